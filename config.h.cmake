@@ -8,6 +8,15 @@
 #cmakedefine HAVE_MALLOC_H
 #cmakedefine HAVE_MALLOC_TRIM
 #cmakedefine HAVE_EAT_NEWLINE_GLITCH
+#cmakedefine HAVE_OPEN_MEMSTREAM
+#cmakedefine HAVE_FMEMOPEN
+#cmakedefine HAVE_EPOLL
+#cmakedefine HAVE_EVENTFD
+#cmakedefine HAVE_KQUEUE
+#cmakedefine HAVE_SENDFILE
+#cmakedefine HAVE_ACCEPT4
+#cmakedefine HAVE_POSIX_SPAWN
+#cmakedefine HAVE_PIDFD_OPEN
 #cmakedefine HAVE_ASPELL_VERSION_STRING
 #cmakedefine HAVE_ENCHANT_GET_VERSION
 #cmakedefine HAVE_GUILE_GMP_MEMORY_FUNCTIONS
@@ -59,6 +59,7 @@
 #include "core-list.h"
 #include "core-log.h"
 #include "core-network.h"
+#include "core-profile.h"
 #include "core-proxy.h"
 #include "core-secure.h"
 #include "core-secure-buffer.h"
@@ -67,6 +68,7 @@
 #include "core-string.h"
 #include "core-sys.h"
 #include "core-upgrade.h"
+#include "core-upgrade-file.h"
 #include "core-url.h"
 #include "core-utf8.h"
 #include "core-util.h"
@@ -657,7 +659,7 @@ command_buffer_display_localvar (void *data,
 COMMAND_CALLBACK(buffer)
 {
     struct t_gui_buffer *ptr_buffer, *ptr_buffer1, *ptr_buffer2;
-    struct t_gui_buffer *weechat_buffer;
+    struct t_gui_buffer *weechat_buffer, **buffers;
     struct t_arraylist *buffers_to_close;
     long number, number1, number2, numbers[3];
     long long number_id;
@@ -928,6 +930,36 @@ COMMAND_CALLBACK(buffer)
         return WEECHAT_RC_OK;
     }
 
+    /* reorder buffers */
+    if (string_strcmp (argv[1], "reorder") == 0)
+    {
+        COMMAND_MIN_ARGS(3, argv[1]);
+
+        buffers = malloc ((argc - 2) * sizeof (*buffers));
+        if (!buffers)
+            COMMAND_ERROR;
+        for (i = 2; i < argc; i++)
+        {
+            buffers[i - 2] = gui_buffer_search_by_id_number_name (argv[i]);
+            if (!buffers[i - 2])
+            {
+                /* invalid buffer name/number */
+                gui_chat_printf (NULL,
+                                 _("%sBuffer \"%s\" not found"),
+                                 gui_chat_prefix[GUI_CHAT_PREFIX_ERROR],
+                                 argv[i]);
+                free (buffers);
+                return WEECHAT_RC_ERROR;
+            }
+        }
+        rc = gui_buffer_reorder (buffers, argc - 2);
+        free (buffers);
+        if (!rc)
+            COMMAND_ERROR;
+
+        return WEECHAT_RC_OK;
+    }
+
     /* merge buffer with another buffer in the list */
     if (string_strcmp (argv[1], "merge") == 0)
     {
@@ -2037,7 +2069,7 @@ COMMAND_CALLBACK(debug)
     struct t_weechat_plugin *ptr_plugin;
     struct timeval time_start, time_end;
     char *result, *str_threshold;
-    long long threshold;
+    long long threshold, interval;
     int debug;
 
     /* make C compiler happy */
@@ -2183,7 +2215,10 @@ COMMAND_CALLBACK(debug)
 
     if (string_strcmp (argv[1], "memory") == 0)
     {
-        debug_memory ();
+        if ((argc > 2) && (string_strcmp (argv[2], "buffers") == 0))
+            debug_memory_buffers ();
+        else
+            debug_memory ();
         return WEECHAT_RC_OK;
     }
 
@@ -2200,6 +2235,69 @@ COMMAND_CALLBACK(debug)
         return WEECHAT_RC_OK;
     }
 
+    if (string_strcmp (argv[1], "profile") == 0)
+    {
+        if (argc == 2)
+        {
+            profile_display (NULL);
+            return WEECHAT_RC_OK;
+        }
+        if (string_strcmp (argv[2], "start") == 0)
+        {
+            profile_start ();
+            gui_chat_printf (NULL, _("Profiler started"));
+            return WEECHAT_RC_OK;
+        }
+        if (string_strcmp (argv[2], "stop") == 0)
+        {
+            profile_stop ();
+            gui_chat_printf (NULL, _("Profiler stopped"));
+            return WEECHAT_RC_OK;
+        }
+        if (string_strcmp (argv[2], "reset") == 0)
+        {
+            profile_reset ();
+            gui_chat_printf (NULL, _("Profiler stats reset"));
+            return WEECHAT_RC_OK;
+        }
+        if (string_strcmp (argv[2], "export") == 0)
+        {
+            COMMAND_MIN_ARGS(4, "profile export");
+            interval = (argc > 4) ? util_parse_delay (argv[4], 1000000) : 0;
+            if (interval < 0)
+                COMMAND_ERROR;
+            if (!profile_export (argv[3]))
+            {
+                gui_chat_printf (NULL,
+                                 _("%sUnable to export profile to file "
+                                   "\"%s\""),
+                                 gui_chat_prefix[GUI_CHAT_PREFIX_ERROR],
+                                 argv[3]);
+                return WEECHAT_RC_OK;
+            }
+            gui_chat_printf (NULL, _("Profile exported to file \"%s\""),
+                             argv[3]);
+            if (!profile_export_set (argv[3], interval))
+                COMMAND_ERROR;
+            if (interval > 0)
+            {
+                str_threshold = util_get_microseconds_string (interval);
+                gui_chat_printf (NULL,
+                                 _("Profile will be exported every %s"),
+                                 (str_threshold) ? str_threshold : "?");
+                free (str_threshold);
+            }
+            return WEECHAT_RC_OK;
+        }
+        COMMAND_ERROR;
+    }
+
+    if (string_strcmp (argv[1], "startup") == 0)
+    {
+        profile_startup_display (NULL);
+        return WEECHAT_RC_OK;
+    }
+
     if (string_strcmp (argv[1], "set") == 0)
     {
         COMMAND_MIN_ARGS(4, argv[1]);
@@ -2311,7 +2409,7 @@ command_eval_print_debug (const char *debug)
                   GUI_COLOR(GUI_COLOR_CHAT));
         string = string_replace_regex (debug, &regex, str_replace, '$',
                                        NULL, NULL);
-        regfree (&regex);
+        string_regfree (&regex);
     }
 
     gui_chat_printf (NULL, "%s", (string) ? string : debug);
@@ -6052,6 +6150,7 @@ COMMAND_CALLBACK(reset)
     if (mask)
     {
         /* reset all options matching the mask */
+        config_file_begin_batch ();
         for (ptr_config = config_files; ptr_config;
              ptr_config = ptr_config->next_config)
         {
@@ -6078,6 +6177,7 @@ COMMAND_CALLBACK(reset)
                 }
             }
         }
+        config_file_end_batch ();
     }
     else
     {
@@ -6168,6 +6268,227 @@ COMMAND_CALLBACK(save)
     return WEECHAT_RC_OK;
 }
 
+/*
+ * Checks if a line matches text searched by command /search (called by
+ * gui_line_scan, possibly in a thread).
+ */
+
+int
+command_search_line_cb (void *data, struct t_gui_line_data *line_data)
+{
+    struct t_command_search *search;
+
+    search = (struct t_command_search *)data;
+
+    return gui_line_match_text (line_data, search->where, search->text,
+                                search->exact, search->regex,
+                                search->regex_compiled);
+}
+
+/*
+ * Callback for command "/search": searches text in lines of buffers.
+ */
+
+COMMAND_CALLBACK(search)
+{
+    struct t_gui_buffer *ptr_buffer;
+    struct t_gui_line *ptr_line;
+    struct t_gui_line_data **lines;
+    struct t_command_search search;
+    regex_t regex;
+    char **buffers, *error, *results;
+    const char *ptr_buffers;
+    int i, arg_text, all, max, count, lines_found, displayed;
+
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) buffer;
+
+    COMMAND_MIN_ARGS(2, "");
+
+    search.where = 0;
+    search.exact = 0;
+    search.regex = 0;
+    search.regex_compiled = NULL;
+    ptr_buffers = NULL;
+    all = 0;
+    max = COMMAND_SEARCH_DEFAULT_MAX;
+
+    for (arg_text = 1; arg_text < argc; arg_text++)
+    {
+        if (string_strcmp (argv[arg_text], "-buffer") == 0)
+        {
+            if (arg_text + 1 >= argc)
+                COMMAND_ERROR;
+            arg_text++;
+            ptr_buffers = argv[arg_text];
+        }
+        else if (string_strcmp (argv[arg_text], "-prefix") == 0)
+            search.where |= GUI_BUFFER_SEARCH_IN_PREFIX;
+        else if (string_strcmp (argv[arg_text], "-message") == 0)
+            search.where |= GUI_BUFFER_SEARCH_IN_MESSAGE;
+        else if (string_strcmp (argv[arg_text], "-exact") == 0)
+            search.exact = 1;
+        else if (string_strcmp (argv[arg_text], "-regex") == 0)
+            search.regex = 1;
+        else if (string_strcmp (argv[arg_text], "-all") == 0)
+            all = 1;
+        else if (string_strcmp (argv[arg_text], "-max") == 0)
+        {
+            if (arg_text + 1 >= argc)
+                COMMAND_ERROR;
+            arg_text++;
+            error = NULL;
+            max = (int)strtol (argv[arg_text], &error, 10);
+            if (!error || error[0] || (max < 0))
+            {
+                gui_chat_printf (NULL,
+                                 _("%sInvalid number: \"%s\""),
+                                 gui_chat_prefix[GUI_CHAT_PREFIX_ERROR],
+                                 argv[arg_text]);
+                return WEECHAT_RC_ERROR;
+            }
+        }
+        else
+            break;
+    }
+
+    if (arg_text >= argc)
+        COMMAND_ERROR;
+
+    if (search.where == 0)
+        search.where = GUI_BUFFER_SEARCH_IN_MESSAGE;
+    search.text = argv_eol[arg_text];
+
+    if (search.regex)
+    {
+        if (string_regcomp (&regex, search.text,
+                            REG_EXTENDED | REG_NOSUB
+                            | ((search.exact) ? 0 : REG_ICASE)) != 0)
+        {
+            gui_chat_printf (NULL,
+                             _("%sInvalid regular expression: \"%s\""),
+                             gui_chat_prefix[GUI_CHAT_PREFIX_ERROR],
+                             search.text);
+            return WEECHAT_RC_ERROR;
+        }
+        search.regex_compiled = &regex;
+    }
+
+    buffers = (ptr_buffers) ?
+        string_split (ptr_buffers, ",", NULL,
+                      WEECHAT_STRING_SPLIT_STRIP_LEFT
+                      | WEECHAT_STRING_SPLIT_STRIP_RIGHT
+                      | WEECHAT_STRING_SPLIT_COLLAPSE_SEPS,
+                      0, NULL) : NULL;
+
+    /* get all lines to search (own lines of buffers, no mixed lines) */
+    count = 0;
+    for (ptr_buffer = gui_buffers; ptr_buffer;
+         ptr_buffer = ptr_buffer->next_buffer)
+    {
+        if (!buffers
+            || string_match_list (ptr_buffer->full_name,
+                                  (const char **)buffers, 0))
+        {
+            count += ptr_buffer->own_lines->lines_count;
+        }
+    }
+    lines = (count > 0) ? malloc (count * sizeof (*lines)) : NULL;
+    results = (count > 0) ? malloc (count) : NULL;
+    if ((count > 0) && (!lines || !results))
+    {
+        free (lines);
+        free (results);
+        string_free_split (buffers);
+        if (search.regex_compiled)
+            string_regfree (search.regex_compiled);
+        gui_chat_printf (NULL,
+                         _("%sNot enough memory (%s)"),
+                         gui_chat_prefix[GUI_CHAT_PREFIX_ERROR],
+                         "/search");
+        return WEECHAT_RC_ERROR;
+    }
+    i = 0;
+    for (ptr_buffer = gui_buffers; ptr_buffer;
+         ptr_buffer = ptr_buffer->next_buffer)
+    {
+        if (buffers
+            && !string_match_list (ptr_buffer->full_name,
+                                   (const char **)buffers, 0))
+        {
+            continue;
+        }
+        for (ptr_line = ptr_buffer->own_lines->first_line;
+             ptr_line && (i < count);
+             ptr_line = ptr_line->next_line)
+        {
+            if (all || ptr_line->data->displayed)
+                lines[i++] = ptr_line->data;
+        }
+    }
+    count = i;
+
+    gui_line_scan (lines, count, CONFIG_INTEGER(config_look_scan_threads),
+                   &command_search_line_cb, &search, results);
+
+    lines_found = 0;
+    for (i = 0; i < count; i++)
+    {
+        if (results[i])
+            lines_found++;
+    }
+
+    gui_chat_printf (NULL, "");
+    if (lines_found == 0)
+    {
+        gui_chat_printf (NULL, _("No line found with \"%s\""), search.text);
+    }
+    else
+    {
+        gui_chat_printf (NULL,
+                         NG_("%d line found with \"%s\":",
+                             "%d lines found with \"%s\":",
+                             lines_found),
+                         lines_found,
+                         search.text);
+        displayed = 0;
+        for (i = 0; (i < count) && (displayed < max); i++)
+        {
+            if (!results[i])
+                continue;
+            gui_chat_printf (NULL,
+                             "  %s%s%s %s %s%s%s%s",
+                             GUI_COLOR(GUI_COLOR_CHAT_BUFFER),
+                             lines[i]->buffer->full_name,
+                             GUI_COLOR(GUI_COLOR_CHAT),
+                             util_get_time_string (&(lines[i]->date)),
+                             (lines[i]->prefix) ? lines[i]->prefix : "",
+                             GUI_COLOR(GUI_COLOR_CHAT),
+                             (lines[i]->prefix && lines[i]->prefix[0]) ?
+                             " " : "",
+                             (lines[i]->message) ? lines[i]->message : "");
+            displayed++;
+        }
+        if (lines_found > displayed)
+        {
+            gui_chat_printf (NULL,
+                             NG_("  (%d more line)", "  (%d more lines)",
+                                 lines_found - displayed),
+                             lines_found - displayed);
+        }
+    }
+
+    free (lines);
+    free (results);
+    string_free_split (buffers);
+    if (search.regex_compiled)
+        string_regfree (search.regex_compiled);
+
+    return WEECHAT_RC_OK;
+}
+
 /*
  * Callback for command "/secure": manage secured data
  */
@@ -7050,6 +7371,7 @@ COMMAND_CALLBACK(unset)
     if (mask)
     {
         /* unset all options matching the mask */
+        config_file_begin_batch ();
         for (ptr_config = config_files; ptr_config;
              ptr_config = ptr_config->next_config)
         {
@@ -7077,6 +7399,7 @@ COMMAND_CALLBACK(unset)
                 }
             }
         }
+        config_file_end_batch ();
     }
     else
     {
@@ -7233,7 +7556,7 @@ COMMAND_CALLBACK(upgrade)
         /* send "upgrade" signal to plugins */
         (void) hook_signal_send ("upgrade", WEECHAT_HOOK_SIGNAL_STRING, "save");
         /* save WeeChat session */
-        if (!upgrade_weechat_save ())
+        if (!upgrade_weechat_save () || !upgrade_file_wait_writers ())
         {
             gui_chat_printf (NULL,
                              _("%sUnable to save WeeChat session "
@@ -7350,6 +7673,8 @@ COMMAND_CALLBACK(upgrade)
     if (CONFIG_BOOLEAN(config_look_save_config_on_exit))
         (void) config_weechat_write ();
     gui_main_end (1);
+    /* wait for end of write of upgrade files (errors are logged) */
+    (void) upgrade_file_wait_writers ();
     log_close ();
 
     if (quit)
@@ -8094,6 +8419,7 @@ command_init ()
            " || move <number>|-|+"
            " || swap <id1>|<number1>|<name1> [<id2>|<number2>|<name2>]"
            " || cycle <id>|<number>|<name> [<id>|<number>|<name>...]"
+           " || reorder <id>|<number>|<name> [<id>|<number>|<name>...]"
            " || merge <id>|<number>|<name>"
            " || unmerge [<number>|-all]"
            " || hide [<id>|<number>|<name>|-all [<id>|<number>|<name>...]]"
@@ -8124,6 +8450,9 @@ command_init ()
             N_("raw[swap]: swap two buffers (swap with current buffer if only one "
                "number/name given)"),
             N_("raw[cycle]: jump loop between a list of buffers"),
+            N_("raw[reorder]: move buffers in one operation: buffers given are "
+               "moved first, in this order, followed by other buffers (numbers "
+               "are kept, only the order of buffers is changed)"),
             N_("raw[merge]: merge current buffer to another buffer (chat area will "
                "be mix of both buffers); by default ctrl-x switches between merged buffers"),
             N_("raw[unmerge]: unmerge buffer from other buffers which have same number"),
@@ -8173,6 +8502,7 @@ command_init ()
             AI("  /buffer swap 1 3"),
             AI("  /buffer swap #weechat"),
             AI("  /buffer cycle #chan1 #chan2 #chan3"),
+            AI("  /buffer reorder core.weechat irc.server.libera #weechat"),
             AI("  /buffer merge 1"),
             AI("  /buffer merge #weechat"),
             AI("  /buffer close 5-7"),
@@ -8186,6 +8516,7 @@ command_init ()
         " || swap %(buffers_numbers)|%(buffers_plugins_names) "
         "%(buffers_numbers)|%(buffers_plugins_names)"
         " || cycle %(buffers_numbers)|%(buffers_plugins_names)|%*"
+        " || reorder %(buffers_numbers)|%(buffers_plugins_names)|%*"
         " || merge %(buffers_numbers)|%(buffers_plugins_names)"
         " || unmerge %(buffers_numbers)|-all"
         " || hide %(buffers_numbers)|%(buffers_plugins_names)|-all "
@@ -8313,9 +8644,12 @@ command_init ()
         N_("list"
            " || set <plugin> <level>"
            " || dump|hooks [<plugin>]"
-           " || buffer|certs|color|dirs|infolists|key|libs|memory|tags|"
+           " || buffer|certs|color|dirs|infolists|key|libs|startup|tags|"
            "term|url|windows"
            " || callbacks <duration>[<unit>]"
+           " || profile [start|stop|reset]"
+           " || profile export <file> [<interval>[<unit>]]"
+           " || memory [buffers]"
            " || mouse|cursor [verbose]"
            " || hdata [free]"
            " || time <command>"
@@ -8349,8 +8683,25 @@ command_init ()
             N_("raw[key]: enable keyboard and mouse debug: display raw codes, "
                "expanded key name and associated command (\"q\" to quit this mode)"),
             N_("raw[libs]: display infos about external libraries used"),
-            N_("raw[memory]: display infos about memory usage"),
+            N_("raw[memory]: display infos about memory usage (with buffers: "
+               "display memory used by each buffer for lines, compressed "
+               "lines, nicklist and local variables, size of lines saved on "
+               "disk, and total by plugin)"),
             N_("raw[mouse]: toggle debug for mouse"),
+            N_("raw[profile]: display time spent in the main loop and in "
+               "callbacks of hooks, by hook type, plugin/script and hook "
+               "(count of calls, total, average, max and 99th percentile of "
+               "time)"),
+            N_("> raw[start]: reset all stats and start profiler"),
+            N_("> raw[stop]: stop profiler (stats are kept)"),
+            N_("> raw[reset]: reset all stats"),
+            N_("> raw[export]: write stats in a file (path is evaluated, see "
+               "/help eval), with an interval: write stats periodically "
+               "until profiler is stopped, where optional unit is one of: "
+               "ms, s (default), m, h"),
+            N_("raw[startup]: display time spent in the phases of WeeChat "
+               "startup, to read configuration files, to load and initialize "
+               "plugins and to load scripts"),
             N_("raw[tags]: display tags for lines"),
             N_("raw[term]: display infos about terminal"),
             N_("raw[url]: toggle debug for calls to hook_url (display output hashtable)"),
@@ -8364,6 +8715,7 @@ command_init ()
             AI("  /debug set irc 1"),
             AI("  /debug mouse verbose"),
             AI("  /debug time /filter toggle"),
+            AI("  /debug profile export ${weechat_state_dir}/profile.txt 1m"),
             AI("  /debug unicode ${chars:${\\u26C0}-${\\u26CF}}")),
         "list"
         " || set %(plugins_names)|" PLUGIN_CORE
@@ -8379,8 +8731,10 @@ command_init ()
         " || infolists"
         " || key"
         " || libs"
-        " || memory"
+        " || memory buffers"
         " || mouse verbose"
+        " || profile start|stop|reset|export"
+        " || startup"
         " || tags"
         " || term"
         " || url"
@@ -9293,6 +9647,42 @@ command_init ()
                "command (see option \"weechat.look.save_config_on_exit\").")),
         "%(config_files)|%*",
         &command_save, NULL, NULL);
+    hook_command (
+        NULL, "search",
+        N_("search text in lines of buffers"),
+        /* TRANSLATORS: only text between angle brackets (eg: "<name>") must be translated */
+        N_("[-buffer <name>[,<name>...]] [-prefix] [-message] [-exact] "
+           "[-regex] [-all] [-max <count>] <text>"),
+        CMD_ARGS_DESC(
+            N_("raw[-buffer]: search only in these buffers (full names, "
+               "wildcard \"*\" is allowed, a name beginning with \"!\" is "
+               "excluded); default is all buffers"),
+            N_("name: full name of buffer"),
+            N_("raw[-prefix]: search in prefix of lines"),
+            N_("raw[-message]: search in message of lines (default if neither "
+               "raw[-prefix] nor raw[-message] is given)"),
+            N_("raw[-exact]: case sensitive search"),
+            N_("raw[-regex]: text is a POSIX extended regular expression"),
+            N_("raw[-all]: search also in lines hidden by filters"),
+            N_("raw[-max]: max number of lines displayed (default: 100, "
+               "0 = display only the number of lines found)"),
+            N_("count: max number of lines"),
+            N_("text: text to search"),
+            "",
+            N_("Lines are searched in parallel threads if there are many lines "
+               "(see /help weechat.look.scan_threads) and the lines found are "
+               "displayed in core buffer."),
+            "",
+            N_("Examples:"),
+            N_("  search \"weechat\" in all buffers:"),
+            AI("    /search weechat"),
+            N_("  search a nick in prefix of lines in IRC channels:"),
+            AI("    /search -buffer irc.*.#* -prefix alice"),
+            N_("  search lines with an URL, display only the number of lines:"),
+            AI("    /search -max 0 -regex https?://")),
+        "-buffer %(buffers_plugins_names)|%*"
+        " || -prefix|-message|-exact|-regex|-all|-max|%*",
+        &command_search, NULL, NULL);
     hook_command (
         NULL, "secure",
         N_("manage secured data (passwords or private data encrypted in file "
@@ -21,6 +21,8 @@
 #ifndef WEECHAT_COMMAND_H
 #define WEECHAT_COMMAND_H
 
+#include <regex.h>
+
 struct t_gui_buffer;
 
 #define COMMAND_CALLBACK(__command)                                     \
@@ -94,6 +96,18 @@ struct t_command_repeat
     int index;                         /* current index (starts at 1)       */
 };
 
+/* default max number of lines displayed by command /search */
+#define COMMAND_SEARCH_DEFAULT_MAX 100
+
+struct t_command_search
+{
+    int where;                         /* search in prefix and/or message   */
+    const char *text;                  /* text to search                    */
+    int exact;                         /* 1 = case sensitive                */
+    int regex;                         /* 1 = text is a regex               */
+    regex_t *regex_compiled;           /* compiled regex                    */
+};
+
 extern const char *command_help_option_color_values ();
 extern void command_version_display (struct t_gui_buffer *buffer,
                                      int send_to_buffer_as_input,
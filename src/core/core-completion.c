@@ -1191,11 +1191,8 @@ completion_list_add_config_options_cb (const void *pointer, void *data,
                                        struct t_gui_buffer *buffer,
                                        struct t_gui_completion *completion)
 {
-    struct t_config_file *ptr_config;
-    struct t_config_section *ptr_section;
-    struct t_config_option *ptr_option;
-    int length;
-    char *option_full_name;
+    const char **options_sorted;
+    int count;
 
     /* make C compiler happy */
     (void) pointer;
@@ -1203,32 +1200,8 @@ completion_list_add_config_options_cb (const void *pointer, void *data,
     (void) completion_item;
     (void) buffer;
 
-    for (ptr_config = config_files; ptr_config;
-         ptr_config = ptr_config->next_config)
-    {
-        for (ptr_section = ptr_config->sections; ptr_section;
-             ptr_section = ptr_section->next_section)
-        {
-            for (ptr_option = ptr_section->options; ptr_option;
-                 ptr_option = ptr_option->next_option)
-            {
-                length = strlen (ptr_config->name) + 1
-                    + strlen (ptr_section->name) + 1
-                    + strlen (ptr_option->name) + 1;
-                option_full_name = malloc (length);
-                if (option_full_name)
-                {
-                    snprintf (option_full_name, length, "%s.%s.%s",
-                              ptr_config->name, ptr_section->name,
-                              ptr_option->name);
-                    gui_completion_list_add (completion,
-                                             option_full_name,
-                                             0, WEECHAT_LIST_POS_SORT);
-                    free (option_full_name);
-                }
-            }
-        }
-    }
+    options_sorted = config_file_get_options_sorted (&count);
+    gui_completion_list_add_sorted (completion, options_sorted, count);
 
     return WEECHAT_RC_OK;
 }
@@ -31,6 +31,7 @@
 #include <stdarg.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <sys/time.h>
 #include <errno.h>
 
 #include "weechat.h"
@@ -43,6 +44,7 @@
 #include "core-hook.h"
 #include "core-infolist.h"
 #include "core-log.h"
+#include "core-profile.h"
 #include "core-string.h"
 #include "core-version.h"
 #include "../gui/gui-color.h"
@@ -53,6 +55,28 @@
 struct t_config_file *config_files = NULL;
 struct t_config_file *last_config_file = NULL;
 
+/* options indexed by full name ("file.section.option") */
+struct t_hashtable *config_file_options_index = NULL;
+
+/* full names of options, sorted (case insensitive), built on demand */
+const char **config_file_options_sorted = NULL;
+int config_file_options_sorted_count = 0;
+int config_file_options_sorted_valid = 0;
+
+/*
+ * configuration file being read: options added in its sections are appended
+ * (unsorted), and sections are sorted once at the end of read
+ */
+struct t_config_file *config_file_bulk_load = NULL;
+
+/*
+ * batch of changes: notifications of config hooks are delayed until the end
+ * of batch, and sent once per option (with last value), by order of first
+ * change
+ */
+int config_file_batch = 0;                 /* > 0 if a batch is in progress */
+struct t_hashtable *config_file_batch_changes = NULL; /* option -> value    */
+
 char *config_option_type_string[CONFIG_NUM_OPTION_TYPES] =
 { N_("boolean"), N_("integer"), N_("string"), N_("color"), N_("enum") };
 char *config_boolean_true[] = { "on", "yes", "y", "true", "t", "1", NULL };
@@ -453,6 +477,17 @@ config_file_new_section (struct t_config_file *config_file, const char *name,
         new_section->callback_delete_option_data = callback_delete_option_data;
         new_section->options = NULL;
         new_section->last_option = NULL;
+        new_section->options_hash = hashtable_new (
+            32,
+            WEECHAT_HASHTABLE_STRING,
+            WEECHAT_HASHTABLE_POINTER,
+            NULL, NULL);
+        if (!new_section->options_hash)
+        {
+            free (new_section->name);
+            free (new_section);
+            return NULL;
+        }
 
         new_section->prev_section = config_file->last_section;
         new_section->next_section = NULL;
@@ -522,6 +557,92 @@ config_file_option_full_name (struct t_config_option *option)
     return option_full_name;
 }
 
+/*
+ * Executes hook_config for an option, or saves the change if a batch is in
+ * progress.
+ */
+
+void
+config_file_hook_config_run (const char *option_full_name, const char *value)
+{
+    if (config_file_batch > 0)
+    {
+        if (!config_file_batch_changes)
+        {
+            config_file_batch_changes = hashtable_new (
+                32,
+                WEECHAT_HASHTABLE_STRING,
+                WEECHAT_HASHTABLE_STRING,
+                NULL, NULL);
+        }
+        if (config_file_batch_changes)
+        {
+            hashtable_set (config_file_batch_changes, option_full_name, value);
+            return;
+        }
+    }
+
+    hook_config_exec (option_full_name, value);
+}
+
+/*
+ * Starts a batch of changes in configuration options: hook_config callbacks
+ * are called only at the end of batch, once per option.
+ *
+ * Batches can be nested: callbacks are called at the end of the outer batch.
+ */
+
+void
+config_file_begin_batch ()
+{
+    config_file_batch++;
+}
+
+/*
+ * Sends a change saved during a batch to hook_config callbacks.
+ */
+
+void
+config_file_end_batch_map_cb (void *data,
+                              struct t_hashtable *hashtable,
+                              const void *key, const void *value)
+{
+    /* make C compiler happy */
+    (void) data;
+    (void) hashtable;
+
+    hook_config_exec ((const char *)key, (const char *)value);
+}
+
+/*
+ * Ends a batch of changes in configuration options: if this is the outer
+ * batch, hook_config callbacks are called for all options changed during the
+ * batch.
+ */
+
+void
+config_file_end_batch ()
+{
+    struct t_hashtable *changes;
+
+    if (config_file_batch <= 0)
+        return;
+
+    config_file_batch--;
+    if (config_file_batch > 0)
+        return;
+
+    /* callbacks can change options, so a new batch can be started */
+    changes = config_file_batch_changes;
+    config_file_batch_changes = NULL;
+
+    if (changes)
+    {
+        hashtable_map (changes, &config_file_end_batch_map_cb, NULL);
+        hashtable_free (changes);
+    }
+}
+
 /*
  * Executes hook_config for modified option.
  */
@@ -534,6 +655,10 @@ config_file_hook_config_exec (struct t_config_option *option)
     if (!option || !option->config_file || !option->section)
         return;
 
+    /* no need to build option name and value if there is no config hook */
+    if (!weechat_hooks[HOOK_TYPE_CONFIG])
+        return;
+
     option_full_name = config_file_option_full_name (option);
     if (!option_full_name)
         return;
@@ -543,25 +668,26 @@ config_file_hook_config_exec (struct t_config_option *option)
         switch (option->type)
         {
             case CONFIG_OPTION_TYPE_BOOLEAN:
-                hook_config_exec (option_full_name,
-                                  (CONFIG_BOOLEAN(option) == CONFIG_BOOLEAN_TRUE) ?
-                                  "on" : "off");
+                config_file_hook_config_run (option_full_name,
+                                             (CONFIG_BOOLEAN(option) == CONFIG_BOOLEAN_TRUE) ?
+                                             "on" : "off");
                 break;
             case CONFIG_OPTION_TYPE_INTEGER:
                 snprintf (str_value, sizeof (str_value),
                           "%d", CONFIG_INTEGER(option));
-                hook_config_exec (option_full_name, str_value);
+                config_file_hook_config_run (option_full_name, str_value);
                 break;
             case CONFIG_OPTION_TYPE_STRING:
-                hook_config_exec (option_full_name, (char *)option->value);
+                config_file_hook_config_run (option_full_name,
+                                             (char *)option->value);
                 break;
             case CONFIG_OPTION_TYPE_COLOR:
-                hook_config_exec (option_full_name,
-                                  gui_color_get_name (CONFIG_COLOR(option)));
+                config_file_hook_config_run (option_full_name,
+                                             gui_color_get_name (CONFIG_COLOR(option)));
                 break;
             case CONFIG_OPTION_TYPE_ENUM:
-                hook_config_exec (option_full_name,
-                                  option->string_values[CONFIG_ENUM(option)]);
+                config_file_hook_config_run (option_full_name,
+                                             option->string_values[CONFIG_ENUM(option)]);
                 break;
             case CONFIG_NUM_OPTION_TYPES:
                 break;
@@ -569,7 +695,7 @@ config_file_hook_config_exec (struct t_config_option *option)
     }
     else
     {
-        hook_config_exec (option_full_name, NULL);
+        config_file_hook_config_run (option_full_name, NULL);
     }
 
     free (option_full_name);
@@ -597,6 +723,157 @@ config_file_option_find_pos (struct t_config_section *section, const char *name)
     return section->options;
 }
 
+/*
+ * Adds an option in hashtables of section and in index of options by full
+ * name.
+ */
+
+void
+config_file_option_index_add (struct t_config_option *option)
+{
+    char *option_full_name;
+
+    if (!option || !option->section)
+        return;
+
+    hashtable_set (option->section->options_hash, option->name, option);
+
+    if (!option->config_file)
+        return;
+
+    if (!config_file_options_index)
+    {
+        config_file_options_index = hashtable_new (
+            32,
+            WEECHAT_HASHTABLE_STRING,
+            WEECHAT_HASHTABLE_POINTER,
+            NULL, NULL);
+        if (!config_file_options_index)
+            return;
+    }
+
+    option_full_name = config_file_option_full_name (option);
+    if (option_full_name)
+    {
+        hashtable_set (config_file_options_index, option_full_name, option);
+        free (option_full_name);
+    }
+
+    config_file_options_sorted_valid = 0;
+}
+
+/*
+ * Removes an option from hashtable of section and from index of options by
+ * full name.
+ */
+
+void
+config_file_option_index_remove (struct t_config_option *option)
+{
+    char *option_full_name;
+
+    if (!option || !option->section)
+        return;
+
+    if (hashtable_get (option->section->options_hash, option->name) == option)
+        hashtable_remove (option->section->options_hash, option->name);
+
+    if (!option->config_file || !config_file_options_index)
+        return;
+
+    option_full_name = config_file_option_full_name (option);
+    if (option_full_name)
+    {
+        if (hashtable_get (config_file_options_index,
+                           option_full_name) == option)
+        {
+            hashtable_remove (config_file_options_index, option_full_name);
+        }
+        free (option_full_name);
+    }
+
+    config_file_options_sorted_valid = 0;
+
+    if (config_file_options_index->items_count == 0)
+    {
+        hashtable_free (config_file_options_index);
+        config_file_options_index = NULL;
+        free (config_file_options_sorted);
+        config_file_options_sorted = NULL;
+        config_file_options_sorted_count = 0;
+    }
+}
+
+/*
+ * Adds full name of an option in array of sorted options.
+ */
+
+void
+config_file_options_sorted_add_cb (void *data,
+                                   struct t_hashtable *hashtable,
+                                   const void *key, const void *value)
+{
+    /* make C compiler happy */
+    (void) data;
+    (void) hashtable;
+    (void) value;
+
+    config_file_options_sorted[config_file_options_sorted_count++] = key;
+}
+
+/*
+ * Compares two option full names (case insensitive), for qsort.
+ */
+
+int
+config_file_options_sorted_cmp_cb (const void *name1, const void *name2)
+{
+    return string_strcasecmp (*((const char **)name1),
+                              *((const char **)name2));
+}
+
+/*
+ * Returns full names of all options, sorted (case insensitive), so that
+ * options matching a prefix can be found with a binary search.
+ *
+ * The array is built on first call and after options are added or removed;
+ * it must NOT be freed, and it is valid only until the next add/remove of
+ * an option.
+ */
+
+const char **
+config_file_get_options_sorted (int *count)
+{
+    const char **new_sorted;
+
+    *count = 0;
+
+    if (!config_file_options_index)
+        return NULL;
+
+    if (!config_file_options_sorted_valid)
+    {
+        new_sorted = realloc (
+            config_file_options_sorted,
+            (config_file_options_index->items_count + 1)
+            * sizeof (*config_file_options_sorted));
+        if (!new_sorted)
+            return NULL;
+        config_file_options_sorted = new_sorted;
+        config_file_options_sorted_count = 0;
+        hashtable_map (config_file_options_index,
+                       &config_file_options_sorted_add_cb, NULL);
+        qsort (config_file_options_sorted, config_file_options_sorted_count,
+               sizeof (*config_file_options_sorted),
+               &config_file_options_sorted_cmp_cb);
+        config_file_options_sorted_valid = 1;
+    }
+
+    *count = config_file_options_sorted_count;
+
+    return config_file_options_sorted;
+}
+
 /*
  * Inserts an option in section (keeping options sorted by name).
  */
@@ -611,8 +888,8 @@ config_file_option_insert_in_section (struct t_config_option *option)
 
     if (option->section->options)
     {
-        pos_option = config_file_option_find_pos (option->section,
-                                                  option->name);
+        pos_option = (option->section->config_file == config_file_bulk_load) ?
+            NULL : config_file_option_find_pos (option->section, option->name);
         if (pos_option)
         {
             /* insert option into the list (before option found) */
@@ -641,6 +918,72 @@ config_file_option_insert_in_section (struct t_config_option *option)
         (option->section)->options = option;
         (option->section)->last_option = option;
     }
+
+    config_file_option_index_add (option);
+}
+
+/*
+ * Compares two options by name (used to sort options with qsort).
+ */
+
+int
+config_file_option_cmp_cb (const void *option1, const void *option2)
+{
+    return strcmp ((*((struct t_config_option **)option1))->name,
+                   (*((struct t_config_option **)option2))->name);
+}
+
+/*
+ * Sorts options of a section by name (used after options have been appended
+ * without sort, during read of configuration file).
+ */
+
+void
+config_file_section_sort_options (struct t_config_section *section)
+{
+    struct t_config_option *ptr_option, **options;
+    int count, sorted, i;
+
+    if (!section || !section->options)
+        return;
+
+    count = 0;
+    sorted = 1;
+    for (ptr_option = section->options; ptr_option;
+         ptr_option = ptr_option->next_option)
+    {
+        if (ptr_option->prev_option
+            && (strcmp (ptr_option->prev_option->name, ptr_option->name) > 0))
+        {
+            sorted = 0;
+        }
+        count++;
+    }
+    if (sorted)
+        return;
+
+    options = malloc (count * sizeof (*options));
+    if (!options)
+        return;
+
+    i = 0;
+    for (ptr_option = section->options; ptr_option;
+         ptr_option = ptr_option->next_option)
+    {
+        options[i++] = ptr_option;
+    }
+
+    qsort (options, count, sizeof (*options), &config_file_option_cmp_cb);
+
+    for (i = 0; i < count; i++)
+    {
+        options[i]->prev_option = (i > 0) ? options[i - 1] : NULL;
+        options[i]->next_option = (i < count - 1) ? options[i + 1] : NULL;
+    }
+    section->options = options[0];
+    section->last_option = options[count - 1];
+
+    free (options);
 }
 
 /*
@@ -1004,37 +1347,23 @@ config_file_search_option (struct t_config_file *config_file,
 {
     struct t_config_section *ptr_section;
     struct t_config_option *ptr_option;
-    int rc;
 
     if (!option_name)
         return NULL;
 
     if (section)
     {
-        for (ptr_option = section->last_option; ptr_option;
-             ptr_option = ptr_option->prev_option)
-        {
-            rc = strcmp (ptr_option->name, option_name);
-            if (rc == 0)
-                return ptr_option;
-            else if (rc < 0)
-                break;
-        }
+        return hashtable_get (section->options_hash, option_name);
     }
     else if (config_file)
     {
         for (ptr_section = config_file->sections; ptr_section;
              ptr_section = ptr_section->next_section)
         {
-            for (ptr_option = ptr_section->last_option; ptr_option;
-                 ptr_option = ptr_option->prev_option)
-            {
-                rc = strcmp (ptr_option->name, option_name);
-                if (rc == 0)
-                    return ptr_option;
-                else if (rc < 0)
-                    break;
-            }
+            ptr_option = hashtable_get (ptr_section->options_hash,
+                                        option_name);
+            if (ptr_option)
+                return ptr_option;
         }
     }
 
@@ -1058,7 +1387,6 @@ config_file_search_section_option (struct t_config_file *config_file,
 {
     struct t_config_section *ptr_section;
     struct t_config_option *ptr_option;
-    int rc;
 
     *section_found = NULL;
     *option_found = NULL;
@@ -1068,18 +1396,11 @@ config_file_search_section_option (struct t_config_file *config_file,
 
     if (section)
     {
-        for (ptr_option = section->last_option; ptr_option;
-             ptr_option = ptr_option->prev_option)
+        ptr_option = hashtable_get (section->options_hash, option_name);
+        if (ptr_option)
         {
-            rc = strcmp (ptr_option->name, option_name);
-            if (rc == 0)
-            {
-                *section_found = section;
-                *option_found = ptr_option;
-                return;
-            }
-            else if (rc < 0)
-                break;
+            *section_found = section;
+            *option_found = ptr_option;
         }
     }
     else if (config_file)
@@ -1087,18 +1408,13 @@ config_file_search_section_option (struct t_config_file *config_file,
         for (ptr_section = config_file->sections; ptr_section;
              ptr_section = ptr_section->next_section)
         {
-            for (ptr_option = ptr_section->last_option; ptr_option;
-                 ptr_option = ptr_option->prev_option)
+            ptr_option = hashtable_get (ptr_section->options_hash,
+                                        option_name);
+            if (ptr_option)
             {
-                rc = strcmp (ptr_option->name, option_name);
-                if (rc == 0)
-                {
-                    *section_found = ptr_section;
-                    *option_found = ptr_option;
-                    return;
-                }
-                else if (rc < 0)
-                    break;
+                *section_found = ptr_section;
+                *option_found = ptr_option;
+                return;
             }
         }
     }
@@ -1143,6 +1459,28 @@ config_file_search_with_string (const char *option_name,
 
     pos_section = strchr (option_name, '.');
     pos_option = (pos_section) ? strchr (pos_section + 1, '.') : NULL;
+
+    /* fast path: search option in index of options by full name */
+    if (pos_section && pos_option && config_file_options_index)
+    {
+        ptr_option = hashtable_get (config_file_options_index, option_name);
+        if (ptr_option
+            && ((int)strlen (ptr_option->section->name) ==
+                pos_option - pos_section - 1))
+        {
+            if (config_file)
+                *config_file = ptr_option->config_file;
+            if (section)
+                *section = ptr_option->section;
+            if (option)
+                *option = ptr_option;
+            if (pos_option_name)
+                *pos_option_name = pos_option + 1;
+            return;
+        }
+        ptr_option = NULL;
+    }
+
     if (pos_section && pos_option)
     {
         file_name = string_strndup (option_name, pos_section - option_name);
@@ -2255,7 +2593,7 @@ config_file_option_unset (struct t_config_option *option)
 
         if (option_full_name)
         {
-            hook_config_exec (option_full_name, NULL);
+            config_file_hook_config_run (option_full_name, NULL);
             free (option_full_name);
         }
     }
@@ -2304,6 +2642,7 @@ config_file_option_rename (struct t_config_option *option,
         /* remove option from list */
         if (option->section)
         {
+            config_file_option_index_remove (option);
             if (option->prev_option)
                 (option->prev_option)->next_option = option->next_option;
             if (option->next_option)
@@ -3196,6 +3535,10 @@ config_file_write_internal (struct t_config_file *config_file,
     if (!config_file)
         return WEECHAT_CONFIG_WRITE_ERROR;
 
+    /* config files are written only by WeeChat process, not a child process */
+    if (hook_process_in_child)
+        return WEECHAT_CONFIG_WRITE_ERROR;
+
     /* build filename */
     filename_length = strlen (weechat_config_dir) + strlen (DIR_SEPARATOR) +
         strlen (config_file->filename) + 1;
@@ -3248,6 +3591,9 @@ config_file_write_internal (struct t_config_file *config_file,
         goto error;
     }
 
+    /* use a large buffer, so that the file is written with few system calls */
+    setvbuf (config_file->file, NULL, _IOFBF, CONFIG_FILE_WRITE_BUFFER_SIZE);
+
     /* write header with name of config file and WeeChat version */
     if (!string_fprintf (
             config_file->file,
@@ -3627,6 +3973,7 @@ config_file_read_internal (struct t_config_file *config_file, int reload)
     int filename_length, line_number, rc, length, version;
     int warning_update_displayed;
     char *filename, *section, *option, *value;
+    struct t_config_file *ptr_bulk_load;
     struct t_config_section *ptr_section;
     struct t_config_option *ptr_option;
     char line[16384], *ptr_line, *ptr_line2, *pos, *pos2;
@@ -3677,6 +4024,10 @@ config_file_read_internal (struct t_config_file *config_file, int reload)
     if (!reload)
         log_printf (_("Reading configuration file %s"), config_file->filename);
 
+    /* append new options without sort, sections are sorted at the end */
+    ptr_bulk_load = config_file_bulk_load;
+    config_file_bulk_load = config_file;
+
     /* read all lines */
     ptr_section = NULL;
     line_number = 0;
@@ -3939,6 +4290,13 @@ end_file:
     config_file->file = NULL;
     free (filename);
 
+    config_file_bulk_load = ptr_bulk_load;
+    for (ptr_section = config_file->sections; ptr_section;
+         ptr_section = ptr_section->next_section)
+    {
+        config_file_section_sort_options (ptr_section);
+    }
+
     return WEECHAT_CONFIG_READ_OK;
 }
 
@@ -3954,7 +4312,18 @@ end_file:
 int
 config_file_read (struct t_config_file *config_file)
 {
-    return config_file_read_internal (config_file, 0);
+    struct timeval tv_start;
+    int rc;
+
+    gettimeofday (&tv_start, NULL);
+    rc = config_file_read_internal (config_file, 0);
+    if (config_file)
+    {
+        (void) profile_startup_add (PROFILE_STARTUP_CONFIG,
+                                    config_file->filename, &tv_start);
+    }
+
+    return rc;
 }
 
 /*
@@ -3992,6 +4361,9 @@ config_file_reload (struct t_config_file *config_file)
         }
     }
 
+    /* notify config hooks once per option, at the end of reload */
+    config_file_begin_batch ();
+
     /* read configuration file */
     rc = config_file_read_internal (config_file, 1);
 
@@ -4010,6 +4382,8 @@ config_file_reload (struct t_config_file *config_file)
         }
     }
 
+    config_file_end_batch ();
+
     return rc;
 }
 
@@ -4045,11 +4419,14 @@ config_file_option_free (struct t_config_option *option, int run_callback)
     if (!option)
         return;
 
-    option_full_name = (run_callback) ?
+    option_full_name = (run_callback && weechat_hooks[HOOK_TYPE_CONFIG]) ?
         config_file_option_full_name (option) : NULL;
 
     ptr_section = option->section;
 
+    /* remove option from hashtables (before name is freed) */
+    config_file_option_index_remove (option);
+
     /* free data */
     config_file_option_free_data (option);
 
@@ -4074,7 +4451,7 @@ config_file_option_free (struct t_config_option *option, int run_callback)
 
     if (option_full_name)
     {
-        hook_config_exec (option_full_name, NULL);
+        config_file_hook_config_run (option_full_name, NULL);
         free (option_full_name);
     }
 }
@@ -4112,6 +4489,7 @@ config_file_section_free (struct t_config_section *section)
 
     /* free data */
     config_file_section_free_options (section);
+    hashtable_free (section->options_hash);
     free (section->name);
     free (section->callback_read_data);
     free (section->callback_write_data);
@@ -4291,6 +4669,7 @@ config_file_hdata_config_section_cb (const void *pointer, void *data,
         HDATA_VAR(struct t_config_section, callback_delete_option_data, POINTER, 0, NULL, NULL);
         HDATA_VAR(struct t_config_section, options, POINTER, 0, NULL, "config_option");
         HDATA_VAR(struct t_config_section, last_option, POINTER, 0, NULL, "config_option");
+        HDATA_VAR(struct t_config_section, options_hash, HASHTABLE, 0, NULL, NULL);
         HDATA_VAR(struct t_config_section, prev_section, POINTER, 0, NULL, hdata_name);
         HDATA_VAR(struct t_config_section, next_section, POINTER, 0, NULL, hdata_name);
     }
@@ -4583,6 +4962,7 @@ config_file_print_log ()
             log_printf ("      callback_delete_option_data . : %p", ptr_section->callback_delete_option_data);
             log_printf ("      options . . . . . . . . . . . : %p", ptr_section->options);
             log_printf ("      last_option . . . . . . . . . : %p", ptr_section->last_option);
+            log_printf ("      options_hash. . . . . . . . . : %p", ptr_section->options_hash);
             log_printf ("      prev_section. . . . . . . . . : %p", ptr_section->prev_section);
             log_printf ("      next_section. . . . . . . . . : %p", ptr_section->next_section);
 
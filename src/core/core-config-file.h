@@ -45,6 +45,9 @@
 #define CONFIG_BOOLEAN_FALSE  0
 #define CONFIG_BOOLEAN_TRUE   1
 
+/* size of buffer used to write configuration files */
+#define CONFIG_FILE_WRITE_BUFFER_SIZE (256 * 1024)
+
 struct t_weelist;
 struct t_infolist;
 
@@ -129,6 +132,7 @@ struct t_config_section
     void *callback_delete_option_data;     /* data sent to delete callback  */
     struct t_config_option *options;       /* options in section            */
     struct t_config_option *last_option;   /* last option in section        */
+    struct t_hashtable *options_hash;      /* options indexed by name       */
     struct t_config_section *prev_section; /* link to previous section      */
     struct t_config_section *next_section; /* link to next section          */
 };
@@ -184,6 +188,9 @@ struct t_config_option
 
 extern struct t_config_file *config_files;
 extern struct t_config_file *last_config_file;
+extern struct t_hashtable *config_file_options_index;
+extern struct t_config_file *config_file_bulk_load;
+extern int config_file_batch;
 
 extern char *config_option_type_string[];
 
@@ -206,6 +213,8 @@ extern int config_file_set_version (struct t_config_file *config_file,
                                     const void *callback_update_pointer,
                                     void *callback_update_data);
 extern struct t_arraylist *config_file_get_configs_by_priority ();
+extern void config_file_begin_batch ();
+extern void config_file_end_batch ();
 extern struct t_config_section *config_file_new_section (struct t_config_file *config_file,
                                                          const char *name,
                                                          int user_can_add_options,
@@ -285,6 +294,7 @@ extern void config_file_search_with_string (const char *option_name,
                                             struct t_config_section **section,
                                             struct t_config_option **option,
                                             char **pos_option_name);
+extern const char **config_file_get_options_sorted (int *count);
 extern int config_file_string_to_boolean (const char *text);
 extern int config_file_option_reset (struct t_config_option *option,
                                      int run_callback);
@@ -43,6 +43,7 @@
 #include "core-hook.h"
 #include "core-log.h"
 #include "core-network.h"
+#include "core-parallel.h"
 #include "core-utf8.h"
 #include "core-list.h"
 #include "core-proxy.h"
@@ -62,6 +63,7 @@
 #include "../gui/gui-line.h"
 #include "../gui/gui-main.h"
 #include "../gui/gui-mouse.h"
+#include "../gui/gui-nick.h"
 #include "../gui/gui-nicklist.h"
 #include "../gui/gui-window.h"
 #include "../plugins/plugin.h"
@@ -141,6 +143,7 @@ struct t_config_option *config_look_day_change_message_1date = NULL;
 struct t_config_option *config_look_day_change_message_2dates = NULL;
 struct t_config_option *config_look_eat_newline_glitch = NULL;
 struct t_config_option *config_look_emphasized_attributes = NULL;
+struct t_config_option *config_look_filter_chunk_size = NULL;
 struct t_config_option *config_look_highlight = NULL;
 struct t_config_option *config_look_highlight_disable_regex = NULL;
 struct t_config_option *config_look_highlight_prefix = NULL;
@@ -176,6 +179,7 @@ struct t_config_option *config_look_jump_previous_buffer_when_closing = NULL;
 struct t_config_option *config_look_jump_smart_back_to_buffer = NULL;
 struct t_config_option *config_look_key_bind_safe = NULL;
 struct t_config_option *config_look_key_grab_delay = NULL;
+struct t_config_option *config_look_max_fps = NULL;
 struct t_config_option *config_look_mouse = NULL;
 struct t_config_option *config_look_nick_color_force = NULL;
 struct t_config_option *config_look_nick_color_hash = NULL;
@@ -211,6 +215,7 @@ struct t_config_option *config_look_read_marker_update_on_buffer_switch = NULL;
 struct t_config_option *config_look_save_config_on_exit = NULL;
 struct t_config_option *config_look_save_config_with_fsync = NULL;
 struct t_config_option *config_look_save_layout_on_exit = NULL;
+struct t_config_option *config_look_scan_threads = NULL;
 struct t_config_option *config_look_scroll_amount = NULL;
 struct t_config_option *config_look_scroll_bottom_after_switch = NULL;
 struct t_config_option *config_look_scroll_page_percent = NULL;
@@ -316,11 +321,15 @@ struct t_config_option *config_completion_partial_completion_templates = NULL;
 
 /* config, history section */
 
+struct t_config_option *config_history_buffer_lines_on_disk = NULL;
 struct t_config_option *config_history_display_default = NULL;
+struct t_config_option *config_history_file = NULL;
 struct t_config_option *config_history_max_buffer_lines_minutes = NULL;
 struct t_config_option *config_history_max_buffer_lines_number = NULL;
+struct t_config_option *config_history_max_buffer_lines_uncompressed = NULL;
 struct t_config_option *config_history_max_commands = NULL;
 struct t_config_option *config_history_max_visited_buffers = NULL;
+struct t_config_option *config_history_remove_duplicates = NULL;
 
 /* config, network section */
 
@@ -797,6 +806,8 @@ config_set_nick_colors ()
         | WEECHAT_STRING_SPLIT_STRIP_RIGHT
         | WEECHAT_STRING_SPLIT_COLLAPSE_SEPS,
         0, &config_num_nick_colors);
+
+    gui_nick_color_cache_clear ();
 }
 
 /*
@@ -851,6 +862,26 @@ config_change_look_nick_color_force (const void *pointer, void *data,
         }
         string_free_split (items);
     }
+
+    gui_nick_color_cache_clear ();
+}
+
+/*
+ * Callback for changes on options "weechat.look.nick_color_hash",
+ * "weechat.look.nick_color_hash_salt" and
+ * "weechat.look.nick_color_stop_chars".
+ */
+
+void
+config_change_look_nick_color (const void *pointer, void *data,
+                               struct t_config_option *option)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) option;
+
+    gui_nick_color_cache_clear ();
 }
 
 /*
@@ -1013,7 +1044,7 @@ config_change_highlight_disable_regex (const void *pointer, void *data,
 
     if (config_highlight_disable_regex)
     {
-        regfree (config_highlight_disable_regex);
+        string_regfree (config_highlight_disable_regex);
         free (config_highlight_disable_regex);
         config_highlight_disable_regex = NULL;
     }
@@ -1050,7 +1081,7 @@ config_change_highlight_regex (const void *pointer, void *data,
 
     if (config_highlight_regex)
     {
-        regfree (config_highlight_regex);
+        string_regfree (config_highlight_regex);
         free (config_highlight_regex);
         config_highlight_regex = NULL;
     }
@@ -1131,6 +1162,9 @@ config_change_hotlist_sort (const void *pointer, void *data,
         0,
         &config_num_hotlist_sort_fields);
 
+    gui_hotlist_set_sort_fields (config_hotlist_sort_fields,
+                                 config_num_hotlist_sort_fields);
+
     gui_hotlist_resort ();
 }
 
@@ -3584,6 +3618,18 @@ config_weechat_init_options ()
             NULL, NULL, NULL,
             &config_change_emphasized_attributes, NULL, NULL,
             NULL, NULL, NULL);
+        config_look_filter_chunk_size = config_file_new_option (
+            weechat_config_file, weechat_config_section_look,
+            "filter_chunk_size", "integer",
+            N_("max number of lines filtered at once in a buffer when filters "
+               "are changed: lines of bigger buffers are filtered in "
+               "background by chunks of this size, starting with the last "
+               "line, so that WeeChat does not freeze; 0 = filter all lines "
+               "at once"),
+            NULL, 0, INT_MAX, "10000", NULL, 0,
+            NULL, NULL, NULL,
+            NULL, NULL, NULL,
+            NULL, NULL, NULL);
         config_look_highlight = config_file_new_option (
             weechat_config_file, weechat_config_section_look,
             "highlight", "string",
@@ -3905,6 +3951,16 @@ config_weechat_init_options ()
                "(see /help input)"),
             NULL, 1, 10000, "800", NULL, 0,
             NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+        config_look_max_fps = config_file_new_option (
+            weechat_config_file, weechat_config_section_look,
+            "max_fps", "integer",
+            N_("max number of screen refreshes per second: changes in "
+               "buffers and bars are drawn together at most this number of "
+               "times per second, which reduces CPU usage when many "
+               "messages are received; the screen is always refreshed "
+               "immediately after a key is pressed (0 = no limit)"),
+            NULL, 0, 1000, "60", NULL, 0,
+            NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
         config_look_mouse = config_file_new_option (
             weechat_config_file, weechat_config_section_look,
             "mouse", "boolean",
@@ -3935,7 +3991,9 @@ config_weechat_init_options ()
                "of 64-bit integer, sum = sum of letters, sum_32 = sum of letters "
                "using 32-bit instead of 64-bit integer"),
             "djb2|sum|djb2_32|sum_32", 0, 0, "djb2", NULL, 0,
-            NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+            NULL, NULL, NULL,
+            &config_change_look_nick_color, NULL, NULL,
+            NULL, NULL, NULL);
         config_look_nick_color_hash_salt = config_file_new_option (
             weechat_config_file, weechat_config_section_look,
             "nick_color_hash_salt", "string",
@@ -3943,7 +4001,9 @@ config_weechat_init_options ()
                "(the nickname is appended to this salt and the hash algorithm "
                "operates on this string); modifying this shuffles nick colors"),
             NULL, 0, 0, "", NULL, 0,
-            NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+            NULL, NULL, NULL,
+            &config_change_look_nick_color, NULL, NULL,
+            NULL, NULL, NULL);
         config_look_nick_color_stop_chars = config_file_new_option (
             weechat_config_file, weechat_config_section_look,
             "nick_color_stop_chars", "string",
@@ -3956,7 +4016,7 @@ config_weechat_init_options ()
                "this option"),
             NULL, 0, 0, "_|[", NULL, 0,
             NULL, NULL, NULL,
-            NULL, NULL, NULL,
+            &config_change_look_nick_color, NULL, NULL,
             NULL, NULL, NULL);
         config_look_nick_prefix = config_file_new_option (
             weechat_config_file, weechat_config_section_look,
@@ -4246,6 +4306,18 @@ config_weechat_init_options ()
             NULL, NULL, NULL,
             &config_change_save_layout_on_exit, NULL, NULL,
             NULL, NULL, NULL);
+        config_look_scan_threads = config_file_new_option (
+            weechat_config_file, weechat_config_section_look,
+            "scan_threads", "integer",
+            N_("max number of threads used to scan lines of buffers (when "
+               "filters are changed, for text search in buffers and for "
+               "command /search): lines are split between threads only if "
+               "there are many lines to scan; 1 = scan all lines in main "
+               "thread"),
+            NULL, 1, PARALLEL_MAX_THREADS, "4", NULL, 0,
+            NULL, NULL, NULL,
+            NULL, NULL, NULL,
+            NULL, NULL, NULL);
         config_look_scroll_amount = config_file_new_option (
             weechat_config_file, weechat_config_section_look,
             "scroll_amount", "integer",
@@ -5134,6 +5206,22 @@ config_weechat_init_options ()
         NULL, NULL, NULL);
     if (weechat_config_section_history)
     {
+        config_history_buffer_lines_on_disk = config_file_new_option (
+            weechat_config_file, weechat_config_section_history,
+            "buffer_lines_on_disk", "boolean",
+            N_("save oldest blocks of compressed lines in files on disk "
+               "(directory \"${weechat_cache_dir}/lines\") instead of "
+               "removing them according to options "
+               "weechat.history.max_buffer_lines_number and "
+               "weechat.history.max_buffer_lines_minutes: these options "
+               "then limit the number of lines kept in memory and the "
+               "scrollback of buffers is unlimited; lines are read again "
+               "from disk when they are needed (scroll, search, relay "
+               "clients) and files are kept on /upgrade; this option requires "
+               "compression of lines (see option "
+               "weechat.history.max_buffer_lines_uncompressed)"),
+            NULL, 0, 0, "off", NULL, 0,
+            NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
         config_history_display_default = config_file_new_option (
             weechat_config_file, weechat_config_section_history,
             "display_default", "integer",
@@ -5141,6 +5229,19 @@ config_weechat_init_options ()
                "history listing (0 = unlimited)"),
             NULL, 0, INT_MAX, "5", NULL, 0,
             NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+        config_history_file = config_file_new_option (
+            weechat_config_file, weechat_config_section_history,
+            "file", "string",
+            N_("path to file where global history of commands is saved "
+               "(path is evaluated, see function string_eval_path_home in "
+               "plugin API reference); the file is read on startup and new "
+               "entries are appended to it, one second after they are added; "
+               "if empty, history is not saved; WARNING: commands are saved "
+               "as-is, including passwords: you can exclude some commands "
+               "with the modifier \"history_add\" "
+               "(example: \"${weechat_state_dir}/history\")"),
+            NULL, 0, 0, "", NULL, 0,
+            NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
         config_history_max_buffer_lines_minutes = config_file_new_option (
             weechat_config_file, weechat_config_section_history,
             "max_buffer_lines_minutes", "integer",
@@ -5158,6 +5259,19 @@ config_weechat_init_options ()
                "weechat.history.max_buffer_lines_minutes is NOT set to 0"),
             NULL, 0, INT_MAX, "4096", NULL, 0,
             NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+        config_history_max_buffer_lines_uncompressed = config_file_new_option (
+            weechat_config_file, weechat_config_section_history,
+            "max_buffer_lines_uncompressed", "integer",
+            N_("number of most recent lines kept uncompressed in memory per "
+               "buffer (0 = never compress lines); older lines are compressed "
+               "by blocks of 1024 lines and uncompressed when they are "
+               "needed (scroll, search, relay clients); the number of lines "
+               "in a buffer can then exceed the option "
+               "weechat.history.max_buffer_lines_number by at most one "
+               "block; merged buffers are never compressed; this option "
+               "requires WeeChat compiled with zstd"),
+            NULL, 0, INT_MAX, "0", NULL, 0,
+            NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
         config_history_max_commands = config_file_new_option (
             weechat_config_file, weechat_config_section_history,
             "max_commands", "integer",
@@ -5171,6 +5285,15 @@ config_weechat_init_options ()
             N_("maximum number of visited buffers to keep in memory"),
             NULL, 0, 1000, "50", NULL, 0,
             NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+        config_history_remove_duplicates = config_file_new_option (
+            weechat_config_file, weechat_config_section_history,
+            "remove_duplicates", "boolean",
+            N_("remove duplicates in history: when a command already in "
+               "history is added again, the old entry is removed and the "
+               "command becomes the most recent entry (if disabled, only "
+               "a command identical to the last one is not added)"),
+            NULL, 0, 0, "off", NULL, 0,
+            NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
     }
 
     /* proxies */
@@ -5528,14 +5651,14 @@ config_weechat_free ()
 
     if (config_highlight_disable_regex)
     {
-        regfree (config_highlight_disable_regex);
+        string_regfree (config_highlight_disable_regex);
         free (config_highlight_disable_regex);
         config_highlight_disable_regex = NULL;
     }
 
     if (config_highlight_regex)
     {
-        regfree (config_highlight_regex);
+        string_regfree (config_highlight_regex);
         free (config_highlight_regex);
         config_highlight_regex = NULL;
     }
@@ -5612,4 +5735,5 @@ config_weechat_free ()
         config_hotlist_sort_fields = NULL;
         config_num_hotlist_sort_fields = 0;
     }
+    gui_hotlist_set_sort_fields (NULL, 0);
 }
@@ -198,6 +198,7 @@ extern struct t_config_option *config_look_day_change_message_1date;
 extern struct t_config_option *config_look_day_change_message_2dates;
 extern struct t_config_option *config_look_eat_newline_glitch;
 extern struct t_config_option *config_look_emphasized_attributes;
+extern struct t_config_option *config_look_filter_chunk_size;
 extern struct t_config_option *config_look_highlight;
 extern struct t_config_option *config_look_highlight_disable_regex;
 extern struct t_config_option *config_look_highlight_prefix;
@@ -233,6 +234,7 @@ extern struct t_config_option *config_look_jump_previous_buffer_when_closing;
 extern struct t_config_option *config_look_jump_smart_back_to_buffer;
 extern struct t_config_option *config_look_key_bind_safe;
 extern struct t_config_option *config_look_key_grab_delay;
+extern struct t_config_option *config_look_max_fps;
 extern struct t_config_option *config_look_mouse;
 extern struct t_config_option *config_look_nick_color_force;
 extern struct t_config_option *config_look_nick_color_hash;
@@ -267,6 +269,7 @@ extern struct t_config_option *config_look_read_marker_update_on_buffer_switch;
 extern struct t_config_option *config_look_save_config_on_exit;
 extern struct t_config_option *config_look_save_config_with_fsync;
 extern struct t_config_option *config_look_save_layout_on_exit;
+extern struct t_config_option *config_look_scan_threads;
 extern struct t_config_option *config_look_scroll_amount;
 extern struct t_config_option *config_look_scroll_bottom_after_switch;
 extern struct t_config_option *config_look_scroll_page_percent;
@@ -363,11 +366,15 @@ extern struct t_config_option *config_completion_partial_completion_count;
 extern struct t_config_option *config_completion_partial_completion_other;
 extern struct t_config_option *config_completion_partial_completion_templates;
 
+extern struct t_config_option *config_history_buffer_lines_on_disk;
 extern struct t_config_option *config_history_display_default;
+extern struct t_config_option *config_history_file;
 extern struct t_config_option *config_history_max_buffer_lines_minutes;
 extern struct t_config_option *config_history_max_buffer_lines_number;
+extern struct t_config_option *config_history_max_buffer_lines_uncompressed;
 extern struct t_config_option *config_history_max_commands;
 extern struct t_config_option *config_history_max_visited_buffers;
+extern struct t_config_option *config_history_remove_duplicates;
 
 extern struct t_config_option *config_network_connection_timeout;
 extern struct t_config_option *config_network_gnutls_ca_system;
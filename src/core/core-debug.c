@@ -65,6 +65,7 @@
 #include "../gui/gui-hotlist.h"
 #include "../gui/gui-key.h"
 #include "../gui/gui-layout.h"
+#include "../gui/gui-line.h"
 #include "../gui/gui-main.h"
 #include "../gui/gui-window.h"
 #include "../plugins/plugin.h"
@@ -160,6 +161,9 @@ debug_dump_cb (const void *pointer, void *data,
 void
 debug_sigsegv_cb ()
 {
+    /* write crash dump immediately in log file */
+    log_set_flush_delayed (0);
+
     debug_dump (1);
     unhook_all ();
     gui_main_end (0);
@@ -327,6 +331,108 @@ debug_memory ()
 #endif /* HAVE_MALLINFO2 */
 }
 
+/*
+ * Displays memory used by buffers and total by plugin (lines, compressed
+ * lines, lines saved on disk, nicklist and local variables).
+ */
+
+void
+debug_memory_buffers ()
+{
+    struct t_gui_buffer *ptr_buffer;
+    struct t_weechat_plugin *ptr_plugin;
+    char *str_lines, *str_compressed, *str_disk, *str_nicklist;
+    char *str_local_vars, *str_memory;
+    long long memory, disk, total_memory, total_disk;
+    int buffers;
+
+    gui_chat_printf (NULL, "");
+    gui_chat_printf (NULL, _("Memory used by buffers:"));
+    for (ptr_buffer = gui_buffers; ptr_buffer;
+         ptr_buffer = ptr_buffer->next_buffer)
+    {
+        str_lines = string_format_size (
+            ptr_buffer->own_lines->lines_size);
+        str_compressed = string_format_size (
+            ptr_buffer->own_lines->lines_compressed_size);
+        str_disk = string_format_size (
+            ptr_buffer->own_lines->segment_size);
+        str_nicklist = string_format_size (ptr_buffer->nicklist_size);
+        str_local_vars = string_format_size (ptr_buffer->local_variables_size);
+        gui_chat_printf (NULL,
+                         _("  %d. %s: lines: %d (%s), compressed: %d (%s), "
+                           "on disk: %d (%s), nicklist: %d (%s), "
+                           "local variables: %s"),
+                         ptr_buffer->number,
+                         ptr_buffer->full_name,
+                         ptr_buffer->own_lines->lines_count,
+                         (str_lines) ? str_lines : "?",
+                         ptr_buffer->own_lines->lines_compressed_count,
+                         (str_compressed) ? str_compressed : "?",
+                         ptr_buffer->own_lines->lines_segment_count,
+                         (str_disk) ? str_disk : "?",
+                         ptr_buffer->nicklist_count,
+                         (str_nicklist) ? str_nicklist : "?",
+                         (str_local_vars) ? str_local_vars : "?");
+        free (str_lines);
+        free (str_compressed);
+        free (str_disk);
+        free (str_nicklist);
+        free (str_local_vars);
+    }
+
+    gui_chat_printf (NULL, "");
+    gui_chat_printf (NULL, _("Memory used by buffers of plugins:"));
+    total_memory = 0;
+    total_disk = 0;
+    ptr_plugin = NULL;
+    while (1)
+    {
+        buffers = 0;
+        memory = 0;
+        disk = 0;
+        for (ptr_buffer = gui_buffers; ptr_buffer;
+             ptr_buffer = ptr_buffer->next_buffer)
+        {
+            if (ptr_buffer->plugin == ptr_plugin)
+            {
+                buffers++;
+                memory += gui_buffer_get_memory_size (ptr_buffer);
+                disk += ptr_buffer->own_lines->segment_size;
+            }
+        }
+        if (buffers > 0)
+        {
+            str_memory = string_format_size (memory);
+            str_disk = string_format_size (disk);
+            gui_chat_printf (NULL,
+                             NG_("  %s: %d buffer, memory: %s, on disk: %s",
+                                 "  %s: %d buffers, memory: %s, on disk: %s",
+                                 buffers),
+                             plugin_get_name (ptr_plugin),
+                             buffers,
+                             (str_memory) ? str_memory : "?",
+                             (str_disk) ? str_disk : "?");
+            free (str_memory);
+            free (str_disk);
+        }
+        total_memory += memory;
+        total_disk += disk;
+        ptr_plugin = (ptr_plugin) ? ptr_plugin->next_plugin : weechat_plugins;
+        if (!ptr_plugin)
+            break;
+    }
+
+    str_memory = string_format_size (total_memory);
+    str_disk = string_format_size (total_disk);
+    gui_chat_printf (NULL,
+                     _("  total: memory: %s, on disk: %s"),
+                     (str_memory) ? str_memory : "?",
+                     (str_disk) ? str_disk : "?");
+    free (str_memory);
+    free (str_disk);
+}
+
 /*
  * Callback called for each variable in hdata.
  */
@@ -616,7 +722,7 @@ debug_infolists ()
                         switch (ptr_var->type)
                         {
                             case INFOLIST_INTEGER:
-                                size_data += sizeof (int);
+                                /* value stored in var */
                                 break;
                             case INFOLIST_STRING:
                                 size_data += strlen ((char *)(ptr_var->value));
@@ -628,7 +734,7 @@ debug_infolists ()
                                 size_data += ptr_var->size;
                                 break;
                             case INFOLIST_TIME:
-                                size_data += sizeof (time_t);
+                                /* value stored in var */
                                 break;
                             case INFOLIST_NUM_TYPES:
                                 break;
@@ -29,6 +29,7 @@ extern long long debug_long_callbacks;
 extern void debug_sigsegv_cb ();
 extern void debug_windows_tree ();
 extern void debug_memory ();
+extern void debug_memory_buffers ();
 extern void debug_hdata ();
 extern void debug_hooks ();
 extern void debug_hooks_plugin (const char *plugin_name);
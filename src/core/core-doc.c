@@ -87,7 +87,7 @@ doc_gen_escape_anchor_link (const char *message)
     free (string_escaped[index_string_escaped]);
     string_escaped[index_string_escaped] = string_replace_regex (
         message, &regex, "-", '$', NULL, NULL);
-    regfree (&regex);
+    string_regfree (&regex);
     return string_escaped[index_string_escaped];
 }
 
@@ -65,6 +65,11 @@
     }
 
 
+struct t_hashtable *eval_compiled = NULL;     /* compiled expressions      */
+struct t_eval_compiled *eval_compiled_list = NULL; /* most recently used    */
+struct t_eval_compiled *last_eval_compiled = NULL; /* least recently used   */
+int eval_compiled_count = 0;                  /* number of compiled expr.  */
+
 char *eval_logical_ops[EVAL_NUM_LOGICAL_OPS] =
 { "||", "&&" };
 
@@ -91,6 +96,8 @@ char *eval_replace_vars (const char *expr,
                          struct t_eval_context *eval_context);
 char *eval_expression_condition (const char *expr,
                                  struct t_eval_context *eval_context);
+char *eval_expression_condition_raw (const char *expr,
+                                     struct t_eval_context *eval_context);
 
 
 /*
@@ -505,17 +512,16 @@ eval_string_repeat (const char *text)
 char *
 eval_string_split (const char *text)
 {
-    char *pos, *pos2, *pos3, *str_number, *separators, **items, *value, *error;
-    char str_value[32], *str_flags, **list_flags, *strip_items;
-    int i, num_items, count_items, random_item, flags;
+    struct t_string_split_cursor cursor;
+    const char *pos, *pos2, *pos3, *ptr_flag, *ptr_item;
+    char *separators, *value, *error, str_value[32], *str_flags, *strip_items;
+    char *item;
+    int num_items, count_items, random_item, flags, length_flag, length_item;
     long number, max_items;
 
-    str_number = NULL;
     separators = NULL;
-    items = NULL;
     value = NULL;
     str_flags = NULL;
-    list_flags = NULL;
     strip_items = NULL;
     count_items = 0;
     random_item = 0;
@@ -530,20 +536,19 @@ eval_string_split (const char *text)
         goto end;
 
     number = 0;
-    str_number = string_strndup (text, pos - text);
-    if (strcmp (str_number, "count") == 0)
+    if ((pos - text == 5) && (strncmp (text, "count", 5) == 0))
     {
         count_items = 1;
     }
-    else if (strcmp (str_number, "random") == 0)
+    else if ((pos - text == 6) && (strncmp (text, "random", 6) == 0))
     {
         random_item = 1;
     }
     else
     {
         error = NULL;
-        number = strtol (str_number, &error, 10);
-        if (!error || error[0] || (number == 0))
+        number = strtol (text, &error, 10);
+        if (!error || (error != pos) || (number == 0))
             goto end;
     }
 
@@ -561,38 +566,39 @@ eval_string_split (const char *text)
     if (!pos3)
         goto end;
     str_flags = string_strndup (pos2, pos3 - pos2);
-    list_flags = string_split (str_flags, "+", NULL, 0, 0, NULL);
-    if (list_flags)
-    {
-        for (i = 0; list_flags[i]; i++)
-        {
-            if (strcmp (list_flags[i], "strip_left") == 0)
-                flags |= WEECHAT_STRING_SPLIT_STRIP_LEFT;
-            else if (strcmp (list_flags[i], "strip_right") == 0)
-                flags |= WEECHAT_STRING_SPLIT_STRIP_RIGHT;
-            else if (strcmp (list_flags[i], "collapse_seps") == 0)
-                flags |= WEECHAT_STRING_SPLIT_COLLAPSE_SEPS;
-            else if (strcmp (list_flags[i], "keep_eol") == 0)
-                flags |= WEECHAT_STRING_SPLIT_KEEP_EOL;
-            else if (strncmp (list_flags[i], "strip_items=", 12) == 0)
-            {
-                free (strip_items);
-                strip_items = strdup (list_flags[i] + 12);
-            }
-            else if (strncmp (list_flags[i], "max_items=", 10) == 0)
-            {
-                error = NULL;
-                max_items = strtol (list_flags[i] + 10, &error, 10);
-                if (!error || error[0] || (max_items < 0))
-                    goto end;
-            }
+    string_split_cursor_init (&cursor, str_flags, "+", 0, 0);
+    while (string_split_cursor_next (&cursor, &ptr_flag, &length_flag))
+    {
+        if ((length_flag == 10) && (strncmp (ptr_flag, "strip_left", 10) == 0))
+            flags |= WEECHAT_STRING_SPLIT_STRIP_LEFT;
+        else if ((length_flag == 11)
+                 && (strncmp (ptr_flag, "strip_right", 11) == 0))
+            flags |= WEECHAT_STRING_SPLIT_STRIP_RIGHT;
+        else if ((length_flag == 13)
+                 && (strncmp (ptr_flag, "collapse_seps", 13) == 0))
+            flags |= WEECHAT_STRING_SPLIT_COLLAPSE_SEPS;
+        else if ((length_flag == 8) && (strncmp (ptr_flag, "keep_eol", 8) == 0))
+            flags |= WEECHAT_STRING_SPLIT_KEEP_EOL;
+        else if ((length_flag >= 12)
+                 && (strncmp (ptr_flag, "strip_items=", 12) == 0))
+        {
+            free (strip_items);
+            strip_items = string_strndup (ptr_flag + 12, length_flag - 12);
+        }
+        else if ((length_flag >= 10)
+                 && (strncmp (ptr_flag, "max_items=", 10) == 0))
+        {
+            error = NULL;
+            max_items = strtol (ptr_flag + 10, &error, 10);
+            if (!error || (error != ptr_flag + length_flag) || (max_items < 0))
+                goto end;
         }
     }
 
     pos3++;
 
-    items = string_split (pos3, separators, strip_items, flags,
-                          max_items, &num_items);
+    /* items are not allocated, only the item returned is duplicated */
+    num_items = string_split_count (pos3, separators, flags, max_items);
 
     /* if "count" was asked, return the number of items found after split */
     if (count_items)
@@ -602,7 +608,7 @@ eval_string_split (const char *text)
         goto end;
     }
 
-    if (!items || (num_items < 1))
+    if (num_items < 1)
         goto end;
 
     /* if "random" was asked, return a random item */
@@ -620,15 +626,30 @@ eval_string_split (const char *text)
     if (number < 0)
         number = num_items + number;
 
-    value = strdup (items[number]);
+    string_split_cursor_init (&cursor, pos3, separators, flags, max_items);
+    while (string_split_cursor_next (&cursor, &ptr_item, &length_item))
+    {
+        if (number == 0)
+        {
+            item = string_strndup (ptr_item, length_item);
+            if (item && strip_items && strip_items[0])
+            {
+                value = string_strip (item, 1, 1, strip_items);
+                free (item);
+            }
+            else
+            {
+                value = item;
+            }
+            break;
+        }
+        number--;
+    }
 
 end:
-    free (str_number);
     free (separators);
     free (str_flags);
-    string_free_split (list_flags);
     free (strip_items);
-    string_free_split (items);
     return (value) ? value : strdup ("");
 }
 
@@ -2119,6 +2140,9 @@ eval_replace_vars (const char *expr, struct t_eval_context *eval_context)
 /*
  * Compares two expressions.
  *
+ * For a regex comparison, if "regex" is not NULL, it is used instead of
+ * compiling expr2.
+ *
  * Returns:
  *   "1": comparison is true
  *   "0": comparison is false
@@ -2132,7 +2156,7 @@ eval_replace_vars (const char *expr, struct t_eval_context *eval_context)
 
 char *
 eval_compare (const char *expr1, int comparison, const char *expr2,
-              struct t_eval_context *eval_context)
+              regex_t *regex_compiled, struct t_eval_context *eval_context)
 {
     int rc, string_compare, length1, length2, debug_id;
     regex_t regex;
@@ -2151,13 +2175,20 @@ eval_compare (const char *expr1, int comparison, const char *expr2,
     if ((comparison == EVAL_COMPARE_REGEX_MATCHING)
         || (comparison == EVAL_COMPARE_REGEX_NOT_MATCHING))
     {
-        if (string_regcomp (&regex, expr2,
-                            REG_EXTENDED | REG_ICASE | REG_NOSUB) != 0)
+        if (regex_compiled)
         {
-            goto end;
+            rc = (string_regexec (regex_compiled, expr1, 0, NULL, 0) == 0) ? 1 : 0;
+        }
+        else
+        {
+            if (string_regcomp (&regex, expr2,
+                                REG_EXTENDED | REG_ICASE | REG_NOSUB) != 0)
+            {
+                goto end;
+            }
+            rc = (string_regexec (&regex, expr1, 0, NULL, 0) == 0) ? 1 : 0;
+            string_regfree (&regex);
         }
-        rc = (regexec (&regex, expr1, 0, NULL, 0) == 0) ? 1 : 0;
-        regfree (&regex);
         if (comparison == EVAL_COMPARE_REGEX_NOT_MATCHING)
             rc ^= 1;
         goto end;
@@ -2260,9 +2291,445 @@ end:
     return value;
 }
 
+/*
+ * Frees a compiled expression node (and its sub-nodes).
+ */
+
+void
+eval_node_free (struct t_eval_node *node)
+{
+    if (!node)
+        return;
+
+    free (node->text);
+    if (node->regex)
+    {
+        string_regfree (node->regex);
+        free (node->regex);
+    }
+    eval_node_free (node->left);
+    eval_node_free (node->right);
+
+    free (node);
+}
+
+/*
+ * Creates a new compiled expression node.
+ *
+ * Returns pointer to new node, NULL if error.
+ */
+
+struct t_eval_node *
+eval_node_new (enum t_eval_node_type type, int op, const char *text,
+               int length_text, struct t_eval_context *eval_context)
+{
+    struct t_eval_node *new_node;
+
+    new_node = malloc (sizeof (*new_node));
+    if (!new_node)
+        return NULL;
+
+    new_node->type = type;
+    new_node->op = op;
+    new_node->text = NULL;
+    new_node->constant = 0;
+    new_node->regex = NULL;
+    new_node->left = NULL;
+    new_node->right = NULL;
+
+    if (text)
+    {
+        new_node->text = (length_text >= 0) ?
+            string_strndup (text, length_text) : strdup (text);
+        if (!new_node->text)
+        {
+            free (new_node);
+            return NULL;
+        }
+        /* no prefix char: variables are not replaced (no variable/escape) */
+        new_node->constant = (strchr (new_node->text,
+                                      eval_context->prefix[0]) == NULL);
+    }
+
+    return new_node;
+}
+
+/*
+ * Compiles a condition: the expression is split into sub-expressions,
+ * the same way as function eval_expression_condition_raw does it, but
+ * without evaluating anything (the evaluation is done later by function
+ * eval_node_evaluate, for each call with different variables).
+ *
+ * Returns pointer to compiled expression, NULL if error.
+ */
+
+struct t_eval_node *
+eval_compile_condition (const char *expr, struct t_eval_context *eval_context)
+{
+    struct t_eval_node *node;
+    int logic, comp, length, level;
+    const char *pos, *pos_end;
+    char *expr2;
+
+    node = NULL;
+
+    /* skip spaces at beginning of string */
+    while (expr[0] == ' ')
+    {
+        expr++;
+    }
+    if (!expr[0])
+        return eval_node_new (EVAL_NODE_VALUE, 0, expr, -1, eval_context);
+
+    /* skip spaces at end of string */
+    pos_end = expr + strlen (expr) - 1;
+    while ((pos_end > expr) && (pos_end[0] == ' '))
+    {
+        pos_end--;
+    }
+
+    expr2 = string_strndup (expr, pos_end + 1 - expr);
+    if (!expr2)
+        return NULL;
+
+    /* search for a logical operator */
+    for (logic = 0; logic < EVAL_NUM_LOGICAL_OPS; logic++)
+    {
+        pos = eval_strstr_level (expr2, eval_logical_ops[logic], eval_context,
+                                 "(", ")", 0);
+        if (pos > expr2)
+        {
+            node = eval_node_new (EVAL_NODE_LOGICAL_OP, logic, NULL, 0,
+                                  eval_context);
+            if (!node)
+                goto end;
+            length = pos - expr2;
+            while ((length > 0) && (expr2[length - 1] == ' '))
+            {
+                length--;
+            }
+            expr2[length] = '\0';
+            node->left = eval_compile_condition (expr2, eval_context);
+            pos += strlen (eval_logical_ops[logic]);
+            while (pos[0] == ' ')
+            {
+                pos++;
+            }
+            node->right = eval_compile_condition (pos, eval_context);
+            goto end;
+        }
+    }
+
+    /* search for a comparison */
+    for (comp = 0; comp < EVAL_NUM_COMPARISONS; comp++)
+    {
+        pos = eval_strstr_level (expr2, eval_comparisons[comp], eval_context,
+                                 "(", ")", 0);
+        if (pos >= expr2)
+        {
+            node = eval_node_new (EVAL_NODE_COMPARISON, comp, NULL, 0,
+                                  eval_context);
+            if (!node)
+                goto end;
+            length = pos - expr2;
+            while ((length > 0) && (expr2[length - 1] == ' '))
+            {
+                length--;
+            }
+            pos += strlen (eval_comparisons[comp]);
+            while (pos[0] == ' ')
+            {
+                pos++;
+            }
+            if ((comp == EVAL_COMPARE_REGEX_MATCHING)
+                || (comp == EVAL_COMPARE_REGEX_NOT_MATCHING))
+            {
+                /* for regex: just replace vars in both expressions */
+                node->left = eval_node_new (EVAL_NODE_VARS, 0,
+                                            expr2, length, eval_context);
+                node->right = eval_node_new (EVAL_NODE_VARS, 0, pos, -1,
+                                             eval_context);
+                /* constant regex: compile it now */
+                if (node->right && node->right->constant)
+                {
+                    node->regex = malloc (sizeof (*node->regex));
+                    if (node->regex
+                        && (string_regcomp (node->regex, node->right->text,
+                                            REG_EXTENDED | REG_ICASE
+                                            | REG_NOSUB) != 0))
+                    {
+                        free (node->regex);
+                        node->regex = NULL;
+                    }
+                }
+            }
+            else
+            {
+                /* other comparison: fully evaluate both expressions */
+                expr2[length] = '\0';
+                node->left = eval_compile_condition (expr2, eval_context);
+                node->right = eval_compile_condition (pos, eval_context);
+            }
+            goto end;
+        }
+    }
+
+    /* sub-expression between parentheses */
+    if (expr2[0] == '(')
+    {
+        level = 0;
+        pos = expr2 + 1;
+        while (pos[0])
+        {
+            if (pos[0] == '(')
+                level++;
+            else if (pos[0] == ')')
+            {
+                if (level == 0)
+                    break;
+                level--;
+            }
+            pos++;
+        }
+        if ((pos[0] == ')') && !pos[1])
+        {
+            node = eval_node_new (EVAL_NODE_PARENTHESES, 0, NULL, 0,
+                                  eval_context);
+            if (!node)
+                goto end;
+            expr2[pos - expr2] = '\0';
+            node->left = eval_compile_condition (expr2 + 1, eval_context);
+        }
+        else
+        {
+            /*
+             * something after parentheses (or closing parenthesis missing):
+             * the result depends on the value of sub-expression, so this
+             * expression can not be compiled
+             */
+            node = eval_node_new (EVAL_NODE_EXPRESSION, 0, expr2, -1,
+                                  eval_context);
+        }
+        goto end;
+    }
+
+    /* no logical operator neither comparison: just replace variables */
+    node = eval_node_new (EVAL_NODE_VARS, 0, expr2, -1, eval_context);
+
+end:
+    free (expr2);
+
+    /* error on a sub-expression */
+    if (node
+        && (((node->type == EVAL_NODE_LOGICAL_OP)
+             || (node->type == EVAL_NODE_COMPARISON))
+            && (!node->left || !node->right)))
+    {
+        eval_node_free (node);
+        node = NULL;
+    }
+    if (node && (node->type == EVAL_NODE_PARENTHESES) && !node->left)
+    {
+        eval_node_free (node);
+        node = NULL;
+    }
+
+    return node;
+}
+
+/*
+ * Evaluates a compiled condition.
+ *
+ * Note: result must be freed after use (if not NULL).
+ */
+
+char *
+eval_node_evaluate (struct t_eval_node *node,
+                    struct t_eval_context *eval_context)
+{
+    char *value, *tmp_value, *tmp_value2;
+    int rc;
+
+    switch (node->type)
+    {
+        case EVAL_NODE_VALUE:
+            return strdup (node->text);
+        case EVAL_NODE_VARS:
+            if (node->constant
+                && (eval_context->recursion_count + 1 < EVAL_RECURSION_MAX))
+            {
+                return strdup (node->text);
+            }
+            return eval_replace_vars (node->text, eval_context);
+        case EVAL_NODE_LOGICAL_OP:
+            tmp_value = eval_node_evaluate (node->left, eval_context);
+            rc = eval_is_true (tmp_value);
+            free (tmp_value);
+            /*
+             * if rc == 0 with "&&" or rc == 1 with "||", no need to
+             * evaluate second sub-expression, just return the rc
+             */
+            if ((rc && (node->op == EVAL_LOGICAL_OP_AND))
+                || (!rc && (node->op == EVAL_LOGICAL_OP_OR)))
+            {
+                tmp_value = eval_node_evaluate (node->right, eval_context);
+                rc = eval_is_true (tmp_value);
+                free (tmp_value);
+            }
+            return strdup ((rc) ? EVAL_STR_TRUE : EVAL_STR_FALSE);
+        case EVAL_NODE_COMPARISON:
+            tmp_value = eval_node_evaluate (node->left, eval_context);
+            tmp_value2 = eval_node_evaluate (node->right, eval_context);
+            value = eval_compare (
+                tmp_value, node->op, tmp_value2,
+                (node->regex && tmp_value2
+                 && (strcmp (tmp_value2, node->right->text) == 0)) ?
+                node->regex : NULL,
+                eval_context);
+            free (tmp_value);
+            free (tmp_value2);
+            return value;
+        case EVAL_NODE_PARENTHESES:
+            return eval_node_evaluate (node->left, eval_context);
+        case EVAL_NODE_EXPRESSION:
+            return eval_expression_condition_raw (node->text, eval_context);
+        case EVAL_NUM_NODE_TYPES:
+            break;
+    }
+
+    return NULL;
+}
+
+/*
+ * Frees a compiled expression and removes it from list.
+ */
+
+void
+eval_compiled_free (struct t_eval_compiled *compiled)
+{
+    if (compiled->prev_compiled)
+        (compiled->prev_compiled)->next_compiled = compiled->next_compiled;
+    if (compiled->next_compiled)
+        (compiled->next_compiled)->prev_compiled = compiled->prev_compiled;
+    if (eval_compiled_list == compiled)
+        eval_compiled_list = compiled->next_compiled;
+    if (last_eval_compiled == compiled)
+        last_eval_compiled = compiled->prev_compiled;
+
+    hashtable_remove (eval_compiled, compiled->expr);
+
+    free (compiled->expr);
+    eval_node_free (compiled->node);
+
+    free (compiled);
+
+    eval_compiled_count--;
+}
+
+/*
+ * Searches a compiled expression in cache, compiles and adds it in cache
+ * if not found.
+ *
+ * The compiled expression is moved at the beginning of list (most recently
+ * used), and if the cache is full, the least recently used expression is
+ * removed (expressions being evaluated are never removed).
+ *
+ * Returns pointer to compiled expression, NULL if not found and it can not
+ * be compiled or added in cache.
+ */
+
+struct t_eval_compiled *
+eval_compiled_get (const char *expr, struct t_eval_context *eval_context)
+{
+    struct t_eval_compiled *ptr_compiled;
+    struct t_eval_node *node;
+
+    if (!eval_compiled)
+    {
+        eval_compiled = hashtable_new (32,
+                                       WEECHAT_HASHTABLE_STRING,
+                                       WEECHAT_HASHTABLE_POINTER,
+                                       NULL, NULL);
+        if (!eval_compiled)
+            return NULL;
+    }
+
+    ptr_compiled = (struct t_eval_compiled *)hashtable_get (eval_compiled,
+                                                            expr);
+    if (!ptr_compiled)
+    {
+        /* cache full: remove least recently used expression */
+        if (eval_compiled_count >= EVAL_COMPILED_MAX)
+        {
+            ptr_compiled = last_eval_compiled;
+            while (ptr_compiled && (ptr_compiled->used > 0))
+            {
+                ptr_compiled = ptr_compiled->prev_compiled;
+            }
+            if (!ptr_compiled)
+                return NULL;
+            eval_compiled_free (ptr_compiled);
+        }
+
+        node = eval_compile_condition (expr, eval_context);
+        if (!node)
+            return NULL;
+
+        ptr_compiled = malloc (sizeof (*ptr_compiled));
+        if (!ptr_compiled)
+        {
+            eval_node_free (node);
+            return NULL;
+        }
+        ptr_compiled->expr = strdup (expr);
+        ptr_compiled->node = node;
+        ptr_compiled->used = 0;
+        ptr_compiled->prev_compiled = NULL;
+        ptr_compiled->next_compiled = NULL;
+        if (!ptr_compiled->expr
+            || !hashtable_set (eval_compiled, expr, ptr_compiled))
+        {
+            free (ptr_compiled->expr);
+            eval_node_free (ptr_compiled->node);
+            free (ptr_compiled);
+            return NULL;
+        }
+        eval_compiled_count++;
+    }
+    else if (ptr_compiled != eval_compiled_list)
+    {
+        /* remove expression from list (it is added again as first) */
+        (ptr_compiled->prev_compiled)->next_compiled = ptr_compiled->next_compiled;
+        if (ptr_compiled->next_compiled)
+            (ptr_compiled->next_compiled)->prev_compiled = ptr_compiled->prev_compiled;
+        else
+            last_eval_compiled = ptr_compiled->prev_compiled;
+        ptr_compiled->prev_compiled = NULL;
+        ptr_compiled->next_compiled = NULL;
+    }
+    else
+    {
+        /* already first in list */
+        return ptr_compiled;
+    }
+
+    /* add expression at the beginning of list */
+    ptr_compiled->next_compiled = eval_compiled_list;
+    if (eval_compiled_list)
+        eval_compiled_list->prev_compiled = ptr_compiled;
+    else
+        last_eval_compiled = ptr_compiled;
+    eval_compiled_list = ptr_compiled;
+
+    return ptr_compiled;
+}
+
 /*
  * Evaluates a condition (this function must not be called directly).
  *
+ * The condition is compiled on first call and the compiled form is kept in
+ * a cache (except with debug or custom prefix/suffix).
+ *
  * For return value, see function eval_expression().
  *
  * Note: result must be freed after use (if not NULL).
@@ -2271,6 +2738,40 @@ end:
 char *
 eval_expression_condition (const char *expr,
                            struct t_eval_context *eval_context)
+{
+    struct t_eval_compiled *ptr_compiled;
+    char *value;
+
+    if (expr
+        && (eval_context->debug_level == 0)
+        && (strcmp (eval_context->prefix, EVAL_DEFAULT_PREFIX) == 0)
+        && (strcmp (eval_context->suffix, EVAL_DEFAULT_SUFFIX) == 0))
+    {
+        ptr_compiled = eval_compiled_get (expr, eval_context);
+        if (ptr_compiled)
+        {
+            ptr_compiled->used++;
+            value = eval_node_evaluate (ptr_compiled->node, eval_context);
+            ptr_compiled->used--;
+            return value;
+        }
+    }
+
+    return eval_expression_condition_raw (expr, eval_context);
+}
+
+/*
+ * Evaluates a condition without compiled form (this function must not be
+ * called directly).
+ *
+ * For return value, see function eval_expression().
+ *
+ * Note: result must be freed after use (if not NULL).
+ */
+
+char *
+eval_expression_condition_raw (const char *expr,
+                               struct t_eval_context *eval_context)
 {
     int logic, comp, length, level, rc, debug_id;
     const char *pos, *pos_end;
@@ -2407,7 +2908,8 @@ eval_expression_condition (const char *expr,
                 tmp_value2 = eval_expression_condition (pos, eval_context);
             }
             free (sub_expr);
-            value = eval_compare (tmp_value, comp, tmp_value2, eval_context);
+            value = eval_compare (tmp_value, comp, tmp_value2, NULL,
+                                  eval_context);
             free (tmp_value);
             free (tmp_value2);
             goto end;
@@ -2545,7 +3047,8 @@ eval_replace_regex (const char *string, regex_t *regex, const char *replace,
             eval_regex.match[i].rm_so = -1;
         }
 
-        rc = regexec (regex, result + start_offset, 100, eval_regex.match, 0);
+        rc = string_regexec (regex, result + start_offset, 100,
+                             eval_regex.match, 0);
 
         /* no match found: exit the loop */
         if ((rc != 0) || (eval_regex.match[0].rm_so < 0))
@@ -2864,7 +3367,7 @@ eval_expression (const char *expr, struct t_hashtable *pointers,
     hashtable_free (user_vars);
     if (regex && regex_allocated)
     {
-        regfree (regex);
+        string_regfree (regex);
         free (regex);
     }
 
@@ -2877,3 +3380,417 @@ eval_expression (const char *expr, struct t_hashtable *pointers,
 
     return value;
 }
+
+/*
+ * Initializes fast path of a condition, which is used if the condition is
+ * a comparison of a variable of hdata with a constant, for example
+ * "${buffer.full_name} == irc.libera.#weechat".
+ *
+ * The variable is then read directly at its offset in the structure and
+ * compared, without evaluating the whole condition.
+ */
+
+void
+eval_cond_init_fast (struct t_eval_cond *cond)
+{
+    struct t_eval_node *node;
+    struct t_hdata_var *ptr_var;
+    struct t_config_option *ptr_option;
+    const char *ptr_text;
+    char *error;
+    int i, length_name, length;
+
+    node = cond->compiled->node;
+    if ((node->type != EVAL_NODE_COMPARISON)
+        || (node->left->type != EVAL_NODE_VARS)
+        || ((node->right->type != EVAL_NODE_VALUE)
+            && ((node->right->type != EVAL_NODE_VARS)
+                || !node->right->constant)))
+    {
+        return;
+    }
+
+    /* left expression must be exactly "${hdata.var}" */
+    ptr_text = node->left->text;
+    length_name = strlen (cond->hdata->name);
+    length = strlen (ptr_text);
+    if ((strncmp (ptr_text, EVAL_DEFAULT_PREFIX, 2) != 0)
+        || (ptr_text[length - 1] != '}')
+        || (strncmp (ptr_text + 2, cond->hdata->name, length_name) != 0)
+        || (ptr_text[2 + length_name] != '.')
+        || (2 + length_name + 1 >= length - 1))
+    {
+        return;
+    }
+    for (i = 2 + length_name + 1; i < length - 1; i++)
+    {
+        if (!((ptr_text[i] >= 'a') && (ptr_text[i] <= 'z'))
+            && !((ptr_text[i] >= 'A') && (ptr_text[i] <= 'Z'))
+            && !((ptr_text[i] >= '0') && (ptr_text[i] <= '9'))
+            && (ptr_text[i] != '_'))
+        {
+            return;
+        }
+    }
+
+    cond->fast_name = string_strndup (ptr_text + 2, length - 3);
+    if (!cond->fast_name)
+        return;
+
+    /* variables evaluated before hdata: not a fast path */
+    if ((strncmp (cond->fast_name, "date", 4) == 0)
+        || (strncmp (cond->fast_name, "sec.", 4) == 0)
+        || (cond->extra_vars
+            && hashtable_has_key (cond->extra_vars, cond->fast_name)))
+    {
+        goto error;
+    }
+    config_file_search_with_string (cond->fast_name, NULL, NULL, &ptr_option,
+                                    NULL);
+    if (ptr_option)
+        goto error;
+
+    ptr_var = hashtable_get (cond->hdata->hash_var,
+                             cond->fast_name + length_name + 1);
+    if (!ptr_var || ptr_var->array_size)
+        goto error;
+    switch (ptr_var->type)
+    {
+        case WEECHAT_HDATA_CHAR:
+        case WEECHAT_HDATA_INTEGER:
+        case WEECHAT_HDATA_LONG:
+        case WEECHAT_HDATA_LONGLONG:
+        case WEECHAT_HDATA_STRING:
+        case WEECHAT_HDATA_SHARED_STRING:
+        case WEECHAT_HDATA_POINTER:
+        case WEECHAT_HDATA_TIME:
+            break;
+        default:
+            goto error;
+    }
+
+    cond->fast_type = ptr_var->type;
+    cond->fast_offset = ptr_var->offset;
+    cond->fast_op = node->op;
+    cond->fast_value = node->right->text;
+    cond->fast_regex = node->regex;
+
+    /*
+     * if the value is not a number, the comparison "==" or "!=" is always
+     * a string comparison (see function eval_compare)
+     */
+    strtod (cond->fast_value, &error);
+    cond->fast_strcmp = (((cond->fast_op == EVAL_COMPARE_EQUAL)
+                          || (cond->fast_op == EVAL_COMPARE_NOT_EQUAL))
+                         && (!error || error[0])) ? 1 : 0;
+    return;
+
+error:
+    free (cond->fast_name);
+    cond->fast_name = NULL;
+}
+
+/*
+ * Creates a condition to evaluate many times with different pointers,
+ * for example to search an element in a list of hdata.
+ *
+ * The condition is compiled once, the context (pointers, variables and
+ * options) is created once and reused for each evaluation.
+ *
+ * If hdata is not NULL, the pointer given to eval_cond_is_true is set in
+ * pointers with the name of hdata, and if the condition is a comparison of
+ * a hdata variable with a constant, the variable is compared directly.
+ *
+ * Note: extra_vars is not duplicated and must remain valid until the
+ * condition is freed.
+ *
+ * Returns pointer to new condition, NULL if error.
+ */
+
+struct t_eval_cond *
+eval_cond_new (const char *expr, struct t_hashtable *pointers,
+               struct t_hashtable *extra_vars, struct t_hashtable *options,
+               struct t_hdata *hdata)
+{
+    struct t_eval_cond *new_cond;
+    struct t_eval_context *eval_context;
+    struct t_gui_window *window;
+    const char *ptr_value;
+    int use_compiled;
+
+    if (!expr)
+        return NULL;
+
+    new_cond = calloc (1, sizeof (*new_cond));
+    if (!new_cond)
+        return NULL;
+
+    new_cond->expr = strdup (expr);
+    new_cond->pointers = (pointers) ?
+        hashtable_dup (pointers) :
+        hashtable_new (32,
+                       WEECHAT_HASHTABLE_STRING,
+                       WEECHAT_HASHTABLE_POINTER,
+                       NULL, NULL);
+    new_cond->extra_vars = extra_vars;
+    new_cond->options = (options) ?
+        hashtable_dup (options) :
+        hashtable_new (32,
+                       WEECHAT_HASHTABLE_STRING,
+                       WEECHAT_HASHTABLE_STRING,
+                       NULL, NULL);
+    if (!new_cond->expr || !new_cond->pointers || !new_cond->options)
+    {
+        eval_cond_free (new_cond);
+        return NULL;
+    }
+    hashtable_set (new_cond->options, "type", "condition");
+    new_cond->hdata = hdata;
+
+    /* custom prefix/suffix or debug: use eval_expression each time */
+    ptr_value = hashtable_get (new_cond->options, "prefix");
+    use_compiled = !(ptr_value && ptr_value[0]);
+    ptr_value = hashtable_get (new_cond->options, "suffix");
+    if (ptr_value && ptr_value[0])
+        use_compiled = 0;
+    ptr_value = hashtable_get (new_cond->options, "debug");
+    if (ptr_value && ptr_value[0])
+        use_compiled = 0;
+    if (!use_compiled)
+        return new_cond;
+
+    /* init context, the same way as function eval_expression does it */
+    eval_context = &(new_cond->context);
+    eval_context->pointers = new_cond->pointers;
+    eval_context->extra_vars = extra_vars;
+    eval_context->user_vars = hashtable_new (32,
+                                             WEECHAT_HASHTABLE_STRING,
+                                             WEECHAT_HASHTABLE_STRING,
+                                             NULL, NULL);
+    if (!eval_context->user_vars)
+        return new_cond;
+    ptr_value = hashtable_get (new_cond->options, "extra");
+    eval_context->extra_vars_eval = (ptr_value
+                                     && (strcmp (ptr_value, "eval") == 0)) ?
+        1 : 0;
+    eval_context->prefix = EVAL_DEFAULT_PREFIX;
+    eval_context->length_prefix = strlen (eval_context->prefix);
+    eval_context->suffix = EVAL_DEFAULT_SUFFIX;
+    eval_context->length_suffix = strlen (eval_context->suffix);
+    eval_context->regex = NULL;
+    eval_context->regex_replacement_index = 1;
+    eval_context->recursion_count = 0;
+    eval_context->syntax_highlight = 0;
+    eval_context->debug_level = 0;
+    eval_context->debug_depth = 0;
+    eval_context->debug_id = 0;
+    eval_context->debug_output = NULL;
+
+    /* set window/buffer with current window/buffer (if not defined) */
+    if (gui_current_window)
+    {
+        if (!hashtable_has_key (new_cond->pointers, "window"))
+            hashtable_set (new_cond->pointers, "window", gui_current_window);
+        if (!hashtable_has_key (new_cond->pointers, "buffer"))
+        {
+            if (hdata && (strcmp (hdata->name, "window") == 0))
+            {
+                new_cond->buffer_from_window = 1;
+            }
+            else
+            {
+                window = (struct t_gui_window *)hashtable_get (
+                    new_cond->pointers, "window");
+                if (window)
+                    hashtable_set (new_cond->pointers, "buffer", window->buffer);
+            }
+        }
+    }
+
+    new_cond->compiled = eval_compiled_get (expr, eval_context);
+    if (!new_cond->compiled)
+        return new_cond;
+
+    /* the compiled condition must not be removed from cache */
+    new_cond->compiled->used++;
+
+    if (hdata)
+        eval_cond_init_fast (new_cond);
+
+    return new_cond;
+}
+
+/*
+ * Evaluates a condition with the fast path.
+ *
+ * Returns:
+ *   1: condition is true
+ *   0: condition is false
+ *  -1: fast path can not be used (the condition must be fully evaluated)
+ */
+
+int
+eval_cond_fast (struct t_eval_cond *cond, void *pointer)
+{
+    struct t_gui_buffer *ptr_buffer;
+    char str_value[128], *value;
+    const char *ptr_value;
+    void *ptr_var;
+    int rc;
+
+    /* local variable of buffer with the same name? */
+    ptr_buffer = hashtable_get (cond->pointers, "buffer");
+    if (ptr_buffer
+        && hashtable_has_key (ptr_buffer->local_variables, cond->fast_name))
+    {
+        return -1;
+    }
+
+    ptr_var = (char *)pointer + cond->fast_offset;
+    ptr_value = str_value;
+
+    switch (cond->fast_type)
+    {
+        case WEECHAT_HDATA_CHAR:
+            snprintf (str_value, sizeof (str_value),
+                      "%c", *((char *)ptr_var));
+            break;
+        case WEECHAT_HDATA_INTEGER:
+            snprintf (str_value, sizeof (str_value),
+                      "%d", *((int *)ptr_var));
+            break;
+        case WEECHAT_HDATA_LONG:
+            snprintf (str_value, sizeof (str_value),
+                      "%ld", *((long *)ptr_var));
+            break;
+        case WEECHAT_HDATA_LONGLONG:
+            snprintf (str_value, sizeof (str_value),
+                      "%lld", *((long long *)ptr_var));
+            break;
+        case WEECHAT_HDATA_STRING:
+        case WEECHAT_HDATA_SHARED_STRING:
+            ptr_value = *((char **)ptr_var);
+            if (!ptr_value)
+                return -1;
+            if (cond->fast_strcmp)
+            {
+                rc = (strcmp (ptr_value, cond->fast_value) == 0) ? 1 : 0;
+                return (cond->fast_op == EVAL_COMPARE_EQUAL) ? rc : rc ^ 1;
+            }
+            break;
+        case WEECHAT_HDATA_POINTER:
+            snprintf (str_value, sizeof (str_value),
+                      "0x%lx", (unsigned long)(*((void **)ptr_var)));
+            break;
+        case WEECHAT_HDATA_TIME:
+            snprintf (str_value, sizeof (str_value),
+                      "%lld", (long long)(*((time_t *)ptr_var)));
+            break;
+        default:
+            return -1;
+    }
+
+    value = eval_compare (ptr_value, cond->fast_op, cond->fast_value,
+                          cond->fast_regex, &(cond->context));
+    rc = eval_is_true (value);
+    free (value);
+
+    return rc;
+}
+
+/*
+ * Evaluates a condition created with eval_cond_new.
+ *
+ * If the condition has a hdata, the pointer is set in pointers with the
+ * name of hdata before evaluation.
+ *
+ * Returns:
+ *   1: condition is true
+ *   0: condition is false
+ */
+
+int
+eval_cond_is_true (struct t_eval_cond *cond, void *pointer)
+{
+    struct t_gui_window *window;
+    char *value;
+    int rc;
+
+    if (!cond)
+        return 0;
+
+    if (cond->hdata)
+    {
+        hashtable_set (cond->pointers, cond->hdata->name, pointer);
+        if (cond->buffer_from_window)
+        {
+            window = (struct t_gui_window *)pointer;
+            hashtable_set (cond->pointers, "buffer",
+                           (window) ? window->buffer : NULL);
+        }
+    }
+
+    if (!cond->compiled)
+    {
+        value = eval_expression (cond->expr, cond->pointers, cond->extra_vars,
+                                 cond->options);
+        rc = eval_is_true (value);
+        free (value);
+        return rc;
+    }
+
+    if (cond->fast_name && pointer)
+    {
+        rc = eval_cond_fast (cond, pointer);
+        if (rc >= 0)
+            return rc;
+    }
+
+    /* reset variables defined in a previous evaluation */
+    if (cond->context.user_vars->items_count > 0)
+        hashtable_remove_all (cond->context.user_vars);
+    cond->context.recursion_count = 0;
+
+    value = eval_node_evaluate (cond->compiled->node, &(cond->context));
+    rc = eval_is_true (value);
+    free (value);
+
+    return rc;
+}
+
+/*
+ * Frees a condition created with eval_cond_new.
+ */
+
+void
+eval_cond_free (struct t_eval_cond *cond)
+{
+    if (!cond)
+        return;
+
+    free (cond->expr);
+    hashtable_free (cond->pointers);
+    hashtable_free (cond->options);
+    hashtable_free (cond->context.user_vars);
+    if (cond->compiled)
+        cond->compiled->used--;
+    free (cond->fast_name);
+
+    free (cond);
+}
+
+/*
+ * Ends eval: frees all compiled expressions.
+ */
+
+void
+eval_end ()
+{
+    while (eval_compiled_list)
+    {
+        eval_compiled_free (eval_compiled_list);
+    }
+
+    hashtable_free (eval_compiled);
+    eval_compiled = NULL;
+}
@@ -22,6 +22,8 @@
 
 #include <regex.h>
 
+struct t_hdata;
+
 #define EVAL_STR_FALSE      "0"
 #define EVAL_STR_TRUE       "1"
 
@@ -30,6 +32,8 @@
 
 #define EVAL_RECURSION_MAX  32
 
+#define EVAL_COMPILED_MAX   512
+
 #define EVAL_RANGE_DIGIT    "0123456789"
 #define EVAL_RANGE_XDIGIT   EVAL_RANGE_DIGIT "abcdefABCDEF"
 #define EVAL_RANGE_LOWER    "abcdefghijklmnopqrstuvwxyz"
@@ -73,6 +77,41 @@ enum t_eval_comparison
     EVAL_NUM_COMPARISONS,
 };
 
+enum t_eval_node_type
+{
+    EVAL_NODE_VALUE = 0,               /* value returned as-is              */
+    EVAL_NODE_VARS,                    /* replace variables in text         */
+    EVAL_NODE_LOGICAL_OP,              /* logical operator: "||" or "&&"    */
+    EVAL_NODE_COMPARISON,              /* comparison: "==", "=~", ...       */
+    EVAL_NODE_PARENTHESES,             /* sub-expression in parentheses     */
+    EVAL_NODE_EXPRESSION,              /* expression evaluated without      */
+                                       /* compiled form                     */
+    /* number of node types */
+    EVAL_NUM_NODE_TYPES,
+};
+
+struct t_eval_node
+{
+    enum t_eval_node_type type;        /* type of node                      */
+    int op;                            /* logical operator or comparison    */
+    char *text;                        /* text (value, vars, expression)    */
+    int constant;                      /* 1 if text has no variables        */
+    regex_t *regex;                    /* compiled regex (comparison with   */
+                                       /* a constant regex)                 */
+    struct t_eval_node *left;          /* left sub-expression               */
+    struct t_eval_node *right;         /* right sub-expression              */
+};
+
+struct t_eval_compiled
+{
+    char *expr;                        /* expression (key in hashtable)     */
+    struct t_eval_node *node;          /* compiled expression               */
+    int used;                          /* > 0 if being evaluated            */
+    struct t_eval_compiled *prev_compiled; /* link to previous (more        */
+                                           /* recently used) expression     */
+    struct t_eval_compiled *next_compiled; /* link to next expression       */
+};
+
 struct t_eval_regex
 {
     const char *result;
@@ -101,10 +140,47 @@ struct t_eval_context
     char **debug_output;               /* string with debug output          */
 };
 
+struct t_eval_cond
+{
+    char *expr;                        /* condition                         */
+    struct t_hashtable *pointers;      /* pointers (copy)                   */
+    struct t_hashtable *extra_vars;    /* extra variables (not a copy)      */
+    struct t_hashtable *options;       /* options (copy)                    */
+    struct t_hdata *hdata;             /* hdata of pointer changed before   */
+                                       /* each evaluation (can be NULL)     */
+    int buffer_from_window;            /* 1 if "buffer" is set with buffer  */
+                                       /* of window (hdata "window")        */
+    struct t_eval_context context;     /* context reused for evaluations    */
+    struct t_eval_compiled *compiled;  /* compiled condition (NULL: eval    */
+                                       /* with eval_expression each time)   */
+    /* fast path for: "${hdata.var} <comparison> <constant>" */
+    char *fast_name;                   /* "hdata.var" (NULL if no fast path)*/
+    int fast_type;                     /* type of variable in hdata         */
+    int fast_offset;                   /* offset of variable in hdata       */
+    int fast_op;                       /* comparison                        */
+    const char *fast_value;            /* constant value compared           */
+    regex_t *fast_regex;               /* compiled regex (for =~ and !~)    */
+    int fast_strcmp;                   /* 1 if a strcmp can be used (value  */
+                                       /* is not a number)                  */
+};
+
+extern struct t_hashtable *eval_compiled;
+extern struct t_eval_compiled *eval_compiled_list;
+extern struct t_eval_compiled *last_eval_compiled;
+extern int eval_compiled_count;
+
 extern int eval_is_true (const char *value);
 extern char *eval_expression (const char *expr,
                               struct t_hashtable *pointers,
                               struct t_hashtable *extra_vars,
                               struct t_hashtable *options);
+extern struct t_eval_cond *eval_cond_new (const char *expr,
+                                          struct t_hashtable *pointers,
+                                          struct t_hashtable *extra_vars,
+                                          struct t_hashtable *options,
+                                          struct t_hdata *hdata);
+extern int eval_cond_is_true (struct t_eval_cond *cond, void *pointer);
+extern void eval_cond_free (struct t_eval_cond *cond);
+extern void eval_end ();
 
 #endif /* WEECHAT_EVAL_H */
@@ -200,10 +200,11 @@ hashtable_keycmp_default_cb (struct t_hashtable *hashtable,
 /*
  * Creates a new hashtable.
  *
- * The size is NOT a limit for number of items in hashtable. It is the size of
- * internal array to store hashed keys: a high value uses more memory, but has
- * better performance because this reduces the collisions of hashed keys and
- * then reduces length of linked lists.
+ * The size is NOT a limit for number of items in hashtable. It is the initial
+ * size of internal array to store hashed keys: a high value uses more memory,
+ * but has better performance because this reduces the collisions of hashed
+ * keys and then reduces length of linked lists. The size is automatically
+ * increased when there are too many items in the hashtable.
  *
  * Returns pointer to new hashtable, NULL if error.
  */
@@ -248,6 +249,10 @@ hashtable_new (int size,
         {
             new_hashtable->htable[i] = NULL;
         }
+        new_hashtable->auto_resize = 1;
+        new_hashtable->size_old = 0;
+        new_hashtable->htable_old = NULL;
+        new_hashtable->rehash_index = 0;
         new_hashtable->items_count = 0;
         new_hashtable->oldest_item = NULL;
         new_hashtable->newest_item = NULL;
@@ -396,6 +401,147 @@ hashtable_free_value (struct t_hashtable *hashtable,
     }
 }
 
+/*
+ * Returns pointer to the linked list where a key with this hashed key is
+ * stored: in old table if a resize is in progress and the list has not yet
+ * been moved, otherwise in htable.
+ */
+
+struct t_hashtable_item **
+hashtable_get_list (struct t_hashtable *hashtable, unsigned long long hash_key)
+{
+    unsigned long long index;
+
+    if (hashtable->htable_old)
+    {
+        index = hash_key % hashtable->size_old;
+        if (index >= (unsigned long long)hashtable->rehash_index)
+            return &(hashtable->htable_old[index]);
+    }
+
+    return &(hashtable->htable[hash_key % hashtable->size]);
+}
+
+/*
+ * Inserts an item in a linked list (sorted by key).
+ */
+
+void
+hashtable_list_insert (struct t_hashtable *hashtable,
+                       struct t_hashtable_item **list,
+                       struct t_hashtable_item *item)
+{
+    struct t_hashtable_item *ptr_item, *pos_item;
+
+    pos_item = NULL;
+    for (ptr_item = *list;
+         ptr_item
+             && ((int)(hashtable->callback_keycmp) (hashtable, item->key, ptr_item->key) > 0);
+         ptr_item = ptr_item->next_item)
+    {
+        pos_item = ptr_item;
+    }
+
+    if (pos_item)
+    {
+        /* insert item after position found */
+        item->prev_item = pos_item;
+        item->next_item = pos_item->next_item;
+        if (pos_item->next_item)
+            (pos_item->next_item)->prev_item = item;
+        pos_item->next_item = item;
+    }
+    else
+    {
+        /* insert item at beginning of list */
+        item->prev_item = NULL;
+        item->next_item = *list;
+        if (*list)
+            (*list)->prev_item = item;
+        *list = item;
+    }
+}
+
+/*
+ * Moves some linked lists from old table to htable (during a resize of
+ * hashtable); if count is negative, all remaining lists are moved.
+ *
+ * The old table is freed when all lists have been moved.
+ */
+
+void
+hashtable_rehash (struct t_hashtable *hashtable, int count)
+{
+    struct t_hashtable_item *ptr_item;
+    unsigned long long hash_key;
+
+    if (!hashtable->htable_old)
+        return;
+
+    while ((hashtable->rehash_index < hashtable->size_old) && (count != 0))
+    {
+        while (hashtable->htable_old[hashtable->rehash_index])
+        {
+            ptr_item = hashtable->htable_old[hashtable->rehash_index];
+            hashtable->htable_old[hashtable->rehash_index] = ptr_item->next_item;
+            hash_key = hashtable->callback_hash_key (hashtable, ptr_item->key);
+            hashtable_list_insert (
+                hashtable,
+                &(hashtable->htable[hash_key % hashtable->size]),
+                ptr_item);
+        }
+        hashtable->rehash_index++;
+        if (count > 0)
+            count--;
+    }
+
+    if (hashtable->rehash_index >= hashtable->size_old)
+    {
+        free (hashtable->htable_old);
+        hashtable->htable_old = NULL;
+        hashtable->size_old = 0;
+        hashtable->rehash_index = 0;
+    }
+}
+
+/*
+ * Starts a resize of hashtable if there are too many items for its size:
+ * a new htable (with double size) is allocated, and lists of the old table
+ * are moved progressively to the new one.
+ */
+
+void
+hashtable_resize (struct t_hashtable *hashtable)
+{
+    struct t_hashtable_item **new_htable;
+    int i, new_size;
+
+    if (!hashtable->auto_resize
+        || (hashtable->items_count <= hashtable->size * HASHTABLE_RESIZE_LOAD)
+        || (hashtable->size > INT32_MAX / 2))
+    {
+        return;
+    }
+
+    /* a resize is already in progress: finish it first */
+    hashtable_rehash (hashtable, -1);
+
+    new_size = hashtable->size * 2;
+    new_htable = malloc (new_size * sizeof (*new_htable));
+    if (!new_htable)
+        return;
+    for (i = 0; i < new_size; i++)
+    {
+        new_htable[i] = NULL;
+    }
+
+    hashtable->htable_old = hashtable->htable;
+    hashtable->size_old = hashtable->size;
+    hashtable->rehash_index = 0;
+    hashtable->htable = new_htable;
+    hashtable->size = new_size;
+}
+
 /*
  * Sets value for a key in hashtable.
  *
@@ -409,8 +555,7 @@ hashtable_set_with_size (struct t_hashtable *hashtable,
                          const void *key, int key_size,
                          const void *value, int value_size)
 {
-    unsigned long long hash;
-    struct t_hashtable_item *ptr_item, *pos_item, *new_item;
+    struct t_hashtable_item **list, *ptr_item, *pos_item, *new_item;
 
     if (!hashtable
         || ((hashtable->type_keys == HASHTABLE_BUFFER) && (key_size <= 0))
@@ -419,10 +564,13 @@ hashtable_set_with_size (struct t_hashtable *hashtable,
         return NULL;
     }
 
+    hashtable_rehash (hashtable, HASHTABLE_RESIZE_STEP);
+
     /* search position for item in hashtable */
-    hash = hashtable->callback_hash_key (hashtable, key) % hashtable->size;
+    list = hashtable_get_list (hashtable,
+                               hashtable->callback_hash_key (hashtable, key));
     pos_item = NULL;
-    for (ptr_item = hashtable->htable[hash];
+    for (ptr_item = *list;
          ptr_item
              && ((int)(hashtable->callback_keycmp) (hashtable, key, ptr_item->key) > 0);
          ptr_item = ptr_item->next_item)
@@ -467,10 +615,10 @@ hashtable_set_with_size (struct t_hashtable *hashtable,
     {
         /* insert item at beginning of list */
         new_item->prev_item = NULL;
-        new_item->next_item = hashtable->htable[hash];
-        if (hashtable->htable[hash])
-            (hashtable->htable[hash])->prev_item = new_item;
-        hashtable->htable[hash] = new_item;
+        new_item->next_item = *list;
+        if (*list)
+            (*list)->prev_item = new_item;
+        *list = new_item;
     }
 
     /* keep items ordered by date of creation */
@@ -484,6 +632,8 @@ hashtable_set_with_size (struct t_hashtable *hashtable,
 
     hashtable->items_count++;
 
+    hashtable_resize (hashtable);
+
     return new_item;
 }
 
@@ -506,24 +656,27 @@ hashtable_set (struct t_hashtable *hashtable,
 /*
  * Searches for an item in hashtable.
  *
- * If hash is non NULL, then it is set with hash value of key (even if key is
- * not found).
+ * If hash is non NULL, then it is set with hash value of key (index in
+ * htable, even if key is not found).
+ * If list is non NULL, then it is set with pointer to the linked list where
+ * the key is stored (even if key is not found).
  */
 
 struct t_hashtable_item *
-hashtable_get_item (struct t_hashtable *hashtable, const void *key,
-                    unsigned long long *hash)
+hashtable_search_item (struct t_hashtable *hashtable, const void *key,
+                       unsigned long long *hash,
+                       struct t_hashtable_item ***list)
 {
-    unsigned long long key_hash;
-    struct t_hashtable_item *ptr_item;
+    unsigned long long hash_key;
+    struct t_hashtable_item **ptr_list, *ptr_item;
 
-    if (!hashtable)
-        return NULL;
-
-    key_hash = hashtable->callback_hash_key (hashtable, key) % hashtable->size;
+    hash_key = hashtable->callback_hash_key (hashtable, key);
     if (hash)
-        *hash = key_hash;
-    for (ptr_item = hashtable->htable[key_hash];
+        *hash = hash_key % hashtable->size;
+    ptr_list = hashtable_get_list (hashtable, hash_key);
+    if (list)
+        *list = ptr_list;
+    for (ptr_item = *ptr_list;
          ptr_item && hashtable->callback_keycmp (hashtable, key, ptr_item->key) > 0;
          ptr_item = ptr_item->next_item)
     {
@@ -538,6 +691,23 @@ hashtable_get_item (struct t_hashtable *hashtable, const void *key,
     return NULL;
 }
 
+/*
+ * Searches for an item in hashtable.
+ *
+ * If hash is non NULL, then it is set with hash value of key (even if key is
+ * not found).
+ */
+
+struct t_hashtable_item *
+hashtable_get_item (struct t_hashtable *hashtable, const void *key,
+                    unsigned long long *hash)
+{
+    if (!hashtable)
+        return NULL;
+
+    return hashtable_search_item (hashtable, key, hash, NULL);
+}
+
 /*
  * Gets value for a key in hashtable.
  *
@@ -718,6 +888,7 @@ hashtable_dup (struct t_hashtable *hashtable)
                                    hashtable->callback_keycmp);
     if (new_hashtable)
     {
+        new_hashtable->auto_resize = hashtable->auto_resize;
         new_hashtable->callback_free_key = hashtable->callback_free_key;
         new_hashtable->callback_free_value = hashtable->callback_free_value;
         hashtable_map (hashtable,
@@ -1242,7 +1413,7 @@ hashtable_add_from_infolist (struct t_hashtable *hashtable,
 void
 hashtable_remove_item (struct t_hashtable *hashtable,
                        struct t_hashtable_item *item,
-                       unsigned long long hash)
+                       struct t_hashtable_item **list)
 {
     if (!hashtable || !item)
         return;
@@ -1266,8 +1437,8 @@ hashtable_remove_item (struct t_hashtable *hashtable,
         (item->prev_item)->next_item = item->next_item;
     if (item->next_item)
         (item->next_item)->prev_item = item->prev_item;
-    if (hashtable->htable[hash] == item)
-        hashtable->htable[hash] = item->next_item;
+    if (*list == item)
+        *list = item->next_item;
 
     free (item);
 
@@ -1281,15 +1452,16 @@ hashtable_remove_item (struct t_hashtable *hashtable,
 void
 hashtable_remove (struct t_hashtable *hashtable, const void *key)
 {
-    struct t_hashtable_item *ptr_item;
-    unsigned long long hash;
+    struct t_hashtable_item **list, *ptr_item;
 
     if (!hashtable || !key)
         return;
 
-    ptr_item = hashtable_get_item (hashtable, key, &hash);
+    hashtable_rehash (hashtable, HASHTABLE_RESIZE_STEP);
+
+    ptr_item = hashtable_search_item (hashtable, key, NULL, &list);
     if (ptr_item)
-        hashtable_remove_item (hashtable, ptr_item, hash);
+        hashtable_remove_item (hashtable, ptr_item, list);
 }
 
 /*
@@ -1304,11 +1476,14 @@ hashtable_remove_all (struct t_hashtable *hashtable)
     if (!hashtable)
         return;
 
+    hashtable_rehash (hashtable, -1);
+
     for (i = 0; i < hashtable->size; i++)
     {
         while (hashtable->htable[i])
         {
-            hashtable_remove_item (hashtable, hashtable->htable[i], i);
+            hashtable_remove_item (hashtable, hashtable->htable[i],
+                                   &(hashtable->htable[i]));
         }
     }
 }
@@ -1330,41 +1505,24 @@ hashtable_free (struct t_hashtable *hashtable)
 }
 
 /*
- * Prints hashtable in WeeChat log file (usually for crash dump).
+ * Prints linked lists of a table of hashtable in WeeChat log file.
  */
 
 void
-hashtable_print_log (struct t_hashtable *hashtable, const char *name)
+hashtable_print_log_htable (struct t_hashtable *hashtable,
+                            struct t_hashtable_item **htable, int size,
+                            const char *name)
 {
     struct t_hashtable_item *ptr_item;
     int i;
 
-    log_printf ("");
-    log_printf ("[hashtable %s (addr:%p)]", name, hashtable);
-    log_printf ("  size . . . . . . . . . : %d", hashtable->size);
-    log_printf ("  htable . . . . . . . . : %p", hashtable->htable);
-    log_printf ("  items_count. . . . . . : %d", hashtable->items_count);
-    log_printf ("  oldest_item. . . . . . : %p", hashtable->oldest_item);
-    log_printf ("  newest_item. . . . . . : %p", hashtable->newest_item);
-    log_printf ("  type_keys. . . . . . . : %d (%s)",
-                hashtable->type_keys,
-                hashtable_type_string[hashtable->type_keys]);
-    log_printf ("  type_values. . . . . . : %d (%s)",
-                hashtable->type_values,
-                hashtable_type_string[hashtable->type_values]);
-    log_printf ("  callback_hash_key. . . : %p", hashtable->callback_hash_key);
-    log_printf ("  callback_keycmp. . . . : %p", hashtable->callback_keycmp);
-    log_printf ("  callback_free_key. . . : %p", hashtable->callback_free_key);
-    log_printf ("  callback_free_value. . : %p", hashtable->callback_free_value);
-    log_printf ("  keys_values. . . . . . : '%s'", hashtable->keys_values);
-
-    for (i = 0; i < hashtable->size; i++)
+    for (i = 0; i < size; i++)
     {
-        log_printf ("  htable[%06d] . . . . : %p", i, hashtable->htable[i]);
-        for (ptr_item = hashtable->htable[i]; ptr_item;
+        log_printf ("  %s[%06d] . . . . : %p", name, i, htable[i]);
+        for (ptr_item = htable[i]; ptr_item;
              ptr_item = ptr_item->next_item)
         {
-            log_printf ("    [item %p]", hashtable->htable);
+            log_printf ("    [item %p]", ptr_item);
             switch (hashtable->type_keys)
             {
                 case HASHTABLE_INTEGER:
@@ -1420,3 +1578,42 @@ hashtable_print_log (struct t_hashtable *hashtable, const char *name)
         }
     }
 }
+
+/*
+ * Prints hashtable in WeeChat log file (usually for crash dump).
+ */
+
+void
+hashtable_print_log (struct t_hashtable *hashtable, const char *name)
+{
+    log_printf ("");
+    log_printf ("[hashtable %s (addr:%p)]", name, hashtable);
+    log_printf ("  size . . . . . . . . . : %d", hashtable->size);
+    log_printf ("  htable . . . . . . . . : %p", hashtable->htable);
+    log_printf ("  auto_resize. . . . . . : %d", hashtable->auto_resize);
+    log_printf ("  size_old . . . . . . . : %d", hashtable->size_old);
+    log_printf ("  htable_old . . . . . . : %p", hashtable->htable_old);
+    log_printf ("  rehash_index . . . . . : %d", hashtable->rehash_index);
+    log_printf ("  items_count. . . . . . : %d", hashtable->items_count);
+    log_printf ("  oldest_item. . . . . . : %p", hashtable->oldest_item);
+    log_printf ("  newest_item. . . . . . : %p", hashtable->newest_item);
+    log_printf ("  type_keys. . . . . . . : %d (%s)",
+                hashtable->type_keys,
+                hashtable_type_string[hashtable->type_keys]);
+    log_printf ("  type_values. . . . . . : %d (%s)",
+                hashtable->type_values,
+                hashtable_type_string[hashtable->type_values]);
+    log_printf ("  callback_hash_key. . . : %p", hashtable->callback_hash_key);
+    log_printf ("  callback_keycmp. . . . : %p", hashtable->callback_keycmp);
+    log_printf ("  callback_free_key. . . : %p", hashtable->callback_free_key);
+    log_printf ("  callback_free_value. . : %p", hashtable->callback_free_value);
+    log_printf ("  keys_values. . . . . . : '%s'", hashtable->keys_values);
+
+    hashtable_print_log_htable (hashtable, hashtable->htable,
+                                hashtable->size, "htable");
+    if (hashtable->htable_old)
+    {
+        hashtable_print_log_htable (hashtable, hashtable->htable_old,
+                                    hashtable->size_old, "htable_old");
+    }
+}
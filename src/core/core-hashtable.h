@@ -96,8 +96,17 @@ typedef void (t_hashtable_map_string)(void *data,
  * +-----+
  * |   7 | --> "weechat"
  * +-----+
+ *
+ * When the number of items exceeds HASHTABLE_RESIZE_LOAD times the size, the
+ * size of htable is doubled (if "auto_resize" is set, which is the default).
+ * Items are not moved all at once: the old table is kept in "htable_old" and
+ * a few lists of this table are moved to the new one on each change in the
+ * hashtable, until the old table is empty and freed.
  */
 
+#define HASHTABLE_RESIZE_LOAD 2
+#define HASHTABLE_RESIZE_STEP 2
+
 enum t_hashtable_type
 {
     HASHTABLE_INTEGER = 0,
@@ -129,6 +138,12 @@ struct t_hashtable
     int size;                          /* hashtable size                    */
     struct t_hashtable_item **htable;  /* table to map hashes with linked   */
                                        /* lists                             */
+    int auto_resize;                   /* 1 if size grows with items count  */
+    int size_old;                      /* size of old table (during resize) */
+    struct t_hashtable_item **htable_old; /* old table, with lists not yet  */
+                                       /* moved to htable (NULL if no       */
+                                       /* resize in progress)               */
+    int rehash_index;                  /* next list to move from old table  */
     int items_count;                   /* number of items in hashtable      */
     struct t_hashtable_item *oldest_item; /* oldest item in hashtable       */
     struct t_hashtable_item *newest_item; /* newest item in hashtable       */
@@ -24,6 +24,7 @@
 #endif
 
 #include <stdlib.h>
+#include <stdio.h>
 #include <string.h>
 
 #include "weechat.h"
@@ -170,12 +171,19 @@ hdata_new_var (struct t_hdata *hdata, const char *name, int offset, int type,
 }
 
 /*
- * Adds a new list pointer in a hdata.
+ * Adds a new list pointer in a hdata, with an optional hashtable containing
+ * all pointers of the list (keys are pointers, values are not used).
+ *
+ * The hashtable is created/updated/freed by the owner of the list, so a
+ * pointer to the variable holding the hashtable is given (the hashtable
+ * can be NULL if the list is empty). If set, it is used to check pointers
+ * in a constant time instead of walking the list.
  */
 
 void
-hdata_new_list (struct t_hdata *hdata, const char *name, void *pointer,
-                int flags)
+hdata_new_list_pointers (struct t_hdata *hdata, const char *name,
+                         void *pointer, int flags,
+                         struct t_hashtable **pointers)
 {
     struct t_hdata_list *list;
 
@@ -187,10 +195,22 @@ hdata_new_list (struct t_hdata *hdata, const char *name, void *pointer,
     {
         list->pointer = pointer;
         list->flags = flags;
+        list->pointers = pointers;
         hashtable_set (hdata->hash_list, name, list);
     }
 }
 
+/*
+ * Adds a new list pointer in a hdata.
+ */
+
+void
+hdata_new_list (struct t_hdata *hdata, const char *name, void *pointer,
+                int flags)
+{
+    hdata_new_list_pointers (hdata, name, pointer, flags, NULL);
+}
+
 /*
  * Gets offset of variable in hdata.
  */
@@ -424,6 +444,363 @@ hdata_get_var_at_offset (struct t_hdata *hdata, void *pointer, int offset)
     return pointer + offset;
 }
 
+/*
+ * Returns pointer to content of a variable in an object, with an optional
+ * index in array (-1 if no index).
+ *
+ * Returns NULL if index is invalid for this variable.
+ */
+
+void *
+hdata_path_var_content (struct t_hdata_var *var, void *pointer, int index)
+{
+    void *ptr_array;
+    int size;
+
+    if (!var->array_size || (index < 0))
+        return pointer + var->offset;
+
+    switch (var->type)
+    {
+        case WEECHAT_HDATA_CHAR:
+            size = sizeof (char);
+            break;
+        case WEECHAT_HDATA_INTEGER:
+            size = sizeof (int);
+            break;
+        case WEECHAT_HDATA_LONG:
+            size = sizeof (long);
+            break;
+        case WEECHAT_HDATA_LONGLONG:
+            size = sizeof (long long);
+            break;
+        case WEECHAT_HDATA_STRING:
+        case WEECHAT_HDATA_SHARED_STRING:
+            /* we can not index a static array of strings */
+            if (!var->array_pointer)
+                return NULL;
+            size = sizeof (char *);
+            break;
+        case WEECHAT_HDATA_POINTER:
+            size = sizeof (void *);
+            break;
+        case WEECHAT_HDATA_TIME:
+            size = sizeof (time_t);
+            break;
+        case WEECHAT_HDATA_HASHTABLE:
+            size = sizeof (struct t_hashtable *);
+            break;
+        default:
+            return NULL;
+    }
+
+    if (var->array_pointer)
+    {
+        ptr_array = *((void **)(pointer + var->offset));
+        if (!ptr_array)
+            return NULL;
+    }
+    else
+    {
+        ptr_array = pointer + var->offset;
+    }
+
+    return ptr_array + ((size_t)index * size);
+}
+
+/*
+ * Resolves a path of variables, starting with an object of hdata "hdata",
+ * for example with buffer hdata: "lines.first_line.data.message".
+ *
+ * Each variable can have an index for arrays (format: "N|name"); all
+ * variables except the last one must be pointers with a hdata.
+ *
+ * The path returned can then be used with function hdata_path_get_var on
+ * many objects, without looking again for variables in hdata; it must be
+ * freed before the hdata used in path are freed.
+ *
+ * Returns pointer to path, NULL if error.
+ *
+ * Note: result must be freed after use with function hdata_path_free.
+ */
+
+struct t_hdata_path *
+hdata_path_new (struct t_hdata *hdata, const char *path)
+{
+    struct t_hdata_path *new_path;
+    struct t_hdata *ptr_hdata;
+    struct t_hdata_var *ptr_var;
+    char **items;
+    const char *ptr_name;
+    int i, num_items, index;
+
+    if (!hdata || !path || !path[0])
+        return NULL;
+
+    items = string_split (path, ".", NULL, 0, 0, &num_items);
+    if (!items)
+        return NULL;
+
+    new_path = malloc (sizeof (*new_path));
+    if (!new_path)
+        goto error;
+    new_path->hdata = hdata;
+    new_path->num_steps = num_items;
+    new_path->steps = malloc (num_items * sizeof (*new_path->steps));
+    if (!new_path->steps)
+        goto error;
+
+    ptr_hdata = hdata;
+    for (i = 0; i < num_items; i++)
+    {
+        hdata_get_index_and_name (items[i], &index, &ptr_name);
+        ptr_var = (ptr_hdata) ?
+            hashtable_get (ptr_hdata->hash_var, ptr_name) : NULL;
+        if (!ptr_var || (ptr_var->offset < 0))
+            goto error;
+        new_path->steps[i].var = ptr_var;
+        new_path->steps[i].index = index;
+        if (i < num_items - 1)
+        {
+            /* not the last variable: it must be a pointer to an object */
+            if ((ptr_var->type != WEECHAT_HDATA_POINTER)
+                || !ptr_var->hdata_name)
+            {
+                goto error;
+            }
+            ptr_hdata = hook_hdata_get (NULL, ptr_var->hdata_name);
+        }
+    }
+
+    string_free_split (items);
+
+    return new_path;
+
+error:
+    if (new_path)
+    {
+        free (new_path->steps);
+        free (new_path);
+    }
+    string_free_split (items);
+    return NULL;
+}
+
+/*
+ * Gets pointer to content of last variable in path, starting with object
+ * "pointer".
+ *
+ * Returns NULL if path is invalid or if a pointer in path is NULL.
+ */
+
+void *
+hdata_path_get_var (struct t_hdata_path *path, void *pointer)
+{
+    void *ptr_content;
+    int i;
+
+    if (!path || !pointer)
+        return NULL;
+
+    for (i = 0; i < path->num_steps; i++)
+    {
+        ptr_content = hdata_path_var_content (path->steps[i].var, pointer,
+                                              path->steps[i].index);
+        if (!ptr_content || (i == path->num_steps - 1))
+            return ptr_content;
+        pointer = *((void **)ptr_content);
+        if (!pointer)
+            return NULL;
+    }
+
+    return NULL;
+}
+
+/*
+ * Frees a path of hdata variables.
+ */
+
+void
+hdata_path_free (struct t_hdata_path *path)
+{
+    if (!path)
+        return;
+
+    free (path->steps);
+    free (path);
+}
+
+/*
+ * Converts content of a hdata variable to a string.
+ *
+ * Returns pointer to string (the string is "str_value" or the string in
+ * variable), NULL if the type is not supported.
+ */
+
+const char *
+hdata_var_content_to_string (struct t_hdata_var *var, void *ptr_content,
+                             char *str_value, int size_value)
+{
+    void *ptr_value;
+
+    switch (var->type)
+    {
+        case WEECHAT_HDATA_CHAR:
+            str_value[0] = *((char *)ptr_content);
+            str_value[1] = '\0';
+            return str_value;
+        case WEECHAT_HDATA_INTEGER:
+            snprintf (str_value, size_value, "%d", *((int *)ptr_content));
+            return str_value;
+        case WEECHAT_HDATA_LONG:
+            snprintf (str_value, size_value, "%ld", *((long *)ptr_content));
+            return str_value;
+        case WEECHAT_HDATA_LONGLONG:
+            snprintf (str_value, size_value,
+                      "%lld", *((long long *)ptr_content));
+            return str_value;
+        case WEECHAT_HDATA_STRING:
+        case WEECHAT_HDATA_SHARED_STRING:
+            return (*((char **)ptr_content)) ? *((char **)ptr_content) : "";
+        case WEECHAT_HDATA_POINTER:
+        case WEECHAT_HDATA_HASHTABLE:
+            ptr_value = *((void **)ptr_content);
+            str_value[0] = '\0';
+            if (ptr_value)
+            {
+                snprintf (str_value, size_value,
+                          "0x%lx", (unsigned long)ptr_value);
+            }
+            return str_value;
+        case WEECHAT_HDATA_TIME:
+            snprintf (str_value, size_value,
+                      "%lld", (long long)(*((time_t *)ptr_content)));
+            return str_value;
+    }
+
+    return NULL;
+}
+
+/*
+ * Gets values of variables in many objects of a list, starting with object
+ * "pointer", and moving to next objects (if count >= 0) or to previous
+ * objects (if count < 0) of the list.
+ *
+ * Argument "count" is the max number of objects to read (0 = all objects
+ * until the end of list), argument "fields" is a comma-separated list of
+ * variables, each variable can be a path of variables, like in function
+ * hdata_path_new (for example: "data.date,data.prefix,data.message" with
+ * hdata "line").
+ *
+ * Returns hashtable with these keys (all values are strings):
+ *   "count": number of objects read
+ *   "next": pointer to the object after the last one read (empty string if
+ *           the end of list was reached)
+ *   "N.pointer": pointer to object N (first object is 0)
+ *   "N.field": value of variable "field" in object N (empty string if the
+ *              value is NULL)
+ *
+ * Returns NULL if error (for example if a variable is not found).
+ *
+ * Note: result must be freed after use with function hashtable_free.
+ */
+
+struct t_hashtable *
+hdata_get_fields (struct t_hdata *hdata, void *pointer, int count,
+                  const char *fields)
+{
+    struct t_hashtable *hashtable;
+    struct t_hdata_path **paths;
+    struct t_hdata_var *ptr_var;
+    char **list_fields, *key, str_value[64];
+    const char *ptr_var_move, *ptr_value;
+    void *ptr_content;
+    int i, j, num_fields, length_key;
+
+    if (!hdata || !fields || !fields[0])
+        return NULL;
+
+    list_fields = string_split (fields, ",", NULL,
+                                WEECHAT_STRING_SPLIT_STRIP_LEFT
+                                | WEECHAT_STRING_SPLIT_STRIP_RIGHT
+                                | WEECHAT_STRING_SPLIT_COLLAPSE_SEPS,
+                                0, &num_fields);
+    if (!list_fields)
+        return NULL;
+
+    hashtable = NULL;
+    key = NULL;
+
+    paths = calloc (num_fields, sizeof (*paths));
+    if (!paths)
+        goto end;
+    for (j = 0; j < num_fields; j++)
+    {
+        paths[j] = hdata_path_new (hdata, list_fields[j]);
+        if (!paths[j])
+            goto end;
+    }
+
+    length_key = strlen (fields) + 32;
+    key = malloc (length_key);
+    if (!key)
+        goto end;
+
+    hashtable = hashtable_new (32,
+                               WEECHAT_HASHTABLE_STRING,
+                               WEECHAT_HASHTABLE_STRING,
+                               NULL, NULL);
+    if (!hashtable)
+        goto end;
+
+    ptr_var_move = (count < 0) ? hdata->var_prev : hdata->var_next;
+    count = abs (count);
+
+    for (i = 0; pointer && ((count == 0) || (i < count)); i++)
+    {
+        snprintf (key, length_key, "%d.pointer", i);
+        snprintf (str_value, sizeof (str_value),
+                  "0x%lx", (unsigned long)pointer);
+        hashtable_set (hashtable, key, str_value);
+        for (j = 0; j < num_fields; j++)
+        {
+            ptr_var = paths[j]->steps[paths[j]->num_steps - 1].var;
+            ptr_content = hdata_path_get_var (paths[j], pointer);
+            ptr_value = (ptr_content) ?
+                hdata_var_content_to_string (ptr_var, ptr_content,
+                                             str_value, sizeof (str_value)) :
+                NULL;
+            snprintf (key, length_key, "%d.%s", i, list_fields[j]);
+            hashtable_set (hashtable, key, (ptr_value) ? ptr_value : "");
+        }
+        pointer = (ptr_var_move) ?
+            hdata_pointer (hdata, pointer, ptr_var_move) : NULL;
+    }
+
+    snprintf (str_value, sizeof (str_value), "%d", i);
+    hashtable_set (hashtable, "count", str_value);
+    str_value[0] = '\0';
+    if (pointer)
+    {
+        snprintf (str_value, sizeof (str_value),
+                  "0x%lx", (unsigned long)pointer);
+    }
+    hashtable_set (hashtable, "next", str_value);
+
+end:
+    if (paths)
+    {
+        for (j = 0; j < num_fields; j++)
+        {
+            hdata_path_free (paths[j]);
+        }
+        free (paths);
+    }
+    free (key);
+    string_free_split (list_fields);
+    return hashtable;
+}
+
 /*
  * Gets a list pointer in hdata.
  */
@@ -473,6 +850,55 @@ hdata_check_pointer_in_list (struct t_hdata *hdata, void *list, void *pointer)
     return 0;
 }
 
+/*
+ * Checks if a pointer is in the hashtable of pointers of a list (if the
+ * hashtable is not set, the list is walked).
+ */
+
+int
+hdata_check_pointer_in_hashtable (struct t_hdata *hdata,
+                                  struct t_hdata_list *list, void *pointer)
+{
+    if (!*(list->pointers))
+    {
+        return hdata_check_pointer_in_list (hdata,
+                                            *((void **)(list->pointer)),
+                                            pointer);
+    }
+
+    return hashtable_has_key (*(list->pointers), pointer);
+}
+
+/*
+ * Searches a list with a hashtable of pointers, using the current value of
+ * list (callback called for each list in hdata).
+ */
+
+void
+hdata_search_list_pointers_map_cb (void *data, struct t_hashtable *hashtable,
+                                   const void *key, const void *value)
+{
+    void **pointers;
+    struct t_hdata_list *ptr_list;
+
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    pointers = (void **)data;
+
+    /* list already found? just exit */
+    if (pointers[1])
+        return;
+
+    ptr_list = (struct t_hdata_list *)value;
+    if (ptr_list && ptr_list->pointers
+        && (*((void **)(ptr_list->pointer)) == pointers[0]))
+    {
+        pointers[1] = ptr_list;
+    }
+}
+
 /*
  * Checks if a pointer is in a list with flag "check_pointers".
  */
@@ -503,10 +929,18 @@ hdata_check_pointer_map_cb (void *data, struct t_hashtable *hashtable,
     if (!ptr_list || !(ptr_list->flags & WEECHAT_HDATA_LIST_CHECK_POINTERS))
         return;
 
-    *found = (void *)((unsigned long)hdata_check_pointer_in_list (
-                          ptr_hdata,
-                          *((void **)(ptr_list->pointer)),
-                          pointer));
+    if (ptr_list->pointers)
+    {
+        *found = (void *)((unsigned long)hdata_check_pointer_in_hashtable (
+                              ptr_hdata, ptr_list, pointer));
+    }
+    else
+    {
+        *found = (void *)((unsigned long)hdata_check_pointer_in_list (
+                              ptr_hdata,
+                              *((void **)(ptr_list->pointer)),
+                              pointer));
+    }
     (*num_lists)++;
 }
 
@@ -518,6 +952,9 @@ hdata_check_pointer_map_cb (void *data, struct t_hashtable *hashtable,
  * the pointer is considered valid (so this function returns 1); if the
  * pointer is not found in any list, this function returns 0.
  *
+ * Lists with a hashtable of pointers (see function hdata_new_list_pointers)
+ * are checked in constant time, other lists are walked from their head.
+ *
  * Returns:
  *   1: pointer exists in the given list (or a list with check_pointers flag)
  *   0: pointer does not exist
@@ -533,6 +970,18 @@ hdata_check_pointer (struct t_hdata *hdata, void *list, void *pointer)
 
     if (list)
     {
+        /* search pointer in the hashtable of pointers of list (if any) */
+        pointers[0] = list;
+        pointers[1] = NULL;
+        hashtable_map (hdata->hash_list,
+                       &hdata_search_list_pointers_map_cb,
+                       pointers);
+        if (pointers[1])
+        {
+            return hdata_check_pointer_in_hashtable (
+                hdata, (struct t_hdata_list *)pointers[1], pointer);
+        }
+
         /* search pointer in the given list */
         return hdata_check_pointer_in_list (hdata, list, pointer);
     }
@@ -591,68 +1040,34 @@ hdata_search (struct t_hdata *hdata,
               struct t_hashtable *options,
               int move)
 {
-    struct t_hashtable *pointers2, *options2;
-    char *result;
+    struct t_eval_cond *cond;
     void *ret_pointer;
-    int rc;
 
     if (!hdata || !pointer || !search || !search[0] || (move == 0))
         return NULL;
 
     ret_pointer = NULL;
 
-    /* duplicate or create hashtable with pointers */
-    if (pointers)
-    {
-        pointers2 = hashtable_dup (pointers);
-    }
-    else
-    {
-        pointers2 = hashtable_new (32,
-                                   WEECHAT_HASHTABLE_STRING,
-                                   WEECHAT_HASHTABLE_POINTER,
-                                   NULL,
-                                   NULL);
-    }
-
-    /* duplicate or create hashtable with options */
-    if (options)
-    {
-        options2 = hashtable_dup (options);
-    }
-    else
-    {
-        options2 = hashtable_new (32,
-                                  WEECHAT_HASHTABLE_STRING,
-                                  WEECHAT_HASHTABLE_POINTER,
-                                  NULL,
-                                  NULL);
-    }
-    if (options2)
-        hashtable_set (options2, "type", "condition");
+    /*
+     * compile condition once, with a context reused for all elements
+     * (the pointer is set with the name of hdata before each evaluation)
+     */
+    cond = eval_cond_new (search, pointers, extra_vars, options, hdata);
+    if (!cond)
+        return NULL;
 
     while (pointer)
     {
-        /* set pointer in hashtable (used for evaluating expression) */
-        if (pointers2)
-            hashtable_set (pointers2, hdata->name, pointer);
-
-        /* evaluate expression */
-        result = eval_expression (search, pointers2, extra_vars, options2);
-        rc = eval_is_true (result);
-        free (result);
-        if (rc)
+        if (eval_cond_is_true (cond, pointer))
         {
             ret_pointer = pointer;
-            goto end;
+            break;
         }
-
         pointer = hdata_move (hdata, pointer, move);
     }
 
-end:
-    hashtable_free (pointers2);
-    hashtable_free (options2);
+    eval_cond_free (cond);
+
     return ret_pointer;
 }
 
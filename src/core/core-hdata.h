@@ -37,6 +37,10 @@
 /* create a hdata list */
 #define HDATA_LIST(__name, __flags)                                     \
     hdata_new_list (hdata, #__name, &(__name), __flags);
+/* create a hdata list with a hashtable of all pointers in list */
+#define HDATA_LIST_POINTERS(__name, __flags, __pointers)                \
+    hdata_new_list_pointers (hdata, #__name, &(__name), __flags,        \
+                             &(__pointers));
 
 struct t_hdata_var
 {
@@ -53,6 +57,24 @@ struct t_hdata_list
 {
     void *pointer;                     /* list pointer                      */
     int flags;                         /* flags for list                    */
+    struct t_hashtable **pointers;     /* hashtable with all pointers in    */
+                                       /* list (optional, maintained by     */
+                                       /* the owner of list): used to check */
+                                       /* pointers without walking the list */
+};
+
+struct t_hdata_path_step
+{
+    struct t_hdata_var *var;           /* variable in hdata                 */
+    int index;                         /* index in array (-1 if none)       */
+};
+
+struct t_hdata_path
+{
+    struct t_hdata *hdata;             /* hdata of first object             */
+    int num_steps;                     /* number of variables in path       */
+    struct t_hdata_path_step *steps;   /* variables (all except last one    */
+                                       /* are pointers to other objects)    */
 };
 
 struct t_hdata
@@ -97,6 +119,9 @@ extern struct t_hdata *hdata_new (struct t_weechat_plugin *plugin,
 extern void hdata_new_var (struct t_hdata *hdata, const char *name, int offset,
                            int type, int update_allowed, const char *array_size,
                            const char *hdata_name);
+extern void hdata_new_list_pointers (struct t_hdata *hdata, const char *name,
+                                     void *pointer, int flags,
+                                     struct t_hashtable **pointers);
 extern void hdata_new_list (struct t_hdata *hdata, const char *name,
                             void *pointer, int flags);
 extern int hdata_get_var_offset (struct t_hdata *hdata, const char *name);
@@ -114,6 +139,17 @@ extern void *hdata_get_var (struct t_hdata *hdata, void *pointer,
                             const char *name);
 extern void *hdata_get_var_at_offset (struct t_hdata *hdata, void *pointer,
                                       int offset);
+extern struct t_hdata_path *hdata_path_new (struct t_hdata *hdata,
+                                            const char *path);
+extern void *hdata_path_get_var (struct t_hdata_path *path, void *pointer);
+extern void hdata_path_free (struct t_hdata_path *path);
+extern const char *hdata_var_content_to_string (struct t_hdata_var *var,
+                                               void *ptr_content,
+                                               char *str_value,
+                                               int size_value);
+extern struct t_hashtable *hdata_get_fields (struct t_hdata *hdata,
+                                             void *pointer, int count,
+                                             const char *fields);
 extern void *hdata_get_list (struct t_hdata *hdata, const char *name);
 extern int hdata_check_pointer (struct t_hdata *hdata, void *list,
                                 void *pointer);
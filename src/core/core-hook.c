@@ -32,11 +32,13 @@
 #include <errno.h>
 
 #include "weechat.h"
+#include "core-arraylist.h"
 #include "core-debug.h"
 #include "core-hook.h"
 #include "core-hashtable.h"
 #include "core-infolist.h"
 #include "core-log.h"
+#include "core-profile.h"
 #include "core-signal.h"
 #include "core-string.h"
 #include "core-util.h"
@@ -52,6 +54,8 @@ struct t_hook *weechat_hooks[HOOK_NUM_TYPES];     /* list of hooks          */
 struct t_hook *last_weechat_hook[HOOK_NUM_TYPES]; /* last hook              */
 int hooks_count[HOOK_NUM_TYPES];                  /* number of hooks        */
 int hooks_count_total = 0;                        /* total number of hooks  */
+/* index of hooks by name (name -> arraylist of hooks, same order as list) */
+struct t_hashtable *hook_index_name[HOOK_NUM_TYPES];
 int hook_exec_recursion = 0;           /* 1 when a hook is executed         */
 int real_delete_pending = 0;           /* 1 if some hooks must be deleted   */
 
@@ -59,11 +63,11 @@ int hook_socketpair_ok = 0;            /* 1 if socketpair() is OK           */
 
 /* hook callbacks */
 t_callback_hook *hook_callback_add[HOOK_NUM_TYPES] =
-{ NULL, NULL, NULL, &hook_fd_add_cb, NULL, NULL, NULL, NULL, NULL, NULL,
-  NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
+{ NULL, NULL, &hook_timer_add_cb, &hook_fd_add_cb, NULL, NULL, NULL, NULL,
+  NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
 t_callback_hook *hook_callback_remove[HOOK_NUM_TYPES] =
-{ NULL, NULL, NULL, &hook_fd_remove_cb, NULL, NULL, NULL, NULL, NULL, NULL,
-  NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
+{ NULL, NULL, &hook_timer_remove_cb, &hook_fd_remove_cb, NULL, NULL, NULL,
+  NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
 t_callback_hook *hook_callback_free_data[HOOK_NUM_TYPES] =
 {
     &hook_command_free_data,
@@ -169,9 +173,11 @@ hook_init ()
         weechat_hooks[type] = NULL;
         last_weechat_hook[type] = NULL;
         hooks_count[type] = 0;
+        hook_index_name[type] = NULL;
     }
     hooks_count_total = 0;
     hook_last_system_time = time (NULL);
+    hook_last_monotonic_time = hook_timer_get_monotonic_time ();
 
     /*
      * Set a flag to 0 if socketpair() function is not available.
@@ -326,6 +332,127 @@ hook_add_to_list (struct t_hook *new_hook)
         (hook_callback_add[new_hook->type]) (new_hook);
 }
 
+/*
+ * Frees an arraylist of hooks in index by name.
+ */
+
+void
+hook_index_name_free_value_cb (struct t_hashtable *hashtable,
+                               const void *key, void *value)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    arraylist_free ((struct t_arraylist *)value);
+}
+
+/*
+ * Adds a hook in index by name (used to quickly find hooks of types command,
+ * info, info_hashtable, infolist and hdata).
+ *
+ * Hooks with same name are kept in the same order as the list of hooks
+ * (priority, then order of creation).
+ */
+
+void
+hook_index_name_add (struct t_hook *hook, const char *name)
+{
+    struct t_arraylist *ptr_list;
+    struct t_hook *ptr_hook;
+    int i, size;
+
+    if (!hook || !name)
+        return;
+
+    if (!hook_index_name[hook->type])
+    {
+        hook_index_name[hook->type] = hashtable_new (
+            32,
+            WEECHAT_HASHTABLE_STRING,
+            WEECHAT_HASHTABLE_POINTER,
+            NULL, NULL);
+        if (!hook_index_name[hook->type])
+            return;
+        hashtable_set_pointer (hook_index_name[hook->type],
+                               "callback_free_value",
+                               &hook_index_name_free_value_cb);
+    }
+
+    ptr_list = hashtable_get (hook_index_name[hook->type], name);
+    if (!ptr_list)
+    {
+        ptr_list = arraylist_new (4, 0, 1, NULL, NULL, NULL, NULL);
+        if (!ptr_list)
+            return;
+        hashtable_set (hook_index_name[hook->type], name, ptr_list);
+    }
+
+    /* insert hook after hooks with same or higher priority */
+    size = arraylist_size (ptr_list);
+    for (i = 0; i < size; i++)
+    {
+        ptr_hook = (struct t_hook *)arraylist_get (ptr_list, i);
+        if (hook->priority > ptr_hook->priority)
+            break;
+    }
+    arraylist_insert (ptr_list, i, hook);
+}
+
+/*
+ * Removes a hook from index by name.
+ */
+
+void
+hook_index_name_remove (struct t_hook *hook, const char *name)
+{
+    struct t_arraylist *ptr_list;
+    int i, size;
+
+    if (!hook || !name || !hook_index_name[hook->type])
+        return;
+
+    ptr_list = hashtable_get (hook_index_name[hook->type], name);
+    if (!ptr_list)
+        return;
+
+    size = arraylist_size (ptr_list);
+    for (i = 0; i < size; i++)
+    {
+        if (arraylist_get (ptr_list, i) == hook)
+        {
+            arraylist_remove (ptr_list, i);
+            break;
+        }
+    }
+
+    if (arraylist_size (ptr_list) == 0)
+        hashtable_remove (hook_index_name[hook->type], name);
+
+    if (hook_index_name[hook->type]->items_count == 0)
+    {
+        hashtable_free (hook_index_name[hook->type]);
+        hook_index_name[hook->type] = NULL;
+    }
+}
+
+/*
+ * Returns the arraylist of hooks with a name in the index by name (same order
+ * as the list of hooks), NULL if there is no hook with this name.
+ */
+
+struct t_arraylist *
+hook_index_name_get (int type, const char *name)
+{
+    if ((type < 0) || (type >= HOOK_NUM_TYPES) || !name
+        || !hook_index_name[type])
+    {
+        return NULL;
+    }
+
+    return hashtable_get (hook_index_name[type], name);
+}
+
 /*
  * Removes a hook from list.
  */
@@ -408,6 +535,7 @@ hook_init_data (struct t_hook *hook, struct t_weechat_plugin *plugin,
     hook->priority = priority;
     hook->callback_pointer = callback_pointer;
     hook->callback_data = callback_data;
+    hook->profile = NULL;
     hook->hook_data = NULL;
 
     if (weechat_debug_core >= 2)
@@ -489,7 +617,7 @@ hook_callback_start (struct t_hook *hook, struct t_hook_exec_cb *hook_exec_cb)
     else
         hook->running = 1;
 
-    if (debug_long_callbacks > 0)
+    if ((debug_long_callbacks > 0) || profile_enabled)
     {
         gettimeofday (&hook_exec_cb->start_time, NULL);
     }
@@ -516,24 +644,27 @@ hook_callback_end (struct t_hook *hook, struct t_hook_exec_cb *hook_exec_cb)
     else
         hook->running = 0;
 
-    if ((debug_long_callbacks > 0)
-        && (hook_exec_cb->start_time.tv_sec > 0))
+    if (hook_exec_cb->start_time.tv_sec == 0)
+        return;
+
+    gettimeofday (&end_time, NULL);
+    time_diff = util_timeval_diff (&hook_exec_cb->start_time, &end_time);
+
+    if (profile_enabled && !hook->deleted)
+        profile_hook_add (hook, time_diff);
+
+    if ((debug_long_callbacks > 0) && (time_diff >= debug_long_callbacks))
     {
-        gettimeofday (&end_time, NULL);
-        time_diff = util_timeval_diff (&hook_exec_cb->start_time, &end_time);
-        if (time_diff >= debug_long_callbacks)
-        {
-            str_diff = util_get_microseconds_string (time_diff);
-            log_printf (
-                _("debug: long callback: hook %s (%s), plugin: %s, "
-                  "subplugin: %s, time elapsed: %s"),
-                hook_type_string[hook->type],
-                hook_get_description (hook),
-                plugin_get_name (hook->plugin),
-                (hook->subplugin) ? hook->subplugin : "-",
-                str_diff);
-            free (str_diff);
-        }
+        str_diff = util_get_microseconds_string (time_diff);
+        log_printf (
+            _("debug: long callback: hook %s (%s), plugin: %s, "
+              "subplugin: %s, time elapsed: %s"),
+            hook_type_string[hook->type],
+            hook_get_description (hook),
+            plugin_get_name (hook->plugin),
+            (hook->subplugin) ? hook->subplugin : "-",
+            str_diff);
+        free (str_diff);
     }
 }
 
@@ -596,6 +727,23 @@ hook_set (struct t_hook *hook, const char *property, const char *value)
             HOOK_PROCESS(hook, child_write[HOOK_PROCESS_STDIN]) = -1;
         }
     }
+    else if ((strcmp (property, "flag_read") == 0)
+             || (strcmp (property, "flag_write") == 0)
+             || (strcmp (property, "flag_exception") == 0))
+    {
+        hook_fd_set (hook, property, value);
+    }
+    else if (strcmp (property, "slack") == 0)
+    {
+        hook_timer_set (hook, property, value);
+    }
+    else if ((strcmp (property, "cache_signal") == 0)
+             || (strcmp (property, "cache_config") == 0)
+             || (strcmp (property, "cache_clear") == 0)
+             || (strcmp (property, "cache") == 0))
+    {
+        hook_info_set (hook, property, value);
+    }
     else if (strcmp (property, "signal") == 0)
     {
         if (!hook->deleted
@@ -701,6 +849,7 @@ unhook (struct t_hook *hook)
         free (hook->callback_data);
         hook->callback_data = NULL;
     }
+    profile_hook_free (hook);
 
     /* remove hook from list (if there's no hook exec pending) */
     if (hook_exec_recursion == 0)
@@ -937,6 +1086,7 @@ hook_print_log ()
             log_printf ("  priority. . . . . . . . : %d", ptr_hook->priority);
             log_printf ("  callback_pointer. . . . : %p", ptr_hook->callback_pointer);
             log_printf ("  callback_data . . . . . : %p", ptr_hook->callback_data);
+            log_printf ("  profile . . . . . . . . : %p", ptr_hook->profile);
             if (ptr_hook->deleted)
                 continue;
 
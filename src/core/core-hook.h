@@ -48,9 +48,11 @@ struct t_gui_line;
 struct t_gui_completion;
 struct t_gui_window;
 struct t_weelist;
+struct t_arraylist;
 struct t_hashtable;
 struct t_infolist;
 struct t_infolist_item;
+struct t_profile_hook;
 
 /* hook types */
 
@@ -105,6 +107,8 @@ struct t_hook
     int priority;                      /* priority (to sort hooks)          */
     const void *callback_pointer;      /* pointer sent to callback          */
     void *callback_data;               /* data sent to callback             */
+    struct t_profile_hook *profile;    /* profiler stats (NULL if the hook  */
+                                       /* was not called while profiling)   */
 
     /* hook data (depends on hook type) */
     void *hook_data;                   /* hook specific data                */
@@ -132,6 +136,9 @@ extern long long hook_debug_long_callbacks;
 
 extern void hook_init ();
 extern void hook_add_to_list (struct t_hook *new_hook);
+extern void hook_index_name_add (struct t_hook *hook, const char *name);
+extern void hook_index_name_remove (struct t_hook *hook, const char *name);
+extern struct t_arraylist *hook_index_name_get (int type, const char *name);
 extern void hook_init_data (struct t_hook *hook,
                             struct t_weechat_plugin *plugin,
                             int type, int priority,
@@ -27,9 +27,11 @@
 #include <string.h>
 
 #include "weechat.h"
+#include "core-hashtable.h"
 #include "core-log.h"
 #include "core-string.h"
 #include "core-infolist.h"
+#include "../plugins/plugin.h"
 
 
 struct t_infolist *weechat_infolists = NULL;
@@ -58,6 +60,7 @@ infolist_new (struct t_weechat_plugin *plugin)
         new_infolist->items = NULL;
         new_infolist->last_item = NULL;
         new_infolist->ptr_item = NULL;
+        new_infolist->names = NULL;
 
         new_infolist->prev_infolist = last_weechat_infolist;
         new_infolist->next_infolist = NULL;
@@ -112,8 +115,11 @@ infolist_new_item (struct t_infolist *infolist)
     new_item = malloc (sizeof (*new_item));
     if (new_item)
     {
+        new_item->infolist = infolist;
         new_item->vars = NULL;
         new_item->last_var = NULL;
+        new_item->hint_var = (infolist->last_item) ?
+            infolist->last_item->vars : NULL;
         new_item->fields = NULL;
 
         new_item->prev_item = infolist->last_item;
@@ -128,6 +134,90 @@ infolist_new_item (struct t_infolist *infolist)
     return new_item;
 }
 
+/*
+ * Gets name of a variable shared by all items of an infolist.
+ *
+ * If create == 1 and the name is not yet in infolist, it is added.
+ *
+ * Returns pointer to the shared name, NULL if not found or error.
+ */
+
+char *
+infolist_get_shared_name (struct t_infolist *infolist, const char *name,
+                          int create)
+{
+    struct t_hashtable_item *ptr_item;
+
+    if (!infolist->names)
+    {
+        if (!create)
+            return NULL;
+        infolist->names = hashtable_new (32,
+                                         WEECHAT_HASHTABLE_STRING,
+                                         WEECHAT_HASHTABLE_POINTER,
+                                         NULL, NULL);
+        if (!infolist->names)
+            return NULL;
+    }
+
+    ptr_item = hashtable_get_item (infolist->names, name, NULL);
+    if (!ptr_item && create)
+        ptr_item = hashtable_set (infolist->names, name, NULL);
+
+    return (ptr_item) ? (char *)ptr_item->key : NULL;
+}
+
+/*
+ * Creates a new variable in an item (value is not set).
+ *
+ * The name is shared with variables of same name in other items: most of
+ * times items have the same variables in same order, so the variable at same
+ * position in previous item is checked first, before searching in names of
+ * infolist.
+ *
+ * Returns pointer to new variable, NULL if error.
+ */
+
+struct t_infolist_var *
+infolist_var_new (struct t_infolist_item *item, const char *name,
+                  enum t_infolist_type type)
+{
+    struct t_infolist_var *new_var;
+    char *shared_name;
+
+    if (item->hint_var && (strcmp (item->hint_var->name, name) == 0))
+    {
+        shared_name = item->hint_var->name;
+    }
+    else
+    {
+        shared_name = infolist_get_shared_name (item->infolist, name, 1);
+        if (!shared_name)
+            return NULL;
+    }
+    if (item->hint_var)
+        item->hint_var = item->hint_var->next_var;
+
+    new_var = malloc (sizeof (*new_var));
+    if (!new_var)
+        return NULL;
+
+    new_var->name = shared_name;
+    new_var->type = type;
+    new_var->value = NULL;
+    new_var->size = 0;
+
+    new_var->prev_var = item->last_var;
+    new_var->next_var = NULL;
+    if (item->last_var)
+        item->last_var->next_var = new_var;
+    else
+        item->vars = new_var;
+    item->last_var = new_var;
+
+    return new_var;
+}
+
 /*
  * Creates a new integer variable in an item.
  *
@@ -143,23 +233,11 @@ infolist_new_var_integer (struct t_infolist_item *item,
     if (!item || !name || !name[0])
         return NULL;
 
-    new_var = malloc (sizeof (*new_var));
+    new_var = infolist_var_new (item, name, INFOLIST_INTEGER);
     if (new_var)
     {
-        new_var->name = strdup (name);
-        new_var->type = INFOLIST_INTEGER;
-        new_var->value = malloc (sizeof (int));
-        if (new_var->value)
-            *((int *)new_var->value) = value;
-        new_var->size = 0;  /* not used for an integer */
-
-        new_var->prev_var = item->last_var;
-        new_var->next_var = NULL;
-        if (item->last_var)
-            item->last_var->next_var = new_var;
-        else
-            item->vars = new_var;
-        item->last_var = new_var;
+        new_var->scalar.integer = value;
+        new_var->value = &(new_var->scalar.integer);
     }
 
     return new_var;
@@ -180,22 +258,9 @@ infolist_new_var_string (struct t_infolist_item *item,
     if (!item || !name || !name[0])
         return NULL;
 
-    new_var = malloc (sizeof (*new_var));
+    new_var = infolist_var_new (item, name, INFOLIST_STRING);
     if (new_var)
-    {
-        new_var->name = strdup (name);
-        new_var->type = INFOLIST_STRING;
         new_var->value = (value) ? strdup (value) : NULL;
-        new_var->size = 0;  /* not used for a string */
-
-        new_var->prev_var = item->last_var;
-        new_var->next_var = NULL;
-        if (item->last_var)
-            item->last_var->next_var = new_var;
-        else
-            item->vars = new_var;
-        item->last_var = new_var;
-    }
 
     return new_var;
 }
@@ -215,22 +280,9 @@ infolist_new_var_pointer (struct t_infolist_item *item,
     if (!item || !name || !name[0])
         return NULL;
 
-    new_var = malloc (sizeof (*new_var));
+    new_var = infolist_var_new (item, name, INFOLIST_POINTER);
     if (new_var)
-    {
-        new_var->name = strdup (name);
-        new_var->type = INFOLIST_POINTER;
         new_var->value = pointer;
-        new_var->size = 0;  /* not used for a pointer */
-
-        new_var->prev_var = item->last_var;
-        new_var->next_var = NULL;
-        if (item->last_var)
-            item->last_var->next_var = new_var;
-        else
-            item->vars = new_var;
-        item->last_var = new_var;
-    }
 
     return new_var;
 }
@@ -250,23 +302,13 @@ infolist_new_var_buffer (struct t_infolist_item *item,
     if (!item || !name || !name[0] || (size <= 0))
         return NULL;
 
-    new_var = malloc (sizeof (*new_var));
+    new_var = infolist_var_new (item, name, INFOLIST_BUFFER);
     if (new_var)
     {
-        new_var->name = strdup (name);
-        new_var->type = INFOLIST_BUFFER;
         new_var->value = malloc (size);
         if (new_var->value)
             memcpy (new_var->value, pointer, size);
         new_var->size = size;
-
-        new_var->prev_var = item->last_var;
-        new_var->next_var = NULL;
-        if (item->last_var)
-            item->last_var->next_var = new_var;
-        else
-            item->vars = new_var;
-        item->last_var = new_var;
     }
 
     return new_var;
@@ -287,23 +329,11 @@ infolist_new_var_time (struct t_infolist_item *item,
     if (!item || !name || !name[0])
         return NULL;
 
-    new_var = malloc (sizeof (*new_var));
+    new_var = infolist_var_new (item, name, INFOLIST_TIME);
     if (new_var)
     {
-        new_var->name = strdup (name);
-        new_var->type = INFOLIST_TIME;
-        new_var->value = malloc (sizeof (time_t));
-        if (new_var->value)
-            *((time_t *)new_var->value) = time;
-        new_var->size = 0;  /* not used for a time */
-
-        new_var->prev_var = item->last_var;
-        new_var->next_var = NULL;
-        if (item->last_var)
-            item->last_var->next_var = new_var;
-        else
-            item->vars = new_var;
-        item->last_var = new_var;
+        new_var->scalar.time = time;
+        new_var->value = &(new_var->scalar.time);
     }
 
     return new_var;
@@ -366,20 +396,28 @@ infolist_reset_item_cursor (struct t_infolist *infolist)
 
 /*
  * Searches for a variable in current infolist item.
+ *
+ * The name is resolved once in names of infolist, then variables of item
+ * are compared by pointer on their shared name.
  */
 
 struct t_infolist_var *
 infolist_search_var (struct t_infolist *infolist, const char *name)
 {
     struct t_infolist_var *ptr_var;
+    const char *shared_name;
 
     if (!infolist || !infolist->ptr_item || !name || !name[0])
         return NULL;
 
+    shared_name = infolist_get_shared_name (infolist, name, 0);
+    if (!shared_name)
+        return NULL;
+
     for (ptr_var = infolist->ptr_item->vars; ptr_var;
          ptr_var = ptr_var->next_var)
     {
-        if (strcmp (ptr_var->name, name) == 0)
+        if (ptr_var->name == shared_name)
             return ptr_var;
     }
 
@@ -430,23 +468,14 @@ infolist_integer (struct t_infolist *infolist, const char *var)
 {
     struct t_infolist_var *ptr_var;
 
-    if (!infolist || !infolist->ptr_item || !var || !var[0])
+    ptr_var = infolist_search_var (infolist, var);
+    if (!ptr_var)
         return 0;
 
-    for (ptr_var = infolist->ptr_item->vars; ptr_var;
-         ptr_var = ptr_var->next_var)
-    {
-        if (strcmp (ptr_var->name, var) == 0)
-        {
-            if (ptr_var->type == INFOLIST_INTEGER)
-                return *((int *)ptr_var->value);
-            else
-                return 0;
-        }
-    }
-
-    /* variable not found */
-    return 0;
+    if (ptr_var->type == INFOLIST_INTEGER)
+        return *((int *)ptr_var->value);
+    else
+        return 0;
 }
 
 /*
@@ -458,23 +487,14 @@ infolist_string (struct t_infolist *infolist, const char *var)
 {
     struct t_infolist_var *ptr_var;
 
-    if (!infolist || !infolist->ptr_item || !var || !var[0])
+    ptr_var = infolist_search_var (infolist, var);
+    if (!ptr_var)
         return NULL;
 
-    for (ptr_var = infolist->ptr_item->vars; ptr_var;
-         ptr_var = ptr_var->next_var)
-    {
-        if (strcmp (ptr_var->name, var) == 0)
-        {
-            if (ptr_var->type == INFOLIST_STRING)
-                return (char *)ptr_var->value;
-            else
-                return NULL;
-        }
-    }
-
-    /* variable not found */
-    return NULL;
+    if (ptr_var->type == INFOLIST_STRING)
+        return (char *)ptr_var->value;
+    else
+        return NULL;
 }
 
 /*
@@ -486,23 +506,14 @@ infolist_pointer (struct t_infolist *infolist, const char *var)
 {
     struct t_infolist_var *ptr_var;
 
-    if (!infolist || !infolist->ptr_item || !var || !var[0])
+    ptr_var = infolist_search_var (infolist, var);
+    if (!ptr_var)
         return NULL;
 
-    for (ptr_var = infolist->ptr_item->vars; ptr_var;
-         ptr_var = ptr_var->next_var)
-    {
-        if (strcmp (ptr_var->name, var) == 0)
-        {
-            if (ptr_var->type == INFOLIST_POINTER)
-                return ptr_var->value;
-            else
-                return NULL;
-        }
-    }
-
-    /* variable not found */
-    return NULL;
+    if (ptr_var->type == INFOLIST_POINTER)
+        return ptr_var->value;
+    else
+        return NULL;
 }
 
 /*
@@ -517,26 +528,17 @@ infolist_buffer (struct t_infolist *infolist, const char *var,
 {
     struct t_infolist_var *ptr_var;
 
-    if (!infolist || !infolist->ptr_item || !var || !var[0])
+    ptr_var = infolist_search_var (infolist, var);
+    if (!ptr_var)
         return NULL;
 
-    for (ptr_var = infolist->ptr_item->vars; ptr_var;
-         ptr_var = ptr_var->next_var)
+    if (ptr_var->type == INFOLIST_BUFFER)
     {
-        if (strcmp (ptr_var->name, var) == 0)
-        {
-            if (ptr_var->type == INFOLIST_BUFFER)
-            {
-                *size = ptr_var->size;
-                return ptr_var->value;
-            }
-            else
-                return NULL;
-        }
+        *size = ptr_var->size;
+        return ptr_var->value;
     }
-
-    /* variable not found */
-    return NULL;
+    else
+        return NULL;
 }
 
 /*
@@ -548,23 +550,14 @@ infolist_time (struct t_infolist *infolist, const char *var)
 {
     struct t_infolist_var *ptr_var;
 
-    if (!infolist || !infolist->ptr_item || !var || !var[0])
+    ptr_var = infolist_search_var (infolist, var);
+    if (!ptr_var)
         return 0;
 
-    for (ptr_var = infolist->ptr_item->vars; ptr_var;
-         ptr_var = ptr_var->next_var)
-    {
-        if (strcmp (ptr_var->name, var) == 0)
-        {
-            if (ptr_var->type == INFOLIST_TIME)
-                return *((time_t *)ptr_var->value);
-            else
-                return 0;
-        }
-    }
-
-    /* variable not found */
-    return 0;
+    if (ptr_var->type == INFOLIST_TIME)
+        return *((time_t *)ptr_var->value);
+    else
+        return 0;
 }
 
 /*
@@ -594,12 +587,9 @@ infolist_var_free (struct t_infolist_item *item,
     if (var->next_var)
         (var->next_var)->prev_var = var->prev_var;
 
-    /* free data */
-    free (var->name);
-    if (((var->type == INFOLIST_INTEGER)
-         || (var->type == INFOLIST_STRING)
-         || (var->type == INFOLIST_BUFFER)
-         || (var->type == INFOLIST_TIME))
+    /* free data (name is owned by infolist, integer/time are in var) */
+    if (((var->type == INFOLIST_STRING)
+         || (var->type == INFOLIST_BUFFER))
         && var->value)
     {
         free (var->value);
@@ -680,6 +670,7 @@ infolist_free (struct t_infolist *infolist)
     {
         infolist_item_free (infolist, infolist->items);
     }
+    hashtable_free (infolist->names);
 
     free (infolist);
 
@@ -725,6 +716,7 @@ infolist_print_log ()
         log_printf ("  items. . . . . . . . . : %p", ptr_infolist->items);
         log_printf ("  last_item. . . . . . . : %p", ptr_infolist->last_item);
         log_printf ("  ptr_item . . . . . . . : %p", ptr_infolist->ptr_item);
+        log_printf ("  names. . . . . . . . . : %p", ptr_infolist->names);
         log_printf ("  prev_infolist. . . . . : %p", ptr_infolist->prev_infolist);
         log_printf ("  next_infolist. . . . . : %p", ptr_infolist->next_infolist);
 
@@ -733,8 +725,10 @@ infolist_print_log ()
         {
             log_printf ("");
             log_printf ("    [item (addr:%p)]", ptr_item);
+            log_printf ("      infolist . . . . . . . : %p", ptr_item->infolist);
             log_printf ("      vars . . . . . . . . . : %p", ptr_item->vars);
             log_printf ("      last_var . . . . . . . : %p", ptr_item->last_var);
+            log_printf ("      hint_var . . . . . . . : %p", ptr_item->hint_var);
             log_printf ("      prev_item. . . . . . . : %p", ptr_item->prev_item);
             log_printf ("      next_item. . . . . . . : %p", ptr_item->next_item);
 
@@ -23,6 +23,7 @@
 #include <time.h>
 
 struct t_weechat_plugin;
+struct t_hashtable;
 
 /* list structures */
 
@@ -39,18 +40,27 @@ enum t_infolist_type
 
 struct t_infolist_var
 {
-    char *name;                        /* variable name                     */
+    char *name;                        /* variable name (shared by all      */
+                                       /* items, owned by infolist)         */
     enum t_infolist_type type;         /* type: int, string, ...            */
     void *value;                       /* pointer to value                  */
     int size;                          /* for type buffer                   */
+    union
+    {
+        int integer;                   /* value for type integer            */
+        time_t time;                   /* value for type time               */
+    } scalar;                          /* (value points to this union)      */
     struct t_infolist_var *prev_var;   /* link to previous variable         */
     struct t_infolist_var *next_var;   /* link to next variable             */
 };
 
 struct t_infolist_item
 {
+    struct t_infolist *infolist;       /* infolist containing this item     */
     struct t_infolist_var *vars;       /* item variables                    */
     struct t_infolist_var *last_var;   /* last variable                     */
+    struct t_infolist_var *hint_var;   /* var of previous item expected at  */
+                                       /* same position (to reuse its name) */
     char *fields;                      /* fields list (NULL if never asked) */
     struct t_infolist_item *prev_item; /* link to previous item             */
     struct t_infolist_item *next_item; /* link to next item                 */
@@ -63,6 +73,8 @@ struct t_infolist
     struct t_infolist_item *items;     /* link to items                     */
     struct t_infolist_item *last_item; /* last variable                     */
     struct t_infolist_item *ptr_item;  /* pointer to current item           */
+    struct t_hashtable *names;         /* names of variables (keys are      */
+                                       /* shared by vars of all items)      */
     struct t_infolist *prev_infolist;  /* link to previous list             */
     struct t_infolist *next_infolist;  /* link to next list                 */
 };
@@ -77,6 +89,11 @@ extern struct t_infolist *last_weechat_infolist;
 extern struct t_infolist *infolist_new (struct t_weechat_plugin *plugin);
 extern int infolist_valid (struct t_infolist *infolist);
 extern struct t_infolist_item *infolist_new_item (struct t_infolist *infolist);
+extern char *infolist_get_shared_name (struct t_infolist *infolist,
+                                       const char *name, int create);
+extern struct t_infolist_var *infolist_var_new (struct t_infolist_item *item,
+                                                const char *name,
+                                                enum t_infolist_type type);
 extern struct t_infolist_var *infolist_new_var_integer (struct t_infolist_item *item,
                                                         const char *name,
                                                         int value);
@@ -252,6 +252,13 @@ input_data (struct t_gui_buffer *buffer, const char *data,
     if (!buffer || !gui_buffer_valid (buffer) || !data)
         return WEECHAT_RC_ERROR;
 
+    /*
+     * commands and text are not allowed in a child process (the child shares
+     * the sockets of WeeChat process, for example with IRC servers)
+     */
+    if (hook_process_in_child)
+        return WEECHAT_RC_ERROR;
+
     rc = WEECHAT_RC_OK;
 
     buffer_full_name = NULL;
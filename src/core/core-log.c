@@ -49,6 +49,11 @@ char *weechat_log_filename = NULL; /* WeeChat log filename (weechat.log)    */
 FILE *weechat_log_file = NULL;     /* WeeChat log file                      */
 int weechat_log_use_time = 1;      /* 0 to temporary disable time in log,   */
                                    /* for example when dumping data         */
+int log_flush_delayed = 0;         /* 1 if flush of log file is delayed     */
+                                   /* (done once per main loop iteration)   */
+int log_flush_pending = 0;         /* 1 if log file must be flushed         */
+time_t log_date_last = 0;          /* date of last prefix built             */
+char log_date_prefix[128] = "";    /* last prefix with date: "[...] "       */
 
 
 /*
@@ -137,16 +142,46 @@ log_init ()
                 version_get_compilation_time ());
 }
 
+/*
+ * Returns prefix with current date for a line in log file.
+ *
+ * The prefix is built only when the date (in seconds) changes.
+ */
+
+const char *
+log_date_prefix_get ()
+{
+    time_t seconds;
+    struct tm *date_tmp;
+
+    seconds = time (NULL);
+    if (!log_date_prefix[0] || (seconds != log_date_last))
+    {
+        date_tmp = localtime (&seconds);
+        if (!date_tmp)
+            return "";
+        snprintf (log_date_prefix, sizeof (log_date_prefix),
+                  "[%04d-%02d-%02d %02d:%02d:%02d] ",
+                  date_tmp->tm_year + 1900, date_tmp->tm_mon + 1,
+                  date_tmp->tm_mday, date_tmp->tm_hour,
+                  date_tmp->tm_min, date_tmp->tm_sec);
+        log_date_last = seconds;
+    }
+    return log_date_prefix;
+}
+
 /*
  * Writes a message in WeeChat log file.
+ *
+ * The file is flushed immediately, unless the flush is delayed (in main loop):
+ * then it is flushed by function log_flush, called once per iteration of the
+ * main loop.
  */
 
 void
 log_printf (const char *message, ...)
 {
     char *ptr_buffer;
-    static time_t seconds;
-    struct tm *date_tmp;
 
     if (!weechat_log_file)
         return;
@@ -165,31 +200,46 @@ log_printf (const char *message, ...)
             ptr_buffer++;
         }
 
-        if (weechat_log_use_time)
-        {
-            seconds = time (NULL);
-            date_tmp = localtime (&seconds);
-            if (date_tmp)
-            {
-                string_fprintf (weechat_log_file,
-                                "[%04d-%02d-%02d %02d:%02d:%02d] %s\n",
-                                date_tmp->tm_year + 1900, date_tmp->tm_mon + 1,
-                                date_tmp->tm_mday, date_tmp->tm_hour,
-                                date_tmp->tm_min, date_tmp->tm_sec,
-                                vbuffer);
-            }
-            else
-                string_fprintf (weechat_log_file, "%s\n", vbuffer);
-        }
-        else
-            string_fprintf (weechat_log_file, "%s\n", vbuffer);
+        string_fprintf (weechat_log_file, "%s%s\n",
+                        (weechat_log_use_time) ? log_date_prefix_get () : "",
+                        vbuffer);
 
-        fflush (weechat_log_file);
+        if (log_flush_delayed)
+            log_flush_pending = 1;
+        else
+            fflush (weechat_log_file);
 
         free (vbuffer);
     }
 }
 
+/*
+ * Flushes WeeChat log file if some messages have been written since last
+ * flush.
+ */
+
+void
+log_flush ()
+{
+    if (log_flush_pending && weechat_log_file)
+        fflush (weechat_log_file);
+    log_flush_pending = 0;
+}
+
+/*
+ * Enables or disables delayed flush of WeeChat log file.
+ *
+ * When the delayed flush is disabled, the log file is flushed immediately.
+ */
+
+void
+log_set_flush_delayed (int delayed)
+{
+    log_flush_delayed = (delayed) ? 1 : 0;
+    if (!log_flush_delayed)
+        log_flush ();
+}
+
 /*
  * Dumps a string as hexa data in WeeChat log file.
  */
@@ -240,6 +290,7 @@ log_close ()
         fclose (weechat_log_file);
         weechat_log_file = NULL;
     }
+    log_flush_pending = 0;
 
     /* free filename */
     if (weechat_log_filename)
@@ -30,6 +30,8 @@ extern void log_init ();
 extern void log_close ();
 extern void log_printf (const char *message, ...);
 extern void log_printf_hexa (const char *spaces, const char *string);
+extern void log_flush ();
+extern void log_set_flush_delayed (int delayed);
 extern int log_crash_rename ();
 
 #endif /* WEECHAT_LOG_H */
@@ -46,6 +46,7 @@
 #include <netdb.h>
 #include <resolv.h>
 #include <errno.h>
+#include <signal.h>
 #include <gcrypt.h>
 #include <sys/time.h>
 #if defined(__OpenBSD__)
@@ -76,6 +77,9 @@ int network_num_certs = 0;        /* number of certs loaded (system + user) */
 gnutls_certificate_credentials_t gnutls_xcred; /* GnuTLS client credentials */
 
 
+int network_connect_async_fd_cb (const void *pointer, void *data, int fd);
+
+
 /*
  * Initializes gcrypt.
  */
@@ -923,6 +927,318 @@ error:
     return -1;
 }
 
+/*
+ * Creates a name resolution of a peer address (and optional local hostname),
+ * to run in a thread with network_resolve_start().
+ *
+ * Returns pointer to new resolution, NULL if error.
+ */
+
+struct t_network_resolve *
+network_resolve_new (const char *address, int port, int family,
+                     const char *local_hostname)
+{
+    struct t_network_resolve *new_resolve;
+    char str_port[NI_MAXSERV + 1];
+    int resolve_pipe[2];
+
+    if (!address || !address[0])
+        return NULL;
+
+    new_resolve = malloc (sizeof (*new_resolve));
+    if (!new_resolve)
+        return NULL;
+
+    if (pipe (resolve_pipe) < 0)
+    {
+        free (new_resolve);
+        return NULL;
+    }
+
+    snprintf (str_port, sizeof (str_port), "%d", port);
+
+    pthread_mutex_init (&new_resolve->mutex, NULL);
+    new_resolve->refcount = 1;
+    new_resolve->done = 0;
+    new_resolve->address = strdup (address);
+    new_resolve->port = strdup (str_port);
+    new_resolve->family = family;
+    new_resolve->local_hostname = (local_hostname && local_hostname[0]) ?
+        strdup (local_hostname) : NULL;
+    new_resolve->pipe_read = resolve_pipe[0];
+    new_resolve->pipe_write = resolve_pipe[1];
+    new_resolve->rc_remote = 0;
+    new_resolve->rc_local = 0;
+    new_resolve->res_remote = NULL;
+    new_resolve->res_local = NULL;
+
+    if (!new_resolve->address || !new_resolve->port)
+    {
+        network_resolve_unref (new_resolve);
+        return NULL;
+    }
+
+    return new_resolve;
+}
+
+/*
+ * Releases a name resolution: it is freed when it is not used any more
+ * (by the thread and by the connect hook).
+ */
+
+void
+network_resolve_unref (struct t_network_resolve *resolve)
+{
+    int refcount;
+
+    if (!resolve)
+        return;
+
+    pthread_mutex_lock (&resolve->mutex);
+    refcount = --resolve->refcount;
+    pthread_mutex_unlock (&resolve->mutex);
+
+    if (refcount > 0)
+        return;
+
+    free (resolve->address);
+    free (resolve->port);
+    free (resolve->local_hostname);
+    if (resolve->res_remote)
+        freeaddrinfo (resolve->res_remote);
+    if (resolve->res_local)
+        freeaddrinfo (resolve->res_local);
+    close (resolve->pipe_read);
+    close (resolve->pipe_write);
+    pthread_mutex_destroy (&resolve->mutex);
+
+    free (resolve);
+}
+
+/*
+ * Resolves names (function executed in a thread).
+ *
+ * When done, one byte is written in the pipe, so that the main thread is
+ * notified by a fd hook.
+ */
+
+void *
+network_resolve_thread (void *arg)
+{
+    struct t_network_resolve *resolve;
+    struct addrinfo hints, *res_remote, *res_local;
+    int rc_remote, rc_local, num_written;
+
+    resolve = (struct t_network_resolve *)arg;
+
+    res_remote = NULL;
+    res_local = NULL;
+    rc_local = 0;
+
+    memset (&hints, 0, sizeof (hints));
+    hints.ai_family = resolve->family;
+    hints.ai_socktype = SOCK_STREAM;
+#ifdef AI_ADDRCONFIG
+    hints.ai_flags = AI_ADDRCONFIG;
+#endif /* AI_ADDRCONFIG */
+    res_init ();
+    rc_remote = getaddrinfo (resolve->address, resolve->port,
+                             &hints, &res_remote);
+
+    if ((rc_remote == 0) && res_remote && resolve->local_hostname)
+    {
+        hints.ai_family = AF_UNSPEC;
+        rc_local = getaddrinfo (resolve->local_hostname, NULL,
+                                &hints, &res_local);
+    }
+
+    pthread_mutex_lock (&resolve->mutex);
+    resolve->rc_remote = rc_remote;
+    resolve->res_remote = res_remote;
+    resolve->rc_local = rc_local;
+    resolve->res_local = res_local;
+    resolve->done = 1;
+    pthread_mutex_unlock (&resolve->mutex);
+
+    num_written = write (resolve->pipe_write, "1", 1);
+    (void) num_written;
+
+    network_resolve_unref (resolve);
+
+    return NULL;
+}
+
+/*
+ * Starts the name resolution in a detached thread.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (thread not created)
+ */
+
+int
+network_resolve_start (struct t_network_resolve *resolve)
+{
+    pthread_t thread_id;
+    pthread_attr_t attr;
+    sigset_t set, old_set;
+    int rc;
+
+    if (!resolve)
+        return 0;
+
+    if (pthread_attr_init (&attr) != 0)
+        return 0;
+    pthread_attr_setdetachstate (&attr, PTHREAD_CREATE_DETACHED);
+
+    /* reference for the thread */
+    pthread_mutex_lock (&resolve->mutex);
+    resolve->refcount++;
+    pthread_mutex_unlock (&resolve->mutex);
+
+    /* signals are handled by the main thread only */
+    sigfillset (&set);
+    pthread_sigmask (SIG_SETMASK, &set, &old_set);
+    rc = pthread_create (&thread_id, &attr, &network_resolve_thread, resolve);
+    pthread_sigmask (SIG_SETMASK, &old_set, NULL);
+
+    pthread_attr_destroy (&attr);
+
+    if (rc != 0)
+    {
+        network_resolve_unref (resolve);
+        return 0;
+    }
+
+    return 1;
+}
+
+/*
+ * Builds the list of addresses to try for a connection: addresses are grouped
+ * by family (for example: IPv6, then IPv4), the groups are rotated by "retry"
+ * (something is wrong with the group tried first if the connection is
+ * retried, so start at a different offset to increase the chance of success)
+ * and addresses are shuffled inside each group.
+ *
+ * Returns the number of addresses in *res_reorder (array must be freed after
+ * use), 0 if no address was found, -1 if error.
+ */
+
+int
+network_connect_reorder_addresses (struct addrinfo *res_remote, int retry,
+                                   struct addrinfo ***res_reorder)
+{
+    struct addrinfo *ptr_res, **reorder;
+    int rand_num, i, num_groups, tmp_num_groups, num_hosts, tmp_host;
+    int last_af;
+
+    if (!res_reorder)
+        return -1;
+
+    *res_reorder = NULL;
+
+    /*
+     * count all the groups of hosts by tracking family, e.g.
+     * 0 = [2001:db8::1, 2001:db8::2,
+     * 1 =  192.0.2.1, 192.0.2.2,
+     * 2 =  2002:c000:201::1, 2002:c000:201::2]
+     */
+    last_af = AF_UNSPEC;
+    num_groups = 0;
+    num_hosts = 0;
+    for (ptr_res = res_remote; ptr_res; ptr_res = ptr_res->ai_next)
+    {
+        if (ptr_res->ai_family != last_af)
+            if (last_af != AF_UNSPEC)
+                num_groups++;
+
+        num_hosts++;
+        last_af = ptr_res->ai_family;
+    }
+    if (last_af != AF_UNSPEC)
+        num_groups++;
+
+    /* no IP addresses found (all AF_UNSPEC) */
+    if (num_groups == 0)
+        return 0;
+
+    reorder = malloc (sizeof (*reorder) * num_hosts);
+    if (!reorder)
+        return -1;
+
+    /* reorder groups */
+    retry %= num_groups;
+    i = 0;
+
+    last_af = AF_UNSPEC;
+    tmp_num_groups = 0;
+    tmp_host = i; /* start of current group */
+
+    /* top of list */
+    for (ptr_res = res_remote; ptr_res; ptr_res = ptr_res->ai_next)
+    {
+        if (ptr_res->ai_family != last_af)
+        {
+            if (last_af != AF_UNSPEC)
+                tmp_num_groups++;
+
+            tmp_host = i;
+        }
+
+        if (tmp_num_groups >= retry)
+        {
+            /* shuffle while adding */
+            rand_num = tmp_host + (rand () % ((i + 1) - tmp_host));
+            if (rand_num == i)
+                reorder[i++] = ptr_res;
+            else
+            {
+                reorder[i++] = reorder[rand_num];
+                reorder[rand_num] = ptr_res;
+            }
+        }
+
+        last_af = ptr_res->ai_family;
+    }
+
+    last_af = AF_UNSPEC;
+    tmp_num_groups = 0;
+    tmp_host = i; /* start of current group */
+
+    /* remainder of list */
+    for (ptr_res = res_remote; ptr_res; ptr_res = ptr_res->ai_next)
+    {
+        if (ptr_res->ai_family != last_af)
+        {
+            if (last_af != AF_UNSPEC)
+                tmp_num_groups++;
+
+            tmp_host = i;
+        }
+
+        if (tmp_num_groups < retry)
+        {
+            /* shuffle while adding */
+            rand_num = tmp_host + (rand () % ((i + 1) - tmp_host));
+            if (rand_num == i)
+                reorder[i++] = ptr_res;
+            else
+            {
+                reorder[i++] = reorder[rand_num];
+                reorder[rand_num] = ptr_res;
+            }
+        }
+        else
+            break;
+
+        last_af = ptr_res->ai_family;
+    }
+
+    *res_reorder = reorder;
+
+    return num_hosts;
+}
+
 /*
  * Connects to peer in a child process.
  */
@@ -938,21 +1254,13 @@ network_connect_child (struct t_hook *hook_connect)
     char status_without_string[1 + 5 + 1];
     const char *error;
     int rc, length, num_written;
-    int sock, set, flags, j;
+    int sock, set, flags, i, j, num_hosts;
     struct msghdr msg;
     struct cmsghdr *cmsg;
     char msg_buf[CMSG_SPACE(sizeof (sock))];
     struct iovec iov[1];
     char iov_data[1] = { 0 };
-    /*
-     * indicates that something is wrong with whichever group of
-     * servers is being tried first after connecting, so start at
-     * a different offset to increase the chance of success
-     */
-    int retry, rand_num, i;
-    int num_groups, tmp_num_groups, num_hosts, tmp_host;
     struct addrinfo **res_reorder;
-    int last_af;
     struct timeval tv_time;
 
     res_local = NULL;
@@ -1108,29 +1416,9 @@ network_connect_child (struct t_hook *hook_connect)
 
     /* res_local != NULL now indicates that bind() is required */
 
-    /*
-     * count all the groups of hosts by tracking family, e.g.
-     * 0 = [2001:db8::1, 2001:db8::2,
-     * 1 =  192.0.2.1, 192.0.2.2,
-     * 2 =  2002:c000:201::1, 2002:c000:201::2]
-     */
-    last_af = AF_UNSPEC;
-    num_groups = 0;
-    num_hosts = 0;
-    for (ptr_res = res_remote; ptr_res; ptr_res = ptr_res->ai_next)
-    {
-        if (ptr_res->ai_family != last_af)
-            if (last_af != AF_UNSPEC)
-                num_groups++;
-
-        num_hosts++;
-        last_af = ptr_res->ai_family;
-    }
-    if (last_af != AF_UNSPEC)
-        num_groups++;
-
-    res_reorder = malloc (sizeof (*res_reorder) * num_hosts);
-    if (!res_reorder)
+    num_hosts = network_connect_reorder_addresses (
+        res_remote, HOOK_CONNECT(hook_connect, retry), &res_reorder);
+    if (num_hosts < 0)
     {
         snprintf (status_without_string, sizeof (status_without_string),
                   "%c00000", '0' + WEECHAT_HOOK_CONNECT_MEMORY_ERROR);
@@ -1139,79 +1427,7 @@ network_connect_child (struct t_hook *hook_connect)
         (void) num_written;
         goto end;
     }
-
-    /* reorder groups */
-    retry = HOOK_CONNECT(hook_connect, retry);
-    if (num_groups > 0)
-    {
-        retry %= num_groups;
-        i = 0;
-
-        last_af = AF_UNSPEC;
-        tmp_num_groups = 0;
-        tmp_host = i; /* start of current group */
-
-        /* top of list */
-        for (ptr_res = res_remote; ptr_res; ptr_res = ptr_res->ai_next)
-        {
-            if (ptr_res->ai_family != last_af)
-            {
-                if (last_af != AF_UNSPEC)
-                    tmp_num_groups++;
-
-                tmp_host = i;
-            }
-
-            if (tmp_num_groups >= retry)
-            {
-                /* shuffle while adding */
-                rand_num = tmp_host + (rand () % ((i + 1) - tmp_host));
-                if (rand_num == i)
-                    res_reorder[i++] = ptr_res;
-                else
-                {
-                    res_reorder[i++] = res_reorder[rand_num];
-                    res_reorder[rand_num] = ptr_res;
-                }
-            }
-
-            last_af = ptr_res->ai_family;
-        }
-
-        last_af = AF_UNSPEC;
-        tmp_num_groups = 0;
-        tmp_host = i; /* start of current group */
-
-        /* remainder of list */
-        for (ptr_res = res_remote; ptr_res; ptr_res = ptr_res->ai_next)
-        {
-            if (ptr_res->ai_family != last_af)
-            {
-                if (last_af != AF_UNSPEC)
-                    tmp_num_groups++;
-
-                tmp_host = i;
-            }
-
-            if (tmp_num_groups < retry)
-            {
-                /* shuffle while adding */
-                rand_num = tmp_host + (rand () % ((i + 1) - tmp_host));
-                if (rand_num == i)
-                    res_reorder[i++] = ptr_res;
-                else
-                {
-                    res_reorder[i++] = res_reorder[rand_num];
-                    res_reorder[rand_num] = ptr_res;
-                }
-            }
-            else
-                break;
-
-            last_af = ptr_res->ai_family;
-        }
-    }
-    else
+    if (num_hosts == 0)
     {
         /* no IP addresses found (all AF_UNSPEC) */
         snprintf (status_without_string, sizeof (status_without_string),
@@ -1566,6 +1782,115 @@ network_connect_gnutls_handshake_timer_cb (const void *pointer,
     return WEECHAT_RC_OK;
 }
 
+/*
+ * Performs the TLS handshake (if TLS is enabled) on the connected socket of
+ * hook, then calls the callback.
+ *
+ * Argument "ip_address" is freed or kept in the hook by this function.
+ *
+ * Note: the hook is unhooked, unless the handshake is still in progress.
+ */
+
+void
+network_connect_connected (struct t_hook *hook_connect, char *ip_address)
+{
+    int rc, direction;
+
+    if (HOOK_CONNECT(hook_connect, gnutls_sess))
+    {
+        /*
+         * the socket needs to be non-blocking since the call to
+         * gnutls_handshake can block
+         */
+        HOOK_CONNECT(hook_connect, handshake_fd_flags) =
+            fcntl (HOOK_CONNECT(hook_connect, sock), F_GETFL);
+        if (HOOK_CONNECT(hook_connect, handshake_fd_flags) == -1)
+            HOOK_CONNECT(hook_connect, handshake_fd_flags) = 0;
+        fcntl (HOOK_CONNECT(hook_connect, sock), F_SETFL,
+               HOOK_CONNECT(hook_connect, handshake_fd_flags) | O_NONBLOCK);
+        gnutls_transport_set_ptr (*HOOK_CONNECT(hook_connect, gnutls_sess),
+                                  (gnutls_transport_ptr_t) ((ptrdiff_t) HOOK_CONNECT(hook_connect, sock)));
+        if (HOOK_CONNECT(hook_connect, gnutls_dhkey_size) > 0)
+        {
+            gnutls_dh_set_prime_bits (*HOOK_CONNECT(hook_connect, gnutls_sess),
+                                      (unsigned int) HOOK_CONNECT(hook_connect, gnutls_dhkey_size));
+        }
+        rc = gnutls_handshake (*HOOK_CONNECT(hook_connect, gnutls_sess));
+        if ((rc == GNUTLS_E_AGAIN) || (rc == GNUTLS_E_INTERRUPTED))
+        {
+            /*
+             * gnutls was unable to proceed with the handshake without
+             * blocking: non fatal error, we just have to wait for an
+             * event about handshake
+             */
+            if (HOOK_CONNECT(hook_connect, hook_fd))
+            {
+                unhook (HOOK_CONNECT(hook_connect, hook_fd));
+                HOOK_CONNECT(hook_connect, hook_fd) = NULL;
+            }
+            direction = gnutls_record_get_direction (*HOOK_CONNECT(hook_connect, gnutls_sess));
+            HOOK_CONNECT(hook_connect, handshake_ip_address) = ip_address;
+            HOOK_CONNECT(hook_connect, handshake_hook_fd) =
+                hook_fd (hook_connect->plugin,
+                         HOOK_CONNECT(hook_connect, sock),
+                         (!direction ? 1 : 0), (direction  ? 1 : 0), 0,
+                         &network_connect_gnutls_handshake_fd_cb,
+                         hook_connect, NULL);
+            HOOK_CONNECT(hook_connect, handshake_hook_timer) =
+                hook_timer (hook_connect->plugin,
+                            CONFIG_INTEGER(config_network_gnutls_handshake_timeout) * 1000,
+                            0, 1,
+                            &network_connect_gnutls_handshake_timer_cb,
+                            hook_connect, NULL);
+            return;
+        }
+        else if (rc != GNUTLS_E_SUCCESS)
+        {
+            (void) (HOOK_CONNECT(hook_connect, callback))
+                (hook_connect->callback_pointer,
+                 hook_connect->callback_data,
+                 WEECHAT_HOOK_CONNECT_GNUTLS_HANDSHAKE_ERROR,
+                 rc, HOOK_CONNECT(hook_connect, sock),
+                 gnutls_strerror (rc),
+                 ip_address);
+            unhook (hook_connect);
+            free (ip_address);
+            return;
+        }
+        fcntl (HOOK_CONNECT(hook_connect, sock), F_SETFL,
+               HOOK_CONNECT(hook_connect, handshake_fd_flags));
+#if LIBGNUTLS_VERSION_NUMBER < 0x02090a /* 2.9.10 */
+        /*
+         * gnutls only has the gnutls_certificate_set_verify_function()
+         * function since version 2.9.10. We need to call our verify
+         * function manually after the handshake for old gnutls versions
+         */
+        if (hook_connect_gnutls_verify_certificates (*HOOK_CONNECT(hook_connect, gnutls_sess)) != 0)
+        {
+            (void) (HOOK_CONNECT(hook_connect, callback))
+                (hook_connect->callback_pointer,
+                 hook_connect->callback_data,
+                 WEECHAT_HOOK_CONNECT_GNUTLS_HANDSHAKE_ERROR,
+                 rc, HOOK_CONNECT(hook_connect, sock),
+                 "Error in the certificate.",
+                 ip_address);
+            unhook (hook_connect);
+            free (ip_address);
+            return;
+        }
+#endif /* LIBGNUTLS_VERSION_NUMBER < 0x02090a */
+    }
+
+    (void) (HOOK_CONNECT(hook_connect, callback))
+        (hook_connect->callback_pointer,
+         hook_connect->callback_data,
+         WEECHAT_HOOK_CONNECT_OK, 0,
+         HOOK_CONNECT(hook_connect, sock),
+         NULL, ip_address);
+    unhook (hook_connect);
+    free (ip_address);
+}
+
 /*
  * Reads connection progress from child process.
  */
@@ -1577,7 +1902,6 @@ network_connect_child_read_cb (const void *pointer, void *data, int fd)
     char buffer[1], buf_size[6], *cb_error, *cb_ip_address, *error;
     int num_read;
     long size_msg;
-    int rc, direction;
     int sock, i;
     struct msghdr msg;
     struct cmsghdr *cmsg;
@@ -1674,87 +1998,8 @@ network_connect_child_read_cb (const void *pointer, void *data, int fd)
 
             HOOK_CONNECT(hook_connect, sock) = sock;
 
-            if (HOOK_CONNECT(hook_connect, gnutls_sess))
-            {
-                /*
-                 * the socket needs to be non-blocking since the call to
-                 * gnutls_handshake can block
-                 */
-                HOOK_CONNECT(hook_connect, handshake_fd_flags) =
-                    fcntl (HOOK_CONNECT(hook_connect, sock), F_GETFL);
-                if (HOOK_CONNECT(hook_connect, handshake_fd_flags) == -1)
-                    HOOK_CONNECT(hook_connect, handshake_fd_flags) = 0;
-                fcntl (HOOK_CONNECT(hook_connect, sock), F_SETFL,
-                       HOOK_CONNECT(hook_connect, handshake_fd_flags) | O_NONBLOCK);
-                gnutls_transport_set_ptr (*HOOK_CONNECT(hook_connect, gnutls_sess),
-                                          (gnutls_transport_ptr_t) ((ptrdiff_t) HOOK_CONNECT(hook_connect, sock)));
-                if (HOOK_CONNECT(hook_connect, gnutls_dhkey_size) > 0)
-                {
-                    gnutls_dh_set_prime_bits (*HOOK_CONNECT(hook_connect, gnutls_sess),
-                                              (unsigned int) HOOK_CONNECT(hook_connect, gnutls_dhkey_size));
-                }
-                rc = gnutls_handshake (*HOOK_CONNECT(hook_connect, gnutls_sess));
-                if ((rc == GNUTLS_E_AGAIN) || (rc == GNUTLS_E_INTERRUPTED))
-                {
-                    /*
-                     * gnutls was unable to proceed with the handshake without
-                     * blocking: non fatal error, we just have to wait for an
-                     * event about handshake
-                     */
-                    unhook (HOOK_CONNECT(hook_connect, hook_fd));
-                    HOOK_CONNECT(hook_connect, hook_fd) = NULL;
-                    direction = gnutls_record_get_direction (*HOOK_CONNECT(hook_connect, gnutls_sess));
-                    HOOK_CONNECT(hook_connect, handshake_ip_address) = cb_ip_address;
-                    HOOK_CONNECT(hook_connect, handshake_hook_fd) =
-                        hook_fd (hook_connect->plugin,
-                                 HOOK_CONNECT(hook_connect, sock),
-                                 (!direction ? 1 : 0), (direction  ? 1 : 0), 0,
-                                 &network_connect_gnutls_handshake_fd_cb,
-                                 hook_connect, NULL);
-                    HOOK_CONNECT(hook_connect, handshake_hook_timer) =
-                        hook_timer (hook_connect->plugin,
-                                    CONFIG_INTEGER(config_network_gnutls_handshake_timeout) * 1000,
-                                    0, 1,
-                                    &network_connect_gnutls_handshake_timer_cb,
-                                    hook_connect, NULL);
-                    return WEECHAT_RC_OK;
-                }
-                else if (rc != GNUTLS_E_SUCCESS)
-                {
-                    (void) (HOOK_CONNECT(hook_connect, callback))
-                        (hook_connect->callback_pointer,
-                         hook_connect->callback_data,
-                         WEECHAT_HOOK_CONNECT_GNUTLS_HANDSHAKE_ERROR,
-                         rc, sock,
-                         gnutls_strerror (rc),
-                         cb_ip_address);
-                    unhook (hook_connect);
-                    free (cb_ip_address);
-                    return WEECHAT_RC_OK;
-                }
-                fcntl (HOOK_CONNECT(hook_connect, sock), F_SETFL,
-                       HOOK_CONNECT(hook_connect, handshake_fd_flags));
-#if LIBGNUTLS_VERSION_NUMBER < 0x02090a /* 2.9.10 */
-                /*
-                 * gnutls only has the gnutls_certificate_set_verify_function()
-                 * function since version 2.9.10. We need to call our verify
-                 * function manually after the handshake for old gnutls versions
-                 */
-                if (hook_connect_gnutls_verify_certificates (*HOOK_CONNECT(hook_connect, gnutls_sess)) != 0)
-                {
-                    (void) (HOOK_CONNECT(hook_connect, callback))
-                        (hook_connect->callback_pointer,
-                         hook_connect->callback_data,
-                         WEECHAT_HOOK_CONNECT_GNUTLS_HANDSHAKE_ERROR,
-                         rc, sock,
-                         "Error in the certificate.",
-                         cb_ip_address);
-                    unhook (hook_connect);
-                    free (cb_ip_address);
-                    return WEECHAT_RC_OK;
-                }
-#endif /* LIBGNUTLS_VERSION_NUMBER < 0x02090a */
-            }
+            network_connect_connected (hook_connect, cb_ip_address);
+            return WEECHAT_RC_OK;
         }
         else
         {
@@ -1808,16 +2053,18 @@ network_connect_child_read_cb (const void *pointer, void *data, int fd)
 }
 
 /*
- * Connects with fork (called by hook_connect() only!).
+ * Initializes GnuTLS session of hook (if TLS is asked).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (the callback is called and the hook is unhooked)
  */
 
-void
-network_connect_with_fork (struct t_hook *hook_connect)
+int
+network_connect_gnutls_init (struct t_hook *hook_connect)
 {
-    int child_pipe[2], child_socket[2], rc, i;
-    char str_error[1024];
     const char *pos_error;
-    pid_t pid;
+    int rc;
 
     /* initialize GnuTLS if TLS asked */
     if (HOOK_CONNECT(hook_connect, gnutls_sess))
@@ -1830,7 +2077,7 @@ network_connect_with_fork (struct t_hook *hook_connect)
                  WEECHAT_HOOK_CONNECT_GNUTLS_INIT_ERROR,
                  0, -1, NULL, NULL);
             unhook (hook_connect);
-            return;
+            return 0;
         }
         if (!network_is_ip_address (HOOK_CONNECT(hook_connect, address)))
         {
@@ -1847,7 +2094,7 @@ network_connect_with_fork (struct t_hook *hook_connect)
                      WEECHAT_HOOK_CONNECT_GNUTLS_INIT_ERROR,
                      0, -1, _("set server name indication (SNI) failed"), NULL);
                 unhook (hook_connect);
-                return;
+                return 0;
             }
         }
         rc = gnutls_priority_set_direct (*HOOK_CONNECT(hook_connect, gnutls_sess),
@@ -1861,7 +2108,7 @@ network_connect_with_fork (struct t_hook *hook_connect)
                  WEECHAT_HOOK_CONNECT_GNUTLS_INIT_ERROR,
                  0, -1, _("invalid priorities"), NULL);
             unhook (hook_connect);
-            return;
+            return 0;
         }
         gnutls_credentials_set (*HOOK_CONNECT(hook_connect, gnutls_sess),
                                 GNUTLS_CRD_CERTIFICATE,
@@ -1870,6 +2117,299 @@ network_connect_with_fork (struct t_hook *hook_connect)
                                   (gnutls_transport_ptr_t) ((unsigned long) HOOK_CONNECT(hook_connect, sock)));
     }
 
+    return 1;
+}
+
+/*
+ * Tries to connect to the next address of the list (non-blocking connect).
+ *
+ * If the connection is in progress, a fd hook is added on the socket; if all
+ * addresses have been tried, the callback is called with the last error and
+ * the hook is unhooked.
+ */
+
+void
+network_connect_async_next (struct t_hook *hook_connect)
+{
+    struct addrinfo *ptr_res, *ptr_loc, *res_local;
+    int sock, set, flags, rc;
+
+    res_local = HOOK_CONNECT(hook_connect, resolve)->res_local;
+
+    while (HOOK_CONNECT(hook_connect, connect_index) < HOOK_CONNECT(hook_connect, connect_num_addrs))
+    {
+        ptr_res = HOOK_CONNECT(hook_connect, connect_addrs)[HOOK_CONNECT(hook_connect, connect_index)];
+        HOOK_CONNECT(hook_connect, connect_index)++;
+
+        sock = socket (ptr_res->ai_family,
+                       ptr_res->ai_socktype,
+                       ptr_res->ai_protocol);
+        if (sock < 0)
+        {
+            HOOK_CONNECT(hook_connect, connect_status) = WEECHAT_HOOK_CONNECT_SOCKET_ERROR;
+            continue;
+        }
+
+        /* set SO_REUSEADDR option for socket */
+        set = 1;
+        setsockopt (sock, SOL_SOCKET, SO_REUSEADDR, (void *) &set, sizeof (set));
+
+        /* set SO_KEEPALIVE option for socket */
+        set = 1;
+        setsockopt (sock, SOL_SOCKET, SO_KEEPALIVE, (void *) &set, sizeof (set));
+
+        /* set flag O_NONBLOCK on socket */
+        flags = fcntl (sock, F_GETFL);
+        if (flags == -1)
+            flags = 0;
+        fcntl (sock, F_SETFL, flags | O_NONBLOCK);
+
+        if (res_local)
+        {
+            rc = -1;
+
+            /* bind local hostname/IP if asked by user */
+            for (ptr_loc = res_local; ptr_loc; ptr_loc = ptr_loc->ai_next)
+            {
+                if (ptr_loc->ai_family != ptr_res->ai_family)
+                    continue;
+
+                rc = bind (sock, ptr_loc->ai_addr, ptr_loc->ai_addrlen);
+                if (rc == 0)
+                    break;
+            }
+
+            if (rc < 0)
+            {
+                HOOK_CONNECT(hook_connect, connect_status) = WEECHAT_HOOK_CONNECT_LOCAL_HOSTNAME_ERROR;
+                close (sock);
+                continue;
+            }
+        }
+
+        /* connect to peer */
+        if (connect (sock, ptr_res->ai_addr, ptr_res->ai_addrlen) == 0)
+        {
+            HOOK_CONNECT(hook_connect, connect_sock) = sock;
+            network_connect_async_fd_cb (hook_connect, NULL, sock);
+            return;
+        }
+        if (errno == EINPROGRESS)
+        {
+            /* wait for socket to be writable, see man connect */
+            HOOK_CONNECT(hook_connect, connect_sock) = sock;
+            HOOK_CONNECT(hook_connect, hook_fd) = hook_fd (hook_connect->plugin,
+                                                           sock, 0, 1, 0,
+                                                           &network_connect_async_fd_cb,
+                                                           hook_connect, NULL);
+            return;
+        }
+
+        HOOK_CONNECT(hook_connect, connect_status) = WEECHAT_HOOK_CONNECT_CONNECTION_REFUSED;
+        close (sock);
+    }
+
+    /* all addresses tried: connection failed */
+    (void) (HOOK_CONNECT(hook_connect, callback))
+        (hook_connect->callback_pointer,
+         hook_connect->callback_data,
+         HOOK_CONNECT(hook_connect, connect_status),
+         0, -1, NULL, NULL);
+    unhook (hook_connect);
+}
+
+/*
+ * Callback for socket being connected (non-blocking connect).
+ */
+
+int
+network_connect_async_fd_cb (const void *pointer, void *data, int fd)
+{
+    struct t_hook *hook_connect;
+    struct addrinfo *ptr_res;
+    char remote_address[NI_MAXHOST + 1];
+    int value;
+    socklen_t len;
+
+    /* make C compiler happy */
+    (void) data;
+
+    hook_connect = (struct t_hook *)pointer;
+
+    if (HOOK_CONNECT(hook_connect, hook_fd))
+    {
+        unhook (HOOK_CONNECT(hook_connect, hook_fd));
+        HOOK_CONNECT(hook_connect, hook_fd) = NULL;
+    }
+
+    len = sizeof (value);
+    if ((getsockopt (fd, SOL_SOCKET, SO_ERROR, &value, &len) != 0)
+        || (value != 0))
+    {
+        /* connection failed, try next address */
+        close (fd);
+        HOOK_CONNECT(hook_connect, connect_sock) = -1;
+        HOOK_CONNECT(hook_connect, connect_status) = WEECHAT_HOOK_CONNECT_CONNECTION_REFUSED;
+        network_connect_async_next (hook_connect);
+        return WEECHAT_RC_OK;
+    }
+
+    HOOK_CONNECT(hook_connect, sock) = fd;
+    HOOK_CONNECT(hook_connect, connect_sock) = -1;
+
+    ptr_res = HOOK_CONNECT(hook_connect, connect_addrs)[HOOK_CONNECT(hook_connect, connect_index) - 1];
+    network_connect_connected (
+        hook_connect,
+        (getnameinfo (ptr_res->ai_addr, ptr_res->ai_addrlen,
+                      remote_address, sizeof (remote_address),
+                      NULL, 0, NI_NUMERICHOST) == 0) ?
+        strdup (remote_address) : NULL);
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Callback for end of name resolution (done in a thread).
+ */
+
+int
+network_connect_resolve_read_cb (const void *pointer, void *data, int fd)
+{
+    struct t_hook *hook_connect;
+    struct t_network_resolve *ptr_resolve;
+    char buffer[1];
+    int num_read, done, status;
+
+    /* make C compiler happy */
+    (void) data;
+
+    hook_connect = (struct t_hook *)pointer;
+    ptr_resolve = HOOK_CONNECT(hook_connect, resolve);
+
+    num_read = read (fd, buffer, sizeof (buffer));
+    (void) num_read;
+
+    pthread_mutex_lock (&ptr_resolve->mutex);
+    done = ptr_resolve->done;
+    pthread_mutex_unlock (&ptr_resolve->mutex);
+    if (!done)
+        return WEECHAT_RC_OK;
+
+    unhook (HOOK_CONNECT(hook_connect, hook_fd));
+    HOOK_CONNECT(hook_connect, hook_fd) = NULL;
+
+    if ((ptr_resolve->rc_remote != 0) || !ptr_resolve->res_remote)
+    {
+        /* address not found */
+        (void) (HOOK_CONNECT(hook_connect, callback))
+            (hook_connect->callback_pointer,
+             hook_connect->callback_data,
+             WEECHAT_HOOK_CONNECT_ADDRESS_NOT_FOUND,
+             0, -1,
+             (ptr_resolve->rc_remote != 0) ?
+             gai_strerror (ptr_resolve->rc_remote) : NULL,
+             NULL);
+        unhook (hook_connect);
+        return WEECHAT_RC_OK;
+    }
+
+    if (ptr_resolve->local_hostname
+        && ((ptr_resolve->rc_local != 0) || !ptr_resolve->res_local))
+    {
+        /* local hostname not found */
+        (void) (HOOK_CONNECT(hook_connect, callback))
+            (hook_connect->callback_pointer,
+             hook_connect->callback_data,
+             WEECHAT_HOOK_CONNECT_LOCAL_HOSTNAME_ERROR,
+             0, -1,
+             (ptr_resolve->rc_local != 0) ?
+             gai_strerror (ptr_resolve->rc_local) : NULL,
+             NULL);
+        unhook (hook_connect);
+        return WEECHAT_RC_OK;
+    }
+
+    HOOK_CONNECT(hook_connect, connect_num_addrs) =
+        network_connect_reorder_addresses (
+            ptr_resolve->res_remote,
+            HOOK_CONNECT(hook_connect, retry),
+            &HOOK_CONNECT(hook_connect, connect_addrs));
+    if (HOOK_CONNECT(hook_connect, connect_num_addrs) <= 0)
+    {
+        status = (HOOK_CONNECT(hook_connect, connect_num_addrs) < 0) ?
+            WEECHAT_HOOK_CONNECT_MEMORY_ERROR :
+            WEECHAT_HOOK_CONNECT_IP_ADDRESS_NOT_FOUND;
+        (void) (HOOK_CONNECT(hook_connect, callback))
+            (hook_connect->callback_pointer,
+             hook_connect->callback_data,
+             status, 0, -1, NULL, NULL);
+        unhook (hook_connect);
+        return WEECHAT_RC_OK;
+    }
+
+    HOOK_CONNECT(hook_connect, connect_index) = 0;
+    HOOK_CONNECT(hook_connect, connect_status) = WEECHAT_HOOK_CONNECT_IP_ADDRESS_NOT_FOUND;
+    network_connect_async_next (hook_connect);
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Connects without fork: names are resolved in a thread, then the connection
+ * is made with a non-blocking socket in the main thread (called by
+ * network_connect_hook() only!).
+ *
+ * Returns:
+ *   1: OK (connection in progress)
+ *   0: the thread could not be started
+ */
+
+int
+network_connect_with_thread (struct t_hook *hook_connect)
+{
+    struct t_network_resolve *new_resolve;
+
+    new_resolve = network_resolve_new (
+        HOOK_CONNECT(hook_connect, address),
+        HOOK_CONNECT(hook_connect, port),
+        (HOOK_CONNECT(hook_connect, ipv6)) ? AF_UNSPEC : AF_INET,
+        HOOK_CONNECT(hook_connect, local_hostname));
+    if (!new_resolve)
+        return 0;
+
+    if (!network_resolve_start (new_resolve))
+    {
+        network_resolve_unref (new_resolve);
+        return 0;
+    }
+
+    HOOK_CONNECT(hook_connect, resolve) = new_resolve;
+    HOOK_CONNECT(hook_connect, hook_child_timer) = hook_timer (hook_connect->plugin,
+                                                               CONFIG_INTEGER(config_network_connection_timeout) * 1000,
+                                                               0, 1,
+                                                               &network_connect_child_timer_cb,
+                                                               hook_connect,
+                                                               NULL);
+    HOOK_CONNECT(hook_connect, hook_fd) = hook_fd (hook_connect->plugin,
+                                                   new_resolve->pipe_read,
+                                                   1, 0, 0,
+                                                   &network_connect_resolve_read_cb,
+                                                   hook_connect, NULL);
+
+    return 1;
+}
+
+/*
+ * Connects with fork (called by network_connect_hook() only!).
+ */
+
+void
+network_connect_with_fork (struct t_hook *hook_connect)
+{
+    int child_pipe[2], child_socket[2], rc, i;
+    char str_error[1024];
+    pid_t pid;
+
     /* create pipe for child process */
     if (pipe (child_pipe) < 0)
     {
@@ -1954,3 +2494,27 @@ network_connect_with_fork (struct t_hook *hook_connect)
                                                    &network_connect_child_read_cb,
                                                    hook_connect, NULL);
 }
+
+/*
+ * Connects to peer (called by hook_connect() only!).
+ *
+ * Without proxy, names are resolved in a thread and the connection is made
+ * in the main thread; with a proxy (or if the thread can not be created),
+ * the connection is made in a forked process.
+ */
+
+void
+network_connect_hook (struct t_hook *hook_connect)
+{
+    if (!network_connect_gnutls_init (hook_connect))
+        return;
+
+    if (!HOOK_CONNECT(hook_connect, proxy)
+        || !HOOK_CONNECT(hook_connect, proxy)[0])
+    {
+        if (network_connect_with_thread (hook_connect))
+            return;
+    }
+
+    network_connect_with_fork (hook_connect);
+}
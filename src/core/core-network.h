@@ -22,8 +22,10 @@
 
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <pthread.h>
 
 struct t_hook;
+struct addrinfo;
 
 struct t_network_socks4
 {
@@ -43,6 +45,29 @@ struct t_network_socks5
                           /*              auth(user/pass) (2), ...          */
 };
 
+/*
+ * name resolution done in a thread (for connections without proxy): the
+ * structure is shared by the thread and the connect hook, it is freed when
+ * both have released it
+ */
+
+struct t_network_resolve
+{
+    pthread_mutex_t mutex;             /* mutex for fields below            */
+    int refcount;                      /* number of users (thread, hook)    */
+    int done;                          /* 1 if resolution is done           */
+    char *address;                     /* peer address                      */
+    char *port;                        /* peer port (string)                */
+    int family;                        /* AF_UNSPEC or AF_INET              */
+    char *local_hostname;              /* local hostname (optional)         */
+    int pipe_read;                     /* read end of pipe (for hook fd)    */
+    int pipe_write;                    /* written by thread when done       */
+    int rc_remote;                     /* getaddrinfo() rc for peer         */
+    int rc_local;                      /* getaddrinfo() rc for local host   */
+    struct addrinfo *res_remote;       /* addresses of peer                 */
+    struct addrinfo *res_local;        /* addresses of local hostname       */
+};
+
 extern int network_init_gnutls_ok;
 extern int network_num_certs_system;
 extern int network_num_certs_user;
@@ -57,6 +82,15 @@ extern int network_pass_proxy (const char *proxy, int sock,
                                const char *address, int port);
 extern int network_connect_to (const char *proxy, struct sockaddr *address,
                                socklen_t address_length);
+extern int network_connect_reorder_addresses (struct addrinfo *res_remote,
+                                              int retry,
+                                              struct addrinfo ***res_reorder);
+extern struct t_network_resolve *network_resolve_new (const char *address,
+                                                      int port, int family,
+                                                      const char *local_hostname);
+extern int network_resolve_start (struct t_network_resolve *resolve);
+extern void network_resolve_unref (struct t_network_resolve *resolve);
 extern void network_connect_with_fork (struct t_hook *hook_connect);
+extern void network_connect_hook (struct t_hook *hook_connect);
 
 #endif /* WEECHAT_NETWORK_H */
@@ -0,0 +1,137 @@
+/*
+ * core-parallel.c - run a callback on ranges of items in parallel threads
+ *
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <signal.h>
+#include <pthread.h>
+
+#include "weechat.h"
+#include "core-parallel.h"
+
+
+struct t_parallel_range
+{
+    t_parallel_cb *callback;           /* callback called for the range     */
+    void *data;                        /* data sent to callback             */
+    int thread_index;                  /* index of thread (0 = main thread) */
+    int start;                         /* first item (included)             */
+    int end;                           /* last item (excluded)              */
+};
+
+
+/*
+ * Runs callback on a range, in a thread.
+ *
+ * Signals are blocked in the thread so that they are all received by the
+ * main thread.
+ */
+
+void *
+parallel_thread_run (void *arg)
+{
+    struct t_parallel_range *range;
+    sigset_t set;
+
+    range = (struct t_parallel_range *)arg;
+
+    sigfillset (&set);
+    pthread_sigmask (SIG_BLOCK, &set, NULL);
+
+    (range->callback) (range->data, range->thread_index,
+                       range->start, range->end);
+
+    return NULL;
+}
+
+/*
+ * Runs callback on "count" items, split in ranges processed in parallel by
+ * at most "max_threads" threads (including the main thread), each thread
+ * having at least "min_count_thread" items.
+ *
+ * The callback is called once per thread with the range of items to process
+ * (start included, end excluded); the function returns once all ranges have
+ * been processed.
+ * If a thread can not be created, its range is processed in the main thread.
+ *
+ * Returns the number of threads used (1 if all items have been processed in
+ * the main thread), 0 if error.
+ */
+
+int
+parallel_run (int max_threads, int count, int min_count_thread,
+              t_parallel_cb *callback, void *data)
+{
+    struct t_parallel_range ranges[PARALLEL_MAX_THREADS];
+    pthread_t threads[PARALLEL_MAX_THREADS];
+    int i, num_threads, created[PARALLEL_MAX_THREADS];
+
+    if (!callback || (count < 0))
+        return 0;
+
+    if (min_count_thread < 1)
+        min_count_thread = 1;
+    if (max_threads > PARALLEL_MAX_THREADS)
+        max_threads = PARALLEL_MAX_THREADS;
+
+    num_threads = count / min_count_thread;
+    if (num_threads > max_threads)
+        num_threads = max_threads;
+
+    if (num_threads <= 1)
+    {
+        (callback) (data, 0, 0, count);
+        return 1;
+    }
+
+    for (i = 0; i < num_threads; i++)
+    {
+        ranges[i].callback = callback;
+        ranges[i].data = data;
+        ranges[i].thread_index = i;
+        ranges[i].start = (int)(((long long)count * i) / num_threads);
+        ranges[i].end = (int)(((long long)count * (i + 1)) / num_threads);
+    }
+
+    for (i = 1; i < num_threads; i++)
+    {
+        created[i] = (pthread_create (&threads[i], NULL,
+                                      &parallel_thread_run,
+                                      &ranges[i]) == 0) ? 1 : 0;
+    }
+
+    /* main thread processes the first range */
+    (callback) (data, 0, ranges[0].start, ranges[0].end);
+
+    for (i = 1; i < num_threads; i++)
+    {
+        if (created[i])
+            pthread_join (threads[i], NULL);
+        else
+            (callback) (data, i, ranges[i].start, ranges[i].end);
+    }
+
+    return num_threads;
+}
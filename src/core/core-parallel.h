@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef WEECHAT_PARALLEL_H
+#define WEECHAT_PARALLEL_H
+
+/*
+ * a parallel run splits a range of "count" items in contiguous ranges,
+ * processed by the callback in threads (the main thread processes the first
+ * range); the callback must only read shared data: the main thread waits for
+ * all threads before returning, so the data can not change during the run
+ */
+
+#define PARALLEL_MAX_THREADS 64
+
+typedef void (t_parallel_cb)(void *data, int thread_index,
+                             int start, int end);
+
+extern int parallel_run (int max_threads, int count, int min_count_thread,
+                         t_parallel_cb *callback, void *data);
+
+#endif /* WEECHAT_PARALLEL_H */
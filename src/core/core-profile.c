@@ -0,0 +1,988 @@
+/*
+ * core-profile.c - profiler for hook callbacks and main loop
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include "weechat.h"
+#include "core-profile.h"
+#include "core-arraylist.h"
+#include "core-hashtable.h"
+#include "core-hook.h"
+#include "core-infolist.h"
+#include "core-string.h"
+#include "core-util.h"
+#include "../gui/gui-chat.h"
+#include "../plugins/plugin.h"
+
+
+char *profile_phase_string[PROFILE_NUM_PHASES] =
+{ "timers", "refreshes", "fd", "process", "signals" };
+
+int profile_enabled = 0;               /* 1 if profiler is running          */
+struct timeval profile_start_time;     /* start of profiling                */
+struct timeval profile_stop_time;      /* end of profiling (if stopped)     */
+struct t_profile_stats profile_phases[PROFILE_NUM_PHASES];
+struct t_profile_stats profile_loop;   /* iterations of main loop           */
+struct timeval profile_loop_start;     /* start of current iteration        */
+struct t_profile_stats profile_hook_types[HOOK_NUM_TYPES];
+struct t_hashtable *profile_plugins = NULL; /* stats by plugin/subplugin    */
+
+char *profile_export_filename = NULL;  /* file for periodic export          */
+long long profile_export_interval = 0; /* interval for export (microsecs)   */
+struct t_hook *profile_export_timer = NULL; /* timer for periodic export    */
+
+char *profile_startup_type_string[PROFILE_STARTUP_NUM_TYPES] =
+{ "phase", "config", "plugin_load", "plugin_init", "script" };
+
+int profile_startup_running = 0;       /* 1 during initialization           */
+struct t_profile_startup_step *profile_startup_steps = NULL; /* steps       */
+struct t_profile_startup_step *last_profile_startup_step = NULL;
+long long profile_startup_time = 0;    /* total time of startup (microsecs) */
+struct timeval profile_startup_mark;   /* start of next script load         */
+struct t_hook *profile_startup_hook_scripts = NULL; /* scripts loaded       */
+
+
+/*
+ * Adds time of a call in stats.
+ */
+
+void
+profile_stats_add (struct t_profile_stats *stats, long long time)
+{
+    int bucket;
+    long long value;
+
+    if (!stats)
+        return;
+
+    if (time < 0)
+        time = 0;
+
+    stats->count++;
+    stats->time_total += time;
+    if (time > stats->time_max)
+        stats->time_max = time;
+
+    /* bucket N contains calls with time in range [2^(N-1), 2^N - 1] */
+    bucket = 0;
+    value = time;
+    while ((value > 0) && (bucket < PROFILE_HISTOGRAM_SIZE - 1))
+    {
+        value >>= 1;
+        bucket++;
+    }
+    stats->histogram[bucket]++;
+}
+
+/*
+ * Returns an estimation of a percentile of time (like 99 for p99), using the
+ * histogram of stats: this is the upper bound of the bucket that contains
+ * the percentile (but not more than the max time).
+ */
+
+long long
+profile_stats_percentile (struct t_profile_stats *stats, int percent)
+{
+    long long count, limit, time;
+    int i;
+
+    if (!stats || (stats->count == 0))
+        return 0;
+
+    if (percent < 0)
+        percent = 0;
+    if (percent > 100)
+        percent = 100;
+
+    limit = ((stats->count * percent) + 99) / 100;
+    if (limit < 1)
+        limit = 1;
+
+    count = 0;
+    for (i = 0; i < PROFILE_HISTOGRAM_SIZE; i++)
+    {
+        count += stats->histogram[i];
+        if (count >= limit)
+        {
+            time = (i == 0) ? 0 : (1LL << i) - 1;
+            return (time < stats->time_max) ? time : stats->time_max;
+        }
+    }
+
+    return stats->time_max;
+}
+
+/*
+ * Frees a stats value in hashtable of plugins.
+ */
+
+void
+profile_plugins_free_value_cb (struct t_hashtable *hashtable,
+                               const void *key, void *value)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    free (value);
+}
+
+/*
+ * Gets stats of a plugin (or subplugin) by name, creates them if not found.
+ *
+ * Returns pointer to stats, NULL if error.
+ */
+
+struct t_profile_stats *
+profile_plugins_get_stats (const char *name)
+{
+    struct t_profile_stats *ptr_stats;
+
+    if (!profile_plugins)
+    {
+        profile_plugins = hashtable_new (32,
+                                         WEECHAT_HASHTABLE_STRING,
+                                         WEECHAT_HASHTABLE_POINTER,
+                                         NULL, NULL);
+        if (!profile_plugins)
+            return NULL;
+        profile_plugins->callback_free_value = &profile_plugins_free_value_cb;
+    }
+
+    ptr_stats = hashtable_get (profile_plugins, name);
+    if (ptr_stats)
+        return ptr_stats;
+
+    ptr_stats = calloc (1, sizeof (*ptr_stats));
+    if (!ptr_stats)
+        return NULL;
+    if (!hashtable_set (profile_plugins, name, ptr_stats))
+    {
+        free (ptr_stats);
+        return NULL;
+    }
+
+    return ptr_stats;
+}
+
+/*
+ * Adds time of a hook callback in stats of the hook, its plugin, subplugin
+ * and hook type.
+ */
+
+void
+profile_hook_add (struct t_hook *hook, long long time)
+{
+    char *name;
+
+    if (!hook)
+        return;
+
+    if (!hook->profile)
+    {
+        hook->profile = calloc (1, sizeof (*(hook->profile)));
+        if (!hook->profile)
+            return;
+        hook->profile->plugin_stats = profile_plugins_get_stats (
+            plugin_get_name (hook->plugin));
+        if (hook->subplugin
+            && (string_asprintf (&name, "%s/%s",
+                                 plugin_get_name (hook->plugin),
+                                 hook->subplugin) >= 0))
+        {
+            hook->profile->subplugin_stats = profile_plugins_get_stats (name);
+            free (name);
+        }
+    }
+
+    profile_stats_add (&(hook->profile->stats), time);
+    profile_stats_add (hook->profile->plugin_stats, time);
+    profile_stats_add (hook->profile->subplugin_stats, time);
+    profile_stats_add (&profile_hook_types[hook->type], time);
+}
+
+/*
+ * Frees profile of a hook.
+ */
+
+void
+profile_hook_free (struct t_hook *hook)
+{
+    if (!hook || !hook->profile)
+        return;
+
+    free (hook->profile);
+    hook->profile = NULL;
+}
+
+/*
+ * Starts measure of a main loop phase: start time is set to 0 if the
+ * profiler is disabled.
+ */
+
+void
+profile_phase_start (struct timeval *start)
+{
+    if (profile_enabled)
+    {
+        gettimeofday (start, NULL);
+    }
+    else
+    {
+        start->tv_sec = 0;
+        start->tv_usec = 0;
+    }
+}
+
+/*
+ * Ends measure of a main loop phase, and starts measure of next phase
+ * (start time is set to end time of this phase).
+ */
+
+void
+profile_phase_end (enum t_profile_phase phase, struct timeval *start)
+{
+    struct timeval end;
+
+    if (!profile_enabled || (start->tv_sec == 0))
+    {
+        if (!profile_enabled)
+            profile_loop_start.tv_sec = 0;
+        profile_phase_start (start);
+        return;
+    }
+
+    gettimeofday (&end, NULL);
+    profile_stats_add (&profile_phases[phase],
+                       util_timeval_diff (start, &end));
+    memcpy (start, &end, sizeof (*start));
+
+    /* last phase: end of main loop iteration (the first one is partial) */
+    if (phase == PROFILE_NUM_PHASES - 1)
+    {
+        if (profile_loop_start.tv_sec != 0)
+        {
+            profile_stats_add (&profile_loop,
+                               util_timeval_diff (&profile_loop_start, &end));
+        }
+        memcpy (&profile_loop_start, &end, sizeof (profile_loop_start));
+    }
+}
+
+/*
+ * Resets all stats of profiler.
+ */
+
+void
+profile_reset ()
+{
+    struct t_hook *ptr_hook;
+    int type;
+
+    for (type = 0; type < HOOK_NUM_TYPES; type++)
+    {
+        for (ptr_hook = weechat_hooks[type]; ptr_hook;
+             ptr_hook = ptr_hook->next_hook)
+        {
+            profile_hook_free (ptr_hook);
+        }
+    }
+
+    memset (profile_phases, 0, sizeof (profile_phases));
+    memset (&profile_loop, 0, sizeof (profile_loop));
+    profile_loop_start.tv_sec = 0;
+    profile_loop_start.tv_usec = 0;
+    memset (profile_hook_types, 0, sizeof (profile_hook_types));
+    if (profile_plugins)
+        hashtable_remove_all (profile_plugins);
+
+    gettimeofday (&profile_start_time, NULL);
+    memcpy (&profile_stop_time, &profile_start_time,
+            sizeof (profile_stop_time));
+}
+
+/*
+ * Starts profiler (all stats are reset).
+ */
+
+void
+profile_start ()
+{
+    profile_reset ();
+    profile_enabled = 1;
+}
+
+/*
+ * Stops profiler (stats are kept, periodic export is stopped).
+ */
+
+void
+profile_stop ()
+{
+    if (!profile_enabled)
+        return;
+
+    profile_enabled = 0;
+    gettimeofday (&profile_stop_time, NULL);
+    profile_export_set (NULL, 0);
+}
+
+/*
+ * Displays a line of profiler output, in core buffer if file is NULL,
+ * otherwise in the file.
+ */
+
+void
+profile_display_printf (FILE *file, const char *format, ...)
+{
+    weechat_va_format (format);
+    if (!vbuffer)
+        return;
+
+    if (file)
+        string_fprintf (file, "%s\n", vbuffer);
+    else
+        gui_chat_printf (NULL, "%s", vbuffer);
+
+    free (vbuffer);
+}
+
+/*
+ * Displays stats with a name.
+ */
+
+void
+profile_display_stats (FILE *file, const char *name,
+                       struct t_profile_stats *stats)
+{
+    char *str_total, *str_avg, *str_max, *str_p99;
+
+    str_total = util_get_microseconds_string (stats->time_total);
+    str_avg = util_get_microseconds_string (
+        (stats->count > 0) ? stats->time_total / stats->count : 0);
+    str_max = util_get_microseconds_string (stats->time_max);
+    str_p99 = util_get_microseconds_string (
+        profile_stats_percentile (stats, 99));
+
+    profile_display_printf (
+        file,
+        "    %s: calls: %lld, total: %s, avg: %s, max: %s, p99: %s",
+        name,
+        stats->count,
+        (str_total) ? str_total : "?",
+        (str_avg) ? str_avg : "?",
+        (str_max) ? str_max : "?",
+        (str_p99) ? str_p99 : "?");
+
+    free (str_total);
+    free (str_avg);
+    free (str_max);
+    free (str_p99);
+}
+
+/*
+ * Compares two hooks by total time of their callbacks (descending order).
+ */
+
+int
+profile_hooks_cmp_cb (void *data, struct t_arraylist *arraylist,
+                      void *pointer1, void *pointer2)
+{
+    struct t_hook *hook1, *hook2;
+
+    /* make C compiler happy */
+    (void) data;
+    (void) arraylist;
+
+    hook1 = (struct t_hook *)pointer1;
+    hook2 = (struct t_hook *)pointer2;
+
+    if (hook1->profile->stats.time_total < hook2->profile->stats.time_total)
+        return 1;
+    if (hook1->profile->stats.time_total > hook2->profile->stats.time_total)
+        return -1;
+    return 0;
+}
+
+/*
+ * Displays stats of plugins (callback for hashtable_map).
+ */
+
+void
+profile_display_plugins_map_cb (void *data, struct t_hashtable *hashtable,
+                                const void *key, const void *value)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+
+    profile_display_stats ((FILE *)data, (const char *)key,
+                           (struct t_profile_stats *)value);
+}
+
+/*
+ * Displays profiler stats, in core buffer if file is NULL, otherwise in the
+ * file.
+ */
+
+void
+profile_display (FILE *file)
+{
+    struct t_arraylist *hooks;
+    struct t_hook *ptr_hook;
+    struct timeval tv_now;
+    char *str_duration, *str_desc, str_name[1024];
+    int i, type, size;
+
+    gettimeofday (&tv_now, NULL);
+    str_duration = util_get_microseconds_string (
+        util_timeval_diff (&profile_start_time,
+                           (profile_enabled) ? &tv_now : &profile_stop_time));
+
+    profile_display_printf (file, "");
+    profile_display_printf (file,
+                            "Profile (%s, duration: %s):",
+                            (profile_enabled) ? "running" : "stopped",
+                            (str_duration) ? str_duration : "?");
+    free (str_duration);
+
+    /* main loop phases */
+    profile_display_printf (file, "  main loop:");
+    profile_display_stats (file, "iteration", &profile_loop);
+    for (i = 0; i < PROFILE_NUM_PHASES; i++)
+    {
+        profile_display_stats (file, profile_phase_string[i],
+                               &profile_phases[i]);
+    }
+
+    /* hook types */
+    profile_display_printf (file, "  hook types:");
+    for (type = 0; type < HOOK_NUM_TYPES; type++)
+    {
+        if (profile_hook_types[type].count > 0)
+        {
+            profile_display_stats (file, hook_type_string[type],
+                                   &profile_hook_types[type]);
+        }
+    }
+
+    /* plugins and subplugins */
+    profile_display_printf (file, "  plugins:");
+    if (profile_plugins)
+        hashtable_map (profile_plugins, &profile_display_plugins_map_cb, file);
+
+    /* hooks with highest total time */
+    hooks = arraylist_new (64, 1, 1,
+                           &profile_hooks_cmp_cb, NULL, NULL, NULL);
+    if (!hooks)
+        return;
+    for (type = 0; type < HOOK_NUM_TYPES; type++)
+    {
+        for (ptr_hook = weechat_hooks[type]; ptr_hook;
+             ptr_hook = ptr_hook->next_hook)
+        {
+            if (!ptr_hook->deleted && ptr_hook->profile)
+                arraylist_add (hooks, ptr_hook);
+        }
+    }
+    size = arraylist_size (hooks);
+    profile_display_printf (file, "  hooks (top %d of %d):",
+                            (size < PROFILE_TOP_HOOKS) ? size : PROFILE_TOP_HOOKS,
+                            size);
+    for (i = 0; (i < size) && (i < PROFILE_TOP_HOOKS); i++)
+    {
+        ptr_hook = (struct t_hook *)arraylist_get (hooks, i);
+        str_desc = hook_get_description (ptr_hook);
+        snprintf (str_name, sizeof (str_name),
+                  "%s (%s), %s%s%s",
+                  hook_type_string[ptr_hook->type],
+                  (str_desc) ? str_desc : "-",
+                  plugin_get_name (ptr_hook->plugin),
+                  (ptr_hook->subplugin) ? "/" : "",
+                  (ptr_hook->subplugin) ? ptr_hook->subplugin : "");
+        free (str_desc);
+        profile_display_stats (file, str_name, &(ptr_hook->profile->stats));
+    }
+    arraylist_free (hooks);
+}
+
+/*
+ * Exports profiler stats to a file (path is evaluated, see
+ * /help eval); the file is overwritten if it exists.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+profile_export (const char *filename)
+{
+    char *path;
+    FILE *file;
+
+    if (!filename || !filename[0])
+        return 0;
+
+    path = string_eval_path_home (filename, NULL, NULL, NULL);
+    if (!path)
+        return 0;
+
+    file = fopen (path, "w");
+    free (path);
+    if (!file)
+        return 0;
+
+    profile_display (file);
+    fclose (file);
+
+    return 1;
+}
+
+/*
+ * Callback for timer of periodic export.
+ */
+
+int
+profile_export_timer_cb (const void *pointer, void *data, int remaining_calls)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) remaining_calls;
+
+    (void) profile_export (profile_export_filename);
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Sets periodic export of profiler stats to a file, each "interval"
+ * microseconds (a NULL filename or an interval <= 0 stops periodic export).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+profile_export_set (const char *filename, long long interval)
+{
+    long interval_ms;
+
+    if (profile_export_timer)
+    {
+        unhook (profile_export_timer);
+        profile_export_timer = NULL;
+    }
+    free (profile_export_filename);
+    profile_export_filename = NULL;
+    profile_export_interval = 0;
+
+    if (!filename || !filename[0] || (interval <= 0))
+        return 1;
+
+    interval_ms = interval / 1000;
+    if (interval_ms < 1)
+        interval_ms = 1;
+
+    profile_export_filename = strdup (filename);
+    if (!profile_export_filename)
+        return 0;
+    profile_export_timer = hook_timer (NULL, interval_ms, 0, 0,
+                                       &profile_export_timer_cb, NULL, NULL);
+    if (!profile_export_timer)
+    {
+        free (profile_export_filename);
+        profile_export_filename = NULL;
+        return 0;
+    }
+    profile_export_interval = interval;
+
+    return 1;
+}
+
+/*
+ * Adds stats in an infolist.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+profile_add_stats_to_infolist (struct t_infolist *infolist,
+                               const char *type, const char *name,
+                               struct t_hook *hook,
+                               struct t_profile_stats *stats)
+{
+    struct t_infolist_item *ptr_item;
+    char value[64];
+
+    ptr_item = infolist_new_item (infolist);
+    if (!ptr_item)
+        return 0;
+
+    if (!infolist_new_var_string (ptr_item, "type", type))
+        return 0;
+    if (!infolist_new_var_string (ptr_item, "name", name))
+        return 0;
+    if (!infolist_new_var_pointer (ptr_item, "hook", hook))
+        return 0;
+    snprintf (value, sizeof (value), "%lld", stats->count);
+    if (!infolist_new_var_string (ptr_item, "count", value))
+        return 0;
+    snprintf (value, sizeof (value), "%lld", stats->time_total);
+    if (!infolist_new_var_string (ptr_item, "time_total", value))
+        return 0;
+    snprintf (value, sizeof (value), "%lld",
+              (stats->count > 0) ? stats->time_total / stats->count : 0);
+    if (!infolist_new_var_string (ptr_item, "time_avg", value))
+        return 0;
+    snprintf (value, sizeof (value), "%lld", stats->time_max);
+    if (!infolist_new_var_string (ptr_item, "time_max", value))
+        return 0;
+    snprintf (value, sizeof (value), "%lld",
+              profile_stats_percentile (stats, 99));
+    if (!infolist_new_var_string (ptr_item, "time_p99", value))
+        return 0;
+    if (!infolist_new_var_buffer (ptr_item, "histogram", stats->histogram,
+                                  sizeof (stats->histogram)))
+        return 0;
+
+    return 1;
+}
+
+/*
+ * Adds stats of plugins in an infolist (callback for hashtable_map).
+ */
+
+void
+profile_plugins_infolist_map_cb (void *data, struct t_hashtable *hashtable,
+                                 const void *key, const void *value)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+
+    (void) profile_add_stats_to_infolist ((struct t_infolist *)data,
+                                          "plugin", (const char *)key, NULL,
+                                          (struct t_profile_stats *)value);
+}
+
+/*
+ * Adds all profiler stats in an infolist.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+profile_add_to_infolist (struct t_infolist *infolist)
+{
+    struct t_hook *ptr_hook;
+    char name[1024];
+    int i, type;
+
+    if (!infolist)
+        return 0;
+
+    for (i = 0; i < PROFILE_NUM_PHASES; i++)
+    {
+        if (!profile_add_stats_to_infolist (infolist, "phase",
+                                            profile_phase_string[i], NULL,
+                                            &profile_phases[i]))
+            return 0;
+    }
+
+    if (!profile_add_stats_to_infolist (infolist, "loop", "iteration", NULL,
+                                        &profile_loop))
+        return 0;
+
+    for (type = 0; type < HOOK_NUM_TYPES; type++)
+    {
+        if (!profile_add_stats_to_infolist (infolist, "hook_type",
+                                            hook_type_string[type], NULL,
+                                            &profile_hook_types[type]))
+            return 0;
+    }
+
+    if (profile_plugins)
+    {
+        hashtable_map (profile_plugins,
+                       &profile_plugins_infolist_map_cb, infolist);
+    }
+
+    for (type = 0; type < HOOK_NUM_TYPES; type++)
+    {
+        for (ptr_hook = weechat_hooks[type]; ptr_hook;
+             ptr_hook = ptr_hook->next_hook)
+        {
+            if (ptr_hook->deleted || !ptr_hook->profile)
+                continue;
+            snprintf (name, sizeof (name),
+                      "%s%s%s",
+                      plugin_get_name (ptr_hook->plugin),
+                      (ptr_hook->subplugin) ? "/" : "",
+                      (ptr_hook->subplugin) ? ptr_hook->subplugin : "");
+            if (!profile_add_stats_to_infolist (infolist, "hook", name,
+                                                ptr_hook,
+                                                &(ptr_hook->profile->stats)))
+                return 0;
+        }
+    }
+
+    return 1;
+}
+
+/*
+ * Callback for signals "xxx_script_loaded": adds a step for the script, with
+ * time since the previous mark (start of plugin init or previous script
+ * loaded).
+ */
+
+int
+profile_startup_script_loaded_cb (const void *pointer, void *data,
+                                  const char *signal,
+                                  const char *type_data, void *signal_data)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) signal;
+
+    if (type_data && (strcmp (type_data, WEECHAT_HOOK_SIGNAL_STRING) == 0))
+    {
+        (void) profile_startup_add (PROFILE_STARTUP_SCRIPT,
+                                    (const char *)signal_data,
+                                    &profile_startup_mark);
+    }
+    profile_startup_set_mark ();
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Starts record of startup profile (called on WeeChat startup, after init of
+ * hooks).
+ */
+
+void
+profile_startup_init ()
+{
+    profile_startup_free_all ();
+    profile_startup_time = 0;
+    profile_startup_running = 1;
+    profile_startup_set_mark ();
+    profile_startup_hook_scripts = hook_signal (
+        NULL, "*_script_loaded",
+        &profile_startup_script_loaded_cb, NULL, NULL);
+}
+
+/*
+ * Adds a step in startup profile, from "start" to now.
+ *
+ * Returns pointer to new step, NULL if error or if the startup is over.
+ */
+
+struct t_profile_startup_step *
+profile_startup_add (enum t_profile_startup_type type, const char *name,
+                     struct timeval *start)
+{
+    struct t_profile_startup_step *new_step;
+    struct timeval tv_now;
+
+    if (!profile_startup_running || (type < 0)
+        || (type >= PROFILE_STARTUP_NUM_TYPES) || !start)
+    {
+        return NULL;
+    }
+
+    new_step = malloc (sizeof (*new_step));
+    if (!new_step)
+        return NULL;
+
+    gettimeofday (&tv_now, NULL);
+
+    new_step->type = type;
+    new_step->name = strdup ((name) ? name : "");
+    new_step->start = util_timeval_diff (&weechat_current_start_timeval,
+                                         start);
+    new_step->time = util_timeval_diff (start, &tv_now);
+
+    new_step->prev_step = last_profile_startup_step;
+    new_step->next_step = NULL;
+    if (last_profile_startup_step)
+        last_profile_startup_step->next_step = new_step;
+    else
+        profile_startup_steps = new_step;
+    last_profile_startup_step = new_step;
+
+    return new_step;
+}
+
+/*
+ * Adds a phase in startup profile, from "start" to now, and starts the next
+ * phase (start time is set to now).
+ */
+
+void
+profile_startup_phase (const char *name, struct timeval *start)
+{
+    if (!profile_startup_running)
+        return;
+
+    (void) profile_startup_add (PROFILE_STARTUP_PHASE, name, start);
+    gettimeofday (start, NULL);
+}
+
+/*
+ * Sets the mark used as start time of the next script loaded.
+ */
+
+void
+profile_startup_set_mark ()
+{
+    gettimeofday (&profile_startup_mark, NULL);
+}
+
+/*
+ * Ends record of startup profile (called at the end of WeeChat
+ * initialization).
+ */
+
+void
+profile_startup_end ()
+{
+    struct timeval tv_now;
+
+    if (!profile_startup_running)
+        return;
+
+    profile_startup_running = 0;
+    gettimeofday (&tv_now, NULL);
+    profile_startup_time = util_timeval_diff (&weechat_current_start_timeval,
+                                              &tv_now);
+    unhook (profile_startup_hook_scripts);
+    profile_startup_hook_scripts = NULL;
+}
+
+/*
+ * Displays startup profile, in core buffer if file is NULL, otherwise in the
+ * file.
+ */
+
+void
+profile_startup_display (FILE *file)
+{
+    struct t_profile_startup_step *ptr_step;
+    struct timeval tv_now;
+    char *str_total, *str_time, *str_start;
+    int type, count;
+
+    if (profile_startup_running)
+    {
+        gettimeofday (&tv_now, NULL);
+        str_total = util_get_microseconds_string (
+            util_timeval_diff (&weechat_current_start_timeval, &tv_now));
+    }
+    else
+    {
+        str_total = util_get_microseconds_string (profile_startup_time);
+    }
+    profile_display_printf (file, "");
+    profile_display_printf (file,
+                            "Startup profile (%s, total: %s):",
+                            (profile_startup_running) ? "running" : "done",
+                            (str_total) ? str_total : "?");
+    free (str_total);
+
+    for (type = 0; type < PROFILE_STARTUP_NUM_TYPES; type++)
+    {
+        count = 0;
+        for (ptr_step = profile_startup_steps; ptr_step;
+             ptr_step = ptr_step->next_step)
+        {
+            if (ptr_step->type != (enum t_profile_startup_type)type)
+                continue;
+            if (count == 0)
+            {
+                profile_display_printf (file, "  %s:",
+                                        profile_startup_type_string[type]);
+            }
+            str_time = util_get_microseconds_string (ptr_step->time);
+            str_start = util_get_microseconds_string (ptr_step->start);
+            profile_display_printf (file,
+                                    "    %s: %s (start: +%s)",
+                                    ptr_step->name,
+                                    (str_time) ? str_time : "?",
+                                    (str_start) ? str_start : "?");
+            free (str_time);
+            free (str_start);
+            count++;
+        }
+    }
+}
+
+/*
+ * Frees all steps of startup profile.
+ */
+
+void
+profile_startup_free_all ()
+{
+    struct t_profile_startup_step *ptr_next_step;
+
+    while (profile_startup_steps)
+    {
+        ptr_next_step = profile_startup_steps->next_step;
+        free (profile_startup_steps->name);
+        free (profile_startup_steps);
+        profile_startup_steps = ptr_next_step;
+    }
+    last_profile_startup_step = NULL;
+}
+
+/*
+ * Ends profiler.
+ */
+
+void
+profile_end ()
+{
+    profile_enabled = 0;
+    profile_export_set (NULL, 0);
+    profile_startup_end ();
+    profile_startup_free_all ();
+    if (profile_plugins)
+    {
+        hashtable_free (profile_plugins);
+        profile_plugins = NULL;
+    }
+}
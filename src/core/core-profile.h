@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WEECHAT_PROFILE_H
+#define WEECHAT_PROFILE_H
+
+#include <stdio.h>
+#include <sys/time.h>
+
+/*
+ * the profiler measures time spent in hook callbacks (aggregated by hook,
+ * plugin/script and hook type) and in the phases of the main loop;
+ * it is disabled by default: when disabled, the only cost is a test on
+ * the variable "profile_enabled"
+ *
+ * the startup profile is always recorded (a few steps only, until the end of
+ * WeeChat initialization): phases of initialization, read of configuration
+ * files, load/init of plugins and load of scripts
+ */
+
+#define PROFILE_HISTOGRAM_SIZE 32      /* bucket N: time < 2^N microsecs    */
+#define PROFILE_TOP_HOOKS      20      /* number of hooks displayed         */
+
+struct t_hashtable;
+struct t_hook;
+struct t_infolist;
+
+enum t_profile_phase
+{
+    PROFILE_PHASE_TIMERS = 0,          /* execution of timer hooks          */
+    PROFILE_PHASE_REFRESHES,           /* refresh of screen                 */
+    PROFILE_PHASE_FD,                  /* wait for fd and fd hooks          */
+    PROFILE_PHASE_PROCESS,             /* run of process hooks              */
+    PROFILE_PHASE_SIGNALS,             /* handle of signals received        */
+    /* number of main loop phases */
+    PROFILE_NUM_PHASES,
+};
+
+enum t_profile_startup_type
+{
+    PROFILE_STARTUP_PHASE = 0,         /* phase of initialization           */
+    PROFILE_STARTUP_CONFIG,            /* read of a configuration file      */
+    PROFILE_STARTUP_PLUGIN_LOAD,       /* load of a plugin (dlopen)         */
+    PROFILE_STARTUP_PLUGIN_INIT,       /* init of a plugin                  */
+    PROFILE_STARTUP_SCRIPT,            /* load of a script                  */
+    /* number of startup step types */
+    PROFILE_STARTUP_NUM_TYPES,
+};
+
+struct t_profile_startup_step
+{
+    enum t_profile_startup_type type;  /* type of step                      */
+    char *name;                        /* name (phase, file, plugin, ...)   */
+    long long start;                   /* start (microseconds since start   */
+                                       /* of WeeChat)                       */
+    long long time;                    /* duration (microseconds)           */
+    struct t_profile_startup_step *prev_step; /* link to previous step      */
+    struct t_profile_startup_step *next_step; /* link to next step          */
+};
+
+struct t_profile_stats
+{
+    long long count;                   /* number of calls                   */
+    long long time_total;              /* total time (microseconds)         */
+    long long time_max;                /* max time of a call (microsecs)    */
+    long long histogram[PROFILE_HISTOGRAM_SIZE]; /* calls by time (log2)    */
+};
+
+struct t_profile_hook
+{
+    struct t_profile_stats stats;      /* stats for the hook                */
+    struct t_profile_stats *plugin_stats;    /* stats of hook plugin        */
+    struct t_profile_stats *subplugin_stats; /* stats of hook subplugin     */
+                                             /* (NULL if no subplugin)      */
+};
+
+extern char *profile_phase_string[];
+extern int profile_enabled;
+extern struct timeval profile_start_time;
+extern struct t_profile_stats profile_phases[];
+extern struct t_profile_stats profile_loop;
+extern struct t_profile_stats profile_hook_types[];
+extern struct t_hashtable *profile_plugins;
+extern char *profile_export_filename;
+extern long long profile_export_interval;
+extern char *profile_startup_type_string[];
+extern int profile_startup_running;
+extern struct t_profile_startup_step *profile_startup_steps;
+extern struct t_profile_startup_step *last_profile_startup_step;
+extern long long profile_startup_time;
+
+extern void profile_stats_add (struct t_profile_stats *stats,
+                               long long time);
+extern long long profile_stats_percentile (struct t_profile_stats *stats,
+                                           int percent);
+extern void profile_hook_add (struct t_hook *hook, long long time);
+extern void profile_hook_free (struct t_hook *hook);
+extern void profile_phase_start (struct timeval *start);
+extern void profile_phase_end (enum t_profile_phase phase,
+                               struct timeval *start);
+extern void profile_reset ();
+extern void profile_start ();
+extern void profile_stop ();
+extern void profile_display (FILE *file);
+extern int profile_export (const char *filename);
+extern int profile_export_set (const char *filename, long long interval);
+extern int profile_add_to_infolist (struct t_infolist *infolist);
+extern void profile_startup_init ();
+extern struct t_profile_startup_step *profile_startup_add (enum t_profile_startup_type type,
+                                                           const char *name,
+                                                           struct timeval *start);
+extern void profile_startup_phase (const char *name, struct timeval *start);
+extern void profile_startup_set_mark ();
+extern void profile_startup_end ();
+extern void profile_startup_display (FILE *file);
+extern void profile_startup_free_all ();
+extern void profile_end ();
+
+#endif /* WEECHAT_PROFILE_H */
@@ -0,0 +1,330 @@
+/*
+ * core-slab.c - slab allocator (items of same size allocated in chunks)
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+
+#include "weechat.h"
+#include "core-slab.h"
+#include "core-log.h"
+
+
+/*
+ * header stored before each item, with a pointer to the chunk containing
+ * the item (the union is used to keep items aligned)
+ */
+
+union t_slab_header
+{
+    struct t_slab_chunk *chunk;
+    void *align_pointer;
+    long long align_long_long;
+    double align_double;
+};
+
+#define SLAB_ALIGN(size)                                                \
+    ((((size) + sizeof (union t_slab_header) - 1)                       \
+      / sizeof (union t_slab_header)) * sizeof (union t_slab_header))
+
+#define SLAB_CHUNK_ITEMS(chunk)                                         \
+    (((char *)(chunk)) + SLAB_ALIGN(sizeof (struct t_slab_chunk)))
+
+
+/*
+ * Creates a new slab for items of size "item_size".
+ *
+ * The first chunk has room for SLAB_CHUNK_MIN_ITEMS items, then the size of
+ * each new chunk is doubled, up to "chunk_max_items" items.
+ *
+ * Returns pointer to new slab, NULL if error.
+ */
+
+struct t_slab *
+slab_new (int item_size, int chunk_max_items)
+{
+    struct t_slab *new_slab;
+
+    if ((item_size <= 0) || (chunk_max_items <= 0))
+        return NULL;
+
+    new_slab = malloc (sizeof (*new_slab));
+    if (!new_slab)
+        return NULL;
+
+    if (item_size < (int)sizeof (void *))
+        item_size = sizeof (void *);
+
+    new_slab->item_size = item_size;
+    new_slab->slot_size = SLAB_ALIGN(sizeof (union t_slab_header))
+        + SLAB_ALIGN(item_size);
+    new_slab->chunk_max_items = chunk_max_items;
+    new_slab->chunks_count = 0;
+    new_slab->items_count = 0;
+    new_slab->free_pending = 0;
+    new_slab->chunks = NULL;
+    new_slab->last_chunk = NULL;
+
+    return new_slab;
+}
+
+/*
+ * Removes a chunk from list of chunks.
+ */
+
+void
+slab_chunk_unlink (struct t_slab *slab, struct t_slab_chunk *chunk)
+{
+    if (chunk->prev_chunk)
+        (chunk->prev_chunk)->next_chunk = chunk->next_chunk;
+    else
+        slab->chunks = chunk->next_chunk;
+    if (chunk->next_chunk)
+        (chunk->next_chunk)->prev_chunk = chunk->prev_chunk;
+    else
+        slab->last_chunk = chunk->prev_chunk;
+    chunk->prev_chunk = NULL;
+    chunk->next_chunk = NULL;
+}
+
+/*
+ * Adds a chunk at the beginning of list of chunks.
+ */
+
+void
+slab_chunk_add_first (struct t_slab *slab, struct t_slab_chunk *chunk)
+{
+    chunk->prev_chunk = NULL;
+    chunk->next_chunk = slab->chunks;
+    if (slab->chunks)
+        (slab->chunks)->prev_chunk = chunk;
+    else
+        slab->last_chunk = chunk;
+    slab->chunks = chunk;
+}
+
+/*
+ * Adds a chunk at the end of list of chunks.
+ */
+
+void
+slab_chunk_add_last (struct t_slab *slab, struct t_slab_chunk *chunk)
+{
+    chunk->prev_chunk = slab->last_chunk;
+    chunk->next_chunk = NULL;
+    if (slab->last_chunk)
+        (slab->last_chunk)->next_chunk = chunk;
+    else
+        slab->chunks = chunk;
+    slab->last_chunk = chunk;
+}
+
+/*
+ * Creates a new chunk in a slab (added at the beginning of list).
+ *
+ * Returns pointer to new chunk, NULL if error.
+ */
+
+struct t_slab_chunk *
+slab_chunk_new (struct t_slab *slab)
+{
+    struct t_slab_chunk *new_chunk;
+    int size;
+
+    size = SLAB_CHUNK_MIN_ITEMS;
+    while ((size < slab->chunk_max_items) && (size < slab->items_count))
+    {
+        size *= 2;
+    }
+    if (size > slab->chunk_max_items)
+        size = slab->chunk_max_items;
+
+    new_chunk = malloc (SLAB_ALIGN(sizeof (*new_chunk))
+                        + ((size_t)size * slab->slot_size));
+    if (!new_chunk)
+        return NULL;
+
+    new_chunk->slab = slab;
+    new_chunk->size = size;
+    new_chunk->items_used = 0;
+    new_chunk->items_init = 0;
+    new_chunk->free_items = NULL;
+    slab_chunk_add_first (slab, new_chunk);
+    slab->chunks_count++;
+
+    return new_chunk;
+}
+
+/*
+ * Allocates an item in a slab.
+ *
+ * Returns pointer to item (content is not initialized), NULL if error.
+ */
+
+void *
+slab_alloc (struct t_slab *slab)
+{
+    struct t_slab_chunk *ptr_chunk;
+    union t_slab_header *ptr_header;
+    void *item;
+
+    if (!slab)
+        return NULL;
+
+    ptr_chunk = slab->chunks;
+    if (!ptr_chunk || (ptr_chunk->items_used >= ptr_chunk->size))
+    {
+        ptr_chunk = slab_chunk_new (slab);
+        if (!ptr_chunk)
+            return NULL;
+    }
+
+    if (ptr_chunk->free_items)
+    {
+        item = ptr_chunk->free_items;
+        ptr_chunk->free_items = *((void **)item);
+    }
+    else
+    {
+        ptr_header = (union t_slab_header *)(
+            SLAB_CHUNK_ITEMS(ptr_chunk)
+            + ((size_t)ptr_chunk->items_init * slab->slot_size));
+        ptr_header->chunk = ptr_chunk;
+        item = ((char *)ptr_header) + SLAB_ALIGN(sizeof (*ptr_header));
+        ptr_chunk->items_init++;
+    }
+
+    ptr_chunk->items_used++;
+    slab->items_count++;
+
+    /* move full chunk at the end of list */
+    if ((ptr_chunk->items_used >= ptr_chunk->size)
+        && (ptr_chunk != slab->last_chunk))
+    {
+        slab_chunk_unlink (slab, ptr_chunk);
+        slab_chunk_add_last (slab, ptr_chunk);
+    }
+
+    return item;
+}
+
+/*
+ * Frees an item allocated by function slab_alloc.
+ *
+ * The chunk containing the item is freed if it has no more items used.
+ */
+
+void
+slab_free_item (void *item)
+{
+    union t_slab_header *ptr_header;
+    struct t_slab_chunk *ptr_chunk;
+    struct t_slab *ptr_slab;
+
+    if (!item)
+        return;
+
+    ptr_header = (union t_slab_header *)(
+        ((char *)item) - SLAB_ALIGN(sizeof (*ptr_header)));
+    ptr_chunk = ptr_header->chunk;
+    ptr_slab = ptr_chunk->slab;
+
+    ptr_chunk->items_used--;
+    ptr_slab->items_count--;
+
+    if (ptr_chunk->items_used == 0)
+    {
+        slab_chunk_unlink (ptr_slab, ptr_chunk);
+        free (ptr_chunk);
+        ptr_slab->chunks_count--;
+        if (ptr_slab->free_pending && (ptr_slab->items_count == 0))
+            free (ptr_slab);
+        return;
+    }
+
+    *((void **)item) = ptr_chunk->free_items;
+    ptr_chunk->free_items = item;
+
+    /* chunk was full: move it at the beginning of list */
+    if ((ptr_chunk->items_used == ptr_chunk->size - 1)
+        && (ptr_chunk != ptr_slab->chunks))
+    {
+        slab_chunk_unlink (ptr_slab, ptr_chunk);
+        slab_chunk_add_first (ptr_slab, ptr_chunk);
+    }
+}
+
+/*
+ * Frees a slab.
+ *
+ * If some items are still used, the slab is kept and it is automatically
+ * freed when the last item is freed with function slab_free_item.
+ */
+
+void
+slab_free (struct t_slab *slab)
+{
+    if (!slab)
+        return;
+
+    if (slab->items_count > 0)
+    {
+        slab->free_pending = 1;
+        return;
+    }
+
+    /* no items used: all chunks have already been freed */
+    free (slab);
+}
+
+/*
+ * Prints slab in WeeChat log file (usually for crash dump).
+ */
+
+void
+slab_print_log (struct t_slab *slab, const char *name)
+{
+    struct t_slab_chunk *ptr_chunk;
+
+    log_printf ("[slab %s (addr:%p)]", name, slab);
+
+    if (!slab)
+        return;
+
+    log_printf ("  item_size. . . . . . . : %d", slab->item_size);
+    log_printf ("  slot_size. . . . . . . : %d", slab->slot_size);
+    log_printf ("  chunk_max_items. . . . : %d", slab->chunk_max_items);
+    log_printf ("  chunks_count . . . . . : %d", slab->chunks_count);
+    log_printf ("  items_count. . . . . . : %d", slab->items_count);
+    log_printf ("  free_pending . . . . . : %d", slab->free_pending);
+    log_printf ("  chunks . . . . . . . . : %p", slab->chunks);
+    log_printf ("  last_chunk . . . . . . : %p", slab->last_chunk);
+
+    for (ptr_chunk = slab->chunks; ptr_chunk;
+         ptr_chunk = ptr_chunk->next_chunk)
+    {
+        log_printf ("    chunk %p: size:%d, items_used:%d, items_init:%d",
+                    ptr_chunk, ptr_chunk->size, ptr_chunk->items_used,
+                    ptr_chunk->items_init);
+    }
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WEECHAT_SLAB_H
+#define WEECHAT_SLAB_H
+
+/*
+ * a slab allocates items of same size in chunks: each chunk has room for
+ * many items, and it is freed as soon as all its items are freed;
+ * chunks with free items are first in list and full chunks are at the end;
+ * if the slab is freed while some items are still used, it is really freed
+ * when the last item is freed
+ */
+
+#define SLAB_CHUNK_MIN_ITEMS 8
+
+struct t_slab;
+
+struct t_slab_chunk
+{
+    struct t_slab *slab;               /* slab containing this chunk        */
+    int size;                          /* number of items in chunk          */
+    int items_used;                    /* number of allocated items         */
+    int items_init;                    /* number of items used at least     */
+                                       /* once (next ones are untouched)    */
+    void *free_items;                  /* list of freed items               */
+    struct t_slab_chunk *prev_chunk;   /* link to previous chunk            */
+    struct t_slab_chunk *next_chunk;   /* link to next chunk                */
+};
+
+struct t_slab
+{
+    int item_size;                     /* size of an item (bytes)           */
+    int slot_size;                     /* size of header + item (aligned)   */
+    int chunk_max_items;               /* max number of items in a chunk    */
+    int chunks_count;                  /* number of chunks                  */
+    int items_count;                   /* number of allocated items         */
+    int free_pending;                  /* 1 if slab must be freed when      */
+                                       /* last item is freed                */
+    struct t_slab_chunk *chunks;       /* chunks (with free items first)    */
+    struct t_slab_chunk *last_chunk;   /* last chunk                        */
+};
+
+extern struct t_slab *slab_new (int item_size, int chunk_max_items);
+extern void *slab_alloc (struct t_slab *slab);
+extern void slab_free_item (void *item);
+extern void slab_free (struct t_slab *slab);
+extern void slab_print_log (struct t_slab *slab, const char *name);
+
+#endif /* WEECHAT_SLAB_H */
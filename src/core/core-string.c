@@ -35,11 +35,17 @@
 #include <regex.h>
 #include <stdint.h>
 #include <gcrypt.h>
+#include <pthread.h>
 
 #ifdef HAVE_ICONV
 #include <iconv.h>
 #endif
 
+#ifdef HAVE_PCRE2
+#define PCRE2_CODE_UNIT_WIDTH 8
+#include <pcre2.h>
+#endif
+
 #ifndef ICONV_CONST
   #ifdef ICONV_2ARG_IS_CONST
     #define ICONV_CONST const
@@ -53,6 +59,7 @@
 #include "core-config.h"
 #include "core-eval.h"
 #include "core-hashtable.h"
+#include "core-thread.h"
 #include "core-utf8.h"
 #include "../gui/gui-chat.h"
 #include "../gui/gui-color.h"
@@ -66,8 +73,21 @@
 #define MIN3(a, b, c) ((a) < (b) ? ((a) < (c) ? (a) : (c)) : ((b) < (c) ? (b) : (c)))
 
 struct t_hashtable *string_hashtable_shared = NULL;
-int string_concat_index = 0;
-char **string_concat_buffer[STRING_NUM_CONCAT_BUFFERS];
+pthread_mutex_t string_shared_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* buffers for string_concat (main thread), other threads use the key */
+struct t_string_concat string_concat_main;
+pthread_key_t string_concat_key;
+int string_concat_key_ok = 0;
+
+#ifdef HAVE_PCRE2
+/* PCRE2 compiled regex for each regex_t compiled with flag "j" */
+struct t_hashtable *string_hashtable_regex_jit = NULL;
+pthread_mutex_t string_regex_jit_mutex = PTHREAD_MUTEX_INITIALIZER;
+/* PCRE2 match data (one per thread) */
+pthread_key_t string_regex_match_data_key;
+int string_regex_match_data_key_ok = 0;
+#endif
 
 
 /*
@@ -944,6 +964,31 @@ string_strcasestr (const char *string, const char *search)
     return NULL;
 }
 
+/*
+ * Returns the char at beginning of string, converted to lower case if
+ * "lower" is set.
+ *
+ * The conversion is the same as the one done by string_charcasecmp().
+ */
+
+int
+string_char_lower (const char *string, int lower)
+{
+    int wchar;
+
+    if (!((unsigned char)(string[0]) & 0x80))
+    {
+        wchar = (unsigned char)string[0];
+        if (lower && (wchar >= 'A') && (wchar <= 'Z'))
+            wchar += ('a' - 'A');
+        return wchar;
+    }
+
+    wchar = utf8_char_int (string);
+
+    return (lower) ? (int)towlower (wchar) : wchar;
+}
+
 /*
  * Checks if a string matches a mask.
  *
@@ -1116,6 +1161,417 @@ string_match_list (const char *string, const char **masks, int case_sensitive)
     return match;
 }
 
+/*
+ * Compiles a mask to match it quickly with function string_match_compiled.
+ *
+ * The mask can contain wildcards ("*"), as in function string_match.
+ * The mask is split only once: literal prefix (before the first wildcard),
+ * literal suffix (after the last wildcard) and words between wildcards.
+ * If case_sensitive is 0, words are converted to lower case once.
+ *
+ * The char "!" at beginning of mask is not interpreted (it is interpreted
+ * only by function string_mask_compile_list).
+ *
+ * Note: result must be freed after use with function string_mask_free.
+ */
+
+struct t_string_mask *
+string_mask_compile (const char *mask, int case_sensitive)
+{
+    struct t_string_mask *new_mask;
+    struct t_string_mask_word *ptr_word;
+    const char *ptr_mask, *pos_end, *ptr_char;
+    int count, length, i;
+
+    if (!mask)
+        return NULL;
+
+    new_mask = malloc (sizeof (*new_mask));
+    if (!new_mask)
+        return NULL;
+
+    new_mask->mask = strdup (mask);
+    new_mask->case_sensitive = (case_sensitive) ? 1 : 0;
+    new_mask->negated = 0;
+    length = strlen (mask);
+    new_mask->wildcard_start = (mask[0] == '*') ? 1 : 0;
+    new_mask->wildcard_end = ((length > 0) && (mask[length - 1] == '*')) ?
+        1 : 0;
+    new_mask->words_count = 0;
+    new_mask->words = NULL;
+    if (!new_mask->mask)
+        goto error;
+
+    /* count words between wildcards */
+    count = 0;
+    ptr_mask = mask;
+    while (ptr_mask[0])
+    {
+        while (ptr_mask[0] == '*')
+        {
+            ptr_mask++;
+        }
+        if (!ptr_mask[0])
+            break;
+        count++;
+        pos_end = strchr (ptr_mask, '*');
+        ptr_mask = (pos_end) ? pos_end : ptr_mask + strlen (ptr_mask);
+    }
+    if (count == 0)
+        return new_mask;
+
+    new_mask->words = calloc (count, sizeof (*new_mask->words));
+    if (!new_mask->words)
+        goto error;
+
+    /* extract words */
+    ptr_mask = mask;
+    while (ptr_mask[0] && (new_mask->words_count < count))
+    {
+        while (ptr_mask[0] == '*')
+        {
+            ptr_mask++;
+        }
+        pos_end = strchr (ptr_mask, '*');
+        if (!pos_end)
+            pos_end = ptr_mask + strlen (ptr_mask);
+        ptr_word = &new_mask->words[new_mask->words_count];
+        new_mask->words_count++;
+        ptr_word->word = string_strndup (ptr_mask, pos_end - ptr_mask);
+        if (!ptr_word->word)
+            goto error;
+        ptr_word->size = pos_end - ptr_mask;
+        ptr_word->length = utf8_strlen (ptr_word->word);
+        if (!case_sensitive)
+        {
+            ptr_word->chars = malloc (
+                ptr_word->length * sizeof (ptr_word->chars[0]));
+            if (!ptr_word->chars)
+                goto error;
+            ptr_char = ptr_word->word;
+            for (i = 0; i < ptr_word->length; i++)
+            {
+                ptr_word->chars[i] = string_char_lower (ptr_char, 1);
+                ptr_char = utf8_next_char (ptr_char);
+            }
+        }
+        ptr_mask = pos_end;
+    }
+
+    return new_mask;
+
+error:
+    string_mask_free (new_mask);
+    return NULL;
+}
+
+/*
+ * Checks if a word of a compiled mask is at beginning of string; the word
+ * must end before "limit" (if not NULL).
+ *
+ * Returns pointer to the string after the word, NULL if the word is not at
+ * beginning of string.
+ */
+
+const char *
+string_mask_word_at (const char *string, const char *limit,
+                     struct t_string_mask_word *word, int case_sensitive)
+{
+    int i;
+
+    if (case_sensitive)
+    {
+        if ((limit && (limit - string < word->size))
+            || (strncmp (string, word->word, word->size) != 0))
+        {
+            return NULL;
+        }
+        return string + word->size;
+    }
+
+    for (i = 0; i < word->length; i++)
+    {
+        if (!string[0] || (limit && (string >= limit))
+            || (string_char_lower (string, 1) != word->chars[i]))
+        {
+            return NULL;
+        }
+        string = utf8_next_char (string);
+    }
+
+    return string;
+}
+
+/*
+ * Searches the first occurrence of a word of a compiled mask in string; the
+ * word must end before "limit" (if not NULL).
+ *
+ * Returns pointer to the string after the word, NULL if the word is not
+ * found.
+ */
+
+const char *
+string_mask_word_search (const char *string, const char *limit,
+                         struct t_string_mask_word *word, int case_sensitive)
+{
+    const char *pos_word, *ptr_end;
+
+    if (case_sensitive)
+    {
+        /* any other occurrence would end after the first one */
+        pos_word = strstr (string, word->word);
+        if (!pos_word || (limit && (limit - pos_word < word->size)))
+            return NULL;
+        return pos_word + word->size;
+    }
+
+    while (string[0] && (!limit || (string < limit)))
+    {
+        if (string_char_lower (string, 1) == word->chars[0])
+        {
+            ptr_end = string_mask_word_at (string, limit, word, 0);
+            if (ptr_end)
+                return ptr_end;
+        }
+        string = utf8_next_char (string);
+    }
+
+    return NULL;
+}
+
+/*
+ * Checks if a word of a compiled mask is at end of string.
+ *
+ * Returns pointer to the beginning of word in string, NULL if the string
+ * does not end with the word.
+ */
+
+const char *
+string_mask_word_end (const char *string, struct t_string_mask_word *word,
+                      int case_sensitive)
+{
+    const char *ptr_string;
+    int i, length;
+
+    length = strlen (string);
+
+    if (case_sensitive)
+    {
+        if ((length < word->size)
+            || (strcmp (string + length - word->size, word->word) != 0))
+        {
+            return NULL;
+        }
+        return string + length - word->size;
+    }
+
+    ptr_string = string + length;
+    for (i = word->length - 1; i >= 0; i--)
+    {
+        if (ptr_string <= string)
+            return NULL;
+        ptr_string = utf8_prev_char (string, ptr_string);
+        if (!ptr_string
+            || (string_char_lower (ptr_string, 1) != word->chars[i]))
+        {
+            return NULL;
+        }
+    }
+
+    return ptr_string;
+}
+
+/*
+ * Checks if a string matches a compiled mask (see function
+ * string_mask_compile).
+ *
+ * The result is the same as function string_match called with the mask
+ * and case_sensitive flag used to compile the mask, the flag "negated" of
+ * the mask is ignored.
+ *
+ * Returns:
+ *   1: string matches mask
+ *   0: string does not match mask
+ */
+
+int
+string_match_compiled (const char *string, struct t_string_mask *mask)
+{
+    const char *ptr_string, *ptr_limit;
+    int first, last, i;
+
+    if (!string || !mask || !mask->mask[0])
+        return 0;
+
+    /* mask with only wildcards */
+    if (mask->words_count == 0)
+        return 1;
+
+    ptr_string = string;
+    ptr_limit = NULL;
+    first = 0;
+    last = mask->words_count - 1;
+
+    /* check literal prefix */
+    if (!mask->wildcard_start)
+    {
+        ptr_string = string_mask_word_at (string, NULL, &mask->words[0],
+                                          mask->case_sensitive);
+        if (!ptr_string)
+            return 0;
+        if ((mask->words_count == 1) && !mask->wildcard_end)
+            return (ptr_string[0]) ? 0 : 1;
+        first = 1;
+    }
+
+    /* check literal suffix */
+    if (!mask->wildcard_end)
+    {
+        ptr_limit = string_mask_word_end (ptr_string, &mask->words[last],
+                                          mask->case_sensitive);
+        if (!ptr_limit)
+            return 0;
+        last--;
+    }
+
+    /* search other words, in order, before the suffix */
+    for (i = first; i <= last; i++)
+    {
+        ptr_string = string_mask_word_search (ptr_string, ptr_limit,
+                                              &mask->words[i],
+                                              mask->case_sensitive);
+        if (!ptr_string)
+            return 0;
+    }
+
+    return 1;
+}
+
+/*
+ * Frees a compiled mask.
+ */
+
+void
+string_mask_free (struct t_string_mask *mask)
+{
+    int i;
+
+    if (!mask)
+        return;
+
+    free (mask->mask);
+    if (mask->words)
+    {
+        for (i = 0; i < mask->words_count; i++)
+        {
+            free (mask->words[i].word);
+            free (mask->words[i].chars);
+        }
+        free (mask->words);
+    }
+
+    free (mask);
+}
+
+/*
+ * Compiles a list of masks to match them quickly with function
+ * string_match_list_compiled.
+ *
+ * Negative masks are allowed with "!mask" (see function string_match_list).
+ *
+ * Returns a NULL-terminated array of compiled masks, NULL if error.
+ *
+ * Note: result must be freed after use with function string_mask_free_list.
+ */
+
+struct t_string_mask **
+string_mask_compile_list (const char **masks, int case_sensitive)
+{
+    struct t_string_mask **list;
+    int count, i, negated;
+
+    if (!masks)
+        return NULL;
+
+    for (count = 0; masks[count]; count++)
+    {
+    }
+
+    list = calloc (count + 1, sizeof (*list));
+    if (!list)
+        return NULL;
+
+    for (i = 0; i < count; i++)
+    {
+        negated = (masks[i][0] == '!') ? 1 : 0;
+        list[i] = string_mask_compile (masks[i] + negated, case_sensitive);
+        if (!list[i])
+        {
+            string_mask_free_list (list);
+            return NULL;
+        }
+        list[i]->negated = negated;
+    }
+
+    return list;
+}
+
+/*
+ * Checks if a string matches a list of compiled masks (see function
+ * string_mask_compile_list).
+ *
+ * The result is the same as function string_match_list called with the list
+ * of masks used to compile the list.
+ *
+ * Returns:
+ *   1: string matches list of masks
+ *   0: string does not match list of masks
+ */
+
+int
+string_match_list_compiled (const char *string, struct t_string_mask **masks)
+{
+    int match, i;
+
+    if (!string || !masks)
+        return 0;
+
+    match = 0;
+
+    for (i = 0; masks[i]; i++)
+    {
+        if (string_match_compiled (string, masks[i]))
+        {
+            if (masks[i]->negated)
+                return 0;
+            else
+                match = 1;
+        }
+    }
+
+    return match;
+}
+
+/*
+ * Frees a list of compiled masks.
+ */
+
+void
+string_mask_free_list (struct t_string_mask **masks)
+{
+    int i;
+
+    if (!masks)
+        return;
+
+    for (i = 0; masks[i]; i++)
+    {
+        string_mask_free (masks[i]);
+    }
+
+    free (masks);
+}
+
 /*
  * Expands home in a path.
  *
@@ -1635,10 +2091,11 @@ string_mask_to_regex (const char *mask)
 /*
  * Extracts flags and regex from a string.
  *
- * Format of flags is: (?eins-eins)string
+ * Format of flags is: (?eijns-eijns)string
  * Flags are:
  *   e: POSIX extended regex (REG_EXTENDED)
  *   i: case insensitive (REG_ICASE)
+ *   j: match with PCRE2 and JIT compilation, if available (STRING_REGEX_JIT)
  *   n: match-any-character operators don't match a newline (REG_NEWLINE)
  *   s: support for substring addressing of matches is not required (REG_NOSUB)
  *
@@ -1686,6 +2143,9 @@ string_regex_flags (const char *regex, int default_flags, int *flags)
                     case 'i':
                         flag = REG_ICASE;
                         break;
+                    case 'j':
+                        flag = STRING_REGEX_JIT;
+                        break;
                     case 'n':
                         flag = REG_NEWLINE;
                         break;
@@ -1695,49 +2155,744 @@ string_regex_flags (const char *regex, int default_flags, int *flags)
                 }
                 if (flag > 0)
                 {
-                    if (set_flag)
-                        *flags |= flag;
-                    else
-                        *flags &= ~flag;
+                    if (set_flag)
+                        *flags |= flag;
+                    else
+                        *flags &= ~flag;
+                }
+            }
+        }
+        ptr_regex = pos + 1;
+    }
+
+    return ptr_regex;
+}
+
+#ifdef HAVE_PCRE2
+/*
+ * Frees PCRE2 match data of a thread.
+ */
+
+void
+string_regex_jit_free_match_data (void *match_data)
+{
+    pcre2_match_data_free ((pcre2_match_data *)match_data);
+}
+
+/*
+ * Frees a PCRE2 compiled regex (value of hashtable).
+ */
+
+void
+string_regex_jit_free_value (struct t_hashtable *hashtable,
+                             const void *key, void *value)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    pcre2_code_free ((pcre2_code *)value);
+}
+
+/*
+ * Compiles a regex with PCRE2 (and JIT compilation if supported) and links
+ * it to the POSIX regex "preg".
+ *
+ * Only extended regex are compiled (basic regex syntax is not supported by
+ * PCRE2); if the compilation fails, the POSIX regex is used to match.
+ */
+
+void
+string_regex_jit_compile (void *preg, const char *regex, int flags)
+{
+    pcre2_code *code;
+    uint32_t options;
+    int error_code;
+    PCRE2_SIZE error_offset;
+
+    if (!(flags & REG_EXTENDED))
+        return;
+
+    options = PCRE2_UTF;
+#ifdef PCRE2_MATCH_INVALID_UTF
+    options |= PCRE2_MATCH_INVALID_UTF;
+#endif /* PCRE2_MATCH_INVALID_UTF */
+    if (flags & REG_ICASE)
+        options |= PCRE2_CASELESS;
+    options |= (flags & REG_NEWLINE) ? PCRE2_MULTILINE : PCRE2_DOTALL;
+
+    code = pcre2_compile ((PCRE2_SPTR)regex, PCRE2_ZERO_TERMINATED, options,
+                          &error_code, &error_offset, NULL);
+    if (!code)
+        return;
+
+    /* if JIT is not supported, the PCRE2 interpreter is used */
+    pcre2_jit_compile (code, PCRE2_JIT_COMPLETE);
+
+    pthread_mutex_lock (&string_regex_jit_mutex);
+    if (!string_hashtable_regex_jit)
+    {
+        string_hashtable_regex_jit = hashtable_new (
+            32,
+            WEECHAT_HASHTABLE_POINTER,
+            WEECHAT_HASHTABLE_POINTER,
+            NULL, NULL);
+        if (string_hashtable_regex_jit)
+            string_hashtable_regex_jit->callback_free_value = &string_regex_jit_free_value;
+    }
+    if (string_hashtable_regex_jit)
+        hashtable_set (string_hashtable_regex_jit, preg, code);
+    else
+        pcre2_code_free (code);
+    pthread_mutex_unlock (&string_regex_jit_mutex);
+}
+
+/*
+ * Removes the PCRE2 compiled regex linked to a regex_t (if any).
+ */
+
+void
+string_regex_jit_remove (void *preg)
+{
+    pthread_mutex_lock (&string_regex_jit_mutex);
+    if (string_hashtable_regex_jit)
+        hashtable_remove (string_hashtable_regex_jit, preg);
+    pthread_mutex_unlock (&string_regex_jit_mutex);
+}
+
+/*
+ * Executes a PCRE2 compiled regex.
+ *
+ * Returns:
+ *   0: match
+ *   REG_NOMATCH: no match
+ *   -1: error (then the POSIX regex must be used)
+ */
+
+int
+string_regex_jit_exec (pcre2_code *code, const char *string,
+                       size_t nmatch, regmatch_t *pmatch, int eflags)
+{
+    pcre2_match_data *match_data;
+    PCRE2_SIZE *ovector;
+    uint32_t options;
+    int rc;
+    size_t i, count;
+
+    if (!string_regex_match_data_key_ok || (nmatch > STRING_REGEX_MAX_MATCHES))
+        return -1;
+
+    match_data = pthread_getspecific (string_regex_match_data_key);
+    if (!match_data)
+    {
+        match_data = pcre2_match_data_create (STRING_REGEX_MAX_MATCHES, NULL);
+        if (!match_data)
+            return -1;
+        if (pthread_setspecific (string_regex_match_data_key, match_data) != 0)
+        {
+            pcre2_match_data_free (match_data);
+            return -1;
+        }
+    }
+
+    options = 0;
+    if (eflags & REG_NOTBOL)
+        options |= PCRE2_NOTBOL;
+    if (eflags & REG_NOTEOL)
+        options |= PCRE2_NOTEOL;
+
+    rc = pcre2_match (code, (PCRE2_SPTR)string, PCRE2_ZERO_TERMINATED, 0,
+                      options, match_data, NULL);
+    if (rc == PCRE2_ERROR_NOMATCH)
+        return REG_NOMATCH;
+    if (rc < 0)
+        return -1;
+
+    /* rc == 0 means that ovector is too small: all pairs are set */
+    count = (rc == 0) ? STRING_REGEX_MAX_MATCHES : (size_t)rc;
+    ovector = pcre2_get_ovector_pointer (match_data);
+    for (i = 0; i < nmatch; i++)
+    {
+        if ((i < count) && (ovector[i * 2] != PCRE2_UNSET))
+        {
+            pmatch[i].rm_so = (regoff_t)ovector[i * 2];
+            pmatch[i].rm_eo = (regoff_t)ovector[(i * 2) + 1];
+        }
+        else
+        {
+            pmatch[i].rm_so = -1;
+            pmatch[i].rm_eo = -1;
+        }
+    }
+
+    return 0;
+}
+#endif /* HAVE_PCRE2 */
+
+/*
+ * Compiles a regex using optional flags at beginning of string (for format of
+ * flags in regex, see string_regex_flags()).
+ *
+ * If flag "j" is set and WeeChat is built with PCRE2, the regex is compiled
+ * with PCRE2 as well, and it is used by string_regexec() to match strings
+ * (the POSIX regex is always compiled, so that "regexec" can still be used).
+ *
+ * Returns:
+ *   0: successful compilation
+ *   other value: compilation failed
+ *
+ * Note: regex must be freed with string_regfree after use.
+ */
+
+int
+string_regcomp (void *preg, const char *regex, int default_flags)
+{
+    const char *ptr_regex;
+    int flags, rc;
+
+    if (!regex)
+        return -1;
+
+    ptr_regex = string_regex_flags (regex, default_flags, &flags);
+    if (!ptr_regex || !ptr_regex[0])
+        ptr_regex = "^";
+
+#ifdef HAVE_PCRE2
+    /* remove any PCRE2 regex previously linked to this address */
+    string_regex_jit_remove (preg);
+#endif /* HAVE_PCRE2 */
+
+    rc = regcomp ((regex_t *)preg, ptr_regex, flags & ~STRING_REGEX_JIT);
+
+#ifdef HAVE_PCRE2
+    if ((rc == 0) && (flags & STRING_REGEX_JIT))
+        string_regex_jit_compile (preg, ptr_regex, flags);
+#endif /* HAVE_PCRE2 */
+
+    return rc;
+}
+
+/*
+ * Matches a string with a regex compiled by string_regcomp().
+ *
+ * The PCRE2 regex is used if the regex was compiled with flag "j" (and
+ * WeeChat is built with PCRE2), otherwise the function "regexec" is called.
+ *
+ * Returns:
+ *   0: match
+ *   REG_NOMATCH: no match
+ */
+
+int
+string_regexec (void *preg, const char *string, size_t nmatch,
+                void *pmatch, int eflags)
+{
+#ifdef HAVE_PCRE2
+    pcre2_code *code;
+    int rc;
+
+    code = NULL;
+    pthread_mutex_lock (&string_regex_jit_mutex);
+    if (string_hashtable_regex_jit)
+        code = hashtable_get (string_hashtable_regex_jit, preg);
+    pthread_mutex_unlock (&string_regex_jit_mutex);
+    if (code)
+    {
+        rc = string_regex_jit_exec (code, string, nmatch,
+                                    (regmatch_t *)pmatch, eflags);
+        if (rc >= 0)
+            return rc;
+    }
+#endif /* HAVE_PCRE2 */
+
+    return regexec ((regex_t *)preg, string, nmatch, (regmatch_t *)pmatch,
+                    eflags);
+}
+
+/*
+ * Frees a regex compiled by string_regcomp().
+ */
+
+void
+string_regfree (void *preg)
+{
+    if (!preg)
+        return;
+
+#ifdef HAVE_PCRE2
+    string_regex_jit_remove (preg);
+#endif /* HAVE_PCRE2 */
+
+    regfree ((regex_t *)preg);
+}
+
+/*
+ * Searches the transition of a state for a char.
+ *
+ * Returns the next state, -1 if not found.
+ */
+
+int
+string_highlight_goto (struct t_string_highlight_state *state, int wchar)
+{
+    int min, max, middle;
+
+    min = 0;
+    max = state->edges_count - 1;
+    while (min <= max)
+    {
+        middle = (min + max) / 2;
+        if (state->edges[middle].wchar == wchar)
+            return state->edges[middle].state;
+        if (state->edges[middle].wchar < wchar)
+            min = middle + 1;
+        else
+            max = middle - 1;
+    }
+
+    return -1;
+}
+
+/*
+ * Adds a state in an automaton.
+ *
+ * Returns the index of new state, -1 if error.
+ */
+
+int
+string_highlight_add_state (struct t_string_highlight_automaton *automaton)
+{
+    struct t_string_highlight_state *new_states, *ptr_state;
+    int new_alloc;
+
+    if (automaton->states_count >= automaton->states_alloc)
+    {
+        new_alloc = (automaton->states_alloc == 0) ?
+            16 : automaton->states_alloc * 2;
+        new_states = realloc (automaton->states,
+                              new_alloc * sizeof (automaton->states[0]));
+        if (!new_states)
+            return -1;
+        automaton->states = new_states;
+        automaton->states_alloc = new_alloc;
+    }
+
+    ptr_state = &automaton->states[automaton->states_count];
+    ptr_state->edges = NULL;
+    ptr_state->edges_count = 0;
+    ptr_state->fail = 0;
+    ptr_state->output = -1;
+    ptr_state->word = -1;
+
+    return automaton->states_count++;
+}
+
+/*
+ * Adds a word in the trie of an automaton.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+string_highlight_add_word (struct t_string_highlight *highlight,
+                           struct t_string_highlight_automaton *automaton,
+                           const char *word, int lower, int index_word)
+{
+    struct t_string_highlight_edge *new_edges;
+    struct t_string_highlight_state *ptr_state;
+    const char *ptr_word;
+    int state, next_state, wchar, i;
+
+    if (automaton->states_count == 0)
+    {
+        if (string_highlight_add_state (automaton) < 0)
+            return 0;
+    }
+
+    state = 0;
+    ptr_word = word;
+    while (ptr_word[0])
+    {
+        wchar = string_char_lower (ptr_word, lower);
+        next_state = string_highlight_goto (&automaton->states[state], wchar);
+        if (next_state < 0)
+        {
+            next_state = string_highlight_add_state (automaton);
+            if (next_state < 0)
+                return 0;
+            ptr_state = &automaton->states[state];
+            new_edges = realloc (ptr_state->edges,
+                                 (ptr_state->edges_count + 1)
+                                 * sizeof (ptr_state->edges[0]));
+            if (!new_edges)
+                return 0;
+            ptr_state->edges = new_edges;
+            /* insert the transition, keeping the array sorted by char */
+            i = ptr_state->edges_count;
+            while ((i > 0) && (ptr_state->edges[i - 1].wchar > wchar))
+            {
+                ptr_state->edges[i] = ptr_state->edges[i - 1];
+                i--;
+            }
+            ptr_state->edges[i].wchar = wchar;
+            ptr_state->edges[i].state = next_state;
+            ptr_state->edges_count++;
+        }
+        state = next_state;
+        ptr_word = utf8_next_char (ptr_word);
+    }
+
+    highlight->words[index_word].next_word = automaton->states[state].word;
+    automaton->states[state].word = index_word;
+
+    return 1;
+}
+
+/*
+ * Computes the fail and output links of states in an automaton (breadth-first
+ * traversal of the trie).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+string_highlight_build_links (struct t_string_highlight_automaton *automaton)
+{
+    struct t_string_highlight_state *ptr_state, *ptr_next_state;
+    int *queue, queue_start, queue_end, state, fail, next_fail, i;
+
+    if (automaton->states_count == 0)
+        return 1;
+
+    queue = malloc (automaton->states_count * sizeof (queue[0]));
+    if (!queue)
+        return 0;
+
+    queue_start = 0;
+    queue_end = 0;
+    queue[queue_end++] = 0;
+    while (queue_start < queue_end)
+    {
+        state = queue[queue_start++];
+        ptr_state = &automaton->states[state];
+        for (i = 0; i < ptr_state->edges_count; i++)
+        {
+            ptr_next_state = &automaton->states[ptr_state->edges[i].state];
+            fail = 0;
+            if (state != 0)
+            {
+                fail = ptr_state->fail;
+                while (1)
+                {
+                    next_fail = string_highlight_goto (
+                        &automaton->states[fail], ptr_state->edges[i].wchar);
+                    if (next_fail >= 0)
+                    {
+                        fail = next_fail;
+                        break;
+                    }
+                    if (fail == 0)
+                        break;
+                    fail = automaton->states[fail].fail;
+                }
+            }
+            ptr_next_state->fail = fail;
+            ptr_next_state->output = (automaton->states[fail].word >= 0) ?
+                fail : automaton->states[fail].output;
+            queue[queue_end++] = ptr_state->edges[i].state;
+        }
+    }
+
+    free (queue);
+
+    return 1;
+}
+
+/*
+ * Compiles a list of words to highlight (comma separated, for format of
+ * words, see string_has_highlight()) in an Aho-Corasick automaton, so that
+ * a string can be checked for all words in a single pass.
+ *
+ * Returns pointer to compiled highlight, NULL if error.
+ *
+ * Note: result must be freed with string_highlight_free after use.
+ */
+
+struct t_string_highlight *
+string_highlight_compile (const char *highlight_words)
+{
+    struct t_string_highlight *new_highlight;
+    struct t_string_highlight_word *new_words;
+    char *highlight, *pos, *pos_end;
+    int end, length, wildcard_start, wildcard_end, flags, sensitive, i;
+
+    if (!highlight_words)
+        return NULL;
+
+    new_highlight = malloc (sizeof (*new_highlight));
+    if (!new_highlight)
+        return NULL;
+
+    new_highlight->highlight_words = strdup (highlight_words);
+    new_highlight->words = NULL;
+    new_highlight->words_count = 0;
+    for (i = 0; i < 2; i++)
+    {
+        new_highlight->automaton[i].states = NULL;
+        new_highlight->automaton[i].states_count = 0;
+        new_highlight->automaton[i].states_alloc = 0;
+    }
+    if (!new_highlight->highlight_words)
+        goto error;
+
+    highlight = strdup (highlight_words);
+    if (!highlight)
+        goto error;
+
+    pos = highlight;
+    end = 0;
+    while (!end)
+    {
+        flags = 0;
+        pos = (char *)string_regex_flags (pos, REG_ICASE, &flags);
+
+        pos_end = strchr (pos, ',');
+        if (!pos_end)
+        {
+            pos_end = strchr (pos, '\0');
+            end = 1;
+        }
+
+        length = pos_end - pos;
+        pos_end[0] = '\0';
+        wildcard_start = 0;
+        wildcard_end = 0;
+        if (length > 0)
+        {
+            if ((wildcard_start = (pos[0] == '*')))
+            {
+                pos++;
+                length--;
+            }
+            if ((wildcard_end = (*(pos_end - 1) == '*')))
+            {
+                *(pos_end - 1) = '\0';
+                length--;
+            }
+        }
+
+        if (length > 0)
+        {
+            new_words = realloc (new_highlight->words,
+                                 (new_highlight->words_count + 1)
+                                 * sizeof (new_highlight->words[0]));
+            if (!new_words)
+            {
+                free (highlight);
+                goto error;
+            }
+            new_highlight->words = new_words;
+            new_words[new_highlight->words_count].length = utf8_strlen (pos);
+            new_words[new_highlight->words_count].wildcard_start = wildcard_start;
+            new_words[new_highlight->words_count].wildcard_end = wildcard_end;
+            new_words[new_highlight->words_count].next_word = -1;
+            sensitive = (flags & REG_ICASE) ? 0 : 1;
+            if (!string_highlight_add_word (
+                    new_highlight,
+                    &new_highlight->automaton[sensitive],
+                    pos,
+                    !sensitive,
+                    new_highlight->words_count))
+            {
+                free (highlight);
+                goto error;
+            }
+            new_highlight->words_count++;
+        }
+
+        if (!end)
+            pos = pos_end + 1;
+    }
+
+    free (highlight);
+
+    for (i = 0; i < 2; i++)
+    {
+        if (!string_highlight_build_links (&new_highlight->automaton[i]))
+            goto error;
+    }
+
+    return new_highlight;
+
+error:
+    string_highlight_free (new_highlight);
+    return NULL;
+}
+
+/*
+ * Checks if a word found in a string (ending with the char at "ptr_char")
+ * is a highlight, according to the delimiters around the word.
+ *
+ * Returns:
+ *   1: the word is a highlight
+ *   0: the word is not a highlight
+ */
+
+int
+string_highlight_check_word (struct t_string_highlight_word *word,
+                             const char *string, const char *ptr_char,
+                             const char *ptr_next_char)
+{
+    const char *match, *match_pre;
+    int i, startswith, endswith;
+
+    if (word->wildcard_start && word->wildcard_end)
+        return 1;
+
+    match = ptr_char;
+    for (i = 1; match && (i < word->length); i++)
+    {
+        match = utf8_prev_char (string, match);
+    }
+    if (!match)
+        return 0;
+
+    startswith = 1;
+    if (!word->wildcard_start && (match > string))
+    {
+        match_pre = utf8_prev_char (string, match);
+        startswith = (!match_pre
+                      || !string_is_word_char_highlight (match_pre));
+    }
+    endswith = (word->wildcard_end
+                || !ptr_next_char[0]
+                || !string_is_word_char_highlight (ptr_next_char));
+
+    return startswith && endswith;
+}
+
+/*
+ * Runs an automaton on a string.
+ *
+ * Returns:
+ *   1: string has a highlight
+ *   0: string has no highlight
+ */
+
+int
+string_highlight_match_automaton (struct t_string_highlight *highlight,
+                                  struct t_string_highlight_automaton *automaton,
+                                  const char *string, int lower)
+{
+    struct t_string_highlight_state *states;
+    const char *ptr_string, *ptr_next;
+    int state, next_state, output, word, wchar;
+
+    if (automaton->states_count <= 1)
+        return 0;
+
+    states = automaton->states;
+    state = 0;
+    ptr_string = string;
+    while (ptr_string[0])
+    {
+        wchar = string_char_lower (ptr_string, lower);
+        ptr_next = ((unsigned char)(ptr_string[0]) & 0x80) ?
+            utf8_next_char (ptr_string) : ptr_string + 1;
+        while (1)
+        {
+            next_state = string_highlight_goto (&states[state], wchar);
+            if (next_state >= 0)
+            {
+                state = next_state;
+                break;
+            }
+            if (state == 0)
+                break;
+            state = states[state].fail;
+        }
+        output = (states[state].word >= 0) ? state : states[state].output;
+        while (output >= 0)
+        {
+            for (word = states[output].word; word >= 0;
+                 word = highlight->words[word].next_word)
+            {
+                if (string_highlight_check_word (&highlight->words[word],
+                                                 string, ptr_string,
+                                                 ptr_next))
+                {
+                    return 1;
                 }
             }
+            output = states[output].output;
         }
-        ptr_regex = pos + 1;
+        ptr_string = ptr_next;
     }
 
-    return ptr_regex;
+    return 0;
 }
 
 /*
- * Compiles a regex using optional flags at beginning of string (for format of
- * flags in regex, see string_regex_flags()).
+ * Checks if a string has a highlight using words compiled with
+ * string_highlight_compile().
  *
  * Returns:
- *   0: successful compilation
- *   other value: compilation failed
- *
- * Note: regex must be freed with regfree after use.
+ *   1: string has a highlight
+ *   0: string has no highlight
  */
 
 int
-string_regcomp (void *preg, const char *regex, int default_flags)
+string_highlight_match (struct t_string_highlight *highlight,
+                        const char *string)
 {
-    const char *ptr_regex;
-    int flags;
+    if (!highlight || !string || !string[0] || (highlight->words_count == 0))
+        return 0;
 
-    if (!regex)
-        return -1;
+    return (string_highlight_match_automaton (highlight,
+                                              &highlight->automaton[0],
+                                              string, 1)
+            || string_highlight_match_automaton (highlight,
+                                                 &highlight->automaton[1],
+                                                 string, 0));
+}
 
-    ptr_regex = string_regex_flags (regex, default_flags, &flags);
+/*
+ * Frees a compiled highlight.
+ */
+
+void
+string_highlight_free (struct t_string_highlight *highlight)
+{
+    int i, j;
+
+    if (!highlight)
+        return;
+
+    free (highlight->highlight_words);
+    free (highlight->words);
+    for (i = 0; i < 2; i++)
+    {
+        for (j = 0; j < highlight->automaton[i].states_count; j++)
+        {
+            free (highlight->automaton[i].states[j].edges);
+        }
+        free (highlight->automaton[i].states);
+    }
 
-    return regcomp ((regex_t *)preg,
-                    (ptr_regex && ptr_regex[0]) ? ptr_regex : "^",
-                    flags);
+    free (highlight);
 }
 
 /*
  * Checks if a string has a highlight (using list of words to highlight).
  *
+ * Words are separated by commas, each word can start with flags (see
+ * string_regex_flags(); by default, comparison is case insensitive), and
+ * can start and/or end with "*" to match partial words.
+ *
  * Returns:
  *   1: string has a highlight
  *   0: string has no highlight
@@ -1746,100 +2901,21 @@ string_regcomp (void *preg, const char *regex, int default_flags)
 int
 string_has_highlight (const char *string, const char *highlight_words)
 {
-    const char *match, *match_pre, *match_post, *msg_pos;
-    char *msg, *highlight, *pos, *pos_end;
-    int end, length, startswith, endswith, wildcard_start, wildcard_end, flags;
+    struct t_string_highlight *highlight;
+    int rc;
 
     if (!string || !string[0] || !highlight_words || !highlight_words[0])
         return 0;
 
-    msg = strdup (string);
-    if (!msg)
-        return 0;
-
-    highlight = strdup (highlight_words);
+    highlight = string_highlight_compile (highlight_words);
     if (!highlight)
-    {
-        free (msg);
         return 0;
-    }
-
-    pos = highlight;
-    end = 0;
-    while (!end)
-    {
-        flags = 0;
-        pos = (char *)string_regex_flags (pos, REG_ICASE, &flags);
-
-        pos_end = strchr (pos, ',');
-        if (!pos_end)
-        {
-            pos_end = strchr (pos, '\0');
-            end = 1;
-        }
-        /* error parsing string! */
-        if (!pos_end)
-        {
-            free (msg);
-            free (highlight);
-            return 0;
-        }
-
-        length = pos_end - pos;
-        pos_end[0] = '\0';
-        if (length > 0)
-        {
-            if ((wildcard_start = (pos[0] == '*')))
-            {
-                pos++;
-                length--;
-            }
-            if ((wildcard_end = (*(pos_end - 1) == '*')))
-            {
-                *(pos_end - 1) = '\0';
-                length--;
-            }
-        }
-
-        if (length > 0)
-        {
-            msg_pos = msg;
-            while (1)
-            {
-                match = (flags & REG_ICASE) ?
-                    string_strcasestr (msg_pos, pos) : strstr (msg_pos, pos);
-                if (!match)
-                    break;
-                match_pre = utf8_prev_char (msg, match);
-                if (!match_pre)
-                    match_pre = match - 1;
-                match_post = match + length;
-                startswith = ((match == msg) || (!string_is_word_char_highlight (match_pre)));
-                endswith = ((!match_post[0]) || (!string_is_word_char_highlight (match_post)));
-                if ((wildcard_start && wildcard_end) ||
-                    (!wildcard_start && !wildcard_end &&
-                     startswith && endswith) ||
-                    (wildcard_start && endswith) ||
-                    (wildcard_end && startswith))
-                {
-                    /* highlight found! */
-                    free (msg);
-                    free (highlight);
-                    return 1;
-                }
-                msg_pos = match_post;
-            }
-        }
 
-        if (!end)
-            pos = pos_end + 1;
-    }
+    rc = string_highlight_match (highlight, string);
 
-    free (msg);
-    free (highlight);
+    string_highlight_free (highlight);
 
-    /* no highlight found */
-    return 0;
+    return rc;
 }
 
 /*
@@ -1859,7 +2935,7 @@ string_has_highlight_regex_compiled (const char *string, regex_t *regex)
 
     while (string && string[0])
     {
-        rc = regexec (regex, string,  1, &regex_match, 0);
+        rc = string_regexec (regex, string, 1, &regex_match, 0);
 
         /*
          * no match found: exit the loop (if rm_eo == 0, it is an empty match
@@ -1910,7 +2986,7 @@ string_has_highlight_regex (const char *string, const char *regex)
 
     rc = string_has_highlight_regex_compiled (string, &reg);
 
-    regfree (&reg);
+    string_regfree (&reg);
 
     return rc;
 }
@@ -2199,7 +3275,7 @@ string_replace_regex (const char *string, void *regex, const char *replace,
             regex_match[i].rm_so = -1;
         }
 
-        rc = regexec ((regex_t *)regex, result + start_offset, 100, regex_match,
+        rc = string_regexec (regex, result + start_offset, 100, regex_match,
                       0);
         /*
          * no match found: exit the loop (if rm_eo == 0, it is an empty match
@@ -2424,7 +3500,7 @@ string_split_internal (const char *string, const char *separators,
                        int num_items_max, int *num_items, int shared)
 {
     int i, j, count_items;
-    char *string2, **array, *temp_str, *ptr, *ptr1, *ptr2;
+    char *string2, **array, *temp_str, *ptr, *ptr1, *ptr2, char_end;
     const char *str_shared;
 
     if (num_items)
@@ -2549,6 +3625,16 @@ string_split_internal (const char *string, const char *separators,
                     if (!array[i])
                         goto error;
                 }
+                else if (shared && (!strip_items || !strip_items[0]))
+                {
+                    /* no temporary copy: the item is shared in place */
+                    char_end = ptr2[0];
+                    ptr2[0] = '\0';
+                    array[i] = (char *)string_shared_get (ptr1);
+                    ptr2[0] = char_end;
+                    if (!array[i])
+                        goto error;
+                }
                 else
                 {
                     array[i] = malloc (ptr2 - ptr1 + 1);
@@ -2644,6 +3730,200 @@ string_split_shared (const char *string, const char *separators,
                                   num_items_max, num_items, 1);
 }
 
+/*
+ * Initializes a cursor to split a string according to separators, without
+ * allocating memory: items are returned one by one by function
+ * string_split_cursor_next, as pointers in the string with a length.
+ *
+ * The items are the same as the ones returned by function string_split
+ * (without argument "strip_items"); the cursor does not copy the string,
+ * which must not be changed or freed while the cursor is used.
+ *
+ * Example:
+ *
+ *   struct t_string_split_cursor cursor;
+ *   const char *item;
+ *   int length;
+ *
+ *   string_split_cursor_init (&cursor, "abc,de,fghi", ",", 0, 0);
+ *   while (string_split_cursor_next (&cursor, &item, &length))
+ *   {
+ *       ...
+ *   }
+ */
+
+void
+string_split_cursor_init (struct t_string_split_cursor *cursor,
+                          const char *string, const char *separators,
+                          int flags, int num_items_max)
+{
+    const char *ptr_string;
+
+    if (!cursor)
+        return;
+
+    cursor->separators = separators;
+    cursor->flags = flags;
+    cursor->num_items_max = num_items_max;
+    cursor->num_items = 0;
+    cursor->ptr = NULL;
+    cursor->end = NULL;
+    cursor->empty_last = 0;
+
+    if (!string || !string[0] || !separators || !separators[0])
+        return;
+
+    cursor->ptr = string;
+    cursor->end = string + strlen (string);
+    if (flags & WEECHAT_STRING_SPLIT_STRIP_LEFT)
+    {
+        while (cursor->ptr[0] && strchr (separators, cursor->ptr[0]))
+        {
+            cursor->ptr++;
+        }
+    }
+    if (flags & WEECHAT_STRING_SPLIT_STRIP_RIGHT)
+    {
+        while ((cursor->end > cursor->ptr)
+               && strchr (separators, cursor->end[-1]))
+        {
+            cursor->end--;
+        }
+    }
+
+    /* empty string after strip: no items */
+    if (cursor->ptr >= cursor->end)
+    {
+        cursor->ptr = NULL;
+        return;
+    }
+
+    /*
+     * like function string_split, leading separators collapsed (and not
+     * stripped) give an empty item after the last one
+     */
+    if ((flags & WEECHAT_STRING_SPLIT_COLLAPSE_SEPS)
+        && strchr (separators, cursor->ptr[0]))
+    {
+        ptr_string = cursor->ptr;
+        while ((ptr_string < cursor->end)
+               && strchr (separators, ptr_string[0]))
+        {
+            ptr_string++;
+        }
+        cursor->empty_last = (ptr_string < cursor->end) ? 1 : 0;
+    }
+}
+
+/*
+ * Returns the next item of a string split with a cursor (see function
+ * string_split_cursor_init).
+ *
+ * The item is not NUL-terminated: "length" is its size in bytes.
+ *
+ * Returns:
+ *   1: item returned in "item" and "length"
+ *   0: no more items
+ */
+
+int
+string_split_cursor_next (struct t_string_split_cursor *cursor,
+                          const char **item, int *length)
+{
+    const char *ptr_end;
+
+    if (!cursor
+        || ((cursor->num_items_max > 0)
+            && (cursor->num_items >= cursor->num_items_max)))
+    {
+        return 0;
+    }
+
+    if (cursor->ptr && (cursor->flags & WEECHAT_STRING_SPLIT_COLLAPSE_SEPS))
+    {
+        /* skip separators to find the beginning of item */
+        while ((cursor->ptr < cursor->end)
+               && strchr (cursor->separators, cursor->ptr[0]))
+        {
+            cursor->ptr++;
+        }
+        if ((cursor->ptr >= cursor->end) && (cursor->num_items > 0))
+            cursor->ptr = NULL;
+    }
+
+    if (!cursor->ptr)
+    {
+        if (!cursor->empty_last)
+            return 0;
+        cursor->empty_last = 0;
+        if (item)
+            *item = cursor->end;
+        if (length)
+            *length = 0;
+        cursor->num_items++;
+        return 1;
+    }
+
+    /* search the end of item */
+    ptr_end = cursor->ptr;
+    while ((ptr_end < cursor->end)
+           && !strchr (cursor->separators, ptr_end[0]))
+    {
+        ptr_end++;
+    }
+
+    if (item)
+        *item = cursor->ptr;
+    if (length)
+    {
+        /* like function string_split, an empty item is kept empty */
+        *length = ((cursor->flags & WEECHAT_STRING_SPLIT_KEEP_EOL)
+                   && (ptr_end > cursor->ptr)) ?
+            cursor->end - cursor->ptr : ptr_end - cursor->ptr;
+    }
+    cursor->num_items++;
+
+    if (ptr_end < cursor->end)
+    {
+        /* skip the separator found */
+        cursor->ptr = (cursor->flags & WEECHAT_STRING_SPLIT_COLLAPSE_SEPS) ?
+            ptr_end : ptr_end + 1;
+    }
+    else
+    {
+        cursor->ptr = NULL;
+    }
+
+    return 1;
+}
+
+/*
+ * Counts the items of a string split according to separators, without
+ * allocating memory.
+ *
+ * Returns the number of items, which is the same as the number of items
+ * returned by function string_split.
+ */
+
+int
+string_split_count (const char *string, const char *separators, int flags,
+                    int num_items_max)
+{
+    struct t_string_split_cursor cursor;
+    int count;
+
+    string_split_cursor_init (&cursor, string, separators, flags,
+                              num_items_max);
+
+    count = 0;
+    while (string_split_cursor_next (&cursor, NULL, NULL))
+    {
+        count++;
+    }
+
+    return count;
+}
+
 /*
  * Splits a string like the shell does for a command with arguments.
  *
@@ -3058,35 +4338,46 @@ string_free_split_command (char **split_command)
 char ***
 string_split_tags (const char *tags, int *num_tags)
 {
-    char ***tags_array, **tags_array_temp;
-    int i, tags_count;
+    struct t_string_split_cursor cursor;
+    char ***tags_array, *tag;
+    const char *ptr_tag;
+    int i, tags_count, length;
 
     tags_array = NULL;
     tags_count = 0;
 
     if (tags)
     {
-        tags_array_temp = string_split (tags, ",", NULL,
-                                        WEECHAT_STRING_SPLIT_STRIP_LEFT
-                                        | WEECHAT_STRING_SPLIT_STRIP_RIGHT
-                                        | WEECHAT_STRING_SPLIT_COLLAPSE_SEPS,
-                                        0, &tags_count);
-        if (tags_array_temp && (tags_count > 0))
+        /* count tags first, without allocating them */
+        tags_count = string_split_count (tags, ",",
+                                         WEECHAT_STRING_SPLIT_STRIP_LEFT
+                                         | WEECHAT_STRING_SPLIT_STRIP_RIGHT
+                                         | WEECHAT_STRING_SPLIT_COLLAPSE_SEPS,
+                                         0);
+        if (tags_count > 0)
         {
             tags_array = malloc ((tags_count + 1) * sizeof (*tags_array));
             if (tags_array)
             {
+                string_split_cursor_init (&cursor, tags, ",",
+                                          WEECHAT_STRING_SPLIT_STRIP_LEFT
+                                          | WEECHAT_STRING_SPLIT_STRIP_RIGHT
+                                          | WEECHAT_STRING_SPLIT_COLLAPSE_SEPS,
+                                          0);
                 for (i = 0; i < tags_count; i++)
                 {
-                    tags_array[i] = string_split_shared (tags_array_temp[i],
-                                                         "+", NULL,
-                                                         0, 0,
-                                                         NULL);
+                    tags_array[i] = NULL;
+                    if (string_split_cursor_next (&cursor, &ptr_tag, &length))
+                    {
+                        tag = string_strndup (ptr_tag, length);
+                        tags_array[i] = string_split_shared (tag, "+", NULL,
+                                                             0, 0, NULL);
+                        free (tag);
+                    }
                 }
                 tags_array[tags_count] = NULL;
             }
         }
-        string_free_split (tags_array_temp);
     }
 
     if (num_tags)
@@ -4558,12 +5849,22 @@ const char *
 string_shared_get (const char *string)
 {
     struct t_hashtable_item *ptr_item;
+    const char *shared_string;
     char *key;
     int length;
 
     if (!string)
         return NULL;
 
+    length = sizeof (string_shared_count_t) + strlen (string) + 1;
+    key = malloc (length);
+    if (!key)
+        return NULL;
+    *((string_shared_count_t *)key) = 1;
+    strcpy (key + sizeof (string_shared_count_t), string);
+
+    pthread_mutex_lock (&string_shared_mutex);
+
     if (!string_hashtable_shared)
     {
         /*
@@ -4576,18 +5877,15 @@ string_shared_get (const char *string)
                                                  &string_shared_hash_key,
                                                  &string_shared_keycmp);
         if (!string_hashtable_shared)
+        {
+            pthread_mutex_unlock (&string_shared_mutex);
+            free (key);
             return NULL;
+        }
 
         string_hashtable_shared->callback_free_key = &string_shared_free_key;
     }
 
-    length = sizeof (string_shared_count_t) + strlen (string) + 1;
-    key = malloc (length);
-    if (!key)
-        return NULL;
-    *((string_shared_count_t *)key) = 1;
-    strcpy (key + sizeof (string_shared_count_t), string);
-
     ptr_item = hashtable_get_item (string_hashtable_shared, key, NULL);
     if (ptr_item)
     {
@@ -4606,8 +5904,12 @@ string_shared_get (const char *string)
             free (key);
     }
 
-    return (ptr_item) ?
+    shared_string = (ptr_item) ?
         ((const char *)ptr_item->key) + sizeof (string_shared_count_t) : NULL;
+
+    pthread_mutex_unlock (&string_shared_mutex);
+
+    return shared_string;
 }
 
 /*
@@ -4628,10 +5930,14 @@ string_shared_free (const char *string)
 
     ptr_count = (string_shared_count_t *)(string - sizeof (string_shared_count_t));
 
+    pthread_mutex_lock (&string_shared_mutex);
+
     (*ptr_count)--;
 
     if (*ptr_count == 0)
         hashtable_remove (string_hashtable_shared, ptr_count);
+
+    pthread_mutex_unlock (&string_shared_mutex);
 }
 
 /*
@@ -4848,30 +6154,86 @@ string_dyn_free (char **string, int free_string)
     return ptr_string;
 }
 
+/*
+ * Frees buffers used by string_concat in a thread (other than main thread).
+ */
+
+void
+string_concat_free (void *concat)
+{
+    int i;
+
+    for (i = 0; i < STRING_NUM_CONCAT_BUFFERS; i++)
+    {
+        if (((struct t_string_concat *)concat)->buffer[i])
+            string_dyn_free (((struct t_string_concat *)concat)->buffer[i], 1);
+    }
+    free (concat);
+}
+
+/*
+ * Returns buffers used by string_concat in current thread: the main thread
+ * uses global buffers, other threads have their own buffers.
+ *
+ * Returns NULL if error.
+ */
+
+struct t_string_concat *
+string_concat_get ()
+{
+    struct t_string_concat *concat;
+
+    if (!string_concat_key_ok || thread_is_main ())
+        return &string_concat_main;
+
+    concat = pthread_getspecific (string_concat_key);
+    if (!concat)
+    {
+        concat = calloc (1, sizeof (*concat));
+        if (!concat)
+            return NULL;
+        if (pthread_setspecific (string_concat_key, concat) != 0)
+        {
+            free (concat);
+            return NULL;
+        }
+    }
+
+    return concat;
+}
+
 /*
  * Concatenates strings, using a separator (which can be NULL or empty string
  * to not use any separator).
  *
  * Last argument must be NULL to terminate the variable list of arguments.
+ *
+ * The string returned is valid until 8 other calls to this function are made
+ * in the same thread (each thread has its own buffers).
  */
 
 const char *
 string_concat (const char *separator, ...)
 {
+    struct t_string_concat *concat;
     va_list args;
     const char *str;
     int index;
 
-    string_concat_index = (string_concat_index + 1) % 8;
+    concat = string_concat_get ();
+    if (!concat)
+        return NULL;
+
+    concat->index = (concat->index + 1) % STRING_NUM_CONCAT_BUFFERS;
 
-    if (string_concat_buffer[string_concat_index])
+    if (concat->buffer[concat->index])
     {
-        string_dyn_copy (string_concat_buffer[string_concat_index], NULL);
+        string_dyn_copy (concat->buffer[concat->index], NULL);
     }
     else
     {
-        string_concat_buffer[string_concat_index] = string_dyn_alloc (128);
-        if (!string_concat_buffer[string_concat_index])
+        concat->buffer[concat->index] = string_dyn_alloc (128);
+        if (!concat->buffer[concat->index])
             return NULL;
     }
 
@@ -4884,15 +6246,15 @@ string_concat (const char *separator, ...)
             break;
         if ((index > 0) && separator && separator[0])
         {
-            string_dyn_concat (string_concat_buffer[string_concat_index],
+            string_dyn_concat (concat->buffer[concat->index],
                                separator, -1);
         }
-        string_dyn_concat (string_concat_buffer[string_concat_index], str, -1);
+        string_dyn_concat (concat->buffer[concat->index], str, -1);
         index++;
     }
     va_end (args);
 
-    return (const char *)(*string_concat_buffer[string_concat_index]);
+    return (const char *)(*concat->buffer[concat->index]);
 }
 
 /*
@@ -4904,10 +6266,19 @@ string_init ()
 {
     int i;
 
+    string_concat_main.index = 0;
     for (i = 0; i < STRING_NUM_CONCAT_BUFFERS; i++)
     {
-        string_concat_buffer[i] = NULL;
+        string_concat_main.buffer[i] = NULL;
     }
+    string_concat_key_ok = (pthread_key_create (&string_concat_key,
+                                                &string_concat_free) == 0);
+
+#ifdef HAVE_PCRE2
+    string_regex_match_data_key_ok = (pthread_key_create (
+                                          &string_regex_match_data_key,
+                                          &string_regex_jit_free_match_data) == 0);
+#endif /* HAVE_PCRE2 */
 }
 
 /*
@@ -4918,18 +6289,41 @@ void
 string_end ()
 {
     int i;
+#ifdef HAVE_PCRE2
+    void *match_data;
+#endif
 
     if (string_hashtable_shared)
     {
         hashtable_free (string_hashtable_shared);
         string_hashtable_shared = NULL;
     }
+#ifdef HAVE_PCRE2
+    if (string_hashtable_regex_jit)
+    {
+        hashtable_free (string_hashtable_regex_jit);
+        string_hashtable_regex_jit = NULL;
+    }
+    if (string_regex_match_data_key_ok)
+    {
+        match_data = pthread_getspecific (string_regex_match_data_key);
+        if (match_data)
+            string_regex_jit_free_match_data (match_data);
+        pthread_key_delete (string_regex_match_data_key);
+        string_regex_match_data_key_ok = 0;
+    }
+#endif /* HAVE_PCRE2 */
     for (i = 0; i < STRING_NUM_CONCAT_BUFFERS; i++)
     {
-        if (string_concat_buffer[i])
+        if (string_concat_main.buffer[i])
         {
-            string_dyn_free (string_concat_buffer[i], 1);
-            string_concat_buffer[i] = NULL;
+            string_dyn_free (string_concat_main.buffer[i], 1);
+            string_concat_main.buffer[i] = NULL;
         }
     }
+    if (string_concat_key_ok)
+    {
+        pthread_key_delete (string_concat_key);
+        string_concat_key_ok = 0;
+    }
 }
@@ -25,6 +25,11 @@
 #include <regex.h>
 
 #define STRING_NUM_CONCAT_BUFFERS 8
+
+/* flag "j" in regex: match with PCRE2 (JIT), if WeeChat is built with it */
+#define STRING_REGEX_JIT (1 << 16)
+/* max number of matches returned by a PCRE2 regex */
+#define STRING_REGEX_MAX_MATCHES 100
 #define STR_CONCAT(separator, argz...) string_concat (separator, ##argz, NULL)
 
 typedef uint32_t string_shared_count_t;
@@ -37,8 +42,103 @@ struct t_string_dyn
     string_dyn_size_t size;            /* size of string (including '\0')   */
 };
 
+/* buffers used by string_concat (one set of buffers per thread) */
+
+struct t_string_concat
+{
+    int index;                         /* index of last buffer used         */
+    char **buffer[STRING_NUM_CONCAT_BUFFERS]; /* dynamic strings            */
+};
+
+/* cursor to split a string without allocating memory */
+
+struct t_string_split_cursor
+{
+    const char *separators;            /* separators                        */
+    int flags;                         /* WEECHAT_STRING_SPLIT_xxx flags    */
+    int num_items_max;                 /* max items (0 = no limit)          */
+    int num_items;                     /* number of items returned          */
+    const char *ptr;                   /* current position in string        */
+                                       /* (NULL = no more items)            */
+    const char *end;                   /* end of string (after strip)       */
+    int empty_last;                    /* 1 if an empty item is returned    */
+                                       /* after the last one                */
+};
+
+/* mask compiled to match strings quickly (wildcards "*" parsed once) */
+
+struct t_string_mask_word
+{
+    char *word;                        /* word between wildcards            */
+    int size;                          /* size of word (in bytes)           */
+    int length;                        /* length of word (in UTF-8 chars)   */
+    int *chars;                        /* lower case chars of word (only    */
+                                       /* if case insensitive)              */
+};
+
+struct t_string_mask
+{
+    char *mask;                        /* mask (without "!" if negated)     */
+    int case_sensitive;                /* 1 if match is case sensitive      */
+    int negated;                       /* 1 for a negative mask ("!mask")   */
+    int wildcard_start;                /* 1 if mask starts with "*"         */
+    int wildcard_end;                  /* 1 if mask ends with "*"           */
+    int words_count;                   /* number of words                   */
+    struct t_string_mask_word *words;  /* words: first one is the literal   */
+                                       /* prefix if wildcard_start == 0,    */
+                                       /* last one is the literal suffix    */
+                                       /* if wildcard_end == 0              */
+};
+
+/* highlight words compiled in an Aho-Corasick automaton */
+
+struct t_string_highlight_word
+{
+    int length;                        /* length of word (number of chars)  */
+    int wildcard_start;                /* 1 if word starts with "*"         */
+    int wildcard_end;                  /* 1 if word ends with "*"           */
+    int next_word;                     /* next word ending in same state    */
+};
+
+struct t_string_highlight_edge
+{
+    int wchar;                         /* char (lower case if insensitive)  */
+    int state;                         /* next state                        */
+};
+
+struct t_string_highlight_state
+{
+    struct t_string_highlight_edge *edges; /* transitions (sorted by char)  */
+    int edges_count;                   /* number of transitions             */
+    int fail;                          /* state of longest proper suffix    */
+    int output;                        /* nearest state with words in the   */
+                                       /* fail chain (-1 if none)           */
+    int word;                          /* first word ending in this state   */
+                                       /* (-1 if none)                      */
+};
+
+struct t_string_highlight_automaton
+{
+    struct t_string_highlight_state *states; /* states (0 is the root)      */
+    int states_count;                  /* number of states                  */
+    int states_alloc;                  /* number of allocated states        */
+};
+
+struct t_string_highlight
+{
+    char *highlight_words;             /* words used to build automatons    */
+    struct t_string_highlight_word *words; /* words found in the string     */
+    int words_count;                   /* number of words                   */
+    struct t_string_highlight_automaton automaton[2]; /* automaton for case */
+                                       /* insensitive (0), sensitive (1)    */
+};
+
 struct t_hashtable;
 
+#ifdef HAVE_PCRE2
+extern struct t_hashtable *string_hashtable_regex_jit;
+#endif
+
 extern int string_asprintf (char **result, const char *fmt, ...);
 extern char *string_strndup (const char *string, int bytes);
 extern char *string_cut (const char *string, int length, int count_suffix,
@@ -72,6 +172,16 @@ extern int string_match (const char *string, const char *mask,
                          int case_sensitive);
 extern int string_match_list (const char *string, const char **masks,
                               int case_sensitive);
+extern struct t_string_mask *string_mask_compile (const char *mask,
+                                                  int case_sensitive);
+extern int string_match_compiled (const char *string,
+                                  struct t_string_mask *mask);
+extern void string_mask_free (struct t_string_mask *mask);
+extern struct t_string_mask **string_mask_compile_list (const char **masks,
+                                                        int case_sensitive);
+extern int string_match_list_compiled (const char *string,
+                                       struct t_string_mask **masks);
+extern void string_mask_free_list (struct t_string_mask **masks);
 extern char *string_replace (const char *string, const char *search,
                              const char *replace);
 extern char *string_expand_home (const char *path);
@@ -90,6 +200,13 @@ extern char *string_mask_to_regex (const char *mask);
 extern const char *string_regex_flags (const char *regex, int default_flags,
                                        int *flags);
 extern int string_regcomp (void *preg, const char *regex, int default_flags);
+extern int string_regexec (void *preg, const char *string, size_t nmatch,
+                           void *pmatch, int eflags);
+extern void string_regfree (void *preg);
+extern struct t_string_highlight *string_highlight_compile (const char *highlight_words);
+extern int string_highlight_match (struct t_string_highlight *highlight,
+                                   const char *string);
+extern void string_highlight_free (struct t_string_highlight *highlight);
 extern int string_has_highlight (const char *string,
                                  const char *highlight_words);
 extern int string_has_highlight_regex_compiled (const char *string,
@@ -108,6 +225,14 @@ extern char **string_split (const char *string, const char *separators,
 extern char **string_split_shared (const char *string, const char *separators,
                                    const char *strip_items, int flags,
                                    int num_items_max, int *num_items);
+extern void string_split_cursor_init (struct t_string_split_cursor *cursor,
+                                      const char *string,
+                                      const char *separators,
+                                      int flags, int num_items_max);
+extern int string_split_cursor_next (struct t_string_split_cursor *cursor,
+                                     const char **item, int *length);
+extern int string_split_count (const char *string, const char *separators,
+                               int flags, int num_items_max);
 extern char **string_split_shell (const char *string, int *num_items);
 extern void string_free_split (char **split_string);
 extern void string_free_split_shared (char **split_string);
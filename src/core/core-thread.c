@@ -0,0 +1,354 @@
+/*
+ * core-thread.c - post callbacks from any thread to the main thread
+ *
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#ifdef HAVE_EVENTFD
+#include <sys/eventfd.h>
+#endif
+
+#include "weechat.h"
+#include "core-thread.h"
+#include "core-hook.h"
+#include "core-log.h"
+#include "../plugins/plugin.h"
+
+
+pthread_t thread_main;                 /* main thread (running main loop)   */
+
+/* posts pushed by threads (last post first), shared by all threads */
+struct t_thread_post *thread_posts = NULL;
+
+/* posts taken from the queue and not yet run (only used by main thread) */
+struct t_thread_post *thread_posts_pending = NULL;
+struct t_thread_post *last_thread_post_pending = NULL;
+
+int thread_post_fd[2] = { -1, -1 };    /* fd to wake up main loop (read,    */
+                                       /* write), same fd for eventfd       */
+struct t_hook *thread_post_hook_fd = NULL; /* fd hook on thread_post_fd[0]  */
+
+
+/*
+ * Checks if the current thread is the main thread.
+ *
+ * Returns:
+ *   1: current thread is the main thread
+ *   0: current thread is another thread
+ */
+
+int
+thread_is_main ()
+{
+    return (pthread_equal (pthread_self (), thread_main)) ? 1 : 0;
+}
+
+/*
+ * Wakes up the main loop: the fd hook on thread_post_fd[0] is triggered.
+ *
+ * This function is async-signal-safe and can be called by any thread.
+ */
+
+void
+thread_post_wakeup ()
+{
+#ifdef HAVE_EVENTFD
+    uint64_t value;
+
+    value = 1;
+    (void) write (thread_post_fd[1], &value, sizeof (value));
+#else
+    /* if the pipe is full, the main loop has already been woken up */
+    (void) write (thread_post_fd[1], "1", 1);
+#endif
+}
+
+/*
+ * Posts a callback, that will be called in the main thread (on next iteration
+ * of main loop), with "callback_pointer" and "callback_data" as arguments.
+ *
+ * This function can be called by any thread (including the main thread);
+ * callbacks are called in the order of posts.
+ *
+ * If the plugin is unloaded before the callback is called, the callback is
+ * not called (and data is not freed).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+thread_post (struct t_weechat_plugin *plugin,
+             t_thread_post_cb *callback,
+             const void *callback_pointer,
+             void *callback_data)
+{
+    struct t_thread_post *new_post;
+
+    if (!callback || (thread_post_fd[1] < 0))
+        return 0;
+
+    new_post = malloc (sizeof (*new_post));
+    if (!new_post)
+        return 0;
+
+    new_post->plugin = plugin;
+    new_post->callback = callback;
+    new_post->callback_pointer = callback_pointer;
+    new_post->callback_data = callback_data;
+
+    /* lock-free push at head of queue */
+    new_post->next_post = __atomic_load_n (&thread_posts, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n (&thread_posts,
+                                         &new_post->next_post, new_post,
+                                         1, __ATOMIC_RELEASE,
+                                         __ATOMIC_RELAXED))
+    {
+    }
+
+    /* the main loop is woken up only once until it takes the posts */
+    if (!new_post->next_post)
+        thread_post_wakeup ();
+
+    return 1;
+}
+
+/*
+ * Takes all posts in queue and adds them at the end of pending posts, in the
+ * order of posts.
+ *
+ * This function must be called only by the main thread.
+ */
+
+void
+thread_post_take_all ()
+{
+    struct t_thread_post *ptr_post, *next_post, *posts;
+    char buffer[64];
+
+    /* clear the fd before taking posts, so that new posts wake up again */
+    while (read (thread_post_fd[0], buffer, sizeof (buffer)) > 0)
+    {
+    }
+
+    ptr_post = __atomic_exchange_n (&thread_posts, NULL, __ATOMIC_ACQUIRE);
+
+    /* reverse the list: posts are pushed at head of queue */
+    posts = NULL;
+    while (ptr_post)
+    {
+        next_post = ptr_post->next_post;
+        ptr_post->next_post = posts;
+        posts = ptr_post;
+        ptr_post = next_post;
+    }
+    if (!posts)
+        return;
+
+    if (last_thread_post_pending)
+        last_thread_post_pending->next_post = posts;
+    else
+        thread_posts_pending = posts;
+    for (ptr_post = posts; ptr_post->next_post;
+         ptr_post = ptr_post->next_post)
+    {
+    }
+    last_thread_post_pending = ptr_post;
+}
+
+/*
+ * Runs callbacks of all posts.
+ *
+ * This function must be called only by the main thread.
+ *
+ * Returns the number of callbacks called.
+ */
+
+int
+thread_post_run ()
+{
+    struct t_thread_post *ptr_post;
+    int count;
+
+    if (thread_post_fd[0] < 0)
+        return 0;
+
+    thread_post_take_all ();
+
+    count = 0;
+    while (thread_posts_pending)
+    {
+        /* the post is removed first: callback can post or unload plugins */
+        ptr_post = thread_posts_pending;
+        thread_posts_pending = ptr_post->next_post;
+        if (!thread_posts_pending)
+            last_thread_post_pending = NULL;
+        (ptr_post->callback) (ptr_post->callback_pointer,
+                              ptr_post->callback_data);
+        free (ptr_post);
+        count++;
+    }
+
+    return count;
+}
+
+/*
+ * Callback for fd hook: runs callbacks of posts.
+ */
+
+int
+thread_post_fd_cb (const void *pointer, void *data, int fd)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) fd;
+
+    thread_post_run ();
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Removes all posts of a plugin (called when the plugin is unloaded):
+ * callbacks of these posts are not called.
+ *
+ * This function must be called only by the main thread.
+ */
+
+void
+thread_post_remove_plugin (struct t_weechat_plugin *plugin)
+{
+    struct t_thread_post *ptr_post, *next_post, *prev_post;
+
+    if (!plugin || (thread_post_fd[0] < 0))
+        return;
+
+    thread_post_take_all ();
+
+    prev_post = NULL;
+    ptr_post = thread_posts_pending;
+    while (ptr_post)
+    {
+        next_post = ptr_post->next_post;
+        if (ptr_post->plugin == plugin)
+        {
+            if (prev_post)
+                prev_post->next_post = next_post;
+            else
+                thread_posts_pending = next_post;
+            if (last_thread_post_pending == ptr_post)
+                last_thread_post_pending = prev_post;
+            free (ptr_post);
+        }
+        else
+        {
+            prev_post = ptr_post;
+        }
+        ptr_post = next_post;
+    }
+
+    /* other posts taken from queue are run on next main loop iteration */
+    if (thread_posts_pending)
+        thread_post_wakeup ();
+}
+
+/*
+ * Initializes threads: saves the main thread and creates the fd used to wake
+ * up the main loop.
+ */
+
+void
+thread_init ()
+{
+    thread_main = pthread_self ();
+
+#ifdef HAVE_EVENTFD
+    thread_post_fd[0] = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+    thread_post_fd[1] = thread_post_fd[0];
+    if (thread_post_fd[0] < 0)
+    {
+        thread_post_fd[1] = -1;
+        log_printf ("Error: unable to create eventfd for thread posts");
+        return;
+    }
+#else
+    if (pipe (thread_post_fd) < 0)
+    {
+        thread_post_fd[0] = -1;
+        thread_post_fd[1] = -1;
+        log_printf ("Error: unable to create pipe for thread posts");
+        return;
+    }
+    fcntl (thread_post_fd[0], F_SETFL, O_NONBLOCK);
+    fcntl (thread_post_fd[1], F_SETFL, O_NONBLOCK);
+    fcntl (thread_post_fd[0], F_SETFD, FD_CLOEXEC);
+    fcntl (thread_post_fd[1], F_SETFD, FD_CLOEXEC);
+#endif
+
+    thread_post_hook_fd = hook_fd (NULL, thread_post_fd[0], 1, 0, 0,
+                                   &thread_post_fd_cb, NULL, NULL);
+}
+
+/*
+ * Ends threads: frees posts not run and closes the fd used to wake up the
+ * main loop.
+ *
+ * Threads must not post callbacks any more when this function is called.
+ */
+
+void
+thread_end ()
+{
+    struct t_thread_post *ptr_post;
+
+    if (thread_post_fd[0] < 0)
+        return;
+
+    thread_post_take_all ();
+    while (thread_posts_pending)
+    {
+        ptr_post = thread_posts_pending;
+        thread_posts_pending = ptr_post->next_post;
+        free (ptr_post);
+    }
+    last_thread_post_pending = NULL;
+
+    if (thread_post_hook_fd)
+    {
+        unhook (thread_post_hook_fd);
+        thread_post_hook_fd = NULL;
+    }
+
+    close (thread_post_fd[0]);
+    if (thread_post_fd[1] != thread_post_fd[0])
+        close (thread_post_fd[1]);
+    thread_post_fd[0] = -1;
+    thread_post_fd[1] = -1;
+}
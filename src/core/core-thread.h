@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef WEECHAT_THREAD_H
+#define WEECHAT_THREAD_H
+
+/*
+ * any thread can post a callback to the main thread: posts are pushed in a
+ * lock-free queue (multiple producers, single consumer) and the main loop is
+ * woken up by a fd (eventfd or pipe) watched by a fd hook; callbacks are
+ * then called in the main thread, in the order of posts
+ */
+
+struct t_weechat_plugin;
+
+typedef void (t_thread_post_cb)(const void *pointer, void *data);
+
+struct t_thread_post
+{
+    struct t_weechat_plugin *plugin;   /* plugin (NULL for core)            */
+    t_thread_post_cb *callback;        /* callback called in main thread    */
+    const void *callback_pointer;      /* pointer sent to callback          */
+    void *callback_data;               /* data sent to callback             */
+    struct t_thread_post *next_post;   /* link to next post                 */
+};
+
+extern int thread_is_main ();
+extern int thread_post (struct t_weechat_plugin *plugin,
+                        t_thread_post_cb *callback,
+                        const void *callback_pointer,
+                        void *callback_data);
+extern int thread_post_run ();
+extern void thread_post_remove_plugin (struct t_weechat_plugin *plugin);
+extern void thread_init ();
+extern void thread_end ();
+
+#endif /* WEECHAT_THREAD_H */
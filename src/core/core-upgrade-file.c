@@ -28,12 +28,22 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <string.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <pthread.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
 
 #include "weechat.h"
 #include "core-upgrade-file.h"
+#include "core-dir.h"
 #include "core-infolist.h"
+#include "core-log.h"
 #include "core-string.h"
 #include "core-utf8.h"
 #include "../gui/gui-chat.h"
@@ -44,6 +54,12 @@
 struct t_upgrade_file *upgrade_files = NULL;
 struct t_upgrade_file *last_upgrade_file = NULL;
 
+/* files being written on disk (by threads) */
+struct t_upgrade_file_io *upgrade_file_writers = NULL;
+
+/* files mapped in memory (before they are read by core and plugins) */
+struct t_upgrade_file_io *upgrade_file_readers = NULL;
+
 
 /*
  * Displays an error with upgrade.
@@ -175,6 +191,275 @@ upgrade_file_write_buffer (struct t_upgrade_file *upgrade_file, void *pointer,
     return 1;
 }
 
+/*
+ * Frees an upgrade file I/O.
+ */
+
+void
+upgrade_file_io_free (struct t_upgrade_file_io *io)
+{
+    if (!io)
+        return;
+
+    free (io->filename);
+    free (io->data);
+    free (io);
+}
+
+/*
+ * Thread writing content of an upgrade file on disk.
+ */
+
+void *
+upgrade_file_writer_thread_cb (void *arg)
+{
+    struct t_upgrade_file_io *io;
+    ssize_t num_written;
+    size_t pos;
+    int fd;
+
+    io = (struct t_upgrade_file_io *)arg;
+
+    io->rc = 0;
+
+    fd = open (io->filename, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0)
+        return NULL;
+
+    pos = 0;
+    while (pos < io->size)
+    {
+        num_written = write (fd, io->data + pos, io->size - pos);
+        if (num_written <= 0)
+        {
+            close (fd);
+            return NULL;
+        }
+        pos += num_written;
+    }
+
+    if (close (fd) == 0)
+        io->rc = 1;
+
+    return NULL;
+}
+
+/*
+ * Maps an upgrade file in memory (read-only), and tells the kernel to read
+ * it in background.
+ *
+ * Returns pointer to the mapped file (size is set in *size), NULL if error.
+ *
+ * Note: result must be unmapped with munmap() after use.
+ */
+
+char *
+upgrade_file_map (const char *filename, size_t *size)
+{
+    struct stat st;
+    void *data;
+    int fd;
+
+    *size = 0;
+
+    fd = open (filename, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    if ((fstat (fd, &st) != 0) || (st.st_size <= 0))
+    {
+        close (fd);
+        return NULL;
+    }
+
+    data = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close (fd);
+    if (data == MAP_FAILED)
+        return NULL;
+
+    (void) posix_madvise (data, st.st_size, POSIX_MADV_WILLNEED);
+
+    *size = st.st_size;
+
+    return (char *)data;
+}
+
+/*
+ * Starts a thread for an upgrade file I/O.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (thread not created)
+ */
+
+int
+upgrade_file_io_start_thread (struct t_upgrade_file_io *io,
+                              void *(*thread_cb)(void *arg))
+{
+    sigset_t set, old_set;
+    int rc;
+
+    /* signals are handled by the main thread only */
+    sigfillset (&set);
+    pthread_sigmask (SIG_SETMASK, &set, &old_set);
+    rc = pthread_create (&io->thread, NULL, thread_cb, io);
+    pthread_sigmask (SIG_SETMASK, &old_set, NULL);
+
+    return (rc == 0) ? 1 : 0;
+}
+
+/*
+ * Waits for end of all threads writing upgrade files on disk.
+ *
+ * Returns:
+ *   1: OK (all files written)
+ *   0: error (at least one file was not written)
+ */
+
+int
+upgrade_file_wait_writers ()
+{
+    struct t_upgrade_file_io *ptr_io, *ptr_next_io;
+    int rc;
+
+    rc = 1;
+
+    ptr_io = upgrade_file_writers;
+    while (ptr_io)
+    {
+        ptr_next_io = ptr_io->next_io;
+        pthread_join (ptr_io->thread, NULL);
+        if (!ptr_io->rc)
+        {
+            log_printf (_("Error writing upgrade file \"%s\""),
+                        ptr_io->filename);
+            rc = 0;
+        }
+        upgrade_file_io_free (ptr_io);
+        ptr_io = ptr_next_io;
+    }
+    upgrade_file_writers = NULL;
+
+    return rc;
+}
+
+/*
+ * Maps an upgrade file in memory (callback called for each file in WeeChat
+ * data directory).
+ */
+
+void
+upgrade_file_prefetch_cb (void *data, const char *filename)
+{
+    struct t_upgrade_file_io *new_io;
+
+    /* make C compiler happy */
+    (void) data;
+
+    if (!string_match (filename, "*.upgrade", 1))
+        return;
+
+    new_io = malloc (sizeof (*new_io));
+    if (!new_io)
+        return;
+    new_io->filename = strdup (filename);
+    new_io->data = upgrade_file_map (filename, &new_io->size);
+    new_io->rc = (new_io->data) ? 1 : 0;
+    new_io->next_io = upgrade_file_readers;
+    if (!new_io->filename || !new_io->data)
+    {
+        if (new_io->data)
+            munmap (new_io->data, new_io->size);
+        new_io->data = NULL;
+        upgrade_file_io_free (new_io);
+        return;
+    }
+    upgrade_file_readers = new_io;
+}
+
+/*
+ * Maps all upgrade files of a directory in memory, so that the kernel reads
+ * all of them in background, in parallel.
+ *
+ * The files are then parsed in place when they are opened with function
+ * upgrade_file_new (by core and plugins).
+ */
+
+void
+upgrade_file_prefetch (const char *directory)
+{
+#ifdef HAVE_FMEMOPEN
+    if (!directory)
+        return;
+
+    dir_exec_on_files (directory, 0, 0, &upgrade_file_prefetch_cb, NULL);
+#else
+    /* make C compiler happy */
+    (void) directory;
+#endif
+}
+
+/*
+ * Gets a prefetched upgrade file.
+ *
+ * Returns pointer to the mapped file (size is set in *size), NULL if the
+ * file was not prefetched.
+ *
+ * Note: result must be unmapped with munmap() after use.
+ */
+
+char *
+upgrade_file_prefetch_get (const char *filename, size_t *size)
+{
+    struct t_upgrade_file_io *ptr_io, *ptr_prev_io;
+    char *data;
+
+    *size = 0;
+
+    ptr_prev_io = NULL;
+    for (ptr_io = upgrade_file_readers; ptr_io; ptr_io = ptr_io->next_io)
+    {
+        if (strcmp (ptr_io->filename, filename) == 0)
+            break;
+        ptr_prev_io = ptr_io;
+    }
+    if (!ptr_io)
+        return NULL;
+
+    /* remove file from list */
+    if (ptr_prev_io)
+        ptr_prev_io->next_io = ptr_io->next_io;
+    else
+        upgrade_file_readers = ptr_io->next_io;
+
+    data = ptr_io->data;
+    *size = ptr_io->size;
+    ptr_io->data = NULL;
+
+    upgrade_file_io_free (ptr_io);
+
+    return data;
+}
+
+/*
+ * Frees all prefetched upgrade files (not read by core or plugins).
+ */
+
+void
+upgrade_file_prefetch_free ()
+{
+    struct t_upgrade_file_io *ptr_next_io;
+
+    while (upgrade_file_readers)
+    {
+        ptr_next_io = upgrade_file_readers->next_io;
+        munmap (upgrade_file_readers->data, upgrade_file_readers->size);
+        upgrade_file_readers->data = NULL;
+        upgrade_file_io_free (upgrade_file_readers);
+        upgrade_file_readers = ptr_next_io;
+    }
+}
+
 /*
  * Creates an upgrade file.
  *
@@ -215,24 +500,88 @@ upgrade_file_new (const char *filename,
         new_upgrade_file->callback_read = callback_read;
         new_upgrade_file->callback_read_pointer = callback_read_pointer;
         new_upgrade_file->callback_read_data = callback_read_data;
-
-        /* open file in read or write mode */
+        new_upgrade_file->file = NULL;
+        new_upgrade_file->memory_data = NULL;
+        new_upgrade_file->memory_size = 0;
+        new_upgrade_file->memory_write = 0;
+        new_upgrade_file->memory_mapped = 0;
+
+        /*
+         * open file in read or write mode: in memory if possible (file
+         * mapped in memory for read, and written on disk by a thread on
+         * close)
+         */
         if (callback_read)
-            new_upgrade_file->file = fopen (new_upgrade_file->filename, "rb");
+        {
+#ifdef HAVE_FMEMOPEN
+            new_upgrade_file->memory_data = upgrade_file_prefetch_get (
+                new_upgrade_file->filename,
+                &new_upgrade_file->memory_size);
+            if (!new_upgrade_file->memory_data)
+            {
+                new_upgrade_file->memory_data = upgrade_file_map (
+                    new_upgrade_file->filename,
+                    &new_upgrade_file->memory_size);
+            }
+            if (new_upgrade_file->memory_data)
+            {
+                new_upgrade_file->memory_mapped = 1;
+                new_upgrade_file->file = fmemopen (
+                    new_upgrade_file->memory_data,
+                    new_upgrade_file->memory_size,
+                    "rb");
+                if (!new_upgrade_file->file)
+                {
+                    munmap (new_upgrade_file->memory_data,
+                            new_upgrade_file->memory_size);
+                    new_upgrade_file->memory_data = NULL;
+                    new_upgrade_file->memory_size = 0;
+                    new_upgrade_file->memory_mapped = 0;
+                }
+            }
+#endif
+            if (!new_upgrade_file->file)
+            {
+                new_upgrade_file->file = fopen (new_upgrade_file->filename,
+                                                "rb");
+            }
+        }
         else
-            new_upgrade_file->file = fopen (new_upgrade_file->filename, "wb");
+        {
+#ifdef HAVE_OPEN_MEMSTREAM
+            new_upgrade_file->file = open_memstream (
+                &new_upgrade_file->memory_data,
+                &new_upgrade_file->memory_size);
+            if (new_upgrade_file->file)
+                new_upgrade_file->memory_write = 1;
+#endif
+            if (!new_upgrade_file->file)
+            {
+                new_upgrade_file->file = fopen (new_upgrade_file->filename,
+                                                "wb");
+            }
+        }
 
         if (!new_upgrade_file->file)
         {
+            free (new_upgrade_file->memory_data);
             free (new_upgrade_file->filename);
             free (new_upgrade_file);
             return NULL;
         }
 
+        if (!new_upgrade_file->memory_data && !new_upgrade_file->memory_write)
+        {
+            /* use a large buffer: upgrade files can be very big */
+            setvbuf (new_upgrade_file->file, NULL, _IOFBF,
+                     UPGRADE_FILE_BUFFER_SIZE);
+        }
+
         /* change permissions if write mode */
         if (!callback_read)
         {
-            chmod (new_upgrade_file->filename, 0600);
+            if (!new_upgrade_file->memory_write)
+                chmod (new_upgrade_file->filename, 0600);
 
             /* write signature */
             upgrade_file_write_string (new_upgrade_file, UPGRADE_SIGNATURE);
@@ -414,6 +763,292 @@ upgrade_file_write_object (struct t_upgrade_file *upgrade_file, int object_id,
     return 1;
 }
 
+/*
+ * Creates a new block (to write in upgrade file).
+ *
+ * Returns pointer to new block, NULL if error.
+ */
+
+struct t_upgrade_block *
+upgrade_file_block_new ()
+{
+    struct t_upgrade_block *new_block;
+
+    new_block = malloc (sizeof (*new_block));
+    if (!new_block)
+        return NULL;
+
+    new_block->data = NULL;
+    new_block->size = 0;
+    new_block->size_alloc = 0;
+    new_block->read_pos = 0;
+
+    return new_block;
+}
+
+/*
+ * Adds data at the end of a block.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+upgrade_file_block_add (struct t_upgrade_block *block,
+                        const void *data, int size)
+{
+    char *new_data;
+    int new_size_alloc;
+
+    if (!block || !data || (size < 0))
+        return 0;
+
+    if (size == 0)
+        return 1;
+
+    if (block->size + size > block->size_alloc)
+    {
+        new_size_alloc = (block->size_alloc < 4096) ?
+            4096 : block->size_alloc + (block->size_alloc / 2);
+        if (new_size_alloc < block->size + size)
+            new_size_alloc = block->size + size;
+        new_data = realloc (block->data, new_size_alloc);
+        if (!new_data)
+            return 0;
+        block->data = new_data;
+        block->size_alloc = new_size_alloc;
+    }
+
+    memcpy (block->data + block->size, data, size);
+    block->size += size;
+
+    return 1;
+}
+
+/*
+ * Adds an integer at the end of a block.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+upgrade_file_block_add_integer (struct t_upgrade_block *block, int value)
+{
+    return upgrade_file_block_add (block, &value, sizeof (value));
+}
+
+/*
+ * Adds a time at the end of a block.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+upgrade_file_block_add_time (struct t_upgrade_block *block, time_t date)
+{
+    return upgrade_file_block_add (block, &date, sizeof (date));
+}
+
+/*
+ * Adds a string at the end of a block: length (-1 for NULL), then the
+ * string with its final '\0' (so that the string can be used directly in
+ * the block when it is read).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+upgrade_file_block_add_string (struct t_upgrade_block *block,
+                               const char *string)
+{
+    int length;
+
+    if (!string)
+        return upgrade_file_block_add_integer (block, -1);
+
+    length = strlen (string);
+    if (!upgrade_file_block_add_integer (block, length))
+        return 0;
+
+    return upgrade_file_block_add (block, string, length + 1);
+}
+
+/*
+ * Gets data from a block (at current read position).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (not enough data in block)
+ */
+
+int
+upgrade_file_block_get (struct t_upgrade_block *block, void *data, int size)
+{
+    if (!block || (size < 0) || (block->read_pos + size > block->size))
+        return 0;
+
+    if (data)
+        memcpy (data, block->data + block->read_pos, size);
+    block->read_pos += size;
+
+    return 1;
+}
+
+/*
+ * Gets an integer from a block (at current read position).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+upgrade_file_block_get_integer (struct t_upgrade_block *block, int *value)
+{
+    return upgrade_file_block_get (block, value, sizeof (*value));
+}
+
+/*
+ * Gets a time from a block (at current read position).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+upgrade_file_block_get_time (struct t_upgrade_block *block, time_t *date)
+{
+    return upgrade_file_block_get (block, date, sizeof (*date));
+}
+
+/*
+ * Gets a string from a block (at current read position).
+ *
+ * Returns pointer to string in block data (must not be freed), NULL if the
+ * string is NULL or in case of error.
+ */
+
+const char *
+upgrade_file_block_get_string (struct t_upgrade_block *block)
+{
+    const char *ptr_string;
+    int length;
+
+    if (!upgrade_file_block_get_integer (block, &length) || (length < 0))
+        return NULL;
+
+    if (block->read_pos + length + 1 > block->size)
+    {
+        block->read_pos = block->size;
+        return NULL;
+    }
+
+    ptr_string = block->data + block->read_pos;
+    if (ptr_string[length] != '\0')
+    {
+        block->read_pos = block->size;
+        return NULL;
+    }
+    block->read_pos += length + 1;
+
+    return ptr_string;
+}
+
+/*
+ * Frees a block.
+ */
+
+void
+upgrade_file_block_free (struct t_upgrade_block *block)
+{
+    if (!block)
+        return;
+
+    free (block->data);
+    free (block);
+}
+
+/*
+ * Writes a block in upgrade file (compressed with zstd if available).
+ *
+ * Format: object type, object id, compression, size of data, size of data
+ * written (compressed or not), data.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+upgrade_file_write_block (struct t_upgrade_file *upgrade_file, int object_id,
+                          struct t_upgrade_block *block)
+{
+    const void *ptr_data;
+    int compression, size_data;
+#ifdef HAVE_ZSTD
+    void *data_zstd;
+    size_t size_zstd;
+#endif
+
+    if (!upgrade_file || !block)
+        return 0;
+
+    compression = UPGRADE_BLOCK_COMPRESSION_NONE;
+    ptr_data = block->data;
+    size_data = block->size;
+
+#ifdef HAVE_ZSTD
+    data_zstd = NULL;
+    if (block->size > 0)
+    {
+        size_zstd = ZSTD_compressBound (block->size);
+        data_zstd = malloc (size_zstd);
+        if (data_zstd)
+        {
+            size_zstd = ZSTD_compress (data_zstd, size_zstd,
+                                       block->data, block->size,
+                                       UPGRADE_BLOCK_ZSTD_LEVEL);
+            if (!ZSTD_isError (size_zstd)
+                && ((int)size_zstd < block->size))
+            {
+                compression = UPGRADE_BLOCK_COMPRESSION_ZSTD;
+                ptr_data = data_zstd;
+                size_data = size_zstd;
+            }
+        }
+    }
+#endif
+
+    if (!upgrade_file_write_integer (upgrade_file, UPGRADE_TYPE_OBJECT_BLOCK)
+        || !upgrade_file_write_integer (upgrade_file, object_id)
+        || !upgrade_file_write_integer (upgrade_file, compression)
+        || !upgrade_file_write_integer (upgrade_file, block->size)
+        || !upgrade_file_write_integer (upgrade_file, size_data)
+        || ((size_data > 0)
+            && (fwrite (ptr_data, size_data, 1, upgrade_file->file) != 1)))
+    {
+        UPGRADE_ERROR(_("write - block"), "");
+#ifdef HAVE_ZSTD
+        free (data_zstd);
+#endif
+        return 0;
+    }
+
+#ifdef HAVE_ZSTD
+    free (data_zstd);
+#endif
+
+    return 1;
+}
+
 /*
  * Reads an integer in upgrade file.
  *
@@ -565,6 +1200,163 @@ upgrade_file_read_time (struct t_upgrade_file *upgrade_file, time_t *time)
     return 1;
 }
 
+/*
+ * Calls read callback for an object.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+upgrade_file_run_callback_read (struct t_upgrade_file *upgrade_file,
+                                int object_id, struct t_infolist *infolist)
+{
+    if (!upgrade_file->callback_read)
+        return 1;
+
+    return ((int)(upgrade_file->callback_read) (
+                upgrade_file->callback_read_pointer,
+                upgrade_file->callback_read_data,
+                upgrade_file,
+                object_id,
+                infolist) == WEECHAT_RC_ERROR) ? 0 : 1;
+}
+
+/*
+ * Reads a block in upgrade file (after the object type) and calls read
+ * callback with an infolist containing the block: pointer "block" and
+ * integer "block_size".
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+upgrade_file_read_block (struct t_upgrade_file *upgrade_file)
+{
+    struct t_infolist *infolist;
+    struct t_infolist_item *item;
+    int rc, object_id, compression, size, size_data;
+    const char *ptr_data;
+    void *data, *data_block;
+#ifdef HAVE_ZSTD
+    size_t size_zstd;
+#endif
+
+    rc = 0;
+    infolist = NULL;
+    ptr_data = NULL;
+    data = NULL;
+    data_block = NULL;
+
+    if (!upgrade_file_read_integer (upgrade_file, &object_id)
+        || !upgrade_file_read_integer (upgrade_file, &compression)
+        || !upgrade_file_read_integer (upgrade_file, &size)
+        || !upgrade_file_read_integer (upgrade_file, &size_data)
+        || (size < 0) || (size_data < 0))
+    {
+        UPGRADE_ERROR(_("read - block"), "");
+        goto end;
+    }
+
+    upgrade_file->last_read_pos = ftell (upgrade_file->file);
+    upgrade_file->last_read_length = size_data;
+
+    if ((size_data > 0) && upgrade_file->memory_mapped)
+    {
+        /* file mapped in memory: use block in place (no copy) */
+        if ((upgrade_file->last_read_pos < 0)
+            || ((size_t)upgrade_file->last_read_pos + size_data
+                > upgrade_file->memory_size)
+            || (fseek (upgrade_file->file, size_data, SEEK_CUR) < 0))
+        {
+            UPGRADE_ERROR(_("read - block"), "");
+            goto end;
+        }
+        ptr_data = upgrade_file->memory_data + upgrade_file->last_read_pos;
+    }
+    else if (size_data > 0)
+    {
+        data = malloc (size_data);
+        if (!data)
+        {
+            UPGRADE_ERROR(_("read - block"), "");
+            goto end;
+        }
+        if (fread (data, size_data, 1, upgrade_file->file) != 1)
+        {
+            UPGRADE_ERROR(_("read - block"), "");
+            goto end;
+        }
+        ptr_data = data;
+    }
+
+    switch (compression)
+    {
+        case UPGRADE_BLOCK_COMPRESSION_NONE:
+            if (size != size_data)
+            {
+                UPGRADE_ERROR(_("read - block"), "size");
+                goto end;
+            }
+            data_block = (void *)ptr_data;
+            break;
+        case UPGRADE_BLOCK_COMPRESSION_ZSTD:
+#ifdef HAVE_ZSTD
+            data_block = malloc ((size > 0) ? size : 1);
+            if (!data_block)
+            {
+                UPGRADE_ERROR(_("read - block"), "");
+                goto end;
+            }
+            size_zstd = ZSTD_decompress (data_block, size,
+                                         ptr_data, size_data);
+            if (ZSTD_isError (size_zstd) || ((int)size_zstd != size))
+            {
+                UPGRADE_ERROR(_("read - block"), "zstd");
+                goto end;
+            }
+#else
+            UPGRADE_ERROR(_("read - block"), "zstd not available");
+            goto end;
+#endif
+            break;
+        default:
+            UPGRADE_ERROR(_("read - block"), "compression");
+            goto end;
+    }
+
+    infolist = infolist_new (NULL);
+    if (!infolist)
+    {
+        UPGRADE_ERROR(_("read - infolist creation"), "");
+        goto end;
+    }
+    item = infolist_new_item (infolist);
+    if (!item)
+    {
+        UPGRADE_ERROR(_("read - infolist item creation"), "");
+        goto end;
+    }
+    if (data_block && (size > 0))
+    {
+        /* the block is not copied: it is valid only during the callback */
+        infolist_new_var_pointer (item, "block", data_block);
+        infolist_new_var_integer (item, "block_size", size);
+    }
+
+    rc = upgrade_file_run_callback_read (upgrade_file, object_id, infolist);
+
+end:
+    infolist_free (infolist);
+    if (data_block != ptr_data)
+        free (data_block);
+    free (data);
+    return rc;
+}
+
 /*
  * Reads an object in upgrade file and calls read callback.
  *
@@ -599,6 +1391,9 @@ upgrade_file_read_object (struct t_upgrade_file *upgrade_file)
         goto end;
     }
 
+    if (type == UPGRADE_TYPE_OBJECT_BLOCK)
+        return upgrade_file_read_block (upgrade_file);
+
     if (type != UPGRADE_TYPE_OBJECT_START)
     {
         UPGRADE_ERROR(_("read - bad object type ('object start' expected)"), "");
@@ -693,20 +1488,7 @@ upgrade_file_read_object (struct t_upgrade_file *upgrade_file)
         }
     }
 
-    rc = 1;
-
-    if (upgrade_file->callback_read)
-    {
-        if ((int)(upgrade_file->callback_read) (
-                upgrade_file->callback_read_pointer,
-                upgrade_file->callback_read_data,
-                upgrade_file,
-                object_id,
-                infolist) == WEECHAT_RC_ERROR)
-        {
-            rc = 0;
-        }
-    }
+    rc = upgrade_file_run_callback_read (upgrade_file, object_id, infolist);
 
 end:
     infolist_free (infolist);
@@ -739,7 +1521,10 @@ upgrade_file_read (struct t_upgrade_file *upgrade_file)
         return 0;
     }
 
-    if (!signature || (strcmp (signature, UPGRADE_SIGNATURE) != 0))
+    /* files with signature v2.2 can still be read (they have no blocks) */
+    if (!signature
+        || ((strcmp (signature, UPGRADE_SIGNATURE) != 0)
+            && (strcmp (signature, UPGRADE_SIGNATURE_V2_2) != 0)))
     {
         UPGRADE_ERROR(_("read - bad signature (upgrade file format may have "
                         "changed since last version)"), "");
@@ -765,12 +1550,56 @@ upgrade_file_read (struct t_upgrade_file *upgrade_file)
 void
 upgrade_file_close (struct t_upgrade_file *upgrade_file)
 {
+    struct t_upgrade_file_io *new_io;
+
     if (!upgrade_file)
         return;
 
-    free (upgrade_file->filename);
     if (upgrade_file->file)
         fclose (upgrade_file->file);
+
+    if (upgrade_file->memory_write)
+    {
+        /* write content on disk, in a thread */
+        new_io = malloc (sizeof (*new_io));
+        if (new_io)
+        {
+            new_io->filename = upgrade_file->filename;
+            new_io->data = upgrade_file->memory_data;
+            new_io->size = upgrade_file->memory_size;
+            new_io->rc = 0;
+            new_io->next_io = upgrade_file_writers;
+            upgrade_file->filename = NULL;
+            upgrade_file->memory_data = NULL;
+            if (upgrade_file_io_start_thread (new_io,
+                                              &upgrade_file_writer_thread_cb))
+            {
+                upgrade_file_writers = new_io;
+            }
+            else
+            {
+                /* thread not created: write file now */
+                (void) upgrade_file_writer_thread_cb (new_io);
+                if (!new_io->rc)
+                {
+                    log_printf (_("Error writing upgrade file \"%s\""),
+                                new_io->filename);
+                }
+                upgrade_file_io_free (new_io);
+            }
+        }
+        else
+        {
+            log_printf (_("Error writing upgrade file \"%s\""),
+                        upgrade_file->filename);
+        }
+    }
+
+    free (upgrade_file->filename);
+    if (upgrade_file->memory_mapped)
+        munmap (upgrade_file->memory_data, upgrade_file->memory_size);
+    else
+        free (upgrade_file->memory_data);
     free (upgrade_file->callback_read_data);
 
     /* remove upgrade file list */
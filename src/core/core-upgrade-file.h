@@ -21,8 +21,19 @@
 #define WEECHAT_UPGRADE_FILE_H
 
 #include <stdio.h>
+#include <time.h>
+#include <pthread.h>
 
-#define UPGRADE_SIGNATURE "===== WeeChat Upgrade file v2.2 - binary, do not edit! ====="
+#define UPGRADE_SIGNATURE "===== WeeChat Upgrade file v2.3 - binary, do not edit! ====="
+#define UPGRADE_SIGNATURE_V2_2 "===== WeeChat Upgrade file v2.2 - binary, do not edit! ====="
+
+/* size of stdio buffer used to read/write upgrade files */
+#define UPGRADE_FILE_BUFFER_SIZE (1024 * 1024)
+
+/* compression of blocks */
+#define UPGRADE_BLOCK_COMPRESSION_NONE 0
+#define UPGRADE_BLOCK_COMPRESSION_ZSTD 1
+#define UPGRADE_BLOCK_ZSTD_LEVEL       1
 
 #define UPGRADE_ERROR(msg1, msg2)                                       \
     upgrade_file_error(upgrade_file, msg1, msg2, __FILE__, __LINE__)
@@ -34,12 +45,51 @@ enum t_upgrade_type
     UPGRADE_TYPE_OBJECT_START = 0,
     UPGRADE_TYPE_OBJECT_END,
     UPGRADE_TYPE_OBJECT_VAR,
+    UPGRADE_TYPE_OBJECT_BLOCK,             /* binary block (since v2.3)     */
+};
+
+/*
+ * A block is a binary object, written in one call (optionally compressed),
+ * and sent to the read callback as an infolist with a pointer "block" and
+ * an integer "block_size" (the block is not copied and is valid only during
+ * the callback): this is much faster than an infolist with many variables,
+ * and is used for large data (like buffer lines).
+ */
+
+struct t_upgrade_block
+{
+    char *data;                            /* content of block              */
+    int size;                              /* size of content               */
+    int size_alloc;                        /* allocated size                */
+    int read_pos;                          /* current position (for read)   */
+};
+
+/*
+ * Upgrade files are written in memory, then a thread writes content on disk
+ * (so that plugins and core can serialize their data while the previous
+ * files are written), and they are mapped in memory at the beginning of the
+ * upgrade (so that the kernel reads all files in background), then parsed
+ * in place.
+ */
+
+struct t_upgrade_file_io
+{
+    char *filename;                        /* filename with path            */
+    char *data;                            /* content of file               */
+    size_t size;                           /* size of content               */
+    int rc;                                /* 1 if OK, 0 if error           */
+    pthread_t thread;                      /* thread writing/reading file   */
+    struct t_upgrade_file_io *next_io;     /* link to next file             */
 };
 
 struct t_upgrade_file
 {
     char *filename;                        /* filename with path            */
     FILE *file;                            /* file pointer                  */
+    char *memory_data;                     /* content of file in memory     */
+    size_t memory_size;                    /* size of content in memory     */
+    int memory_write;                      /* 1 if written in memory        */
+    int memory_mapped;                     /* 1 if file is mapped in memory */
     long last_read_pos;                    /* last read position            */
     int last_read_length;                  /* last read length              */
     int (*callback_read)                   /* callback called when reading  */
@@ -65,7 +115,30 @@ extern struct t_upgrade_file *upgrade_file_new (const char *filename,
 extern int upgrade_file_write_object (struct t_upgrade_file *upgrade_file,
                                       int object_id,
                                       struct t_infolist *infolist);
+extern struct t_upgrade_block *upgrade_file_block_new ();
+extern int upgrade_file_block_add (struct t_upgrade_block *block,
+                                   const void *data, int size);
+extern int upgrade_file_block_add_integer (struct t_upgrade_block *block,
+                                           int value);
+extern int upgrade_file_block_add_time (struct t_upgrade_block *block,
+                                        time_t date);
+extern int upgrade_file_block_add_string (struct t_upgrade_block *block,
+                                          const char *string);
+extern int upgrade_file_block_get (struct t_upgrade_block *block,
+                                   void *data, int size);
+extern int upgrade_file_block_get_integer (struct t_upgrade_block *block,
+                                           int *value);
+extern int upgrade_file_block_get_time (struct t_upgrade_block *block,
+                                        time_t *date);
+extern const char *upgrade_file_block_get_string (struct t_upgrade_block *block);
+extern void upgrade_file_block_free (struct t_upgrade_block *block);
+extern int upgrade_file_write_block (struct t_upgrade_file *upgrade_file,
+                                     int object_id,
+                                     struct t_upgrade_block *block);
 extern int upgrade_file_read (struct t_upgrade_file *upgrade_file);
 extern void upgrade_file_close (struct t_upgrade_file *upgrade_file);
+extern int upgrade_file_wait_writers ();
+extern void upgrade_file_prefetch (const char *directory);
+extern void upgrade_file_prefetch_free ();
 
 #endif /* WEECHAT_UPGRADE_FILE_H */
@@ -36,6 +36,7 @@
 #include "core-infolist.h"
 #include "core-secure-buffer.h"
 #include "core-string.h"
+#include "core-upgrade-file.h"
 #include "core-util.h"
 #include "../gui/gui-buffer.h"
 #include "../gui/gui-chat.h"
@@ -44,6 +45,8 @@
 #include "../gui/gui-hotlist.h"
 #include "../gui/gui-layout.h"
 #include "../gui/gui-line.h"
+#include "../gui/gui-line-compress.h"
+#include "../gui/gui-line-segment.h"
 #include "../gui/gui-nicklist.h"
 #include "../gui/gui-window.h"
 #include "../plugins/plugin.h"
@@ -110,6 +113,226 @@ upgrade_weechat_save_history (struct t_upgrade_file *upgrade_file,
     return 1;
 }
 
+/*
+ * Gets index of a string in the table of strings of a block with buffer
+ * lines (the string is added in table if not found).
+ *
+ * Returns index of string, -1 if string is NULL.
+ */
+
+int
+upgrade_weechat_lines_string_index (struct t_hashtable *strings,
+                                    const char *string)
+{
+    int *ptr_index, index;
+
+    if (!string)
+        return -1;
+
+    ptr_index = hashtable_get (strings, string);
+    if (ptr_index)
+        return *ptr_index;
+
+    index = strings->items_count;
+    if (!hashtable_set (strings, string, &index))
+        return -1;
+
+    return index;
+}
+
+/*
+ * Adds a string of the table of strings in a block with buffer lines
+ * (the hashtable keeps the order of creation, which is the order of indexes).
+ */
+
+void
+upgrade_weechat_lines_add_string_cb (void *data,
+                                     struct t_hashtable *hashtable,
+                                     const void *key, const void *value)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) value;
+
+    upgrade_file_block_add_string ((struct t_upgrade_block *)data,
+                                   (const char *)key);
+}
+
+/*
+ * Saves buffer lines in WeeChat upgrade file, starting at line "first_line"
+ * (at most UPGRADE_WEECHAT_LINES_PER_BLOCK lines are saved).
+ *
+ * The lines are saved in a block, by column (all ids, then all dates, etc.),
+ * and tags/prefixes are saved only once, in a table of strings at the
+ * beginning of the block.
+ *
+ * Returns pointer to the next line to save (NULL if all lines were saved),
+ * and *rc is set to 1 if OK, 0 if error.
+ */
+
+struct t_gui_line *
+upgrade_weechat_save_buffer_lines_block (struct t_upgrade_file *upgrade_file,
+                                         struct t_gui_lines *lines,
+                                         struct t_gui_line *first_line,
+                                         int *rc)
+{
+    struct t_upgrade_block *block;
+    struct t_hashtable *strings;
+    struct t_gui_line *ptr_line, *next_line;
+    int i, count, last_read_line, *index_tags, *index_prefix;
+    char *tags;
+
+    *rc = 0;
+    block = NULL;
+    strings = NULL;
+    index_tags = NULL;
+    index_prefix = NULL;
+
+    count = 0;
+    last_read_line = -1;
+    for (ptr_line = first_line;
+         ptr_line && (count < UPGRADE_WEECHAT_LINES_PER_BLOCK);
+         ptr_line = ptr_line->next_line)
+    {
+        if (lines->last_read_line == ptr_line)
+            last_read_line = count;
+        count++;
+    }
+    next_line = ptr_line;
+
+    block = upgrade_file_block_new ();
+    strings = hashtable_new (256,
+                             WEECHAT_HASHTABLE_STRING,
+                             WEECHAT_HASHTABLE_INTEGER,
+                             NULL, NULL);
+    index_tags = malloc (count * sizeof (*index_tags));
+    index_prefix = malloc (count * sizeof (*index_prefix));
+    if (!block || !strings || !index_tags || !index_prefix)
+        goto end;
+
+    /* build table of strings (tags and prefixes) */
+    for (i = 0, ptr_line = first_line; i < count;
+         i++, ptr_line = ptr_line->next_line)
+    {
+        tags = string_rebuild_split_string (
+            (const char **)ptr_line->data->tags_array, ",", 0, -1);
+        index_tags[i] = upgrade_weechat_lines_string_index (
+            strings, (tags) ? tags : "");
+        free (tags);
+        index_prefix[i] = upgrade_weechat_lines_string_index (
+            strings, ptr_line->data->prefix);
+    }
+
+    /* header */
+    upgrade_file_block_add_integer (block, count);
+    upgrade_file_block_add_integer (block, last_read_line);
+    upgrade_file_block_add_integer (block, strings->items_count);
+    hashtable_map (strings, &upgrade_weechat_lines_add_string_cb, block);
+
+    /* columns */
+    for (i = 0, ptr_line = first_line; i < count;
+         i++, ptr_line = ptr_line->next_line)
+    {
+        upgrade_file_block_add_integer (block, ptr_line->data->id);
+    }
+    for (i = 0, ptr_line = first_line; i < count;
+         i++, ptr_line = ptr_line->next_line)
+    {
+        upgrade_file_block_add_integer (block, ptr_line->data->y);
+    }
+    for (i = 0, ptr_line = first_line; i < count;
+         i++, ptr_line = ptr_line->next_line)
+    {
+        upgrade_file_block_add_time (block, ptr_line->data->date);
+        upgrade_file_block_add_integer (block, ptr_line->data->date_usec);
+    }
+    for (i = 0, ptr_line = first_line; i < count;
+         i++, ptr_line = ptr_line->next_line)
+    {
+        upgrade_file_block_add_time (block, ptr_line->data->date_printed);
+        upgrade_file_block_add_integer (block,
+                                        ptr_line->data->date_usec_printed);
+    }
+    for (i = 0, ptr_line = first_line; i < count;
+         i++, ptr_line = ptr_line->next_line)
+    {
+        upgrade_file_block_add_integer (block, ptr_line->data->highlight);
+    }
+    upgrade_file_block_add (block, index_tags, count * sizeof (*index_tags));
+    upgrade_file_block_add (block, index_prefix,
+                            count * sizeof (*index_prefix));
+    for (i = 0, ptr_line = first_line; i < count;
+         i++, ptr_line = ptr_line->next_line)
+    {
+        if (!upgrade_file_block_add_string (block, ptr_line->data->message))
+            goto end;
+    }
+
+    *rc = upgrade_file_write_block (upgrade_file,
+                                    UPGRADE_WEECHAT_TYPE_BUFFER_LINES,
+                                    block);
+
+end:
+    upgrade_file_block_free (block);
+    hashtable_free (strings);
+    free (index_tags);
+    free (index_prefix);
+    return next_line;
+}
+
+/*
+ * Saves list of blocks of buffer lines saved in segment file (the file itself
+ * is kept on disk and used again after /upgrade).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+upgrade_weechat_save_buffer_segments (struct t_upgrade_file *upgrade_file,
+                                      struct t_gui_lines *lines)
+{
+    struct t_infolist *ptr_infolist;
+    struct t_infolist_item *ptr_item;
+    struct t_gui_line_block *ptr_block;
+    int rc;
+
+    if (!lines->segment_blocks)
+        return 1;
+
+    ptr_infolist = infolist_new (NULL);
+    if (!ptr_infolist)
+        return 0;
+
+    for (ptr_block = lines->segment_blocks; ptr_block;
+         ptr_block = ptr_block->next_block)
+    {
+        ptr_item = infolist_new_item (ptr_infolist);
+        if (!ptr_item
+            || !infolist_new_var_integer (ptr_item, "size", ptr_block->size)
+            || !infolist_new_var_integer (ptr_item, "size_uncompressed",
+                                          ptr_block->size_uncompressed)
+            || !infolist_new_var_integer (ptr_item, "lines_count",
+                                          ptr_block->lines_count)
+            || !infolist_new_var_integer (ptr_item, "read_marker",
+                                          ptr_block->read_marker)
+            || !infolist_new_var_time (ptr_item, "last_date_printed",
+                                       ptr_block->last_date_printed))
+        {
+            infolist_free (ptr_infolist);
+            return 0;
+        }
+    }
+
+    rc = upgrade_file_write_object (upgrade_file,
+                                    UPGRADE_WEECHAT_TYPE_BUFFER_LINES_SEGMENT,
+                                    ptr_infolist);
+    infolist_free (ptr_infolist);
+
+    return rc;
+}
+
 /*
  * Saves buffers in WeeChat upgrade file.
  *
@@ -164,24 +387,25 @@ upgrade_weechat_save_buffers (struct t_upgrade_file *upgrade_file)
                 return 0;
         }
 
-        /* save buffer lines */
-        for (ptr_line = ptr_buffer->own_lines->first_line; ptr_line;
-             ptr_line = ptr_line->next_line)
+        /* save list of blocks saved on disk (oldest lines) */
+        if (!upgrade_weechat_save_buffer_segments (upgrade_file,
+                                                   ptr_buffer->own_lines))
+            return 0;
+
+        /*
+         * save buffer lines (by blocks), including compressed lines in
+         * memory (but not lines on disk)
+         */
+        while (ptr_buffer->own_lines->compressed_blocks)
         {
-            ptr_infolist = infolist_new (NULL);
-            if (!ptr_infolist)
-                return 0;
-            if (!gui_line_add_to_infolist (ptr_infolist,
-                                           ptr_buffer->own_lines,
-                                           ptr_line))
-            {
-                infolist_free (ptr_infolist);
-                return 0;
-            }
-            rc = upgrade_file_write_object (upgrade_file,
-                                            UPGRADE_WEECHAT_TYPE_BUFFER_LINE,
-                                            ptr_infolist);
-            infolist_free (ptr_infolist);
+            if (gui_line_uncompress_block (ptr_buffer) < 0)
+                break;
+        }
+        ptr_line = ptr_buffer->own_lines->first_line;
+        while (ptr_line)
+        {
+            ptr_line = upgrade_weechat_save_buffer_lines_block (
+                upgrade_file, ptr_buffer->own_lines, ptr_line, &rc);
             if (!rc)
                 return 0;
         }
@@ -651,11 +875,16 @@ upgrade_weechat_read_buffer (struct t_infolist *infolist)
 }
 
 /*
- * Reads a buffer line from infolist.
+ * Adds a buffer line read in upgrade file to the current buffer.
  */
 
 void
-upgrade_weechat_read_buffer_line (struct t_infolist *infolist)
+upgrade_weechat_add_buffer_line (int id, int y,
+                                 time_t date, int date_usec,
+                                 time_t date_printed, int date_usec_printed,
+                                 const char *tags, const char *prefix,
+                                 const char *message,
+                                 int highlight, int last_read_line)
 {
     struct t_gui_line *new_line;
 
@@ -668,37 +897,36 @@ upgrade_weechat_read_buffer_line (struct t_infolist *infolist)
             new_line = gui_line_new (
                 upgrade_current_buffer,
                 -1,
-                infolist_time (infolist, "date"),
-                infolist_integer (infolist, "date_usec"),
-                infolist_time (infolist, "date_printed"),
-                infolist_integer (infolist, "date_usec_printed"),
-                infolist_string (infolist, "tags"),
-                infolist_string (infolist, "prefix"),
-                infolist_string (infolist, "message"));
+                date,
+                date_usec,
+                date_printed,
+                date_usec_printed,
+                tags,
+                prefix,
+                message);
             if (new_line)
             {
-                new_line->data->id = infolist_integer (infolist, "id");
+                new_line->data->id = id;
                 gui_line_add (new_line);
-                new_line->data->highlight = infolist_integer (infolist,
-                                                              "highlight");
-                if (infolist_integer (infolist, "last_read_line"))
+                new_line->data->highlight = highlight;
+                if (last_read_line)
                     upgrade_current_buffer->lines->last_read_line = new_line;
             }
             break;
         case GUI_BUFFER_TYPE_FREE:
             new_line = gui_line_new (
                 upgrade_current_buffer,
-                infolist_integer (infolist, "y"),
-                infolist_time (infolist, "date"),
-                infolist_integer (infolist, "date_usec"),
-                infolist_time (infolist, "date_printed"),
-                infolist_integer (infolist, "date_usec_printed"),
-                infolist_string (infolist, "tags"),
+                y,
+                date,
+                date_usec,
+                date_printed,
+                date_usec_printed,
+                tags,
                 NULL,
-                infolist_string (infolist, "message"));
+                message);
             if (new_line)
             {
-                new_line->data->id = infolist_integer (infolist, "id");
+                new_line->data->id = id;
                 gui_line_add_y (new_line);
             }
             break;
@@ -707,6 +935,146 @@ upgrade_weechat_read_buffer_line (struct t_infolist *infolist)
     }
 }
 
+/*
+ * Reads a buffer line from infolist (upgrade file v2.2).
+ */
+
+void
+upgrade_weechat_read_buffer_line (struct t_infolist *infolist)
+{
+    upgrade_weechat_add_buffer_line (
+        infolist_integer (infolist, "id"),
+        infolist_integer (infolist, "y"),
+        infolist_time (infolist, "date"),
+        infolist_integer (infolist, "date_usec"),
+        infolist_time (infolist, "date_printed"),
+        infolist_integer (infolist, "date_usec_printed"),
+        infolist_string (infolist, "tags"),
+        infolist_string (infolist, "prefix"),
+        infolist_string (infolist, "message"),
+        infolist_integer (infolist, "highlight"),
+        infolist_integer (infolist, "last_read_line"));
+}
+
+/*
+ * Reads a block of buffer lines (saved by function
+ * upgrade_weechat_save_buffer_lines_block).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+upgrade_weechat_read_buffer_lines (struct t_infolist *infolist)
+{
+    struct t_upgrade_block block, dates, dates_printed;
+    const char **strings, *message;
+    int i, rc, count, last_read_line, num_strings, *id, *y;
+    int *highlight, *index_tags, *index_prefix, date_usec, date_usec_printed;
+    time_t date, date_printed;
+
+    rc = 0;
+    strings = NULL;
+    id = NULL;
+    y = NULL;
+    highlight = NULL;
+    index_tags = NULL;
+    index_prefix = NULL;
+
+    block.data = infolist_pointer (infolist, "block");
+    if (!block.data)
+        return 1;
+    block.size = infolist_integer (infolist, "block_size");
+    block.size_alloc = block.size;
+    block.read_pos = 0;
+
+    /* header */
+    if (!upgrade_file_block_get_integer (&block, &count)
+        || !upgrade_file_block_get_integer (&block, &last_read_line)
+        || !upgrade_file_block_get_integer (&block, &num_strings)
+        || (count < 0) || (num_strings < 0))
+    {
+        goto end;
+    }
+
+    /* table of strings */
+    if (num_strings > 0)
+    {
+        strings = malloc (num_strings * sizeof (*strings));
+        if (!strings)
+            goto end;
+        for (i = 0; i < num_strings; i++)
+        {
+            strings[i] = upgrade_file_block_get_string (&block);
+            if (!strings[i])
+                goto end;
+        }
+    }
+
+    /* columns */
+    id = malloc ((count + 1) * sizeof (*id));
+    y = malloc ((count + 1) * sizeof (*y));
+    highlight = malloc ((count + 1) * sizeof (*highlight));
+    index_tags = malloc ((count + 1) * sizeof (*index_tags));
+    index_prefix = malloc ((count + 1) * sizeof (*index_prefix));
+    if (!id || !y || !highlight || !index_tags || !index_prefix)
+        goto end;
+    if (!upgrade_file_block_get (&block, id, count * sizeof (*id))
+        || !upgrade_file_block_get (&block, y, count * sizeof (*y)))
+        goto end;
+    dates = block;
+    if (!upgrade_file_block_get (
+            &block, NULL, count * (sizeof (date) + sizeof (date_usec))))
+        goto end;
+    dates_printed = block;
+    if (!upgrade_file_block_get (
+            &block, NULL,
+            count * (sizeof (date_printed) + sizeof (date_usec_printed))))
+        goto end;
+    if (!upgrade_file_block_get (&block, highlight,
+                                 count * sizeof (*highlight))
+        || !upgrade_file_block_get (&block, index_tags,
+                                    count * sizeof (*index_tags))
+        || !upgrade_file_block_get (&block, index_prefix,
+                                    count * sizeof (*index_prefix)))
+        goto end;
+
+    for (i = 0; i < count; i++)
+    {
+        if ((index_tags[i] >= num_strings) || (index_prefix[i] >= num_strings)
+            || !upgrade_file_block_get_time (&dates, &date)
+            || !upgrade_file_block_get_integer (&dates, &date_usec)
+            || !upgrade_file_block_get_time (&dates_printed, &date_printed)
+            || !upgrade_file_block_get_integer (&dates_printed,
+                                                &date_usec_printed))
+        {
+            goto end;
+        }
+        message = upgrade_file_block_get_string (&block);
+        upgrade_weechat_add_buffer_line (
+            id[i], y[i],
+            date, date_usec,
+            date_printed, date_usec_printed,
+            (index_tags[i] >= 0) ? strings[index_tags[i]] : NULL,
+            (index_prefix[i] >= 0) ? strings[index_prefix[i]] : NULL,
+            message,
+            highlight[i],
+            (i == last_read_line) ? 1 : 0);
+    }
+
+    rc = 1;
+
+end:
+    free (strings);
+    free (id);
+    free (y);
+    free (highlight);
+    free (index_tags);
+    free (index_prefix);
+    return rc;
+}
+
 /*
  * Reads a nicklist from infolist.
  */
@@ -874,6 +1242,27 @@ upgrade_weechat_read_cb (const void *pointer, void *data,
             case UPGRADE_WEECHAT_TYPE_BUFFER_LINE:
                 upgrade_weechat_read_buffer_line (infolist);
                 break;
+            case UPGRADE_WEECHAT_TYPE_BUFFER_LINES:
+                if (!upgrade_weechat_read_buffer_lines (infolist))
+                {
+                    gui_chat_printf (NULL,
+                                     _("%sError reading buffer lines in "
+                                       "upgrade file"),
+                                     gui_chat_prefix[GUI_CHAT_PREFIX_ERROR]);
+                }
+                break;
+            case UPGRADE_WEECHAT_TYPE_BUFFER_LINES_SEGMENT:
+                if (upgrade_current_buffer)
+                {
+                    (void) gui_line_segment_add_block (
+                        upgrade_current_buffer,
+                        infolist_integer (infolist, "size"),
+                        infolist_integer (infolist, "size_uncompressed"),
+                        infolist_integer (infolist, "lines_count"),
+                        infolist_integer (infolist, "read_marker"),
+                        infolist_time (infolist, "last_date_printed"));
+                }
+                break;
             case UPGRADE_WEECHAT_TYPE_NICKLIST:
                 upgrade_weechat_read_nicklist (infolist);
                 break;
@@ -917,15 +1306,24 @@ upgrade_weechat_load ()
 
     upgrade_layout = gui_layout_alloc (GUI_LAYOUT_UPGRADE);
 
+    /* read all upgrade files (core and plugins) in parallel */
+    upgrade_file_prefetch (weechat_data_dir);
+
     upgrade_file = upgrade_file_new (WEECHAT_UPGRADE_FILENAME,
                                      &upgrade_weechat_read_cb, NULL, NULL);
     if (!upgrade_file)
+    {
+        upgrade_file_prefetch_free ();
         return 0;
+    }
 
     rc = upgrade_file_read (upgrade_file);
 
     upgrade_file_close (upgrade_file);
 
+    if (!rc)
+        upgrade_file_prefetch_free ();
+
     if (!hotlist_reset)
         gui_hotlist_clear (GUI_HOTLIST_MASK_MAX);
 
@@ -988,6 +1386,9 @@ upgrade_weechat_end ()
     struct timeval tv_now;
     long long time_diff;
 
+    /* free upgrade files read in memory and not used */
+    upgrade_file_prefetch_free ();
+
     /* remove .upgrade files */
     dir_exec_on_files (weechat_data_dir,
                        0, 0,
@@ -35,8 +35,13 @@ enum t_upgrade_weechat_type
     UPGRADE_WEECHAT_TYPE_MISC,
     UPGRADE_WEECHAT_TYPE_HOTLIST,
     UPGRADE_WEECHAT_TYPE_LAYOUT_WINDOW,
+    UPGRADE_WEECHAT_TYPE_BUFFER_LINES,
+    UPGRADE_WEECHAT_TYPE_BUFFER_LINES_SEGMENT,
 };
 
+/* max number of buffer lines saved in a single block */
+#define UPGRADE_WEECHAT_LINES_PER_BLOCK 16384
+
 int upgrade_weechat_save ();
 int upgrade_weechat_load ();
 void upgrade_weechat_end ();
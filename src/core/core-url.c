@@ -37,6 +37,9 @@
 #include "core-string.h"
 #include "../plugins/plugin.h"
 
+#if URL_ERROR_SIZE < CURL_ERROR_SIZE
+#error "URL_ERROR_SIZE is too small for curl error buffer"
+#endif
 
 #define URL_DEF_CONST(__prefix, __name)                                 \
     { #__name, CURL##__prefix##_##__name }
@@ -1315,72 +1318,69 @@ weeurl_set_proxy (CURL *curl, struct t_proxy *proxy)
 }
 
 /*
- * Downloads URL using options.
+ * Creates a new URL transfer: initializes the curl easy handle with options,
+ * without performing the transfer.
  *
  * If output is not NULL, it must be a hashtable with keys and values of type
- * "string". The following keys may be added in the hashtable,
- * depending on the success or error of the URL transfer:
+ * "string" (see function weeurl_download).
  *
- *   key           | description
- *   --------------|--------------------------------------------------------
- *   response_code | HTTP response code (as string)
- *   headers       | HTTP headers in response
- *   output        | stdout (set only if "file_out" was not set in options)
- *   error         | error message (set only in case of error)
+ * If an error occurs (for example a file can not be opened), the field "rc"
+ * is set in transfer (see return codes of function weeurl_download) and the
+ * transfer must not be performed: it must be ended with weeurl_transfer_done.
  *
- * Returns:
- *   0: OK
- *   1: invalid URL
- *   2: error downloading URL
- *   3: not enough memory
- *   4: file error
+ * Returns pointer to new transfer, NULL if not enough memory.
+ *
+ * Note: result must be freed after use with function weeurl_transfer_free.
  */
 
-int
-weeurl_download (const char *url, struct t_hashtable *options,
-                 struct t_hashtable *output)
+struct t_url_transfer *
+weeurl_transfer_new (const char *url, struct t_hashtable *options,
+                     struct t_hashtable *output)
 {
+    struct t_url_transfer *new_transfer;
     CURL *curl;
-    struct t_url_file url_file[2];
     char *url_file_option[2] = { "file_in", "file_out" };
     char *url_file_mode[2] = { "rb", "wb" };
-    char url_error[CURL_ERROR_SIZE + 1], url_error_code[12];
-    char **string_headers, **string_output;
-    char str_response_code[32];
     CURLoption url_file_opt_func[2] = { CURLOPT_READFUNCTION, CURLOPT_WRITEFUNCTION };
     CURLoption url_file_opt_data[2] = { CURLOPT_READDATA, CURLOPT_WRITEDATA };
     void *url_file_opt_cb[2] = { &weeurl_read_stream, &weeurl_write_stream };
     struct t_proxy *ptr_proxy;
-    int rc, curl_rc, i, output_to_file;
-    long response_code;
+    int i, output_to_file;
 
-    rc = 0;
-
-    string_headers = NULL;
-    string_output = NULL;
-    url_error[0] = '\0';
-    url_error_code[0] = '\0';
+    new_transfer = malloc (sizeof (*new_transfer));
+    if (!new_transfer)
+        return NULL;
 
+    new_transfer->curl = NULL;
+    new_transfer->url = (url) ? strdup (url) : NULL;
+    new_transfer->output = output;
     for (i = 0; i < 2; i++)
     {
-        url_file[i].filename = NULL;
-        url_file[i].stream = NULL;
+        new_transfer->url_file[i].filename = NULL;
+        new_transfer->url_file[i].stream = NULL;
     }
+    new_transfer->string_headers = NULL;
+    new_transfer->string_output = NULL;
+    new_transfer->error[0] = '\0';
+    new_transfer->rc = 0;
 
     if (!url || !url[0])
     {
-        snprintf (url_error, sizeof (url_error), "%s", _("invalid URL"));
-        rc = 1;
-        goto end;
+        snprintf (new_transfer->error, sizeof (new_transfer->error),
+                  "%s", _("invalid URL"));
+        new_transfer->rc = 1;
+        return new_transfer;
     }
 
     curl = curl_easy_init ();
     if (!curl)
     {
-        snprintf (url_error, sizeof (url_error), "%s", _("not enough memory"));
-        rc = 3;
-        goto end;
+        snprintf (new_transfer->error, sizeof (new_transfer->error),
+                  "%s", _("not enough memory"));
+        new_transfer->rc = 3;
+        return new_transfer;
     }
+    new_transfer->curl = curl;
 
     /* set default options */
     curl_easy_setopt (curl, CURLOPT_URL, url);
@@ -1398,11 +1398,12 @@ weeurl_download (const char *url, struct t_hashtable *options,
     /* set callback to retrieve HTTP headers */
     if (output)
     {
-        string_headers = string_dyn_alloc (1024);
-        if (string_headers)
+        new_transfer->string_headers = string_dyn_alloc (1024);
+        if (new_transfer->string_headers)
         {
             curl_easy_setopt (curl, CURLOPT_HEADERFUNCTION, &weeurl_write_string);
-            curl_easy_setopt (curl, CURLOPT_HEADERDATA, string_headers);
+            curl_easy_setopt (curl, CURLOPT_HEADERDATA,
+                              new_transfer->string_headers);
         }
     }
 
@@ -1412,22 +1413,26 @@ weeurl_download (const char *url, struct t_hashtable *options,
     {
         for (i = 0; i < 2; i++)
         {
-            url_file[i].filename = hashtable_get (options, url_file_option[i]);
-            if (url_file[i].filename)
+            new_transfer->url_file[i].filename = hashtable_get (
+                options, url_file_option[i]);
+            if (new_transfer->url_file[i].filename)
             {
-                url_file[i].stream = fopen (url_file[i].filename, url_file_mode[i]);
-                if (!url_file[i].stream)
+                new_transfer->url_file[i].stream = fopen (
+                    new_transfer->url_file[i].filename, url_file_mode[i]);
+                if (!new_transfer->url_file[i].stream)
                 {
-                    snprintf (url_error, sizeof (url_error),
+                    snprintf (new_transfer->error,
+                              sizeof (new_transfer->error),
                               (i == 0) ?
                               _("file \"%s\" not found") :
                               _("can not write file \"%s\""),
-                              url_file[i].filename);
-                    rc = 4;
-                    goto end;
+                              new_transfer->url_file[i].filename);
+                    new_transfer->rc = 4;
+                    return new_transfer;
                 }
                 curl_easy_setopt (curl, url_file_opt_func[i], url_file_opt_cb[i]);
-                curl_easy_setopt (curl, url_file_opt_data[i], url_file[i].stream);
+                curl_easy_setopt (curl, url_file_opt_data[i],
+                                  new_transfer->url_file[i].stream);
                 if (i == 1)
                     output_to_file = 1;
             }
@@ -1437,11 +1442,12 @@ weeurl_download (const char *url, struct t_hashtable *options,
     /* redirect stdout if no filename was given (via key "file_out") */
     if (output && !output_to_file)
     {
-        string_output = string_dyn_alloc (1024);
-        if (string_output)
+        new_transfer->string_output = string_dyn_alloc (1024);
+        if (new_transfer->string_output)
         {
             curl_easy_setopt (curl, CURLOPT_WRITEFUNCTION, &weeurl_write_string);
-            curl_easy_setopt (curl, CURLOPT_WRITEDATA, string_output);
+            curl_easy_setopt (curl, CURLOPT_WRITEDATA,
+                              new_transfer->string_output);
         }
     }
 
@@ -1449,70 +1455,179 @@ weeurl_download (const char *url, struct t_hashtable *options,
     hashtable_map (options, &weeurl_option_map_cb, curl);
 
     /* set error buffer */
-    curl_easy_setopt (curl, CURLOPT_ERRORBUFFER, url_error);
+    curl_easy_setopt (curl, CURLOPT_ERRORBUFFER, new_transfer->error);
 
-    /* perform action! */
-    curl_rc = curl_easy_perform (curl);
-    if (curl_rc == CURLE_OK)
-    {
-        if (output)
-        {
-            curl_easy_getinfo (curl, CURLINFO_RESPONSE_CODE, &response_code);
-            snprintf (str_response_code, sizeof (str_response_code),
-                      "%ld", response_code);
-            hashtable_set (output, "response_code", str_response_code);
-        }
-    }
-    else
+    return new_transfer;
+}
+
+/*
+ * Ends an URL transfer: sets the result in output hashtable (if not NULL),
+ * using the curl return code (ignored if the transfer was not performed
+ * because of an error in function weeurl_transfer_new).
+ *
+ * Returns the return code of transfer (see function weeurl_download).
+ */
+
+int
+weeurl_transfer_done (struct t_url_transfer *transfer, int curl_rc)
+{
+    char str_response_code[32], url_error_code[12];
+    long response_code;
+    int i;
+
+    if (!transfer)
+        return 3;
+
+    url_error_code[0] = '\0';
+
+    if (transfer->rc == 0)
     {
-        if (output)
+        if (curl_rc == CURLE_OK)
         {
-            snprintf (url_error_code, sizeof (url_error_code), "%d", curl_rc);
-            if (!url_error[0])
+            if (transfer->output)
             {
-                snprintf (url_error, sizeof (url_error),
-                          "%s", _("transfer error"));
+                curl_easy_getinfo (transfer->curl, CURLINFO_RESPONSE_CODE,
+                                   &response_code);
+                snprintf (str_response_code, sizeof (str_response_code),
+                          "%ld", response_code);
+                hashtable_set (transfer->output, "response_code",
+                               str_response_code);
             }
         }
         else
         {
-            /*
-             * URL transfer done in a forked process: display error on stderr,
-             * which will be sent to the hook_process callback
-             */
-            fprintf (stderr,
-                     _("curl error %d (%s) (URL: \"%s\")\n"),
-                     curl_rc, url_error, url);
+            if (transfer->output)
+            {
+                snprintf (url_error_code, sizeof (url_error_code),
+                          "%d", curl_rc);
+                if (!transfer->error[0])
+                {
+                    snprintf (transfer->error, sizeof (transfer->error),
+                              "%s", _("transfer error"));
+                }
+            }
+            else
+            {
+                /*
+                 * URL transfer done in a forked process: display error on
+                 * stderr, which will be sent to the hook_process callback
+                 */
+                fprintf (stderr,
+                         _("curl error %d (%s) (URL: \"%s\")\n"),
+                         curl_rc, transfer->error, transfer->url);
+            }
+            transfer->rc = 2;
         }
-        rc = 2;
     }
 
-    /* cleanup */
-    curl_easy_cleanup (curl);
-
-end:
+    /* close files, so that they are complete when the callback is called */
     for (i = 0; i < 2; i++)
     {
-        if (url_file[i].stream)
-            fclose (url_file[i].stream);
+        if (transfer->url_file[i].stream)
+        {
+            fclose (transfer->url_file[i].stream);
+            transfer->url_file[i].stream = NULL;
+        }
     }
-    if (output)
+
+    if (transfer->output)
     {
-        if (string_headers)
+        if (transfer->string_headers)
         {
-            hashtable_set (output, "headers", *string_headers);
-            string_dyn_free (string_headers, 1);
+            hashtable_set (transfer->output, "headers",
+                           *(transfer->string_headers));
         }
-        if (string_output)
+        if (transfer->string_output)
         {
-            hashtable_set (output, "output", *string_output);
-            string_dyn_free (string_output, 1);
+            hashtable_set (transfer->output, "output",
+                           *(transfer->string_output));
         }
-        if (url_error[0])
-            hashtable_set (output, "error", url_error);
+        if (transfer->error[0])
+            hashtable_set (transfer->output, "error", transfer->error);
         if (url_error_code[0])
-            hashtable_set (output, "error_code_curl", url_error_code);
+        {
+            hashtable_set (transfer->output, "error_code_curl",
+                           url_error_code);
+        }
+    }
+
+    return transfer->rc;
+}
+
+/*
+ * Frees an URL transfer.
+ *
+ * If the curl easy handle was added to a multi handle, it must be removed
+ * from the multi handle before calling this function.
+ */
+
+void
+weeurl_transfer_free (struct t_url_transfer *transfer)
+{
+    int i;
+
+    if (!transfer)
+        return;
+
+    if (transfer->curl)
+        curl_easy_cleanup (transfer->curl);
+    free (transfer->url);
+    for (i = 0; i < 2; i++)
+    {
+        if (transfer->url_file[i].stream)
+            fclose (transfer->url_file[i].stream);
     }
+    string_dyn_free (transfer->string_headers, 1);
+    string_dyn_free (transfer->string_output, 1);
+
+    free (transfer);
+}
+
+/*
+ * Downloads URL using options.
+ *
+ * If output is not NULL, it must be a hashtable with keys and values of type
+ * "string". The following keys may be added in the hashtable,
+ * depending on the success or error of the URL transfer:
+ *
+ *   key           | description
+ *   --------------|--------------------------------------------------------
+ *   response_code | HTTP response code (as string)
+ *   headers       | HTTP headers in response
+ *   output        | stdout (set only if "file_out" was not set in options)
+ *   error         | error message (set only in case of error)
+ *
+ * Returns:
+ *   0: OK
+ *   1: invalid URL
+ *   2: error downloading URL
+ *   3: not enough memory
+ *   4: file error
+ */
+
+int
+weeurl_download (const char *url, struct t_hashtable *options,
+                 struct t_hashtable *output)
+{
+    struct t_url_transfer *transfer;
+    int rc, curl_rc;
+
+    transfer = weeurl_transfer_new (url, options, output);
+    if (!transfer)
+    {
+        if (output)
+            hashtable_set (output, "error", _("not enough memory"));
+        return 3;
+    }
+
+    /* perform action! */
+    curl_rc = (transfer->rc == 0) ?
+        curl_easy_perform (transfer->curl) : CURLE_OK;
+
+    rc = weeurl_transfer_done (transfer, curl_rc);
+
+    weeurl_transfer_free (transfer);
+
     return rc;
 }
 
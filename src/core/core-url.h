@@ -22,6 +22,9 @@
 
 #include <stdio.h>
 
+/* size of error buffer for curl (same value as CURL_ERROR_SIZE) */
+#define URL_ERROR_SIZE 256
+
 struct t_hashtable;
 struct t_infolist;
 
@@ -54,10 +57,27 @@ struct t_url_file
     FILE *stream;                      /* file stream                       */
 };
 
+struct t_url_transfer
+{
+    void *curl;                        /* curl easy handle                  */
+    char *url;                         /* URL                               */
+    struct t_hashtable *output;        /* output hashtable (can be NULL)    */
+    struct t_url_file url_file[2];     /* files for "file_in", "file_out"   */
+    char **string_headers;             /* HTTP headers received             */
+    char **string_output;              /* output (if no "file_out")         */
+    char error[URL_ERROR_SIZE + 1];    /* error message (from curl)         */
+    int rc;                            /* return code (0 = OK)              */
+};
+
 extern int url_debug;
 extern char *url_type_string[];
 extern struct t_url_option url_options[];
 
+extern struct t_url_transfer *weeurl_transfer_new (const char *url,
+                                                   struct t_hashtable *options,
+                                                   struct t_hashtable *output);
+extern int weeurl_transfer_done (struct t_url_transfer *transfer, int curl_rc);
+extern void weeurl_transfer_free (struct t_url_transfer *transfer);
 extern int weeurl_download (const char *url, struct t_hashtable *options,
                             struct t_hashtable *output);
 extern int weeurl_option_add_to_infolist (struct t_infolist *infolist,
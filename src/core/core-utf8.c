@@ -524,6 +524,10 @@ utf8_char_size_screen (const char *string)
     if (((unsigned char)string[0]) < 32)
         return 1;
 
+    /* printable ASCII char: exactly one column (no need to call wcwidth) */
+    if (((unsigned char)string[0]) < 127)
+        return 1;
+
     codepoint = (wchar_t)utf8_char_int (string);
 
     /*
@@ -561,6 +565,14 @@ utf8_strlen_screen (const char *string)
     ptr_string = string;
     while (ptr_string && ptr_string[0])
     {
+        /* fast path for printable ASCII chars: one column each */
+        if ((((unsigned char)ptr_string[0]) >= 32)
+            && (((unsigned char)ptr_string[0]) < 127))
+        {
+            size_screen++;
+            ptr_string++;
+            continue;
+        }
         size_screen_char = utf8_char_size_screen (ptr_string);
         /* count only chars that use at least one column */
         if (size_screen_char > 0)
@@ -62,16 +62,18 @@ struct t_hook *
 hook_command_search (struct t_weechat_plugin *plugin, const char *command)
 {
     struct t_hook *ptr_hook;
+    struct t_arraylist *ptr_list;
+    int i, size;
 
     if (!command)
         return NULL;
 
-    for (ptr_hook = weechat_hooks[HOOK_TYPE_COMMAND]; ptr_hook;
-         ptr_hook = ptr_hook->next_hook)
+    ptr_list = hook_index_name_get (HOOK_TYPE_COMMAND, command);
+    size = arraylist_size (ptr_list);
+    for (i = 0; i < size; i++)
     {
-        if (!ptr_hook->deleted
-            && (ptr_hook->plugin == plugin)
-            && (strcmp (HOOK_COMMAND(ptr_hook, command), command) == 0))
+        ptr_hook = (struct t_hook *)arraylist_get (ptr_list, i);
+        if (!ptr_hook->deleted && (ptr_hook->plugin == plugin))
             return ptr_hook;
     }
 
@@ -567,6 +569,8 @@ hook_command (struct t_weechat_plugin *plugin, const char *command,
 
     hook_add_to_list (new_hook);
 
+    hook_index_name_add (new_hook, new_hook_command->command);
+
     return new_hook;
 }
 
@@ -588,14 +592,15 @@ int
 hook_command_exec (struct t_gui_buffer *buffer, int any_plugin,
                    struct t_weechat_plugin *plugin, const char *string)
 {
-    struct t_hook *ptr_hook, *next_hook;
+    struct t_hook *ptr_hook;
     struct t_hook *hook_plugin, *hook_other_plugin, *hook_other_plugin2;
+    struct t_arraylist *ptr_list;
     struct t_hook *hook_incomplete_command;
     struct t_hook_exec_cb hook_exec_cb;
     char **argv, **argv_eol;
     const char *ptr_command_name;
     int argc, rc, length_command_name, allow_incomplete_commands;
-    int count_other_plugin, count_incomplete_commands;
+    int count_other_plugin, count_incomplete_commands, i, size;
 
     if (!buffer || !string || !string[0])
         return HOOK_COMMAND_EXEC_NOT_FOUND;
@@ -632,43 +637,48 @@ hook_command_exec (struct t_gui_buffer *buffer, int any_plugin,
     count_other_plugin = 0;
     allow_incomplete_commands = CONFIG_BOOLEAN(config_look_command_incomplete);
     count_incomplete_commands = 0;
-    ptr_hook = weechat_hooks[HOOK_TYPE_COMMAND];
-    while (ptr_hook)
+    ptr_list = hook_index_name_get (HOOK_TYPE_COMMAND, ptr_command_name);
+    size = arraylist_size (ptr_list);
+    for (i = 0; i < size; i++)
     {
-        next_hook = ptr_hook->next_hook;
-
-        if (!ptr_hook->deleted)
+        ptr_hook = (struct t_hook *)arraylist_get (ptr_list, i);
+        if (ptr_hook->deleted)
+            continue;
+        if (ptr_hook->plugin == plugin)
+        {
+            if (!hook_plugin)
+                hook_plugin = ptr_hook;
+        }
+        else
         {
-            if (strcmp (ptr_command_name, HOOK_COMMAND(ptr_hook, command)) == 0)
+            if (any_plugin)
             {
-                if (ptr_hook->plugin == plugin)
-                {
-                    if (!hook_plugin)
-                        hook_plugin = ptr_hook;
-                }
-                else
-                {
-                    if (any_plugin)
-                    {
-                        if (!hook_other_plugin)
-                            hook_other_plugin = ptr_hook;
-                        else if (!hook_other_plugin2)
-                            hook_other_plugin2 = ptr_hook;
-                        count_other_plugin++;
-                    }
-                }
+                if (!hook_other_plugin)
+                    hook_other_plugin = ptr_hook;
+                else if (!hook_other_plugin2)
+                    hook_other_plugin2 = ptr_hook;
+                count_other_plugin++;
             }
-            else if (allow_incomplete_commands
-                     && (string_strncmp (ptr_command_name,
-                                         HOOK_COMMAND(ptr_hook, command),
-                                         length_command_name) == 0))
+        }
+    }
+
+    /* search incomplete commands only if the command was not found */
+    if (allow_incomplete_commands && !hook_plugin && !hook_other_plugin)
+    {
+        for (ptr_hook = weechat_hooks[HOOK_TYPE_COMMAND]; ptr_hook;
+             ptr_hook = ptr_hook->next_hook)
+        {
+            if (!ptr_hook->deleted
+                && (strcmp (ptr_command_name,
+                            HOOK_COMMAND(ptr_hook, command)) != 0)
+                && (string_strncmp (ptr_command_name,
+                                    HOOK_COMMAND(ptr_hook, command),
+                                    length_command_name) == 0))
             {
                 hook_incomplete_command = ptr_hook;
                 count_incomplete_commands++;
             }
         }
-
-        ptr_hook = next_hook;
     }
 
     rc = HOOK_COMMAND_EXEC_NOT_FOUND;
@@ -969,6 +979,7 @@ hook_command_free_data (struct t_hook *hook)
 
     if (HOOK_COMMAND(hook, command))
     {
+        hook_index_name_remove (hook, HOOK_COMMAND(hook, command));
         free (HOOK_COMMAND(hook, command));
         HOOK_COMMAND(hook, command) = NULL;
     }
@@ -84,12 +84,47 @@ hook_config (struct t_weechat_plugin *plugin, const char *option,
     new_hook_config->callback = callback;
     new_hook_config->option = strdup ((ptr_option) ? ptr_option :
                                       ((option) ? option : ""));
+    new_hook_config->wildcard = (new_hook_config->option
+                                 && strchr (new_hook_config->option, '*')) ?
+        1 : 0;
+    new_hook_config->mask = (new_hook_config->wildcard) ?
+        string_mask_compile (new_hook_config->option, 0) : NULL;
 
     hook_add_to_list (new_hook);
 
     return new_hook;
 }
 
+/*
+ * Checks if an option matches the option of a config hook.
+ *
+ * If the hook option has a wildcard, it is compiled once when the hook is
+ * created, so that the literal prefix and suffix are compared first.
+ *
+ * Returns:
+ *   1: option matches
+ *   0: option does not match
+ */
+
+int
+hook_config_match (struct t_hook *hook, const char *option)
+{
+    if (!HOOK_CONFIG(hook, option))
+        return 1;
+
+    if (!HOOK_CONFIG(hook, wildcard))
+    {
+        return (HOOK_CONFIG(hook, option)[0]
+                && (string_strcasecmp (option,
+                                       HOOK_CONFIG(hook, option)) == 0)) ?
+            1 : 0;
+    }
+
+    return (HOOK_CONFIG(hook, mask)) ?
+        string_match_compiled (option, HOOK_CONFIG(hook, mask)) :
+        string_match (option, HOOK_CONFIG(hook, option), 0);
+}
+
 /*
  * Executes a config hook.
  */
@@ -109,8 +144,7 @@ hook_config_exec (const char *option, const char *value)
 
         if (!ptr_hook->deleted
             && !ptr_hook->running
-            && (!HOOK_CONFIG(ptr_hook, option)
-                || (string_match (option, HOOK_CONFIG(ptr_hook, option), 0))))
+            && hook_config_match (ptr_hook, option))
         {
             hook_callback_start (ptr_hook, &hook_exec_cb);
             (void) (HOOK_CONFIG(ptr_hook, callback))
@@ -142,6 +176,11 @@ hook_config_free_data (struct t_hook *hook)
         free (HOOK_CONFIG(hook, option));
         HOOK_CONFIG(hook, option) = NULL;
     }
+    if (HOOK_CONFIG(hook, mask))
+    {
+        string_mask_free (HOOK_CONFIG(hook, mask));
+        HOOK_CONFIG(hook, mask) = NULL;
+    }
 
     free (hook->hook_data);
     hook->hook_data = NULL;
@@ -183,4 +222,6 @@ hook_config_print_log (struct t_hook *hook)
     log_printf ("  config data:");
     log_printf ("    callback. . . . . . . : %p", HOOK_CONFIG(hook, callback));
     log_printf ("    option. . . . . . . . : '%s'", HOOK_CONFIG(hook, option));
+    log_printf ("    wildcard. . . . . . . : %d", HOOK_CONFIG(hook, wildcard));
+    log_printf ("    mask. . . . . . . . . : %p", HOOK_CONFIG(hook, mask));
 }
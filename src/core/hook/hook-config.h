@@ -22,6 +22,7 @@
 
 struct t_weechat_plugin;
 struct t_infolist_item;
+struct t_string_mask;
 
 #define HOOK_CONFIG(hook, var) (((struct t_hook_config *)hook->hook_data)->var)
 
@@ -33,6 +34,8 @@ struct t_hook_config
     t_hook_callback_config *callback;  /* config callback                   */
     char *option;                      /* config option for hook            */
                                        /* (NULL = hook for all options)     */
+    int wildcard;                      /* 1 if option has a wildcard ("*")  */
+    struct t_string_mask *mask;        /* compiled option (if wildcard)     */
 };
 
 extern char *hook_config_get_description (struct t_hook *hook);
@@ -60,7 +60,7 @@ hook_connect_get_description (struct t_hook *hook)
 }
 
 /*
- * Hooks a connection to a peer (using fork).
+ * Hooks a connection to a peer (using a thread or a fork).
  *
  * Returns pointer to new hook, NULL if error.
  */
@@ -120,6 +120,12 @@ hook_connect (struct t_weechat_plugin *plugin, const char *proxy,
     new_hook_connect->handshake_hook_timer = NULL;
     new_hook_connect->handshake_fd_flags = 0;
     new_hook_connect->handshake_ip_address = NULL;
+    new_hook_connect->resolve = NULL;
+    new_hook_connect->connect_addrs = NULL;
+    new_hook_connect->connect_num_addrs = 0;
+    new_hook_connect->connect_index = 0;
+    new_hook_connect->connect_status = 0;
+    new_hook_connect->connect_sock = -1;
     if (!hook_socketpair_ok)
     {
         for (i = 0; i < HOOK_CONNECT_MAX_SOCKETS; i++)
@@ -131,7 +137,7 @@ hook_connect (struct t_weechat_plugin *plugin, const char *proxy,
 
     hook_add_to_list (new_hook);
 
-    network_connect_with_fork (new_hook);
+    network_connect_hook (new_hook);
 
     return new_hook;
 }
@@ -267,6 +273,21 @@ hook_connect_free_data (struct t_hook *hook)
         free (HOOK_CONNECT(hook, handshake_ip_address));
         HOOK_CONNECT(hook, handshake_ip_address) = NULL;
     }
+    if (HOOK_CONNECT(hook, connect_addrs))
+    {
+        free (HOOK_CONNECT(hook, connect_addrs));
+        HOOK_CONNECT(hook, connect_addrs) = NULL;
+    }
+    if (HOOK_CONNECT(hook, resolve))
+    {
+        network_resolve_unref (HOOK_CONNECT(hook, resolve));
+        HOOK_CONNECT(hook, resolve) = NULL;
+    }
+    if (HOOK_CONNECT(hook, connect_sock) != -1)
+    {
+        close (HOOK_CONNECT(hook, connect_sock));
+        HOOK_CONNECT(hook, connect_sock) = -1;
+    }
     if (HOOK_CONNECT(hook, child_pid) > 0)
     {
         kill (HOOK_CONNECT(hook, child_pid), SIGKILL);
@@ -371,6 +392,16 @@ hook_connect_add_to_infolist (struct t_infolist_item *item,
         return 0;
     if (!infolist_new_var_string (item, "handshake_ip_address", HOOK_CONNECT(hook, handshake_ip_address)))
         return 0;
+    if (!infolist_new_var_pointer (item, "resolve", HOOK_CONNECT(hook, resolve)))
+        return 0;
+    if (!infolist_new_var_integer (item, "connect_num_addrs", HOOK_CONNECT(hook, connect_num_addrs)))
+        return 0;
+    if (!infolist_new_var_integer (item, "connect_index", HOOK_CONNECT(hook, connect_index)))
+        return 0;
+    if (!infolist_new_var_integer (item, "connect_status", HOOK_CONNECT(hook, connect_status)))
+        return 0;
+    if (!infolist_new_var_integer (item, "connect_sock", HOOK_CONNECT(hook, connect_sock)))
+        return 0;
 
     return 1;
 }
@@ -411,6 +442,12 @@ hook_connect_print_log (struct t_hook *hook)
     log_printf ("    handshake_hook_timer. : %p", HOOK_CONNECT(hook, handshake_hook_timer));
     log_printf ("    handshake_fd_flags. . : %d", HOOK_CONNECT(hook, handshake_fd_flags));
     log_printf ("    handshake_ip_address. : '%s'", HOOK_CONNECT(hook, handshake_ip_address));
+    log_printf ("    resolve . . . . . . . : %p", HOOK_CONNECT(hook, resolve));
+    log_printf ("    connect_addrs . . . . : %p", HOOK_CONNECT(hook, connect_addrs));
+    log_printf ("    connect_num_addrs . . : %d", HOOK_CONNECT(hook, connect_num_addrs));
+    log_printf ("    connect_index . . . . : %d", HOOK_CONNECT(hook, connect_index));
+    log_printf ("    connect_status. . . . : %d", HOOK_CONNECT(hook, connect_status));
+    log_printf ("    connect_sock. . . . . : %d", HOOK_CONNECT(hook, connect_sock));
     if (!hook_socketpair_ok)
     {
         for (i = 0; i < HOOK_CONNECT_MAX_SOCKETS; i++)
@@ -25,6 +25,8 @@
 
 struct t_weechat_plugin;
 struct t_infolist_item;
+struct t_network_resolve;
+struct addrinfo;
 
 #define HOOK_CONNECT(hook, var) (((struct t_hook_connect *)hook->hook_data)->var)
 
@@ -73,6 +75,13 @@ struct t_hook_connect
     struct t_hook *handshake_hook_timer; /* timer for handshake timeout     */
     int handshake_fd_flags;            /* socket flags saved for handshake  */
     char *handshake_ip_address;        /* ip address (used for handshake)   */
+    /* connection without fork (names resolved in a thread) */
+    struct t_network_resolve *resolve; /* name resolution (thread)          */
+    struct addrinfo **connect_addrs;   /* addresses to try (reordered)      */
+    int connect_num_addrs;             /* number of addresses to try        */
+    int connect_index;                 /* index of next address to try      */
+    int connect_status;                /* status of last connection attempt */
+    int connect_sock;                  /* socket being connected            */
     /* sockets used if socketpair() is NOT available */
     int sock_v4[HOOK_CONNECT_MAX_SOCKETS];  /* IPv4 sockets for connecting  */
     int sock_v6[HOOK_CONNECT_MAX_SOCKETS];  /* IPv6 sockets for connecting  */
@@ -28,17 +28,44 @@
 #include <poll.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <unistd.h>
+#ifdef HAVE_EPOLL
+#include <sys/epoll.h>
+#elif defined(HAVE_KQUEUE)
+#include <sys/types.h>
+#include <sys/event.h>
+#include <sys/time.h>
+#endif
 
 #include "../weechat.h"
 #include "../core-hook.h"
+#include "../core-hashtable.h"
 #include "../core-infolist.h"
 #include "../core-log.h"
 #include "../../gui/gui-chat.h"
+#include "../../plugins/plugin.h"
 
 
 struct pollfd *hook_fd_pollfd = NULL;  /* file descriptors for poll()       */
 int hook_fd_pollfd_count = 0;          /* number of file descriptors        */
 
+#if defined(HAVE_EPOLL) || defined(HAVE_KQUEUE)
+int hook_fd_event_fd = -1;             /* epoll/kqueue fd (-1 = use poll()) */
+int hook_fd_event_disabled = 0;        /* 1 if epoll/kqueue can not be used */
+                                       /* (poll() is used until all fd      */
+                                       /* hooks are removed)                */
+int hook_fd_event_rebuild = 0;         /* 1 if interest set must be rebuilt */
+int hook_fd_event_removed = 0;         /* number of fd removed (detects     */
+                                       /* events for hooks just removed)    */
+struct t_hashtable *hook_fd_hashtable = NULL; /* fd -> hook                 */
+#ifdef HAVE_EPOLL
+struct epoll_event *hook_fd_events = NULL; /* events returned by epoll     */
+#else
+struct kevent *hook_fd_events = NULL;  /* events returned by kqueue         */
+#endif
+int hook_fd_events_size = 0;           /* size of array hook_fd_events      */
+#endif
+
 
 /*
  * Returns description of hook.
@@ -119,6 +146,271 @@ hook_fd_realloc_pollfd ()
     hook_fd_pollfd_count = count;
 }
 
+#if defined(HAVE_EPOLL) || defined(HAVE_KQUEUE)
+
+/*
+ * Reallocates the array of events returned by epoll/kqueue.
+ */
+
+void
+hook_fd_event_realloc ()
+{
+    void *ptr_events;
+    int size;
+
+    /* with kqueue, read and write are two different events */
+#ifdef HAVE_EPOLL
+    size = hooks_count[HOOK_TYPE_FD];
+#else
+    size = hooks_count[HOOK_TYPE_FD] * 2;
+#endif
+
+    if (size == hook_fd_events_size)
+        return;
+
+    if (size == 0)
+    {
+        free (hook_fd_events);
+        hook_fd_events = NULL;
+    }
+    else
+    {
+        ptr_events = realloc (hook_fd_events, size * sizeof (*hook_fd_events));
+        if (!ptr_events)
+            return;
+        hook_fd_events = ptr_events;
+    }
+
+    hook_fd_events_size = size;
+}
+
+/*
+ * Registers a fd hook in the epoll/kqueue interest set.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (errno is set)
+ */
+
+int
+hook_fd_event_register (struct t_hook *hook)
+{
+#ifdef HAVE_EPOLL
+    struct epoll_event event;
+
+    memset (&event, 0, sizeof (event));
+    if (HOOK_FD(hook, flags) & HOOK_FD_FLAG_READ)
+        event.events |= EPOLLIN;
+    if (HOOK_FD(hook, flags) & HOOK_FD_FLAG_WRITE)
+        event.events |= EPOLLOUT;
+    event.data.fd = HOOK_FD(hook, fd);
+
+    if (epoll_ctl (hook_fd_event_fd, EPOLL_CTL_ADD,
+                   HOOK_FD(hook, fd), &event) == 0)
+    {
+        return 1;
+    }
+    /* fd still registered by a hook deleted but not yet freed */
+    if ((errno == EEXIST)
+        && (epoll_ctl (hook_fd_event_fd, EPOLL_CTL_MOD,
+                       HOOK_FD(hook, fd), &event) == 0))
+    {
+        return 1;
+    }
+    return 0;
+#else
+    struct kevent events[2];
+    int num_events;
+
+    num_events = 0;
+    if (HOOK_FD(hook, flags) & HOOK_FD_FLAG_READ)
+    {
+        EV_SET(&events[num_events], HOOK_FD(hook, fd), EVFILT_READ,
+               EV_ADD, 0, 0, NULL);
+        num_events++;
+    }
+    if (HOOK_FD(hook, flags) & HOOK_FD_FLAG_WRITE)
+    {
+        EV_SET(&events[num_events], HOOK_FD(hook, fd), EVFILT_WRITE,
+               EV_ADD, 0, 0, NULL);
+        num_events++;
+    }
+    if (num_events == 0)
+        return 1;
+
+    return (kevent (hook_fd_event_fd, events, num_events,
+                    NULL, 0, NULL) == 0) ? 1 : 0;
+#endif
+}
+
+/*
+ * Removes a fd hook from the epoll/kqueue interest set.
+ *
+ * Errors are ignored: if the fd has already been closed, the kernel has
+ * already removed it from the interest set.
+ */
+
+void
+hook_fd_event_unregister (struct t_hook *hook)
+{
+#ifdef HAVE_EPOLL
+    struct epoll_event event;
+
+    memset (&event, 0, sizeof (event));
+    (void) epoll_ctl (hook_fd_event_fd, EPOLL_CTL_DEL,
+                      HOOK_FD(hook, fd), &event);
+#else
+    struct kevent events[2];
+    int num_events;
+
+    num_events = 0;
+    if (HOOK_FD(hook, flags) & HOOK_FD_FLAG_READ)
+    {
+        EV_SET(&events[num_events], HOOK_FD(hook, fd), EVFILT_READ,
+               EV_DELETE, 0, 0, NULL);
+        num_events++;
+    }
+    if (HOOK_FD(hook, flags) & HOOK_FD_FLAG_WRITE)
+    {
+        EV_SET(&events[num_events], HOOK_FD(hook, fd), EVFILT_WRITE,
+               EV_DELETE, 0, 0, NULL);
+        num_events++;
+    }
+    if (num_events > 0)
+        (void) kevent (hook_fd_event_fd, events, num_events, NULL, 0, NULL);
+#endif
+}
+
+/*
+ * Closes the epoll/kqueue fd and frees the data used by this backend.
+ */
+
+void
+hook_fd_event_end ()
+{
+    if (hook_fd_event_fd >= 0)
+    {
+        close (hook_fd_event_fd);
+        hook_fd_event_fd = -1;
+    }
+    if (hook_fd_hashtable)
+    {
+        hashtable_free (hook_fd_hashtable);
+        hook_fd_hashtable = NULL;
+    }
+    free (hook_fd_events);
+    hook_fd_events = NULL;
+    hook_fd_events_size = 0;
+    hook_fd_event_rebuild = 0;
+}
+
+/*
+ * Adds a fd hook to the epoll/kqueue backend.
+ *
+ * If the fd can not be watched by epoll/kqueue (for example a regular file
+ * with epoll), the backend is disabled and poll() is used instead, until
+ * all fd hooks are removed.
+ */
+
+void
+hook_fd_event_add (struct t_hook *hook)
+{
+    if (hook_fd_event_disabled)
+        return;
+
+    if (hook_fd_event_fd < 0)
+    {
+#ifdef HAVE_EPOLL
+        hook_fd_event_fd = epoll_create1 (EPOLL_CLOEXEC);
+#else
+        hook_fd_event_fd = kqueue ();
+        if (hook_fd_event_fd >= 0)
+            (void) fcntl (hook_fd_event_fd, F_SETFD, FD_CLOEXEC);
+#endif
+        if (hook_fd_event_fd < 0)
+        {
+            hook_fd_event_disabled = 1;
+            return;
+        }
+        hook_fd_hashtable = hashtable_new (32,
+                                           WEECHAT_HASHTABLE_INTEGER,
+                                           WEECHAT_HASHTABLE_POINTER,
+                                           NULL, NULL);
+        if (!hook_fd_hashtable)
+        {
+            hook_fd_event_end ();
+            hook_fd_event_disabled = 1;
+            return;
+        }
+    }
+
+    hook_fd_event_realloc ();
+
+    if (!hook_fd_event_register (hook))
+    {
+        if (errno == EBADF)
+        {
+            HOOK_FD(hook, error) = errno;
+            gui_chat_printf (NULL,
+                             _("%sBad file descriptor (%d) used in "
+                               "hook_fd"),
+                             gui_chat_prefix[GUI_CHAT_PREFIX_ERROR],
+                             HOOK_FD(hook, fd));
+        }
+        else
+        {
+            /* fd not supported by epoll/kqueue: fallback to poll() */
+            hook_fd_event_end ();
+            hook_fd_event_disabled = 1;
+            return;
+        }
+    }
+
+    hashtable_set (hook_fd_hashtable, &(HOOK_FD(hook, fd)), hook);
+}
+
+/*
+ * Removes a fd hook from the epoll/kqueue backend.
+ */
+
+void
+hook_fd_event_remove (struct t_hook *hook)
+{
+    if (hook_fd_event_fd < 0)
+        return;
+
+    hook_fd_event_unregister (hook);
+    hook_fd_event_removed++;
+
+    if (hashtable_get (hook_fd_hashtable, &(HOOK_FD(hook, fd))) == hook)
+        hashtable_remove (hook_fd_hashtable, &(HOOK_FD(hook, fd)));
+}
+
+/*
+ * Rebuilds the epoll/kqueue interest set with all fd hooks.
+ *
+ * This is done when an event is received for a fd which is not hooked any
+ * more (the fd was closed before being unhooked while another process still
+ * has it open, so the kernel can not remove it from the interest set).
+ */
+
+void
+hook_fd_event_rebuild_interest_set ()
+{
+    struct t_hook *ptr_hook;
+
+    hook_fd_event_end ();
+
+    for (ptr_hook = weechat_hooks[HOOK_TYPE_FD]; ptr_hook;
+         ptr_hook = ptr_hook->next_hook)
+    {
+        if (!ptr_hook->deleted)
+            hook_fd_event_add (ptr_hook);
+    }
+}
+
+#endif /* HAVE_EPOLL || HAVE_KQUEUE */
+
 /*
  * Callback called when a fd hook is added in the list of hooks.
  */
@@ -126,10 +418,14 @@ hook_fd_realloc_pollfd ()
 void
 hook_fd_add_cb (struct t_hook *hook)
 {
+    hook_fd_realloc_pollfd ();
+
+#if defined(HAVE_EPOLL) || defined(HAVE_KQUEUE)
+    hook_fd_event_add (hook);
+#else
     /* make C compiler happy */
     (void) hook;
-
-    hook_fd_realloc_pollfd ();
+#endif
 }
 
 /*
@@ -143,6 +439,19 @@ hook_fd_remove_cb (struct t_hook *hook)
     (void) hook;
 
     hook_fd_realloc_pollfd ();
+
+#if defined(HAVE_EPOLL) || defined(HAVE_KQUEUE)
+    if (hooks_count[HOOK_TYPE_FD] == 0)
+    {
+        /* no more fd hooks: next hook will try again epoll/kqueue */
+        hook_fd_event_end ();
+        hook_fd_event_disabled = 0;
+    }
+    else
+    {
+        hook_fd_event_realloc ();
+    }
+#endif
 }
 
 /*
@@ -194,9 +503,165 @@ hook_fd (struct t_weechat_plugin *plugin, int fd, int flag_read,
     return new_hook;
 }
 
+/*
+ * Sets a flag of a fd hook: property is "flag_read", "flag_write" or
+ * "flag_exception" and value is "1" (set flag) or "0" (remove flag).
+ *
+ * If epoll/kqueue is used, the interest set is immediately updated.
+ */
+
+void
+hook_fd_set (struct t_hook *hook, const char *property, const char *value)
+{
+    char *error;
+    long number;
+    int flag, new_flags;
+
+    if (!hook || hook->deleted || (hook->type != HOOK_TYPE_FD)
+        || !property || !value)
+    {
+        return;
+    }
+
+    if (strcmp (property, "flag_read") == 0)
+        flag = HOOK_FD_FLAG_READ;
+    else if (strcmp (property, "flag_write") == 0)
+        flag = HOOK_FD_FLAG_WRITE;
+    else if (strcmp (property, "flag_exception") == 0)
+        flag = HOOK_FD_FLAG_EXCEPTION;
+    else
+        return;
+
+    error = NULL;
+    number = strtol (value, &error, 10);
+    if (!error || error[0])
+        return;
+
+    new_flags = (number) ?
+        HOOK_FD(hook, flags) | flag : HOOK_FD(hook, flags) & ~flag;
+    if (new_flags == HOOK_FD(hook, flags))
+        return;
+
+#if defined(HAVE_EPOLL) || defined(HAVE_KQUEUE)
+    if ((hook_fd_event_fd >= 0)
+        && (hashtable_get (hook_fd_hashtable, &(HOOK_FD(hook, fd))) == hook))
+    {
+        hook_fd_event_unregister (hook);
+        HOOK_FD(hook, flags) = new_flags;
+        if (!hook_fd_event_register (hook))
+        {
+            /* fd can not be watched any more: fallback to poll() */
+            hook_fd_event_end ();
+            hook_fd_event_disabled = 1;
+        }
+        return;
+    }
+#endif
+
+    HOOK_FD(hook, flags) = new_flags;
+}
+
+#if defined(HAVE_EPOLL) || defined(HAVE_KQUEUE)
+
+/*
+ * Waits for events with epoll/kqueue and calls the callbacks of fd hooks
+ * with activity.
+ */
+
+void
+hook_fd_exec_event (int timeout)
+{
+    struct t_hook *ptr_hook;
+    struct t_hook_exec_cb hook_exec_cb;
+    int i, j, fd, ready, duplicate, removed;
+#ifdef HAVE_KQUEUE
+    struct timespec ts_timeout;
+#endif
+
+    if (hook_fd_event_rebuild)
+        hook_fd_event_rebuild_interest_set ();
+
+    if ((hook_fd_event_fd < 0) || (hook_fd_events_size == 0))
+        return;
+
+#ifdef HAVE_EPOLL
+    ready = epoll_wait (hook_fd_event_fd, hook_fd_events, hook_fd_events_size,
+                        timeout);
+#else
+    ts_timeout.tv_sec = timeout / 1000;
+    ts_timeout.tv_nsec = (timeout % 1000) * 1000000;
+    ready = kevent (hook_fd_event_fd, NULL, 0,
+                    hook_fd_events, hook_fd_events_size, &ts_timeout);
+#endif
+    if (ready <= 0)
+        return;
+
+    /* execute callbacks for file descriptors with activity */
+    hook_exec_start ();
+
+    removed = hook_fd_event_removed;
+
+    for (i = 0; i < ready; i++)
+    {
+        /* backend disabled by a callback: poll() is used on next call */
+        if (hook_fd_event_fd < 0)
+            break;
+
+#ifdef HAVE_EPOLL
+        fd = hook_fd_events[i].data.fd;
+#else
+        fd = (int)hook_fd_events[i].ident;
+#endif
+
+        /* callback is called only once per fd (kqueue: read + write) */
+        duplicate = 0;
+        for (j = 0; j < i; j++)
+        {
+#ifdef HAVE_EPOLL
+            if (hook_fd_events[j].data.fd == fd)
+#else
+            if ((int)hook_fd_events[j].ident == fd)
+#endif
+            {
+                duplicate = 1;
+                break;
+            }
+        }
+        if (duplicate)
+            continue;
+
+        ptr_hook = hashtable_get (hook_fd_hashtable, &fd);
+        if (!ptr_hook)
+        {
+            /*
+             * event for a fd not hooked: if no fd was unhooked by a callback
+             * in this loop, the interest set is not valid any more
+             */
+            if (removed == hook_fd_event_removed)
+                hook_fd_event_rebuild = 1;
+            continue;
+        }
+
+        if (!ptr_hook->deleted && !ptr_hook->running)
+        {
+            hook_callback_start (ptr_hook, &hook_exec_cb);
+            (void) (HOOK_FD(ptr_hook, callback)) (
+                ptr_hook->callback_pointer,
+                ptr_hook->callback_data,
+                HOOK_FD(ptr_hook, fd));
+            hook_callback_end (ptr_hook, &hook_exec_cb);
+        }
+    }
+
+    hook_exec_end ();
+}
+
+#endif /* HAVE_EPOLL || HAVE_KQUEUE */
+
 /*
  * Executes fd hooks:
- * - poll() on fie descriptors
+ * - wait for events with epoll/kqueue (if available) or poll() on file
+ *   descriptors
  * - call of hook fd callbacks if needed.
  */
 
@@ -210,6 +675,18 @@ hook_fd_exec ()
     if (!weechat_hooks[HOOK_TYPE_FD])
         return;
 
+    timeout = hook_timer_get_time_to_next ();
+    if (hook_process_pending)
+        timeout = 0;
+
+#if defined(HAVE_EPOLL) || defined(HAVE_KQUEUE)
+    if ((hook_fd_event_fd >= 0) || hook_fd_event_rebuild)
+    {
+        hook_fd_exec_event (timeout);
+        return;
+    }
+#endif
+
     /* build an array of "struct pollfd" for poll() */
     num_fd = 0;
     for (ptr_hook = weechat_hooks[HOOK_TYPE_FD]; ptr_hook;
@@ -250,9 +727,6 @@ hook_fd_exec ()
     }
 
     /* perform the poll() */
-    timeout = hook_timer_get_time_to_next ();
-    if (hook_process_pending)
-        timeout = 0;
     ready = poll (hook_fd_pollfd, num_fd, timeout);
     if (ready <= 0)
         return;
@@ -305,6 +779,11 @@ hook_fd_free_data (struct t_hook *hook)
     if (!hook || !hook->hook_data)
         return;
 
+#if defined(HAVE_EPOLL) || defined(HAVE_KQUEUE)
+    /* remove fd from interest set now: it may be closed after unhook */
+    hook_fd_event_remove (hook);
+#endif
+
     free (hook->hook_data);
     hook->hook_data = NULL;
 }
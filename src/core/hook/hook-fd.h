@@ -50,6 +50,8 @@ extern struct t_hook *hook_fd (struct t_weechat_plugin *plugin, int fd,
                                t_hook_callback_fd *callback,
                                const void *callback_pointer,
                                void *callback_data);
+extern void hook_fd_set (struct t_hook *hook, const char *property,
+                         const char *value);
 extern void hook_fd_exec ();
 extern void hook_fd_free_data (struct t_hook *hook);
 extern int hook_fd_add_to_infolist (struct t_infolist_item *item,
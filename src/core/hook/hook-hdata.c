@@ -27,6 +27,7 @@
 #include <string.h>
 
 #include "../weechat.h"
+#include "../core-arraylist.h"
 #include "../core-hashtable.h"
 #include "../core-hdata.h"
 #include "../core-hook.h"
@@ -91,6 +92,8 @@ hook_hdata (struct t_weechat_plugin *plugin, const char *hdata_name,
 
     hook_add_to_list (new_hook);
 
+    hook_index_name_add (new_hook, new_hook_hdata->hdata_name);
+
     return new_hook;
 }
 
@@ -101,9 +104,11 @@ hook_hdata (struct t_weechat_plugin *plugin, const char *hdata_name,
 struct t_hdata *
 hook_hdata_get (struct t_weechat_plugin *plugin, const char *hdata_name)
 {
-    struct t_hook *ptr_hook, *next_hook;
+    struct t_hook *ptr_hook;
+    struct t_arraylist *ptr_list;
     struct t_hook_exec_cb hook_exec_cb;
     struct t_hdata *value;
+    int i, size;
 
     /* make C compiler happy */
     (void) plugin;
@@ -120,14 +125,12 @@ hook_hdata_get (struct t_weechat_plugin *plugin, const char *hdata_name)
 
     hook_exec_start ();
 
-    ptr_hook = weechat_hooks[HOOK_TYPE_HDATA];
-    while (ptr_hook)
+    ptr_list = hook_index_name_get (HOOK_TYPE_HDATA, hdata_name);
+    size = arraylist_size (ptr_list);
+    for (i = 0; i < size; i++)
     {
-        next_hook = ptr_hook->next_hook;
-
-        if (!ptr_hook->deleted
-            && !ptr_hook->running
-            && (strcmp (HOOK_HDATA(ptr_hook, hdata_name), hdata_name) == 0))
+        ptr_hook = (struct t_hook *)arraylist_get (ptr_list, i);
+        if (!ptr_hook->deleted && !ptr_hook->running)
         {
             hook_callback_start (ptr_hook, &hook_exec_cb);
             value = (HOOK_HDATA(ptr_hook, callback))
@@ -139,8 +142,6 @@ hook_hdata_get (struct t_weechat_plugin *plugin, const char *hdata_name)
             hook_exec_end ();
             return value;
         }
-
-        ptr_hook = next_hook;
     }
 
     hook_exec_end ();
@@ -161,6 +162,7 @@ hook_hdata_free_data (struct t_hook *hook)
 
     if (HOOK_HDATA(hook, hdata_name))
     {
+        hook_index_name_remove (hook, HOOK_HDATA(hook, hdata_name));
         free (HOOK_HDATA(hook, hdata_name));
         HOOK_HDATA(hook, hdata_name) = NULL;
     }
@@ -22,6 +22,7 @@
 
 struct t_weechat_plugin;
 struct t_infolist_item;
+struct t_string_mask;
 
 #define HOOK_HSIGNAL(hook, var) (((struct t_hook_hsignal *)hook->hook_data)->var)
 
@@ -36,6 +37,9 @@ struct t_hook_hsignal
                                        /* begin or end with "*",            */
                                        /* "*" == any signal                 */
     int num_signals;                   /* number of signals                 */
+    struct t_string_mask **masks;      /* compiled signals (num_signals)    */
+    unsigned long long seq;            /* order of creation (used to sort   */
+                                       /* hooks in index)                   */
 };
 
 extern char *hook_hsignal_get_description (struct t_hook *hook);
@@ -44,6 +48,7 @@ extern struct t_hook *hook_hsignal (struct t_weechat_plugin *plugin,
                                     t_hook_callback_hsignal *callback,
                                     const void *callback_pointer,
                                     void *callback_data);
+extern int hook_hsignal_has_hooks (const char *signal);
 extern int hook_hsignal_send (const char *signal,
                               struct t_hashtable *hashtable);
 extern void hook_hsignal_free_data (struct t_hook *hook);
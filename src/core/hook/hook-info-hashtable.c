@@ -27,6 +27,7 @@
 #include <string.h>
 
 #include "../weechat.h"
+#include "../core-arraylist.h"
 #include "../core-hook.h"
 #include "../core-infolist.h"
 #include "../core-log.h"
@@ -94,6 +95,8 @@ hook_info_hashtable (struct t_weechat_plugin *plugin, const char *info_name,
 
     hook_add_to_list (new_hook);
 
+    hook_index_name_add (new_hook, new_hook_info_hashtable->info_name);
+
     return new_hook;
 }
 
@@ -105,9 +108,11 @@ struct t_hashtable *
 hook_info_get_hashtable (struct t_weechat_plugin *plugin, const char *info_name,
                          struct t_hashtable *hashtable)
 {
-    struct t_hook *ptr_hook, *next_hook;
+    struct t_hook *ptr_hook;
+    struct t_arraylist *ptr_list;
     struct t_hook_exec_cb hook_exec_cb;
     struct t_hashtable *value;
+    int i, size;
 
     /* make C compiler happy */
     (void) plugin;
@@ -117,14 +122,12 @@ hook_info_get_hashtable (struct t_weechat_plugin *plugin, const char *info_name,
 
     hook_exec_start ();
 
-    ptr_hook = weechat_hooks[HOOK_TYPE_INFO_HASHTABLE];
-    while (ptr_hook)
+    ptr_list = hook_index_name_get (HOOK_TYPE_INFO_HASHTABLE, info_name);
+    size = arraylist_size (ptr_list);
+    for (i = 0; i < size; i++)
     {
-        next_hook = ptr_hook->next_hook;
-
-        if (!ptr_hook->deleted
-            && !ptr_hook->running
-            && (strcmp (HOOK_INFO_HASHTABLE(ptr_hook, info_name), info_name) == 0))
+        ptr_hook = (struct t_hook *)arraylist_get (ptr_list, i);
+        if (!ptr_hook->deleted && !ptr_hook->running)
         {
             hook_callback_start (ptr_hook, &hook_exec_cb);
             value = (HOOK_INFO_HASHTABLE(ptr_hook, callback))
@@ -137,8 +140,6 @@ hook_info_get_hashtable (struct t_weechat_plugin *plugin, const char *info_name,
             hook_exec_end ();
             return value;
         }
-
-        ptr_hook = next_hook;
     }
 
     hook_exec_end ();
@@ -159,6 +160,7 @@ hook_info_hashtable_free_data (struct t_hook *hook)
 
     if (HOOK_INFO_HASHTABLE(hook, info_name))
     {
+        hook_index_name_remove (hook, HOOK_INFO_HASHTABLE(hook, info_name));
         free (HOOK_INFO_HASHTABLE(hook, info_name));
         HOOK_INFO_HASHTABLE(hook, info_name) = NULL;
     }
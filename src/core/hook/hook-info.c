@@ -27,10 +27,13 @@
 #include <string.h>
 
 #include "../weechat.h"
+#include "../core-arraylist.h"
+#include "../core-hashtable.h"
 #include "../core-hook.h"
 #include "../core-infolist.h"
 #include "../core-log.h"
 #include "../core-string.h"
+#include "../../plugins/plugin.h"
 
 
 /*
@@ -88,9 +91,14 @@ hook_info (struct t_weechat_plugin *plugin, const char *info_name,
     new_hook_info->description = strdup ((description) ? description : "");
     new_hook_info->args_description = strdup ((args_description) ?
                                               args_description : "");
+    new_hook_info->cache = NULL;
+    new_hook_info->hooks_cache = NULL;
+    new_hook_info->num_hooks_cache = 0;
 
     hook_add_to_list (new_hook);
 
+    hook_index_name_add (new_hook, new_hook_info->info_name);
+
     return new_hook;
 }
 
@@ -104,9 +112,13 @@ char *
 hook_info_get (struct t_weechat_plugin *plugin, const char *info_name,
                const char *arguments)
 {
-    struct t_hook *ptr_hook, *next_hook;
+    struct t_hook *ptr_hook;
+    struct t_arraylist *ptr_list;
+    struct t_hashtable *ptr_cache;
     struct t_hook_exec_cb hook_exec_cb;
+    const char *ptr_value;
     char *value;
+    int i, size;
 
     /* make C compiler happy */
     (void) plugin;
@@ -116,15 +128,23 @@ hook_info_get (struct t_weechat_plugin *plugin, const char *info_name,
 
     hook_exec_start ();
 
-    ptr_hook = weechat_hooks[HOOK_TYPE_INFO];
-    while (ptr_hook)
+    ptr_list = hook_index_name_get (HOOK_TYPE_INFO, info_name);
+    size = arraylist_size (ptr_list);
+    for (i = 0; i < size; i++)
     {
-        next_hook = ptr_hook->next_hook;
-
-        if (!ptr_hook->deleted
-            && !ptr_hook->running
-            && (strcmp (HOOK_INFO(ptr_hook, info_name), info_name) == 0))
+        ptr_hook = (struct t_hook *)arraylist_get (ptr_list, i);
+        if (!ptr_hook->deleted && !ptr_hook->running)
         {
+            ptr_cache = HOOK_INFO(ptr_hook, cache);
+            if (ptr_cache
+                && hashtable_has_key (ptr_cache, (arguments) ? arguments : ""))
+            {
+                ptr_value = hashtable_get (ptr_cache,
+                                           (arguments) ? arguments : "");
+                hook_exec_end ();
+                return (ptr_value) ? strdup (ptr_value) : NULL;
+            }
+
             hook_callback_start (ptr_hook, &hook_exec_cb);
             value = (HOOK_INFO(ptr_hook, callback))
                 (ptr_hook->callback_pointer,
@@ -133,11 +153,18 @@ hook_info_get (struct t_weechat_plugin *plugin, const char *info_name,
                  arguments);
             hook_callback_end (ptr_hook, &hook_exec_cb);
 
+            /* the callback may have disabled the cache */
+            ptr_cache = HOOK_INFO(ptr_hook, cache);
+            if (ptr_cache)
+            {
+                if (ptr_cache->items_count >= HOOK_INFO_CACHE_MAX)
+                    hashtable_remove_all (ptr_cache);
+                hashtable_set (ptr_cache, (arguments) ? arguments : "", value);
+            }
+
             hook_exec_end ();
             return value;
         }
-
-        ptr_hook = next_hook;
     }
 
     hook_exec_end ();
@@ -146,6 +173,180 @@ hook_info_get (struct t_weechat_plugin *plugin, const char *info_name,
     return NULL;
 }
 
+/*
+ * Callback for signals and options clearing the cache of an info.
+ */
+
+int
+hook_info_cache_signal_cb (const void *pointer, void *data,
+                           const char *signal, const char *type_data,
+                           void *signal_data)
+{
+    struct t_hook *hook;
+
+    /* make C compiler happy */
+    (void) data;
+    (void) signal;
+    (void) type_data;
+    (void) signal_data;
+
+    hook = (struct t_hook *)pointer;
+
+    if (hook->hook_data && HOOK_INFO(hook, cache))
+        hashtable_remove_all (HOOK_INFO(hook, cache));
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Callback for options clearing the cache of an info.
+ */
+
+int
+hook_info_cache_config_cb (const void *pointer, void *data,
+                           const char *option, const char *value)
+{
+    /* make C compiler happy */
+    (void) value;
+
+    return hook_info_cache_signal_cb (pointer, data, option, NULL, NULL);
+}
+
+/*
+ * Adds a hook clearing the cache of an info.
+ */
+
+void
+hook_info_cache_add_hook (struct t_hook *hook, struct t_hook *new_hook)
+{
+    struct t_hook **new_hooks;
+
+    if (!new_hook)
+        return;
+
+    new_hooks = realloc (HOOK_INFO(hook, hooks_cache),
+                         (HOOK_INFO(hook, num_hooks_cache) + 1)
+                         * sizeof (HOOK_INFO(hook, hooks_cache)[0]));
+    if (!new_hooks)
+    {
+        unhook (new_hook);
+        return;
+    }
+    HOOK_INFO(hook, hooks_cache) = new_hooks;
+    HOOK_INFO(hook, hooks_cache)[HOOK_INFO(hook, num_hooks_cache)] = new_hook;
+    HOOK_INFO(hook, num_hooks_cache)++;
+}
+
+/*
+ * Enables the cache of an info (if not already enabled).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+hook_info_cache_enable (struct t_hook *hook)
+{
+    if (HOOK_INFO(hook, cache))
+        return 1;
+
+    HOOK_INFO(hook, cache) = hashtable_new (64,
+                                            WEECHAT_HASHTABLE_STRING,
+                                            WEECHAT_HASHTABLE_STRING,
+                                            NULL, NULL);
+    return (HOOK_INFO(hook, cache)) ? 1 : 0;
+}
+
+/*
+ * Disables the cache of an info: unhooks signals/options clearing the cache
+ * and frees the cache.
+ */
+
+void
+hook_info_cache_disable (struct t_hook *hook)
+{
+    int i;
+
+    for (i = 0; i < HOOK_INFO(hook, num_hooks_cache); i++)
+    {
+        unhook (HOOK_INFO(hook, hooks_cache)[i]);
+    }
+    free (HOOK_INFO(hook, hooks_cache));
+    HOOK_INFO(hook, hooks_cache) = NULL;
+    HOOK_INFO(hook, num_hooks_cache) = 0;
+
+    hashtable_free (HOOK_INFO(hook, cache));
+    HOOK_INFO(hook, cache) = NULL;
+}
+
+/*
+ * Sets an info hook property (string).
+ *
+ * Properties:
+ *   cache_signal: enable cache of values, cleared when one of these signals
+ *                 is sent (signals separated by ";", wildcard "*" allowed)
+ *   cache_config: enable cache of values, cleared when one of these options
+ *                 is changed (options separated by ";", wildcard "*" allowed)
+ *   cache_clear: clear the cache (value is ignored)
+ *   cache: "0" to disable the cache
+ *
+ * The info hook must return the same value for same arguments until one of
+ * the signals is sent or one of the options is changed.
+ */
+
+void
+hook_info_set (struct t_hook *hook, const char *property, const char *value)
+{
+    char **items;
+    int i, num_items;
+
+    if (!hook || hook->deleted || (hook->type != HOOK_TYPE_INFO)
+        || !property || !value)
+    {
+        return;
+    }
+
+    if (strcmp (property, "cache_signal") == 0)
+    {
+        if (value[0] && hook_info_cache_enable (hook))
+        {
+            hook_info_cache_add_hook (
+                hook,
+                hook_signal (NULL, value, &hook_info_cache_signal_cb,
+                             hook, NULL));
+        }
+    }
+    else if (strcmp (property, "cache_config") == 0)
+    {
+        if (!value[0] || !hook_info_cache_enable (hook))
+            return;
+        items = string_split (value, ";", NULL,
+                              WEECHAT_STRING_SPLIT_STRIP_LEFT
+                              | WEECHAT_STRING_SPLIT_STRIP_RIGHT
+                              | WEECHAT_STRING_SPLIT_COLLAPSE_SEPS,
+                              0, &num_items);
+        for (i = 0; items && (i < num_items); i++)
+        {
+            hook_info_cache_add_hook (
+                hook,
+                hook_config (NULL, items[i], &hook_info_cache_config_cb,
+                             hook, NULL));
+        }
+        string_free_split (items);
+    }
+    else if (strcmp (property, "cache_clear") == 0)
+    {
+        if (HOOK_INFO(hook, cache))
+            hashtable_remove_all (HOOK_INFO(hook, cache));
+    }
+    else if (strcmp (property, "cache") == 0)
+    {
+        if (strcmp (value, "0") == 0)
+            hook_info_cache_disable (hook);
+    }
+}
+
 /*
  * Frees data in an info hook.
  */
@@ -158,6 +359,7 @@ hook_info_free_data (struct t_hook *hook)
 
     if (HOOK_INFO(hook, info_name))
     {
+        hook_index_name_remove (hook, HOOK_INFO(hook, info_name));
         free (HOOK_INFO(hook, info_name));
         HOOK_INFO(hook, info_name) = NULL;
     }
@@ -171,6 +373,7 @@ hook_info_free_data (struct t_hook *hook)
         free (HOOK_INFO(hook, args_description));
         HOOK_INFO(hook, args_description) = NULL;
     }
+    hook_info_cache_disable (hook);
 
     free (hook->hook_data);
     hook->hook_data = NULL;
@@ -225,4 +428,9 @@ hook_info_print_log (struct t_hook *hook)
     log_printf ("    info_name . . . . . . : '%s'", HOOK_INFO(hook, info_name));
     log_printf ("    description . . . . . : '%s'", HOOK_INFO(hook, description));
     log_printf ("    args_description. . . : '%s'", HOOK_INFO(hook, args_description));
+    log_printf ("    cache . . . . . . . . : %p (items: %d)",
+                HOOK_INFO(hook, cache),
+                (HOOK_INFO(hook, cache)) ? HOOK_INFO(hook, cache)->items_count : 0);
+    log_printf ("    hooks_cache . . . . . : %p", HOOK_INFO(hook, hooks_cache));
+    log_printf ("    num_hooks_cache . . . : %d", HOOK_INFO(hook, num_hooks_cache));
 }
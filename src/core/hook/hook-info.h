@@ -22,9 +22,13 @@
 
 struct t_weechat_plugin;
 struct t_infolist_item;
+struct t_hashtable;
 
 #define HOOK_INFO(hook, var) (((struct t_hook_info *)hook->hook_data)->var)
 
+/* max number of values in cache of an info (cache is cleared when full) */
+#define HOOK_INFO_CACHE_MAX 4096
+
 typedef char *(t_hook_callback_info)(const void *pointer, void *data,
                                      const char *info_name,
                                      const char *arguments);
@@ -35,6 +39,10 @@ struct t_hook_info
     char *info_name;                   /* name of info returned             */
     char *description;                 /* description                       */
     char *args_description;            /* description of arguments          */
+    struct t_hashtable *cache;         /* cache: arguments -> value         */
+                                       /* (NULL if info is not cached)      */
+    struct t_hook **hooks_cache;       /* signal/config hooks clearing cache*/
+    int num_hooks_cache;               /* number of hooks clearing cache    */
 };
 
 extern char *hook_info_get_description (struct t_hook *hook);
@@ -48,6 +56,8 @@ extern struct t_hook *hook_info (struct t_weechat_plugin *plugin,
 extern char *hook_info_get (struct t_weechat_plugin *plugin,
                             const char *info_name,
                             const char *arguments);
+extern void hook_info_set (struct t_hook *hook, const char *property,
+                           const char *value);
 extern void hook_info_free_data (struct t_hook *hook);
 extern int hook_info_add_to_infolist (struct t_infolist_item *item,
                                       struct t_hook *hook);
@@ -27,6 +27,7 @@
 #include <string.h>
 
 #include "../weechat.h"
+#include "../core-arraylist.h"
 #include "../core-hook.h"
 #include "../core-infolist.h"
 #include "../core-log.h"
@@ -94,6 +95,8 @@ hook_infolist (struct t_weechat_plugin *plugin, const char *infolist_name,
 
     hook_add_to_list (new_hook);
 
+    hook_index_name_add (new_hook, new_hook_infolist->infolist_name);
+
     return new_hook;
 }
 
@@ -105,9 +108,11 @@ struct t_infolist *
 hook_infolist_get (struct t_weechat_plugin *plugin, const char *infolist_name,
                    void *pointer, const char *arguments)
 {
-    struct t_hook *ptr_hook, *next_hook;
+    struct t_hook *ptr_hook;
+    struct t_arraylist *ptr_list;
     struct t_hook_exec_cb hook_exec_cb;
     struct t_infolist *value;
+    int i, size;
 
     /* make C compiler happy */
     (void) plugin;
@@ -117,14 +122,12 @@ hook_infolist_get (struct t_weechat_plugin *plugin, const char *infolist_name,
 
     hook_exec_start ();
 
-    ptr_hook = weechat_hooks[HOOK_TYPE_INFOLIST];
-    while (ptr_hook)
+    ptr_list = hook_index_name_get (HOOK_TYPE_INFOLIST, infolist_name);
+    size = arraylist_size (ptr_list);
+    for (i = 0; i < size; i++)
     {
-        next_hook = ptr_hook->next_hook;
-
-        if (!ptr_hook->deleted
-            && !ptr_hook->running
-            && (strcmp (HOOK_INFOLIST(ptr_hook, infolist_name), infolist_name) == 0))
+        ptr_hook = (struct t_hook *)arraylist_get (ptr_list, i);
+        if (!ptr_hook->deleted && !ptr_hook->running)
         {
             hook_callback_start (ptr_hook, &hook_exec_cb);
             value = (HOOK_INFOLIST(ptr_hook, callback))
@@ -138,8 +141,6 @@ hook_infolist_get (struct t_weechat_plugin *plugin, const char *infolist_name,
             hook_exec_end ();
             return value;
         }
-
-        ptr_hook = next_hook;
     }
 
     hook_exec_end ();
@@ -160,6 +161,7 @@ hook_infolist_free_data (struct t_hook *hook)
 
     if (HOOK_INFOLIST(hook, infolist_name))
     {
+        hook_index_name_remove (hook, HOOK_INFOLIST(hook, infolist_name));
         free (HOOK_INFOLIST(hook, infolist_name));
         HOOK_INFOLIST(hook, infolist_name) = NULL;
     }
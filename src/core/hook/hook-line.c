@@ -109,6 +109,8 @@ hook_line (struct t_weechat_plugin *plugin, const char *buffer_type,
         | WEECHAT_STRING_SPLIT_COLLAPSE_SEPS,
         0,
         &new_hook_line->num_buffers);
+    new_hook_line->buffers_masks = string_mask_compile_list (
+        (const char **)new_hook_line->buffers, 0);
     new_hook_line->tags_array = string_split_tags (tags,
                                                    &new_hook_line->tags_count);
 
@@ -144,9 +146,14 @@ hook_line_exec (struct t_gui_line *line)
         if (!ptr_hook->deleted && !ptr_hook->running
             && ((HOOK_LINE(ptr_hook, buffer_type) == -1)
                 || ((int)(line->data->buffer->type) == (HOOK_LINE(ptr_hook, buffer_type))))
-            && string_match_list (line->data->buffer->full_name,
-                                  (const char **)HOOK_LINE(ptr_hook, buffers),
-                                  0)
+            && ((HOOK_LINE(ptr_hook, buffers_masks)) ?
+                string_match_list_compiled (
+                    line->data->buffer->full_name,
+                    HOOK_LINE(ptr_hook, buffers_masks)) :
+                string_match_list (
+                    line->data->buffer->full_name,
+                    (const char **)HOOK_LINE(ptr_hook, buffers),
+                    0))
             && (!HOOK_LINE(ptr_hook, tags_array)
                 || gui_line_match_tags (line->data,
                                         HOOK_LINE(ptr_hook, tags_count),
@@ -223,6 +230,11 @@ hook_line_free_data (struct t_hook *hook)
         string_free_split (HOOK_LINE(hook, buffers));
         HOOK_LINE(hook, buffers) = NULL;
     }
+    if (HOOK_LINE(hook, buffers_masks))
+    {
+        string_mask_free_list (HOOK_LINE(hook, buffers_masks));
+        HOOK_LINE(hook, buffers_masks) = NULL;
+    }
     if (HOOK_LINE(hook, tags_array))
     {
         string_free_split_tags (HOOK_LINE(hook, tags_array));
@@ -281,6 +293,7 @@ hook_line_print_log (struct t_hook *hook)
     log_printf ("    buffer_type . . . . . : %d", HOOK_LINE(hook, buffer_type));
     log_printf ("    buffers . . . . . . . : %p", HOOK_LINE(hook, buffers));
     log_printf ("    num_buffers . . . . . : %d", HOOK_LINE(hook, num_buffers));
+    log_printf ("    buffers_masks . . . . : %p", HOOK_LINE(hook, buffers_masks));
     for (i = 0; i < HOOK_LINE(hook, num_buffers); i++)
     {
         log_printf ("      buffers[%03d]. . . : '%s'",
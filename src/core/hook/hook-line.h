@@ -24,6 +24,7 @@ struct t_weechat_plugin;
 struct t_infolist_item;
 struct t_hashtable;
 struct t_gui_line;
+struct t_string_mask;
 
 #define HOOK_LINE(hook, var) (((struct t_hook_line *)hook->hook_data)->var)
 
@@ -39,6 +40,7 @@ struct t_hook_line
                                        /* hook is executed (see the         */
                                        /* function "buffer_match_list")     */
     int num_buffers;                   /* number of buffers in list         */
+    struct t_string_mask **buffers_masks; /* compiled buffer masks         */
     int tags_count;                    /* number of tags selected           */
     char ***tags_array;                /* tags selected (NULL = any)        */
 };
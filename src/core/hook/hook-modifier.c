@@ -27,10 +27,23 @@
 #include <string.h>
 
 #include "../weechat.h"
+#include "../core-arraylist.h"
+#include "../core-hashtable.h"
 #include "../core-hook.h"
 #include "../core-infolist.h"
 #include "../core-log.h"
 #include "../core-string.h"
+#include "../../plugins/plugin.h"
+
+
+/*
+ * index of modifier hooks: hashtable (modifier name -> arraylist of hooks,
+ * names are case insensitive, like signal names),
+ * arraylists are sorted like the list of hooks (priority, then order of
+ * creation)
+ */
+struct t_hashtable *hook_modifier_index = NULL;
+unsigned long long hook_modifier_seq = 0; /* counter for order of creation  */
 
 
 /*
@@ -45,6 +58,120 @@ hook_modifier_get_description (struct t_hook *hook)
     return strdup (HOOK_MODIFIER(hook, modifier));
 }
 
+/*
+ * Compares two modifier hooks in index: same order as in list of hooks
+ * (priority, then order of creation).
+ */
+
+int
+hook_modifier_index_cmp_cb (void *data, struct t_arraylist *arraylist,
+                            void *pointer1, void *pointer2)
+{
+    struct t_hook *hook1, *hook2;
+
+    /* make C compiler happy */
+    (void) data;
+    (void) arraylist;
+
+    hook1 = (struct t_hook *)pointer1;
+    hook2 = (struct t_hook *)pointer2;
+
+    if (hook1->priority != hook2->priority)
+        return (hook1->priority > hook2->priority) ? -1 : 1;
+
+    if (HOOK_MODIFIER(hook1, seq) != HOOK_MODIFIER(hook2, seq))
+        return (HOOK_MODIFIER(hook1, seq) < HOOK_MODIFIER(hook2, seq)) ? -1 : 1;
+
+    return 0;
+}
+
+/*
+ * Frees an arraylist of hooks in index.
+ */
+
+void
+hook_modifier_index_free_value_cb (struct t_hashtable *hashtable,
+                                   const void *key, void *value)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    arraylist_free ((struct t_arraylist *)value);
+}
+
+/*
+ * Adds a modifier hook in index.
+ */
+
+void
+hook_modifier_index_add (struct t_hook *hook)
+{
+    struct t_arraylist *ptr_list;
+
+    if (!hook_modifier_index)
+    {
+        hook_modifier_index = hashtable_new (
+            32,
+            WEECHAT_HASHTABLE_STRING,
+            WEECHAT_HASHTABLE_POINTER,
+            &hook_signal_hash_key_cb,
+            &hook_signal_keycmp_cb);
+        if (!hook_modifier_index)
+            return;
+        hashtable_set_pointer (hook_modifier_index,
+                               "callback_free_value",
+                               &hook_modifier_index_free_value_cb);
+    }
+
+    ptr_list = hashtable_get (hook_modifier_index,
+                              HOOK_MODIFIER(hook, modifier));
+    if (!ptr_list)
+    {
+        ptr_list = arraylist_new (4, 1, 0,
+                                  &hook_modifier_index_cmp_cb, NULL,
+                                  NULL, NULL);
+        if (!ptr_list)
+            return;
+        hashtable_set (hook_modifier_index, HOOK_MODIFIER(hook, modifier),
+                       ptr_list);
+    }
+    arraylist_add (ptr_list, hook);
+}
+
+/*
+ * Removes a modifier hook from index.
+ */
+
+void
+hook_modifier_index_remove (struct t_hook *hook)
+{
+    struct t_arraylist *ptr_list;
+    int index;
+
+    if (!hook_modifier_index || !HOOK_MODIFIER(hook, modifier))
+        return;
+
+    ptr_list = hashtable_get (hook_modifier_index,
+                              HOOK_MODIFIER(hook, modifier));
+    if (ptr_list)
+    {
+        if (arraylist_search (ptr_list, hook, &index, NULL))
+            arraylist_remove (ptr_list, index);
+        if (arraylist_size (ptr_list) == 0)
+        {
+            hashtable_remove (hook_modifier_index,
+                              HOOK_MODIFIER(hook, modifier));
+        }
+    }
+
+    if (hook_modifier_index->items_count == 0)
+    {
+        hashtable_free (hook_modifier_index);
+        hook_modifier_index = NULL;
+    }
+}
+
 /*
  * Hooks a modifier.
  *
@@ -83,15 +210,40 @@ hook_modifier (struct t_weechat_plugin *plugin, const char *modifier,
     new_hook->hook_data = new_hook_modifier;
     new_hook_modifier->callback = callback;
     new_hook_modifier->modifier = strdup ((ptr_modifier) ? ptr_modifier : modifier);
+    new_hook_modifier->seq = hook_modifier_seq++;
 
     hook_add_to_list (new_hook);
 
+    hook_modifier_index_add (new_hook);
+
     return new_hook;
 }
 
+/*
+ * Checks if a modifier is hooked (at least one hook with this modifier name).
+ *
+ * This can be used to skip the build of arguments for function
+ * hook_modifier_exec when nobody hooks the modifier.
+ *
+ * Returns:
+ *   1: modifier is hooked
+ *   0: modifier is not hooked
+ */
+
+int
+hook_modifier_hooked (const char *modifier)
+{
+    if (!modifier || !modifier[0] || !hook_modifier_index)
+        return 0;
+
+    return (hashtable_get (hook_modifier_index, modifier)) ? 1 : 0;
+}
+
 /*
  * Executes a modifier hook.
  *
+ * Hooks are searched in the index, by modifier name.
+ *
  * Note: result must be freed after use.
  */
 
@@ -99,9 +251,11 @@ char *
 hook_modifier_exec (struct t_weechat_plugin *plugin, const char *modifier,
                     const char *modifier_data, const char *string)
 {
-    struct t_hook *ptr_hook, *next_hook;
+    struct t_hook *ptr_hook, *hooks_static[64], **hooks;
     struct t_hook_exec_cb hook_exec_cb;
+    struct t_arraylist *ptr_list;
     char *new_msg, *message_modified;
+    int i, num_hooks;
 
     /* make C compiler happy */
     (void) plugin;
@@ -109,22 +263,48 @@ hook_modifier_exec (struct t_weechat_plugin *plugin, const char *modifier,
     if (!modifier || !modifier[0] || !string)
         return NULL;
 
+    ptr_list = (hook_modifier_index) ?
+        hashtable_get (hook_modifier_index, modifier) : NULL;
+    num_hooks = (ptr_list) ? arraylist_size (ptr_list) : 0;
+
+    if (num_hooks == 0)
+        return strdup (string);
+
+    /*
+     * build the list of hooks to call before calling callbacks, because
+     * callbacks can add or remove modifier hooks
+     */
+    if (num_hooks <= (int)(sizeof (hooks_static) / sizeof (hooks_static[0])))
+    {
+        hooks = hooks_static;
+    }
+    else
+    {
+        hooks = malloc (num_hooks * sizeof (*hooks));
+        if (!hooks)
+            return NULL;
+    }
+    for (i = 0; i < num_hooks; i++)
+    {
+        hooks[i] = arraylist_get (ptr_list, i);
+    }
+
     new_msg = NULL;
     message_modified = strdup (string);
     if (!message_modified)
+    {
+        if (hooks != hooks_static)
+            free (hooks);
         return NULL;
+    }
 
     hook_exec_start ();
 
-    ptr_hook = weechat_hooks[HOOK_TYPE_MODIFIER];
-    while (ptr_hook)
+    for (i = 0; i < num_hooks; i++)
     {
-        next_hook = ptr_hook->next_hook;
+        ptr_hook = hooks[i];
 
-        if (!ptr_hook->deleted
-            && !ptr_hook->running
-            && (string_strcasecmp (HOOK_MODIFIER(ptr_hook, modifier),
-                                   modifier) == 0))
+        if (!ptr_hook->deleted && !ptr_hook->running)
         {
             hook_callback_start (ptr_hook, &hook_exec_cb);
             new_msg = (HOOK_MODIFIER(ptr_hook, callback))
@@ -139,8 +319,8 @@ hook_modifier_exec (struct t_weechat_plugin *plugin, const char *modifier,
             if (new_msg && !new_msg[0])
             {
                 free (message_modified);
-                hook_exec_end ();
-                return new_msg;
+                message_modified = new_msg;
+                break;
             }
 
             /* new message => keep it as base for next modifier */
@@ -150,12 +330,13 @@ hook_modifier_exec (struct t_weechat_plugin *plugin, const char *modifier,
                 message_modified = new_msg;
             }
         }
-
-        ptr_hook = next_hook;
     }
 
     hook_exec_end ();
 
+    if (hooks != hooks_static)
+        free (hooks);
+
     return message_modified;
 }
 
@@ -169,6 +350,8 @@ hook_modifier_free_data (struct t_hook *hook)
     if (!hook || !hook->hook_data)
         return;
 
+    hook_modifier_index_remove (hook);
+
     if (HOOK_MODIFIER(hook, modifier))
     {
         free (HOOK_MODIFIER(hook, modifier));
@@ -34,6 +34,8 @@ struct t_hook_modifier
 {
     t_hook_callback_modifier *callback; /* modifier callback                */
     char *modifier;                     /* name of modifier                 */
+    unsigned long long seq;             /* order of creation (used to sort  */
+                                        /* hooks in index)                  */
 };
 
 extern char *hook_modifier_get_description (struct t_hook *hook);
@@ -42,6 +44,7 @@ extern struct t_hook *hook_modifier (struct t_weechat_plugin *plugin,
                                      t_hook_callback_modifier *callback,
                                      const void *callback_pointer,
                                      void *callback_data);
+extern int hook_modifier_hooked (const char *modifier);
 extern char *hook_modifier_exec (struct t_weechat_plugin *plugin,
                                  const char *modifier,
                                  const char *modifier_data,
@@ -113,8 +113,50 @@ hook_print (struct t_weechat_plugin *plugin, struct t_gui_buffer *buffer,
     return new_hook;
 }
 
+/*
+ * Decodes colors in prefix and message of a line (done only once for all
+ * print hooks, and only if a hook needs it).
+ *
+ * Strings without color codes are not copied: the pointers are set to the
+ * line data (updated on each call, in case a callback changed the line) and
+ * buffers are used only for strings with color codes.
+ *
+ * Returns:
+ *   1: OK (prefix and message without colors are set)
+ *   0: error
+ */
+
+int
+hook_print_decode_colors (struct t_gui_line *line, int *decoded,
+                          char ***buffer_prefix, char ***buffer_message,
+                          const char **prefix_no_color,
+                          const char **message_no_color)
+{
+    if (!*decoded)
+    {
+        *decoded = 1;
+        *prefix_no_color = gui_color_decode_buffer (line->data->prefix,
+                                                    buffer_prefix);
+        *message_no_color = gui_color_decode_buffer (line->data->message,
+                                                     buffer_message);
+    }
+    else
+    {
+        if (!*buffer_prefix)
+            *prefix_no_color = line->data->prefix;
+        if (!*buffer_message && *message_no_color)
+            *message_no_color = line->data->message;
+    }
+
+    return (*message_no_color) ? 1 : 0;
+}
+
 /*
  * Executes a print hook.
+ *
+ * Conditions are checked from the fastest to the slowest (buffer, tags,
+ * message) and colors are decoded in prefix and message only if a hook
+ * needs it (message filter or strip_colors).
  */
 
 void
@@ -122,7 +164,9 @@ hook_print_exec (struct t_gui_buffer *buffer, struct t_gui_line *line)
 {
     struct t_hook *ptr_hook, *next_hook;
     struct t_hook_exec_cb hook_exec_cb;
-    char *prefix_no_color, *message_no_color;
+    char **buffer_prefix, **buffer_message;
+    const char *prefix_no_color, *message_no_color;
+    int decoded;
 
     if (!weechat_hooks[HOOK_TYPE_PRINT])
         return;
@@ -130,57 +174,68 @@ hook_print_exec (struct t_gui_buffer *buffer, struct t_gui_line *line)
     if (!line->data->message)
         return;
 
-    prefix_no_color = (line->data->prefix) ?
-        gui_color_decode (line->data->prefix, NULL) : NULL;
-
-    message_no_color = gui_color_decode (line->data->message, NULL);
-    if (!message_no_color)
-    {
-        free (prefix_no_color);
-        return;
-    }
+    decoded = 0;
+    buffer_prefix = NULL;
+    buffer_message = NULL;
+    prefix_no_color = NULL;
+    message_no_color = NULL;
 
     hook_exec_start ();
 
-    ptr_hook = weechat_hooks[HOOK_TYPE_PRINT];
-    while (ptr_hook)
+    for (ptr_hook = weechat_hooks[HOOK_TYPE_PRINT]; ptr_hook;
+         ptr_hook = next_hook)
     {
         next_hook = ptr_hook->next_hook;
 
-        if (!ptr_hook->deleted
-            && !ptr_hook->running
-            && (!HOOK_PRINT(ptr_hook, buffer)
-                || (buffer == HOOK_PRINT(ptr_hook, buffer)))
-            && (!HOOK_PRINT(ptr_hook, message)
-                || !HOOK_PRINT(ptr_hook, message)[0]
-                || string_strcasestr (prefix_no_color, HOOK_PRINT(ptr_hook, message))
-                || string_strcasestr (message_no_color, HOOK_PRINT(ptr_hook, message)))
-            && (!HOOK_PRINT(ptr_hook, tags_array)
-                || gui_line_match_tags (line->data,
-                                        HOOK_PRINT(ptr_hook, tags_count),
-                                        HOOK_PRINT(ptr_hook, tags_array))))
+        if (ptr_hook->deleted
+            || ptr_hook->running
+            || (HOOK_PRINT(ptr_hook, buffer)
+                && (buffer != HOOK_PRINT(ptr_hook, buffer)))
+            || (HOOK_PRINT(ptr_hook, tags_array)
+                && !gui_line_match_tags (line->data,
+                                         HOOK_PRINT(ptr_hook, tags_count),
+                                         HOOK_PRINT(ptr_hook, tags_array))))
+        {
+            continue;
+        }
+
+        if ((HOOK_PRINT(ptr_hook, strip_colors)
+             || (HOOK_PRINT(ptr_hook, message)
+                 && HOOK_PRINT(ptr_hook, message)[0]))
+            && !hook_print_decode_colors (line, &decoded,
+                                          &buffer_prefix, &buffer_message,
+                                          &prefix_no_color,
+                                          &message_no_color))
+        {
+            continue;
+        }
+
+        if (HOOK_PRINT(ptr_hook, message)
+            && HOOK_PRINT(ptr_hook, message)[0]
+            && !string_strcasestr (prefix_no_color, HOOK_PRINT(ptr_hook, message))
+            && !string_strcasestr (message_no_color, HOOK_PRINT(ptr_hook, message)))
         {
-            /* run callback */
-            hook_callback_start (ptr_hook, &hook_exec_cb);
-            (void) (HOOK_PRINT(ptr_hook, callback))
-                (ptr_hook->callback_pointer,
-                 ptr_hook->callback_data,
-                 buffer,
-                 line->data->date,
-                 line->data->date_usec,
-                 line->data->tags_count,
-                 (const char **)line->data->tags_array,
-                 (int)line->data->displayed, (int)line->data->highlight,
-                 (HOOK_PRINT(ptr_hook, strip_colors)) ? prefix_no_color : line->data->prefix,
-                 (HOOK_PRINT(ptr_hook, strip_colors)) ? message_no_color : line->data->message);
-            hook_callback_end (ptr_hook, &hook_exec_cb);
+            continue;
         }
 
-        ptr_hook = next_hook;
+        /* run callback */
+        hook_callback_start (ptr_hook, &hook_exec_cb);
+        (void) (HOOK_PRINT(ptr_hook, callback))
+            (ptr_hook->callback_pointer,
+             ptr_hook->callback_data,
+             buffer,
+             line->data->date,
+             line->data->date_usec,
+             line->data->tags_count,
+             (const char **)line->data->tags_array,
+             (int)line->data->displayed, (int)line->data->highlight,
+             (HOOK_PRINT(ptr_hook, strip_colors)) ? prefix_no_color : line->data->prefix,
+             (HOOK_PRINT(ptr_hook, strip_colors)) ? message_no_color : line->data->message);
+        hook_callback_end (ptr_hook, &hook_exec_cb);
     }
 
-    free (prefix_no_color);
-    free (message_no_color);
+    string_dyn_free (buffer_prefix, 1);
+    string_dyn_free (buffer_message, 1);
 
     hook_exec_end ();
 }
@@ -30,6 +30,12 @@
 #include <poll.h>
 #include <fcntl.h>
 #include <errno.h>
+#ifdef HAVE_POSIX_SPAWN
+#include <spawn.h>
+#endif
+#ifdef HAVE_PIDFD_OPEN
+#include <sys/pidfd.h>
+#endif
 
 #include "../weechat.h"
 #include "../core-hashtable.h"
@@ -44,6 +50,8 @@
 
 int hook_process_pending = 0;          /* 1 if there are some process to    */
                                        /* run (via fork)                    */
+int hook_process_in_child = 0;         /* 1 if running in the child process */
+                                       /* (after fork)                      */
 
 
 void hook_process_run (struct t_hook *hook_process);
@@ -87,7 +95,9 @@ hook_process_hashtable (struct t_weechat_plugin *plugin,
     struct t_hook_process *new_hook_process;
     char *stdout_buffer, *stderr_buffer, *error;
     const char *ptr_value;
+    int buffer_max, buffer_flush;
     long number;
+    long long output_max;
 
     stdout_buffer = NULL;
     stderr_buffer = NULL;
@@ -97,11 +107,51 @@ hook_process_hashtable (struct t_weechat_plugin *plugin,
     if (!command || !command[0] || !callback)
         goto error;
 
-    stdout_buffer = malloc (HOOK_PROCESS_BUFFER_SIZE + 1);
+    buffer_max = HOOK_PROCESS_BUFFER_SIZE;
+    buffer_flush = -1;
+    output_max = 0;
+    if (options)
+    {
+        ptr_value = hashtable_get (options, "buffer_size");
+        if (ptr_value && ptr_value[0])
+        {
+            error = NULL;
+            number = strtol (ptr_value, &error, 10);
+            if (error && !error[0]
+                && (number >= HOOK_PROCESS_BUFFER_SIZE_MIN)
+                && (number <= HOOK_PROCESS_BUFFER_SIZE_MAX))
+            {
+                buffer_max = (int)number;
+            }
+        }
+        ptr_value = hashtable_get (options, "buffer_flush");
+        if (ptr_value && ptr_value[0])
+        {
+            error = NULL;
+            number = strtol (ptr_value, &error, 10);
+            if (error && !error[0]
+                && (number >= 1) && (number <= buffer_max))
+            {
+                buffer_flush = (int)number;
+            }
+        }
+        ptr_value = hashtable_get (options, "output_max");
+        if (ptr_value && ptr_value[0])
+        {
+            error = NULL;
+            output_max = strtoll (ptr_value, &error, 10);
+            if (!error || error[0] || (output_max < 0))
+                output_max = 0;
+        }
+    }
+    if (buffer_flush < 0)
+        buffer_flush = buffer_max;
+
+    stdout_buffer = malloc (buffer_max + 1);
     if (!stdout_buffer)
         goto error;
 
-    stderr_buffer = malloc (HOOK_PROCESS_BUFFER_SIZE + 1);
+    stderr_buffer = malloc (buffer_max + 1);
     if (!stderr_buffer)
         goto error;
 
@@ -130,9 +180,11 @@ hook_process_hashtable (struct t_weechat_plugin *plugin,
     new_hook_process->child_write[HOOK_PROCESS_STDOUT] = -1;
     new_hook_process->child_write[HOOK_PROCESS_STDERR] = -1;
     new_hook_process->child_pid = 0;
+    new_hook_process->child_pidfd = -1;
     new_hook_process->hook_fd[HOOK_PROCESS_STDIN] = NULL;
     new_hook_process->hook_fd[HOOK_PROCESS_STDOUT] = NULL;
     new_hook_process->hook_fd[HOOK_PROCESS_STDERR] = NULL;
+    new_hook_process->hook_pidfd = NULL;
     new_hook_process->hook_timer = NULL;
     new_hook_process->buffer[HOOK_PROCESS_STDIN] = NULL;
     new_hook_process->buffer[HOOK_PROCESS_STDOUT] = stdout_buffer;
@@ -140,21 +192,12 @@ hook_process_hashtable (struct t_weechat_plugin *plugin,
     new_hook_process->buffer_size[HOOK_PROCESS_STDIN] = 0;
     new_hook_process->buffer_size[HOOK_PROCESS_STDOUT] = 0;
     new_hook_process->buffer_size[HOOK_PROCESS_STDERR] = 0;
-    new_hook_process->buffer_flush = HOOK_PROCESS_BUFFER_SIZE;
-    if (options)
-    {
-        ptr_value = hashtable_get (options, "buffer_flush");
-        if (ptr_value && ptr_value[0])
-        {
-            error = NULL;
-            number = strtol (ptr_value, &error, 10);
-            if (error && !error[0]
-                && (number >= 1) && (number <= HOOK_PROCESS_BUFFER_SIZE))
-            {
-                new_hook_process->buffer_flush = (int)number;
-            }
-        }
-    }
+    new_hook_process->buffer_max = buffer_max;
+    new_hook_process->buffer_flush = buffer_flush;
+    new_hook_process->line_mode = (options && hashtable_has_key (options,
+                                                                 "line_mode"));
+    new_hook_process->output_max = output_max;
+    new_hook_process->output_size = 0;
 
     hook_add_to_list (new_hook);
 
@@ -202,6 +245,98 @@ hook_process (struct t_weechat_plugin *plugin,
                                    callback, callback_pointer, callback_data);
 }
 
+/*
+ * Builds arguments to execute the command of a process hook.
+ *
+ * Arguments are taken in hashtable options (keys "arg1", "arg2", ...) if
+ * present, otherwise the command is split like the shell does.
+ *
+ * Note: result must be freed after use with function string_free_split.
+ */
+
+char **
+hook_process_get_args (struct t_hook *hook_process)
+{
+    char **exec_args, *arg0, str_arg[64];
+    const char *ptr_arg;
+    int i, num_args;
+
+    num_args = 0;
+    if (HOOK_PROCESS(hook_process, options))
+    {
+        /*
+         * count number of arguments given in the hashtable options,
+         * keys are: "arg1", "arg2", ...
+         */
+        while (1)
+        {
+            snprintf (str_arg, sizeof (str_arg), "arg%d", num_args + 1);
+            ptr_arg = hashtable_get (HOOK_PROCESS(hook_process, options),
+                                     str_arg);
+            if (!ptr_arg)
+                break;
+            num_args++;
+        }
+    }
+    if (num_args > 0)
+    {
+        /*
+         * if at least one argument was found in hashtable option, the
+         * "command" contains only path to binary (without arguments), and
+         * the arguments are in hashtable
+         */
+        exec_args = malloc ((num_args + 2) * sizeof (exec_args[0]));
+        if (exec_args)
+        {
+            exec_args[0] = strdup (HOOK_PROCESS(hook_process, command));
+            for (i = 1; i <= num_args; i++)
+            {
+                snprintf (str_arg, sizeof (str_arg), "arg%d", i);
+                ptr_arg = hashtable_get (HOOK_PROCESS(hook_process, options),
+                                         str_arg);
+                exec_args[i] = (ptr_arg) ? strdup (ptr_arg) : NULL;
+            }
+            exec_args[num_args + 1] = NULL;
+        }
+    }
+    else
+    {
+        /*
+         * if no arguments were found in hashtable, make an automatic split
+         * of command, like the shell does
+         */
+        exec_args = string_split_shell (HOOK_PROCESS(hook_process, command),
+                                        NULL);
+    }
+
+    if (!exec_args)
+        return NULL;
+
+    if (!exec_args[0])
+    {
+        string_free_split (exec_args);
+        return NULL;
+    }
+
+    arg0 = string_expand_home (exec_args[0]);
+    if (arg0)
+    {
+        free (exec_args[0]);
+        exec_args[0] = arg0;
+    }
+    if (weechat_debug_core >= 1)
+    {
+        log_printf ("hook_process, command='%s'",
+                    HOOK_PROCESS(hook_process, command));
+        for (i = 0; exec_args[i]; i++)
+        {
+            log_printf ("  args[%02d] == '%s'", i, exec_args[i]);
+        }
+    }
+
+    return exec_args;
+}
+
 /*
  * Child process for hook process: executes command and returns string result
  * into pipe for WeeChat process.
@@ -210,11 +345,18 @@ hook_process (struct t_weechat_plugin *plugin,
 void
 hook_process_child (struct t_hook *hook_process)
 {
-    char **exec_args, *arg0, str_arg[64];
-    const char *ptr_url, *ptr_arg;
-    int rc, i, num_args;
+    char **exec_args;
+    const char *ptr_url;
+    int rc;
     FILE *f;
 
+    /*
+     * the child shares sockets and files with WeeChat process: some
+     * functions (like commands, messages displayed and write of config
+     * files) are disabled or redirected (see hook_process_in_child)
+     */
+    hook_process_in_child = 1;
+
     /* read stdin from parent, if a pipe was defined */
     if (HOOK_PROCESS(hook_process, child_read[HOOK_PROCESS_STDIN]) >= 0)
     {
@@ -292,73 +434,9 @@ hook_process_child (struct t_hook *hook_process)
     else
     {
         /* launch command */
-        num_args = 0;
-        if (HOOK_PROCESS(hook_process, options))
-        {
-            /*
-             * count number of arguments given in the hashtable options,
-             * keys are: "arg1", "arg2", ...
-             */
-            while (1)
-            {
-                snprintf (str_arg, sizeof (str_arg), "arg%d", num_args + 1);
-                ptr_arg = hashtable_get (HOOK_PROCESS(hook_process, options),
-                                         str_arg);
-                if (!ptr_arg)
-                    break;
-                num_args++;
-            }
-        }
-        if (num_args > 0)
-        {
-            /*
-             * if at least one argument was found in hashtable option, the
-             * "command" contains only path to binary (without arguments), and
-             * the arguments are in hashtable
-             */
-            exec_args = malloc ((num_args + 2) * sizeof (exec_args[0]));
-            if (exec_args)
-            {
-                exec_args[0] = strdup (HOOK_PROCESS(hook_process, command));
-                for (i = 1; i <= num_args; i++)
-                {
-                    snprintf (str_arg, sizeof (str_arg), "arg%d", i);
-                    ptr_arg = hashtable_get (HOOK_PROCESS(hook_process, options),
-                                             str_arg);
-                    exec_args[i] = (ptr_arg) ? strdup (ptr_arg) : NULL;
-                }
-                exec_args[num_args + 1] = NULL;
-            }
-        }
-        else
-        {
-            /*
-             * if no arguments were found in hashtable, make an automatic split
-             * of command, like the shell does
-             */
-            exec_args = string_split_shell (HOOK_PROCESS(hook_process, command),
-                                            NULL);
-        }
-
+        exec_args = hook_process_get_args (hook_process);
         if (exec_args)
-        {
-            arg0 = string_expand_home (exec_args[0]);
-            if (arg0)
-            {
-                free (exec_args[0]);
-                exec_args[0] = arg0;
-            }
-            if (weechat_debug_core >= 1)
-            {
-                log_printf ("hook_process, command='%s'",
-                            HOOK_PROCESS(hook_process, command));
-                for (i = 0; exec_args[i]; i++)
-                {
-                    log_printf ("  args[%02d] == '%s'", i, exec_args[i]);
-                }
-            }
             execvp (exec_args[0], exec_args);
-        }
 
         /* should not be executed if execvp was OK */
         string_free_split (exec_args);
@@ -372,22 +450,66 @@ hook_process_child (struct t_hook *hook_process)
     _exit (rc);
 }
 
+/*
+ * Returns the size of complete lines at beginning of buffer: number of bytes
+ * up to (and including) the last newline, 0 if there's no newline in buffer.
+ */
+
+int
+hook_process_complete_lines_size (const char *buffer, int size)
+{
+    int i;
+
+    if (!buffer)
+        return 0;
+
+    for (i = size - 1; i >= 0; i--)
+    {
+        if (buffer[i] == '\n')
+            return i + 1;
+    }
+
+    return 0;
+}
+
 /*
  * Sends buffers (stdout/stderr) to callback.
+ *
+ * In line mode, while the process is running, only complete lines are sent
+ * (the incomplete last line is kept for next call), unless the buffer is full.
  */
 
 void
 hook_process_send_buffers (struct t_hook *hook_process, int callback_rc)
 {
-    int size;
+    int i, size, size_sent[3];
+    char saved_char[3];
+
+    for (i = HOOK_PROCESS_STDOUT; i <= HOOK_PROCESS_STDERR; i++)
+    {
+        size_sent[i] = HOOK_PROCESS(hook_process, buffer_size[i]);
+        if (HOOK_PROCESS(hook_process, line_mode)
+            && (callback_rc == WEECHAT_HOOK_PROCESS_RUNNING)
+            && (size_sent[i] < HOOK_PROCESS(hook_process, buffer_max)))
+        {
+            size_sent[i] = hook_process_complete_lines_size (
+                HOOK_PROCESS(hook_process, buffer[i]), size_sent[i]);
+        }
+    }
 
-    /* add '\0' at end of stdout and stderr */
-    size = HOOK_PROCESS(hook_process, buffer_size[HOOK_PROCESS_STDOUT]);
-    if (size > 0)
-        HOOK_PROCESS(hook_process, buffer[HOOK_PROCESS_STDOUT])[size] = '\0';
-    size = HOOK_PROCESS(hook_process, buffer_size[HOOK_PROCESS_STDERR]);
-    if (size > 0)
-        HOOK_PROCESS(hook_process, buffer[HOOK_PROCESS_STDERR])[size] = '\0';
+    if ((callback_rc == WEECHAT_HOOK_PROCESS_RUNNING)
+        && (size_sent[HOOK_PROCESS_STDOUT] == 0)
+        && (size_sent[HOOK_PROCESS_STDERR] == 0))
+    {
+        return;
+    }
+
+    /* add '\0' at end of data sent for stdout and stderr */
+    for (i = HOOK_PROCESS_STDOUT; i <= HOOK_PROCESS_STDERR; i++)
+    {
+        saved_char[i] = HOOK_PROCESS(hook_process, buffer[i])[size_sent[i]];
+        HOOK_PROCESS(hook_process, buffer[i])[size_sent[i]] = '\0';
+    }
 
     /* send buffers to callback */
     (void) (HOOK_PROCESS(hook_process, callback))
@@ -395,52 +517,96 @@ hook_process_send_buffers (struct t_hook *hook_process, int callback_rc)
          hook_process->callback_data,
          HOOK_PROCESS(hook_process, command),
          callback_rc,
-         (HOOK_PROCESS(hook_process, buffer_size[HOOK_PROCESS_STDOUT]) > 0) ?
+         (size_sent[HOOK_PROCESS_STDOUT] > 0) ?
          HOOK_PROCESS(hook_process, buffer[HOOK_PROCESS_STDOUT]) : NULL,
-         (HOOK_PROCESS(hook_process, buffer_size[HOOK_PROCESS_STDERR]) > 0) ?
+         (size_sent[HOOK_PROCESS_STDERR] > 0) ?
          HOOK_PROCESS(hook_process, buffer[HOOK_PROCESS_STDERR]) : NULL);
 
-    /* reset size for stdout and stderr */
-    HOOK_PROCESS(hook_process, buffer_size[HOOK_PROCESS_STDOUT]) = 0;
-    HOOK_PROCESS(hook_process, buffer_size[HOOK_PROCESS_STDERR]) = 0;
-}
-
-/*
- * Adds some data to buffer (stdout or stderr).
- */
-
-void
-hook_process_add_to_buffer (struct t_hook *hook_process, int index_buffer,
-                            const char *buffer, int size)
-{
-    if (HOOK_PROCESS(hook_process, buffer_size[index_buffer]) + size > HOOK_PROCESS_BUFFER_SIZE)
-        hook_process_send_buffers (hook_process, WEECHAT_HOOK_PROCESS_RUNNING);
+    /* hook removed in callback? */
+    if (hook_process->deleted || !hook_process->hook_data)
+        return;
 
-    memcpy (HOOK_PROCESS(hook_process, buffer[index_buffer]) +
-            HOOK_PROCESS(hook_process, buffer_size[index_buffer]),
-            buffer, size);
-    HOOK_PROCESS(hook_process, buffer_size[index_buffer]) += size;
+    /* keep data not sent (incomplete line) at beginning of buffers */
+    for (i = HOOK_PROCESS_STDOUT; i <= HOOK_PROCESS_STDERR; i++)
+    {
+        HOOK_PROCESS(hook_process, buffer[i])[size_sent[i]] = saved_char[i];
+        size = HOOK_PROCESS(hook_process, buffer_size[i]) - size_sent[i];
+        if ((size > 0) && (size_sent[i] > 0))
+        {
+            memmove (HOOK_PROCESS(hook_process, buffer[i]),
+                     HOOK_PROCESS(hook_process, buffer[i]) + size_sent[i],
+                     size);
+        }
+        HOOK_PROCESS(hook_process, buffer_size[i]) = size;
+    }
 }
 
 /*
  * Reads process output (stdout or stderr) from child process.
+ *
+ * Data is read directly in the buffer of the hook, which is sent to the
+ * callback when it is full or when the flush size is reached.
+ *
+ * If the max size of output is reached, the data received up to this limit
+ * is sent to the callback (with return code WEECHAT_HOOK_PROCESS_ERROR) and
+ * the child process is killed.
  */
 
 void
 hook_process_child_read (struct t_hook *hook_process, int fd,
                          int index_buffer, struct t_hook **hook_fd)
 {
-    char buffer[HOOK_PROCESS_BUFFER_SIZE / 8];
-    int num_read;
+    int num_read, size_free;
+    long long size_over;
 
     if (hook_process->deleted)
         return;
 
-    num_read = read (fd, buffer, sizeof (buffer) - 1);
+    /* buffer full: send it to the callback first */
+    if (HOOK_PROCESS(hook_process, buffer_size[index_buffer]) >=
+        HOOK_PROCESS(hook_process, buffer_max))
+    {
+        hook_process_send_buffers (hook_process, WEECHAT_HOOK_PROCESS_RUNNING);
+        if (hook_process->deleted)
+            return;
+    }
+
+    size_free = HOOK_PROCESS(hook_process, buffer_max)
+        - HOOK_PROCESS(hook_process, buffer_size[index_buffer]);
+
+    num_read = read (fd,
+                     HOOK_PROCESS(hook_process, buffer[index_buffer])
+                     + HOOK_PROCESS(hook_process, buffer_size[index_buffer]),
+                     size_free);
     if (num_read > 0)
     {
-        hook_process_add_to_buffer (hook_process, index_buffer,
-                                    buffer, num_read);
+        HOOK_PROCESS(hook_process, buffer_size[index_buffer]) += num_read;
+        HOOK_PROCESS(hook_process, output_size) += num_read;
+        if (HOOK_PROCESS(hook_process, output_max) > 0)
+        {
+            size_over = HOOK_PROCESS(hook_process, output_size)
+                - HOOK_PROCESS(hook_process, output_max);
+            if (size_over > 0)
+            {
+                HOOK_PROCESS(hook_process, buffer_size[index_buffer]) -=
+                    (int)size_over;
+                hook_process_send_buffers (hook_process,
+                                           WEECHAT_HOOK_PROCESS_ERROR);
+                if (hook_process->deleted)
+                    return;
+                if (weechat_debug_core >= 1)
+                {
+                    gui_chat_printf (NULL,
+                                     _("End of command '%s', max size of "
+                                       "output reached (%lld bytes)"),
+                                     HOOK_PROCESS(hook_process, command),
+                                     HOOK_PROCESS(hook_process, output_max));
+                }
+                kill (HOOK_PROCESS(hook_process, child_pid), SIGKILL);
+                unhook (hook_process);
+                return;
+            }
+        }
         if (HOOK_PROCESS(hook_process, buffer_size[index_buffer]) >=
             HOOK_PROCESS(hook_process, buffer_flush))
         {
@@ -570,14 +736,62 @@ hook_process_child_read_until_eof (struct t_hook *hook_process)
 }
 
 /*
- * Checks if child process is still alive.
+ * Checks if child process has ended: if yes, sends remaining output to the
+ * callback and removes the hook.
+ *
+ * Returns:
+ *   1: child process has ended
+ *   0: child process is still running
+ */
+
+int
+hook_process_child_check_end (struct t_hook *hook_process)
+{
+    int status, rc;
+    pid_t pid;
+
+    pid = waitpid (HOOK_PROCESS(hook_process, child_pid), &status, WNOHANG);
+    if ((pid < 0) && (errno == ECHILD))
+    {
+        /* child already acknowledged elsewhere: return code is unknown */
+        hook_process_child_read_until_eof (hook_process);
+        hook_process_send_buffers (hook_process, WEECHAT_HOOK_PROCESS_ERROR);
+        unhook (hook_process);
+        return 1;
+    }
+    if (pid > 0)
+    {
+        if (WIFEXITED(status))
+        {
+            /* child terminated normally */
+            rc = WEXITSTATUS(status);
+            hook_process_child_read_until_eof (hook_process);
+            hook_process_send_buffers (hook_process, rc);
+            unhook (hook_process);
+            return 1;
+        }
+        else if (WIFSIGNALED(status))
+        {
+            /* child terminated by a signal */
+            hook_process_child_read_until_eof (hook_process);
+            hook_process_send_buffers (hook_process,
+                                       WEECHAT_HOOK_PROCESS_ERROR);
+            unhook (hook_process);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Checks if child process is still alive (or if timeout is reached).
  */
 
 int
 hook_process_timer_cb (const void *pointer, void *data, int remaining_calls)
 {
     struct t_hook *hook_process;
-    int status, rc;
 
     /* make C compiler happy */
     (void) data;
@@ -603,34 +817,151 @@ hook_process_timer_cb (const void *pointer, void *data, int remaining_calls)
     }
     else
     {
-        if (waitpid (HOOK_PROCESS(hook_process, child_pid),
-                     &status, WNOHANG) > 0)
+        (void) hook_process_child_check_end (hook_process);
+    }
+
+    return WEECHAT_RC_OK;
+}
+
+#ifdef HAVE_PIDFD_OPEN
+/*
+ * Callback called when the child process has ended (its pidfd is readable).
+ */
+
+int
+hook_process_child_exit_cb (const void *pointer, void *data, int fd)
+{
+    struct t_hook *hook_process;
+
+    /* make C compiler happy */
+    (void) data;
+    (void) fd;
+
+    hook_process = (struct t_hook *)pointer;
+
+    if (hook_process->deleted)
+        return WEECHAT_RC_OK;
+
+    if (!hook_process_child_check_end (hook_process))
+    {
+        /*
+         * child not ended yet (should not happen): stop watching the pidfd
+         * (it would remain readable) and check the child with a timer
+         */
+        unhook (HOOK_PROCESS(hook_process, hook_pidfd));
+        HOOK_PROCESS(hook_process, hook_pidfd) = NULL;
+        if (HOOK_PROCESS(hook_process, hook_timer))
+            unhook (HOOK_PROCESS(hook_process, hook_timer));
+        HOOK_PROCESS(hook_process, hook_timer) = hook_timer (
+            hook_process->plugin, 100, 0, 0,
+            &hook_process_timer_cb, hook_process, NULL);
+    }
+
+    return WEECHAT_RC_OK;
+}
+#endif /* HAVE_PIDFD_OPEN */
+
+#ifdef HAVE_POSIX_SPAWN
+/*
+ * Executes command of a process hook with posix_spawn, which is faster than
+ * fork for a large process (memory of WeeChat is not duplicated).
+ *
+ * It is used only to run a command: "url:" and "func:" need a child copy
+ * of WeeChat process and are started with fork.
+ *
+ * Returns PID of child process, -1 if error (then fork must be used).
+ */
+
+pid_t
+hook_process_spawn (struct t_hook *hook_process)
+{
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t attr;
+    char **exec_args;
+    pid_t pid;
+    int i, fd;
+
+    exec_args = hook_process_get_args (hook_process);
+    if (!exec_args)
+        return -1;
+
+    pid = -1;
+
+    if (posix_spawn_file_actions_init (&actions) != 0)
+    {
+        string_free_split (exec_args);
+        return -1;
+    }
+    if (posix_spawnattr_init (&attr) != 0)
+    {
+        posix_spawn_file_actions_destroy (&actions);
+        string_free_split (exec_args);
+        return -1;
+    }
+
+    /* run child with real user id (like "setuid (getuid ())" after fork) */
+    if (posix_spawnattr_setflags (&attr, POSIX_SPAWN_RESETIDS) != 0)
+        goto end;
+
+    /* read stdin from parent if a pipe was defined, otherwise "/dev/null" */
+    fd = HOOK_PROCESS(hook_process, child_read[HOOK_PROCESS_STDIN]);
+    if (((fd >= 0)
+         && (posix_spawn_file_actions_adddup2 (&actions, fd,
+                                               STDIN_FILENO) != 0))
+        || ((fd < 0)
+            && (posix_spawn_file_actions_addopen (&actions, STDIN_FILENO,
+                                                  "/dev/null", O_RDONLY,
+                                                  0) != 0)))
+    {
+        goto end;
+    }
+    fd = HOOK_PROCESS(hook_process, child_write[HOOK_PROCESS_STDIN]);
+    if ((fd >= 0) && (posix_spawn_file_actions_addclose (&actions, fd) != 0))
+        goto end;
+
+    /* redirect stdout/stderr to pipes (or "/dev/null" in detached mode) */
+    for (i = HOOK_PROCESS_STDOUT; i <= HOOK_PROCESS_STDERR; i++)
+    {
+        fd = HOOK_PROCESS(hook_process, child_read[i]);
+        if (fd >= 0)
         {
-            if (WIFEXITED(status))
-            {
-                /* child terminated normally */
-                rc = WEXITSTATUS(status);
-                hook_process_child_read_until_eof (hook_process);
-                hook_process_send_buffers (hook_process, rc);
-                unhook (hook_process);
-            }
-            else if (WIFSIGNALED(status))
+            if ((posix_spawn_file_actions_addclose (&actions, fd) != 0)
+                || (posix_spawn_file_actions_adddup2 (
+                        &actions,
+                        HOOK_PROCESS(hook_process, child_write[i]),
+                        i) != 0))
             {
-                /* child terminated by a signal */
-                hook_process_child_read_until_eof (hook_process);
-                hook_process_send_buffers (hook_process,
-                                           WEECHAT_HOOK_PROCESS_ERROR);
-                unhook (hook_process);
+                goto end;
             }
         }
+        else if (posix_spawn_file_actions_addopen (&actions, i, "/dev/null",
+                                                   O_WRONLY, 0) != 0)
+        {
+            goto end;
+        }
     }
 
-    return WEECHAT_RC_OK;
+    if (posix_spawnp (&pid, exec_args[0], &actions, &attr, exec_args,
+                      environ) != 0)
+    {
+        pid = -1;
+    }
+
+end:
+    posix_spawnattr_destroy (&attr);
+    posix_spawn_file_actions_destroy (&actions);
+    string_free_split (exec_args);
+
+    return pid;
 }
+#endif /* HAVE_POSIX_SPAWN */
 
 /*
  * Executes process command in child, and read data in current process,
  * with fd hook.
+ *
+ * A command is executed with posix_spawn if available (with fallback to
+ * fork if it fails, so that errors are reported by the child as usual).
  */
 
 void
@@ -675,8 +1006,20 @@ hook_process_run (struct t_hook *hook_process)
     fflush (stdout);
     fflush (stderr);
 
+    pid = -1;
+
+#ifdef HAVE_POSIX_SPAWN
+    if ((strncmp (HOOK_PROCESS(hook_process, command), "url:", 4) != 0)
+        && (strncmp (HOOK_PROCESS(hook_process, command), "func:", 5) != 0))
+    {
+        pid = hook_process_spawn (hook_process);
+    }
+#endif /* HAVE_POSIX_SPAWN */
+
     /* fork */
-    switch (pid = fork ())
+    if (pid < 0)
+        pid = fork ();
+    switch (pid)
     {
         /* fork failed */
         case -1:
@@ -740,6 +1083,35 @@ hook_process_run (struct t_hook *hook_process)
     }
 
     timeout = HOOK_PROCESS(hook_process, timeout);
+
+#ifdef HAVE_PIDFD_OPEN
+    /*
+     * watch the end of child with a pidfd in the fd event loop, so that no
+     * timer is needed to check if child is still alive (the timer is then
+     * used only for the timeout)
+     */
+    HOOK_PROCESS(hook_process, child_pidfd) = pidfd_open (pid, 0);
+    if (HOOK_PROCESS(hook_process, child_pidfd) >= 0)
+    {
+        HOOK_PROCESS(hook_process, hook_pidfd) =
+            hook_fd (hook_process->plugin,
+                     HOOK_PROCESS(hook_process, child_pidfd),
+                     1, 0, 0,
+                     &hook_process_child_exit_cb,
+                     hook_process, NULL);
+    }
+    if (HOOK_PROCESS(hook_process, hook_pidfd))
+    {
+        if (timeout > 0)
+        {
+            HOOK_PROCESS(hook_process, hook_timer) = hook_timer (
+                hook_process->plugin, timeout, 0, 1,
+                &hook_process_timer_cb, hook_process, NULL);
+        }
+        return;
+    }
+#endif /* HAVE_PIDFD_OPEN */
+
     interval = 100;
     max_calls = 0;
     if (timeout > 0)
@@ -850,11 +1222,21 @@ hook_process_free_data (struct t_hook *hook)
         unhook (HOOK_PROCESS(hook, hook_fd[HOOK_PROCESS_STDERR]));
         HOOK_PROCESS(hook, hook_fd[HOOK_PROCESS_STDERR]) = NULL;
     }
+    if (HOOK_PROCESS(hook, hook_pidfd))
+    {
+        unhook (HOOK_PROCESS(hook, hook_pidfd));
+        HOOK_PROCESS(hook, hook_pidfd) = NULL;
+    }
     if (HOOK_PROCESS(hook, hook_timer))
     {
         unhook (HOOK_PROCESS(hook, hook_timer));
         HOOK_PROCESS(hook, hook_timer) = NULL;
     }
+    if (HOOK_PROCESS(hook, child_pidfd) >= 0)
+    {
+        close (HOOK_PROCESS(hook, child_pidfd));
+        HOOK_PROCESS(hook, child_pidfd) = -1;
+    }
     if (HOOK_PROCESS(hook, child_pid) > 0)
     {
         kill (HOOK_PROCESS(hook, child_pid), SIGKILL);
@@ -950,14 +1332,24 @@ hook_process_add_to_infolist (struct t_infolist_item *item,
         return 0;
     if (!infolist_new_var_integer (item, "child_pid", HOOK_PROCESS(hook, child_pid)))
         return 0;
+    if (!infolist_new_var_integer (item, "child_pidfd", HOOK_PROCESS(hook, child_pidfd)))
+        return 0;
     if (!infolist_new_var_pointer (item, "hook_fd_stdin", HOOK_PROCESS(hook, hook_fd[HOOK_PROCESS_STDIN])))
         return 0;
     if (!infolist_new_var_pointer (item, "hook_fd_stdout", HOOK_PROCESS(hook, hook_fd[HOOK_PROCESS_STDOUT])))
         return 0;
     if (!infolist_new_var_pointer (item, "hook_fd_stderr", HOOK_PROCESS(hook, hook_fd[HOOK_PROCESS_STDERR])))
         return 0;
+    if (!infolist_new_var_pointer (item, "hook_pidfd", HOOK_PROCESS(hook, hook_pidfd)))
+        return 0;
     if (!infolist_new_var_pointer (item, "hook_timer", HOOK_PROCESS(hook, hook_timer)))
         return 0;
+    if (!infolist_new_var_integer (item, "buffer_max", HOOK_PROCESS(hook, buffer_max)))
+        return 0;
+    if (!infolist_new_var_integer (item, "buffer_flush", HOOK_PROCESS(hook, buffer_flush)))
+        return 0;
+    if (!infolist_new_var_integer (item, "line_mode", HOOK_PROCESS(hook, line_mode)))
+        return 0;
 
     return 1;
 }
@@ -988,8 +1380,17 @@ hook_process_print_log (struct t_hook *hook)
     log_printf ("    child_read[stderr]. . : %d", HOOK_PROCESS(hook, child_read[HOOK_PROCESS_STDERR]));
     log_printf ("    child_write[stderr] . : %d", HOOK_PROCESS(hook, child_write[HOOK_PROCESS_STDERR]));
     log_printf ("    child_pid . . . . . . : %d", HOOK_PROCESS(hook, child_pid));
+    log_printf ("    child_pidfd . . . . . : %d", HOOK_PROCESS(hook, child_pidfd));
     log_printf ("    hook_fd[stdin]. . . . : %p", HOOK_PROCESS(hook, hook_fd[HOOK_PROCESS_STDIN]));
     log_printf ("    hook_fd[stdout] . . . : %p", HOOK_PROCESS(hook, hook_fd[HOOK_PROCESS_STDOUT]));
     log_printf ("    hook_fd[stderr] . . . : %p", HOOK_PROCESS(hook, hook_fd[HOOK_PROCESS_STDERR]));
+    log_printf ("    hook_pidfd. . . . . . : %p", HOOK_PROCESS(hook, hook_pidfd));
     log_printf ("    hook_timer. . . . . . : %p", HOOK_PROCESS(hook, hook_timer));
+    log_printf ("    buffer_size[stdout] . : %d", HOOK_PROCESS(hook, buffer_size[HOOK_PROCESS_STDOUT]));
+    log_printf ("    buffer_size[stderr] . : %d", HOOK_PROCESS(hook, buffer_size[HOOK_PROCESS_STDERR]));
+    log_printf ("    buffer_max. . . . . . : %d", HOOK_PROCESS(hook, buffer_max));
+    log_printf ("    buffer_flush. . . . . : %d", HOOK_PROCESS(hook, buffer_flush));
+    log_printf ("    line_mode . . . . . . : %d", HOOK_PROCESS(hook, line_mode));
+    log_printf ("    output_max. . . . . . : %lld", HOOK_PROCESS(hook, output_max));
+    log_printf ("    output_size . . . . . : %lld", HOOK_PROCESS(hook, output_size));
 }
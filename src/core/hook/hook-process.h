@@ -31,6 +31,8 @@ struct t_hashtable;
 #define HOOK_PROCESS_STDOUT      1
 #define HOOK_PROCESS_STDERR      2
 #define HOOK_PROCESS_BUFFER_SIZE 65536
+#define HOOK_PROCESS_BUFFER_SIZE_MIN 1024
+#define HOOK_PROCESS_BUFFER_SIZE_MAX (16 * 1024 * 1024)
 
 typedef int (t_hook_callback_process)(const void *pointer, void *data,
                                       const char *command,
@@ -47,16 +49,25 @@ struct t_hook_process
     int child_read[3];                 /* read stdin/out/err data from child*/
     int child_write[3];                /* write stdin/out/err data for child*/
     pid_t child_pid;                   /* pid of child process              */
+    int child_pidfd;                   /* fd to watch end of child (or -1)  */
     struct t_hook *hook_fd[3];         /* hook fd for stdin/out/err         */
-    struct t_hook *hook_timer;         /* timer to check if child has died  */
+    struct t_hook *hook_pidfd;         /* hook fd for end of child process  */
+    struct t_hook *hook_timer;         /* timer for timeout / to check if   */
+                                       /* child has died (without pidfd)    */
     char *buffer[3];                   /* buffers for child stdin/out/err   */
     int buffer_size[3];                /* size of child stdin/out/err       */
+    int buffer_max;                    /* allocated size for out/err buffers*/
     int buffer_flush;                  /* bytes to flush output buffers     */
+    int line_mode;                     /* 1 = send only complete lines      */
+    long long output_max;              /* max bytes of output (0 = no limit)*/
+    long long output_size;             /* bytes received on stdout/stderr   */
 };
 
 extern int hook_process_pending;
+extern int hook_process_in_child;
 
 extern char *hook_process_get_description (struct t_hook *hook);
+extern int hook_process_complete_lines_size (const char *buffer, int size);
 extern struct t_hook *hook_process (struct t_weechat_plugin *plugin,
                                     const char *command,
                                     int timeout,
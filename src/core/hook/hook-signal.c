@@ -25,15 +25,30 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <wctype.h>
 
 #include "../weechat.h"
+#include "../core-arraylist.h"
+#include "../core-hashtable.h"
 #include "../core-hook.h"
 #include "../core-infolist.h"
 #include "../core-log.h"
 #include "../core-string.h"
+#include "../core-utf8.h"
 #include "../../plugins/plugin.h"
 
 
+/*
+ * index of signal hooks: hooks with exact signal names are stored in a
+ * hashtable (signal name -> arraylist of hooks), hooks with wildcard in
+ * signal name are stored in another arraylist; all arraylists are sorted
+ * like the list of hooks (priority, then order of creation)
+ */
+struct t_hashtable *hook_signal_index_exact = NULL;
+struct t_arraylist *hook_signal_index_wildcard = NULL;
+unsigned long long hook_signal_seq = 0; /* counter for order of creation    */
+
+
 /*
  * Returns description of hook.
  *
@@ -47,6 +62,223 @@ hook_signal_get_description (struct t_hook *hook)
         (const char **)(HOOK_SIGNAL(hook, signals)), ";", 0, -1);
 }
 
+/*
+ * Hashes a signal name (case insensitive).
+ */
+
+unsigned long long
+hook_signal_hash_key_cb (struct t_hashtable *hashtable, const void *key)
+{
+    const char *ptr_key;
+    unsigned long long hash;
+
+    /* make C compiler happy */
+    (void) hashtable;
+
+    hash = 5381;
+    ptr_key = (const char *)key;
+    while (ptr_key && ptr_key[0])
+    {
+        if (!((unsigned char)(ptr_key[0]) & 0x80))
+        {
+            hash ^= (hash << 5) + (hash >> 2)
+                + (((ptr_key[0] >= 'A') && (ptr_key[0] <= 'Z')) ?
+                   ptr_key[0] + ('a' - 'A') : ptr_key[0]);
+            ptr_key++;
+        }
+        else
+        {
+            hash ^= (hash << 5) + (hash >> 2)
+                + (unsigned long long)towlower (utf8_char_int (ptr_key));
+            ptr_key = utf8_next_char (ptr_key);
+        }
+    }
+
+    return hash;
+}
+
+/*
+ * Compares two signal names (case insensitive).
+ */
+
+int
+hook_signal_keycmp_cb (struct t_hashtable *hashtable,
+                       const void *key1, const void *key2)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+
+    return string_strcasecmp ((const char *)key1, (const char *)key2);
+}
+
+/*
+ * Compares two signal hooks in index: same order as in list of hooks
+ * (priority, then order of creation).
+ */
+
+int
+hook_signal_index_cmp_cb (void *data, struct t_arraylist *arraylist,
+                          void *pointer1, void *pointer2)
+{
+    struct t_hook *hook1, *hook2;
+
+    /* make C compiler happy */
+    (void) data;
+    (void) arraylist;
+
+    hook1 = (struct t_hook *)pointer1;
+    hook2 = (struct t_hook *)pointer2;
+
+    if (hook1->priority != hook2->priority)
+        return (hook1->priority > hook2->priority) ? -1 : 1;
+
+    if (HOOK_SIGNAL(hook1, seq) != HOOK_SIGNAL(hook2, seq))
+        return (HOOK_SIGNAL(hook1, seq) < HOOK_SIGNAL(hook2, seq)) ? -1 : 1;
+
+    return 0;
+}
+
+/*
+ * Frees an arraylist of hooks in index.
+ */
+
+void
+hook_signal_index_free_value_cb (struct t_hashtable *hashtable,
+                                 const void *key, void *value)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    arraylist_free ((struct t_arraylist *)value);
+}
+
+/*
+ * Creates a new arraylist of hooks for the index.
+ *
+ * Returns pointer to new arraylist, NULL if error.
+ */
+
+struct t_arraylist *
+hook_signal_index_new_list ()
+{
+    return arraylist_new (4, 1, 0,
+                          &hook_signal_index_cmp_cb, NULL,
+                          NULL, NULL);
+}
+
+/*
+ * Adds a signal hook in index.
+ */
+
+void
+hook_signal_index_add (struct t_hook *hook)
+{
+    struct t_arraylist *ptr_list;
+    const char *ptr_signal;
+    int i;
+
+    if (!hook_signal_index_exact)
+    {
+        hook_signal_index_exact = hashtable_new (
+            32,
+            WEECHAT_HASHTABLE_STRING,
+            WEECHAT_HASHTABLE_POINTER,
+            &hook_signal_hash_key_cb,
+            &hook_signal_keycmp_cb);
+        if (!hook_signal_index_exact)
+            return;
+        hashtable_set_pointer (hook_signal_index_exact,
+                               "callback_free_value",
+                               &hook_signal_index_free_value_cb);
+    }
+    if (!hook_signal_index_wildcard)
+    {
+        hook_signal_index_wildcard = hook_signal_index_new_list ();
+        if (!hook_signal_index_wildcard)
+            return;
+    }
+
+    for (i = 0; i < HOOK_SIGNAL(hook, num_signals); i++)
+    {
+        ptr_signal = HOOK_SIGNAL(hook, signals)[i];
+        if (strchr (ptr_signal, '*'))
+        {
+            arraylist_add (hook_signal_index_wildcard, hook);
+        }
+        else
+        {
+            ptr_list = hashtable_get (hook_signal_index_exact, ptr_signal);
+            if (!ptr_list)
+            {
+                ptr_list = hook_signal_index_new_list ();
+                if (!ptr_list)
+                    continue;
+                hashtable_set (hook_signal_index_exact, ptr_signal, ptr_list);
+            }
+            arraylist_add (ptr_list, hook);
+        }
+    }
+}
+
+/*
+ * Removes a hook from an arraylist of index.
+ */
+
+void
+hook_signal_index_remove_from_list (struct t_arraylist *list,
+                                    struct t_hook *hook)
+{
+    int index;
+
+    if (arraylist_search (list, hook, &index, NULL))
+        arraylist_remove (list, index);
+}
+
+/*
+ * Removes a signal hook from index.
+ */
+
+void
+hook_signal_index_remove (struct t_hook *hook)
+{
+    struct t_arraylist *ptr_list;
+    const char *ptr_signal;
+    int i;
+
+    if (!hook_signal_index_exact || !hook_signal_index_wildcard)
+        return;
+
+    for (i = 0; i < HOOK_SIGNAL(hook, num_signals); i++)
+    {
+        ptr_signal = HOOK_SIGNAL(hook, signals)[i];
+        if (strchr (ptr_signal, '*'))
+        {
+            hook_signal_index_remove_from_list (hook_signal_index_wildcard,
+                                                hook);
+        }
+        else
+        {
+            ptr_list = hashtable_get (hook_signal_index_exact, ptr_signal);
+            if (ptr_list)
+            {
+                hook_signal_index_remove_from_list (ptr_list, hook);
+                if (arraylist_size (ptr_list) == 0)
+                    hashtable_remove (hook_signal_index_exact, ptr_signal);
+            }
+        }
+    }
+
+    if ((hook_signal_index_exact->items_count == 0)
+        && (arraylist_size (hook_signal_index_wildcard) == 0))
+    {
+        hashtable_free (hook_signal_index_exact);
+        hook_signal_index_exact = NULL;
+        arraylist_free (hook_signal_index_wildcard);
+        hook_signal_index_wildcard = NULL;
+    }
+}
+
 /*
  * Hooks a signal.
  *
@@ -61,7 +293,7 @@ hook_signal (struct t_weechat_plugin *plugin, const char *signal,
 {
     struct t_hook *new_hook;
     struct t_hook_signal *new_hook_signal;
-    int priority;
+    int priority, i;
     const char *ptr_signal;
 
     if (!signal || !signal[0] || !callback)
@@ -92,9 +324,26 @@ hook_signal (struct t_weechat_plugin *plugin, const char *signal,
         | WEECHAT_STRING_SPLIT_STRIP_RIGHT
         | WEECHAT_STRING_SPLIT_COLLAPSE_SEPS,
         0, &new_hook_signal->num_signals);
+    new_hook_signal->masks = NULL;
+    if (new_hook_signal->num_signals > 0)
+    {
+        new_hook_signal->masks = malloc (new_hook_signal->num_signals
+                                     * sizeof (new_hook_signal->masks[0]));
+        if (new_hook_signal->masks)
+        {
+            for (i = 0; i < new_hook_signal->num_signals; i++)
+            {
+                new_hook_signal->masks[i] = string_mask_compile (
+                    new_hook_signal->signals[i], 0);
+            }
+        }
+    }
+    new_hook_signal->seq = hook_signal_seq++;
 
     hook_add_to_list (new_hook);
 
+    hook_signal_index_add (new_hook);
+
     return new_hook;
 }
 
@@ -114,36 +363,129 @@ hook_signal_match (const char *signal, struct t_hook *hook)
 
     for (i = 0; i < HOOK_SIGNAL(hook, num_signals); i++)
     {
-        if (string_match (signal, HOOK_SIGNAL(hook, signals)[i], 0))
+        if ((HOOK_SIGNAL(hook, masks) && HOOK_SIGNAL(hook, masks)[i]) ?
+            string_match_compiled (signal, HOOK_SIGNAL(hook, masks)[i]) :
+            string_match (signal, HOOK_SIGNAL(hook, signals)[i], 0))
+        {
             return 1;
+        }
     }
 
     return 0;
 }
 
+/*
+ * Returns the next hook with wildcard matching the signal, starting at
+ * index "*index" in the list of hooks with wildcard; "*index" is set to the
+ * index after the hook found.
+ *
+ * Returns pointer to hook found, NULL if no more hook is matching.
+ */
+
+struct t_hook *
+hook_signal_index_next_wildcard (const char *signal, int *index)
+{
+    struct t_hook *ptr_hook;
+
+    while (*index < arraylist_size (hook_signal_index_wildcard))
+    {
+        ptr_hook = arraylist_get (hook_signal_index_wildcard, *index);
+        (*index)++;
+        if (hook_signal_match (signal, ptr_hook))
+            return ptr_hook;
+    }
+
+    return NULL;
+}
+
 /*
  * Sends a signal.
+ *
+ * Hooks are searched in the index: by exact name in hashtable, then hooks
+ * with wildcard are checked; both lists are merged to call callbacks in the
+ * same order as the list of hooks.
  */
 
 int
 hook_signal_send (const char *signal, const char *type_data, void *signal_data)
 {
-    struct t_hook *ptr_hook, *next_hook;
+    struct t_hook *ptr_hook, *hooks_static[64], **hooks, *hook_exact;
+    struct t_hook *hook_wildcard;
     struct t_hook_exec_cb hook_exec_cb;
-    int rc;
+    struct t_arraylist *ptr_list_exact;
+    int rc, rc_cmp, i, num_hooks, size_exact, size_wildcard, index_exact;
+    int index_wildcard;
 
     rc = WEECHAT_RC_OK;
 
+    if (!signal || !hook_signal_index_exact || !hook_signal_index_wildcard)
+        return rc;
+
+    ptr_list_exact = hashtable_get (hook_signal_index_exact, signal);
+    size_exact = (ptr_list_exact) ? arraylist_size (ptr_list_exact) : 0;
+    size_wildcard = arraylist_size (hook_signal_index_wildcard);
+
+    if (size_exact + size_wildcard == 0)
+        return rc;
+
+    /*
+     * build the list of hooks to call before calling callbacks, because
+     * callbacks can add or remove signal hooks
+     */
+    if (size_exact + size_wildcard <= (int)(sizeof (hooks_static)
+                                            / sizeof (hooks_static[0])))
+    {
+        hooks = hooks_static;
+    }
+    else
+    {
+        hooks = malloc ((size_exact + size_wildcard) * sizeof (*hooks));
+        if (!hooks)
+            return rc;
+    }
+    num_hooks = 0;
+    index_exact = 0;
+    index_wildcard = 0;
+    hook_wildcard = hook_signal_index_next_wildcard (signal, &index_wildcard);
+    while ((index_exact < size_exact) || hook_wildcard)
+    {
+        hook_exact = (index_exact < size_exact) ?
+            arraylist_get (ptr_list_exact, index_exact) : NULL;
+        if (hook_exact && hook_wildcard)
+        {
+            rc_cmp = hook_signal_index_cmp_cb (NULL, NULL,
+                                               hook_exact, hook_wildcard);
+        }
+        else
+        {
+            rc_cmp = (hook_exact) ? -1 : 1;
+        }
+        if (rc_cmp <= 0)
+        {
+            hooks[num_hooks++] = hook_exact;
+            index_exact++;
+            /* same hook matching exact name and a wildcard */
+            if (rc_cmp == 0)
+            {
+                hook_wildcard = hook_signal_index_next_wildcard (
+                    signal, &index_wildcard);
+            }
+        }
+        else
+        {
+            hooks[num_hooks++] = hook_wildcard;
+            hook_wildcard = hook_signal_index_next_wildcard (
+                signal, &index_wildcard);
+        }
+    }
+
     hook_exec_start ();
 
-    ptr_hook = weechat_hooks[HOOK_TYPE_SIGNAL];
-    while (ptr_hook)
+    for (i = 0; i < num_hooks; i++)
     {
-        next_hook = ptr_hook->next_hook;
+        ptr_hook = hooks[i];
 
-        if (!ptr_hook->deleted
-            && !ptr_hook->running
-            && hook_signal_match (signal, ptr_hook))
+        if (!ptr_hook->deleted && !ptr_hook->running)
         {
             hook_callback_start (ptr_hook, &hook_exec_cb);
             rc = (HOOK_SIGNAL(ptr_hook, callback))
@@ -157,12 +499,13 @@ hook_signal_send (const char *signal, const char *type_data, void *signal_data)
             if (rc == WEECHAT_RC_OK_EAT)
                 break;
         }
-
-        ptr_hook = next_hook;
     }
 
     hook_exec_end ();
 
+    if (hooks != hooks_static)
+        free (hooks);
+
     return rc;
 }
 
@@ -173,14 +516,27 @@ hook_signal_send (const char *signal, const char *type_data, void *signal_data)
 void
 hook_signal_free_data (struct t_hook *hook)
 {
+    int i;
+
     if (!hook || !hook->hook_data)
         return;
 
+    hook_signal_index_remove (hook);
+
     if (HOOK_SIGNAL(hook, signals))
     {
         string_free_split (HOOK_SIGNAL(hook, signals));
         HOOK_SIGNAL(hook, signals) = NULL;
     }
+    if (HOOK_SIGNAL(hook, masks))
+    {
+        for (i = 0; i < HOOK_SIGNAL(hook, num_signals); i++)
+        {
+            string_mask_free (HOOK_SIGNAL(hook, masks)[i]);
+        }
+        free (HOOK_SIGNAL(hook, masks));
+        HOOK_SIGNAL(hook, masks) = NULL;
+    }
     HOOK_SIGNAL(hook, num_signals) = 0;
 
     free (hook->hook_data);
@@ -240,4 +596,5 @@ hook_signal_print_log (struct t_hook *hook)
     {
         log_printf ("      '%s'", HOOK_SIGNAL(hook, signals)[i]);
     }
+    log_printf ("    masks . . . . . . . . : %p", HOOK_SIGNAL(hook, masks));
 }
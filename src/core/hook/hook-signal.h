@@ -22,6 +22,8 @@
 
 struct t_weechat_plugin;
 struct t_infolist_item;
+struct t_hashtable;
+struct t_string_mask;
 
 #define HOOK_SIGNAL(hook, var) (((struct t_hook_signal *)hook->hook_data)->var)
 
@@ -36,9 +38,16 @@ struct t_hook_signal
                                        /* begin or end with "*",            */
                                        /* "*" == any signal                 */
     int num_signals;                   /* number of signals                 */
+    struct t_string_mask **masks;      /* compiled signals (num_signals)    */
+    unsigned long long seq;            /* order of creation (used to sort   */
+                                       /* hooks in index)                   */
 };
 
 extern char *hook_signal_get_description (struct t_hook *hook);
+extern unsigned long long hook_signal_hash_key_cb (struct t_hashtable *hashtable,
+                                                  const void *key);
+extern int hook_signal_keycmp_cb (struct t_hashtable *hashtable,
+                                  const void *key1, const void *key2);
 extern struct t_hook *hook_signal (struct t_weechat_plugin *plugin,
                                    const char *signal,
                                    t_hook_callback_signal *callback,
@@ -36,6 +36,14 @@
 
 
 time_t hook_last_system_time = 0;      /* used to detect system clock skew  */
+time_t hook_last_monotonic_time = 0;   /* used to detect system clock skew  */
+
+struct t_hook **hook_timer_heap = NULL; /* min-heap of timers (next_exec)   */
+int hook_timer_heap_size = 0;          /* allocated size of heap            */
+int hook_timer_heap_count = 0;         /* number of timers in heap          */
+struct t_hook **hook_timer_due = NULL; /* timers to run in hook_timer_exec  */
+int hook_timer_due_size = 0;           /* allocated size of hook_timer_due  */
+unsigned long long hook_timer_seq = 0; /* counter for order of creation     */
 
 
 /*
@@ -75,6 +83,171 @@ hook_timer_get_description (struct t_hook *hook)
     return strdup (str_desc);
 }
 
+/*
+ * Compares two timers in heap: by date of next execution, then by order of
+ * creation.
+ *
+ * Returns:
+ *   < 0: timer1 must run before timer2
+ *   > 0: timer1 must run after timer2
+ */
+
+int
+hook_timer_heap_cmp (struct t_hook *timer1, struct t_hook *timer2)
+{
+    int rc;
+
+    rc = util_timeval_cmp (&HOOK_TIMER(timer1, next_exec),
+                           &HOOK_TIMER(timer2, next_exec));
+    if (rc != 0)
+        return rc;
+
+    return (HOOK_TIMER(timer1, seq) < HOOK_TIMER(timer2, seq)) ? -1 : 1;
+}
+
+/*
+ * Sets a timer at a given index in heap.
+ */
+
+void
+hook_timer_heap_set (int index, struct t_hook *hook)
+{
+    hook_timer_heap[index] = hook;
+    HOOK_TIMER(hook, heap_index) = index;
+}
+
+/*
+ * Moves up a timer in heap until its parent runs before it.
+ */
+
+void
+hook_timer_heap_sift_up (int index)
+{
+    struct t_hook *ptr_hook;
+    int parent;
+
+    ptr_hook = hook_timer_heap[index];
+    while (index > 0)
+    {
+        parent = (index - 1) / 2;
+        if (hook_timer_heap_cmp (hook_timer_heap[parent], ptr_hook) <= 0)
+            break;
+        hook_timer_heap_set (index, hook_timer_heap[parent]);
+        index = parent;
+    }
+    hook_timer_heap_set (index, ptr_hook);
+}
+
+/*
+ * Moves down a timer in heap until its children run after it.
+ */
+
+void
+hook_timer_heap_sift_down (int index)
+{
+    struct t_hook *ptr_hook;
+    int child;
+
+    ptr_hook = hook_timer_heap[index];
+    while (1)
+    {
+        child = (2 * index) + 1;
+        if (child >= hook_timer_heap_count)
+            break;
+        if ((child + 1 < hook_timer_heap_count)
+            && (hook_timer_heap_cmp (hook_timer_heap[child + 1],
+                                     hook_timer_heap[child]) < 0))
+        {
+            child++;
+        }
+        if (hook_timer_heap_cmp (ptr_hook, hook_timer_heap[child]) <= 0)
+            break;
+        hook_timer_heap_set (index, hook_timer_heap[child]);
+        index = child;
+    }
+    hook_timer_heap_set (index, ptr_hook);
+}
+
+/*
+ * Adds a timer in heap.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (memory allocation)
+ */
+
+int
+hook_timer_heap_add (struct t_hook *hook)
+{
+    struct t_hook **new_heap;
+    int new_size;
+
+    if (HOOK_TIMER(hook, heap_index) >= 0)
+        return 1;
+
+    if (hook_timer_heap_count >= hook_timer_heap_size)
+    {
+        new_size = (hook_timer_heap_size > 0) ? hook_timer_heap_size * 2 : 32;
+        new_heap = realloc (hook_timer_heap, new_size * sizeof (*new_heap));
+        if (!new_heap)
+            return 0;
+        hook_timer_heap = new_heap;
+        hook_timer_heap_size = new_size;
+    }
+
+    hook_timer_heap_set (hook_timer_heap_count, hook);
+    hook_timer_heap_count++;
+    hook_timer_heap_sift_up (hook_timer_heap_count - 1);
+
+    return 1;
+}
+
+/*
+ * Removes a timer from heap.
+ */
+
+void
+hook_timer_heap_remove (struct t_hook *hook)
+{
+    struct t_hook *ptr_last;
+    int index;
+
+    index = HOOK_TIMER(hook, heap_index);
+    if ((index < 0) || (index >= hook_timer_heap_count)
+        || (hook_timer_heap[index] != hook))
+    {
+        return;
+    }
+
+    HOOK_TIMER(hook, heap_index) = -1;
+    hook_timer_heap_count--;
+
+    /* move last timer at this index, then restore heap order */
+    if (index < hook_timer_heap_count)
+    {
+        ptr_last = hook_timer_heap[hook_timer_heap_count];
+        hook_timer_heap_set (index, ptr_last);
+        hook_timer_heap_sift_up (index);
+        hook_timer_heap_sift_down (HOOK_TIMER(ptr_last, heap_index));
+    }
+}
+
+/*
+ * Rebuilds the heap (called when date of next execution has changed for
+ * all timers).
+ */
+
+void
+hook_timer_heap_rebuild ()
+{
+    int i;
+
+    for (i = (hook_timer_heap_count / 2) - 1; i >= 0; i--)
+    {
+        hook_timer_heap_sift_down (i);
+    }
+}
+
 /*
  * Initializes a timer hook.
  */
@@ -131,6 +304,38 @@ hook_timer_init (struct t_hook *hook)
                       ((long long)HOOK_TIMER(hook, interval)) * 1000);
 }
 
+/*
+ * Callback called when a timer hook is added in the list of hooks.
+ */
+
+void
+hook_timer_add_cb (struct t_hook *hook)
+{
+    hook_timer_heap_add (hook);
+}
+
+/*
+ * Callback called when a timer hook is removed from the list of hooks.
+ */
+
+void
+hook_timer_remove_cb (struct t_hook *hook)
+{
+    /* make C compiler happy */
+    (void) hook;
+
+    if (hooks_count[HOOK_TYPE_TIMER] == 0)
+    {
+        free (hook_timer_heap);
+        hook_timer_heap = NULL;
+        hook_timer_heap_size = 0;
+        hook_timer_heap_count = 0;
+        free (hook_timer_due);
+        hook_timer_due = NULL;
+        hook_timer_due_size = 0;
+    }
+}
+
 /*
  * Hooks a timer.
  *
@@ -167,6 +372,9 @@ hook_timer (struct t_weechat_plugin *plugin, long interval, int align_second,
     new_hook_timer->interval = interval;
     new_hook_timer->align_second = align_second;
     new_hook_timer->remaining_calls = max_calls;
+    new_hook_timer->slack = 0;
+    new_hook_timer->heap_index = -1;
+    new_hook_timer->seq = hook_timer_seq++;
 
     hook_timer_init (new_hook);
 
@@ -176,26 +384,71 @@ hook_timer (struct t_weechat_plugin *plugin, long interval, int align_second,
 }
 
 /*
- * Checks if system clock is older than previous call to this function (that
- * means new time is lower than in past). If yes, adjusts all timers to current
- * time.
+ * Sets a timer hook property (string).
+ */
+
+void
+hook_timer_set (struct t_hook *hook, const char *property, const char *value)
+{
+    char *error;
+    long number;
+
+    if (!hook || hook->deleted || (hook->type != HOOK_TYPE_TIMER)
+        || !property || !value)
+    {
+        return;
+    }
+
+    if (strcmp (property, "slack") == 0)
+    {
+        error = NULL;
+        number = strtol (value, &error, 10);
+        if (error && !error[0] && (number >= 0))
+            HOOK_TIMER(hook, slack) = number;
+    }
+}
+
+/*
+ * Returns time of monotonic clock (in seconds), which is not affected by
+ * changes of system clock.
+ */
+
+time_t
+hook_timer_get_monotonic_time ()
+{
+    struct timespec ts;
+
+    if (clock_gettime (CLOCK_MONOTONIC, &ts) != 0)
+        return time (NULL);
+
+    return ts.tv_sec;
+}
+
+/*
+ * Checks if system clock has changed since previous call to this function
+ * (that means time elapsed on system clock is different from time elapsed on
+ * monotonic clock). If yes, adjusts all timers to current time.
  */
 
 void
 hook_timer_check_system_clock ()
 {
-    time_t now;
+    time_t now, now_monotonic;
     long diff_time;
     struct t_hook *ptr_hook;
 
     now = time (NULL);
+    now_monotonic = hook_timer_get_monotonic_time ();
 
     /*
-     * check if difference with previous time is more than 10 seconds:
-     * if it is, then consider it's clock skew and reinitialize all timers
+     * check if difference between elapsed times on system and monotonic
+     * clocks is more than 10 seconds: if it is, then consider it's clock
+     * skew and reinitialize all timers
      */
-    diff_time = now - hook_last_system_time;
-    if ((diff_time <= -10) || (diff_time >= 10))
+    diff_time = (long)(now - hook_last_system_time)
+        - (long)(now_monotonic - hook_last_monotonic_time);
+    if ((diff_time <= -1 * HOOK_TIMER_MAX_CLOCK_SKEW)
+        || (diff_time >= HOOK_TIMER_MAX_CLOCK_SKEW))
     {
         if (weechat_debug_core >= 1)
         {
@@ -212,87 +465,106 @@ hook_timer_check_system_clock ()
             if (!ptr_hook->deleted)
                 hook_timer_init (ptr_hook);
         }
+        hook_timer_heap_rebuild ();
     }
 
     hook_last_system_time = now;
+    hook_last_monotonic_time = now_monotonic;
 }
 
 /*
- * Returns time until next timeout (in milliseconds).
+ * Lowers the wakeup date with deadlines of timers in heap (from index), each
+ * deadline being the next execution of timer plus its slack.
+ *
+ * Children of a timer in heap are not checked if this timer is scheduled
+ * after the wakeup date, since they are scheduled after it.
  */
 
-int
-hook_timer_get_time_to_next ()
+void
+hook_timer_get_wakeup_heap (int index, struct timeval *tv_wakeup)
 {
-    struct t_hook *ptr_hook;
-    int found, timeout;
-    struct timeval tv_now, tv_timeout;
-    long diff_usec;
-
-    hook_timer_check_system_clock ();
-
-    found = 0;
-    tv_timeout.tv_sec = 0;
-    tv_timeout.tv_usec = 0;
+    struct timeval tv_deadline;
 
-    for (ptr_hook = weechat_hooks[HOOK_TYPE_TIMER]; ptr_hook;
-         ptr_hook = ptr_hook->next_hook)
+    if ((index >= hook_timer_heap_count)
+        || (util_timeval_cmp (&HOOK_TIMER(hook_timer_heap[index], next_exec),
+                              tv_wakeup) >= 0))
     {
-        if (!ptr_hook->deleted
-            && (!found
-                || (util_timeval_cmp (&HOOK_TIMER(ptr_hook, next_exec),
-                                      &tv_timeout) < 0)))
-        {
-            found = 1;
-            tv_timeout.tv_sec = HOOK_TIMER(ptr_hook, next_exec).tv_sec;
-            tv_timeout.tv_usec = HOOK_TIMER(ptr_hook, next_exec).tv_usec;
-        }
+        return;
     }
 
-    /* no timeout found, return 2 seconds by default */
-    if (!found)
+    tv_deadline.tv_sec = HOOK_TIMER(hook_timer_heap[index], next_exec).tv_sec;
+    tv_deadline.tv_usec = HOOK_TIMER(hook_timer_heap[index], next_exec).tv_usec;
+    util_timeval_add (
+        &tv_deadline,
+        ((long long)HOOK_TIMER(hook_timer_heap[index], slack)) * 1000);
+    if (util_timeval_cmp (&tv_deadline, tv_wakeup) < 0)
     {
-        tv_timeout.tv_sec = 2;
-        tv_timeout.tv_usec = 0;
-        goto end;
+        tv_wakeup->tv_sec = tv_deadline.tv_sec;
+        tv_wakeup->tv_usec = tv_deadline.tv_usec;
     }
 
+    hook_timer_get_wakeup_heap ((2 * index) + 1, tv_wakeup);
+    hook_timer_get_wakeup_heap ((2 * index) + 2, tv_wakeup);
+}
+
+/*
+ * Gets date of next wakeup to run timers: this is the lowest deadline of
+ * timers (next execution plus slack), so that timers with a slack can be
+ * delayed and executed at same time as other timers.
+ *
+ * Returns:
+ *   1: wakeup date found
+ *   0: no timer
+ */
+
+int
+hook_timer_get_wakeup (struct timeval *tv_wakeup)
+{
+    if (!tv_wakeup || (hook_timer_heap_count <= 0))
+        return 0;
+
+    /* first timer in heap is the next one to run */
+    tv_wakeup->tv_sec = HOOK_TIMER(hook_timer_heap[0], next_exec).tv_sec;
+    tv_wakeup->tv_usec = HOOK_TIMER(hook_timer_heap[0], next_exec).tv_usec;
+    util_timeval_add (
+        tv_wakeup,
+        ((long long)HOOK_TIMER(hook_timer_heap[0], slack)) * 1000);
+
+    hook_timer_get_wakeup_heap (1, tv_wakeup);
+    hook_timer_get_wakeup_heap (2, tv_wakeup);
+
+    return 1;
+}
+
+/*
+ * Returns time until next timeout (in milliseconds).
+ */
+
+int
+hook_timer_get_time_to_next ()
+{
+    struct timeval tv_now, tv_wakeup;
+    long long diff;
+
+    hook_timer_check_system_clock ();
+
+    /* no timeout found, return max timeout by default */
+    if (!hook_timer_get_wakeup (&tv_wakeup))
+        return HOOK_TIMER_MAX_TIMEOUT;
+
     gettimeofday (&tv_now, NULL);
 
-    /* next timeout is past date! */
-    if (util_timeval_cmp (&tv_timeout, &tv_now) < 0)
-    {
-        tv_timeout.tv_sec = 0;
-        tv_timeout.tv_usec = 0;
-        goto end;
-    }
+    /* number of milliseconds until wakeup (< 0 if past date) */
+    diff = util_timeval_diff (&tv_now, &tv_wakeup) / 1000;
 
-    tv_timeout.tv_sec = tv_timeout.tv_sec - tv_now.tv_sec;
-    diff_usec = tv_timeout.tv_usec - tv_now.tv_usec;
-    if (diff_usec >= 0)
-    {
-        tv_timeout.tv_usec = diff_usec;
-    }
-    else
-    {
-        tv_timeout.tv_sec--;
-        tv_timeout.tv_usec = 1000000 + diff_usec;
-    }
+    if (diff < 1)
+        return 1;
 
     /*
-     * to detect clock skew, we ensure there's a call to timers every
-     * 2 seconds max
+     * wait at most HOOK_TIMER_MAX_TIMEOUT, so that a change of system clock
+     * is not detected too late
      */
-    if (tv_timeout.tv_sec >= 2)
-    {
-        tv_timeout.tv_sec = 2;
-        tv_timeout.tv_usec = 0;
-    }
-
-end:
-    /* return a number of milliseconds */
-    timeout = (tv_timeout.tv_sec * 1000) + (tv_timeout.tv_usec / 1000);
-    return (timeout < 1) ? 1 : timeout;
+    return (diff > HOOK_TIMER_MAX_TIMEOUT) ? HOOK_TIMER_MAX_TIMEOUT : (int)diff;
 }
 
 /*
@@ -302,9 +574,10 @@ end:
 void
 hook_timer_exec ()
 {
-    struct t_hook *ptr_hook, *next_hook;
+    struct t_hook *ptr_hook, **new_due;
     struct t_hook_exec_cb hook_exec_cb;
     struct timeval tv_time;
+    int i, num_due, new_size;
 
     if (!weechat_hooks[HOOK_TYPE_TIMER])
         return;
@@ -313,17 +586,41 @@ hook_timer_exec ()
 
     gettimeofday (&tv_time, NULL);
 
+    /*
+     * remove all timers to run from heap first, so that each timer is
+     * executed at most one time, even if it is late
+     */
+    num_due = 0;
+    while ((hook_timer_heap_count > 0)
+           && (util_timeval_cmp (&HOOK_TIMER(hook_timer_heap[0], next_exec),
+                                 &tv_time) <= 0))
+    {
+        if (num_due >= hook_timer_due_size)
+        {
+            new_size = (hook_timer_due_size > 0) ? hook_timer_due_size * 2 : 32;
+            new_due = realloc (hook_timer_due, new_size * sizeof (*new_due));
+            if (!new_due)
+                break;
+            hook_timer_due = new_due;
+            hook_timer_due_size = new_size;
+        }
+        hook_timer_due[num_due++] = hook_timer_heap[0];
+        hook_timer_heap_remove (hook_timer_heap[0]);
+    }
+
+    if (num_due == 0)
+        return;
+
     hook_exec_start ();
 
-    ptr_hook = weechat_hooks[HOOK_TYPE_TIMER];
-    while (ptr_hook)
+    for (i = 0; i < num_due; i++)
     {
-        next_hook = ptr_hook->next_hook;
+        ptr_hook = hook_timer_due[i];
+
+        if (ptr_hook->deleted)
+            continue;
 
-        if (!ptr_hook->deleted
-            && !ptr_hook->running
-            && (util_timeval_cmp (&HOOK_TIMER(ptr_hook, next_exec),
-                                  &tv_time) <= 0))
+        if (!ptr_hook->running)
         {
             hook_callback_start (ptr_hook, &hook_exec_cb);
             (void) (HOOK_TIMER(ptr_hook, callback))
@@ -350,7 +647,9 @@ hook_timer_exec ()
             }
         }
 
-        ptr_hook = next_hook;
+        /* put timer back in heap with its new date of next execution */
+        if (!ptr_hook->deleted)
+            hook_timer_heap_add (ptr_hook);
     }
 
     hook_exec_end ();
@@ -366,6 +665,8 @@ hook_timer_free_data (struct t_hook *hook)
     if (!hook || !hook->hook_data)
         return;
 
+    hook_timer_heap_remove (hook);
+
     free (hook->hook_data);
     hook->hook_data = NULL;
 }
@@ -396,6 +697,9 @@ hook_timer_add_to_infolist (struct t_infolist_item *item,
         return 0;
     if (!infolist_new_var_integer (item, "remaining_calls", HOOK_TIMER(hook, remaining_calls)))
         return 0;
+    snprintf (value, sizeof (value), "%ld", HOOK_TIMER(hook, slack));
+    if (!infolist_new_var_string (item, "slack", value))
+        return 0;
     if (!infolist_new_var_buffer (item, "last_exec",
                                   &(HOOK_TIMER(hook, last_exec)),
                                   sizeof (HOOK_TIMER(hook, last_exec))))
@@ -425,6 +729,7 @@ hook_timer_print_log (struct t_hook *hook)
     log_printf ("    interval. . . . . . . : %ld", HOOK_TIMER(hook, interval));
     log_printf ("    align_second. . . . . : %d", HOOK_TIMER(hook, align_second));
     log_printf ("    remaining_calls . . . : %d", HOOK_TIMER(hook, remaining_calls));
+    log_printf ("    slack . . . . . . . . : %ld", HOOK_TIMER(hook, slack));
     util_strftimeval (text_time, sizeof (text_time),
                       "%Y-%m-%dT%H:%M:%S.%f", &(HOOK_TIMER(hook, last_exec)));
     log_printf ("    last_exec . . . . . . : %s", text_time);
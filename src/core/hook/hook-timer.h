@@ -26,6 +26,12 @@
 struct t_weechat_plugin;
 struct t_infolist_item;
 
+/* max time to wait in poll (used to detect system clock skew) */
+#define HOOK_TIMER_MAX_TIMEOUT (60 * 1000)
+
+/* max difference between system and monotonic clocks (in seconds) */
+#define HOOK_TIMER_MAX_CLOCK_SKEW 10
+
 #define HOOK_TIMER(hook, var) (((struct t_hook_timer *)hook->hook_data)->var)
 
 typedef int (t_hook_callback_timer)(const void *pointer, void *data,
@@ -38,19 +44,37 @@ struct t_hook_timer
     int align_second;                  /* alignment on a second             */
                                        /* for ex.: 60 = each min. at 0 sec  */
     int remaining_calls;               /* calls remaining (0 = unlimited)   */
+    long slack;                        /* max delay allowed to group this   */
+                                       /* timer with other timers (ms)      */
     struct timeval last_exec;          /* last time hook was executed       */
     struct timeval next_exec;          /* next scheduled execution          */
+    int heap_index;                    /* index in heap of timers (-1 if    */
+                                       /* not in heap)                      */
+    unsigned long long seq;            /* order of creation (used to sort   */
+                                       /* timers with same next_exec)       */
 };
 
 extern time_t hook_last_system_time;
+extern time_t hook_last_monotonic_time;
+extern struct t_hook **hook_timer_heap;
+extern int hook_timer_heap_count;
 
 extern char *hook_timer_get_description (struct t_hook *hook);
+extern int hook_timer_heap_add (struct t_hook *hook);
+extern void hook_timer_heap_remove (struct t_hook *hook);
+extern void hook_timer_add_cb (struct t_hook *hook);
+extern void hook_timer_remove_cb (struct t_hook *hook);
 extern struct t_hook *hook_timer (struct t_weechat_plugin *plugin,
                                   long interval, int align_second,
                                   int max_calls,
                                   t_hook_callback_timer *callback,
                                   const void *callback_pointer,
                                   void *callback_data);
+extern void hook_timer_set (struct t_hook *hook, const char *property,
+                            const char *value);
+extern time_t hook_timer_get_monotonic_time ();
+extern void hook_timer_check_system_clock ();
+extern int hook_timer_get_wakeup (struct timeval *tv_wakeup);
 extern int hook_timer_get_time_to_next ();
 extern void hook_timer_exec ();
 extern void hook_timer_free_data (struct t_hook *hook);
@@ -31,6 +31,7 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <pthread.h>
+#include <curl/curl.h>
 
 #include "../weechat.h"
 #include "../core-hashtable.h"
@@ -43,6 +44,18 @@
 #include "../../plugins/plugin.h"
 
 
+/*
+ * transfers are done in a curl multi handle driven by the main loop (fd and
+ * timer hooks), so that connections, DNS cache and TLS sessions are reused
+ * between URL hooks (with HTTP/2 multiplexing); if libcurl has no
+ * asynchronous DNS resolver, each transfer is done in a thread instead
+ */
+int hook_url_multi_enabled = -1;      /* -1 = not initialized yet           */
+CURLM *hook_url_multi = NULL;         /* curl multi handle                  */
+CURLSH *hook_url_share = NULL;        /* curl share handle (DNS, TLS)       */
+struct t_hook *hook_url_multi_timer = NULL; /* timer requested by curl      */
+
+
 /*
  * Returns description of hook.
  *
@@ -104,6 +117,29 @@ hook_url_run_callback (struct t_hook *hook)
          HOOK_URL(hook, output));
 }
 
+/*
+ * Ends an URL hook: runs the callback and removes the hook.
+ */
+
+void
+hook_url_end_transfer (struct t_hook *hook)
+{
+    const char *ptr_error;
+
+    hook_url_run_callback (hook);
+    ptr_error = hashtable_get (HOOK_URL(hook, output), "error");
+    if ((weechat_debug_core >= 1) && ptr_error && ptr_error[0])
+    {
+        gui_chat_printf (
+            NULL,
+            _("%sURL transfer error: %s (URL: \"%s\")"),
+            gui_chat_prefix[GUI_CHAT_PREFIX_ERROR],
+            ptr_error,
+            HOOK_URL(hook, url));
+    }
+    unhook (hook);
+}
+
 /*
  * Thread cleanup function: mark thread as not running any more.
  */
@@ -149,14 +185,13 @@ hook_url_transfer_thread (void *hook_pointer)
 }
 
 /*
- * Checks if thread is still alive.
+ * Checks if thread is still alive (or if timeout is reached).
  */
 
 int
 hook_url_timer_cb (const void *pointer, void *data, int remaining_calls)
 {
     struct t_hook *hook;
-    const char *ptr_error;
     char str_error[1024], str_error_code[12];
 
     /* make C compiler happy */
@@ -168,20 +203,9 @@ hook_url_timer_cb (const void *pointer, void *data, int remaining_calls)
     if (hook->deleted)
         return WEECHAT_RC_OK;
 
-    if (!HOOK_URL(hook, thread_running))
+    if (!HOOK_URL(hook, transfer) && !HOOK_URL(hook, thread_running))
     {
-        hook_url_run_callback (hook);
-        ptr_error = hashtable_get (HOOK_URL(hook, output), "error");
-        if ((weechat_debug_core >= 1) && ptr_error && ptr_error[0])
-        {
-            gui_chat_printf (
-                NULL,
-                _("%sURL transfer error: %s (URL: \"%s\")"),
-                gui_chat_prefix[GUI_CHAT_PREFIX_ERROR],
-                ptr_error,
-                HOOK_URL(hook, url));
-        }
-        unhook (hook);
+        hook_url_end_transfer (hook);
         return WEECHAT_RC_OK;
     }
 
@@ -205,14 +229,295 @@ hook_url_timer_cb (const void *pointer, void *data, int remaining_calls)
                 HOOK_URL(hook, url),
                 ((float)HOOK_URL(hook, timeout)) / 1000);
         }
-        pthread_cancel (HOOK_URL(hook, thread_id));
-        usleep (1000);
+        if (!HOOK_URL(hook, transfer))
+        {
+            pthread_cancel (HOOK_URL(hook, thread_id));
+            usleep (1000);
+        }
         unhook (hook);
     }
 
     return WEECHAT_RC_OK;
 }
 
+/*
+ * Checks transfers done in curl multi handle: runs callback of their hooks
+ * and removes them.
+ */
+
+void
+hook_url_multi_check_done ()
+{
+    CURLMsg *msg;
+    CURL *curl;
+    struct t_hook *ptr_hook;
+    int msgs_left, curl_rc, url_rc;
+    char *ptr_private, str_error_code[12];
+
+    while ((msg = curl_multi_info_read (hook_url_multi, &msgs_left)))
+    {
+        if (msg->msg != CURLMSG_DONE)
+            continue;
+
+        /* msg is not valid any more after the handle is removed */
+        curl = msg->easy_handle;
+        curl_rc = msg->data.result;
+
+        ptr_private = NULL;
+        curl_easy_getinfo (curl, CURLINFO_PRIVATE, &ptr_private);
+        ptr_hook = (struct t_hook *)ptr_private;
+        if (!ptr_hook || ptr_hook->deleted || !ptr_hook->hook_data
+            || !HOOK_URL(ptr_hook, transfer))
+        {
+            continue;
+        }
+
+        curl_multi_remove_handle (hook_url_multi, curl);
+        url_rc = weeurl_transfer_done (HOOK_URL(ptr_hook, transfer), curl_rc);
+        weeurl_transfer_free (HOOK_URL(ptr_hook, transfer));
+        HOOK_URL(ptr_hook, transfer) = NULL;
+        if (url_rc != 0)
+        {
+            snprintf (str_error_code, sizeof (str_error_code), "%d", url_rc);
+            hashtable_set (HOOK_URL(ptr_hook, output), "error_code",
+                           str_error_code);
+        }
+        hook_url_end_transfer (ptr_hook);
+    }
+}
+
+/*
+ * Callback for activity on a socket used by curl multi handle.
+ */
+
+int
+hook_url_multi_fd_cb (const void *pointer, void *data, int fd)
+{
+    int running;
+
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+
+    curl_multi_socket_action (hook_url_multi, fd, 0, &running);
+    hook_url_multi_check_done ();
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Callback for timer requested by curl multi handle.
+ */
+
+int
+hook_url_multi_timer_cb (const void *pointer, void *data, int remaining_calls)
+{
+    int running;
+
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) remaining_calls;
+
+    /* this timer is called once, it is removed after this callback */
+    hook_url_multi_timer = NULL;
+
+    curl_multi_socket_action (hook_url_multi, CURL_SOCKET_TIMEOUT, 0, &running);
+    hook_url_multi_check_done ();
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Callback called by curl to watch (or stop watching) a socket.
+ */
+
+int
+hook_url_multi_socket_function (CURL *curl, curl_socket_t socket, int what,
+                                void *user_pointer, void *socket_pointer)
+{
+    struct t_hook *ptr_hook_fd;
+    int flags;
+
+    /* make C compiler happy */
+    (void) curl;
+    (void) user_pointer;
+
+    ptr_hook_fd = (struct t_hook *)socket_pointer;
+
+    if (what == CURL_POLL_REMOVE)
+    {
+        if (ptr_hook_fd)
+        {
+            unhook (ptr_hook_fd);
+            curl_multi_assign (hook_url_multi, socket, NULL);
+        }
+        return 0;
+    }
+
+    flags = 0;
+    if (what & CURL_POLL_IN)
+        flags |= HOOK_FD_FLAG_READ;
+    if (what & CURL_POLL_OUT)
+        flags |= HOOK_FD_FLAG_WRITE;
+
+    if (ptr_hook_fd && hook_valid (ptr_hook_fd) && !ptr_hook_fd->deleted)
+    {
+        HOOK_FD(ptr_hook_fd, flags) = flags;
+    }
+    else
+    {
+        ptr_hook_fd = hook_fd (NULL, socket,
+                               (flags & HOOK_FD_FLAG_READ) ? 1 : 0,
+                               (flags & HOOK_FD_FLAG_WRITE) ? 1 : 0,
+                               0,
+                               &hook_url_multi_fd_cb, NULL, NULL);
+        curl_multi_assign (hook_url_multi, socket, ptr_hook_fd);
+    }
+
+    return 0;
+}
+
+/*
+ * Callback called by curl to set the timer of multi handle.
+ */
+
+int
+hook_url_multi_timer_function (CURLM *multi, long timeout_ms,
+                               void *user_pointer)
+{
+    /* make C compiler happy */
+    (void) multi;
+    (void) user_pointer;
+
+    if (hook_url_multi_timer)
+    {
+        unhook (hook_url_multi_timer);
+        hook_url_multi_timer = NULL;
+    }
+
+    /* timeout_ms == -1: delete the timer */
+    if (timeout_ms >= 0)
+    {
+        hook_url_multi_timer = hook_timer (NULL,
+                                           (timeout_ms > 0) ? timeout_ms : 1,
+                                           0, 1,
+                                           &hook_url_multi_timer_cb,
+                                           NULL, NULL);
+    }
+
+    return 0;
+}
+
+/*
+ * Initializes curl multi and share handles (first time this function is
+ * called).
+ *
+ * Returns:
+ *   1: curl multi handle can be used
+ *   0: transfers must be done in threads
+ */
+
+int
+hook_url_multi_init ()
+{
+    curl_version_info_data *info;
+
+    if (hook_url_multi_enabled >= 0)
+        return hook_url_multi_enabled;
+
+    hook_url_multi_enabled = 0;
+
+    /* a synchronous DNS resolver would block the main loop */
+    info = curl_version_info (CURLVERSION_NOW);
+    if (!info || !(info->features & CURL_VERSION_ASYNCHDNS))
+        return 0;
+
+    hook_url_multi = curl_multi_init ();
+    if (!hook_url_multi)
+        return 0;
+
+    curl_multi_setopt (hook_url_multi, CURLMOPT_SOCKETFUNCTION,
+                       &hook_url_multi_socket_function);
+    curl_multi_setopt (hook_url_multi, CURLMOPT_TIMERFUNCTION,
+                       &hook_url_multi_timer_function);
+    curl_multi_setopt (hook_url_multi, CURLMOPT_PIPELINING,
+                       (long)CURLPIPE_MULTIPLEX);
+
+    /* DNS cache and TLS sessions shared by all transfers */
+    hook_url_share = curl_share_init ();
+    if (hook_url_share)
+    {
+        curl_share_setopt (hook_url_share, CURLSHOPT_SHARE,
+                           CURL_LOCK_DATA_DNS);
+        curl_share_setopt (hook_url_share, CURLSHOPT_SHARE,
+                           CURL_LOCK_DATA_SSL_SESSION);
+    }
+
+    hook_url_multi_enabled = 1;
+
+    return 1;
+}
+
+/*
+ * Starts transfer for an URL hook in the curl multi handle.
+ */
+
+void
+hook_url_transfer_multi (struct t_hook *hook)
+{
+    struct t_url_transfer *transfer;
+    CURLMcode multi_rc;
+    int url_rc;
+    char str_error[1024], str_error_code[12];
+
+    transfer = weeurl_transfer_new (HOOK_URL(hook, url),
+                                    HOOK_URL(hook, options),
+                                    HOOK_URL(hook, output));
+    if (!transfer)
+    {
+        hashtable_set (HOOK_URL(hook, output), "error", "not enough memory");
+        hashtable_set (HOOK_URL(hook, output), "error_code", "3");
+        hook_url_end_transfer (hook);
+        return;
+    }
+
+    if (transfer->rc == 0)
+    {
+        curl_easy_setopt (transfer->curl, CURLOPT_PRIVATE, hook);
+        curl_easy_setopt (transfer->curl, CURLOPT_PIPEWAIT, 1L);
+        if (hook_url_share)
+            curl_easy_setopt (transfer->curl, CURLOPT_SHARE, hook_url_share);
+        multi_rc = curl_multi_add_handle (hook_url_multi, transfer->curl);
+        if (multi_rc == CURLM_OK)
+        {
+            HOOK_URL(hook, transfer) = transfer;
+            if (HOOK_URL(hook, timeout) > 0)
+            {
+                HOOK_URL(hook, hook_timer) = hook_timer (
+                    hook->plugin, HOOK_URL(hook, timeout), 0, 1,
+                    &hook_url_timer_cb, hook, NULL);
+            }
+            return;
+        }
+        snprintf (str_error, sizeof (str_error),
+                  "error calling curl_multi_add_handle: %s",
+                  curl_multi_strerror (multi_rc));
+        hashtable_set (HOOK_URL(hook, output), "error", str_error);
+        hashtable_set (HOOK_URL(hook, output), "error_code", "5");
+        weeurl_transfer_free (transfer);
+        hook_url_end_transfer (hook);
+        return;
+    }
+
+    /* error when initializing transfer */
+    url_rc = weeurl_transfer_done (transfer, CURLE_OK);
+    weeurl_transfer_free (transfer);
+    snprintf (str_error_code, sizeof (str_error_code), "%d", url_rc);
+    hashtable_set (HOOK_URL(hook, output), "error_code", str_error_code);
+    hook_url_end_transfer (hook);
+}
+
 /*
  * Starts transfer for an URL hook.
  */
@@ -224,6 +529,12 @@ hook_url_transfer (struct t_hook *hook)
     long interval;
     char str_error[1024], str_error_code[12], str_error_code_pthread[12];
 
+    if (hook_url_multi_init ())
+    {
+        hook_url_transfer_multi (hook);
+        return;
+    }
+
     HOOK_URL(hook, thread_running) = 1;
 
     /* create thread */
@@ -321,6 +632,7 @@ hook_url (struct t_weechat_plugin *plugin,
     new_hook_url->url = strdup (url);
     new_hook_url->options = (options) ? hashtable_dup (options) : NULL;
     new_hook_url->timeout = timeout;
+    new_hook_url->transfer = NULL;
     new_hook_url->thread_id = 0;
     new_hook_url->thread_created = 0;
     new_hook_url->thread_running = 0;
@@ -379,6 +691,13 @@ hook_url_free_data (struct t_hook *hook)
         unhook (HOOK_URL(hook, hook_timer));
         HOOK_URL(hook, hook_timer) = NULL;
     }
+    if (HOOK_URL(hook, transfer))
+    {
+        curl_multi_remove_handle (hook_url_multi,
+                                  HOOK_URL(hook, transfer)->curl);
+        weeurl_transfer_free (HOOK_URL(hook, transfer));
+        HOOK_URL(hook, transfer) = NULL;
+    }
     if (HOOK_URL(hook, thread_running))
     {
         pthread_cancel (HOOK_URL(hook, thread_id));
@@ -396,6 +715,28 @@ hook_url_free_data (struct t_hook *hook)
     hook->hook_data = NULL;
 }
 
+/*
+ * Ends URL hooks: frees curl multi and share handles (must be called after
+ * all hooks have been removed).
+ */
+
+void
+hook_url_end ()
+{
+    if (hook_url_multi)
+    {
+        curl_multi_cleanup (hook_url_multi);
+        hook_url_multi = NULL;
+    }
+    if (hook_url_share)
+    {
+        curl_share_cleanup (hook_url_share);
+        hook_url_share = NULL;
+    }
+    hook_url_multi_timer = NULL;
+    hook_url_multi_enabled = -1;
+}
+
 /*
  * Adds url hook data in the infolist item.
  *
@@ -419,6 +760,8 @@ hook_url_add_to_infolist (struct t_infolist_item *item,
         return 0;
     if (!infolist_new_var_integer (item, "timeout", (int)(HOOK_URL(hook, timeout))))
         return 0;
+    if (!infolist_new_var_pointer (item, "transfer", HOOK_URL(hook, transfer)))
+        return 0;
     if (!infolist_new_var_integer (item, "thread_created", (int)(HOOK_URL(hook, thread_created))))
         return 0;
     if (!infolist_new_var_integer (item, "thread_running", (int)(HOOK_URL(hook, thread_running))))
@@ -449,6 +792,7 @@ hook_url_print_log (struct t_hook *hook)
                 hashtable_get_string (HOOK_URL(hook, options),
                                       "keys_values"));
     log_printf ("    timeout . . . . . . . : %ld", HOOK_URL(hook, timeout));
+    log_printf ("    transfer. . . . . . . : %p", HOOK_URL(hook, transfer));
     log_printf ("    thread_created. . . . : %d", (int)HOOK_URL(hook, thread_created));
     log_printf ("    thread_running. . . . : %d", (int)HOOK_URL(hook, thread_running));
     log_printf ("    hook_timer. . . . . . : %p", HOOK_URL(hook, hook_timer));
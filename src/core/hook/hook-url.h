@@ -23,6 +23,7 @@
 struct t_weechat_plugin;
 struct t_infolist_item;
 struct t_hashtable;
+struct t_url_transfer;
 
 #define HOOK_URL(hook, var) (((struct t_hook_url *)hook->hook_data)->var)
 
@@ -37,10 +38,13 @@ struct t_hook_url
     char *url;                         /* URL                               */
     struct t_hashtable *options;       /* URL options (see doc)             */
     long timeout;                      /* timeout (ms) (0 = no timeout)     */
+    struct t_url_transfer *transfer;   /* transfer in curl multi handle     */
+                                       /* (NULL if done in a thread)        */
     pthread_t thread_id;               /* thread id                         */
     int thread_created;                /* thread created                    */
     int thread_running;                /* 1 if thread is running            */
-    struct t_hook *hook_timer;         /* timer to check if thread has ended*/
+    struct t_hook *hook_timer;         /* timer for timeout / to check if   */
+                                       /* thread has ended                  */
     struct t_hashtable *output;        /* URL transfer output data          */
 };
 
@@ -53,6 +57,7 @@ extern struct t_hook *hook_url (struct t_weechat_plugin *plugin,
                                 const void *callback_pointer,
                                 void *callback_data);
 extern void hook_url_free_data (struct t_hook *hook);
+extern void hook_url_end ();
 extern int hook_url_add_to_infolist (struct t_infolist_item *item,
                                          struct t_hook *hook);
 extern void hook_url_print_log (struct t_hook *hook);
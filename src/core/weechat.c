@@ -68,11 +68,13 @@
 #include "core-list.h"
 #include "core-log.h"
 #include "core-network.h"
+#include "core-profile.h"
 #include "core-proxy.h"
 #include "core-secure.h"
 #include "core-secure-config.h"
 #include "core-signal.h"
 #include "core-string.h"
+#include "core-thread.h"
 #include "core-upgrade.h"
 #include "core-url.h"
 #include "core-utf8.h"
@@ -82,8 +84,10 @@
 #include "../gui/gui-color.h"
 #include "../gui/gui-completion.h"
 #include "../gui/gui-focus.h"
+#include "../gui/gui-history.h"
 #include "../gui/gui-key.h"
 #include "../gui/gui-layout.h"
+#include "../gui/gui-line-segment.h"
 #include "../gui/gui-main.h"
 #include "../plugins/plugin.h"
 #include "../plugins/plugin-api.h"
@@ -97,6 +101,7 @@
 int weechat_headless = 0;              /* 1 if running headless (no GUI)    */
 int weechat_daemon = 0;                /* 1 if daemonized (no foreground)   */
 int weechat_log_stdout = 0;            /* 1 to log messages on stdout       */
+int weechat_no_render = 0;             /* 1 to never draw windows and bars  */
 int weechat_debug_core = 0;            /* debug level for core              */
 char *weechat_argv0 = NULL;            /* WeeChat binary file name (argv[0])*/
 int weechat_upgrading = 0;             /* =1 if WeeChat is upgrading        */
@@ -227,6 +232,14 @@ weechat_display_usage ()
             stdout,
             _("                           (option ignored if option "
               "\"--daemon\" is given)\n"));
+        string_fprintf (
+            stdout,
+            _("      --no-render          do not draw windows and bars "
+              "(bar items are built only when their\n"));
+        string_fprintf (
+            stdout,
+            _("                           content is requested, for "
+              "example by a relay client)\n"));
         string_fprintf (stdout, "\n");
     }
 
@@ -622,8 +635,11 @@ weechat_init_gettext ()
 void
 weechat_init (int argc, char *argv[], void (*gui_init_cb)())
 {
+    struct timeval tv_phase;
+
     weechat_first_start_time = time (NULL); /* initialize start time        */
     gettimeofday (&weechat_current_start_timeval, NULL);
+    tv_phase = weechat_current_start_timeval;
 
     /* set the seed for the pseudo-random integer generator */
     srand ((weechat_current_start_timeval.tv_sec
@@ -635,6 +651,8 @@ weechat_init (int argc, char *argv[], void (*gui_init_cb)())
     signal_init ();                     /* initialize signals               */
     hdata_init ();                      /* initialize hdata                 */
     hook_init ();                       /* initialize hooks                 */
+    profile_startup_init ();            /* start record of startup profile  */
+    thread_init ();                     /* initialize thread posts          */
     debug_init ();                      /* hook signals for debug           */
     gui_color_init ();                  /* initialize colors                */
     gui_chat_init ();                   /* initialize chat                  */
@@ -651,13 +669,16 @@ weechat_init (int argc, char *argv[], void (*gui_init_cb)())
     weechat_parse_args (argc, argv);    /* parse command line args          */
     dir_create_home_dirs ();            /* create WeeChat home directories  */
     log_init ();                        /* init log file                    */
+    profile_startup_phase ("init", &tv_phase);
     plugin_api_init ();                 /* create some hooks (info,hdata,..)*/
     secure_config_read ();              /* read secured data options        */
     config_weechat_read ();             /* read WeeChat options             */
     network_init_gnutls ();             /* init GnuTLS                      */
+    profile_startup_phase ("config", &tv_phase);
 
     if (gui_init_cb)
         (*gui_init_cb) ();              /* init WeeChat interface           */
+    profile_startup_phase ("gui", &tv_phase);
 
     if (weechat_upgrading)
     {
@@ -666,19 +687,30 @@ weechat_init (int argc, char *argv[], void (*gui_init_cb)())
         else
             weechat_upgrading = 0;
     }
+    if (!weechat_upgrading)
+    {
+        gui_history_file_read ();       /* read history file                */
+        gui_line_segment_remove_all_files (); /* remove old lines on disk   */
+    }
+    profile_startup_phase ((weechat_upgrading) ? "upgrade" : "history",
+                           &tv_phase);
     if (!weechat_doc_gen)
         weechat_startup_message ();     /* display WeeChat startup message  */
     gui_chat_print_lines_waiting_buffer (NULL); /* display lines waiting    */
     weechat_term_check ();              /* warning about wrong $TERM        */
     weechat_locale_check ();            /* warning about wrong locale       */
     command_startup (0);                /* command executed before plugins  */
+    profile_startup_phase ("startup_commands", &tv_phase);
     plugin_init (weechat_force_plugin_autoload, /* init plugin interface(s) */
                  argc, argv);
+    profile_startup_phase ("plugins", &tv_phase);
     command_startup (1);                /* commands executed after plugins  */
     if (!weechat_upgrading)
         gui_layout_window_apply (gui_layout_current, -1);
     if (weechat_upgrading)
         upgrade_weechat_end ();         /* remove .upgrade files + signal   */
+    profile_startup_phase ("end", &tv_phase);
+    profile_startup_end ();             /* end record of startup profile    */
 
     if (weechat_doc_gen)
     {
@@ -708,7 +740,11 @@ weechat_end (void (*gui_end_cb)(int clean_exit))
     secure_config_free ();              /* free secured data options        */
     config_file_free_all ();            /* free all configuration files     */
     gui_key_end ();                     /* remove all keys                  */
+    profile_end ();                     /* end profiler                     */
+    thread_end ();                      /* end thread posts                 */
     unhook_all ();                      /* remove all hooks                 */
+    hook_url_end ();                    /* end URL transfers (curl multi)   */
+    eval_end ();                        /* end eval                         */
     hdata_end ();                       /* end hdata                        */
     secure_end ();                      /* end secured data                 */
     string_end ();                      /* end string                       */
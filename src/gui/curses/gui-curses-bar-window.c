@@ -68,11 +68,91 @@ gui_bar_window_objects_init (struct t_gui_bar_window *bar_window)
         bar_window->gui_objects = new_objects;
         GUI_BAR_WINDOW_OBJECTS(bar_window)->win_bar = NULL;
         GUI_BAR_WINDOW_OBJECTS(bar_window)->win_separator = NULL;
+        GUI_BAR_WINDOW_OBJECTS(bar_window)->draw_content = NULL;
         return 1;
     }
     return 0;
 }
 
+/*
+ * Resets content of last draw of a bar window: next draw will redraw the
+ * whole bar window.
+ */
+
+void
+gui_bar_window_draw_cache_reset (struct t_gui_bar_window *bar_window)
+{
+    if (!bar_window || !bar_window->gui_objects)
+        return;
+
+    free (GUI_BAR_WINDOW_OBJECTS(bar_window)->draw_content);
+    GUI_BAR_WINDOW_OBJECTS(bar_window)->draw_content = NULL;
+}
+
+/*
+ * Checks if a bar window has already been drawn with this content and same
+ * state (size, scroll, colors, window), so that Curses window already
+ * displays it.
+ *
+ * Returns:
+ *   1: bar window is unchanged
+ *   0: bar window must be drawn
+ */
+
+int
+gui_bar_window_draw_cache_match (struct t_gui_bar_window *bar_window,
+                                 struct t_gui_window *window,
+                                 const char *content, int color_bg)
+{
+    struct t_gui_bar_window_curses_objects *ptr_objects;
+
+    ptr_objects = GUI_BAR_WINDOW_OBJECTS(bar_window);
+
+    return (content
+            && ptr_objects->draw_content
+            && (ptr_objects->draw_window == window)
+            && (ptr_objects->draw_current_window == (window == gui_current_window))
+            && (ptr_objects->draw_color_bg == color_bg)
+            && (ptr_objects->draw_width == bar_window->width)
+            && (ptr_objects->draw_height == bar_window->height)
+            && (ptr_objects->draw_scroll_x == bar_window->scroll_x)
+            && (ptr_objects->draw_scroll_y == bar_window->scroll_y)
+            && (ptr_objects->draw_lines_start == bar_window->content_lines_start)
+            && (ptr_objects->draw_lines_total == bar_window->content_lines_total)
+            && (ptr_objects->draw_max_length == bar_window->content_max_length)
+            && (strcmp (ptr_objects->draw_content, content) == 0)) ? 1 : 0;
+}
+
+/*
+ * Saves content and state of a bar window after it has been drawn.
+ *
+ * The content is freed by this function (it is stored in bar window and
+ * will be freed on next draw or when the bar window is freed).
+ */
+
+void
+gui_bar_window_draw_cache_save (struct t_gui_bar_window *bar_window,
+                                struct t_gui_window *window,
+                                char *content, int color_bg)
+{
+    struct t_gui_bar_window_curses_objects *ptr_objects;
+
+    ptr_objects = GUI_BAR_WINDOW_OBJECTS(bar_window);
+
+    free (ptr_objects->draw_content);
+    ptr_objects->draw_content = content;
+    ptr_objects->draw_window = window;
+    ptr_objects->draw_current_window = (window == gui_current_window) ? 1 : 0;
+    ptr_objects->draw_color_bg = color_bg;
+    ptr_objects->draw_width = bar_window->width;
+    ptr_objects->draw_height = bar_window->height;
+    ptr_objects->draw_scroll_x = bar_window->scroll_x;
+    ptr_objects->draw_scroll_y = bar_window->scroll_y;
+    ptr_objects->draw_lines_start = bar_window->content_lines_start;
+    ptr_objects->draw_lines_total = bar_window->content_lines_total;
+    ptr_objects->draw_max_length = bar_window->content_max_length;
+}
+
 /*
  * Frees Curses windows for a bar window.
  */
@@ -93,6 +173,7 @@ gui_bar_window_objects_free (struct t_gui_bar_window *bar_window)
         delwin (GUI_BAR_WINDOW_OBJECTS(bar_window)->win_separator);
         GUI_BAR_WINDOW_OBJECTS(bar_window)->win_separator = NULL;
     }
+    gui_bar_window_draw_cache_reset (bar_window);
 }
 
 /*
@@ -118,6 +199,7 @@ gui_bar_window_create_win (struct t_gui_bar_window *bar_window)
         delwin (GUI_BAR_WINDOW_OBJECTS(bar_window)->win_separator);
         GUI_BAR_WINDOW_OBJECTS(bar_window)->win_separator = NULL;
     }
+    gui_bar_window_draw_cache_reset (bar_window);
 
     if ((bar_window->x >= 0) && (bar_window->y >= 0))
     {
@@ -532,7 +614,7 @@ gui_bar_window_draw (struct t_gui_bar_window *bar_window,
 {
     int x, y, items_count, num_lines, line, color_bg, bar_position, bar_size;
     enum t_gui_bar_filling bar_filling;
-    char *content, *content2, **items;
+    char *content, *content2, *content_drawn, **items;
     static char str_start_input[16] = { '\0' };
     static char str_start_input_hidden[16] = { '\0' };
     static char str_cursor[16] = { '\0' };
@@ -543,7 +625,7 @@ gui_bar_window_draw (struct t_gui_bar_window *bar_window,
     int chars_available, index, size;
     int length_screen_before_cursor, length_screen_after_cursor;
     int diff, max_length, optimal_number_of_lines;
-    int some_data_not_displayed;
+    int some_data_not_displayed, lines_start, lines_total;
     int index_item, index_subitem, index_line;
 
     if (!gui_init_ok)
@@ -579,6 +661,27 @@ gui_bar_window_draw (struct t_gui_bar_window *bar_window,
                   GUI_COLOR_BAR_MOVE_CURSOR_CHAR);
     }
 
+    bar_position = CONFIG_ENUM(bar_window->bar->options[GUI_BAR_OPTION_POSITION]);
+    bar_filling = gui_bar_get_filling (bar_window->bar);
+    bar_size = CONFIG_INTEGER(bar_window->bar->options[GUI_BAR_OPTION_SIZE]);
+
+    content = gui_bar_window_content_get_with_filling (bar_window, window,
+                                                       &num_spacers);
+
+    /*
+     * same content and state as last draw: the Curses window already
+     * displays it, so coords and cursor position are kept and only the
+     * cursor and separator are refreshed
+     */
+    if (gui_bar_window_draw_cache_match (bar_window, window, content,
+                                         color_bg))
+    {
+        free (content);
+        goto end;
+    }
+    gui_bar_window_draw_cache_reset (bar_window);
+    content_drawn = (content) ? strdup (content) : NULL;
+
     /*
      * these values will be overwritten later (by gui_bar_window_print_string)
      * if cursor has to move somewhere in bar window
@@ -594,12 +697,6 @@ gui_bar_window_draw (struct t_gui_bar_window *bar_window,
 
     gui_window_current_emphasis = 0;
 
-    bar_position = CONFIG_ENUM(bar_window->bar->options[GUI_BAR_OPTION_POSITION]);
-    bar_filling = gui_bar_get_filling (bar_window->bar);
-    bar_size = CONFIG_INTEGER(bar_window->bar->options[GUI_BAR_OPTION_SIZE]);
-
-    content = gui_bar_window_content_get_with_filling (bar_window, window,
-                                                       &num_spacers);
     if (content)
     {
         utf8_normalize (content, '?');
@@ -666,6 +763,11 @@ gui_bar_window_draw (struct t_gui_bar_window *bar_window,
                         num_lines = 1;
                     optimal_number_of_lines += num_lines;
                 }
+                if ((bar_window->content_scroll_y >= 0)
+                    && (bar_window->content_max_length > max_length))
+                {
+                    max_length = bar_window->content_max_length;
+                }
                 if (max_length == 0)
                     max_length = 1;
 
@@ -696,10 +798,21 @@ gui_bar_window_draw (struct t_gui_bar_window *bar_window,
             x = 0;
             y = 0;
             some_data_not_displayed = 0;
+            /* content may have only lines displayed (see gui-bar-window.c) */
+            if (bar_window->content_scroll_y >= 0)
+            {
+                lines_start = bar_window->content_lines_start;
+                lines_total = bar_window->content_lines_total;
+            }
+            else
+            {
+                lines_start = 0;
+                lines_total = items_count;
+            }
             if ((bar_window->scroll_y > 0)
-                && (bar_window->scroll_y > items_count - bar_window->height))
+                && (bar_window->scroll_y > lines_total - bar_window->height))
             {
-                bar_window->scroll_y = items_count - bar_window->height;
+                bar_window->scroll_y = lines_total - bar_window->height;
                 if (bar_window->scroll_y < 0)
                     bar_window->scroll_y = 0;
             }
@@ -783,7 +896,7 @@ gui_bar_window_draw (struct t_gui_bar_window *bar_window,
                 }
 
                 if ((bar_window->scroll_y == 0)
-                    || (line >= bar_window->scroll_y))
+                    || (lines_start + line >= bar_window->scroll_y))
                 {
                     if (!gui_bar_window_print_string (bar_window,
                                                       window,
@@ -857,7 +970,8 @@ gui_bar_window_draw (struct t_gui_bar_window *bar_window,
                 }
             }
             if ((bar_window->cursor_x < 0) && (bar_window->cursor_y < 0)
-                && (some_data_not_displayed || (line < items_count)))
+                && (some_data_not_displayed
+                    || (lines_start + line < lines_total)))
             {
                 ptr_string = (bar_filling == GUI_BAR_FILLING_HORIZONTAL) ?
                     CONFIG_STRING(config_look_bar_more_right) :
@@ -889,6 +1003,13 @@ gui_bar_window_draw (struct t_gui_bar_window *bar_window,
                           CONFIG_COLOR(bar_window->bar->options[color_bg]));
     }
 
+    if (content_drawn)
+    {
+        gui_bar_window_draw_cache_save (bar_window, window, content_drawn,
+                                        color_bg);
+    }
+
+end:
     /*
      * move cursor if it was asked in an item content (input_text does that
      * to move cursor in user input text)
@@ -27,6 +27,17 @@ struct t_gui_bar_window_curses_objects
 {
     WINDOW *win_bar;                /* bar Curses window                    */
     WINDOW *win_separator;          /* separator (optional)                 */
+    char *draw_content;             /* content of last draw (NULL = none)   */
+    struct t_gui_window *draw_window; /* window used for last draw          */
+    int draw_current_window;        /* 1 if window was current window       */
+    int draw_color_bg;              /* bg color option used for last draw   */
+    int draw_width;                 /* width of bar window for last draw    */
+    int draw_height;                /* height of bar window for last draw   */
+    int draw_scroll_x;              /* scroll_x after last draw             */
+    int draw_scroll_y;              /* scroll_y after last draw             */
+    int draw_lines_start;           /* content_lines_start for last draw    */
+    int draw_lines_total;           /* content_lines_total for last draw    */
+    int draw_max_length;            /* content_max_length for last draw     */
 };
 
 #endif /* WEECHAT_GUI_CURSES_BAR_WINDOW_H */
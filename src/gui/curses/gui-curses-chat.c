@@ -24,6 +24,7 @@
 #endif
 
 #include <stdlib.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
@@ -42,9 +43,11 @@
 #include "../gui-color.h"
 #include "../gui-hotlist.h"
 #include "../gui-line.h"
+#include "../gui-line-compress.h"
 #include "../gui-main.h"
 #include "../gui-window.h"
 #include "gui-curses.h"
+#include "gui-curses-chat.h"
 #include "gui-curses-main.h"
 #include "gui-curses-window.h"
 
@@ -1414,7 +1417,7 @@ gui_chat_display_line (struct t_gui_window *window, struct t_gui_line *line,
             return 0;
         x = window->win_chat_cursor_x;
         y = window->win_chat_cursor_y;
-        num_lines = gui_chat_display_line (window, line, 0, 1);
+        num_lines = gui_chat_get_line_rows (window, line);
         window->win_chat_cursor_x = x;
         window->win_chat_cursor_y = y;
         gui_window_current_emphasis = 0;
@@ -1805,6 +1808,118 @@ gui_chat_display_line_y (struct t_gui_window *window, struct t_gui_line *line,
     free (message_with_search);
 }
 
+/*
+ * Returns number of rows of a line in a window (same as a simulated display
+ * of the line).
+ *
+ * The number of rows is cached in the window (computing it requires to build
+ * the whole line), and the cache is used as long as the context used to
+ * compute it (width, neighbor lines, read marker, prefix length, ...) has not
+ * changed.
+ *
+ * First and last lines are not cached, because the day change message
+ * displayed before/after them depends on current date.
+ */
+
+int
+gui_chat_get_line_rows (struct t_gui_window *window, struct t_gui_line *line)
+{
+    struct t_gui_chat_layout layout, *ptr_layout;
+    struct t_hashtable *ptr_cache;
+
+    if (!line)
+        return 0;
+
+    ptr_cache = GUI_WINDOW_OBJECTS(window)->chat_layout;
+
+    memset (&layout, 0, sizeof (layout));
+    layout.prev_line = gui_line_get_prev_displayed (line);
+    layout.next_line = gui_line_get_next_displayed (line);
+    if (!ptr_cache || !layout.prev_line || !layout.next_line
+        || (window->buffer->text_search == GUI_BUFFER_SEARCH_LINES))
+    {
+        return gui_chat_display_line (window, line, 0, 1);
+    }
+
+    layout.data = line->data;
+    layout.lines = window->buffer->lines;
+    layout.width = gui_chat_get_real_width (window);
+    layout.prefix_max_length = window->buffer->lines->prefix_max_length;
+    layout.buffer_max_length = window->buffer->lines->buffer_max_length;
+    layout.time_for_each_line = window->buffer->time_for_each_line;
+    layout.day_change = window->buffer->day_change;
+    layout.display_tags = gui_chat_display_tags;
+    layout.marker = gui_chat_marker_for_line (window->buffer, line);
+
+    ptr_layout = hashtable_get (ptr_cache, line);
+    if (ptr_layout
+        && (memcmp (ptr_layout, &layout,
+                    offsetof (struct t_gui_chat_layout, rows)) == 0))
+    {
+        return ptr_layout->rows;
+    }
+
+    layout.rows = gui_chat_display_line (window, line, 0, 1);
+
+    if (ptr_layout)
+    {
+        memcpy (ptr_layout, &layout, sizeof (layout));
+    }
+    else
+    {
+        if (ptr_cache->items_count >= GUI_CHAT_LAYOUT_MAX_LINES)
+            hashtable_remove_all (ptr_cache);
+        hashtable_set_with_size (ptr_cache, line, 0, &layout, sizeof (layout));
+    }
+
+    return layout.rows;
+}
+
+/*
+ * Removes a line from cache of lines rows in a window.
+ */
+
+void
+gui_chat_layout_remove_line (struct t_gui_window *window,
+                             struct t_gui_line *line)
+{
+    if (!window || !window->gui_objects)
+        return;
+
+    if (GUI_WINDOW_OBJECTS(window)->chat_last_line == line)
+        gui_chat_last_line_reset (window);
+
+    if (GUI_WINDOW_OBJECTS(window)->chat_layout)
+        hashtable_remove (GUI_WINDOW_OBJECTS(window)->chat_layout, line);
+}
+
+/*
+ * Clears cache of lines rows in a window.
+ */
+
+void
+gui_chat_layout_clear (struct t_gui_window *window)
+{
+    if (!window || !window->gui_objects
+        || !GUI_WINDOW_OBJECTS(window)->chat_layout)
+        return;
+
+    hashtable_remove_all (GUI_WINDOW_OBJECTS(window)->chat_layout);
+}
+
+/*
+ * Resets cache of lines rows and last line displayed in a window: the whole
+ * chat area is drawn again (used when many lines are added or removed at any
+ * position in lines displayed).
+ */
+
+void
+gui_chat_layout_reset (struct t_gui_window *window)
+{
+    gui_chat_last_line_reset (window);
+    gui_chat_layout_clear (window);
+}
+
 /*
  * Returns pointer to line & offset for a difference with given line.
  */
@@ -1835,7 +1950,7 @@ gui_chat_calculate_line_diff (struct t_gui_window *window,
             *line = gui_line_get_last_displayed (window->buffer);
             if (!(*line))
                 return;
-            current_size = gui_chat_display_line (window, *line, 0, 1);
+            current_size = gui_chat_get_line_rows (window, *line);
             if (current_size == 0)
                 current_size = 1;
             *line_pos = current_size - 1;
@@ -1847,11 +1962,11 @@ gui_chat_calculate_line_diff (struct t_gui_window *window,
             if (!(*line))
                 return;
             *line_pos = 0;
-            current_size = gui_chat_display_line (window, *line, 0, 1);
+            current_size = gui_chat_get_line_rows (window, *line);
         }
     }
     else
-        current_size = gui_chat_display_line (window, *line, 0, 1);
+        current_size = gui_chat_get_line_rows (window, *line);
 
     while ((*line) && (difference != 0))
     {
@@ -1862,10 +1977,10 @@ gui_chat_calculate_line_diff (struct t_gui_window *window,
                 (*line_pos)--;
             else
             {
-                *line = gui_line_get_prev_displayed (*line);
+                *line = gui_line_uncompress_get_prev_displayed (*line);
                 if (*line)
                 {
-                    current_size = gui_chat_display_line (window, *line, 0, 1);
+                    current_size = gui_chat_get_line_rows (window, *line);
                     if (current_size == 0)
                         current_size = 1;
                     *line_pos = current_size - 1;
@@ -1883,7 +1998,7 @@ gui_chat_calculate_line_diff (struct t_gui_window *window,
                 *line = gui_line_get_next_displayed (*line);
                 if (*line)
                 {
-                    current_size = gui_chat_display_line (window, *line, 0, 1);
+                    current_size = gui_chat_get_line_rows (window, *line);
                     if (current_size == 0)
                         current_size = 1;
                     *line_pos = 0;
@@ -1917,6 +2032,149 @@ gui_chat_calculate_line_diff (struct t_gui_window *window,
     }
 }
 
+/*
+ * Resets last line displayed at bottom of chat area: next draw of chat will
+ * display all lines.
+ */
+
+void
+gui_chat_last_line_reset (struct t_gui_window *window)
+{
+    if (!window || !window->gui_objects)
+        return;
+
+    GUI_WINDOW_OBJECTS(window)->chat_last_lines = NULL;
+    GUI_WINDOW_OBJECTS(window)->chat_last_line = NULL;
+    GUI_WINDOW_OBJECTS(window)->chat_last_line_rows = 0;
+    GUI_WINDOW_OBJECTS(window)->chat_last_y = 0;
+    GUI_WINDOW_OBJECTS(window)->chat_last_width = 0;
+    GUI_WINDOW_OBJECTS(window)->chat_last_prefix_max_length = 0;
+    GUI_WINDOW_OBJECTS(window)->chat_last_buffer_max_length = 0;
+}
+
+/*
+ * Saves last line displayed at bottom of chat area (all lines of buffer are
+ * displayed, up to the last one), so that lines added later can be displayed
+ * without drawing again the whole chat area.
+ */
+
+void
+gui_chat_last_line_save (struct t_gui_window *window, struct t_gui_line *line)
+{
+    GUI_WINDOW_OBJECTS(window)->chat_last_lines = window->buffer->lines;
+    GUI_WINDOW_OBJECTS(window)->chat_last_line = line;
+    GUI_WINDOW_OBJECTS(window)->chat_last_line_rows =
+        gui_chat_get_line_rows (window, line);
+    GUI_WINDOW_OBJECTS(window)->chat_last_y =
+        (window->win_chat_cursor_y < window->win_chat_height) ?
+        window->win_chat_cursor_y : window->win_chat_height;
+    GUI_WINDOW_OBJECTS(window)->chat_last_width =
+        gui_chat_get_real_width (window);
+    GUI_WINDOW_OBJECTS(window)->chat_last_prefix_max_length =
+        window->buffer->lines->prefix_max_length;
+    GUI_WINDOW_OBJECTS(window)->chat_last_buffer_max_length =
+        window->buffer->lines->buffer_max_length;
+}
+
+/*
+ * Draws only lines added at the end of a formatted buffer: the chat area is
+ * scrolled up (using insert/delete line of terminal if possible) and the new
+ * lines are displayed at bottom.
+ *
+ * This is possible only if the last line of buffer was displayed at bottom
+ * during last draw, and if the layout of lines already displayed has not
+ * changed (same width, same prefix/buffer length, same rows for last line,
+ * which changes if the read marker or a day change is displayed after it).
+ *
+ * Returns:
+ *   1: new lines displayed
+ *   0: lines can not be displayed this way (the whole chat must be drawn)
+ */
+
+int
+gui_chat_draw_lines_added (struct t_gui_window *window)
+{
+    struct t_gui_window_curses_objects *ptr_objects;
+    struct t_gui_line *ptr_line, *ptr_last_line;
+    char format_empty[32];
+    int rows, scroll, i;
+
+    ptr_objects = GUI_WINDOW_OBJECTS(window);
+
+    if (!ptr_objects->chat_last_line
+        || (ptr_objects->chat_last_lines != window->buffer->lines)
+        || window->scroll->start_line
+        || window->scroll->scrolling
+        || (window->buffer->text_search != GUI_BUFFER_SEARCH_DISABLED)
+        || !window->coords
+        || (window->coords_size != window->win_chat_height)
+        || !ptr_objects->chat_last_line->data->displayed
+        || (ptr_objects->chat_last_width != gui_chat_get_real_width (window))
+        || (ptr_objects->chat_last_prefix_max_length
+            != window->buffer->lines->prefix_max_length)
+        || (ptr_objects->chat_last_buffer_max_length
+            != window->buffer->lines->buffer_max_length)
+        || (ptr_objects->chat_last_line_rows
+            != gui_chat_get_line_rows (window, ptr_objects->chat_last_line)))
+    {
+        return 0;
+    }
+
+    /* count rows of new lines (they must fit in chat area) */
+    rows = 0;
+    ptr_last_line = NULL;
+    for (ptr_line = gui_line_get_next_displayed (ptr_objects->chat_last_line);
+         ptr_line; ptr_line = gui_line_get_next_displayed (ptr_line))
+    {
+        rows += gui_chat_get_line_rows (window, ptr_line);
+        if (rows >= window->win_chat_height)
+            return 0;
+        ptr_last_line = ptr_line;
+    }
+
+    /* no new line displayed (lines added are filtered) */
+    if (!ptr_last_line)
+        return 1;
+
+    /* scroll chat area and coordinates of lines */
+    scroll = ptr_objects->chat_last_y + rows - window->win_chat_height;
+    if (scroll > 0)
+    {
+        scrollok (ptr_objects->win_chat, TRUE);
+        wscrl (ptr_objects->win_chat, scroll);
+        scrollok (ptr_objects->win_chat, FALSE);
+        memmove (window->coords, window->coords + scroll,
+                 (window->coords_size - scroll) * sizeof (window->coords[0]));
+        for (i = window->coords_size - scroll; i < window->coords_size; i++)
+        {
+            gui_window_coords_init_line (window, i);
+        }
+        ptr_objects->chat_last_y -= scroll;
+        window->scroll->first_line_displayed = 0;
+    }
+
+    /* clear rows of new lines */
+    snprintf (format_empty, sizeof (format_empty),
+              "%%-%ds", window->win_chat_width);
+    for (i = ptr_objects->chat_last_y; i < window->win_chat_height; i++)
+    {
+        mvwprintw (ptr_objects->win_chat, i, 0, format_empty, " ");
+    }
+
+    /* display new lines */
+    window->win_chat_cursor_x = 0;
+    window->win_chat_cursor_y = ptr_objects->chat_last_y;
+    for (ptr_line = gui_line_get_next_displayed (ptr_objects->chat_last_line);
+         ptr_line; ptr_line = gui_line_get_next_displayed (ptr_line))
+    {
+        gui_chat_display_line (window, ptr_line, 0, 0);
+    }
+
+    gui_chat_last_line_save (window, ptr_last_line);
+
+    return 1;
+}
+
 /*
  * Draws chat window for a formatted buffer.
  */
@@ -1928,6 +2186,8 @@ gui_chat_draw_formatted_buffer (struct t_gui_window *window)
     int auto_search_first_line, line_pos, line_pos2, count;
     int old_scrolling, old_lines_after;
 
+    gui_chat_last_line_reset (window);
+
     /* display at position of scrolling */
     auto_search_first_line = 1;
     ptr_line = NULL;
@@ -1981,9 +2241,8 @@ gui_chat_draw_formatted_buffer (struct t_gui_window *window)
     {
         /* display end of first line at top of screen */
         count = gui_chat_display_line (window, ptr_line,
-                                       gui_chat_display_line (window,
-                                                              ptr_line,
-                                                              0, 1) -
+                                       gui_chat_get_line_rows (window,
+                                                               ptr_line) -
                                        line_pos, 0);
         ptr_line = gui_line_get_next_displayed (ptr_line);
         window->scroll->first_line_displayed = 0;
@@ -2008,7 +2267,7 @@ gui_chat_draw_formatted_buffer (struct t_gui_window *window)
     /* if so, disable scroll indicator */
     if (!ptr_line && window->scroll->scrolling)
     {
-        if ((count == gui_chat_display_line (window, gui_line_get_last_displayed (window->buffer), 0, 1))
+        if ((count == gui_chat_get_line_rows (window, gui_line_get_last_displayed (window->buffer)))
             || (count == window->win_chat_height))
             window->scroll->scrolling = 0;
     }
@@ -2020,6 +2279,13 @@ gui_chat_draw_formatted_buffer (struct t_gui_window *window)
         window->scroll->start_line_pos = 0;
     }
 
+    /* last line displayed at bottom: next lines added can be drawn alone */
+    if (!ptr_line && !window->scroll->scrolling && !window->scroll->start_line)
+    {
+        gui_chat_last_line_save (window,
+                                 gui_line_get_last_displayed (window->buffer));
+    }
+
     window->scroll->lines_after = 0;
     if (window->scroll->scrolling && ptr_line)
     {
@@ -2338,13 +2604,24 @@ gui_chat_draw (struct t_gui_buffer *buffer, int clear_chat)
             && (ptr_win->win_chat_x >= 0) && (ptr_win->win_chat_y >= 0)
             && (GUI_WINDOW_OBJECTS(ptr_win)->win_chat))
         {
-            gui_window_coords_alloc (ptr_win);
-
             gui_chat_reset_style (ptr_win, NULL, 0, 1,
                                   GUI_COLOR_CHAT_INACTIVE_WINDOW,
                                   GUI_COLOR_CHAT_INACTIVE_BUFFER,
                                   GUI_COLOR_CHAT);
 
+            /* only lines added at bottom: scroll and display new lines */
+            if (!clear_chat
+                && buffer->chat_refresh_lines_added
+                && (ptr_win->buffer->type == GUI_BUFFER_TYPE_FORMATTED)
+                && (ptr_win->win_chat_height >= 2)
+                && gui_chat_draw_lines_added (ptr_win))
+            {
+                wnoutrefresh (GUI_WINDOW_OBJECTS(ptr_win)->win_chat);
+                continue;
+            }
+
+            gui_window_coords_alloc (ptr_win);
+
             if (clear_chat)
             {
                 snprintf (format_empty, sizeof (format_empty),
@@ -2391,4 +2668,5 @@ gui_chat_draw (struct t_gui_buffer *buffer, int clear_chat)
 
 end:
     buffer->chat_refresh_needed = 0;
+    buffer->chat_refresh_lines_added = 0;
 }
@@ -20,6 +20,35 @@
 #ifndef WEECHAT_GUI_CURSES_CHAT_H
 #define WEECHAT_GUI_CURSES_CHAT_H
 
+#define GUI_CHAT_LAYOUT_MAX_LINES 4096
+
+/*
+ * number of rows of a line displayed in a window, with the context used to
+ * compute it: the entry is used only if this context has not changed
+ */
+
+struct t_gui_chat_layout
+{
+    struct t_gui_line_data *data;      /* line data                         */
+    struct t_gui_lines *lines;         /* lines of buffer displayed         */
+    struct t_gui_line *prev_line;      /* previous line displayed           */
+    struct t_gui_line *next_line;      /* next line displayed               */
+    int width;                         /* real width of chat area           */
+    int prefix_max_length;             /* max length of prefix in lines     */
+    int buffer_max_length;             /* max length of buffer name         */
+    int time_for_each_line;            /* time displayed for each line?     */
+    int day_change;                    /* day change displayed?             */
+    int display_tags;                  /* tags displayed?                   */
+    int marker;                        /* read marker displayed after line? */
+    int rows;                          /* number of rows of line            */
+};
+
+extern int gui_chat_get_line_rows (struct t_gui_window *window,
+                                   struct t_gui_line *line);
+extern void gui_chat_last_line_reset (struct t_gui_window *window);
+extern void gui_chat_last_line_save (struct t_gui_window *window,
+                                     struct t_gui_line *line);
+extern int gui_chat_draw_lines_added (struct t_gui_window *window);
 extern void gui_chat_calculate_line_diff (struct t_gui_window *window,
                                           struct t_gui_line **line,
                                           int *line_pos, int difference);
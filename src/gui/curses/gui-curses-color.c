@@ -98,7 +98,7 @@ short *gui_color_term_color_content = NULL; /* content of colors (r/b/g)    */
 
 /* pairs */
 int gui_color_num_pairs = 63;            /* number of pairs used by WeeChat */
-short *gui_color_pairs = NULL;           /* table with pair for each fg+bg  */
+int *gui_color_pairs = NULL;             /* table with pair for each fg+bg  */
 int gui_color_pairs_used = 0;            /* number of pairs currently used  */
 int gui_color_warning_pairs_full = 0;    /* warning displayed?              */
 int gui_color_pairs_auto_reset = 0;         /* auto reset of pairs needed   */
@@ -432,6 +432,20 @@ gui_color_timer_warning_pairs_full (const void *pointer, void *data,
     return WEECHAT_RC_OK;
 }
 
+/*
+ * Initializes a color pair (with extended pairs if supported by ncurses).
+ */
+
+void
+gui_color_init_pair (int pair, int fg, int bg)
+{
+#ifdef GUI_CURSES_EXTENDED_PAIRS
+    init_extended_pair (pair, fg, bg);
+#else
+    init_pair ((short)pair, (short)fg, (short)bg);
+#endif
+}
+
 /*
  * Gets a pair with given foreground/background colors.
  *
@@ -501,7 +515,7 @@ gui_color_get_pair (int fg, int bg)
         /* create a new pair if no pair exists for this fg/bg */
         gui_color_pairs_used++;
         gui_color_pairs[index] = gui_color_pairs_used;
-        init_pair (gui_color_pairs_used, fg, bg);
+        gui_color_init_pair (gui_color_pairs_used, fg, bg);
         if ((gui_color_num_pairs > 1) && !gui_color_pairs_auto_reset_pending
             && (CONFIG_INTEGER(config_look_color_pairs_auto_reset) >= 0)
             && (gui_color_num_pairs - gui_color_pairs_used <= CONFIG_INTEGER(config_look_color_pairs_auto_reset)))
@@ -665,9 +679,14 @@ gui_color_init_vars ()
         gui_color_term_color_pairs = COLOR_PAIRS;
         gui_color_term_can_change_color = (can_change_color ()) ? 1 : 0;
 
-        /* TODO: ncurses may support 65536, but short type used for pairs supports only 32768? */
+#ifdef GUI_CURSES_EXTENDED_PAIRS
+        /* extended pairs: "int" type, pair 0 is reserved */
+        gui_color_num_pairs = gui_color_term_color_pairs - 1;
+#else
+        /* "short" type used for pairs supports only 32767 pairs */
         gui_color_num_pairs = (gui_color_term_color_pairs >= 32768) ?
             32767 : gui_color_term_color_pairs - 1;
+#endif
         gui_color_pairs = calloc (
             (size_t)(gui_color_term_colors + 2) * (gui_color_term_colors + 2),
             sizeof (gui_color_pairs[0]));
@@ -732,7 +751,7 @@ gui_color_init_pairs_terminal ()
     {
         for (i = 1; i <= gui_color_num_pairs; i++)
         {
-            init_pair (i, i, -1);
+            gui_color_init_pair (i, i, -1);
         }
     }
 }
@@ -758,9 +777,9 @@ gui_color_init_pairs_weechat ()
             for (i = 1; i <= gui_color_num_pairs; i++)
             {
                 if ((foregrounds[i] >= -1) && (backgrounds[i] >= -1))
-                    init_pair (i, foregrounds[i], backgrounds[i]);
+                    gui_color_init_pair (i, foregrounds[i], backgrounds[i]);
                 else
-                    init_pair (i, i, -1);
+                    gui_color_init_pair (i, i, -1);
             }
         }
         free (foregrounds);
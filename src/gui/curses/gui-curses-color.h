@@ -37,6 +37,7 @@ extern time_t gui_color_pairs_auto_reset_last;
 extern int gui_color_buffer_refresh_needed;
 
 extern int gui_color_get_gui_attrs (int color);
+extern void gui_color_init_pair (int pair, int fg, int bg);
 extern int gui_color_get_pair (int fg, int bg);
 extern int gui_color_weechat_get_pair (int weechat_color);
 extern void gui_color_alloc ();
@@ -44,6 +44,7 @@
 #include "../gui-mouse.h"
 #include "../gui-window.h"
 #include "gui-curses.h"
+#include "gui-curses-main.h"
 
 #define BIND(key, command)                                      \
     gui_key_default_bind (context, key, command, create_option)
@@ -298,7 +299,7 @@ gui_key_flush (int paste)
     static char key_str[64] = { '\0' };
     static int length_key_str = 0;
     char key_temp[2], *key_utf, *input_old, *ptr_char, *next_char, *ptr_error;
-    char utf_partial_char[16];
+    char utf_partial_char[16], **paste_text;
     struct t_gui_buffer *old_buffer;
 
     /* if paste pending or bracketed paste detected, just return */
@@ -317,6 +318,16 @@ gui_key_flush (int paste)
     last_key_used = -1;
     undo_done = 0;
     old_buffer = NULL;
+
+    /*
+     * text pasted (without text search): all chars are inserted at once
+     * in input, after the loop, with a single signal "input_text_changed"
+     */
+    paste_text = (paste
+                  && !gui_cursor_mode
+                  && (gui_current_window->buffer->text_search == GUI_BUFFER_SEARCH_DISABLED)) ?
+        string_dyn_alloc (gui_key_buffer_size + 1) : NULL;
+
     for (i = 0; i < gui_key_buffer_size; i++)
     {
         key = gui_key_buffer[i];
@@ -406,7 +417,11 @@ gui_key_flush (int paste)
             strcat (key_str, key_utf);
         }
 
-        if (key_str[0])
+        if (key_str[0] && paste_text)
+        {
+            string_dyn_concat (paste_text, key_str, -1);
+        }
+        else if (key_str[0])
         {
             /*
              * send the signal "key_pressed" only if NOT reading a mouse event
@@ -497,6 +512,19 @@ gui_key_flush (int paste)
             last_key_used = i;
     }
 
+    if (paste_text)
+    {
+        if ((*paste_text)[0])
+        {
+            gui_buffer_undo_snap (gui_current_window->buffer);
+            gui_input_insert_string (gui_current_window->buffer, *paste_text);
+            gui_input_text_changed_modifier_and_signal (gui_current_window->buffer,
+                                                        1, /* save undo */
+                                                        1); /* stop completion */
+        }
+        string_dyn_free (paste_text, 1);
+    }
+
     if (last_key_used == gui_key_buffer_size - 1)
         gui_key_buffer_reset ();
     else if (last_key_used >= 0)
@@ -540,6 +568,9 @@ gui_key_read_cb (const void *pointer, void *data, int fd)
     if (ret < 0)
         return WEECHAT_RC_OK;
 
+    /* refresh screen immediately after keys (ignore option max_fps) */
+    gui_main_refresh_immediate = 1;
+
     for (i = 0; i < ret; i++)
     {
         if (gui_key_paste_pending && (buffer[i] == 25))
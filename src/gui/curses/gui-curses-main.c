@@ -28,15 +28,19 @@
 #include <unistd.h>
 #include <string.h>
 #include <signal.h>
+#include <sys/time.h>
 #include <time.h>
 
 #include "../../core/weechat.h"
 #include "../../core/core-command.h"
 #include "../../core/core-config.h"
+#include "../../core/core-hashtable.h"
 #include "../../core/core-hook.h"
 #include "../../core/core-log.h"
+#include "../../core/core-profile.h"
 #include "../../core/core-signal.h"
 #include "../../core/core-string.h"
+#include "../../core/core-util.h"
 #include "../../core/core-utf8.h"
 #include "../../core/core-version.h"
 #include "../../plugins/plugin.h"
@@ -55,6 +59,7 @@
 #include "../gui-line.h"
 #include "../gui-history.h"
 #include "../gui-mouse.h"
+#include "../gui-nick.h"
 #include "../gui-nicklist.h"
 #include "../gui-window.h"
 #include "gui-curses.h"
@@ -68,6 +73,10 @@ volatile sig_atomic_t gui_signal_sigwinch_received = 0;  /* sigwinch signal */
 int gui_term_cols = 0;                 /* number of columns in terminal     */
 int gui_term_lines = 0;                /* number of lines in terminal       */
 
+int gui_main_refresh_immediate = 0;    /* refresh now (key pressed)         */
+struct timeval gui_main_refresh_last;  /* time of last refresh of screen    */
+struct t_hook *gui_main_refresh_timer = NULL; /* timer for delayed refresh  */
+
 
 /*
  * Gets a password from user (called on startup, when GUI is not initialized).
@@ -273,6 +282,107 @@ gui_main_debug_libs ()
 #endif /* defined(NCURSES_VERSION) && defined(NCURSES_VERSION_PATCH) */
 }
 
+/*
+ * Checks if something must be refreshed on screen.
+ *
+ * Returns:
+ *   1: refresh needed
+ *   0: nothing to refresh
+ */
+
+int
+gui_main_refresh_pending ()
+{
+    struct t_gui_window *ptr_win;
+    struct t_gui_buffer *ptr_buffer;
+    struct t_gui_bar *ptr_bar;
+
+    if (gui_window_refresh_needed || gui_color_buffer_refresh_needed
+        || (gui_bar_item_updates && (gui_bar_item_updates->items_count > 0)))
+    {
+        return 1;
+    }
+
+    for (ptr_win = gui_windows; ptr_win; ptr_win = ptr_win->next_window)
+    {
+        if (ptr_win->refresh_needed)
+            return 1;
+    }
+
+    for (ptr_buffer = gui_buffers; ptr_buffer;
+         ptr_buffer = ptr_buffer->next_buffer)
+    {
+        if (ptr_buffer->chat_refresh_needed)
+            return 1;
+    }
+
+    for (ptr_bar = gui_bars; ptr_bar; ptr_bar = ptr_bar->next_bar)
+    {
+        if (ptr_bar->bar_refresh_needed)
+            return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * Callback for timer used to wake up the main loop when a delayed refresh is
+ * allowed (the refresh itself is done by the main loop).
+ */
+
+int
+gui_main_refresh_timer_cb (const void *pointer, void *data,
+                           int remaining_calls)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+
+    if (remaining_calls == 0)
+        gui_main_refresh_timer = NULL;
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Checks if screen can be refreshed now, according to option
+ * weechat.look.max_fps: all refresh requests received until the next allowed
+ * refresh are done together.
+ *
+ * When the refresh is delayed, a timer is used to wake up the main loop.
+ *
+ * Returns:
+ *   1: screen can be refreshed now
+ *   0: refresh is delayed
+ */
+
+int
+gui_main_refresh_allowed ()
+{
+    struct timeval tv_now;
+    long long frame, diff;
+    int max_fps;
+
+    max_fps = CONFIG_INTEGER(config_look_max_fps);
+    if ((max_fps <= 0) || gui_main_refresh_immediate)
+        return 1;
+
+    gettimeofday (&tv_now, NULL);
+    frame = 1000000LL / max_fps;
+    diff = util_timeval_diff (&gui_main_refresh_last, &tv_now);
+    if ((diff < 0) || (diff >= frame))
+        return 1;
+
+    if (!gui_main_refresh_timer)
+    {
+        gui_main_refresh_timer = hook_timer (
+            NULL, ((frame - diff) + 999) / 1000, 0, 1,
+            &gui_main_refresh_timer_cb, NULL, NULL);
+    }
+
+    return 0;
+}
+
 /*
  * Refreshes for windows, buffers, bars.
  */
@@ -284,6 +394,9 @@ gui_main_refreshes ()
     struct t_gui_buffer *ptr_buffer;
     struct t_gui_bar *ptr_bar;
 
+    /* run pending updates of bar items */
+    gui_bar_item_update_flush ();
+
     /* refresh color buffer if needed */
     if (gui_color_buffer_refresh_needed)
     {
@@ -291,6 +404,17 @@ gui_main_refreshes ()
         gui_color_buffer_refresh_needed = 0;
     }
 
+    /*
+     * in headless mode with option "--no-render", nothing is drawn: bar
+     * items are built only when their content is requested (see function
+     * gui_bar_window_add_to_infolist)
+     */
+    if (weechat_no_render)
+    {
+        gui_window_refresh_needed = 0;
+        return;
+    }
+
     /* compute max length for prefix/buffer if needed */
     for (ptr_buffer = gui_buffers; ptr_buffer;
          ptr_buffer = ptr_buffer->next_buffer)
@@ -346,6 +470,7 @@ gui_main_refreshes ()
     {
         if (ptr_win->refresh_needed)
         {
+            gui_chat_layout_clear (ptr_win);
             gui_window_switch_to_buffer (ptr_win, ptr_win->buffer, 0);
             gui_chat_draw (ptr_win->buffer, 1);
             ptr_win->refresh_needed = 0;
@@ -388,6 +513,7 @@ void
 gui_main_loop ()
 {
     struct t_hook *hook_fd_keyboard;
+    struct timeval phase_start;
     int send_signal_sigwinch;
 
     send_signal_sigwinch = 0;
@@ -412,10 +538,16 @@ gui_main_loop ()
 
     gui_window_ask_refresh (1);
 
+    profile_phase_start (&phase_start);
+
+    /* flush log file once per iteration of main loop */
+    log_set_flush_delayed (1);
+
     while (!weechat_quit)
     {
         /* execute timer hooks */
         hook_timer_exec ();
+        profile_phase_end (PROFILE_PHASE_TIMERS, &phase_start);
 
         /* auto reset of color pairs */
         if (gui_color_pairs_auto_reset)
@@ -429,13 +561,23 @@ gui_main_loop ()
         if (gui_signal_sigwinch_received)
         {
             gui_window_ask_refresh (2);
+            gui_main_refresh_immediate = 1;
             gui_signal_sigwinch_received = 0;
             send_signal_sigwinch = 1;
         }
 
-        gui_main_refreshes ();
-        if (gui_window_refresh_needed && !gui_window_bare_display)
+        if (!gui_main_refresh_pending ())
+        {
             gui_main_refreshes ();
+        }
+        else if (gui_main_refresh_allowed ())
+        {
+            gui_main_refreshes ();
+            if (gui_window_refresh_needed && !gui_window_bare_display)
+                gui_main_refreshes ();
+            gettimeofday (&gui_main_refresh_last, NULL);
+            gui_main_refresh_immediate = 0;
+        }
 
         if (send_signal_sigwinch)
         {
@@ -445,17 +587,25 @@ gui_main_loop ()
         }
 
         gui_color_pairs_auto_reset_pending = 0;
+        profile_phase_end (PROFILE_PHASE_REFRESHES, &phase_start);
 
         /* execute fd hooks */
         hook_fd_exec ();
+        profile_phase_end (PROFILE_PHASE_FD, &phase_start);
 
         /* run process (with fork) */
         hook_process_exec ();
+        profile_phase_end (PROFILE_PHASE_PROCESS, &phase_start);
 
         /* handle signals received */
         signal_handle ();
+        profile_phase_end (PROFILE_PHASE_SIGNALS, &phase_start);
+
+        log_flush ();
     }
 
+    log_set_flush_delayed (0);
+
     /* remove keyboard hook */
     unhook (hook_fd_keyboard);
 }
@@ -536,6 +686,9 @@ gui_main_end (int clean_exit)
         /* free some variables used for nicklist */
         gui_nicklist_end ();
 
+        /* free cache of nick colors */
+        gui_nick_end ();
+
         /* free some variables used for hotlist */
         gui_hotlist_end ();
     }
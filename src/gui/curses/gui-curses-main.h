@@ -21,6 +21,7 @@
 #define WEECHAT_GUI_CURSES_MAIN_H
 
 extern int gui_term_cols, gui_term_lines;
+extern int gui_main_refresh_immediate;
 
 extern void gui_main_init ();
 extern void gui_main_loop ();
@@ -36,6 +36,7 @@
 #include "../../core/weechat.h"
 #include "../../core/core-config.h"
 #include "../../core/core-eval.h"
+#include "../../core/core-hashtable.h"
 #include "../../core/core-hook.h"
 #include "../../core/core-log.h"
 #include "../../core/core-string.h"
@@ -51,6 +52,7 @@
 #include "../gui-key.h"
 #include "../gui-layout.h"
 #include "../gui-line.h"
+#include "../gui-line-compress.h"
 #include "../gui-main.h"
 #include "../gui-mouse.h"
 #include "../gui-nicklist.h"
@@ -137,6 +139,12 @@ gui_window_objects_init (struct t_gui_window *window)
         GUI_WINDOW_OBJECTS(window)->win_chat = NULL;
         GUI_WINDOW_OBJECTS(window)->win_separator_horiz = NULL;
         GUI_WINDOW_OBJECTS(window)->win_separator_vertic = NULL;
+        GUI_WINDOW_OBJECTS(window)->chat_layout = hashtable_new (
+            32,
+            WEECHAT_HASHTABLE_POINTER,
+            WEECHAT_HASHTABLE_BUFFER,
+            NULL, NULL);
+        gui_chat_last_line_reset (window);
         return 1;
     }
     return 0;
@@ -157,6 +165,7 @@ gui_window_objects_free (struct t_gui_window *window, int free_separators)
         delwin (GUI_WINDOW_OBJECTS(window)->win_chat);
         GUI_WINDOW_OBJECTS(window)->win_chat = NULL;
     }
+    gui_chat_last_line_reset (window);
     if (free_separators)
     {
         if  (GUI_WINDOW_OBJECTS(window)->win_separator_horiz)
@@ -169,9 +178,77 @@ gui_window_objects_free (struct t_gui_window *window, int free_separators)
             delwin (GUI_WINDOW_OBJECTS(window)->win_separator_vertic);
             GUI_WINDOW_OBJECTS(window)->win_separator_vertic = NULL;
         }
+        if (GUI_WINDOW_OBJECTS(window)->chat_layout)
+        {
+            hashtable_free (GUI_WINDOW_OBJECTS(window)->chat_layout);
+            GUI_WINDOW_OBJECTS(window)->chat_layout = NULL;
+        }
     }
 }
 
+/*
+ * Sets color pair for a window (extended pair if supported by ncurses).
+ */
+
+void
+gui_window_color_set (WINDOW *window, int pair)
+{
+#ifdef GUI_CURSES_EXTENDED_PAIRS
+    wcolor_set (window, 0, &pair);
+#else
+    wcolor_set (window, (short)pair, NULL);
+#endif
+}
+
+/*
+ * Sets attributes and color pair for a window (extended pair if supported by
+ * ncurses).
+ */
+
+void
+gui_window_attr_set (WINDOW *window, attr_t attrs, int pair)
+{
+#ifdef GUI_CURSES_EXTENDED_PAIRS
+    wattr_set (window, attrs, 0, &pair);
+#else
+    wattr_set (window, attrs, (short)pair, NULL);
+#endif
+}
+
+/*
+ * Gets attributes and color pair of a window (extended pair if supported by
+ * ncurses).
+ */
+
+void
+gui_window_attr_get (WINDOW *window, attr_t *attrs, t_gui_curses_pair *pair)
+{
+#ifdef GUI_CURSES_EXTENDED_PAIRS
+    short pair_short;
+
+    pair_short = 0;
+    wattr_get (window, attrs, &pair_short, pair);
+#else
+    wattr_get (window, attrs, pair, NULL);
+#endif
+}
+
+/*
+ * Changes attributes and color pair of chars in a window (extended pair if
+ * supported by ncurses).
+ */
+
+void
+gui_window_chgat (WINDOW *window, int y, int x, int count, attr_t attrs,
+                  int pair)
+{
+#ifdef GUI_CURSES_EXTENDED_PAIRS
+    mvwchgat (window, y, x, count, attrs, 0, &pair);
+#else
+    mvwchgat (window, y, x, count, attrs, (short)pair, NULL);
+#endif
+}
+
 /*
  * Clears a Curses window.
  */
@@ -198,7 +275,14 @@ gui_window_clear (WINDOW *window, int fg, int bg)
 
 #ifdef NCURSES_EXT_COLORS
     cchar_t c;
-    setcchar (&c, L" ", attrs, gui_color_get_pair (fg, bg), NULL);
+    int pair;
+
+    pair = gui_color_get_pair (fg, bg);
+#ifdef GUI_CURSES_EXTENDED_PAIRS
+    setcchar (&c, L" ", attrs, 0, &pair);
+#else
+    setcchar (&c, L" ", attrs, (short)pair, NULL);
+#endif
     wbkgrndset (window, &c);
 #else
     wbkgdset (window, ' ' | COLOR_PAIR (gui_color_get_pair (fg, bg)) | attrs);
@@ -216,8 +300,15 @@ gui_window_clrtoeol (WINDOW *window)
 {
 #ifdef NCURSES_EXT_COLORS
     cchar_t c;
-    setcchar (&c, L" ", A_NORMAL, gui_color_get_pair (gui_window_current_style_fg,
-                                                      gui_window_current_style_bg), NULL);
+    int pair;
+
+    pair = gui_color_get_pair (gui_window_current_style_fg,
+                               gui_window_current_style_bg);
+#ifdef GUI_CURSES_EXTENDED_PAIRS
+    setcchar (&c, L" ", A_NORMAL, 0, &pair);
+#else
+    setcchar (&c, L" ", A_NORMAL, (short)pair, NULL);
+#endif
     wbkgrndset (window, &c);
 #else
     wbkgdset (window,
@@ -235,8 +326,6 @@ void
 gui_window_save_style (WINDOW *window)
 {
     struct t_gui_window_saved_style *ptr_saved_style;
-    attr_t *ptr_attrs;
-    short *ptr_pair;
 
     /* get pointer on saved style */
     ptr_saved_style = &gui_window_saved_style[gui_window_saved_style_index];
@@ -246,9 +335,8 @@ gui_window_save_style (WINDOW *window)
     ptr_saved_style->style_bg = gui_window_current_style_bg;
     ptr_saved_style->color_attr = gui_window_current_color_attr;
     ptr_saved_style->emphasis = gui_window_current_emphasis;
-    ptr_attrs = &ptr_saved_style->attrs;
-    ptr_pair = &ptr_saved_style->pair;
-    wattr_get (window, ptr_attrs, ptr_pair, NULL);
+    gui_window_attr_get (window, &ptr_saved_style->attrs,
+                         &ptr_saved_style->pair);
 
     /* increment style index (circular list) */
     gui_window_saved_style_index++;
@@ -278,13 +366,14 @@ gui_window_restore_style (WINDOW *window)
     gui_window_current_style_bg = ptr_saved_style->style_bg;
     gui_window_current_color_attr = ptr_saved_style->color_attr;
     gui_window_current_emphasis = ptr_saved_style->emphasis;
-    wattr_set (window, ptr_saved_style->attrs, ptr_saved_style->pair, NULL);
+    gui_window_attr_set (window, ptr_saved_style->attrs,
+                         ptr_saved_style->pair);
     /*
      * for unknown reason, the wattr_set function sometimes
      * fails to set the color pair under FreeBSD, so we force
      * it again with wcolor_set
      */
-    wcolor_set (window, ptr_saved_style->pair, NULL);
+    gui_window_color_set (window, ptr_saved_style->pair);
 }
 
 /*
@@ -298,8 +387,8 @@ gui_window_reset_style (WINDOW *window, int weechat_color)
     gui_window_current_style_bg = -1;
     gui_window_current_color_attr = 0;
 
-    wattr_set (window, gui_color[weechat_color]->attributes,
-               gui_color_weechat_get_pair (weechat_color), NULL);
+    gui_window_attr_set (window, gui_color[weechat_color]->attributes,
+                         gui_color_weechat_get_pair (weechat_color));
 }
 
 /*
@@ -313,7 +402,7 @@ gui_window_reset_color (WINDOW *window, int weechat_color)
     gui_window_current_style_bg = gui_color[weechat_color]->background;
 
     wattron (window, gui_color[weechat_color]->attributes);
-    wcolor_set (window, gui_color_weechat_get_pair (weechat_color), NULL);
+    gui_window_color_set (window, gui_color_weechat_get_pair (weechat_color));
 }
 
 /*
@@ -348,7 +437,7 @@ gui_window_set_color (WINDOW *window, int fg, int bg)
     gui_window_current_style_fg = fg;
     gui_window_current_style_bg = bg;
 
-    wcolor_set (window, gui_color_get_pair (fg, bg), NULL);
+    gui_window_color_set (window, gui_color_get_pair (fg, bg));
 }
 
 /*
@@ -563,7 +652,7 @@ gui_window_set_custom_color_pair (WINDOW *window, int pair)
     if ((pair >= 0) && (pair <= gui_color_num_pairs))
     {
         gui_window_remove_color_style (window, A_ALL_ATTR);
-        wcolor_set (window, pair, NULL);
+        gui_window_color_set (window, pair);
     }
 }
 
@@ -588,24 +677,22 @@ gui_window_toggle_emphasis ()
 void
 gui_window_emphasize (WINDOW *window, int x, int y, int count)
 {
-    attr_t attrs, *ptr_attrs;
-    short pair, *ptr_pair;
+    attr_t attrs;
+    t_gui_curses_pair pair;
 
     if (config_emphasized_attributes == 0)
     {
         /* use color for emphasis (from config) */
-        mvwchgat (window, y, x, count,
-                  gui_color[GUI_COLOR_EMPHASIS]->attributes,
-                  gui_color_weechat_get_pair (GUI_COLOR_EMPHASIS), NULL);
+        gui_window_chgat (window, y, x, count,
+                          gui_color[GUI_COLOR_EMPHASIS]->attributes,
+                          gui_color_weechat_get_pair (GUI_COLOR_EMPHASIS));
     }
     else
     {
         /* exclusive or (XOR) with attributes */
         attrs = 0;
         pair = 0;
-        ptr_attrs = &attrs;
-        ptr_pair = &pair;
-        wattr_get (window, ptr_attrs, ptr_pair, NULL);
+        gui_window_attr_get (window, &attrs, &pair);
         if (config_emphasized_attributes & GUI_COLOR_EXTENDED_BLINK_FLAG)
             attrs ^= A_BLINK;
         if (config_emphasized_attributes & GUI_COLOR_EXTENDED_DIM_FLAG)
@@ -618,7 +705,7 @@ gui_window_emphasize (WINDOW *window, int x, int y, int count)
             attrs ^= A_ITALIC;
         if (config_emphasized_attributes & GUI_COLOR_EXTENDED_UNDERLINE_FLAG)
             attrs ^= A_UNDERLINE;
-        mvwchgat (window, y, x, count, attrs, pair, NULL);
+        gui_window_chgat (window, y, x, count, attrs, pair);
     }
 
     /* move the cursor after the text (mvwchgat does not move cursor) */
@@ -1344,6 +1431,9 @@ gui_window_switch_to_buffer (struct t_gui_window *window,
                                                        window->win_chat_width,
                                                        window->win_chat_y,
                                                        window->win_chat_x);
+        /* allow use of insert/delete line of terminal to scroll chat */
+        if (GUI_WINDOW_OBJECTS(window)->win_chat)
+            idlok (GUI_WINDOW_OBJECTS(window)->win_chat, TRUE);
     }
     gui_window_draw_separators (window);
     gui_buffer_ask_chat_refresh (window->buffer, 2);
@@ -1638,6 +1728,8 @@ gui_window_scroll_top (struct t_gui_window *window)
     switch (window->buffer->type)
     {
         case GUI_BUFFER_TYPE_FORMATTED:
+            if (gui_line_uncompress_lines (window->buffer, -1) > 0)
+                window->scroll->first_line_displayed = 0;
             if (!window->scroll->first_line_displayed)
             {
                 window->scroll->start_line = gui_line_get_first_displayed (window->buffer);
@@ -2473,6 +2565,14 @@ gui_window_swap (struct t_gui_window *window, int direction)
 void
 gui_window_refresh_screen (int full_refresh)
 {
+    struct t_gui_window *ptr_win;
+
+    /* options or size may have changed: rows of lines must be computed again */
+    for (ptr_win = gui_windows; ptr_win; ptr_win = ptr_win->next_window)
+    {
+        gui_chat_layout_clear (ptr_win);
+    }
+
     if (full_refresh)
     {
         endwin ();
@@ -2719,4 +2819,15 @@ gui_window_objects_print_log (struct t_gui_window *window)
     log_printf ("    win_chat. . . . . . . : %p", GUI_WINDOW_OBJECTS(window)->win_chat);
     log_printf ("    win_separator_horiz . : %p", GUI_WINDOW_OBJECTS(window)->win_separator_horiz);
     log_printf ("    win_separator_vertic. : %p", GUI_WINDOW_OBJECTS(window)->win_separator_vertic);
+    log_printf ("    chat_layout . . . . . : %p (%d lines)",
+                GUI_WINDOW_OBJECTS(window)->chat_layout,
+                (GUI_WINDOW_OBJECTS(window)->chat_layout) ?
+                GUI_WINDOW_OBJECTS(window)->chat_layout->items_count : 0);
+    log_printf ("    chat_last_lines . . . : %p", GUI_WINDOW_OBJECTS(window)->chat_last_lines);
+    log_printf ("    chat_last_line. . . . : %p", GUI_WINDOW_OBJECTS(window)->chat_last_line);
+    log_printf ("    chat_last_line_rows . : %d", GUI_WINDOW_OBJECTS(window)->chat_last_line_rows);
+    log_printf ("    chat_last_y . . . . . : %d", GUI_WINDOW_OBJECTS(window)->chat_last_y);
+    log_printf ("    chat_last_width . . . : %d", GUI_WINDOW_OBJECTS(window)->chat_last_width);
+    log_printf ("    chat_last_prefix_max_length: %d", GUI_WINDOW_OBJECTS(window)->chat_last_prefix_max_length);
+    log_printf ("    chat_last_buffer_max_length: %d", GUI_WINDOW_OBJECTS(window)->chat_last_buffer_max_length);
 }
@@ -30,7 +30,7 @@ struct t_gui_window_saved_style
     int color_attr;
     int emphasis;
     attr_t attrs;
-    short pair;
+    t_gui_curses_pair pair;
 };
 
 struct t_gui_window_curses_objects
@@ -38,12 +38,27 @@ struct t_gui_window_curses_objects
     WINDOW *win_chat;               /* chat window (example: channel)       */
     WINDOW *win_separator_horiz;    /* horizontal separator (optional)      */
     WINDOW *win_separator_vertic;   /* vertical separator (optional)        */
+    struct t_hashtable *chat_layout;/* rows of lines (key: line pointer)    */
+    /* last line displayed at bottom of chat (to display only new lines)   */
+    struct t_gui_lines *chat_last_lines;  /* lines displayed                */
+    struct t_gui_line *chat_last_line;    /* last line displayed            */
+    int chat_last_line_rows;        /* number of rows of last line          */
+    int chat_last_y;                /* row after last line displayed        */
+    int chat_last_width;            /* width of chat area                   */
+    int chat_last_prefix_max_length;/* max length of prefix in lines        */
+    int chat_last_buffer_max_length;/* max length of buffer name in lines   */
 };
 
 extern int gui_window_current_color_attr;
 extern int gui_window_current_emphasis;
 
 extern void gui_window_read_terminal_size ();
+extern void gui_window_color_set (WINDOW *window, int pair);
+extern void gui_window_attr_set (WINDOW *window, attr_t attrs, int pair);
+extern void gui_window_attr_get (WINDOW *window, attr_t *attrs,
+                                 t_gui_curses_pair *pair);
+extern void gui_window_chgat (WINDOW *window, int y, int x, int count,
+                              attr_t attrs, int pair);
 extern void gui_window_clear (WINDOW *window, int fg, int bg);
 extern void gui_window_clrtoeol (WINDOW *window);
 extern void gui_window_save_style (WINDOW *window);
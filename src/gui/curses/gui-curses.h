@@ -33,4 +33,16 @@
 #endif /* HAVE_NCURSESW_CURSES_H */
 #endif /* WEECHAT_HEADLESS */
 
+/*
+ * with ncurses >= 6.1, color pairs are "int" (and not "short"), so more than
+ * 32767 pairs can be used; the pair is then given in argument "opts" of
+ * ncurses functions
+ */
+#if defined(NCURSES_EXT_COLORS) && (NCURSES_EXT_COLORS >= 20170401)
+#define GUI_CURSES_EXTENDED_PAIRS 1
+typedef int t_gui_curses_pair;
+#else
+typedef short t_gui_curses_pair;
+#endif
+
 #endif /* WEECHAT_GUI_CURSES_H */
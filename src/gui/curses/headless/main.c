@@ -105,6 +105,7 @@ main (int argc, char *argv[])
      * Parse extra options for headless mode:
      * - "--daemon": daemonize the process
      * - "--stdout": log messages to stdout (instead of log file)
+     * - "--no-render": never draw windows and bars
      */
     weechat_daemon = 0;
     for (i = 1; i < argc; i++)
@@ -117,6 +118,10 @@ main (int argc, char *argv[])
         {
             weechat_log_stdout = 1;
         }
+        else if (strcmp (argv[i], "--no-render") == 0)
+        {
+            weechat_no_render = 1;
+        }
     }
     if (weechat_daemon)
     {
@@ -71,6 +71,9 @@ char *gui_bar_item_names[GUI_BAR_NUM_ITEMS] =
 };
 struct t_gui_bar_item_hook *gui_bar_item_hooks = NULL;
 struct t_hook *gui_bar_item_timer = NULL;
+struct t_hashtable *gui_bar_item_updates = NULL; /* pending updates (names) */
+struct t_hook *gui_bar_item_updates_timer = NULL; /* timer for delayed      */
+                                                  /* updates                */
 
 
 /*
@@ -378,12 +381,15 @@ gui_bar_item_get_vars (const char *item_name,
  *               returns: color(delimiter) + "[" +
  *                        (value of item "time") + color(delimiter) + "]"
  *
+ * The hashtable "extra_info" (can be NULL) is sent to the callback, see
+ * function gui_bar_window_content_get_lines.
+ *
  * Note: result must be freed after use.
  */
 
 char *
 gui_bar_item_get_value (struct t_gui_bar *bar, struct t_gui_window *window,
-                        int item, int subitem)
+                        int item, int subitem, struct t_hashtable *extra_info)
 {
     char *item_value, delimiter_color[32], bar_color[32];
     char **result, str_attr[8], *str_diff;
@@ -427,7 +433,7 @@ gui_bar_item_get_value (struct t_gui_bar *bar, struct t_gui_window *window,
                 ptr_item,
                 window,
                 buffer,
-                NULL);
+                extra_info);
             if ((debug_long_callbacks > 0) && (start_time.tv_sec > 0))
             {
                 gettimeofday (&end_time, NULL);
@@ -559,6 +565,74 @@ gui_bar_item_count_lines (char *string)
     return count;
 }
 
+/*
+ * Gets lines displayed in bar window, sent by the bar window in hashtable
+ * "extra_info" (see function gui_bar_window_content_get_lines).
+ *
+ * Returns:
+ *   1: callback can return only "lines_count" lines from "lines_start"
+ *   0: callback must return all lines
+ */
+
+int
+gui_bar_item_get_lines_displayed (struct t_hashtable *extra_info,
+                                  int *lines_start, int *lines_count)
+{
+    const char *ptr_start, *ptr_count;
+    char *error1, *error2;
+    long start, count;
+
+    *lines_start = 0;
+    *lines_count = -1;
+
+    if (!extra_info)
+        return 0;
+
+    ptr_start = hashtable_get (extra_info, "_lines_start");
+    ptr_count = hashtable_get (extra_info, "_lines_count");
+    if (!ptr_start || !ptr_count)
+        return 0;
+
+    error1 = NULL;
+    start = strtol (ptr_start, &error1, 10);
+    error2 = NULL;
+    count = strtol (ptr_count, &error2, 10);
+    if (!error1 || error1[0] || !error2 || error2[0]
+        || (start < 0) || (count <= 0))
+    {
+        return 0;
+    }
+
+    *lines_start = (int)start;
+    *lines_count = (int)count;
+
+    return 1;
+}
+
+/*
+ * Sets lines returned by a bar item callback in hashtable "extra_info":
+ * total number of lines, first line returned and max length of all lines
+ * (on screen, 0 if unknown).
+ */
+
+void
+gui_bar_item_set_lines_returned (struct t_hashtable *extra_info,
+                                 int lines_total, int lines_start,
+                                 int max_length)
+{
+    char str_value[32];
+
+    if (!extra_info)
+        return;
+
+    snprintf (str_value, sizeof (str_value), "%d", lines_total);
+    hashtable_set (extra_info, "_lines_total", str_value);
+    snprintf (str_value, sizeof (str_value), "%d", lines_start);
+    hashtable_set (extra_info, "_lines_start", str_value);
+    snprintf (str_value, sizeof (str_value), "%d", max_length);
+    hashtable_set (extra_info, "_lines_max_length", str_value);
+}
+
 /*
  * Creates a new bar item.
  *
@@ -594,6 +668,9 @@ gui_bar_item_new (struct t_weechat_plugin *plugin, const char *name,
         new_bar_item->build_callback = build_callback;
         new_bar_item->build_callback_pointer = build_callback_pointer;
         new_bar_item->build_callback_data = build_callback_data;
+        new_bar_item->update_min_interval = 0;
+        new_bar_item->update_last_time.tv_sec = 0;
+        new_bar_item->update_last_time.tv_usec = 0;
 
         /* add bar item to bar items queue */
         new_bar_item->prev_item = last_gui_bar_item;
@@ -612,11 +689,11 @@ gui_bar_item_new (struct t_weechat_plugin *plugin, const char *name,
 }
 
 /*
- * Updates an item on all bars displayed on screen.
+ * Updates an item on all bars displayed on screen (now).
  */
 
 void
-gui_bar_item_update (const char *item_name)
+gui_bar_item_update_now (const char *item_name)
 {
     struct t_gui_bar *ptr_bar;
     struct t_gui_window *ptr_window;
@@ -703,6 +780,134 @@ gui_bar_item_update (const char *item_name)
     }
 }
 
+
+/*
+ * Asks for update of an item on all bars displayed on screen.
+ *
+ * The update is delayed until next refresh of screen (see function
+ * gui_bar_item_update_flush), so that many updates of the same item
+ * are done only once.
+ */
+
+void
+gui_bar_item_update (const char *item_name)
+{
+    if (!item_name)
+        return;
+
+    if (!gui_bar_item_updates)
+    {
+        gui_bar_item_updates = hashtable_new (32,
+                                              WEECHAT_HASHTABLE_STRING,
+                                              WEECHAT_HASHTABLE_POINTER,
+                                              NULL, NULL);
+        if (!gui_bar_item_updates)
+        {
+            gui_bar_item_update_now (item_name);
+            return;
+        }
+    }
+
+    hashtable_set (gui_bar_item_updates, item_name, NULL);
+}
+
+/*
+ * Callback for timer of delayed updates of bar items: the pending updates are
+ * done on next refresh of screen.
+ */
+
+int
+gui_bar_item_updates_timer_cb (const void *pointer, void *data,
+                               int remaining_calls)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+
+    if (remaining_calls == 0)
+        gui_bar_item_updates_timer = NULL;
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Updates an item pending in hashtable of updates, if its minimum interval
+ * between two updates is elapsed (the update is kept for later otherwise).
+ */
+
+void
+gui_bar_item_update_flush_map_cb (void *data,
+                                  struct t_hashtable *hashtable,
+                                  const void *key, const void *value)
+{
+    struct t_gui_bar_item *ptr_item;
+    struct timeval *tv_now;
+    long long *min_delay, delay;
+    char *item_name;
+
+    /* make C compiler happy */
+    (void) value;
+
+    tv_now = (struct timeval *)(((void **)data)[0]);
+    min_delay = (long long *)(((void **)data)[1]);
+
+    ptr_item = gui_bar_item_search ((const char *)key);
+    if (ptr_item && (ptr_item->update_min_interval > 0))
+    {
+        delay = ((long long)ptr_item->update_min_interval * 1000)
+            - util_timeval_diff (&ptr_item->update_last_time, tv_now);
+        if (delay > 0)
+        {
+            if ((*min_delay < 0) || (delay < *min_delay))
+                *min_delay = delay;
+            return;
+        }
+        ptr_item->update_last_time.tv_sec = tv_now->tv_sec;
+        ptr_item->update_last_time.tv_usec = tv_now->tv_usec;
+    }
+
+    item_name = strdup ((const char *)key);
+    hashtable_remove (hashtable, key);
+    if (item_name)
+    {
+        gui_bar_item_update_now (item_name);
+        free (item_name);
+    }
+}
+
+/*
+ * Runs all pending updates of bar items (called before refresh of screen).
+ *
+ * Updates of items with a minimum interval between two updates may be
+ * delayed: a timer is then used to wake up the main loop.
+ */
+
+void
+gui_bar_item_update_flush ()
+{
+    struct timeval tv_now;
+    long long min_delay;
+    void *map_data[2];
+
+    if (!gui_bar_item_updates || (gui_bar_item_updates->items_count == 0))
+        return;
+
+    gettimeofday (&tv_now, NULL);
+    min_delay = -1;
+    map_data[0] = &tv_now;
+    map_data[1] = &min_delay;
+
+    hashtable_map (gui_bar_item_updates,
+                   &gui_bar_item_update_flush_map_cb, map_data);
+
+    if ((min_delay > 0) && !gui_bar_item_updates_timer)
+    {
+        gui_bar_item_updates_timer = hook_timer (
+            NULL, (min_delay + 999) / 1000, 0, 1,
+            &gui_bar_item_updates_timer_cb, NULL, NULL);
+    }
+}
+
 /*
  * Deletes a bar item.
  */
@@ -1833,6 +2038,123 @@ gui_bar_item_buffer_title_cb (const void *pointer, void *data,
     return (buffer->title) ? strdup (buffer->title) : NULL;
 }
 
+/*
+ * Adds a line with a nick or a group in nicklist bar item.
+ */
+
+void
+gui_bar_item_buffer_nicklist_add_line (char **nicklist,
+                                       struct t_gui_buffer *buffer,
+                                       struct t_gui_nick_group *group,
+                                       struct t_gui_nick *nick)
+{
+    struct t_config_option *ptr_option;
+    int i;
+
+    if (*nicklist[0])
+        string_dyn_concat (nicklist, "\n", -1);
+
+    if (nick)
+    {
+        if (buffer->nicklist_display_groups)
+        {
+            for (i = 0; i < nick->group->level; i++)
+            {
+                string_dyn_concat (nicklist, " ", -1);
+            }
+        }
+        if (nick->prefix_color)
+        {
+            if (strchr (nick->prefix_color, '.'))
+            {
+                config_file_search_with_string (nick->prefix_color,
+                                                NULL, NULL, &ptr_option,
+                                                NULL);
+                if (ptr_option)
+                {
+                    string_dyn_concat (
+                        nicklist,
+                        gui_color_get_custom (
+                            gui_color_get_name (
+                                CONFIG_COLOR(ptr_option))),
+                        -1);
+                }
+            }
+            else
+            {
+                string_dyn_concat (nicklist,
+                                   gui_color_get_custom (
+                                       nick->prefix_color),
+                                   -1);
+            }
+        }
+        if (nick->prefix)
+            string_dyn_concat (nicklist, nick->prefix, -1);
+        if (nick->color)
+        {
+            if (strchr (nick->color, '.'))
+            {
+                config_file_search_with_string (nick->color,
+                                                NULL, NULL, &ptr_option,
+                                                NULL);
+                if (ptr_option)
+                {
+                    string_dyn_concat (
+                        nicklist,
+                        gui_color_get_custom (
+                            gui_color_get_name (
+                                CONFIG_COLOR(ptr_option))),
+                        -1);
+                }
+            }
+            else
+            {
+                string_dyn_concat (nicklist,
+                                   gui_color_get_custom (
+                                       nick->color),
+                                   -1);
+            }
+        }
+        string_dyn_concat (nicklist, nick->name, -1);
+    }
+    else
+    {
+        for (i = 0; i < group->level - 1; i++)
+        {
+            string_dyn_concat (nicklist, " ", -1);
+        }
+        if (group->color)
+        {
+            if (strchr (group->color, '.'))
+            {
+                config_file_search_with_string (group->color,
+                                                NULL, NULL, &ptr_option,
+                                                NULL);
+                if (ptr_option)
+                {
+                    string_dyn_concat (
+                        nicklist,
+                        gui_color_get_custom (
+                            gui_color_get_name (
+                                CONFIG_COLOR(ptr_option))),
+                        -1);
+                }
+            }
+            else
+            {
+                string_dyn_concat (nicklist,
+                                   gui_color_get_custom (
+                                       group->color),
+                                   -1);
+            }
+        }
+        string_dyn_concat (nicklist,
+                           gui_nicklist_get_group_start (
+                               group->name),
+                           -1);
+    }
+}
+
 /*
  * Bar item with nicklist.
  */
@@ -1846,16 +2168,14 @@ gui_bar_item_buffer_nicklist_cb (const void *pointer, void *data,
 {
     struct t_gui_nick_group *ptr_group;
     struct t_gui_nick *ptr_nick;
-    struct t_config_option *ptr_option;
     char **nicklist;
-    int i;
+    int limit_lines, lines_start, lines_count, line, length, max_length;
 
     /* make C compiler happy */
     (void) pointer;
     (void) data;
     (void) item;
     (void) window;
-    (void) extra_info;
 
     if (!buffer)
         return NULL;
@@ -1864,6 +2184,17 @@ gui_bar_item_buffer_nicklist_cb (const void *pointer, void *data,
     if (!nicklist)
         return NULL;
 
+    /*
+     * with a huge nicklist, only lines displayed in bar window are built,
+     * other lines are just counted (and their length is computed, for bars
+     * with automatic size)
+     */
+    limit_lines = gui_bar_item_get_lines_displayed (extra_info,
+                                                    &lines_start,
+                                                    &lines_count);
+    line = 0;
+    max_length = 0;
+
     ptr_group = NULL;
     ptr_nick = NULL;
     gui_nicklist_get_next_item (buffer, &ptr_group, &ptr_nick);
@@ -1874,112 +2205,40 @@ gui_bar_item_buffer_nicklist_cb (const void *pointer, void *data,
                 && buffer->nicklist_display_groups
                 && ptr_group->visible))
         {
-            if (*nicklist[0])
-                string_dyn_concat (nicklist, "\n", -1);
-
-            if (ptr_nick)
+            if (limit_lines)
             {
-                if (buffer->nicklist_display_groups)
-                {
-                    for (i = 0; i < ptr_nick->group->level; i++)
-                    {
-                        string_dyn_concat (nicklist, " ", -1);
-                    }
-                }
-                if (ptr_nick->prefix_color)
+                if (ptr_nick)
                 {
-                    if (strchr (ptr_nick->prefix_color, '.'))
-                    {
-                        config_file_search_with_string (ptr_nick->prefix_color,
-                                                        NULL, NULL, &ptr_option,
-                                                            NULL);
-                        if (ptr_option)
-                        {
-                            string_dyn_concat (
-                                nicklist,
-                                gui_color_get_custom (
-                                    gui_color_get_name (
-                                        CONFIG_COLOR(ptr_option))),
-                                -1);
-                        }
-                    }
-                    else
-                    {
-                        string_dyn_concat (nicklist,
-                                           gui_color_get_custom (
-                                               ptr_nick->prefix_color),
-                                           -1);
-                    }
+                    length = ((buffer->nicklist_display_groups) ?
+                              ptr_nick->group->level : 0)
+                        + utf8_strlen_screen (ptr_nick->prefix)
+                        + utf8_strlen_screen (ptr_nick->name);
                 }
-                if (ptr_nick->prefix)
-                    string_dyn_concat (nicklist, ptr_nick->prefix, -1);
-                if (ptr_nick->color)
+                else
                 {
-                    if (strchr (ptr_nick->color, '.'))
-                    {
-                        config_file_search_with_string (ptr_nick->color,
-                                                        NULL, NULL, &ptr_option,
-                                                        NULL);
-                        if (ptr_option)
-                        {
-                            string_dyn_concat (
-                                nicklist,
-                                gui_color_get_custom (
-                                    gui_color_get_name (
-                                        CONFIG_COLOR(ptr_option))),
-                                -1);
-                        }
-                    }
-                    else
-                    {
-                        string_dyn_concat (nicklist,
-                                           gui_color_get_custom (
-                                               ptr_nick->color),
-                                           -1);
-                    }
+                    length = ptr_group->level - 1
+                        + utf8_strlen_screen (
+                            gui_nicklist_get_group_start (ptr_group->name));
                 }
-                string_dyn_concat (nicklist, ptr_nick->name, -1);
+                if (length > max_length)
+                    max_length = length;
             }
-            else
+            if (!limit_lines
+                || ((line >= lines_start)
+                    && (line < lines_start + lines_count)))
             {
-                for (i = 0; i < ptr_group->level - 1; i++)
-                {
-                    string_dyn_concat (nicklist, " ", -1);
-                }
-                if (ptr_group->color)
-                {
-                    if (strchr (ptr_group->color, '.'))
-                    {
-                        config_file_search_with_string (ptr_group->color,
-                                                        NULL, NULL, &ptr_option,
-                                                        NULL);
-                        if (ptr_option)
-                        {
-                            string_dyn_concat (
-                                nicklist,
-                                gui_color_get_custom (
-                                    gui_color_get_name (
-                                        CONFIG_COLOR(ptr_option))),
-                                -1);
-                        }
-                    }
-                    else
-                    {
-                        string_dyn_concat (nicklist,
-                                           gui_color_get_custom (
-                                               ptr_group->color),
-                                           -1);
-                    }
-                }
-                string_dyn_concat (nicklist,
-                                   gui_nicklist_get_group_start (
-                                       ptr_group->name),
-                                   -1);
+                gui_bar_item_buffer_nicklist_add_line (nicklist, buffer,
+                                                       ptr_group, ptr_nick);
             }
+            line++;
         }
         gui_nicklist_get_next_item (buffer, &ptr_group, &ptr_nick);
     }
 
+    if (limit_lines)
+        gui_bar_item_set_lines_returned (extra_info, line, lines_start,
+                                         max_length);
+
     return string_dyn_free (nicklist, 0);
 }
 
@@ -2402,7 +2661,8 @@ gui_bar_item_init ()
                       gui_bar_item_names[GUI_BAR_ITEM_BUFFER_NUMBER],
                       &gui_bar_item_buffer_number_cb, NULL, NULL);
     gui_bar_item_hook_signal ("window_switch;buffer_switch;buffer_moved;"
-                              "buffer_merged;buffer_unmerged;buffer_closed",
+                              "buffer_list_reordered;buffer_merged;"
+                              "buffer_unmerged;buffer_closed",
                               gui_bar_item_names[GUI_BAR_ITEM_BUFFER_NUMBER]);
 
     /* buffer name */
@@ -2410,7 +2670,7 @@ gui_bar_item_init ()
                       gui_bar_item_names[GUI_BAR_ITEM_BUFFER_NAME],
                       &gui_bar_item_buffer_name_cb, NULL, NULL);
     gui_bar_item_hook_signal ("window_switch;buffer_switch;buffer_renamed;"
-                              "buffer_moved",
+                              "buffer_moved;buffer_list_reordered",
                               gui_bar_item_names[GUI_BAR_ITEM_BUFFER_NAME]);
 
     /* buffer short name */
@@ -2418,7 +2678,7 @@ gui_bar_item_init ()
                       gui_bar_item_names[GUI_BAR_ITEM_BUFFER_SHORT_NAME],
                       &gui_bar_item_buffer_short_name_cb, NULL, NULL);
     gui_bar_item_hook_signal ("window_switch;buffer_switch;buffer_renamed;"
-                              "buffer_moved",
+                              "buffer_moved;buffer_list_reordered",
                               gui_bar_item_names[GUI_BAR_ITEM_BUFFER_SHORT_NAME]);
 
     /* buffer modes */
@@ -2475,7 +2735,8 @@ gui_bar_item_init ()
     gui_bar_item_new (NULL,
                       gui_bar_item_names[GUI_BAR_ITEM_HOTLIST],
                       &gui_bar_item_hotlist_cb, NULL, NULL);
-    gui_bar_item_hook_signal ("hotlist_changed;buffer_moved;buffer_closed;"
+    gui_bar_item_hook_signal ("hotlist_changed;buffer_moved;"
+                              "buffer_list_reordered;buffer_closed;"
                               "buffer_localvar_*",
                               gui_bar_item_names[GUI_BAR_ITEM_HOTLIST]);
 
@@ -2558,10 +2819,52 @@ gui_bar_item_end ()
         gui_bar_item_hooks = next_bar_item_hook;
     }
 
+    /* remove pending updates */
+    if (gui_bar_item_updates_timer)
+    {
+        unhook (gui_bar_item_updates_timer);
+        gui_bar_item_updates_timer = NULL;
+    }
+    hashtable_free (gui_bar_item_updates);
+    gui_bar_item_updates = NULL;
+
     /* remove bar items */
     gui_bar_item_free_all ();
 }
 
+/*
+ * Callback for updating data of a bar item.
+ */
+
+int
+gui_bar_item_hdata_bar_item_update_cb (void *data,
+                                       struct t_hdata *hdata,
+                                       void *pointer,
+                                       struct t_hashtable *hashtable)
+{
+    const char *value;
+    int rc;
+
+    /* make C compiler happy */
+    (void) data;
+
+    rc = 0;
+
+    if (hashtable_has_key (hashtable, "update_min_interval"))
+    {
+        value = hashtable_get (hashtable, "update_min_interval");
+        if (value)
+        {
+            hdata_set (hdata, pointer, "update_min_interval", value);
+            if (((struct t_gui_bar_item *)pointer)->update_min_interval < 0)
+                ((struct t_gui_bar_item *)pointer)->update_min_interval = 0;
+            rc++;
+        }
+    }
+
+    return rc;
+}
+
 /*
  * Return hdata for bar item.
  */
@@ -2577,7 +2880,7 @@ gui_bar_item_hdata_bar_item_cb (const void *pointer, void *data,
     (void) data;
 
     hdata = hdata_new (NULL, hdata_name, "prev_item", "next_item",
-                       0, 0, NULL, NULL);
+                       0, 0, &gui_bar_item_hdata_bar_item_update_cb, NULL);
     if (hdata)
     {
         HDATA_VAR(struct t_gui_bar_item, plugin, POINTER, 0, NULL, "plugin");
@@ -2585,6 +2888,7 @@ gui_bar_item_hdata_bar_item_cb (const void *pointer, void *data,
         HDATA_VAR(struct t_gui_bar_item, build_callback, POINTER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_bar_item, build_callback_pointer, POINTER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_bar_item, build_callback_data, POINTER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_bar_item, update_min_interval, INTEGER, 1, NULL, NULL);
         HDATA_VAR(struct t_gui_bar_item, prev_item, POINTER, 0, NULL, hdata_name);
         HDATA_VAR(struct t_gui_bar_item, next_item, POINTER, 0, NULL, hdata_name);
         HDATA_LIST(gui_bar_items, WEECHAT_HDATA_LIST_CHECK_POINTERS);
@@ -2637,6 +2941,11 @@ gui_bar_item_print_log ()
 {
     struct t_gui_bar_item *ptr_item;
 
+    log_printf ("");
+    log_printf ("[bar items pending updates: %d (timer: %p)]",
+                (gui_bar_item_updates) ? gui_bar_item_updates->items_count : 0,
+                gui_bar_item_updates_timer);
+
     for (ptr_item = gui_bar_items; ptr_item; ptr_item = ptr_item->next_item)
     {
         log_printf ("");
@@ -2647,6 +2956,10 @@ gui_bar_item_print_log ()
         log_printf ("  build_callback . . . . : %p", ptr_item->build_callback);
         log_printf ("  build_callback_pointer : %p", ptr_item->build_callback_pointer);
         log_printf ("  build_callback_data. . : %p", ptr_item->build_callback_data);
+        log_printf ("  update_min_interval. . : %d", ptr_item->update_min_interval);
+        log_printf ("  update_last_time . . . : %lld.%06ld",
+                    (long long)(ptr_item->update_last_time.tv_sec),
+                    (long)(ptr_item->update_last_time.tv_usec));
         log_printf ("  prev_item. . . . . . . : %p", ptr_item->prev_item);
         log_printf ("  next_item. . . . . . . : %p", ptr_item->next_item);
     }
@@ -20,6 +20,8 @@
 #ifndef WEECHAT_GUI_BAR_ITEM_H
 #define WEECHAT_GUI_BAR_ITEM_H
 
+#include <sys/time.h>
+
 enum t_gui_bar_item_weechat
 {
     GUI_BAR_ITEM_INPUT_PASTE = 0,
@@ -71,6 +73,9 @@ struct t_gui_bar_item
                                      /* callback called for building item   */
     const void *build_callback_pointer; /* pointer for callback             */
     void *build_callback_data;          /* data for callback                */
+    int update_min_interval;         /* min interval between two updates    */
+                                     /* (in milliseconds, 0 = no limit)     */
+    struct timeval update_last_time; /* time of last update                 */
     struct t_gui_bar_item *prev_item; /* link to previous bar item          */
     struct t_gui_bar_item *next_item; /* link to next bar item              */
 };
@@ -86,6 +91,7 @@ struct t_gui_bar_item_hook
 extern struct t_gui_bar_item *gui_bar_items;
 extern struct t_gui_bar_item *last_gui_bar_item;
 extern char *gui_bar_item_names[];
+extern struct t_hashtable *gui_bar_item_updates;
 
 /* functions */
 
@@ -103,8 +109,15 @@ extern void gui_bar_item_get_vars (const char *item_name,
                                    char **suffix);
 extern char *gui_bar_item_get_value (struct t_gui_bar *bar,
                                      struct t_gui_window *window,
-                                     int item, int subitem);
+                                     int item, int subitem,
+                                     struct t_hashtable *extra_info);
 extern int gui_bar_item_count_lines (char *string);
+extern int gui_bar_item_get_lines_displayed (struct t_hashtable *extra_info,
+                                             int *lines_start,
+                                             int *lines_count);
+extern void gui_bar_item_set_lines_returned (struct t_hashtable *extra_info,
+                                             int lines_total, int lines_start,
+                                             int max_length);
 extern struct t_gui_bar_item *gui_bar_item_new (struct t_weechat_plugin *plugin,
                                                 const char *name,
                                                 char *(*build_callback)(const void *pointer,
@@ -115,7 +128,9 @@ extern struct t_gui_bar_item *gui_bar_item_new (struct t_weechat_plugin *plugin,
                                                                         struct t_hashtable *extra_info),
                                                 const void *build_callback_pointer,
                                                 void *build_callback_data);
-extern void gui_bar_item_update (const char *name);
+extern void gui_bar_item_update_now (const char *item_name);
+extern void gui_bar_item_update (const char *item_name);
+extern void gui_bar_item_update_flush ();
 extern void gui_bar_item_free (struct t_gui_bar_item *item);
 extern void gui_bar_item_free_all ();
 extern void gui_bar_item_free_all_plugin (struct t_weechat_plugin *plugin);
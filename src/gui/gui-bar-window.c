@@ -449,6 +449,11 @@ gui_bar_window_content_alloc (struct t_gui_bar_window *bar_window)
     bar_window->items_content = NULL;
     bar_window->items_num_lines = NULL;
     bar_window->items_refresh_needed = NULL;
+    bar_window->content_scroll_y = -1;
+    bar_window->content_height = 0;
+    bar_window->content_lines_start = 0;
+    bar_window->content_lines_total = 0;
+    bar_window->content_max_length = 0;
     bar_window->screen_col_size = 0;
     bar_window->screen_lines = 0;
     bar_window->items_subcount = calloc (1,
@@ -580,6 +585,152 @@ gui_bar_window_content_free (struct t_gui_bar_window *bar_window)
     }
 }
 
+/*
+ * Checks if the content of a bar window can be limited to the lines
+ * displayed (the item callback can then build only these lines); the bar
+ * must have:
+ * - a single item, without prefix/suffix
+ * - a filling "vertical"
+ * - a size which does not depend on the number of lines (position
+ *   "left"/"right" or a fixed size).
+ *
+ * Returns:
+ *   1: content can be limited to lines displayed
+ *   0: content must have all lines
+ */
+
+int
+gui_bar_window_can_limit_lines (struct t_gui_bar_window *bar_window)
+{
+    int position;
+
+    if (!bar_window || (bar_window->height <= 0)
+        || (bar_window->items_count != 1)
+        || !bar_window->items_subcount
+        || (bar_window->items_subcount[0] != 1)
+        || (bar_window->bar->items_count != 1)
+        || (bar_window->bar->items_subcount[0] != 1)
+        || !bar_window->bar->items_name[0][0]
+        || bar_window->bar->items_prefix[0][0]
+        || bar_window->bar->items_suffix[0][0])
+    {
+        return 0;
+    }
+
+    if (gui_bar_get_filling (bar_window->bar) != GUI_BAR_FILLING_VERTICAL)
+        return 0;
+
+    position = CONFIG_ENUM(bar_window->bar->options[GUI_BAR_OPTION_POSITION]);
+    if ((position != GUI_BAR_POSITION_LEFT)
+        && (position != GUI_BAR_POSITION_RIGHT)
+        && (CONFIG_INTEGER(bar_window->bar->options[GUI_BAR_OPTION_SIZE]) == 0))
+    {
+        return 0;
+    }
+
+    return 1;
+}
+
+/*
+ * Gets value of an item with only lines displayed in bar window: the
+ * callback receives the lines displayed in "extra_info" (keys "_lines_start"
+ * and "_lines_count") and sets the total number of lines (key "_lines_total"),
+ * the first line returned (key "_lines_start") and optionally the max length
+ * of all lines (key "_lines_max_length").
+ *
+ * If the callback does not set the key "_lines_total", the value returned
+ * is the full content of item.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+gui_bar_window_content_get_lines (struct t_gui_bar_window *bar_window,
+                                  struct t_gui_window *window,
+                                  int index_item, int index_subitem)
+{
+    struct t_hashtable *extra_info;
+    char *value, str_value[32], *error;
+    const char *ptr_value;
+    int i, scroll_y, max_scroll_y;
+    long number;
+
+    extra_info = hashtable_new (32,
+                                WEECHAT_HASHTABLE_STRING,
+                                WEECHAT_HASHTABLE_STRING,
+                                NULL, NULL);
+    if (!extra_info)
+    {
+        return gui_bar_item_get_value (bar_window->bar, window,
+                                       index_item, index_subitem, NULL);
+    }
+
+    value = NULL;
+
+    /*
+     * the callback is called a second time if the scroll was not valid
+     * (too high) or if it was changed by the callback itself
+     */
+    for (i = 0; i < 2; i++)
+    {
+        free (value);
+        bar_window->content_scroll_y = -1;
+        scroll_y = bar_window->scroll_y;
+        hashtable_remove_all (extra_info);
+        snprintf (str_value, sizeof (str_value), "%d", scroll_y);
+        hashtable_set (extra_info, "_lines_start", str_value);
+        snprintf (str_value, sizeof (str_value), "%d", bar_window->height);
+        hashtable_set (extra_info, "_lines_count", str_value);
+
+        value = gui_bar_item_get_value (bar_window->bar, window,
+                                        index_item, index_subitem,
+                                        extra_info);
+
+        /* item has returned all lines? */
+        ptr_value = hashtable_get (extra_info, "_lines_total");
+        if (!ptr_value)
+            break;
+        error = NULL;
+        number = strtol (ptr_value, &error, 10);
+        if (!error || error[0] || (number < 0))
+            break;
+
+        bar_window->content_scroll_y = scroll_y;
+        bar_window->content_height = bar_window->height;
+        bar_window->content_lines_total = (int)number;
+        bar_window->content_lines_start = scroll_y;
+        ptr_value = hashtable_get (extra_info, "_lines_start");
+        if (ptr_value)
+        {
+            error = NULL;
+            number = strtol (ptr_value, &error, 10);
+            if (error && !error[0] && (number >= 0))
+                bar_window->content_lines_start = (int)number;
+        }
+        bar_window->content_max_length = 0;
+        ptr_value = hashtable_get (extra_info, "_lines_max_length");
+        if (ptr_value)
+        {
+            error = NULL;
+            number = strtol (ptr_value, &error, 10);
+            if (error && !error[0] && (number >= 0))
+                bar_window->content_max_length = (int)number;
+        }
+
+        max_scroll_y = bar_window->content_lines_total - bar_window->height;
+        if (max_scroll_y < 0)
+            max_scroll_y = 0;
+        if (bar_window->scroll_y > max_scroll_y)
+            bar_window->scroll_y = max_scroll_y;
+        if (bar_window->scroll_y == scroll_y)
+            break;
+    }
+
+    hashtable_free (extra_info);
+
+    return value;
+}
+
 /*
  * Builds content of an item for a bar window.
  */
@@ -600,15 +751,29 @@ gui_bar_window_content_build_item (struct t_gui_bar_window *bar_window,
             bar_window->items_content[index_item][index_subitem] = NULL;
         }
         bar_window->items_num_lines[index_item][index_subitem] = 0;
+        bar_window->content_scroll_y = -1;
 
         /* build item, but only if there's a buffer in window */
         if ((window && window->buffer)
             || (gui_current_window && gui_current_window->buffer))
         {
-            bar_window->items_content[index_item][index_subitem] =
-                gui_bar_item_get_value (bar_window->bar, window,
-                                        index_item, index_subitem);
+            if (gui_bar_window_can_limit_lines (bar_window))
+            {
+                bar_window->items_content[index_item][index_subitem] =
+                    gui_bar_window_content_get_lines (bar_window, window,
+                                                      index_item,
+                                                      index_subitem);
+            }
+            else
+            {
+                bar_window->items_content[index_item][index_subitem] =
+                    gui_bar_item_get_value (bar_window->bar, window,
+                                            index_item, index_subitem,
+                                            NULL);
+            }
             bar_window->items_num_lines[index_item][index_subitem] =
+                (bar_window->content_scroll_y >= 0) ?
+                bar_window->content_lines_total :
                 gui_bar_item_count_lines (bar_window->items_content[index_item][index_subitem]);
             bar_window->items_refresh_needed[index_item][index_subitem] = 0;
         }
@@ -653,8 +818,14 @@ gui_bar_window_content_get (struct t_gui_bar_window *bar_window,
     if (!bar_window)
         return NULL;
 
-    /* rebuild content if refresh is needed */
-    if (bar_window->items_refresh_needed[index_item][index_subitem])
+    /*
+     * rebuild content if refresh is needed, or if content has only lines
+     * displayed and bar window has been scrolled or resized
+     */
+    if (bar_window->items_refresh_needed[index_item][index_subitem]
+        || ((bar_window->content_scroll_y >= 0)
+            && ((bar_window->scroll_y != bar_window->content_scroll_y)
+                || (bar_window->height != bar_window->content_height))))
     {
         gui_bar_window_content_build_item (bar_window, window,
                                            index_item, index_subitem);
@@ -664,6 +835,37 @@ gui_bar_window_content_get (struct t_gui_bar_window *bar_window,
     return bar_window->items_content[index_item][index_subitem];
 }
 
+/*
+ * Searches window containing a bar window.
+ *
+ * Returns pointer to window found, NULL if not found or if the bar window
+ * is in a root bar.
+ */
+
+struct t_gui_window *
+gui_bar_window_search_window (struct t_gui_bar_window *bar_window)
+{
+    struct t_gui_window *ptr_window;
+    struct t_gui_bar_window *ptr_bar_window;
+
+    if (!bar_window || (bar_window->bar->bar_window == bar_window))
+        return NULL;
+
+    for (ptr_window = gui_windows; ptr_window;
+         ptr_window = ptr_window->next_window)
+    {
+        for (ptr_bar_window = ptr_window->bar_windows; ptr_bar_window;
+             ptr_bar_window = ptr_bar_window->next_bar_window)
+        {
+            if (ptr_bar_window == bar_window)
+                return ptr_window;
+        }
+    }
+
+    /* bar window not found */
+    return NULL;
+}
+
 /*
  * Checks if the item content is a spacer (bar item "spacer").
  *
@@ -1225,6 +1427,11 @@ gui_bar_window_new (struct t_gui_bar *bar, struct t_gui_window *window)
         new_bar_window->items_content = NULL;
         new_bar_window->items_num_lines = NULL;
         new_bar_window->items_refresh_needed = NULL;
+        new_bar_window->content_scroll_y = -1;
+        new_bar_window->content_height = 0;
+        new_bar_window->content_lines_start = 0;
+        new_bar_window->content_lines_total = 0;
+        new_bar_window->content_max_length = 0;
         new_bar_window->screen_col_size = 0;
         new_bar_window->screen_lines = 0;
         new_bar_window->coords_count = 0;
@@ -1676,6 +1883,10 @@ gui_bar_window_hdata_bar_window_cb (const void *pointer, void *data,
 /*
  * Adds a bar window in an infolist.
  *
+ * Content of items is built if a refresh is needed (bar items are not built
+ * when the bar is not drawn, for example in headless mode with option
+ * "--no-render").
+ *
  * Returns:
  *   1: OK
  *   0: error
@@ -1686,12 +1897,15 @@ gui_bar_window_add_to_infolist (struct t_infolist *infolist,
                                 struct t_gui_bar_window *bar_window)
 {
     struct t_infolist_item *ptr_item;
+    struct t_gui_window *ptr_window;
     int i, j;
     char option_name[64];
 
     if (!infolist || !bar_window)
         return 0;
 
+    ptr_window = gui_bar_window_search_window (bar_window);
+
     ptr_item = infolist_new_item (infolist);
     if (!ptr_item)
         return 0;
@@ -1724,8 +1938,10 @@ gui_bar_window_add_to_infolist (struct t_infolist *infolist,
         {
             snprintf (option_name, sizeof (option_name),
                       "items_content_%05d_%05d", i + 1, j + 1);
-            if (!infolist_new_var_string (ptr_item, option_name,
-                                          bar_window->items_content[i][j]))
+            if (!infolist_new_var_string (
+                    ptr_item, option_name,
+                    gui_bar_window_content_get (bar_window, ptr_window,
+                                                i, j)))
                 return 0;
             snprintf (option_name, sizeof (option_name),
                       "items_num_lines_%05d_%05d", i + 1, j + 1);
@@ -1792,6 +2008,11 @@ gui_bar_window_print_log (struct t_gui_bar_window *bar_window)
             log_printf ("    items_content. . . . . . : %p", bar_window->items_content);
         }
     }
+    log_printf ("    content_scroll_y . . . : %d", bar_window->content_scroll_y);
+    log_printf ("    content_height . . . . : %d", bar_window->content_height);
+    log_printf ("    content_lines_start. . : %d", bar_window->content_lines_start);
+    log_printf ("    content_lines_total. . : %d", bar_window->content_lines_total);
+    log_printf ("    content_max_length . . : %d", bar_window->content_max_length);
     log_printf ("    screen_col_size. . . . : %d", bar_window->screen_col_size);
     log_printf ("    screen_lines . . . . . : %d", bar_window->screen_lines);
     log_printf ("    coords_count . . . . . : %d", bar_window->coords_count);
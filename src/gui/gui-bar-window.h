@@ -49,6 +49,14 @@ struct t_gui_bar_window
     char ***items_content;          /* content for each (sub)item of bar    */
     int **items_num_lines;          /* number of lines for each (sub)item   */
     int **items_refresh_needed;     /* refresh needed for (sub)item?        */
+    int content_scroll_y;           /* scroll_y used to build content with  */
+                                    /* only lines displayed (-1 if content  */
+                                    /* has all lines)                       */
+    int content_height;             /* height used to build content         */
+    int content_lines_start;        /* first line in content                */
+    int content_lines_total;        /* total number of lines in item        */
+    int content_max_length;         /* max length of all lines in item      */
+                                    /* (0 if unknown)                       */
     int screen_col_size;            /* size of columns on screen            */
                                     /* (for filling with columns)           */
     int screen_lines;               /* number of lines on screen            */
@@ -76,6 +84,12 @@ extern void gui_bar_window_calculate_pos_size (struct t_gui_bar_window *bar_wind
                                                struct t_gui_window *window);
 extern void gui_bar_window_content_build (struct t_gui_bar_window *bar_window,
                                           struct t_gui_window *window);
+extern int gui_bar_window_can_limit_lines (struct t_gui_bar_window *bar_window);
+extern char *gui_bar_window_content_get_lines (struct t_gui_bar_window *bar_window,
+                                               struct t_gui_window *window,
+                                               int index_item,
+                                               int index_subitem);
+extern struct t_gui_window *gui_bar_window_search_window (struct t_gui_bar_window *bar_window);
 extern char *gui_bar_window_content_get_with_filling (struct t_gui_bar_window *bar_window,
                                                       struct t_gui_window *window,
                                                       int *num_spacers);
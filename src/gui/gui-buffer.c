@@ -25,6 +25,7 @@
 
 #include <stdlib.h>
 #include <stdint.h>
+#include <limits.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdarg.h>
@@ -59,6 +60,7 @@
 #include "gui-key.h"
 #include "gui-layout.h"
 #include "gui-line.h"
+#include "gui-line-compress.h"
 #include "gui-main.h"
 #include "gui-nicklist.h"
 #include "gui-window.h"
@@ -76,9 +78,20 @@ int gui_buffers_visited_count = 0;              /* number of visited buffers*/
 int gui_buffers_visited_frozen = 0;             /* 1 to forbid list updates */
 struct t_gui_buffer *gui_buffer_last_displayed = NULL; /* last b. displayed */
 
+struct t_hashtable *gui_buffer_pointers = NULL; /* all buffers (to check   */
+                                                /* pointers quickly)        */
 struct t_hashtable *gui_buffer_by_id = NULL;    /* buffers by id            */
+struct t_hashtable *gui_buffer_by_full_name = NULL; /* buffers by full name */
+struct t_hashtable *gui_buffer_by_full_name_lower = NULL; /* buffers by     */
+                                                /* full name (lower case)   */
 long long gui_buffer_last_id_assigned = -1;     /* last id assigned         */
 
+struct t_gui_buffer **gui_buffer_number_index = NULL; /* first buffer of    */
+                                                /* each number (sorted)     */
+int gui_buffer_number_index_count = 0;          /* number of items in index */
+int gui_buffer_number_index_size = 0;           /* allocated size of index  */
+int gui_buffer_number_index_valid = 0;          /* 0 if index must be built */
+
 char *gui_buffer_reserved_names[] =
 { GUI_BUFFER_MAIN, SECURE_BUFFER_NAME, GUI_COLOR_BUFFER_NAME,
   NULL
@@ -87,6 +100,13 @@ char *gui_buffer_reserved_names[] =
 int gui_buffer_set_signals = 1;        /* 0 to disable signals sent in      */
                                        /* function gui_buffer_set           */
 
+int gui_buffer_set_multiple_count = 0; /* > 0 in gui_buffer_set_multiple    */
+struct t_gui_buffer_signal_delayed *gui_buffer_signals_delayed = NULL;
+                                       /* signals sent at end of            */
+                                       /* gui_buffer_set_multiple           */
+int gui_buffer_signals_delayed_count = 0; /* number of delayed signals      */
+int gui_buffer_signals_delayed_size = 0;  /* allocated size of array        */
+
 char *gui_buffer_type_string[GUI_BUFFER_NUM_TYPES] =
 { "formatted", "free" };
 
@@ -182,8 +202,49 @@ gui_buffer_search_notify (const char *notify)
     return -1;
 }
 
+/*
+ * Delays a buffer signal until the end of gui_buffer_set_multiple (the signal
+ * is not added if the same signal with same data is already delayed).
+ */
+
+void
+gui_buffer_signal_delay (const char *signal,
+                         const char *type_data, void *signal_data)
+{
+    struct t_gui_buffer_signal_delayed *new_signals;
+    int i, new_size;
+
+    for (i = 0; i < gui_buffer_signals_delayed_count; i++)
+    {
+        if ((gui_buffer_signals_delayed[i].signal_data == signal_data)
+            && (strcmp (gui_buffer_signals_delayed[i].signal, signal) == 0))
+        {
+            return;
+        }
+    }
+
+    if (gui_buffer_signals_delayed_count >= gui_buffer_signals_delayed_size)
+    {
+        new_size = (gui_buffer_signals_delayed_size > 0) ?
+            gui_buffer_signals_delayed_size * 2 : 16;
+        new_signals = realloc (gui_buffer_signals_delayed,
+                               new_size * sizeof (*new_signals));
+        if (!new_signals)
+            return;
+        gui_buffer_signals_delayed = new_signals;
+        gui_buffer_signals_delayed_size = new_size;
+    }
+
+    gui_buffer_signals_delayed[gui_buffer_signals_delayed_count].signal = signal;
+    gui_buffer_signals_delayed[gui_buffer_signals_delayed_count].type_data = type_data;
+    gui_buffer_signals_delayed[gui_buffer_signals_delayed_count].signal_data = signal_data;
+    gui_buffer_signals_delayed_count++;
+}
+
 /*
  * Sends a buffer signal (only if the buffer is completely opened.
+ *
+ * During gui_buffer_set_multiple, the signal is sent at the end, only once.
  */
 
 int
@@ -191,8 +252,16 @@ gui_buffer_send_signal (struct t_gui_buffer *buffer,
                         const char *signal,
                         const char *type_data, void *signal_data)
 {
-    return (buffer->opening) ?
-        WEECHAT_RC_OK : hook_signal_send (signal, type_data, signal_data);
+    if (buffer->opening)
+        return WEECHAT_RC_OK;
+
+    if (gui_buffer_set_multiple_count > 0)
+    {
+        gui_buffer_signal_delay (signal, type_data, signal_data);
+        return WEECHAT_RC_OK;
+    }
+
+    return hook_signal_send (signal, type_data, signal_data);
 }
 
 /*
@@ -214,6 +283,128 @@ gui_buffer_get_plugin_name (struct t_gui_buffer *buffer)
     return plugin_get_name (buffer->plugin);
 }
 
+/*
+ * Gets number of bytes used in memory by a buffer: lines, compressed lines,
+ * nicklist and local variables (lines saved on disk are not counted).
+ */
+
+long long
+gui_buffer_get_memory_size (struct t_gui_buffer *buffer)
+{
+    if (!buffer)
+        return 0;
+
+    return buffer->own_lines->lines_size
+        + buffer->own_lines->lines_compressed_size
+        + buffer->nicklist_size
+        + buffer->local_variables_size;
+}
+
+/*
+ * Adds a buffer in hashtables "gui_buffer_by_full_name" and
+ * "gui_buffer_by_full_name_lower".
+ *
+ * If another buffer already has the same key, it is kept in the hashtable.
+ */
+
+void
+gui_buffer_full_name_index_add (struct t_gui_buffer *buffer)
+{
+    char *full_name_lower;
+
+    if (!buffer->full_name)
+        return;
+
+    if (!gui_buffer_by_full_name)
+    {
+        gui_buffer_by_full_name = hashtable_new (
+            64,
+            WEECHAT_HASHTABLE_STRING,
+            WEECHAT_HASHTABLE_POINTER,
+            NULL, NULL);
+    }
+    if (gui_buffer_by_full_name
+        && !hashtable_has_key (gui_buffer_by_full_name, buffer->full_name))
+    {
+        hashtable_set (gui_buffer_by_full_name, buffer->full_name, buffer);
+    }
+
+    if (!gui_buffer_by_full_name_lower)
+    {
+        gui_buffer_by_full_name_lower = hashtable_new (
+            64,
+            WEECHAT_HASHTABLE_STRING,
+            WEECHAT_HASHTABLE_POINTER,
+            NULL, NULL);
+    }
+    full_name_lower = string_tolower (buffer->full_name);
+    if (gui_buffer_by_full_name_lower && full_name_lower
+        && !hashtable_has_key (gui_buffer_by_full_name_lower, full_name_lower))
+    {
+        hashtable_set (gui_buffer_by_full_name_lower, full_name_lower, buffer);
+    }
+    free (full_name_lower);
+}
+
+/*
+ * Removes a buffer from hashtables "gui_buffer_by_full_name" and
+ * "gui_buffer_by_full_name_lower".
+ *
+ * If another buffer has the same key, it replaces the buffer in the
+ * hashtable.
+ */
+
+void
+gui_buffer_full_name_index_remove (struct t_gui_buffer *buffer)
+{
+    struct t_gui_buffer *ptr_buffer;
+    char *full_name_lower;
+
+    if (!buffer->full_name)
+        return;
+
+    if (gui_buffer_by_full_name
+        && (hashtable_get (gui_buffer_by_full_name,
+                           buffer->full_name) == buffer))
+    {
+        hashtable_remove (gui_buffer_by_full_name, buffer->full_name);
+        for (ptr_buffer = gui_buffers; ptr_buffer;
+             ptr_buffer = ptr_buffer->next_buffer)
+        {
+            if ((ptr_buffer != buffer)
+                && ptr_buffer->full_name
+                && (strcmp (ptr_buffer->full_name, buffer->full_name) == 0))
+            {
+                hashtable_set (gui_buffer_by_full_name,
+                               ptr_buffer->full_name, ptr_buffer);
+                break;
+            }
+        }
+    }
+
+    full_name_lower = string_tolower (buffer->full_name);
+    if (gui_buffer_by_full_name_lower && full_name_lower
+        && (hashtable_get (gui_buffer_by_full_name_lower,
+                           full_name_lower) == buffer))
+    {
+        hashtable_remove (gui_buffer_by_full_name_lower, full_name_lower);
+        for (ptr_buffer = gui_buffers; ptr_buffer;
+             ptr_buffer = ptr_buffer->next_buffer)
+        {
+            if ((ptr_buffer != buffer)
+                && ptr_buffer->full_name
+                && (string_strcasecmp (ptr_buffer->full_name,
+                                       buffer->full_name) == 0))
+            {
+                hashtable_set (gui_buffer_by_full_name_lower,
+                               full_name_lower, ptr_buffer);
+                break;
+            }
+        }
+    }
+    free (full_name_lower);
+}
+
 /*
  * Builds "full_name" of buffer (for example after changing name or
  * plugin_name_for_upgrade).
@@ -227,6 +418,7 @@ gui_buffer_build_full_name (struct t_gui_buffer *buffer)
     if (!buffer)
         return;
 
+    gui_buffer_full_name_index_remove (buffer);
     free (buffer->full_name);
     length = strlen (gui_buffer_get_plugin_name (buffer)) + 1 +
         strlen (buffer->name) + 1;
@@ -236,6 +428,35 @@ gui_buffer_build_full_name (struct t_gui_buffer *buffer)
         snprintf (buffer->full_name, length, "%s.%s",
                   gui_buffer_get_plugin_name (buffer), buffer->name);
     }
+    gui_buffer_full_name_index_add (buffer);
+
+    /* filters matching buffer may have changed */
+    buffer->filters_cache_generation = -1;
+}
+
+/*
+ * Gets number of bytes used in memory by a local variable (hashtable item,
+ * name and value).
+ */
+
+int
+gui_buffer_local_var_get_size (const char *name, const char *value)
+{
+    return sizeof (struct t_hashtable_item)
+        + ((name) ? strlen (name) + 1 : 0)
+        + ((value) ? strlen (value) + 1 : 0);
+}
+
+/*
+ * Invalidates the cache of strings with local variables replaced (called
+ * when a local variable is added, changed or removed).
+ */
+
+void
+gui_buffer_local_var_cache_invalidate (struct t_gui_buffer *buffer)
+{
+    if (buffer && buffer->local_var_cache)
+        hashtable_remove_all (buffer->local_var_cache);
 }
 
 /*
@@ -255,7 +476,15 @@ gui_buffer_local_var_add (struct t_gui_buffer *buffer, const char *name,
     if (string_strcmp (ptr_value, value) == 0)
         return;
 
+    if (ptr_value)
+    {
+        buffer->local_variables_size -= gui_buffer_local_var_get_size (
+            name, ptr_value);
+    }
     hashtable_set (buffer->local_variables, name, value);
+    buffer->local_variables_size += gui_buffer_local_var_get_size (name,
+                                                                   value);
+    gui_buffer_local_var_cache_invalidate (buffer);
 
     (void) gui_buffer_send_signal (
         buffer,
@@ -278,7 +507,10 @@ gui_buffer_local_var_remove (struct t_gui_buffer *buffer, const char *name)
     ptr_value = hashtable_get (buffer->local_variables, name);
     if (ptr_value)
     {
+        buffer->local_variables_size -= gui_buffer_local_var_get_size (
+            name, ptr_value);
         hashtable_remove (buffer->local_variables, name);
+        gui_buffer_local_var_cache_invalidate (buffer);
         (void) gui_buffer_send_signal (buffer,
                                        "buffer_localvar_removed",
                                        WEECHAT_HOOK_SIGNAL_POINTER, buffer);
@@ -295,6 +527,8 @@ gui_buffer_local_var_remove_all (struct t_gui_buffer *buffer)
     if (buffer && buffer->local_variables)
     {
         hashtable_remove_all (buffer->local_variables);
+        buffer->local_variables_size = 0;
+        gui_buffer_local_var_cache_invalidate (buffer);
         (void) gui_buffer_send_signal (buffer,
                                        "buffer_localvar_removed",
                                        WEECHAT_HOOK_SIGNAL_POINTER, buffer);
@@ -441,6 +675,128 @@ gui_buffer_find_pos (struct t_gui_buffer *buffer)
     return NULL;
 }
 
+/*
+ * Invalidates the index of buffers by number: it is built again on next
+ * search by number.
+ *
+ * This function must be called each time the list of buffers or a buffer
+ * number is changed.
+ */
+
+void
+gui_buffer_number_index_invalidate ()
+{
+    gui_buffer_number_index_valid = 0;
+}
+
+/*
+ * Builds the index of buffers by number: first buffer of each number, sorted
+ * by number.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+gui_buffer_number_index_build ()
+{
+    struct t_gui_buffer *ptr_buffer, **new_index;
+    int count, new_size;
+
+    count = 0;
+    for (ptr_buffer = gui_buffers; ptr_buffer;
+         ptr_buffer = ptr_buffer->next_buffer)
+    {
+        if (!ptr_buffer->prev_buffer
+            || (ptr_buffer->number != ptr_buffer->prev_buffer->number))
+        {
+            count++;
+        }
+    }
+
+    if (count > gui_buffer_number_index_size)
+    {
+        new_size = (gui_buffer_number_index_size > 0) ?
+            gui_buffer_number_index_size : 64;
+        while (new_size < count)
+        {
+            new_size *= 2;
+        }
+        new_index = realloc (gui_buffer_number_index,
+                             new_size * sizeof (*new_index));
+        if (!new_index)
+            return 0;
+        gui_buffer_number_index = new_index;
+        gui_buffer_number_index_size = new_size;
+    }
+
+    count = 0;
+    for (ptr_buffer = gui_buffers; ptr_buffer;
+         ptr_buffer = ptr_buffer->next_buffer)
+    {
+        if (!ptr_buffer->prev_buffer
+            || (ptr_buffer->number != ptr_buffer->prev_buffer->number))
+        {
+            gui_buffer_number_index[count++] = ptr_buffer;
+        }
+    }
+    gui_buffer_number_index_count = count;
+    gui_buffer_number_index_valid = 1;
+
+    return 1;
+}
+
+/*
+ * Searches position of a number in the index of buffers by number (the index
+ * must be valid).
+ *
+ * Returns position in index (>= 0), -1 if number is not found.
+ */
+
+int
+gui_buffer_number_index_search (int number)
+{
+    int min, max, middle;
+
+    /* fast path: no gap in numbers before this one */
+    if ((number >= 1) && (number <= gui_buffer_number_index_count)
+        && (gui_buffer_number_index[number - 1]->number == number))
+    {
+        return number - 1;
+    }
+
+    min = 0;
+    max = gui_buffer_number_index_count - 1;
+    while (min <= max)
+    {
+        middle = (min + max) / 2;
+        if (number == gui_buffer_number_index[middle]->number)
+            return middle;
+        if (number < gui_buffer_number_index[middle]->number)
+            max = middle - 1;
+        else
+            min = middle + 1;
+    }
+
+    /* number not found */
+    return -1;
+}
+
+/*
+ * Frees the index of buffers by number.
+ */
+
+void
+gui_buffer_number_index_free ()
+{
+    free (gui_buffer_number_index);
+    gui_buffer_number_index = NULL;
+    gui_buffer_number_index_count = 0;
+    gui_buffer_number_index_size = 0;
+    gui_buffer_number_index_valid = 0;
+}
+
 /*
  * Shifts number of buffers (number + 1) until we find a gap (if auto renumber
  * is OFF), or until last buffer.
@@ -451,6 +807,8 @@ gui_buffer_shift_numbers (struct t_gui_buffer *buffer)
 {
     struct t_gui_buffer *ptr_buffer;
 
+    gui_buffer_number_index_invalidate ();
+
     for (ptr_buffer = buffer; ptr_buffer; ptr_buffer = ptr_buffer->next_buffer)
     {
         if (ptr_buffer->prev_buffer
@@ -577,6 +935,19 @@ gui_buffer_insert (struct t_gui_buffer *buffer)
         last_gui_buffer = buffer;
     }
 
+    gui_buffer_number_index_invalidate ();
+
+    if (!gui_buffer_pointers)
+    {
+        gui_buffer_pointers = hashtable_new (
+            64,
+            WEECHAT_HASHTABLE_POINTER,
+            WEECHAT_HASHTABLE_POINTER,
+            NULL, NULL);
+    }
+    if (gui_buffer_pointers)
+        hashtable_set (gui_buffer_pointers, buffer, NULL);
+
     if (merge_buffer)
         gui_buffer_merge (buffer, merge_buffer);
     else
@@ -858,6 +1229,9 @@ gui_buffer_new_props_with_id (long long id,
     new_buffer->day_change = 1;
     new_buffer->clear = 1;
     new_buffer->filter = 1;
+    new_buffer->filters_cache = NULL;
+    new_buffer->filters_cache_count = 0;
+    new_buffer->filters_cache_generation = -1;
 
     /* close callback */
     new_buffer->close_callback = close_callback;
@@ -878,6 +1252,13 @@ gui_buffer_new_props_with_id (long long id,
     new_buffer->next_line_id = 0;
     new_buffer->time_for_each_line = 1;
     new_buffer->chat_refresh_needed = 2;
+    new_buffer->chat_refresh_lines_added = 0;
+    new_buffer->lines_batch = 0;
+    new_buffer->lines_batch_first_id = 0;
+    new_buffer->lines_batch_count = 0;
+    new_buffer->lines_batch_hidden = 0;
+    memset (new_buffer->lines_batch_hotlist, 0,
+            sizeof (new_buffer->lines_batch_hotlist));
 
     /* nicklist */
     new_buffer->nicklist = 0;
@@ -892,6 +1273,27 @@ gui_buffer_new_props_with_id (long long id,
     new_buffer->nicklist_nicks_count = 0;
     new_buffer->nicklist_nicks_visible_count = 0;
     new_buffer->nicklist_last_id_assigned = -1;
+    new_buffer->nicklist_size = 0;
+    new_buffer->nicklist_groups_by_id = hashtable_new (
+        32,
+        WEECHAT_HASHTABLE_LONGLONG,
+        WEECHAT_HASHTABLE_POINTER,
+        NULL, NULL);
+    new_buffer->nicklist_groups_by_name = hashtable_new (
+        32,
+        WEECHAT_HASHTABLE_STRING,
+        WEECHAT_HASHTABLE_POINTER,
+        NULL, NULL);
+    new_buffer->nicklist_nicks_by_id = hashtable_new (
+        32,
+        WEECHAT_HASHTABLE_LONGLONG,
+        WEECHAT_HASHTABLE_POINTER,
+        NULL, NULL);
+    new_buffer->nicklist_nicks_by_name = hashtable_new (
+        32,
+        WEECHAT_HASHTABLE_STRING,
+        WEECHAT_HASHTABLE_POINTER,
+        NULL, NULL);
     new_buffer->nickcmp_callback = NULL;
     new_buffer->nickcmp_callback_pointer = NULL;
     new_buffer->nickcmp_callback_data = NULL;
@@ -928,6 +1330,7 @@ gui_buffer_new_props_with_id (long long id,
     new_buffer->last_history = NULL;
     new_buffer->ptr_history = NULL;
     new_buffer->num_history = 0;
+    new_buffer->history_index = NULL;
 
     /* text search */
     new_buffer->text_search = GUI_BUFFER_SEARCH_DISABLED;
@@ -943,6 +1346,8 @@ gui_buffer_new_props_with_id (long long id,
 
     /* highlight */
     new_buffer->highlight_words = NULL;
+    new_buffer->highlight_words_compiled = NULL;
+    new_buffer->highlight_words_global_compiled = NULL;
     new_buffer->highlight_disable_regex = NULL;
     new_buffer->highlight_disable_regex_compiled = NULL;
     new_buffer->highlight_regex = NULL;
@@ -976,6 +1381,10 @@ gui_buffer_new_props_with_id (long long id,
     hashtable_set (new_buffer->local_variables,
                    "plugin", plugin_get_name (plugin));
     hashtable_set (new_buffer->local_variables, "name", name);
+    new_buffer->local_variables_size =
+        gui_buffer_local_var_get_size ("plugin", plugin_get_name (plugin))
+        + gui_buffer_local_var_get_size ("name", name);
+    new_buffer->local_var_cache = NULL;
 
     /* add buffer to buffers list */
     first_buffer_creation = (gui_buffers == NULL);
@@ -1208,6 +1617,9 @@ gui_buffer_valid (struct t_gui_buffer *buffer)
     if (!buffer)
         return 1;
 
+    if (gui_buffer_pointers)
+        return hashtable_has_key (gui_buffer_pointers, buffer);
+
     for (ptr_buffer = gui_buffers; ptr_buffer;
          ptr_buffer = ptr_buffer->next_buffer)
     {
@@ -1220,14 +1632,15 @@ gui_buffer_valid (struct t_gui_buffer *buffer)
 }
 
 /*
- * Replaces local variables ($var) in a string, using value of local variables.
+ * Replaces local variables ($var) in a string, using value of local variables
+ * (without cache).
  *
  * Note: result must be freed after use.
  */
 
 char *
-gui_buffer_string_replace_local_var (struct t_gui_buffer *buffer,
-                                     const char *string)
+gui_buffer_string_replace_local_var_build (struct t_gui_buffer *buffer,
+                                           const char *string)
 {
     int index_string, index_result;
     size_t length, length_var;
@@ -1309,6 +1722,79 @@ gui_buffer_string_replace_local_var (struct t_gui_buffer *buffer,
     return result;
 }
 
+/*
+ * Replaces local variables ($var) in a string, using value of local variables.
+ *
+ * The result is saved in a cache of the buffer, which is cleared when a local
+ * variable is added, changed or removed; if the string has no "$", the string
+ * itself is returned.
+ *
+ * Note: result must NOT be freed, and it is valid only until the next change
+ * in local variables of buffer.
+ */
+
+const char *
+gui_buffer_string_replace_local_var_cached (struct t_gui_buffer *buffer,
+                                            const char *string)
+{
+    const char *ptr_result;
+    char *result;
+
+    if (!buffer || !string)
+        return NULL;
+
+    if (!strchr (string, '$'))
+        return string;
+
+    if (buffer->local_var_cache)
+    {
+        ptr_result = hashtable_get (buffer->local_var_cache, string);
+        if (ptr_result)
+            return ptr_result;
+    }
+    else
+    {
+        buffer->local_var_cache = hashtable_new (32,
+                                                 WEECHAT_HASHTABLE_STRING,
+                                                 WEECHAT_HASHTABLE_STRING,
+                                                 NULL, NULL);
+        if (!buffer->local_var_cache)
+            return NULL;
+    }
+
+    result = gui_buffer_string_replace_local_var_build (buffer, string);
+    if (!result)
+        return NULL;
+
+    /* too many different strings (for example from scripts): clear cache */
+    if (buffer->local_var_cache->items_count >= GUI_BUFFER_LOCAL_VAR_CACHE_MAX)
+        hashtable_remove_all (buffer->local_var_cache);
+
+    ptr_result = NULL;
+    if (hashtable_set (buffer->local_var_cache, string, result))
+        ptr_result = hashtable_get (buffer->local_var_cache, string);
+    free (result);
+
+    return ptr_result;
+}
+
+/*
+ * Replaces local variables ($var) in a string, using value of local variables.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+gui_buffer_string_replace_local_var (struct t_gui_buffer *buffer,
+                                     const char *string)
+{
+    const char *ptr_result;
+
+    ptr_result = gui_buffer_string_replace_local_var_cached (buffer, string);
+
+    return (ptr_result) ? strdup (ptr_result) : NULL;
+}
+
 /*
  * Checks if full name of buffer marches list of buffers.
  *
@@ -1601,6 +2087,27 @@ gui_buffer_get_pointer (struct t_gui_buffer *buffer, const char *property)
     return NULL;
 }
 
+/*
+ * Sets flag "chat_refresh_needed" after lines have been added at the end of
+ * buffer.
+ *
+ * If nothing else has to be refreshed, the chat area can be scrolled and only
+ * the new lines are displayed.
+ */
+
+void
+gui_buffer_ask_chat_refresh_lines_added (struct t_gui_buffer *buffer)
+{
+    if (!buffer)
+        return;
+
+    if (buffer->chat_refresh_needed == 0)
+    {
+        buffer->chat_refresh_needed = 1;
+        buffer->chat_refresh_lines_added = 1;
+    }
+}
+
 /*
  * Sets flag "chat_refresh_needed".
  */
@@ -1613,6 +2120,8 @@ gui_buffer_ask_chat_refresh (struct t_gui_buffer *buffer, int refresh)
 
     if (refresh > buffer->chat_refresh_needed)
         buffer->chat_refresh_needed = refresh;
+    if (refresh > 0)
+        buffer->chat_refresh_lines_added = 0;
 }
 
 /*
@@ -2064,7 +2573,7 @@ gui_buffer_set_highlight_disable_regex (struct t_gui_buffer *buffer,
     }
     if (buffer->highlight_disable_regex_compiled)
     {
-        regfree (buffer->highlight_disable_regex_compiled);
+        string_regfree (buffer->highlight_disable_regex_compiled);
         free (buffer->highlight_disable_regex_compiled);
         buffer->highlight_disable_regex_compiled = NULL;
     }
@@ -2108,7 +2617,7 @@ gui_buffer_set_highlight_regex (struct t_gui_buffer *buffer,
     }
     if (buffer->highlight_regex_compiled)
     {
-        regfree (buffer->highlight_regex_compiled);
+        string_regfree (buffer->highlight_regex_compiled);
         free (buffer->highlight_regex_compiled);
         buffer->highlight_regex_compiled = NULL;
     }
@@ -2548,8 +3057,9 @@ void
 gui_buffer_set (struct t_gui_buffer *buffer, const char *property,
                 const char *value)
 {
-    long number;
+    long number, count;
     char *error;
+    const char *ptr_count;
 
     if (!property || !value)
         return;
@@ -2580,6 +3090,23 @@ gui_buffer_set (struct t_gui_buffer *buffer, const char *property,
                         0);  /* check_conditions */
                 }
             }
+            else if (error && (error != value) && (error[0] == ',')
+                     && (number >= 0))
+            {
+                /* "priority,count": add "count" messages with priority */
+                ptr_count = error + 1;
+                error = NULL;
+                count = strtol (ptr_count, &error, 10);
+                if (error && (error != ptr_count) && !error[0] && (count > 0))
+                {
+                    (void) gui_hotlist_add_count (
+                        buffer,
+                        number,
+                        NULL,  /* creation_time */
+                        0,  /* check_conditions */
+                        (count > INT_MAX) ? INT_MAX : (int)count);
+                }
+            }
         }
     }
     else if (strcmp (property, "completion_freeze") == 0)
@@ -2647,6 +3174,16 @@ gui_buffer_set (struct t_gui_buffer *buffer, const char *property,
         if (error && !error[0])
             gui_buffer_set_filter (buffer, number);
     }
+    else if (strcmp (property, "uncompress_lines") == 0)
+    {
+        error = NULL;
+        number = strtol (value, &error, 10);
+        if (error && !error[0])
+        {
+            (void) gui_line_uncompress_lines (
+                buffer, (number < 0) ? -1 : (number > INT_MAX) ? INT_MAX : number);
+        }
+    }
     else if (strcmp (property, "number") == 0)
     {
         error = NULL;
@@ -2819,6 +3356,63 @@ gui_buffer_set (struct t_gui_buffer *buffer, const char *property,
     }
 }
 
+/*
+ * Sets multiple buffer properties (hashtable with property as key and value
+ * as value, like in function gui_buffer_new_props).
+ *
+ * Signals sent by gui_buffer_set are sent only once, at the end, followed by
+ * signal "buffer_properties_changed" (only if at least one signal was sent).
+ */
+
+void
+gui_buffer_set_multiple (struct t_gui_buffer *buffer,
+                         struct t_hashtable *properties)
+{
+    struct t_gui_buffer_signal_delayed *signals;
+    int i, count;
+
+    if (!properties)
+        return;
+
+    gui_buffer_set_multiple_count++;
+    hashtable_map (properties, &gui_buffer_apply_properties_cb, buffer);
+    gui_buffer_set_multiple_count--;
+
+    if ((gui_buffer_set_multiple_count > 0)
+        || (gui_buffer_signals_delayed_count == 0))
+    {
+        return;
+    }
+
+    /* take the delayed signals: callbacks can set other buffer properties */
+    signals = gui_buffer_signals_delayed;
+    count = gui_buffer_signals_delayed_count;
+    gui_buffer_signals_delayed = NULL;
+    gui_buffer_signals_delayed_count = 0;
+    gui_buffer_signals_delayed_size = 0;
+
+    for (i = 0; i < count; i++)
+    {
+        /* skip signal if the buffer has been closed by a previous signal */
+        if ((strcmp (signals[i].type_data, WEECHAT_HOOK_SIGNAL_POINTER) == 0)
+            && !gui_buffer_valid (signals[i].signal_data))
+        {
+            continue;
+        }
+        (void) hook_signal_send (signals[i].signal,
+                                 signals[i].type_data,
+                                 signals[i].signal_data);
+    }
+
+    free (signals);
+
+    if (buffer && gui_buffer_valid (buffer))
+    {
+        (void) hook_signal_send ("buffer_properties_changed",
+                                 WEECHAT_HOOK_SIGNAL_POINTER, buffer);
+    }
+}
+
 /*
  * Sets a buffer property (pointer).
  */
@@ -2993,33 +3587,59 @@ struct t_gui_buffer *
 gui_buffer_search_by_full_name (const char *full_name)
 {
     struct t_gui_buffer *ptr_buffer;
-    int case_sensitive;
+    char *full_name_lower;
 
     if (!full_name)
         return NULL;
 
-    case_sensitive = 1;
     if (strncmp (full_name, "(?i)", 4) == 0)
     {
-        case_sensitive = 0;
-        full_name += 4;
+        if (!gui_buffer_by_full_name_lower)
+            return NULL;
+        full_name_lower = string_tolower (full_name + 4);
+        if (!full_name_lower)
+            return NULL;
+        ptr_buffer = hashtable_get (gui_buffer_by_full_name_lower,
+                                    full_name_lower);
+        free (full_name_lower);
+        return ptr_buffer;
     }
 
-    for (ptr_buffer = gui_buffers; ptr_buffer;
-         ptr_buffer = ptr_buffer->next_buffer)
+    return (gui_buffer_by_full_name) ?
+        hashtable_get (gui_buffer_by_full_name, full_name) : NULL;
+}
+
+/*
+ * Checks if a buffer matches plugin and name.
+ *
+ * Returns:
+ *   1: buffer matches plugin and name
+ *   0: buffer does not match plugin or name
+ */
+
+int
+gui_buffer_match_plugin_name (struct t_gui_buffer *buffer,
+                              const char *plugin, int plugin_case_sensitive,
+                              const char *name, int name_case_sensitive)
+{
+    if (!buffer->name)
+        return 0;
+
+    if (plugin && plugin[0])
     {
-        if (ptr_buffer->full_name
-            && ((case_sensitive
-                 && strcmp (ptr_buffer->full_name, full_name) == 0)
-                || (!case_sensitive
-                    && string_strcasecmp (ptr_buffer->full_name, full_name) == 0)))
+        if ((plugin_case_sensitive
+             && (strcmp (plugin, gui_buffer_get_plugin_name (buffer)) != 0))
+            || (!plugin_case_sensitive
+                && (string_strcasecmp (plugin, gui_buffer_get_plugin_name (buffer)) != 0)))
         {
-            return ptr_buffer;
+            return 0;
         }
     }
 
-    /* buffer not found */
-    return NULL;
+    return ((name_case_sensitive
+             && (strcmp (buffer->name, name) == 0))
+            || (!name_case_sensitive
+                && (string_strcasecmp (buffer->name, name) == 0))) ? 1 : 0;
 }
 
 /*
@@ -3033,9 +3653,9 @@ struct t_gui_buffer *
 gui_buffer_search (const char *plugin, const char *name)
 {
     struct t_gui_buffer *ptr_buffer;
-    int plugin_match, plugin_case_sensitive, name_case_sensitive;
+    int plugin_case_sensitive, name_case_sensitive, length;
     long long id;
-    char *error;
+    char *error, *full_name;
 
     if (!name || !name[0])
         return gui_current_window->buffer;
@@ -3067,33 +3687,48 @@ gui_buffer_search (const char *plugin, const char *name)
     if (!name[0])
         return gui_current_window->buffer;
 
-    for (ptr_buffer = gui_buffers; ptr_buffer;
-         ptr_buffer = ptr_buffer->next_buffer)
+    /*
+     * with a plugin, search first in hashtables by full name: if no buffer
+     * is found, then no buffer matches; the buffer found must be checked
+     * since the search can be case insensitive in hashtable while it is not
+     * for plugin or name, or a dot in the plugin or buffer name could give
+     * the same full name
+     */
+    if (plugin && plugin[0])
     {
-        if (ptr_buffer->name)
+        length = 4 + strlen (plugin) + 1 + strlen (name) + 1;
+        full_name = malloc (length);
+        if (full_name)
         {
-            plugin_match = 1;
-            if (plugin && plugin[0])
-            {
-                if ((plugin_case_sensitive
-                     && (strcmp (plugin, gui_buffer_get_plugin_name (ptr_buffer)) != 0))
-                    || (!plugin_case_sensitive
-                        && (string_strcasecmp (plugin, gui_buffer_get_plugin_name (ptr_buffer)) != 0)))
-                {
-                    plugin_match = 0;
-                }
-            }
-            if (plugin_match
-                && ((name_case_sensitive
-                     && (strcmp (ptr_buffer->name, name) == 0))
-                    || (!name_case_sensitive
-                        && (string_strcasecmp (ptr_buffer->name, name) == 0))))
+            snprintf (full_name, length, "%s%s.%s",
+                      (plugin_case_sensitive && name_case_sensitive) ?
+                      "" : "(?i)",
+                      plugin,
+                      name);
+            ptr_buffer = gui_buffer_search_by_full_name (full_name);
+            free (full_name);
+            if (!ptr_buffer)
+                return NULL;
+            if (gui_buffer_match_plugin_name (ptr_buffer,
+                                              plugin, plugin_case_sensitive,
+                                              name, name_case_sensitive))
             {
                 return ptr_buffer;
             }
         }
     }
 
+    for (ptr_buffer = gui_buffers; ptr_buffer;
+         ptr_buffer = ptr_buffer->next_buffer)
+    {
+        if (gui_buffer_match_plugin_name (ptr_buffer,
+                                          plugin, plugin_case_sensitive,
+                                          name, name_case_sensitive))
+        {
+            return ptr_buffer;
+        }
+    }
+
     /* buffer not found */
     return NULL;
 }
@@ -3226,14 +3861,23 @@ struct t_gui_buffer *
 gui_buffer_search_by_number (int number)
 {
     struct t_gui_buffer *ptr_buffer;
+    int pos;
 
-    for (ptr_buffer = gui_buffers; ptr_buffer;
-         ptr_buffer = ptr_buffer->next_buffer)
+    if (!gui_buffer_number_index_valid && !gui_buffer_number_index_build ())
     {
-        if (ptr_buffer->number == number)
-            return ptr_buffer;
+        for (ptr_buffer = gui_buffers; ptr_buffer;
+             ptr_buffer = ptr_buffer->next_buffer)
+        {
+            if (ptr_buffer->number == number)
+                return ptr_buffer;
+        }
+        return NULL;
     }
 
+    pos = gui_buffer_number_index_search (number);
+    if (pos >= 0)
+        return gui_buffer_number_index[pos];
+
     /* buffer not found */
     return NULL;
 }
@@ -3340,11 +3984,12 @@ gui_buffer_count_merged_buffers (int number)
 
     count = 0;
 
-    for (ptr_buffer = gui_buffers; ptr_buffer;
+    /* merged buffers are consecutive in list, starting with first found */
+    for (ptr_buffer = gui_buffer_search_by_number (number);
+         ptr_buffer && (ptr_buffer->number == number);
          ptr_buffer = ptr_buffer->next_buffer)
     {
-        if (ptr_buffer->number == number)
-            count++;
+        count++;
     }
 
     return count;
@@ -3769,6 +4414,9 @@ gui_buffer_close (struct t_gui_buffer *buffer)
 
     gui_buffer_visited_remove_by_buffer (buffer);
 
+    gui_buffer_full_name_index_remove (buffer);
+    gui_buffer_number_index_invalidate ();
+
     /* compute "number - 1" on next buffers if auto renumber is ON */
     if (CONFIG_BOOLEAN(config_look_buffer_auto_renumber))
     {
@@ -3781,20 +4429,26 @@ gui_buffer_close (struct t_gui_buffer *buffer)
 
     /* free all lines */
     gui_line_free_all (buffer);
-    free (buffer->own_lines);
-    free (buffer->mixed_lines);
+    gui_line_lines_free (buffer->own_lines);
+    gui_line_lines_free (buffer->mixed_lines);
 
     /* free some data */
+    free (buffer->filters_cache);
     gui_buffer_undo_free_all (buffer);
     gui_history_buffer_free (buffer);
     gui_completion_free (buffer->completion);
     gui_nicklist_remove_all (buffer);
     gui_nicklist_remove_group (buffer, buffer->nicklist_root);
+    hashtable_free (buffer->nicklist_groups_by_id);
+    hashtable_free (buffer->nicklist_groups_by_name);
+    hashtable_free (buffer->nicklist_nicks_by_id);
+    hashtable_free (buffer->nicklist_nicks_by_name);
     hashtable_free (buffer->hotlist_max_level_nicks);
     gui_key_free_all (-1, &buffer->keys, &buffer->last_key,
                       &buffer->keys_count, 0);
     gui_buffer_local_var_remove_all (buffer);
     hashtable_free (buffer->local_variables);
+    hashtable_free (buffer->local_var_cache);
     free (buffer->plugin_name_for_upgrade);
     free (buffer->name);
     free (buffer->full_name);
@@ -3808,20 +4462,22 @@ gui_buffer_close (struct t_gui_buffer *buffer)
     free (buffer->text_search_input);
     if (buffer->text_search_regex_compiled)
     {
-        regfree (buffer->text_search_regex_compiled);
+        string_regfree (buffer->text_search_regex_compiled);
         free (buffer->text_search_regex_compiled);
     }
     free (buffer->highlight_words);
+    string_highlight_free (buffer->highlight_words_compiled);
+    string_highlight_free (buffer->highlight_words_global_compiled);
     free (buffer->highlight_disable_regex);
     if (buffer->highlight_disable_regex_compiled)
     {
-        regfree (buffer->highlight_disable_regex_compiled);
+        string_regfree (buffer->highlight_disable_regex_compiled);
         free (buffer->highlight_disable_regex_compiled);
     }
     free (buffer->highlight_regex);
     if (buffer->highlight_regex_compiled)
     {
-        regfree (buffer->highlight_regex_compiled);
+        string_regfree (buffer->highlight_regex_compiled);
         free (buffer->highlight_regex_compiled);
     }
     free (buffer->highlight_tags_restrict);
@@ -3841,12 +4497,35 @@ gui_buffer_close (struct t_gui_buffer *buffer)
         gui_buffers = buffer->next_buffer;
     if (last_gui_buffer == buffer)
         last_gui_buffer = buffer->prev_buffer;
+    if (gui_buffer_pointers)
+    {
+        hashtable_remove (gui_buffer_pointers, buffer);
+        if (gui_buffer_pointers->items_count == 0)
+        {
+            hashtable_free (gui_buffer_pointers);
+            gui_buffer_pointers = NULL;
+        }
+    }
+    if (!gui_buffers)
+        gui_buffer_number_index_free ();
     hashtable_remove (gui_buffer_by_id, &buffer->id);
     if (gui_buffer_by_id->items_count == 0)
     {
         free (gui_buffer_by_id);
         gui_buffer_by_id = NULL;
     }
+    if (gui_buffer_by_full_name
+        && (gui_buffer_by_full_name->items_count == 0))
+    {
+        hashtable_free (gui_buffer_by_full_name);
+        gui_buffer_by_full_name = NULL;
+    }
+    if (gui_buffer_by_full_name_lower
+        && (gui_buffer_by_full_name_lower->items_count == 0))
+    {
+        hashtable_free (gui_buffer_by_full_name_lower);
+        gui_buffer_by_full_name_lower = NULL;
+    }
 
     for (ptr_window = gui_windows; ptr_window;
          ptr_window = ptr_window->next_window)
@@ -4139,6 +4818,7 @@ gui_buffer_renumber (int number1, int number2, int start_number)
     }
 
     /* let's go for the renumbering! */
+    gui_buffer_number_index_invalidate ();
     current_number = start_number;
     ptr_buffer = ptr_first_buffer;
     while (ptr_buffer)
@@ -4216,6 +4896,8 @@ gui_buffer_move_to_number (struct t_gui_buffer *buffer, int number)
         return;
     }
 
+    gui_buffer_number_index_invalidate ();
+
     /* remove buffer(s) from list */
     if (ptr_first_buffer->prev_buffer)
         (ptr_first_buffer->prev_buffer)->next_buffer = ptr_last_buffer->next_buffer;
@@ -4332,6 +5014,8 @@ gui_buffer_swap (int number1, int number2)
     if (!ptr_first_buffer[1] || !ptr_last_buffer[1])
         return;
 
+    gui_buffer_number_index_invalidate ();
+
     /* first set gui_buffers/last_gui_buffers if they are affected by the swap */
     if (gui_buffers == ptr_first_buffer[0])
         gui_buffers = ptr_first_buffer[1];
@@ -4394,6 +5078,124 @@ gui_buffer_swap (int number1, int number2)
         WEECHAT_HOOK_SIGNAL_POINTER, ptr_first_buffer[1]);
 }
 
+/*
+ * Reorders buffers (or merged buffers) in one operation: buffers in array
+ * "buffers" are moved first, in this order, followed by other buffers (in
+ * their current order).
+ *
+ * Merged buffers are moved together (giving any buffer of the group moves the
+ * whole group, next buffers of the same group are ignored).
+ * Numbers already used are kept and given to groups in the new order, so that
+ * gaps between numbers (if auto renumber is OFF) remain at the same place.
+ *
+ * A single signal "buffer_list_reordered" is sent (with a NULL pointer) if
+ * the order of buffers has changed, instead of a signal "buffer_moved" for
+ * each buffer.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+gui_buffer_reorder (struct t_gui_buffer **buffers, int num_buffers)
+{
+    struct t_gui_buffer *ptr_buffer, *ptr_prev_buffer, **last_buffers;
+    int rc, i, pos, count, num_groups, changed, *numbers, *new_order;
+    char *used;
+
+    if (!buffers || (num_buffers < 0))
+        return 0;
+
+    if (!gui_buffers)
+        return 1;
+
+    if (!gui_buffer_number_index_valid && !gui_buffer_number_index_build ())
+        return 0;
+
+    rc = 0;
+    num_groups = gui_buffer_number_index_count;
+    numbers = malloc (num_groups * sizeof (*numbers));
+    new_order = malloc (num_groups * sizeof (*new_order));
+    last_buffers = malloc (num_groups * sizeof (*last_buffers));
+    used = calloc (num_groups, sizeof (*used));
+    if (!numbers || !new_order || !last_buffers || !used)
+        goto end;
+
+    /* save numbers and last buffer of each group (of merged buffers) */
+    for (i = 0; i < num_groups; i++)
+    {
+        numbers[i] = gui_buffer_number_index[i]->number;
+        last_buffers[i] = (i < num_groups - 1) ?
+            gui_buffer_number_index[i + 1]->prev_buffer : last_gui_buffer;
+    }
+
+    /* compute new order of groups: buffers given first, then other ones */
+    count = 0;
+    for (i = 0; i < num_buffers; i++)
+    {
+        if (!buffers[i] || !gui_buffer_valid (buffers[i]))
+            continue;
+        pos = gui_buffer_number_index_search (buffers[i]->number);
+        if ((pos < 0) || used[pos])
+            continue;
+        used[pos] = 1;
+        new_order[count++] = pos;
+    }
+    for (i = 0; i < num_groups; i++)
+    {
+        if (!used[i])
+            new_order[count++] = i;
+    }
+
+    changed = 0;
+    for (i = 0; i < num_groups; i++)
+    {
+        if (new_order[i] != i)
+        {
+            changed = 1;
+            break;
+        }
+    }
+    rc = 1;
+    if (!changed)
+        goto end;
+
+    /* link groups in the new order and give them the saved numbers */
+    ptr_prev_buffer = NULL;
+    for (i = 0; i < num_groups; i++)
+    {
+        pos = new_order[i];
+        for (ptr_buffer = gui_buffer_number_index[pos]; ptr_buffer;
+             ptr_buffer = ptr_buffer->next_buffer)
+        {
+            ptr_buffer->number = numbers[i];
+            if (ptr_buffer == last_buffers[pos])
+                break;
+        }
+        gui_buffer_number_index[pos]->prev_buffer = ptr_prev_buffer;
+        if (ptr_prev_buffer)
+            ptr_prev_buffer->next_buffer = gui_buffer_number_index[pos];
+        else
+            gui_buffers = gui_buffer_number_index[pos];
+        ptr_prev_buffer = last_buffers[pos];
+    }
+    ptr_prev_buffer->next_buffer = NULL;
+    last_gui_buffer = ptr_prev_buffer;
+
+    gui_buffer_number_index_invalidate ();
+
+    (void) hook_signal_send ("buffer_list_reordered",
+                             WEECHAT_HOOK_SIGNAL_POINTER, NULL);
+
+end:
+    free (numbers);
+    free (new_order);
+    free (last_buffers);
+    free (used);
+    return rc;
+}
+
 /*
  * Merges a buffer into another buffer.
  */
@@ -4447,6 +5249,9 @@ gui_buffer_merge (struct t_gui_buffer *buffer,
     if (!ptr_first_buffer[1] || !ptr_last_buffer[1])
         return;
 
+    /* lines of buffers are about to be mixed: finish filter jobs */
+    gui_filter_jobs_finish ();
+
     /* remove buffer(s) to merge from list */
     if (ptr_first_buffer[0]->prev_buffer)
         (ptr_first_buffer[0]->prev_buffer)->next_buffer = ptr_last_buffer[0]->next_buffer;
@@ -4456,6 +5261,7 @@ gui_buffer_merge (struct t_gui_buffer *buffer,
         gui_buffers = ptr_last_buffer[0]->next_buffer;
     if (last_gui_buffer == ptr_last_buffer[0])
         last_gui_buffer = ptr_first_buffer[0]->prev_buffer;
+    gui_buffer_number_index_invalidate ();
 
     /* compute "number - 1" on next buffers if auto renumber is ON */
     if (CONFIG_BOOLEAN(config_look_buffer_auto_renumber))
@@ -4545,6 +5351,9 @@ gui_buffer_unmerge (struct t_gui_buffer *buffer, int number)
         }
     }
 
+    /* mixed lines are about to be rebuilt or freed: finish filter jobs */
+    gui_filter_jobs_finish ();
+
     if (num_merged == 2)
     {
         /* only one buffer will remain, so it will not be merged any more */
@@ -4574,6 +5383,8 @@ gui_buffer_unmerge (struct t_gui_buffer *buffer, int number)
         buffer->lines = buffer->own_lines;
     }
 
+    gui_buffer_number_index_invalidate ();
+
     /* remove buffer from list */
     if (buffer->prev_buffer)
         (buffer->prev_buffer)->next_buffer = buffer->next_buffer;
@@ -4743,6 +5554,7 @@ gui_buffer_sort_by_layout_number ()
 
     gui_buffers = NULL;
     last_gui_buffer = NULL;
+    gui_buffer_number_index_invalidate ();
 
     /* list with buffers that are NOT in layout (layout_number == 0) */
     extra_buffers = NULL;
@@ -5240,6 +6052,12 @@ gui_buffer_hdata_buffer_cb (const void *pointer, void *data,
         HDATA_VAR(struct t_gui_buffer, next_line_id, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, time_for_each_line, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, chat_refresh_needed, INTEGER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_buffer, chat_refresh_lines_added, INTEGER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_buffer, lines_batch, INTEGER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_buffer, lines_batch_first_id, INTEGER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_buffer, lines_batch_count, INTEGER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_buffer, lines_batch_hidden, INTEGER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_buffer, lines_batch_hotlist, INTEGER, 0, GUI_HOTLIST_NUM_PRIORITIES_STR, NULL);
         HDATA_VAR(struct t_gui_buffer, nicklist, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, nicklist_case_sensitive, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, nicklist_root, POINTER, 0, NULL, "nick_group");
@@ -5252,6 +6070,11 @@ gui_buffer_hdata_buffer_cb (const void *pointer, void *data,
         HDATA_VAR(struct t_gui_buffer, nicklist_nicks_count, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, nicklist_nicks_visible_count, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, nicklist_last_id_assigned, LONGLONG, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_buffer, nicklist_size, LONGLONG, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_buffer, nicklist_groups_by_id, HASHTABLE, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_buffer, nicklist_groups_by_name, HASHTABLE, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_buffer, nicklist_nicks_by_id, HASHTABLE, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_buffer, nicklist_nicks_by_name, HASHTABLE, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, nickcmp_callback, POINTER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, nickcmp_callback_pointer, POINTER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, nickcmp_callback_data, POINTER, 0, NULL, NULL);
@@ -5291,6 +6114,8 @@ gui_buffer_hdata_buffer_cb (const void *pointer, void *data,
         HDATA_VAR(struct t_gui_buffer, text_search_ptr_history, POINTER, 0, NULL, "history");
         HDATA_VAR(struct t_gui_buffer, text_search_input, STRING, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, highlight_words, STRING, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_buffer, highlight_words_compiled, POINTER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_buffer, highlight_words_global_compiled, POINTER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, highlight_disable_regex, STRING, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, highlight_disable_regex_compiled, POINTER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, highlight_regex, STRING, 0, NULL, NULL);
@@ -5307,9 +6132,11 @@ gui_buffer_hdata_buffer_cb (const void *pointer, void *data,
         HDATA_VAR(struct t_gui_buffer, last_key, POINTER, 0, NULL, "key");
         HDATA_VAR(struct t_gui_buffer, keys_count, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, local_variables, HASHTABLE, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_buffer, local_variables_size, LONGLONG, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, prev_buffer, POINTER, 0, NULL, hdata_name);
         HDATA_VAR(struct t_gui_buffer, next_buffer, POINTER, 0, NULL, hdata_name);
-        HDATA_LIST(gui_buffers, WEECHAT_HDATA_LIST_CHECK_POINTERS);
+        HDATA_LIST_POINTERS(gui_buffers, WEECHAT_HDATA_LIST_CHECK_POINTERS,
+                            gui_buffer_pointers);
         HDATA_LIST(last_gui_buffer, 0);
         HDATA_LIST(gui_buffer_last_displayed, 0);
     }
@@ -5688,6 +6515,9 @@ gui_buffer_print_log ()
         log_printf ("  day_change. . . . . . . : %d", ptr_buffer->day_change);
         log_printf ("  clear . . . . . . . . . : %d", ptr_buffer->clear);
         log_printf ("  filter. . . . . . . . . : %d", ptr_buffer->filter);
+        log_printf ("  filters_cache . . . . . : %p", ptr_buffer->filters_cache);
+        log_printf ("  filters_cache_count . . : %d", ptr_buffer->filters_cache_count);
+        log_printf ("  filters_cache_generation: %d", ptr_buffer->filters_cache_generation);
         log_printf ("  close_callback. . . . . : %p", ptr_buffer->close_callback);
         log_printf ("  close_callback_pointer. : %p", ptr_buffer->close_callback_pointer);
         log_printf ("  close_callback_data . . : %p", ptr_buffer->close_callback_data);
@@ -5702,6 +6532,16 @@ gui_buffer_print_log ()
         log_printf ("  next_line_id. . . . . . : %d", ptr_buffer->next_line_id);
         log_printf ("  time_for_each_line. . . : %d", ptr_buffer->time_for_each_line);
         log_printf ("  chat_refresh_needed . . : %d", ptr_buffer->chat_refresh_needed);
+        log_printf ("  chat_refresh_lines_added: %d", ptr_buffer->chat_refresh_lines_added);
+        log_printf ("  lines_batch . . . . . . : %d", ptr_buffer->lines_batch);
+        log_printf ("  lines_batch_first_id. . : %d", ptr_buffer->lines_batch_first_id);
+        log_printf ("  lines_batch_count . . . : %d", ptr_buffer->lines_batch_count);
+        log_printf ("  lines_batch_hidden. . . : %d", ptr_buffer->lines_batch_hidden);
+        log_printf ("  lines_batch_hotlist . . : %d,%d,%d,%d",
+                    ptr_buffer->lines_batch_hotlist[GUI_HOTLIST_LOW],
+                    ptr_buffer->lines_batch_hotlist[GUI_HOTLIST_MESSAGE],
+                    ptr_buffer->lines_batch_hotlist[GUI_HOTLIST_PRIVATE],
+                    ptr_buffer->lines_batch_hotlist[GUI_HOTLIST_HIGHLIGHT]);
         log_printf ("  nicklist. . . . . . . . : %d", ptr_buffer->nicklist);
         log_printf ("  nicklist_case_sensitive : %d", ptr_buffer->nicklist_case_sensitive);
         log_printf ("  nicklist_root . . . . . : %p", ptr_buffer->nicklist_root);
@@ -5714,6 +6554,11 @@ gui_buffer_print_log ()
         log_printf ("  nicklist_nicks_count. . : %d", ptr_buffer->nicklist_nicks_count);
         log_printf ("  nicklist_nicks_vis_cnt. : %d", ptr_buffer->nicklist_nicks_visible_count);
         log_printf ("  nicklist_last_id_assigned: %lld", ptr_buffer->nicklist_last_id_assigned);
+        log_printf ("  nicklist_size . . . . . : %lld", ptr_buffer->nicklist_size);
+        log_printf ("  nicklist_groups_by_id . : %p", ptr_buffer->nicklist_groups_by_id);
+        log_printf ("  nicklist_groups_by_name : %p", ptr_buffer->nicklist_groups_by_name);
+        log_printf ("  nicklist_nicks_by_id. . : %p", ptr_buffer->nicklist_nicks_by_id);
+        log_printf ("  nicklist_nicks_by_name. : %p", ptr_buffer->nicklist_nicks_by_name);
         log_printf ("  nickcmp_callback. . . . : %p", ptr_buffer->nickcmp_callback);
         log_printf ("  nickcmp_callback_pointer: %p", ptr_buffer->nickcmp_callback_pointer);
         log_printf ("  nickcmp_callback_data . : %p", ptr_buffer->nickcmp_callback_data);
@@ -5762,6 +6607,8 @@ gui_buffer_print_log ()
         log_printf ("  text_search_ptr_history . . . . : %p", ptr_buffer->text_search_ptr_history);
         log_printf ("  text_search_input . . . . . . . : '%s'", ptr_buffer->text_search_input);
         log_printf ("  highlight_words . . . . . . . . : '%s'", ptr_buffer->highlight_words);
+        log_printf ("  highlight_words_compiled. . . . : %p", ptr_buffer->highlight_words_compiled);
+        log_printf ("  highlight_words_global_compiled : %p", ptr_buffer->highlight_words_global_compiled);
         log_printf ("  highlight_disable_regex . . . . : '%s'", ptr_buffer->highlight_disable_regex);
         log_printf ("  highlight_disable_regex_compiled: %p", ptr_buffer->highlight_disable_regex_compiled);
         log_printf ("  highlight_regex . . . . . . . . : '%s'", ptr_buffer->highlight_regex);
@@ -5778,6 +6625,8 @@ gui_buffer_print_log ()
         log_printf ("  last_key. . . . . . . . . . . . : %p", ptr_buffer->last_key);
         log_printf ("  keys_count. . . . . . . . . . . : %d", ptr_buffer->keys_count);
         log_printf ("  local_variables . . . . . . . . : %p", ptr_buffer->local_variables);
+        log_printf ("  local_variables_size. . . . . . : %lld", ptr_buffer->local_variables_size);
+        log_printf ("  local_var_cache . . . . . . . . : %p", ptr_buffer->local_var_cache);
         log_printf ("  prev_buffer . . . . . . . . . . : %p", ptr_buffer->prev_buffer);
         log_printf ("  next_buffer . . . . . . . . . . : %p", ptr_buffer->next_buffer);
 
@@ -23,10 +23,14 @@
 #include <limits.h>
 #include <regex.h>
 
+#include "gui-hotlist.h"
+
 struct t_config_option;
+struct t_gui_filter;
 struct t_gui_window;
 struct t_hashtable;
 struct t_infolist;
+struct t_string_highlight;
 
 enum t_gui_buffer_type
 {
@@ -86,6 +90,9 @@ enum t_gui_buffer_search_history
 
 #define GUI_BUFFER_INPUT_BLOCK_SIZE 256
 
+/* max number of strings with local variables replaced kept in cache */
+#define GUI_BUFFER_LOCAL_VAR_CACHE_MAX 32
+
 /* buffer structures */
 
 struct t_gui_input_undo
@@ -134,6 +141,10 @@ struct t_gui_buffer
     int clear;                         /* 1 if clear of buffer is allowed   */
                                        /* with command /buffer clear        */
     int filter;                        /* 1 if filters enabled for buffer   */
+    struct t_gui_filter **filters_cache; /* filters matching buffer name    */
+    int filters_cache_count;           /* number of filters in cache        */
+    int filters_cache_generation;      /* generation of filters when cache  */
+                                       /* was built (-1 = cache not built)  */
 
     /* close callback */
     int (*close_callback)(const void *pointer, /* called when buffer is     */
@@ -158,7 +169,16 @@ struct t_gui_buffer
                                        /* (used with formatted type only)   */
     int time_for_each_line;            /* time is displayed for each line?  */
     int chat_refresh_needed;           /* refresh for chat is needed ?      */
+    int chat_refresh_lines_added;      /* 1 if refresh is only for lines    */
+                                       /* added at end of buffer            */
                                        /* (1=refresh, 2=erase+refresh)      */
+    int lines_batch;                   /* > 0 if lines are added in a batch */
+                                       /* (see gui_chat_printf_lines_begin) */
+    int lines_batch_first_id;          /* id of first line of batch         */
+    int lines_batch_count;             /* number of lines added in batch    */
+    int lines_batch_hidden;            /* 1 if hidden lines added in batch  */
+    int lines_batch_hotlist[GUI_HOTLIST_NUM_PRIORITIES]; /* hotlist adds    */
+                                       /* deferred until end of batch       */
 
     /* nicklist */
     int nicklist;                      /* = 1 if nicklist is enabled        */
@@ -172,7 +192,12 @@ struct t_gui_buffer
     int nicklist_groups_visible_count; /* number of groups displayed        */
     int nicklist_nicks_count;          /* number of nicks                   */
     int nicklist_nicks_visible_count;  /* number of nicks displayed         */
+    long long nicklist_size;           /* bytes used by groups and nicks    */
     long long nicklist_last_id_assigned; /* last id assigned for a grp/nick */
+    struct t_hashtable *nicklist_groups_by_id;   /* groups by id            */
+    struct t_hashtable *nicklist_groups_by_name; /* groups by name          */
+    struct t_hashtable *nicklist_nicks_by_id;    /* nicks by id             */
+    struct t_hashtable *nicklist_nicks_by_name;  /* nicks by name (lower)   */
     int (*nickcmp_callback)(const void *pointer, /* called to compare nicks */
                             void *data,          /* (search in nicklist)    */
                             struct t_gui_buffer *buffer,
@@ -220,6 +245,7 @@ struct t_gui_buffer
     struct t_gui_history *last_history;/* last command in history           */
     struct t_gui_history *ptr_history; /* current command in history        */
     int num_history;                   /* number of commands in history     */
+    struct t_hashtable *history_index; /* text -> history (to find dups)    */
 
     /* text search (in buffer lines or command line history) */
     enum t_gui_buffer_search text_search; /* text search type               */
@@ -236,6 +262,9 @@ struct t_gui_buffer
 
     /* highlight settings for buffer */
     char *highlight_words;             /* list of words to highlight        */
+    struct t_string_highlight *highlight_words_compiled; /* compiled words  */
+    struct t_string_highlight *highlight_words_global_compiled; /* compiled */
+                                       /* words of weechat.look.highlight   */
     char *highlight_regex;             /* regex for highlight               */
     regex_t *highlight_regex_compiled; /* compiled regex                    */
     char *highlight_disable_regex;     /* regex for disabling highlight     */
@@ -260,6 +289,9 @@ struct t_gui_buffer
 
     /* local variables */
     struct t_hashtable *local_variables; /* local variables                 */
+    long long local_variables_size;    /* bytes used by local variables     */
+    struct t_hashtable *local_var_cache; /* strings with local variables    */
+                                       /* replaced (string -> result)       */
 
     /* link to previous/next buffer */
     struct t_gui_buffer *prev_buffer;  /* link to previous buffer           */
@@ -273,6 +305,13 @@ struct t_gui_buffer_visited
     struct t_gui_buffer_visited *next_buffer; /* link to next variable      */
 };
 
+struct t_gui_buffer_signal_delayed
+{
+    const char *signal;                /* signal name                       */
+    const char *type_data;             /* type of signal data               */
+    void *signal_data;                 /* signal data (pointer)             */
+};
+
 /* buffer variables */
 
 extern struct t_gui_buffer *gui_buffers;
@@ -284,7 +323,10 @@ extern int gui_buffers_visited_index;
 extern int gui_buffers_visited_count;
 extern int gui_buffers_visited_frozen;
 extern struct t_gui_buffer *gui_buffer_last_displayed;
+extern struct t_hashtable *gui_buffer_pointers;
 extern struct t_hashtable *gui_buffer_by_id;
+extern struct t_hashtable *gui_buffer_by_full_name;
+extern struct t_hashtable *gui_buffer_by_full_name_lower;
 extern long long gui_buffer_last_id_assigned;
 extern char *gui_buffer_reserved_names[];
 extern char *gui_buffer_type_string[];
@@ -302,7 +344,10 @@ extern int gui_buffer_send_signal (struct t_gui_buffer *buffer,
                                    const char *signal,
                                    const char *type_data, void *signal_data);
 extern const char *gui_buffer_get_plugin_name (struct t_gui_buffer *buffer);
+extern long long gui_buffer_get_memory_size (struct t_gui_buffer *buffer);
 extern void gui_buffer_build_full_name (struct t_gui_buffer *buffer);
+extern int gui_buffer_local_var_get_size (const char *name,
+                                          const char *value);
 extern void gui_buffer_local_var_add (struct t_gui_buffer *buffer,
                                       const char *name,
                                       const char *value);
@@ -359,6 +404,8 @@ extern struct t_gui_buffer *gui_buffer_new_user (const char *name,
                                                  enum t_gui_buffer_type buffer_type);
 extern void gui_buffer_user_set_callbacks ();
 extern int gui_buffer_valid (struct t_gui_buffer *buffer);
+extern const char *gui_buffer_string_replace_local_var_cached (struct t_gui_buffer *buffer,
+                                                              const char *string);
 extern char *gui_buffer_string_replace_local_var (struct t_gui_buffer *buffer,
                                                   const char *string);
 extern int gui_buffer_match_list (struct t_gui_buffer *buffer,
@@ -372,6 +419,7 @@ extern const char *gui_buffer_get_string (struct t_gui_buffer *buffer,
                                           const char *property);
 extern void *gui_buffer_get_pointer (struct t_gui_buffer *buffer,
                                      const char *property);
+extern void gui_buffer_ask_chat_refresh_lines_added (struct t_gui_buffer *buffer);
 extern void gui_buffer_ask_chat_refresh (struct t_gui_buffer *buffer,
                                          int refresh);
 extern void gui_buffer_set_title (struct t_gui_buffer *buffer,
@@ -394,6 +442,8 @@ extern void gui_buffer_set_input_prompt (struct t_gui_buffer *buffer,
                                          const char *input_prompt);
 extern void gui_buffer_set (struct t_gui_buffer *buffer, const char *property,
                             const char *value);
+extern void gui_buffer_set_multiple (struct t_gui_buffer *buffer,
+                                     struct t_hashtable *properties);
 extern void gui_buffer_set_pointer (struct t_gui_buffer *buffer,
                                     const char *property, void *pointer);
 extern void gui_buffer_compute_num_displayed ();
@@ -421,6 +471,8 @@ extern void gui_buffer_zoom (struct t_gui_buffer *buffer);
 extern void gui_buffer_renumber (int number1, int number2, int start_number);
 extern void gui_buffer_move_to_number (struct t_gui_buffer *buffer, int number);
 extern void gui_buffer_swap (int number1, int number2);
+extern int gui_buffer_reorder (struct t_gui_buffer **buffers,
+                               int num_buffers);
 extern void gui_buffer_merge (struct t_gui_buffer *buffer,
                               struct t_gui_buffer *target_buffer);
 extern void gui_buffer_unmerge (struct t_gui_buffer *buffer, int number);
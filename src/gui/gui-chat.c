@@ -45,6 +45,7 @@
 #include "gui-buffer.h"
 #include "gui-color.h"
 #include "gui-filter.h"
+#include "gui-hotlist.h"
 #include "gui-input.h"
 #include "gui-line.h"
 #include "gui-main.h"
@@ -59,6 +60,11 @@ struct t_gui_buffer *gui_chat_mute_buffer = NULL; /* mute buffer            */
 int gui_chat_display_tags = 0;                  /* display tags?            */
 char **gui_chat_lines_waiting_buffer = NULL;    /* lines waiting for core   */
                                                 /* buffer                   */
+char *gui_chat_format_buffer = NULL;            /* buffer reused to format  */
+                                                /* messages of printf       */
+int gui_chat_format_buffer_size = 0;            /* size of format buffer    */
+int gui_chat_format_buffer_used = 0;            /* 1 if format buffer is    */
+                                                /* used (by a printf)       */
 
 
 /*
@@ -164,6 +170,17 @@ gui_chat_strlen_screen (const char *string)
     length = 0;
     while (string && string[0])
     {
+        /*
+         * fast path for printable ASCII chars: one column each (they can
+         * not be the start of a color code)
+         */
+        if ((((unsigned char)string[0]) >= 32)
+            && (((unsigned char)string[0]) < 127))
+        {
+            length++;
+            string++;
+            continue;
+        }
         string = gui_chat_string_next_char (NULL, NULL,
                                             (unsigned char *)string, 0, 0, 0);
         if (string)
@@ -552,6 +569,7 @@ gui_chat_change_time_format ()
                     ptr_line->data->date,
                     ptr_line->data->date_usec,
                     ptr_line->data->highlight);
+                gui_line_size_update (ptr_line->data);
             }
         }
     }
@@ -778,7 +796,7 @@ gui_chat_printf_datetime_tags_internal (struct t_gui_buffer *buffer,
     if (new_line->data->buffer && new_line->data->buffer->print_hooks_enabled)
         hook_print_exec (new_line->data->buffer, new_line);
 
-    gui_buffer_ask_chat_refresh (new_line->data->buffer, 1);
+    gui_buffer_ask_chat_refresh_lines_added (new_line->data->buffer);
 
     free (string);
     free (modifier_data);
@@ -789,8 +807,7 @@ gui_chat_printf_datetime_tags_internal (struct t_gui_buffer *buffer,
 no_print:
     if (new_line)
     {
-        gui_line_free_data (new_line);
-        free (new_line);
+        gui_line_free_new (new_line);
     }
     free (string);
     free (modifier_data);
@@ -862,6 +879,126 @@ gui_chat_print_lines_waiting_buffer (FILE *f)
     }
 }
 
+/*
+ * Formats a message with a list of arguments (like vsnprintf).
+ *
+ * The message is formatted in a buffer reused for all messages (so that
+ * there is no allocation for most messages), unless this buffer is already
+ * used (nested call of a printf function, for example in a hook callback):
+ * then the message is formatted in a newly allocated buffer.
+ *
+ * Returns formatted message, NULL if error.
+ *
+ * Note: result must be released by calling function gui_chat_format_release.
+ */
+
+char *
+gui_chat_vformat (const char *format, va_list args)
+{
+    va_list args_copy;
+    char *buffer, *new_buffer;
+    int size, num, use_format_buffer;
+
+    use_format_buffer = !gui_chat_format_buffer_used;
+
+    if (use_format_buffer && gui_chat_format_buffer)
+    {
+        buffer = gui_chat_format_buffer;
+        size = gui_chat_format_buffer_size;
+    }
+    else
+    {
+        size = 1024;
+        buffer = malloc (size);
+        if (!buffer)
+            return NULL;
+        if (use_format_buffer)
+        {
+            gui_chat_format_buffer = buffer;
+            gui_chat_format_buffer_size = size;
+        }
+    }
+
+    while (1)
+    {
+        va_copy (args_copy, args);
+        num = vsnprintf (buffer, size, format, args_copy);
+        va_end (args_copy);
+        if ((num >= 0) && (num < size))
+            break;
+        size = (num >= 0) ? num + 1 : size * 2;
+        new_buffer = realloc (buffer, size);
+        if (!new_buffer)
+        {
+            free (buffer);
+            if (use_format_buffer)
+            {
+                gui_chat_format_buffer = NULL;
+                gui_chat_format_buffer_size = 0;
+            }
+            return NULL;
+        }
+        buffer = new_buffer;
+        if (use_format_buffer)
+        {
+            gui_chat_format_buffer = buffer;
+            gui_chat_format_buffer_size = size;
+        }
+    }
+
+    if (use_format_buffer)
+        gui_chat_format_buffer_used = 1;
+
+    return buffer;
+}
+
+/*
+ * Releases a message formatted by function gui_chat_vformat.
+ *
+ * The reused buffer is freed if it is too big (to not keep a lot of memory
+ * after a very long message).
+ */
+
+void
+gui_chat_format_release (char *message)
+{
+    if (!message)
+        return;
+
+    if (message == gui_chat_format_buffer)
+    {
+        gui_chat_format_buffer_used = 0;
+        if (gui_chat_format_buffer_size > GUI_CHAT_FORMAT_BUFFER_MAX_SIZE)
+        {
+            free (gui_chat_format_buffer);
+            gui_chat_format_buffer = NULL;
+            gui_chat_format_buffer_size = 0;
+        }
+    }
+    else
+    {
+        free (message);
+    }
+}
+
+/*
+ * Displays a message in a child process (hook_process with a function):
+ * the message is written without colors on stderr, so it is sent to the
+ * callback of WeeChat process (instead of being added in a buffer of the
+ * child, which is never displayed).
+ */
+
+void
+gui_chat_printf_child (const char *message)
+{
+    char *message_no_color;
+
+    message_no_color = gui_color_decode (message, NULL);
+    fprintf (stderr, "%s\n", (message_no_color) ? message_no_color : message);
+    fflush (stderr);
+    free (message_no_color);
+}
+
 /*
  * Displays a message in a buffer with optional date and tags.
  *
@@ -875,7 +1012,8 @@ gui_chat_printf_datetime_tags (struct t_gui_buffer *buffer,
                                const char *tags, const char *message, ...)
 {
     struct timeval tv_date_printed;
-    char *pos, *pos_end;
+    va_list args;
+    char *vbuffer, *pos, *pos_end;
     int one_line;
 
     if (!message)
@@ -889,12 +1027,21 @@ gui_chat_printf_datetime_tags (struct t_gui_buffer *buffer,
             return;
     }
 
-    weechat_va_format (message);
+    va_start (args, message);
+    vbuffer = gui_chat_vformat (message, args);
+    va_end (args);
     if (!vbuffer)
         return;
 
     utf8_normalize (vbuffer, '?');
 
+    if (hook_process_in_child)
+    {
+        gui_chat_printf_child (vbuffer);
+        gui_chat_format_release (vbuffer);
+        return;
+    }
+
     gettimeofday (&tv_date_printed, NULL);
     if (date <= 0)
     {
@@ -940,7 +1087,142 @@ gui_chat_printf_datetime_tags (struct t_gui_buffer *buffer,
         pos = (pos_end && pos_end[1]) ? pos_end + 1 : NULL;
     }
 
-    free (vbuffer);
+    gui_chat_format_release (vbuffer);
+}
+
+/*
+ * Starts a batch of lines added in a buffer with formatted content.
+ *
+ * Until the end of batch (see function gui_chat_printf_lines_end), hooks
+ * line and print are still executed for each line, but hotlist updates and
+ * signals "buffer_line_added" and "buffer_lines_hidden" are deferred and done
+ * once at the end of batch.
+ *
+ * Batches can be nested: only the end of outer batch sends the signals.
+ */
+
+void
+gui_chat_printf_lines_begin (struct t_gui_buffer *buffer)
+{
+    if (!buffer)
+        buffer = gui_buffer_search_main ();
+
+    if (!buffer || !gui_buffer_valid (buffer)
+        || (buffer->type != GUI_BUFFER_TYPE_FORMATTED))
+    {
+        return;
+    }
+
+    if (buffer->lines_batch == 0)
+    {
+        buffer->lines_batch_first_id = buffer->next_line_id;
+        buffer->lines_batch_count = 0;
+        buffer->lines_batch_hidden = 0;
+        memset (buffer->lines_batch_hotlist, 0,
+                sizeof (buffer->lines_batch_hotlist));
+    }
+    buffer->lines_batch++;
+}
+
+/*
+ * Checks if a line has been added in current batch of lines of its buffer.
+ *
+ * Returns:
+ *   1: line added in batch
+ *   0: line added before the batch
+ */
+
+int
+gui_chat_line_in_batch (struct t_gui_line *line)
+{
+    int id, first_id, next_id;
+
+    id = line->data->id;
+    first_id = line->data->buffer->lines_batch_first_id;
+    next_id = line->data->buffer->next_line_id;
+
+    /* the line id is reset to 0 after INT_MAX */
+    if (first_id <= next_id)
+        return (id >= first_id) && (id < next_id);
+
+    return (id >= first_id) || (id < next_id);
+}
+
+/*
+ * Ends a batch of lines added in a buffer with formatted content: updates
+ * hotlist and sends signals for all lines added since the call to
+ * gui_chat_printf_lines_begin.
+ */
+
+void
+gui_chat_printf_lines_end (struct t_gui_buffer *buffer)
+{
+    struct t_gui_line *ptr_line, *ptr_next_line, *ptr_last_line;
+    int i, count;
+
+    if (!buffer)
+        buffer = gui_buffer_search_main ();
+
+    if (!buffer || !gui_buffer_valid (buffer) || (buffer->lines_batch <= 0))
+        return;
+
+    buffer->lines_batch--;
+    if (buffer->lines_batch > 0)
+        return;
+
+    /* add buffer in hotlist, once by priority */
+    for (i = 0; i < GUI_HOTLIST_NUM_PRIORITIES; i++)
+    {
+        count = buffer->lines_batch_hotlist[i];
+        buffer->lines_batch_hotlist[i] = 0;
+        if (count > 0)
+        {
+            (void) gui_hotlist_add_count (
+                buffer,
+                i,
+                NULL,  /* creation_time */
+                1,  /* check_conditions */
+                count);
+        }
+    }
+
+    if (buffer->lines_batch_hidden)
+    {
+        buffer->lines_batch_hidden = 0;
+        (void) gui_buffer_send_signal (buffer,
+                                       "buffer_lines_hidden",
+                                       WEECHAT_HOOK_SIGNAL_POINTER,
+                                       buffer);
+    }
+
+    /*
+     * send signal "buffer_line_added" for lines of batch still in buffer
+     * (some of them may have been removed, for example by the option
+     * weechat.history.max_buffer_lines_number)
+     */
+    count = buffer->lines_batch_count;
+    buffer->lines_batch_count = 0;
+    if (count <= 0)
+        return;
+    ptr_last_line = buffer->own_lines->last_line;
+    if (!ptr_last_line || !gui_chat_line_in_batch (ptr_last_line))
+        return;
+    ptr_line = ptr_last_line;
+    for (i = 1; (i < count) && ptr_line->prev_line
+             && gui_chat_line_in_batch (ptr_line->prev_line); i++)
+    {
+        ptr_line = ptr_line->prev_line;
+    }
+    while (ptr_line)
+    {
+        /* lines added by callbacks of signal are not part of the batch */
+        ptr_next_line = (ptr_line == ptr_last_line) ?
+            NULL : ptr_line->next_line;
+        (void) gui_buffer_send_signal (buffer,
+                                       "buffer_line_added",
+                                       WEECHAT_HOOK_SIGNAL_POINTER, ptr_line);
+        ptr_line = ptr_next_line;
+    }
 }
 
 /*
@@ -957,6 +1239,8 @@ gui_chat_printf_y_datetime_tags (struct t_gui_buffer *buffer, int y,
 {
     struct t_gui_line *ptr_line, *new_line, *new_line_empty;
     struct timeval tv_date_printed;
+    va_list args;
+    char *vbuffer;
     int i, last_y, num_lines_to_add;
 
     if (!message)
@@ -965,6 +1249,10 @@ gui_chat_printf_y_datetime_tags (struct t_gui_buffer *buffer, int y,
     if (gui_init_ok && !gui_chat_buffer_valid (buffer, GUI_BUFFER_TYPE_FREE))
         return;
 
+    /* buffers with free content are not updated in a child process */
+    if (hook_process_in_child)
+        return;
+
     /* if y is negative, add a line -N lines after the last line */
     if (y < 0)
     {
@@ -972,7 +1260,9 @@ gui_chat_printf_y_datetime_tags (struct t_gui_buffer *buffer, int y,
             buffer->own_lines->last_line->data->y - y : (-1 * y) - 1;
     }
 
-    weechat_va_format (message);
+    va_start (args, message);
+    vbuffer = gui_chat_vformat (message, args);
+    va_end (args);
     if (!vbuffer)
         return;
 
@@ -1001,8 +1291,7 @@ gui_chat_printf_y_datetime_tags (struct t_gui_buffer *buffer, int y,
 
     if (!new_line->data->buffer)
     {
-        gui_line_free_data (new_line);
-        free (new_line);
+        gui_line_free_new (new_line);
         goto end;
     }
 
@@ -1041,8 +1330,7 @@ gui_chat_printf_y_datetime_tags (struct t_gui_buffer *buffer, int y,
         else
         {
             string_fprintf (stdout, "%s\n", new_line->data->message);
-            gui_line_free_data (new_line);
-            free (new_line);
+            gui_line_free_new (new_line);
         }
     }
     else
@@ -1070,12 +1358,11 @@ gui_chat_printf_y_datetime_tags (struct t_gui_buffer *buffer, int y,
                 }
             }
         }
-        gui_line_free_data (new_line);
-        free (new_line);
+        gui_line_free_new (new_line);
     }
 
 end:
-    free (vbuffer);
+    gui_chat_format_release (vbuffer);
 }
 
 /*
@@ -1209,6 +1496,15 @@ gui_chat_end ()
         }
     }
 
+    /* free buffers used to remove colors in lines */
+    gui_line_free_buffers_no_color ();
+
+    /* free buffer used to format messages */
+    free (gui_chat_format_buffer);
+    gui_chat_format_buffer = NULL;
+    gui_chat_format_buffer_size = 0;
+    gui_chat_format_buffer_used = 0;
+
     /* free lines waiting for buffer (should always be NULL here) */
     if (gui_chat_lines_waiting_buffer)
     {
@@ -21,6 +21,7 @@
 #define WEECHAT_GUI_CHAT_H
 
 #include <stdio.h>
+#include <stdarg.h>
 #include <time.h>
 
 struct t_hashtable;
@@ -48,6 +49,9 @@ struct t_gui_line;
 #define GUI_CHAT_PREFIX_JOIN_DEFAULT    "-->"
 #define GUI_CHAT_PREFIX_QUIT_DEFAULT    "<--"
 
+/* max size kept for the buffer reused to format messages */
+#define GUI_CHAT_FORMAT_BUFFER_MAX_SIZE (64 * 1024)
+
 enum t_gui_chat_prefix
 {
     GUI_CHAT_PREFIX_ERROR = 0,
@@ -96,6 +100,9 @@ extern int gui_chat_get_time_length ();
 extern void gui_chat_change_time_format ();
 extern int gui_chat_buffer_valid (struct t_gui_buffer *buffer,
                                   int buffer_type);
+extern char *gui_chat_vformat (const char *format, va_list args);
+extern void gui_chat_format_release (char *message);
+extern void gui_chat_printf_child (const char *message);
 extern void gui_chat_printf_datetime_tags (struct t_gui_buffer *buffer,
                                            time_t date, int date_usec,
                                            const char *tags,
@@ -105,6 +112,9 @@ extern void gui_chat_printf_y_datetime_tags (struct t_gui_buffer *buffer,
                                              time_t date, int date_usec,
                                              const char *tags,
                                              const char *message, ...);
+extern void gui_chat_printf_lines_begin (struct t_gui_buffer *buffer);
+extern int gui_chat_line_in_batch (struct t_gui_line *line);
+extern void gui_chat_printf_lines_end (struct t_gui_buffer *buffer);
 extern void gui_chat_print_lines_waiting_buffer (FILE *f);
 extern int gui_chat_hsignal_quote_line_cb (const void *pointer, void *data,
                                            const char *signal,
@@ -120,5 +130,9 @@ extern const char *gui_chat_string_next_char (struct t_gui_window *window,
                                               int apply_style_inactive,
                                               int nick_offline);
 extern void gui_chat_draw (struct t_gui_buffer *buffer, int clear_chat);
+extern void gui_chat_layout_remove_line (struct t_gui_window *window,
+                                         struct t_gui_line *line);
+extern void gui_chat_layout_clear (struct t_gui_window *window);
+extern void gui_chat_layout_reset (struct t_gui_window *window);
 
 #endif /* WEECHAT_GUI_CHAT_H */
@@ -100,6 +100,13 @@ int gui_color_term256[256] =
     0xd0d0d0, 0xdadada, 0xe4e4e4, 0xeeeeee,                      /* 252-255 */
 };
 
+/* chars starting a WeeChat color code */
+static const char gui_color_code_chars[] =
+{
+    GUI_COLOR_COLOR_CHAR, GUI_COLOR_SET_ATTR_CHAR, GUI_COLOR_REMOVE_ATTR_CHAR,
+    GUI_COLOR_RESET_CHAR, '\0',
+};
+
 /* ANSI colors */
 regex_t *gui_color_regex_ansi = NULL;
 char *gui_color_ansi[16] =
@@ -774,6 +781,48 @@ gui_color_code_size (const char *string)
     return 0;
 }
 
+/*
+ * Removes WeeChat color codes from a message and adds the result to a
+ * dynamic string, optionally replacing color codes by a string.
+ *
+ * Text between color codes is added at once (not char by char).
+ */
+
+void
+gui_color_decode_dyn (char **output, const char *string,
+                      const char *replacement)
+{
+    const char *ptr_string, *ptr_start;
+
+    ptr_start = string;
+    ptr_string = string;
+    while (ptr_string[0])
+    {
+        switch (ptr_string[0])
+        {
+            case GUI_COLOR_COLOR_CHAR:
+            case GUI_COLOR_SET_ATTR_CHAR:
+            case GUI_COLOR_REMOVE_ATTR_CHAR:
+            case GUI_COLOR_RESET_CHAR:
+                if (ptr_string > ptr_start)
+                {
+                    string_dyn_concat (output, ptr_start,
+                                       ptr_string - ptr_start);
+                }
+                ptr_string += gui_color_code_size (ptr_string);
+                ptr_start = ptr_string;
+                if (replacement && replacement[0])
+                    string_dyn_concat (output, replacement, -1);
+                break;
+            default:
+                ptr_string++;
+                break;
+        }
+    }
+    if (ptr_string > ptr_start)
+        string_dyn_concat (output, ptr_start, ptr_string - ptr_start);
+}
+
 /*
  * Removes WeeChat color codes from a message and optionally replaces them
  * by a string.
@@ -784,9 +833,7 @@ gui_color_code_size (const char *string)
 char *
 gui_color_decode (const char *string, const char *replacement)
 {
-    const unsigned char *ptr_string;
     char **out;
-    int length;
 
     if (!string)
         return NULL;
@@ -795,171 +842,46 @@ gui_color_decode (const char *string, const char *replacement)
     if (!out)
         return NULL;
 
-    ptr_string = (unsigned char *)string;
-    while (ptr_string && ptr_string[0])
+    gui_color_decode_dyn (out, string, replacement);
+
+    return string_dyn_free (out, 0);
+}
+
+/*
+ * Removes WeeChat color codes from a message, using a reusable buffer.
+ *
+ * If the string has no color codes, the string itself is returned and the
+ * buffer is not used. Otherwise the buffer (a dynamic string) is allocated
+ * if needed (when *buffer is NULL), filled with the string without colors
+ * and returned: it can be reused for other strings and must be freed after
+ * use with string_dyn_free (*buffer, 1).
+ *
+ * Note: result must NOT be freed.
+ */
+
+const char *
+gui_color_decode_buffer (const char *string, char ***buffer)
+{
+    if (!string || !buffer)
+        return NULL;
+
+    if (!strpbrk (string, gui_color_code_chars))
+        return string;
+
+    if (*buffer)
     {
-        switch (ptr_string[0])
-        {
-            case GUI_COLOR_COLOR_CHAR:
-                ptr_string++;
-                switch (ptr_string[0])
-                {
-                    case GUI_COLOR_FG_CHAR:
-                        ptr_string++;
-                        if (ptr_string[0] == GUI_COLOR_EXTENDED_CHAR)
-                        {
-                            ptr_string++;
-                            while (gui_color_attr_get_flag (ptr_string[0]) > 0)
-                            {
-                                ptr_string++;
-                            }
-                            if (ptr_string[0] && ptr_string[1] && ptr_string[2]
-                                && ptr_string[3] && ptr_string[4])
-                            {
-                                ptr_string += 5;
-                            }
-                        }
-                        else
-                        {
-                            while (gui_color_attr_get_flag (ptr_string[0]) > 0)
-                            {
-                                ptr_string++;
-                            }
-                            if (ptr_string[0] && ptr_string[1])
-                                ptr_string += 2;
-                        }
-                        break;
-                    case GUI_COLOR_BG_CHAR:
-                        ptr_string++;
-                        if (ptr_string[0] == GUI_COLOR_EXTENDED_CHAR)
-                        {
-                            ptr_string++;
-                            if (ptr_string[0] && ptr_string[1] && ptr_string[2]
-                                && ptr_string[3] && ptr_string[4])
-                            {
-                                ptr_string += 5;
-                            }
-                        }
-                        else
-                        {
-                            if (ptr_string[0] && ptr_string[1])
-                                ptr_string += 2;
-                        }
-                        break;
-                    case GUI_COLOR_FG_BG_CHAR:
-                        ptr_string++;
-                        if (ptr_string[0] == GUI_COLOR_EXTENDED_CHAR)
-                        {
-                            ptr_string++;
-                            while (gui_color_attr_get_flag (ptr_string[0]) > 0)
-                            {
-                                ptr_string++;
-                            }
-                            if (ptr_string[0] && ptr_string[1] && ptr_string[2]
-                                && ptr_string[3] && ptr_string[4])
-                            {
-                                ptr_string += 5;
-                            }
-                        }
-                        else
-                        {
-                            while (gui_color_attr_get_flag (ptr_string[0]) > 0)
-                            {
-                                ptr_string++;
-                            }
-                            if (ptr_string[0] && ptr_string[1])
-                                ptr_string += 2;
-                        }
-                        /*
-                         * note: the comma is an old separator not used any
-                         * more (since WeeChat 2.6), but we still use it here
-                         * so in case of/upgrade this will not break colors in
-                         * old messages
-                         */
-                        if ((ptr_string[0] == ',') || (ptr_string[0] == '~'))
-                        {
-                            if (ptr_string[1] == GUI_COLOR_EXTENDED_CHAR)
-                            {
-                                ptr_string += 2;
-                                if (ptr_string[0] && ptr_string[1]
-                                    && ptr_string[2] && ptr_string[3]
-                                    && ptr_string[4])
-                                {
-                                    ptr_string += 5;
-                                }
-                            }
-                            else
-                            {
-                                ptr_string++;
-                                if (ptr_string[0] && ptr_string[1])
-                                    ptr_string += 2;
-                            }
-                        }
-                        break;
-                    case GUI_COLOR_EXTENDED_CHAR:
-                        ptr_string++;
-                        if ((isdigit (ptr_string[0])) && (isdigit (ptr_string[1]))
-                            && (isdigit (ptr_string[2])) && (isdigit (ptr_string[3]))
-                            && (isdigit (ptr_string[4])))
-                        {
-                            ptr_string += 5;
-                        }
-                        break;
-                    case GUI_COLOR_EMPHASIS_CHAR:
-                        ptr_string++;
-                        break;
-                    case GUI_COLOR_BAR_CHAR:
-                        ptr_string++;
-                        switch (ptr_string[0])
-                        {
-                            case GUI_COLOR_BAR_FG_CHAR:
-                            case GUI_COLOR_BAR_BG_CHAR:
-                            case GUI_COLOR_BAR_DELIM_CHAR:
-                            case GUI_COLOR_BAR_START_INPUT_CHAR:
-                            case GUI_COLOR_BAR_START_INPUT_HIDDEN_CHAR:
-                            case GUI_COLOR_BAR_MOVE_CURSOR_CHAR:
-                            case GUI_COLOR_BAR_START_ITEM:
-                            case GUI_COLOR_BAR_START_LINE_ITEM:
-                            case GUI_COLOR_BAR_SPACER:
-                                ptr_string++;
-                                break;
-                        }
-                        break;
-                    case GUI_COLOR_RESET_CHAR:
-                        ptr_string++;
-                        break;
-                    default:
-                        if (isdigit (ptr_string[0]) && isdigit (ptr_string[1]))
-                            ptr_string += 2;
-                        break;
-                }
-                if (replacement && replacement[0])
-                    string_dyn_concat (out, replacement, -1);
-                break;
-            case GUI_COLOR_SET_ATTR_CHAR:
-            case GUI_COLOR_REMOVE_ATTR_CHAR:
-                ptr_string++;
-                if (ptr_string[0])
-                    ptr_string++;
-                if (replacement && replacement[0])
-                    string_dyn_concat (out, replacement, -1);
-                break;
-            case GUI_COLOR_RESET_CHAR:
-                ptr_string++;
-                if (replacement && replacement[0])
-                    string_dyn_concat (out, replacement, -1);
-                break;
-            default:
-                length = utf8_char_size ((char *)ptr_string);
-                if (length == 0)
-                    length = 1;
-                string_dyn_concat (out, (const char *)ptr_string, length);
-                ptr_string += length;
-                break;
-        }
+        string_dyn_copy (*buffer, NULL);
+    }
+    else
+    {
+        *buffer = string_dyn_alloc (strlen (string) + 1);
+        if (!*buffer)
+            return NULL;
     }
 
-    return string_dyn_free (out, 0);
+    gui_color_decode_dyn (*buffer, string, NULL);
+
+    return **buffer;
 }
 
 /*
@@ -1794,7 +1716,7 @@ gui_color_emphasize (const char *string,
         {
             /* search next match using the regex */
             regex_match.rm_so = -1;
-            rc = regexec (regex, ptr_no_color, 1, &regex_match, 0);
+            rc = string_regexec (regex, ptr_no_color, 1, &regex_match, 0);
 
             /*
              * no match found: exit the loop (if rm_no == 0, it is an empty
@@ -2075,7 +1997,7 @@ gui_color_end ()
 
     if (gui_color_regex_ansi)
     {
-        regfree (gui_color_regex_ansi);
+        string_regfree (gui_color_regex_ansi);
         free (gui_color_regex_ansi);
         gui_color_regex_ansi = NULL;
     }
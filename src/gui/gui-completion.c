@@ -308,65 +308,45 @@ gui_completion_stop (struct t_gui_completion *completion)
 }
 
 /*
- * Checks if nick has one or more ignored chars (for nick comparison).
+ * Checks if the first char of string is ignored (for nick comparison).
  *
  * Returns:
- *   1: nick has one or more ignored chars
- *   0: nick has no ignored chars
+ *   1: char is ignored
+ *   0: char is not ignored
  */
 
 int
-gui_completion_nick_has_ignored_chars (const char *string)
+gui_completion_nick_char_is_ignored (const char *string)
 {
     int char_size;
     char utf_char[16];
 
-    while (string[0])
-    {
-        char_size = utf8_char_size (string);
-        memcpy (utf_char, string, char_size);
-        utf_char[char_size] = '\0';
+    char_size = utf8_char_size (string);
+    memcpy (utf_char, string, char_size);
+    utf_char[char_size] = '\0';
 
-        if (strstr (CONFIG_STRING(config_completion_nick_ignore_chars),
-                    utf_char))
-            return 1;
-
-        string += char_size;
-    }
-    return 0;
+    return (strstr (CONFIG_STRING(config_completion_nick_ignore_chars),
+                    utf_char)) ? 1 : 0;
 }
 
 /*
- * Duplicates a nick and ignores some chars.
+ * Checks if nick has one or more ignored chars (for nick comparison).
  *
- * Note: result must be freed after use.
+ * Returns:
+ *   1: nick has one or more ignored chars
+ *   0: nick has no ignored chars
  */
 
-char *
-gui_completion_nick_strdup_ignore_chars (const char *string)
+int
+gui_completion_nick_has_ignored_chars (const char *string)
 {
-    int char_size;
-    char *result, *pos, utf_char[16];
-
-    result = malloc (strlen (string) + 1);
-    pos = result;
     while (string[0])
     {
-        char_size = utf8_char_size (string);
-        memcpy (utf_char, string, char_size);
-        utf_char[char_size] = '\0';
-
-        if (!strstr (CONFIG_STRING(config_completion_nick_ignore_chars),
-                     utf_char))
-        {
-            memcpy (pos, utf_char, char_size);
-            pos += char_size;
-        }
-
-        string += char_size;
+        if (gui_completion_nick_char_is_ignored (string))
+            return 1;
+        string = utf8_next_char (string);
     }
-    pos[0] = '\0';
-    return result;
+    return 0;
 }
 
 /*
@@ -382,8 +362,7 @@ gui_completion_nick_strdup_ignore_chars (const char *string)
 int
 gui_completion_nickncmp (const char *base_word, const char *nick, int max)
 {
-    char *base_word2, *nick2;
-    int case_sensitive, return_cmp;
+    int case_sensitive, rc;
 
     case_sensitive = CONFIG_BOOLEAN(config_completion_nick_case_sensitive);
 
@@ -397,17 +376,29 @@ gui_completion_nickncmp (const char *base_word, const char *nick, int max)
             string_strncasecmp (base_word, nick, max);
     }
 
-    base_word2 = gui_completion_nick_strdup_ignore_chars (base_word);
-    nick2 = gui_completion_nick_strdup_ignore_chars (nick);
-
-    return_cmp = (case_sensitive) ?
-        strncmp (base_word2, nick2, utf8_strlen (base_word2)) :
-        string_strncasecmp (base_word2, nick2, utf8_strlen (base_word2));
-
-    free (base_word2);
-    free (nick2);
-
-    return return_cmp;
+    /*
+     * compare base word with the nick without ignored chars (base word has
+     * no ignored chars), without allocating a copy of the nick (this
+     * function is called for each nick of the buffer)
+     */
+    while (1)
+    {
+        while (nick[0] && gui_completion_nick_char_is_ignored (nick))
+        {
+            nick = utf8_next_char (nick);
+        }
+        if (!base_word[0])
+            return 0;
+        if (!nick[0])
+            return 1;
+        rc = (case_sensitive) ?
+            string_charcmp (base_word, nick) :
+            string_charcasecmp (base_word, nick);
+        if (rc != 0)
+            return rc;
+        base_word = utf8_next_char (base_word);
+        nick = utf8_next_char (nick);
+    }
 }
 
 /*
@@ -512,6 +503,53 @@ gui_completion_list_add (struct t_gui_completion *completion, const char *word,
     }
 }
 
+/*
+ * Adds words from an array sorted (case insensitive) to completion list:
+ * only the words starting with the base word are added, they are found
+ * with a binary search in the array.
+ */
+
+void
+gui_completion_list_add_sorted (struct t_gui_completion *completion,
+                                const char **words, int num_words)
+{
+    int length, low, high, middle;
+
+    if (!completion || !words || (num_words <= 0))
+        return;
+
+    low = 0;
+    length = 0;
+
+    if (completion->base_word && completion->base_word[0])
+    {
+        length = utf8_strlen (completion->base_word);
+
+        /* search first word >= base word */
+        high = num_words;
+        while (low < high)
+        {
+            middle = low + ((high - low) / 2);
+            if (string_strncasecmp (words[middle], completion->base_word,
+                                    length) < 0)
+                low = middle + 1;
+            else
+                high = middle;
+        }
+    }
+
+    /* add all words starting with base word (they are consecutive) */
+    while ((low < num_words)
+           && ((length == 0)
+               || (string_strncasecmp (words[low], completion->base_word,
+                                       length) == 0)))
+    {
+        gui_completion_list_add (completion, words[low],
+                                 0, WEECHAT_LIST_POS_SORT);
+        low++;
+    }
+}
+
 /*
  * Custom completion by a plugin.
  */
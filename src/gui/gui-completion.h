@@ -89,6 +89,9 @@ extern void gui_completion_stop (struct t_gui_completion *completion);
 extern void gui_completion_list_add (struct t_gui_completion *completion,
                                      const char *word,
                                      int nick_completion, const char *where);
+extern void gui_completion_list_add_sorted (struct t_gui_completion *completion,
+                                            const char **words,
+                                            int num_words);
 extern int gui_completion_search (struct t_gui_completion *completion,
                                   const char *data, int position,
                                   int direction);
@@ -46,11 +46,154 @@
 struct t_gui_filter *gui_filters = NULL;           /* first filter          */
 struct t_gui_filter *last_gui_filter = NULL;       /* last filter           */
 int gui_filters_enabled = 1;                       /* filters enabled?      */
+int gui_filters_generation = 0;                    /* incremented when a    */
+                                                   /* filter is added or    */
+                                                   /* removed               */
+struct t_hook *gui_filter_jobs_timer = NULL;       /* timer for filter jobs */
 
+/* lines checked at once and their result (1 = displayed, 0 = hidden) */
+struct t_gui_line_data *gui_filter_scan_lines[GUI_FILTER_SCAN_MAX_LINES];
+char gui_filter_scan_displayed[GUI_FILTER_SCAN_MAX_LINES];
+
+/* buffers whose lines are in gui_filter_scan_lines (see function */
+/* gui_filter_all_buffers) */
+struct t_gui_buffer *gui_filter_scan_buffers[GUI_FILTER_SCAN_MAX_BUFFERS];
+int gui_filter_scan_buffers_start[GUI_FILTER_SCAN_MAX_BUFFERS + 1];
+
+
+/*
+ * Checks if a buffer is matching buffer names of a filter.
+ *
+ * Returns:
+ *   1: buffer matches filter
+ *   0: buffer does not match filter
+ */
+
+int
+gui_filter_match_buffer (struct t_gui_filter *filter,
+                         struct t_gui_buffer *buffer)
+{
+    if (filter->buffers_masks)
+    {
+        return string_match_list_compiled (buffer->full_name,
+                                           filter->buffers_masks);
+    }
+
+    return string_match_list (buffer->full_name,
+                              (const char **)filter->buffers, 0);
+}
+
+/*
+ * Resets cache of filters in a buffer: the cache is built again on next line
+ * checked.
+ */
+
+void
+gui_filter_buffer_cache_reset (struct t_gui_buffer *buffer)
+{
+    if (!buffer)
+        return;
+
+    free (buffer->filters_cache);
+    buffer->filters_cache = NULL;
+    buffer->filters_cache_count = 0;
+    buffer->filters_cache_generation = -1;
+}
+
+/*
+ * Builds cache of filters in a buffer: list of filters (enabled or not) with
+ * a buffer mask matching the buffer full name.
+ *
+ * If the cache can not be built, buffer->filters_cache_generation is set to
+ * -1 and all filters are checked for each line.
+ */
+
+void
+gui_filter_buffer_cache_build (struct t_gui_buffer *buffer)
+{
+    struct t_gui_filter *ptr_filter;
+    int count;
+
+    gui_filter_buffer_cache_reset (buffer);
+
+    if (!buffer->full_name)
+        return;
+
+    count = 0;
+    for (ptr_filter = gui_filters; ptr_filter;
+         ptr_filter = ptr_filter->next_filter)
+    {
+        if (gui_filter_match_buffer (ptr_filter, buffer))
+        {
+            count++;
+        }
+    }
+
+    if (count > 0)
+    {
+        buffer->filters_cache = malloc (
+            count * sizeof (*buffer->filters_cache));
+        if (!buffer->filters_cache)
+            return;
+        for (ptr_filter = gui_filters; ptr_filter;
+             ptr_filter = ptr_filter->next_filter)
+        {
+            if (gui_filter_match_buffer (ptr_filter, buffer))
+            {
+                buffer->filters_cache[buffer->filters_cache_count++] =
+                    ptr_filter;
+            }
+        }
+    }
+
+    buffer->filters_cache_generation = gui_filters_generation;
+}
+
+/*
+ * Checks if a line is matching tags and regex of a filter (buffer is not
+ * checked).
+ *
+ * Returns:
+ *   1: line is matching filter (line must be hidden)
+ *   0: line is not matching filter
+ */
+
+int
+gui_filter_match_line (struct t_gui_filter *filter,
+                       struct t_gui_line_data *line_data)
+{
+    int rc;
+
+    if ((strcmp (filter->tags, "*") != 0)
+        && !gui_line_match_tags (line_data,
+                                 filter->tags_count,
+                                 filter->tags_array))
+    {
+        return 0;
+    }
+
+    /* check line with regex */
+    rc = 1;
+    if (!filter->regex_prefix && !filter->regex_message)
+        rc = 0;
+    if (gui_line_match_regex (line_data,
+                              filter->regex_prefix,
+                              filter->regex_message))
+    {
+        rc = 0;
+    }
+    if (filter->regex && (filter->regex[0] == '!'))
+        rc ^= 1;
+
+    return (rc == 0) ? 1 : 0;
+}
 
 /*
  * Checks if a line must be displayed or not (filtered).
  *
+ * Only filters in cache of buffer are checked (the cache is built if
+ * needed).
+ *
  * Returns:
  *   1: line must be displayed (not filtered)
  *   0: line must be hidden (filtered)
@@ -59,12 +202,40 @@ int gui_filters_enabled = 1;                       /* filters enabled?      */
 int
 gui_filter_check_line (struct t_gui_line_data *line_data)
 {
+    struct t_gui_buffer *ptr_buffer;
     struct t_gui_filter *ptr_filter;
-    int rc;
+    int i;
+
+    ptr_buffer = line_data->buffer;
 
     /* line is always displayed if filters are disabled (globally or in buffer) */
-    if (!gui_filters_enabled || !line_data->buffer->filter)
+    if (!gui_filters_enabled || !ptr_buffer->filter)
+        return 1;
+
+    if (ptr_buffer->filters_cache_generation != gui_filters_generation)
+        gui_filter_buffer_cache_build (ptr_buffer);
+
+    if (ptr_buffer->filters_cache_generation == gui_filters_generation)
+    {
+        if (ptr_buffer->filters_cache_count == 0)
+            return 1;
+
+        if (gui_line_has_tag_no_filter (line_data))
+            return 1;
+
+        for (i = 0; i < ptr_buffer->filters_cache_count; i++)
+        {
+            if (ptr_buffer->filters_cache[i]->enabled
+                && gui_filter_match_line (ptr_buffer->filters_cache[i],
+                                          line_data))
+            {
+                return 0;
+            }
+        }
         return 1;
+    }
+
+    /* cache not available: check all filters */
 
     if (gui_line_has_tag_no_filter (line_data))
         return 1;
@@ -72,34 +243,11 @@ gui_filter_check_line (struct t_gui_line_data *line_data)
     for (ptr_filter = gui_filters; ptr_filter;
          ptr_filter = ptr_filter->next_filter)
     {
-        if (ptr_filter->enabled)
+        if (ptr_filter->enabled
+            && gui_filter_match_buffer (ptr_filter, ptr_buffer)
+            && gui_filter_match_line (ptr_filter, line_data))
         {
-            /* check buffer */
-            if (string_match_list (line_data->buffer->full_name,
-                                   (const char **)ptr_filter->buffers,
-                                   0))
-            {
-                if ((strcmp (ptr_filter->tags, "*") == 0)
-                    || (gui_line_match_tags (line_data,
-                                             ptr_filter->tags_count,
-                                             ptr_filter->tags_array)))
-                {
-                    /* check line with regex */
-                    rc = 1;
-                    if (!ptr_filter->regex_prefix && !ptr_filter->regex_message)
-                        rc = 0;
-                    if (gui_line_match_regex (line_data,
-                                              ptr_filter->regex_prefix,
-                                              ptr_filter->regex_message))
-                    {
-                        rc = 0;
-                    }
-                    if (ptr_filter->regex && (ptr_filter->regex[0] == '!'))
-                        rc ^= 1;
-                    if (rc == 0)
-                        return 0;
-                }
-            }
+            return 0;
         }
     }
 
@@ -108,53 +256,104 @@ gui_filter_check_line (struct t_gui_line_data *line_data)
 }
 
 /*
- * Filters a buffer, using message filters.
+ * Callback used to check a line with filters (called by gui_line_scan,
+ * possibly in a thread).
+ */
+
+int
+gui_filter_scan_cb (void *data, struct t_gui_line_data *line_data)
+{
+    /* make C compiler happy */
+    (void) data;
+
+    return gui_filter_check_line (line_data);
+}
+
+/*
+ * Checks the first "count" lines of gui_filter_scan_lines with filters,
+ * result is stored in gui_filter_scan_displayed.
  *
- * If line_data is NULL, filters all lines in buffer.
- * If line_data is not NULL, filters only this line_data.
+ * Lines are checked in threads if there are many lines: the cache of filters
+ * is first built in all buffers, so that threads only read buffers (if the
+ * cache can not be built, lines are checked in main thread).
  */
 
 void
-gui_filter_buffer (struct t_gui_buffer *buffer,
-                   struct t_gui_line_data *line_data)
+gui_filter_scan (int count)
 {
-    struct t_gui_line *ptr_line;
-    struct t_gui_line_data *ptr_line_data;
-    struct t_gui_window *ptr_window;
-    int lines_changed, line_displayed, lines_hidden;
+    struct t_gui_buffer *ptr_buffer;
+    int max_threads;
 
-    lines_changed = 0;
-    lines_hidden = buffer->lines->lines_hidden;
+    max_threads = CONFIG_INTEGER(config_look_scan_threads);
 
-    ptr_line = buffer->lines->first_line;
-    while (ptr_line || line_data)
+    if (gui_filters_enabled
+        && (max_threads > 1)
+        && (count >= 2 * GUI_LINE_SCAN_MIN_LINES_THREAD))
     {
-        ptr_line_data = (line_data) ? line_data : ptr_line->data;
+        for (ptr_buffer = gui_buffers; ptr_buffer;
+             ptr_buffer = ptr_buffer->next_buffer)
+        {
+            if (!ptr_buffer->filter)
+                continue;
+            if (ptr_buffer->filters_cache_generation != gui_filters_generation)
+                gui_filter_buffer_cache_build (ptr_buffer);
+            if (ptr_buffer->filters_cache_generation != gui_filters_generation)
+            {
+                max_threads = 1;
+                break;
+            }
+        }
+    }
 
-        line_displayed = gui_filter_check_line (ptr_line_data);
+    gui_line_scan (gui_filter_scan_lines, count, max_threads,
+                   &gui_filter_scan_cb, NULL, gui_filter_scan_displayed);
+}
 
-        if (ptr_line_data->displayed != line_displayed)
+/*
+ * Applies result of gui_filter_scan on the first "count" lines of
+ * gui_filter_scan_lines and updates the number of hidden lines.
+ *
+ * Returns:
+ *   1: at least one line has been hidden or displayed
+ *   0: no changes
+ */
+
+int
+gui_filter_scan_apply (int count, int *lines_hidden)
+{
+    int i, lines_changed;
+
+    lines_changed = 0;
+
+    for (i = 0; i < count; i++)
+    {
+        if (gui_filter_scan_lines[i]->displayed != gui_filter_scan_displayed[i])
         {
             lines_changed = 1;
-            lines_hidden += (line_displayed) ? -1 : 1;
+            *lines_hidden += (gui_filter_scan_displayed[i]) ? -1 : 1;
+            gui_line_set_displayed (gui_filter_scan_lines[i],
+                                    gui_filter_scan_displayed[i]);
         }
+    }
 
-        ptr_line_data->displayed = line_displayed;
-
-        if (line_data)
-            break;
+    return lines_changed;
+}
 
-        ptr_line = ptr_line->next_line;
-    }
+/*
+ * Updates number of hidden lines and asks refresh of buffer after some
+ * lines have been filtered.
+ */
 
-    if (line_data)
-        line_data->buffer->lines->prefix_max_length_refresh = 1;
-    else
-        buffer->lines->prefix_max_length_refresh = 1;
+void
+gui_filter_buffer_update (struct t_gui_buffer *buffer,
+                          struct t_gui_lines *lines,
+                          int lines_hidden, int lines_changed)
+{
+    struct t_gui_window *ptr_window;
 
-    if (buffer->lines->lines_hidden != lines_hidden)
+    if (lines->lines_hidden != lines_hidden)
     {
-        buffer->lines->lines_hidden = lines_hidden;
+        lines->lines_hidden = lines_hidden;
         (void) gui_buffer_send_signal (buffer,
                                        "buffer_lines_hidden",
                                        WEECHAT_HOOK_SIGNAL_POINTER, buffer);
@@ -185,28 +384,335 @@ gui_filter_buffer (struct t_gui_buffer *buffer,
     }
 }
 
+/*
+ * Filters a buffer, using message filters.
+ *
+ * If line_data is NULL, filters all lines in buffer (and cancels the filter
+ * job running on buffer lines, if any).
+ * If line_data is not NULL, filters only this line_data.
+ */
+
+void
+gui_filter_buffer (struct t_gui_buffer *buffer,
+                   struct t_gui_line_data *line_data)
+{
+    struct t_gui_line *ptr_line;
+    int count, lines_changed, line_displayed, lines_hidden;
+
+    lines_changed = 0;
+    lines_hidden = buffer->lines->lines_hidden;
+
+    if (line_data)
+    {
+        line_displayed = gui_filter_check_line (line_data);
+        if (line_data->displayed != line_displayed)
+        {
+            lines_changed = 1;
+            lines_hidden += (line_displayed) ? -1 : 1;
+        }
+        gui_line_set_displayed (line_data, line_displayed);
+    }
+    else
+    {
+        buffer->lines->filter_job_line = NULL;
+        ptr_line = buffer->lines->first_line;
+        while (ptr_line)
+        {
+            count = 0;
+            while (ptr_line && (count < GUI_FILTER_SCAN_MAX_LINES))
+            {
+                gui_filter_scan_lines[count++] = ptr_line->data;
+                ptr_line = ptr_line->next_line;
+            }
+            gui_filter_scan (count);
+            if (gui_filter_scan_apply (count, &lines_hidden))
+                lines_changed = 1;
+        }
+    }
+
+    gui_filter_buffer_update (buffer, buffer->lines,
+                              lines_hidden, lines_changed);
+}
+
+/*
+ * Runs one step of the filter job on lines of a buffer: filters at most
+ * "max_lines" lines (all lines if max_lines <= 0), starting with line
+ * lines->filter_job_line and going backwards.
+ *
+ * Returns:
+ *   1: job is finished (all lines have been filtered)
+ *   0: job is not finished
+ */
+
+int
+gui_filter_job_step (struct t_gui_buffer *buffer, struct t_gui_lines *lines,
+                     int max_lines)
+{
+    struct t_gui_line *ptr_line;
+    int count, count_scan, lines_changed, lines_hidden;
+
+    if (!lines->filter_job_line)
+        return 1;
+
+    count = 0;
+    lines_changed = 0;
+    lines_hidden = lines->lines_hidden;
+
+    ptr_line = lines->filter_job_line;
+    while (ptr_line && ((max_lines <= 0) || (count < max_lines)))
+    {
+        count_scan = 0;
+        while (ptr_line
+               && (count_scan < GUI_FILTER_SCAN_MAX_LINES)
+               && ((max_lines <= 0) || (count + count_scan < max_lines)))
+        {
+            gui_filter_scan_lines[count_scan++] = ptr_line->data;
+            ptr_line = ptr_line->prev_line;
+        }
+        gui_filter_scan (count_scan);
+        if (gui_filter_scan_apply (count_scan, &lines_hidden))
+            lines_changed = 1;
+        count += count_scan;
+    }
+
+    lines->filter_job_line = ptr_line;
+    lines->filter_job_lines_done += count;
+
+    gui_filter_buffer_update (buffer, lines, lines_hidden, lines_changed);
+
+    return (ptr_line) ? 0 : 1;
+}
+
+/*
+ * Runs one step of all filter jobs.
+ *
+ * Returns:
+ *   1: all jobs are finished
+ *   0: some jobs are not finished
+ */
+
+int
+gui_filter_jobs_step (int max_lines)
+{
+    struct t_gui_buffer *ptr_buffer;
+    int finished;
+
+    finished = 1;
+
+    for (ptr_buffer = gui_buffers; ptr_buffer;
+         ptr_buffer = ptr_buffer->next_buffer)
+    {
+        if (!gui_filter_job_step (ptr_buffer, ptr_buffer->own_lines,
+                                  max_lines))
+        {
+            finished = 0;
+        }
+        if (ptr_buffer->mixed_lines
+            && !gui_filter_job_step (ptr_buffer, ptr_buffer->mixed_lines,
+                                     max_lines))
+        {
+            finished = 0;
+        }
+    }
+
+    return finished;
+}
+
+/*
+ * Callback for timer running filter jobs.
+ */
+
+int
+gui_filter_jobs_timer_cb (const void *pointer, void *data, int remaining_calls)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) remaining_calls;
+
+    if (gui_filter_jobs_step (CONFIG_INTEGER(config_look_filter_chunk_size)))
+    {
+        unhook (gui_filter_jobs_timer);
+        gui_filter_jobs_timer = NULL;
+    }
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Filters all lines of a buffer, in background if the buffer has more lines
+ * than option weechat.look.filter_chunk_size: lines are then filtered by
+ * chunks (starting with the last line, which are displayed) by a timer.
+ */
+
+void
+gui_filter_buffer_job_start (struct t_gui_buffer *buffer)
+{
+    int chunk_size;
+
+    chunk_size = CONFIG_INTEGER(config_look_filter_chunk_size);
+
+    if ((chunk_size <= 0) || (buffer->lines->lines_count <= chunk_size))
+    {
+        gui_filter_buffer (buffer, NULL);
+        return;
+    }
+
+    buffer->lines->filter_job_line = buffer->lines->last_line;
+    buffer->lines->filter_job_lines_done = 0;
+
+    /* filter immediately the last lines (displayed in windows) */
+    if (gui_filter_job_step (buffer, buffer->lines, chunk_size))
+        return;
+
+    if (!gui_filter_jobs_timer)
+    {
+        gui_filter_jobs_timer = hook_timer (NULL, 1, 0, 0,
+                                            &gui_filter_jobs_timer_cb,
+                                            NULL, NULL);
+        if (!gui_filter_jobs_timer)
+            gui_filter_jobs_finish ();
+    }
+}
+
+/*
+ * Finishes immediately all filter jobs (for example before lines of buffers
+ * are merged or unmerged).
+ */
+
+void
+gui_filter_jobs_finish ()
+{
+    (void) gui_filter_jobs_step (0);
+
+    if (gui_filter_jobs_timer)
+    {
+        unhook (gui_filter_jobs_timer);
+        gui_filter_jobs_timer = NULL;
+    }
+}
+
+/*
+ * Filters lines of buffers in gui_filter_scan_buffers (lines are all in
+ * gui_filter_scan_lines).
+ */
+
+void
+gui_filter_scan_buffers_flush (int num_buffers)
+{
+    struct t_gui_buffer *buffers[GUI_FILTER_SCAN_MAX_BUFFERS];
+    int i, j, start, end, lines_hidden[GUI_FILTER_SCAN_MAX_BUFFERS];
+    int lines_changed[GUI_FILTER_SCAN_MAX_BUFFERS];
+
+    if (num_buffers <= 0)
+        return;
+
+    gui_filter_scan (gui_filter_scan_buffers_start[num_buffers]);
+
+    /*
+     * apply result on all buffers before sending signals, because a signal
+     * callback can filter lines again (and use gui_filter_scan_lines)
+     */
+    for (i = 0; i < num_buffers; i++)
+    {
+        buffers[i] = gui_filter_scan_buffers[i];
+        start = gui_filter_scan_buffers_start[i];
+        end = gui_filter_scan_buffers_start[i + 1];
+        lines_hidden[i] = buffers[i]->lines->lines_hidden;
+        lines_changed[i] = 0;
+        for (j = start; j < end; j++)
+        {
+            if (gui_filter_scan_lines[j]->displayed
+                != gui_filter_scan_displayed[j])
+            {
+                lines_changed[i] = 1;
+                lines_hidden[i] += (gui_filter_scan_displayed[j]) ? -1 : 1;
+                gui_line_set_displayed (gui_filter_scan_lines[j],
+                                        gui_filter_scan_displayed[j]);
+            }
+        }
+    }
+
+    for (i = 0; i < num_buffers; i++)
+    {
+        if (gui_buffer_valid (buffers[i]))
+        {
+            gui_filter_buffer_update (buffers[i], buffers[i]->lines,
+                                      lines_hidden[i], lines_changed[i]);
+        }
+    }
+}
+
 /*
  * Filters all buffers, using message filters.
  *
  * If filter is NULL, filters all buffers.
  * If filter is not NULL, filters only buffers matched by this filter.
+ *
+ * Lines of small buffers are checked together (in threads if there are many
+ * lines, see function gui_filter_scan); big buffers are filtered in
+ * background (see function gui_filter_buffer_job_start).
  */
 
 void
 gui_filter_all_buffers (struct t_gui_filter *filter)
 {
     struct t_gui_buffer *ptr_buffer;
+    struct t_gui_line *ptr_line;
+    int chunk_size, count, num_buffers;
+
+    chunk_size = CONFIG_INTEGER(config_look_filter_chunk_size);
+
+    count = 0;
+    num_buffers = 0;
 
     for (ptr_buffer = gui_buffers; ptr_buffer;
          ptr_buffer = ptr_buffer->next_buffer)
     {
-        if (!filter
-            || string_match_list (ptr_buffer->full_name,
-                                  (const char **)filter->buffers, 0))
+        if (filter
+            && !gui_filter_match_buffer (filter, ptr_buffer))
+        {
+            continue;
+        }
+
+        /* merged or big buffer: filter it now (or in background) */
+        if (ptr_buffer->mixed_lines
+            || (ptr_buffer->lines->lines_count > GUI_FILTER_SCAN_MAX_LINES)
+            || ((chunk_size > 0)
+                && (ptr_buffer->lines->lines_count > chunk_size)))
         {
-            gui_filter_buffer (ptr_buffer, NULL);
+            gui_filter_scan_buffers_start[num_buffers] = count;
+            gui_filter_scan_buffers_flush (num_buffers);
+            count = 0;
+            num_buffers = 0;
+            gui_filter_buffer_job_start (ptr_buffer);
+            continue;
+        }
+
+        if ((num_buffers >= GUI_FILTER_SCAN_MAX_BUFFERS)
+            || (count + ptr_buffer->lines->lines_count
+                > GUI_FILTER_SCAN_MAX_LINES))
+        {
+            gui_filter_scan_buffers_start[num_buffers] = count;
+            gui_filter_scan_buffers_flush (num_buffers);
+            count = 0;
+            num_buffers = 0;
+        }
+
+        ptr_buffer->lines->filter_job_line = NULL;
+        gui_filter_scan_buffers[num_buffers] = ptr_buffer;
+        gui_filter_scan_buffers_start[num_buffers] = count;
+        num_buffers++;
+        for (ptr_line = ptr_buffer->lines->first_line;
+             ptr_line && (count < GUI_FILTER_SCAN_MAX_LINES);
+             ptr_line = ptr_line->next_line)
+        {
+            gui_filter_scan_lines[count++] = ptr_line->data;
         }
     }
+
+    gui_filter_scan_buffers_start[num_buffers] = count;
+    gui_filter_scan_buffers_flush (num_buffers);
 }
 
 /*
@@ -333,6 +839,9 @@ gui_filter_add_to_list (struct t_gui_filter *filter)
             gui_filters = filter;
         last_gui_filter = filter;
     }
+
+    /* cache of filters must be built again in all buffers */
+    gui_filters_generation++;
 }
 
 /*
@@ -350,6 +859,9 @@ gui_filter_remove_from_list (struct t_gui_filter *filter)
         gui_filters = filter->next_filter;
     if (last_gui_filter == filter)
         last_gui_filter = filter->prev_filter;
+
+    /* cache of filters must be built again in all buffers */
+    gui_filters_generation++;
 }
 
 /*
@@ -448,7 +960,7 @@ gui_filter_new (int enabled, const char *name, const char *buffer_name,
                     free (regex_prefix);
                     if (regex1)
                     {
-                        regfree (regex1);
+                        string_regfree (regex1);
                         free (regex1);
                     }
                     free (regex2);
@@ -477,6 +989,8 @@ gui_filter_new (int enabled, const char *name, const char *buffer_name,
             | WEECHAT_STRING_SPLIT_COLLAPSE_SEPS,
             0,
             &new_filter->num_buffers);
+        new_filter->buffers_masks = string_mask_compile_list (
+            (const char **)new_filter->buffers, 0);
         new_filter->tags = (tags) ? strdup (tags) : NULL;
         new_filter->tags_array = string_split_tags (new_filter->tags,
                                                     &new_filter->tags_count);
@@ -541,17 +1055,18 @@ gui_filter_free (struct t_gui_filter *filter)
     free (filter->name);
     free (filter->buffer_name);
     string_free_split (filter->buffers);
+    string_mask_free_list (filter->buffers_masks);
     free (filter->tags);
     string_free_split_tags (filter->tags_array);
     free (filter->regex);
     if (filter->regex_prefix)
     {
-        regfree (filter->regex_prefix);
+        string_regfree (filter->regex_prefix);
         free (filter->regex_prefix);
     }
     if (filter->regex_message)
     {
-        regfree (filter->regex_message);
+        string_regfree (filter->regex_message);
         free (filter->regex_message);
     }
 
@@ -598,6 +1113,7 @@ gui_filter_hdata_filter_cb (const void *pointer, void *data,
         HDATA_VAR(struct t_gui_filter, buffer_name, STRING, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_filter, num_buffers, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_filter, buffers, POINTER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_filter, buffers_masks, POINTER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_filter, tags, STRING, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_filter, tags_count, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_filter, tags_array, POINTER, 0, "*,tags_count", NULL);
@@ -679,6 +1195,7 @@ gui_filter_print_log ()
 
     log_printf ("");
     log_printf ("gui_filters_enabled = %d", gui_filters_enabled);
+    log_printf ("gui_filters_generation = %d", gui_filters_generation);
 
     for (ptr_filter = gui_filters; ptr_filter;
          ptr_filter = ptr_filter->next_filter)
@@ -694,6 +1211,7 @@ gui_filter_print_log ()
         {
             log_printf ("  buffers[%03d] . . . . . : '%s'", i, ptr_filter->buffers[i]);
         }
+        log_printf ("  buffers_masks. . . . . : %p", ptr_filter->buffers_masks);
         log_printf ("  tags . . . . . . . . . : '%s'", ptr_filter->tags);
         log_printf ("  regex. . . . . . . . . : '%s'", ptr_filter->regex);
         log_printf ("  regex_prefix . . . . . : %p", ptr_filter->regex_prefix);
@@ -24,9 +24,17 @@
 
 #define GUI_FILTER_TAG_NO_FILTER "no_filter"
 
+/* max lines/buffers checked at once (in threads if there are many lines) */
+#define GUI_FILTER_SCAN_MAX_LINES   16384
+#define GUI_FILTER_SCAN_MAX_BUFFERS 256
+
 /* filter structures */
 
+struct t_gui_buffer;
 struct t_gui_line_data;
+struct t_gui_lines;
+struct t_string_mask;
+struct t_hook;
 
 struct t_gui_filter
 {
@@ -35,6 +43,7 @@ struct t_gui_filter
     char *buffer_name;                 /* name of buffer(s)                 */
     int num_buffers;                   /* number of buffers in list         */
     char **buffers;                    /* list of buffer names              */
+    struct t_string_mask **buffers_masks; /* compiled buffer names         */
     char *tags;                        /* tags                              */
     int tags_count;                    /* number of tags                    */
     char ***tags_array;                /* array of tags                     */
@@ -50,12 +59,31 @@ struct t_gui_filter
 extern struct t_gui_filter *gui_filters;
 extern struct t_gui_filter *last_gui_filter;
 extern int gui_filters_enabled;
+extern int gui_filters_generation;
+extern struct t_hook *gui_filter_jobs_timer;
 
 /* filter functions */
 
+extern int gui_filter_match_buffer (struct t_gui_filter *filter,
+                                    struct t_gui_buffer *buffer);
+extern void gui_filter_buffer_cache_reset (struct t_gui_buffer *buffer);
+extern void gui_filter_buffer_cache_build (struct t_gui_buffer *buffer);
+extern int gui_filter_match_line (struct t_gui_filter *filter,
+                                  struct t_gui_line_data *line_data);
 extern int gui_filter_check_line (struct t_gui_line_data *line_data);
+extern void gui_filter_scan (int count);
+extern int gui_filter_scan_apply (int count, int *lines_hidden);
 extern void gui_filter_buffer (struct t_gui_buffer *buffer,
                                struct t_gui_line_data *line_data);
+extern void gui_filter_buffer_update (struct t_gui_buffer *buffer,
+                                      struct t_gui_lines *lines,
+                                      int lines_hidden, int lines_changed);
+extern int gui_filter_job_step (struct t_gui_buffer *buffer,
+                                struct t_gui_lines *lines,
+                                int max_lines);
+extern int gui_filter_jobs_step (int max_lines);
+extern void gui_filter_buffer_job_start (struct t_gui_buffer *buffer);
+extern void gui_filter_jobs_finish ();
 extern void gui_filter_all_buffers (struct t_gui_filter *filter);
 extern void gui_filter_global_enable ();
 extern void gui_filter_global_disable ();
@@ -28,9 +28,11 @@
 #include <stdio.h>
 #include <stddef.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "../core/weechat.h"
 #include "../core/core-config.h"
+#include "../core/core-dir.h"
 #include "../core/core-hashtable.h"
 #include "../core/core-hdata.h"
 #include "../core/core-hook.h"
@@ -39,6 +41,7 @@
 #include "../plugins/plugin.h"
 #include "gui-history.h"
 #include "gui-buffer.h"
+#include "gui-chat.h"
 #include "gui-input.h"
 
 
@@ -46,31 +49,90 @@ struct t_gui_history *gui_history = NULL;
 struct t_gui_history *last_gui_history = NULL;
 struct t_gui_history *gui_history_ptr = NULL;
 int num_gui_history = 0;
+struct t_hashtable *gui_history_index = NULL; /* text -> global history    */
+
+char **gui_history_file_pending = NULL;  /* entries to append to file       */
+struct t_hook *gui_history_file_timer = NULL; /* timer to write file        */
 
 
 /*
- * Removes oldest history entry in a buffer.
+ * Returns the history entry with a text (using the index of history, which
+ * is built on first call), NULL if not found.
  */
 
-void
-gui_history_buffer_remove_oldest (struct t_gui_buffer *buffer)
+struct t_gui_history *
+gui_history_index_search (struct t_hashtable **index,
+                          struct t_gui_history *last_history,
+                          const char *string)
 {
     struct t_gui_history *ptr_history;
 
-    if (buffer->text_search_ptr_history == buffer->last_history)
+    if (!*index)
+    {
+        *index = hashtable_new (32,
+                                WEECHAT_HASHTABLE_STRING,
+                                WEECHAT_HASHTABLE_POINTER,
+                                NULL, NULL);
+        if (!*index)
+            return NULL;
+        /* from oldest to most recent: most recent entry wins */
+        for (ptr_history = last_history; ptr_history;
+             ptr_history = ptr_history->prev_history)
+        {
+            hashtable_set (*index, ptr_history->text, ptr_history);
+        }
+    }
+
+    return hashtable_get (*index, string);
+}
+
+/*
+ * Removes an entry from the index of history (if the text is indexed with
+ * this entry).
+ */
+
+void
+gui_history_index_remove (struct t_hashtable *index,
+                          struct t_gui_history *history)
+{
+    if (index && history->text
+        && (hashtable_get (index, history->text) == history))
+    {
+        hashtable_remove (index, history->text);
+    }
+}
+
+/*
+ * Removes an entry in a buffer's history.
+ */
+
+void
+gui_history_buffer_remove (struct t_gui_buffer *buffer,
+                           struct t_gui_history *history)
+{
+    if (buffer->text_search_ptr_history == history)
     {
         buffer->text_search_ptr_history = NULL;
         buffer->text_search_found = 0;
         gui_input_search_signal (buffer);
     }
 
-    ptr_history = buffer->last_history->prev_history;
-    if (buffer->ptr_history == buffer->last_history)
-        buffer->ptr_history = ptr_history;
-    ((buffer->last_history)->prev_history)->next_history = NULL;
-    free (buffer->last_history->text);
-    free (buffer->last_history);
-    buffer->last_history = ptr_history;
+    if (buffer->ptr_history == history)
+        buffer->ptr_history = history->prev_history;
+
+    gui_history_index_remove (buffer->history_index, history);
+
+    if (history->prev_history)
+        (history->prev_history)->next_history = history->next_history;
+    else
+        buffer->history = history->next_history;
+    if (history->next_history)
+        (history->next_history)->prev_history = history->prev_history;
+    else
+        buffer->last_history = history->prev_history;
+
+    free (history->text);
+    free (history);
 
     buffer->num_history--;
 }
@@ -82,7 +144,7 @@ gui_history_buffer_remove_oldest (struct t_gui_buffer *buffer)
 void
 gui_history_buffer_add (struct t_gui_buffer *buffer, const char *string)
 {
-    struct t_gui_history *new_history;
+    struct t_gui_history *new_history, *ptr_history;
 
     if (!string)
         return;
@@ -91,6 +153,15 @@ gui_history_buffer_add (struct t_gui_buffer *buffer, const char *string)
         && (strcmp (buffer->history->text, string) == 0))
         return;
 
+    if (CONFIG_BOOLEAN(config_history_remove_duplicates))
+    {
+        ptr_history = gui_history_index_search (&buffer->history_index,
+                                                buffer->last_history,
+                                                string);
+        if (ptr_history)
+            gui_history_buffer_remove (buffer, ptr_history);
+    }
+
     new_history = malloc (sizeof (*new_history));
     if (new_history)
     {
@@ -103,31 +174,32 @@ gui_history_buffer_add (struct t_gui_buffer *buffer, const char *string)
         new_history->prev_history = NULL;
         buffer->history = new_history;
         buffer->num_history++;
+        if (buffer->history_index && new_history->text)
+            hashtable_set (buffer->history_index, new_history->text, new_history);
 
         /* remove one command if necessary */
         if ((CONFIG_INTEGER(config_history_max_commands) > 0)
             && (buffer->num_history > CONFIG_INTEGER(config_history_max_commands)))
         {
-            gui_history_buffer_remove_oldest (buffer);
+            gui_history_buffer_remove (buffer, buffer->last_history);
         }
     }
 }
 
 /*
- * Removes oldest global history entry.
+ * Removes an entry in global history.
  */
 
 void
-gui_history_global_remove_oldest ()
+gui_history_global_remove (struct t_gui_history *history)
 {
     struct t_gui_buffer *ptr_buffer;
-    struct t_gui_history *ptr_history;
 
-    /* ensure no buffer is using the last global history entry */
+    /* ensure no buffer is using the global history entry */
     for (ptr_buffer = gui_buffers; ptr_buffer;
          ptr_buffer = ptr_buffer->next_buffer)
     {
-        if (ptr_buffer->text_search_ptr_history == last_gui_history)
+        if (ptr_buffer->text_search_ptr_history == history)
         {
             ptr_buffer->text_search_ptr_history = NULL;
             ptr_buffer->text_search_found = 0;
@@ -135,13 +207,22 @@ gui_history_global_remove_oldest ()
         }
     }
 
-    ptr_history = last_gui_history->prev_history;
-    if (gui_history_ptr == last_gui_history)
-        gui_history_ptr = ptr_history;
-    (last_gui_history->prev_history)->next_history = NULL;
-    free (last_gui_history->text);
-    free (last_gui_history);
-    last_gui_history = ptr_history;
+    if (gui_history_ptr == history)
+        gui_history_ptr = history->prev_history;
+
+    gui_history_index_remove (gui_history_index, history);
+
+    if (history->prev_history)
+        (history->prev_history)->next_history = history->next_history;
+    else
+        gui_history = history->next_history;
+    if (history->next_history)
+        (history->next_history)->prev_history = history->prev_history;
+    else
+        last_gui_history = history->prev_history;
+
+    free (history->text);
+    free (history);
 
     num_gui_history--;
 }
@@ -153,7 +234,7 @@ gui_history_global_remove_oldest ()
 void
 gui_history_global_add (const char *string)
 {
-    struct t_gui_history *new_history;
+    struct t_gui_history *new_history, *ptr_history;
 
     if (!string)
         return;
@@ -161,6 +242,15 @@ gui_history_global_add (const char *string)
     if (gui_history && (strcmp (gui_history->text, string) == 0))
         return;
 
+    if (CONFIG_BOOLEAN(config_history_remove_duplicates))
+    {
+        ptr_history = gui_history_index_search (&gui_history_index,
+                                                last_gui_history,
+                                                string);
+        if (ptr_history)
+            gui_history_global_remove (ptr_history);
+    }
+
     new_history = malloc (sizeof (*new_history));
     if (new_history)
     {
@@ -173,16 +263,250 @@ gui_history_global_add (const char *string)
         new_history->prev_history = NULL;
         gui_history = new_history;
         num_gui_history++;
+        if (gui_history_index && new_history->text)
+            hashtable_set (gui_history_index, new_history->text, new_history);
 
         /* remove one command if necessary */
         if ((CONFIG_INTEGER(config_history_max_commands) > 0)
             && (num_gui_history > CONFIG_INTEGER(config_history_max_commands)))
         {
-            gui_history_global_remove_oldest ();
+            gui_history_global_remove (last_gui_history);
         }
     }
 }
 
+/*
+ * Returns the path of history file (evaluated), NULL if the history is not
+ * saved in a file.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+gui_history_file_get_path ()
+{
+    if (!CONFIG_STRING(config_history_file)
+        || !CONFIG_STRING(config_history_file)[0])
+    {
+        return NULL;
+    }
+
+    return string_eval_path_home (CONFIG_STRING(config_history_file),
+                                  NULL, NULL, NULL);
+}
+
+/*
+ * Escapes a history entry to write it on a single line in history file
+ * (backslashes and new lines are escaped).
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+gui_history_file_escape (const char *string)
+{
+    char **entry;
+
+    entry = string_dyn_alloc (64);
+    if (!entry)
+        return NULL;
+
+    for (; string[0]; string++)
+    {
+        if (string[0] == '\\')
+            string_dyn_concat (entry, "\\\\", -1);
+        else if (string[0] == '\n')
+            string_dyn_concat (entry, "\\n", -1);
+        else if (string[0] == '\r')
+            string_dyn_concat (entry, "\\r", -1);
+        else
+            string_dyn_concat (entry, string, 1);
+    }
+
+    return string_dyn_free (entry, 0);
+}
+
+/*
+ * Appends pending entries of global history to the history file.
+ */
+
+void
+gui_history_file_flush ()
+{
+    char *path;
+    FILE *file;
+
+    if (gui_history_file_timer)
+    {
+        unhook (gui_history_file_timer);
+        gui_history_file_timer = NULL;
+    }
+
+    if (!gui_history_file_pending || !(*gui_history_file_pending)[0])
+        return;
+
+    path = gui_history_file_get_path ();
+    if (path)
+    {
+        file = fopen (path, "a");
+        if (!file
+            || (fputs (*gui_history_file_pending, file) < 0)
+            || (fclose (file) != 0))
+        {
+            gui_chat_printf (NULL,
+                             _("%sError: unable to write history file \"%s\""),
+                             gui_chat_prefix[GUI_CHAT_PREFIX_ERROR],
+                             path);
+        }
+        free (path);
+    }
+
+    string_dyn_free (gui_history_file_pending, 1);
+    gui_history_file_pending = NULL;
+}
+
+/*
+ * Callback for timer writing pending entries in history file.
+ */
+
+int
+gui_history_file_timer_cb (const void *pointer, void *data,
+                           int remaining_calls)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) remaining_calls;
+
+    /* the timer is removed when it has been called */
+    gui_history_file_timer = NULL;
+
+    gui_history_file_flush ();
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Adds a text/command to the entries to append to history file.
+ *
+ * Entries are written by a timer (one second later), so that the file is
+ * not opened each time a command is sent.
+ */
+
+void
+gui_history_file_add (const char *string)
+{
+    char *entry;
+
+    if (!CONFIG_STRING(config_history_file)
+        || !CONFIG_STRING(config_history_file)[0])
+    {
+        return;
+    }
+
+    if (!gui_history_file_pending)
+    {
+        gui_history_file_pending = string_dyn_alloc (256);
+        if (!gui_history_file_pending)
+            return;
+    }
+
+    entry = gui_history_file_escape (string);
+    if (!entry)
+        return;
+    string_dyn_concat (gui_history_file_pending, entry, -1);
+    string_dyn_concat (gui_history_file_pending, "\n", -1);
+    free (entry);
+
+    if (!gui_history_file_timer)
+    {
+        gui_history_file_timer = hook_timer (NULL, 1000, 0, 1,
+                                             &gui_history_file_timer_cb,
+                                             NULL, NULL);
+    }
+}
+
+/*
+ * Reads history file and adds entries to global history.
+ *
+ * If the file has much more entries than the history can keep (twice the
+ * value of option weechat.history.max_commands), it is rewritten with only
+ * the entries kept in history.
+ */
+
+void
+gui_history_file_read ()
+{
+    struct t_gui_history *ptr_history;
+    char *path, *path_tmp, *content, *ptr_line, *pos_eol, *text, *entry;
+    FILE *file;
+    int count, rc;
+
+    path = gui_history_file_get_path ();
+    if (!path)
+        return;
+
+    content = dir_file_get_content (path);
+    if (!content)
+    {
+        free (path);
+        return;
+    }
+
+    count = 0;
+    ptr_line = content;
+    while (ptr_line[0])
+    {
+        pos_eol = strchr (ptr_line, '\n');
+        if (pos_eol)
+            pos_eol[0] = '\0';
+        if (ptr_line[0])
+        {
+            text = string_convert_escaped_chars (ptr_line);
+            if (text)
+            {
+                gui_history_global_add (text);
+                free (text);
+            }
+            count++;
+        }
+        if (!pos_eol)
+            break;
+        ptr_line = pos_eol + 1;
+    }
+    free (content);
+
+    /* compact the file if it has too many entries */
+    if ((CONFIG_INTEGER(config_history_max_commands) > 0)
+        && (count > 2 * CONFIG_INTEGER(config_history_max_commands)))
+    {
+        if (string_asprintf (&path_tmp, "%s.tmp", path) >= 0)
+        {
+            file = fopen (path_tmp, "w");
+            if (file)
+            {
+                rc = 1;
+                for (ptr_history = last_gui_history; ptr_history;
+                     ptr_history = ptr_history->prev_history)
+                {
+                    entry = gui_history_file_escape (ptr_history->text);
+                    rc &= (entry && (fputs (entry, file) >= 0)
+                           && (fputc ('\n', file) != EOF));
+                    free (entry);
+                }
+                if ((fclose (file) != 0) || !rc
+                    || (rename (path_tmp, path) != 0))
+                {
+                    unlink (path_tmp);
+                }
+            }
+            free (path_tmp);
+        }
+    }
+
+    free (path);
+}
+
 /*
  * Adds a text/command to buffer's history + global history.
  */
@@ -190,7 +514,9 @@ gui_history_global_add (const char *string)
 void
 gui_history_add (struct t_gui_buffer *buffer, const char *string)
 {
+    const char *ptr_string;
     char *string2, str_buffer[128];
+    int save;
 
     snprintf (str_buffer, sizeof (str_buffer), "0x%lx", (unsigned long)buffer);
     string2 = hook_modifier_exec (NULL, "history_add", str_buffer, string);
@@ -201,8 +527,13 @@ gui_history_add (struct t_gui_buffer *buffer, const char *string)
      */
     if (!string2 || string2[0])
     {
-        gui_history_buffer_add (buffer, (string2) ? string2 : string);
-        gui_history_global_add ((string2) ? string2 : string);
+        ptr_string = (string2) ? string2 : string;
+        /* consecutive duplicates are not saved in history file */
+        save = (!gui_history || (strcmp (gui_history->text, ptr_string) != 0));
+        gui_history_buffer_add (buffer, ptr_string);
+        gui_history_global_add (ptr_string);
+        if (save)
+            gui_history_file_add (ptr_string);
     }
 
     free (string2);
@@ -233,8 +564,8 @@ gui_history_search_text (struct t_gui_buffer *buffer,
     if (buffer->text_search_regex)
     {
         if (buffer->text_search_regex_compiled
-            && (regexec (buffer->text_search_regex_compiled,
-                         history->text, 0, NULL, 0) == 0))
+            && (string_regexec (buffer->text_search_regex_compiled,
+                                history->text, 0, NULL, 0) == 0))
         {
             rc = 1;
         }
@@ -304,6 +635,9 @@ gui_history_global_free ()
 {
     struct t_gui_history *ptr_history;
 
+    /* write pending entries in history file */
+    gui_history_file_flush ();
+
     while (gui_history)
     {
         ptr_history = gui_history->next_history;
@@ -315,6 +649,11 @@ gui_history_global_free ()
     last_gui_history = NULL;
     gui_history_ptr = NULL;
     num_gui_history = 0;
+    if (gui_history_index)
+    {
+        hashtable_free (gui_history_index);
+        gui_history_index = NULL;
+    }
 }
 
 
@@ -341,6 +680,11 @@ gui_history_buffer_free (struct t_gui_buffer *buffer)
     buffer->last_history = NULL;
     buffer->ptr_history = NULL;
     buffer->num_history = 0;
+    if (buffer->history_index)
+    {
+        hashtable_free (buffer->history_index);
+        buffer->history_index = NULL;
+    }
 }
 
 /*
@@ -372,6 +716,21 @@ gui_history_hdata_history_update_cb (void *data,
     {
         /* update history */
         ptr_history = (struct t_gui_history *)pointer;
+        /* the entry can be in global history or any buffer's history */
+        if (gui_history_index)
+        {
+            hashtable_free (gui_history_index);
+            gui_history_index = NULL;
+        }
+        for (ptr_buffer = gui_buffers; ptr_buffer;
+             ptr_buffer = ptr_buffer->next_buffer)
+        {
+            if (ptr_buffer->history_index)
+            {
+                hashtable_free (ptr_buffer->history_index);
+                ptr_buffer->history_index = NULL;
+            }
+        }
         free (ptr_history->text);
         ptr_history->text = strdup (text);
     }
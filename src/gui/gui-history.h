@@ -37,6 +37,8 @@ extern void gui_history_buffer_add (struct t_gui_buffer *buffer,
                                     const char *string);
 extern void gui_history_global_add (const char *string);
 extern void gui_history_add (struct t_gui_buffer *buffer, const char *string);
+extern void gui_history_file_flush ();
+extern void gui_history_file_read ();
 extern int gui_history_search (struct t_gui_buffer *buffer,
                                struct t_gui_history *history);
 extern void gui_history_global_free ();
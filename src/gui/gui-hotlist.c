@@ -54,6 +54,10 @@ struct t_hashtable *gui_hotlist_hashtable_add_conditions_options = NULL;
 int gui_add_hotlist = 1;                    /* 0 is for temporarily disable */
                                             /* hotlist add for all buffers  */
 
+/* sort fields (compiled from option weechat.look.hotlist_sort) */
+struct t_gui_hotlist_sort_field *gui_hotlist_sort_fields = NULL;
+int gui_hotlist_num_sort_fields = 0;
+
 char *gui_hotlist_priority_string[GUI_HOTLIST_NUM_PRIORITIES] =
 { "low", "message", "private", "highlight" };
 
@@ -227,6 +231,111 @@ gui_hotlist_check_buffer_notify (struct t_gui_buffer *buffer,
     return 1;
 }
 
+/*
+ * Sets fields used to sort hotlist (called when option
+ * "weechat.look.hotlist_sort" is changed).
+ *
+ * Each field is parsed once here (prefixes "-" and "~"), and the most common
+ * fields are compared directly, without hdata (which is much slower, as it
+ * is called multiple times for each hotlist added).
+ *
+ * If fields is NULL, the sort fields are freed.
+ */
+
+void
+gui_hotlist_set_sort_fields (char **fields, int num_fields)
+{
+    struct {
+        const char *name;
+        enum t_gui_hotlist_sort_var var;
+    } fast_vars[] = {
+        { "priority", GUI_HOTLIST_SORT_VAR_PRIORITY },
+        { "time", GUI_HOTLIST_SORT_VAR_TIME },
+        { "time_usec", GUI_HOTLIST_SORT_VAR_TIME_USEC },
+        { "buffer.number", GUI_HOTLIST_SORT_VAR_BUFFER_NUMBER },
+        { "buffer.name", GUI_HOTLIST_SORT_VAR_BUFFER_NAME },
+        { "buffer.full_name", GUI_HOTLIST_SORT_VAR_BUFFER_FULL_NAME },
+        { "buffer.short_name", GUI_HOTLIST_SORT_VAR_BUFFER_SHORT_NAME },
+        { NULL, GUI_HOTLIST_SORT_VAR_HDATA },
+    };
+    struct t_gui_hotlist_sort_field *ptr_sort_field;
+    const char *ptr_field;
+    int i, j;
+
+    for (i = 0; i < gui_hotlist_num_sort_fields; i++)
+    {
+        free ((char *)gui_hotlist_sort_fields[i].name);
+    }
+    free (gui_hotlist_sort_fields);
+    gui_hotlist_sort_fields = NULL;
+    gui_hotlist_num_sort_fields = 0;
+
+    if (!fields || (num_fields <= 0))
+        return;
+
+    gui_hotlist_sort_fields = malloc (
+        num_fields * sizeof (*gui_hotlist_sort_fields));
+    if (!gui_hotlist_sort_fields)
+        return;
+
+    for (i = 0; i < num_fields; i++)
+    {
+        ptr_sort_field = &gui_hotlist_sort_fields[gui_hotlist_num_sort_fields];
+        ptr_sort_field->reverse = 1;
+        ptr_sort_field->case_sensitive = 1;
+        ptr_field = fields[i];
+        while ((ptr_field[0] == '-') || (ptr_field[0] == '~'))
+        {
+            if (ptr_field[0] == '-')
+                ptr_sort_field->reverse *= -1;
+            else if (ptr_field[0] == '~')
+                ptr_sort_field->case_sensitive ^= 1;
+            ptr_field++;
+        }
+        ptr_sort_field->name = strdup (ptr_field);
+        if (!ptr_sort_field->name)
+            continue;
+        ptr_sort_field->var = GUI_HOTLIST_SORT_VAR_HDATA;
+        for (j = 0; fast_vars[j].name; j++)
+        {
+            if (strcmp (ptr_field, fast_vars[j].name) == 0)
+            {
+                ptr_sort_field->var = fast_vars[j].var;
+                break;
+            }
+        }
+        gui_hotlist_num_sort_fields++;
+    }
+}
+
+/*
+ * Compares two strings (that can be NULL) for hotlist sort.
+ *
+ * Returns:
+ *   -1: string1 < string2
+ *    0: string1 == string2
+ *    1: string1 > string2
+ */
+
+int
+gui_hotlist_compare_strings (const char *string1, const char *string2,
+                             int case_sensitive)
+{
+    int rc;
+
+    if (!string1 && !string2)
+        return 0;
+    if (string1 && !string2)
+        return 1;
+    if (!string1 && string2)
+        return -1;
+
+    rc = (case_sensitive) ?
+        strcmp (string1, string2) : string_strcasecmp (string1, string2);
+
+    return (rc < 0) ? -1 : ((rc > 0) ? 1 : 0);
+}
+
 /*
  * Compares two hotlists in order to add them in the sorted list.
  *
@@ -244,37 +353,81 @@ gui_hotlist_compare_hotlists (struct t_hdata *hdata_hotlist,
                               struct t_gui_hotlist *hotlist1,
                               struct t_gui_hotlist *hotlist2)
 {
-    int i, reverse, case_sensitive, rc;
-    const char *ptr_field;
+    struct t_gui_hotlist_sort_field *ptr_sort_field;
+    struct t_gui_buffer *buffer1, *buffer2;
+    int i, rc;
+
+    if (!hotlist1 && !hotlist2)
+        return 0;
+    if (hotlist1 && !hotlist2)
+        return (gui_hotlist_num_sort_fields > 0) ?
+            gui_hotlist_sort_fields[0].reverse : 0;
+    if (!hotlist1 && hotlist2)
+        return (gui_hotlist_num_sort_fields > 0) ?
+            gui_hotlist_sort_fields[0].reverse * -1 : 0;
+
+    buffer1 = hotlist1->buffer;
+    buffer2 = hotlist2->buffer;
 
-    for (i = 0; i < config_num_hotlist_sort_fields; i++)
+    for (i = 0; i < gui_hotlist_num_sort_fields; i++)
     {
-        rc = 0;
-        reverse = 1;
-        case_sensitive = 1;
-        ptr_field = config_hotlist_sort_fields[i];
-        while ((ptr_field[0] == '-') || (ptr_field[0] == '~'))
+        ptr_sort_field = &gui_hotlist_sort_fields[i];
+        if ((ptr_sort_field->var >= GUI_HOTLIST_SORT_VAR_BUFFER_NUMBER)
+            && (!buffer1 || !buffer2))
         {
-            if (ptr_field[0] == '-')
-                reverse *= -1;
-            else if (ptr_field[0] == '~')
-                case_sensitive ^= 1;
-            ptr_field++;
+            rc = (buffer1) ? 1 : ((buffer2) ? -1 : 0);
         }
-        if (!hotlist1 && !hotlist2)
-            rc = 0;
-        else if (hotlist1 && !hotlist2)
-            rc = 1;
-        else if (!hotlist1 && hotlist2)
-            rc = -1;
         else
         {
-            rc = hdata_compare (hdata_hotlist,
-                                hotlist1, hotlist2,
-                                ptr_field,
-                                case_sensitive);
+            switch (ptr_sort_field->var)
+            {
+                case GUI_HOTLIST_SORT_VAR_PRIORITY:
+                    rc = (hotlist1->priority < hotlist2->priority) ?
+                        -1 : ((hotlist1->priority > hotlist2->priority) ?
+                              1 : 0);
+                    break;
+                case GUI_HOTLIST_SORT_VAR_TIME:
+                    rc = (hotlist1->creation_time.tv_sec
+                          < hotlist2->creation_time.tv_sec) ?
+                        -1 : ((hotlist1->creation_time.tv_sec
+                               > hotlist2->creation_time.tv_sec) ? 1 : 0);
+                    break;
+                case GUI_HOTLIST_SORT_VAR_TIME_USEC:
+                    rc = (hotlist1->creation_time.tv_usec
+                          < hotlist2->creation_time.tv_usec) ?
+                        -1 : ((hotlist1->creation_time.tv_usec
+                               > hotlist2->creation_time.tv_usec) ? 1 : 0);
+                    break;
+                case GUI_HOTLIST_SORT_VAR_BUFFER_NUMBER:
+                    rc = (buffer1->number < buffer2->number) ?
+                        -1 : ((buffer1->number > buffer2->number) ? 1 : 0);
+                    break;
+                case GUI_HOTLIST_SORT_VAR_BUFFER_NAME:
+                    rc = gui_hotlist_compare_strings (
+                        buffer1->name, buffer2->name,
+                        ptr_sort_field->case_sensitive);
+                    break;
+                case GUI_HOTLIST_SORT_VAR_BUFFER_FULL_NAME:
+                    rc = gui_hotlist_compare_strings (
+                        buffer1->full_name, buffer2->full_name,
+                        ptr_sort_field->case_sensitive);
+                    break;
+                case GUI_HOTLIST_SORT_VAR_BUFFER_SHORT_NAME:
+                    rc = gui_hotlist_compare_strings (
+                        buffer1->short_name, buffer2->short_name,
+                        ptr_sort_field->case_sensitive);
+                    break;
+                default:
+                    if (!hdata_hotlist)
+                        hdata_hotlist = hook_hdata_get (NULL, "hotlist");
+                    rc = hdata_compare (hdata_hotlist,
+                                        hotlist1, hotlist2,
+                                        ptr_sort_field->name,
+                                        ptr_sort_field->case_sensitive);
+                    break;
+            }
         }
-        rc *= reverse;
+        rc *= ptr_sort_field->reverse;
         if (rc != 0)
             return rc;
     }
@@ -284,27 +437,31 @@ gui_hotlist_compare_hotlists (struct t_hdata *hdata_hotlist,
 
 /*
  * Searches for position of hotlist (to keep hotlist sorted).
+ *
+ * The hotlist is searched from the end (argument "last_hotlist"), so that
+ * adding a hotlist after all others (most common case with default sort,
+ * by time) is immediate.
+ *
+ * Returns pointer to the hotlist before which the new hotlist must be
+ * inserted, NULL if the new hotlist must be added at the end.
  */
 
 struct t_gui_hotlist *
-gui_hotlist_find_pos (struct t_gui_hotlist *hotlist,
+gui_hotlist_find_pos (struct t_gui_hotlist *last_hotlist,
                       struct t_gui_hotlist *new_hotlist)
 {
-    struct t_hdata *hdata_hotlist;
-    struct t_gui_hotlist *ptr_hotlist;
+    struct t_gui_hotlist *ptr_hotlist, *pos_hotlist;
 
-    hdata_hotlist = hook_hdata_get (NULL, "hotlist");
-    for (ptr_hotlist = hotlist; ptr_hotlist;
-         ptr_hotlist = ptr_hotlist->next_hotlist)
+    pos_hotlist = NULL;
+    for (ptr_hotlist = last_hotlist; ptr_hotlist;
+         ptr_hotlist = ptr_hotlist->prev_hotlist)
     {
-        if (gui_hotlist_compare_hotlists (hdata_hotlist,
-                                          new_hotlist, ptr_hotlist) < 0)
-        {
-            return ptr_hotlist;
-        }
+        if (gui_hotlist_compare_hotlists (NULL, new_hotlist, ptr_hotlist) >= 0)
+            break;
+        pos_hotlist = ptr_hotlist;
     }
 
-    return NULL;
+    return pos_hotlist;
 }
 
 /*
@@ -320,7 +477,7 @@ gui_hotlist_add_hotlist (struct t_gui_hotlist **hotlist,
 
     if (*hotlist)
     {
-        pos_hotlist = gui_hotlist_find_pos (*hotlist, new_hotlist);
+        pos_hotlist = gui_hotlist_find_pos (*last_hotlist, new_hotlist);
 
         if (pos_hotlist)
         {
@@ -352,7 +509,7 @@ gui_hotlist_add_hotlist (struct t_gui_hotlist **hotlist,
 }
 
 /*
- * Adds a buffer to hotlist, with priority.
+ * Adds a buffer to hotlist, with priority, for "count" messages.
  *
  * If creation_time is NULL, current time is used.
  *
@@ -361,16 +518,17 @@ gui_hotlist_add_hotlist (struct t_gui_hotlist **hotlist,
  */
 
 struct t_gui_hotlist *
-gui_hotlist_add (struct t_gui_buffer *buffer,
-                 enum t_gui_hotlist_priority priority,
-                 struct timeval *creation_time,
-                 int check_conditions)
+gui_hotlist_add_count (struct t_gui_buffer *buffer,
+                       enum t_gui_hotlist_priority priority,
+                       struct timeval *creation_time,
+                       int check_conditions,
+                       int count_messages)
 {
     struct t_gui_hotlist *new_hotlist, *ptr_hotlist;
     int i, count[GUI_HOTLIST_NUM_PRIORITIES], rc;
     char *value, str_value[32];
 
-    if (!buffer || !gui_add_hotlist)
+    if (!buffer || !gui_add_hotlist || (count_messages < 1))
         return NULL;
 
     /* do not add core buffer if upgrading */
@@ -453,7 +611,7 @@ gui_hotlist_add (struct t_gui_buffer *buffer,
         /* return if priority is greater or equal than the one to add */
         if (ptr_hotlist->priority >= priority)
         {
-            ptr_hotlist->count[priority]++;
+            ptr_hotlist->count[priority] += count_messages;
             gui_hotlist_changed_signal (buffer);
             return ptr_hotlist;
         }
@@ -481,7 +639,7 @@ gui_hotlist_add (struct t_gui_buffer *buffer,
     new_hotlist->buffer = buffer;
     buffer->hotlist = new_hotlist;
     memcpy (new_hotlist->count, count, sizeof (new_hotlist->count));
-    new_hotlist->count[priority]++;
+    new_hotlist->count[priority] += count_messages;
     new_hotlist->next_hotlist = NULL;
     new_hotlist->prev_hotlist = NULL;
 
@@ -492,6 +650,25 @@ gui_hotlist_add (struct t_gui_buffer *buffer,
     return new_hotlist;
 }
 
+/*
+ * Adds a buffer to hotlist, with priority.
+ *
+ * If creation_time is NULL, current time is used.
+ *
+ * Returns pointer to hotlist created or changed, NULL if no hotlist was
+ * created/changed.
+ */
+
+struct t_gui_hotlist *
+gui_hotlist_add (struct t_gui_buffer *buffer,
+                 enum t_gui_hotlist_priority priority,
+                 struct timeval *creation_time,
+                 int check_conditions)
+{
+    return gui_hotlist_add_count (buffer, priority, creation_time,
+                                  check_conditions, 1);
+}
+
 /*
  * Restores a hotlist that was removed from a buffer.
  */
@@ -543,35 +720,91 @@ gui_hotlist_restore_all_buffers ()
 void
 gui_hotlist_resort ()
 {
-    struct t_gui_hotlist *new_hotlist, *last_new_hotlist;
-    struct t_gui_hotlist *ptr_hotlist, *ptr_next_hotlist, *ptr_prev_hotlist;
-    int hotlist_changed;
+    struct t_gui_hotlist *ptr_hotlist, *list1, *list2;
+    struct t_gui_hotlist *merged, *last_merged, *ptr_prev_hotlist, *ptr_next;
+    int size, num_merges, size1, size2;
 
     /* sort is not needed if hotlist has less than 2 entries */
     if (!gui_hotlist || !gui_hotlist->next_hotlist)
         return;
 
-    /* resort hotlist in new linked list */
-    hotlist_changed = 0;
-    new_hotlist = NULL;
-    last_new_hotlist = NULL;
-    ptr_hotlist = gui_hotlist;
-    while (ptr_hotlist)
+    /* nothing to do if the hotlist is already sorted */
+    for (ptr_hotlist = gui_hotlist; ptr_hotlist->next_hotlist;
+         ptr_hotlist = ptr_hotlist->next_hotlist)
     {
-        ptr_next_hotlist = ptr_hotlist->next_hotlist;
-        ptr_prev_hotlist = ptr_hotlist->prev_hotlist;
-        gui_hotlist_add_hotlist (&new_hotlist, &last_new_hotlist, ptr_hotlist);
-        if (ptr_hotlist->prev_hotlist != ptr_prev_hotlist)
-            hotlist_changed = 1;
-        ptr_hotlist = ptr_next_hotlist;
+        if (gui_hotlist_compare_hotlists (NULL, ptr_hotlist,
+                                          ptr_hotlist->next_hotlist) > 0)
+            break;
+    }
+    if (!ptr_hotlist->next_hotlist)
+        return;
+
+    /*
+     * bottom-up merge sort of the linked list (stable: hotlists with the
+     * same sort keys keep their relative order)
+     */
+    merged = gui_hotlist;
+    size = 1;
+    while (1)
+    {
+        list1 = merged;
+        merged = NULL;
+        last_merged = NULL;
+        num_merges = 0;
+        while (list1)
+        {
+            num_merges++;
+            list2 = list1;
+            for (size1 = 0; list2 && (size1 < size); size1++)
+            {
+                list2 = list2->next_hotlist;
+            }
+            size2 = size;
+            while ((size1 > 0) || ((size2 > 0) && list2))
+            {
+                if ((size1 == 0)
+                    || ((size2 > 0) && list2
+                        && (gui_hotlist_compare_hotlists (NULL,
+                                                          list1, list2) > 0)))
+                {
+                    ptr_hotlist = list2;
+                    list2 = list2->next_hotlist;
+                    size2--;
+                }
+                else
+                {
+                    ptr_hotlist = list1;
+                    list1 = list1->next_hotlist;
+                    size1--;
+                }
+                if (last_merged)
+                    last_merged->next_hotlist = ptr_hotlist;
+                else
+                    merged = ptr_hotlist;
+                last_merged = ptr_hotlist;
+            }
+            list1 = list2;
+        }
+        last_merged->next_hotlist = NULL;
+        if (num_merges <= 1)
+            break;
+        size *= 2;
+    }
+
+    /* rebuild links to previous hotlists */
+    ptr_prev_hotlist = NULL;
+    for (ptr_hotlist = merged; ptr_hotlist; ptr_hotlist = ptr_next)
+    {
+        ptr_next = ptr_hotlist->next_hotlist;
+        ptr_hotlist->prev_hotlist = ptr_prev_hotlist;
+        ptr_prev_hotlist = ptr_hotlist;
     }
 
     /* switch to new sorted hotlist */
-    gui_hotlist = new_hotlist;
-    last_gui_hotlist = last_new_hotlist;
+    gui_hotlist = merged;
+    last_gui_hotlist = ptr_prev_hotlist;
 
-    if (hotlist_changed)
-        gui_hotlist_changed_signal (NULL);
+    gui_hotlist_changed_signal (NULL);
 }
 
 /*
@@ -38,6 +38,26 @@ enum t_gui_hotlist_priority
 
 #define GUI_HOTLIST_MASK_MAX ((1 << GUI_HOTLIST_NUM_PRIORITIES) - 1)
 
+enum t_gui_hotlist_sort_var
+{
+    GUI_HOTLIST_SORT_VAR_HDATA = 0,        /* any var (with hdata_compare)  */
+    GUI_HOTLIST_SORT_VAR_PRIORITY,
+    GUI_HOTLIST_SORT_VAR_TIME,
+    GUI_HOTLIST_SORT_VAR_TIME_USEC,
+    GUI_HOTLIST_SORT_VAR_BUFFER_NUMBER,
+    GUI_HOTLIST_SORT_VAR_BUFFER_NAME,
+    GUI_HOTLIST_SORT_VAR_BUFFER_FULL_NAME,
+    GUI_HOTLIST_SORT_VAR_BUFFER_SHORT_NAME,
+};
+
+struct t_gui_hotlist_sort_field
+{
+    enum t_gui_hotlist_sort_var var;       /* variable to compare           */
+    const char *name;                      /* name of var (for hdata)       */
+    int reverse;                           /* 1 = normal, -1 = reverse      */
+    int case_sensitive;                    /* 1 = case sensitive (strings)  */
+};
+
 struct t_gui_hotlist
 {
     enum t_gui_hotlist_priority priority;  /* 0=crappy msg (join/part),     */
@@ -59,12 +79,18 @@ extern int gui_add_hotlist;
 /* hotlist functions */
 
 extern int gui_hotlist_search_priority (const char *priority);
+extern struct t_gui_hotlist *gui_hotlist_add_count (struct t_gui_buffer *buffer,
+                                                    enum t_gui_hotlist_priority priority,
+                                                    struct timeval *creation_time,
+                                                    int check_conditions,
+                                                    int count_messages);
 extern struct t_gui_hotlist *gui_hotlist_add (struct t_gui_buffer *buffer,
                                               enum t_gui_hotlist_priority priority,
                                               struct timeval *creation_time,
                                               int check_conditions);
 extern void gui_hotlist_restore_buffer (struct t_gui_buffer *buffer);
 extern void gui_hotlist_restore_all_buffers ();
+extern void gui_hotlist_set_sort_fields (char **fields, int num_fields);
 extern void gui_hotlist_resort ();
 extern void gui_hotlist_clear (int level_mask);
 extern void gui_hotlist_clear_level_string (struct t_gui_buffer *buffer,
@@ -602,7 +602,7 @@ gui_input_search_compile_regex (struct t_gui_buffer *buffer)
     /* remove the compiled regex */
     if (buffer->text_search_regex_compiled)
     {
-        regfree (buffer->text_search_regex_compiled);
+        string_regfree (buffer->text_search_regex_compiled);
         free (buffer->text_search_regex_compiled);
         buffer->text_search_regex_compiled = NULL;
     }
@@ -65,6 +65,16 @@ struct t_gui_key *last_gui_default_key[GUI_KEY_NUM_CONTEXTS];
 int gui_keys_count[GUI_KEY_NUM_CONTEXTS];            /* keys number         */
 int gui_default_keys_count[GUI_KEY_NUM_CONTEXTS];    /* default keys number */
 
+/*
+ * index of keys by context (for keys with a command), built on first key
+ * pressed and freed when keys are added/removed:
+ *   - exact: key chunks joined with "," -> key
+ *   - partial: first chunks of keys joined with "," -> first key (in list
+ *     order) with more chunks
+ */
+struct t_hashtable *gui_key_index_exact[GUI_KEY_NUM_CONTEXTS];
+struct t_hashtable *gui_key_index_partial[GUI_KEY_NUM_CONTEXTS];
+
 char *gui_key_context_string[GUI_KEY_NUM_CONTEXTS] =
 { "default", "search", "histsearch", "cursor", "mouse" };
 
@@ -136,6 +146,7 @@ gui_key_init ()
         gui_keys[context] = NULL;
         last_gui_key[context] = NULL;
         gui_keys_count[context] = 0;
+        gui_key_index_free (context);
     }
 }
 
@@ -990,6 +1001,149 @@ gui_key_fix (const char *key)
     return string_dyn_free (result, 0);
 }
 
+/*
+ * Frees index of keys for a context.
+ */
+
+void
+gui_key_index_free (int context)
+{
+    if (gui_key_index_exact[context])
+    {
+        hashtable_free (gui_key_index_exact[context]);
+        gui_key_index_exact[context] = NULL;
+    }
+    if (gui_key_index_partial[context])
+    {
+        hashtable_free (gui_key_index_partial[context]);
+        gui_key_index_partial[context] = NULL;
+    }
+}
+
+/*
+ * Frees index of keys if the list of keys is the list of a context
+ * (keys of buffers are not indexed).
+ */
+
+void
+gui_key_index_invalidate (struct t_gui_key **keys)
+{
+    int context;
+
+    for (context = 0; context < GUI_KEY_NUM_CONTEXTS; context++)
+    {
+        if (keys == &gui_keys[context])
+        {
+            gui_key_index_free (context);
+            break;
+        }
+    }
+}
+
+/*
+ * Builds index of keys for a context.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+gui_key_index_build (int context)
+{
+    struct t_gui_key *ptr_key;
+    char *prefix;
+    int i;
+
+    gui_key_index_exact[context] = hashtable_new (
+        256,
+        WEECHAT_HASHTABLE_STRING,
+        WEECHAT_HASHTABLE_POINTER,
+        NULL, NULL);
+    gui_key_index_partial[context] = hashtable_new (
+        256,
+        WEECHAT_HASHTABLE_STRING,
+        WEECHAT_HASHTABLE_POINTER,
+        NULL, NULL);
+    if (!gui_key_index_exact[context] || !gui_key_index_partial[context])
+    {
+        gui_key_index_free (context);
+        return 0;
+    }
+
+    for (ptr_key = gui_keys[context]; ptr_key; ptr_key = ptr_key->next_key)
+    {
+        /* ignore keys with no command */
+        if (!ptr_key->command || !ptr_key->command[0])
+            continue;
+        if (!ptr_key->key || !ptr_key->chunks
+            || ((context == GUI_KEY_CONTEXT_CURSOR)
+                && (ptr_key->key[0] == '@')))
+        {
+            continue;
+        }
+        for (i = 1; i <= ptr_key->chunks_count; i++)
+        {
+            prefix = string_rebuild_split_string (
+                (const char **)ptr_key->chunks, ",", 0, i - 1);
+            if (!prefix)
+                continue;
+            if (i == ptr_key->chunks_count)
+            {
+                if (!hashtable_has_key (gui_key_index_exact[context], prefix))
+                {
+                    hashtable_set (gui_key_index_exact[context],
+                                   prefix, ptr_key);
+                }
+            }
+            else if (!hashtable_has_key (gui_key_index_partial[context],
+                                         prefix))
+            {
+                hashtable_set (gui_key_index_partial[context],
+                               prefix, ptr_key);
+            }
+            free (prefix);
+        }
+    }
+
+    return 1;
+}
+
+/*
+ * Searches key chunks in index of keys for a context.
+ *
+ * Returns pointer to key found (exact match has priority over partial
+ * match), NULL if not found.
+ * In case of exact match, *exact_match is set to 1, otherwise 0.
+ */
+
+struct t_gui_key *
+gui_key_index_search (int context, const char **chunks, int chunks_count,
+                      int *exact_match)
+{
+    struct t_gui_key *ptr_key;
+    char *key;
+
+    *exact_match = 0;
+
+    if (!chunks || (chunks_count < 1))
+        return NULL;
+
+    key = string_rebuild_split_string (chunks, ",", 0, chunks_count - 1);
+    if (!key)
+        return NULL;
+
+    ptr_key = hashtable_get (gui_key_index_exact[context], key);
+    if (ptr_key)
+        *exact_match = 1;
+    else
+        ptr_key = hashtable_get (gui_key_index_partial[context], key);
+
+    free (key);
+
+    return ptr_key;
+}
+
 /*
  * Searches for position of a key (to keep keys sorted).
  */
@@ -1023,6 +1177,8 @@ gui_key_insert_sorted (struct t_gui_key **keys,
 {
     struct t_gui_key *pos_key;
 
+    gui_key_index_invalidate (keys);
+
     if (*keys)
     {
         pos_key = gui_key_find_pos (*keys, key);
@@ -1411,6 +1567,8 @@ gui_key_option_change_cb (const void *pointer, void *data,
 
     free (ptr_key->command);
     ptr_key->command = strdup (CONFIG_STRING(option));
+
+    gui_key_index_free (context);
 }
 
 /*
@@ -1642,6 +1800,22 @@ gui_key_search_part (struct t_gui_buffer *buffer, int context,
     if ((!chunks1 && !chunks2) || !exact_match)
         return NULL;
 
+    /* keys of context: use the index (built on first call) */
+    if (!buffer
+        && (gui_key_index_exact[context]
+            || gui_key_index_build (context)))
+    {
+        key1_found = gui_key_index_search (context, chunks1, chunks1_count,
+                                           &rc1);
+        if (key1_found)
+        {
+            *exact_match = rc1;
+            return key1_found;
+        }
+        return gui_key_index_search (context, chunks2, chunks2_count,
+                                     exact_match);
+    }
+
     key1_found = NULL;
     key2_found = NULL;
     rc1 = 0;
@@ -1954,10 +2128,9 @@ gui_key_unbind_plugin (const char *context, const char *key)
 
 int
 gui_key_focus_matching (struct t_gui_key *key,
-                        struct t_hashtable **hashtable_focus)
+                        struct t_gui_focus_info **focus_info)
 {
     int match[2], area;
-    const char *chat, *buffer_full_name, *bar_name, *bar_item_name;
 
     for (area = 0; area < 2; area++)
     {
@@ -1968,29 +2141,33 @@ gui_key_focus_matching (struct t_gui_key *key,
                 match[area] = 1;
                 break;
             case GUI_KEY_FOCUS_CHAT:
-                chat = hashtable_get (hashtable_focus[area], "_chat");
-                buffer_full_name = hashtable_get (hashtable_focus[area],
-                                                  "_buffer_full_name");
-                if (chat && (strcmp (chat, "1") == 0)
-                    && buffer_full_name && buffer_full_name[0])
+                if (focus_info[area]
+                    && focus_info[area]->chat
+                    && focus_info[area]->buffer
+                    && focus_info[area]->buffer->full_name
+                    && focus_info[area]->buffer->full_name[0]
+                    && string_match (focus_info[area]->buffer->full_name,
+                                     key->area_name[area], 0))
                 {
-                    if (string_match (buffer_full_name, key->area_name[area], 0))
-                        match[area] = 1;
+                    match[area] = 1;
                 }
                 break;
             case GUI_KEY_FOCUS_BAR:
-                bar_name = hashtable_get (hashtable_focus[area], "_bar_name");
-                if (bar_name && bar_name[0]
-                    && (string_match (bar_name, key->area_name[area], 0)))
+                if (focus_info[area]
+                    && focus_info[area]->bar_window
+                    && focus_info[area]->bar_window->bar->name[0]
+                    && string_match (focus_info[area]->bar_window->bar->name,
+                                     key->area_name[area], 0))
                 {
                     match[area] = 1;
                 }
                 break;
             case GUI_KEY_FOCUS_ITEM:
-                bar_item_name = hashtable_get (hashtable_focus[area],
-                                               "_bar_item_name");
-                if (bar_item_name && bar_item_name[0]
-                    && (string_match (bar_item_name, key->area_name[area], 0)))
+                if (focus_info[area]
+                    && focus_info[area]->bar_item
+                    && focus_info[area]->bar_item[0]
+                    && string_match (focus_info[area]->bar_item,
+                                     key->area_name[area], 0))
                 {
                     match[area] = 1;
                 }
@@ -2003,6 +2180,35 @@ gui_key_focus_matching (struct t_gui_key *key,
     return match[0] && match[1];
 }
 
+/*
+ * Builds focus hashtables with focus info (only if not already built).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+gui_key_focus_build_hashtables (const char *key,
+                                struct t_gui_focus_info **focus_info,
+                                struct t_hashtable **hashtable_focus)
+{
+    int area;
+
+    for (area = 0; area < 2; area++)
+    {
+        if (focus_info[area] && !hashtable_focus[area])
+        {
+            hashtable_focus[area] = gui_focus_to_hashtable (focus_info[area],
+                                                            key);
+            if (!hashtable_focus[area])
+                return 0;
+        }
+    }
+
+    return 1;
+}
+
 /*
  * Displays focus hashtable (for debug).
  */
@@ -2038,15 +2244,21 @@ gui_key_focus_display_hashtable (struct t_hashtable *hashtable)
 
 int
 gui_key_focus_command (const char *key, int context,
-                       struct t_hashtable **hashtable_focus)
+                       struct t_gui_focus_info **focus_info)
 {
     struct t_gui_key *ptr_key;
-    int i, matching, debug, rc;
+    int i, matching, debug, rc, executed;
     char *command, **commands;
     const char *str_buffer;
-    struct t_hashtable *hashtable;
+    struct t_hashtable *hashtable, *hashtable_focus[2];
     struct t_gui_buffer *ptr_buffer;
 
+    executed = 0;
+
+    /* hashtables are built only if a key is matching the focus */
+    hashtable_focus[0] = NULL;
+    hashtable_focus[1] = NULL;
+
     debug = 0;
     if (gui_cursor_debug && (context == GUI_KEY_CONTEXT_CURSOR))
         debug = gui_cursor_debug;
@@ -2085,10 +2297,13 @@ gui_key_focus_command (const char *key, int context,
             continue;
 
         /* check if focus is matching with key */
-        matching = gui_key_focus_matching (ptr_key, hashtable_focus);
+        matching = gui_key_focus_matching (ptr_key, focus_info);
         if (!matching)
             continue;
 
+        if (!gui_key_focus_build_hashtables (key, focus_info, hashtable_focus))
+            break;
+
         hashtable = hook_focus_get_data (hashtable_focus[0],
                                          hashtable_focus[1]);
         if (!hashtable)
@@ -2162,10 +2377,12 @@ gui_key_focus_command (const char *key, int context,
             }
         }
         hashtable_free (hashtable);
-        return 1;
+        executed = 1;
+        break;
     }
 
-    if (debug > 1)
+    if (!executed && (debug > 1)
+        && gui_key_focus_build_hashtables (key, focus_info, hashtable_focus))
     {
         hashtable = hook_focus_get_data (hashtable_focus[0],
                                          hashtable_focus[1]);
@@ -2176,7 +2393,10 @@ gui_key_focus_command (const char *key, int context,
         }
     }
 
-    return 0;
+    hashtable_free (hashtable_focus[0]);
+    hashtable_free (hashtable_focus[1]);
+
+    return executed;
 }
 
 /*
@@ -2191,34 +2411,25 @@ gui_key_focus_command (const char *key, int context,
 int
 gui_key_focus (const char *key, int context)
 {
-    struct t_gui_focus_info *focus_info1, *focus_info2;
-    struct t_hashtable *hashtable_focus[2];
+    struct t_gui_focus_info *focus_info[2];
     int rc;
 
     rc = 0;
-    focus_info1 = NULL;
-    focus_info2 = NULL;
-    hashtable_focus[0] = NULL;
-    hashtable_focus[1] = NULL;
+    focus_info[0] = NULL;
+    focus_info[1] = NULL;
 
     if (context == GUI_KEY_CONTEXT_MOUSE)
     {
-        focus_info1 = gui_focus_get_info (gui_mouse_event_x[0],
-                                          gui_mouse_event_y[0]);
-        if (!focus_info1)
-            goto end;
-        hashtable_focus[0] = gui_focus_to_hashtable (focus_info1, key);
-        if (!hashtable_focus[0])
+        focus_info[0] = gui_focus_get_info (gui_mouse_event_x[0],
+                                            gui_mouse_event_y[0]);
+        if (!focus_info[0])
             goto end;
         if ((gui_mouse_event_x[0] != gui_mouse_event_x[1])
             || (gui_mouse_event_y[0] != gui_mouse_event_y[1]))
         {
-            focus_info2 = gui_focus_get_info (gui_mouse_event_x[1],
-                                              gui_mouse_event_y[1]);
-            if (!focus_info2)
-                goto end;
-            hashtable_focus[1] = gui_focus_to_hashtable (focus_info2, key);
-            if (!hashtable_focus[1])
+            focus_info[1] = gui_focus_get_info (gui_mouse_event_x[1],
+                                                gui_mouse_event_y[1]);
+            if (!focus_info[1])
                 goto end;
         }
         if (gui_mouse_debug)
@@ -2231,21 +2442,16 @@ gui_key_focus (const char *key, int context)
     }
     else
     {
-        focus_info1 = gui_focus_get_info (gui_cursor_x, gui_cursor_y);
-        if (!focus_info1)
-            goto end;
-        hashtable_focus[0] = gui_focus_to_hashtable (focus_info1, key);
-        if (!hashtable_focus[0])
+        focus_info[0] = gui_focus_get_info (gui_cursor_x, gui_cursor_y);
+        if (!focus_info[0])
             goto end;
     }
 
-    rc = gui_key_focus_command (key, context, hashtable_focus);
+    rc = gui_key_focus_command (key, context, focus_info);
 
 end:
-    gui_focus_free_info (focus_info1);
-    gui_focus_free_info (focus_info2);
-    hashtable_free (hashtable_focus[0]);
-    hashtable_free (hashtable_focus[1]);
+    gui_focus_free_info (focus_info[0]);
+    gui_focus_free_info (focus_info[1]);
 
     return rc;
 }
@@ -2623,6 +2829,8 @@ gui_key_free (int context,
     if (!key)
         return;
 
+    gui_key_index_invalidate (keys);
+
     if (delete_option)
     {
         ptr_option = config_file_search_option (
@@ -3065,6 +3273,7 @@ gui_key_end ()
                           &last_gui_default_key[context],
                           &gui_default_keys_count[context],
                           0);
+        gui_key_index_free (context);
     }
 }
 
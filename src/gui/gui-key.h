@@ -96,6 +96,7 @@ extern void gui_key_grab_init (int grab_command, const char *delay);
 extern int gui_key_expand (const char *key,
                            char **key_name, char **key_name_alias);
 extern char *gui_key_legacy_to_alias (const char *key);
+extern void gui_key_index_free (int context);
 extern struct t_gui_key *gui_key_new (struct t_gui_buffer *buffer,
                                       int context,
                                       const char *key,
@@ -0,0 +1,855 @@
+/*
+ * gui-line-compress.c - compression of oldest lines of buffers (used by all GUI)
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Lines of a block are saved one after the other, each line with:
+ *   - these fields (native byte order): id (int), date (int64),
+ *     date_usec (int), date_printed (int64), date_usec_printed (int),
+ *     notify_level (char), highlight (char), flags (char),
+ *   - then three strings, each one ending with '\0': tags (separated by
+ *     commas), prefix and message.
+ *
+ * Other fields of lines (time string, prefix length, displayed flag) are
+ * computed again when the block is uncompressed.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "../core/weechat.h"
+#include "../core/core-config.h"
+#include "../core/core-log.h"
+#include "../core/core-slab.h"
+#include "../core/core-string.h"
+#include "gui-line-compress.h"
+#include "gui-buffer.h"
+#include "gui-chat.h"
+#include "gui-filter.h"
+#include "gui-line.h"
+#include "gui-line-segment.h"
+#include "gui-window.h"
+
+
+#define GUI_LINE_COMPRESS_FLAG_TAGS   1
+#define GUI_LINE_COMPRESS_FLAG_PREFIX 2
+
+/* buffer with lines to compress, or uncompressed lines */
+struct t_gui_line_compress_data
+{
+    char *data;                        /* lines (fields and strings)        */
+    int size;                          /* size of data used                 */
+    int size_alloc;                    /* size of data allocated            */
+};
+
+
+/*
+ * Checks if compression of lines is enabled for a buffer: only formatted
+ * buffers which are not merged with other buffers can have lines compressed.
+ *
+ * Returns:
+ *   1: compression is enabled
+ *   0: compression is disabled
+ */
+
+int
+gui_line_compress_enabled (struct t_gui_buffer *buffer)
+{
+#ifdef HAVE_ZSTD
+    return (buffer
+            && (CONFIG_INTEGER(config_history_max_buffer_lines_uncompressed) > 0)
+            && (buffer->type == GUI_BUFFER_TYPE_FORMATTED)
+            && !buffer->mixed_lines) ? 1 : 0;
+#else
+    /* make C compiler happy */
+    (void) buffer;
+
+    return 0;
+#endif /* HAVE_ZSTD */
+}
+
+/*
+ * Checks if lines of a buffer can not be compressed now: when a window is
+ * scrolled in the buffer, a search is active or a filter job is running.
+ *
+ * Returns:
+ *   1: lines must not be compressed now
+ *   0: lines can be compressed
+ */
+
+int
+gui_line_compress_is_locked (struct t_gui_buffer *buffer)
+{
+    struct t_gui_window *ptr_win;
+    struct t_gui_window_scroll *ptr_scroll;
+
+    if ((buffer->text_search != GUI_BUFFER_SEARCH_DISABLED)
+        || buffer->own_lines->filter_job_line)
+    {
+        return 1;
+    }
+
+    for (ptr_win = gui_windows; ptr_win; ptr_win = ptr_win->next_window)
+    {
+        for (ptr_scroll = ptr_win->scroll; ptr_scroll;
+             ptr_scroll = ptr_scroll->next_scroll)
+        {
+            if ((ptr_scroll->buffer == buffer) && ptr_scroll->start_line)
+                return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Asks a full refresh of chat area if at least one window is displaying
+ * buffer and that number of lines in buffer is lower than window height
+ * (before or after the number of lines changed).
+ */
+
+void
+gui_line_compress_ask_refresh (struct t_gui_buffer *buffer, int old_count)
+{
+    struct t_gui_window *ptr_win;
+
+    for (ptr_win = gui_windows; ptr_win; ptr_win = ptr_win->next_window)
+    {
+        if ((ptr_win->buffer == buffer)
+            && ((old_count < ptr_win->win_chat_height)
+                || (buffer->own_lines->lines_count < ptr_win->win_chat_height)))
+        {
+            gui_buffer_ask_chat_refresh (buffer, 2);
+            break;
+        }
+    }
+}
+
+/*
+ * Adds bytes at the end of data.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (not enough memory)
+ */
+
+int
+gui_line_compress_data_add (struct t_gui_line_compress_data *data,
+                            const void *bytes, int size)
+{
+    char *new_data;
+    int new_size;
+
+    if (data->size + size > data->size_alloc)
+    {
+        new_size = (data->size_alloc > 0) ? data->size_alloc : 4096;
+        while (data->size + size > new_size)
+        {
+            new_size *= 2;
+        }
+        new_data = realloc (data->data, new_size);
+        if (!new_data)
+            return 0;
+        data->data = new_data;
+        data->size_alloc = new_size;
+    }
+
+    memcpy (data->data + data->size, bytes, size);
+    data->size += size;
+
+    return 1;
+}
+
+/*
+ * Adds a line at the end of data.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (not enough memory)
+ */
+
+int
+gui_line_compress_data_add_line (struct t_gui_line_compress_data *data,
+                                 struct t_gui_line_data *line_data)
+{
+    int64_t date;
+    char flags, *tags;
+    int rc;
+
+    flags = 0;
+    if (line_data->tags_array)
+        flags |= GUI_LINE_COMPRESS_FLAG_TAGS;
+    if (line_data->prefix)
+        flags |= GUI_LINE_COMPRESS_FLAG_PREFIX;
+
+    if (!gui_line_compress_data_add (data, &line_data->id,
+                                     sizeof (line_data->id)))
+        return 0;
+    date = (int64_t)line_data->date;
+    if (!gui_line_compress_data_add (data, &date, sizeof (date)))
+        return 0;
+    if (!gui_line_compress_data_add (data, &line_data->date_usec,
+                                     sizeof (line_data->date_usec)))
+        return 0;
+    date = (int64_t)line_data->date_printed;
+    if (!gui_line_compress_data_add (data, &date, sizeof (date)))
+        return 0;
+    if (!gui_line_compress_data_add (data, &line_data->date_usec_printed,
+                                     sizeof (line_data->date_usec_printed)))
+        return 0;
+    if (!gui_line_compress_data_add (data, &line_data->notify_level, 1)
+        || !gui_line_compress_data_add (data, &line_data->highlight, 1)
+        || !gui_line_compress_data_add (data, &flags, 1))
+        return 0;
+
+    tags = (line_data->tags_array) ?
+        string_rebuild_split_string ((const char **)line_data->tags_array,
+                                     ",", 0, -1) : NULL;
+    rc = gui_line_compress_data_add (data, (tags) ? tags : "",
+                                     (tags) ? strlen (tags) + 1 : 1);
+    free (tags);
+    if (!rc)
+        return 0;
+    if (!gui_line_compress_data_add (
+            data,
+            (line_data->prefix) ? line_data->prefix : "",
+            (line_data->prefix) ? strlen (line_data->prefix) + 1 : 1))
+        return 0;
+    if (!gui_line_compress_data_add (
+            data,
+            (line_data->message) ? line_data->message : "",
+            (line_data->message) ? strlen (line_data->message) + 1 : 1))
+        return 0;
+
+    return 1;
+}
+
+/*
+ * Adds a block at the end of compressed blocks (the block must not be in any
+ * list).
+ */
+
+void
+gui_line_compress_add_to_list (struct t_gui_lines *lines,
+                               struct t_gui_line_block *block)
+{
+    block->prev_block = lines->last_compressed_block;
+    block->next_block = NULL;
+    if (lines->last_compressed_block)
+        (lines->last_compressed_block)->next_block = block;
+    else
+        lines->compressed_blocks = block;
+    lines->last_compressed_block = block;
+    lines->lines_compressed_count += block->lines_count;
+    lines->lines_compressed_size += block->size;
+}
+
+/*
+ * Removes a block from compressed blocks (the block is not freed).
+ */
+
+void
+gui_line_compress_remove_from_list (struct t_gui_lines *lines,
+                                    struct t_gui_line_block *block)
+{
+    if (block->prev_block)
+        (block->prev_block)->next_block = block->next_block;
+    if (block->next_block)
+        (block->next_block)->prev_block = block->prev_block;
+    if (lines->compressed_blocks == block)
+        lines->compressed_blocks = block->next_block;
+    if (lines->last_compressed_block == block)
+        lines->last_compressed_block = block->prev_block;
+    block->prev_block = NULL;
+    block->next_block = NULL;
+
+    lines->lines_compressed_count -= block->lines_count;
+    lines->lines_compressed_size -= block->size;
+}
+
+/*
+ * Compresses the oldest lines of a buffer in one block; the block is added
+ * after other blocks and lines are removed from the buffer.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+gui_line_compress_block (struct t_gui_buffer *buffer)
+{
+#ifdef HAVE_ZSTD
+    struct t_gui_lines *lines;
+    struct t_gui_line *ptr_line;
+    struct t_gui_line_block *new_block;
+    struct t_gui_line_compress_data data;
+    time_t last_date_printed;
+    char *compressed, *new_compressed;
+    size_t compressed_size;
+    int i, read_marker;
+
+    lines = buffer->own_lines;
+
+    data.data = NULL;
+    data.size = 0;
+    data.size_alloc = 0;
+    i = 0;
+    read_marker = -1;
+    last_date_printed = 0;
+    for (ptr_line = lines->first_line;
+         ptr_line && (i < GUI_LINE_COMPRESS_BLOCK_LINES);
+         ptr_line = ptr_line->next_line)
+    {
+        if (!gui_line_compress_data_add_line (&data, ptr_line->data))
+        {
+            free (data.data);
+            return 0;
+        }
+        if (ptr_line == lines->last_read_line)
+            read_marker = i;
+        last_date_printed = ptr_line->data->date_printed;
+        i++;
+    }
+    if (i == 0)
+    {
+        free (data.data);
+        return 0;
+    }
+
+    compressed_size = ZSTD_compressBound (data.size);
+    compressed = malloc (compressed_size);
+    if (!compressed)
+    {
+        free (data.data);
+        return 0;
+    }
+    compressed_size = ZSTD_compress (compressed, compressed_size,
+                                     data.data, data.size,
+                                     GUI_LINE_COMPRESS_LEVEL);
+    if (ZSTD_isError (compressed_size))
+    {
+        free (compressed);
+        free (data.data);
+        return 0;
+    }
+    new_compressed = realloc (compressed, compressed_size);
+    if (new_compressed)
+        compressed = new_compressed;
+
+    new_block = malloc (sizeof (*new_block));
+    if (!new_block)
+    {
+        free (compressed);
+        free (data.data);
+        return 0;
+    }
+    new_block->data = compressed;
+    new_block->size = (int)compressed_size;
+    new_block->size_uncompressed = data.size;
+    new_block->lines_count = i;
+    new_block->read_marker = read_marker;
+    new_block->last_date_printed = last_date_printed;
+    new_block->offset = -1;
+    gui_line_compress_add_to_list (lines, new_block);
+
+    free (data.data);
+
+    /*
+     * remove lines from buffer; if the read marker is in the block, it is
+     * moved before the first line (and restored when the block is
+     * uncompressed, see function gui_line_uncompress_block)
+     */
+    for (i = 0; i < new_block->lines_count; i++)
+    {
+        gui_line_free (buffer, lines->first_line);
+    }
+
+    return 1;
+#else
+    /* make C compiler happy */
+    (void) buffer;
+
+    return 0;
+#endif /* HAVE_ZSTD */
+}
+
+/*
+ * Compresses the oldest lines of a buffer, so that the number of lines not
+ * compressed is lower than option weechat.history.max_buffer_lines_uncompressed
+ * plus the size of a block (more lines are kept if a window displaying the
+ * buffer is higher than this option, so that it is filled without
+ * uncompressing lines).
+ *
+ * Returns the number of blocks created.
+ */
+
+int
+gui_line_compress_buffer (struct t_gui_buffer *buffer)
+{
+    struct t_gui_window *ptr_win;
+    int old_count, count, lines_kept;
+
+    if (!gui_line_compress_enabled (buffer)
+        || (buffer->own_lines->lines_count <
+            CONFIG_INTEGER(config_history_max_buffer_lines_uncompressed)
+            + GUI_LINE_COMPRESS_BLOCK_LINES)
+        || gui_line_compress_is_locked (buffer))
+    {
+        return 0;
+    }
+
+    lines_kept = CONFIG_INTEGER(config_history_max_buffer_lines_uncompressed);
+    for (ptr_win = gui_windows; ptr_win; ptr_win = ptr_win->next_window)
+    {
+        if ((ptr_win->buffer == buffer)
+            && (ptr_win->win_chat_height > lines_kept))
+        {
+            lines_kept = ptr_win->win_chat_height;
+        }
+    }
+
+    old_count = buffer->own_lines->lines_count;
+    count = 0;
+    while (buffer->own_lines->lines_count >=
+           lines_kept + GUI_LINE_COMPRESS_BLOCK_LINES)
+    {
+        if (!gui_line_compress_block (buffer))
+            break;
+        count++;
+    }
+
+    if (count > 0)
+        gui_line_compress_ask_refresh (buffer, old_count);
+
+    return count;
+}
+
+/*
+ * Frees a block of compressed lines and removes it from the list of blocks.
+ */
+
+void
+gui_line_compress_free_block (struct t_gui_lines *lines,
+                              struct t_gui_line_block *block)
+{
+    gui_line_compress_remove_from_list (lines, block);
+
+    free (block->data);
+    free (block);
+}
+
+/*
+ * Removes oldest blocks of compressed lines according to history options
+ * (see function gui_line_add): a block is removed only if all its lines must
+ * be removed.
+ *
+ * If option weechat.history.buffer_lines_on_disk is enabled, the block is
+ * saved in the segment file of buffer instead of being freed.
+ *
+ * Returns the number of lines removed (from memory).
+ */
+
+int
+gui_line_compress_remove_old (struct t_gui_buffer *buffer,
+                              time_t current_time)
+{
+    struct t_gui_lines *lines;
+    int lines_removed;
+
+    if (!buffer)
+        return 0;
+
+    lines = buffer->own_lines;
+    lines_removed = 0;
+    while (lines->compressed_blocks
+           && (((CONFIG_INTEGER(config_history_max_buffer_lines_number) > 0)
+                && (lines->lines_count + lines->lines_compressed_count
+                    - lines->compressed_blocks->lines_count + 1 >
+                    CONFIG_INTEGER(config_history_max_buffer_lines_number)))
+               || ((CONFIG_INTEGER(config_history_max_buffer_lines_minutes) > 0)
+                   && (current_time - lines->compressed_blocks->last_date_printed >
+                       CONFIG_INTEGER(config_history_max_buffer_lines_minutes) * 60))))
+    {
+        lines_removed += lines->compressed_blocks->lines_count;
+        if (!gui_line_segment_enabled (buffer)
+            || !gui_line_segment_write_block (buffer,
+                                              lines->compressed_blocks))
+        {
+            gui_line_compress_free_block (lines, lines->compressed_blocks);
+        }
+    }
+
+    return lines_removed;
+}
+
+/*
+ * Frees all blocks of compressed lines.
+ */
+
+void
+gui_line_compress_free_all (struct t_gui_lines *lines)
+{
+    if (!lines)
+        return;
+
+    while (lines->compressed_blocks)
+    {
+        gui_line_compress_free_block (lines, lines->compressed_blocks);
+    }
+}
+
+/*
+ * Reads a line in uncompressed data, starting at position "*pos" (which is
+ * moved after the line).
+ *
+ * Returns pointer to new line, NULL if error.
+ */
+
+struct t_gui_line *
+gui_line_uncompress_read_line (struct t_gui_buffer *buffer,
+                               const char *data, int size, int *pos)
+{
+    struct t_gui_line *new_line;
+    struct t_gui_line_data *new_line_data;
+    int64_t date, date_printed;
+    const char *ptr_tags, *ptr_prefix, *ptr_message;
+    char notify_level, highlight, flags;
+    int id, date_usec, date_usec_printed;
+
+    if (*pos + (int)(sizeof (id) + sizeof (date) + sizeof (date_usec)
+                     + sizeof (date_printed) + sizeof (date_usec_printed)
+                     + 3) > size)
+    {
+        return NULL;
+    }
+    memcpy (&id, data + *pos, sizeof (id));
+    *pos += sizeof (id);
+    memcpy (&date, data + *pos, sizeof (date));
+    *pos += sizeof (date);
+    memcpy (&date_usec, data + *pos, sizeof (date_usec));
+    *pos += sizeof (date_usec);
+    memcpy (&date_printed, data + *pos, sizeof (date_printed));
+    *pos += sizeof (date_printed);
+    memcpy (&date_usec_printed, data + *pos, sizeof (date_usec_printed));
+    *pos += sizeof (date_usec_printed);
+    notify_level = data[(*pos)++];
+    highlight = data[(*pos)++];
+    flags = data[(*pos)++];
+
+    ptr_tags = data + *pos;
+    ptr_prefix = memchr (ptr_tags, '\0', size - *pos);
+    if (!ptr_prefix)
+        return NULL;
+    ptr_prefix++;
+    ptr_message = memchr (ptr_prefix, '\0', data + size - ptr_prefix);
+    if (!ptr_message)
+        return NULL;
+    ptr_message++;
+    if (!memchr (ptr_message, '\0', data + size - ptr_message))
+        return NULL;
+    *pos = (ptr_message - data) + strlen (ptr_message) + 1;
+
+    new_line = gui_line_alloc (buffer->own_lines);
+    if (!new_line)
+        return NULL;
+    new_line_data = gui_line_alloc_data (buffer->own_lines);
+    if (!new_line_data)
+    {
+        slab_free_item (new_line);
+        return NULL;
+    }
+    new_line->data = new_line_data;
+
+    new_line->data->buffer = buffer;
+    new_line->data->size = 0;
+    new_line->data->id = id;
+    new_line->data->y = -1;
+    new_line->data->date = (time_t)date;
+    new_line->data->date_usec = date_usec;
+    new_line->data->date_printed = (time_t)date_printed;
+    new_line->data->date_usec_printed = date_usec_printed;
+    gui_line_tags_alloc (new_line->data,
+                         (flags & GUI_LINE_COMPRESS_FLAG_TAGS) ?
+                         ptr_tags : NULL);
+    new_line->data->notify_level = notify_level;
+    new_line->data->highlight = highlight;
+    new_line->data->refresh_needed = 0;
+    new_line->data->prefix = (flags & GUI_LINE_COMPRESS_FLAG_PREFIX) ?
+        (char *)string_shared_get (ptr_prefix) : NULL;
+    new_line->data->prefix_length = (new_line->data->prefix) ?
+        gui_chat_strlen_screen (new_line->data->prefix) : 0;
+    new_line->data->message = strdup (ptr_message);
+    new_line->data->str_time = gui_chat_get_time_string (
+        new_line->data->date, new_line->data->date_usec,
+        new_line->data->highlight);
+    new_line->data->displayed = gui_filter_check_line (new_line->data);
+
+    new_line->prev_line = NULL;
+    new_line->next_line = NULL;
+
+    return new_line;
+}
+
+/*
+ * Uncompresses the most recent block of compressed lines of a buffer: lines
+ * are added at the beginning of buffer lines and the block is freed.
+ *
+ * If there is no compressed block in memory, the most recent block of the
+ * segment file is read first.
+ *
+ * Returns the number of lines added, -1 if error.
+ */
+
+int
+gui_line_uncompress_block (struct t_gui_buffer *buffer)
+{
+#ifdef HAVE_ZSTD
+    struct t_gui_lines *lines;
+    struct t_gui_line_block *ptr_block;
+    struct t_gui_line *new_line, *first_line, *last_line, *ptr_line;
+    struct t_gui_line *line_read_marker;
+    char *data;
+    size_t size;
+    int pos, count, old_count;
+
+    if (!buffer)
+        return -1;
+
+    lines = buffer->own_lines;
+    ptr_block = lines->last_compressed_block;
+    if (!ptr_block)
+    {
+        ptr_block = gui_line_segment_read_block (buffer);
+        if (!ptr_block)
+            return -1;
+    }
+
+    data = malloc (ptr_block->size_uncompressed);
+    if (!data)
+        return -1;
+    size = ZSTD_decompress (data, ptr_block->size_uncompressed,
+                            ptr_block->data, ptr_block->size);
+    if (ZSTD_isError (size))
+    {
+        free (data);
+        return -1;
+    }
+
+    first_line = NULL;
+    last_line = NULL;
+    line_read_marker = NULL;
+    pos = 0;
+    count = 0;
+    while (pos < (int)size)
+    {
+        new_line = gui_line_uncompress_read_line (buffer, data, (int)size,
+                                                  &pos);
+        if (!new_line)
+            break;
+        new_line->prev_line = last_line;
+        if (last_line)
+            last_line->next_line = new_line;
+        else
+            first_line = new_line;
+        last_line = new_line;
+        if (count == ptr_block->read_marker)
+            line_read_marker = new_line;
+        count++;
+    }
+
+    free (data);
+
+    if (!first_line)
+    {
+        gui_line_compress_free_block (lines, ptr_block);
+        return -1;
+    }
+
+    /* add lines at the beginning of buffer lines */
+    old_count = lines->lines_count;
+    last_line->next_line = lines->first_line;
+    if (lines->first_line)
+        (lines->first_line)->prev_line = last_line;
+    else
+        lines->last_line = last_line;
+    lines->first_line = first_line;
+    lines->lines_count += count;
+    for (ptr_line = first_line; ptr_line != last_line->next_line;
+         ptr_line = ptr_line->next_line)
+    {
+        gui_line_size_add (ptr_line->data);
+        if (ptr_line->data->displayed)
+        {
+            gui_line_prefix_length_add (
+                lines, gui_line_prefix_align_length (ptr_line->data));
+        }
+        else
+        {
+            (lines->lines_hidden)++;
+        }
+    }
+
+    /* restore read marker if it has not been moved since compression */
+    if (line_read_marker && lines->first_line_not_read
+        && !lines->last_read_line)
+    {
+        lines->last_read_line = line_read_marker;
+        lines->first_line_not_read = 0;
+    }
+
+    gui_line_compress_free_block (lines, ptr_block);
+
+    gui_line_id_index_rebuild (lines);
+
+    gui_line_compress_ask_refresh (buffer, old_count);
+
+    return count;
+#else
+    /* make C compiler happy */
+    (void) buffer;
+
+    return -1;
+#endif /* HAVE_ZSTD */
+}
+
+/*
+ * Uncompresses blocks of lines in a buffer, until the buffer has at least
+ * "count" lines not compressed (if count < 0, all lines are uncompressed,
+ * including lines in segment file).
+ *
+ * Returns the number of lines uncompressed.
+ */
+
+int
+gui_line_uncompress_lines (struct t_gui_buffer *buffer, int count)
+{
+    int lines_added, rc;
+
+    if (!buffer)
+        return 0;
+
+    lines_added = 0;
+    while ((buffer->own_lines->compressed_blocks
+            || buffer->own_lines->segment_blocks)
+           && ((count < 0) || (buffer->own_lines->lines_count < count)))
+    {
+        rc = gui_line_uncompress_block (buffer);
+        if (rc < 0)
+            break;
+        lines_added += rc;
+    }
+
+    return lines_added;
+}
+
+/*
+ * Gets previous line, uncompressing a block of lines if the line is the first
+ * line of buffer and that some lines are compressed.
+ *
+ * Returns pointer to previous line, NULL if not found.
+ */
+
+struct t_gui_line *
+gui_line_uncompress_get_prev_line (struct t_gui_line *line)
+{
+    struct t_gui_buffer *ptr_buffer;
+
+    if (!line)
+        return NULL;
+
+    if (!line->prev_line)
+    {
+        ptr_buffer = line->data->buffer;
+        if (ptr_buffer
+            && (ptr_buffer->lines == ptr_buffer->own_lines)
+            && (ptr_buffer->own_lines->first_line == line))
+        {
+            while (!line->prev_line
+                   && (ptr_buffer->own_lines->compressed_blocks
+                       || ptr_buffer->own_lines->segment_blocks))
+            {
+                if (gui_line_uncompress_block (ptr_buffer) < 0)
+                    break;
+            }
+        }
+    }
+
+    return line->prev_line;
+}
+
+/*
+ * Gets previous line displayed, uncompressing blocks of lines if needed.
+ *
+ * Returns pointer to previous line displayed, NULL if not found.
+ */
+
+struct t_gui_line *
+gui_line_uncompress_get_prev_displayed (struct t_gui_line *line)
+{
+    if (line)
+    {
+        line = gui_line_uncompress_get_prev_line (line);
+        while (line && !gui_line_is_displayed (line))
+        {
+            line = gui_line_uncompress_get_prev_line (line);
+        }
+    }
+    return line;
+}
+
+/*
+ * Prints blocks of compressed lines in WeeChat log file (usually for crash
+ * dump).
+ */
+
+void
+gui_line_compress_print_log (struct t_gui_lines *lines)
+{
+    struct t_gui_line_block *ptr_block;
+
+    if (!lines)
+        return;
+
+    for (ptr_block = lines->compressed_blocks; ptr_block;
+         ptr_block = ptr_block->next_block)
+    {
+        log_printf ("");
+        log_printf ("    [compressed block (addr:%p)]", ptr_block);
+        log_printf ("      data . . . . . . . . . : %p", ptr_block->data);
+        log_printf ("      size . . . . . . . . . : %d", ptr_block->size);
+        log_printf ("      size_uncompressed. . . : %d", ptr_block->size_uncompressed);
+        log_printf ("      lines_count. . . . . . : %d", ptr_block->lines_count);
+        log_printf ("      read_marker. . . . . . : %d", ptr_block->read_marker);
+        log_printf ("      last_date_printed. . . : %lld", (long long)ptr_block->last_date_printed);
+        log_printf ("      offset . . . . . . . . : %lld", ptr_block->offset);
+        log_printf ("      prev_block . . . . . . : %p", ptr_block->prev_block);
+        log_printf ("      next_block . . . . . . : %p", ptr_block->next_block);
+    }
+}
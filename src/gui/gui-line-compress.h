@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WEECHAT_GUI_LINE_COMPRESS_H
+#define WEECHAT_GUI_LINE_COMPRESS_H
+
+#include <time.h>
+
+/*
+ * oldest lines of a formatted buffer can be compressed (with zstd) in blocks
+ * of lines, which are removed from the list of lines; the most recent block
+ * is uncompressed and added back at the beginning of the list of lines when
+ * it is needed (scroll, search, ...)
+ */
+
+#define GUI_LINE_COMPRESS_BLOCK_LINES 1024
+#define GUI_LINE_COMPRESS_LEVEL 3
+
+struct t_gui_buffer;
+struct t_gui_line;
+struct t_gui_lines;
+
+struct t_gui_line_block
+{
+    char *data;                        /* compressed lines                  */
+    int size;                          /* size of compressed lines          */
+    int size_uncompressed;             /* size of lines once uncompressed   */
+    int lines_count;                   /* number of lines in block          */
+    int read_marker;                   /* index of line with read marker    */
+                                       /* (-1 if not in this block)         */
+    time_t last_date_printed;          /* date printed of last line         */
+    long long offset;                  /* offset of block in segment file   */
+                                       /* (-1 if block is in memory)        */
+    struct t_gui_line_block *prev_block; /* link to previous block          */
+    struct t_gui_line_block *next_block; /* link to next block              */
+};
+
+/* line compress functions */
+
+extern int gui_line_compress_enabled (struct t_gui_buffer *buffer);
+extern void gui_line_compress_add_to_list (struct t_gui_lines *lines,
+                                           struct t_gui_line_block *block);
+extern void gui_line_compress_remove_from_list (struct t_gui_lines *lines,
+                                                struct t_gui_line_block *block);
+extern int gui_line_compress_buffer (struct t_gui_buffer *buffer);
+extern int gui_line_compress_remove_old (struct t_gui_buffer *buffer,
+                                         time_t current_time);
+extern void gui_line_compress_free_all (struct t_gui_lines *lines);
+extern int gui_line_uncompress_block (struct t_gui_buffer *buffer);
+extern int gui_line_uncompress_lines (struct t_gui_buffer *buffer, int count);
+extern struct t_gui_line *gui_line_uncompress_get_prev_line (struct t_gui_line *line);
+extern struct t_gui_line *gui_line_uncompress_get_prev_displayed (struct t_gui_line *line);
+extern void gui_line_compress_print_log (struct t_gui_lines *lines);
+
+#endif /* WEECHAT_GUI_LINE_COMPRESS_H */
@@ -0,0 +1,435 @@
+/*
+ * gui-line-segment.c - segment files with oldest lines of buffers on disk
+ *                      (used by all GUI)
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * A segment file contains compressed blocks of lines (same format as blocks
+ * in memory, see file gui-line-compress.c), one after the other, from the
+ * oldest to the most recent; the list of blocks (size, number of lines, ...)
+ * is kept in memory only, and saved in the upgrade file on /upgrade.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "../core/weechat.h"
+#include "../core/core-config.h"
+#include "../core/core-dir.h"
+#include "../core/core-log.h"
+#include "../core/core-string.h"
+#include "gui-line-segment.h"
+#include "gui-buffer.h"
+#include "gui-line.h"
+#include "gui-line-compress.h"
+
+
+/*
+ * Checks if segment files are enabled for a buffer: lines must be compressed
+ * in the buffer (see function gui_line_compress_enabled).
+ *
+ * Returns:
+ *   1: segment files are enabled
+ *   0: segment files are disabled
+ */
+
+int
+gui_line_segment_enabled (struct t_gui_buffer *buffer)
+{
+    return (CONFIG_BOOLEAN(config_history_buffer_lines_on_disk)
+            && gui_line_compress_enabled (buffer)) ? 1 : 0;
+}
+
+/*
+ * Gets path to segment file of a buffer.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+gui_line_segment_get_path (struct t_gui_buffer *buffer)
+{
+    char *path;
+
+    if (!buffer || !weechat_cache_dir)
+        return NULL;
+
+    if (string_asprintf (&path, "%s/%s/%lld.lines",
+                         weechat_cache_dir, GUI_LINE_SEGMENT_DIR,
+                         buffer->id) < 0)
+    {
+        return NULL;
+    }
+
+    return path;
+}
+
+/*
+ * Adds a block at the end of segment blocks (the block must not be in any
+ * list).
+ */
+
+void
+gui_line_segment_add_to_list (struct t_gui_lines *lines,
+                              struct t_gui_line_block *block)
+{
+    block->prev_block = lines->last_segment_block;
+    block->next_block = NULL;
+    if (lines->last_segment_block)
+        (lines->last_segment_block)->next_block = block;
+    else
+        lines->segment_blocks = block;
+    lines->last_segment_block = block;
+    lines->lines_segment_count += block->lines_count;
+    lines->segment_size = block->offset + block->size;
+}
+
+/*
+ * Removes the most recent block from segment blocks (the block is not freed).
+ */
+
+void
+gui_line_segment_remove_last_from_list (struct t_gui_lines *lines)
+{
+    struct t_gui_line_block *ptr_block;
+
+    ptr_block = lines->last_segment_block;
+    if (!ptr_block)
+        return;
+
+    lines->last_segment_block = ptr_block->prev_block;
+    if (lines->last_segment_block)
+        (lines->last_segment_block)->next_block = NULL;
+    else
+        lines->segment_blocks = NULL;
+    lines->lines_segment_count -= ptr_block->lines_count;
+    lines->segment_size = ptr_block->offset;
+    ptr_block->prev_block = NULL;
+    ptr_block->next_block = NULL;
+}
+
+/*
+ * Writes a block of compressed lines at the end of the segment file of a
+ * buffer: the block is removed from compressed blocks, its data is freed and
+ * it is added at the end of segment blocks.
+ *
+ * The block must be the oldest compressed block of buffer.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (block is unchanged)
+ */
+
+int
+gui_line_segment_write_block (struct t_gui_buffer *buffer,
+                              struct t_gui_line_block *block)
+{
+    struct t_gui_lines *lines;
+    struct stat st;
+    char *path, *dir;
+    ssize_t num_written;
+    long long pos;
+    int fd, rc;
+
+    if (!buffer || !block || !block->data)
+        return 0;
+
+    lines = buffer->own_lines;
+    rc = 0;
+    fd = -1;
+
+    path = gui_line_segment_get_path (buffer);
+    if (!path)
+        return 0;
+    dir = strrchr (path, '/');
+    if (dir)
+    {
+        dir[0] = '\0';
+        (void) dir_mkdir_parents (path, 0700);
+        dir[0] = '/';
+    }
+
+    fd = open (path, O_WRONLY | O_CREAT, 0600);
+    if (fd < 0)
+        goto end;
+
+    /* remove any data after the last block (not used any more) */
+    if ((fstat (fd, &st) < 0)
+        || ((st.st_size != (off_t)lines->segment_size)
+            && (ftruncate (fd, (off_t)lines->segment_size) < 0)))
+    {
+        goto end;
+    }
+
+    pos = 0;
+    while (pos < block->size)
+    {
+        num_written = pwrite (fd, block->data + pos, block->size - pos,
+                              (off_t)(lines->segment_size + pos));
+        if (num_written <= 0)
+        {
+            /* restore previous size of file */
+            (void) ftruncate (fd, (off_t)lines->segment_size);
+            goto end;
+        }
+        pos += num_written;
+    }
+
+    gui_line_compress_remove_from_list (lines, block);
+    free (block->data);
+    block->data = NULL;
+    block->offset = lines->segment_size;
+    gui_line_segment_add_to_list (lines, block);
+
+    rc = 1;
+
+end:
+    if (fd >= 0)
+        close (fd);
+    free (path);
+    return rc;
+}
+
+/*
+ * Reads the most recent block of the segment file of a buffer (with mmap):
+ * the block is removed from segment blocks (and the file is truncated) then
+ * added at the end of compressed blocks.
+ *
+ * If the block can not be read, it is removed and freed (its lines are lost).
+ *
+ * Returns pointer to block read, NULL if error.
+ */
+
+struct t_gui_line_block *
+gui_line_segment_read_block (struct t_gui_buffer *buffer)
+{
+    struct t_gui_lines *lines;
+    struct t_gui_line_block *ptr_block;
+    struct stat st;
+    char *path, *data;
+    void *map;
+    long page_size;
+    off_t map_offset;
+    size_t map_size;
+    int fd;
+
+    if (!buffer || !buffer->own_lines->last_segment_block)
+        return NULL;
+
+    lines = buffer->own_lines;
+    ptr_block = lines->last_segment_block;
+    gui_line_segment_remove_last_from_list (lines);
+
+    data = NULL;
+    fd = -1;
+
+    path = gui_line_segment_get_path (buffer);
+    if (!path)
+        goto error;
+
+    fd = open (path, O_RDWR);
+    if (fd < 0)
+        goto error;
+
+    /* mapping data beyond end of file would cause a SIGBUS on access */
+    if ((fstat (fd, &st) < 0)
+        || ((long long)st.st_size < ptr_block->offset + ptr_block->size))
+    {
+        goto error;
+    }
+
+    data = malloc (ptr_block->size);
+    if (!data)
+        goto error;
+
+    page_size = sysconf (_SC_PAGESIZE);
+    if (page_size <= 0)
+        page_size = 4096;
+    map_offset = (off_t)(ptr_block->offset - (ptr_block->offset % page_size));
+    map_size = (size_t)(ptr_block->offset - map_offset) + ptr_block->size;
+    map = mmap (NULL, map_size, PROT_READ, MAP_PRIVATE, fd, map_offset);
+    if (map == MAP_FAILED)
+        goto error;
+    memcpy (data, (char *)map + (ptr_block->offset - map_offset),
+            ptr_block->size);
+    munmap (map, map_size);
+
+    /* block is now in memory: remove it from file */
+    (void) ftruncate (fd, (off_t)ptr_block->offset);
+    close (fd);
+    fd = -1;
+    if (!lines->segment_blocks)
+        unlink (path);
+    free (path);
+
+    ptr_block->data = data;
+    ptr_block->offset = -1;
+    gui_line_compress_add_to_list (lines, ptr_block);
+
+    return ptr_block;
+
+error:
+    if (fd >= 0)
+        close (fd);
+    free (path);
+    free (data);
+    free (ptr_block);
+    return NULL;
+}
+
+/*
+ * Adds a block at the end of segment blocks of a buffer, without writing
+ * anything in the segment file (used to restore blocks on /upgrade: data is
+ * already in the file).
+ *
+ * Returns pointer to new block, NULL if error.
+ */
+
+struct t_gui_line_block *
+gui_line_segment_add_block (struct t_gui_buffer *buffer,
+                            int size, int size_uncompressed, int lines_count,
+                            int read_marker, time_t last_date_printed)
+{
+    struct t_gui_line_block *new_block;
+
+    if (!buffer || (size <= 0) || (size_uncompressed <= 0)
+        || (lines_count <= 0))
+    {
+        return NULL;
+    }
+
+    new_block = malloc (sizeof (*new_block));
+    if (!new_block)
+        return NULL;
+
+    new_block->data = NULL;
+    new_block->size = size;
+    new_block->size_uncompressed = size_uncompressed;
+    new_block->lines_count = lines_count;
+    new_block->read_marker = read_marker;
+    new_block->last_date_printed = last_date_printed;
+    new_block->offset = buffer->own_lines->segment_size;
+    gui_line_segment_add_to_list (buffer->own_lines, new_block);
+
+    return new_block;
+}
+
+/*
+ * Frees all segment blocks (the segment file is not removed).
+ */
+
+void
+gui_line_segment_free_all (struct t_gui_lines *lines)
+{
+    struct t_gui_line_block *ptr_block;
+
+    if (!lines)
+        return;
+
+    while (lines->last_segment_block)
+    {
+        ptr_block = lines->last_segment_block;
+        gui_line_segment_remove_last_from_list (lines);
+        free (ptr_block);
+    }
+    lines->segment_size = 0;
+}
+
+/*
+ * Removes segment file of a buffer.
+ *
+ * The file is kept during /upgrade (it is used by the new WeeChat process).
+ */
+
+void
+gui_line_segment_remove_file (struct t_gui_buffer *buffer)
+{
+    char *path;
+
+    if (!buffer || weechat_upgrading)
+        return;
+
+    path = gui_line_segment_get_path (buffer);
+    if (path)
+    {
+        unlink (path);
+        free (path);
+    }
+}
+
+/*
+ * Removes all segment files (called on startup if WeeChat is not upgrading:
+ * files left by a previous process are not used).
+ */
+
+void
+gui_line_segment_remove_all_files ()
+{
+    char *path;
+
+    if (!weechat_cache_dir)
+        return;
+
+    if (string_asprintf (&path, "%s/%s",
+                         weechat_cache_dir, GUI_LINE_SEGMENT_DIR) >= 0)
+    {
+        (void) dir_rmtree (path);
+        free (path);
+    }
+}
+
+/*
+ * Prints segment blocks in WeeChat log file (usually for crash dump).
+ */
+
+void
+gui_line_segment_print_log (struct t_gui_lines *lines)
+{
+    struct t_gui_line_block *ptr_block;
+
+    if (!lines)
+        return;
+
+    for (ptr_block = lines->segment_blocks; ptr_block;
+         ptr_block = ptr_block->next_block)
+    {
+        log_printf ("");
+        log_printf ("    [segment block (addr:%p)]", ptr_block);
+        log_printf ("      offset . . . . . . . . : %lld", ptr_block->offset);
+        log_printf ("      size . . . . . . . . . : %d", ptr_block->size);
+        log_printf ("      size_uncompressed. . . : %d", ptr_block->size_uncompressed);
+        log_printf ("      lines_count. . . . . . : %d", ptr_block->lines_count);
+        log_printf ("      read_marker. . . . . . : %d", ptr_block->read_marker);
+        log_printf ("      last_date_printed. . . : %lld", (long long)ptr_block->last_date_printed);
+        log_printf ("      prev_block . . . . . . : %p", ptr_block->prev_block);
+        log_printf ("      next_block . . . . . . : %p", ptr_block->next_block);
+    }
+}
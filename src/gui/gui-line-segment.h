@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WEECHAT_GUI_LINE_SEGMENT_H
+#define WEECHAT_GUI_LINE_SEGMENT_H
+
+#include <time.h>
+
+/*
+ * oldest blocks of compressed lines can be saved in a segment file on disk
+ * (one file per buffer, in directory "${weechat_cache_dir}/lines"), instead
+ * of being removed; blocks are appended to the file and the most recent one
+ * is read again (with mmap) and removed from end of file when it is needed
+ */
+
+#define GUI_LINE_SEGMENT_DIR "lines"
+
+struct t_gui_buffer;
+struct t_gui_lines;
+struct t_gui_line_block;
+
+/* line segment functions */
+
+extern int gui_line_segment_enabled (struct t_gui_buffer *buffer);
+extern char *gui_line_segment_get_path (struct t_gui_buffer *buffer);
+extern int gui_line_segment_write_block (struct t_gui_buffer *buffer,
+                                         struct t_gui_line_block *block);
+extern struct t_gui_line_block *gui_line_segment_read_block (struct t_gui_buffer *buffer);
+extern struct t_gui_line_block *gui_line_segment_add_block (struct t_gui_buffer *buffer,
+                                                            int size,
+                                                            int size_uncompressed,
+                                                            int lines_count,
+                                                            int read_marker,
+                                                            time_t last_date_printed);
+extern void gui_line_segment_free_all (struct t_gui_lines *lines);
+extern void gui_line_segment_remove_file (struct t_gui_buffer *buffer);
+extern void gui_line_segment_remove_all_files ();
+extern void gui_line_segment_print_log (struct t_gui_lines *lines);
+
+#endif /* WEECHAT_GUI_LINE_SEGMENT_H */
@@ -36,9 +36,13 @@
 #include "../core/core-hook.h"
 #include "../core/core-infolist.h"
 #include "../core/core-log.h"
+#include "../core/core-slab.h"
+#include "../core/core-parallel.h"
 #include "../core/core-string.h"
 #include "../plugins/plugin.h"
 #include "gui-line.h"
+#include "gui-line-compress.h"
+#include "gui-line-segment.h"
 #include "gui-buffer.h"
 #include "gui-chat.h"
 #include "gui-color.h"
@@ -48,6 +52,23 @@
 #include "gui-window.h"
 
 
+/*
+ * buffers reused to remove colors in prefix/message (search and filters),
+ * one per thread (lines can be scanned in threads, see gui_line_scan)
+ */
+__thread char **gui_line_buffer_no_color_prefix = NULL;
+__thread char **gui_line_buffer_no_color_message = NULL;
+
+/* data sent to threads scanning lines */
+struct t_gui_line_scan
+{
+    struct t_gui_line_data **lines;    /* lines to scan                     */
+    t_gui_line_scan_cb *callback;      /* callback called for each line     */
+    void *callback_data;               /* data sent to callback             */
+    char *results;                     /* result of callback for each line  */
+};
+
+
 /*
  * Allocates structure "t_gui_lines" and initializes it.
  *
@@ -66,12 +87,32 @@ gui_line_lines_alloc ()
         new_lines->last_line = NULL;
         new_lines->last_read_line = NULL;
         new_lines->lines_count = 0;
+        new_lines->lines_size = 0;
         new_lines->first_line_not_read = 0;
         new_lines->lines_hidden = 0;
         new_lines->buffer_max_length = 0;
         new_lines->buffer_max_length_refresh = 0;
         new_lines->prefix_max_length = CONFIG_INTEGER(config_look_prefix_align_min);
         new_lines->prefix_max_length_refresh = 0;
+        new_lines->prefix_length_count = NULL;
+        new_lines->prefix_length_count_size = 0;
+        new_lines->id_index = NULL;
+        new_lines->id_index_size = 0;
+        new_lines->id_index_start = 0;
+        new_lines->id_index_count = 0;
+        new_lines->id_index_disabled = 0;
+        new_lines->filter_job_line = NULL;
+        new_lines->filter_job_lines_done = 0;
+        new_lines->line_slab = NULL;
+        new_lines->line_data_slab = NULL;
+        new_lines->compressed_blocks = NULL;
+        new_lines->last_compressed_block = NULL;
+        new_lines->lines_compressed_count = 0;
+        new_lines->lines_compressed_size = 0;
+        new_lines->segment_blocks = NULL;
+        new_lines->last_segment_block = NULL;
+        new_lines->lines_segment_count = 0;
+        new_lines->segment_size = 0;
     }
 
     return new_lines;
@@ -87,9 +128,244 @@ gui_line_lines_free (struct t_gui_lines *lines)
     if (!lines)
         return;
 
+    free (lines->id_index);
+    free (lines->prefix_length_count);
+    gui_line_compress_free_all (lines);
+    gui_line_segment_free_all (lines);
+    slab_free (lines->line_slab);
+    slab_free (lines->line_data_slab);
     free (lines);
 }
 
+/*
+ * Allocates a line (not initialized) in slab of a "t_gui_lines" structure.
+ *
+ * Returns pointer to line, NULL if error.
+ */
+
+struct t_gui_line *
+gui_line_alloc (struct t_gui_lines *lines)
+{
+    if (!lines->line_slab)
+    {
+        lines->line_slab = slab_new (sizeof (struct t_gui_line),
+                                     GUI_LINE_SLAB_CHUNK_MAX_ITEMS);
+        if (!lines->line_slab)
+            return NULL;
+    }
+
+    return slab_alloc (lines->line_slab);
+}
+
+/*
+ * Allocates a line data (not initialized) in slab of a "t_gui_lines"
+ * structure.
+ *
+ * Returns pointer to line data, NULL if error.
+ */
+
+struct t_gui_line_data *
+gui_line_alloc_data (struct t_gui_lines *lines)
+{
+    if (!lines->line_data_slab)
+    {
+        lines->line_data_slab = slab_new (sizeof (struct t_gui_line_data),
+                                          GUI_LINE_SLAB_CHUNK_MAX_ITEMS);
+        if (!lines->line_data_slab)
+            return NULL;
+    }
+
+    return slab_alloc (lines->line_data_slab);
+}
+
+/*
+ * Searches position of a line id in index of lines sorted by id.
+ *
+ * Returns position of the first line with an id greater than or equal to
+ * "id" (relative to lines->id_index_start), lines->id_index_count if all
+ * lines have a lower id.
+ */
+
+int
+gui_line_id_index_search_pos (struct t_gui_lines *lines, int id)
+{
+    struct t_gui_line **ptr_index;
+    int low, high, middle;
+
+    ptr_index = lines->id_index + lines->id_index_start;
+    low = 0;
+    high = lines->id_index_count;
+    while (low < high)
+    {
+        middle = low + ((high - low) / 2);
+        if (ptr_index[middle]->data->id < id)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return low;
+}
+
+/*
+ * Disables index of lines sorted by id: the search of a line by id is then
+ * sequential, until all lines are removed from the buffer.
+ */
+
+void
+gui_line_id_index_disable (struct t_gui_lines *lines)
+{
+    free (lines->id_index);
+    lines->id_index = NULL;
+    lines->id_index_size = 0;
+    lines->id_index_start = 0;
+    lines->id_index_count = 0;
+    lines->id_index_disabled = 1;
+}
+
+/*
+ * Rebuilds index of lines sorted by id, with all lines (used when many lines
+ * are added at the beginning of lines).
+ */
+
+void
+gui_line_id_index_rebuild (struct t_gui_lines *lines)
+{
+    struct t_gui_line *ptr_line;
+    int lines_count;
+
+    if (!lines)
+        return;
+
+    gui_line_id_index_disable (lines);
+    lines->id_index_disabled = 0;
+
+    /* lines are added one by one, as if there was only this line */
+    lines_count = lines->lines_count;
+    lines->lines_count = 1;
+    for (ptr_line = lines->first_line; ptr_line;
+         ptr_line = ptr_line->next_line)
+    {
+        gui_line_id_index_add (lines, ptr_line);
+        if (lines->id_index_disabled)
+            break;
+    }
+    lines->lines_count = lines_count;
+}
+
+/*
+ * Adds a line in index of lines sorted by id.
+ *
+ * Lines are usually added with an id greater than the last one, so the line
+ * is then appended at the end of index (if many lines were removed from the
+ * beginning of index, the index is compacted instead of being enlarged).
+ *
+ * If the id is already used by another line, the index is disabled.
+ */
+
+void
+gui_line_id_index_add (struct t_gui_lines *lines, struct t_gui_line *line)
+{
+    struct t_gui_line **new_index, **ptr_index;
+    int pos, new_size;
+
+    if (!lines || !line || !line->data)
+        return;
+
+    if (lines->id_index_disabled)
+    {
+        /* the index is enabled again if this is the only line */
+        if (lines->lines_count > 1)
+            return;
+        lines->id_index_disabled = 0;
+    }
+
+    pos = lines->id_index_count;
+    if ((lines->id_index_count > 0)
+        && (lines->id_index[lines->id_index_start + lines->id_index_count - 1]->data->id >= line->data->id))
+    {
+        pos = gui_line_id_index_search_pos (lines, line->data->id);
+        if (lines->id_index[lines->id_index_start + pos]->data->id == line->data->id)
+        {
+            gui_line_id_index_disable (lines);
+            return;
+        }
+    }
+
+    if (lines->id_index_start + lines->id_index_count >= lines->id_index_size)
+    {
+        if ((lines->id_index_start > 0)
+            && (lines->id_index_start >= lines->id_index_count))
+        {
+            memmove (lines->id_index,
+                     lines->id_index + lines->id_index_start,
+                     lines->id_index_count * sizeof (*lines->id_index));
+            lines->id_index_start = 0;
+        }
+        else
+        {
+            new_size = (lines->id_index_size > 0) ?
+                lines->id_index_size * 2 : 64;
+            new_index = realloc (lines->id_index,
+                                 new_size * sizeof (*new_index));
+            if (!new_index)
+            {
+                gui_line_id_index_disable (lines);
+                return;
+            }
+            lines->id_index = new_index;
+            lines->id_index_size = new_size;
+        }
+    }
+
+    ptr_index = lines->id_index + lines->id_index_start;
+    if (pos < lines->id_index_count)
+    {
+        memmove (ptr_index + pos + 1,
+                 ptr_index + pos,
+                 (lines->id_index_count - pos) * sizeof (*ptr_index));
+    }
+    ptr_index[pos] = line;
+    lines->id_index_count++;
+}
+
+/*
+ * Removes a line from index of lines sorted by id.
+ */
+
+void
+gui_line_id_index_remove (struct t_gui_lines *lines, struct t_gui_line *line)
+{
+    struct t_gui_line **ptr_index;
+    int pos;
+
+    if (!lines || !line || !line->data
+        || lines->id_index_disabled || (lines->id_index_count == 0))
+    {
+        return;
+    }
+
+    pos = gui_line_id_index_search_pos (lines, line->data->id);
+    ptr_index = lines->id_index + lines->id_index_start;
+    if ((pos >= lines->id_index_count) || (ptr_index[pos] != line))
+        return;
+
+    if (pos == 0)
+    {
+        /* first line removed (most common case): just move the start */
+        lines->id_index_start++;
+    }
+    else if (pos < lines->id_index_count - 1)
+    {
+        memmove (ptr_index + pos,
+                 ptr_index + pos + 1,
+                 (lines->id_index_count - pos - 1) * sizeof (*ptr_index));
+    }
+    lines->id_index_count--;
+    if (lines->id_index_count == 0)
+        lines->id_index_start = 0;
+}
+
 /*
  * Allocates array with tags in a line_data.
  */
@@ -130,6 +406,79 @@ gui_line_tags_free (struct t_gui_line_data *line_data)
     }
 }
 
+/*
+ * Gets number of bytes used in memory by a line: line, line data, time
+ * string, array of tags and message (prefix and tags are shared strings, they
+ * are not counted).
+ */
+
+int
+gui_line_data_get_size (struct t_gui_line_data *line_data)
+{
+    int size;
+
+    if (!line_data)
+        return 0;
+
+    size = sizeof (struct t_gui_line) + sizeof (*line_data);
+    if (line_data->str_time)
+        size += strlen (line_data->str_time) + 1;
+    if (line_data->tags_array)
+        size += (line_data->tags_count + 1) * sizeof (*line_data->tags_array);
+    if (line_data->message)
+        size += strlen (line_data->message) + 1;
+
+    return size;
+}
+
+/*
+ * Adds size of a line to the size of own lines of its buffer (called when the
+ * line is added in own lines).
+ */
+
+void
+gui_line_size_add (struct t_gui_line_data *line_data)
+{
+    if (!line_data || !line_data->buffer)
+        return;
+
+    line_data->size = gui_line_data_get_size (line_data);
+    line_data->buffer->own_lines->lines_size += line_data->size;
+}
+
+/*
+ * Removes size of a line from the size of own lines of its buffer (called
+ * when the line is removed from own lines).
+ */
+
+void
+gui_line_size_remove (struct t_gui_line_data *line_data)
+{
+    if (!line_data || !line_data->buffer || (line_data->size == 0))
+        return;
+
+    line_data->buffer->own_lines->lines_size -= line_data->size;
+    line_data->size = 0;
+}
+
+/*
+ * Updates size of a line after a change in its content (nothing is done if
+ * the line is not in own lines of its buffer).
+ */
+
+void
+gui_line_size_update (struct t_gui_line_data *line_data)
+{
+    int size;
+
+    if (!line_data || !line_data->buffer || (line_data->size == 0))
+        return;
+
+    size = gui_line_data_get_size (line_data);
+    line_data->buffer->own_lines->lines_size += size - line_data->size;
+    line_data->size = size;
+}
+
 /*
  * Checks if prefix on line is a nick and is the same as nick on previous/next
  * line (according to direction: if < 0, check if it's the same nick as
@@ -611,11 +960,29 @@ gui_line_get_next_displayed (struct t_gui_line *line)
 struct t_gui_line *
 gui_line_search_by_id (struct t_gui_buffer *buffer, int id)
 {
+    struct t_gui_lines *ptr_lines;
     struct t_gui_line *ptr_line;
+    int pos;
 
     if (!buffer || !buffer->own_lines)
         return NULL;
 
+    ptr_lines = buffer->own_lines;
+
+    if (!ptr_lines->id_index_disabled)
+    {
+        if (ptr_lines->id_index_count == 0)
+            return NULL;
+        pos = gui_line_id_index_search_pos (ptr_lines, id);
+        if (pos < ptr_lines->id_index_count)
+        {
+            ptr_line = ptr_lines->id_index[ptr_lines->id_index_start + pos];
+            if (ptr_line->data->id == id)
+                return ptr_line;
+        }
+        return NULL;
+    }
+
     for (ptr_line = buffer->own_lines->last_line; ptr_line;
          ptr_line = ptr_line->prev_line)
     {
@@ -628,7 +995,14 @@ gui_line_search_by_id (struct t_gui_buffer *buffer, int id)
 }
 
 /*
- * Searches for text in a line.
+ * Checks if a line matches a text (or a regex).
+ *
+ * Argument "where" is a combination of GUI_BUFFER_SEARCH_IN_PREFIX and
+ * GUI_BUFFER_SEARCH_IN_MESSAGE.
+ * If "regex" is 1, "regex_compiled" is used (no match if it is NULL),
+ * otherwise "text" is searched (case sensitive if "exact" is 1).
+ *
+ * This function can be called by threads (see function gui_line_scan).
  *
  * Returns:
  *   1: text found in line
@@ -636,88 +1010,174 @@ gui_line_search_by_id (struct t_gui_buffer *buffer, int id)
  */
 
 int
-gui_line_search_text (struct t_gui_buffer *buffer, struct t_gui_line *line)
+gui_line_match_text (struct t_gui_line_data *line_data, int where,
+                     const char *text, int exact,
+                     int regex, regex_t *regex_compiled)
 {
-    char *prefix, *message;
+    const char *prefix, *message;
+    char *message_tags;
     int rc;
 
-    if (!line || !line->data->message
-        || !buffer->input_buffer || !buffer->input_buffer[0])
-    {
+    if (!line_data || !line_data->message || !text || !text[0])
         return 0;
-    }
 
     rc = 0;
 
-    if ((buffer->text_search_where & GUI_BUFFER_SEARCH_IN_PREFIX)
-        && line->data->prefix)
+    if ((where & GUI_BUFFER_SEARCH_IN_PREFIX) && line_data->prefix)
     {
-        prefix = gui_color_decode (line->data->prefix, NULL);
+        prefix = gui_color_decode_buffer (line_data->prefix,
+                                          &gui_line_buffer_no_color_prefix);
         if (prefix)
         {
-            if (buffer->text_search_regex)
+            if (regex)
             {
-                if (buffer->text_search_regex_compiled)
+                if (regex_compiled
+                    && (string_regexec (regex_compiled, prefix, 0, NULL, 0) == 0))
                 {
-                    if (regexec (buffer->text_search_regex_compiled,
-                                 prefix, 0, NULL, 0) == 0)
-                    {
-                        rc = 1;
-                    }
+                    rc = 1;
                 }
             }
-            else if ((buffer->text_search_exact
-                      && (strstr (prefix, buffer->input_buffer)))
-                     || (!buffer->text_search_exact
-                         && (string_strcasestr (prefix, buffer->input_buffer))))
+            else if ((exact && (strstr (prefix, text)))
+                     || (!exact && (string_strcasestr (prefix, text))))
             {
                 rc = 1;
             }
-            free (prefix);
         }
     }
 
-    if (!rc && (buffer->text_search_where & GUI_BUFFER_SEARCH_IN_MESSAGE))
+    if (!rc && (where & GUI_BUFFER_SEARCH_IN_MESSAGE))
     {
+        message_tags = NULL;
         if (gui_chat_display_tags)
         {
-            message = gui_line_build_string_message_tags (
-                line->data->message,
-                line->data->tags_count,
-                line->data->tags_array,
+            message_tags = gui_line_build_string_message_tags (
+                line_data->message,
+                line_data->tags_count,
+                line_data->tags_array,
                 0);
+            message = message_tags;
         }
         else
         {
-            message = gui_color_decode (line->data->message, NULL);
+            message = gui_color_decode_buffer (
+                line_data->message,
+                &gui_line_buffer_no_color_message);
         }
         if (message)
         {
-            if (buffer->text_search_regex)
+            if (regex)
             {
-                if (buffer->text_search_regex_compiled)
+                if (regex_compiled
+                    && (string_regexec (regex_compiled, message, 0, NULL, 0) == 0))
                 {
-                    if (regexec (buffer->text_search_regex_compiled,
-                                 message, 0, NULL, 0) == 0)
-                    {
-                        rc = 1;
-                    }
+                    rc = 1;
                 }
             }
-            else if ((buffer->text_search_exact
-                      && (strstr (message, buffer->input_buffer)))
-                     || (!buffer->text_search_exact
-                         && (string_strcasestr (message, buffer->input_buffer))))
+            else if ((exact && (strstr (message, text)))
+                     || (!exact && (string_strcasestr (message, text))))
             {
                 rc = 1;
             }
-            free (message);
         }
+        free (message_tags);
     }
 
     return rc;
 }
 
+/*
+ * Searches for text in a line (using search options of buffer).
+ *
+ * Returns:
+ *   1: text found in line
+ *   0: text not found in line
+ */
+
+int
+gui_line_search_text (struct t_gui_buffer *buffer, struct t_gui_line *line)
+{
+    if (!line)
+        return 0;
+
+    return gui_line_match_text (line->data,
+                                buffer->text_search_where,
+                                buffer->input_buffer,
+                                buffer->text_search_exact,
+                                buffer->text_search_regex,
+                                buffer->text_search_regex_compiled);
+}
+
+/*
+ * Frees buffers used to remove colors in lines (for the current thread).
+ */
+
+void
+gui_line_free_buffers_no_color ()
+{
+    if (gui_line_buffer_no_color_prefix)
+    {
+        string_dyn_free (gui_line_buffer_no_color_prefix, 1);
+        gui_line_buffer_no_color_prefix = NULL;
+    }
+    if (gui_line_buffer_no_color_message)
+    {
+        string_dyn_free (gui_line_buffer_no_color_message, 1);
+        gui_line_buffer_no_color_message = NULL;
+    }
+}
+
+/*
+ * Scans a range of lines (callback of parallel_run).
+ */
+
+void
+gui_line_scan_range_cb (void *data, int thread_index, int start, int end)
+{
+    struct t_gui_line_scan *scan;
+    int i;
+
+    scan = (struct t_gui_line_scan *)data;
+
+    for (i = start; i < end; i++)
+    {
+        scan->results[i] = (char)((scan->callback) (scan->callback_data,
+                                                    scan->lines[i]));
+    }
+
+    /* buffers of the main thread are kept, they are reused */
+    if (thread_index > 0)
+        gui_line_free_buffers_no_color ();
+}
+
+/*
+ * Scans lines: calls the callback for each line and stores its result
+ * (0 or 1) in "results" (which must have room for "count" chars).
+ *
+ * If there are many lines, they are split between at most "max_threads"
+ * threads (see function parallel_run): the callback must only read data
+ * (lines, buffers, filters, ...), which can not change until the function
+ * returns.
+ */
+
+void
+gui_line_scan (struct t_gui_line_data **lines, int count, int max_threads,
+               t_gui_line_scan_cb *callback, void *callback_data,
+               char *results)
+{
+    struct t_gui_line_scan scan;
+
+    if (!lines || (count <= 0) || !callback || !results)
+        return;
+
+    scan.lines = lines;
+    scan.callback = callback;
+    scan.callback_data = callback_data;
+    scan.results = results;
+
+    (void) parallel_run (max_threads, count, GUI_LINE_SCAN_MIN_LINES_THREAD,
+                         &gui_line_scan_range_cb, &scan);
+}
+
 /*
  * Checks if a line matches regex.
  *
@@ -730,23 +1190,21 @@ int
 gui_line_match_regex (struct t_gui_line_data *line_data, regex_t *regex_prefix,
                       regex_t *regex_message)
 {
-    char *prefix, *message;
+    const char *prefix, *message;
     int match_prefix, match_message;
 
     if (!line_data || (!regex_prefix && !regex_message))
         return 0;
 
-    prefix = NULL;
-    message = NULL;
-
     match_prefix = 1;
     match_message = 1;
 
     if (line_data->prefix)
     {
-        prefix = gui_color_decode (line_data->prefix, NULL);
+        prefix = gui_color_decode_buffer (line_data->prefix,
+                                          &gui_line_buffer_no_color_prefix);
         if (!prefix
-            || (regex_prefix && (regexec (regex_prefix, prefix, 0, NULL, 0) != 0)))
+            || (regex_prefix && (string_regexec (regex_prefix, prefix, 0, NULL, 0) != 0)))
             match_prefix = 0;
     }
     else
@@ -757,9 +1215,10 @@ gui_line_match_regex (struct t_gui_line_data *line_data, regex_t *regex_prefix,
 
     if (line_data->message)
     {
-        message = gui_color_decode (line_data->message, NULL);
+        message = gui_color_decode_buffer (line_data->message,
+                                           &gui_line_buffer_no_color_message);
         if (!message
-            || (regex_message && (regexec (regex_message, message, 0, NULL, 0) != 0)))
+            || (regex_message && (string_regexec (regex_message, message, 0, NULL, 0) != 0)))
             match_message = 0;
     }
     else
@@ -768,9 +1227,6 @@ gui_line_match_regex (struct t_gui_line_data *line_data, regex_t *regex_prefix,
             match_message = 0;
     }
 
-    free (prefix);
-    free (message);
-
     return (match_prefix && match_message);
 }
 
@@ -804,6 +1260,11 @@ gui_line_has_tag_no_filter (struct t_gui_line_data *line_data)
 /*
  * Checks if line matches tags.
  *
+ * Tags of line and tags in "tags_array" (built by string_split_tags) are
+ * shared strings, so a tag is first compared by pointer; a tag without
+ * wildcard is then compared without case, and other tags are matched with
+ * function string_match.
+ *
  * Returns:
  *   1: line matches tags
  *   0: line does not match tags
@@ -813,7 +1274,7 @@ int
 gui_line_match_tags (struct t_gui_line_data *line_data,
                      int tags_count, char ***tags_array)
 {
-    int i, j, k, match, tag_found, tag_negated;
+    int i, j, k, match, tag_found, tag_negated, tag_wildcard;
     const char *ptr_tag;
 
     if (!line_data)
@@ -841,9 +1302,16 @@ gui_line_match_tags (struct t_gui_line_data *line_data,
             }
             else
             {
+                tag_wildcard = (strchr (ptr_tag, '*')) ? 1 : 0;
                 for (k = 0; k < line_data->tags_count; k++)
                 {
-                    if (string_match (line_data->tags_array[k], ptr_tag, 0))
+                    if ((line_data->tags_array[k] == ptr_tag)
+                        || (!tag_wildcard
+                            && (string_strcasecmp (line_data->tags_array[k],
+                                                   ptr_tag) == 0))
+                        || (tag_wildcard
+                            && string_match (line_data->tags_array[k],
+                                             ptr_tag, 0)))
                     {
                         tag_found = 1;
                         break;
@@ -908,6 +1376,33 @@ gui_line_get_nick_tag (struct t_gui_line *line)
     return tag + 5;
 }
 
+/*
+ * Checks if a string has a highlight with a list of words, using (and
+ * updating if needed) the words compiled in "*highlight".
+ *
+ * The words are compiled again only if they have changed since the last call.
+ *
+ * Returns:
+ *   1: string has a highlight
+ *   0: string has no highlight
+ */
+
+int
+gui_line_has_highlight_words (struct t_string_highlight **highlight,
+                              const char *string, const char *words)
+{
+    if (!words || !words[0])
+        return 0;
+
+    if (!*highlight || (strcmp ((*highlight)->highlight_words, words) != 0))
+    {
+        string_highlight_free (*highlight);
+        *highlight = string_highlight_compile (words);
+    }
+
+    return string_highlight_match (*highlight, string);
+}
+
 /*
  * Checks if a line has highlight (with a string in global highlight or buffer
  * highlight).
@@ -921,8 +1416,8 @@ int
 gui_line_has_highlight (struct t_gui_line *line)
 {
     int rc, rc_regex, i, no_highlight, action, length;
-    char *msg_no_color, *ptr_msg_no_color, *highlight_words;
-    const char *ptr_nick;
+    char *msg_no_color, *ptr_msg_no_color;
+    const char *ptr_nick, *highlight_words;
     regmatch_t regex_match;
 
     /* remove color codes from line message */
@@ -1002,8 +1497,8 @@ gui_line_has_highlight (struct t_gui_line *line)
      */
     if (config_highlight_disable_regex)
     {
-        rc_regex = regexec (config_highlight_disable_regex,
-                            ptr_msg_no_color, 1, &regex_match, 0);
+        rc_regex = string_regexec (config_highlight_disable_regex,
+                                   ptr_msg_no_color, 1, &regex_match, 0);
         if ((rc_regex == 0) && (regex_match.rm_so >= 0) && (regex_match.rm_eo > 0))
         {
             rc = 0;
@@ -1017,8 +1512,8 @@ gui_line_has_highlight (struct t_gui_line *line)
      */
     if (line->data->buffer->highlight_disable_regex_compiled)
     {
-        rc_regex = regexec (line->data->buffer->highlight_disable_regex_compiled,
-                            ptr_msg_no_color, 1, &regex_match, 0);
+        rc_regex = string_regexec (line->data->buffer->highlight_disable_regex_compiled,
+                                   ptr_msg_no_color, 1, &regex_match, 0);
         if ((rc_regex == 0) && (regex_match.rm_so >= 0) && (regex_match.rm_eo > 0))
         {
             rc = 0;
@@ -1071,21 +1566,25 @@ gui_line_has_highlight (struct t_gui_line *line)
      * there is highlight on line if one of buffer highlight words matches line
      * or one of global highlight words matches line
      */
-    highlight_words = gui_buffer_string_replace_local_var (line->data->buffer,
-                                                           line->data->buffer->highlight_words);
-    rc = string_has_highlight (ptr_msg_no_color,
-                               (highlight_words) ?
-                               highlight_words : line->data->buffer->highlight_words);
-    free (highlight_words);
+    highlight_words = gui_buffer_string_replace_local_var_cached (
+        line->data->buffer,
+        line->data->buffer->highlight_words);
+    rc = gui_line_has_highlight_words (
+        &line->data->buffer->highlight_words_compiled,
+        ptr_msg_no_color,
+        (highlight_words) ?
+        highlight_words : line->data->buffer->highlight_words);
     if (rc)
         goto end;
 
-    highlight_words = gui_buffer_string_replace_local_var (line->data->buffer,
-                                                           CONFIG_STRING(config_look_highlight));
-    rc = string_has_highlight (ptr_msg_no_color,
-                               (highlight_words) ?
-                               highlight_words : CONFIG_STRING(config_look_highlight));
-    free (highlight_words);
+    highlight_words = gui_buffer_string_replace_local_var_cached (
+        line->data->buffer,
+        CONFIG_STRING(config_look_highlight));
+    rc = gui_line_has_highlight_words (
+        &line->data->buffer->highlight_words_global_compiled,
+        ptr_msg_no_color,
+        (highlight_words) ?
+        highlight_words : CONFIG_STRING(config_look_highlight));
     if (rc)
         goto end;
 
@@ -1192,28 +1691,177 @@ gui_line_compute_buffer_max_length (struct t_gui_buffer *buffer,
 }
 
 /*
- * Computes "prefix_max_length" for a "t_gui_lines" structure.
+ * Returns length of prefix of a line used to compute the prefix alignment:
+ * length of prefix, with the nick prefix/suffix if the prefix is a nick.
+ *
+ * The prefix displayed for a line with same nick as previous line (options
+ * weechat.look.prefix_same_nick*) is not used, so that this length does not
+ * depend on other lines.
  */
 
-void
-gui_line_compute_prefix_max_length (struct t_gui_lines *lines)
+int
+gui_line_prefix_align_length (struct t_gui_line_data *line_data)
 {
-    struct t_gui_line *ptr_line;
-    int prefix_length, prefix_is_nick;
-
-    lines->prefix_max_length = CONFIG_INTEGER(config_look_prefix_align_min);
+    int i;
 
-    for (ptr_line = lines->first_line; ptr_line;
-         ptr_line = ptr_line->next_line)
+    for (i = 0; i < line_data->tags_count; i++)
+    {
+        if (strncmp (line_data->tags_array[i], "prefix_nick_", 12) == 0)
+            return line_data->prefix_length + config_length_nick_prefix_suffix;
+    }
+
+    return line_data->prefix_length;
+}
+
+/*
+ * Resets count of lines by prefix length and "prefix_max_length" for a
+ * "t_gui_lines" structure (same as no lines displayed).
+ */
+
+void
+gui_line_prefix_length_reset (struct t_gui_lines *lines)
+{
+    if (lines->prefix_length_count)
+    {
+        memset (lines->prefix_length_count, 0,
+                lines->prefix_length_count_size *
+                sizeof (lines->prefix_length_count[0]));
+    }
+    lines->prefix_max_length = CONFIG_INTEGER(config_look_prefix_align_min);
+}
+
+/*
+ * Adds a displayed line with a prefix of "length" in the count of lines by
+ * prefix length, and adjusts "prefix_max_length".
+ */
+
+void
+gui_line_prefix_length_add (struct t_gui_lines *lines, int length)
+{
+    int *new_count, new_size;
+
+    if (length < 0)
+        return;
+
+    if (length > lines->prefix_max_length)
+        lines->prefix_max_length = length;
+
+    if (length >= lines->prefix_length_count_size)
+    {
+        new_size = ((length / GUI_LINE_PREFIX_LENGTH_COUNT_STEP) + 1)
+            * GUI_LINE_PREFIX_LENGTH_COUNT_STEP;
+        new_count = realloc (lines->prefix_length_count,
+                             new_size * sizeof (new_count[0]));
+        if (!new_count)
+            return;
+        memset (new_count + lines->prefix_length_count_size, 0,
+                (new_size - lines->prefix_length_count_size) *
+                sizeof (new_count[0]));
+        lines->prefix_length_count = new_count;
+        lines->prefix_length_count_size = new_size;
+    }
+
+    lines->prefix_length_count[length]++;
+}
+
+/*
+ * Removes a displayed line with a prefix of "length" from the count of lines
+ * by prefix length, and adjusts "prefix_max_length" if it was the last line
+ * with the max length.
+ */
+
+void
+gui_line_prefix_length_remove (struct t_gui_lines *lines, int length)
+{
+    int length_min;
+
+    if ((length < 0)
+        || (length >= lines->prefix_length_count_size)
+        || (lines->prefix_length_count[length] <= 0))
+    {
+        return;
+    }
+
+    lines->prefix_length_count[length]--;
+
+    if ((lines->prefix_length_count[length] == 0)
+        && (length == lines->prefix_max_length))
+    {
+        length_min = CONFIG_INTEGER(config_look_prefix_align_min);
+        while ((length > length_min)
+               && (lines->prefix_length_count[length] == 0))
+        {
+            length--;
+        }
+        lines->prefix_max_length = (length > length_min) ? length : length_min;
+    }
+}
+
+/*
+ * Updates count of lines by prefix length in own and mixed lines of the
+ * buffer of a line data: a line with prefix length "old_length" is removed
+ * and a line with prefix length "new_length" is added (-1 for none).
+ */
+
+void
+gui_line_prefix_length_update (struct t_gui_line_data *line_data,
+                               int old_length, int new_length)
+{
+    if (!line_data->buffer || (old_length == new_length))
+        return;
+
+    gui_line_prefix_length_remove (line_data->buffer->own_lines, old_length);
+    gui_line_prefix_length_add (line_data->buffer->own_lines, new_length);
+    if (line_data->buffer->mixed_lines)
+    {
+        gui_line_prefix_length_remove (line_data->buffer->mixed_lines,
+                                       old_length);
+        gui_line_prefix_length_add (line_data->buffer->mixed_lines,
+                                    new_length);
+    }
+}
+
+/*
+ * Sets flag "displayed" in a line data (line already added in buffer) and
+ * updates count of lines by prefix length.
+ */
+
+void
+gui_line_set_displayed (struct t_gui_line_data *line_data, int displayed)
+{
+    int length;
+
+    if (!line_data || (line_data->displayed == displayed))
+        return;
+
+    line_data->displayed = displayed;
+
+    length = gui_line_prefix_align_length (line_data);
+    if (displayed)
+        gui_line_prefix_length_update (line_data, -1, length);
+    else
+        gui_line_prefix_length_update (line_data, length, -1);
+}
+
+/*
+ * Computes "prefix_max_length" for a "t_gui_lines" structure (count of lines
+ * by prefix length is built again).
+ */
+
+void
+gui_line_compute_prefix_max_length (struct t_gui_lines *lines)
+{
+    struct t_gui_line *ptr_line;
+
+    gui_line_prefix_length_reset (lines);
+
+    for (ptr_line = lines->first_line; ptr_line;
+         ptr_line = ptr_line->next_line)
     {
         if (ptr_line->data->displayed)
         {
-            gui_line_get_prefix_for_display (ptr_line, NULL, &prefix_length,
-                                             NULL, &prefix_is_nick);
-            if (prefix_is_nick)
-                prefix_length += config_length_nick_prefix_suffix;
-            if (prefix_length > lines->prefix_max_length)
-                lines->prefix_max_length = prefix_length;
+            gui_line_prefix_length_add (
+                lines, gui_line_prefix_align_length (ptr_line->data));
         }
     }
 
@@ -1228,8 +1876,6 @@ void
 gui_line_add_to_list (struct t_gui_lines *lines,
                       struct t_gui_line *line)
 {
-    int prefix_length, prefix_is_nick;
-
     if (lines->last_line)
         (lines->last_line)->next_line = line;
     else
@@ -1238,18 +1884,11 @@ gui_line_add_to_list (struct t_gui_lines *lines,
     line->next_line = NULL;
     lines->last_line = line;
 
-    /*
-     * adjust "prefix_max_length" if this prefix length is > max
-     * (only if the line is displayed
-     */
+    /* count prefix length and adjust "prefix_max_length" (if displayed) */
     if (line->data->displayed)
     {
-        gui_line_get_prefix_for_display (line, NULL, &prefix_length, NULL,
-                                         &prefix_is_nick);
-        if (prefix_is_nick)
-            prefix_length += config_length_nick_prefix_suffix;
-        if (prefix_length > lines->prefix_max_length)
-            lines->prefix_max_length = prefix_length;
+        gui_line_prefix_length_add (lines,
+                                    gui_line_prefix_align_length (line->data));
     }
     else
     {
@@ -1258,6 +1897,8 @@ gui_line_add_to_list (struct t_gui_lines *lines,
     }
 
     lines->lines_count++;
+    if (line->data->buffer && (lines == line->data->buffer->own_lines))
+        gui_line_size_add (line->data);
 }
 
 /*
@@ -1271,11 +1912,27 @@ gui_line_free_data (struct t_gui_line *line)
     gui_line_tags_free (line->data);
     string_shared_free (line->data->prefix);
     free (line->data->message);
-    free (line->data);
+    slab_free_item (line->data);
 
     line->data = NULL;
 }
 
+/*
+ * Frees a line created by function gui_line_new and which has not been added
+ * in a buffer (line data is freed as well).
+ */
+
+void
+gui_line_free_new (struct t_gui_line *line)
+{
+    if (!line)
+        return;
+
+    if (line->data)
+        gui_line_free_data (line);
+    slab_free_item (line);
+}
+
 /*
  * Removes a line from a "t_gui_lines" structure.
  */
@@ -1288,7 +1945,6 @@ gui_line_remove_from_list (struct t_gui_buffer *buffer,
 {
     struct t_gui_window *ptr_win;
     struct t_gui_window_scroll *ptr_scroll;
-    int prefix_length, prefix_is_nick;
 
     for (ptr_win = gui_windows; ptr_win; ptr_win = ptr_win->next_window)
     {
@@ -1317,16 +1973,17 @@ gui_line_remove_from_list (struct t_gui_buffer *buffer,
             if (ptr_scroll->text_search_start_line == line)
                 ptr_scroll->text_search_start_line = NULL;
         }
-        /* remove line from coords */
+        /* remove line from coords and from cache of lines rows */
         gui_window_coords_remove_line (ptr_win, line);
+        gui_chat_layout_remove_line (ptr_win, line);
     }
 
-    gui_line_get_prefix_for_display (line, NULL, &prefix_length, NULL,
-                                     &prefix_is_nick);
-    if (prefix_is_nick)
-        prefix_length += config_length_nick_prefix_suffix;
-    if (prefix_length == lines->prefix_max_length)
-        lines->prefix_max_length_refresh = 1;
+    /* remove prefix length from count (adjust "prefix_max_length") */
+    if (line->data->displayed)
+    {
+        gui_line_prefix_length_remove (
+            lines, gui_line_prefix_align_length (line->data));
+    }
 
     /* move read marker if it was on line we are removing */
     if (lines->last_read_line == line)
@@ -1340,9 +1997,16 @@ gui_line_remove_from_list (struct t_gui_buffer *buffer,
     if (!line->data->displayed && (lines->lines_hidden > 0))
         (lines->lines_hidden)--;
 
+    /* move filter job to previous line if it was on line we are removing */
+    if (lines->filter_job_line == line)
+        lines->filter_job_line = line->prev_line;
+
     /* free data */
     if (free_data)
+    {
+        gui_line_size_remove (line->data);
         gui_line_free_data (line);
+    }
 
     /* remove line from list */
     if (line->prev_line)
@@ -1356,7 +2020,7 @@ gui_line_remove_from_list (struct t_gui_buffer *buffer,
 
     lines->lines_count--;
 
-    free (line);
+    slab_free_item (line);
 }
 
 /*
@@ -1369,7 +2033,7 @@ gui_line_mixed_add (struct t_gui_lines *lines,
 {
     struct t_gui_line *new_line;
 
-    new_line = malloc (sizeof (*new_line));
+    new_line = gui_line_alloc (lines);
     if (new_line)
     {
         new_line->data = line_data;
@@ -1378,51 +2042,151 @@ gui_line_mixed_add (struct t_gui_lines *lines,
 }
 
 /*
- * Frees all mixed lines matching a buffer.
+ * Removes all mixed lines marked for removal (lines without data) in one
+ * pass: windows are updated only once, instead of once per line removed.
  */
 
 void
-gui_line_mixed_free_buffer (struct t_gui_buffer *buffer)
+gui_line_mixed_remove_marked (struct t_gui_buffer *buffer,
+                              struct t_gui_lines *lines)
 {
+    struct t_gui_window *ptr_win;
+    struct t_gui_window_scroll *ptr_scroll;
     struct t_gui_line *ptr_line, *ptr_next_line;
+    int i;
 
-    if (buffer->mixed_lines)
+    for (ptr_win = gui_windows; ptr_win; ptr_win = ptr_win->next_window)
     {
-        ptr_line = buffer->mixed_lines->first_line;
-        while (ptr_line)
+        for (ptr_scroll = ptr_win->scroll; ptr_scroll;
+             ptr_scroll = ptr_scroll->next_scroll)
         {
-            ptr_next_line = ptr_line->next_line;
-
-            if (ptr_line->data->buffer == buffer)
+            if (ptr_scroll->start_line && !ptr_scroll->start_line->data)
             {
-                gui_line_remove_from_list (buffer,
-                                           buffer->mixed_lines,
-                                           ptr_line,
-                                           0);
+                ptr_line = ptr_scroll->start_line;
+                while (ptr_line && !ptr_line->data)
+                {
+                    ptr_line = ptr_line->next_line;
+                }
+                ptr_scroll->start_line = ptr_line;
+                ptr_scroll->start_line_pos = 0;
+                if (!ptr_scroll->start_line)
+                {
+                    ptr_scroll->first_line_displayed = 1;
+                    ptr_scroll->scrolling = 0;
+                    ptr_scroll->lines_after = 0;
+                }
+                ptr_win->scroll_changed = 1;
             }
+            if (ptr_scroll->text_search_start_line
+                && !ptr_scroll->text_search_start_line->data)
+            {
+                ptr_scroll->text_search_start_line = NULL;
+            }
+        }
+        if (ptr_win->coords)
+        {
+            for (i = 0; i < ptr_win->coords_size; i++)
+            {
+                if (ptr_win->coords[i].line && !ptr_win->coords[i].line->data)
+                    gui_window_coords_init_line (ptr_win, i);
+            }
+        }
+        gui_chat_layout_reset (ptr_win);
+    }
 
-            ptr_line = ptr_next_line;
+    /* move read marker and filter job to previous line kept */
+    while (lines->last_read_line && !lines->last_read_line->data)
+    {
+        lines->last_read_line = lines->last_read_line->prev_line;
+        lines->first_line_not_read = (lines->last_read_line) ? 0 : 1;
+    }
+    while (lines->filter_job_line && !lines->filter_job_line->data)
+    {
+        lines->filter_job_line = lines->filter_job_line->prev_line;
+    }
+
+    /* remove lines from list */
+    ptr_line = lines->first_line;
+    while (ptr_line)
+    {
+        ptr_next_line = ptr_line->next_line;
+        if (!ptr_line->data)
+        {
+            if (ptr_line->prev_line)
+                (ptr_line->prev_line)->next_line = ptr_line->next_line;
+            if (ptr_line->next_line)
+                (ptr_line->next_line)->prev_line = ptr_line->prev_line;
+            if (lines->first_line == ptr_line)
+                lines->first_line = ptr_line->next_line;
+            if (lines->last_line == ptr_line)
+                lines->last_line = ptr_line->prev_line;
+            lines->lines_count--;
+            slab_free_item (ptr_line);
         }
+        ptr_line = ptr_next_line;
     }
+
+    lines->buffer_max_length_refresh = 1;
+
+    gui_buffer_ask_chat_refresh (buffer, 2);
 }
 
 /*
- * Frees all mixed lines in a buffer.
+ * Frees all mixed lines matching a buffer.
  */
 
 void
-gui_line_mixed_free_all (struct t_gui_buffer *buffer)
+gui_line_mixed_free_buffer (struct t_gui_buffer *buffer)
 {
-    if (buffer->mixed_lines)
+    struct t_gui_line *ptr_line;
+
+    if (!buffer->mixed_lines)
+        return;
+
+    /* mark lines to remove (a mixed line does not own its data) */
+    for (ptr_line = buffer->mixed_lines->first_line; ptr_line;
+         ptr_line = ptr_line->next_line)
     {
-        while (buffer->mixed_lines->first_line)
+        if (ptr_line->data->buffer == buffer)
         {
-            gui_line_remove_from_list (buffer,
-                                       buffer->mixed_lines,
-                                       buffer->mixed_lines->first_line,
-                                       0);
+            if (ptr_line->data->displayed)
+            {
+                gui_line_prefix_length_remove (
+                    buffer->mixed_lines,
+                    gui_line_prefix_align_length (ptr_line->data));
+            }
+            else if (buffer->mixed_lines->lines_hidden > 0)
+            {
+                (buffer->mixed_lines->lines_hidden)--;
+            }
+            ptr_line->data = NULL;
         }
     }
+
+    gui_line_mixed_remove_marked (buffer, buffer->mixed_lines);
+}
+
+/*
+ * Frees all mixed lines in a buffer.
+ */
+
+void
+gui_line_mixed_free_all (struct t_gui_buffer *buffer)
+{
+    struct t_gui_line *ptr_line;
+
+    if (!buffer->mixed_lines)
+        return;
+
+    for (ptr_line = buffer->mixed_lines->first_line; ptr_line;
+         ptr_line = ptr_line->next_line)
+    {
+        ptr_line->data = NULL;
+    }
+    buffer->mixed_lines->lines_hidden = 0;
+    gui_line_prefix_length_reset (buffer->mixed_lines);
+
+    gui_line_mixed_remove_marked (buffer, buffer->mixed_lines);
 }
 
 /*
@@ -1455,28 +2219,117 @@ gui_line_free (struct t_gui_buffer *buffer, struct t_gui_line *line)
     }
 
     /* remove line from lines list */
+    gui_line_id_index_remove (buffer->own_lines, line);
     gui_line_remove_from_list (buffer, buffer->own_lines, line, 1);
 }
 
 /*
  * Deletes all formatted lines from a buffer.
+ *
+ * All lines are removed in one pass: mixed lines are removed only once and
+ * windows are updated only once, instead of once per line removed.
  */
 
 void
 gui_line_free_all (struct t_gui_buffer *buffer)
 {
     struct t_gui_window *ptr_win;
+    struct t_gui_window_scroll *ptr_scroll;
+    struct t_gui_lines *lines;
+    struct t_gui_line *ptr_line, *ptr_next_line;
+    int i;
 
     for (ptr_win = gui_windows; ptr_win; ptr_win = ptr_win->next_window)
     {
         ptr_win->scroll_changed = 0;
     }
 
-    while (buffer->own_lines->first_line)
+    /* first remove mixed lines using data of lines (if buffer is merged) */
+    gui_line_mixed_free_buffer (buffer);
+
+    lines = buffer->own_lines;
+
+    if (lines->first_line)
     {
-        gui_line_free (buffer, buffer->own_lines->first_line);
+        /*
+         * now the only lines remaining with data of this buffer are its own
+         * lines: remove them from windows (scroll, coords, cache of rows)
+         */
+        for (ptr_win = gui_windows; ptr_win; ptr_win = ptr_win->next_window)
+        {
+            for (ptr_scroll = ptr_win->scroll; ptr_scroll;
+                 ptr_scroll = ptr_scroll->next_scroll)
+            {
+                if (ptr_scroll->start_line
+                    && ptr_scroll->start_line->data
+                    && (ptr_scroll->start_line->data->buffer == buffer))
+                {
+                    ptr_scroll->start_line = NULL;
+                    ptr_scroll->start_line_pos = 0;
+                    ptr_scroll->first_line_displayed = 1;
+                    ptr_scroll->scrolling = 0;
+                    ptr_scroll->lines_after = 0;
+                    gui_window_ask_refresh (1);
+                    ptr_win->scroll_changed = 1;
+                }
+                ptr_line = ptr_scroll->text_search_start_line;
+                if (ptr_line && ptr_line->data
+                    && (ptr_line->data->buffer == buffer))
+                {
+                    ptr_scroll->text_search_start_line = NULL;
+                }
+            }
+            if (ptr_win->coords)
+            {
+                for (i = 0; i < ptr_win->coords_size; i++)
+                {
+                    if (ptr_win->coords[i].line
+                        && ptr_win->coords[i].line->data
+                        && (ptr_win->coords[i].line->data->buffer == buffer))
+                    {
+                        gui_window_coords_init_line (ptr_win, i);
+                    }
+                }
+            }
+            gui_chat_layout_reset (ptr_win);
+        }
+
+        /* read marker was on a line removed: it is now before first line */
+        if (lines->last_read_line)
+        {
+            lines->last_read_line = NULL;
+            lines->first_line_not_read = 1;
+        }
+        lines->lines_hidden = 0;
+        lines->filter_job_line = NULL;
+        gui_line_prefix_length_reset (lines);
+        if (!lines->id_index_disabled)
+        {
+            lines->id_index_start = 0;
+            lines->id_index_count = 0;
+        }
+
+        /* free lines */
+        ptr_line = lines->first_line;
+        while (ptr_line)
+        {
+            ptr_next_line = ptr_line->next_line;
+            gui_line_size_remove (ptr_line->data);
+            gui_line_free_data (ptr_line);
+            slab_free_item (ptr_line);
+            ptr_line = ptr_next_line;
+        }
+        lines->first_line = NULL;
+        lines->last_line = NULL;
+        lines->lines_count = 0;
+
+        gui_buffer_ask_chat_refresh (buffer, 2);
     }
 
+    gui_line_compress_free_all (buffer->own_lines);
+    gui_line_segment_free_all (buffer->own_lines);
+    gui_line_segment_remove_file (buffer);
+
     for (ptr_win = gui_windows; ptr_win; ptr_win = ptr_win->next_window)
     {
         if (ptr_win->scroll_changed)
@@ -1585,21 +2438,22 @@ gui_line_new (struct t_gui_buffer *buffer, int y,
         return NULL;
 
     /* create new line */
-    new_line = malloc (sizeof (*new_line));
+    new_line = gui_line_alloc (buffer->own_lines);
     if (!new_line)
         return NULL;
 
     /* create data for line */
-    new_line_data = malloc (sizeof (*new_line_data));
+    new_line_data = gui_line_alloc_data (buffer->own_lines);
     if (!new_line_data)
     {
-        free (new_line);
+        slab_free_item (new_line);
         return NULL;
     }
     new_line->data = new_line_data;
 
     /* fill data in new line */
     new_line->data->buffer = buffer;
+    new_line->data->size = 0;
     new_line->data->message = (message) ? strdup (message) : strdup ("");
 
     if (buffer->type == GUI_BUFFER_TYPE_FORMATTED)
@@ -1851,6 +2705,8 @@ gui_line_hook_update (struct t_gui_line *line,
         free (new_message);
     }
 
+    gui_line_size_update (line->data);
+
     max_notify_level = gui_line_get_max_notify_level (line);
 
     /* if tags were updated but not notify_level, adjust notify level */
@@ -1878,6 +2734,29 @@ gui_line_hook_update (struct t_gui_line *line,
     }
 }
 
+/*
+ * Adds buffer of a line to hotlist.
+ *
+ * If lines are added in a batch in the buffer, the add is deferred until the
+ * end of batch (see function gui_chat_printf_lines_end).
+ */
+
+void
+gui_line_hotlist_add (struct t_gui_line *line, int priority)
+{
+    if (line->data->buffer->lines_batch > 0)
+    {
+        line->data->buffer->lines_batch_hotlist[priority]++;
+        return;
+    }
+
+    (void) gui_hotlist_add (
+        line->data->buffer,
+        priority,
+        NULL,  /* creation_time */
+        1);  /* check_conditions */
+}
+
 /*
  * Adds a new line in a buffer with formatted content.
  */
@@ -1894,10 +2773,15 @@ gui_line_add (struct t_gui_line *line)
      * remove line(s) if necessary, according to history options:
      *   max_lines:   if > 0, keep only N lines in buffer
      *   max_minutes: if > 0, keep only lines from last N minutes
+     * (compressed lines are older: they are removed first, by blocks;
+     * if lines are saved on disk, only blocks are removed from memory)
      */
-    lines_removed = 0;
     current_time = time (NULL);
-    while (line->data->buffer->own_lines->first_line
+    lines_removed = gui_line_compress_remove_old (line->data->buffer,
+                                                  current_time);
+    while (!line->data->buffer->own_lines->compressed_blocks
+           && !gui_line_segment_enabled (line->data->buffer)
+           && line->data->buffer->own_lines->first_line
            && (((CONFIG_INTEGER(config_history_max_buffer_lines_number) > 0)
                 && (line->data->buffer->own_lines->lines_count + 1 >
                     CONFIG_INTEGER(config_history_max_buffer_lines_number)))
@@ -1912,6 +2796,11 @@ gui_line_add (struct t_gui_line *line)
 
     /* add line to lines list */
     gui_line_add_to_list (line->data->buffer->own_lines, line);
+    gui_line_id_index_add (line->data->buffer->own_lines, line);
+
+    /* compress oldest lines, if enabled */
+    if (gui_line_compress_enabled (line->data->buffer))
+        (void) gui_line_compress_buffer (line->data->buffer);
 
     /* update hotlist and/or send signals for line */
     if (line->data->displayed)
@@ -1919,11 +2808,7 @@ gui_line_add (struct t_gui_line *line)
         if ((line->data->notify_level >= GUI_HOTLIST_MIN)
             && line->data->highlight)
         {
-            (void) gui_hotlist_add (
-                line->data->buffer,
-                GUI_HOTLIST_HIGHLIGHT,
-                NULL,  /* creation_time */
-                1);  /* check_conditions */
+            gui_line_hotlist_add (line, GUI_HOTLIST_HIGHLIGHT);
             if (!weechat_upgrading)
             {
                 message_for_signal = gui_line_build_string_prefix_message (
@@ -1953,15 +2838,13 @@ gui_line_add (struct t_gui_line *line)
                 }
             }
             if (line->data->notify_level >= GUI_HOTLIST_MIN)
-            {
-                (void) gui_hotlist_add (
-                    line->data->buffer,
-                    line->data->notify_level,
-                    NULL,  /* creation_time */
-                    1);  /* check_conditions */
-            }
+                gui_line_hotlist_add (line, line->data->notify_level);
         }
     }
+    else if (line->data->buffer->lines_batch > 0)
+    {
+        line->data->buffer->lines_batch_hidden = 1;
+    }
     else
     {
         (void) gui_buffer_send_signal (line->data->buffer,
@@ -1994,6 +2877,13 @@ gui_line_add (struct t_gui_line *line)
         }
     }
 
+    if (line->data->buffer->lines_batch > 0)
+    {
+        /* signal is sent at the end of batch */
+        line->data->buffer->lines_batch_count++;
+        return;
+    }
+
     (void) gui_buffer_send_signal (line->data->buffer,
                                    "buffer_line_added",
                                    WEECHAT_HOOK_SIGNAL_POINTER, line);
@@ -2012,7 +2902,7 @@ gui_line_add_y (struct t_gui_line *line)
 {
     struct t_gui_line *ptr_line;
     struct t_gui_window *ptr_win;
-    int old_line_displayed;
+    int old_line_displayed, id_changed;
 
     /* search if line exists for "y" */
     for (ptr_line = line->data->buffer->own_lines->first_line; ptr_line;
@@ -2032,13 +2922,21 @@ gui_line_add_y (struct t_gui_line *line)
             for (ptr_win = gui_windows; ptr_win; ptr_win = ptr_win->next_window)
             {
                 gui_window_coords_remove_line (ptr_win, ptr_line);
+                gui_chat_layout_remove_line (ptr_win, ptr_line);
             }
         }
 
         /* replace ptr_line by line in list */
+        id_changed = (ptr_line->data->id != line->data->id);
+        if (id_changed)
+            gui_line_id_index_remove (line->data->buffer->own_lines, ptr_line);
+        gui_line_size_remove (ptr_line->data);
         gui_line_free_data (ptr_line);
         ptr_line->data = line->data;
-        free (line);
+        slab_free_item (line);
+        gui_line_size_add (ptr_line->data);
+        if (id_changed)
+            gui_line_id_index_add (ptr_line->data->buffer->own_lines, ptr_line);
     }
     else
     {
@@ -2069,6 +2967,8 @@ gui_line_add_y (struct t_gui_line *line)
         ptr_line = line;
 
         line->data->buffer->own_lines->lines_count++;
+        gui_line_size_add (line->data);
+        gui_line_id_index_add (line->data->buffer->own_lines, line);
     }
 
     /* check if line is filtered or not */
@@ -2102,6 +3002,10 @@ gui_line_add_y (struct t_gui_line *line)
 void
 gui_line_clear (struct t_gui_line *line)
 {
+    int old_prefix_length;
+
+    old_prefix_length = gui_line_prefix_align_length (line->data);
+
     line->data->date = 0;
     line->data->date_usec = 0;
     line->data->date_printed = 0;
@@ -2122,25 +3026,111 @@ gui_line_clear (struct t_gui_line *line)
     line->data->highlight = 0;
     free (line->data->message);
     line->data->message = strdup ("");
+    gui_line_size_update (line->data);
+    if (line->data->displayed)
+        gui_line_prefix_length_update (line->data, old_prefix_length, 0);
+}
+
+/*
+ * Inserts lines in mixed lines, sorted by date (a line is inserted after all
+ * lines with same date); the lines to insert must be sorted by date.
+ *
+ * If "lines_to_move" is set, its lines are moved (without allocation) and it
+ * is empty on return; otherwise new lines are allocated for lines of
+ * "lines_to_copy".
+ */
+
+void
+gui_line_mixed_insert_lines (struct t_gui_lines *mixed_lines,
+                             struct t_gui_lines *lines_to_move,
+                             struct t_gui_lines *lines_to_copy)
+{
+    struct t_gui_line *ptr_line, *ptr_next_line, *ptr_pos, *new_line;
+
+    ptr_pos = mixed_lines->first_line;
+    ptr_line = (lines_to_move) ?
+        lines_to_move->first_line : lines_to_copy->first_line;
+    while (ptr_line)
+    {
+        ptr_next_line = ptr_line->next_line;
+
+        if (lines_to_move)
+        {
+            new_line = ptr_line;
+        }
+        else
+        {
+            new_line = gui_line_alloc (mixed_lines);
+            if (!new_line)
+                break;
+            new_line->data = ptr_line->data;
+        }
+
+        /* lines are sorted by date: search goes on from last position */
+        while (ptr_pos && (ptr_pos->data->date <= new_line->data->date))
+        {
+            ptr_pos = ptr_pos->next_line;
+        }
+
+        /* insert new line before ptr_pos (or at the end) */
+        new_line->next_line = ptr_pos;
+        new_line->prev_line = (ptr_pos) ?
+            ptr_pos->prev_line : mixed_lines->last_line;
+        if (new_line->prev_line)
+            (new_line->prev_line)->next_line = new_line;
+        else
+            mixed_lines->first_line = new_line;
+        if (ptr_pos)
+            ptr_pos->prev_line = new_line;
+        else
+            mixed_lines->last_line = new_line;
+
+        mixed_lines->lines_count++;
+        if (!new_line->data->displayed)
+            mixed_lines->lines_hidden++;
+
+        ptr_line = ptr_next_line;
+    }
+
+    if (lines_to_move)
+    {
+        lines_to_move->first_line = NULL;
+        lines_to_move->last_line = NULL;
+        lines_to_move->last_read_line = NULL;
+        lines_to_move->lines_count = 0;
+        lines_to_move->lines_hidden = 0;
+    }
+
+    /* ask refresh of prefix/buffer max length for mixed lines */
+    mixed_lines->prefix_max_length_refresh = 1;
+    mixed_lines->buffer_max_length_refresh = 1;
 }
 
 /*
  * Mixes lines of a buffer (or group of buffers) with a new buffer.
+ *
+ * Mixed lines of the target group are kept and lines of the buffer are
+ * inserted into them: existing lines (and windows scrolled on them) are not
+ * changed, and lines already mixed in the group of the buffer are moved
+ * without allocation.
  */
 
 void
 gui_line_mix_buffers (struct t_gui_buffer *buffer)
 {
     struct t_gui_buffer *ptr_buffer, *ptr_buffer_found;
-    struct t_gui_lines *new_lines;
-    struct t_gui_line *ptr_line1, *ptr_line2;
+    struct t_gui_lines *mixed_lines, *old_mixed_lines;
+    struct t_gui_window *ptr_win;
 
-    /* search first other buffer with same number */
+    /* search first other buffer with same number, not mixed with buffer */
     ptr_buffer_found = NULL;
-    for (ptr_buffer = gui_buffers; ptr_buffer;
+    for (ptr_buffer = gui_buffer_search_by_number (buffer->number);
+         ptr_buffer && (ptr_buffer->number == buffer->number);
          ptr_buffer = ptr_buffer->next_buffer)
     {
-        if ((ptr_buffer != buffer) && (ptr_buffer->number == buffer->number))
+        if ((ptr_buffer != buffer)
+            && (!ptr_buffer->mixed_lines
+                || (ptr_buffer->mixed_lines != buffer->mixed_lines)))
         {
             ptr_buffer_found = ptr_buffer;
             break;
@@ -2149,71 +3139,46 @@ gui_line_mix_buffers (struct t_gui_buffer *buffer)
     if (!ptr_buffer_found)
         return;
 
-    /* mix all lines (sorting by date) to a new structure "new_lines" */
-    new_lines = gui_line_lines_alloc ();
-    if (!new_lines)
-        return;
-    ptr_line1 = ptr_buffer_found->lines->first_line;
-    ptr_line2 = buffer->lines->first_line;
-    while (ptr_line1 || ptr_line2)
+    /* compressed lines are not mixed: all lines are uncompressed first */
+    (void) gui_line_uncompress_lines (buffer, -1);
+    (void) gui_line_uncompress_lines (ptr_buffer_found, -1);
+
+    /* get mixed lines of target buffer, or create them */
+    mixed_lines = ptr_buffer_found->mixed_lines;
+    if (!mixed_lines)
     {
-        if (!ptr_line1)
-        {
-            gui_line_mixed_add (new_lines, ptr_line2->data);
-            ptr_line2 = ptr_line2->next_line;
-        }
-        else
-        {
-            if (!ptr_line2)
-            {
-                gui_line_mixed_add (new_lines, ptr_line1->data);
-                ptr_line1 = ptr_line1->next_line;
-            }
-            else
-            {
-                /* look for older line by comparing time */
-                if (ptr_line1->data->date <= ptr_line2->data->date)
-                {
-                    while (ptr_line1
-                           && (ptr_line1->data->date <= ptr_line2->data->date))
-                    {
-                        gui_line_mixed_add (new_lines, ptr_line1->data);
-                        ptr_line1 = ptr_line1->next_line;
-                    }
-                }
-                else
-                {
-                    while (ptr_line2
-                           && (ptr_line1->data->date > ptr_line2->data->date))
-                    {
-                        gui_line_mixed_add (new_lines, ptr_line2->data);
-                        ptr_line2 = ptr_line2->next_line;
-                    }
-                }
-            }
-        }
+        mixed_lines = gui_line_lines_alloc ();
+        if (!mixed_lines)
+            return;
+        gui_line_mixed_insert_lines (mixed_lines, NULL,
+                                     ptr_buffer_found->own_lines);
     }
 
-    /* ask refresh of prefix/buffer max length for mixed lines */
-    new_lines->prefix_max_length_refresh = 1;
-    new_lines->buffer_max_length_refresh = 1;
+    /* chat area of windows must be fully drawn again */
+    for (ptr_win = gui_windows; ptr_win; ptr_win = ptr_win->next_window)
+    {
+        gui_chat_layout_reset (ptr_win);
+    }
 
-    /* free old mixed lines */
-    if (ptr_buffer_found->mixed_lines)
+    /* insert lines of buffer */
+    old_mixed_lines = buffer->mixed_lines;
+    if (old_mixed_lines)
+    {
+        gui_line_mixed_insert_lines (mixed_lines, old_mixed_lines, NULL);
+        gui_line_lines_free (old_mixed_lines);
+    }
+    else
     {
-        gui_line_mixed_free_all (ptr_buffer_found);
-        free (ptr_buffer_found->mixed_lines);
+        gui_line_mixed_insert_lines (mixed_lines, NULL, buffer->own_lines);
     }
 
-    /* use new structure with mixed lines in all buffers with correct number */
-    for (ptr_buffer = gui_buffers; ptr_buffer;
+    /* use structure with mixed lines in all buffers with correct number */
+    for (ptr_buffer = gui_buffer_search_by_number (buffer->number);
+         ptr_buffer && (ptr_buffer->number == buffer->number);
          ptr_buffer = ptr_buffer->next_buffer)
     {
-        if (ptr_buffer->number == buffer->number)
-        {
-            ptr_buffer->mixed_lines = new_lines;
-            ptr_buffer->lines = ptr_buffer->mixed_lines;
-        }
+        ptr_buffer->mixed_lines = mixed_lines;
+        ptr_buffer->lines = ptr_buffer->mixed_lines;
     }
 }
 
@@ -2238,12 +3203,21 @@ gui_line_hdata_lines_cb (const void *pointer, void *data,
         HDATA_VAR(struct t_gui_lines, last_line, POINTER, 0, NULL, "line");
         HDATA_VAR(struct t_gui_lines, last_read_line, POINTER, 0, NULL, "line");
         HDATA_VAR(struct t_gui_lines, lines_count, INTEGER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_lines, lines_size, LONGLONG, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_lines, first_line_not_read, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_lines, lines_hidden, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_lines, buffer_max_length, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_lines, buffer_max_length_refresh, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_lines, prefix_max_length, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_lines, prefix_max_length_refresh, INTEGER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_lines, prefix_length_count, INTEGER, 0, "*,prefix_length_count_size", NULL);
+        HDATA_VAR(struct t_gui_lines, prefix_length_count_size, INTEGER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_lines, filter_job_line, POINTER, 0, NULL, "line");
+        HDATA_VAR(struct t_gui_lines, filter_job_lines_done, INTEGER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_lines, lines_compressed_count, INTEGER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_lines, lines_compressed_size, LONGLONG, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_lines, lines_segment_count, INTEGER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_lines, segment_size, LONGLONG, 0, NULL, NULL);
     }
     return hdata;
 }
@@ -2287,7 +3261,7 @@ gui_line_hdata_line_data_update_cb (void *data,
     char *new_value, *pos_newline;
     struct t_gui_line_data *line_data;
     struct t_gui_window *ptr_win;
-    int rc, update_coords;
+    int rc, update_coords, old_prefix_length;
 
     /* make C compiler happy */
     (void) data;
@@ -2296,6 +3270,7 @@ gui_line_hdata_line_data_update_cb (void *data,
 
     rc = 0;
     update_coords = 0;
+    old_prefix_length = gui_line_prefix_align_length (line_data);
 
     if (hashtable_has_key (hashtable, "date"))
     {
@@ -2363,7 +3338,6 @@ gui_line_hdata_line_data_update_cb (void *data,
         hdata_set (hdata, pointer, "prefix", value);
         line_data->prefix_length = (line_data->prefix) ?
             gui_chat_strlen_screen (line_data->prefix) : 0;
-        line_data->buffer->lines->prefix_max_length_refresh = 1;
         rc++;
         update_coords = 1;
     }
@@ -2387,12 +3361,19 @@ gui_line_hdata_line_data_update_cb (void *data,
 
     if (rc > 0)
     {
-        if (update_coords)
+        gui_line_size_update (line_data);
+        if (line_data->displayed)
         {
-            for (ptr_win = gui_windows; ptr_win; ptr_win = ptr_win->next_window)
-            {
+            gui_line_prefix_length_update (
+                line_data,
+                old_prefix_length,
+                gui_line_prefix_align_length (line_data));
+        }
+        for (ptr_win = gui_windows; ptr_win; ptr_win = ptr_win->next_window)
+        {
+            if (update_coords)
                 gui_window_coords_remove_line_data (ptr_win, line_data);
-            }
+            gui_chat_layout_clear (ptr_win);
         }
         gui_filter_buffer (line_data->buffer, line_data);
         gui_buffer_ask_chat_refresh (line_data->buffer, 1);
@@ -2436,6 +3417,7 @@ gui_line_hdata_line_data_cb (const void *pointer, void *data,
         HDATA_VAR(struct t_gui_line_data, notify_level, CHAR, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_line_data, highlight, CHAR, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_line_data, refresh_needed, CHAR, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_line_data, size, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_line_data, prefix, SHARED_STRING, 1, NULL, NULL);
         HDATA_VAR(struct t_gui_line_data, prefix_length, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_line_data, message, STRING, 1, NULL, NULL);
@@ -2541,11 +3523,33 @@ gui_lines_print_log (struct t_gui_lines *lines)
         log_printf ("    last_line. . . . . . . . : %p", lines->last_line);
         log_printf ("    last_read_line . . . . . : %p", lines->last_read_line);
         log_printf ("    lines_count. . . . . . . : %d", lines->lines_count);
+        log_printf ("    lines_size . . . . . . . : %lld", lines->lines_size);
         log_printf ("    first_line_not_read. . . : %d", lines->first_line_not_read);
         log_printf ("    lines_hidden . . . . . . : %d", lines->lines_hidden);
         log_printf ("    buffer_max_length. . . . : %d", lines->buffer_max_length);
         log_printf ("    buffer_max_length_refresh: %d", lines->buffer_max_length_refresh);
         log_printf ("    prefix_max_length. . . . : %d", lines->prefix_max_length);
         log_printf ("    prefix_max_length_refresh: %d", lines->prefix_max_length_refresh);
+        log_printf ("    prefix_length_count. . . : %p", lines->prefix_length_count);
+        log_printf ("    prefix_length_count_size : %d", lines->prefix_length_count_size);
+        log_printf ("    id_index . . . . . . . . : %p", lines->id_index);
+        log_printf ("    id_index_size. . . . . . : %d", lines->id_index_size);
+        log_printf ("    id_index_start . . . . . : %d", lines->id_index_start);
+        log_printf ("    id_index_count . . . . . : %d", lines->id_index_count);
+        log_printf ("    id_index_disabled. . . . : %d", lines->id_index_disabled);
+        log_printf ("    filter_job_line. . . . . : %p", lines->filter_job_line);
+        log_printf ("    filter_job_lines_done. . : %d", lines->filter_job_lines_done);
+        log_printf ("    line_slab. . . . . . . . : %p", lines->line_slab);
+        log_printf ("    line_data_slab . . . . . : %p", lines->line_data_slab);
+        log_printf ("    compressed_blocks. . . . : %p", lines->compressed_blocks);
+        log_printf ("    last_compressed_block. . : %p", lines->last_compressed_block);
+        log_printf ("    lines_compressed_count . : %d", lines->lines_compressed_count);
+        log_printf ("    lines_compressed_size. . : %lld", lines->lines_compressed_size);
+        log_printf ("    segment_blocks . . . . . : %p", lines->segment_blocks);
+        log_printf ("    last_segment_block . . . : %p", lines->last_segment_block);
+        log_printf ("    lines_segment_count. . . : %d", lines->lines_segment_count);
+        log_printf ("    segment_size . . . . . . : %lld", lines->segment_size);
+        gui_line_compress_print_log (lines);
+        gui_line_segment_print_log (lines);
     }
 }
@@ -23,7 +23,15 @@
 #include <time.h>
 #include <regex.h>
 
+#define GUI_LINE_SLAB_CHUNK_MAX_ITEMS 256
+
+/* growth of array with count of lines by prefix length */
+#define GUI_LINE_PREFIX_LENGTH_COUNT_STEP 32
+
+struct t_gui_line_block;
 struct t_infolist;
+struct t_slab;
+struct t_string_highlight;
 
 /* line structures */
 
@@ -45,6 +53,8 @@ struct t_gui_line_data
     char notify_level;                 /* notify level for the line         */
     char highlight;                    /* 1 if line has highlight           */
     char refresh_needed;               /* 1 if refresh asked (free buffer)  */
+    int size;                          /* bytes used by line (0 if line is  */
+                                       /* not in buffer own lines)          */
     char *prefix;                      /* prefix for line (may be NULL)     */
     int prefix_length;                 /* prefix length (on screen)         */
     char *message;                     /* line content (after prefix)       */
@@ -63,6 +73,8 @@ struct t_gui_lines
     struct t_gui_line *last_line;      /* pointer to last line              */
     struct t_gui_line *last_read_line; /* last read line                    */
     int lines_count;                   /* number of lines                   */
+    long long lines_size;              /* bytes used by lines in memory     */
+                                       /* (only for own lines of buffer)    */
     int first_line_not_read;           /* if 1, marker is before first line */
     int lines_hidden;                  /* 1 if at least one line is hidden  */
     int buffer_max_length;             /* max length for buffer name (for   */
@@ -70,15 +82,66 @@ struct t_gui_lines
     int buffer_max_length_refresh;     /* refresh asked for buffer max len. */
     int prefix_max_length;             /* max length for prefix align       */
     int prefix_max_length_refresh;     /* refresh asked for prefix max len. */
+    int *prefix_length_count;          /* number of displayed lines by      */
+                                       /* prefix length (for max length)    */
+    int prefix_length_count_size;      /* size of prefix_length_count       */
+    struct t_gui_line **id_index;      /* own lines sorted by id (used to   */
+                                       /* search a line by id quickly)      */
+    int id_index_size;                 /* allocated size of id_index        */
+    int id_index_start;                /* index of first line in id_index   */
+    int id_index_count;                /* number of lines in id_index       */
+    int id_index_disabled;             /* 1 if ids are not sorted (the      */
+                                       /* search by id is then sequential)  */
+    struct t_gui_line *filter_job_line; /* next line to filter (backwards)  */
+                                       /* by a filter job (NULL if no job)  */
+    int filter_job_lines_done;         /* number of lines filtered by job   */
+    struct t_slab *line_slab;          /* allocator for lines               */
+    struct t_slab *line_data_slab;     /* allocator for lines data (only    */
+                                       /* for own lines of buffer)          */
+    struct t_gui_line_block *compressed_blocks; /* oldest lines compressed  */
+                                       /* (only for own lines of buffer)    */
+    struct t_gui_line_block *last_compressed_block; /* most recent block    */
+    int lines_compressed_count;        /* number of lines compressed        */
+    long long lines_compressed_size;   /* bytes used by compressed blocks   */
+    struct t_gui_line_block *segment_blocks; /* oldest blocks, saved in     */
+                                       /* segment file on disk              */
+    struct t_gui_line_block *last_segment_block; /* most recent block on    */
+                                       /* disk                              */
+    int lines_segment_count;           /* number of lines on disk           */
+    long long segment_size;            /* size of segment file              */
 };
 
+/* min number of lines scanned by a thread (see function gui_line_scan) */
+#define GUI_LINE_SCAN_MIN_LINES_THREAD 2048
+
+typedef int (t_gui_line_scan_cb)(void *data,
+                                 struct t_gui_line_data *line_data);
+
+/* line variables */
+
+extern __thread char **gui_line_buffer_no_color_prefix;
+extern __thread char **gui_line_buffer_no_color_message;
+
 /* line functions */
 
 extern struct t_gui_lines *gui_line_lines_alloc ();
 extern void gui_line_lines_free (struct t_gui_lines *lines);
+extern struct t_gui_line *gui_line_alloc (struct t_gui_lines *lines);
+extern struct t_gui_line_data *gui_line_alloc_data (struct t_gui_lines *lines);
+extern int gui_line_id_index_search_pos (struct t_gui_lines *lines, int id);
+extern void gui_line_id_index_disable (struct t_gui_lines *lines);
+extern void gui_line_id_index_rebuild (struct t_gui_lines *lines);
+extern void gui_line_id_index_add (struct t_gui_lines *lines,
+                                   struct t_gui_line *line);
+extern void gui_line_id_index_remove (struct t_gui_lines *lines,
+                                      struct t_gui_line *line);
 extern void gui_line_tags_alloc (struct t_gui_line_data *line_data,
                                  const char *tags);
 extern void gui_line_tags_free (struct t_gui_line_data *line_data);
+extern int gui_line_data_get_size (struct t_gui_line_data *line_data);
+extern void gui_line_size_add (struct t_gui_line_data *line_data);
+extern void gui_line_size_remove (struct t_gui_line_data *line_data);
+extern void gui_line_size_update (struct t_gui_line_data *line_data);
 extern void gui_line_get_prefix_for_display (struct t_gui_line *line,
                                              char **prefix, int *length,
                                              char **color, int *prefix_is_nick);
@@ -99,8 +162,15 @@ extern struct t_gui_line *gui_line_get_prev_displayed (struct t_gui_line *line);
 extern struct t_gui_line *gui_line_get_next_displayed (struct t_gui_line *line);
 extern struct t_gui_line *gui_line_search_by_id (struct t_gui_buffer *buffer,
                                                  int id);
+extern int gui_line_match_text (struct t_gui_line_data *line_data, int where,
+                                const char *text, int exact,
+                                int regex, regex_t *regex_compiled);
 extern int gui_line_search_text (struct t_gui_buffer *buffer,
                                  struct t_gui_line *line);
+extern void gui_line_free_buffers_no_color ();
+extern void gui_line_scan (struct t_gui_line_data **lines, int count,
+                           int max_threads, t_gui_line_scan_cb *callback,
+                           void *callback_data, char *results);
 extern int gui_line_match_regex (struct t_gui_line_data *line_data,
                                  regex_t *regex_prefix,
                                  regex_t *regex_message);
@@ -110,15 +180,31 @@ extern int gui_line_match_tags (struct t_gui_line_data *line_data,
 extern const char *gui_line_search_tag_starting_with (struct t_gui_line *line,
                                                       const char *tag);
 extern const char *gui_line_get_nick_tag (struct t_gui_line *line);
+extern int gui_line_has_highlight_words (struct t_string_highlight **highlight,
+                                         const char *string,
+                                         const char *words);
 extern int gui_line_has_highlight (struct t_gui_line *line);
 extern int gui_line_has_offline_nick (struct t_gui_line *line);
 extern int gui_line_is_action (struct t_gui_line *line);
 extern void gui_line_compute_buffer_max_length (struct t_gui_buffer *buffer,
                                                 struct t_gui_lines *lines);
+extern int gui_line_prefix_align_length (struct t_gui_line_data *line_data);
+extern void gui_line_prefix_length_reset (struct t_gui_lines *lines);
+extern void gui_line_prefix_length_add (struct t_gui_lines *lines,
+                                        int length);
+extern void gui_line_prefix_length_remove (struct t_gui_lines *lines,
+                                           int length);
+extern void gui_line_prefix_length_update (struct t_gui_line_data *line_data,
+                                           int old_length, int new_length);
+extern void gui_line_set_displayed (struct t_gui_line_data *line_data,
+                                    int displayed);
 extern void gui_line_compute_prefix_max_length (struct t_gui_lines *lines);
+extern void gui_line_mixed_remove_marked (struct t_gui_buffer *buffer,
+                                          struct t_gui_lines *lines);
 extern void gui_line_mixed_free_buffer (struct t_gui_buffer *buffer);
 extern void gui_line_mixed_free_all (struct t_gui_buffer *buffer);
 extern void gui_line_free_data (struct t_gui_line *line);
+extern void gui_line_free_new (struct t_gui_line *line);
 extern void gui_line_free (struct t_gui_buffer *buffer,
                            struct t_gui_line *line);
 extern void gui_line_free_all (struct t_gui_buffer *buffer);
@@ -142,6 +228,9 @@ extern void gui_line_hook_update (struct t_gui_line *line,
 extern void gui_line_add (struct t_gui_line *line);
 extern void gui_line_add_y (struct t_gui_line *line);
 extern void gui_line_clear (struct t_gui_line *line);
+extern void gui_line_mixed_insert_lines (struct t_gui_lines *mixed_lines,
+                                         struct t_gui_lines *lines_to_move,
+                                         struct t_gui_lines *lines_to_copy);
 extern void gui_line_mix_buffers (struct t_gui_buffer *buffer);
 extern struct t_hdata *gui_line_hdata_lines_cb (const void *pointer,
                                                 void *data,
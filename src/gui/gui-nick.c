@@ -24,6 +24,7 @@
 #endif
 
 #include <stdlib.h>
+#include <stdio.h>
 #include <stdint.h>
 #include <string.h>
 
@@ -32,10 +33,15 @@
 #include "../core/core-hashtable.h"
 #include "../core/core-string.h"
 #include "../core/core-utf8.h"
+#include "../plugins/plugin.h"
 #include "gui-nick.h"
 #include "gui-color.h"
 
 
+/* cache of nick color names (computed with WeeChat options) */
+struct t_hashtable *gui_nick_color_cache = NULL;
+
+
 /*
  * Hashes a string with a variant of djb2 hash, using 64-bit integer.
  *
@@ -240,6 +246,37 @@ gui_nick_strdup_for_color (const char *nickname)
     return result;
 }
 
+/*
+ * Clears cache of nick color names.
+ *
+ * This function must be called when an option used to compute the nick
+ * colors is changed.
+ */
+
+void
+gui_nick_color_cache_clear ()
+{
+    if (gui_nick_color_cache)
+        hashtable_remove_all (gui_nick_color_cache);
+}
+
+/*
+ * Builds key for cache of nick color names: "case_range:nickname".
+ *
+ * Returns 1 if key is OK, 0 if nickname is too long (not cached).
+ */
+
+int
+gui_nick_color_cache_key (const char *nickname, int case_range,
+                          char *key, int size_key)
+{
+    int length;
+
+    length = snprintf (key, size_key, "%d:%s", case_range, nickname);
+
+    return ((length >= 0) && (length < size_key)) ? 1 : 0;
+}
+
 /*
  * Finds a color name for a nick (according to nick letters).
  *
@@ -265,8 +302,8 @@ char *
 gui_nick_find_color_name (const char *nickname, int case_range,
                           const char *colors)
 {
-    int color, num_colors;
-    char *nickname2, *nickname3, **list_colors, *result;
+    int color, num_colors, cache_key;
+    char *nickname2, *nickname3, **list_colors, *result, key[256];
     const char *forced_color, *ptr_result;
     static char *default_color = "default";
 
@@ -275,10 +312,24 @@ gui_nick_find_color_name (const char *nickname, int case_range,
     nickname2 = NULL;
     nickname3 = NULL;
     ptr_result = NULL;
+    cache_key = 0;
 
     if (!nickname || !nickname[0])
         goto end;
 
+    /* color from WeeChat options: look in cache first */
+    if (!colors || !colors[0])
+    {
+        cache_key = gui_nick_color_cache_key (nickname, case_range,
+                                              key, sizeof (key));
+        if (cache_key && gui_nick_color_cache)
+        {
+            ptr_result = hashtable_get (gui_nick_color_cache, key);
+            if (ptr_result)
+                return strdup (ptr_result);
+        }
+    }
+
     if (colors && colors[0])
     {
         list_colors = string_split (colors, ",", NULL, 0, 0, &num_colors);
@@ -324,6 +375,23 @@ gui_nick_find_color_name (const char *nickname, int case_range,
 
 end:
     result = strdup ((ptr_result) ? ptr_result : default_color);
+    if (cache_key && result)
+    {
+        if (!gui_nick_color_cache)
+        {
+            gui_nick_color_cache = hashtable_new (
+                256,
+                WEECHAT_HASHTABLE_STRING,
+                WEECHAT_HASHTABLE_STRING,
+                NULL, NULL);
+        }
+        if (gui_nick_color_cache)
+        {
+            if (gui_nick_color_cache->items_count >= GUI_NICK_COLOR_CACHE_MAX)
+                hashtable_remove_all (gui_nick_color_cache);
+            hashtable_set (gui_nick_color_cache, key, result);
+        }
+    }
     string_free_split (list_colors);
     free (nickname2);
     free (nickname3);
@@ -362,3 +430,17 @@ gui_nick_find_color (const char *nickname, int case_range, const char *colors)
     free (color);
     return (ptr_result) ? strdup (ptr_result) : NULL;
 }
+
+/*
+ * Frees all allocated data.
+ */
+
+void
+gui_nick_end ()
+{
+    if (gui_nick_color_cache)
+    {
+        hashtable_free (gui_nick_color_cache);
+        gui_nick_color_cache = NULL;
+    }
+}
@@ -20,9 +20,18 @@
 #ifndef WEECHAT_GUI_NICK_H
 #define WEECHAT_GUI_NICK_H
 
+struct t_hashtable;
+
+/* max number of nicks in cache of colors (cache is cleared when full) */
+#define GUI_NICK_COLOR_CACHE_MAX 4096
+
+extern struct t_hashtable *gui_nick_color_cache;
+
+extern void gui_nick_color_cache_clear ();
 extern char *gui_nick_find_color_name (const char *nickname, int case_range,
                                        const char *colors);
 extern char *gui_nick_find_color (const char *nickname, int case_range,
                                   const char *colors);
+extern void gui_nick_end ();
 
 #endif /* WEECHAT_GUI_NICK_H */
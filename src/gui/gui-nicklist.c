@@ -34,6 +34,7 @@
 #include <ctype.h>
 
 #include "../core/weechat.h"
+#include "../core/core-arraylist.h"
 #include "../core/core-config.h"
 #include "../core/core-hashtable.h"
 #include "../core/core-hdata.h"
@@ -93,6 +94,10 @@ gui_nicklist_send_hsignal (const char *signal, struct t_gui_buffer *buffer,
                            struct t_gui_nick_group *group,
                            struct t_gui_nick *nick)
 {
+    /* no hook for this hsignal? then do not build the hashtable */
+    if (!hook_hsignal_has_hooks (signal))
+        return;
+
     if (!gui_nicklist_hsignal)
     {
         gui_nicklist_hsignal = hashtable_new (32,
@@ -181,6 +186,121 @@ gui_nicklist_insert_group_sorted (struct t_gui_nick_group **groups,
     }
 }
 
+/*
+ * Checks if a group is the group "from_group" or one of its descendants
+ * (if "from_group" is NULL, any group matches).
+ *
+ * Returns:
+ *   1: group is in "from_group"
+ *   0: group is not in "from_group"
+ */
+
+int
+gui_nicklist_group_is_in_group (struct t_gui_nick_group *group,
+                                struct t_gui_nick_group *from_group)
+{
+    struct t_gui_nick_group *ptr_group;
+
+    if (!from_group)
+        return 1;
+
+    for (ptr_group = group; ptr_group; ptr_group = ptr_group->parent)
+    {
+        if (ptr_group == from_group)
+            return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * Adds a group in hashtables "nicklist_groups_by_id" and
+ * "nicklist_groups_by_name" of buffer.
+ *
+ * Groups are indexed by name without the optional digits and '|' used to
+ * sort them (for example "01|op" and "op" have the same key: "op"); groups
+ * with same key are chained with the pointer "next_by_name".
+ */
+
+void
+gui_nicklist_group_index_add (struct t_gui_buffer *buffer,
+                              struct t_gui_nick_group *group)
+{
+    struct t_gui_nick_group *ptr_group;
+    const char *key;
+
+    group->next_by_name = NULL;
+
+    if (buffer->nicklist_groups_by_id)
+        hashtable_set (buffer->nicklist_groups_by_id, &group->id, group);
+
+    if (buffer->nicklist_groups_by_name)
+    {
+        key = gui_nicklist_get_group_start (group->name);
+        ptr_group = hashtable_get (buffer->nicklist_groups_by_name, key);
+        if (ptr_group)
+        {
+            while (ptr_group->next_by_name)
+            {
+                ptr_group = ptr_group->next_by_name;
+            }
+            ptr_group->next_by_name = group;
+        }
+        else
+        {
+            hashtable_set (buffer->nicklist_groups_by_name, key, group);
+        }
+    }
+}
+
+/*
+ * Removes a group from hashtables "nicklist_groups_by_id" and
+ * "nicklist_groups_by_name" of buffer.
+ */
+
+void
+gui_nicklist_group_index_remove (struct t_gui_buffer *buffer,
+                                 struct t_gui_nick_group *group)
+{
+    struct t_gui_nick_group *ptr_group;
+    const char *key;
+
+    if (buffer->nicklist_groups_by_id
+        && (hashtable_get (buffer->nicklist_groups_by_id, &group->id) == group))
+    {
+        hashtable_remove (buffer->nicklist_groups_by_id, &group->id);
+    }
+
+    if (buffer->nicklist_groups_by_name)
+    {
+        key = gui_nicklist_get_group_start (group->name);
+        ptr_group = hashtable_get (buffer->nicklist_groups_by_name, key);
+        if (ptr_group == group)
+        {
+            if (group->next_by_name)
+            {
+                hashtable_set (buffer->nicklist_groups_by_name, key,
+                               group->next_by_name);
+            }
+            else
+            {
+                hashtable_remove (buffer->nicklist_groups_by_name, key);
+            }
+        }
+        else
+        {
+            while (ptr_group && (ptr_group->next_by_name != group))
+            {
+                ptr_group = ptr_group->next_by_name;
+            }
+            if (ptr_group)
+                ptr_group->next_by_name = group->next_by_name;
+        }
+    }
+
+    group->next_by_name = NULL;
+}
+
 /*
  * Searches for a group in nicklist by id (this function must not be called
  * directly).
@@ -195,6 +315,14 @@ gui_nicklist_search_group_id (struct t_gui_buffer *buffer,
 {
     struct t_gui_nick_group *ptr_group, *ptr_group_found;
 
+    if (buffer && buffer->nicklist_groups_by_id)
+    {
+        ptr_group = hashtable_get (buffer->nicklist_groups_by_id, &id);
+        return (ptr_group
+                && gui_nicklist_group_is_in_group (ptr_group, from_group)) ?
+            ptr_group : NULL;
+    }
+
     if (!from_group)
         from_group = buffer->nicklist_root;
 
@@ -235,6 +363,23 @@ gui_nicklist_search_group_name (struct t_gui_buffer *buffer,
     struct t_gui_nick_group *ptr_group, *ptr_group_found;
     const char *ptr_name;
 
+    if (buffer && buffer->nicklist_groups_by_name)
+    {
+        for (ptr_group = hashtable_get (buffer->nicklist_groups_by_name,
+                                        gui_nicklist_get_group_start (name));
+             ptr_group; ptr_group = ptr_group->next_by_name)
+        {
+            ptr_name = (skip_digits) ?
+                gui_nicklist_get_group_start (ptr_group->name) : ptr_group->name;
+            if ((strcmp (ptr_name, name) == 0)
+                && gui_nicklist_group_is_in_group (ptr_group, from_group))
+            {
+                return ptr_group;
+            }
+        }
+        return NULL;
+    }
+
     if (!from_group)
         from_group = buffer->nicklist_root;
 
@@ -361,9 +506,13 @@ gui_nicklist_add_group_with_id (struct t_gui_buffer *buffer, long long id,
     new_group->last_child = NULL;
     new_group->nicks = NULL;
     new_group->last_nick = NULL;
+    new_group->nicks_sorted = NULL;
     new_group->prev_group = NULL;
     new_group->next_group = NULL;
 
+    gui_nicklist_group_index_add (buffer, new_group);
+    buffer->nicklist_size += sizeof (*new_group);
+
     if (new_group->parent)
     {
         gui_nicklist_insert_group_sorted (&(new_group->parent->children),
@@ -412,6 +561,40 @@ gui_nicklist_add_group (struct t_gui_buffer *buffer,
         visible);
 }
 
+/*
+ * Searches for index of a nick name in the sorted array of nicks of a group
+ * (binary search).
+ *
+ * If "after_equal" is 1, returns index of first nick with a name greater
+ * than "name" (position to insert a new nick after nicks with same name),
+ * otherwise returns index of first nick with a name greater than or equal
+ * to "name".
+ */
+
+int
+gui_nicklist_nick_sorted_index (struct t_gui_nick_group *group,
+                                const char *name, int after_equal)
+{
+    struct t_gui_nick *ptr_nick;
+    int low, high, middle, rc;
+
+    low = 0;
+    high = arraylist_size (group->nicks_sorted);
+    while (low < high)
+    {
+        middle = low + ((high - low) / 2);
+        ptr_nick = (struct t_gui_nick *)arraylist_get (group->nicks_sorted,
+                                                       middle);
+        rc = string_strcasecmp (name, ptr_nick->name);
+        if ((rc > 0) || (after_equal && (rc == 0)))
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return low;
+}
+
 /*
  * Searches for position of a nick (to keep nicklist sorted).
  */
@@ -420,19 +603,13 @@ struct t_gui_nick *
 gui_nicklist_find_pos_nick (struct t_gui_nick_group *group,
                             struct t_gui_nick *nick)
 {
-    struct t_gui_nick *ptr_nick;
-
     if (!group)
         return NULL;
 
-    for (ptr_nick = group->nicks; ptr_nick; ptr_nick = ptr_nick->next_nick)
-    {
-        if (string_strcasecmp (nick->name, ptr_nick->name) < 0)
-            return ptr_nick;
-    }
-
-    /* nick will be inserted at end of list */
-    return NULL;
+    /* NULL if nick will be inserted at end of list */
+    return (struct t_gui_nick *)arraylist_get (
+        group->nicks_sorted,
+        gui_nicklist_nick_sorted_index (group, nick->name, 1));
 }
 
 /*
@@ -444,10 +621,20 @@ gui_nicklist_insert_nick_sorted (struct t_gui_nick_group *group,
                                  struct t_gui_nick *nick)
 {
     struct t_gui_nick *pos_nick;
+    int index;
+
+    if (!group->nicks_sorted)
+    {
+        group->nicks_sorted = arraylist_new (16, 0, 1,
+                                             NULL, NULL, NULL, NULL);
+    }
+    index = gui_nicklist_nick_sorted_index (group, nick->name, 1);
+    arraylist_insert (group->nicks_sorted, index, nick);
 
     if (group->nicks)
     {
-        pos_nick = gui_nicklist_find_pos_nick (group, nick);
+        pos_nick = (struct t_gui_nick *)arraylist_get (group->nicks_sorted,
+                                                       index + 1);
 
         if (pos_nick)
         {
@@ -478,6 +665,148 @@ gui_nicklist_insert_nick_sorted (struct t_gui_nick_group *group,
     }
 }
 
+/*
+ * Removes nick from the sorted array of nicks of its group.
+ */
+
+void
+gui_nicklist_remove_nick_sorted (struct t_gui_nick *nick)
+{
+    struct t_gui_nick_group *group;
+    int index, size;
+
+    group = nick->group;
+    size = arraylist_size (group->nicks_sorted);
+    for (index = gui_nicklist_nick_sorted_index (group, nick->name, 0);
+         index < size; index++)
+    {
+        if (arraylist_get (group->nicks_sorted, index) == nick)
+        {
+            arraylist_remove (group->nicks_sorted, index);
+            break;
+        }
+    }
+}
+
+/*
+ * Returns the key used to index a nick in hashtable "nicklist_nicks_by_name"
+ * of buffer: nick name in lower case, with chars "[\]^" replaced by "{|}~"
+ * (like IRC casemapping "rfc1459"), so that nicks considered equal by the
+ * buffer "nickcmp" callback have the same key.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+gui_nicklist_nick_name_key (const char *name)
+{
+    char *key, *ptr_key;
+
+    key = string_tolower (name);
+    if (!key)
+        return NULL;
+
+    for (ptr_key = key; ptr_key[0]; ptr_key++)
+    {
+        if ((ptr_key[0] >= '[') && (ptr_key[0] <= '^'))
+            ptr_key[0] += ('{' - '[');
+    }
+
+    return key;
+}
+
+/*
+ * Adds a nick in hashtables "nicklist_nicks_by_id" and
+ * "nicklist_nicks_by_name" of buffer (nicks with same key are chained with
+ * the pointer "next_by_name").
+ */
+
+void
+gui_nicklist_nick_index_add (struct t_gui_buffer *buffer,
+                             struct t_gui_nick *nick)
+{
+    struct t_gui_nick *ptr_nick;
+    char *key;
+
+    nick->next_by_name = NULL;
+
+    if (buffer->nicklist_nicks_by_id)
+        hashtable_set (buffer->nicklist_nicks_by_id, &nick->id, nick);
+
+    if (buffer->nicklist_nicks_by_name)
+    {
+        key = gui_nicklist_nick_name_key (nick->name);
+        if (!key)
+            return;
+        ptr_nick = hashtable_get (buffer->nicklist_nicks_by_name, key);
+        if (ptr_nick)
+        {
+            while (ptr_nick->next_by_name)
+            {
+                ptr_nick = ptr_nick->next_by_name;
+            }
+            ptr_nick->next_by_name = nick;
+        }
+        else
+        {
+            hashtable_set (buffer->nicklist_nicks_by_name, key, nick);
+        }
+        free (key);
+    }
+}
+
+/*
+ * Removes a nick from hashtables "nicklist_nicks_by_id" and
+ * "nicklist_nicks_by_name" of buffer.
+ */
+
+void
+gui_nicklist_nick_index_remove (struct t_gui_buffer *buffer,
+                                struct t_gui_nick *nick)
+{
+    struct t_gui_nick *ptr_nick;
+    char *key;
+
+    if (buffer->nicklist_nicks_by_id
+        && (hashtable_get (buffer->nicklist_nicks_by_id, &nick->id) == nick))
+    {
+        hashtable_remove (buffer->nicklist_nicks_by_id, &nick->id);
+    }
+
+    if (buffer->nicklist_nicks_by_name)
+    {
+        key = gui_nicklist_nick_name_key (nick->name);
+        if (key)
+        {
+            ptr_nick = hashtable_get (buffer->nicklist_nicks_by_name, key);
+            if (ptr_nick == nick)
+            {
+                if (nick->next_by_name)
+                {
+                    hashtable_set (buffer->nicklist_nicks_by_name, key,
+                                   nick->next_by_name);
+                }
+                else
+                {
+                    hashtable_remove (buffer->nicklist_nicks_by_name, key);
+                }
+            }
+            else
+            {
+                while (ptr_nick && (ptr_nick->next_by_name != nick))
+                {
+                    ptr_nick = ptr_nick->next_by_name;
+                }
+                if (ptr_nick)
+                    ptr_nick->next_by_name = nick->next_by_name;
+            }
+            free (key);
+        }
+    }
+
+    nick->next_by_name = NULL;
+}
+
 /*
  * Searches for a nick in nicklist by id (this function must not be called
  * directly).
@@ -493,6 +822,15 @@ gui_nicklist_search_nick_id (struct t_gui_buffer *buffer,
     struct t_gui_nick *ptr_nick;
     struct t_gui_nick_group *ptr_group;
 
+    if (buffer->nicklist_nicks_by_id)
+    {
+        ptr_nick = hashtable_get (buffer->nicklist_nicks_by_id, &id);
+        return (ptr_nick
+                && gui_nicklist_group_is_in_group (ptr_nick->group,
+                                                   from_group)) ?
+            ptr_nick : NULL;
+    }
+
     for (ptr_nick = (from_group) ? from_group->nicks : buffer->nicklist_root->nicks;
          ptr_nick; ptr_nick = ptr_nick->next_nick)
     {
@@ -527,6 +865,36 @@ gui_nicklist_search_nick_name (struct t_gui_buffer *buffer,
 {
     struct t_gui_nick *ptr_nick;
     struct t_gui_nick_group *ptr_group;
+    char *key;
+
+    if (buffer->nicklist_nicks_by_name)
+    {
+        key = gui_nicklist_nick_name_key (name);
+        if (!key)
+            return NULL;
+        for (ptr_nick = hashtable_get (buffer->nicklist_nicks_by_name, key);
+             ptr_nick; ptr_nick = ptr_nick->next_by_name)
+        {
+            if (!gui_nicklist_group_is_in_group (ptr_nick->group, from_group))
+                continue;
+            if (buffer->nickcmp_callback)
+            {
+                if ((buffer->nickcmp_callback) (buffer->nickcmp_callback_pointer,
+                                                buffer->nickcmp_callback_data,
+                                                buffer,
+                                                ptr_nick->name,
+                                                name) == 0)
+                    break;
+            }
+            else
+            {
+                if (strcmp (ptr_nick->name, name) == 0)
+                    break;
+            }
+        }
+        free (key);
+        return ptr_nick;
+    }
 
     for (ptr_nick = (from_group) ? from_group->nicks : buffer->nicklist_root->nicks;
          ptr_nick; ptr_nick = ptr_nick->next_nick)
@@ -625,8 +993,11 @@ gui_nicklist_add_nick_with_id (struct t_gui_buffer *buffer, long long id,
 
     gui_nicklist_insert_nick_sorted (new_nick->group, new_nick);
 
+    gui_nicklist_nick_index_add (buffer, new_nick);
+
     buffer->nicklist_count++;
     buffer->nicklist_nicks_count++;
+    buffer->nicklist_size += sizeof (*new_nick);
 
     if (visible)
     {
@@ -688,7 +1059,10 @@ gui_nicklist_remove_nick (struct t_gui_buffer *buffer,
     gui_nicklist_send_signal ("nicklist_nick_removing", buffer, nick_removed);
     gui_nicklist_send_hsignal ("nicklist_nick_removing", buffer, NULL, nick);
 
+    gui_nicklist_nick_index_remove (buffer, nick);
+
     /* remove nick from list */
+    gui_nicklist_remove_nick_sorted (nick);
     if (nick->prev_nick)
         (nick->prev_nick)->next_nick = nick->next_nick;
     if (nick->next_nick)
@@ -706,6 +1080,7 @@ gui_nicklist_remove_nick (struct t_gui_buffer *buffer,
 
     buffer->nicklist_count--;
     buffer->nicklist_nicks_count--;
+    buffer->nicklist_size -= sizeof (*nick);
 
     if (nick->visible)
     {
@@ -755,6 +1130,8 @@ gui_nicklist_remove_group (struct t_gui_buffer *buffer,
     gui_nicklist_send_signal ("nicklist_group_removing", buffer, group_removed);
     gui_nicklist_send_hsignal ("nicklist_group_removing", buffer, group, NULL);
 
+    gui_nicklist_group_index_remove (buffer, group);
+
     if (group->parent)
     {
         /* remove group from list */
@@ -778,6 +1155,9 @@ gui_nicklist_remove_group (struct t_gui_buffer *buffer,
     /* free data */
     string_shared_free (group->name);
     string_shared_free (group->color);
+    arraylist_free (group->nicks_sorted);
+
+    buffer->nicklist_size -= sizeof (*group);
 
     if (buffer->nicklist_display_groups && group->visible)
     {
@@ -1054,7 +1434,9 @@ gui_nicklist_group_set (struct t_gui_buffer *buffer,
             && (id != group->id)
             && !gui_nicklist_search_group_id (buffer, NULL, id))
         {
+            gui_nicklist_group_index_remove (buffer, group);
             group->id = id;
+            gui_nicklist_group_index_add (buffer, group);
             group_changed = 1;
         }
     }
@@ -1176,7 +1558,9 @@ gui_nicklist_nick_set (struct t_gui_buffer *buffer,
             && (id != nick->id)
             && !gui_nicklist_search_nick_id (buffer, NULL, id))
         {
+            gui_nicklist_nick_index_remove (buffer, nick);
             nick->id = id;
+            gui_nicklist_nick_index_add (buffer, nick);
             nick_changed = 1;
         }
     }
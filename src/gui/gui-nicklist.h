@@ -20,6 +20,7 @@
 #ifndef WEECHAT_GUI_NICKLIST_H
 #define WEECHAT_GUI_NICKLIST_H
 
+struct t_arraylist;
 struct t_gui_buffer;
 struct t_infolist;
 
@@ -35,8 +36,12 @@ struct t_gui_nick_group
     struct t_gui_nick_group *last_child; /* last child                      */
     struct t_gui_nick *nicks;          /* nicks for group                   */
     struct t_gui_nick *last_nick;      /* last nick for group               */
+    struct t_arraylist *nicks_sorted;  /* nicks sorted by name (for binary  */
+                                       /* search of position of new nick)   */
     struct t_gui_nick_group *prev_group; /* link to previous group          */
     struct t_gui_nick_group *next_group; /* link to next group              */
+    struct t_gui_nick_group *next_by_name; /* next group with same key in   */
+                                       /* buffer->nicklist_groups_by_name   */
 };
 
 struct t_gui_nick
@@ -50,6 +55,8 @@ struct t_gui_nick
     int visible;                       /* 1 if nick is displayed            */
     struct t_gui_nick *prev_nick;      /* link to previous nick             */
     struct t_gui_nick *next_nick;      /* link to next nick                 */
+    struct t_gui_nick *next_by_name;   /* next nick with same key in        */
+                                       /* buffer->nicklist_nicks_by_name    */
 };
 
 /* nicklist functions */
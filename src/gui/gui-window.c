@@ -54,6 +54,7 @@
 #include "gui-hotlist.h"
 #include "gui-layout.h"
 #include "gui-line.h"
+#include "gui-line-compress.h"
 
 
 int gui_init_ok = 0;                            /* = 1 if GUI is initialized*/
@@ -1177,7 +1178,7 @@ gui_window_scroll (struct t_gui_window *window, char *scroll)
 {
     int direction, stop, count_msg, scroll_from_end_free_buffer;
     char time_letter, saved_char;
-    time_t old_date, diff_date;
+    time_t old_date, diff_date, line_date_value;
     char *pos, *error;
     long number;
     struct t_gui_line *ptr_line;
@@ -1281,12 +1282,15 @@ gui_window_scroll (struct t_gui_window *window, char *scroll)
         if (!date_tmp)
             return;
         memcpy (&old_line_date, date_tmp, sizeof (struct tm));
+        memcpy (&line_date, &old_line_date, sizeof (struct tm));
+        line_date_value = old_date;
     }
 
     while (ptr_line)
     {
         ptr_line = (direction < 0) ?
-            gui_line_get_prev_displayed (ptr_line) : gui_line_get_next_displayed (ptr_line);
+            gui_line_uncompress_get_prev_displayed (ptr_line) :
+            gui_line_get_next_displayed (ptr_line);
 
         if (ptr_line
             && ((window->buffer->type != GUI_BUFFER_TYPE_FORMATTED)
@@ -1300,10 +1304,20 @@ gui_window_scroll (struct t_gui_window *window, char *scroll)
             }
             else
             {
-                date_tmp = localtime (&(ptr_line->data->date));
-                if (!date_tmp)
-                    return;
-                memcpy (&line_date, date_tmp, sizeof (struct tm));
+                /*
+                 * the local date is needed only to scroll to a different
+                 * second/minute/hour/day/month/year (number == 0), and it is
+                 * computed only if the line date is not the same as the
+                 * previous line (many lines have the same date)
+                 */
+                if ((number == 0) && (ptr_line->data->date != line_date_value))
+                {
+                    date_tmp = localtime (&(ptr_line->data->date));
+                    if (!date_tmp)
+                        return;
+                    memcpy (&line_date, date_tmp, sizeof (struct tm));
+                    line_date_value = ptr_line->data->date;
+                }
                 if (old_date > ptr_line->data->date)
                     diff_date = old_date - ptr_line->data->date;
                 else
@@ -1505,7 +1519,8 @@ gui_window_scroll_previous_highlight (struct t_gui_window *window)
         if (window->buffer->lines->first_line)
         {
             ptr_line = (window->scroll->start_line) ?
-                window->scroll->start_line->prev_line : window->buffer->lines->last_line;
+                gui_line_uncompress_get_prev_line (window->scroll->start_line) :
+                window->buffer->lines->last_line;
             while (ptr_line)
             {
                 if (ptr_line->data->highlight)
@@ -1517,7 +1532,7 @@ gui_window_scroll_previous_highlight (struct t_gui_window *window)
                     gui_buffer_ask_chat_refresh (window->buffer, 2);
                     return;
                 }
-                ptr_line = ptr_line->prev_line;
+                ptr_line = gui_line_uncompress_get_prev_line (ptr_line);
             }
             /* no previous highlight, scroll to bottom */
             gui_window_scroll_bottom (window);
@@ -1595,6 +1610,109 @@ gui_window_scroll_unread (struct t_gui_window *window)
     }
 }
 
+/*
+ * Callback used to search text in a line (called by gui_line_scan, possibly
+ * in a thread).
+ */
+
+int
+gui_window_search_text_scan_cb (void *data, struct t_gui_line_data *line_data)
+{
+    struct t_gui_buffer *buffer;
+
+    buffer = (struct t_gui_buffer *)data;
+
+    return gui_line_match_text (line_data,
+                                buffer->text_search_where,
+                                buffer->input_buffer,
+                                buffer->text_search_exact,
+                                buffer->text_search_regex,
+                                buffer->text_search_regex_compiled);
+}
+
+/*
+ * Searches for text in displayed lines of buffer, starting with "line"
+ * (included) and going backward or forward.
+ *
+ * Lines are checked by blocks (in threads if the block has many lines, see
+ * function gui_line_scan); the first block is small because the text is
+ * often found in lines near the start.
+ *
+ * Returns pointer to the first line found, NULL if not found.
+ */
+
+struct t_gui_line *
+gui_window_search_text_lines (struct t_gui_buffer *buffer,
+                              struct t_gui_line *line, int backward)
+{
+    struct t_gui_line **lines, **new_lines, *ptr_line, *line_found;
+    struct t_gui_line_data **lines_data, **new_lines_data;
+    char *results, *new_results;
+    int i, count, block_size;
+
+    lines = NULL;
+    lines_data = NULL;
+    results = NULL;
+    line_found = NULL;
+    block_size = GUI_WINDOW_SEARCH_FIRST_BLOCK;
+
+    ptr_line = line;
+    while (ptr_line && !line_found)
+    {
+        new_lines = realloc (lines, block_size * sizeof (*lines));
+        if (new_lines)
+            lines = new_lines;
+        new_lines_data = realloc (lines_data,
+                                  block_size * sizeof (*lines_data));
+        if (new_lines_data)
+            lines_data = new_lines_data;
+        new_results = realloc (results, block_size);
+        if (new_results)
+            results = new_results;
+        if (!new_lines || !new_lines_data || !new_results)
+        {
+            /* not enough memory: search line by line */
+            while (ptr_line && !gui_line_search_text (buffer, ptr_line))
+            {
+                ptr_line = (backward) ?
+                    gui_line_get_prev_displayed (ptr_line) :
+                    gui_line_get_next_displayed (ptr_line);
+            }
+            line_found = ptr_line;
+            break;
+        }
+        count = 0;
+        while (ptr_line && (count < block_size))
+        {
+            lines[count] = ptr_line;
+            lines_data[count] = ptr_line->data;
+            count++;
+            ptr_line = (backward) ?
+                gui_line_get_prev_displayed (ptr_line) :
+                gui_line_get_next_displayed (ptr_line);
+        }
+        gui_line_scan (lines_data, count,
+                       CONFIG_INTEGER(config_look_scan_threads),
+                       &gui_window_search_text_scan_cb, buffer, results);
+        for (i = 0; i < count; i++)
+        {
+            if (results[i])
+            {
+                line_found = lines[i];
+                break;
+            }
+        }
+        if (block_size < GUI_WINDOW_SEARCH_MAX_BLOCK)
+            block_size *= 2;
+    }
+
+    free (lines);
+    free (lines_data);
+    free (results);
+
+    return line_found;
+}
+
 /*
  * Searches for text in buffer lines or commands history.
  *
@@ -1624,18 +1742,16 @@ gui_window_search_text (struct t_gui_window *window)
                     ptr_line = (window->scroll->start_line) ?
                         gui_line_get_prev_displayed (window->scroll->start_line) :
                         gui_line_get_last_displayed (window->buffer);
-                    while (ptr_line)
+                    ptr_line = gui_window_search_text_lines (window->buffer,
+                                                             ptr_line, 1);
+                    if (ptr_line)
                     {
-                        if (gui_line_search_text (window->buffer, ptr_line))
-                        {
-                            window->scroll->start_line = ptr_line;
-                            window->scroll->start_line_pos = 0;
-                            window->scroll->first_line_displayed =
-                                (window->scroll->start_line == gui_line_get_first_displayed (window->buffer));
-                            gui_buffer_ask_chat_refresh (window->buffer, 2);
-                            return 1;
-                        }
-                        ptr_line = gui_line_get_prev_displayed (ptr_line);
+                        window->scroll->start_line = ptr_line;
+                        window->scroll->start_line_pos = 0;
+                        window->scroll->first_line_displayed =
+                            (window->scroll->start_line == gui_line_get_first_displayed (window->buffer));
+                        gui_buffer_ask_chat_refresh (window->buffer, 2);
+                        return 1;
                     }
                 }
             }
@@ -1647,18 +1763,16 @@ gui_window_search_text (struct t_gui_window *window)
                     ptr_line = (window->scroll->start_line) ?
                         gui_line_get_next_displayed (window->scroll->start_line) :
                         gui_line_get_first_displayed (window->buffer);
-                    while (ptr_line)
+                    ptr_line = gui_window_search_text_lines (window->buffer,
+                                                             ptr_line, 0);
+                    if (ptr_line)
                     {
-                        if (gui_line_search_text (window->buffer, ptr_line))
-                        {
-                            window->scroll->start_line = ptr_line;
-                            window->scroll->start_line_pos = 0;
-                            window->scroll->first_line_displayed =
-                                (window->scroll->start_line == window->buffer->lines->first_line);
-                            gui_buffer_ask_chat_refresh (window->buffer, 2);
-                            return 1;
-                        }
-                        ptr_line = gui_line_get_next_displayed (ptr_line);
+                        window->scroll->start_line = ptr_line;
+                        window->scroll->start_line_pos = 0;
+                        window->scroll->first_line_displayed =
+                            (window->scroll->start_line == window->buffer->lines->first_line);
+                        gui_buffer_ask_chat_refresh (window->buffer, 2);
+                        return 1;
                     }
                 }
             }
@@ -1688,6 +1802,10 @@ gui_window_search_start (struct t_gui_window *window, int search,
 
     window->buffer->text_search = search;
 
+    /* search is done in all lines: compressed lines are uncompressed */
+    if (window->buffer->text_search == GUI_BUFFER_SEARCH_LINES)
+        (void) gui_line_uncompress_lines (window->buffer, -1);
+
     switch (window->buffer->text_search)
     {
         case GUI_BUFFER_SEARCH_DISABLED:
@@ -1848,7 +1966,7 @@ gui_window_search_stop (struct t_gui_window *window, int stop_here)
     window->buffer->text_search_direction = GUI_BUFFER_SEARCH_DIR_BACKWARD;
     if (window->buffer->text_search_regex_compiled)
     {
-        regfree (window->buffer->text_search_regex_compiled);
+        string_regfree (window->buffer->text_search_regex_compiled);
         free (window->buffer->text_search_regex_compiled);
         window->buffer->text_search_regex_compiled = NULL;
     }
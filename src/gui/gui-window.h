@@ -24,6 +24,10 @@ struct t_infolist;
 struct t_gui_bar_window;
 struct t_gui_line_data;
 
+/* lines scanned at once by text search (first block, then doubled) */
+#define GUI_WINDOW_SEARCH_FIRST_BLOCK 1024
+#define GUI_WINDOW_SEARCH_MAX_BLOCK   65536
+
 /* window structures */
 
 struct t_gui_window_coords
@@ -193,6 +197,9 @@ extern void gui_window_search_start (struct t_gui_window *window,
                                      struct t_gui_line *text_search_start_line);
 extern void gui_window_search_restart (struct t_gui_window *window);
 extern void gui_window_search_stop (struct t_gui_window *window, int stop_here);
+extern struct t_gui_line *gui_window_search_text_lines (struct t_gui_buffer *buffer,
+                                                       struct t_gui_line *line,
+                                                       int backward);
 extern int gui_window_search_text (struct t_gui_window *window);
 extern void gui_window_zoom (struct t_gui_window *window);
 extern struct t_hdata *gui_window_hdata_window_cb (const void *pointer,
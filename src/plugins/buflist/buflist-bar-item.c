@@ -39,6 +39,8 @@ struct t_arraylist *buflist_list_buffers[BUFLIST_BAR_NUM_ITEMS] =
 
 int old_line_number_current_buffer[BUFLIST_BAR_NUM_ITEMS] =
 { -1, -1, -1, -1, -1 };
+struct t_hashtable *buflist_bar_item_lines[BUFLIST_BAR_NUM_ITEMS] =
+{ NULL, NULL, NULL, NULL, NULL };
 
 
 /*
@@ -140,6 +142,170 @@ buflist_bar_item_update (int index, int force)
     }
 }
 
+/*
+ * Invalidates lines evaluated for a buffer in all bar items (the line is
+ * evaluated again on next refresh of bar item).
+ *
+ * If buffer is NULL, lines of all buffers are invalidated.
+ */
+
+void
+buflist_bar_item_lines_invalidate (struct t_gui_buffer *buffer)
+{
+    int i;
+
+    for (i = 0; i < BUFLIST_BAR_NUM_ITEMS; i++)
+    {
+        if (!buflist_bar_item_lines[i])
+            continue;
+        if (buffer)
+            weechat_hashtable_remove (buflist_bar_item_lines[i], buffer);
+        else
+            weechat_hashtable_remove_all (buflist_bar_item_lines[i]);
+    }
+}
+
+/*
+ * Frees a line evaluated for a buffer (callback called when a line is
+ * removed from hashtable).
+ */
+
+void
+buflist_bar_item_free_line_cb (struct t_hashtable *hashtable,
+                               const void *key, void *value)
+{
+    struct t_buflist_bar_item_line *ptr_line;
+
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    ptr_line = (struct t_buflist_bar_item_line *)value;
+    if (!ptr_line)
+        return;
+
+    free (ptr_line->signature);
+    free (ptr_line->line);
+    free (ptr_line);
+}
+
+/*
+ * Computes number of lines and max length of lines on screen for a line
+ * evaluated (the line can contain newlines).
+ */
+
+void
+buflist_bar_item_line_compute_size (struct t_buflist_bar_item_line *line)
+{
+    const char *ptr_line, *pos;
+    char *str_line;
+    int length;
+
+    if (!line)
+        return;
+
+    line->lines = 0;
+    line->max_length = 0;
+
+    if (!line->line)
+        return;
+
+    ptr_line = line->line;
+    while (ptr_line)
+    {
+        line->lines++;
+        pos = strchr (ptr_line, '\n');
+        if (pos)
+        {
+            str_line = weechat_strndup (ptr_line, pos - ptr_line);
+            length = weechat_strlen_screen (str_line);
+            free (str_line);
+            ptr_line = pos + 1;
+        }
+        else
+        {
+            length = weechat_strlen_screen (ptr_line);
+            ptr_line = NULL;
+        }
+        if (length > line->max_length)
+            line->max_length = length;
+    }
+}
+
+/*
+ * Returns line evaluated for a buffer in a bar item.
+ *
+ * The line is reused if variables have the same values as the last time the
+ * line was evaluated (and if the line was not invalidated by a signal),
+ * otherwise the display conditions and the line are evaluated and saved for
+ * next refresh of bar item.
+ *
+ * Returns NULL if error.
+ */
+
+struct t_buflist_bar_item_line *
+buflist_bar_item_get_line (int item_index, struct t_gui_buffer *buffer,
+                           const char *format)
+{
+    struct t_buflist_bar_item_line *ptr_line;
+    char **signature, *condition;
+    const char *ptr_values;
+
+    signature = weechat_string_dyn_alloc (256);
+    if (!signature)
+        return NULL;
+    ptr_values = weechat_hashtable_get_string (buflist_hashtable_extra_vars,
+                                               "values");
+    weechat_string_dyn_concat (signature, ptr_values, -1);
+    weechat_string_dyn_concat (signature, "\n", -1);
+    ptr_values = weechat_hashtable_get_string (buflist_hashtable_pointers,
+                                               "values");
+    weechat_string_dyn_concat (signature, ptr_values, -1);
+
+    ptr_line = weechat_hashtable_get (buflist_bar_item_lines[item_index],
+                                      buffer);
+    if (ptr_line && (strcmp (ptr_line->signature, *signature) == 0))
+    {
+        weechat_string_dyn_free (signature, 1);
+        return ptr_line;
+    }
+
+    ptr_line = malloc (sizeof (*ptr_line));
+    if (!ptr_line)
+    {
+        weechat_string_dyn_free (signature, 1);
+        return NULL;
+    }
+    ptr_line->signature = weechat_string_dyn_free (signature, 0);
+
+    /* check condition: if false, the buffer is not displayed */
+    condition = weechat_string_eval_expression (
+        weechat_config_string (buflist_config_look_display_conditions),
+        buflist_hashtable_pointers,
+        buflist_hashtable_extra_vars,
+        buflist_hashtable_options_conditions);
+    ptr_line->displayed = (condition && (strcmp (condition, "1") == 0));
+    free (condition);
+
+    /* build string */
+    ptr_line->line = (ptr_line->displayed) ?
+        weechat_string_eval_expression (format,
+                                        buflist_hashtable_pointers,
+                                        buflist_hashtable_extra_vars,
+                                        NULL) : NULL;
+    buflist_bar_item_line_compute_size (ptr_line);
+
+    /* replace line in hashtable (old line is freed) */
+    if (!weechat_hashtable_set (buflist_bar_item_lines[item_index],
+                                buffer, ptr_line))
+    {
+        buflist_bar_item_free_line_cb (NULL, NULL, ptr_line);
+        return NULL;
+    }
+
+    return ptr_line;
+}
+
 /*
  * Checks if the bar can be scrolled, the bar must have:
  * - a position "left" or "right"
@@ -297,6 +463,50 @@ buflist_bar_item_auto_scroll (const char *item_name, int line_number)
     }
 }
 
+/*
+ * Gets lines displayed in bar window, sent by WeeChat in hashtable
+ * "extra_info" (only if the bar window can display a part of the item).
+ *
+ * Returns:
+ *   1: callback can return only "lines_count" lines from "lines_start"
+ *   0: callback must return all lines
+ */
+
+int
+buflist_bar_item_get_lines_displayed (struct t_hashtable *extra_info,
+                                      int *lines_start, int *lines_count)
+{
+    const char *ptr_start, *ptr_count;
+    char *error1, *error2;
+    long start, count;
+
+    *lines_start = 0;
+    *lines_count = -1;
+
+    if (!extra_info)
+        return 0;
+
+    ptr_start = weechat_hashtable_get (extra_info, "_lines_start");
+    ptr_count = weechat_hashtable_get (extra_info, "_lines_count");
+    if (!ptr_start || !ptr_count)
+        return 0;
+
+    error1 = NULL;
+    start = strtol (ptr_start, &error1, 10);
+    error2 = NULL;
+    count = strtol (ptr_count, &error2, 10);
+    if (!error1 || error1[0] || !error2 || error2[0]
+        || (start < 0) || (count <= 0))
+    {
+        return 0;
+    }
+
+    *lines_start = (int)start;
+    *lines_count = (int)count;
+
+    return 1;
+}
+
 /*
  * Returns the content of the bar item.
  */
@@ -313,11 +523,12 @@ buflist_bar_item_buflist_cb (const void *pointer, void *data,
     struct t_gui_buffer *ptr_buffer_prev, *ptr_buffer_next;
     struct t_gui_nick *ptr_gui_nick;
     struct t_gui_hotlist *ptr_hotlist;
-    void *ptr_server, *ptr_channel;
-    char **buflist, *str_buflist, *condition;
+    struct t_buflist_bar_item_line *ptr_line;
+    struct t_buflist_sort_key *ptr_sort_key;
+    char **buflist, *str_buflist;
     char str_format_number[32], str_format_number_empty[32];
     char str_nick_prefix[32], str_color_nick_prefix[32];
-    char str_number[32], str_number2[32], *line, **hotlist, *str_hotlist;
+    char str_number[32], str_number2[32], **hotlist, *str_hotlist;
     char str_hotlist_count[32];
     const char *ptr_format, *ptr_format_current, *ptr_format_indent;
     const char *ptr_name, *ptr_type, *ptr_nick, *ptr_nick_prefix;
@@ -329,13 +540,14 @@ buflist_bar_item_buflist_cb (const void *pointer, void *data,
     const char *ptr_lag, *ptr_item_name, *ptr_tls_version;
     int item_index, num_buffers, is_channel, is_private, is_list;
     int i, j, length_max_number, current_buffer, number, prev_number, priority;
-    int rc, count, line_number, line_number_current_buffer;
+    int count, line_number, line_number_current_buffer;
     int hotlist_priority_number;
+    int limit_lines, lines_start, lines_count, line_screen, first_line_screen;
+    int max_length;
 
     /* make C compiler happy */
     (void) data;
     (void) buffer;
-    (void) extra_info;
 
     if (!weechat_config_boolean (buflist_config_look_enabled))
         return NULL;
@@ -349,6 +561,19 @@ buflist_bar_item_buflist_cb (const void *pointer, void *data,
     line_number = 0;
     line_number_current_buffer = 0;
 
+    /*
+     * if the bar window displays only a part of the item, the lines are
+     * still evaluated for all buffers (they are cached), but only the lines
+     * displayed are concatenated (this requires a newline between buffers)
+     */
+    limit_lines = (weechat_config_boolean (buflist_config_look_add_newline)) ?
+        buflist_bar_item_get_lines_displayed (extra_info,
+                                              &lines_start,
+                                              &lines_count) : 0;
+    line_screen = 0;
+    first_line_screen = -1;
+    max_length = 0;
+
     buflist = weechat_string_dyn_alloc (256);
 
     weechat_hashtable_set (buflist_hashtable_pointers, "bar_item", item);
@@ -382,18 +607,18 @@ buflist_bar_item_buflist_cb (const void *pointer, void *data,
     num_buffers = weechat_arraylist_size (buffers);
     for (i = 0; i < num_buffers; i++)
     {
-        ptr_buffer = weechat_arraylist_get (buffers, i);
+        ptr_sort_key = weechat_arraylist_get (buffers, i);
+        ptr_buffer = ptr_sort_key->buffer;
 
         /* set pointers */
         weechat_hashtable_set (buflist_hashtable_pointers,
                                "buffer", ptr_buffer);
 
-        /* set IRC server/channel pointers */
-        buflist_buffer_get_irc_pointers (ptr_buffer, &ptr_server, &ptr_channel);
+        /* set IRC server/channel pointers (found when buffers were sorted) */
         weechat_hashtable_set (buflist_hashtable_pointers,
-                               "irc_server", ptr_server);
+                               "irc_server", ptr_sort_key->irc_server);
         weechat_hashtable_set (buflist_hashtable_pointers,
-                               "irc_channel", ptr_channel);
+                               "irc_channel", ptr_sort_key->irc_channel);
 
         /* name / short name */
         ptr_name = weechat_hdata_string (buflist_hdata_buffer,
@@ -623,15 +848,15 @@ buflist_bar_item_buflist_cb (const void *pointer, void *data,
             (ptr_tls_version && ptr_tls_version[0]) ?
             weechat_config_string (buflist_config_format_tls_version) : "");
 
-        /* check condition: if false, the buffer is not displayed */
-        condition = weechat_string_eval_expression (
-            weechat_config_string (buflist_config_look_display_conditions),
-            buflist_hashtable_pointers,
-            buflist_hashtable_extra_vars,
-            buflist_hashtable_options_conditions);
-        rc = (condition && (strcmp (condition, "1") == 0));
-        free (condition);
-        if (!rc)
+        /* evaluate condition and line (or reuse line evaluated before) */
+        ptr_line = buflist_bar_item_get_line (
+            item_index, ptr_buffer,
+            (current_buffer) ? ptr_format_current : ptr_format);
+        if (!ptr_line)
+            goto error;
+
+        /* if condition is false, the buffer is not displayed */
+        if (!ptr_line->displayed)
             continue;
 
         /* add buffer in list */
@@ -642,30 +867,44 @@ buflist_bar_item_buflist_cb (const void *pointer, void *data,
             line_number_current_buffer = line_number;
         prev_number = number;
 
-        /* add newline between each buffer (if needed) */
-        if (weechat_config_boolean (buflist_config_look_add_newline)
-            && *buflist[0])
+        if (!limit_lines
+            || ((line_screen + ptr_line->lines > lines_start)
+                && (line_screen < lines_start + lines_count)))
         {
-            if (!weechat_string_dyn_concat (buflist, "\n", -1))
-                goto error;
-        }
+            if (first_line_screen < 0)
+                first_line_screen = line_screen;
 
-        /* build string */
-        line = weechat_string_eval_expression (
-            (current_buffer) ? ptr_format_current : ptr_format,
-            buflist_hashtable_pointers,
-            buflist_hashtable_extra_vars,
-            NULL);
+            /* add newline between each buffer (if needed) */
+            if (weechat_config_boolean (buflist_config_look_add_newline)
+                && *buflist[0])
+            {
+                if (!weechat_string_dyn_concat (buflist, "\n", -1))
+                    goto error;
+            }
 
-        /* concatenate string */
-        rc = weechat_string_dyn_concat (buflist, line, -1);
-        free (line);
-        if (!rc)
-            goto error;
+            /* concatenate string */
+            if (!weechat_string_dyn_concat (buflist, ptr_line->line, -1))
+                goto error;
+        }
 
+        if (ptr_line->max_length > max_length)
+            max_length = ptr_line->max_length;
+        line_screen += ptr_line->lines;
         line_number++;
     }
 
+    if (limit_lines)
+    {
+        snprintf (str_number, sizeof (str_number), "%d", line_screen);
+        weechat_hashtable_set (extra_info, "_lines_total", str_number);
+        snprintf (str_number, sizeof (str_number),
+                  "%d",
+                  (first_line_screen >= 0) ? first_line_screen : lines_start);
+        weechat_hashtable_set (extra_info, "_lines_start", str_number);
+        snprintf (str_number, sizeof (str_number), "%d", max_length);
+        weechat_hashtable_set (extra_info, "_lines_max_length", str_number);
+    }
+
     str_buflist = weechat_string_dyn_free (buflist, 0);
 
     goto end;
@@ -743,6 +982,18 @@ buflist_bar_item_init ()
     for (i = 0; i < BUFLIST_BAR_NUM_ITEMS; i++)
     {
         buflist_list_buffers[i] = NULL;
+        buflist_bar_item_lines[i] = weechat_hashtable_new (
+            32,
+            WEECHAT_HASHTABLE_POINTER,
+            WEECHAT_HASHTABLE_POINTER,
+            NULL,
+            NULL);
+        if (buflist_bar_item_lines[i])
+        {
+            weechat_hashtable_set_pointer (buflist_bar_item_lines[i],
+                                           "callback_free_value",
+                                           &buflist_bar_item_free_line_cb);
+        }
         old_line_number_current_buffer[i] = -1;
         buflist_bar_item_buflist[i] = weechat_bar_item_new (
             buflist_bar_item_get_name (i),
@@ -784,5 +1035,7 @@ buflist_bar_item_end ()
             weechat_arraylist_free (buflist_list_buffers[i]);
             buflist_list_buffers[i] = NULL;
         }
+        weechat_hashtable_free (buflist_bar_item_lines[i]);
+        buflist_bar_item_lines[i] = NULL;
     }
 }
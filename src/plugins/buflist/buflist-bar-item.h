@@ -25,14 +25,33 @@
 #define BUFLIST_BAR_NUM_ITEMS 5
 
 struct t_gui_bar_item;
+struct t_gui_buffer;
+struct t_hashtable;
+
+struct t_buflist_bar_item_line
+{
+    char *signature;                   /* values of variables used to       */
+                                       /* evaluate condition and line       */
+    int displayed;                     /* result of display conditions      */
+    char *line;                        /* evaluated line (NULL if not       */
+                                       /* displayed)                        */
+    int lines;                         /* number of lines on screen         */
+    int max_length;                    /* max length of lines on screen     */
+};
 
 extern struct t_gui_bar_item *buflist_bar_item_buflist[BUFLIST_BAR_NUM_ITEMS];
 extern struct t_arraylist *buflist_list_buffers[BUFLIST_BAR_NUM_ITEMS];
+extern struct t_hashtable *buflist_bar_item_lines[BUFLIST_BAR_NUM_ITEMS];
 
 extern const char *buflist_bar_item_get_name (int index);
 extern int buflist_bar_item_get_index (const char *item_name);
 extern int buflist_bar_item_get_index_with_pointer (struct t_gui_bar_item *item);
 extern void buflist_bar_item_update (int index, int force);
+extern void buflist_bar_item_lines_invalidate (struct t_gui_buffer *buffer);
+extern void buflist_bar_item_line_compute_size (struct t_buflist_bar_item_line *line);
+extern int buflist_bar_item_get_lines_displayed (struct t_hashtable *extra_info,
+                                                 int *lines_start,
+                                                 int *lines_count);
 extern int buflist_bar_item_init ();
 extern void buflist_bar_item_end ();
 
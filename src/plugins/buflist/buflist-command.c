@@ -74,6 +74,7 @@ buflist_command_buflist (const void *pointer, void *data,
 
     if (weechat_strcmp (argv[1], "refresh") == 0)
     {
+        buflist_bar_item_lines_invalidate (NULL);
         if (argc > 2)
         {
             for (i = 2; i < argc; i++)
@@ -155,9 +155,24 @@ buflist_config_signal_buffer_cb (const void *pointer, void *data,
     /* make C compiler happy */
     (void) pointer;
     (void) data;
-    (void) signal;
-    (void) type_data;
-    (void) signal_data;
+
+    if (((strncmp (signal, "buffer_", 7) == 0)
+         || (strcmp (signal, "hotlist_changed") == 0))
+        && (strcmp (type_data, WEECHAT_HOOK_SIGNAL_POINTER) == 0))
+    {
+        /* signal on a buffer (all buffers if pointer is NULL) */
+        buflist_bar_item_lines_invalidate (signal_data);
+    }
+    else if ((strncmp (signal, "nicklist_nick_", 14) != 0)
+             && (strcmp (signal, "window_switch") != 0))
+    {
+        /*
+         * signal added by user: it can change anything in evaluated lines
+         * (nick prefix and current buffer are checked when lines are
+         * evaluated, so lines are kept on nicklist and window signals)
+         */
+        buflist_bar_item_lines_invalidate (NULL);
+    }
 
     buflist_bar_item_update (-1, 0);
 
@@ -254,6 +269,8 @@ buflist_config_change_enabled (const void *pointer, void *data,
     (void) data;
     (void) option;
 
+    buflist_bar_item_lines_invalidate (NULL);
+
     buflist_config_free_signals_refresh ();
 
     if (weechat_config_boolean (buflist_config_look_enabled))
@@ -367,6 +384,7 @@ buflist_config_change_nick_prefix (const void *pointer, void *data,
     (void) option;
 
     buflist_config_change_signals_refresh (NULL, NULL, NULL);
+    buflist_bar_item_lines_invalidate (NULL);
     buflist_bar_item_update (-1, 0);
 }
 
@@ -399,6 +417,7 @@ buflist_config_change_buflist (const void *pointer, void *data,
     (void) data;
     (void) option;
 
+    buflist_bar_item_lines_invalidate (NULL);
     buflist_bar_item_update (-1, 0);
 }
 
@@ -457,6 +476,7 @@ buflist_config_change_format (const void *pointer, void *data,
     buflist_config_format_hotlist_eval = buflist_config_add_eval_for_formats (
         weechat_config_string (buflist_config_format_hotlist));
 
+    buflist_bar_item_lines_invalidate (NULL);
     buflist_bar_item_update (-1, 0);
 }
 
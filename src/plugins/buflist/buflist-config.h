@@ -27,9 +27,9 @@
 
 #define BUFLIST_CONFIG_SIGNALS_REFRESH                                  \
     "buffer_opened,buffer_closed,buffer_merged,buffer_unmerged,"        \
-    "buffer_moved,buffer_renamed,buffer_switch,buffer_hidden,"          \
-    "buffer_unhidden,buffer_localvar_added,buffer_localvar_changed,"    \
-    "window_switch,hotlist_changed"
+    "buffer_moved,buffer_list_reordered,buffer_renamed,buffer_switch,"  \
+    "buffer_hidden,buffer_unhidden,buffer_localvar_added,"              \
+    "buffer_localvar_changed,window_switch,hotlist_changed"
 #define BUFLIST_CONFIG_SIGNALS_REFRESH_NICK_PREFIX                      \
     "nicklist_nick_*"
 
@@ -50,6 +50,9 @@ struct t_hdata *buflist_hdata_bar = NULL;
 struct t_hdata *buflist_hdata_bar_item = NULL;
 struct t_hdata *buflist_hdata_bar_window = NULL;
 
+/* sort fields parsed for the last buflist item sorted */
+struct t_buflist_sort_context buflist_sort_context = { NULL, NULL, NULL, 0 };
+
 
 /*
  * Adds the buflist bar.
@@ -213,7 +216,8 @@ buflist_compare_inactive_merged_buffers (struct t_gui_buffer *buffer1,
  * Compares two buffers in order to add them in the sorted arraylist.
  *
  * The comparison is made using the list of fields defined in the option
- * "buflist.look.sort".
+ * "buflist.look.sort", parsed in the sort context (argument "data"); the
+ * pointers are sort keys of buffers (see function buflist_sort_buffers).
  *
  * Returns:
  *   -1: buffer1 < buffer2
@@ -225,122 +229,192 @@ int
 buflist_compare_buffers (void *data, struct t_arraylist *arraylist,
                          void *pointer1, void *pointer2)
 {
-    int i, item_number, reverse, case_sensitive, rc;
-    const char *ptr_field;
-    struct t_gui_hotlist *ptr_hotlist1, *ptr_hotlist2;
-    void *ptr_server1, *ptr_server2, *ptr_channel1, *ptr_channel2;
-    struct t_hdata *hdata_irc_server, *hdata_irc_channel;
-    struct t_gui_bar_item *ptr_item;
+    int i, rc;
+    struct t_buflist_sort_context *context;
+    struct t_buflist_sort_field *ptr_field;
+    struct t_buflist_sort_key *key1, *key2;
+
+    /* make C compiler happy */
+    (void) arraylist;
+
+    context = (struct t_buflist_sort_context *)data;
+    key1 = (struct t_buflist_sort_key *)pointer1;
+    key2 = (struct t_buflist_sort_key *)pointer2;
+
+    for (i = 0; i < context->num_fields; i++)
+    {
+        rc = 0;
+        ptr_field = &(context->fields[i]);
+        switch (ptr_field->type)
+        {
+            case BUFLIST_SORT_FIELD_HOTLIST:
+                if (!key1->hotlist && !key2->hotlist)
+                    rc = 0;
+                else if (key1->hotlist && !key2->hotlist)
+                    rc = 1;
+                else if (!key1->hotlist && key2->hotlist)
+                    rc = -1;
+                else
+                {
+                    rc = weechat_hdata_compare (buflist_hdata_hotlist,
+                                                key1->hotlist, key2->hotlist,
+                                                ptr_field->name,
+                                                ptr_field->case_sensitive);
+                }
+                break;
+            case BUFLIST_SORT_FIELD_IRC_SERVER:
+                if (context->hdata_irc_server)
+                {
+                    rc = weechat_hdata_compare (context->hdata_irc_server,
+                                                key1->irc_server,
+                                                key2->irc_server,
+                                                ptr_field->name,
+                                                ptr_field->case_sensitive);
+                }
+                break;
+            case BUFLIST_SORT_FIELD_IRC_CHANNEL:
+                if (context->hdata_irc_channel)
+                {
+                    rc = weechat_hdata_compare (context->hdata_irc_channel,
+                                                key1->irc_channel,
+                                                key2->irc_channel,
+                                                ptr_field->name,
+                                                ptr_field->case_sensitive);
+                }
+                break;
+            default:
+                rc = weechat_hdata_compare (buflist_hdata_buffer,
+                                            key1->buffer, key2->buffer,
+                                            ptr_field->name,
+                                            ptr_field->case_sensitive);
+
+                /*
+                 * In case we are sorting on "active" flag and that both
+                 * buffers have same value (it should be 0),
+                 * we sort buffers so that the buffers immediately after the
+                 * active one is first in list, followed by the next ones,
+                 * followed by the buffers before the active one.
+                 */
+                if ((rc == 0)
+                    && (strcmp (ptr_field->name, "active") == 0)
+                    && (key1->number == key2->number))
+                {
+                    rc = buflist_compare_inactive_merged_buffers (key1->buffer,
+                                                                  key2->buffer);
+                }
+                break;
+        }
+        rc *= ptr_field->reverse;
+        if (rc != 0)
+            return rc;
+    }
 
+    return 0;
+}
+
+/*
+ * Frees a sort key of a buffer.
+ */
+
+void
+buflist_sort_key_free_cb (void *data, struct t_arraylist *arraylist,
+                          void *pointer)
+{
     /* make C compiler happy */
+    (void) data;
     (void) arraylist;
 
-    ptr_item = (struct t_gui_bar_item *)data;
-    item_number = buflist_bar_item_get_index_with_pointer (ptr_item);
+    free (pointer);
+}
+
+/*
+ * Frees fields parsed in a sort context.
+ */
+
+void
+buflist_sort_context_free (struct t_buflist_sort_context *context)
+{
+    if (!context)
+        return;
+
+    free (context->fields);
+    context->fields = NULL;
+    context->num_fields = 0;
+}
+
+/*
+ * Parses fields of option "buflist.look.sort" for a bar item.
+ */
+
+void
+buflist_sort_context_init (struct t_buflist_sort_context *context,
+                           struct t_gui_bar_item *item)
+{
+    int i, item_number;
+    const char *ptr_field;
+    struct t_buflist_sort_field *ptr_sort_field;
+
+    item_number = buflist_bar_item_get_index_with_pointer (item);
     if (item_number < 0)
-        item_number= 0;
+        item_number = 0;
 
-    hdata_irc_server = weechat_hdata_get ("irc_server");
-    hdata_irc_channel = weechat_hdata_get ("irc_channel");
+    buflist_sort_context_free (context);
+
+    context->hdata_irc_server = weechat_hdata_get ("irc_server");
+    context->hdata_irc_channel = weechat_hdata_get ("irc_channel");
+
+    if (buflist_config_sort_fields_count[item_number] <= 0)
+        return;
+
+    context->fields = malloc (buflist_config_sort_fields_count[item_number]
+                              * sizeof (context->fields[0]));
+    if (!context->fields)
+        return;
 
     for (i = 0; i < buflist_config_sort_fields_count[item_number]; i++)
     {
-        rc = 0;
-        reverse = 1;
-        case_sensitive = 1;
+        ptr_sort_field = &(context->fields[context->num_fields]);
+        ptr_sort_field->reverse = 1;
+        ptr_sort_field->case_sensitive = 1;
         ptr_field = buflist_config_sort_fields[item_number][i];
         while ((ptr_field[0] == '-') || (ptr_field[0] == '~'))
         {
             if (ptr_field[0] == '-')
-                reverse *= -1;
+                ptr_sort_field->reverse *= -1;
             else if (ptr_field[0] == '~')
-                case_sensitive ^= 1;
+                ptr_sort_field->case_sensitive ^= 1;
             ptr_field++;
         }
         if (strncmp (ptr_field, "hotlist.", 8) == 0)
         {
-            ptr_hotlist1 = weechat_hdata_pointer (buflist_hdata_buffer,
-                                                  pointer1, "hotlist");
-            ptr_hotlist2 = weechat_hdata_pointer (buflist_hdata_buffer,
-                                                  pointer2, "hotlist");
-            if (!ptr_hotlist1 && !ptr_hotlist2)
-                rc = 0;
-            else if (ptr_hotlist1 && !ptr_hotlist2)
-                rc = 1;
-            else if (!ptr_hotlist1 && ptr_hotlist2)
-                rc = -1;
-            else
-            {
-                rc = weechat_hdata_compare (buflist_hdata_hotlist,
-                                            ptr_hotlist1, ptr_hotlist2,
-                                            ptr_field + 8,
-                                            case_sensitive);
-            }
+            ptr_sort_field->type = BUFLIST_SORT_FIELD_HOTLIST;
+            ptr_sort_field->name = ptr_field + 8;
         }
         else if (strncmp (ptr_field, "irc_server.", 11) == 0)
         {
-            if (hdata_irc_server)
-            {
-                buflist_buffer_get_irc_pointers (pointer1,
-                                                 &ptr_server1, &ptr_channel1);
-                buflist_buffer_get_irc_pointers (pointer2,
-                                                 &ptr_server2, &ptr_channel2);
-                rc = weechat_hdata_compare (hdata_irc_server,
-                                            ptr_server1, ptr_server2,
-                                            ptr_field + 11,
-                                            case_sensitive);
-            }
+            ptr_sort_field->type = BUFLIST_SORT_FIELD_IRC_SERVER;
+            ptr_sort_field->name = ptr_field + 11;
         }
         else if (strncmp (ptr_field, "irc_channel.", 12) == 0)
         {
-            if (hdata_irc_channel)
-            {
-                buflist_buffer_get_irc_pointers (pointer1,
-                                                 &ptr_server1, &ptr_channel1);
-                buflist_buffer_get_irc_pointers (pointer2,
-                                                 &ptr_server2, &ptr_channel2);
-                rc = weechat_hdata_compare (hdata_irc_channel,
-                                            ptr_channel1, ptr_channel2,
-                                            ptr_field + 12,
-                                            case_sensitive);
-            }
+            ptr_sort_field->type = BUFLIST_SORT_FIELD_IRC_CHANNEL;
+            ptr_sort_field->name = ptr_field + 12;
         }
         else
         {
-            rc = weechat_hdata_compare (buflist_hdata_buffer,
-                                        pointer1, pointer2,
-                                        ptr_field,
-                                        case_sensitive);
-
-            /*
-             * In case we are sorting on "active" flag and that both
-             * buffers have same value (it should be 0),
-             * we sort buffers so that the buffers immediately after the
-             * active one is first in list, followed by the next ones, followed
-             * by the buffers before the active one.
-             */
-            if ((rc == 0)
-                && (strcmp (ptr_field, "active") == 0)
-                && (weechat_hdata_integer (buflist_hdata_buffer,
-                                           pointer1, "number") ==
-                    weechat_hdata_integer (buflist_hdata_buffer,
-                                           pointer2, "number")))
-            {
-                rc = buflist_compare_inactive_merged_buffers (pointer1,
-                                                              pointer2);
-            }
+            ptr_sort_field->type = BUFLIST_SORT_FIELD_BUFFER;
+            ptr_sort_field->name = ptr_field;
         }
-        rc *= reverse;
-        if (rc != 0)
-            return rc;
+        context->num_fields++;
     }
-
-    return 0;
 }
 
 /*
- * Builds a list of pointers to buffers, sorted according to option
- * "buflist.look.sort".
+ * Builds a list of buffers sorted according to option "buflist.look.sort".
+ *
+ * The values used by sort (hotlist, IRC server/channel pointers) are read
+ * only one time for each buffer, in a sort key of type
+ * "struct t_buflist_sort_key", and the arraylist contains these keys.
  *
  * Returns an arraylist that must be freed by weechat_arraylist_free after use.
  */
@@ -350,15 +424,32 @@ buflist_sort_buffers (struct t_gui_bar_item *item)
 {
     struct t_arraylist *buffers;
     struct t_gui_buffer *ptr_buffer;
+    struct t_buflist_sort_key *key;
+
+    buflist_sort_context_init (&buflist_sort_context, item);
 
     buffers = weechat_arraylist_new (128, 1, 1,
-                                     &buflist_compare_buffers, item,
-                                     NULL, NULL);
+                                     &buflist_compare_buffers,
+                                     &buflist_sort_context,
+                                     &buflist_sort_key_free_cb, NULL);
 
     ptr_buffer = weechat_hdata_get_list (buflist_hdata_buffer, "gui_buffers");
     while (ptr_buffer)
     {
-        weechat_arraylist_add (buffers, ptr_buffer);
+        key = malloc (sizeof (*key));
+        if (key)
+        {
+            key->buffer = ptr_buffer;
+            key->number = weechat_hdata_integer (buflist_hdata_buffer,
+                                                 ptr_buffer, "number");
+            key->hotlist = weechat_hdata_pointer (buflist_hdata_buffer,
+                                                  ptr_buffer, "hotlist");
+            buflist_buffer_get_irc_pointers (ptr_buffer,
+                                             &key->irc_server,
+                                             &key->irc_channel);
+            if (weechat_arraylist_add (buffers, key) < 0)
+                free (key);
+        }
         ptr_buffer = weechat_hdata_move (buflist_hdata_buffer, ptr_buffer, 1);
     }
 
@@ -534,6 +625,8 @@ weechat_plugin_end (struct t_weechat_plugin *plugin)
     buflist_config_write ();
     buflist_config_free ();
 
+    buflist_sort_context_free (&buflist_sort_context);
+
     buflist_hdata_window = NULL;
     buflist_hdata_buffer = NULL;
     buflist_hdata_hotlist = NULL;
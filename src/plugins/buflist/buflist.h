@@ -28,6 +28,39 @@
 
 struct t_gui_bar_item;
 
+enum t_buflist_sort_field_type
+{
+    BUFLIST_SORT_FIELD_BUFFER = 0,     /* buffer variable (hdata "buffer")  */
+    BUFLIST_SORT_FIELD_HOTLIST,        /* "hotlist.xxx"                     */
+    BUFLIST_SORT_FIELD_IRC_SERVER,     /* "irc_server.xxx"                  */
+    BUFLIST_SORT_FIELD_IRC_CHANNEL,    /* "irc_channel.xxx"                 */
+};
+
+struct t_buflist_sort_field
+{
+    enum t_buflist_sort_field_type type; /* type of field                 */
+    const char *name;                  /* hdata variable name               */
+    int reverse;                       /* 1 = normal sort, -1 = reverse     */
+    int case_sensitive;                /* 1 = case sensitive comparison     */
+};
+
+struct t_buflist_sort_context
+{
+    struct t_hdata *hdata_irc_server;  /* hdata "irc_server" (can be NULL)  */
+    struct t_hdata *hdata_irc_channel; /* hdata "irc_channel" (can be NULL) */
+    struct t_buflist_sort_field *fields; /* parsed fields of sort option    */
+    int num_fields;                    /* number of fields                  */
+};
+
+struct t_buflist_sort_key
+{
+    struct t_gui_buffer *buffer;       /* buffer                            */
+    int number;                        /* buffer number                     */
+    void *hotlist;                     /* hotlist of buffer (can be NULL)   */
+    void *irc_server;                  /* IRC server (can be NULL)          */
+    void *irc_channel;                 /* IRC channel (can be NULL)         */
+};
+
 extern struct t_weechat_plugin *weechat_buflist_plugin;
 
 extern struct t_hdata *buflist_hdata_window;
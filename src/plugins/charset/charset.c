@@ -21,6 +21,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #ifndef __USE_GNU
 #define __USE_GNU
 #endif
@@ -49,6 +50,49 @@ struct t_config_section *charset_config_section_encode = NULL;
 char *charset_terminal = NULL;
 char *charset_internal = NULL;
 
+/*
+ * cache of charsets found for modifier data (decode/encode), and of charsets
+ * which convert ASCII chars to themselves; caches are cleared when an option
+ * of charset configuration file is changed
+ */
+struct t_hashtable *charset_cache_decode = NULL;
+struct t_hashtable *charset_cache_encode = NULL;
+struct t_hashtable *charset_cache_ascii = NULL;
+
+
+/*
+ * Clears caches of charsets.
+ */
+
+void
+charset_cache_clear ()
+{
+    if (charset_cache_decode)
+        weechat_hashtable_remove_all (charset_cache_decode);
+    if (charset_cache_encode)
+        weechat_hashtable_remove_all (charset_cache_encode);
+    if (charset_cache_ascii)
+        weechat_hashtable_remove_all (charset_cache_ascii);
+}
+
+/*
+ * Callback for changes on options of charset configuration file.
+ */
+
+int
+charset_config_changed_cb (const void *pointer, void *data,
+                           const char *option, const char *value)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) option;
+    (void) value;
+
+    charset_cache_clear ();
+
+    return WEECHAT_RC_OK;
+}
 
 /*
  * Reloads charset configuration file.
@@ -62,6 +106,8 @@ charset_config_reload (const void *pointer, void *data,
     (void) pointer;
     (void) data;
 
+    charset_cache_clear ();
+
     /* free all decode/encode charsets */
     weechat_config_section_free_options (charset_config_section_decode);
     weechat_config_section_free_options (charset_config_section_encode);
@@ -375,8 +421,125 @@ charset_get (struct t_config_section *section, const char *name,
     return NULL;
 }
 
+/*
+ * Reads a charset in configuration file, using the cache of charsets found
+ * for modifier data.
+ */
+
+const char *
+charset_cache_get (struct t_hashtable *cache,
+                   struct t_config_section *section, const char *name,
+                   struct t_config_option *default_charset)
+{
+    const char *charset;
+
+    if (!name)
+        name = "";
+
+    if (cache)
+    {
+        charset = weechat_hashtable_get (cache, name);
+        if (charset)
+            return (charset[0]) ? charset : NULL;
+    }
+
+    charset = charset_get (section, name, default_charset);
+
+    if (cache)
+    {
+        if (weechat_hashtable_get_integer (cache, "items_count")
+            >= CHARSET_CACHE_MAX_ITEMS)
+        {
+            weechat_hashtable_remove_all (cache);
+        }
+        weechat_hashtable_set (cache, name, (charset) ? charset : "");
+    }
+
+    return charset;
+}
+
+/*
+ * Checks if a string has only ASCII chars (< 128), by reading 8 bytes at once.
+ *
+ * Returns pointer to the first non-ASCII char, NULL if the string has only
+ * ASCII chars.
+ */
+
+const char *
+charset_skip_ascii (const char *string)
+{
+    uint64_t word;
+    size_t i, length;
+
+    length = strlen (string);
+
+    for (i = 0; i + sizeof (word) <= length; i += sizeof (word))
+    {
+        memcpy (&word, string + i, sizeof (word));
+        if (word & 0x8080808080808080ULL)
+            break;
+    }
+
+    for (; i < length; i++)
+    {
+        if ((unsigned char)string[i] & 0x80)
+            return string + i;
+    }
+
+    return NULL;
+}
+
+/*
+ * Checks if a charset converts ASCII chars (1-127) to themselves, in both
+ * directions (decode and encode): this is not the case for some charsets
+ * like UTF-7, UTF-16, ISO-2022-JP or HZ.
+ *
+ * Returns:
+ *   1: ASCII chars are unchanged by the charset
+ *   0: ASCII chars are changed by the charset
+ */
+
+int
+charset_ascii_compatible (const char *charset)
+{
+    char ascii_chars[128], *decoded, *encoded;
+    int *ptr_compatible, i, compatible;
+
+    if (charset_cache_ascii)
+    {
+        ptr_compatible = weechat_hashtable_get (charset_cache_ascii, charset);
+        if (ptr_compatible)
+            return *ptr_compatible;
+    }
+
+    for (i = 1; i < 128; i++)
+    {
+        ascii_chars[i - 1] = i;
+    }
+    ascii_chars[127] = '\0';
+
+    decoded = weechat_iconv_to_internal (charset, ascii_chars);
+    encoded = weechat_iconv_from_internal (charset, ascii_chars);
+
+    compatible = (decoded && encoded
+                  && (strcmp (decoded, ascii_chars) == 0)
+                  && (strcmp (encoded, ascii_chars) == 0)) ? 1 : 0;
+
+    free (decoded);
+    free (encoded);
+
+    if (charset_cache_ascii)
+        weechat_hashtable_set (charset_cache_ascii, charset, &compatible);
+
+    return compatible;
+}
+
 /*
  * Decodes a string with a charset to internal charset (UTF-8).
+ *
+ * If the string is already valid UTF-8, or has only ASCII chars which are
+ * unchanged by the charset, NULL is returned (string unchanged) without
+ * calling iconv.
  */
 
 char *
@@ -384,15 +547,16 @@ charset_decode_cb (const void *pointer, void *data,
                    const char *modifier, const char *modifier_data,
                    const char *string)
 {
-    const char *charset;
+    const char *charset, *ptr_non_ascii;
 
     /* make C compiler happy */
     (void) pointer;
     (void) data;
     (void) modifier;
 
-    charset = charset_get (charset_config_section_decode, modifier_data,
-                           charset_default_decode);
+    charset = charset_cache_get (charset_cache_decode,
+                                 charset_config_section_decode, modifier_data,
+                                 charset_default_decode);
     if (weechat_charset_plugin->debug)
     {
         weechat_printf (NULL,
@@ -400,14 +564,28 @@ charset_decode_cb (const void *pointer, void *data,
                         "(modifier=\"%s\", modifier_data=\"%s\", string=\"%s\")",
                         charset, modifier, modifier_data, string);
     }
-    if (charset && charset[0])
-        return weechat_iconv_to_internal (charset, string);
+    if (!charset || !charset[0] || !string)
+        return NULL;
 
-    return NULL;
+    ptr_non_ascii = charset_skip_ascii (string);
+    if (ptr_non_ascii)
+    {
+        if (weechat_utf8_is_valid (ptr_non_ascii, -1, NULL))
+            return NULL;
+    }
+    else if (charset_ascii_compatible (charset))
+    {
+        return NULL;
+    }
+
+    return weechat_iconv_to_internal (charset, string);
 }
 
 /*
  * Encodes a string from internal charset (UTF-8) to another charset.
+ *
+ * If the string has only ASCII chars which are unchanged by the charset,
+ * NULL is returned (string unchanged) without calling iconv.
  */
 
 char *
@@ -422,8 +600,9 @@ charset_encode_cb (const void *pointer, void *data,
     (void) data;
     (void) modifier;
 
-    charset = charset_get (charset_config_section_encode, modifier_data,
-                           charset_default_encode);
+    charset = charset_cache_get (charset_cache_encode,
+                                 charset_config_section_encode, modifier_data,
+                                 charset_default_encode);
     if (weechat_charset_plugin->debug)
     {
         weechat_printf (NULL,
@@ -431,10 +610,13 @@ charset_encode_cb (const void *pointer, void *data,
                         "(modifier=\"%s\", modifier_data=\"%s\", string=\"%s\")",
                         charset, modifier, modifier_data, string);
     }
-    if (charset && charset[0])
-        return weechat_iconv_from_internal (charset, string);
+    if (!charset || !charset[0] || !string)
+        return NULL;
 
-    return NULL;
+    if (!charset_skip_ascii (string) && charset_ascii_compatible (charset))
+        return NULL;
+
+    return weechat_iconv_from_internal (charset, string);
 }
 
 /*
@@ -602,6 +784,22 @@ weechat_plugin_init (struct t_weechat_plugin *plugin, int argc, char *argv[])
 
     charset_config_read ();
 
+    charset_cache_decode = weechat_hashtable_new (32,
+                                                  WEECHAT_HASHTABLE_STRING,
+                                                  WEECHAT_HASHTABLE_STRING,
+                                                  NULL, NULL);
+    charset_cache_encode = weechat_hashtable_new (32,
+                                                  WEECHAT_HASHTABLE_STRING,
+                                                  WEECHAT_HASHTABLE_STRING,
+                                                  NULL, NULL);
+    charset_cache_ascii = weechat_hashtable_new (32,
+                                                 WEECHAT_HASHTABLE_STRING,
+                                                 WEECHAT_HASHTABLE_INTEGER,
+                                                 NULL, NULL);
+
+    weechat_hook_config (CHARSET_CONFIG_NAME ".*",
+                         &charset_config_changed_cb, NULL, NULL);
+
     /* /charset command */
     weechat_hook_command (
         "charset",
@@ -639,6 +837,13 @@ weechat_plugin_end (struct t_weechat_plugin *plugin)
     weechat_config_free (charset_config_file);
     charset_config_file = NULL;
 
+    weechat_hashtable_free (charset_cache_decode);
+    charset_cache_decode = NULL;
+    weechat_hashtable_free (charset_cache_encode);
+    charset_cache_encode = NULL;
+    weechat_hashtable_free (charset_cache_ascii);
+    charset_cache_ascii = NULL;
+
     free (charset_terminal);
     charset_terminal = NULL;
 
@@ -27,6 +27,9 @@
 #define CHARSET_CONFIG_NAME "charset"
 #define CHARSET_CONFIG_PRIO_NAME (TO_STR(CHARSET_PLUGIN_PRIORITY) "|" CHARSET_CONFIG_NAME)
 
+/* max number of modifier data in caches of decode/encode charsets */
+#define CHARSET_CACHE_MAX_ITEMS 4096
+
 extern struct t_weechat_plugin *weechat_charset_plugin;
 
 #endif /* WEECHAT_PLUGIN_CHARSET_H */
@@ -322,6 +322,26 @@ exec_command_parse_options (struct t_exec_cmd_options *cmd_options,
             if (!error || error[0])
                 return 0;
         }
+        else if (weechat_strcmp (argv[i], "-rate") == 0)
+        {
+            if (i + 1 >= argc)
+                return 0;
+            i++;
+            error = NULL;
+            cmd_options->rate_limit = strtol (argv[i], &error, 10);
+            if (!error || error[0] || (cmd_options->rate_limit < 0))
+                return 0;
+        }
+        else if (weechat_strcmp (argv[i], "-ring") == 0)
+        {
+            if (i + 1 >= argc)
+                return 0;
+            i++;
+            error = NULL;
+            cmd_options->ring_size = strtol (argv[i], &error, 10);
+            if (!error || error[0] || (cmd_options->ring_size < 0))
+                return 0;
+        }
         else if (weechat_strcmp (argv[i], "-name") == 0)
         {
             if (i + 1 >= argc)
@@ -435,6 +455,8 @@ exec_command_run (struct t_gui_buffer *buffer,
     cmd_options.flush = 1;
     cmd_options.color = EXEC_COLOR_AUTO;
     cmd_options.display_rc = 1;
+    cmd_options.rate_limit = 0;
+    cmd_options.ring_size = 0;
     cmd_options.ptr_command_name = NULL;
     cmd_options.pipe_command = NULL;
     cmd_options.hsignal = NULL;
@@ -591,6 +613,8 @@ exec_command_run (struct t_gui_buffer *buffer,
         cmd_options.new_buffer : cmd_options.line_numbers;
     new_exec_cmd->color = cmd_options.color;
     new_exec_cmd->display_rc = cmd_options.display_rc;
+    new_exec_cmd->rate_limit = cmd_options.rate_limit;
+    new_exec_cmd->ring_size = cmd_options.ring_size;
     new_exec_cmd->pipe_command = cmd_options.pipe_command;
     new_exec_cmd->hsignal = cmd_options.hsignal;
 
@@ -614,6 +638,14 @@ exec_command_run (struct t_gui_buffer *buffer,
 
     if (new_exec_cmd->hook)
     {
+        /* refresh display of last lines every second */
+        if (new_exec_cmd->ring_size > 0)
+        {
+            new_exec_cmd->ring_timer = weechat_hook_timer (
+                1000, 0, 0,
+                &exec_ring_timer_cb, new_exec_cmd, NULL);
+        }
+
         /* get PID of command */
         ptr_infolist = weechat_infolist_get ("hook", new_exec_cmd->hook, NULL);
         if (ptr_infolist)
@@ -832,7 +864,8 @@ exec_command_init ()
            " || [-sh|-nosh] [-bg|-nobg] [-stdin|-nostdin] [-buffer <name>] "
            "[-l|-o|-oc|-n|-nf] [-oerr] [-cl|-nocl] [-sw|-nosw] [-ln|-noln] "
            "[-flush|-noflush] [-color ansi|auto|irc|weechat|strip] [-rc|-norc] "
-           "[-timeout <timeout>] [-name <name>] [-pipe <command>] "
+           "[-timeout <timeout>] [-rate <lines>] [-ring <lines>] [-name <name>] "
+           "[-pipe <command>] "
            "[-hsignal <name>] <command>"
            " || -in <id> <text>"
            " || -inclose <id> [<text>]"
@@ -889,6 +922,12 @@ exec_command_init ()
             N_("raw[-rc]: display return code (default)"),
             N_("raw[-norc]: don't display return code"),
             N_("raw[-timeout]: set a timeout for the command (in seconds)"),
+            N_("raw[-rate]: max number of lines displayed per second, extra "
+               "lines are dropped and their number is displayed (0 = no limit, "
+               "default)"),
+            N_("raw[-ring]: keep only the last lines of output: they are "
+               "displayed at the end of the command, and refreshed every second "
+               "in an exec buffer (0 = keep all lines, default)"),
             N_("raw[-name]: set a name for the command (to name it later with /exec)"),
             N_("raw[-pipe]: send the output to a WeeChat/plugin command (line by "
                "line); if there are spaces in command/arguments, enclose them with "
@@ -928,10 +967,13 @@ exec_command_init ()
             AI("  /exec -o uptime"),
             AI("  /exec -pipe \"/print Machine uptime:\" uptime"),
             AI("  /exec -n tail -f /var/log/messages"),
+            AI("  /exec -n -rate 100 tail -f /var/log/messages"),
+            AI("  /exec -n -ring 20 make"),
             AI("  /exec -kill 0")),
         "-list"
         " || -sh|-nosh|-bg|-nobg|-stdin|-nostdin|-buffer|-l|-o|-n|-nf|"
-        "-cl|-nocl|-sw|-nosw|-ln|-noln|-flush|-noflush|-color|-timeout|-name|"
+        "-cl|-nocl|-sw|-nosw|-ln|-noln|-flush|-noflush|-color|-timeout|-rate|-ring|"
+        "-name|"
         "-pipe|-hsignal|%*"
         " || -in|-inclose|-signal|-kill %(exec_commands_ids)"
         " || -killall"
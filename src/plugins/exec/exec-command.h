@@ -39,6 +39,8 @@ struct t_exec_cmd_options
     int flush;                         /* 1 to flush lines immediately      */
     int color;                         /* what to do with ANSI colors       */
     int display_rc;                    /* 1 to display return code          */
+    int rate_limit;                    /* max lines displayed/sec (0 = none)*/
+    int ring_size;                     /* keep only N last lines (0 = off)  */
     const char *ptr_command_name;      /* name of command                   */
     char *pipe_command;                /* output piped to WeeChat/plugin cmd*/
     char *hsignal;                     /* send a hsignal with output        */
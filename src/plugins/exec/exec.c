@@ -138,6 +138,16 @@ exec_add ()
     new_exec_cmd->buffer_full_name = NULL;
     new_exec_cmd->line_numbers = 0;
     new_exec_cmd->display_rc = 0;
+    new_exec_cmd->rate_limit = 0;
+    new_exec_cmd->rate_time = 0;
+    new_exec_cmd->rate_count = 0;
+    new_exec_cmd->lines_dropped = 0;
+    new_exec_cmd->ring_size = 0;
+    new_exec_cmd->ring = NULL;
+    new_exec_cmd->ring_start = 0;
+    new_exec_cmd->ring_count = 0;
+    new_exec_cmd->ring_changed = 0;
+    new_exec_cmd->ring_timer = NULL;
     new_exec_cmd->output_line_nb = 0;
     for (i = 0; i < 2; i++)
     {
@@ -370,6 +380,218 @@ exec_display_line (struct t_exec_cmd *exec_cmd, struct t_gui_buffer *buffer,
     free (line_color);
 }
 
+/*
+ * Displays a message on buffer (local display, never sent to the buffer
+ * as input).
+ */
+
+void
+exec_display_message (struct t_gui_buffer *buffer, const char *tags,
+                      const char *message)
+{
+    if (weechat_buffer_get_integer (buffer, "type") == 1)
+        weechat_printf_y_date_tags (buffer, -1, 0, tags, "%s", message);
+    else
+        weechat_printf_date_tags (buffer, 0, tags, "%s", message);
+}
+
+/*
+ * Displays the number of lines dropped by the rate limit (if any).
+ */
+
+void
+exec_display_lines_dropped (struct t_exec_cmd *exec_cmd,
+                            struct t_gui_buffer *buffer)
+{
+    char str_message[1024];
+
+    if (exec_cmd->lines_dropped <= 0)
+        return;
+
+    snprintf (str_message, sizeof (str_message),
+              NG_("%s: %d line dropped (command %ld, rate limit: %d lines/s)",
+                  "%s: %d lines dropped (command %ld, rate limit: %d lines/s)",
+                  exec_cmd->lines_dropped),
+              EXEC_PLUGIN_NAME, exec_cmd->lines_dropped, exec_cmd->number,
+              exec_cmd->rate_limit);
+    exec_display_message (buffer, "exec_dropped", str_message);
+
+    exec_cmd->lines_dropped = 0;
+}
+
+/*
+ * Adds a line in the ring of last lines (when option "-ring" is used).
+ */
+
+void
+exec_ring_add (struct t_exec_cmd *exec_cmd, int out, const char *line)
+{
+    struct t_exec_ring_line *ptr_ring_line;
+    int index;
+
+    if (!exec_cmd->ring)
+    {
+        exec_cmd->ring = calloc (exec_cmd->ring_size, sizeof (*exec_cmd->ring));
+        if (!exec_cmd->ring)
+            return;
+    }
+
+    if (exec_cmd->ring_count < exec_cmd->ring_size)
+    {
+        index = (exec_cmd->ring_start + exec_cmd->ring_count) % exec_cmd->ring_size;
+        exec_cmd->ring_count++;
+    }
+    else
+    {
+        /* ring is full: replace the oldest line */
+        index = exec_cmd->ring_start;
+        exec_cmd->ring_start = (exec_cmd->ring_start + 1) % exec_cmd->ring_size;
+    }
+
+    ptr_ring_line = &(exec_cmd->ring[index]);
+    free (ptr_ring_line->line);
+    exec_cmd->output_line_nb++;
+    ptr_ring_line->out = out;
+    ptr_ring_line->line_nb = exec_cmd->output_line_nb;
+    ptr_ring_line->line = strdup (line);
+
+    exec_cmd->ring_changed = 1;
+}
+
+/*
+ * Displays lines of the ring; if the buffer is an exec buffer, it is
+ * cleared before (so that only the last lines are displayed).
+ */
+
+void
+exec_ring_display (struct t_exec_cmd *exec_cmd, struct t_gui_buffer *buffer)
+{
+    struct t_exec_ring_line *ptr_ring_line;
+    int i, line_nb;
+
+    if (!exec_cmd->ring || !exec_cmd->ring_changed)
+        return;
+
+    exec_cmd->ring_changed = 0;
+
+    if (buffer
+        && (strcmp (weechat_buffer_get_string (buffer, "plugin"),
+                    EXEC_PLUGIN_NAME) == 0))
+    {
+        weechat_buffer_clear (buffer);
+    }
+
+    line_nb = exec_cmd->output_line_nb;
+    weechat_printf_lines_begin (buffer);
+    for (i = 0; i < exec_cmd->ring_count; i++)
+    {
+        ptr_ring_line = &(exec_cmd->ring[(exec_cmd->ring_start + i) % exec_cmd->ring_size]);
+        exec_cmd->output_line_nb = ptr_ring_line->line_nb - 1;
+        exec_display_line (exec_cmd, buffer, ptr_ring_line->out,
+                           ptr_ring_line->line);
+    }
+    weechat_printf_lines_end (buffer);
+    exec_cmd->output_line_nb = line_nb;
+}
+
+/*
+ * Frees the ring of last lines.
+ */
+
+void
+exec_ring_free (struct t_exec_cmd *exec_cmd)
+{
+    int i;
+
+    if (exec_cmd->ring_timer)
+    {
+        weechat_unhook (exec_cmd->ring_timer);
+        exec_cmd->ring_timer = NULL;
+    }
+
+    if (!exec_cmd->ring)
+        return;
+
+    for (i = 0; i < exec_cmd->ring_size; i++)
+    {
+        free (exec_cmd->ring[i].line);
+    }
+    free (exec_cmd->ring);
+    exec_cmd->ring = NULL;
+    exec_cmd->ring_start = 0;
+    exec_cmd->ring_count = 0;
+    exec_cmd->ring_changed = 0;
+}
+
+/*
+ * Timer callback to refresh the display of ring in an exec buffer.
+ */
+
+int
+exec_ring_timer_cb (const void *pointer, void *data, int remaining_calls)
+{
+    struct t_exec_cmd *exec_cmd;
+    struct t_gui_buffer *ptr_buffer;
+
+    /* make C compiler happy */
+    (void) data;
+    (void) remaining_calls;
+
+    exec_cmd = (struct t_exec_cmd *)pointer;
+    if (!exec_cmd)
+        return WEECHAT_RC_OK;
+
+    ptr_buffer = weechat_buffer_search ("==", exec_cmd->buffer_full_name);
+    if (ptr_buffer
+        && (strcmp (weechat_buffer_get_string (ptr_buffer, "plugin"),
+                    EXEC_PLUGIN_NAME) == 0))
+    {
+        exec_ring_display (exec_cmd, ptr_buffer);
+    }
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Handles a line of output: the line is kept in the ring (option "-ring"),
+ * dropped if the rate limit is reached (option "-rate") or displayed.
+ */
+
+void
+exec_output_line (struct t_exec_cmd *exec_cmd, struct t_gui_buffer *buffer,
+                  int out, const char *line)
+{
+    time_t now;
+
+    if (!exec_cmd || !line)
+        return;
+
+    if (exec_cmd->ring_size > 0)
+    {
+        exec_ring_add (exec_cmd, out, line);
+        return;
+    }
+
+    if (exec_cmd->rate_limit > 0)
+    {
+        now = time (NULL);
+        if (now != exec_cmd->rate_time)
+        {
+            exec_cmd->rate_time = now;
+            exec_cmd->rate_count = 0;
+            exec_display_lines_dropped (exec_cmd, buffer);
+        }
+        if (exec_cmd->rate_count >= exec_cmd->rate_limit)
+        {
+            exec_cmd->lines_dropped++;
+            return;
+        }
+        exec_cmd->rate_count++;
+    }
+
+    exec_display_line (exec_cmd, buffer, out, line);
+}
+
 /*
  * Concatenates some text to stdout/stderr of a command.
  */
@@ -419,7 +641,7 @@ exec_concat_output (struct t_exec_cmd *exec_cmd, struct t_gui_buffer *buffer,
             free (exec_cmd->output[out]);
             exec_cmd->output[out] = NULL;
             exec_cmd->output_size[out] = 0;
-            exec_display_line (exec_cmd, buffer, out, line);
+            exec_output_line (exec_cmd, buffer, out, line);
             free (line);
             ptr_text = pos_next;
         }
@@ -482,10 +704,14 @@ exec_end_command (struct t_exec_cmd *exec_cmd, int return_code)
         ptr_buffer = weechat_buffer_search ("==", exec_cmd->buffer_full_name);
 
         /* display the last line of output (if not ending with '\n') */
-        exec_display_line (exec_cmd, ptr_buffer, EXEC_STDOUT,
-                           exec_cmd->output[EXEC_STDOUT]);
-        exec_display_line (exec_cmd, ptr_buffer, EXEC_STDERR,
-                           exec_cmd->output[EXEC_STDERR]);
+        exec_output_line (exec_cmd, ptr_buffer, EXEC_STDOUT,
+                          exec_cmd->output[EXEC_STDOUT]);
+        exec_output_line (exec_cmd, ptr_buffer, EXEC_STDERR,
+                          exec_cmd->output[EXEC_STDERR]);
+
+        /* display last lines kept in ring and lines dropped */
+        exec_ring_display (exec_cmd, ptr_buffer);
+        exec_display_lines_dropped (exec_cmd, ptr_buffer);
 
         /*
          * display return code (only if command is not detached, if output is
@@ -552,6 +778,7 @@ exec_end_command (struct t_exec_cmd *exec_cmd, int return_code)
         exec_cmd->output[i] = NULL;
         exec_cmd->output_size[i] = 0;
     }
+    exec_ring_free (exec_cmd);
 
     /* schedule a timer to remove the executed command */
     if (weechat_config_integer (exec_config_command_purge_delay) >= 0)
@@ -597,10 +824,13 @@ exec_process_cb (const void *pointer, void *data, const char *command,
     {
         ptr_buffer = weechat_buffer_search ("==",
                                             ptr_exec_cmd->buffer_full_name);
+        /* display all lines received at once (one hotlist update) */
+        weechat_printf_lines_begin (ptr_buffer);
         if (out)
             exec_concat_output (ptr_exec_cmd, ptr_buffer, EXEC_STDOUT, out);
         if (err)
             exec_concat_output (ptr_exec_cmd, ptr_buffer, EXEC_STDERR, err);
+        weechat_printf_lines_end (ptr_buffer);
     }
 
     if (return_code == WEECHAT_HOOK_PROCESS_ERROR)
@@ -644,6 +874,7 @@ exec_free (struct t_exec_cmd *exec_cmd)
     }
     free (exec_cmd->pipe_command);
     free (exec_cmd->hsignal);
+    exec_ring_free (exec_cmd);
 
     free (exec_cmd);
 
@@ -691,6 +922,16 @@ exec_print_log ()
         weechat_log_printf ("  buffer_full_name. . . . . : '%s'", ptr_exec_cmd->buffer_full_name);
         weechat_log_printf ("  line_numbers. . . . . . . : %d", ptr_exec_cmd->line_numbers);
         weechat_log_printf ("  display_rc. . . . . . . . : %d", ptr_exec_cmd->display_rc);
+        weechat_log_printf ("  rate_limit. . . . . . . . : %d", ptr_exec_cmd->rate_limit);
+        weechat_log_printf ("  rate_time . . . . . . . . : %lld", (long long)ptr_exec_cmd->rate_time);
+        weechat_log_printf ("  rate_count. . . . . . . . : %d", ptr_exec_cmd->rate_count);
+        weechat_log_printf ("  lines_dropped . . . . . . : %d", ptr_exec_cmd->lines_dropped);
+        weechat_log_printf ("  ring_size . . . . . . . . : %d", ptr_exec_cmd->ring_size);
+        weechat_log_printf ("  ring. . . . . . . . . . . : %p", ptr_exec_cmd->ring);
+        weechat_log_printf ("  ring_start. . . . . . . . : %d", ptr_exec_cmd->ring_start);
+        weechat_log_printf ("  ring_count. . . . . . . . : %d", ptr_exec_cmd->ring_count);
+        weechat_log_printf ("  ring_changed. . . . . . . : %d", ptr_exec_cmd->ring_changed);
+        weechat_log_printf ("  ring_timer. . . . . . . . : %p", ptr_exec_cmd->ring_timer);
         weechat_log_printf ("  output_line_nb. . . . . . : %d", ptr_exec_cmd->output_line_nb);
         weechat_log_printf ("  output_size[stdout] . . . : %d", ptr_exec_cmd->output_size[EXEC_STDOUT]);
         weechat_log_printf ("  output[stdout]. . . . . . : '%s'", ptr_exec_cmd->output[EXEC_STDOUT]);
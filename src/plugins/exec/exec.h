@@ -41,6 +41,13 @@ enum t_exec_color
     EXEC_NUM_COLORS,
 };
 
+struct t_exec_ring_line
+{
+    int out;                           /* EXEC_STDOUT or EXEC_STDERR        */
+    int line_nb;                       /* line number                       */
+    char *line;                        /* content of line                   */
+};
+
 struct t_exec_cmd
 {
     /* command/process */
@@ -61,6 +68,16 @@ struct t_exec_cmd
     int line_numbers;                  /* 1 if lines numbers are displayed  */
     int color;                         /* what to do with ANSI colors       */
     int display_rc;                    /* 1 if return code is displayed     */
+    int rate_limit;                    /* max lines displayed/sec (0 = none)*/
+    time_t rate_time;                  /* second of lines counted           */
+    int rate_count;                    /* lines displayed in this second    */
+    int lines_dropped;                 /* lines dropped (not reported yet)  */
+    int ring_size;                     /* keep only N last lines (0 = off)  */
+    struct t_exec_ring_line *ring;     /* ring with N last lines            */
+    int ring_start;                    /* index of first line in ring       */
+    int ring_count;                    /* number of lines in ring           */
+    int ring_changed;                  /* 1 if ring changed since display   */
+    struct t_hook *ring_timer;         /* timer to refresh ring display     */
 
     /* command output */
     int output_line_nb;                /* line number                       */
@@ -87,6 +104,8 @@ extern struct t_exec_cmd *exec_add ();
 extern int exec_process_cb (const void *pointer, void *data,
                             const char *command, int return_code,
                             const char *out, const char *err);
+extern int exec_ring_timer_cb (const void *pointer, void *data,
+                               int remaining_calls);
 extern void exec_free (struct t_exec_cmd *exec_cmd);
 extern void exec_free_all ();
 
@@ -35,6 +35,7 @@ struct t_config_section *fifo_config_section_file = NULL;
 /* fifo config, file section */
 
 struct t_config_option *fifo_config_file_enabled = NULL;
+struct t_config_option *fifo_config_file_exec_max_time = NULL;
 struct t_config_option *fifo_config_file_path = NULL;
 
 
@@ -113,6 +114,17 @@ fifo_config_init ()
             NULL, NULL, NULL,
             &fifo_config_change_file_enabled, NULL, NULL,
             NULL, NULL, NULL);
+        fifo_config_file_exec_max_time = weechat_config_new_option (
+            fifo_config_file, fifo_config_section_file,
+            "exec_max_time", "integer",
+            N_("max time (in milliseconds) spent to execute commands received "
+               "in pipe before giving control back to WeeChat; the remaining "
+               "commands are executed later, and the pipe is not read until "
+               "they are all executed (0 = execute all commands immediately)"),
+            NULL, 0, 60000, "50", NULL, 0,
+            NULL, NULL, NULL,
+            NULL, NULL, NULL,
+            NULL, NULL, NULL);
         fifo_config_file_path = weechat_config_new_option (
             fifo_config_file, fifo_config_section_file,
             "path", "string",
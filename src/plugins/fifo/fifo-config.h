@@ -24,6 +24,7 @@
 #define FIFO_CONFIG_PRIO_NAME (TO_STR(FIFO_PLUGIN_PRIORITY) "|" FIFO_CONFIG_NAME)
 
 extern struct t_config_option *fifo_config_file_enabled;
+extern struct t_config_option *fifo_config_file_exec_max_time;
 extern struct t_config_option *fifo_config_file_path;
 
 extern int fifo_config_init ();
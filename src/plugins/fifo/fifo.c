@@ -25,6 +25,7 @@
 #include <string.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/time.h>
 #include <dirent.h>
 #include <limits.h>
 #include <fcntl.h>
@@ -51,10 +52,20 @@ int fifo_quiet = 0;
 int fifo_fd = -1;
 struct t_hook *fifo_fd_hook = NULL;
 char *fifo_filename = NULL;
-char *fifo_unterminated = NULL;
+char *fifo_pending = NULL;             /* data received, not executed   */
+int fifo_pending_size = 0;             /* size of data in fifo_pending  */
+int fifo_pending_alloc = 0;            /* allocated size for pending    */
+struct t_hook *fifo_exec_timer = NULL; /* timer to execute pending cmds */
+char *fifo_buffer_name = NULL;         /* last buffer name used in pipe */
+struct t_gui_buffer *fifo_buffer = NULL; /* last buffer used in pipe    */
+struct t_hook *fifo_hook_buffer_closing = NULL;
+struct t_hook *fifo_hook_buffer_renamed = NULL;
 
 
 int fifo_fd_cb (const void *pointer, void *data, int fd);
+int fifo_buffer_signal_cb (const void *pointer, void *data,
+                           const char *signal,
+                           const char *type_data, void *signal_data);
 
 
 /*
@@ -121,6 +132,10 @@ fifo_create ()
             }
             fifo_fd_hook = weechat_hook_fd (fifo_fd, 1, 0, 0,
                                             &fifo_fd_cb, NULL, NULL);
+            fifo_hook_buffer_closing = weechat_hook_signal (
+                "buffer_closing", &fifo_buffer_signal_cb, NULL, NULL);
+            fifo_hook_buffer_renamed = weechat_hook_signal (
+                "buffer_renamed", &fifo_buffer_signal_cb, NULL, NULL);
         }
         else
         {
@@ -152,12 +167,27 @@ fifo_remove ()
 
     fifo_found = (fifo_fd != -1);
 
-    /* remove fd hook */
+    /* remove hooks */
     if (fifo_fd_hook)
     {
         weechat_unhook (fifo_fd_hook);
         fifo_fd_hook = NULL;
     }
+    if (fifo_exec_timer)
+    {
+        weechat_unhook (fifo_exec_timer);
+        fifo_exec_timer = NULL;
+    }
+    if (fifo_hook_buffer_closing)
+    {
+        weechat_unhook (fifo_hook_buffer_closing);
+        fifo_hook_buffer_closing = NULL;
+    }
+    if (fifo_hook_buffer_renamed)
+    {
+        weechat_unhook (fifo_hook_buffer_renamed);
+        fifo_hook_buffer_renamed = NULL;
+    }
 
     /* close FIFO pipe */
     if (fifo_fd != -1)
@@ -166,9 +196,16 @@ fifo_remove ()
         fifo_fd = -1;
     }
 
-    /* remove any unterminated message */
-    free (fifo_unterminated);
-    fifo_unterminated = NULL;
+    /* remove any pending data (not executed or unterminated) */
+    free (fifo_pending);
+    fifo_pending = NULL;
+    fifo_pending_size = 0;
+    fifo_pending_alloc = 0;
+
+    /* remove last buffer used */
+    free (fifo_buffer_name);
+    fifo_buffer_name = NULL;
+    fifo_buffer = NULL;
 
     /* remove FIFO from disk */
     if (fifo_filename)
@@ -186,6 +223,59 @@ fifo_remove ()
     }
 }
 
+/*
+ * Callback for signals "buffer_closing" and "buffer_renamed": forgets the
+ * last buffer used in pipe.
+ */
+
+int
+fifo_buffer_signal_cb (const void *pointer, void *data,
+                       const char *signal,
+                       const char *type_data, void *signal_data)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) signal;
+    (void) type_data;
+    (void) signal_data;
+
+    free (fifo_buffer_name);
+    fifo_buffer_name = NULL;
+    fifo_buffer = NULL;
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Searches a buffer by full name; the last buffer found is kept, so that
+ * many commands sent to the same buffer do not search it each time.
+ *
+ * Returns pointer to buffer found, NULL if not found.
+ */
+
+struct t_gui_buffer *
+fifo_search_buffer (const char *full_name)
+{
+    struct t_gui_buffer *ptr_buffer;
+
+    if (fifo_buffer && fifo_buffer_name
+        && (strcmp (fifo_buffer_name, full_name) == 0))
+    {
+        return fifo_buffer;
+    }
+
+    ptr_buffer = weechat_buffer_search ("==", full_name);
+    if (ptr_buffer)
+    {
+        free (fifo_buffer_name);
+        fifo_buffer_name = strdup (full_name);
+        fifo_buffer = (fifo_buffer_name) ? ptr_buffer : NULL;
+    }
+
+    return ptr_buffer;
+}
+
 /*
  * Executes a command/text received in FIFO pipe.
  */
@@ -234,7 +324,7 @@ fifo_exec (const char *text)
         escaped = pos_msg[1] == '\\';
         pos_msg[0] = '\0';
         pos_msg += 2;
-        ptr_buffer = weechat_buffer_search ("==", text2);
+        ptr_buffer = fifo_search_buffer (text2);
         if (!ptr_buffer)
         {
             weechat_printf (NULL,
@@ -259,6 +349,101 @@ fifo_exec (const char *text)
     free (command_unescaped);
 }
 
+/*
+ * Executes complete lines received in FIFO pipe, during at most
+ * "fifo.file.exec_max_time" milliseconds.
+ *
+ * Returns:
+ *   1: all complete lines have been executed
+ *   0: some complete lines are still pending
+ */
+
+int
+fifo_exec_pending ()
+{
+    struct timeval tv_start, tv_now;
+    long long max_time;
+    char *ptr_line, *pos;
+    int pos_start, length;
+
+    max_time = (long long)weechat_config_integer (fifo_config_file_exec_max_time) * 1000;
+    if (max_time > 0)
+        gettimeofday (&tv_start, NULL);
+
+    pos_start = 0;
+    while (pos_start < fifo_pending_size)
+    {
+        ptr_line = fifo_pending + pos_start;
+        pos = memchr (ptr_line, '\n', fifo_pending_size - pos_start);
+        if (!pos)
+            break;
+        length = pos - ptr_line;
+        pos_start += length + 1;
+        pos[0] = '\0';
+        if ((length > 0) && (ptr_line[length - 1] == '\r'))
+            ptr_line[length - 1] = '\0';
+
+        fifo_exec (ptr_line);
+
+        /* pipe removed in command executed? */
+        if (!fifo_pending)
+            return 1;
+
+        if (max_time > 0)
+        {
+            gettimeofday (&tv_now, NULL);
+            if (weechat_util_timeval_diff (&tv_start, &tv_now) >= max_time)
+                break;
+        }
+    }
+
+    /* keep remaining data (pending lines and unterminated line) */
+    if (pos_start > 0)
+    {
+        fifo_pending_size -= pos_start;
+        if (fifo_pending_size > 0)
+        {
+            memmove (fifo_pending, fifo_pending + pos_start,
+                     fifo_pending_size);
+        }
+    }
+
+    if (fifo_pending_size <= 0)
+        return 1;
+
+    return (memchr (fifo_pending, '\n', fifo_pending_size)) ? 0 : 1;
+}
+
+/*
+ * Timer callback: executes lines still pending and reads the pipe again
+ * when they are all executed.
+ */
+
+int
+fifo_exec_timer_cb (const void *pointer, void *data, int remaining_calls)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) remaining_calls;
+
+    if (!fifo_exec_pending ())
+        return WEECHAT_RC_OK;
+
+    if (fifo_exec_timer)
+    {
+        weechat_unhook (fifo_exec_timer);
+        fifo_exec_timer = NULL;
+    }
+    if (!fifo_fd_hook && (fifo_fd != -1))
+    {
+        fifo_fd_hook = weechat_hook_fd (fifo_fd, 1, 0, 0,
+                                        &fifo_fd_cb, NULL, NULL);
+    }
+
+    return WEECHAT_RC_OK;
+}
+
 /*
  * Reads data in FIFO pipe.
  */
@@ -266,68 +451,45 @@ fifo_exec (const char *text)
 int
 fifo_fd_cb (const void *pointer, void *data, int fd)
 {
-    static char buffer[4096 + 2];
-    char *buf2, *pos, *ptr_buf, *next_ptr_buf;
-    int num_read, check_error;
+    char *new_pending;
+    int num_read, new_alloc, check_error;
 
     /* make C compiler happy */
     (void) pointer;
     (void) data;
     (void) fd;
 
-    num_read = read (fifo_fd, buffer, sizeof (buffer) - 2);
-    if (num_read > 0)
+    /* read a large chunk of data after the pending data */
+    if (fifo_pending_alloc - fifo_pending_size < FIFO_READ_SIZE)
     {
-        buffer[num_read] = '\0';
-
-        buf2 = NULL;
-        ptr_buf = buffer;
-        if (fifo_unterminated)
-        {
-            buf2 = malloc (strlen (fifo_unterminated) +
-                           strlen (buffer) + 1);
-            if (buf2)
-            {
-                strcpy (buf2, fifo_unterminated);
-                strcat (buf2, buffer);
-            }
-            ptr_buf = buf2;
-            free (fifo_unterminated);
-            fifo_unterminated = NULL;
-        }
+        new_alloc = fifo_pending_size + FIFO_READ_SIZE;
+        new_pending = realloc (fifo_pending, new_alloc);
+        if (!new_pending)
+            return WEECHAT_RC_OK;
+        fifo_pending = new_pending;
+        fifo_pending_alloc = new_alloc;
+    }
 
-        while (ptr_buf && ptr_buf[0])
+    num_read = read (fifo_fd, fifo_pending + fifo_pending_size,
+                     FIFO_READ_SIZE);
+    if (num_read > 0)
+    {
+        fifo_pending_size += num_read;
+        if (!fifo_exec_pending () && fifo_fd_hook)
         {
-            next_ptr_buf = NULL;
-            pos = strstr (ptr_buf, "\r\n");
-            if (pos)
+            /*
+             * time is over: stop reading the pipe and execute the pending
+             * lines on next main loop iterations
+             */
+            weechat_unhook (fifo_fd_hook);
+            fifo_fd_hook = NULL;
+            if (!fifo_exec_timer)
             {
-                pos[0] = '\0';
-                next_ptr_buf = pos + 2;
+                fifo_exec_timer = weechat_hook_timer (
+                    1, 0, 0,
+                    &fifo_exec_timer_cb, NULL, NULL);
             }
-            else
-            {
-                pos = strstr (ptr_buf, "\n");
-                if (pos)
-                {
-                    pos[0] = '\0';
-                    next_ptr_buf = pos + 1;
-                }
-                else
-                {
-                    fifo_unterminated = strdup (ptr_buf);
-                    ptr_buf = NULL;
-                    next_ptr_buf = NULL;
-                }
-            }
-
-            if (ptr_buf)
-                fifo_exec (ptr_buf);
-
-            ptr_buf = next_ptr_buf;
         }
-
-        free (buf2);
     }
     else if (num_read < 0)
     {
@@ -24,6 +24,9 @@
 #define FIFO_PLUGIN_NAME "fifo"
 #define FIFO_PLUGIN_PRIORITY 9000
 
+/* size of chunk read in the pipe */
+#define FIFO_READ_SIZE (64 * 1024)
+
 extern struct t_weechat_plugin *weechat_fifo_plugin;
 extern int fifo_quiet;
 extern int fifo_fd;
@@ -27,6 +27,7 @@
 #include "../weechat-plugin.h"
 #include "fset.h"
 #include "fset-option.h"
+#include "fset-bar-item.h"
 #include "fset-buffer.h"
 #include "fset-config.h"
 
@@ -1078,20 +1079,171 @@ fset_option_set_filter (const char *filter)
         strdup (filter) : NULL;
 }
 
+/*
+ * Returns the length of prefix for a filter matching a substring (for example
+ * 1 for "=value"), -1 if the filter is not matching a substring (condition,
+ * exact value, mask with wildcard, ...).
+ */
+
+int
+fset_option_filter_substring_prefix (const char *filter)
+{
+    if (strchr (filter, '*'))
+        return -1;
+
+    if ((strncmp (filter, "c:", 2) == 0)
+        || (strncmp (filter, "f:", 2) == 0)
+        || (strncmp (filter, "t:", 2) == 0)
+        || (strncmp (filter, "d==", 3) == 0)
+        || (strcmp (filter, "d") == 0)
+        || (strncmp (filter, "==", 2) == 0))
+    {
+        return -1;
+    }
+
+    if ((strncmp (filter, "d=", 2) == 0)
+        || (strncmp (filter, "d:", 2) == 0)
+        || (strncmp (filter, "h=", 2) == 0))
+    {
+        return 2;
+    }
+    if (strncmp (filter, "he=", 3) == 0)
+        return 3;
+    if (filter[0] == '=')
+        return 1;
+
+    /* filter by option name */
+    return 0;
+}
+
+/*
+ * Checks if options matching a new filter are a subset of options matching
+ * the old filter (for example old filter "irc.look" and new filter
+ * "irc.look.color"), so that the current list of options can be filtered
+ * instead of getting again all options.
+ *
+ * Returns:
+ *   1: new filter narrows the old filter
+ *   0: new filter does not narrow the old filter
+ */
+
+int
+fset_option_filter_is_narrower (const char *old_filter, const char *new_filter)
+{
+    int prefix;
+
+    if (!new_filter)
+        return 0;
+
+    /* no filter before: list contains all options */
+    if (!old_filter)
+        return 1;
+
+    prefix = fset_option_filter_substring_prefix (old_filter);
+    if ((prefix < 0)
+        || (prefix != fset_option_filter_substring_prefix (new_filter)))
+    {
+        return 0;
+    }
+
+    return (strncmp (new_filter, old_filter, strlen (old_filter)) == 0) ?
+        1 : 0;
+}
+
+/*
+ * Filters the current list of options with the filter (which must narrow the
+ * filter used to build the list): only options matching the filter are
+ * kept, without looping on all WeeChat/plugin options.
+ */
+
+void
+fset_option_filter_current_options ()
+{
+    struct t_arraylist *new_options;
+    struct t_fset_option *ptr_fset_option, *new_fset_option;
+    struct t_config_option *ptr_option;
+    int i, num_options, keep_marked;
+
+    new_options = fset_option_get_arraylist_options ();
+    if (!new_options)
+    {
+        fset_option_get_options ();
+        return;
+    }
+
+    keep_marked = !weechat_config_boolean (fset_config_look_auto_unmark);
+
+    fset_option_count_marked = 0;
+    fset_option_init_max_length (fset_option_max_length);
+
+    num_options = weechat_arraylist_size (fset_options);
+    for (i = 0; i < num_options; i++)
+    {
+        ptr_fset_option = weechat_arraylist_get (fset_options, i);
+        if (!ptr_fset_option
+            || !fset_option_match_filter (ptr_fset_option, fset_option_filter))
+        {
+            continue;
+        }
+        ptr_option = weechat_config_get (ptr_fset_option->name);
+        if (!ptr_option)
+            continue;
+        new_fset_option = fset_option_add (ptr_option);
+        if (!new_fset_option)
+            continue;
+        if (keep_marked && ptr_fset_option->marked)
+        {
+            new_fset_option->marked = 1;
+            fset_option_count_marked++;
+        }
+        weechat_arraylist_add (new_options, new_fset_option);
+    }
+
+    weechat_arraylist_free (fset_options);
+    fset_options = new_options;
+
+    num_options = weechat_arraylist_size (fset_options);
+    for (i = 0; i < num_options; i++)
+    {
+        ptr_fset_option = weechat_arraylist_get (fset_options, i);
+        if (ptr_fset_option)
+            ptr_fset_option->index = i;
+    }
+}
+
 /*
  * Filters options.
+ *
+ * If the fset buffer is opened with options displayed and the new filter
+ * narrows the current one (for example when a char is added at the end of
+ * filter), only the options currently displayed are filtered.
  */
 
 void
 fset_option_filter_options (const char *filter)
 {
+    char *old_filter;
+
     fset_buffer_selected_line = 0;
 
+    old_filter = (fset_option_filter) ? strdup (fset_option_filter) : NULL;
+
     fset_option_set_filter (filter);
 
     fset_buffer_set_localvar_filter ();
 
-    fset_option_get_options ();
+    if (fset_buffer
+        && (weechat_arraylist_size (fset_options) > 0)
+        && fset_option_filter_is_narrower (old_filter, fset_option_filter))
+    {
+        fset_option_filter_current_options ();
+    }
+    else
+    {
+        fset_option_get_options ();
+    }
+
+    free (old_filter);
 
     fset_buffer_refresh (1);
 }
@@ -1484,6 +1636,7 @@ void
 fset_option_config_changed (const char *option_name)
 {
     struct t_fset_option *ptr_fset_option, *new_fset_option;
+    struct t_fset_option_max_length old_max_length;
     struct t_config_option *ptr_option;
     int option_removed, option_added, line, num_options;
     char *old_name_selected;
@@ -1552,6 +1705,8 @@ fset_option_config_changed (const char *option_name)
     }
     else
     {
+        memcpy (&old_max_length, fset_option_max_length,
+                sizeof (old_max_length));
         num_options = weechat_arraylist_size (fset_options);
         for (line = 0; line < num_options; line++)
         {
@@ -1567,7 +1722,30 @@ fset_option_config_changed (const char *option_name)
             }
         }
         fset_option_set_max_length_fields_all ();
-        fset_buffer_refresh (0);
+        if (memcmp (&old_max_length, fset_option_max_length,
+                    sizeof (old_max_length)) != 0)
+        {
+            /* max length of fields changed: all lines must be displayed */
+            fset_buffer_refresh (0);
+        }
+        else
+        {
+            /* display only options using this option as parent */
+            for (line = 0; line < num_options; line++)
+            {
+                ptr_fset_option = weechat_arraylist_get (fset_options, line);
+                if (ptr_fset_option
+                    && ptr_fset_option->parent_name
+                    && option_name
+                    && (strcmp (ptr_fset_option->parent_name,
+                                option_name) == 0))
+                {
+                    (void) fset_buffer_display_option (ptr_fset_option);
+                }
+            }
+            fset_buffer_set_title ();
+            fset_bar_item_update ();
+        }
     }
 
     free (old_name_selected);
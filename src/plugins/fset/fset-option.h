@@ -99,6 +99,8 @@ extern void fset_option_set_max_length_fields_all ();
 extern void fset_option_free (struct t_fset_option *fset_option);
 extern struct t_arraylist *fset_option_get_arraylist_options ();
 extern struct t_fset_option_max_length *fset_option_get_max_length ();
+extern int fset_option_filter_is_narrower (const char *old_filter,
+                                           const char *new_filter);
 extern void fset_option_get_options ();
 extern void fset_option_set_filter (const char *filter);
 extern void fset_option_filter_options (const char *filter);
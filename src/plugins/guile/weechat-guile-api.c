@@ -5230,6 +5230,30 @@ weechat_guile_api_hdata_hashtable (SCM hdata, SCM pointer, SCM name)
     API_RETURN_OTHER(result_alist);
 }
 
+SCM
+weechat_guile_api_hdata_get_fields (SCM hdata, SCM pointer, SCM count,
+                                    SCM fields)
+{
+    struct t_hashtable *result_hashtable;
+    SCM result_alist;
+
+    API_INIT_FUNC(1, "hdata_get_fields", API_RETURN_EMPTY);
+    if (!scm_is_string (hdata) || !scm_is_string (pointer)
+        || !scm_is_integer (count) || !scm_is_string (fields))
+        API_WRONG_ARGS(API_RETURN_EMPTY);
+
+    result_hashtable = weechat_hdata_get_fields (
+        API_STR2PTR(API_SCM_TO_STRING(hdata)),
+        API_STR2PTR(API_SCM_TO_STRING(pointer)),
+        scm_to_int (count),
+        API_SCM_TO_STRING(fields));
+    result_alist = weechat_guile_hashtable_to_alist (result_hashtable);
+
+    weechat_hashtable_free (result_hashtable);
+
+    API_RETURN_OTHER(result_alist);
+}
+
 SCM
 weechat_guile_api_hdata_compare (SCM hdata, SCM pointer1, SCM pointer2,
                                  SCM name, SCM case_sensitive)
@@ -5648,6 +5672,7 @@ weechat_guile_api_module_init (void *data)
     API_DEF_FUNC(hdata_pointer, 3);
     API_DEF_FUNC(hdata_time, 3);
     API_DEF_FUNC(hdata_hashtable, 3);
+    API_DEF_FUNC(hdata_get_fields, 4);
     API_DEF_FUNC(hdata_compare, 5);
     API_DEF_FUNC(hdata_update, 3);
     API_DEF_FUNC(hdata_get_string, 2);
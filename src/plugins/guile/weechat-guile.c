@@ -53,6 +53,7 @@ struct t_plugin_script_data guile_data;
 struct t_config_file *guile_config_file = NULL;
 struct t_config_option *guile_config_look_check_license = NULL;
 struct t_config_option *guile_config_look_eval_keep_context = NULL;
+struct t_config_option *guile_config_look_autoload_deferred = NULL;
 
 int guile_quiet = 0;
 
@@ -598,13 +599,18 @@ void
 weechat_guile_load_cb (void *data, const char *filename)
 {
     const char *pos_dot;
-
-    /* make C compiler happy */
-    (void) data;
+    int old_guile_quiet;
 
     pos_dot = strrchr (filename, '.');
     if (pos_dot && (strcmp (pos_dot, ".scm") == 0))
+    {
+        /* data is an optional pointer to integer: 1 for quiet mode */
+        old_guile_quiet = guile_quiet;
+        if (data && *((int *)data))
+            guile_quiet = 1;
         weechat_guile_load (filename, NULL);
+        guile_quiet = old_guile_quiet;
+    }
 }
 
 /*
@@ -1311,6 +1317,7 @@ weechat_plugin_init (struct t_weechat_plugin *plugin, int argc, char *argv[])
     guile_data.config_file = &guile_config_file;
     guile_data.config_look_check_license = &guile_config_look_check_license;
     guile_data.config_look_eval_keep_context = &guile_config_look_eval_keep_context;
+    guile_data.config_look_autoload_deferred = &guile_config_look_autoload_deferred;
     guile_data.scripts = &guile_scripts;
     guile_data.last_script = &last_guile_script;
     guile_data.callback_command = &weechat_guile_command_cb;
@@ -28,6 +28,8 @@
 #include "../weechat-plugin.h"
 #include "irc.h"
 #include "irc-batch.h"
+#include "irc-channel.h"
+#include "irc-chathistory.h"
 #include "irc-message.h"
 #include "irc-protocol.h"
 #include "irc-raw.h"
@@ -133,6 +135,9 @@ irc_batch_start_batch (struct t_irc_server *server, const char *reference,
     ptr_batch->tags = (tags) ? weechat_hashtable_dup (tags) : NULL;
     ptr_batch->start_time = time (NULL);
     ptr_batch->messages = NULL;
+    ptr_batch->msgs = NULL;
+    ptr_batch->num_msgs = 0;
+    ptr_batch->size_msgs = 0;
     ptr_batch->end_received = 0;
     ptr_batch->messages_processed = 0;
 
@@ -144,6 +149,11 @@ irc_batch_start_batch (struct t_irc_server *server, const char *reference,
 /*
  * Adds an IRC message to a batch reference.
  *
+ * The message is appended to the string "messages" and its position is
+ * stored with the command and channel already parsed (both are optional),
+ * so that messages are not split and parsed again when the batch is
+ * processed.
+ *
  * Returns:
  *   1: OK, message added
  *   0: error, message not added
@@ -151,9 +161,12 @@ irc_batch_start_batch (struct t_irc_server *server, const char *reference,
 
 int
 irc_batch_add_message (struct t_irc_server *server, const char *reference,
-                       const char *irc_message)
+                       const char *irc_message, const char *command,
+                       const char *channel)
 {
     struct t_irc_batch *ptr_batch;
+    struct t_irc_batch_msg *new_msgs, *ptr_msg;
+    int new_size, offset;
 
     if (!server || !reference || !irc_message)
         return 0;
@@ -167,10 +180,28 @@ irc_batch_add_message (struct t_irc_server *server, const char *reference,
     if (!ptr_batch->messages)
         return 0;
 
+    if (ptr_batch->num_msgs >= ptr_batch->size_msgs)
+    {
+        new_size = (ptr_batch->size_msgs > 0) ? ptr_batch->size_msgs * 2 : 16;
+        new_msgs = realloc (ptr_batch->msgs, new_size * sizeof (*new_msgs));
+        if (!new_msgs)
+            return 0;
+        ptr_batch->msgs = new_msgs;
+        ptr_batch->size_msgs = new_size;
+    }
+
     if ((*(ptr_batch->messages))[0])
         weechat_string_dyn_concat (ptr_batch->messages, "\n", -1);
+    offset = strlen (*(ptr_batch->messages));
     weechat_string_dyn_concat (ptr_batch->messages, irc_message, -1);
 
+    ptr_msg = &(ptr_batch->msgs[ptr_batch->num_msgs]);
+    ptr_msg->offset = offset;
+    ptr_msg->length = strlen (irc_message);
+    ptr_msg->command = (command) ? strdup (command) : NULL;
+    ptr_msg->channel = (channel) ? strdup (channel) : NULL;
+    ptr_batch->num_msgs++;
+
     return 1;
 }
 
@@ -181,12 +212,20 @@ irc_batch_add_message (struct t_irc_server *server, const char *reference,
 void
 irc_batch_free (struct t_irc_server *server, struct t_irc_batch *batch)
 {
+    int i;
+
     free (batch->reference);
     free (batch->parent_ref);
     free (batch->type);
     free (batch->parameters);
     weechat_hashtable_free (batch->tags);
     weechat_string_dyn_free (batch->messages, 1);
+    for (i = 0; i < batch->num_msgs; i++)
+    {
+        free (batch->msgs[i].command);
+        free (batch->msgs[i].channel);
+    }
+    free (batch->msgs);
 
     /* remove batch from list */
     if (batch->prev_batch)
@@ -214,6 +253,82 @@ irc_batch_free_all (struct t_irc_server *server)
     }
 }
 
+/*
+ * Processes a message of a batch.
+ *
+ * Arguments "command" and "channel" are the command and channel already
+ * parsed in message; if "command" is NULL, the message is parsed.
+ */
+
+void
+irc_batch_process_message (struct t_irc_server *server,
+                           struct t_irc_batch *batch,
+                           const char *message,
+                           const char *command,
+                           const char *channel)
+{
+    char *message_lf, *message_tags, *msg_command, *msg_channel;
+    const char *ptr_message;
+
+    message_lf = NULL;
+    message_tags = NULL;
+    msg_command = NULL;
+    msg_channel = NULL;
+
+    ptr_message = message;
+
+    if (strchr (ptr_message, '\r'))
+    {
+        message_lf = weechat_string_replace (ptr_message, "\r", "\n");
+        if (!message_lf)
+            goto end;
+        ptr_message = message_lf;
+    }
+
+    if (batch->tags)
+    {
+        message_tags = irc_tag_add_tags_to_message (ptr_message, batch->tags);
+        if (!message_tags)
+            goto end;
+        ptr_message = message_tags;
+    }
+
+    if (!command)
+    {
+        irc_message_parse (server,
+                           ptr_message,
+                           NULL,   /* tags */
+                           NULL,   /* message_without_tags */
+                           NULL,   /* nick */
+                           NULL,   /* user */
+                           NULL,   /* host */
+                           &msg_command,
+                           &msg_channel,
+                           NULL,   /* arguments */
+                           NULL,   /* text */
+                           NULL,   /* params */
+                           NULL,   /* num_params */
+                           NULL,   /* pos_command */
+                           NULL,   /* pos_arguments */
+                           NULL,   /* pos_channel */
+                           NULL);  /* pos_text */
+        command = msg_command;
+        channel = msg_channel;
+    }
+
+    /* add raw message */
+    irc_raw_print (server, IRC_RAW_FLAG_RECV, ptr_message);
+
+    /* call receive callback, ignoring batch tags */
+    irc_protocol_recv_command (server, ptr_message, command, channel, 1);
+
+end:
+    free (message_lf);
+    free (message_tags);
+    free (msg_command);
+    free (msg_channel);
+}
+
 /*
  * Processes messages in a batch.
  */
@@ -222,8 +337,7 @@ void
 irc_batch_process_messages (struct t_irc_server *server,
                             struct t_irc_batch *batch)
 {
-    char **list_messages, *command, *channel, modifier_data[1024], *new_messages;
-    char *message, *message2;
+    char **list_messages, modifier_data[1024], *new_messages, *ptr_end;
     int i, count_messages;
 
     if (!batch || !batch->messages)
@@ -244,53 +358,40 @@ irc_batch_process_messages (struct t_irc_server *server,
         new_messages = NULL;
     }
 
-    /* messages not dropped? */
-    if (!new_messages || new_messages[0])
+    if (!new_messages)
+    {
+        /*
+         * messages unchanged: use the messages stored, each one is
+         * terminated in place (the separator '\n' is restored after use)
+         */
+        for (i = 0; i < batch->num_msgs; i++)
+        {
+            ptr_end = *(batch->messages) + batch->msgs[i].offset
+                + batch->msgs[i].length;
+            if (ptr_end[0])
+                ptr_end[0] = '\0';
+            else
+                ptr_end = NULL;
+            irc_batch_process_message (
+                server, batch,
+                *(batch->messages) + batch->msgs[i].offset,
+                batch->msgs[i].command,
+                batch->msgs[i].channel);
+            if (ptr_end)
+                ptr_end[0] = '\n';
+        }
+    }
+    else if (new_messages[0])
     {
-        list_messages = weechat_string_split (
-            (new_messages) ? new_messages : *(batch->messages),
-            "\n", NULL, 0, 0, &count_messages);
+        /* messages changed by a modifier (and not dropped) */
+        list_messages = weechat_string_split (new_messages, "\n", NULL, 0, 0,
+                                              &count_messages);
         if (list_messages)
         {
             for (i = 0; i < count_messages; i++)
             {
-                message = weechat_string_replace (list_messages[i], "\r", "\n");
-                if (!message)
-                    continue;
-
-                message2 = irc_tag_add_tags_to_message (message,
-                                                        batch->tags);
-                if (!message2)
-                    continue;
-
-                irc_message_parse (server,
-                                   message2,
-                                   NULL,   /* tags */
-                                   NULL,   /* message_without_tags */
-                                   NULL,   /* nick */
-                                   NULL,   /* user */
-                                   NULL,   /* host */
-                                   &command,
-                                   &channel,
-                                   NULL,   /* arguments */
-                                   NULL,   /* text */
-                                   NULL,   /* params */
-                                   NULL,   /* num_params */
-                                   NULL,   /* pos_command */
-                                   NULL,   /* pos_arguments */
-                                   NULL,   /* pos_channel */
-                                   NULL);  /* pos_text */
-
-                /* add raw message */
-                irc_raw_print (server, IRC_RAW_FLAG_RECV, message2);
-
-                /* call receive callback, ignoring batch tags */
-                irc_protocol_recv_command (server, message2, command, channel, 1);
-
-                free (message);
-                free (message2);
-                free (command);
-                free (channel);
+                irc_batch_process_message (server, batch, list_messages[i],
+                                           NULL, NULL);
             }
             weechat_string_free_split (list_messages);
         }
@@ -307,6 +408,8 @@ void
 irc_batch_end_batch (struct t_irc_server *server, const char *reference)
 {
     struct t_irc_batch *ptr_batch, *ptr_next_batch, *ptr_parent_batch;
+    struct t_irc_channel *ptr_channel;
+    struct t_gui_buffer *ptr_buffer;
     int num_processed;
 
     if (!server || !reference)
@@ -334,8 +437,23 @@ irc_batch_end_batch (struct t_irc_server *server, const char *reference)
             ptr_parent_batch = irc_batch_search (server, ptr_batch->parent_ref);
             if (!ptr_parent_batch || ptr_parent_batch->messages_processed)
             {
+                ptr_buffer = NULL;
+                if (strcmp (ptr_batch->type, "chathistory") == 0)
+                {
+                    ptr_channel = irc_channel_search (server,
+                                                      ptr_batch->parameters);
+                    if (ptr_channel)
+                        ptr_buffer = ptr_channel->buffer;
+                }
+                /* history of a channel: add all lines in a single batch */
+                if (ptr_buffer)
+                    weechat_printf_lines_begin (ptr_buffer);
                 irc_batch_process_messages (server, ptr_batch);
+                if (ptr_buffer)
+                    weechat_printf_lines_end (ptr_buffer);
                 ptr_batch->messages_processed = 1;
+                if (strcmp (ptr_batch->type, "chathistory") == 0)
+                    irc_chathistory_end (server, ptr_batch->parameters);
                 num_processed++;
             }
         }
@@ -527,6 +645,9 @@ irc_batch_hdata_batch_cb (const void *pointer, void *data,
         WEECHAT_HDATA_VAR(struct t_irc_batch, parameters, STRING, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_batch, start_time, TIME, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_batch, messages, POINTER, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_batch, msgs, POINTER, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_batch, num_msgs, INTEGER, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_batch, size_msgs, INTEGER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_batch, end_received, INTEGER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_batch, messages_processed, INTEGER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_batch, prev_batch, POINTER, 0, NULL, hdata_name);
@@ -561,6 +682,9 @@ irc_batch_print_log (struct t_irc_server *server)
         weechat_log_printf ("       message . . . . . . : %p ('%s')",
                             ptr_batch->messages,
                             (ptr_batch->messages) ? *(ptr_batch->messages) : NULL);
+        weechat_log_printf ("       msgs. . . . . . . . : %p", ptr_batch->msgs);
+        weechat_log_printf ("       num_msgs. . . . . . : %d", ptr_batch->num_msgs);
+        weechat_log_printf ("       size_msgs . . . . . : %d", ptr_batch->size_msgs);
         weechat_log_printf ("       end_received. . . . : %d", ptr_batch->end_received);
         weechat_log_printf ("       messages_processed. : %d", ptr_batch->messages_processed);
         weechat_log_printf ("       prev_batch. . . . . : %p", ptr_batch->prev_batch);
@@ -25,6 +25,16 @@
 struct t_hashtable;
 struct t_irc_server;
 
+/* message stored in a batch (span in string "messages" of batch) */
+
+struct t_irc_batch_msg
+{
+    int offset;                         /* offset of message in "messages"  */
+    int length;                         /* length of message                */
+    char *command;                      /* IRC command (NULL if unknown)    */
+    char *channel;                      /* channel (NULL if none)           */
+};
+
 struct t_irc_batch
 {
     char *reference;                    /* batch reference                  */
@@ -35,6 +45,9 @@ struct t_irc_batch
     time_t start_time;                  /* start time (to auto-purge if     */
                                         /* batch end is not received)       */
     char **messages;                    /* messages separated by '\n'       */
+    struct t_irc_batch_msg *msgs;       /* messages (spans in "messages")   */
+    int num_msgs;                       /* number of messages               */
+    int size_msgs;                      /* allocated size of "msgs"         */
     int end_received;                   /* batch end reference received     */
     int messages_processed;             /* 1 if msgs have been processed    */
     struct t_irc_batch *prev_batch;     /* link to previous batch           */
@@ -52,7 +65,9 @@ extern struct t_irc_batch *irc_batch_start_batch (struct t_irc_server *server,
                                                   struct t_hashtable *tags);
 extern int irc_batch_add_message (struct t_irc_server *server,
                                   const char *reference,
-                                  const char *irc_message);
+                                  const char *irc_message,
+                                  const char *command,
+                                  const char *channel);
 extern void irc_batch_end_batch (struct t_irc_server *server,
                                  const char *reference);
 extern void irc_batch_free (struct t_irc_server *server,
@@ -30,6 +30,7 @@
 #include "irc.h"
 #include "irc-channel.h"
 #include "irc-buffer.h"
+#include "irc-chathistory.h"
 #include "irc-color.h"
 #include "irc-command.h"
 #include "irc-config.h"
@@ -156,24 +157,6 @@ irc_channel_search_buffer (struct t_irc_server *server, int channel_type,
     return NULL;
 }
 
-/*
- * Applies properties to a buffer.
- */
-
-void
-irc_channel_apply_props (void *data,
-                         struct t_hashtable *hashtable,
-                         const void *key,
-                         const void *value)
-{
-    /* make C compiler happy */
-    (void) hashtable;
-
-    weechat_buffer_set ((struct t_gui_buffer *)data,
-                        (const char *)key,
-                        (const char *)value);
-}
-
 /*
  * Creates a buffer for a channel.
  */
@@ -263,7 +246,7 @@ irc_channel_create_buffer (struct t_irc_server *server,
         if (irc_server_strcasecmp (server, ptr_short_name, channel_name) != 0)
             weechat_hashtable_remove (buffer_props, "short_name");
         /* apply properties */
-        weechat_hashtable_map (buffer_props, &irc_channel_apply_props, ptr_buffer);
+        weechat_buffer_set_multiple (ptr_buffer, buffer_props);
     }
     else
     {
@@ -461,6 +444,7 @@ irc_channel_new (struct t_irc_server *server, int channel_type,
         WEECHAT_HASHTABLE_STRING,
         NULL, NULL);
     new_channel->checking_whox = 0;
+    new_channel->join_check_pending = 0;
     new_channel->away_message = NULL;
     new_channel->has_quit_server = 0;
     new_channel->cycle = 0;
@@ -471,6 +455,13 @@ irc_channel_new (struct t_irc_server *server, int channel_type,
     new_channel->nicks_count = 0;
     new_channel->nicks = NULL;
     new_channel->last_nick = NULL;
+    new_channel->nicks_hash = weechat_hashtable_new (
+        32,
+        WEECHAT_HASHTABLE_STRING,
+        WEECHAT_HASHTABLE_POINTER,
+        NULL, NULL);
+    new_channel->nicklist_lazy = 0;
+    new_channel->nicklist_names = 0;
     new_channel->nicks_speaking[0] = NULL;
     new_channel->nicks_speaking[1] = NULL;
     new_channel->nicks_speaking_time = NULL;
@@ -486,6 +477,7 @@ irc_channel_new (struct t_irc_server *server, int channel_type,
     new_channel->join_smart_filtered = NULL;
     new_channel->typing_state = IRC_CHANNEL_TYPING_STATE_OFF;
     new_channel->typing_status_sent = 0;
+    new_channel->chathistory_state = IRC_CHATHISTORY_STATE_NONE;
     new_channel->buffer = ptr_buffer;
     new_channel->buffer_as_string = NULL;
 
@@ -570,6 +562,214 @@ irc_channel_add_nicklist_groups (struct t_irc_server *server,
                                 "weechat.color.nicklist_group", 1);
 }
 
+/*
+ * Checks if nicks of a channel must be removed from the buffer nicklist:
+ * this is done while the channel is joined (before end of names), if it has
+ * at least the number of nicks in option irc.look.nicklist_lazy_min_nicks
+ * and if the buffer is not displayed in a window; then nicks are added in
+ * nicklist only when the buffer is displayed or when the nicklist is
+ * requested (signal "buffer_nicklist_request").
+ */
+
+void
+irc_channel_nicklist_check_lazy (struct t_irc_server *server,
+                                 struct t_irc_channel *channel)
+{
+    int min_nicks;
+
+    if (!channel || channel->nicklist_lazy
+        || (channel->type != IRC_CHANNEL_TYPE_CHANNEL) || !channel->buffer)
+    {
+        return;
+    }
+
+    min_nicks = weechat_config_integer (irc_config_look_nicklist_lazy_min_nicks);
+    if ((min_nicks <= 0) || (channel->nicks_count < min_nicks))
+        return;
+
+    if (weechat_hashtable_has_key (channel->join_msg_received, "366")
+        || weechat_window_search_with_buffer (channel->buffer))
+    {
+        return;
+    }
+
+    /* remove all nicks from nicklist (nicks are kept in the channel) */
+    weechat_nicklist_remove_all (channel->buffer);
+    irc_channel_add_nicklist_groups (server, channel);
+    channel->nicklist_lazy = 1;
+}
+
+/*
+ * Starts the receiving of nicks in names (353) while the channel is joined:
+ * nicks are added in the channel but not in the buffer nicklist, which is
+ * filled at once at the end of names (see function
+ * irc_channel_nicklist_names_end).
+ */
+
+void
+irc_channel_nicklist_names_start (struct t_irc_server *server,
+                                  struct t_irc_channel *channel)
+{
+    if (!channel || channel->nicklist_lazy || channel->nicklist_names
+        || !channel->buffer
+        || weechat_hashtable_has_key (channel->join_msg_received, "366"))
+    {
+        return;
+    }
+
+    /* remove all nicks from nicklist (nicks are kept in the channel) */
+    weechat_nicklist_remove_all (channel->buffer);
+    irc_channel_add_nicklist_groups (server, channel);
+    channel->nicklist_lazy = 1;
+    channel->nicklist_names = 1;
+}
+
+/*
+ * Ends the receiving of nicks in names (end of names: 366): nicks are added
+ * in the buffer nicklist, unless the nicklist remains lazy (see function
+ * irc_channel_nicklist_check_lazy).
+ */
+
+void
+irc_channel_nicklist_names_end (struct t_irc_server *server,
+                                struct t_irc_channel *channel)
+{
+    if (!channel || !channel->nicklist_names)
+        return;
+
+    channel->nicklist_names = 0;
+
+    /* nicklist already filled (buffer displayed during names)? */
+    if (!channel->nicklist_lazy)
+        return;
+
+    channel->nicklist_lazy = 0;
+    irc_channel_nicklist_check_lazy (server, channel);
+    if (!channel->nicklist_lazy)
+    {
+        channel->nicklist_lazy = 1;
+        irc_channel_nicklist_fill (server, channel);
+    }
+}
+
+/*
+ * Compares two nicks by name (used to sort nicks with qsort).
+ */
+
+int
+irc_channel_nicklist_fill_cmp_cb (const void *nick1, const void *nick2)
+{
+    return weechat_strcasecmp ((*((struct t_irc_nick **)nick1))->name,
+                               (*((struct t_irc_nick **)nick2))->name);
+}
+
+/*
+ * Adds all nicks of a channel in the buffer nicklist, if they were not added
+ * (see function irc_channel_nicklist_check_lazy).
+ *
+ * Nicks are added sorted by name, so that each nick is added at the end of
+ * its nicklist group.
+ */
+
+void
+irc_channel_nicklist_fill (struct t_irc_server *server,
+                           struct t_irc_channel *channel)
+{
+    struct t_irc_nick *ptr_nick, **nicks;
+    int i, count;
+
+    if (!channel || !channel->nicklist_lazy)
+        return;
+
+    channel->nicklist_lazy = 0;
+
+    nicks = (channel->nicks_count > 0) ?
+        malloc (channel->nicks_count * sizeof (*nicks)) : NULL;
+    if (!nicks)
+    {
+        for (ptr_nick = channel->nicks; ptr_nick;
+             ptr_nick = ptr_nick->next_nick)
+        {
+            irc_nick_nicklist_add (server, channel, ptr_nick);
+        }
+        return;
+    }
+
+    count = 0;
+    for (ptr_nick = channel->nicks; ptr_nick && (count < channel->nicks_count);
+         ptr_nick = ptr_nick->next_nick)
+    {
+        nicks[count++] = ptr_nick;
+    }
+    qsort (nicks, count, sizeof (*nicks), &irc_channel_nicklist_fill_cmp_cb);
+    for (i = 0; i < count; i++)
+    {
+        irc_nick_nicklist_add (server, channel, nicks[i]);
+    }
+    free (nicks);
+}
+
+/*
+ * Adds all nicks in the buffer nicklist of all channels which have the
+ * nicklist not filled, if they have less than the number of nicks in option
+ * irc.look.nicklist_lazy_min_nicks (or if the option is 0).
+ */
+
+void
+irc_channel_nicklist_fill_all ()
+{
+    struct t_irc_server *ptr_server;
+    struct t_irc_channel *ptr_channel;
+    int min_nicks;
+
+    min_nicks = weechat_config_integer (irc_config_look_nicklist_lazy_min_nicks);
+
+    for (ptr_server = irc_servers; ptr_server;
+         ptr_server = ptr_server->next_server)
+    {
+        for (ptr_channel = ptr_server->channels; ptr_channel;
+             ptr_channel = ptr_channel->next_channel)
+        {
+            if (ptr_channel->nicklist_lazy
+                && ((min_nicks <= 0) || (ptr_channel->nicks_count < min_nicks)))
+            {
+                irc_channel_nicklist_fill (ptr_server, ptr_channel);
+            }
+        }
+    }
+}
+
+/*
+ * Callback for signals "buffer_switch" and "buffer_nicklist_request": fills
+ * the nicklist of the channel buffer if it was not filled yet.
+ */
+
+int
+irc_channel_nicklist_signal_cb (const void *pointer, void *data,
+                                const char *signal,
+                                const char *type_data,
+                                void *signal_data)
+{
+    struct t_irc_server *ptr_server;
+    struct t_irc_channel *ptr_channel;
+
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) signal;
+    (void) type_data;
+
+    if (!signal_data)
+        return WEECHAT_RC_OK;
+
+    irc_buffer_get_server_and_channel ((struct t_gui_buffer *)signal_data,
+                                       &ptr_server, &ptr_channel);
+    if (ptr_channel && ptr_channel->nicklist_lazy)
+        irc_channel_nicklist_fill (ptr_server, ptr_channel);
+
+    return WEECHAT_RC_OK;
+}
+
 /*
  * Sets modes on channel buffer.
  */
@@ -858,8 +1058,7 @@ irc_channel_remove_account (struct t_irc_server *server,
         for (ptr_nick = channel->nicks; ptr_nick;
              ptr_nick = ptr_nick->next_nick)
         {
-            free (ptr_nick->account);
-            ptr_nick->account = NULL;
+            irc_nick_set_account (ptr_nick, NULL);
         }
     }
 }
@@ -1649,6 +1848,7 @@ irc_channel_free (struct t_irc_server *server, struct t_irc_channel *channel)
     /* free linked lists */
     irc_nick_free_all (server, channel);
     irc_modelist_free_all (channel);
+    weechat_hashtable_free (channel->nicks_hash);
 
     /* free channel data */
     free (channel->name);
@@ -1709,6 +1909,7 @@ irc_channel_hdata_channel_cb (const void *pointer, void *data,
         WEECHAT_HDATA_VAR(struct t_irc_channel, key, STRING, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_channel, join_msg_received, HASHTABLE, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_channel, checking_whox, INTEGER, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_channel, join_check_pending, INTEGER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_channel, away_message, STRING, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_channel, has_quit_server, INTEGER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_channel, cycle, INTEGER, 0, NULL, NULL);
@@ -1719,6 +1920,8 @@ irc_channel_hdata_channel_cb (const void *pointer, void *data,
         WEECHAT_HDATA_VAR(struct t_irc_channel, nicks_count, INTEGER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_channel, nicks, POINTER, 0, NULL, "irc_nick");
         WEECHAT_HDATA_VAR(struct t_irc_channel, last_nick, POINTER, 0, NULL, "irc_nick");
+        WEECHAT_HDATA_VAR(struct t_irc_channel, nicks_hash, HASHTABLE, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_channel, nicklist_lazy, INTEGER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_channel, nicks_speaking, POINTER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_channel, nicks_speaking_time, POINTER, 0, NULL, "irc_channel_speaking");
         WEECHAT_HDATA_VAR(struct t_irc_channel, last_nick_speaking_time, POINTER, 0, NULL, "irc_channel_speaking");
@@ -1727,6 +1930,7 @@ irc_channel_hdata_channel_cb (const void *pointer, void *data,
         WEECHAT_HDATA_VAR(struct t_irc_channel, join_smart_filtered, HASHTABLE, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_channel, typing_state, INTEGER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_channel, typing_status_sent, TIME, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_channel, chathistory_state, INTEGER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_channel, buffer, POINTER, 0, NULL, "buffer");
         WEECHAT_HDATA_VAR(struct t_irc_channel, buffer_as_string, STRING, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_channel, prev_channel, POINTER, 0, NULL, hdata_name);
@@ -1827,6 +2031,8 @@ irc_channel_add_to_infolist (struct t_infolist *infolist,
         return 0;
     if (!weechat_infolist_new_var_integer (ptr_item, "nicks_count", channel->nicks_count))
         return 0;
+    if (!weechat_infolist_new_var_integer (ptr_item, "nicklist_lazy", channel->nicklist_lazy))
+        return 0;
     for (i = 0; i < 2; i++)
     {
         if (channel->nicks_speaking[i])
@@ -1897,6 +2103,7 @@ irc_channel_print_log (struct t_irc_channel *channel)
                         weechat_hashtable_get_string (channel->join_msg_received,
                                                       "keys_values"));
     weechat_log_printf ("       checking_whox. . . . . . : %d", channel->checking_whox);
+    weechat_log_printf ("       join_check_pending . . . : %d", channel->join_check_pending);
     weechat_log_printf ("       away_message . . . . . . : '%s'", channel->away_message);
     weechat_log_printf ("       has_quit_server. . . . . : %d", channel->has_quit_server);
     weechat_log_printf ("       cycle. . . . . . . . . . : %d", channel->cycle);
@@ -1907,6 +2114,9 @@ irc_channel_print_log (struct t_irc_channel *channel)
     weechat_log_printf ("       nicks_count. . . . . . . : %d", channel->nicks_count);
     weechat_log_printf ("       nicks. . . . . . . . . . : %p", channel->nicks);
     weechat_log_printf ("       last_nick. . . . . . . . : %p", channel->last_nick);
+    weechat_log_printf ("       nicks_hash . . . . . . . : %p", channel->nicks_hash);
+    weechat_log_printf ("       nicklist_lazy. . . . . . : %d", channel->nicklist_lazy);
+    weechat_log_printf ("       nicklist_names . . . . . : %d", channel->nicklist_names);
     weechat_log_printf ("       nicks_speaking[0]. . . . : %p", channel->nicks_speaking[0]);
     weechat_log_printf ("       nicks_speaking[1]. . . . : %p", channel->nicks_speaking[1]);
     weechat_log_printf ("       nicks_speaking_time. . . : %p", channel->nicks_speaking_time);
@@ -1919,6 +2129,7 @@ irc_channel_print_log (struct t_irc_channel *channel)
                                                       "keys_values"));
     weechat_log_printf ("       typing_state . . . . . . : %d", channel->typing_state);
     weechat_log_printf ("       typing_status_sent . . . : %lld", (long long)channel->typing_status_sent);
+    weechat_log_printf ("       chathistory_state. . . . : %d", channel->chathistory_state);
     weechat_log_printf ("       buffer . . . . . . . . . : %p", channel->buffer);
     weechat_log_printf ("       buffer_as_string . . . . : '%s'", channel->buffer_as_string);
     weechat_log_printf ("       prev_channel . . . . . . : %p", channel->prev_channel);
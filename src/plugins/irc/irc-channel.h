@@ -62,6 +62,7 @@ struct t_irc_channel
                                        /* 353=names, 366=names count,       */
                                        /* 332/333=topic, 329=creation date  */
     int checking_whox;                 /* = 1 if checking WHOX              */
+    int join_check_pending;            /* MODE/WHO delayed (join burst)     */
     char *away_message;                /* to display away only once in pv   */
     int has_quit_server;               /* =1 if nick has quit (pv only), to */
                                        /* display message when he's back    */
@@ -74,6 +75,13 @@ struct t_irc_channel
     int nicks_count;                   /* # nicks on channel (0 if pv)      */
     struct t_irc_nick *nicks;          /* nicks on the channel              */
     struct t_irc_nick *last_nick;      /* last nick on the channel          */
+    struct t_hashtable *nicks_hash;    /* nicks by name (lower case with    */
+                                       /* server casemapping)               */
+    int nicklist_lazy;                 /* 1 if nicks are not in nicklist    */
+                                       /* (filled when buffer is displayed) */
+    int nicklist_names;                /* 1 if nicks received in names      */
+                                       /* (353) are added in nicklist at    */
+                                       /* end of names (366)                */
     struct t_weelist *nicks_speaking[2]; /* for smart completion: first     */
                                        /* list is nick speaking, second is  */
                                        /* speaking to me (highlight)        */
@@ -85,6 +93,7 @@ struct t_irc_channel
     struct t_hashtable *join_smart_filtered; /* smart filtered joins        */
     int typing_state;                  /* typing state                      */
     time_t typing_status_sent;         /* last time typing status was sent  */
+    int chathistory_state;             /* state of history fetch            */
     struct t_gui_buffer *buffer;       /* buffer allocated for channel      */
     char *buffer_as_string;            /* used to return buffer info        */
     struct t_irc_channel *prev_channel; /* link to previous channel         */
@@ -116,6 +125,19 @@ extern void irc_channel_pv_rename (struct t_irc_server *server,
                                    const char *new_name);
 extern void irc_channel_add_nicklist_groups (struct t_irc_server *server,
                                              struct t_irc_channel *channel);
+extern void irc_channel_nicklist_check_lazy (struct t_irc_server *server,
+                                             struct t_irc_channel *channel);
+extern void irc_channel_nicklist_names_start (struct t_irc_server *server,
+                                             struct t_irc_channel *channel);
+extern void irc_channel_nicklist_names_end (struct t_irc_server *server,
+                                           struct t_irc_channel *channel);
+extern void irc_channel_nicklist_fill (struct t_irc_server *server,
+                                       struct t_irc_channel *channel);
+extern void irc_channel_nicklist_fill_all ();
+extern int irc_channel_nicklist_signal_cb (const void *pointer, void *data,
+                                           const char *signal,
+                                           const char *type_data,
+                                           void *signal_data);
 extern void irc_channel_set_buffer_modes (struct t_irc_server *server,
                                           struct t_irc_channel *channel);
 extern void irc_channel_set_buffer_input_prompt (struct t_irc_server *server,
@@ -0,0 +1,202 @@
+/*
+ * irc-chathistory.c - fetch of channel history (capability draft/chathistory)
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../weechat-plugin.h"
+#include "irc.h"
+#include "irc-chathistory.h"
+#include "irc-channel.h"
+#include "irc-server.h"
+
+
+/*
+ * Checks if history of channels can be fetched on a server: capabilities
+ * "batch" and "draft/chathistory" must be enabled.
+ *
+ * Returns:
+ *   1: history can be fetched
+ *   0: history can not be fetched
+ */
+
+int
+irc_chathistory_enabled (struct t_irc_server *server)
+{
+    if (!server)
+        return 0;
+
+    return (weechat_hashtable_has_key (server->cap_list, "batch")
+            && weechat_hashtable_has_key (server->cap_list,
+                                          "draft/chathistory")) ? 1 : 0;
+}
+
+/*
+ * Schedules the fetch of history when a channel has been joined (history is
+ * fetched only once by channel).
+ */
+
+void
+irc_chathistory_channel_joined (struct t_irc_server *server,
+                                struct t_irc_channel *channel)
+{
+    if (!server || !channel
+        || (channel->chathistory_state != IRC_CHATHISTORY_STATE_NONE)
+        || !irc_chathistory_enabled (server))
+    {
+        return;
+    }
+
+    channel->chathistory_state = IRC_CHATHISTORY_STATE_PENDING;
+
+    irc_chathistory_send_requests (server);
+}
+
+/*
+ * Returns priority of a channel for the fetch of history:
+ *   2: buffer is displayed in a window
+ *   1: buffer is in hotlist
+ *   0: other buffer
+ */
+
+int
+irc_chathistory_channel_priority (struct t_irc_channel *channel)
+{
+    if (!channel || !channel->buffer)
+        return 0;
+
+    if (weechat_buffer_get_integer (channel->buffer, "num_displayed") > 0)
+        return 2;
+
+    if (weechat_hdata_pointer (weechat_hdata_get ("buffer"),
+                               channel->buffer, "hotlist"))
+        return 1;
+
+    return 0;
+}
+
+/*
+ * Sends CHATHISTORY requests for channels waiting for history, by priority
+ * (displayed buffers first, then buffers in hotlist), without exceeding
+ * IRC_CHATHISTORY_MAX_REQUESTS requests not answered.
+ */
+
+void
+irc_chathistory_send_requests (struct t_irc_server *server)
+{
+    struct t_irc_channel *ptr_channel, *ptr_best_channel;
+    const char *ptr_max;
+    char *error;
+    int limit, priority, best_priority;
+    long number;
+
+    if (!server || !server->is_connected || !irc_chathistory_enabled (server))
+        return;
+
+    limit = IRC_CHATHISTORY_LIMIT;
+    ptr_max = irc_server_get_isupport_value (server, "CHATHISTORY");
+    if (ptr_max && ptr_max[0])
+    {
+        error = NULL;
+        number = strtol (ptr_max, &error, 10);
+        if (error && !error[0] && (number > 0) && (number < limit))
+            limit = (int)number;
+    }
+
+    while (server->chathistory_requests < IRC_CHATHISTORY_MAX_REQUESTS)
+    {
+        ptr_best_channel = NULL;
+        best_priority = -1;
+        for (ptr_channel = server->channels; ptr_channel;
+             ptr_channel = ptr_channel->next_channel)
+        {
+            if (ptr_channel->chathistory_state != IRC_CHATHISTORY_STATE_PENDING)
+                continue;
+            priority = irc_chathistory_channel_priority (ptr_channel);
+            if (priority > best_priority)
+            {
+                ptr_best_channel = ptr_channel;
+                best_priority = priority;
+                if (priority >= 2)
+                    break;
+            }
+        }
+        if (!ptr_best_channel)
+            break;
+
+        irc_server_sendf (server, IRC_SERVER_SEND_OUTQ_PRIO_LOW, NULL,
+                          "CHATHISTORY LATEST %s * %d",
+                          ptr_best_channel->name, limit);
+        ptr_best_channel->chathistory_state = IRC_CHATHISTORY_STATE_REQUESTED;
+        server->chathistory_requests++;
+    }
+}
+
+/*
+ * Ends the fetch of history for a target (when the batch "chathistory" is
+ * received or if the server replied with an error), then sends next
+ * requests.
+ */
+
+void
+irc_chathistory_end (struct t_irc_server *server, const char *target)
+{
+    struct t_irc_channel *ptr_channel;
+
+    if (!server || !target)
+        return;
+
+    ptr_channel = irc_channel_search (server, target);
+    if (!ptr_channel
+        || (ptr_channel->chathistory_state != IRC_CHATHISTORY_STATE_REQUESTED))
+    {
+        return;
+    }
+
+    ptr_channel->chathistory_state = IRC_CHATHISTORY_STATE_DONE;
+    if (server->chathistory_requests > 0)
+        server->chathistory_requests--;
+
+    irc_chathistory_send_requests (server);
+}
+
+/*
+ * Resets fetch of history on a server (on disconnection): channels not
+ * received yet will be fetched again after join.
+ */
+
+void
+irc_chathistory_reset (struct t_irc_server *server)
+{
+    struct t_irc_channel *ptr_channel;
+
+    if (!server)
+        return;
+
+    for (ptr_channel = server->channels; ptr_channel;
+         ptr_channel = ptr_channel->next_channel)
+    {
+        if (ptr_channel->chathistory_state != IRC_CHATHISTORY_STATE_DONE)
+            ptr_channel->chathistory_state = IRC_CHATHISTORY_STATE_NONE;
+    }
+    server->chathistory_requests = 0;
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WEECHAT_PLUGIN_IRC_CHATHISTORY_H
+#define WEECHAT_PLUGIN_IRC_CHATHISTORY_H
+
+/* max number of CHATHISTORY requests sent and not answered, by server */
+#define IRC_CHATHISTORY_MAX_REQUESTS 4
+
+/* max number of messages asked by request (if not limited by server) */
+#define IRC_CHATHISTORY_LIMIT 100
+
+struct t_irc_server;
+struct t_irc_channel;
+
+enum t_irc_chathistory_state
+{
+    IRC_CHATHISTORY_STATE_NONE = 0,    /* history not asked                 */
+    IRC_CHATHISTORY_STATE_PENDING,     /* waiting to send the request       */
+    IRC_CHATHISTORY_STATE_REQUESTED,   /* request sent, waiting for batch   */
+    IRC_CHATHISTORY_STATE_DONE,        /* history received                  */
+    /* number of chathistory states */
+    IRC_CHATHISTORY_NUM_STATES,
+};
+
+extern int irc_chathistory_enabled (struct t_irc_server *server);
+extern void irc_chathistory_channel_joined (struct t_irc_server *server,
+                                            struct t_irc_channel *channel);
+extern int irc_chathistory_channel_priority (struct t_irc_channel *channel);
+extern void irc_chathistory_send_requests (struct t_irc_server *server);
+extern void irc_chathistory_end (struct t_irc_server *server,
+                                 const char *target);
+extern void irc_chathistory_reset (struct t_irc_server *server);
+
+#endif /* WEECHAT_PLUGIN_IRC_CHATHISTORY_H */
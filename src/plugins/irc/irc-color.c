@@ -208,8 +208,8 @@ char *
 irc_color_decode (const char *string, int keep_colors)
 {
     char **out, *error;
-    char str_fg[16], str_bg[16], str_color[128], str_key[128], str_to_add[128];
-    const char *remapped_color;
+    char str_fg[16], str_bg[16], str_color[128], str_key[128];
+    const char *remapped_color, *pos_code;
     unsigned char *ptr_string;
     int length, fg, bg, fg_term, bg_term, bold, reverse, italic, underline;
     long fg_rgb, bg_rgb;
@@ -217,6 +217,11 @@ irc_color_decode (const char *string, int keep_colors)
     if (!string)
         return NULL;
 
+    /* fast exit if there is no color/style code at all (most messages) */
+    pos_code = strpbrk (string, IRC_COLOR_CODES_STR);
+    if (!pos_code)
+        return strdup (string);
+
     length = strlen (string);
     out = weechat_string_dyn_alloc (length + (length / 2) + 1);
     if (!out)
@@ -231,14 +236,25 @@ irc_color_decode (const char *string, int keep_colors)
     ptr_string = (unsigned char *)string;
     while (ptr_string && ptr_string[0])
     {
-        str_to_add[0] = '\0';
+        /* copy all chars until next color/style code */
+        if (!pos_code)
+        {
+            weechat_string_dyn_concat (out, (const char *)ptr_string, -1);
+            break;
+        }
+        if ((const char *)ptr_string < pos_code)
+        {
+            weechat_string_dyn_concat (out, (const char *)ptr_string,
+                                       pos_code - (const char *)ptr_string);
+            ptr_string = (unsigned char *)pos_code;
+        }
         switch (ptr_string[0])
         {
             case IRC_COLOR_BOLD_CHAR:
                 if (keep_colors)
                 {
-                    snprintf (str_to_add, sizeof (str_to_add), "%s",
-                              weechat_color ((bold) ? "-bold" : "bold"));
+                    weechat_string_dyn_concat (
+                        out, weechat_color ((bold) ? "-bold" : "bold"), -1);
                 }
                 bold ^= 1;
                 ptr_string++;
@@ -246,8 +262,8 @@ irc_color_decode (const char *string, int keep_colors)
             case IRC_COLOR_RESET_CHAR:
                 if (keep_colors)
                 {
-                    snprintf (str_to_add, sizeof (str_to_add), "%s",
-                              weechat_color ("reset"));
+                    weechat_string_dyn_concat (
+                        out, weechat_color ("reset"), -1);
                 }
                 bold = 0;
                 reverse = 0;
@@ -258,8 +274,8 @@ irc_color_decode (const char *string, int keep_colors)
             case IRC_COLOR_REVERSE_CHAR:
                 if (keep_colors)
                 {
-                    snprintf (str_to_add, sizeof (str_to_add), "%s",
-                              weechat_color ((reverse) ? "-reverse" : "reverse"));
+                    weechat_string_dyn_concat (
+                        out, weechat_color ((reverse) ? "-reverse" : "reverse"), -1);
                 }
                 reverse ^= 1;
                 ptr_string++;
@@ -267,8 +283,8 @@ irc_color_decode (const char *string, int keep_colors)
             case IRC_COLOR_ITALIC_CHAR:
                 if (keep_colors)
                 {
-                    snprintf (str_to_add, sizeof (str_to_add), "%s",
-                              weechat_color ((italic) ? "-italic" : "italic"));
+                    weechat_string_dyn_concat (
+                        out, weechat_color ((italic) ? "-italic" : "italic"), -1);
                 }
                 italic ^= 1;
                 ptr_string++;
@@ -276,8 +292,8 @@ irc_color_decode (const char *string, int keep_colors)
             case IRC_COLOR_UNDERLINE_CHAR:
                 if (keep_colors)
                 {
-                    snprintf (str_to_add, sizeof (str_to_add), "%s",
-                              weechat_color ((underline) ? "-underline" : "underline"));
+                    weechat_string_dyn_concat (
+                        out, weechat_color ((underline) ? "-underline" : "underline"), -1);
                 }
                 underline ^= 1;
                 ptr_string++;
@@ -355,13 +371,13 @@ irc_color_decode (const char *string, int keep_colors)
                                       (bg >= 0) ? "," : "",
                                       (bg >= 0) ? irc_color_to_weechat[bg] : "");
                         }
-                        snprintf (str_to_add, sizeof (str_to_add), "%s",
-                                  weechat_color (str_color));
+                        weechat_string_dyn_concat (
+                            out, weechat_color (str_color), -1);
                     }
                     else
                     {
-                        snprintf (str_to_add, sizeof (str_to_add), "%s",
-                                  weechat_color ("resetcolor"));
+                        weechat_string_dyn_concat (
+                            out, weechat_color ("resetcolor"), -1);
                     }
                 }
                 break;
@@ -453,32 +469,18 @@ irc_color_decode (const char *string, int keep_colors)
                                       (str_bg[0]) ? "," : "",
                                       str_bg);
                         }
-                        snprintf (str_to_add, sizeof (str_to_add), "%s",
-                                  weechat_color (str_color));
+                        weechat_string_dyn_concat (
+                            out, weechat_color (str_color), -1);
                     }
                     else
                     {
-                        snprintf (str_to_add, sizeof (str_to_add), "%s",
-                                  weechat_color ("resetcolor"));
+                        weechat_string_dyn_concat (
+                            out, weechat_color ("resetcolor"), -1);
                     }
                 }
                 break;
-            default:
-                /*
-                 * we are not on an IRC color code, just copy the UTF-8 char
-                 * into "str_to_add"
-                 */
-                length = weechat_utf8_char_size ((char *)ptr_string);
-                if (length == 0)
-                    length = 1;
-                memcpy (str_to_add, ptr_string, length);
-                str_to_add[length] = '\0';
-                ptr_string += length;
-                break;
         }
-        /* add "str_to_add" (if not empty) to "out" */
-        if (str_to_add[0])
-            weechat_string_dyn_concat (out, str_to_add, -1);
+        pos_code = strpbrk ((const char *)ptr_string, IRC_COLOR_CODES_STR);
     }
 
     return weechat_string_dyn_free (out, 0);
@@ -1062,7 +1064,7 @@ irc_color_end ()
 {
     if (irc_color_regex_ansi)
     {
-        regfree (irc_color_regex_ansi);
+        weechat_string_regfree (irc_color_regex_ansi);
         free (irc_color_regex_ansi);
         irc_color_regex_ansi = NULL;
     }
@@ -59,6 +59,11 @@
 #define IRC_COLOR_UNDERLINE_CHAR '\x1F'  /* underlined text                 */
 #define IRC_COLOR_UNDERLINE_STR  "\x1F"  /*   [1F]...[1F]                   */
 
+/* all chars above (any of them in a message starts a color/style code) */
+#define IRC_COLOR_CODES_STR IRC_COLOR_BOLD_STR IRC_COLOR_COLOR_STR      \
+    IRC_COLOR_HEX_COLOR_STR IRC_COLOR_RESET_STR IRC_COLOR_REVERSE_STR   \
+    IRC_COLOR_ITALIC_STR IRC_COLOR_UNDERLINE_STR
+
 #define IRC_COLOR_TERM2IRC_NUM_COLORS 16
 
 /* macros for WeeChat core and IRC colors */
@@ -620,8 +620,99 @@ IRC_COMMAND_CALLBACK(admin)
     return WEECHAT_RC_OK;
 }
 
+/*
+ * Compiles a list of masks separated by commas (each mask can contain
+ * wildcards "*"), so that they can be matched quickly with many strings.
+ *
+ * Returns an array of compiled masks, NULL if the list is empty or on error.
+ *
+ * Note: result must be freed after use with function irc_command_masks_free.
+ */
+
+struct t_string_mask **
+irc_command_masks_compile (const char *str_masks, int case_sensitive,
+                           int *num_masks)
+{
+    struct t_string_mask **masks;
+    char **items;
+    int i, num_items;
+
+    *num_masks = 0;
+
+    if (!str_masks || !str_masks[0])
+        return NULL;
+
+    items = weechat_string_split (str_masks, ",", NULL,
+                                  WEECHAT_STRING_SPLIT_STRIP_LEFT
+                                  | WEECHAT_STRING_SPLIT_STRIP_RIGHT
+                                  | WEECHAT_STRING_SPLIT_COLLAPSE_SEPS,
+                                  0, &num_items);
+    if (!items)
+        return NULL;
+
+    masks = (num_items > 0) ? malloc (num_items * sizeof (*masks)) : NULL;
+    if (masks)
+    {
+        for (i = 0; i < num_items; i++)
+        {
+            masks[i] = weechat_string_mask_compile (items[i], case_sensitive);
+        }
+        *num_masks = num_items;
+    }
+
+    weechat_string_free_split (items);
+
+    return masks;
+}
+
+/*
+ * Checks if a string matches one of the compiled masks.
+ *
+ * Returns:
+ *   1: string matches one of the masks
+ *   0: string does not match any mask
+ */
+
+int
+irc_command_masks_match (const char *string, struct t_string_mask **masks,
+                         int num_masks)
+{
+    int i;
+
+    for (i = 0; i < num_masks; i++)
+    {
+        if (masks[i] && weechat_string_match_compiled (string, masks[i]))
+            return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * Frees compiled masks.
+ */
+
+void
+irc_command_masks_free (struct t_string_mask **masks, int num_masks)
+{
+    int i;
+
+    if (!masks)
+        return;
+
+    for (i = 0; i < num_masks; i++)
+    {
+        weechat_string_mask_free (masks[i]);
+    }
+    free (masks);
+}
+
 /*
  * Executes a command on a list of IRC buffers.
+ *
+ * The command is scanned only once: special variables ($server, $channel,
+ * $nick) are replaced only if there is a "$" in command, and the command is
+ * evaluated only if it contains "${".
  */
 
 void
@@ -632,9 +723,9 @@ irc_command_exec_buffers (struct t_weelist *list_buffers,
     struct t_irc_channel *ptr_channel;
     struct t_gui_buffer *ptr_buffer;
     struct t_hashtable *pointers;
-    const char *ptr_buffer_name;
+    const char *ptr_buffer_name, *ptr_command;
     char *cmd_vars_replaced, *cmd_eval;
-    int i, list_size;
+    int i, list_size, replace_vars;
 
     list_size = weechat_list_size (list_buffers);
     if (list_size < 1)
@@ -648,6 +739,8 @@ irc_command_exec_buffers (struct t_weelist *list_buffers,
     if (!pointers)
         return;
 
+    replace_vars = (strchr (command, '$')) ? 1 : 0;
+
     for (i = 0; i < list_size; i++)
     {
         ptr_buffer_name = weechat_list_string (
@@ -659,24 +752,27 @@ irc_command_exec_buffers (struct t_weelist *list_buffers,
                                            &ptr_server, &ptr_channel);
         if (!ptr_server)
             continue;
-        weechat_hashtable_set (pointers, "buffer", ptr_buffer);
-        weechat_hashtable_set (pointers, "irc_server", ptr_server);
-        if (ptr_channel)
-            weechat_hashtable_set (pointers, "irc_channel", ptr_channel);
-        else
-            weechat_hashtable_remove (pointers, "irc_channel");
-        cmd_vars_replaced = irc_message_replace_vars (
-            ptr_server,
-            (ptr_channel) ? ptr_channel->name : NULL,
-            command);
-        cmd_eval = weechat_string_eval_expression (
-            (cmd_vars_replaced) ? cmd_vars_replaced : command,
-            pointers,
-            NULL,
-            NULL);
+        cmd_vars_replaced = (replace_vars) ?
+            irc_message_replace_vars (
+                ptr_server,
+                (ptr_channel) ? ptr_channel->name : NULL,
+                command) : NULL;
+        ptr_command = (cmd_vars_replaced) ? cmd_vars_replaced : command;
+        cmd_eval = NULL;
+        if (strstr (ptr_command, "${"))
+        {
+            weechat_hashtable_set (pointers, "buffer", ptr_buffer);
+            weechat_hashtable_set (pointers, "irc_server", ptr_server);
+            if (ptr_channel)
+                weechat_hashtable_set (pointers, "irc_channel", ptr_channel);
+            else
+                weechat_hashtable_remove (pointers, "irc_channel");
+            cmd_eval = weechat_string_eval_expression (ptr_command, pointers,
+                                                       NULL, NULL);
+        }
         weechat_command (
             (ptr_channel) ? ptr_channel->buffer : ptr_server->buffer,
-            (cmd_eval) ? cmd_eval : ((cmd_vars_replaced) ? cmd_vars_replaced : command));
+            (cmd_eval) ? cmd_eval : ptr_command);
         free (cmd_vars_replaced);
         free (cmd_eval);
     }
@@ -703,18 +799,13 @@ irc_command_exec_all_channels (struct t_irc_server *server,
     struct t_irc_server *ptr_server, *next_server;
     struct t_irc_channel *ptr_channel, *next_channel;
     struct t_weelist *list_buffers;
-    char **channels;
-    int num_channels, picked, i, parted, state_ok;
+    struct t_string_mask **channels;
+    int num_channels, picked, parted, state_ok;
 
     if (!command || !command[0])
         return;
 
-    channels = (str_channels && str_channels[0]) ?
-        weechat_string_split (str_channels, ",", NULL,
-                              WEECHAT_STRING_SPLIT_STRIP_LEFT
-                              | WEECHAT_STRING_SPLIT_STRIP_RIGHT
-                              | WEECHAT_STRING_SPLIT_COLLAPSE_SEPS,
-                              0, &num_channels) : NULL;
+    channels = irc_command_masks_compile (str_channels, 0, &num_channels);
 
     /* build a list of buffer names where the command will be executed */
     list_buffers = weechat_list_new ();
@@ -743,17 +834,12 @@ irc_command_exec_all_channels (struct t_irc_server *server,
                     {
                         picked = (inclusive) ? 0 : 1;
 
-                        if (channels)
+                        if (channels
+                            && irc_command_masks_match (ptr_channel->name,
+                                                        channels,
+                                                        num_channels))
                         {
-                            for (i = 0; i < num_channels; i++)
-                            {
-                                if (weechat_string_match (ptr_channel->name,
-                                                          channels[i], 0))
-                                {
-                                    picked = (inclusive) ? 1 : 0;
-                                    break;
-                                }
-                            }
+                            picked = (inclusive) ? 1 : 0;
                         }
 
                         if (picked)
@@ -779,7 +865,7 @@ irc_command_exec_all_channels (struct t_irc_server *server,
     irc_command_exec_buffers (list_buffers, command);
 
     weechat_list_free (list_buffers);
-    weechat_string_free_split (channels);
+    irc_command_masks_free (channels, num_channels);
 }
 
 /*
@@ -949,18 +1035,13 @@ irc_command_exec_all_servers (int inclusive, const char *str_servers, const char
 {
     struct t_irc_server *ptr_server, *next_server;
     struct t_weelist *list_buffers;
-    char **servers;
-    int num_servers, picked, i;
+    struct t_string_mask **servers;
+    int num_servers, picked;
 
     if (!command || !command[0])
         return;
 
-    servers = (str_servers && str_servers[0]) ?
-        weechat_string_split (str_servers, ",", NULL,
-                              WEECHAT_STRING_SPLIT_STRIP_LEFT
-                              | WEECHAT_STRING_SPLIT_STRIP_RIGHT
-                              | WEECHAT_STRING_SPLIT_COLLAPSE_SEPS,
-                              0, &num_servers) : NULL;
+    servers = irc_command_masks_compile (str_servers, 1, &num_servers);
 
     /* build a list of buffer names where the command will be executed */
     list_buffers = weechat_list_new ();
@@ -973,17 +1054,11 @@ irc_command_exec_all_servers (int inclusive, const char *str_servers, const char
         {
             picked = (inclusive) ? 0 : 1;
 
-            if (servers)
+            if (servers
+                && irc_command_masks_match (ptr_server->name,
+                                            servers, num_servers))
             {
-                for (i = 0; i < num_servers; i++)
-                {
-                    if (weechat_string_match (ptr_server->name,
-                                              servers[i], 1))
-                    {
-                        picked = (inclusive) ? 1 : 0;
-                        break;
-                    }
-                }
+                picked = (inclusive) ? 1 : 0;
             }
 
             if (picked)
@@ -1004,7 +1079,7 @@ irc_command_exec_all_servers (int inclusive, const char *str_servers, const char
     irc_command_exec_buffers (list_buffers, command);
 
     weechat_list_free (list_buffers);
-    weechat_string_free_split (servers);
+    irc_command_masks_free (servers, num_servers);
 }
 
 /*
@@ -3643,14 +3718,14 @@ IRC_COMMAND_CALLBACK(list)
         }
         if (ptr_server->cmd_list_regexp)
         {
-            regfree (ptr_server->cmd_list_regexp);
+            weechat_string_regfree (ptr_server->cmd_list_regexp);
             free (ptr_server->cmd_list_regexp);
         }
         ptr_server->cmd_list_regexp = new_regexp;
     }
     else if (ptr_server->cmd_list_regexp)
     {
-        regfree (ptr_server->cmd_list_regexp);
+        weechat_string_regfree (ptr_server->cmd_list_regexp);
         free (ptr_server->cmd_list_regexp);
         ptr_server->cmd_list_regexp = NULL;
     }
@@ -5651,6 +5726,22 @@ irc_command_display_server (struct t_irc_server *server, int with_detail)
                             IRC_COLOR_CHAT_VALUE,
                             weechat_config_integer (server->options[IRC_SERVER_OPTION_ANTI_FLOOD]),
                             NG_("second", "seconds", weechat_config_integer (server->options[IRC_SERVER_OPTION_ANTI_FLOOD])));
+        /* anti_flood_burst */
+        if (weechat_config_option_is_null (server->options[IRC_SERVER_OPTION_ANTI_FLOOD_BURST]))
+            weechat_printf (NULL, "  anti_flood_burst . . :   (%d)",
+                            IRC_SERVER_OPTION_INTEGER(server, IRC_SERVER_OPTION_ANTI_FLOOD_BURST));
+        else
+            weechat_printf (NULL, "  anti_flood_burst . . : %s%d",
+                            IRC_COLOR_CHAT_VALUE,
+                            weechat_config_integer (server->options[IRC_SERVER_OPTION_ANTI_FLOOD_BURST]));
+        /* anti_flood_bytes */
+        if (weechat_config_option_is_null (server->options[IRC_SERVER_OPTION_ANTI_FLOOD_BYTES]))
+            weechat_printf (NULL, "  anti_flood_bytes . . :   (%d)",
+                            IRC_SERVER_OPTION_INTEGER(server, IRC_SERVER_OPTION_ANTI_FLOOD_BYTES));
+        else
+            weechat_printf (NULL, "  anti_flood_bytes . . : %s%d",
+                            IRC_COLOR_CHAT_VALUE,
+                            weechat_config_integer (server->options[IRC_SERVER_OPTION_ANTI_FLOOD_BYTES]));
         /* away_check */
         if (weechat_config_option_is_null (server->options[IRC_SERVER_OPTION_AWAY_CHECK]))
             weechat_printf (NULL, "  away_check . . . . . :   (%d %s)",
@@ -6195,8 +6286,11 @@ IRC_COMMAND_CALLBACK(server)
             {
                 strcpy (message, msg_no_quotes);
                 strcat (message, "\r\n");
-                irc_server_msgq_add_buffer (ptr_server, message);
-                irc_server_msgq_flush ();
+                if (irc_server_recv_buffer_add (ptr_server, message,
+                                                length + 2))
+                {
+                    irc_server_recv_buffer_process (ptr_server);
+                }
                 free (message);
             }
         }
@@ -7233,9 +7327,9 @@ irc_command_init ()
             "",
             N_("Capabilities supported by WeeChat are: "
                "account-notify, account-tag, away-notify, batch, cap-notify, "
-               "chghost, draft/multiline, echo-message, extended-join, "
-               "invite-notify, message-tags, multi-prefix, server-time, setname, "
-               "userhost-in-names."),
+               "chghost, draft/chathistory, draft/multiline, echo-message, "
+               "extended-join, invite-notify, message-tags, multi-prefix, "
+               "server-time, setname, userhost-in-names."),
             "",
             N_("The capabilities to automatically enable on servers can be set "
                "in option irc.server_default.capabilities (or by server in "
@@ -59,8 +59,9 @@ struct t_irc_channel;
  */
 #define IRC_COMMAND_CAP_SUPPORTED                                       \
     "account-notify|account-tag|away-notify|batch|cap-notify|chghost|"  \
-    "draft/multiline|echo-message|extended-join|invite-notify|"         \
-    "message-tags|multi-prefix|server-time|setname|userhost-in-names"
+    "draft/chathistory|draft/multiline|echo-message|extended-join|"     \
+    "invite-notify|message-tags|multi-prefix|server-time|setname|"      \
+    "userhost-in-names"
 
 /* list of supported CTCPs (for completion in command /ctcp) */
 #define IRC_COMMAND_CTCP_SUPPORTED_COMPLETION \
@@ -106,6 +106,7 @@ struct t_config_option *irc_config_look_new_pv_position = NULL;
 struct t_config_option *irc_config_look_nick_completion_smart = NULL;
 struct t_config_option *irc_config_look_nick_mode = NULL;
 struct t_config_option *irc_config_look_nick_mode_empty = NULL;
+struct t_config_option *irc_config_look_nicklist_lazy_min_nicks = NULL;
 struct t_config_option *irc_config_look_nicks_hide_password = NULL;
 struct t_config_option *irc_config_look_notice_as_pv = NULL;
 struct t_config_option *irc_config_look_notice_welcome_redirect = NULL;
@@ -172,8 +173,10 @@ struct t_config_option *irc_config_network_lag_max = NULL;
 struct t_config_option *irc_config_network_lag_min_show = NULL;
 struct t_config_option *irc_config_network_lag_reconnect = NULL;
 struct t_config_option *irc_config_network_lag_refresh_interval = NULL;
+struct t_config_option *irc_config_network_max_process_time = NULL;
 struct t_config_option *irc_config_network_notify_check_ison = NULL;
 struct t_config_option *irc_config_network_notify_check_whois = NULL;
+struct t_config_option *irc_config_network_recv_size = NULL;
 struct t_config_option *irc_config_network_sasl_fail_unavailable = NULL;
 struct t_config_option *irc_config_network_send_unknown_commands = NULL;
 struct t_config_option *irc_config_network_whois_double_nick = NULL;
@@ -607,6 +610,23 @@ irc_config_change_look_item_display_server (const void *pointer, void *data,
     weechat_bar_item_update ("buffer_short_name");
 }
 
+/*
+ * Callback for changes on option "irc.look.nicklist_lazy_min_nicks".
+ */
+
+void
+irc_config_change_look_nicklist_lazy_min_nicks (const void *pointer,
+                                                void *data,
+                                                struct t_config_option *option)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) option;
+
+    irc_channel_nicklist_fill_all ();
+}
+
 /*
  * Callback for changes on option "irc.look.nicks_hide_password".
  */
@@ -1101,6 +1121,8 @@ irc_config_server_default_change_cb (const void *pointer, void *data,
                                               weechat_config_string (option));
                         break;
                     case IRC_SERVER_OPTION_ANTI_FLOOD:
+                    case IRC_SERVER_OPTION_ANTI_FLOOD_BURST:
+                    case IRC_SERVER_OPTION_ANTI_FLOOD_BYTES:
                         if (ptr_server->hook_timer_anti_flood)
                         {
                             irc_server_outqueue_timer_remove (ptr_server);
@@ -1396,6 +1418,14 @@ irc_config_server_change_cb (const void *pointer, void *data,
                         IRC_SERVER_OPTION_BOOLEAN(ptr_server,
                                                   IRC_SERVER_OPTION_TLS));
                     break;
+                case IRC_SERVER_OPTION_TLS_CERT:
+                case IRC_SERVER_OPTION_TLS_PASSWORD:
+                case IRC_SERVER_OPTION_TLS_PRIORITIES:
+                case IRC_SERVER_OPTION_TLS_FINGERPRINT:
+                case IRC_SERVER_OPTION_TLS_VERIFY:
+                    /* TLS session must not be resumed with old options */
+                    irc_server_tls_session_free (ptr_server);
+                    break;
                 case IRC_SERVER_OPTION_NICKS:
                     irc_server_set_nicks (
                         ptr_server,
@@ -1403,6 +1433,8 @@ irc_config_server_change_cb (const void *pointer, void *data,
                                                  IRC_SERVER_OPTION_NICKS));
                     break;
                 case IRC_SERVER_OPTION_ANTI_FLOOD:
+                case IRC_SERVER_OPTION_ANTI_FLOOD_BURST:
+                case IRC_SERVER_OPTION_ANTI_FLOOD_BYTES:
                     if (ptr_server->hook_timer_anti_flood)
                     {
                         irc_server_outqueue_timer_remove (ptr_server);
@@ -2528,7 +2560,9 @@ irc_config_server_new_option (struct t_config_file *config_file,
                 config_file, section,
                 option_name, "integer",
                 N_("delay in milliseconds between two messages sent to server "
-                   "(anti-flood protection); 0 = disable protection and always "
+                   "(anti-flood protection), after a burst of messages (see "
+                   "options anti_flood_burst and anti_flood_bytes); "
+                   "0 = disable protection and always "
                    "send messages immediately (not recommended because the "
                    "server can close the connection if you send several "
                    "messages in a short time); "
@@ -2548,6 +2582,44 @@ irc_config_server_new_option (struct t_config_file *config_file,
                 callback_change_data,
                 NULL, NULL, NULL);
             break;
+        case IRC_SERVER_OPTION_ANTI_FLOOD_BURST:
+            new_option = weechat_config_new_option (
+                config_file, section,
+                option_name, "integer",
+                N_("max number of messages sent immediately to server before "
+                   "anti-flood delay is applied (when no messages have been "
+                   "sent recently); one message can be sent again after each "
+                   "delay set in option anti_flood (token bucket)"),
+                NULL, 1, 1000,
+                default_value, value,
+                null_value_allowed,
+                callback_check_value,
+                callback_check_value_pointer,
+                callback_check_value_data,
+                callback_change,
+                callback_change_pointer,
+                callback_change_data,
+                NULL, NULL, NULL);
+            break;
+        case IRC_SERVER_OPTION_ANTI_FLOOD_BYTES:
+            new_option = weechat_config_new_option (
+                config_file, section,
+                option_name, "integer",
+                N_("size of message (in bytes) which counts as one additional "
+                   "message for anti-flood, so that long messages wait longer "
+                   "than short ones (like the penalty of IRC servers, for "
+                   "example 120); 0 = all messages count as one message"),
+                NULL, 0, 65536,
+                default_value, value,
+                null_value_allowed,
+                callback_check_value,
+                callback_check_value_pointer,
+                callback_check_value_data,
+                callback_change,
+                callback_change_pointer,
+                callback_change_data,
+                NULL, NULL, NULL);
+            break;
         case IRC_SERVER_OPTION_AWAY_CHECK:
             new_option = weechat_config_new_option (
                 config_file, section,
@@ -3503,6 +3575,18 @@ irc_config_init ()
             NULL, NULL, NULL,
             &irc_config_change_buffer_input_prompt, NULL, NULL,
             NULL, NULL, NULL);
+        irc_config_look_nicklist_lazy_min_nicks = weechat_config_new_option (
+            irc_config_file, irc_config_section_look,
+            "nicklist_lazy_min_nicks", "integer",
+            N_("minimum number of nicks in a channel to add nicks in the "
+               "nicklist only when the channel buffer is displayed in a "
+               "window or when the nicklist is requested (for example by a "
+               "relay client); this saves CPU and memory with very large "
+               "channels (0 = always add nicks in the nicklist)"),
+            NULL, 0, 1000000, "0", NULL, 0,
+            NULL, NULL, NULL,
+            &irc_config_change_look_nicklist_lazy_min_nicks, NULL, NULL,
+            NULL, NULL, NULL);
         irc_config_look_nicks_hide_password = weechat_config_new_option (
             irc_config_file, irc_config_section_look,
             "nicks_hide_password", "string",
@@ -4014,6 +4098,17 @@ irc_config_init ()
                "increasing (in seconds)"),
             NULL, 1, 3600, "1", NULL, 0,
             NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+        irc_config_network_max_process_time = weechat_config_new_option (
+            irc_config_file, irc_config_section_network,
+            "max_process_time", "integer",
+            N_("max time spent to process messages received from a server "
+               "before giving back control to WeeChat main loop (in "
+               "milliseconds, 0 = no limit); the other messages are "
+               "processed a few milliseconds later, so that WeeChat stays "
+               "responsive when a lot of messages are received (for example "
+               "when a bouncer sends a big backlog)"),
+            NULL, 0, 60 * 1000, "50", NULL, 0,
+            NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
         irc_config_network_notify_check_ison = weechat_config_new_option (
             irc_config_file, irc_config_section_network,
             "notify_check_ison", "integer",
@@ -4032,6 +4127,15 @@ irc_config_init ()
             NULL, NULL, NULL,
             &irc_config_change_network_notify_check_whois, NULL, NULL,
             NULL, NULL, NULL);
+        irc_config_network_recv_size = weechat_config_new_option (
+            irc_config_file, irc_config_section_network,
+            "recv_size", "integer",
+            N_("max size of data read from server socket in a single call "
+               "(in bytes); a bigger value reduces the number of system "
+               "calls when a lot of data is received (for example when "
+               "joining many channels)"),
+            NULL, 1024, 1024 * 1024, "65536", NULL, 0,
+            NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
         irc_config_network_sasl_fail_unavailable = weechat_config_new_option (
             irc_config_file, irc_config_section_network,
             "sasl_fail_unavailable", "boolean",
@@ -141,6 +141,7 @@ extern struct t_config_option *irc_config_look_new_pv_position;
 extern struct t_config_option *irc_config_look_nick_completion_smart;
 extern struct t_config_option *irc_config_look_nick_mode;
 extern struct t_config_option *irc_config_look_nick_mode_empty;
+extern struct t_config_option *irc_config_look_nicklist_lazy_min_nicks;
 extern struct t_config_option *irc_config_look_nicks_hide_password;
 extern struct t_config_option *irc_config_look_notice_as_pv;
 extern struct t_config_option *irc_config_look_notice_welcome_redirect;
@@ -203,8 +204,10 @@ extern struct t_config_option *irc_config_network_lag_max;
 extern struct t_config_option *irc_config_network_lag_min_show;
 extern struct t_config_option *irc_config_network_lag_reconnect;
 extern struct t_config_option *irc_config_network_lag_refresh_interval;
+extern struct t_config_option *irc_config_network_max_process_time;
 extern struct t_config_option *irc_config_network_notify_check_ison;
 extern struct t_config_option *irc_config_network_notify_check_whois;
+extern struct t_config_option *irc_config_network_recv_size;
 extern struct t_config_option *irc_config_network_sasl_fail_unavailable;
 extern struct t_config_option *irc_config_network_send_unknown_commands;
 extern struct t_config_option *irc_config_network_whois_double_nick;
@@ -21,6 +21,7 @@
 
 #include <stdlib.h>
 #include <stddef.h>
+#include <stdio.h>
 #include <string.h>
 
 #include "../weechat-plugin.h"
@@ -33,6 +34,9 @@
 struct t_irc_ignore *irc_ignore_list = NULL; /* list of ignore              */
 struct t_irc_ignore *last_irc_ignore = NULL; /* last ignore in list         */
 
+/* cache of decisions: "server/channel/nick/host" => 1 (ignored) or 0 */
+struct t_hashtable *irc_ignore_cache = NULL;
+
 
 /*
  * Checks if an ignore pointer is valid.
@@ -118,6 +122,54 @@ irc_ignore_search_by_number (int number)
     return NULL;
 }
 
+/*
+ * Returns the nick if the mask is a plain nick: "^nick$" where nick has only
+ * letters, digits, "-" and "_" (so the regex can be replaced by a case
+ * insensitive comparison).
+ *
+ * Returns NULL if the mask is not a plain nick.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+irc_ignore_get_nick (const char *mask)
+{
+    int i, length;
+
+    if (!mask || (mask[0] != '^'))
+        return NULL;
+
+    length = strlen (mask);
+    if ((length < 3) || (mask[length - 1] != '$'))
+        return NULL;
+
+    for (i = 1; i < length - 1; i++)
+    {
+        if (!(((mask[i] >= 'a') && (mask[i] <= 'z'))
+              || ((mask[i] >= 'A') && (mask[i] <= 'Z'))
+              || ((mask[i] >= '0') && (mask[i] <= '9'))
+              || (mask[i] == '-')
+              || (mask[i] == '_')))
+        {
+            return NULL;
+        }
+    }
+
+    return weechat_strndup (mask + 1, length - 2);
+}
+
+/*
+ * Clears the cache of decisions (called when an ignore is added or removed).
+ */
+
+void
+irc_ignore_cache_clear ()
+{
+    if (irc_ignore_cache)
+        weechat_hashtable_remove_all (irc_ignore_cache);
+}
+
 /*
  * Adds a new ignore.
  *
@@ -150,6 +202,7 @@ irc_ignore_new (const char *mask, const char *server, const char *channel)
         new_ignore->number = (last_irc_ignore) ? last_irc_ignore->number + 1 : 1;
         new_ignore->mask = strdup (mask);
         new_ignore->regex_mask = regex;
+        new_ignore->nick = irc_ignore_get_nick (mask);
         new_ignore->server = (server) ? strdup (server) : strdup ("*");
         new_ignore->channel = (channel) ? strdup (channel) : strdup ("*");
 
@@ -163,6 +216,8 @@ irc_ignore_new (const char *mask, const char *server, const char *channel)
         new_ignore->next_ignore = NULL;
     }
 
+    irc_ignore_cache_clear ();
+
     return new_ignore;
 }
 
@@ -223,19 +278,37 @@ irc_ignore_check_host (struct t_irc_ignore *ignore,
 {
     const char *pos;
 
-    if (nick && (regexec (ignore->regex_mask, nick, 0, NULL, 0) == 0))
+    /* plain nick: compare strings instead of running the regex */
+    if (ignore->nick)
+    {
+        if (nick && (weechat_strcasecmp (ignore->nick, nick) == 0))
+            return 1;
+        if (host)
+        {
+            if (weechat_strcasecmp (ignore->nick, host) == 0)
+                return 1;
+            pos = strchr (host, '!');
+            if (pos && (weechat_strcasecmp (ignore->nick, pos + 1) == 0))
+                return 1;
+        }
+        return 0;
+    }
+
+    if (nick && (weechat_string_regexec (ignore->regex_mask, nick,
+                                         0, NULL, 0) == 0))
         return 1;
 
     if (host)
     {
-        if (regexec (ignore->regex_mask, host, 0, NULL, 0) == 0)
+        if (weechat_string_regexec (ignore->regex_mask, host,
+                                    0, NULL, 0) == 0)
             return 1;
 
         if (!strchr (ignore->mask, '!'))
         {
             pos = strchr (host, '!');
-            if (pos && (regexec (ignore->regex_mask, pos + 1,
-                                 0, NULL, 0) == 0))
+            if (pos && (weechat_string_regexec (ignore->regex_mask, pos + 1,
+                                                0, NULL, 0) == 0))
             {
                 return 1;
             }
@@ -258,8 +331,11 @@ irc_ignore_check (struct t_irc_server *server, const char *channel,
                   const char *nick, const char *host)
 {
     struct t_irc_ignore *ptr_ignore;
+    char key[4096], type_channel;
+    const char *ptr_channel;
+    int ignored, *ptr_ignored;
 
-    if (!server)
+    if (!server || !irc_ignore_list)
         return 0;
 
     /*
@@ -272,6 +348,43 @@ irc_ignore_check (struct t_irc_server *server, const char *channel,
         return 0;
     }
 
+    /*
+     * build key for the cache with what is used to check ignores; the
+     * channel is replaced by the nick if it's not a valid channel name
+     * (like done in function irc_ignore_check_channel)
+     */
+    if (!channel)
+    {
+        type_channel = '0';
+        ptr_channel = "";
+    }
+    else if (irc_channel_is_channel (server, channel))
+    {
+        type_channel = 'c';
+        ptr_channel = channel;
+    }
+    else
+    {
+        type_channel = (nick) ? 'n' : '-';
+        ptr_channel = (nick) ? nick : "";
+    }
+    if (snprintf (key, sizeof (key), "%s\x01%c%s\x01%c%s\x01%c%s",
+                  server->name,
+                  type_channel, ptr_channel,
+                  (nick) ? '+' : '-', (nick) ? nick : "",
+                  (host) ? '+' : '-', (host) ? host : "") >= (int)sizeof (key))
+    {
+        key[0] = '\0';
+    }
+
+    if (key[0] && irc_ignore_cache)
+    {
+        ptr_ignored = weechat_hashtable_get (irc_ignore_cache, key);
+        if (ptr_ignored)
+            return *ptr_ignored;
+    }
+
+    ignored = 0;
     for (ptr_ignore = irc_ignore_list; ptr_ignore;
          ptr_ignore = ptr_ignore->next_ignore)
     {
@@ -279,11 +392,36 @@ irc_ignore_check (struct t_irc_server *server, const char *channel,
             && irc_ignore_check_channel (ptr_ignore, server, channel, nick))
         {
             if (irc_ignore_check_host (ptr_ignore, nick, host))
-                return 1;
+            {
+                ignored = 1;
+                break;
+            }
         }
     }
 
-    return 0;
+    if (key[0])
+    {
+        if (!irc_ignore_cache)
+        {
+            irc_ignore_cache = weechat_hashtable_new (
+                256,
+                WEECHAT_HASHTABLE_STRING,
+                WEECHAT_HASHTABLE_INTEGER,
+                NULL, NULL);
+        }
+        if (irc_ignore_cache)
+        {
+            if (weechat_hashtable_get_integer (
+                    irc_ignore_cache,
+                    "items_count") >= IRC_IGNORE_CACHE_MAX_SIZE)
+            {
+                weechat_hashtable_remove_all (irc_ignore_cache);
+            }
+            weechat_hashtable_set (irc_ignore_cache, key, &ignored);
+        }
+    }
+
+    return ignored;
 }
 
 /*
@@ -312,9 +450,10 @@ irc_ignore_free (struct t_irc_ignore *ignore)
     free (ignore->mask);
     if (ignore->regex_mask)
     {
-        regfree (ignore->regex_mask);
+        weechat_string_regfree (ignore->regex_mask);
         free (ignore->regex_mask);
     }
+    free (ignore->nick);
     free (ignore->server);
     free (ignore->channel);
 
@@ -330,6 +469,8 @@ irc_ignore_free (struct t_irc_ignore *ignore)
 
     free (ignore);
 
+    irc_ignore_cache_clear ();
+
     (void) weechat_hook_signal_send ("irc_ignore_removed",
                                      WEECHAT_HOOK_SIGNAL_STRING, NULL);
 }
@@ -345,6 +486,12 @@ irc_ignore_free_all ()
     {
         irc_ignore_free (irc_ignore_list);
     }
+
+    if (irc_ignore_cache)
+    {
+        weechat_hashtable_free (irc_ignore_cache);
+        irc_ignore_cache = NULL;
+    }
 }
 
 /*
@@ -368,6 +515,7 @@ irc_ignore_hdata_ignore_cb (const void *pointer, void *data,
         WEECHAT_HDATA_VAR(struct t_irc_ignore, number, INTEGER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_ignore, mask, STRING, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_ignore, regex_mask, POINTER, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_ignore, nick, STRING, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_ignore, server, STRING, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_ignore, channel, STRING, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_ignore, prev_ignore, POINTER, 0, NULL, hdata_name);
@@ -426,6 +574,7 @@ irc_ignore_print_log ()
         weechat_log_printf ("  number . . . . . . . : %d", ptr_ignore->number);
         weechat_log_printf ("  mask . . . . . . . . : '%s'", ptr_ignore->mask);
         weechat_log_printf ("  regex_mask . . . . . : %p", ptr_ignore->regex_mask);
+        weechat_log_printf ("  nick . . . . . . . . : '%s'", ptr_ignore->nick);
         weechat_log_printf ("  server . . . . . . . : '%s'", ptr_ignore->server);
         weechat_log_printf ("  channel. . . . . . . : '%s'", ptr_ignore->channel);
         weechat_log_printf ("  prev_ignore. . . . . : %p", ptr_ignore->prev_ignore);
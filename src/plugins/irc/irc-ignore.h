@@ -22,6 +22,9 @@
 
 #include <regex.h>
 
+#define IRC_IGNORE_CACHE_MAX_SIZE 4096
+
+struct t_hashtable;
 struct t_irc_server;
 struct t_irc_channel;
 
@@ -30,6 +33,8 @@ struct t_irc_ignore
     int number;                        /* ignore number                     */
     char *mask;                        /* nick / host mask                  */
     regex_t *regex_mask;               /* regex for mask                    */
+    char *nick;                        /* nick if mask is "^nick$" (fast    */
+                                       /* check without regex), else NULL   */
     char *server;                      /* server name ("*" == any server)   */
     char *channel;                     /* channel name ("*" == any channel) */
     struct t_irc_ignore *prev_ignore;  /* link to previous ignore           */
@@ -38,6 +43,7 @@ struct t_irc_ignore
 
 extern struct t_irc_ignore *irc_ignore_list;
 extern struct t_irc_ignore *last_irc_ignore;
+extern struct t_hashtable *irc_ignore_cache;
 
 extern int irc_ignore_valid (struct t_irc_ignore *ignore);
 extern struct t_irc_ignore *irc_ignore_search (const char *mask,
@@ -47,6 +53,7 @@ extern struct t_irc_ignore *irc_ignore_search_by_number (int number);
 extern struct t_irc_ignore *irc_ignore_new (const char *mask,
                                             const char *server,
                                             const char *channel);
+extern char *irc_ignore_get_nick (const char *mask);
 extern int irc_ignore_check_server (struct t_irc_ignore *ignore,
                                     const char *server);
 extern int irc_ignore_check_channel (struct t_irc_ignore *ignore,
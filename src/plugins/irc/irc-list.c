@@ -86,6 +86,49 @@ irc_list_compare_cb (void *data, struct t_arraylist *arraylist,
     return 1;
 }
 
+/*
+ * Sorts an array of channels with a merge sort, using the array "tmp" (with
+ * same size) as temporary storage.
+ *
+ * The sort is stable: channels that are equal are kept in the order they were
+ * received.
+ */
+
+void
+irc_list_merge_sort (struct t_irc_server *server, void **channels, void **tmp,
+                     int size)
+{
+    int middle, i, j, k;
+
+    if (size < 2)
+        return;
+
+    middle = size / 2;
+    irc_list_merge_sort (server, channels, tmp, middle);
+    irc_list_merge_sort (server, channels + middle, tmp, size - middle);
+
+    i = 0;
+    j = middle;
+    k = 0;
+    while ((i < middle) && (j < size))
+    {
+        if (irc_list_compare_cb (server, NULL, channels[j], channels[i]) < 0)
+            tmp[k++] = channels[j++];
+        else
+            tmp[k++] = channels[i++];
+    }
+    while (i < middle)
+    {
+        tmp[k++] = channels[i++];
+    }
+    while (j < size)
+    {
+        tmp[k++] = channels[j++];
+    }
+
+    memcpy (channels, tmp, size * sizeof (*channels));
+}
+
 /*
  * Frees a channel in list.
  */
@@ -131,15 +174,41 @@ irc_list_buffer_set_localvar_filter (struct t_gui_buffer *buffer,
 void
 irc_list_set_filter (struct t_irc_server *server, const char *filter)
 {
+    const char *ptr_mask;
+
     if (server->list->filter)
     {
         free (server->list->filter);
         server->list->filter = NULL;
     }
 
+    if (server->list->filter_mask)
+    {
+        weechat_string_mask_free (server->list->filter_mask);
+        server->list->filter_mask = NULL;
+    }
+
     server->list->filter = (filter && (strcmp (filter, "*") != 0)) ?
         strdup (filter) : NULL;
 
+    /* compile the mask once, it is matched against all channels */
+    if (server->list->filter)
+    {
+        ptr_mask = server->list->filter;
+        if ((strncmp (ptr_mask, "n:", 2) == 0)
+            || (strncmp (ptr_mask, "t:", 2) == 0))
+        {
+            ptr_mask += 2;
+        }
+        else if ((strncmp (ptr_mask, "c:", 2) == 0)
+                 || (strncmp (ptr_mask, "u:", 2) == 0))
+        {
+            ptr_mask = NULL;
+        }
+        if (ptr_mask && strchr (ptr_mask, '*'))
+            server->list->filter_mask = weechat_string_mask_compile (ptr_mask, 0);
+    }
+
     irc_list_buffer_set_localvar_filter (server->list->buffer, server);
 }
 
@@ -162,6 +231,11 @@ irc_list_set_sort (struct t_irc_server *server, const char *sort)
         server->list->sort_fields = NULL;
     }
     server->list->sort_fields_count = 0;
+    if (server->list->sort_channels)
+    {
+        weechat_arraylist_free (server->list->sort_channels);
+        server->list->sort_channels = NULL;
+    }
 
     server->list->sort = strdup (
         (sort && sort[0]) ?
@@ -202,6 +276,8 @@ irc_list_add_channel_in_hashtable (struct t_hashtable *hashtable,
 /*
  * Checks if a string matches a mask.
  *
+ * If mask_compiled is not NULL, it is the compiled mask (used instead of
+ * "mask").
  * If mask has no "*" inside, it just checks if "mask" is inside the "string".
  * If mask has at least one "*" inside, the function weechat_string_match is
  * used.
@@ -212,8 +288,11 @@ irc_list_add_channel_in_hashtable (struct t_hashtable *hashtable,
  */
 
 int
-irc_list_string_match (const char *string, const char *mask)
+irc_list_string_match (const char *string, const char *mask,
+                       struct t_string_mask *mask_compiled)
 {
+    if (mask_compiled)
+        return weechat_string_match_compiled (string, mask_compiled);
     if (strchr (mask, '*'))
         return weechat_string_match (string, mask, 0);
     else
@@ -261,7 +340,8 @@ irc_list_channel_match_filter (struct t_irc_server *server,
     {
         /* filter by channel name */
         if (channel->name
-            && irc_list_string_match (channel->name, server->list->filter + 2))
+            && irc_list_string_match (channel->name, server->list->filter + 2,
+                                      server->list->filter_mask))
         {
             return 1;
         }
@@ -270,7 +350,8 @@ irc_list_channel_match_filter (struct t_irc_server *server,
     {
         /* filter by topic */
         if (channel->topic
-            && irc_list_string_match (channel->topic, server->list->filter + 2))
+            && irc_list_string_match (channel->topic, server->list->filter + 2,
+                                      server->list->filter_mask))
         {
             return 1;
         }
@@ -302,12 +383,14 @@ irc_list_channel_match_filter (struct t_irc_server *server,
     else
     {
         if (channel->name
-            && irc_list_string_match (channel->name, server->list->filter))
+            && irc_list_string_match (channel->name, server->list->filter,
+                                      server->list->filter_mask))
         {
             return 1;
         }
         if (channel->topic
-            && irc_list_string_match (channel->topic, server->list->filter))
+            && irc_list_string_match (channel->topic, server->list->filter,
+                                      server->list->filter_mask))
         {
             return 1;
         }
@@ -317,29 +400,128 @@ irc_list_channel_match_filter (struct t_irc_server *server,
 }
 
 /*
- * Filters channels: apply filter and use sort to build the list
- * "filter_channels" that are pointers to t_irc_list_channel structs
- * stored in main list "channels".
+ * Checks if a filter is narrower than another one: all channels matching
+ * "new_filter" are matching "old_filter" as well, so only channels matching
+ * "old_filter" have to be checked with "new_filter".
+ *
+ * This is the case when both filters are on the same fields (name, topic or
+ * both), without "*" inside, and when "new_filter" contains "old_filter"
+ * (for example when chars are added to the filter).
+ *
+ * Returns:
+ *   1: new filter is narrower than old filter
+ *   0: new filter is not narrower than old filter (or it can not be known)
+ */
+
+int
+irc_list_filter_is_narrower (const char *old_filter, const char *new_filter)
+{
+    int length_prefix;
+
+    if (!old_filter || !new_filter)
+        return 0;
+
+    if ((strncmp (old_filter, "c:", 2) == 0)
+        || (strncmp (old_filter, "u:", 2) == 0)
+        || (strncmp (new_filter, "c:", 2) == 0)
+        || (strncmp (new_filter, "u:", 2) == 0))
+    {
+        return 0;
+    }
+
+    length_prefix = ((strncmp (old_filter, "n:", 2) == 0)
+                     || (strncmp (old_filter, "t:", 2) == 0)) ? 2 : 0;
+    if (length_prefix > 0)
+    {
+        if (strncmp (old_filter, new_filter, length_prefix) != 0)
+            return 0;
+    }
+    else if ((strncmp (new_filter, "n:", 2) == 0)
+             || (strncmp (new_filter, "t:", 2) == 0))
+    {
+        return 0;
+    }
+
+    old_filter += length_prefix;
+    new_filter += length_prefix;
+
+    if (strchr (old_filter, '*') || strchr (new_filter, '*'))
+        return 0;
+
+    return (weechat_strcasestr (new_filter, old_filter)) ? 1 : 0;
+}
+
+/*
+ * Sorts channels: builds the list "sort_channels" with pointers to
+ * t_irc_list_channel structs stored in main list "channels", sorted with
+ * "sort".
+ *
+ * The channels are sorted once, and the list is kept until the sort or the
+ * list of channels is changed.
  */
 
 void
-irc_list_filter_channels (struct t_irc_server *server)
+irc_list_sort_channels (struct t_irc_server *server)
 {
-    struct t_irc_list_channel *ptr_channel;
+    void **channels, **tmp;
     int i, list_size;
 
-    if (server->list->filter_channels)
+    if (server->list->sort_channels)
     {
-        weechat_arraylist_clear (server->list->filter_channels);
+        weechat_arraylist_free (server->list->sort_channels);
+        server->list->sort_channels = NULL;
     }
-    else
+
+    /* filtered channels must be built again from the new sorted list */
+    if (server->list->filter_applied)
     {
-        server->list->filter_channels = weechat_arraylist_new (
-            16, 1, 0,
-            &irc_list_compare_cb, server,
-            NULL, NULL);
+        free (server->list->filter_applied);
+        server->list->filter_applied = NULL;
     }
 
+    list_size = weechat_arraylist_size (server->list->channels);
+
+    server->list->sort_channels = weechat_arraylist_new (
+        (list_size > 0) ? list_size : 16, 0, 1,
+        NULL, NULL,
+        NULL, NULL);
+    if (!server->list->sort_channels || (list_size == 0))
+        return;
+
+    channels = malloc (list_size * sizeof (*channels));
+    tmp = malloc (list_size * sizeof (*tmp));
+    if (channels && tmp)
+    {
+        for (i = 0; i < list_size; i++)
+        {
+            channels[i] = weechat_arraylist_get (server->list->channels, i);
+        }
+        irc_list_merge_sort (server, channels, tmp, list_size);
+        for (i = 0; i < list_size; i++)
+        {
+            weechat_arraylist_add (server->list->sort_channels, channels[i]);
+        }
+    }
+    free (channels);
+    free (tmp);
+}
+
+/*
+ * Filters channels: apply filter on sorted channels to build the list
+ * "filter_channels" that are pointers to t_irc_list_channel structs
+ * stored in main list "channels".
+ *
+ * If the filter is narrower than the filter previously applied, only the
+ * channels in "filter_channels" are checked (and not all channels).
+ */
+
+void
+irc_list_filter_channels (struct t_irc_server *server)
+{
+    struct t_arraylist *ptr_source, *old_filter_channels;
+    struct t_irc_list_channel *ptr_channel;
+    int i, list_size;
+
     if (!server->list->sort)
     {
         irc_list_set_sort (
@@ -347,16 +529,43 @@ irc_list_filter_channels (struct t_irc_server *server)
             weechat_config_string (irc_config_look_list_buffer_sort));
     }
 
-    list_size = weechat_arraylist_size (server->list->channels);
-    for (i = 0; i < list_size; i++)
+    if (!server->list->sort_channels)
+        irc_list_sort_channels (server);
+
+    old_filter_channels = server->list->filter_channels;
+
+    ptr_source = (old_filter_channels
+                  && irc_list_filter_is_narrower (server->list->filter_applied,
+                                                  server->list->filter)) ?
+        old_filter_channels : server->list->sort_channels;
+
+    server->list->filter_channels = weechat_arraylist_new (
+        16, 0, 1,
+        NULL, NULL,
+        NULL, NULL);
+
+    if (server->list->filter_channels)
     {
-        ptr_channel = (struct t_irc_list_channel *)weechat_arraylist_get (
-            server->list->channels, i);
-        if (!ptr_channel)
-            continue;
-        if (irc_list_channel_match_filter (server, ptr_channel))
-            weechat_arraylist_add (server->list->filter_channels, ptr_channel);
+        list_size = weechat_arraylist_size (ptr_source);
+        for (i = 0; i < list_size; i++)
+        {
+            ptr_channel = (struct t_irc_list_channel *)weechat_arraylist_get (
+                ptr_source, i);
+            if (!ptr_channel)
+                continue;
+            if (irc_list_channel_match_filter (server, ptr_channel))
+            {
+                weechat_arraylist_add (server->list->filter_channels,
+                                       ptr_channel);
+            }
+        }
     }
+
+    weechat_arraylist_free (old_filter_channels);
+
+    free (server->list->filter_applied);
+    server->list->filter_applied = (server->list->filter) ?
+        strdup (server->list->filter) : NULL;
 }
 
 /*
@@ -378,6 +587,11 @@ irc_list_parse_messages (struct t_irc_server *server, const char *output)
     int i, count_irc_msgs, num_params, length, keep_colors;
     long number;
 
+    if (server->list->sort_channels)
+    {
+        weechat_arraylist_free (server->list->sort_channels);
+        server->list->sort_channels = NULL;
+    }
     if (server->list->channels)
     {
         weechat_arraylist_free (server->list->channels);
@@ -1144,8 +1358,15 @@ irc_list_reset (struct t_irc_server *server)
 
     if (server->list->channels)
         weechat_arraylist_clear (server->list->channels);
+    if (server->list->sort_channels)
+        weechat_arraylist_clear (server->list->sort_channels);
     if (server->list->filter_channels)
         weechat_arraylist_clear (server->list->filter_channels);
+    if (server->list->filter_applied)
+    {
+        free (server->list->filter_applied);
+        server->list->filter_applied = NULL;
+    }
     server->list->name_max_length = 0;
     if (!server->list->sort)
     {
@@ -1171,9 +1392,12 @@ irc_list_alloc ()
 
     list->buffer = NULL;
     list->channels = NULL;
+    list->sort_channels = NULL;
     list->filter_channels = NULL;
     list->name_max_length = 0;
     list->filter = NULL;
+    list->filter_mask = NULL;
+    list->filter_applied = NULL;
     list->sort = NULL;
     list->sort_fields = NULL;
     list->sort_fields_count = 0;
@@ -1197,6 +1421,11 @@ irc_list_free_data (struct t_irc_server *server)
         weechat_arraylist_free (server->list->channels);
         server->list->channels = NULL;
     }
+    if (server->list->sort_channels)
+    {
+        weechat_arraylist_free (server->list->sort_channels);
+        server->list->sort_channels = NULL;
+    }
     if (server->list->filter_channels)
     {
         weechat_arraylist_free (server->list->filter_channels);
@@ -1208,6 +1437,16 @@ irc_list_free_data (struct t_irc_server *server)
         free (server->list->filter);
         server->list->filter = NULL;
     }
+    if (server->list->filter_mask)
+    {
+        weechat_string_mask_free (server->list->filter_mask);
+        server->list->filter_mask = NULL;
+    }
+    if (server->list->filter_applied)
+    {
+        free (server->list->filter_applied);
+        server->list->filter_applied = NULL;
+    }
     if (server->list->sort)
     {
         free (server->list->sort);
@@ -1284,9 +1523,12 @@ irc_list_hdata_list_cb (const void *pointer, void *data, const char *hdata_name)
     {
         WEECHAT_HDATA_VAR(struct t_irc_list, buffer, POINTER, 0, NULL, "buffer");
         WEECHAT_HDATA_VAR(struct t_irc_list, channels, POINTER, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_list, sort_channels, POINTER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_list, filter_channels, POINTER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_list, name_max_length, INTEGER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_list, filter, STRING, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_list, filter_mask, POINTER, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_list, filter_applied, STRING, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_list, sort, STRING, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_list, sort_fields, POINTER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_list, sort_fields_count, INTEGER, 0, NULL, NULL);
@@ -38,9 +38,12 @@ struct t_irc_list
 {
     struct t_gui_buffer *buffer;       /* buffer for /list                  */
     struct t_arraylist *channels;      /* channels received in /list reply  */
+    struct t_arraylist *sort_channels; /* channels sorted with "sort"       */
     struct t_arraylist *filter_channels; /* filtered channels               */
     int name_max_length;               /* max length for channel name       */
     char *filter;                      /* filter for channels               */
+    struct t_string_mask *filter_mask; /* compiled mask of filter (if "*")  */
+    char *filter_applied;              /* filter used for filter_channels   */
     char *sort;                        /* sort for channels                 */
     char **sort_fields;                /* sort fields                       */
     int sort_fields_count;             /* number of sort fields             */
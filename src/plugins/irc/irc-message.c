@@ -36,6 +36,60 @@
 #include "irc-tag.h"
 
 
+/* last split plan (kept to split again the same arguments without scan) */
+struct t_irc_message_split_plan irc_message_split_last_plan =
+{ NULL, '\0', 0, 0, NULL };
+
+
+/*
+ * Returns the next parameter of command arguments, without allocating memory
+ * (see function irc_message_parse_params).
+ *
+ * Argument "ptr_params" must point to arguments without leading spaces before
+ * the first call; it is updated for the next call (NULL if there are no more
+ * parameters).
+ *
+ * Returns:
+ *   1: parameter returned in "param" and "length"
+ *   0: no more parameters
+ */
+
+int
+irc_message_parse_params_next (const char **ptr_params,
+                               const char **param, int *length)
+{
+    const char *ptr_string, *pos_end;
+
+    if (!*ptr_params)
+        return 0;
+
+    ptr_string = *ptr_params;
+
+    /* trailing parameter */
+    if (ptr_string[0] == ':')
+    {
+        *param = ptr_string + 1;
+        *length = strlen (ptr_string + 1);
+        *ptr_params = NULL;
+        return 1;
+    }
+
+    pos_end = strchr (ptr_string, ' ');
+    if (!pos_end)
+        pos_end = ptr_string + strlen (ptr_string);
+    *param = ptr_string;
+    *length = pos_end - ptr_string;
+
+    ptr_string = pos_end;
+    while (ptr_string[0] == ' ')
+    {
+        ptr_string++;
+    }
+    *ptr_params = (ptr_string[0]) ? ptr_string : NULL;
+
+    return 1;
+}
+
 /*
  * Parses command arguments and returns:
  *   - params (array of strings)
@@ -61,9 +115,8 @@ void
 irc_message_parse_params (const char *parameters,
                           char ***params, int *num_params)
 {
-    const char *ptr_params, *pos_end;
-    char **new_params;
-    int alloc_params, trailing;
+    const char *ptr_params, *ptr_param;
+    int i, count, length;
 
     if (!params && !num_params)
         return;
@@ -76,140 +129,76 @@ irc_message_parse_params (const char *parameters,
     if (!parameters)
         return;
 
-    alloc_params = 0;
-    if (params)
+    while (parameters[0] == ' ')
     {
-        *params = malloc ((alloc_params + 1) * sizeof ((*params)[0]));
-        if (!*params)
-            return;
-        *params[0] = NULL;
+        parameters++;
     }
 
+    /* count parameters first, so that the array is allocated only once */
+    count = 0;
     ptr_params = parameters;
-    while (ptr_params[0] == ' ')
+    while (irc_message_parse_params_next (&ptr_params, &ptr_param, &length))
     {
-        ptr_params++;
+        count++;
     }
 
-    trailing = 0;
-    while (1)
+    if (params)
     {
-        pos_end = NULL;
-        if (ptr_params[0] == ':')
-        {
-            ptr_params++;
-            trailing = 1;
-        }
-        else
-        {
-            pos_end = strchr (ptr_params, ' ');
-        }
-        if (!pos_end)
-            pos_end = ptr_params + strlen (ptr_params);
-        if (params)
-        {
-            alloc_params++;
-            new_params = realloc (*params,
-                                  (alloc_params + 1) * sizeof ((*params)[0]));
-            if (!new_params)
-                return;
-            *params = new_params;
-            (*params)[alloc_params - 1] = weechat_strndup (ptr_params,
-                                                           pos_end - ptr_params);
-            (*params)[alloc_params] = NULL;
-        }
-        if (num_params)
-            *num_params += 1;
-        if (trailing)
-            break;
-        ptr_params = pos_end;
-        while (ptr_params[0] == ' ')
+        *params = malloc ((count + 1) * sizeof ((*params)[0]));
+        if (!*params)
+            return;
+        ptr_params = parameters;
+        for (i = 0; i < count; i++)
         {
-            ptr_params++;
+            irc_message_parse_params_next (&ptr_params, &ptr_param, &length);
+            (*params)[i] = weechat_strndup (ptr_param, length);
         }
-        if (!ptr_params[0])
-            break;
+        (*params)[count] = NULL;
     }
+
+    if (num_params)
+        *num_params = count;
 }
 
 /*
- * Parses an IRC message and returns:
- *   - tags (string)
- *   - message without tags (string)
- *   - nick (string)
- *   - user (string)
- *   - host (string)
- *   - command (string)
- *   - channel (string)
- *   - arguments (string)
- *   - text (string)
- *   - params (array of strings)
- *   - num_params (integer)
- *   - pos_command (integer: command index in message)
- *   - pos_arguments (integer: arguments index in message)
- *   - pos_channel (integer: channel index in message)
- *   - pos_text (integer: text index in message)
+ * Parses an IRC message and fills spans (position and length) of its parts
+ * in the message, without allocating memory.
+ *
+ * Parts not found in message have position -1 and length 0.
  *
  * Example:
  *   @time=2015-06-27T16:40:35.000Z :nick!user@host PRIVMSG #weechat :Hello world!
  *
- * Result:
- *               tags: "time=2015-06-27T16:40:35.000Z"
- *   msg_without_tags: ":nick!user@host PRIVMSG #weechat :Hello world!"
- *               nick: "nick"
- *               user: "user"
- *               host: "nick!user@host"
- *            command: "PRIVMSG"
- *            channel: "#weechat"
- *          arguments: "#weechat :Hello world!"
- *               text: "Hello world!"
- *        pos_command: 47
- *      pos_arguments: 55
- *        pos_channel: 55
- *           pos_text: 65
+ * Result (position, length):
+ *               tags: 1, 29      "time=2015-06-27T16:40:35.000Z"
+ *   msg_without_tags: 31, 46     ":nick!user@host PRIVMSG #weechat :Hello world!"
+ *               nick: 32, 4      "nick"
+ *               user: 37, 4      "user"
+ *               host: 32, 14     "nick!user@host"
+ *            command: 47, 7      "PRIVMSG"
+ *            channel: 55, 8      "#weechat"
+ *          arguments: 55, 22     "#weechat :Hello world!"
+ *               text: 65, 12     "Hello world!"
  */
 
 void
-irc_message_parse (struct t_irc_server *server, const char *message,
-                   char **tags, char **message_without_tags, char **nick,
-                   char **user, char **host, char **command, char **channel,
-                   char **arguments, char **text,
-                   char ***params, int *num_params,
-                   int *pos_command, int *pos_arguments, int *pos_channel,
-                   int *pos_text)
+irc_message_parse_spans (struct t_irc_server *server, const char *message,
+                         struct t_irc_message_spans *spans)
 {
     const char *ptr_message, *pos, *pos2, *pos3, *pos4;
 
-    if (tags)
-        *tags = NULL;
-    if (message_without_tags)
-        *message_without_tags = NULL;
-    if (nick)
-        *nick = NULL;
-    if (user)
-        *user = NULL;
-    if (host)
-        *host = NULL;
-    if (command)
-        *command = NULL;
-    if (channel)
-        *channel = NULL;
-    if (arguments)
-        *arguments = NULL;
-    if (text)
-        *text = NULL;
-    if (params)
-        *params = NULL;
-    if (num_params)
-        *num_params = 0;
-    if (pos_command)
-        *pos_command = -1;
-    if (pos_arguments)
-        *pos_arguments = -1;
-    if (pos_channel)
-        *pos_channel = -1;
-    if (pos_text)
-        *pos_text = -1;
+    if (!spans)
+        return;
+
+    IRC_MESSAGE_SPAN_SET(spans->tags, -1, 0);
+    IRC_MESSAGE_SPAN_SET(spans->message_without_tags, -1, 0);
+    IRC_MESSAGE_SPAN_SET(spans->nick, -1, 0);
+    IRC_MESSAGE_SPAN_SET(spans->user, -1, 0);
+    IRC_MESSAGE_SPAN_SET(spans->host, -1, 0);
+    IRC_MESSAGE_SPAN_SET(spans->command, -1, 0);
+    IRC_MESSAGE_SPAN_SET(spans->channel, -1, 0);
+    IRC_MESSAGE_SPAN_SET(spans->arguments, -1, 0);
+    IRC_MESSAGE_SPAN_SET(spans->text, -1, 0);
 
     if (!message)
         return;
@@ -232,11 +221,7 @@ irc_message_parse (struct t_irc_server *server, const char *message,
         pos = strchr (ptr_message, ' ');
         if (pos)
         {
-            if (tags)
-            {
-                *tags = weechat_strndup (ptr_message + 1,
-                                         pos - (ptr_message + 1));
-            }
+            IRC_MESSAGE_SPAN_SET(spans->tags, 1, pos - (ptr_message + 1));
             ptr_message = pos + 1;
             while (ptr_message[0] == ' ')
             {
@@ -245,8 +230,8 @@ irc_message_parse (struct t_irc_server *server, const char *message,
         }
     }
 
-    if (message_without_tags)
-        *message_without_tags = strdup (ptr_message);
+    IRC_MESSAGE_SPAN_SET(spans->message_without_tags,
+                         ptr_message - message, strlen (ptr_message));
 
     /* now we have: ptr_message --> ":nick!user@host PRIVMSG #weechat :Hello world!" */
     if (ptr_message[0] == ':')
@@ -260,23 +245,26 @@ irc_message_parse (struct t_irc_server *server, const char *message,
             pos2 = pos3;
         if (pos2 && pos3 && (pos3 > pos2))
         {
-            if (user)
-                *user = weechat_strndup (pos2 + 1, pos3 - pos2 - 1);
+            IRC_MESSAGE_SPAN_SET(spans->user,
+                                 pos2 + 1 - message, pos3 - pos2 - 1);
         }
         if (pos2 && (!pos || pos > pos2))
         {
-            if (nick)
-                *nick = weechat_strndup (ptr_message + 1, pos2 - (ptr_message + 1));
+            IRC_MESSAGE_SPAN_SET(spans->nick,
+                                 ptr_message + 1 - message,
+                                 pos2 - (ptr_message + 1));
         }
         else if (pos)
         {
-            if (nick)
-                *nick = weechat_strndup (ptr_message + 1, pos - (ptr_message + 1));
+            IRC_MESSAGE_SPAN_SET(spans->nick,
+                                 ptr_message + 1 - message,
+                                 pos - (ptr_message + 1));
         }
         if (pos)
         {
-            if (host)
-                *host = weechat_strndup (ptr_message + 1, pos - (ptr_message + 1));
+            IRC_MESSAGE_SPAN_SET(spans->host,
+                                 ptr_message + 1 - message,
+                                 pos - (ptr_message + 1));
             ptr_message = pos + 1;
             while (ptr_message[0] == ' ')
             {
@@ -285,150 +273,230 @@ irc_message_parse (struct t_irc_server *server, const char *message,
         }
         else
         {
-            if (host)
-                *host = strdup (ptr_message + 1);
+            IRC_MESSAGE_SPAN_SET(spans->host,
+                                 ptr_message + 1 - message,
+                                 strlen (ptr_message + 1));
             ptr_message += strlen (ptr_message);
         }
     }
 
     /* now we have: ptr_message --> "PRIVMSG #weechat :Hello world!" */
-    if (ptr_message[0])
+    if (!ptr_message[0])
+        return;
+
+    pos = strchr (ptr_message, ' ');
+    if (!pos)
     {
-        pos = strchr (ptr_message, ' ');
-        if (pos)
+        IRC_MESSAGE_SPAN_SET(spans->command,
+                             ptr_message - message, strlen (ptr_message));
+        return;
+    }
+
+    IRC_MESSAGE_SPAN_SET(spans->command,
+                         ptr_message - message, pos - ptr_message);
+    pos++;
+    while (pos[0] == ' ')
+    {
+        pos++;
+    }
+    /* now we have: pos --> "#weechat :Hello world!" */
+    IRC_MESSAGE_SPAN_SET(spans->arguments, pos - message, strlen (pos));
+    if ((pos[0] == ':')
+        && ((strncmp (ptr_message, "JOIN ", 5) == 0)
+            || (strncmp (ptr_message, "PART ", 5) == 0)))
+    {
+        pos++;
+    }
+    if (pos[0] == ':')
+    {
+        IRC_MESSAGE_SPAN_SET(spans->text, pos + 1 - message, strlen (pos + 1));
+    }
+    else
+    {
+        if (irc_channel_is_channel (server, pos))
         {
-            if (command)
-                *command = weechat_strndup (ptr_message, pos - ptr_message);
-            if (pos_command)
-                *pos_command = ptr_message - message;
-            pos++;
-            while (pos[0] == ' ')
+            pos2 = strchr (pos, ' ');
+            IRC_MESSAGE_SPAN_SET(spans->channel,
+                                 pos - message,
+                                 (pos2) ? pos2 - pos : (int)strlen (pos));
+            if (pos2)
             {
-                pos++;
-            }
-            /* now we have: pos --> "#weechat :Hello world!" */
-            if (arguments)
-                *arguments = strdup (pos);
-            if (pos_arguments)
-                *pos_arguments = pos - message;
-            irc_message_parse_params (pos, params, num_params);
-            if ((pos[0] == ':')
-                && ((strncmp (ptr_message, "JOIN ", 5) == 0)
-                    || (strncmp (ptr_message, "PART ", 5) == 0)))
-            {
-                pos++;
+                while (pos2[0] == ' ')
+                {
+                    pos2++;
+                }
+                if (pos2[0] == ':')
+                    pos2++;
+                IRC_MESSAGE_SPAN_SET(spans->text,
+                                     pos2 - message, strlen (pos2));
             }
-            if (pos[0] == ':')
+        }
+        else
+        {
+            pos2 = strchr (pos, ' ');
+            if (spans->nick.pos < 0)
             {
-                if (text)
-                    *text = strdup (pos + 1);
-                if (pos_text)
-                    *pos_text = pos - message + 1;
+                IRC_MESSAGE_SPAN_SET(spans->nick,
+                                     pos - message,
+                                     (pos2) ? pos2 - pos : (int)strlen (pos));
             }
-            else
+            if (pos2)
             {
-                if (irc_channel_is_channel (server, pos))
+                pos3 = pos2;
+                pos2++;
+                while (pos2[0] == ' ')
                 {
-                    pos2 = strchr (pos, ' ');
-                    if (channel)
-                    {
-                        if (pos2)
-                            *channel = weechat_strndup (pos, pos2 - pos);
-                        else
-                            *channel = strdup (pos);
-                    }
-                    if (pos_channel)
-                        *pos_channel = pos - message;
-                    if (pos2)
+                    pos2++;
+                }
+                if (irc_channel_is_channel (server, pos2))
+                {
+                    pos4 = strchr (pos2, ' ');
+                    IRC_MESSAGE_SPAN_SET(
+                        spans->channel,
+                        pos2 - message,
+                        (pos4) ? pos4 - pos2 : (int)strlen (pos2));
+                    if (pos4)
                     {
-                        while (pos2[0] == ' ')
+                        while (pos4[0] == ' ')
                         {
-                            pos2++;
+                            pos4++;
                         }
-                        if (pos2[0] == ':')
-                            pos2++;
-                        if (text)
-                            *text = strdup (pos2);
-                        if (pos_text)
-                            *pos_text = pos2 - message;
+                        if (pos4[0] == ':')
+                            pos4++;
+                        IRC_MESSAGE_SPAN_SET(spans->text,
+                                             pos4 - message, strlen (pos4));
                     }
                 }
                 else
                 {
-                    pos2 = strchr (pos, ' ');
-                    if (nick && !*nick)
-                    {
-                        if (pos2)
-                            *nick = weechat_strndup (pos, pos2 - pos);
-                        else
-                            *nick = strdup (pos);
-                    }
-                    if (pos2)
+                    IRC_MESSAGE_SPAN_SET(spans->channel,
+                                         pos - message, pos3 - pos);
+                    pos4 = strchr (pos3, ' ');
+                    if (pos4)
                     {
-                        pos3 = pos2;
-                        pos2++;
-                        while (pos2[0] == ' ')
-                        {
-                            pos2++;
-                        }
-                        if (irc_channel_is_channel (server, pos2))
-                        {
-                            pos4 = strchr (pos2, ' ');
-                            if (channel)
-                            {
-                                if (pos4)
-                                    *channel = weechat_strndup (pos2, pos4 - pos2);
-                                else
-                                    *channel = strdup (pos2);
-                            }
-                            if (pos_channel)
-                                *pos_channel = pos2 - message;
-                            if (pos4)
-                            {
-                                while (pos4[0] == ' ')
-                                {
-                                    pos4++;
-                                }
-                                if (pos4[0] == ':')
-                                    pos4++;
-                                if (text)
-                                    *text = strdup (pos4);
-                                if (pos_text)
-                                    *pos_text = pos4 - message;
-                            }
-                        }
-                        else
+                        while (pos4[0] == ' ')
                         {
-                            if (channel)
-                                *channel = weechat_strndup (pos, pos3 - pos);
-                            if (pos_channel)
-                                *pos_channel = pos - message;
-                            pos4 = strchr (pos3, ' ');
-                            if (pos4)
-                            {
-                                while (pos4[0] == ' ')
-                                {
-                                    pos4++;
-                                }
-                                if (pos4[0] == ':')
-                                    pos4++;
-                                if (text)
-                                    *text = strdup (pos4);
-                                if (pos_text)
-                                    *pos_text = pos4 - message;
-                            }
+                            pos4++;
                         }
+                        if (pos4[0] == ':')
+                            pos4++;
+                        IRC_MESSAGE_SPAN_SET(spans->text,
+                                             pos4 - message, strlen (pos4));
                     }
                 }
             }
         }
-        else
-        {
-            if (command)
-                *command = strdup (ptr_message);
-            if (pos_command)
-                *pos_command = ptr_message - message;
-        }
+    }
+}
+
+/*
+ * Returns a copy of a part of message (span filled by function
+ * irc_message_parse_spans), NULL if the part was not found in message.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+irc_message_span_strdup (const char *message,
+                         struct t_irc_message_span *span)
+{
+    if (!message || !span || (span->pos < 0))
+        return NULL;
+
+    return weechat_strndup (message + span->pos, span->length);
+}
+
+/*
+ * Parses an IRC message and returns:
+ *   - tags (string)
+ *   - message without tags (string)
+ *   - nick (string)
+ *   - user (string)
+ *   - host (string)
+ *   - command (string)
+ *   - channel (string)
+ *   - arguments (string)
+ *   - text (string)
+ *   - params (array of strings)
+ *   - num_params (integer)
+ *   - pos_command (integer: command index in message)
+ *   - pos_arguments (integer: arguments index in message)
+ *   - pos_channel (integer: channel index in message)
+ *   - pos_text (integer: text index in message)
+ *
+ * Example:
+ *   @time=2015-06-27T16:40:35.000Z :nick!user@host PRIVMSG #weechat :Hello world!
+ *
+ * Result:
+ *               tags: "time=2015-06-27T16:40:35.000Z"
+ *   msg_without_tags: ":nick!user@host PRIVMSG #weechat :Hello world!"
+ *               nick: "nick"
+ *               user: "user"
+ *               host: "nick!user@host"
+ *            command: "PRIVMSG"
+ *            channel: "#weechat"
+ *          arguments: "#weechat :Hello world!"
+ *               text: "Hello world!"
+ *        pos_command: 47
+ *      pos_arguments: 55
+ *        pos_channel: 55
+ *           pos_text: 65
+ */
+
+void
+irc_message_parse (struct t_irc_server *server, const char *message,
+                   char **tags, char **message_without_tags, char **nick,
+                   char **user, char **host, char **command, char **channel,
+                   char **arguments, char **text,
+                   char ***params, int *num_params,
+                   int *pos_command, int *pos_arguments, int *pos_channel,
+                   int *pos_text)
+{
+    struct t_irc_message_spans spans;
+
+    irc_message_parse_spans (server, message, &spans);
+
+    if (tags)
+        *tags = irc_message_span_strdup (message, &spans.tags);
+    if (message_without_tags)
+    {
+        *message_without_tags = irc_message_span_strdup (
+            message, &spans.message_without_tags);
+    }
+    if (nick)
+        *nick = irc_message_span_strdup (message, &spans.nick);
+    if (user)
+        *user = irc_message_span_strdup (message, &spans.user);
+    if (host)
+        *host = irc_message_span_strdup (message, &spans.host);
+    if (command)
+        *command = irc_message_span_strdup (message, &spans.command);
+    if (channel)
+        *channel = irc_message_span_strdup (message, &spans.channel);
+    if (arguments)
+        *arguments = irc_message_span_strdup (message, &spans.arguments);
+    if (text)
+        *text = irc_message_span_strdup (message, &spans.text);
+    if (pos_command)
+        *pos_command = spans.command.pos;
+    if (pos_arguments)
+        *pos_arguments = spans.arguments.pos;
+    if (pos_channel)
+        *pos_channel = spans.channel.pos;
+    if (pos_text)
+        *pos_text = spans.text.pos;
+
+    if (spans.arguments.pos >= 0)
+    {
+        irc_message_parse_params (message + spans.arguments.pos,
+                                  params, num_params);
+    }
+    else
+    {
+        if (params)
+            *params = NULL;
+        if (num_params)
+            *num_params = 0;
     }
 }
 
@@ -935,7 +1003,7 @@ irc_message_split_add (struct t_irc_message_split_context *context,
                        const char *tags, const char *message,
                        const char *arguments)
 {
-    char key[32], value[32], *buf;
+    char key[32], buf_static[1024], *buf;
     int length;
 
     if (!context)
@@ -944,7 +1012,8 @@ irc_message_split_add (struct t_irc_message_split_context *context,
     if (message)
     {
         length = ((tags) ? strlen (tags) : 0) + strlen (message) + 1;
-        buf = malloc (length);
+        buf = (length <= (int)sizeof (buf_static)) ?
+            buf_static : malloc (length);
         if (buf)
         {
             snprintf (key, sizeof (key), "msg%d", context->number);
@@ -958,7 +1027,8 @@ irc_message_split_add (struct t_irc_message_split_context *context,
                                 "irc_message_split_add >> %s='%s' (%d bytes)",
                                 key, buf, length - 1);
             }
-            free (buf);
+            if (buf != buf_static)
+                free (buf);
             context->total_bytes += length;
         }
     }
@@ -973,8 +1043,91 @@ irc_message_split_add (struct t_irc_message_split_context *context,
                             key, arguments);
         }
     }
-    snprintf (value, sizeof (value), "%d", context->number);
-    weechat_hashtable_set (context->hashtable, "count", value);
+    /* key "count" is set in hashtable at the end of split */
+    context->count = context->number;
+}
+
+/*
+ * Builds the split plan of arguments: positions of chunks, split on delimiter
+ * if possible, with max length of each chunk (in bytes), without splitting
+ * an UTF-8 char.
+ *
+ * The last plan is kept, so that it is computed only once when the same
+ * arguments are split many times (for example the same long message sent to
+ * many targets).
+ *
+ * Returns pointer to plan, NULL if error.
+ */
+
+struct t_irc_message_split_plan *
+irc_message_split_plan_get (const char *arguments, const char delimiter,
+                            int max_length)
+{
+    const char *ptr_args, *pos, *pos_max, *pos_next, *pos_last_delim;
+    int *new_chunks, size_chunks;
+
+    if (!arguments || (max_length < 1))
+        return NULL;
+
+    /* same plan as last time? */
+    if (irc_message_split_last_plan.arguments
+        && (irc_message_split_last_plan.delimiter == delimiter)
+        && (irc_message_split_last_plan.max_length == max_length)
+        && (strcmp (irc_message_split_last_plan.arguments, arguments) == 0))
+    {
+        return &irc_message_split_last_plan;
+    }
+
+    free (irc_message_split_last_plan.arguments);
+    irc_message_split_last_plan.arguments = strdup (arguments);
+    if (!irc_message_split_last_plan.arguments)
+        return NULL;
+    irc_message_split_last_plan.delimiter = delimiter;
+    irc_message_split_last_plan.max_length = max_length;
+    irc_message_split_last_plan.num_chunks = 0;
+
+    size_chunks = 0;
+    ptr_args = arguments;
+    while (ptr_args[0])
+    {
+        pos = ptr_args;
+        pos_max = pos + max_length;
+        pos_last_delim = NULL;
+        while (pos[0])
+        {
+            if (pos[0] == delimiter)
+                pos_last_delim = pos;
+            /* fast path for ASCII chars */
+            pos_next = ((unsigned char)pos[0] < 0x80) ?
+                pos + 1 : weechat_utf8_next_char (pos);
+            if (pos_next > pos_max)
+                break;
+            pos = pos_next;
+        }
+        if (pos[0] && pos_last_delim)
+            pos = pos_last_delim;
+        if (irc_message_split_last_plan.num_chunks >= size_chunks)
+        {
+            size_chunks = (size_chunks > 0) ? size_chunks * 2 : 8;
+            new_chunks = realloc (irc_message_split_last_plan.chunks,
+                                  2 * size_chunks * sizeof (new_chunks[0]));
+            if (!new_chunks)
+            {
+                free (irc_message_split_last_plan.arguments);
+                irc_message_split_last_plan.arguments = NULL;
+                return NULL;
+            }
+            irc_message_split_last_plan.chunks = new_chunks;
+        }
+        irc_message_split_last_plan.chunks[
+            2 * irc_message_split_last_plan.num_chunks] = ptr_args - arguments;
+        irc_message_split_last_plan.chunks[
+            (2 * irc_message_split_last_plan.num_chunks) + 1] = pos - ptr_args;
+        irc_message_split_last_plan.num_chunks++;
+        ptr_args = (pos == pos_last_delim) ? pos + 1 : pos;
+    }
+
+    return &irc_message_split_last_plan;
 }
 
 /*
@@ -1022,8 +1175,9 @@ irc_message_split_string (struct t_irc_message_split_context *context,
                           int max_length_nick_user_host,
                           int max_length)
 {
-    const char *pos, *pos_max, *pos_next, *pos_last_delim;
+    struct t_irc_message_split_plan *plan;
     char message[8192], *dup_arguments;
+    int i;
 
     if (!context)
         return 0;
@@ -1073,23 +1227,31 @@ irc_message_split_string (struct t_irc_message_split_context *context,
         return 1;
     }
 
-    while (arguments && arguments[0])
+    /* arguments not too long: no split */
+    if ((int)strlen (arguments) <= max_length)
     {
-        pos = arguments;
-        pos_max = pos + max_length;
-        pos_last_delim = NULL;
-        while (pos[0])
-        {
-            if (pos[0] == delimiter)
-                pos_last_delim = pos;
-            pos_next = weechat_utf8_next_char (pos);
-            if (pos_next > pos_max)
-                break;
-            pos = pos_next;
-        }
-        if (pos[0] && pos_last_delim)
-            pos = pos_last_delim;
-        dup_arguments = weechat_strndup (arguments, pos - arguments);
+        snprintf (message, sizeof (message), "%s%s%s %s%s%s%s%s",
+                  (host) ? host : "",
+                  (host) ? " " : "",
+                  command,
+                  (target) ? target : "",
+                  (target && target[0]) ? " " : "",
+                  (prefix) ? prefix : "",
+                  arguments,
+                  (suffix) ? suffix : "");
+        irc_message_split_add (context, tags, message, arguments);
+        (context->number)++;
+        return 1;
+    }
+
+    plan = irc_message_split_plan_get (arguments, delimiter, max_length);
+    if (!plan)
+        return 0;
+
+    for (i = 0; i < plan->num_chunks; i++)
+    {
+        dup_arguments = weechat_strndup (plan->arguments + plan->chunks[2 * i],
+                                         plan->chunks[(2 * i) + 1]);
         if (dup_arguments)
         {
             snprintf (message, sizeof (message), "%s%s%s %s%s%s%s%s",
@@ -1105,7 +1267,6 @@ irc_message_split_string (struct t_irc_message_split_context *context,
             (context->number)++;
             free (dup_arguments);
         }
-        arguments = (pos == pos_last_delim) ? pos + 1 : pos;
     }
 
     return 1;
@@ -1165,10 +1326,41 @@ irc_message_split_authenticate (struct t_irc_message_split_context *context,
     return 1;
 }
 
+/*
+ * Counts number of targets in arguments of a command (targets are separated
+ * by commas, and end at first space), for example "#chan1,#chan2 key1" has
+ * 2 targets.
+ *
+ * Returns number of targets.
+ */
+
+int
+irc_message_count_targets (const char *arguments)
+{
+    const char *ptr_args;
+    int count;
+
+    if (!arguments || !arguments[0] || (arguments[0] == ' '))
+        return 0;
+
+    count = 1;
+    for (ptr_args = arguments; ptr_args[0] && (ptr_args[0] != ' ');
+         ptr_args++)
+    {
+        if ((ptr_args[0] == ',') && ptr_args[1] && (ptr_args[1] != ','))
+            count++;
+    }
+
+    return count;
+}
+
 /*
  * Splits a JOIN message, taking care of keeping channel keys with channel
  * names.
  *
+ * If max_targets > 0, each message has at most max_targets channels (limit
+ * "JOIN" in feature "TARGMAX" of message 005).
+ *
  * Returns:
  *   1: OK
  *   0: error
@@ -1178,10 +1370,10 @@ int
 irc_message_split_join (struct t_irc_message_split_context *context,
                         const char *tags, const char *host,
                         const char *arguments,
-                        int max_length)
+                        int max_length, int max_targets)
 {
     int channels_count, keys_count, length, length_no_channel;
-    int length_to_add, index_channel;
+    int length_to_add, index_channel, targets;
     char **channels, **keys, *pos, *str;
     char msg_to_send[16384], keys_to_add[16384];
 
@@ -1231,12 +1423,14 @@ irc_message_split_join (struct t_irc_message_split_context *context,
     length_no_channel = length;
     keys_to_add[0] = '\0';
     index_channel = 0;
+    targets = 0;
     while (index_channel < channels_count)
     {
         length_to_add = 1 + strlen (channels[index_channel]);
         if (index_channel < keys_count)
             length_to_add += 1 + strlen (keys[index_channel]);
-        if ((length + length_to_add < max_length)
+        if (((length + length_to_add < max_length)
+             && ((max_targets <= 0) || (targets < max_targets)))
             || (length == length_no_channel))
         {
             if (length + length_to_add < (int)sizeof (msg_to_send))
@@ -1255,6 +1449,7 @@ irc_message_split_join (struct t_irc_message_split_context *context,
             }
             length += length_to_add;
             index_channel++;
+            targets++;
         }
         else
         {
@@ -1269,6 +1464,7 @@ irc_message_split_join (struct t_irc_message_split_context *context,
                       (host) ? " " : "");
             length = strlen (msg_to_send);
             keys_to_add[0] = '\0';
+            targets = 0;
         }
     }
 
@@ -1570,14 +1766,15 @@ irc_message_split (struct t_irc_server *server, const char *message)
 {
     struct t_irc_message_split_context split_context;
     char **argv, **argv_eol, *tags, *host, *command, *arguments, target[4096];
-    char *pos, monitor_action[3];
+    char *pos, monitor_action[3], str_count[32];
     int split_ok, split_privmsg, argc, index_args, max_length_nick;
     int max_length_user, max_length_host, max_length_nick_user_host;
     int split_msg_max_length, multiline, multiline_max_bytes;
-    int multiline_max_lines;
+    int multiline_max_lines, max_targets;
 
     split_context.hashtable = NULL;
     split_context.number = 1;
+    split_context.count = -1;
     split_context.total_bytes = 0;
 
     split_ok = 0;
@@ -1740,11 +1937,15 @@ irc_message_split (struct t_irc_server *server, const char *message)
     else if (weechat_strcasecmp (command, "join") == 0)
     {
         /* JOIN #channel1,#channel2,#channel3 key1,key2 */
-        if ((int)strlen (message) > split_msg_max_length - 2)
+        max_targets = irc_server_get_max_targets (server, "JOIN");
+        if (((int)strlen (message) > split_msg_max_length - 2)
+            || ((max_targets > 0)
+                && (irc_message_count_targets (arguments) > max_targets)))
         {
-            /* split join if it's too long */
+            /* split join if it's too long or has too many channels */
             split_ok = irc_message_split_join (&split_context, tags, host,
-                                               arguments, split_msg_max_length);
+                                               arguments, split_msg_max_length,
+                                               max_targets);
         }
     }
     else if ((weechat_strcasecmp (command, "privmsg") == 0)
@@ -1825,9 +2026,29 @@ end:
                                arguments);
     }
 
+    if (split_context.count >= 0)
+    {
+        snprintf (str_count, sizeof (str_count), "%d", split_context.count);
+        weechat_hashtable_set (split_context.hashtable, "count", str_count);
+    }
+
     free (tags);
     weechat_string_free_split (argv);
     weechat_string_free_split (argv_eol);
 
     return split_context.hashtable;
 }
+
+/*
+ * Frees all allocated data.
+ */
+
+void
+irc_message_end ()
+{
+    free (irc_message_split_last_plan.arguments);
+    irc_message_split_last_plan.arguments = NULL;
+    free (irc_message_split_last_plan.chunks);
+    irc_message_split_last_plan.chunks = NULL;
+    irc_message_split_last_plan.num_chunks = 0;
+}
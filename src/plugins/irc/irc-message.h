@@ -24,15 +24,63 @@ struct t_irc_message_split_context
 {
     struct t_hashtable *hashtable;     /* hashtable with msgs/args/count    */
     int number;                        /* current msg index (starts to 1)   */
+    int count;                         /* number of last msg added          */
+                                       /* (-1 if no msg added)              */
     long total_bytes;                  /* total bytes of messages split     */
                                        /* (+ 1 byte between each message)   */
 };
 
+/*
+ * split plan: positions of chunks in arguments, computed once for the same
+ * arguments, delimiter and max length (for example when the same long message
+ * is sent to many targets)
+ */
+
+struct t_irc_message_split_plan
+{
+    char *arguments;                   /* arguments split                   */
+    char delimiter;                    /* delimiter used for split          */
+    int max_length;                    /* max length of a chunk (bytes)     */
+    int num_chunks;                    /* number of chunks                  */
+    int *chunks;                       /* position and length of chunks     */
+                                       /* (2 * num_chunks integers)         */
+};
+
+#define IRC_MESSAGE_SPAN_SET(__span, __pos, __length)                  \
+    ((__span).pos = (__pos), (__span).length = (__length))
+
+struct t_irc_message_span
+{
+    int pos;                           /* position in message (-1 if the    */
+                                       /* part was not found in message)    */
+    int length;                        /* length (bytes)                    */
+};
+
+struct t_irc_message_spans
+{
+    struct t_irc_message_span tags;    /* tags (without "@")                */
+    struct t_irc_message_span message_without_tags; /* message without tags */
+    struct t_irc_message_span nick;    /* nick                              */
+    struct t_irc_message_span user;    /* user                              */
+    struct t_irc_message_span host;    /* host (nick!user@host)             */
+    struct t_irc_message_span command; /* command                           */
+    struct t_irc_message_span channel; /* channel                           */
+    struct t_irc_message_span arguments; /* arguments (up to end of msg)    */
+    struct t_irc_message_span text;    /* text (up to end of message)       */
+};
+
 struct t_irc_server;
 struct t_irc_channel;
 
+extern int irc_message_parse_params_next (const char **ptr_params,
+                                          const char **param, int *length);
 extern void irc_message_parse_params (const char *parameters,
                                       char ***params, int *num_params);
+extern void irc_message_parse_spans (struct t_irc_server *server,
+                                     const char *message,
+                                     struct t_irc_message_spans *spans);
+extern char *irc_message_span_strdup (const char *message,
+                                      struct t_irc_message_span *span);
 extern void irc_message_parse (struct t_irc_server *server, const char *message,
                                char **tags, char **message_without_tags,
                                char **nick, char **user, char **host,
@@ -60,7 +108,12 @@ extern char *irc_message_replace_vars (struct t_irc_server *server,
                                        const char *string);
 extern char *irc_message_hide_password (struct t_irc_server *server,
                                         const char *target, const char *text);
+extern int irc_message_count_targets (const char *arguments);
+extern struct t_irc_message_split_plan *irc_message_split_plan_get (const char *arguments,
+                                                                   const char delimiter,
+                                                                   int max_length);
 extern struct t_hashtable *irc_message_split (struct t_irc_server *server,
                                               const char *message);
+extern void irc_message_end ();
 
 #endif /* WEECHAT_PLUGIN_IRC_MESSAGE_H */
@@ -84,6 +84,21 @@ irc_modelist_search (struct t_irc_channel *channel, char type)
     return NULL;
 }
 
+/*
+ * Frees a list of items in hashtable "items_host" of modelist.
+ */
+
+void
+irc_modelist_items_host_free_value_cb (struct t_hashtable *hashtable,
+                                       const void *key, void *value)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    weechat_arraylist_free ((struct t_arraylist *)value);
+}
+
 /*
  * Creates a new modelist in a channel.
  *
@@ -109,6 +124,25 @@ irc_modelist_new (struct t_irc_channel *channel, char type)
     new_modelist->state = IRC_MODELIST_STATE_EMPTY;
     new_modelist->items = NULL;
     new_modelist->last_item = NULL;
+    new_modelist->items_mask = weechat_hashtable_new (
+        32,
+        WEECHAT_HASHTABLE_STRING,
+        WEECHAT_HASHTABLE_POINTER,
+        NULL, NULL);
+    new_modelist->items_mask_dup = 0;
+    new_modelist->items_host = weechat_hashtable_new (
+        32,
+        WEECHAT_HASHTABLE_STRING,
+        WEECHAT_HASHTABLE_POINTER,
+        NULL, NULL);
+    if (new_modelist->items_host)
+    {
+        weechat_hashtable_set_pointer (new_modelist->items_host,
+                                       "callback_free_value",
+                                       &irc_modelist_items_host_free_value_cb);
+    }
+    new_modelist->items_wildcard = weechat_arraylist_new (
+        16, 1, 0, NULL, NULL, NULL, NULL);
 
     /* add new modelist to channel */
     new_modelist->prev_modelist = channel->last_modelist;
@@ -153,6 +187,10 @@ irc_modelist_free (struct t_irc_channel *channel,
     /* free linked lists */
     irc_modelist_item_free_all (modelist);
 
+    weechat_hashtable_free (modelist->items_mask);
+    weechat_hashtable_free (modelist->items_host);
+    weechat_arraylist_free (modelist->items_wildcard);
+
     free (modelist);
 
     channel->modelists = new_modelists;
@@ -199,6 +237,147 @@ irc_modelist_item_valid (struct t_irc_modelist *modelist,
     return 0;
 }
 
+/*
+ * Returns the host of a mask (in lower case) if the mask has an exact host
+ * (no wildcard after the last "@"), for example "*!*@host.com" => "host.com".
+ *
+ * Returns NULL if the mask has no "@" or if its host contains a wildcard.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+irc_modelist_item_get_host (const char *mask)
+{
+    const char *pos_host;
+
+    if (!mask)
+        return NULL;
+
+    pos_host = strrchr (mask, '@');
+    if (!pos_host || !pos_host[1] || strchr (pos_host + 1, '*'))
+        return NULL;
+
+    return weechat_string_tolower (pos_host + 1);
+}
+
+/*
+ * Adds an item in the indexes of modelist.
+ */
+
+void
+irc_modelist_item_index_add (struct t_irc_modelist *modelist,
+                             struct t_irc_modelist_item *item)
+{
+    struct t_arraylist *ptr_items;
+    char *host;
+
+    /* index by mask: first item with this mask is kept */
+    if (modelist->items_mask)
+    {
+        if (weechat_hashtable_has_key (modelist->items_mask, item->mask))
+            modelist->items_mask_dup++;
+        else
+            weechat_hashtable_set (modelist->items_mask, item->mask, item);
+    }
+
+    /* index by exact host, or list of items with wildcard in host */
+    host = irc_modelist_item_get_host (item->mask);
+    if (host)
+    {
+        if (modelist->items_host)
+        {
+            ptr_items = weechat_hashtable_get (modelist->items_host, host);
+            if (!ptr_items)
+            {
+                ptr_items = weechat_arraylist_new (4, 1, 0,
+                                                   NULL, NULL, NULL, NULL);
+                if (ptr_items
+                    && !weechat_hashtable_set (modelist->items_host, host,
+                                               ptr_items))
+                {
+                    weechat_arraylist_free (ptr_items);
+                    ptr_items = NULL;
+                }
+            }
+            if (ptr_items)
+                weechat_arraylist_add (ptr_items, item);
+        }
+        free (host);
+    }
+    else if (modelist->items_wildcard)
+    {
+        weechat_arraylist_add (modelist->items_wildcard, item);
+    }
+}
+
+/*
+ * Removes an item from the indexes of modelist.
+ */
+
+void
+irc_modelist_item_index_remove (struct t_irc_modelist *modelist,
+                                struct t_irc_modelist_item *item)
+{
+    struct t_irc_modelist_item *ptr_item;
+    struct t_arraylist *ptr_items;
+    char *host;
+    int index;
+
+    /* index by mask: use next item with same mask, if any */
+    if (modelist->items_mask)
+    {
+        if (weechat_hashtable_get (modelist->items_mask, item->mask) == item)
+        {
+            weechat_hashtable_remove (modelist->items_mask, item->mask);
+            if (modelist->items_mask_dup > 0)
+            {
+                for (ptr_item = item->next_item; ptr_item;
+                     ptr_item = ptr_item->next_item)
+                {
+                    if (strcmp (ptr_item->mask, item->mask) == 0)
+                    {
+                        weechat_hashtable_set (modelist->items_mask,
+                                               ptr_item->mask, ptr_item);
+                        modelist->items_mask_dup--;
+                        break;
+                    }
+                }
+            }
+        }
+        else if (modelist->items_mask_dup > 0)
+        {
+            modelist->items_mask_dup--;
+        }
+    }
+
+    /* index by exact host, or list of items with wildcard in host */
+    host = irc_modelist_item_get_host (item->mask);
+    if (host)
+    {
+        if (modelist->items_host)
+        {
+            ptr_items = weechat_hashtable_get (modelist->items_host, host);
+            if (ptr_items)
+            {
+                if (weechat_arraylist_search (ptr_items, item, &index, NULL))
+                    weechat_arraylist_remove (ptr_items, index);
+                if (weechat_arraylist_size (ptr_items) == 0)
+                    weechat_hashtable_remove (modelist->items_host, host);
+            }
+        }
+        free (host);
+    }
+    else if (modelist->items_wildcard)
+    {
+        if (weechat_arraylist_search (modelist->items_wildcard, item,
+                                      &index, NULL))
+        {
+            weechat_arraylist_remove (modelist->items_wildcard, index);
+        }
+    }
+}
+
 /*
  * Searches for an item by mask.
  *
@@ -213,6 +392,9 @@ irc_modelist_item_search_mask (struct t_irc_modelist *modelist, const char *mask
     if (!modelist || !mask)
         return NULL;
 
+    if (modelist->items_mask)
+        return weechat_hashtable_get (modelist->items_mask, mask);
+
     for (ptr_item = modelist->items; ptr_item;
          ptr_item = ptr_item->next_item)
     {
@@ -222,6 +404,68 @@ irc_modelist_item_search_mask (struct t_irc_modelist *modelist, const char *mask
     return NULL;
 }
 
+/*
+ * Searches for an item with a mask matching a hostmask (case insensitive),
+ * for example "nick!user@host.com" matches item with mask "*!*@host.com".
+ *
+ * Only items with the same exact host as hostmask and items with a wildcard
+ * in host are checked, other items can not match.
+ *
+ * Returns pointer to an item matching, NULL if no item matches.
+ */
+
+struct t_irc_modelist_item *
+irc_modelist_item_search_match (struct t_irc_modelist *modelist,
+                                const char *hostmask)
+{
+    struct t_irc_modelist_item *ptr_item;
+    struct t_arraylist *ptr_items;
+    char *host;
+    int i, size;
+
+    if (!modelist || !hostmask)
+        return NULL;
+
+    if (!modelist->items_host || !modelist->items_wildcard)
+    {
+        for (ptr_item = modelist->items; ptr_item;
+             ptr_item = ptr_item->next_item)
+        {
+            if (weechat_string_match (hostmask, ptr_item->mask, 0))
+                return ptr_item;
+        }
+        return NULL;
+    }
+
+    /* items with same exact host */
+    host = irc_modelist_item_get_host (hostmask);
+    if (host)
+    {
+        ptr_items = weechat_hashtable_get (modelist->items_host, host);
+        free (host);
+        size = weechat_arraylist_size (ptr_items);
+        for (i = 0; i < size; i++)
+        {
+            ptr_item = (struct t_irc_modelist_item *)weechat_arraylist_get (
+                ptr_items, i);
+            if (weechat_string_match (hostmask, ptr_item->mask, 0))
+                return ptr_item;
+        }
+    }
+
+    /* items with wildcard in host */
+    size = weechat_arraylist_size (modelist->items_wildcard);
+    for (i = 0; i < size; i++)
+    {
+        ptr_item = (struct t_irc_modelist_item *)weechat_arraylist_get (
+            modelist->items_wildcard, i);
+        if (weechat_string_match (hostmask, ptr_item->mask, 0))
+            return ptr_item;
+    }
+
+    return NULL;
+}
+
 /*
  * Searches for an item by number.
  *
@@ -285,6 +529,8 @@ irc_modelist_item_new (struct t_irc_modelist *modelist,
         modelist->items = new_item;
     modelist->last_item = new_item;
 
+    irc_modelist_item_index_add (modelist, new_item);
+
     if ((modelist->state == IRC_MODELIST_STATE_EMPTY) ||
         (modelist->state == IRC_MODELIST_STATE_RECEIVED))
     {
@@ -308,6 +554,8 @@ irc_modelist_item_free (struct t_irc_modelist *modelist,
     if (!modelist || !item)
         return;
 
+    irc_modelist_item_index_remove (modelist, item);
+
     /* remove item from modelist list */
     if (modelist->last_item == item)
         modelist->last_item = item->prev_item;
@@ -396,6 +644,10 @@ irc_modelist_hdata_modelist_cb (const void *pointer, void *data, const char *hda
         WEECHAT_HDATA_VAR(struct t_irc_modelist, state, INTEGER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_modelist, items, POINTER, 0, NULL, "irc_modelist_item");
         WEECHAT_HDATA_VAR(struct t_irc_modelist, last_item, POINTER, 0, NULL, "irc_modelist_item");
+        WEECHAT_HDATA_VAR(struct t_irc_modelist, items_mask, HASHTABLE, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_modelist, items_mask_dup, INTEGER, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_modelist, items_host, HASHTABLE, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_modelist, items_wildcard, POINTER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_modelist, prev_modelist, POINTER, 0, NULL, hdata_name);
         WEECHAT_HDATA_VAR(struct t_irc_modelist, next_modelist, POINTER, 0, NULL, hdata_name);
     }
@@ -497,6 +749,18 @@ irc_modelist_print_log (struct t_irc_modelist *modelist)
     weechat_log_printf ("");
     weechat_log_printf ("    => modelist \"%c\" (addr:%p):", modelist->type, modelist);
     weechat_log_printf ("         state. . . . . . . . . . : %d", modelist->state);
+    weechat_log_printf ("         items_mask . . . . . . . : %p (items: %d)",
+                        modelist->items_mask,
+                        weechat_hashtable_get_integer (modelist->items_mask,
+                                                       "items_count"));
+    weechat_log_printf ("         items_mask_dup . . . . . : %d", modelist->items_mask_dup);
+    weechat_log_printf ("         items_host . . . . . . . : %p (items: %d)",
+                        modelist->items_host,
+                        weechat_hashtable_get_integer (modelist->items_host,
+                                                       "items_count"));
+    weechat_log_printf ("         items_wildcard . . . . . : %p (size: %d)",
+                        modelist->items_wildcard,
+                        weechat_arraylist_size (modelist->items_wildcard));
     weechat_log_printf ("         prev_modelist  . . . . . : %p", modelist->prev_modelist);
     weechat_log_printf ("         next_modelist  . . . . . : %p", modelist->next_modelist);
     for (ptr_item = modelist->items; ptr_item; ptr_item = ptr_item->next_item)
@@ -29,6 +29,8 @@
 #define IRC_MODELIST_STATE_RECEIVED   2
 #define IRC_MODELIST_STATE_MODIFIED   3
 
+struct t_arraylist;
+struct t_hashtable;
 struct t_irc_server;
 
 struct t_irc_modelist_item
@@ -49,6 +51,14 @@ struct t_irc_modelist
 
     struct t_irc_modelist_item *items;     /* items in modelist             */
     struct t_irc_modelist_item *last_item; /* last item in modelist         */
+    struct t_hashtable *items_mask;        /* items by mask (first item if  */
+                                           /* many items with same mask)    */
+    int items_mask_dup;                    /* number of items not in        */
+                                           /* items_mask (duplicate mask)   */
+    struct t_hashtable *items_host;        /* items by host (lower case)    */
+                                           /* for masks with exact host     */
+    struct t_arraylist *items_wildcard;    /* other items (host with        */
+                                           /* wildcard, extban, ...)        */
 
     struct t_irc_modelist *prev_modelist;  /* pointer to previous modelist  */
     struct t_irc_modelist *next_modelist;  /* pointer to next modelist      */
@@ -68,6 +78,8 @@ extern int irc_modelist_item_valid (struct t_irc_modelist *modelist,
                                     struct t_irc_modelist_item *item);
 extern struct t_irc_modelist_item *irc_modelist_item_search_mask (struct t_irc_modelist *modelist,
                                                                   const char *mask);
+extern struct t_irc_modelist_item *irc_modelist_item_search_match (struct t_irc_modelist *modelist,
+                                                                   const char *hostmask);
 extern struct t_irc_modelist_item *irc_modelist_item_search_number (struct t_irc_modelist *modelist,
                                                                     int number);
 extern struct t_irc_modelist_item *irc_modelist_item_new (struct t_irc_modelist *modelist,
@@ -232,6 +232,27 @@ irc_nick_set_prefixes (struct t_irc_server *server, struct t_irc_nick *nick,
     irc_nick_set_current_prefix (nick);
 }
 
+/*
+ * Sets a shared string in a nick (host, account, realname).
+ *
+ * These strings are shared: the same host, account or realname of a user
+ * joined on many channels is stored only once in memory.
+ */
+
+void
+irc_nick_set_shared_string (char **string, const char *value)
+{
+    /* if value is the same, just return */
+    if ((!*string && !value)
+        || (*string && value && strcmp (*string, value) == 0))
+    {
+        return;
+    }
+
+    weechat_string_shared_free (*string);
+    *string = (value) ? (char *)weechat_string_shared_get (value) : NULL;
+}
+
 /*
  * Sets host for nick.
  */
@@ -242,16 +263,33 @@ irc_nick_set_host (struct t_irc_nick *nick, const char *host)
     if (!nick)
         return;
 
-    /* if host is the same, just return */
-    if ((!nick->host && !host)
-        || (nick->host && host && strcmp (nick->host, host) == 0))
-    {
+    irc_nick_set_shared_string (&nick->host, host);
+}
+
+/*
+ * Sets account for nick.
+ */
+
+void
+irc_nick_set_account (struct t_irc_nick *nick, const char *account)
+{
+    if (!nick)
+        return;
+
+    irc_nick_set_shared_string (&nick->account, account);
+}
+
+/*
+ * Sets realname for nick.
+ */
+
+void
+irc_nick_set_realname (struct t_irc_nick *nick, const char *realname)
+{
+    if (!nick)
         return;
-    }
 
-    /* update the host in nick */
-    free (nick->host);
-    nick->host = (host) ? strdup (host) : NULL;
+    irc_nick_set_shared_string (&nick->realname, realname);
 }
 
 /*
@@ -413,6 +451,9 @@ irc_nick_nicklist_add (struct t_irc_server *server,
     struct t_gui_nick_group *ptr_group;
     char *color;
 
+    if (channel->nicklist_lazy)
+        return;
+
     ptr_group = irc_nick_get_nicklist_group (server, channel->buffer, nick);
     color = irc_nick_get_color_for_nicklist (server, nick);
     weechat_nicklist_add_nick (channel->buffer, ptr_group,
@@ -435,6 +476,9 @@ irc_nick_nicklist_remove (struct t_irc_server *server,
 {
     struct t_gui_nick_group *ptr_group;
 
+    if (channel->nicklist_lazy)
+        return;
+
     ptr_group = irc_nick_get_nicklist_group (server, channel->buffer, nick);
     weechat_nicklist_remove_nick (channel->buffer,
                                   weechat_nicklist_search_nick (channel->buffer,
@@ -453,6 +497,9 @@ irc_nick_nicklist_set (struct t_irc_channel *channel,
 {
     struct t_gui_nick *ptr_nick;
 
+    if (channel->nicklist_lazy)
+        return;
+
     ptr_nick = weechat_nicklist_search_nick (channel->buffer, NULL, nick->name);
     if (ptr_nick)
     {
@@ -517,6 +564,155 @@ irc_nick_nicklist_set_color_all ()
     }
 }
 
+/*
+ * Frees a list of channels in hashtable "nicks_channels" of server.
+ */
+
+void
+irc_nick_channels_free_value_cb (struct t_hashtable *hashtable,
+                                 const void *key, void *value)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    weechat_arraylist_free ((struct t_arraylist *)value);
+}
+
+/*
+ * Adds a channel in list of channels of a nick, in hashtable "nicks_channels"
+ * of server.
+ */
+
+void
+irc_nick_channels_add (struct t_irc_server *server,
+                       struct t_irc_channel *channel,
+                       const char *key)
+{
+    struct t_arraylist *ptr_channels;
+
+    if (!server->nicks_channels)
+        return;
+
+    ptr_channels = weechat_hashtable_get (server->nicks_channels, key);
+    if (!ptr_channels)
+    {
+        ptr_channels = weechat_arraylist_new (4, 0, 0,
+                                              NULL, NULL, NULL, NULL);
+        if (!ptr_channels)
+            return;
+        if (!weechat_hashtable_set (server->nicks_channels, key,
+                                    ptr_channels))
+        {
+            weechat_arraylist_free (ptr_channels);
+            return;
+        }
+    }
+    if (!weechat_arraylist_search (ptr_channels, channel, NULL, NULL))
+        weechat_arraylist_add (ptr_channels, channel);
+}
+
+/*
+ * Removes a channel from list of channels of a nick, in hashtable
+ * "nicks_channels" of server.
+ */
+
+void
+irc_nick_channels_remove (struct t_irc_server *server,
+                          struct t_irc_channel *channel,
+                          const char *key)
+{
+    struct t_arraylist *ptr_channels;
+    int index;
+
+    if (!server->nicks_channels)
+        return;
+
+    ptr_channels = weechat_hashtable_get (server->nicks_channels, key);
+    if (!ptr_channels)
+        return;
+
+    if (weechat_arraylist_search (ptr_channels, channel, &index, NULL))
+        weechat_arraylist_remove (ptr_channels, index);
+    if (weechat_arraylist_size (ptr_channels) == 0)
+        weechat_hashtable_remove (server->nicks_channels, key);
+}
+
+/*
+ * Adds a nick in hashtable "nicks_hash" of channel and the channel in
+ * hashtable "nicks_channels" of server.
+ */
+
+void
+irc_nick_hash_add (struct t_irc_server *server, struct t_irc_channel *channel,
+                   struct t_irc_nick *nick)
+{
+    char *key;
+
+    key = irc_server_string_tolower (server, nick->name);
+    if (key)
+    {
+        if (channel->nicks_hash)
+            weechat_hashtable_set (channel->nicks_hash, key, nick);
+        irc_nick_channels_add (server, channel, key);
+        free (key);
+    }
+}
+
+/*
+ * Removes a nick from hashtable "nicks_hash" of channel and the channel from
+ * hashtable "nicks_channels" of server.
+ */
+
+void
+irc_nick_hash_remove (struct t_irc_server *server,
+                      struct t_irc_channel *channel,
+                      struct t_irc_nick *nick)
+{
+    char *key;
+
+    key = irc_server_string_tolower (server, nick->name);
+    if (key)
+    {
+        if (!channel->nicks_hash
+            || (weechat_hashtable_get (channel->nicks_hash, key) == nick))
+        {
+            if (channel->nicks_hash)
+                weechat_hashtable_remove (channel->nicks_hash, key);
+            irc_nick_channels_remove (server, channel, key);
+        }
+        free (key);
+    }
+}
+
+/*
+ * Rebuilds hashtable "nicks_hash" in all channels of the server and hashtable
+ * "nicks_channels" of server (must be called when the server casemapping
+ * changes).
+ */
+
+void
+irc_nick_hash_rebuild (struct t_irc_server *server)
+{
+    struct t_irc_channel *ptr_channel;
+    struct t_irc_nick *ptr_nick;
+
+    if (server->nicks_channels)
+        weechat_hashtable_remove_all (server->nicks_channels);
+
+    for (ptr_channel = server->channels; ptr_channel;
+         ptr_channel = ptr_channel->next_channel)
+    {
+        if (ptr_channel->nicks_hash)
+            weechat_hashtable_remove_all (ptr_channel->nicks_hash);
+        for (ptr_nick = ptr_channel->nicks; ptr_nick;
+             ptr_nick = ptr_nick->next_nick)
+        {
+            irc_nick_hash_add (server, ptr_channel, ptr_nick);
+        }
+    }
+}
+
 /*
  * Adds a new nick in channel, but do not update the buffer nicklist.
  * This function is only called by the function `irc_nick_new` (below) and
@@ -542,19 +738,21 @@ irc_nick_new_in_channel (struct t_irc_server *server,
         return NULL;
 
     /* initialize new nick */
-    new_nick->name = strdup (nickname);
-    new_nick->host = (host) ? strdup (host) : NULL;
-    new_nick->account = (account) ? strdup (account) : NULL;
-    new_nick->realname = (realname) ? strdup (realname) : NULL;
+    new_nick->name = (char *)weechat_string_shared_get (nickname);
+    new_nick->host = (host) ? (char *)weechat_string_shared_get (host) : NULL;
+    new_nick->account = (account) ?
+        (char *)weechat_string_shared_get (account) : NULL;
+    new_nick->realname = (realname) ?
+        (char *)weechat_string_shared_get (realname) : NULL;
     length = strlen (irc_server_get_prefix_chars (server));
     new_nick->prefixes = malloc (length + 1);
     new_nick->prefix = malloc (2);
     if (!new_nick->name || !new_nick->prefixes || !new_nick->prefix)
     {
-        free (new_nick->name);
-        free (new_nick->host);
-        free (new_nick->account);
-        free (new_nick->realname);
+        weechat_string_shared_free (new_nick->name);
+        weechat_string_shared_free (new_nick->host);
+        weechat_string_shared_free (new_nick->account);
+        weechat_string_shared_free (new_nick->realname);
         free (new_nick->prefixes);
         free (new_nick->prefix);
         free (new_nick);
@@ -580,6 +778,8 @@ irc_nick_new_in_channel (struct t_irc_server *server,
     channel->last_nick = new_nick;
     new_nick->next_nick = NULL;
 
+    irc_nick_hash_add (server, channel, new_nick);
+
     channel->nicks_count++;
 
     channel->nick_completion_reset = 1;
@@ -630,6 +830,9 @@ irc_nick_new (struct t_irc_server *server, struct t_irc_channel *channel,
     /* add nick to buffer nicklist */
     irc_nick_nicklist_add (server, channel, new_nick);
 
+    /* remove nicks from nicklist if channel is large and not displayed */
+    irc_channel_nicklist_check_lazy (server, channel);
+
     /* all is OK, return address of new nick */
     return new_nick;
 }
@@ -653,8 +856,10 @@ irc_nick_change (struct t_irc_server *server, struct t_irc_channel *channel,
         irc_channel_nick_speaking_rename (channel, nick->name, new_nick);
 
     /* change nickname */
-    free (nick->name);
-    nick->name = strdup (new_nick);
+    irc_nick_hash_remove (server, channel, nick);
+    weechat_string_shared_free (nick->name);
+    nick->name = (char *)weechat_string_shared_get (new_nick);
+    irc_nick_hash_add (server, channel, nick);
     free (nick->color);
     if (nick_is_me)
         nick->color = strdup (IRC_COLOR_CHAT_NICK_SELF);
@@ -762,6 +967,7 @@ irc_nick_free (struct t_irc_server *server, struct t_irc_channel *channel,
     irc_nick_nicklist_remove (server, channel, nick);
 
     /* remove nick */
+    irc_nick_hash_remove (server, channel, nick);
     if (channel->last_nick == nick)
         channel->last_nick = nick->prev_nick;
     if (nick->prev_nick)
@@ -778,12 +984,12 @@ irc_nick_free (struct t_irc_server *server, struct t_irc_channel *channel,
     channel->nicks_count--;
 
     /* free data */
-    free (nick->name);
-    free (nick->host);
+    weechat_string_shared_free (nick->name);
+    weechat_string_shared_free (nick->host);
     free (nick->prefixes);
     free (nick->prefix);
-    free (nick->account);
-    free (nick->realname);
+    weechat_string_shared_free (nick->account);
+    weechat_string_shared_free (nick->realname);
     free (nick->color);
 
     free (nick);
@@ -810,6 +1016,8 @@ irc_nick_free_all (struct t_irc_server *server, struct t_irc_channel *channel)
 
     /* remove all groups in nicklist */
     weechat_nicklist_remove_all (channel->buffer);
+    channel->nicklist_lazy = 0;
+    channel->nicklist_names = 0;
 
     /* should be zero, but prevent any bug :D */
     channel->nicks_count = 0;
@@ -829,10 +1037,21 @@ irc_nick_search (struct t_irc_server *server, struct t_irc_channel *channel,
                  const char *nickname)
 {
     struct t_irc_nick *ptr_nick;
+    char *key;
 
     if (!channel || !nickname)
         return NULL;
 
+    if (channel->nicks_hash)
+    {
+        key = irc_server_string_tolower (server, nickname);
+        if (!key)
+            return NULL;
+        ptr_nick = weechat_hashtable_get (channel->nicks_hash, key);
+        free (key);
+        return ptr_nick;
+    }
+
     for (ptr_nick = channel->nicks; ptr_nick;
          ptr_nick = ptr_nick->next_nick)
     {
@@ -844,6 +1063,62 @@ irc_nick_search (struct t_irc_server *server, struct t_irc_channel *channel,
     return NULL;
 }
 
+/*
+ * Searches for channels where a nick is, using hashtable "nicks_channels" of
+ * server (so that only these channels are checked, and not all channels of
+ * the server).
+ *
+ * If with_private == 1, the private buffer with this nick is added at the end
+ * of list (if found).
+ *
+ * Returns a new arraylist with pointers to channels (can be empty), NULL if
+ * error.
+ *
+ * Note: result must be freed after use with function weechat_arraylist_free.
+ */
+
+struct t_arraylist *
+irc_nick_search_channels (struct t_irc_server *server, const char *nickname,
+                          int with_private)
+{
+    struct t_arraylist *channels, *ptr_channels;
+    struct t_irc_channel *ptr_channel;
+    char *key;
+    int i, size;
+
+    if (!server || !nickname)
+        return NULL;
+
+    channels = weechat_arraylist_new (4, 0, 1, NULL, NULL, NULL, NULL);
+    if (!channels)
+        return NULL;
+
+    if (server->nicks_channels)
+    {
+        key = irc_server_string_tolower (server, nickname);
+        if (key)
+        {
+            ptr_channels = weechat_hashtable_get (server->nicks_channels, key);
+            size = weechat_arraylist_size (ptr_channels);
+            for (i = 0; i < size; i++)
+            {
+                weechat_arraylist_add (channels,
+                                       weechat_arraylist_get (ptr_channels, i));
+            }
+            free (key);
+        }
+    }
+
+    if (with_private)
+    {
+        ptr_channel = irc_channel_search (server, nickname);
+        if (ptr_channel && (ptr_channel->type == IRC_CHANNEL_TYPE_PRIVATE))
+            weechat_arraylist_add (channels, ptr_channel);
+    }
+
+    return channels;
+}
+
 /*
  * Returns number of nicks per mode on a channel, as an array of integers
  * whose size is the number of modes + 1 (for regular users).
@@ -1146,13 +1421,13 @@ irc_nick_hdata_nick_cb (const void *pointer, void *data,
                                0, 0, NULL, NULL);
     if (hdata)
     {
-        WEECHAT_HDATA_VAR(struct t_irc_nick, name, STRING, 0, NULL, NULL);
-        WEECHAT_HDATA_VAR(struct t_irc_nick, host, STRING, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_nick, name, SHARED_STRING, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_nick, host, SHARED_STRING, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_nick, prefixes, STRING, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_nick, prefix, STRING, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_nick, away, INTEGER, 0, NULL, NULL);
-        WEECHAT_HDATA_VAR(struct t_irc_nick, account, STRING, 0, NULL, NULL);
-        WEECHAT_HDATA_VAR(struct t_irc_nick, realname, STRING, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_nick, account, SHARED_STRING, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_nick, realname, SHARED_STRING, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_nick, color, STRING, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_nick, prev_nick, POINTER, 0, NULL, hdata_name);
         WEECHAT_HDATA_VAR(struct t_irc_nick, next_nick, POINTER, 0, NULL, hdata_name);
@@ -28,6 +28,8 @@
 #define IRC_NICK_GROUP_OTHER_NUMBER 999
 #define IRC_NICK_GROUP_OTHER_NAME   "..."
 
+struct t_arraylist;
+struct t_hashtable;
 struct t_irc_server;
 struct t_irc_channel;
 
@@ -52,6 +54,10 @@ extern int irc_nick_is_nick (struct t_irc_server *server, const char *string);
 extern char *irc_nick_find_color (const char *nickname);
 extern char *irc_nick_find_color_name (const char *nickname);
 extern void irc_nick_set_host (struct t_irc_nick *nick, const char *host);
+extern void irc_nick_set_account (struct t_irc_nick *nick,
+                                  const char *account);
+extern void irc_nick_set_realname (struct t_irc_nick *nick,
+                                   const char *realname);
 extern int irc_nick_is_op_or_higher (struct t_irc_server *server,
                                      struct t_irc_nick *nick);
 extern int irc_nick_has_prefix_mode (struct t_irc_server *server,
@@ -59,8 +65,20 @@ extern int irc_nick_has_prefix_mode (struct t_irc_server *server,
                                      char prefix_mode);
 extern const char *irc_nick_get_prefix_color_name (struct t_irc_server *server,
                                                    char prefix);
+extern void irc_nick_nicklist_add (struct t_irc_server *server,
+                                   struct t_irc_channel *channel,
+                                   struct t_irc_nick *nick);
 extern void irc_nick_nicklist_set_prefix_color_all ();
 extern void irc_nick_nicklist_set_color_all ();
+extern void irc_nick_channels_free_value_cb (struct t_hashtable *hashtable,
+                                            const void *key, void *value);
+extern void irc_nick_hash_add (struct t_irc_server *server,
+                               struct t_irc_channel *channel,
+                               struct t_irc_nick *nick);
+extern void irc_nick_hash_remove (struct t_irc_server *server,
+                                  struct t_irc_channel *channel,
+                                  struct t_irc_nick *nick);
+extern void irc_nick_hash_rebuild (struct t_irc_server *server);
 extern struct t_irc_nick *irc_nick_new_in_channel (struct t_irc_server *server,
                                                    struct t_irc_channel *channel,
                                                    const char *nickname,
@@ -93,6 +111,9 @@ extern void irc_nick_free_all (struct t_irc_server *server,
 extern struct t_irc_nick *irc_nick_search (struct t_irc_server *server,
                                            struct t_irc_channel *channel,
                                            const char *nickname);
+extern struct t_arraylist *irc_nick_search_channels (struct t_irc_server *server,
+                                                     const char *nickname,
+                                                     int with_private);
 extern int *irc_nick_count (struct t_irc_server *server,
                             struct t_irc_channel *channel, int *size);
 extern void irc_nick_set_away (struct t_irc_server *server,
@@ -204,6 +204,8 @@ irc_notify_new (struct t_irc_server *server, const char *nick, int check_away)
         new_notify->is_on_server = -1;
         new_notify->away_message = NULL;
         new_notify->ison_received = 0;
+        new_notify->whois_interval = 1;
+        new_notify->whois_countdown = 1;
 
         /* add notify to notify list on server */
         new_notify->prev_notify = server->last_notify;
@@ -705,6 +707,37 @@ irc_notify_display_is_on (struct t_irc_server *server,
         (is_on_server) ? IRC_COLOR_MESSAGE_JOIN : IRC_COLOR_MESSAGE_QUIT);
 }
 
+/*
+ * Schedules next WHOIS for a notify, after an answer to WHOIS has been
+ * received: if away status has changed, the nick is checked again on next
+ * call of whois timer, otherwise the interval is doubled (up to
+ * IRC_NOTIFY_WHOIS_MAX_INTERVAL), with a random jitter so that WHOIS of
+ * nicks are spread over timer calls.
+ */
+
+void
+irc_notify_whois_schedule (struct t_irc_notify *notify, int away_changed)
+{
+    if (!notify)
+        return;
+
+    if (away_changed)
+    {
+        notify->whois_interval = 1;
+    }
+    else
+    {
+        notify->whois_interval *= 2;
+        if (notify->whois_interval > IRC_NOTIFY_WHOIS_MAX_INTERVAL)
+            notify->whois_interval = IRC_NOTIFY_WHOIS_MAX_INTERVAL;
+        if (notify->whois_interval < 1)
+            notify->whois_interval = 1;
+    }
+
+    notify->whois_countdown = notify->whois_interval
+        - (rand () % ((notify->whois_interval / 4) + 1));
+}
+
 /*
  * Sets flag "is_on_server" for a notify and display message if user was not on
  * server.
@@ -727,25 +760,36 @@ irc_notify_set_is_on_server (struct t_irc_notify *notify, const char *host,
     irc_notify_send_signal (notify, (is_on_server) ? "join" : "quit", NULL);
 
     notify->is_on_server = is_on_server;
+
+    /* nick has joined: check away status on next call of whois timer */
+    if (is_on_server == 1)
+    {
+        notify->whois_interval = 1;
+        notify->whois_countdown = 1;
+    }
 }
 
 /*
  * Sets away message for a notify and display message if away status has
  * changed.
+ *
+ * Returns:
+ *   1: away message has changed
+ *   0: away message is unchanged
  */
 
-void
+int
 irc_notify_set_away_message (struct t_irc_notify *notify,
                              const char *away_message)
 {
     if (!notify)
-        return;
+        return 0;
 
     /* same away message, then do nothing */
     if ((!notify->away_message && !away_message)
         || (notify->away_message && away_message
             && (strcmp (notify->away_message, away_message) == 0)))
-        return;
+        return 0;
 
     if (!notify->away_message && away_message)
     {
@@ -794,6 +838,8 @@ irc_notify_set_away_message (struct t_irc_notify *notify,
 
     free (notify->away_message);
     notify->away_message = (away_message) ? strdup (away_message) : NULL;
+
+    return 1;
 }
 
 /*
@@ -808,7 +854,7 @@ irc_notify_hsignal_cb (const void *pointer, void *data, const char *signal,
     char **messages, **nicks_sent, **nicks_recv, *irc_cmd, *arguments;
     char *ptr_args, *pos;
     int i, j, num_messages, num_nicks_sent, num_nicks_recv, nick_was_sent;
-    int away_message_updated, no_such_nick;
+    int away_message_updated, no_such_nick, away_changed;
     struct t_irc_server *ptr_server;
     struct t_irc_notify *ptr_notify;
 
@@ -981,6 +1027,7 @@ irc_notify_hsignal_cb (const void *pointer, void *data, const char *signal,
         {
             away_message_updated = 0;
             no_such_nick = 0;
+            away_changed = 0;
             messages = weechat_string_split (
                 output,
                 "\n",
@@ -1026,7 +1073,11 @@ irc_notify_hsignal_cb (const void *pointer, void *data, const char *signal,
                             {
                                 pos++;
                                 /* nick is away */
-                                irc_notify_set_away_message (ptr_notify, pos);
+                                if (irc_notify_set_away_message (ptr_notify,
+                                                                 pos))
+                                {
+                                    away_changed = 1;
+                                }
                                 away_message_updated = 1;
                             }
                         }
@@ -1038,8 +1089,10 @@ irc_notify_hsignal_cb (const void *pointer, void *data, const char *signal,
             if (!away_message_updated && !no_such_nick)
             {
                 /* nick is back */
-                irc_notify_set_away_message (ptr_notify, NULL);
+                if (irc_notify_set_away_message (ptr_notify, NULL))
+                    away_changed = 1;
             }
+            irc_notify_whois_schedule (ptr_notify, away_changed);
         }
     }
 
@@ -1107,6 +1160,10 @@ irc_notify_timer_ison_cb (const void *pointer, void *data, int remaining_calls)
 
 /*
  * Timer called to send "whois" command to servers.
+ *
+ * WHOIS is not sent for nicks known to be offline (answer of ISON/MONITOR),
+ * and for other nicks it is sent only when their countdown has expired
+ * (see function irc_notify_whois_schedule).
  */
 
 int
@@ -1131,8 +1188,12 @@ irc_notify_timer_whois_cb (const void *pointer, void *data,
             {
                 ptr_next_notify = ptr_notify->next_notify;
 
-                if (ptr_notify->check_away)
+                if (ptr_notify->check_away
+                    && (ptr_notify->is_on_server != 0)
+                    && (--ptr_notify->whois_countdown <= 0))
                 {
+                    /* next WHOIS if no answer is received */
+                    ptr_notify->whois_countdown = ptr_notify->whois_interval;
                     /*
                      * redirect whois, and get only 2 messages:
                      * 301: away message
@@ -1177,6 +1238,8 @@ irc_notify_hdata_notify_cb (const void *pointer, void *data,
         WEECHAT_HDATA_VAR(struct t_irc_notify, is_on_server, INTEGER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_notify, away_message, STRING, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_notify, ison_received, INTEGER, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_notify, whois_interval, INTEGER, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_notify, whois_countdown, INTEGER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_notify, prev_notify, POINTER, 0, NULL, hdata_name);
         WEECHAT_HDATA_VAR(struct t_irc_notify, next_notify, POINTER, 0, NULL, hdata_name);
     }
@@ -1240,6 +1303,8 @@ irc_notify_print_log (struct t_irc_server *server)
         weechat_log_printf ("       is_on_server. . . . : %d", ptr_notify->is_on_server);
         weechat_log_printf ("       away_message. . . . : '%s'", ptr_notify->away_message);
         weechat_log_printf ("       ison_received . . . : %d", ptr_notify->ison_received);
+        weechat_log_printf ("       whois_interval. . . : %d", ptr_notify->whois_interval);
+        weechat_log_printf ("       whois_countdown . . : %d", ptr_notify->whois_countdown);
         weechat_log_printf ("       prev_notify . . . . : %p", ptr_notify->prev_notify);
         weechat_log_printf ("       next_notify . . . . : %p", ptr_notify->next_notify);
     }
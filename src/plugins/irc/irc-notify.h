@@ -20,6 +20,9 @@
 #ifndef WEECHAT_PLUGIN_IRC_NOTIFY_H
 #define WEECHAT_PLUGIN_IRC_NOTIFY_H
 
+/* max number of whois timer calls between two WHOIS for a nick (back-off) */
+#define IRC_NOTIFY_WHOIS_MAX_INTERVAL 8
+
 struct t_irc_server;
 
 struct t_irc_notify
@@ -38,6 +41,11 @@ struct t_irc_notify
                                        /* whois command)                    */
     /* internal stuff */
     int ison_received;                 /* used when receiving ison answer   */
+    int whois_interval;                /* number of whois timer calls       */
+                                       /* between two WHOIS (doubled when   */
+                                       /* away status is unchanged)         */
+    int whois_countdown;               /* whois timer calls before next     */
+                                       /* WHOIS (1 = on next call)          */
     struct t_irc_notify *prev_notify;  /* link to previous notify           */
     struct t_irc_notify *next_notify;  /* link to next notify               */
 };
@@ -60,6 +68,8 @@ extern void irc_notify_display_is_on (struct t_irc_server *server,
                                       const char *host,
                                       struct t_irc_notify *notify,
                                       int is_on_server);
+extern void irc_notify_whois_schedule (struct t_irc_notify *notify,
+                                       int away_changed);
 extern void irc_notify_set_is_on_server (struct t_irc_notify *notify,
                                          const char *host, int is_on_server);
 extern void irc_notify_free_all (struct t_irc_server *server);
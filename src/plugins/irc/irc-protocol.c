@@ -44,6 +44,7 @@
 #include "irc-batch.h"
 #include "irc-buffer.h"
 #include "irc-channel.h"
+#include "irc-chathistory.h"
 #include "irc-color.h"
 #include "irc-command.h"
 #include "irc-config.h"
@@ -445,12 +446,13 @@ irc_protocol_print_error_warning_msg (struct t_irc_protocol_ctxt *ctxt,
 
 IRC_PROTOCOL_CALLBACK(account)
 {
+    struct t_arraylist *channels;
     struct t_irc_channel *ptr_channel;
     struct t_irc_nick *ptr_nick;
     struct t_irc_channel_speaking *ptr_nick_speaking;
     const char *pos_account;
     char str_account[512];
-    int cap_account_notify, smart_filter;
+    int cap_account_notify, smart_filter, i, channels_count;
 
     IRC_PROTOCOL_MIN_PARAMS(1);
 
@@ -470,9 +472,12 @@ IRC_PROTOCOL_CALLBACK(account)
     cap_account_notify = weechat_hashtable_has_key (ctxt->server->cap_list,
                                                     "account-notify");
 
-    for (ptr_channel = ctxt->server->channels; ptr_channel;
-         ptr_channel = ptr_channel->next_channel)
+    channels = irc_nick_search_channels (ctxt->server, ctxt->nick, 1);
+    channels_count = weechat_arraylist_size (channels);
+    for (i = 0; i < channels_count; i++)
     {
+        ptr_channel = (struct t_irc_channel *)weechat_arraylist_get (channels, i);
+
         switch (ptr_channel->type)
         {
             case IRC_CHANNEL_TYPE_PRIVATE:
@@ -525,13 +530,14 @@ IRC_PROTOCOL_CALLBACK(account)
                             IRC_COLOR_MESSAGE_ACCOUNT,
                             (pos_account) ? str_account : NULL);
                     }
-                    free (ptr_nick->account);
-                    ptr_nick->account = (cap_account_notify && pos_account) ?
-                        strdup (pos_account) : NULL;
+                    irc_nick_set_account (
+                        ptr_nick,
+                        (cap_account_notify && pos_account) ? pos_account : NULL);
                 }
                 break;
         }
     }
+    weechat_arraylist_free (channels);
 
     return WEECHAT_RC_OK;
 }
@@ -637,15 +643,20 @@ IRC_PROTOCOL_CALLBACK(authenticate)
 
 IRC_PROTOCOL_CALLBACK(away)
 {
+    struct t_arraylist *channels;
     struct t_irc_channel *ptr_channel;
     struct t_irc_nick *ptr_nick;
+    int i, channels_count;
 
     IRC_PROTOCOL_MIN_PARAMS(0);
     IRC_PROTOCOL_CHECK_NICK;
 
-    for (ptr_channel = ctxt->server->channels; ptr_channel;
-         ptr_channel = ptr_channel->next_channel)
+    channels = irc_nick_search_channels (ctxt->server, ctxt->nick, 0);
+    channels_count = weechat_arraylist_size (channels);
+    for (i = 0; i < channels_count; i++)
     {
+        ptr_channel = (struct t_irc_channel *)weechat_arraylist_get (channels, i);
+
         ptr_nick = irc_nick_search (ctxt->server, ptr_channel, ctxt->nick);
         if (ptr_nick)
         {
@@ -653,6 +664,7 @@ IRC_PROTOCOL_CALLBACK(away)
                                (ctxt->num_params > 0));
         }
     }
+    weechat_arraylist_free (channels);
 
     return WEECHAT_RC_OK;
 }
@@ -1382,8 +1394,9 @@ IRC_PROTOCOL_CALLBACK(cap)
 
 IRC_PROTOCOL_CALLBACK(chghost)
 {
-    int length, smart_filter;
+    int length, smart_filter, i, channels_count;
     char *str_host, str_tags[512];
+    struct t_arraylist *channels;
     struct t_irc_channel *ptr_channel;
     struct t_irc_nick *ptr_nick;
     struct t_irc_channel_speaking *ptr_nick_speaking;
@@ -1406,9 +1419,12 @@ IRC_PROTOCOL_CALLBACK(chghost)
     if (ctxt->nick_is_me)
         irc_server_set_host (ctxt->server, str_host);
 
-    for (ptr_channel = ctxt->server->channels; ptr_channel;
-         ptr_channel = ptr_channel->next_channel)
+    channels = irc_nick_search_channels (ctxt->server, ctxt->nick, 1);
+    channels_count = weechat_arraylist_size (channels);
+    for (i = 0; i < channels_count; i++)
     {
+        ptr_channel = (struct t_irc_channel *)weechat_arraylist_get (channels, i);
+
         switch (ptr_channel->type)
         {
             case IRC_CHANNEL_TYPE_PRIVATE:
@@ -1478,6 +1494,7 @@ IRC_PROTOCOL_CALLBACK(chghost)
                 break;
         }
     }
+    weechat_arraylist_free (channels);
 
     free (str_host);
 
@@ -1626,12 +1643,23 @@ IRC_PROTOCOL_CALLBACK(generic_error)
 
 IRC_PROTOCOL_CALLBACK(fail)
 {
+    int i;
+
     IRC_PROTOCOL_MIN_PARAMS(2);
 
     irc_protocol_print_error_warning_msg (ctxt,
                                           weechat_prefix ("error"),
                                           _("Failure:"));
 
+    /* end of history fetch for the target (if it is in context) */
+    if (strcmp (ctxt->params[0], "CHATHISTORY") == 0)
+    {
+        for (i = 2; i < ctxt->num_params - 1; i++)
+        {
+            irc_chathistory_end (ctxt->server, ctxt->params[i]);
+        }
+    }
+
     return WEECHAT_RC_OK;
 }
 
@@ -2236,10 +2264,11 @@ IRC_PROTOCOL_CALLBACK(mode)
 
 IRC_PROTOCOL_CALLBACK(nick)
 {
+    struct t_arraylist *channels;
     struct t_irc_channel *ptr_channel, *ptr_channel_new_nick;
     struct t_irc_nick *ptr_nick, *ptr_nick_found;
     char *old_color, *new_color, str_tags[512];
-    int smart_filter;
+    int smart_filter, i, channels_count;
     struct t_irc_channel_speaking *ptr_nick_speaking;
 
     IRC_PROTOCOL_MIN_PARAMS(1);
@@ -2283,9 +2312,20 @@ IRC_PROTOCOL_CALLBACK(nick)
 
     ptr_channel_new_nick = irc_channel_search (ctxt->server, ctxt->params[0]);
 
-    for (ptr_channel = ctxt->server->channels; ptr_channel;
-         ptr_channel = ptr_channel->next_channel)
+    channels = irc_nick_search_channels (ctxt->server, ctxt->nick, 1);
+    if (channels
+        && ptr_channel_new_nick
+        && (ptr_channel_new_nick->type == IRC_CHANNEL_TYPE_PRIVATE)
+        && !weechat_arraylist_search (channels, ptr_channel_new_nick,
+                                      NULL, NULL))
+    {
+        weechat_arraylist_add (channels, ptr_channel_new_nick);
+    }
+    channels_count = weechat_arraylist_size (channels);
+    for (i = 0; i < channels_count; i++)
     {
+        ptr_channel = (struct t_irc_channel *)weechat_arraylist_get (channels, i);
+
         switch (ptr_channel->type)
         {
             case IRC_CHANNEL_TYPE_PRIVATE:
@@ -2434,6 +2474,7 @@ IRC_PROTOCOL_CALLBACK(nick)
                 break;
         }
     }
+    weechat_arraylist_free (channels);
 
     if (!ctxt->nick_is_me)
     {
@@ -3367,10 +3408,11 @@ end:
 IRC_PROTOCOL_CALLBACK(quit)
 {
     char *str_quit_msg;
+    struct t_arraylist *channels;
     struct t_irc_channel *ptr_channel;
     struct t_irc_nick *ptr_nick;
     struct t_irc_channel_speaking *ptr_nick_speaking;
-    int display_host;
+    int display_host, i, channels_count;
 
     IRC_PROTOCOL_MIN_PARAMS(0);
     IRC_PROTOCOL_CHECK_NICK;
@@ -3378,9 +3420,12 @@ IRC_PROTOCOL_CALLBACK(quit)
     str_quit_msg = (ctxt->num_params > 0) ?
         irc_protocol_string_params (ctxt->params, 0, ctxt->num_params - 1) : NULL;
 
-    for (ptr_channel = ctxt->server->channels; ptr_channel;
-         ptr_channel = ptr_channel->next_channel)
+    channels = irc_nick_search_channels (ctxt->server, ctxt->nick, 1);
+    channels_count = weechat_arraylist_size (channels);
+    for (i = 0; i < channels_count; i++)
     {
+        ptr_channel = (struct t_irc_channel *)weechat_arraylist_get (channels, i);
+
         if (weechat_config_boolean (irc_config_look_typing_status_nicks))
         {
             irc_typing_channel_set_nick (ptr_channel, ctxt->nick,
@@ -3482,6 +3527,7 @@ IRC_PROTOCOL_CALLBACK(quit)
                 irc_nick_free (ctxt->server, ptr_channel, ptr_nick);
         }
     }
+    weechat_arraylist_free (channels);
 
     free (str_quit_msg);
 
@@ -3498,7 +3544,8 @@ IRC_PROTOCOL_CALLBACK(quit)
 
 IRC_PROTOCOL_CALLBACK(setname)
 {
-    int setname_enabled, smart_filter;
+    int setname_enabled, smart_filter, i, channels_count;
+    struct t_arraylist *channels;
     struct t_irc_channel *ptr_channel;
     struct t_irc_nick *ptr_nick;
     struct t_irc_channel_speaking *ptr_nick_speaking;
@@ -3517,9 +3564,12 @@ IRC_PROTOCOL_CALLBACK(setname)
 
     setname_enabled = (weechat_hashtable_has_key (ctxt->server->cap_list, "setname"));
 
-    for (ptr_channel = ctxt->server->channels; ptr_channel;
-            ptr_channel = ptr_channel->next_channel)
+    channels = irc_nick_search_channels (ctxt->server, ctxt->nick, 1);
+    channels_count = weechat_arraylist_size (channels);
+    for (i = 0; i < channels_count; i++)
     {
+        ptr_channel = (struct t_irc_channel *)weechat_arraylist_get (channels, i);
+
         switch (ptr_channel->type)
         {
             case IRC_CHANNEL_TYPE_PRIVATE:
@@ -3581,13 +3631,13 @@ IRC_PROTOCOL_CALLBACK(setname)
                     }
                     if (setname_enabled)
                     {
-                        free (ptr_nick->realname);
-                        ptr_nick->realname = strdup (str_realname);
+                        irc_nick_set_realname (ptr_nick, str_realname);
                     }
                 }
                 break;
         }
     }
+    weechat_arraylist_free (channels);
 
     if (!ctxt->ignore_remove && ctxt->nick_is_me)
     {
@@ -4098,8 +4148,12 @@ IRC_PROTOCOL_CALLBACK(005)
         {
             /* save casemapping */
             casemapping = irc_server_search_casemapping (ctxt->params[i] + 12);
-            if (casemapping >= 0)
+            if ((casemapping >= 0)
+                && (casemapping != ctxt->server->casemapping))
+            {
                 ctxt->server->casemapping = casemapping;
+                irc_nick_hash_rebuild (ctxt->server);
+            }
         }
         else if (strncmp (ctxt->params[i], "UTF8MAPPING=", 12) == 0)
         {
@@ -4806,7 +4860,8 @@ IRC_PROTOCOL_CALLBACK(322)
     IRC_PROTOCOL_MIN_PARAMS(3);
 
     if (!ctxt->server->cmd_list_regexp ||
-        (regexec (ctxt->server->cmd_list_regexp, ctxt->params[1], 0, NULL, 0) == 0))
+        (weechat_string_regexec (ctxt->server->cmd_list_regexp,
+                                 ctxt->params[1], 0, NULL, 0) == 0))
     {
         str_topic = irc_protocol_string_params (ctxt->params, 3, ctxt->num_params - 1);
         weechat_printf_datetime_tags (
@@ -6095,8 +6150,7 @@ IRC_PROTOCOL_CALLBACK(352)
     /* update realname in nick */
     if (ptr_channel && ptr_nick && str_realname)
     {
-        free (ptr_nick->realname);
-        ptr_nick->realname = strdup (str_realname);
+        irc_nick_set_realname (ptr_nick, str_realname);
     }
 
     /* display output of who (manual who from user) */
@@ -6187,6 +6241,13 @@ IRC_PROTOCOL_CALLBACK(353)
      */
     str_nicks = (ptr_channel) ? NULL : weechat_string_dyn_alloc (1024);
 
+    /*
+     * when joining the channel, nicks are added in nicklist at once, at the
+     * end of names (366)
+     */
+    if (ptr_channel && ptr_channel->nicks)
+        irc_channel_nicklist_names_start (ctxt->server, ptr_channel);
+
     for (i = 0; i < num_nicks; i++)
     {
         /* skip and save prefix(es) */
@@ -6369,24 +6430,20 @@ IRC_PROTOCOL_CALLBACK(354)
     /* update account in nick */
     if (ptr_nick)
     {
-        free (ptr_nick->account);
-        if (ptr_channel
-            && weechat_hashtable_has_key (ctxt->server->cap_list, "account-notify"))
-        {
-            ptr_nick->account = strdup (ctxt->params[8]);
-        }
-        else
-        {
-            ptr_nick->account = NULL;
-        }
+        irc_nick_set_account (
+            ptr_nick,
+            (ptr_channel
+             && weechat_hashtable_has_key (ctxt->server->cap_list,
+                                           "account-notify")) ?
+            ctxt->params[8] : NULL);
     }
 
     /* update realname in nick */
     if (ptr_nick)
     {
-        free (ptr_nick->realname);
-        ptr_nick->realname = (ptr_channel && (ctxt->num_params >= 10)) ?
-            strdup (ctxt->params[9]) : NULL;
+        irc_nick_set_realname (
+            ptr_nick,
+            (ptr_channel && (ctxt->num_params >= 10)) ? ctxt->params[9] : NULL);
     }
 
     /* display output of who (manual who from user) */
@@ -6656,6 +6713,9 @@ IRC_PROTOCOL_CALLBACK(366)
 
     ptr_channel = irc_channel_search (ctxt->server, ctxt->params[1]);
 
+    /* add nicks received in names (353) in nicklist */
+    irc_channel_nicklist_names_end (ctxt->server, ptr_channel);
+
     if (ptr_channel && ptr_channel->nicks)
     {
         /* check if a filter was given to /names command */
@@ -6742,12 +6802,16 @@ IRC_PROTOCOL_CALLBACK(366)
             free (channel_name_lower);
         }
 
-        if (!weechat_hashtable_has_key (ptr_channel->join_msg_received, ctxt->command))
+        if (!weechat_hashtable_has_key (ptr_channel->join_msg_received, ctxt->command)
+            && !irc_server_join_burst_defer_check (ctxt->server, ptr_channel))
         {
             irc_command_mode_server (ctxt->server, "MODE", ptr_channel, NULL,
                                      IRC_SERVER_SEND_OUTQ_PRIO_LOW);
             irc_channel_check_whox (ctxt->server, ptr_channel);
         }
+
+        /* fetch history of channel (with capability draft/chathistory) */
+        irc_chathistory_channel_joined (ctxt->server, ptr_channel);
     }
     else
     {
@@ -7918,6 +7982,293 @@ IRC_PROTOCOL_CALLBACK(sasl_end_fail)
     return WEECHAT_RC_OK;
 }
 
+/*
+ * IRC messages received and functions called (commands are named commands in
+ * lower case or 3-digit numeric commands).
+ */
+
+struct t_irc_protocol_msg irc_protocol_messages[] = {
+    /* format: "command", decode_color, keep_trailing_spaces, func_cb       */
+    IRCB(account, 1, 0, account),        /* account (cap "account-notify")  */
+    IRCB(authenticate, 1, 0, authenticate), /* authenticate                 */
+    IRCB(away, 1, 0, away),              /* away (cap "away-notify")        */
+    IRCB(batch, 1, 0, batch),            /* batch (cap "batch")             */
+    IRCB(cap, 1, 0, cap),                /* client capability               */
+    IRCB(chghost, 1, 0, chghost),        /* user/host change (cap "chghost")*/
+    IRCB(error, 1, 0, error),            /* error received from server      */
+    IRCB(fail, 1, 0, fail),              /* error received from server      */
+    IRCB(invite, 1, 0, invite),          /* invite a nick on a channel      */
+    IRCB(join, 1, 0, join),              /* join a channel                  */
+    IRCB(kick, 1, 1, kick),              /* kick a user                     */
+    IRCB(kill, 1, 1, kill),              /* close client-server connection  */
+    IRCB(mode, 1, 0, mode),              /* change channel or user mode     */
+    IRCB(nick, 1, 0, nick),              /* change current nickname         */
+    IRCB(note, 1, 0, note),              /* note received from server       */
+    IRCB(notice, 1, 1, notice),          /* send notice message to user     */
+    IRCB(part, 1, 1, part),              /* leave a channel                 */
+    IRCB(ping, 1, 0, ping),              /* ping server                     */
+    IRCB(pong, 1, 0, pong),              /* answer to a ping message        */
+    IRCB(privmsg, 1, 1, privmsg),        /* message received                */
+    IRCB(quit, 1, 1, quit),              /* close all connections and quit  */
+    IRCB(setname, 0, 1, setname),        /* set realname                    */
+    IRCB(tagmsg, 0, 0, tagmsg),          /* tag message                     */
+    IRCB(topic, 0, 1, topic),            /* get/set channel topic           */
+    IRCB(wallops, 1, 1, wallops),        /* wallops                         */
+    IRCB(warn, 1, 0, warn),              /* warning received from server    */
+    IRCB(001, 1, 0, 001),                /* a server message                */
+    IRCB(005, 1, 0, 005),                /* a server message                */
+    IRCB(008, 1, 0, 008),                /* server notice mask              */
+    IRCB(221, 1, 0, 221),                /* user mode string                */
+    IRCB(223, 1, 0, whois_nick_msg), /* whois (charset is)                  */
+    IRCB(264, 1, 0, whois_nick_msg), /* whois (encrypted connection)        */
+    IRCB(275, 1, 0, whois_nick_msg), /* whois (secure connection)           */
+    IRCB(276, 1, 0, whois_nick_msg), /* whois (client cert. fingerprint)    */
+    IRCB(301, 1, 1, 301),                /* away message                    */
+    IRCB(303, 1, 0, 303),                /* ison                            */
+    IRCB(305, 1, 0, 305),                /* unaway                          */
+    IRCB(306, 1, 0, 306),                /* now away                        */
+    IRCB(307, 1, 0, whois_nick_msg), /* whois (registered nick)             */
+    IRCB(310, 1, 0, whois_nick_msg), /* whois (help mode)                   */
+    IRCB(311, 1, 0, 311),                /* whois (user)                    */
+    IRCB(312, 1, 0, 312),                /* whois (server)                  */
+    IRCB(313, 1, 0, whois_nick_msg), /* whois (operator)                    */
+    IRCB(314, 1, 0, 314),                /* whowas                          */
+    IRCB(315, 1, 0, 315),                /* end of /who list                */
+    IRCB(317, 1, 0, 317),                /* whois (idle)                    */
+    IRCB(318, 1, 0, whois_nick_msg), /* whois (end)                         */
+    IRCB(319, 1, 0, whois_nick_msg), /* whois (channels)                    */
+    IRCB(320, 1, 0, whois_nick_msg), /* whois (identified user)             */
+    IRCB(321, 1, 0, 321),                /* /list start                     */
+    IRCB(322, 1, 1, 322),                /* channel (for /list)             */
+    IRCB(323, 1, 0, 323),                /* end of /list                    */
+    IRCB(324, 1, 0, 324),                /* channel mode                    */
+    IRCB(326, 1, 0, whois_nick_msg), /* whois (has oper privs)              */
+    IRCB(327, 1, 0, 327),                /* whois (host)                    */
+    IRCB(328, 1, 0, 328),                /* channel URL                     */
+    IRCB(329, 1, 0, 329),                /* channel creation date           */
+    IRCB(330, 1, 0, 330_343),            /* is logged in as                 */
+    IRCB(331, 1, 0, 331),                /* no topic for channel            */
+    IRCB(332, 0, 1, 332),                /* topic of channel                */
+    IRCB(333, 1, 0, 333),                /* topic info (nick/date)          */
+    IRCB(335, 1, 0, whois_nick_msg), /* whois (is a bot on)                 */
+    IRCB(337, 1, 0, whois_nick_msg), /* whois (is hiding idle time)         */
+    IRCB(338, 1, 0, 338),                /* whois (host)                    */
+    IRCB(341, 1, 0, 341),                /* inviting                        */
+    IRCB(343, 1, 0, 330_343),            /* is opered as                    */
+    IRCB(344, 1, 0, 344),                /* channel reop / whois (geo info) */
+    IRCB(345, 1, 0, 345),                /* end of channel reop list        */
+    IRCB(346, 1, 0, 346),                /* invite list                     */
+    IRCB(347, 1, 0, 347),                /* end of invite list              */
+    IRCB(348, 1, 0, 348),                /* channel exception list          */
+    IRCB(349, 1, 0, 349),                /* end of channel exception list   */
+    IRCB(350, 1, 0, 350),                /* whois (gateway)                 */
+    IRCB(351, 1, 0, 351),                /* server version                  */
+    IRCB(352, 1, 0, 352),                /* who                             */
+    IRCB(353, 1, 0, 353),                /* list of nicks on channel        */
+    IRCB(354, 1, 0, 354),                /* whox                            */
+    IRCB(366, 1, 0, 366),                /* end of /names list              */
+    IRCB(367, 1, 0, 367),                /* banlist                         */
+    IRCB(368, 1, 0, 368),                /* end of banlist                  */
+    IRCB(369, 1, 0, whowas_nick_msg), /* whowas (end)                       */
+    IRCB(378, 1, 0, whois_nick_msg), /* whois (connecting from)             */
+    IRCB(379, 1, 0, whois_nick_msg), /* whois (using modes)                 */
+    IRCB(401, 1, 0, generic_error),      /* no such nick/channel            */
+    IRCB(402, 1, 0, generic_error),      /* no such server                  */
+    IRCB(403, 1, 0, generic_error),      /* no such channel                 */
+    IRCB(404, 1, 0, generic_error),      /* cannot send to channel          */
+    IRCB(405, 1, 0, generic_error),      /* too many channels               */
+    IRCB(406, 1, 0, generic_error),      /* was no such nick                */
+    IRCB(407, 1, 0, generic_error),      /* was no such nick                */
+    IRCB(409, 1, 0, generic_error),      /* no origin                       */
+    IRCB(410, 1, 0, generic_error),      /* no services                     */
+    IRCB(411, 1, 0, generic_error),      /* no recipient                    */
+    IRCB(412, 1, 0, generic_error),      /* no text to send                 */
+    IRCB(413, 1, 0, generic_error),      /* no toplevel                     */
+    IRCB(414, 1, 0, generic_error),      /* wilcard in toplevel domain      */
+    IRCB(415, 1, 0, generic_error),      /* cannot send message to channel  */
+    IRCB(421, 1, 0, generic_error),      /* unknown command                 */
+    IRCB(422, 1, 0, generic_error),      /* MOTD is missing                 */
+    IRCB(423, 1, 0, generic_error),      /* no administrative info          */
+    IRCB(424, 1, 0, generic_error),      /* file error                      */
+    IRCB(431, 1, 0, generic_error),      /* no nickname given               */
+    IRCB(432, 1, 0, 432),                /* erroneous nickname              */
+    IRCB(433, 1, 0, 433),                /* nickname already in use         */
+    IRCB(436, 1, 0, generic_error),      /* nickname collision              */
+    IRCB(437, 1, 0, 437),                /* nick/channel unavailable        */
+    IRCB(438, 1, 0, 438),                /* not auth. to change nickname    */
+    IRCB(441, 1, 0, generic_error),      /* user not in channel             */
+    IRCB(442, 1, 0, generic_error),      /* not on channel                  */
+    IRCB(443, 1, 0, generic_error),      /* user already on channel         */
+    IRCB(444, 1, 0, generic_error),      /* user not logged in              */
+    IRCB(445, 1, 0, generic_error),      /* summon has been disabled        */
+    IRCB(446, 1, 0, generic_error),      /* users has been disabled         */
+    IRCB(451, 1, 0, generic_error),      /* you are not registered          */
+    IRCB(461, 1, 0, generic_error),      /* not enough parameters           */
+    IRCB(462, 1, 0, generic_error),      /* you may not register            */
+    IRCB(463, 1, 0, generic_error),      /* host not privileged             */
+    IRCB(464, 1, 0, generic_error),      /* password incorrect              */
+    IRCB(465, 1, 0, generic_error),      /* banned from this server         */
+    IRCB(467, 1, 0, generic_error),      /* channel key already set         */
+    IRCB(470, 1, 0, 470),                /* forwarding to another channel   */
+    IRCB(471, 1, 0, generic_error),      /* channel is already full         */
+    IRCB(472, 1, 0, generic_error),      /* unknown mode char to me         */
+    IRCB(473, 1, 0, generic_error),      /* cannot join (invite only)       */
+    IRCB(474, 1, 0, generic_error),      /* cannot join (banned)            */
+    IRCB(475, 1, 0, generic_error),      /* cannot join (bad key)           */
+    IRCB(476, 1, 0, generic_error),      /* bad channel mask                */
+    IRCB(477, 1, 0, generic_error),      /* channel doesn't support modes   */
+    IRCB(481, 1, 0, generic_error),      /* you're not an IRC operator      */
+    IRCB(482, 1, 0, generic_error),      /* you're not channel operator     */
+    IRCB(483, 1, 0, generic_error),      /* you can't kill a server!        */
+    IRCB(484, 1, 0, generic_error),      /* your connection is restricted!  */
+    IRCB(485, 1, 0, generic_error),      /* user immune from kick/deop      */
+    IRCB(487, 1, 0, generic_error),      /* network split                   */
+    IRCB(491, 1, 0, generic_error),      /* no O-lines for your host        */
+    IRCB(501, 1, 0, generic_error),      /* unknown mode flag               */
+    IRCB(502, 1, 0, generic_error),      /* can't chg mode for other users  */
+    IRCB(524, 1, 0, help),               /* HELP/HELPOP (help not found)    */
+    IRCB(671, 1, 0, whois_nick_msg), /* whois (secure connection)           */
+    IRCB(704, 1, 0, help),               /* start of HELP/HELPOP            */
+    IRCB(705, 1, 0, help),               /* body of HELP/HELPOP             */
+    IRCB(706, 1, 0, help),               /* end of HELP/HELPOP              */
+    IRCB(710, 1, 0, 710),                /* knock: has asked for an invite  */
+    IRCB(711, 1, 0, knock_reply),        /* knock: has been delivered       */
+    IRCB(712, 1, 0, knock_reply),        /* knock: too many knocks          */
+    IRCB(713, 1, 0, knock_reply),        /* knock: channel is open          */
+    IRCB(714, 1, 0, knock_reply),        /* knock: already on that channel  */
+    IRCB(716, 1, 0, generic_error),      /* nick is in +g mode              */
+    IRCB(717, 1, 0, generic_error),      /* nick has been informed of msg   */
+    IRCB(728, 1, 0, 728),                /* quietlist                       */
+    IRCB(729, 1, 0, 729),                /* end of quietlist                */
+    IRCB(730, 1, 0, 730),                /* monitored nicks online          */
+    IRCB(731, 1, 0, 731),                /* monitored nicks offline         */
+    IRCB(732, 1, 0, 732),                /* list of monitored nicks         */
+    IRCB(733, 1, 0, 733),                /* end of monitor list             */
+    IRCB(734, 1, 0, 734),                /* monitor list is full            */
+    IRCB(742, 1, 0, generic_error),      /* mode cannot be set              */
+    IRCB(900, 1, 0, 900),                /* logged in as (SASL)             */
+    IRCB(901, 1, 0, 901),                /* you are now logged out          */
+    IRCB(902, 1, 0, sasl_end_fail),      /* SASL auth failed (acc. locked)  */
+    IRCB(903, 1, 0, sasl_end_ok),        /* SASL auth successful            */
+    IRCB(904, 1, 0, sasl_end_fail),      /* SASL auth failed                */
+    IRCB(905, 1, 0, sasl_end_fail),      /* SASL message too long           */
+    IRCB(906, 1, 0, sasl_end_fail),      /* SASL authentication aborted     */
+    IRCB(907, 1, 0, sasl_end_ok),        /* already completed SASL auth     */
+    IRCB(936, 1, 0, generic_error),      /* censored word                   */
+    IRCB(973, 1, 0, server_mode_reason), /* whois (secure conn.)            */
+    IRCB(974, 1, 0, server_mode_reason), /* whois (secure conn.)            */
+    IRCB(975, 1, 0, server_mode_reason), /* whois (secure conn.)            */
+};
+
+#define IRC_PROTOCOL_NUM_MESSAGES                                       \
+    ((int)(sizeof (irc_protocol_messages) / sizeof (irc_protocol_messages[0])))
+
+/*
+ * indexes of messages (built on first search): numeric commands are directly
+ * indexed by their number, named commands are chained by first letter
+ */
+
+int irc_protocol_messages_indexed = 0;
+short irc_protocol_messages_numeric[1000];
+short irc_protocol_messages_letter[26];
+short irc_protocol_messages_next[IRC_PROTOCOL_NUM_MESSAGES];
+
+/*
+ * Builds indexes of IRC messages.
+ */
+
+void
+irc_protocol_build_messages_index ()
+{
+    const char *name;
+    int i, letter, number, last_of_letter[26];
+
+    for (i = 0; i < 1000; i++)
+    {
+        irc_protocol_messages_numeric[i] = -1;
+    }
+    for (i = 0; i < 26; i++)
+    {
+        irc_protocol_messages_letter[i] = -1;
+        last_of_letter[i] = -1;
+    }
+
+    for (i = 0; i < IRC_PROTOCOL_NUM_MESSAGES; i++)
+    {
+        irc_protocol_messages_next[i] = -1;
+        name = irc_protocol_messages[i].name;
+        if (isdigit ((unsigned char)name[0]))
+        {
+            number = atoi (name);
+            if ((number >= 0) && (number < 1000)
+                && (irc_protocol_messages_numeric[number] < 0))
+            {
+                irc_protocol_messages_numeric[number] = i;
+            }
+        }
+        else if ((name[0] >= 'a') && (name[0] <= 'z'))
+        {
+            letter = name[0] - 'a';
+            if (last_of_letter[letter] < 0)
+                irc_protocol_messages_letter[letter] = i;
+            else
+                irc_protocol_messages_next[last_of_letter[letter]] = i;
+            last_of_letter[letter] = i;
+        }
+    }
+
+    irc_protocol_messages_indexed = 1;
+}
+
+/*
+ * Searches an IRC message by command (case insensitive).
+ *
+ * Returns pointer to message found, NULL if not found.
+ */
+
+struct t_irc_protocol_msg *
+irc_protocol_search_message (const char *command)
+{
+    int index, letter;
+
+    if (!command || !command[0])
+        return NULL;
+
+    if (!irc_protocol_messages_indexed)
+        irc_protocol_build_messages_index ();
+
+    /* numeric command with 3 digits: direct access */
+    if (isdigit ((unsigned char)command[0]))
+    {
+        if (!isdigit ((unsigned char)command[1])
+            || !isdigit ((unsigned char)command[2])
+            || command[3])
+        {
+            return NULL;
+        }
+        index = irc_protocol_messages_numeric[((command[0] - '0') * 100)
+                                              + ((command[1] - '0') * 10)
+                                              + (command[2] - '0')];
+        return (index >= 0) ? &irc_protocol_messages[index] : NULL;
+    }
+
+    /* named command: check only commands with same first letter */
+    letter = tolower ((unsigned char)command[0]);
+    if ((letter < 'a') || (letter > 'z'))
+        return NULL;
+    for (index = irc_protocol_messages_letter[letter - 'a']; index >= 0;
+         index = irc_protocol_messages_next[index])
+    {
+        if (weechat_strcasecmp (irc_protocol_messages[index].name,
+                                command) == 0)
+        {
+            return &irc_protocol_messages[index];
+        }
+    }
+
+    return NULL;
+}
+
 /*
  * Executes action when an IRC command is received.
  *
@@ -7937,8 +8288,10 @@ irc_protocol_recv_command (struct t_irc_server *server,
                            const char *msg_channel,
                            int ignore_batch_tag)
 {
-    int i, cmd_found, return_code, decode_color, keep_trailing_spaces, ignored;
+    int return_code, decode_color, keep_trailing_spaces, ignored;
     char *message_colors_decoded, *pos_space, *tags;
+    struct t_irc_protocol_msg *ptr_message;
+    struct t_irc_message_spans spans;
     struct t_irc_channel *ptr_channel;
     t_irc_recv_func *cmd_recv_func;
     const char *ptr_msg_after_tags, *ptr_batch_ref, *ptr_tag_time;
@@ -7947,180 +8300,6 @@ irc_protocol_recv_command (struct t_irc_server *server,
     struct t_irc_protocol_ctxt ctxt;
     struct timeval tv;
 
-    struct t_irc_protocol_msg irc_protocol_messages[] = {
-        /* format: "command", decode_color, keep_trailing_spaces, func_cb   */
-        IRCB(account, 1, 0, account),    /* account (cap "account-notify")  */
-        IRCB(authenticate, 1, 0, authenticate), /* authenticate             */
-        IRCB(away, 1, 0, away),          /* away (cap "away-notify")        */
-        IRCB(batch, 1, 0, batch),        /* batch (cap "batch")             */
-        IRCB(cap, 1, 0, cap),            /* client capability               */
-        IRCB(chghost, 1, 0, chghost),    /* user/host change (cap "chghost")*/
-        IRCB(error, 1, 0, error),        /* error received from server      */
-        IRCB(fail, 1, 0, fail),          /* error received from server      */
-        IRCB(invite, 1, 0, invite),      /* invite a nick on a channel      */
-        IRCB(join, 1, 0, join),          /* join a channel                  */
-        IRCB(kick, 1, 1, kick),          /* kick a user                     */
-        IRCB(kill, 1, 1, kill),          /* close client-server connection  */
-        IRCB(mode, 1, 0, mode),          /* change channel or user mode     */
-        IRCB(nick, 1, 0, nick),          /* change current nickname         */
-        IRCB(note, 1, 0, note),          /* note received from server       */
-        IRCB(notice, 1, 1, notice),      /* send notice message to user     */
-        IRCB(part, 1, 1, part),          /* leave a channel                 */
-        IRCB(ping, 1, 0, ping),          /* ping server                     */
-        IRCB(pong, 1, 0, pong),          /* answer to a ping message        */
-        IRCB(privmsg, 1, 1, privmsg),    /* message received                */
-        IRCB(quit, 1, 1, quit),          /* close all connections and quit  */
-        IRCB(setname, 0, 1, setname),    /* set realname                    */
-        IRCB(tagmsg, 0, 0, tagmsg),      /* tag message                     */
-        IRCB(topic, 0, 1, topic),        /* get/set channel topic           */
-        IRCB(wallops, 1, 1, wallops),    /* wallops                         */
-        IRCB(warn, 1, 0, warn),          /* warning received from server    */
-        IRCB(001, 1, 0, 001),            /* a server message                */
-        IRCB(005, 1, 0, 005),            /* a server message                */
-        IRCB(008, 1, 0, 008),            /* server notice mask              */
-        IRCB(221, 1, 0, 221),            /* user mode string                */
-        IRCB(223, 1, 0, whois_nick_msg), /* whois (charset is)              */
-        IRCB(264, 1, 0, whois_nick_msg), /* whois (encrypted connection)    */
-        IRCB(275, 1, 0, whois_nick_msg), /* whois (secure connection)       */
-        IRCB(276, 1, 0, whois_nick_msg), /* whois (client cert. fingerprint)*/
-        IRCB(301, 1, 1, 301),            /* away message                    */
-        IRCB(303, 1, 0, 303),            /* ison                            */
-        IRCB(305, 1, 0, 305),            /* unaway                          */
-        IRCB(306, 1, 0, 306),            /* now away                        */
-        IRCB(307, 1, 0, whois_nick_msg), /* whois (registered nick)         */
-        IRCB(310, 1, 0, whois_nick_msg), /* whois (help mode)               */
-        IRCB(311, 1, 0, 311),            /* whois (user)                    */
-        IRCB(312, 1, 0, 312),            /* whois (server)                  */
-        IRCB(313, 1, 0, whois_nick_msg), /* whois (operator)                */
-        IRCB(314, 1, 0, 314),            /* whowas                          */
-        IRCB(315, 1, 0, 315),            /* end of /who list                */
-        IRCB(317, 1, 0, 317),            /* whois (idle)                    */
-        IRCB(318, 1, 0, whois_nick_msg), /* whois (end)                     */
-        IRCB(319, 1, 0, whois_nick_msg), /* whois (channels)                */
-        IRCB(320, 1, 0, whois_nick_msg), /* whois (identified user)         */
-        IRCB(321, 1, 0, 321),            /* /list start                     */
-        IRCB(322, 1, 1, 322),            /* channel (for /list)             */
-        IRCB(323, 1, 0, 323),            /* end of /list                    */
-        IRCB(324, 1, 0, 324),            /* channel mode                    */
-        IRCB(326, 1, 0, whois_nick_msg), /* whois (has oper privs)          */
-        IRCB(327, 1, 0, 327),            /* whois (host)                    */
-        IRCB(328, 1, 0, 328),            /* channel URL                     */
-        IRCB(329, 1, 0, 329),            /* channel creation date           */
-        IRCB(330, 1, 0, 330_343),        /* is logged in as                 */
-        IRCB(331, 1, 0, 331),            /* no topic for channel            */
-        IRCB(332, 0, 1, 332),            /* topic of channel                */
-        IRCB(333, 1, 0, 333),            /* topic info (nick/date)          */
-        IRCB(335, 1, 0, whois_nick_msg), /* whois (is a bot on)             */
-        IRCB(337, 1, 0, whois_nick_msg), /* whois (is hiding idle time)     */
-        IRCB(338, 1, 0, 338),            /* whois (host)                    */
-        IRCB(341, 1, 0, 341),            /* inviting                        */
-        IRCB(343, 1, 0, 330_343),        /* is opered as                    */
-        IRCB(344, 1, 0, 344),            /* channel reop / whois (geo info) */
-        IRCB(345, 1, 0, 345),            /* end of channel reop list        */
-        IRCB(346, 1, 0, 346),            /* invite list                     */
-        IRCB(347, 1, 0, 347),            /* end of invite list              */
-        IRCB(348, 1, 0, 348),            /* channel exception list          */
-        IRCB(349, 1, 0, 349),            /* end of channel exception list   */
-        IRCB(350, 1, 0, 350),            /* whois (gateway)                 */
-        IRCB(351, 1, 0, 351),            /* server version                  */
-        IRCB(352, 1, 0, 352),            /* who                             */
-        IRCB(353, 1, 0, 353),            /* list of nicks on channel        */
-        IRCB(354, 1, 0, 354),            /* whox                            */
-        IRCB(366, 1, 0, 366),            /* end of /names list              */
-        IRCB(367, 1, 0, 367),            /* banlist                         */
-        IRCB(368, 1, 0, 368),            /* end of banlist                  */
-        IRCB(369, 1, 0, whowas_nick_msg), /* whowas (end)                   */
-        IRCB(378, 1, 0, whois_nick_msg), /* whois (connecting from)         */
-        IRCB(379, 1, 0, whois_nick_msg), /* whois (using modes)             */
-        IRCB(401, 1, 0, generic_error),  /* no such nick/channel            */
-        IRCB(402, 1, 0, generic_error),  /* no such server                  */
-        IRCB(403, 1, 0, generic_error),  /* no such channel                 */
-        IRCB(404, 1, 0, generic_error),  /* cannot send to channel          */
-        IRCB(405, 1, 0, generic_error),  /* too many channels               */
-        IRCB(406, 1, 0, generic_error),  /* was no such nick                */
-        IRCB(407, 1, 0, generic_error),  /* was no such nick                */
-        IRCB(409, 1, 0, generic_error),  /* no origin                       */
-        IRCB(410, 1, 0, generic_error),  /* no services                     */
-        IRCB(411, 1, 0, generic_error),  /* no recipient                    */
-        IRCB(412, 1, 0, generic_error),  /* no text to send                 */
-        IRCB(413, 1, 0, generic_error),  /* no toplevel                     */
-        IRCB(414, 1, 0, generic_error),  /* wilcard in toplevel domain      */
-        IRCB(415, 1, 0, generic_error),  /* cannot send message to channel  */
-        IRCB(421, 1, 0, generic_error),  /* unknown command                 */
-        IRCB(422, 1, 0, generic_error),  /* MOTD is missing                 */
-        IRCB(423, 1, 0, generic_error),  /* no administrative info          */
-        IRCB(424, 1, 0, generic_error),  /* file error                      */
-        IRCB(431, 1, 0, generic_error),  /* no nickname given               */
-        IRCB(432, 1, 0, 432),            /* erroneous nickname              */
-        IRCB(433, 1, 0, 433),            /* nickname already in use         */
-        IRCB(436, 1, 0, generic_error),  /* nickname collision              */
-        IRCB(437, 1, 0, 437),            /* nick/channel unavailable        */
-        IRCB(438, 1, 0, 438),            /* not auth. to change nickname    */
-        IRCB(441, 1, 0, generic_error),  /* user not in channel             */
-        IRCB(442, 1, 0, generic_error),  /* not on channel                  */
-        IRCB(443, 1, 0, generic_error),  /* user already on channel         */
-        IRCB(444, 1, 0, generic_error),  /* user not logged in              */
-        IRCB(445, 1, 0, generic_error),  /* summon has been disabled        */
-        IRCB(446, 1, 0, generic_error),  /* users has been disabled         */
-        IRCB(451, 1, 0, generic_error),  /* you are not registered          */
-        IRCB(461, 1, 0, generic_error),  /* not enough parameters           */
-        IRCB(462, 1, 0, generic_error),  /* you may not register            */
-        IRCB(463, 1, 0, generic_error),  /* host not privileged             */
-        IRCB(464, 1, 0, generic_error),  /* password incorrect              */
-        IRCB(465, 1, 0, generic_error),  /* banned from this server         */
-        IRCB(467, 1, 0, generic_error),  /* channel key already set         */
-        IRCB(470, 1, 0, 470),            /* forwarding to another channel   */
-        IRCB(471, 1, 0, generic_error),  /* channel is already full         */
-        IRCB(472, 1, 0, generic_error),  /* unknown mode char to me         */
-        IRCB(473, 1, 0, generic_error),  /* cannot join (invite only)       */
-        IRCB(474, 1, 0, generic_error),  /* cannot join (banned)            */
-        IRCB(475, 1, 0, generic_error),  /* cannot join (bad key)           */
-        IRCB(476, 1, 0, generic_error),  /* bad channel mask                */
-        IRCB(477, 1, 0, generic_error),  /* channel doesn't support modes   */
-        IRCB(481, 1, 0, generic_error),  /* you're not an IRC operator      */
-        IRCB(482, 1, 0, generic_error),  /* you're not channel operator     */
-        IRCB(483, 1, 0, generic_error),  /* you can't kill a server!        */
-        IRCB(484, 1, 0, generic_error),  /* your connection is restricted!  */
-        IRCB(485, 1, 0, generic_error),  /* user immune from kick/deop      */
-        IRCB(487, 1, 0, generic_error),  /* network split                   */
-        IRCB(491, 1, 0, generic_error),  /* no O-lines for your host        */
-        IRCB(501, 1, 0, generic_error),  /* unknown mode flag               */
-        IRCB(502, 1, 0, generic_error),  /* can't chg mode for other users  */
-        IRCB(524, 1, 0, help),           /* HELP/HELPOP (help not found)    */
-        IRCB(671, 1, 0, whois_nick_msg), /* whois (secure connection)       */
-        IRCB(704, 1, 0, help),           /* start of HELP/HELPOP            */
-        IRCB(705, 1, 0, help),           /* body of HELP/HELPOP             */
-        IRCB(706, 1, 0, help),           /* end of HELP/HELPOP              */
-        IRCB(710, 1, 0, 710),            /* knock: has asked for an invite  */
-        IRCB(711, 1, 0, knock_reply),    /* knock: has been delivered       */
-        IRCB(712, 1, 0, knock_reply),    /* knock: too many knocks          */
-        IRCB(713, 1, 0, knock_reply),    /* knock: channel is open          */
-        IRCB(714, 1, 0, knock_reply),    /* knock: already on that channel  */
-        IRCB(716, 1, 0, generic_error),  /* nick is in +g mode              */
-        IRCB(717, 1, 0, generic_error),  /* nick has been informed of msg   */
-        IRCB(728, 1, 0, 728),            /* quietlist                       */
-        IRCB(729, 1, 0, 729),            /* end of quietlist                */
-        IRCB(730, 1, 0, 730),            /* monitored nicks online          */
-        IRCB(731, 1, 0, 731),            /* monitored nicks offline         */
-        IRCB(732, 1, 0, 732),            /* list of monitored nicks         */
-        IRCB(733, 1, 0, 733),            /* end of monitor list             */
-        IRCB(734, 1, 0, 734),            /* monitor list is full            */
-        IRCB(742, 1, 0, generic_error),  /* mode cannot be set              */
-        IRCB(900, 1, 0, 900),            /* logged in as (SASL)             */
-        IRCB(901, 1, 0, 901),            /* you are now logged out          */
-        IRCB(902, 1, 0, sasl_end_fail),  /* SASL auth failed (acc. locked)  */
-        IRCB(903, 1, 0, sasl_end_ok),    /* SASL auth successful            */
-        IRCB(904, 1, 0, sasl_end_fail),  /* SASL auth failed                */
-        IRCB(905, 1, 0, sasl_end_fail),  /* SASL message too long           */
-        IRCB(906, 1, 0, sasl_end_fail),  /* SASL authentication aborted     */
-        IRCB(907, 1, 0, sasl_end_ok),    /* already completed SASL auth     */
-        IRCB(936, 1, 0, generic_error),  /* censored word                   */
-        IRCB(973, 1, 0, server_mode_reason), /* whois (secure conn.)        */
-        IRCB(974, 1, 0, server_mode_reason), /* whois (secure conn.)        */
-        IRCB(975, 1, 0, server_mode_reason), /* whois (secure conn.)        */
-        { NULL, 0, 0, NULL },
-    };
-
     if (!msg_command)
         return;
 
@@ -8195,7 +8374,8 @@ irc_protocol_recv_command (struct t_irc_server *server,
         ptr_batch_ref = weechat_hashtable_get (ctxt.tags, "batch");
         if (ptr_batch_ref)
         {
-            if (irc_batch_add_message (server, ptr_batch_ref, irc_message))
+            if (irc_batch_add_message (server, ptr_batch_ref, irc_message,
+                                       msg_command, msg_channel))
                 goto end;
         }
     }
@@ -8265,19 +8445,10 @@ irc_protocol_recv_command (struct t_irc_server *server,
     }
 
     /* look for IRC command */
-    cmd_found = -1;
-    for (i = 0; irc_protocol_messages[i].name; i++)
-    {
-        if (weechat_strcasecmp (irc_protocol_messages[i].name,
-                                msg_command) == 0)
-        {
-            cmd_found = i;
-            break;
-        }
-    }
+    ptr_message = irc_protocol_search_message (msg_command);
 
     /* command not found */
-    if (cmd_found < 0)
+    if (!ptr_message)
     {
         /* for numeric commands, we use default recv function */
         if (irc_protocol_is_numeric_command (msg_command))
@@ -8298,10 +8469,10 @@ irc_protocol_recv_command (struct t_irc_server *server,
     }
     else
     {
-        ctxt.command = strdup (irc_protocol_messages[cmd_found].name);
-        decode_color = irc_protocol_messages[cmd_found].decode_color;
-        keep_trailing_spaces = irc_protocol_messages[cmd_found].keep_trailing_spaces;
-        cmd_recv_func = irc_protocol_messages[cmd_found].recv_function;
+        ctxt.command = strdup (ptr_message->name);
+        decode_color = ptr_message->decode_color;
+        keep_trailing_spaces = ptr_message->keep_trailing_spaces;
+        cmd_recv_func = ptr_message->recv_function;
     }
 
     if ((cmd_recv_func != NULL) && ptr_msg_after_tags)
@@ -8320,23 +8491,13 @@ irc_protocol_recv_command (struct t_irc_server *server,
             strdup (message_colors_decoded) :
             weechat_string_strip (message_colors_decoded, 0, 1, " ");
 
-        irc_message_parse (server,
-                           ctxt.irc_message,
-                           NULL,  /* tags */
-                           NULL,  /* message_without_tags */
-                           NULL,  /* nick */
-                           NULL,  /* user */
-                           NULL,  /* host */
-                           NULL,  /* command */
-                           NULL,  /* channel */
-                           NULL,  /* arguments */
-                           NULL,  /* text */
-                           &(ctxt.params),
-                           &(ctxt.num_params),
-                           NULL,  /* pos_command */
-                           NULL,  /* pos_arguments */
-                           NULL,  /* pos_channel */
-                           NULL);  /* pos_text */
+        /* only params are allocated (they are used by callback) */
+        irc_message_parse_spans (server, ctxt.irc_message, &spans);
+        if (spans.arguments.pos >= 0)
+        {
+            irc_message_parse_params (ctxt.irc_message + spans.arguments.pos,
+                                      &(ctxt.params), &(ctxt.num_params));
+        }
 
         return_code = (int) (cmd_recv_func) (&ctxt);
 
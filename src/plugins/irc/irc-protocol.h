@@ -89,6 +89,7 @@ struct t_irc_protocol_msg
 
 extern const char *irc_protocol_tags (struct t_irc_protocol_ctxt *ctxt,
                                       const char *extra_tags);
+extern struct t_irc_protocol_msg *irc_protocol_search_message (const char *command);
 extern void irc_protocol_recv_command (struct t_irc_server *server,
                                        const char *irc_message,
                                        const char *msg_command,
@@ -475,9 +475,7 @@ irc_raw_message_free (struct t_irc_raw_message *raw_message)
     if (raw_message->next_message)
         (raw_message->next_message)->prev_message = raw_message->prev_message;
 
-    /* free data */
-    free (raw_message->message);
-
+    /* free data (message is in the same allocation) */
     free (raw_message);
 
     irc_raw_messages = new_raw_messages;
@@ -499,7 +497,7 @@ irc_raw_message_free_all ()
 }
 
 /*
- * Removes old raw messages if limit has been reached.
+ * Removes old raw messages if there are more messages than the limit.
  */
 
 void
@@ -508,7 +506,7 @@ irc_raw_message_remove_old ()
     int max_messages;
 
     max_messages = weechat_config_integer (irc_config_look_raw_messages);
-    while (irc_raw_messages && (irc_raw_messages_count >= max_messages))
+    while (irc_raw_messages && (irc_raw_messages_count > max_messages))
     {
         irc_raw_message_free (irc_raw_messages);
     }
@@ -526,33 +524,62 @@ irc_raw_message_add_to_list (time_t date, int date_usec,
                              int flags, const char *message)
 {
     struct t_irc_raw_message *new_raw_message;
+    int max_messages, length;
 
     if (!message)
         return NULL;
 
-    irc_raw_message_remove_old ();
+    length = strlen (message);
+    max_messages = weechat_config_integer (irc_config_look_raw_messages);
 
-    new_raw_message = malloc (sizeof (*new_raw_message));
-    if (new_raw_message)
+    /*
+     * if limit is reached, the oldest message is recycled for the new
+     * message (ring of messages: no free/malloc when the list is full,
+     * unless the new message is longer)
+     */
+    irc_raw_message_remove_old ();
+    new_raw_message = NULL;
+    if (irc_raw_messages && (irc_raw_messages_count >= max_messages))
+    {
+        new_raw_message = irc_raw_messages;
+        irc_raw_messages = new_raw_message->next_message;
+        if (irc_raw_messages)
+            irc_raw_messages->prev_message = NULL;
+        if (last_irc_raw_message == new_raw_message)
+            last_irc_raw_message = NULL;
+        irc_raw_messages_count--;
+        if (new_raw_message->message_alloc < length + 1)
+        {
+            free (new_raw_message);
+            new_raw_message = NULL;
+        }
+    }
+    if (!new_raw_message)
     {
-        new_raw_message->date = date;
-        new_raw_message->date_usec = date_usec;
-        new_raw_message->server = server;
-        new_raw_message->flags = flags;
-        new_raw_message->message = strdup (message);
-
-        /* add message to list */
-        new_raw_message->prev_message = last_irc_raw_message;
-        new_raw_message->next_message = NULL;
-        if (last_irc_raw_message)
-            last_irc_raw_message->next_message = new_raw_message;
-        else
-            irc_raw_messages = new_raw_message;
-        last_irc_raw_message = new_raw_message;
-
-        irc_raw_messages_count++;
+        new_raw_message = malloc (sizeof (*new_raw_message) + length + 1);
+        if (!new_raw_message)
+            return NULL;
+        new_raw_message->message_alloc = length + 1;
     }
 
+    new_raw_message->date = date;
+    new_raw_message->date_usec = date_usec;
+    new_raw_message->server = server;
+    new_raw_message->flags = flags;
+    new_raw_message->message = (char *)(new_raw_message + 1);
+    memcpy (new_raw_message->message, message, length + 1);
+
+    /* add message to list */
+    new_raw_message->prev_message = last_irc_raw_message;
+    new_raw_message->next_message = NULL;
+    if (last_irc_raw_message)
+        last_irc_raw_message->next_message = new_raw_message;
+    else
+        irc_raw_messages = new_raw_message;
+    last_irc_raw_message = new_raw_message;
+
+    irc_raw_messages_count++;
+
     return new_raw_message;
 }
 
@@ -574,6 +601,13 @@ irc_raw_print (struct t_irc_server *server, int flags,
     if (!irc_raw_buffer && (weechat_irc_plugin->debug >= 1))
         irc_raw_open (0);
 
+    /* message not displayed and not kept: nothing to do */
+    if (!irc_raw_buffer
+        && (weechat_config_integer (irc_config_look_raw_messages) == 0))
+    {
+        return;
+    }
+
     gettimeofday (&tv_now, NULL);
     new_raw_message = irc_raw_message_add_to_list (
         tv_now.tv_sec, tv_now.tv_usec, server, flags, message);
@@ -45,6 +45,7 @@ struct t_irc_raw_message
     struct t_irc_server *server;       /* server                            */
     int flags;                         /* flags                             */
     char *message;                     /* message                           */
+    int message_alloc;                 /* size allocated for message        */
     struct t_irc_raw_message *prev_message; /* pointer to previous message  */
     struct t_irc_raw_message *next_message; /* pointer to next message      */
 };
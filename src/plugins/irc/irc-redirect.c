@@ -498,6 +498,7 @@ irc_redirect_new_with_commands (struct t_irc_server *server,
     new_redirect->cmd_filter = hash_cmd[3];
     new_redirect->output = NULL;
     new_redirect->output_size = 0;
+    new_redirect->output_alloc = 0;
 
     /* add redirect to end of list */
     new_redirect->prev_redirect = server->last_redirect;
@@ -684,6 +685,10 @@ irc_redirect_message_match_hash (struct t_irc_redirect *redirect,
 
 /*
  * Adds a message to redirect output.
+ *
+ * The output buffer grows by doubling its size, so that adding many messages
+ * (for example output of /who or /list on a big server) is done in linear
+ * time.
  */
 
 void
@@ -691,6 +696,7 @@ irc_redirect_message_add (struct t_irc_redirect *redirect, const char *message,
                           const char *command)
 {
     char *output2;
+    int length, new_size, new_alloc;
 
     /*
      * if command is not for output, then don't add message
@@ -700,30 +706,36 @@ irc_redirect_message_add (struct t_irc_redirect *redirect, const char *message,
         && !weechat_hashtable_has_key (redirect->cmd_filter, command))
         return;
 
-    /* add message to output */
-    if (redirect->output)
+    /* add message to output (with a "\n" before if output is not empty) */
+    length = strlen (message);
+    new_size = (redirect->output) ?
+        redirect->output_size + 1 + length : length + 1;
+    if (new_size > redirect->output_alloc)
     {
-        redirect->output_size += strlen ("\n") + strlen (message);
-        output2 = realloc (redirect->output, redirect->output_size);
+        new_alloc = (redirect->output_alloc > 0) ?
+            redirect->output_alloc : 256;
+        while (new_alloc < new_size)
+        {
+            new_alloc *= 2;
+        }
+        output2 = realloc (redirect->output, new_alloc);
         if (!output2)
         {
             free (redirect->output);
             redirect->output = NULL;
             redirect->output_size = 0;
+            redirect->output_alloc = 0;
             return;
         }
+        if (!redirect->output)
+            output2[0] = '\0';
         redirect->output = output2;
-        strcat (redirect->output, "\n");
-    }
-    else
-    {
-        redirect->output_size = strlen (message) + 1;
-        redirect->output = malloc (redirect->output_size);
-        if (redirect->output)
-            redirect->output[0] = '\0';
+        redirect->output_alloc = new_alloc;
     }
-    if (redirect->output)
-        strcat (redirect->output, message);
+    if (redirect->output_size > 0)
+        redirect->output[redirect->output_size - 1] = '\n';
+    memcpy (redirect->output + new_size - length - 1, message, length + 1);
+    redirect->output_size = new_size;
 }
 
 /*
@@ -785,6 +797,48 @@ irc_redirect_stop (struct t_irc_redirect *redirect, const char *error)
     }
 }
 
+/*
+ * Checks if a received message may be redirected: it is the case if at least
+ * one redirect of server is waiting for this command (in hashtables of
+ * commands), or is capturing all messages (start command received), or
+ * has received the stop command (the redirect is ended with next message).
+ *
+ * This check is done before splitting the arguments of message, so that
+ * messages not redirected are ignored as fast as possible.
+ *
+ * Returns:
+ *   1: message may be redirected
+ *   0: message is not redirected
+ */
+
+int
+irc_redirect_message_is_wanted (struct t_irc_server *server,
+                                const char *command)
+{
+    struct t_irc_redirect *ptr_redirect;
+
+    for (ptr_redirect = server->redirects; ptr_redirect;
+         ptr_redirect = ptr_redirect->next_redirect)
+    {
+        if (ptr_redirect->start_time <= 0)
+            continue;
+        if (ptr_redirect->cmd_start_received
+            || ptr_redirect->cmd_stop_received)
+        {
+            return 1;
+        }
+        if (ptr_redirect->cmd_start
+            && weechat_hashtable_has_key (ptr_redirect->cmd_start, command))
+        {
+            return 1;
+        }
+        if (weechat_hashtable_has_key (ptr_redirect->cmd_stop, command))
+            return 1;
+    }
+
+    return 0;
+}
+
 /*
  * Tries to redirect a received message (from IRC server) to a redirect in
  * server.
@@ -805,6 +859,9 @@ irc_redirect_message (struct t_irc_server *server, const char *message,
     if (!server || !server->redirects || !message || !command)
         return 0;
 
+    if (!irc_redirect_message_is_wanted (server, command))
+        return 0;
+
     rc = 0;
 
     if (arguments && arguments[0])
@@ -1066,6 +1123,7 @@ irc_redirect_hdata_redirect_cb (const void *pointer, void *data,
         WEECHAT_HDATA_VAR(struct t_irc_redirect, cmd_filter, HASHTABLE, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_redirect, output, STRING, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_redirect, output_size, INTEGER, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_redirect, output_alloc, INTEGER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_redirect, prev_redirect, POINTER, 0, NULL, hdata_name);
         WEECHAT_HDATA_VAR(struct t_irc_redirect, next_redirect, POINTER, 0, NULL, hdata_name);
     }
@@ -1238,6 +1296,7 @@ irc_redirect_print_log (struct t_irc_server *server)
                             weechat_hashtable_get_string (ptr_redirect->cmd_filter, "keys_values"));
         weechat_log_printf ("       output. . . . . . . : '%s'", ptr_redirect->output);
         weechat_log_printf ("       output_size . . . . : %d", ptr_redirect->output_size);
+        weechat_log_printf ("       output_alloc. . . . : %d", ptr_redirect->output_alloc);
         weechat_log_printf ("       prev_redirect . . . : %p", ptr_redirect->prev_redirect);
         weechat_log_printf ("       next_redirect . . . : %p", ptr_redirect->next_redirect);
     }
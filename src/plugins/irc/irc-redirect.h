@@ -71,6 +71,7 @@ struct t_irc_redirect
     char *output;                   /* output of IRC command (gradually      */
                                     /* filled with IRC messages)             */
     int output_size;                /* size (in bytes) of output string      */
+    int output_alloc;               /* allocated size (in bytes) for output  */
     struct t_irc_redirect *prev_redirect; /* link to previous redirect       */
     struct t_irc_redirect *next_redirect; /* link to next redirect           */
 };
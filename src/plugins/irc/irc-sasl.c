@@ -24,6 +24,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <arpa/inet.h>
+#include <sys/stat.h>
 #include <gcrypt.h>
 
 #include <gnutls/gnutls.h>
@@ -45,6 +46,16 @@ char *irc_sasl_mechanism_string[IRC_NUM_SASL_MECHANISMS] =
 { "plain", "scram-sha-1", "scram-sha-256", "scram-sha-512",
   "ecdsa-nist256p-challenge", "external" };
 
+/*
+ * cache of salted passwords for SASL SCRAM (key: hash algo, iterations, salt
+ * and hash of password; value: salted password in hexadecimal), so that the
+ * costly PBKDF2 computation is done only once when reconnecting
+ */
+struct t_hashtable *irc_sasl_scram_cache = NULL;
+
+/* cache of key files for SASL ECDSA (key: path, value: key file) */
+struct t_hashtable *irc_sasl_key_cache = NULL;
+
 
 /*
  * Builds answer for SASL authentication, using mechanism "PLAIN".
@@ -89,6 +100,102 @@ irc_sasl_mechanism_plain (const char *sasl_username, const char *sasl_password)
     return answer_base64;
 }
 
+/*
+ * Computes the salted password for SASL SCRAM:
+ *   SaltedPassword := Hi(Normalize(password), salt, i)
+ *
+ * The result is cached, so that the PBKDF2 algorithm is used only once for
+ * the same hash algorithm, iterations, salt and password (for example when
+ * many servers are reconnected at same time).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+irc_sasl_scram_salted_password (const char *hash_algo,
+                                const char *password,
+                                const char *salt_base64,
+                                const char *salt, int salt_size,
+                                int iterations,
+                                char *salted_password,
+                                int *salted_password_size)
+{
+    char hash_password[512 / 8], hash_password_hex[((512 / 8) * 2) + 1];
+    char salted_password_hex[((512 / 8) * 2) + 1], *key;
+    const char *ptr_value;
+    int hash_password_size, length;
+
+    if (!weechat_crypto_hash (password, strlen (password), "sha256",
+                              hash_password, &hash_password_size))
+    {
+        return 0;
+    }
+    if (weechat_string_base_encode ("16", hash_password, hash_password_size,
+                                    hash_password_hex) < 0)
+    {
+        return 0;
+    }
+    if (weechat_asprintf (&key, "%s:%d:%s:%s",
+                          hash_algo, iterations, salt_base64,
+                          hash_password_hex) < 0)
+    {
+        return 0;
+    }
+
+    if (!irc_sasl_scram_cache)
+    {
+        irc_sasl_scram_cache = weechat_hashtable_new (
+            IRC_SASL_CACHE_MAX,
+            WEECHAT_HASHTABLE_STRING,
+            WEECHAT_HASHTABLE_STRING,
+            NULL, NULL);
+    }
+
+    /* salted password already computed? */
+    ptr_value = weechat_hashtable_get (irc_sasl_scram_cache, key);
+    if (ptr_value)
+    {
+        length = weechat_string_base_decode ("16", ptr_value,
+                                             salted_password);
+        if (length > 0)
+        {
+            *salted_password_size = length;
+            free (key);
+            return 1;
+        }
+    }
+
+    if (!weechat_crypto_hash_pbkdf2 (password, strlen (password),
+                                     hash_algo,
+                                     salt, salt_size,
+                                     iterations,
+                                     salted_password,
+                                     salted_password_size))
+    {
+        free (key);
+        return 0;
+    }
+
+    if (irc_sasl_scram_cache
+        && (weechat_string_base_encode ("16", salted_password,
+                                        *salted_password_size,
+                                        salted_password_hex) >= 0))
+    {
+        if (weechat_hashtable_get_integer (irc_sasl_scram_cache,
+                                           "items_count") >= IRC_SASL_CACHE_MAX)
+        {
+            weechat_hashtable_remove_all (irc_sasl_scram_cache);
+        }
+        weechat_hashtable_set (irc_sasl_scram_cache, key, salted_password_hex);
+    }
+
+    free (key);
+
+    return 1;
+}
+
 /*
  * Builds answer for SASL authentication, using mechanism
  * "SCRAM-SHA-1", "SCRAM-SHA-256" or "SCRAM-SHA-512".
@@ -291,13 +398,13 @@ irc_sasl_mechanism_scram (struct t_irc_server *server,
             if (salt_size <= 0)
                 goto base64_decode_error;
             /* RFC: SaltedPassword := Hi(Normalize(password), salt, i) */
-            if (!weechat_crypto_hash_pbkdf2 (sasl_password,
-                                             strlen (sasl_password),
-                                             hash_algo,
-                                             salt, salt_size,
-                                             iterations,
-                                             salted_password,
-                                             &salted_password_size))
+            if (!irc_sasl_scram_salted_password (hash_algo,
+                                                 sasl_password,
+                                                 salt_base64,
+                                                 salt, salt_size,
+                                                 iterations,
+                                                 salted_password,
+                                                 &salted_password_size))
                 goto crypto_error;
             free (server->sasl_scram_salted_pwd);
             server->sasl_scram_salted_pwd = malloc (salted_password_size);
@@ -444,6 +551,105 @@ end:
     return answer_base64;
 }
 
+/*
+ * Frees a key file in cache.
+ */
+
+void
+irc_sasl_key_cache_free_value_cb (struct t_hashtable *hashtable,
+                                  const void *key, void *value)
+{
+    struct t_irc_sasl_key_file *ptr_key_file;
+
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    ptr_key_file = (struct t_irc_sasl_key_file *)value;
+    if (ptr_key_file)
+    {
+        free (ptr_key_file->content);
+        free (ptr_key_file);
+    }
+}
+
+/*
+ * Returns the content of a key file, using the cache if the file has not
+ * changed since last read (same modification time and size).
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+irc_sasl_get_key_file (const char *path)
+{
+    struct t_irc_sasl_key_file *ptr_key_file, *new_key_file;
+    struct stat st;
+    char *content;
+
+    if (stat (path, &st) != 0)
+        return NULL;
+
+    if (!irc_sasl_key_cache)
+    {
+        irc_sasl_key_cache = weechat_hashtable_new (
+            IRC_SASL_CACHE_MAX,
+            WEECHAT_HASHTABLE_STRING,
+            WEECHAT_HASHTABLE_POINTER,
+            NULL, NULL);
+        if (irc_sasl_key_cache)
+        {
+            weechat_hashtable_set_pointer (irc_sasl_key_cache,
+                                           "callback_free_value",
+                                           &irc_sasl_key_cache_free_value_cb);
+        }
+    }
+
+    ptr_key_file = weechat_hashtable_get (irc_sasl_key_cache, path);
+    if (ptr_key_file
+        && (ptr_key_file->mtime == st.st_mtime)
+        && (ptr_key_file->size == (long long)st.st_size))
+    {
+        return strdup (ptr_key_file->content);
+    }
+
+    content = weechat_file_get_content (path);
+    if (!content)
+    {
+        weechat_hashtable_remove (irc_sasl_key_cache, path);
+        return NULL;
+    }
+
+    if (irc_sasl_key_cache)
+    {
+        new_key_file = malloc (sizeof (*new_key_file));
+        if (new_key_file)
+        {
+            new_key_file->mtime = st.st_mtime;
+            new_key_file->size = (long long)st.st_size;
+            new_key_file->content = strdup (content);
+            if (new_key_file->content)
+            {
+                if (!ptr_key_file
+                    && (weechat_hashtable_get_integer (
+                            irc_sasl_key_cache,
+                            "items_count") >= IRC_SASL_CACHE_MAX))
+                {
+                    weechat_hashtable_remove_all (irc_sasl_key_cache);
+                }
+                weechat_hashtable_set (irc_sasl_key_cache, path,
+                                       new_key_file);
+            }
+            else
+            {
+                free (new_key_file);
+            }
+        }
+    }
+
+    return content;
+}
+
 /*
  * Returns the content of file with SASL key.
  *
@@ -475,7 +681,7 @@ irc_sasl_get_key_content (const char *sasl_key, char **sasl_error)
     weechat_hashtable_free (options);
 
     if (key_path)
-        content = weechat_file_get_content (key_path);
+        content = irc_sasl_get_key_file (key_path);
 
     if (key_path && !content && sasl_error)
     {
@@ -698,3 +904,22 @@ irc_sasl_mechanism_ecdsa_nist256p_challenge (struct t_irc_server *server,
     return NULL;
 #endif /* LIBGNUTLS_VERSION_NUMBER >= 0x030015 */
 }
+
+/*
+ * Frees caches of SASL data.
+ */
+
+void
+irc_sasl_end ()
+{
+    if (irc_sasl_scram_cache)
+    {
+        weechat_hashtable_free (irc_sasl_scram_cache);
+        irc_sasl_scram_cache = NULL;
+    }
+    if (irc_sasl_key_cache)
+    {
+        weechat_hashtable_free (irc_sasl_key_cache);
+        irc_sasl_key_cache = NULL;
+    }
+}
@@ -20,9 +20,14 @@
 #ifndef WEECHAT_PLUGIN_IRC_SASL_H
 #define WEECHAT_PLUGIN_IRC_SASL_H
 
+#include <time.h>
+
 #define IRC_SASL_SCRAM_CLIENT_KEY "Client Key"
 #define IRC_SASL_SCRAM_SERVER_KEY "Server Key"
 
+/* max number of entries in caches (salted passwords and key files) */
+#define IRC_SASL_CACHE_MAX 64
+
 struct t_irc_server;
 
 /* SASL authentication mechanisms */
@@ -39,7 +44,18 @@ enum t_irc_sasl_mechanism
     IRC_NUM_SASL_MECHANISMS,
 };
 
+/* content of a key file (cached until the file is changed) */
+
+struct t_irc_sasl_key_file
+{
+    time_t mtime;                   /* last modification time of file       */
+    long long size;                 /* size of file                         */
+    char *content;                  /* content of file                      */
+};
+
 extern char *irc_sasl_mechanism_string[];
+extern struct t_hashtable *irc_sasl_scram_cache;
+extern struct t_hashtable *irc_sasl_key_cache;
 
 extern char *irc_sasl_mechanism_plain (const char *sasl_username,
                                        const char *sasl_password);
@@ -49,10 +65,13 @@ extern char *irc_sasl_mechanism_scram (struct t_irc_server *server,
                                        const char *sasl_username,
                                        const char *sasl_password,
                                        char **sasl_error);
+extern char *irc_sasl_get_key_file (const char *path);
+extern char *irc_sasl_get_key_content (const char *sasl_key, char **sasl_error);
 extern char *irc_sasl_mechanism_ecdsa_nist256p_challenge (struct t_irc_server *server,
                                                           const char *data_base64,
                                                           const char *sasl_username,
                                                           const char *sasl_key,
                                                           char **sasl_error);
+extern void irc_sasl_end ();
 
 #endif /* WEECHAT_PLUGIN_IRC_SASL_H */
@@ -22,6 +22,7 @@
  */
 
 #include <stdlib.h>
+#include <limits.h>
 #include <stddef.h>
 #include <unistd.h>
 #include <fcntl.h>
@@ -55,6 +56,7 @@
 #include "irc-batch.h"
 #include "irc-buffer.h"
 #include "irc-channel.h"
+#include "irc-chathistory.h"
 #include "irc-color.h"
 #include "irc-command.h"
 #include "irc-config.h"
@@ -73,9 +75,6 @@
 struct t_irc_server *irc_servers = NULL;
 struct t_irc_server *last_irc_server = NULL;
 
-struct t_irc_message *irc_recv_msgq = NULL;
-struct t_irc_message *irc_msgq_last_msg = NULL;
-
 char *irc_server_sasl_fail_string[IRC_SERVER_NUM_SASL_FAIL] =
 { "continue", "reconnect", "disconnect" };
 
@@ -118,6 +117,8 @@ char *irc_server_options[IRC_SERVER_NUM_OPTIONS][2] =
   { "autorejoin_delay",     "30"                      },
   { "connection_timeout",   "60"                      },
   { "anti_flood",           "2000"                    },
+  { "anti_flood_burst",     "5"                       },
+  { "anti_flood_bytes",     "0"                       },
   { "away_check",           "0"                       },
   { "away_check_max_nicks", "25"                      },
   { "msg_kick",             ""                        },
@@ -334,6 +335,43 @@ irc_server_strncasecmp (struct t_irc_server *server,
     return weechat_strncasecmp_range (string1, string2, max, range);
 }
 
+/*
+ * Converts a string to lower case on server (depends on casemapping): two
+ * strings are equal with function irc_server_strcasecmp if and only if they
+ * are equal once converted with this function.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+irc_server_string_tolower (struct t_irc_server *server, const char *string)
+{
+    int casemapping, range;
+    char *result, *ptr_result;
+
+    if (!string)
+        return NULL;
+
+    casemapping = (server) ? server->casemapping : -1;
+    if ((casemapping < 0) || (casemapping >= IRC_SERVER_NUM_CASEMAPPING))
+        casemapping = IRC_SERVER_CASEMAPPING_RFC1459;
+
+    range = irc_server_casemapping_range[casemapping];
+
+    result = strdup (string);
+    if (!result)
+        return NULL;
+
+    /* chars converted are all ASCII, so it is safe to work on bytes */
+    for (ptr_result = result; ptr_result[0]; ptr_result++)
+    {
+        if ((ptr_result[0] >= 'A') && (ptr_result[0] < 'A' + range))
+            ptr_result[0] += ('a' - 'A');
+    }
+
+    return result;
+}
+
 /*
  * Evaluates a string using the server as context:
  * ${irc_server.xxx} and ${server} are replaced by a server option and the
@@ -1104,6 +1142,50 @@ irc_server_get_isupport_value (struct t_irc_server *server, const char *feature)
     return NULL;
 }
 
+/*
+ * Gets max number of targets for a command, using feature "TARGMAX" in
+ * "isupport" (for example "TARGMAX=JOIN:10,PRIVMSG:4,NAMES:1").
+ *
+ * Returns max number of targets, 0 if there is no limit (or if the limit is
+ * unknown).
+ */
+
+int
+irc_server_get_max_targets (struct t_irc_server *server, const char *command)
+{
+    const char *ptr_targmax, *ptr_string, *pos_comma;
+    char *error;
+    int length_command;
+    long value;
+
+    ptr_targmax = irc_server_get_isupport_value (server, "TARGMAX");
+    if (!ptr_targmax || !ptr_targmax[0] || !command || !command[0])
+        return 0;
+
+    length_command = strlen (command);
+
+    ptr_string = ptr_targmax;
+    while (ptr_string && ptr_string[0])
+    {
+        if ((weechat_strncasecmp (ptr_string, command, length_command) == 0)
+            && (ptr_string[length_command] == ':'))
+        {
+            error = NULL;
+            value = strtol (ptr_string + length_command + 1, &error, 10);
+            if (error && ((error[0] == ',') || !error[0]) && (value > 0)
+                && (value <= INT_MAX))
+            {
+                return (int)value;
+            }
+            return 0;
+        }
+        pos_comma = strchr (ptr_string, ',');
+        ptr_string = (pos_comma) ? pos_comma + 1 : NULL;
+    }
+
+    return 0;
+}
+
 /*
  * Gets "chantypes" for the server:
  *   - if server is NULL, returns pointer to irc_channel_default_chantypes
@@ -1754,6 +1836,7 @@ irc_server_alloc (const char *name)
     new_server->hook_timer_connection = NULL;
     new_server->hook_timer_sasl = NULL;
     new_server->hook_timer_anti_flood = NULL;
+    new_server->hook_timer_recv_process = NULL;
     new_server->sasl_scram_client_first = NULL;
     new_server->sasl_scram_salted_pwd = NULL;
     new_server->sasl_scram_salted_pwd_size = 0;
@@ -1768,7 +1851,16 @@ irc_server_alloc (const char *name)
     new_server->gnutls_sess = NULL;
     new_server->tls_cert = NULL;
     new_server->tls_cert_key = NULL;
-    new_server->unterminated_message = NULL;
+    new_server->tls_session_data.data = NULL;
+    new_server->tls_session_data.size = 0;
+    new_server->tls_session_address = NULL;
+    new_server->recv_buffer = NULL;
+    new_server->recv_buffer_old = NULL;
+    new_server->recv_buffer_size = 0;
+    new_server->recv_buffer_length = 0;
+    new_server->recv_buffer_pos = 0;
+    new_server->recv_buffer_processing = 0;
+    new_server->messages_recv = 0;
     new_server->nicks_count = 0;
     new_server->nicks_array = NULL;
     new_server->nick_first_tried = 0;
@@ -1808,12 +1900,17 @@ irc_server_alloc (const char *name)
     new_server->clienttagdeny_count = 0;
     new_server->clienttagdeny_array = NULL;
     new_server->typing_allowed = 1;
+    new_server->typing_pending = 0;
+    new_server->chathistory_requests = 0;
     new_server->reconnect_delay = 0;
     new_server->reconnect_start = 0;
+    new_server->reconnect_count = 0;
     new_server->command_time = 0;
     new_server->autojoin_time = 0;
     new_server->autojoin_done = 0;
     new_server->disable_autojoin = 0;
+    new_server->join_burst = 0;
+    new_server->join_burst_time = 0;
     new_server->is_away = 0;
     new_server->away_message = NULL;
     new_server->away_time = 0;
@@ -1833,6 +1930,14 @@ irc_server_alloc (const char *name)
         new_server->outqueue[i] = NULL;
         new_server->last_outqueue[i] = NULL;
     }
+    new_server->outqueue_count = 0;
+    new_server->anti_flood_time.tv_sec = 0;
+    new_server->anti_flood_time.tv_usec = 0;
+    new_server->outqueue_sent = 0;
+    new_server->outqueue_wait_total = 0;
+    new_server->outqueue_wait_max = 0;
+    new_server->send_buffer = NULL;
+    new_server->send_buffer_length = 0;
     new_server->redirects = NULL;
     new_server->last_redirect = NULL;
     new_server->notify_list = NULL;
@@ -1863,6 +1968,17 @@ irc_server_alloc (const char *name)
         WEECHAT_HASHTABLE_STRING,
         WEECHAT_HASHTABLE_STRING,
         NULL, NULL);
+    new_server->nicks_channels = weechat_hashtable_new (
+        32,
+        WEECHAT_HASHTABLE_STRING,
+        WEECHAT_HASHTABLE_POINTER,
+        NULL, NULL);
+    if (new_server->nicks_channels)
+    {
+        weechat_hashtable_set_pointer (new_server->nicks_channels,
+                                       "callback_free_value",
+                                       &irc_nick_channels_free_value_cb);
+    }
     new_server->batches = NULL;
     new_server->last_batch = NULL;
     new_server->buffer = NULL;
@@ -2220,6 +2336,7 @@ irc_server_outqueue_add (struct t_irc_server *server, int priority,
         new_outqueue->modified = modified;
         new_outqueue->tags = (tags) ? strdup (tags) : NULL;
         new_outqueue->redirect = redirect;
+        gettimeofday (&(new_outqueue->date_added), NULL);
 
         new_outqueue->prev_outqueue = server->last_outqueue[priority];
         new_outqueue->next_outqueue = NULL;
@@ -2228,6 +2345,7 @@ irc_server_outqueue_add (struct t_irc_server *server, int priority,
         else
             server->outqueue[priority] = new_outqueue;
         server->last_outqueue[priority] = new_outqueue;
+        server->outqueue_count++;
     }
 }
 
@@ -2268,6 +2386,8 @@ irc_server_outqueue_free (struct t_irc_server *server,
 
     /* set new head */
     server->outqueue[priority] = new_outqueue;
+
+    server->outqueue_count--;
 }
 
 /*
@@ -2347,6 +2467,8 @@ irc_server_free_data (struct t_irc_server *server)
     weechat_hashtable_free (server->join_noswitch);
     weechat_hashtable_free (server->echo_msg_recv);
     weechat_hashtable_free (server->names_channel_filter);
+    weechat_hashtable_free (server->nicks_channels);
+    irc_server_tls_session_free (server);
 
     /* free server data */
     for (i = 0; i < IRC_SERVER_NUM_OPTIONS; i++)
@@ -2365,8 +2487,11 @@ irc_server_free_data (struct t_irc_server *server)
     weechat_unhook (server->hook_timer_connection);
     weechat_unhook (server->hook_timer_sasl);
     weechat_unhook (server->hook_timer_anti_flood);
+    weechat_unhook (server->hook_timer_recv_process);
     irc_server_free_sasl_data (server);
-    free (server->unterminated_message);
+    free (server->recv_buffer);
+    free (server->recv_buffer_old);
+    free (server->send_buffer);
     weechat_string_free_split (server->nicks_array);
     free (server->nick);
     free (server->nick_modes);
@@ -2383,7 +2508,7 @@ irc_server_free_data (struct t_irc_server *server)
     free (server->away_message);
     if (server->cmd_list_regexp)
     {
-        regfree (server->cmd_list_regexp);
+        weechat_string_regfree (server->cmd_list_regexp);
         free (server->cmd_list_regexp);
     }
     if (server->list)
@@ -2780,6 +2905,77 @@ irc_server_send (struct t_irc_server *server, const char *buffer, int size_buf)
     return rc;
 }
 
+/*
+ * Sends all data in send buffer to server, in a single call if possible
+ * (it is called again if data is partially sent).
+ *
+ * Returns number of bytes sent, -1 if error.
+ */
+
+int
+irc_server_send_buffer_flush (struct t_irc_server *server)
+{
+    int rc, sent;
+
+    if (!server)
+        return -1;
+
+    sent = 0;
+    while (sent < server->send_buffer_length)
+    {
+        rc = irc_server_send (server, server->send_buffer + sent,
+                              server->send_buffer_length - sent);
+        if (rc <= 0)
+        {
+            server->send_buffer_length = 0;
+            return -1;
+        }
+        sent += rc;
+    }
+    server->send_buffer_length = 0;
+
+    return sent;
+}
+
+/*
+ * Adds data in send buffer; the buffer is sent if there is not enough space
+ * for the data.
+ *
+ * Data bigger than the send buffer is sent immediately (after data already in
+ * send buffer).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+irc_server_send_buffer_add (struct t_irc_server *server,
+                            const char *data, int length)
+{
+    if (!server || !data || (length <= 0))
+        return 0;
+
+    if (!server->send_buffer)
+    {
+        server->send_buffer = malloc (IRC_SERVER_SEND_BUFFER_SIZE);
+        if (!server->send_buffer)
+            return (irc_server_send (server, data, length) > 0) ? 1 : 0;
+        server->send_buffer_length = 0;
+    }
+
+    if (server->send_buffer_length + length > IRC_SERVER_SEND_BUFFER_SIZE)
+        irc_server_send_buffer_flush (server);
+
+    if (length > IRC_SERVER_SEND_BUFFER_SIZE)
+        return (irc_server_send (server, data, length) > 0) ? 1 : 0;
+
+    memcpy (server->send_buffer + server->send_buffer_length, data, length);
+    server->send_buffer_length += length;
+
+    return 1;
+}
+
 /*
  * Sets default tags used when sending message.
  */
@@ -2841,6 +3037,80 @@ irc_server_outqueue_all_empty (struct t_irc_server *server)
     return 1;
 }
 
+/*
+ * Returns the cost of a message for anti-flood (in microseconds): delay set
+ * in option "anti_flood", increased by one delay for each
+ * "anti_flood_bytes" bytes in message (if this option is set).
+ */
+
+long long
+irc_server_anti_flood_cost (struct t_irc_server *server, const char *message)
+{
+    long long cost;
+    int bytes;
+
+    if (!server)
+        return 0;
+
+    cost = IRC_SERVER_OPTION_INTEGER(server, IRC_SERVER_OPTION_ANTI_FLOOD);
+    bytes = IRC_SERVER_OPTION_INTEGER(server, IRC_SERVER_OPTION_ANTI_FLOOD_BYTES);
+    if ((bytes > 0) && message)
+        cost += cost * ((long long)strlen (message) / bytes);
+
+    return cost * 1000;
+}
+
+/*
+ * Returns the time to wait (in microseconds) before sending a message with
+ * this cost (0 if it can be sent now).
+ *
+ * Anti-flood is a token bucket: the bucket can contain "anti_flood_burst"
+ * messages and one message is added every "anti_flood" milliseconds; the
+ * bucket is full at date "anti_flood_time" (each message sent moves this
+ * date to the future by the cost of message); a message bigger than the
+ * bucket can be sent only when the bucket is full.
+ */
+
+long long
+irc_server_anti_flood_wait (struct t_irc_server *server, long long cost)
+{
+    struct timeval tv_now;
+    long long used, size;
+
+    if (!server)
+        return 0;
+
+    gettimeofday (&tv_now, NULL);
+    used = weechat_util_timeval_diff (&tv_now, &(server->anti_flood_time));
+    if (used <= 0)
+        return 0;
+
+    size = (long long)IRC_SERVER_OPTION_INTEGER(server, IRC_SERVER_OPTION_ANTI_FLOOD_BURST)
+        * IRC_SERVER_OPTION_INTEGER(server, IRC_SERVER_OPTION_ANTI_FLOOD) * 1000;
+    if (used + cost <= size)
+        return 0;
+
+    return (cost > size) ? used : used + cost - size;
+}
+
+/*
+ * Removes a message with this cost from anti-flood bucket.
+ */
+
+void
+irc_server_anti_flood_add (struct t_irc_server *server, long long cost)
+{
+    struct timeval tv_now;
+
+    if (!server)
+        return;
+
+    gettimeofday (&tv_now, NULL);
+    if (weechat_util_timeval_cmp (&(server->anti_flood_time), &tv_now) < 0)
+        server->anti_flood_time = tv_now;
+    weechat_util_timeval_add (&(server->anti_flood_time), cost);
+}
+
 /*
  * Timer called to send out queue (anti-flood).
  */
@@ -2856,6 +3126,11 @@ irc_server_outqueue_timer_cb (const void *pointer, void *data, int remaining_cal
 
     server = (struct t_irc_server *)pointer;
 
+    if (!server)
+        return WEECHAT_RC_ERROR;
+
+    server->hook_timer_anti_flood = NULL;
+
     irc_server_outqueue_send (server);
 
     return WEECHAT_RC_OK;
@@ -2879,27 +3154,51 @@ irc_server_outqueue_timer_remove (struct t_irc_server *server)
 }
 
 /*
- * Adds anti-flood timer in a server (removes it first if already set).
+ * Adds anti-flood timer in a server (removes it first if already set): the
+ * timer is called when next message in high/low priority queues can be sent.
  */
 
 void
 irc_server_outqueue_timer_add (struct t_irc_server *server)
 {
+    struct t_irc_outqueue *ptr_outqueue;
+    long long wait;
+    int priority;
+
     if (!server)
         return;
 
     if (server->hook_timer_anti_flood)
         irc_server_outqueue_timer_remove (server);
 
+    ptr_outqueue = NULL;
+    for (priority = 1; priority < IRC_SERVER_NUM_OUTQUEUES_PRIO; priority++)
+    {
+        if (server->outqueue[priority])
+        {
+            ptr_outqueue = server->outqueue[priority];
+            break;
+        }
+    }
+    if (!ptr_outqueue)
+        return;
+
+    wait = irc_server_anti_flood_wait (
+        server,
+        irc_server_anti_flood_cost (server, ptr_outqueue->message_after_mod));
+
     server->hook_timer_anti_flood = weechat_hook_timer (
-        IRC_SERVER_OPTION_INTEGER(server, IRC_SERVER_OPTION_ANTI_FLOOD),
-        0, 0,
+        (wait / 1000) + 1,
+        0, 1,
         &irc_server_outqueue_timer_cb,
         server, NULL);
 }
 
 /*
  * Sends one message from out queue.
+ *
+ * The message is added in send buffer: the caller must flush the send buffer
+ * (function irc_server_send_buffer_flush).
  */
 
 void
@@ -2907,10 +3206,19 @@ irc_server_outqueue_send_one_msg (struct t_irc_server *server,
                                   struct t_irc_outqueue *message)
 {
     char *pos, *tags_to_send;
+    struct timeval tv_now;
+    long long wait;
 
     if (!server || !message)
         return;
 
+    gettimeofday (&tv_now, NULL);
+    wait = weechat_util_timeval_diff (&(message->date_added), &tv_now);
+    server->outqueue_sent++;
+    server->outqueue_wait_total += wait;
+    if (wait > server->outqueue_wait_max)
+        server->outqueue_wait_max = wait;
+
     if (message->message_before_mod)
     {
         pos = strchr (message->message_before_mod, '\r');
@@ -2951,10 +3259,15 @@ irc_server_outqueue_send_one_msg (struct t_irc_server *server,
         if (pos)
             pos[0] = '\r';
 
-        /* send command */
-        irc_server_send (server,
-                         message->message_after_mod,
-                         strlen (message->message_after_mod));
+        /* add command in send buffer (sent by the caller) */
+        irc_server_send_buffer_add (server,
+                                    message->message_after_mod,
+                                    strlen (message->message_after_mod));
+
+        /* remove message from anti-flood bucket */
+        irc_server_anti_flood_add (
+            server,
+            irc_server_anti_flood_cost (server, message->message_after_mod));
 
         /* start redirection if redirect is set */
         if (message->redirect)
@@ -2968,6 +3281,13 @@ irc_server_outqueue_send_one_msg (struct t_irc_server *server,
 /*
  * Sends one or multiple message from out queues, by order of priority
  * (immediate/high/low), then from oldest message to newest in queue.
+ *
+ * Messages with immediate priority are always sent; messages with high/low
+ * priority are sent while the anti-flood allows it (see function
+ * irc_server_anti_flood_wait), then a timer is added to send next message.
+ *
+ * All messages sent are grouped in send buffer, so that they are sent with
+ * a single call to send/gnutls_record_send (when possible).
  */
 
 void
@@ -2975,32 +3295,43 @@ irc_server_outqueue_send (struct t_irc_server *server)
 {
     int priority, anti_flood;
 
-    if (irc_server_outqueue_all_empty (server))
-    {
+    if (server->hook_timer_anti_flood)
         irc_server_outqueue_timer_remove (server);
+
+    if (irc_server_outqueue_all_empty (server))
         return;
-    }
 
     anti_flood = IRC_SERVER_OPTION_INTEGER(server, IRC_SERVER_OPTION_ANTI_FLOOD);
 
     for (priority = 0; priority < IRC_SERVER_NUM_OUTQUEUES_PRIO; priority++)
     {
-        if (!server->outqueue[priority])
-            continue;
-
-        irc_server_outqueue_send_one_msg (server, server->outqueue[priority]);
-        irc_server_outqueue_free (server, priority, server->outqueue[priority]);
+        while (server->outqueue[priority])
+        {
+            if ((priority > 0)
+                && (anti_flood > 0)
+                && (irc_server_anti_flood_wait (
+                        server,
+                        irc_server_anti_flood_cost (
+                            server,
+                            server->outqueue[priority]->message_after_mod)) > 0))
+            {
+                break;
+            }
+            irc_server_outqueue_send_one_msg (server,
+                                              server->outqueue[priority]);
+            irc_server_outqueue_free (server, priority,
+                                      server->outqueue[priority]);
+        }
 
-        /*
-         * continue to send for immediate priority (= 0),
-         * exit loop now for high/low priorities (> 0) if anti flood is enabled
-         */
-        if ((priority > 0) && (anti_flood > 0))
+        /* lower priorities are sent only when this queue is empty */
+        if (server->outqueue[priority])
             break;
     }
 
+    irc_server_send_buffer_flush (server);
+
     /* schedule next send if anti-flood is enabled */
-    if ((anti_flood > 0) && !server->hook_timer_anti_flood)
+    if ((anti_flood > 0) && !irc_server_outqueue_all_empty (server))
         irc_server_outqueue_timer_add (server);
 }
 
@@ -3031,9 +3362,8 @@ irc_server_send_one_msg (struct t_irc_server *server, int flags,
     snprintf (str_modifier, sizeof (str_modifier),
               "irc_out_%s",
               (command) ? command : "unknown");
-    new_msg = weechat_hook_modifier_exec (str_modifier,
-                                          server->name,
-                                          message);
+    new_msg = (weechat_hook_modifier_hooked (str_modifier)) ?
+        weechat_hook_modifier_exec (str_modifier, server->name, message) : NULL;
 
     /* no changes in new message */
     if (new_msg && (strcmp (message, new_msg) == 0))
@@ -3082,7 +3412,8 @@ irc_server_send_one_msg (struct t_irc_server *server, int flags,
                 pos_encode = 0;
                 break;
         }
-        if (pos_encode >= 0)
+        if ((pos_encode >= 0)
+            && weechat_hook_modifier_hooked ("charset_encode"))
         {
             ptr_chan_nick = (channel) ? channel : nick;
             if (ptr_chan_nick)
@@ -3273,9 +3604,8 @@ irc_server_sendf (struct t_irc_server *server, int flags, const char *tags,
     snprintf (str_modifier, sizeof (str_modifier),
               "irc_out1_%s",
               (command) ? command : "unknown");
-    new_msg = weechat_hook_modifier_exec (str_modifier,
-                                          server->name,
-                                          vbuffer);
+    new_msg = (weechat_hook_modifier_hooked (str_modifier)) ?
+        weechat_hook_modifier_exec (str_modifier, server->name, vbuffer) : NULL;
 
     /* no changes in new message */
     if (new_msg && (strcmp (vbuffer, new_msg) == 0))
@@ -3356,6 +3686,7 @@ irc_server_sendf (struct t_irc_server *server, int flags, const char *tags,
         irc_server_outqueue_send_one_msg (server, server->outqueue[0]);
         irc_server_outqueue_free (server, 0, server->outqueue[0]);
     }
+    irc_server_send_buffer_flush (server);
 
     /* send any other messages, if any, possibly with anti-flood */
     if (!server->hook_timer_anti_flood)
@@ -3365,401 +3696,504 @@ irc_server_sendf (struct t_irc_server *server, int flags, const char *tags,
 }
 
 /*
- * Adds a message to received messages queue (at the end).
+ * Ensures there is enough free space at the end of receive buffer to add
+ * "size" bytes (plus a final '\0').
+ *
+ * If messages are being processed, the current buffer is kept until the end
+ * of processing (the message being processed points to this buffer).
+ *
+ * Returns pointer to free space in receive buffer, NULL if error.
  */
 
-void
-irc_server_msgq_add_msg (struct t_irc_server *server, const char *msg)
+char *
+irc_server_recv_buffer_grow (struct t_irc_server *server, int size)
 {
-    struct t_irc_message *message;
+    char *new_buffer;
+    int new_size;
 
-    if (!server->unterminated_message && !msg[0])
-        return;
+    if (!server || (size < 0))
+        return NULL;
 
-    message = malloc (sizeof (*message));
-    if (!message)
+    if (server->recv_buffer
+        && (size < server->recv_buffer_size - server->recv_buffer_length))
     {
-        weechat_printf (server->buffer,
-                        _("%s%s: not enough memory for received message"),
-                        weechat_prefix ("error"), IRC_PLUGIN_NAME);
-        return;
+        return server->recv_buffer + server->recv_buffer_length;
+    }
+
+    if (size > INT_MAX / 2 - server->recv_buffer_length)
+        return NULL;
+
+    new_size = (server->recv_buffer_size > 0) ? server->recv_buffer_size : 4096;
+    while (new_size <= server->recv_buffer_length + size)
+    {
+        new_size *= 2;
     }
-    message->server = server;
-    if (server->unterminated_message)
+
+    if (server->recv_buffer_processing && !server->recv_buffer_old)
     {
-        message->data = malloc (strlen (server->unterminated_message) +
-                                strlen (msg) + 1);
-        if (!message->data)
-        {
-            weechat_printf (server->buffer,
-                            _("%s%s: not enough memory for received message"),
-                            weechat_prefix ("error"), IRC_PLUGIN_NAME);
-        }
-        else
+        new_buffer = malloc (new_size);
+        if (!new_buffer)
+            return NULL;
+        if (server->recv_buffer_length > 0)
         {
-            strcpy (message->data, server->unterminated_message);
-            strcat (message->data, msg);
+            memcpy (new_buffer, server->recv_buffer,
+                    server->recv_buffer_length);
         }
-        free (server->unterminated_message);
-        server->unterminated_message = NULL;
+        server->recv_buffer_old = server->recv_buffer;
     }
     else
-        message->data = strdup (msg);
-
-    message->next_message = NULL;
-
-    if (irc_msgq_last_msg)
     {
-        irc_msgq_last_msg->next_message = message;
-        irc_msgq_last_msg = message;
+        new_buffer = realloc (server->recv_buffer, new_size);
+        if (!new_buffer)
+            return NULL;
     }
-    else
+    server->recv_buffer = new_buffer;
+    server->recv_buffer_size = new_size;
+    server->recv_buffer[server->recv_buffer_length] = '\0';
+
+    return server->recv_buffer + server->recv_buffer_length;
+}
+
+/*
+ * Adds data received at the end of receive buffer.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+irc_server_recv_buffer_add (struct t_irc_server *server,
+                            const char *data, int length)
+{
+    char *ptr_buffer;
+
+    if (!server || !data || (length < 0))
+        return 0;
+
+    ptr_buffer = irc_server_recv_buffer_grow (server, length);
+    if (!ptr_buffer)
     {
-        irc_recv_msgq = message;
-        irc_msgq_last_msg = message;
+        weechat_printf (server->buffer,
+                        _("%s%s: not enough memory for received message"),
+                        weechat_prefix ("error"), IRC_PLUGIN_NAME);
+        return 0;
     }
+    memcpy (ptr_buffer, data, length);
+    server->recv_buffer_length += length;
+    server->recv_buffer[server->recv_buffer_length] = '\0';
+
+    return 1;
 }
 
 /*
- * Adds an unterminated message to queue.
+ * Discards all data in receive buffer.
  */
 
 void
-irc_server_msgq_add_unterminated (struct t_irc_server *server,
-                                  const char *string)
+irc_server_recv_buffer_reset (struct t_irc_server *server)
 {
-    char *unterminated_message2;
-
-    if (!string[0])
+    if (!server)
         return;
 
-    if (server->unterminated_message)
+    if (server->recv_buffer_processing && !server->recv_buffer_old)
     {
-        unterminated_message2 =
-            realloc (server->unterminated_message,
-                     (strlen (server->unterminated_message) +
-                      strlen (string) + 1));
-        if (!unterminated_message2)
-        {
-            weechat_printf (server->buffer,
-                            _("%s%s: not enough memory for received message"),
-                            weechat_prefix ("error"), IRC_PLUGIN_NAME);
-            free (server->unterminated_message);
-            server->unterminated_message = NULL;
-            return;
-        }
-        server->unterminated_message = unterminated_message2;
-        strcat (server->unterminated_message, string);
+        /* keep buffer until the end of processing */
+        server->recv_buffer_old = server->recv_buffer;
     }
     else
     {
-        server->unterminated_message = strdup (string);
-        if (!server->unterminated_message)
-        {
-            weechat_printf (server->buffer,
-                            _("%s%s: not enough memory for received message"),
-                            weechat_prefix ("error"), IRC_PLUGIN_NAME);
-        }
+        free (server->recv_buffer);
     }
+    server->recv_buffer = NULL;
+    server->recv_buffer_size = 0;
+    server->recv_buffer_length = 0;
+    server->recv_buffer_pos = 0;
 }
 
 /*
- * Splits received buffer, creating queued messages.
+ * Processes a message received from server (the message is modified during
+ * processing, then restored).
  */
 
 void
-irc_server_msgq_add_buffer (struct t_irc_server *server, const char *buffer)
+irc_server_msg_process (struct t_irc_server *server, char *msg)
 {
-    char *pos_cr, *pos_lf;
+    char *ptr_data, *new_msg, *new_msg2, *ptr_msg, *ptr_msg2, *pos;
+    char *command, *channel;
+    const char *arguments;
+    char *msg_decoded, *msg_decoded_without_color;
+    char str_modifier[128], modifier_data[1024];
+    int pos_channel, pos_text, pos_decode, length;
+    struct t_irc_message_spans spans;
+
+    if (!server || !msg)
+        return;
 
-    while (buffer[0])
+    ptr_data = msg;
+    while (ptr_data[0] == ' ')
     {
-        pos_cr = strchr (buffer, '\r');
-        pos_lf = strchr (buffer, '\n');
+        ptr_data++;
+    }
 
-        if (!pos_cr && !pos_lf)
-        {
-            /* no CR/LF found => add to unterminated and return */
-            irc_server_msgq_add_unterminated (server, buffer);
-            return;
-        }
+    if (ptr_data[0])
+    {
+        server->messages_recv++;
+
+        irc_raw_print (server, IRC_RAW_FLAG_RECV, ptr_data);
 
-        if (pos_cr && ((!pos_lf) || (pos_lf > pos_cr)))
+        irc_message_parse_spans (server, ptr_data, &spans);
+        if (spans.command.pos >= 0)
         {
-            /* found '\r' first => ignore this char */
-            pos_cr[0] = '\0';
-            irc_server_msgq_add_unterminated (server, buffer);
-            buffer = pos_cr + 1;
+            length = spans.command.length;
+            if (length > (int)sizeof (str_modifier) - 8)
+                length = sizeof (str_modifier) - 8;
+            snprintf (str_modifier, sizeof (str_modifier),
+                      "irc_in_%.*s",
+                      length,
+                      ptr_data + spans.command.pos);
         }
         else
         {
-            /* found: '\n' first => terminate message */
-            pos_lf[0] = '\0';
-            irc_server_msgq_add_msg (server, buffer);
-            buffer = pos_lf + 1;
+            snprintf (str_modifier, sizeof (str_modifier),
+                      "irc_in_unknown");
         }
-    }
-}
-
-/*
- * Flushes message queue.
- */
+        new_msg = (weechat_hook_modifier_hooked (str_modifier)) ?
+            weechat_hook_modifier_exec (str_modifier, server->name,
+                                        ptr_data) : NULL;
 
-void
-irc_server_msgq_flush ()
-{
-    struct t_irc_message *next;
-    char *ptr_data, *new_msg, *new_msg2, *ptr_msg, *ptr_msg2, *pos;
-    char *nick, *host, *command, *channel, *arguments;
-    char *msg_decoded, *msg_decoded_without_color;
-    char str_modifier[128], modifier_data[1024];
-    int pos_channel, pos_text, pos_decode;
+        /* no changes in new message */
+        if (new_msg && (strcmp (ptr_data, new_msg) == 0))
+        {
+            free (new_msg);
+            new_msg = NULL;
+        }
 
-    while (irc_recv_msgq)
-    {
-        if (irc_recv_msgq->data)
+        /* message not dropped? */
+        if (!new_msg || new_msg[0])
         {
-            /*
-             * read message only if connection was not lost
-             * (or if we are on a fake server)
-             */
-            if ((irc_recv_msgq->server->sock != -1)
-                || irc_recv_msgq->server->fake_server)
+            /* use new message (returned by plugin) */
+            ptr_msg = (new_msg) ? new_msg : ptr_data;
+
+            while (ptr_msg && ptr_msg[0])
             {
-                ptr_data = irc_recv_msgq->data;
-                while (ptr_data[0] == ' ')
+                pos = strchr (ptr_msg, '\n');
+                if (pos)
+                    pos[0] = '\0';
+
+                if (new_msg)
                 {
-                    ptr_data++;
+                    irc_raw_print (
+                        server,
+                        IRC_RAW_FLAG_RECV | IRC_RAW_FLAG_MODIFIED,
+                        ptr_msg);
                 }
 
-                if (ptr_data[0])
+                /*
+                 * parse message without allocating memory;
+                 * only command and channel are copied because
+                 * they are used after the end of message
+                 */
+                irc_message_parse_spans (server,
+                                         ptr_msg, &spans);
+                command = irc_message_span_strdup (
+                    ptr_msg, &spans.command);
+                channel = irc_message_span_strdup (
+                    ptr_msg, &spans.channel);
+                arguments = (spans.arguments.pos >= 0) ?
+                    ptr_msg + spans.arguments.pos : NULL;
+                pos_channel = spans.channel.pos;
+                pos_text = spans.text.pos;
+
+                msg_decoded = NULL;
+
+                switch (IRC_SERVER_OPTION_ENUM(server,
+                                               IRC_SERVER_OPTION_CHARSET_MESSAGE))
+                {
+                    case IRC_SERVER_CHARSET_MESSAGE_MESSAGE:
+                        pos_decode = 0;
+                        break;
+                    case IRC_SERVER_CHARSET_MESSAGE_CHANNEL:
+                        pos_decode = (pos_channel >= 0) ? pos_channel : pos_text;
+                        break;
+                    case IRC_SERVER_CHARSET_MESSAGE_TEXT:
+                        pos_decode = pos_text;
+                        break;
+                    default:
+                        pos_decode = 0;
+                        break;
+                }
+                if ((pos_decode >= 0)
+                    && weechat_hook_modifier_hooked ("charset_decode"))
                 {
-                    irc_raw_print (irc_recv_msgq->server, IRC_RAW_FLAG_RECV,
-                                   ptr_data);
-
-                    irc_message_parse (irc_recv_msgq->server,
-                                       ptr_data,
-                                       NULL,  /* tags */
-                                       NULL,  /* message_without_tags */
-                                       NULL,  /* nick */
-                                       NULL,  /* user */
-                                       NULL,  /* host */
-                                       &command,
-                                       NULL,  /* channel */
-                                       NULL,  /* arguments */
-                                       NULL,  /* text */
-                                       NULL,  /* params */
-                                       NULL,  /* num_params */
-                                       NULL,  /* pos_command */
-                                       NULL,  /* pos_arguments */
-                                       NULL,  /* pos_channel */
-                                       NULL);  /* pos_text */
-                    snprintf (str_modifier, sizeof (str_modifier),
-                              "irc_in_%s",
-                              (command) ? command : "unknown");
-                    new_msg = weechat_hook_modifier_exec (
-                        str_modifier,
-                        irc_recv_msgq->server->name,
-                        ptr_data);
-                    free (command);
-
-                    /* no changes in new message */
-                    if (new_msg && (strcmp (ptr_data, new_msg) == 0))
+                    /* convert charset for message */
+                    if (channel
+                        && irc_channel_is_channel (server,
+                                                   channel))
                     {
-                        free (new_msg);
-                        new_msg = NULL;
+                        snprintf (modifier_data, sizeof (modifier_data),
+                                  "%s.%s.%s",
+                                  weechat_plugin->name,
+                                  server->name,
+                                  channel);
+                    }
+                    else
+                    {
+                        if ((spans.nick.pos >= 0)
+                            && ((spans.host.pos < 0)
+                                || (spans.nick.length != spans.host.length)
+                                || (strncmp (ptr_msg + spans.nick.pos,
+                                             ptr_msg + spans.host.pos,
+                                             spans.nick.length) != 0)))
+                        {
+                            /* IRC message is max 512 bytes */
+                            length = spans.nick.length;
+                            if (length > 512)
+                                length = 512;
+                            snprintf (modifier_data,
+                                      sizeof (modifier_data),
+                                      "%s.%s.%.*s",
+                                      weechat_plugin->name,
+                                      server->name,
+                                      length,
+                                      ptr_msg + spans.nick.pos);
+                        }
+                        else
+                        {
+                            snprintf (modifier_data,
+                                      sizeof (modifier_data),
+                                      "%s.%s",
+                                      weechat_plugin->name,
+                                      server->name);
+                        }
                     }
 
-                    /* message not dropped? */
-                    if (!new_msg || new_msg[0])
+                    /*
+                     * when UTF8ONLY is enabled, servers must
+                     * not relay content containing non-UTF-8
+                     * data to clients; the charset decoding below
+                     * is then done only if UTF8ONLY is *NOT*
+                     * enabled
+                     * (see: https://ircv3.net/specs/extensions/utf8-only)
+                     */
+                    if (!server->utf8only)
                     {
-                        /* use new message (returned by plugin) */
-                        ptr_msg = (new_msg) ? new_msg : ptr_data;
+                        msg_decoded = irc_message_convert_charset (
+                            ptr_msg, pos_decode,
+                            "charset_decode", modifier_data);
+                    }
+                }
 
-                        while (ptr_msg && ptr_msg[0])
-                        {
-                            pos = strchr (ptr_msg, '\n');
-                            if (pos)
-                                pos[0] = '\0';
-
-                            if (new_msg)
-                            {
-                                irc_raw_print (
-                                    irc_recv_msgq->server,
-                                    IRC_RAW_FLAG_RECV | IRC_RAW_FLAG_MODIFIED,
-                                    ptr_msg);
-                            }
-
-                            irc_message_parse (irc_recv_msgq->server,
-                                               ptr_msg,
-                                               NULL,  /* tags */
-                                               NULL,  /* message_without_tags */
-                                               &nick,
-                                               NULL,  /* user */
-                                               &host,
-                                               &command,
-                                               &channel,
-                                               &arguments,
-                                               NULL,  /* text */
-                                               NULL,  /* params */
-                                               NULL,  /* num_params */
-                                               NULL,  /* pos_command */
-                                               NULL,  /* pos_arguments */
-                                               &pos_channel,
-                                               &pos_text);
-
-                            msg_decoded = NULL;
-
-                            switch (IRC_SERVER_OPTION_ENUM(irc_recv_msgq->server,
-                                                           IRC_SERVER_OPTION_CHARSET_MESSAGE))
-                            {
-                                case IRC_SERVER_CHARSET_MESSAGE_MESSAGE:
-                                    pos_decode = 0;
-                                    break;
-                                case IRC_SERVER_CHARSET_MESSAGE_CHANNEL:
-                                    pos_decode = (pos_channel >= 0) ? pos_channel : pos_text;
-                                    break;
-                                case IRC_SERVER_CHARSET_MESSAGE_TEXT:
-                                    pos_decode = pos_text;
-                                    break;
-                                default:
-                                    pos_decode = 0;
-                                    break;
-                            }
-                            if (pos_decode >= 0)
-                            {
-                                /* convert charset for message */
-                                if (channel
-                                    && irc_channel_is_channel (irc_recv_msgq->server,
-                                                               channel))
-                                {
-                                    snprintf (modifier_data, sizeof (modifier_data),
-                                              "%s.%s.%s",
-                                              weechat_plugin->name,
-                                              irc_recv_msgq->server->name,
-                                              channel);
-                                }
-                                else
-                                {
-                                    if (nick && (!host || (strcmp (nick, host) != 0)))
-                                    {
-                                        snprintf (modifier_data,
-                                                  sizeof (modifier_data),
-                                                  "%s.%s.%s",
-                                                  weechat_plugin->name,
-                                                  irc_recv_msgq->server->name,
-                                                  nick);
-                                    }
-                                    else
-                                    {
-                                        snprintf (modifier_data,
-                                                  sizeof (modifier_data),
-                                                  "%s.%s",
-                                                  weechat_plugin->name,
-                                                  irc_recv_msgq->server->name);
-                                    }
-                                }
-
-                                /*
-                                 * when UTF8ONLY is enabled, servers must
-                                 * not relay content containing non-UTF-8
-                                 * data to clients; the charset decoding below
-                                 * is then done only if UTF8ONLY is *NOT*
-                                 * enabled
-                                 * (see: https://ircv3.net/specs/extensions/utf8-only)
-                                 */
-                                if (!irc_recv_msgq->server->utf8only)
-                                {
-                                    msg_decoded = irc_message_convert_charset (
-                                        ptr_msg, pos_decode,
-                                        "charset_decode", modifier_data);
-                                }
-                            }
-
-                            /* replace WeeChat internal color codes by "?" */
-                            msg_decoded_without_color =
-                                weechat_string_remove_color (
-                                    (msg_decoded) ? msg_decoded : ptr_msg,
-                                    "?");
+                /* replace WeeChat internal color codes by "?" */
+                msg_decoded_without_color =
+                    weechat_string_remove_color (
+                        (msg_decoded) ? msg_decoded : ptr_msg,
+                        "?");
+
+                /* call modifier after charset */
+                ptr_msg2 = (msg_decoded_without_color) ?
+                    msg_decoded_without_color : ((msg_decoded) ? msg_decoded : ptr_msg);
+                snprintf (str_modifier, sizeof (str_modifier),
+                          "irc_in2_%s",
+                          (command) ? command : "unknown");
+                new_msg2 = (weechat_hook_modifier_hooked (str_modifier)) ?
+                    weechat_hook_modifier_exec (str_modifier, server->name,
+                                                ptr_msg2) : NULL;
+                if (new_msg2 && (strcmp (ptr_msg2, new_msg2) == 0))
+                {
+                    free (new_msg2);
+                    new_msg2 = NULL;
+                }
 
-                            /* call modifier after charset */
-                            ptr_msg2 = (msg_decoded_without_color) ?
-                                msg_decoded_without_color : ((msg_decoded) ? msg_decoded : ptr_msg);
-                            snprintf (str_modifier, sizeof (str_modifier),
-                                      "irc_in2_%s",
-                                      (command) ? command : "unknown");
-                            new_msg2 = weechat_hook_modifier_exec (
-                                str_modifier,
-                                irc_recv_msgq->server->name,
-                                ptr_msg2);
-                            if (new_msg2 && (strcmp (ptr_msg2, new_msg2) == 0))
-                            {
-                                free (new_msg2);
-                                new_msg2 = NULL;
-                            }
-
-                            /* message not dropped? */
-                            if (!new_msg2 || new_msg2[0])
-                            {
-                                /* use new message (returned by plugin) */
-                                if (new_msg2)
-                                    ptr_msg2 = new_msg2;
-
-                                /* parse and execute command */
-                                if (irc_redirect_message (irc_recv_msgq->server,
-                                                          ptr_msg2, command,
-                                                          arguments))
-                                {
-                                    /* message redirected, we'll not display it! */
-                                }
-                                else
-                                {
-                                    /* message not redirected, display it */
-                                    irc_protocol_recv_command (
-                                        irc_recv_msgq->server,
-                                        ptr_msg2,
-                                        command,
-                                        channel,
-                                        0);  /* ignore_batch_tag */
-                                }
-                            }
-
-                            free (new_msg2);
-                            free (nick);
-                            free (host);
-                            free (command);
-                            free (channel);
-                            free (arguments);
-                            free (msg_decoded);
-                            free (msg_decoded_without_color);
-
-                            if (pos)
-                            {
-                                pos[0] = '\n';
-                                ptr_msg = pos + 1;
-                            }
-                            else
-                                ptr_msg = NULL;
-                        }
+                /* message not dropped? */
+                if (!new_msg2 || new_msg2[0])
+                {
+                    /* use new message (returned by plugin) */
+                    if (new_msg2)
+                        ptr_msg2 = new_msg2;
+
+                    /* parse and execute command */
+                    if (irc_redirect_message (server,
+                                              ptr_msg2, command,
+                                              arguments))
+                    {
+                        /* message redirected, we'll not display it! */
                     }
                     else
                     {
-                        irc_raw_print (irc_recv_msgq->server,
-                                       IRC_RAW_FLAG_RECV | IRC_RAW_FLAG_MODIFIED,
-                                       _("(message dropped)"));
+                        /* message not redirected, display it */
+                        irc_protocol_recv_command (
+                            server,
+                            ptr_msg2,
+                            command,
+                            channel,
+                            0);  /* ignore_batch_tag */
                     }
-                    free (new_msg);
+                }
+
+                free (new_msg2);
+                free (command);
+                free (channel);
+                free (msg_decoded);
+                free (msg_decoded_without_color);
+
+                if (pos)
+                {
+                    pos[0] = '\n';
+                    ptr_msg = pos + 1;
+                }
+                else
+                    ptr_msg = NULL;
+            }
+        }
+        else
+        {
+            irc_raw_print (server,
+                           IRC_RAW_FLAG_RECV | IRC_RAW_FLAG_MODIFIED,
+                           _("(message dropped)"));
+        }
+        free (new_msg);
+    }
+}
+
+/*
+ * Callback for timer used to process messages received, when the max time to
+ * process messages has been reached.
+ */
+
+int
+irc_server_timer_recv_process_cb (const void *pointer, void *data,
+                                  int remaining_calls)
+{
+    struct t_irc_server *server;
+
+    /* make C compiler happy */
+    (void) data;
+    (void) remaining_calls;
+
+    server = (struct t_irc_server *)pointer;
+
+    if (!server)
+        return WEECHAT_RC_ERROR;
+
+    server->hook_timer_recv_process = NULL;
+
+    irc_server_recv_buffer_process (server);
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Processes all complete messages in receive buffer (messages are parsed in
+ * place, without copy); the unterminated message (if any) is kept at the
+ * beginning of buffer.
+ *
+ * If processing takes more than irc.network.max_process_time, the other
+ * messages are processed later by a timer (messages are always processed in
+ * the order they are received).
+ *
+ * Messages added by a callback during processing are processed by the
+ * outer call, after the current message.
+ */
+
+void
+irc_server_recv_buffer_process (struct t_irc_server *server)
+{
+    char *ptr_msg, *pos_lf, *ptr_src, *ptr_dst;
+    int length, max_process_time;
+    struct timeval tv_start, tv_now;
+
+    if (!server || server->recv_buffer_processing)
+        return;
+
+    if (server->hook_timer_recv_process)
+    {
+        weechat_unhook (server->hook_timer_recv_process);
+        server->hook_timer_recv_process = NULL;
+    }
+
+    server->recv_buffer_processing = 1;
+
+    max_process_time = weechat_config_integer (
+        irc_config_network_max_process_time);
+    if (max_process_time > 0)
+        gettimeofday (&tv_start, NULL);
+
+    while (server->recv_buffer
+           && (server->recv_buffer_pos < server->recv_buffer_length))
+    {
+        ptr_msg = server->recv_buffer + server->recv_buffer_pos;
+        pos_lf = memchr (ptr_msg, '\n',
+                         server->recv_buffer_length - server->recv_buffer_pos);
+        if (!pos_lf)
+            break;
+        pos_lf[0] = '\0';
+        server->recv_buffer_pos += pos_lf - ptr_msg + 1;
+
+        /* remove all '\r' in message */
+        ptr_dst = strchr (ptr_msg, '\r');
+        if (ptr_dst)
+        {
+            for (ptr_src = ptr_dst; ptr_src[0]; ptr_src++)
+            {
+                if (ptr_src[0] != '\r')
+                {
+                    ptr_dst[0] = ptr_src[0];
+                    ptr_dst++;
                 }
             }
-            free (irc_recv_msgq->data);
+            ptr_dst[0] = '\0';
         }
 
-        next = irc_recv_msgq->next_message;
-        free (irc_recv_msgq);
-        irc_recv_msgq = next;
-        if (!irc_recv_msgq)
-            irc_msgq_last_msg = NULL;
+        /*
+         * read message only if connection was not lost
+         * (or if we are on a fake server)
+         */
+        if (ptr_msg[0] && ((server->sock != -1) || server->fake_server))
+            irc_server_msg_process (server, ptr_msg);
+
+        /* max time reached: process other messages later */
+        if ((max_process_time > 0)
+            && server->recv_buffer
+            && (server->recv_buffer_pos < server->recv_buffer_length))
+        {
+            gettimeofday (&tv_now, NULL);
+            if (weechat_util_timeval_diff (&tv_start, &tv_now)
+                >= (long long)max_process_time * 1000)
+            {
+                if (memchr (server->recv_buffer + server->recv_buffer_pos,
+                            '\n',
+                            server->recv_buffer_length - server->recv_buffer_pos))
+                {
+                    server->hook_timer_recv_process = weechat_hook_timer (
+                        1, 0, 1,
+                        &irc_server_timer_recv_process_cb,
+                        server, NULL);
+                }
+                break;
+            }
+        }
     }
+
+    /* remove messages processed, keep the unterminated message */
+    if (server->recv_buffer && (server->recv_buffer_pos > 0))
+    {
+        length = server->recv_buffer_length - server->recv_buffer_pos;
+        if (length > 0)
+        {
+            memmove (server->recv_buffer,
+                     server->recv_buffer + server->recv_buffer_pos,
+                     length);
+        }
+        server->recv_buffer_length = length;
+        server->recv_buffer_pos = 0;
+        server->recv_buffer[length] = '\0';
+    }
+
+    free (server->recv_buffer_old);
+    server->recv_buffer_old = NULL;
+
+    server->recv_buffer_processing = 0;
 }
 
 /*
@@ -3774,8 +4208,8 @@ int
 irc_server_recv_cb (const void *pointer, void *data, int fd)
 {
     struct t_irc_server *server;
-    static char buffer[4096 + 2];
-    int num_read, msgq_flush, end_recv;
+    char *ptr_buffer;
+    int recv_size, num_read, msgq_flush, end_recv;
 
     /* make C compiler happy */
     (void) data;
@@ -3788,26 +4222,38 @@ irc_server_recv_cb (const void *pointer, void *data, int fd)
     msgq_flush = 0;
     end_recv = 0;
 
+    recv_size = weechat_config_integer (irc_config_network_recv_size);
+
     while (!end_recv)
     {
         end_recv = 1;
 
+        /* read directly at the end of receive buffer */
+        ptr_buffer = irc_server_recv_buffer_grow (server, recv_size);
+        if (!ptr_buffer)
+        {
+            weechat_printf (server->buffer,
+                            _("%s%s: not enough memory for received message"),
+                            weechat_prefix ("error"), IRC_PLUGIN_NAME);
+            break;
+        }
+
         if (server->tls_connected)
         {
             if (!server->gnutls_sess)
                 return WEECHAT_RC_ERROR;
-            num_read = gnutls_record_recv (server->gnutls_sess, buffer,
-                                           sizeof (buffer) - 2);
+            num_read = gnutls_record_recv (server->gnutls_sess, ptr_buffer,
+                                           recv_size);
         }
         else
         {
-            num_read = recv (server->sock, buffer, sizeof (buffer) - 2, 0);
+            num_read = recv (server->sock, ptr_buffer, recv_size, 0);
         }
 
         if (num_read > 0)
         {
-            buffer[num_read] = '\0';
-            irc_server_msgq_add_buffer (server, buffer);
+            server->recv_buffer_length += num_read;
+            server->recv_buffer[server->recv_buffer_length] = '\0';
             msgq_flush = 1;  /* the flush will be done after the loop */
             if (server->tls_connected
                 && (gnutls_record_check_pending (server->gnutls_sess) > 0))
@@ -3864,7 +4310,7 @@ irc_server_recv_cb (const void *pointer, void *data, int fd)
     }
 
     if (msgq_flush)
-        irc_server_msgq_flush ();
+        irc_server_recv_buffer_process (server);
 
     return WEECHAT_RC_OK;
 }
@@ -4016,7 +4462,8 @@ irc_server_timer_cb (const void *pointer, void *data, int remaining_calls)
     struct t_irc_batch *ptr_batch, *ptr_next_batch;
     time_t current_time;
     static struct timeval tv;
-    int away_check, refresh_lag;
+    int away_check, refresh_lag, lag_check, lag_refresh_interval;
+    int lag_min_show, lag_reconnect, lag_max;
 
     /* make C compiler happy */
     (void) pointer;
@@ -4025,6 +4472,14 @@ irc_server_timer_cb (const void *pointer, void *data, int remaining_calls)
 
     current_time = time (NULL);
 
+    /* read options only once for all servers */
+    lag_check = weechat_config_integer (irc_config_network_lag_check);
+    lag_refresh_interval = weechat_config_integer (
+        irc_config_network_lag_refresh_interval);
+    lag_min_show = weechat_config_integer (irc_config_network_lag_min_show);
+    lag_reconnect = weechat_config_integer (irc_config_network_lag_reconnect);
+    lag_max = weechat_config_integer (irc_config_network_lag_max);
+
     for (ptr_server = irc_servers; ptr_server;
          ptr_server = ptr_server->next_server)
     {
@@ -4041,7 +4496,7 @@ irc_server_timer_cb (const void *pointer, void *data, int remaining_calls)
                 continue;
 
             /* check for lag */
-            if ((weechat_config_integer (irc_config_network_lag_check) > 0)
+            if ((lag_check > 0)
                 && (ptr_server->lag_check_time.tv_sec == 0)
                 && (current_time >= ptr_server->lag_next_check))
             {
@@ -4088,6 +4543,14 @@ irc_server_timer_cb (const void *pointer, void *data, int remaining_calls)
                 ptr_server->autojoin_time = 0;
             }
 
+            /* check if join burst is drained (some channels not joined) */
+            if ((ptr_server->join_burst > 0)
+                && (current_time >= ptr_server->join_burst_time +
+                    IRC_SERVER_JOIN_BURST_TIMEOUT))
+            {
+                irc_server_join_burst_end (ptr_server);
+            }
+
             /* check if it's time to send MONITOR command */
             if ((ptr_server->monitor_time != 0)
                 && (current_time >= ptr_server->monitor_time))
@@ -4106,8 +4569,8 @@ irc_server_timer_cb (const void *pointer, void *data, int remaining_calls)
                                                                    &tv) / 1000);
                 /* refresh lag item if needed */
                 if (((ptr_server->lag_last_refresh == 0)
-                     || (current_time >= ptr_server->lag_last_refresh + weechat_config_integer (irc_config_network_lag_refresh_interval)))
-                    && (ptr_server->lag >= weechat_config_integer (irc_config_network_lag_min_show)))
+                     || (current_time >= ptr_server->lag_last_refresh + lag_refresh_interval))
+                    && (ptr_server->lag >= lag_min_show))
                 {
                     ptr_server->lag_last_refresh = current_time;
                     if (ptr_server->lag != ptr_server->lag_displayed)
@@ -4117,8 +4580,8 @@ irc_server_timer_cb (const void *pointer, void *data, int remaining_calls)
                     }
                 }
                 /* lag timeout? => disconnect */
-                if ((weechat_config_integer (irc_config_network_lag_reconnect) > 0)
-                    && (ptr_server->lag >= weechat_config_integer (irc_config_network_lag_reconnect) * 1000))
+                if ((lag_reconnect > 0)
+                    && (ptr_server->lag >= lag_reconnect * 1000))
                 {
                     weechat_printf (
                         ptr_server->buffer,
@@ -4133,8 +4596,8 @@ irc_server_timer_cb (const void *pointer, void *data, int remaining_calls)
                 else
                 {
                     /* stop lag counting if max lag is reached */
-                    if ((weechat_config_integer (irc_config_network_lag_max) > 0)
-                        && (ptr_server->lag >= (weechat_config_integer (irc_config_network_lag_max) * 1000)))
+                    if ((lag_max > 0)
+                        && (ptr_server->lag >= (lag_max * 1000)))
                     {
                         /* refresh lag item */
                         ptr_server->lag_last_refresh = current_time;
@@ -4147,8 +4610,7 @@ irc_server_timer_cb (const void *pointer, void *data, int remaining_calls)
                         /* schedule next lag check in 5 seconds */
                         ptr_server->lag_check_time.tv_sec = 0;
                         ptr_server->lag_check_time.tv_usec = 0;
-                        ptr_server->lag_next_check = time (NULL) +
-                            weechat_config_integer (irc_config_network_lag_check);
+                        ptr_server->lag_next_check = time (NULL) + lag_check;
                     }
                 }
                 if (refresh_lag)
@@ -4214,6 +4676,98 @@ irc_server_timer_cb (const void *pointer, void *data, int remaining_calls)
     return WEECHAT_RC_OK;
 }
 
+/*
+ * Frees data of last TLS session of a server.
+ */
+
+void
+irc_server_tls_session_free (struct t_irc_server *server)
+{
+    if (!server)
+        return;
+
+    if (server->tls_session_data.data)
+    {
+        gnutls_free (server->tls_session_data.data);
+        server->tls_session_data.data = NULL;
+    }
+    server->tls_session_data.size = 0;
+    free (server->tls_session_address);
+    server->tls_session_address = NULL;
+}
+
+/*
+ * Saves data of current TLS session of a server, so that the session can be
+ * resumed on next connection to the same address/port (only if the server
+ * was fully connected, ie the certificate was checked).
+ *
+ * With TLS 1.3, the session can be resumed only if a session ticket has been
+ * received.
+ */
+
+void
+irc_server_tls_session_save (struct t_irc_server *server)
+{
+    char str_address[1024];
+
+    irc_server_tls_session_free (server);
+
+    if (server->fake_server || !server->gnutls_sess
+        || !server->tls_connected || !server->is_connected
+        || !server->current_address)
+    {
+        return;
+    }
+
+#if LIBGNUTLS_VERSION_NUMBER >= 0x030603 /* 3.6.3 */
+    if ((gnutls_protocol_get_version (server->gnutls_sess) == GNUTLS_TLS1_3)
+        && !(gnutls_session_get_flags (server->gnutls_sess)
+             & GNUTLS_SFLAGS_SESSION_TICKET))
+    {
+        return;
+    }
+#endif /* LIBGNUTLS_VERSION_NUMBER >= 0x030603 */
+
+    if (gnutls_session_get_data2 (server->gnutls_sess,
+                                  &server->tls_session_data) != GNUTLS_E_SUCCESS)
+    {
+        server->tls_session_data.data = NULL;
+        server->tls_session_data.size = 0;
+        return;
+    }
+
+    snprintf (str_address, sizeof (str_address),
+              "%s/%d", server->current_address, server->current_port);
+    server->tls_session_address = strdup (str_address);
+}
+
+/*
+ * Sets data of last TLS session in the new TLS session of a server, to
+ * resume it (only if the address/port is the same).
+ */
+
+void
+irc_server_tls_session_resume (struct t_irc_server *server)
+{
+    char str_address[1024];
+
+    if (!server->tls_connected || !server->hook_connect
+        || !server->tls_session_data.data || !server->tls_session_address
+        || !server->current_address)
+    {
+        return;
+    }
+
+    snprintf (str_address, sizeof (str_address),
+              "%s/%d", server->current_address, server->current_port);
+    if (strcmp (server->tls_session_address, str_address) != 0)
+        return;
+
+    gnutls_session_set_data (server->gnutls_sess,
+                             server->tls_session_data.data,
+                             server->tls_session_data.size);
+}
+
 /*
  * Closes server connection.
  */
@@ -4249,6 +4803,12 @@ irc_server_close_connection (struct t_irc_server *server)
         server->hook_timer_anti_flood = NULL;
     }
 
+    if (server->hook_timer_recv_process)
+    {
+        weechat_unhook (server->hook_timer_recv_process);
+        server->hook_timer_recv_process = NULL;
+    }
+
     if (server->hook_fd)
     {
         weechat_unhook (server->hook_fd);
@@ -4265,6 +4825,7 @@ irc_server_close_connection (struct t_irc_server *server)
         /* close TLS connection */
         if (server->tls_connected)
         {
+            irc_server_tls_session_save (server);
             if (server->sock != -1)
                 gnutls_bye (server->gnutls_sess, GNUTLS_SHUT_WR);
             gnutls_deinit (server->gnutls_sess);
@@ -4281,15 +4842,14 @@ irc_server_close_connection (struct t_irc_server *server)
     }
 
     /* free any pending message */
-    if (server->unterminated_message)
-    {
-        free (server->unterminated_message);
-        server->unterminated_message = NULL;
-    }
+    irc_server_recv_buffer_reset (server);
     for (i = 0; i < IRC_SERVER_NUM_OUTQUEUES_PRIO; i++)
     {
         irc_server_outqueue_free_all (server, i);
     }
+    server->send_buffer_length = 0;
+    server->anti_flood_time.tv_sec = 0;
+    server->anti_flood_time.tv_usec = 0;
 
     /* remove all redirects */
     irc_redirect_free_all (server);
@@ -5091,6 +5651,21 @@ irc_server_gnutls_callback (const void *pointer, void *data,
 
     if (action == WEECHAT_HOOK_CONNECT_GNUTLS_CB_VERIFY_CERT)
     {
+        /*
+         * session resumed: the certificate has been checked when the
+         * session was established (data of a session is saved only if the
+         * server was fully connected)
+         */
+        if (gnutls_session_is_resumed (tls_session))
+        {
+            weechat_printf (
+                server->buffer,
+                _("%sgnutls: TLS session resumed, certificate already "
+                  "checked"),
+                weechat_prefix ("network"));
+            goto end;
+        }
+
         /* initialize the certificate structure */
         if (gnutls_x509_crt_init (&cert_temp) != GNUTLS_E_SUCCESS)
         {
@@ -5639,6 +6214,7 @@ irc_server_connect (struct t_irc_server *server)
             &irc_server_connect_cb,
             server,
             NULL);
+        irc_server_tls_session_resume (server);
     }
 
     /* send signal "irc_server_connecting" with server name */
@@ -5672,6 +6248,7 @@ irc_server_reconnect (struct t_irc_server *server)
         weechat_prefix ("network"), IRC_PLUGIN_NAME);
 
     server->reconnect_start = 0;
+    server->reconnect_count++;
 
     if (!irc_server_connect (server))
         irc_server_reconnect_schedule (server);
@@ -5756,6 +6333,7 @@ irc_server_disconnect (struct t_irc_server *server, int switch_address,
                 weechat_unhook (ptr_channel->hook_autorejoin);
                 ptr_channel->hook_autorejoin = NULL;
             }
+            ptr_channel->join_check_pending = 0;
             weechat_buffer_set (ptr_channel->buffer, "localvar_del_away", "");
             weechat_printf (
                 ptr_channel->buffer,
@@ -5847,6 +6425,8 @@ irc_server_disconnect (struct t_irc_server *server, int switch_address,
     }
     server->clienttagdeny_count = 0;
     server->typing_allowed = 1;
+    server->typing_pending = 0;
+    irc_chathistory_reset (server);
     server->is_away = 0;
     server->away_time = 0;
     server->lag = 0;
@@ -5859,6 +6439,8 @@ irc_server_disconnect (struct t_irc_server *server, int switch_address,
     irc_server_set_lag (server);
     server->monitor = 0;
     server->monitor_time = 0;
+    server->join_burst = 0;
+    server->join_burst_time = 0;
 
     if (reconnect
         && IRC_SERVER_OPTION_BOOLEAN(server, IRC_SERVER_OPTION_AUTORECONNECT))
@@ -6021,6 +6603,10 @@ irc_server_autojoin_create_buffers (struct t_irc_server *server)
  *
  *   #channel1,#channel2,#channel3 key1,key2
  *
+ * Channels with a key are first (so that keys match channels), and in each
+ * group, channels displayed in a window are first, so that they are joined
+ * first when the JOIN is split in many messages.
+ *
  * Returns NULL if no channels have been found.
  *
  * Note: result must be freed after use.
@@ -6031,7 +6617,7 @@ irc_server_build_autojoin (struct t_irc_server *server)
 {
     struct t_irc_channel *ptr_channel;
     char **channels_with_key, **channels_others, **keys;
-    int num_channels;
+    int num_channels, displayed, pass;
 
     channels_with_key = NULL;
     channels_others = NULL;
@@ -6049,12 +6635,22 @@ irc_server_build_autojoin (struct t_irc_server *server)
 
     num_channels = 0;
 
-    for (ptr_channel = server->channels; ptr_channel;
-         ptr_channel = ptr_channel->next_channel)
+    /* first pass: channels displayed, second pass: other channels */
+    for (pass = 1; pass >= 0; pass--)
     {
-        if ((ptr_channel->type == IRC_CHANNEL_TYPE_CHANNEL)
-            && !ptr_channel->part)
+        for (ptr_channel = server->channels; ptr_channel;
+             ptr_channel = ptr_channel->next_channel)
         {
+            if ((ptr_channel->type != IRC_CHANNEL_TYPE_CHANNEL)
+                || ptr_channel->part)
+            {
+                continue;
+            }
+            displayed = (ptr_channel->buffer
+                         && weechat_window_search_with_buffer (
+                             ptr_channel->buffer)) ? 1 : 0;
+            if (displayed != pass)
+                continue;
             if (ptr_channel->key)
             {
                 /* add channel with key and the key */
@@ -6111,6 +6707,89 @@ error:
     return NULL;
 }
 
+/*
+ * Starts a join burst: the channels in arguments of JOIN command
+ * ("#channel1,#channel2 key1") are joined, and the follow-up requests (MODE
+ * and WHO) of these channels are delayed until all channels are joined.
+ */
+
+void
+irc_server_join_burst_start (struct t_irc_server *server,
+                             const char *arguments)
+{
+    const char *ptr_arg;
+    int count;
+
+    if (!arguments || !arguments[0])
+        return;
+
+    count = 1;
+    for (ptr_arg = arguments; ptr_arg[0] && (ptr_arg[0] != ' '); ptr_arg++)
+    {
+        if (ptr_arg[0] == ',')
+            count++;
+    }
+
+    server->join_burst += count;
+    server->join_burst_time = time (NULL);
+}
+
+/*
+ * Checks if the follow-up requests (MODE and WHO) of a channel joined must be
+ * delayed because a join burst is in progress; in this case the channel is
+ * flagged and the requests will be sent by irc_server_join_burst_end().
+ *
+ * Returns:
+ *   1: requests are delayed
+ *   0: requests must be sent now
+ */
+
+int
+irc_server_join_burst_defer_check (struct t_irc_server *server,
+                                   struct t_irc_channel *channel)
+{
+    if (!server || !channel || (server->join_burst <= 0))
+        return 0;
+
+    channel->join_check_pending = 1;
+    server->join_burst--;
+    server->join_burst_time = time (NULL);
+
+    if (server->join_burst == 0)
+        irc_server_join_burst_end (server);
+
+    return 1;
+}
+
+/*
+ * Ends a join burst: sends follow-up requests (MODE and WHO) of all channels
+ * joined during the burst.
+ */
+
+void
+irc_server_join_burst_end (struct t_irc_server *server)
+{
+    struct t_irc_channel *ptr_channel;
+
+    if (!server)
+        return;
+
+    server->join_burst = 0;
+    server->join_burst_time = 0;
+
+    for (ptr_channel = server->channels; ptr_channel;
+         ptr_channel = ptr_channel->next_channel)
+    {
+        if (ptr_channel->join_check_pending)
+        {
+            ptr_channel->join_check_pending = 0;
+            irc_command_mode_server (server, "MODE", ptr_channel, NULL,
+                                     IRC_SERVER_SEND_OUTQ_PRIO_LOW);
+            irc_channel_check_whox (server, ptr_channel);
+        }
+    }
+}
+
 /*
  * Autojoins (or auto-rejoins) channels.
  */
@@ -6134,6 +6813,7 @@ irc_server_autojoin_channels (struct t_irc_server *server)
             IRC_SERVER_OPTION_STRING(server, IRC_SERVER_OPTION_AUTOJOIN));
         if (autojoin && autojoin[0])
         {
+            irc_server_join_burst_start (server, autojoin);
             irc_command_join_server (server, autojoin, 0, 0);
             server->autojoin_done = 1;
         }
@@ -6145,6 +6825,7 @@ irc_server_autojoin_channels (struct t_irc_server *server)
         autojoin = irc_server_build_autojoin (server);
         if (autojoin)
         {
+            irc_server_join_burst_start (server, autojoin);
             irc_server_sendf (server,
                               IRC_SERVER_SEND_OUTQ_PRIO_HIGH, NULL,
                               "JOIN %s",
@@ -6571,6 +7252,7 @@ irc_server_hdata_server_cb (const void *pointer, void *data,
         WEECHAT_HDATA_VAR(struct t_irc_server, hook_timer_connection, POINTER, 0, NULL, "hook");
         WEECHAT_HDATA_VAR(struct t_irc_server, hook_timer_sasl, POINTER, 0, NULL, "hook");
         WEECHAT_HDATA_VAR(struct t_irc_server, hook_timer_anti_flood, POINTER, 0, NULL, "hook");
+        WEECHAT_HDATA_VAR(struct t_irc_server, hook_timer_recv_process, POINTER, 0, NULL, "hook");
         WEECHAT_HDATA_VAR(struct t_irc_server, sasl_scram_client_first, STRING, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, sasl_scram_salted_pwd, OTHER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, sasl_scram_salted_pwd_size, INTEGER, 0, NULL, NULL);
@@ -6585,7 +7267,14 @@ irc_server_hdata_server_cb (const void *pointer, void *data,
         WEECHAT_HDATA_VAR(struct t_irc_server, gnutls_sess, POINTER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, tls_cert, POINTER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, tls_cert_key, POINTER, 0, NULL, NULL);
-        WEECHAT_HDATA_VAR(struct t_irc_server, unterminated_message, STRING, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_server, tls_session_address, STRING, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_server, recv_buffer, POINTER, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_server, recv_buffer_old, POINTER, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_server, recv_buffer_size, INTEGER, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_server, recv_buffer_length, INTEGER, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_server, recv_buffer_pos, INTEGER, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_server, recv_buffer_processing, INTEGER, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_server, messages_recv, LONGLONG, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, nicks_count, INTEGER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, nicks_array, STRING, 0, "*,nicks_count", NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, nick_first_tried, INTEGER, 0, NULL, NULL);
@@ -6616,12 +7305,16 @@ irc_server_hdata_server_cb (const void *pointer, void *data,
         WEECHAT_HDATA_VAR(struct t_irc_server, clienttagdeny_count, INTEGER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, clienttagdeny_array, STRING, 0, "*,clienttagdeny_count", NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, typing_allowed, INTEGER, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_server, chathistory_requests, INTEGER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, reconnect_delay, INTEGER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, reconnect_start, TIME, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_server, reconnect_count, INTEGER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, command_time, TIME, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, autojoin_time, TIME, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, autojoin_done, INTEGER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, disable_autojoin, INTEGER, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_server, join_burst, INTEGER, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_server, join_burst_time, TIME, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, is_away, INTEGER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, away_message, STRING, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, away_time, TIME, 0, NULL, NULL);
@@ -6636,6 +7329,13 @@ irc_server_hdata_server_cb (const void *pointer, void *data,
         WEECHAT_HDATA_VAR(struct t_irc_server, last_data_purge, TIME, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, outqueue, POINTER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, last_outqueue, POINTER, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_server, outqueue_count, INTEGER, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_server, anti_flood_time, OTHER, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_server, outqueue_sent, LONGLONG, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_server, outqueue_wait_total, LONGLONG, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_server, outqueue_wait_max, LONGLONG, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_server, send_buffer, POINTER, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_server, send_buffer_length, INTEGER, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, redirects, POINTER, 0, NULL, "irc_redirect");
         WEECHAT_HDATA_VAR(struct t_irc_server, last_redirect, POINTER, 0, NULL, "irc_redirect");
         WEECHAT_HDATA_VAR(struct t_irc_server, notify_list, POINTER, 0, NULL, "irc_notify");
@@ -6646,6 +7346,7 @@ irc_server_hdata_server_cb (const void *pointer, void *data,
         WEECHAT_HDATA_VAR(struct t_irc_server, join_noswitch, HASHTABLE, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, echo_msg_recv, HASHTABLE, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, names_channel_filter, HASHTABLE, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_irc_server, nicks_channels, HASHTABLE, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_irc_server, batches, POINTER, 0, NULL, "irc_batch");
         WEECHAT_HDATA_VAR(struct t_irc_server, last_batch, POINTER, 0, NULL, "irc_batch");
         WEECHAT_HDATA_VAR(struct t_irc_server, buffer, POINTER, 0, NULL, "buffer");
@@ -6806,6 +7507,12 @@ irc_server_add_to_infolist (struct t_infolist *infolist,
     if (!weechat_infolist_new_var_integer (ptr_item, "anti_flood",
                                            IRC_SERVER_OPTION_INTEGER(server, IRC_SERVER_OPTION_ANTI_FLOOD)))
         return 0;
+    if (!weechat_infolist_new_var_integer (ptr_item, "anti_flood_burst",
+                                           IRC_SERVER_OPTION_INTEGER(server, IRC_SERVER_OPTION_ANTI_FLOOD_BURST)))
+        return 0;
+    if (!weechat_infolist_new_var_integer (ptr_item, "anti_flood_bytes",
+                                           IRC_SERVER_OPTION_INTEGER(server, IRC_SERVER_OPTION_ANTI_FLOOD_BYTES)))
+        return 0;
     if (!weechat_infolist_new_var_integer (ptr_item, "away_check",
                                            IRC_SERVER_OPTION_INTEGER(server, IRC_SERVER_OPTION_AWAY_CHECK)))
         return 0;
@@ -6922,7 +7629,9 @@ irc_server_add_to_infolist (struct t_infolist *infolist,
             return 0;
         if (!weechat_infolist_new_var_integer (ptr_item, "disconnected", server->disconnected))
             return 0;
-        if (!weechat_infolist_new_var_string (ptr_item, "unterminated_message", server->unterminated_message))
+        if (!weechat_infolist_new_var_string (ptr_item, "unterminated_message",
+                                              (server->recv_buffer) ?
+                                              server->recv_buffer + server->recv_buffer_pos : NULL))
             return 0;
         if (!weechat_infolist_new_var_integer (ptr_item, "monitor", server->monitor))
             return 0;
@@ -7288,6 +7997,20 @@ irc_server_print_log ()
         else
             weechat_log_printf ("  anti_flood. . . . . . . . : %d",
                                 weechat_config_integer (ptr_server->options[IRC_SERVER_OPTION_ANTI_FLOOD]));
+        /* anti_flood_burst */
+        if (weechat_config_option_is_null (ptr_server->options[IRC_SERVER_OPTION_ANTI_FLOOD_BURST]))
+            weechat_log_printf ("  anti_flood_burst. . . . . : null (%d)",
+                                IRC_SERVER_OPTION_INTEGER(ptr_server, IRC_SERVER_OPTION_ANTI_FLOOD_BURST));
+        else
+            weechat_log_printf ("  anti_flood_burst. . . . . : %d",
+                                weechat_config_integer (ptr_server->options[IRC_SERVER_OPTION_ANTI_FLOOD_BURST]));
+        /* anti_flood_bytes */
+        if (weechat_config_option_is_null (ptr_server->options[IRC_SERVER_OPTION_ANTI_FLOOD_BYTES]))
+            weechat_log_printf ("  anti_flood_bytes. . . . . : null (%d)",
+                                IRC_SERVER_OPTION_INTEGER(ptr_server, IRC_SERVER_OPTION_ANTI_FLOOD_BYTES));
+        else
+            weechat_log_printf ("  anti_flood_bytes. . . . . : %d",
+                                weechat_config_integer (ptr_server->options[IRC_SERVER_OPTION_ANTI_FLOOD_BYTES]));
         /* away_check */
         if (weechat_config_option_is_null (ptr_server->options[IRC_SERVER_OPTION_AWAY_CHECK]))
             weechat_log_printf ("  away_check. . . . . . . . : null (%d)",
@@ -7344,6 +8067,7 @@ irc_server_print_log ()
         weechat_log_printf ("  hook_timer_connection . . : %p", ptr_server->hook_timer_connection);
         weechat_log_printf ("  hook_timer_sasl . . . . . : %p", ptr_server->hook_timer_sasl);
         weechat_log_printf ("  hook_timer_anti_flood . . : %p", ptr_server->hook_timer_anti_flood);
+        weechat_log_printf ("  hook_timer_recv_process . : %p", ptr_server->hook_timer_recv_process);
         weechat_log_printf ("  sasl_scram_client_first . : '%s'", ptr_server->sasl_scram_client_first);
         weechat_log_printf ("  sasl_scram_salted_pwd . . : (hidden)");
         weechat_log_printf ("  sasl_scram_salted_pwd_size: %d", ptr_server->sasl_scram_salted_pwd_size);
@@ -7358,7 +8082,17 @@ irc_server_print_log ()
         weechat_log_printf ("  gnutls_sess . . . . . . . : %p", ptr_server->gnutls_sess);
         weechat_log_printf ("  tls_cert. . . . . . . . . : %p", ptr_server->tls_cert);
         weechat_log_printf ("  tls_cert_key. . . . . . . : %p", ptr_server->tls_cert_key);
-        weechat_log_printf ("  unterminated_message. . . : '%s'", ptr_server->unterminated_message);
+        weechat_log_printf ("  tls_session_data. . . . . : %p (size: %u)",
+                            ptr_server->tls_session_data.data,
+                            ptr_server->tls_session_data.size);
+        weechat_log_printf ("  tls_session_address . . . : '%s'", ptr_server->tls_session_address);
+        weechat_log_printf ("  recv_buffer . . . . . . . : %p", ptr_server->recv_buffer);
+        weechat_log_printf ("  recv_buffer_old . . . . . : %p", ptr_server->recv_buffer_old);
+        weechat_log_printf ("  recv_buffer_size. . . . . : %d", ptr_server->recv_buffer_size);
+        weechat_log_printf ("  recv_buffer_length. . . . : %d", ptr_server->recv_buffer_length);
+        weechat_log_printf ("  recv_buffer_pos . . . . . : %d", ptr_server->recv_buffer_pos);
+        weechat_log_printf ("  recv_buffer_processing. . : %d", ptr_server->recv_buffer_processing);
+        weechat_log_printf ("  messages_recv . . . . . . : %lld", ptr_server->messages_recv);
         weechat_log_printf ("  nicks_count . . . . . . . : %d", ptr_server->nicks_count);
         weechat_log_printf ("  nicks_array . . . . . . . : %p", ptr_server->nicks_array);
         weechat_log_printf ("  nick_first_tried. . . . . : %d", ptr_server->nick_first_tried);
@@ -7398,12 +8132,17 @@ irc_server_print_log ()
         weechat_log_printf ("  clienttagdeny_count . . . : %d", ptr_server->clienttagdeny_count);
         weechat_log_printf ("  clienttagdeny_array . . . : %p", ptr_server->clienttagdeny_array);
         weechat_log_printf ("  typing_allowed . .  . . . : %d", ptr_server->typing_allowed);
+        weechat_log_printf ("  typing_pending . .  . . . : %d", ptr_server->typing_pending);
+        weechat_log_printf ("  chathistory_requests. . . : %d", ptr_server->chathistory_requests);
         weechat_log_printf ("  reconnect_delay . . . . . : %d", ptr_server->reconnect_delay);
         weechat_log_printf ("  reconnect_start . . . . . : %lld", (long long)ptr_server->reconnect_start);
+        weechat_log_printf ("  reconnect_count . . . . . : %d", ptr_server->reconnect_count);
         weechat_log_printf ("  command_time. . . . . . . : %lld", (long long)ptr_server->command_time);
         weechat_log_printf ("  autojoin_time . . . . . . : %lld", (long long)ptr_server->autojoin_time);
         weechat_log_printf ("  autojoin_done . . . . . . : %d", ptr_server->autojoin_done);
         weechat_log_printf ("  disable_autojoin. . . . . : %d", ptr_server->disable_autojoin);
+        weechat_log_printf ("  join_burst. . . . . . . . : %d", ptr_server->join_burst);
+        weechat_log_printf ("  join_burst_time . . . . . : %lld", (long long)ptr_server->join_burst_time);
         weechat_log_printf ("  is_away . . . . . . . . . : %d", ptr_server->is_away);
         weechat_log_printf ("  away_message. . . . . . . : '%s'", ptr_server->away_message);
         weechat_log_printf ("  away_time . . . . . . . . : %lld", (long long)ptr_server->away_time);
@@ -7420,6 +8159,7 @@ irc_server_print_log ()
         {
             weechat_log_printf ("    buffer. . . . . . . . . : %p", ptr_server->list->buffer);
             weechat_log_printf ("    channels. . . . . . . . : %p", ptr_server->list->channels);
+            weechat_log_printf ("    sort_channels . . . . . : %p", ptr_server->list->sort_channels);
             weechat_log_printf ("    filter_channels . . . . : %p", ptr_server->list->filter_channels);
         }
         weechat_log_printf ("  last_away_check . . . . . : %lld", (long long)ptr_server->last_away_check);
@@ -7429,6 +8169,15 @@ irc_server_print_log ()
             weechat_log_printf ("  outqueue[%02d]. . . . . . . : %p", i, ptr_server->outqueue[i]);
             weechat_log_printf ("  last_outqueue[%02d] . . . . : %p", i, ptr_server->last_outqueue[i]);
         }
+        weechat_log_printf ("  outqueue_count. . . . . . : %d", ptr_server->outqueue_count);
+        weechat_log_printf ("  anti_flood_time . . . . . : %lld.%06ld",
+                            (long long)(ptr_server->anti_flood_time.tv_sec),
+                            (long)(ptr_server->anti_flood_time.tv_usec));
+        weechat_log_printf ("  outqueue_sent . . . . . . : %lld", ptr_server->outqueue_sent);
+        weechat_log_printf ("  outqueue_wait_total . . . : %lld", ptr_server->outqueue_wait_total);
+        weechat_log_printf ("  outqueue_wait_max . . . . : %lld", ptr_server->outqueue_wait_max);
+        weechat_log_printf ("  send_buffer . . . . . . . : %p", ptr_server->send_buffer);
+        weechat_log_printf ("  send_buffer_length. . . . : %d", ptr_server->send_buffer_length);
         weechat_log_printf ("  redirects . . . . . . . . : %p", ptr_server->redirects);
         weechat_log_printf ("  last_redirect . . . . . . : %p", ptr_server->last_redirect);
         weechat_log_printf ("  notify_list . . . . . . . : %p", ptr_server->notify_list);
@@ -7449,6 +8198,9 @@ irc_server_print_log ()
         weechat_log_printf ("  names_channel_filter. . . : %p (hashtable: '%s')",
                             ptr_server->names_channel_filter,
                             weechat_hashtable_get_string (ptr_server->names_channel_filter, "keys_values"));
+        weechat_log_printf ("  nicks_channels. . . . . . : %p (items: %d)",
+                            ptr_server->nicks_channels,
+                            weechat_hashtable_get_integer (ptr_server->nicks_channels, "items_count"));
         weechat_log_printf ("  batches . . . . . . . . . : %p", ptr_server->batches);
         weechat_log_printf ("  last_batch. . . . . . . . : %p", ptr_server->last_batch);
         weechat_log_printf ("  buffer. . . . . . . . . . : %p", ptr_server->buffer);
@@ -85,6 +85,8 @@ enum t_irc_server_option
     IRC_SERVER_OPTION_AUTOREJOIN_DELAY,     /* delay before auto rejoin      */
     IRC_SERVER_OPTION_CONNECTION_TIMEOUT,   /* timeout for connection        */
     IRC_SERVER_OPTION_ANTI_FLOOD,           /* anti-flood (in ms)            */
+    IRC_SERVER_OPTION_ANTI_FLOOD_BURST,     /* anti-flood: max burst (msgs)  */
+    IRC_SERVER_OPTION_ANTI_FLOOD_BYTES,     /* anti-flood: bytes per msg     */
     IRC_SERVER_OPTION_AWAY_CHECK,           /* delay between away checks     */
     IRC_SERVER_OPTION_AWAY_CHECK_MAX_NICKS, /* max nicks for away check      */
     IRC_SERVER_OPTION_MSG_KICK,             /* default kick message          */
@@ -119,6 +121,18 @@ enum t_irc_server_option
 /* number of queues for sending messages */
 #define IRC_SERVER_NUM_OUTQUEUES_PRIO 3
 
+/*
+ * max size of messages sent in one call to send/gnutls_record_send
+ * (max size of data in a TLS record)
+ */
+#define IRC_SERVER_SEND_BUFFER_SIZE 16384
+
+/*
+ * max delay (in seconds) between two channels joined during auto-join: when
+ * this delay is reached, the join burst is considered as drained
+ */
+#define IRC_SERVER_JOIN_BURST_TIMEOUT 10
+
 /* flags for irc_server_sendf() */
 #define IRC_SERVER_SEND_OUTQ_PRIO_IMMEDIATE (1 << 0)
 #define IRC_SERVER_SEND_OUTQ_PRIO_HIGH      (1 << 1)
@@ -170,6 +184,7 @@ struct t_irc_outqueue
     int modified;                         /* msg was modified by modifier(s) */
     char *tags;                           /* tags (used by Relay plugin)     */
     struct t_irc_redirect *redirect;      /* command redirection             */
+    struct timeval date_added;            /* date of msg added in queue      */
     struct t_irc_outqueue *next_outqueue; /* link to next msg in queue       */
     struct t_irc_outqueue *prev_outqueue; /* link to prev msg in queue       */
 };
@@ -202,6 +217,8 @@ struct t_irc_server
     struct t_hook *hook_timer_connection; /* timer for connection            */
     struct t_hook *hook_timer_sasl; /* timer for SASL authentication         */
     struct t_hook *hook_timer_anti_flood; /* anti-flood timer                */
+    struct t_hook *hook_timer_recv_process; /* timer to process received   */
+                                    /* messages (if max time is reached)     */
     char *sasl_scram_client_first;  /* first message sent for SASL SCRAM     */
     char *sasl_scram_salted_pwd;    /* salted password for SASL SCRAM        */
     int sasl_scram_salted_pwd_size; /* size of salted password for SASL SCRAM*/
@@ -216,7 +233,18 @@ struct t_irc_server
     gnutls_session_t gnutls_sess;   /* gnutls session (only if TLS is used)  */
     gnutls_x509_crt_t tls_cert;     /* certificate used if tls_cert is set   */
     gnutls_x509_privkey_t tls_cert_key; /* key used if tls_cert is set       */
-    char *unterminated_message;     /* beginning of a message in input buf   */
+    gnutls_datum_t tls_session_data; /* data of last TLS session (to resume */
+                                    /* it on next connection)               */
+    char *tls_session_address;      /* "address/port" of tls_session_data   */
+    char *recv_buffer;              /* data received from server (complete  */
+                                    /* messages + unterminated message)      */
+    char *recv_buffer_old;          /* previous receive buffer, kept until   */
+                                    /* end of processing of messages         */
+    int recv_buffer_size;           /* allocated size of receive buffer      */
+    int recv_buffer_length;         /* length of data in receive buffer      */
+    int recv_buffer_pos;            /* position of next message to process   */
+    int recv_buffer_processing;     /* 1 if messages are being processed     */
+    long long messages_recv;        /* number of messages received           */
     int nicks_count;                /* number of nicknames                   */
     char **nicks_array;             /* nicknames (after split)               */
     int nick_first_tried;           /* first nick tried in list of nicks     */
@@ -251,14 +279,21 @@ struct t_irc_server
     int clienttagdeny_count;        /* number of masks in clienttagdeny      */
     char **clienttagdeny_array;     /* masks expanded from clienttagdeny     */
     int typing_allowed;             /* typing not excluded by clienttagdeny? */
+    int typing_pending;             /* 1 if channels have a typing status    */
+                                    /* to send                               */
+    int chathistory_requests;       /* CHATHISTORY requests not answered    */
     int reconnect_delay;            /* current reconnect delay (growing)     */
     time_t reconnect_start;         /* this time + delay = reconnect time    */
+    int reconnect_count;            /* number of reconnections               */
     time_t command_time;            /* this time + command_delay = time to   */
                                     /* execute command                       */
     time_t autojoin_time;           /* this time + autojoin_delay = time to  */
                                     /* auto-join channels                    */
     int autojoin_done;              /* 1 if autojoin has been done           */
     int disable_autojoin;           /* 1 if user asked to not autojoin chans */
+    int join_burst;                 /* number of channels auto-joined not    */
+                                    /* yet fully joined (end of names)       */
+    time_t join_burst_time;         /* time of last channel joined in burst  */
     int is_away;                    /* 1 is user is marked as away           */
     char *away_message;             /* away message, NULL if not away        */
     time_t away_time;               /* time() when user marking as away      */
@@ -276,6 +311,18 @@ struct t_irc_server
                                              /* with 2 priorities (high/low) */
     struct t_irc_outqueue *last_outqueue[IRC_SERVER_NUM_OUTQUEUES_PRIO];
                                              /* last outgoing message        */
+    int outqueue_count;                      /* number of msgs in queues     */
+    struct timeval anti_flood_time;          /* anti-flood (token bucket):   */
+                                             /* date when bucket is full     */
+    long long outqueue_sent;                 /* number of msgs sent from     */
+                                             /* queues                       */
+    long long outqueue_wait_total;           /* total wait time of msgs sent */
+                                             /* (in microseconds)            */
+    long long outqueue_wait_max;             /* max wait time of a msg sent  */
+                                             /* (in microseconds)            */
+    char *send_buffer;                       /* messages to send in a     */
+                                             /* single call (batch)          */
+    int send_buffer_length;                  /* length of data to send       */
     struct t_irc_redirect *redirects;        /* command redirections         */
     struct t_irc_redirect *last_redirect;    /* last command redirection     */
     struct t_irc_notify *notify_list;        /* list of notify               */
@@ -286,6 +333,7 @@ struct t_irc_server
     struct t_hashtable *join_noswitch;       /* joins w/o switch to buffer   */
     struct t_hashtable *echo_msg_recv;    /* msg received with echo-message  */
     struct t_hashtable *names_channel_filter; /* filter for /names on channel*/
+    struct t_hashtable *nicks_channels;   /* channels by nick (lower case)   */
     struct t_irc_batch *batches;          /* batched events (cap "batch")    */
     struct t_irc_batch *last_batch;       /* last batch                      */
     struct t_gui_buffer *buffer;          /* GUI buffer allocated for server */
@@ -298,13 +346,6 @@ struct t_irc_server
 
 /* IRC messages */
 
-struct t_irc_message
-{
-    struct t_irc_server *server;        /* server pointer for received msg   */
-    char *data;                         /* message content                   */
-    struct t_irc_message *next_message; /* link to next message              */
-};
-
 /* digest algorithms for fingerprint */
 
 enum t_irc_fingerprint_digest_algo
@@ -323,7 +364,6 @@ extern char *irc_server_chanmodes_default;
 extern struct t_irc_server *irc_servers;
 extern const int gnutls_cert_type_prio[];
 extern const int gnutls_prot_prio[];
-extern struct t_irc_message *irc_recv_msgq, *irc_msgq_last_msg;
 extern char *irc_server_sasl_fail_string[];
 extern char *irc_server_options[][2];
 
@@ -337,6 +377,8 @@ extern int irc_server_strcasecmp (struct t_irc_server *server,
 extern int irc_server_strncasecmp (struct t_irc_server *server,
                                    const char *string1, const char *string2,
                                    int max);
+extern char *irc_server_string_tolower (struct t_irc_server *server,
+                                        const char *string);
 extern char *irc_server_eval_expression (struct t_irc_server *server,
                                          const char *string);
 extern void irc_server_sasl_get_creds (struct t_irc_server *server,
@@ -357,6 +399,8 @@ extern void irc_server_set_host (struct t_irc_server *server,
 extern const char *irc_server_get_alternate_nick (struct t_irc_server *server);
 extern const char *irc_server_get_isupport_value (struct t_irc_server *server,
                                                   const char *feature);
+extern int irc_server_get_max_targets (struct t_irc_server *server,
+                                       const char *command);
 extern const char *irc_server_get_chantypes (struct t_irc_server *server);
 extern void irc_server_set_prefix_modes_chars (struct t_irc_server *server,
                                                const char *prefix);
@@ -400,21 +444,40 @@ extern int irc_server_send_signal (struct t_irc_server *server,
                                    const char *full_message,
                                    const char *tags);
 extern void irc_server_set_send_default_tags (const char *tags);
+extern long long irc_server_anti_flood_cost (struct t_irc_server *server,
+                                            const char *message);
+extern long long irc_server_anti_flood_wait (struct t_irc_server *server,
+                                            long long cost);
+extern void irc_server_anti_flood_add (struct t_irc_server *server,
+                                       long long cost);
 extern void irc_server_outqueue_timer_remove (struct t_irc_server *server);
 extern void irc_server_outqueue_timer_add (struct t_irc_server *server);
+extern int irc_server_send_buffer_flush (struct t_irc_server *server);
+extern int irc_server_send_buffer_add (struct t_irc_server *server,
+                                       const char *data, int length);
 extern struct t_arraylist *irc_server_sendf (struct t_irc_server *server,
                                              int flags,
                                              const char *tags,
                                              const char *format, ...);
-extern void irc_server_msgq_add_buffer (struct t_irc_server *server,
-                                        const char *buffer);
-extern void irc_server_msgq_flush ();
+extern char *irc_server_recv_buffer_grow (struct t_irc_server *server,
+                                          int size);
+extern int irc_server_recv_buffer_add (struct t_irc_server *server,
+                                       const char *data, int length);
+extern void irc_server_recv_buffer_reset (struct t_irc_server *server);
+extern void irc_server_msg_process (struct t_irc_server *server, char *msg);
+extern int irc_server_timer_recv_process_cb (const void *pointer, void *data,
+                                             int remaining_calls);
+extern void irc_server_recv_buffer_process (struct t_irc_server *server);
 extern void irc_server_set_buffer_title (struct t_irc_server *server);
 extern struct t_gui_buffer *irc_server_create_buffer (struct t_irc_server *server);
 char *irc_server_fingerprint_str_sizes ();
+extern void irc_server_tls_session_free (struct t_irc_server *server);
 extern int irc_server_connect (struct t_irc_server *server);
 extern void irc_server_auto_connect (int auto_connect);
 extern void irc_server_autojoin_channels (struct t_irc_server *server);
+extern int irc_server_join_burst_defer_check (struct t_irc_server *server,
+                                              struct t_irc_channel *channel);
+extern void irc_server_join_burst_end (struct t_irc_server *server);
 extern int irc_server_recv_cb (const void *pointer, void *data, int fd);
 extern int irc_server_timer_sasl_cb (const void *pointer, void *data,
                                      int remaining_calls);
@@ -83,6 +83,8 @@ irc_typing_signal_typing_self_cb (const void *pointer, void *data,
     {
         ptr_channel->typing_state = new_state;
         ptr_channel->typing_status_sent = 0;
+        if (new_state != IRC_CHANNEL_TYPING_STATE_OFF)
+            ptr_server->typing_pending = 1;
     }
 
     return WEECHAT_RC_OK;
@@ -98,6 +100,10 @@ irc_typing_send_to_targets (struct t_irc_server *server)
     struct t_irc_channel *ptr_channel;
     time_t current_time;
 
+    /* nothing to send? (avoid a loop on all channels every second) */
+    if (!server->typing_pending)
+        return;
+
     if (!weechat_config_boolean (irc_config_look_typing_status_self)
         || !server->typing_allowed)
     {
@@ -106,6 +112,8 @@ irc_typing_send_to_targets (struct t_irc_server *server)
 
     current_time = time (NULL);
 
+    server->typing_pending = 0;
+
     for (ptr_channel = server->channels; ptr_channel;
          ptr_channel = ptr_channel->next_channel)
     {
@@ -129,6 +137,11 @@ irc_typing_send_to_targets (struct t_irc_server *server)
                 ptr_channel->typing_status_sent = 0;
             }
         }
+        if (!ptr_channel->part
+            && (ptr_channel->typing_state != IRC_CHANNEL_TYPING_STATE_OFF))
+        {
+            server->typing_pending = 1;
+        }
     }
 }
 
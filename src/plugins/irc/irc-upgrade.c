@@ -450,7 +450,10 @@ irc_upgrade_read_cb (const void *pointer, void *data,
                     irc_upgrade_current_server->disconnected = weechat_infolist_integer (infolist, "disconnected");
                     str = weechat_infolist_string (infolist, "unterminated_message");
                     if (str)
-                        irc_upgrade_current_server->unterminated_message = strdup (str);
+                    {
+                        irc_server_recv_buffer_add (irc_upgrade_current_server,
+                                                    str, strlen (str));
+                    }
                     str = weechat_infolist_string (infolist, "nick");
                     if (str)
                         irc_server_set_nick (irc_upgrade_current_server, str);
@@ -716,6 +719,7 @@ irc_upgrade_read_cb (const void *pointer, void *data,
                         irc_upgrade_current_channel->cycle = weechat_infolist_integer (infolist, "cycle");
                         irc_upgrade_current_channel->part = weechat_infolist_integer (infolist, "part");
                         irc_upgrade_current_channel->nick_completion_reset = weechat_infolist_integer (infolist, "nick_completion_reset");
+                        irc_upgrade_current_channel->nicklist_lazy = weechat_infolist_integer (infolist, "nicklist_lazy");
                         for (i = 0; i < 2; i++)
                         {
                             index = 0;
@@ -934,6 +938,10 @@ irc_upgrade_read_cb (const void *pointer, void *data,
                         if (str)
                             ptr_redirect->output = strdup (str);
                         ptr_redirect->output_size = weechat_infolist_integer (infolist, "output_size");
+                        ptr_redirect->output_alloc = (ptr_redirect->output) ?
+                            (int)strlen (ptr_redirect->output) + 1 : 0;
+                        if (ptr_redirect->output_size > ptr_redirect->output_alloc)
+                            ptr_redirect->output_size = ptr_redirect->output_alloc;
                     }
                 }
                 break;
@@ -38,11 +38,13 @@
 #include "irc-info.h"
 #include "irc-input.h"
 #include "irc-list.h"
+#include "irc-message.h"
 #include "irc-nick.h"
 #include "irc-notify.h"
 #include "irc-protocol.h"
 #include "irc-raw.h"
 #include "irc-redirect.h"
+#include "irc-sasl.h"
 #include "irc-server.h"
 #include "irc-tag.h"
 #include "irc-typing.h"
@@ -231,6 +233,10 @@ weechat_plugin_init (struct t_weechat_plugin *plugin, int argc, char *argv[])
                          &irc_typing_signal_typing_self_cb, NULL, NULL);
     weechat_hook_signal ("window_scrolled",
                          &irc_list_window_scrolled_cb, NULL, NULL);
+    weechat_hook_signal ("buffer_switch",
+                         &irc_channel_nicklist_signal_cb, NULL, NULL);
+    weechat_hook_signal ("buffer_nicklist_request",
+                         &irc_channel_nicklist_signal_cb, NULL, NULL);
 
     /* hook hsignals for redirection */
     weechat_hook_hsignal ("irc_redirect_pattern",
@@ -301,6 +307,8 @@ weechat_plugin_init (struct t_weechat_plugin *plugin, int argc, char *argv[])
     irc_hook_timer = weechat_hook_timer (1 * 1000, 0, 0,
                                          &irc_server_timer_cb,
                                          NULL, NULL);
+    /* allow a small delay to be called with other timers */
+    weechat_hook_set (irc_hook_timer, "slack", "500");
 
     return WEECHAT_RC_OK;
 }
@@ -348,5 +356,9 @@ weechat_plugin_end (struct t_weechat_plugin *plugin)
 
     irc_color_end ();
 
+    irc_sasl_end ();
+
+    irc_message_end ();
+
     return WEECHAT_RC_OK;
 }
@@ -112,6 +112,9 @@ extern "C"
 #define API_RETURN_LONG(__int)                                          \
     return v8::Number::New(__int)
 
+/* API object template, shared by all scripts (built with first script) */
+v8::Persistent<v8::ObjectTemplate> weechat_js_api_template;
+
 
 /*
  * Registers a javascript script.
@@ -5169,6 +5172,32 @@ API_FUNC(hdata_hashtable)
     return result_obj;
 }
 
+API_FUNC(hdata_get_fields)
+{
+    int count;
+    struct t_hashtable *result_hashtable;
+    v8::Handle<v8::Object> result_obj;
+
+    API_INIT_FUNC(1, "hdata_get_fields", "ssis", API_RETURN_EMPTY);
+
+    v8::String::Utf8Value hdata(args[0]);
+    v8::String::Utf8Value pointer(args[1]);
+    count = args[2]->IntegerValue();
+    v8::String::Utf8Value fields(args[3]);
+
+    result_hashtable = weechat_hdata_get_fields (
+        (struct t_hdata *)API_STR2PTR(*hdata),
+        API_STR2PTR(*pointer),
+        count,
+        *fields);
+    result_obj = weechat_js_hashtable_to_object (result_hashtable);
+
+    if (result_hashtable)
+        weechat_hashtable_free (result_hashtable);
+
+    return result_obj;
+}
+
 API_FUNC(hdata_compare)
 {
     int case_sensitive, rc;
@@ -5340,11 +5369,25 @@ API_FUNC(upgrade_close)
     API_RETURN_OK;
 }
 
+/*
+ * Loads the API object "weechat" in global of interpreter.
+ *
+ * The object template (constants and functions) is built only once, when
+ * the first script is loaded, then it is shared by all scripts (each script
+ * has its own context, created from this template).
+ */
+
 void
 WeechatJsV8::loadLibs()
 {
     int i;
 
+    if (!weechat_js_api_template.IsEmpty())
+    {
+        this->addGlobal ("weechat", weechat_js_api_template);
+        return;
+    }
+
     v8::Local<v8::ObjectTemplate> weechat_obj = v8::ObjectTemplate::New();
 
     /* interface constants */
@@ -5578,6 +5621,7 @@ WeechatJsV8::loadLibs()
     API_DEF_FUNC(hdata_pointer);
     API_DEF_FUNC(hdata_time);
     API_DEF_FUNC(hdata_hashtable);
+    API_DEF_FUNC(hdata_get_fields);
     API_DEF_FUNC(hdata_compare);
     API_DEF_FUNC(hdata_update);
     API_DEF_FUNC(hdata_get_string);
@@ -5586,5 +5630,22 @@ WeechatJsV8::loadLibs()
     API_DEF_FUNC(upgrade_read);
     API_DEF_FUNC(upgrade_close);
 
-    this->addGlobal ("weechat", weechat_obj);
+    weechat_js_api_template =
+        v8::Persistent<v8::ObjectTemplate>::New(weechat_obj);
+
+    this->addGlobal ("weechat", weechat_js_api_template);
+}
+
+/*
+ * Frees the API object template shared by all scripts.
+ */
+
+void
+weechat_js_api_end ()
+{
+    if (!weechat_js_api_template.IsEmpty())
+    {
+        weechat_js_api_template.Dispose();
+        weechat_js_api_template.Clear();
+    }
 }
@@ -28,5 +28,6 @@ extern int weechat_js_api_buffer_input_data_cb (const void *pointer,
 extern int weechat_js_api_buffer_close_cb (const void *pointer,
                                            void *data,
                                            struct t_gui_buffer *buffer);
+extern void weechat_js_api_end ();
 
 #endif /* WEECHAT_PLUGIN_JS_API_H */
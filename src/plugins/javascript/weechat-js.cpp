@@ -48,6 +48,7 @@ struct t_plugin_script_data js_data;
 struct t_config_file *js_config_file = NULL;
 struct t_config_option *js_config_look_check_license = NULL;
 struct t_config_option *js_config_look_eval_keep_context = NULL;
+struct t_config_option *js_config_look_autoload_deferred = NULL;
 
 int js_quiet = 0;
 
@@ -421,13 +422,18 @@ void
 weechat_js_load_cb (void *data, const char *filename)
 {
     const char *pos_dot;
-
-    /* make C++ compiler happy */
-    (void) data;
+    int old_js_quiet;
 
     pos_dot = strrchr (filename, '.');
     if (pos_dot && (strcmp (pos_dot, ".js") == 0))
+    {
+        /* data is an optional pointer to integer: 1 for quiet mode */
+        old_js_quiet = js_quiet;
+        if (data && *((int *)data))
+            js_quiet = 1;
         weechat_js_load (filename, NULL);
+        js_quiet = old_js_quiet;
+    }
 }
 
 /*
@@ -945,6 +951,7 @@ weechat_plugin_init (struct t_weechat_plugin *plugin, int argc, char *argv[])
     js_data.config_file = &js_config_file;
     js_data.config_look_check_license = &js_config_look_check_license;
     js_data.config_look_eval_keep_context = &js_config_look_eval_keep_context;
+    js_data.config_look_autoload_deferred = &js_config_look_autoload_deferred;
     js_data.scripts = &js_scripts;
     js_data.last_script = &last_js_script;
     js_data.callback_command = &weechat_js_command_cb;
@@ -987,6 +994,8 @@ weechat_plugin_end (struct t_weechat_plugin *plugin)
     plugin_script_end (plugin, &js_data);
     js_quiet = old_js_quiet;
 
+    weechat_js_api_end ();
+
     /* free some data */
     if (js_action_install_list)
     {
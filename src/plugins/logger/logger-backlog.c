@@ -42,7 +42,9 @@
 #include "logger-buffer.h"
 #include "logger-command.h"
 #include "logger-config.h"
+#include "logger-index.h"
 #include "logger-info.h"
+#include "logger-reader.h"
 #include "logger-tail.h"
 
 
@@ -160,11 +162,15 @@ logger_backlog_msg_free_cb (void *data, struct t_arraylist *arraylist,
  * line of a message, and subsequent lines without timestamp are the rest of
  * the message.
  *
+ * If time_format is NULL, the option logger.file.time_format is used
+ * (time_format must be set if this function is called by the reader thread).
+ *
  * Note: result must be freed after use.
  */
 
 struct t_arraylist *
-logger_backlog_group_messages (struct t_arraylist *lines)
+logger_backlog_group_messages (struct t_arraylist *lines,
+                               const char *time_format)
 {
     int i, size, time_found;
     char *message, *new_message, *str_date, *error;
@@ -175,6 +181,9 @@ logger_backlog_group_messages (struct t_arraylist *lines)
     if (!lines)
         return NULL;
 
+    if (!time_format)
+        time_format = weechat_config_string (logger_config_file_time_format);
+
     message = NULL;
 
     size = weechat_arraylist_size (lines);
@@ -216,10 +225,7 @@ logger_backlog_group_messages (struct t_arraylist *lines)
             if (str_date)
             {
                 memset (&tm_line, 0, sizeof (struct tm));
-                error = strptime (
-                    str_date,
-                    weechat_config_string (logger_config_file_time_format),
-                    &tm_line);
+                error = strptime (str_date, time_format, &tm_line);
                 if (error && !error[0] && (tm_line.tm_year > 0))
                     time_found = 1;
                 free (str_date);
@@ -248,29 +254,58 @@ error:
 }
 
 /*
- * Displays backlog for a buffer by reading end of log file.
+ * Reads the last messages of a log file.
+ *
+ * If use_index == 1, the index of log file is used (if it exists) to read
+ * directly the last messages, otherwise the end of log file is read
+ * backwards.
+ *
+ * This function is called by the main thread or by the reader thread, so it
+ * must not use any option (time_format must be set, see function
+ * logger_backlog_group_messages).
+ *
+ * Note: result must be freed after use.
  */
 
-void
-logger_backlog_file (struct t_gui_buffer *buffer, const char *filename,
-                     int lines)
+struct t_arraylist *
+logger_backlog_read (const char *filename, int lines, int use_index,
+                     const char *time_format)
 {
     struct t_arraylist *last_lines, *messages;
-    int i, num_msgs, old_input_multiline;
-
-    last_lines = logger_tail_file (filename, lines);
-    if (!last_lines)
-        return;
+    off_t offset;
 
-    messages = logger_backlog_group_messages (last_lines);
-    if (!messages)
+    last_lines = NULL;
+    if (use_index)
     {
-        weechat_arraylist_free (last_lines);
-        return;
+        offset = logger_index_tail_offset (filename, lines);
+        if (offset >= 0)
+            last_lines = logger_tail_file_from_offset (filename, offset);
     }
+    if (!last_lines)
+        last_lines = logger_tail_file (filename, lines);
+    if (!last_lines)
+        return NULL;
+
+    messages = logger_backlog_group_messages (last_lines, time_format);
 
     weechat_arraylist_free (last_lines);
 
+    return messages;
+}
+
+/*
+ * Displays messages read in a log file (backlog) in a buffer.
+ */
+
+void
+logger_backlog_display (struct t_gui_buffer *buffer,
+                        struct t_arraylist *messages)
+{
+    int i, num_msgs, old_input_multiline;
+
+    if (!buffer || !messages)
+        return;
+
     /* disable any print hook during display of backlog */
     weechat_buffer_set (buffer, "print_hooks_enabled", "0");
 
@@ -278,6 +313,8 @@ logger_backlog_file (struct t_gui_buffer *buffer, const char *filename,
     old_input_multiline = weechat_buffer_get_integer (buffer, "input_multiline");
     weechat_buffer_set (buffer, "input_multiline", "1");
 
+    weechat_printf_lines_begin (buffer);
+
     num_msgs = weechat_arraylist_size (messages);
     for (i = 0; i < num_msgs; i++)
     {
@@ -285,7 +322,6 @@ logger_backlog_file (struct t_gui_buffer *buffer, const char *filename,
             buffer,
             (const char *)weechat_arraylist_get (messages, i));
     }
-    weechat_arraylist_free (messages);
 
     if (num_msgs > 0)
     {
@@ -295,14 +331,43 @@ logger_backlog_file (struct t_gui_buffer *buffer, const char *filename,
                                   weechat_color (weechat_config_string (logger_config_color_backlog_end)),
                                   weechat_color (weechat_config_string (logger_config_color_backlog_end)),
                                   num_msgs);
-        weechat_buffer_set (buffer, "unread", "");
     }
 
+    weechat_printf_lines_end (buffer);
+
+    if (num_msgs > 0)
+        weechat_buffer_set (buffer, "unread", "");
+
     weechat_buffer_set (buffer, "input_multiline",
                         (old_input_multiline) ? "1" : "0");
     weechat_buffer_set (buffer, "print_hooks_enabled", "1");
 }
 
+/*
+ * Displays backlog for a buffer by reading end of log file.
+ *
+ * If the index of log files is enabled, it is used to read directly the
+ * last messages, otherwise the end of log file is read backwards.
+ */
+
+void
+logger_backlog_file (struct t_gui_buffer *buffer, const char *filename,
+                     int lines)
+{
+    struct t_arraylist *messages;
+
+    messages = logger_backlog_read (
+        filename, lines,
+        weechat_config_boolean (logger_config_file_index),
+        weechat_config_string (logger_config_file_time_format));
+    if (!messages)
+        return;
+
+    logger_backlog_display (buffer, messages);
+
+    weechat_arraylist_free (messages);
+}
+
 /*
  * Callback for signal "logger_backlog".
  */
@@ -337,6 +402,24 @@ logger_backlog_signal_cb (const void *pointer, void *data,
             logger_buffer_set_log_filename (ptr_logger_buffer);
         if (ptr_logger_buffer->log_filename)
         {
+            /*
+             * read backlog in the reader thread if the buffer is not
+             * displayed (backlog is displayed later)
+             */
+            if (weechat_config_boolean (logger_config_look_backlog_async)
+                && !ptr_logger_buffer->backlog_pending
+                && (weechat_buffer_get_integer (signal_data,
+                                                "num_displayed") == 0)
+                && logger_reader_add (
+                    signal_data,
+                    ptr_logger_buffer->log_filename,
+                    weechat_config_integer (logger_config_look_backlog),
+                    weechat_config_boolean (logger_config_file_index),
+                    weechat_config_string (logger_config_file_time_format)))
+            {
+                ptr_logger_buffer->backlog_pending = 1;
+                return WEECHAT_RC_OK;
+            }
             ptr_logger_buffer->log_enabled = 0;
             logger_backlog_file (signal_data,
                                  ptr_logger_buffer->log_filename,
@@ -20,6 +20,13 @@
 #ifndef WEECHAT_PLUGIN_LOGGER_BACKLOG_H
 #define WEECHAT_PLUGIN_LOGGER_BACKLOG_H
 
+struct t_arraylist;
+
+extern struct t_arraylist *logger_backlog_read (const char *filename,
+                                                int lines, int use_index,
+                                                const char *time_format);
+extern void logger_backlog_display (struct t_gui_buffer *buffer,
+                                    struct t_arraylist *messages);
 extern int logger_backlog_signal_cb (const void *pointer, void *data,
                                      const char *signal,
                                      const char *type_data, void *signal_data);
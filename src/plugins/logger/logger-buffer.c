@@ -35,6 +35,11 @@
 #include "logger.h"
 #include "logger-buffer.h"
 #include "logger-config.h"
+#include "logger-index.h"
+#include "logger-reader.h"
+#include "logger-search.h"
+#include "logger-writer.h"
+#include "logger-zstd.h"
 
 
 char *logger_buffer_compression_extension[LOGGER_BUFFER_NUM_COMPRESSION_TYPES] =
@@ -42,6 +47,7 @@ char *logger_buffer_compression_extension[LOGGER_BUFFER_NUM_COMPRESSION_TYPES] =
 
 struct t_logger_buffer *logger_buffers = NULL;
 struct t_logger_buffer *last_logger_buffer = NULL;
+struct t_hashtable *logger_buffers_hashtable = NULL; /* buffer -> logger buf. */
 
 
 /*
@@ -85,6 +91,17 @@ logger_buffer_add (struct t_gui_buffer *buffer, int log_level)
     if (!buffer)
         return NULL;
 
+    if (!logger_buffers_hashtable)
+    {
+        logger_buffers_hashtable = weechat_hashtable_new (
+            32,
+            WEECHAT_HASHTABLE_POINTER,
+            WEECHAT_HASHTABLE_POINTER,
+            NULL, NULL);
+        if (!logger_buffers_hashtable)
+            return NULL;
+    }
+
     if (weechat_logger_plugin->debug)
     {
         weechat_printf_date_tags (NULL, 0, "no_log",
@@ -100,10 +117,27 @@ logger_buffer_add (struct t_gui_buffer *buffer, int log_level)
         new_logger_buffer->log_filename = NULL;
         new_logger_buffer->log_file = NULL;
         new_logger_buffer->log_file_inode = 0;
+        new_logger_buffer->log_file_compressed = 0;
+        new_logger_buffer->log_file_size = 0;
+        new_logger_buffer->log_data = weechat_string_dyn_alloc (256);
+        if (!new_logger_buffer->log_data)
+        {
+            free (new_logger_buffer);
+            return NULL;
+        }
+        new_logger_buffer->index_fd = -1;
+        new_logger_buffer->index_entries = NULL;
+        new_logger_buffer->index_count = 0;
+        new_logger_buffer->index_count_alloc = 0;
+        new_logger_buffer->search_terms = NULL;
+        new_logger_buffer->search_num_postings = 0;
+        new_logger_buffer->search_day = 0;
+        new_logger_buffer->search_first_offset = 0;
         new_logger_buffer->log_enabled = 1;
         new_logger_buffer->log_level = log_level;
         new_logger_buffer->write_start_info_line = 1;
         new_logger_buffer->flush_needed = 0;
+        new_logger_buffer->backlog_pending = 0;
         new_logger_buffer->compressing = 0;
 
         new_logger_buffer->prev_buffer = last_logger_buffer;
@@ -113,6 +147,9 @@ logger_buffer_add (struct t_gui_buffer *buffer, int log_level)
         else
             logger_buffers = new_logger_buffer;
         last_logger_buffer = new_logger_buffer;
+
+        weechat_hashtable_set (logger_buffers_hashtable,
+                               buffer, new_logger_buffer);
     }
 
     return new_logger_buffer;
@@ -127,17 +164,10 @@ logger_buffer_add (struct t_gui_buffer *buffer, int log_level)
 struct t_logger_buffer *
 logger_buffer_search_buffer (struct t_gui_buffer *buffer)
 {
-    struct t_logger_buffer *ptr_logger_buffer;
-
-    for (ptr_logger_buffer = logger_buffers; ptr_logger_buffer;
-         ptr_logger_buffer = ptr_logger_buffer->next_buffer)
-    {
-        if (ptr_logger_buffer->buffer == buffer)
-            return ptr_logger_buffer;
-    }
+    if (!buffer || !logger_buffers_hashtable)
+        return NULL;
 
-    /* logger buffer not found */
-    return NULL;
+    return weechat_hashtable_get (logger_buffers_hashtable, buffer);
 }
 
 /*
@@ -225,6 +255,32 @@ logger_buffer_set_log_filename (struct t_logger_buffer *logger_buffer)
     logger_buffer->log_filename = log_filename;
 }
 
+/*
+ * Appends a message to the lines not yet sent to the writer thread, and adds
+ * it in index of log file.
+ *
+ * Returns offset of message in log file.
+ */
+
+off_t
+logger_buffer_append (struct t_logger_buffer *logger_buffer, time_t date,
+                      const char *message)
+{
+    off_t offset;
+    int length;
+
+    offset = logger_buffer->log_file_size
+        + (off_t)strlen (*(logger_buffer->log_data));
+    length = strlen (message);
+
+    weechat_string_dyn_concat (logger_buffer->log_data, message, length);
+    weechat_string_dyn_concat (logger_buffer->log_data, "\n", -1);
+
+    logger_index_add (logger_buffer, offset, length + 1, date);
+
+    return offset;
+}
+
 /*
  * Creates a log file.
  *
@@ -236,7 +292,7 @@ logger_buffer_set_log_filename (struct t_logger_buffer *logger_buffer)
 int
 logger_buffer_create_log_file (struct t_logger_buffer *logger_buffer)
 {
-    char *charset, *message, buf_time[256], buf_beginning[1024];
+    char *message, buf_time[256], buf_beginning[1024];
     int log_level, rc;
     struct timeval tv_now;
     struct stat statbuf;
@@ -256,6 +312,11 @@ logger_buffer_create_log_file (struct t_logger_buffer *logger_buffer)
         fclose (logger_buffer->log_file);
         logger_buffer->log_file = NULL;
         logger_buffer->log_file_inode = 0;
+        logger_buffer->log_file_size = 0;
+        logger_index_close (logger_buffer);
+        /* offsets in search index are not valid any more */
+        logger_search_free_terms (logger_buffer);
+        logger_search_remove_segments (logger_buffer->log_filename);
     }
 
     /* get log level */
@@ -304,9 +365,42 @@ logger_buffer_create_log_file (struct t_logger_buffer *logger_buffer)
         fclose (logger_buffer->log_file);
         logger_buffer->log_file = NULL;
         logger_buffer->log_file_inode = 0;
+        logger_buffer->log_file_size = 0;
         return 0;
     }
     logger_buffer->log_file_inode = statbuf.st_ino;
+    logger_buffer->log_file_size = statbuf.st_size;
+
+    /*
+     * a new log file is compressed if option "logger.file.stream_compression"
+     * is enabled, an existing log file keeps its format
+     */
+    logger_buffer->log_file_compressed = (statbuf.st_size == 0) ?
+        (weechat_config_boolean (logger_config_file_stream_compression)
+         && logger_zstd_available ()) :
+        logger_zstd_is_compressed (logger_buffer->log_filename);
+    if (logger_buffer->log_file_compressed && !logger_zstd_available ())
+    {
+        weechat_printf_date_tags (
+            NULL, 0, "no_log",
+            _("%s%s: unable to write log file \"%s\": zstd compression is "
+              "not available"),
+            weechat_prefix ("error"), LOGGER_PLUGIN_NAME,
+            logger_buffer->log_filename);
+        fclose (logger_buffer->log_file);
+        logger_buffer->log_file = NULL;
+        logger_buffer->log_file_inode = 0;
+        logger_buffer->log_file_size = 0;
+        logger_buffer->log_file_compressed = 0;
+        return 0;
+    }
+
+    /* open index of log file (not available for a compressed log file) */
+    if (weechat_config_boolean (logger_config_file_index)
+        && !logger_buffer->log_file_compressed)
+    {
+        logger_index_open (logger_buffer);
+    }
 
     /* write info line */
     if (weechat_config_boolean (logger_config_file_info_lines)
@@ -320,12 +414,11 @@ logger_buffer_create_log_file (struct t_logger_buffer *logger_buffer)
         snprintf (buf_beginning, sizeof (buf_beginning),
                   _("%s\t****  Beginning of log  ****"),
                   buf_time);
-        charset = weechat_info_get ("charset_terminal", "");
-        message = (charset) ?
-            weechat_iconv_from_internal (charset, buf_beginning) : NULL;
-        fprintf (logger_buffer->log_file,
-                 "%s\n", (message) ? message : buf_beginning);
-        free (charset);
+        message = (logger_charset_terminal) ?
+            weechat_iconv_from_internal (logger_charset_terminal,
+                                         buf_beginning) : NULL;
+        logger_buffer_append (logger_buffer, tv_now.tv_sec,
+                              (message) ? message : buf_beginning);
         free (message);
         logger_buffer->flush_needed = 1;
     }
@@ -440,6 +533,10 @@ logger_buffer_compress_cb (const void *pointer, void *data,
  *    irc.libera.#test.weechatlog.1.gz -> irc.libera.#test.weechatlog.2.gz
  *    irc.libera.#test.weechatlog      -> irc.libera.#test.weechatlog.1
  *
+ * If the current log file is already compressed with zstd (option
+ * logger.file.stream_compression), it is renamed directly to ".1.zst" and
+ * it is not compressed again.
+ *
  * Then the file irc.libera.#test.weechatlog is created again.
  */
 
@@ -447,9 +544,9 @@ void
 logger_buffer_rotate (struct t_logger_buffer *logger_buffer)
 {
     int compression_type, extension_index, found_comp, found_not_comp, i;
+    int compressed_stream;
     char filename[PATH_MAX], new_filename[PATH_MAX];
     const char *ptr_extension;
-    struct stat st;
 
     /* do not rotate if compression of log file is running */
     if (logger_buffer->compressing)
@@ -459,10 +556,11 @@ logger_buffer_rotate (struct t_logger_buffer *logger_buffer)
     if (logger_config_rotation_size_max == 0)
         return;
 
-    /* do not rotate if max size is not reached */
-    if (fstat (fileno (logger_buffer->log_file), &st) != 0)
-        return;
-    if (st.st_size <= (long int)logger_config_rotation_size_max)
+    /*
+     * do not rotate if max size is not reached (the size includes data sent
+     * to the writer thread and maybe not yet written on disk)
+     */
+    if (logger_buffer->log_file_size <= (off_t)logger_config_rotation_size_max)
         return;
 
     if (weechat_logger_plugin->debug)
@@ -479,6 +577,11 @@ logger_buffer_rotate (struct t_logger_buffer *logger_buffer)
         compression_type = LOGGER_BUFFER_COMPRESSION_NONE;
 #endif
 
+    /* current log file already compressed with zstd */
+    compressed_stream = logger_buffer->log_file_compressed;
+    if (compressed_stream)
+        compression_type = LOGGER_BUFFER_COMPRESSION_ZSTD;
+
     ptr_extension = logger_buffer_compression_extension[compression_type];
 
     /* find the highest existing extension index */
@@ -513,10 +616,33 @@ logger_buffer_rotate (struct t_logger_buffer *logger_buffer)
     }
     extension_index--;
 
+    /*
+     * wait for the writer thread: all data must be written in the log file
+     * before it is renamed (and maybe compressed in a child process)
+     */
+    logger_writer_wait ();
+
     /* close current log file */
     fclose (logger_buffer->log_file);
     logger_buffer->log_file = NULL;
     logger_buffer->log_file_inode = 0;
+    logger_buffer->log_file_size = 0;
+    logger_buffer->log_file_compressed = 0;
+
+    /* remove index of log file (a new index is created with new log file) */
+    if (logger_buffer->index_fd >= 0)
+    {
+        logger_index_close (logger_buffer);
+        snprintf (filename, sizeof (filename),
+                  "%s%s",
+                  logger_buffer->log_filename,
+                  LOGGER_INDEX_EXTENSION);
+        unlink (filename);
+    }
+
+    /* remove search index of log file (offsets are not valid any more) */
+    logger_search_free_terms (logger_buffer);
+    logger_search_remove_segments (logger_buffer->log_filename);
 
     /*
      * rename all files with an extension, starting with the higher one
@@ -531,14 +657,18 @@ logger_buffer_rotate (struct t_logger_buffer *logger_buffer)
     {
         if (i == 0)
         {
-            /* rename current log file to ".1" (no compression for now) */
+            /*
+             * rename current log file to ".1" (no compression for now),
+             * or ".1.zst" if it is already compressed
+             */
             snprintf (filename, sizeof (filename),
                       "%s",
                       logger_buffer->log_filename);
             snprintf (new_filename, sizeof (new_filename),
-                      "%s.%d",
+                      "%s.%d%s",
                       logger_buffer->log_filename,
-                      i + 1);
+                      i + 1,
+                      (compressed_stream) ? ptr_extension : "");
         }
         else
         {
@@ -590,7 +720,8 @@ logger_buffer_rotate (struct t_logger_buffer *logger_buffer)
             break;
     }
 
-    if (compression_type != LOGGER_BUFFER_COMPRESSION_NONE)
+    if (!compressed_stream
+        && (compression_type != LOGGER_BUFFER_COMPRESSION_NONE))
     {
         /* compress rotated log file */
         if (weechat_logger_plugin->debug)
@@ -610,42 +741,164 @@ logger_buffer_rotate (struct t_logger_buffer *logger_buffer)
 }
 
 /*
- * Writes a line to log file.
+ * Sends lines not yet written to the writer thread, then rotates the log file
+ * if needed (if rotate == 1).
+ *
+ * The check of log file (inode) is done only here, so once per flush and not
+ * for each line written.
+ *
+ * If the log file is compressed, the lines are compressed in a zstd frame
+ * here (the lines of one flush are small, so it is fast), so the size of
+ * log file is known for the rotation.
  */
 
 void
-logger_buffer_write_line (struct t_logger_buffer *logger_buffer,
-                          const char *format, ...)
+logger_buffer_flush_file (struct t_logger_buffer *logger_buffer, int rotate)
 {
-    char *charset, *message;
+    char *data, *frame;
+    int fd, size, size_frame;
 
-    if (!logger_buffer_create_log_file (logger_buffer))
+    if (!logger_buffer || !logger_buffer->log_data
+        || !(*(logger_buffer->log_data))[0])
+    {
         return;
+    }
 
-    if (!logger_buffer->log_file)
+    /*
+     * lines are kept in memory while the backlog is read by the reader
+     * thread, so that they are not displayed twice (in backlog and buffer)
+     */
+    if (logger_buffer->backlog_pending)
+        return;
+
+    if (!logger_buffer_create_log_file (logger_buffer)
+        || !logger_buffer->log_file)
+    {
+        /* unable to write log file: drop lines */
+        weechat_string_dyn_copy (logger_buffer->log_data, NULL);
+        logger_index_close (logger_buffer);
+        logger_buffer->flush_needed = 0;
         return;
+    }
+
+    if (weechat_logger_plugin->debug >= 2)
+    {
+        weechat_printf_date_tags (NULL, 0, "no_log",
+                                  "%s: flush file %s",
+                                  LOGGER_PLUGIN_NAME,
+                                  logger_buffer->log_filename);
+    }
+
+    fd = dup (fileno (logger_buffer->log_file));
+    if (fd >= 0)
+    {
+        size = strlen (*(logger_buffer->log_data));
+        data = weechat_string_dyn_free (logger_buffer->log_data, 0);
+        logger_buffer->log_data = weechat_string_dyn_alloc (256);
+        if (logger_buffer->log_file_compressed)
+        {
+            frame = logger_zstd_compress_frame (
+                data, size,
+                weechat_config_integer (
+                    logger_config_file_rotation_compression_level),
+                &size_frame);
+            free (data);
+            data = frame;
+            size = size_frame;
+        }
+        if (!data)
+        {
+            /* compression error: lines are lost */
+            close (fd);
+        }
+        else if (logger_writer_add (
+                fd, data, size,
+                weechat_config_boolean (logger_config_file_fsync)))
+        {
+            logger_buffer->log_file_size += size;
+            logger_index_flush (logger_buffer);
+        }
+        else
+        {
+            /* lines are lost: index does not match log file any more */
+            logger_index_close (logger_buffer);
+        }
+    }
+    else
+    {
+        weechat_string_dyn_copy (logger_buffer->log_data, NULL);
+        logger_index_close (logger_buffer);
+    }
+    logger_buffer->flush_needed = 0;
+
+    if (rotate)
+        logger_buffer_rotate (logger_buffer);
+}
+
+/*
+ * Writes a line to log file.
+ *
+ * The line is converted to the terminal charset and appended in memory;
+ * it is sent to the writer thread on next flush (immediately if no flush
+ * delay is set).
+ *
+ * Returns offset of line in log file, -1 if the line is not written.
+ */
+
+off_t
+logger_buffer_write_line (struct t_logger_buffer *logger_buffer,
+                          time_t date, const char *format, ...)
+{
+    char *message;
+    off_t offset;
+
+    if (!logger_buffer->log_data)
+        return -1;
+
+    if (!logger_buffer->log_file
+        && !logger_buffer_create_log_file (logger_buffer))
+    {
+        return -1;
+    }
+
+    /*
+     * open or close index if option "logger.file.index" has changed
+     * (index is not available for a compressed log file)
+     */
+    if (weechat_config_boolean (logger_config_file_index)
+        && !logger_buffer->log_file_compressed)
+    {
+        if (logger_buffer->index_fd < 0)
+            logger_index_open (logger_buffer);
+    }
+    else if (logger_buffer->index_fd >= 0)
+    {
+        logger_buffer_flush_file (logger_buffer, 0);
+        logger_index_flush (logger_buffer);
+        logger_index_close (logger_buffer);
+    }
+
+    offset = -1;
 
     weechat_va_format (format);
     if (vbuffer)
     {
-        charset = weechat_info_get ("charset_terminal", "");
-        message = (charset) ?
-            weechat_iconv_from_internal (charset, vbuffer) : NULL;
-        fprintf (logger_buffer->log_file,
-                 "%s\n", (message) ? message : vbuffer);
-        free (charset);
+        message = (logger_charset_terminal) ?
+            weechat_iconv_from_internal (logger_charset_terminal,
+                                         vbuffer) : NULL;
+        offset = logger_buffer_append (logger_buffer, date,
+                                       (message) ? message : vbuffer);
+        /* offsets are not in the compressed log file */
+        if (logger_buffer->log_file_compressed)
+            offset = -1;
         free (message);
         logger_buffer->flush_needed = 1;
         if (!logger_hook_timer)
-        {
-            fflush (logger_buffer->log_file);
-            if (weechat_config_boolean (logger_config_file_fsync))
-                fsync (fileno (logger_buffer->log_file));
-            logger_buffer->flush_needed = 0;
-            logger_buffer_rotate (logger_buffer);
-        }
+            logger_buffer_flush_file (logger_buffer, 1);
         free (vbuffer);
     }
+
+    return offset;
 }
 
 /*
@@ -671,6 +924,7 @@ logger_buffer_stop (struct t_logger_buffer *logger_buffer, int write_info_line)
                 weechat_config_string (logger_config_file_time_format),
                 &tv_now);
             logger_buffer_write_line (logger_buffer,
+                                      tv_now.tv_sec,
                                       _("%s\t****  End of log  ****"),
                                       buf_time);
         }
@@ -739,6 +993,7 @@ logger_buffer_start (struct t_gui_buffer *buffer, int write_info_line)
                         fclose (ptr_logger_buffer->log_file);
                         ptr_logger_buffer->log_file = NULL;
                         ptr_logger_buffer->log_file_inode = 0;
+                        ptr_logger_buffer->log_file_size = 0;
                     }
                 }
             }
@@ -783,20 +1038,7 @@ logger_buffer_flush ()
          ptr_logger_buffer = ptr_logger_buffer->next_buffer)
     {
         if (ptr_logger_buffer->log_file && ptr_logger_buffer->flush_needed)
-        {
-            if (weechat_logger_plugin->debug >= 2)
-            {
-                weechat_printf_date_tags (NULL, 0, "no_log",
-                                          "%s: flush file %s",
-                                          LOGGER_PLUGIN_NAME,
-                                          ptr_logger_buffer->log_filename);
-            }
-            fflush (ptr_logger_buffer->log_file);
-            if (weechat_config_boolean (logger_config_file_fsync))
-                fsync (fileno (ptr_logger_buffer->log_file));
-            ptr_logger_buffer->flush_needed = 0;
-            logger_buffer_rotate (ptr_logger_buffer);
-        }
+            logger_buffer_flush_file (ptr_logger_buffer, 1);
     }
 }
 
@@ -859,6 +1101,8 @@ logger_buffer_free (struct t_logger_buffer *logger_buffer)
 
     ptr_buffer = logger_buffer->buffer;
 
+    weechat_hashtable_remove (logger_buffers_hashtable, ptr_buffer);
+
     /* remove logger buffer */
     if (last_logger_buffer == logger_buffer)
         last_logger_buffer = logger_buffer->prev_buffer;
@@ -873,15 +1117,37 @@ logger_buffer_free (struct t_logger_buffer *logger_buffer)
     if (logger_buffer->next_buffer)
         (logger_buffer->next_buffer)->prev_buffer = logger_buffer->prev_buffer;
 
+    /* cancel read of backlog (if pending) */
+    if (logger_buffer->backlog_pending)
+    {
+        logger_reader_cancel (ptr_buffer);
+        logger_buffer->backlog_pending = 0;
+    }
+
+    /* send lines not yet written to the writer thread */
+    if (logger_buffer->log_file)
+        logger_buffer_flush_file (logger_buffer, 0);
+
+    /* write terms of search index not yet written */
+    logger_search_write_segment (logger_buffer);
+
     /* free data */
     free (logger_buffer->log_filename);
     if (logger_buffer->log_file)
         fclose (logger_buffer->log_file);
+    weechat_string_dyn_free (logger_buffer->log_data, 1);
+    logger_index_close (logger_buffer);
 
     free (logger_buffer);
 
     logger_buffers = new_logger_buffers;
 
+    if (!logger_buffers)
+    {
+        weechat_hashtable_free (logger_buffers_hashtable);
+        logger_buffers_hashtable = NULL;
+    }
+
     if (weechat_logger_plugin->debug)
     {
         weechat_printf_date_tags (
@@ -929,6 +1195,10 @@ logger_buffer_add_to_infolist (struct t_infolist *infolist,
         return 0;
     if (!weechat_infolist_new_var_integer (ptr_item, "flush_needed", logger_buffer->flush_needed))
         return 0;
+    if (!weechat_infolist_new_var_integer (ptr_item, "backlog_pending", logger_buffer->backlog_pending))
+        return 0;
+    if (!weechat_infolist_new_var_integer (ptr_item, "log_file_compressed", logger_buffer->log_file_compressed))
+        return 0;
     if (!weechat_infolist_new_var_integer (ptr_item, "compressing", logger_buffer->compressing))
         return 0;
 
@@ -36,6 +36,8 @@ enum t_logger_buffer_compression
 };
 
 struct t_infolist;
+struct t_hashtable;
+struct t_logger_index_entry;
 
 struct t_logger_buffer
 {
@@ -43,11 +45,30 @@ struct t_logger_buffer
     char *log_filename;                   /* log filename                   */
     FILE *log_file;                       /* log file                       */
     ino_t log_file_inode;                 /* inode of log file              */
+    int log_file_compressed;              /* 1 if log file is compressed    */
+                                          /* with zstd while it is written  */
+    off_t log_file_size;                  /* size of log file (including    */
+                                          /* data sent to writer thread)    */
+    char **log_data;                      /* lines not yet sent to writer   */
+                                          /* thread                         */
+    int index_fd;                         /* index of log file (-1 if none) */
+    struct t_logger_index_entry *index_entries; /* index entries not yet    */
+                                          /* sent to writer thread          */
+    int index_count;                      /* number of index entries        */
+    int index_count_alloc;                /* allocated index entries        */
+    struct t_hashtable *search_terms;     /* search index: terms not yet    */
+                                          /* written in a segment           */
+    int search_num_postings;              /* number of postings in memory   */
+    int search_day;                       /* day of terms (YYYYMMDD)        */
+    off_t search_first_offset;            /* offset of first message in     */
+                                          /* terms                          */
     int log_enabled;                      /* log enabled ?                  */
     int log_level;                        /* log level (0..9)               */
     int write_start_info_line;            /* 1 if start info line must be   */
                                           /* written in file                */
     int flush_needed;                     /* flush needed?                  */
+    int backlog_pending;                  /* 1 if backlog is being read by  */
+                                          /* reader thread (no flush)       */
     int compressing;                      /* compressing rotated log, this  */
                                           /* prevents any new rotation      */
                                           /* before the end of compression  */
@@ -57,6 +78,7 @@ struct t_logger_buffer
 
 extern struct t_logger_buffer *logger_buffers;
 extern struct t_logger_buffer *last_logger_buffer;
+extern struct t_hashtable *logger_buffers_hashtable;
 
 extern int logger_buffer_valid (struct t_logger_buffer *logger_buffer);
 extern struct t_logger_buffer *logger_buffer_add (struct t_gui_buffer *buffer,
@@ -66,8 +88,10 @@ extern struct t_logger_buffer *logger_buffer_search_log_filename (const char *lo
 extern void logger_buffer_set_log_filename (struct t_logger_buffer *logger_buffer);
 extern int logger_buffer_create_log_file (struct t_logger_buffer *logger_buffer);
 extern void logger_buffer_rotate (struct t_logger_buffer *logger_buffer);
-extern void logger_buffer_write_line (struct t_logger_buffer *logger_buffer,
-                                      const char *format, ...);
+extern void logger_buffer_flush_file (struct t_logger_buffer *logger_buffer,
+                                      int rotate);
+extern off_t logger_buffer_write_line (struct t_logger_buffer *logger_buffer,
+                                       time_t date, const char *format, ...);
 extern void logger_buffer_stop (struct t_logger_buffer *logger_buffer,
                                 int write_info_line);
 extern void logger_buffer_stop_all (int write_info_line);
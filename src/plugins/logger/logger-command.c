@@ -21,11 +21,13 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "../weechat-plugin.h"
 #include "logger.h"
 #include "logger-buffer.h"
 #include "logger-config.h"
+#include "logger-search.h"
 
 
 /*
@@ -113,6 +115,70 @@ logger_set_buffer (struct t_gui_buffer *buffer, const char *value)
     free (name);
 }
 
+/*
+ * Searches in log files and displays lines found on core buffer.
+ */
+
+void
+logger_search (const char *string)
+{
+    struct t_logger_search_query *query;
+    struct t_logger_search_result *ptr_result;
+    struct t_arraylist *results;
+    const char *error, *ptr_filename;
+    char *line;
+    int i, size;
+
+    query = logger_search_query_parse (string, &error);
+    if (!query)
+    {
+        weechat_printf (NULL, _("%s%s: search error: %s"),
+                        weechat_prefix ("error"), LOGGER_PLUGIN_NAME,
+                        (error) ? error : "?");
+        return;
+    }
+
+    results = logger_search_run (query);
+    size = (results) ? weechat_arraylist_size (results) : 0;
+
+    weechat_printf_date_tags (NULL, 0, "no_log", "");
+    if (size == 0)
+    {
+        weechat_printf_date_tags (NULL, 0, "no_log",
+                                  _("%s: no line found for \"%s\""),
+                                  LOGGER_PLUGIN_NAME, string);
+    }
+    else
+    {
+        weechat_printf_date_tags (
+            NULL, 0, "no_log",
+            NG_("%s: %d line found for \"%s\":",
+                "%s: %d lines found for \"%s\":",
+                size),
+            LOGGER_PLUGIN_NAME, size, string);
+        for (i = 0; i < size; i++)
+        {
+            ptr_result = (struct t_logger_search_result *)weechat_arraylist_get (
+                results, i);
+            ptr_filename = strrchr (ptr_result->log_filename, '/');
+            ptr_filename = (ptr_filename) ?
+                ptr_filename + 1 : ptr_result->log_filename;
+            line = weechat_string_replace (ptr_result->line, "\t", " ");
+            weechat_printf_date_tags (
+                NULL, 0, "no_log",
+                "  %s%s%s: %s",
+                weechat_color ("chat_buffer"),
+                ptr_filename,
+                weechat_color ("reset"),
+                (line) ? line : ptr_result->line);
+            free (line);
+        }
+    }
+
+    weechat_arraylist_free (results);
+    logger_search_query_free (query);
+}
+
 /*
  * Callback for command "/logger".
  */
@@ -125,7 +191,6 @@ logger_command_cb (const void *pointer, void *data,
     /* make C compiler happy */
     (void) pointer;
     (void) data;
-    (void) argv_eol;
 
     if ((argc == 1)
         || ((argc == 2) && (weechat_strcmp (argv[1], "list") == 0)))
@@ -153,6 +218,13 @@ logger_command_cb (const void *pointer, void *data,
         return WEECHAT_RC_OK;
     }
 
+    if (weechat_strcmp (argv[1], "search") == 0)
+    {
+        WEECHAT_COMMAND_MIN_ARGS(3, "search");
+        logger_search (argv_eol[2]);
+        return WEECHAT_RC_OK;
+    }
+
     WEECHAT_COMMAND_ERROR;
 }
 
@@ -170,7 +242,9 @@ logger_command_init ()
         N_("list"
            " || set <level>"
            " || flush"
-           " || disable"),
+           " || disable"
+           " || search [-buffer <name>] [-nick <nick>] [-tag <tag>] "
+           "[-since <date>] [-until <date>] [-limit <count>] [<words>...]"),
         WEECHAT_CMD_ARGS_DESC(
             N_("raw[list]: show logging status for opened buffers"),
             N_("raw[set]: set logging level on current buffer"),
@@ -178,6 +252,17 @@ logger_command_init ()
                "1 = a few messages (most important) .. 9 = all messages)"),
             N_("raw[flush]: write all log files now"),
             N_("raw[disable]: disable logging on current buffer (set level to 0)"),
+            N_("raw[search]: search lines in log files, using the search index "
+               "(see option logger.file.search_index); the most recent lines "
+               "containing all the words are displayed"),
+            N_("name: full name of buffer (search only in log file of this "
+               "buffer)"),
+            N_("nick: search only messages from this nick"),
+            N_("tag: search only lines with this tag"),
+            N_("date: search only lines written since/until this date, "
+               "as ISO 8601 or timestamp (example: \"2024-01-04T21:01:02Z\")"),
+            N_("count: max number of lines displayed (default: 50)"),
+            N_("words: words to search (case insensitive)"),
             "",
             N_("Options \"logger.level.*\" and \"logger.mask.*\" can be used to set "
                "level or mask for a buffer, or buffers beginning with name."),
@@ -195,6 +280,9 @@ logger_command_init ()
             AI("    /logger set 5"),
             N_("  disable logging for current buffer:"),
             AI("    /logger disable"),
+            N_("  search lines from nick \"alice\" with words \"release\" "
+               "and \"weechat\":"),
+            AI("    /logger search -nick alice release weechat"),
             N_("  set level to 3 for all IRC buffers:"),
             AI("    /set logger.level.irc 3"),
             N_("  disable logging for main WeeChat buffer:"),
@@ -204,6 +292,7 @@ logger_command_init ()
         "list"
         " || set 1|2|3|4|5|6|7|8|9"
         " || flush"
-        " || disable",
+        " || disable"
+        " || search -buffer|-nick|-tag|-since|-until|-limit|%(buffers_names)",
         &logger_command_cb, NULL, NULL);
 }
@@ -44,6 +44,7 @@ int logger_config_loading = 0;
 /* logger config, look section */
 
 struct t_config_option *logger_config_look_backlog = NULL;
+struct t_config_option *logger_config_look_backlog_async = NULL;
 struct t_config_option *logger_config_look_backlog_conditions = NULL;
 
 /* logger config, color section */
@@ -57,6 +58,7 @@ struct t_config_option *logger_config_file_auto_log = NULL;
 struct t_config_option *logger_config_file_color_lines = NULL;
 struct t_config_option *logger_config_file_flush_delay = NULL;
 struct t_config_option *logger_config_file_fsync = NULL;
+struct t_config_option *logger_config_file_index = NULL;
 struct t_config_option *logger_config_file_info_lines = NULL;
 struct t_config_option *logger_config_file_log_conditions = NULL;
 struct t_config_option *logger_config_file_mask = NULL;
@@ -68,6 +70,8 @@ struct t_config_option *logger_config_file_replacement_char = NULL;
 struct t_config_option *logger_config_file_rotation_compression_level = NULL;
 struct t_config_option *logger_config_file_rotation_compression_type = NULL;
 struct t_config_option *logger_config_file_rotation_size_max = NULL;
+struct t_config_option *logger_config_file_search_index = NULL;
+struct t_config_option *logger_config_file_stream_compression = NULL;
 struct t_config_option *logger_config_file_time_format = NULL;
 
 /* other */
@@ -119,6 +123,48 @@ logger_config_change_file_rotation_comp_type (const void *pointer,
 #endif
 }
 
+/*
+ * Callback for changes on option "logger.file.stream_compression".
+ */
+
+void
+logger_config_change_file_stream_compression (const void *pointer,
+                                              void *data,
+                                              struct t_config_option *option)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) option;
+
+#ifndef HAVE_ZSTD
+    if (weechat_config_boolean (option))
+    {
+        weechat_printf (NULL,
+                        _("%s%s: zstd compression is not available, "
+                          "logger files will not be compressed"),
+                        weechat_prefix ("error"),
+                        LOGGER_PLUGIN_NAME);
+    }
+#endif
+}
+
+/*
+ * Callback for changes on option "logger.file.time_format".
+ */
+
+void
+logger_config_time_format_change (const void *pointer, void *data,
+                                  struct t_config_option *option)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) option;
+
+    logger_time_cache_reset ();
+}
+
 /*
  * Callback for changes on option "logger.file.color_lines".
  */
@@ -184,6 +230,8 @@ logger_config_flush_delay_change (const void *pointer, void *data,
             weechat_config_integer (logger_config_file_flush_delay) * 1000,
             0, 0,
             &logger_timer_cb, NULL, NULL);
+        /* allow a small delay to be called with other timers */
+        weechat_hook_set (logger_hook_timer, "slack", "1000");
     }
 }
 
@@ -514,6 +562,17 @@ logger_config_init ()
                "new buffer (0 = no backlog)"),
             NULL, 0, INT_MAX, "20", NULL, 0,
             NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+        logger_config_look_backlog_async = weechat_config_new_option (
+            logger_config_file, logger_config_section_look,
+            "backlog_async", "boolean",
+            N_("read the backlog in a separate thread for buffers which are "
+               "not displayed in a window, so that opening many buffers "
+               "(for example on startup) does not block WeeChat; the backlog "
+               "of buffers displayed is read immediately; "
+               "note: messages displayed in the buffer before the end of "
+               "read are displayed before the backlog"),
+            NULL, 0, 0, "on", NULL, 0,
+            NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
         logger_config_look_backlog_conditions = weechat_config_new_option (
             logger_config_file, logger_config_section_look,
             "backlog_conditions", "string",
@@ -597,6 +656,17 @@ logger_config_init ()
                "of log file"),
             NULL, 0, 0, "off", NULL, 0,
             NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+        logger_config_file_index = weechat_config_new_option (
+            logger_config_file, logger_config_section_file,
+            "index", "boolean",
+            N_("write an index for each log file (file with extension "
+               "\".idx\" in the same directory), with offset and date of "
+               "messages, used to read quickly the backlog; the index is "
+               "updated only when this option is enabled (if the log file "
+               "was written while the option was disabled, the index is "
+               "restarted from the end of the log file)"),
+            NULL, 0, 0, "off", NULL, 0,
+            NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
         logger_config_file_info_lines = weechat_config_new_option (
             logger_config_file, logger_config_section_file,
             "info_lines", "boolean",
@@ -710,6 +780,34 @@ logger_config_init ()
             &logger_config_rotation_size_max_check, NULL, NULL,
             &logger_config_rotation_size_max_change, NULL, NULL,
             NULL, NULL, NULL);
+        logger_config_file_search_index = weechat_config_new_option (
+            logger_config_file, logger_config_section_file,
+            "search_index", "boolean",
+            N_("maintain a full-text search index of log files (words of "
+               "messages, nicks and tags of lines), in a directory with "
+               "extension \".fts\" next to each log file; it is used by "
+               "command /logger search; only lines written while this option "
+               "is enabled are indexed"),
+            NULL, 0, 0, "off", NULL, 0,
+            NULL, NULL, NULL,
+            NULL, NULL, NULL,
+            NULL, NULL, NULL);
+        logger_config_file_stream_compression = weechat_config_new_option (
+            logger_config_file, logger_config_section_file,
+            "stream_compression", "boolean",
+            N_("compress the current log file with zstd while it is written "
+               "(one zstd frame per flush, the file can be read with "
+               "\"zstdcat\" at any time), with the compression level "
+               "logger.file.rotation_compression_level; on rotation, the file "
+               "is renamed with extension \".zst\" and not compressed again; "
+               "the option is used only for new log files: an existing log "
+               "file keeps its format until its rotation; the index of log "
+               "files and the search index are not available for compressed "
+               "log files"),
+            NULL, 0, 0, "off", NULL, 0,
+            NULL, NULL, NULL,
+            &logger_config_change_file_stream_compression, NULL, NULL,
+            NULL, NULL, NULL);
         logger_config_file_time_format = weechat_config_new_option (
             logger_config_file, logger_config_section_file,
             "time_format", "string",
@@ -717,7 +815,9 @@ logger_config_init ()
                "specifiers, extra specifiers are supported, see function "
                "util_strftimeval in Plugin API reference)"),
             NULL, 0, 0, "%Y-%m-%d %H:%M:%S", NULL, 0,
-            NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+            NULL, NULL, NULL,
+            &logger_config_time_format_change, NULL, NULL,
+            NULL, NULL, NULL);
     }
 
     /* level */
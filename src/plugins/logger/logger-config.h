@@ -24,6 +24,7 @@
 #define LOGGER_CONFIG_PRIO_NAME (TO_STR(LOGGER_PLUGIN_PRIORITY) "|" LOGGER_CONFIG_NAME)
 
 extern struct t_config_option *logger_config_look_backlog;
+extern struct t_config_option *logger_config_look_backlog_async;
 extern struct t_config_option *logger_config_look_backlog_conditions;
 
 extern struct t_config_option *logger_config_color_backlog_end;
@@ -33,6 +34,7 @@ extern struct t_config_option *logger_config_file_auto_log;
 extern struct t_config_option *logger_config_file_color_lines;
 extern struct t_config_option *logger_config_file_flush_delay;
 extern struct t_config_option *logger_config_file_fsync;
+extern struct t_config_option *logger_config_file_index;
 extern struct t_config_option *logger_config_file_info_lines;
 extern struct t_config_option *logger_config_file_log_conditions;
 extern struct t_config_option *logger_config_file_mask;
@@ -44,6 +46,8 @@ extern struct t_config_option *logger_config_file_replacement_char;
 extern struct t_config_option *logger_config_file_rotation_compression_level;
 extern struct t_config_option *logger_config_file_rotation_compression_type;
 extern struct t_config_option *logger_config_file_rotation_size_max;
+extern struct t_config_option *logger_config_file_search_index;
+extern struct t_config_option *logger_config_file_stream_compression;
 extern struct t_config_option *logger_config_file_time_format;
 
 extern unsigned long long logger_config_rotation_size_max;
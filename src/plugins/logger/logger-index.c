@@ -0,0 +1,401 @@
+/*
+ * logger-index.c - index of log files for logger plugin
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The index of a log file is a sidecar file (log filename + ".idx") with one
+ * fixed-size entry per message written in the log file (offset, length and
+ * date of message), so that the last N messages or the first message after
+ * a date can be found without reading the whole log file.
+ *
+ * The index is valid if the last entry ends at the end of the log file;
+ * if not (for example log written while the index was disabled), the index
+ * is truncated and restarts at the end of the log file: in this case it
+ * covers only the end of the log file (first entry has offset > 0).
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "../weechat-plugin.h"
+#include "logger.h"
+#include "logger-index.h"
+#include "logger-buffer.h"
+#include "logger-config.h"
+#include "logger-writer.h"
+
+
+/*
+ * Returns filename of index for a log file.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+logger_index_get_filename (const char *log_filename)
+{
+    char *filename;
+
+    if (!log_filename || !log_filename[0])
+        return NULL;
+
+    if (weechat_asprintf (&filename, "%s%s",
+                          log_filename, LOGGER_INDEX_EXTENSION) < 0)
+    {
+        return NULL;
+    }
+
+    return filename;
+}
+
+/*
+ * Reads an entry in an index file.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+logger_index_read_entry (int fd, int64_t index,
+                         struct t_logger_index_entry *entry)
+{
+    if ((fd < 0) || (index < 0) || !entry)
+        return 0;
+
+    return (pread (fd, entry, sizeof (*entry),
+                   (off_t)(index * (int64_t)sizeof (*entry)))
+            == (ssize_t)sizeof (*entry)) ? 1 : 0;
+}
+
+/*
+ * Opens index of log file for a logger buffer (the log file must be opened).
+ *
+ * If the index does not match the log file, it is truncated.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+logger_index_open (struct t_logger_buffer *logger_buffer)
+{
+    char *filename;
+    struct stat st;
+    struct t_logger_index_entry entry;
+    int64_t count;
+    off_t log_end;
+    int valid;
+
+    if (!logger_buffer || !logger_buffer->log_file)
+        return 0;
+
+    if (logger_buffer->index_fd >= 0)
+        return 1;
+
+    filename = logger_index_get_filename (logger_buffer->log_filename);
+    if (!filename)
+        return 0;
+
+    /* all data sent to the writer thread must be on disk to check the index */
+    logger_writer_wait ();
+
+    logger_buffer->index_fd = open (filename,
+                                    O_RDWR | O_CREAT | O_APPEND, 0666);
+    free (filename);
+    if (logger_buffer->index_fd < 0)
+        return 0;
+
+    if (fstat (logger_buffer->index_fd, &st) != 0)
+    {
+        logger_index_close (logger_buffer);
+        return 0;
+    }
+
+    /* end of log file, including lines not yet sent to the writer thread */
+    log_end = logger_buffer->log_file_size
+        + (off_t)strlen (*(logger_buffer->log_data));
+
+    valid = 0;
+    count = st.st_size / sizeof (entry);
+    if ((st.st_size % sizeof (entry)) == 0)
+    {
+        if (count == 0)
+            valid = 1;
+        else if (logger_index_read_entry (logger_buffer->index_fd, count - 1,
+                                          &entry))
+        {
+            valid = (entry.offset + entry.length == (int64_t)log_end);
+        }
+    }
+
+    if (!valid)
+    {
+        if (weechat_logger_plugin->debug)
+        {
+            weechat_log_printf ("logger: index does not match log file "
+                                "\"%s\", index truncated",
+                                logger_buffer->log_filename);
+        }
+        if (ftruncate (logger_buffer->index_fd, 0) != 0)
+        {
+            logger_index_close (logger_buffer);
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/*
+ * Closes index of log file for a logger buffer.
+ *
+ * Entries not yet sent to the writer thread are lost.
+ */
+
+void
+logger_index_close (struct t_logger_buffer *logger_buffer)
+{
+    if (!logger_buffer)
+        return;
+
+    if (logger_buffer->index_fd >= 0)
+    {
+        close (logger_buffer->index_fd);
+        logger_buffer->index_fd = -1;
+    }
+    free (logger_buffer->index_entries);
+    logger_buffer->index_entries = NULL;
+    logger_buffer->index_count = 0;
+    logger_buffer->index_count_alloc = 0;
+}
+
+/*
+ * Adds an entry in index of a logger buffer (if the index is opened).
+ */
+
+void
+logger_index_add (struct t_logger_buffer *logger_buffer,
+                  off_t offset, int length, time_t date)
+{
+    struct t_logger_index_entry *new_entries;
+    int new_count_alloc;
+
+    if (!logger_buffer || (logger_buffer->index_fd < 0))
+        return;
+
+    if (logger_buffer->index_count >= logger_buffer->index_count_alloc)
+    {
+        new_count_alloc = (logger_buffer->index_count_alloc < 16) ?
+            16 : logger_buffer->index_count_alloc * 2;
+        new_entries = realloc (logger_buffer->index_entries,
+                               new_count_alloc * sizeof (*new_entries));
+        if (!new_entries)
+            return;
+        logger_buffer->index_entries = new_entries;
+        logger_buffer->index_count_alloc = new_count_alloc;
+    }
+
+    logger_buffer->index_entries[logger_buffer->index_count].offset = offset;
+    logger_buffer->index_entries[logger_buffer->index_count].length = length;
+    logger_buffer->index_entries[logger_buffer->index_count].date = date;
+    logger_buffer->index_count++;
+}
+
+/*
+ * Sends entries of index to the writer thread.
+ *
+ * This must be called after the lines have been sent to the writer thread,
+ * so that the index never references data not yet written in log file.
+ */
+
+void
+logger_index_flush (struct t_logger_buffer *logger_buffer)
+{
+    int fd;
+
+    if (!logger_buffer || (logger_buffer->index_fd < 0)
+        || (logger_buffer->index_count == 0))
+    {
+        return;
+    }
+
+    fd = dup (logger_buffer->index_fd);
+    if (fd >= 0)
+    {
+        logger_writer_add (
+            fd,
+            (char *)logger_buffer->index_entries,
+            logger_buffer->index_count * sizeof (*(logger_buffer->index_entries)),
+            weechat_config_boolean (logger_config_file_fsync));
+    }
+    else
+    {
+        free (logger_buffer->index_entries);
+    }
+    logger_buffer->index_entries = NULL;
+    logger_buffer->index_count = 0;
+    logger_buffer->index_count_alloc = 0;
+}
+
+/*
+ * Opens the index of a log file for read.
+ *
+ * Returns file descriptor, -1 if error; number of entries is set in *count.
+ */
+
+int
+logger_index_open_read (const char *log_filename, int64_t *count)
+{
+    char *filename;
+    struct stat st;
+    int fd;
+
+    *count = 0;
+
+    filename = logger_index_get_filename (log_filename);
+    if (!filename)
+        return -1;
+
+    fd = open (filename, O_RDONLY);
+    free (filename);
+    if (fd < 0)
+        return -1;
+
+    if ((fstat (fd, &st) != 0)
+        || ((st.st_size % sizeof (struct t_logger_index_entry)) != 0))
+    {
+        close (fd);
+        return -1;
+    }
+
+    *count = st.st_size / sizeof (struct t_logger_index_entry);
+
+    return fd;
+}
+
+/*
+ * Returns offset of the N-th last message in a log file, using its index.
+ *
+ * If the log file has less than N messages, the offset returned is 0
+ * (beginning of file).
+ *
+ * Returns -1 if the index can not be used (no index, or index not covering
+ * the N last messages).
+ */
+
+off_t
+logger_index_tail_offset (const char *log_filename, int messages)
+{
+    struct t_logger_index_entry entry;
+    struct stat st;
+    int64_t count;
+    off_t offset;
+    int fd;
+
+    if (messages < 1)
+        return -1;
+
+    fd = logger_index_open_read (log_filename, &count);
+    if (fd < 0)
+        return -1;
+
+    offset = -1;
+    if (count > 0)
+    {
+        if (count >= messages)
+        {
+            if (logger_index_read_entry (fd, count - messages, &entry))
+                offset = entry.offset;
+        }
+        else if (logger_index_read_entry (fd, 0, &entry) && (entry.offset == 0))
+        {
+            /* index covers the whole log file */
+            offset = 0;
+        }
+    }
+    close (fd);
+
+    /* check that index is not beyond the end of log file */
+    if ((offset > 0)
+        && ((stat (log_filename, &st) != 0) || (offset > st.st_size)))
+    {
+        offset = -1;
+    }
+
+    return offset;
+}
+
+/*
+ * Returns offset of first message printed at this date or after, using the
+ * index of log file (dates in index are supposed to be in ascending order).
+ *
+ * Returns -1 if the index can not be used or if there is no message after
+ * this date.
+ */
+
+off_t
+logger_index_search_date (const char *log_filename, time_t date)
+{
+    struct t_logger_index_entry entry;
+    int64_t count, low, high, middle;
+    off_t offset;
+    int fd;
+
+    fd = logger_index_open_read (log_filename, &count);
+    if (fd < 0)
+        return -1;
+
+    /* binary search of first entry with date >= date */
+    low = 0;
+    high = count;
+    while (low < high)
+    {
+        middle = low + ((high - low) / 2);
+        if (!logger_index_read_entry (fd, middle, &entry))
+        {
+            close (fd);
+            return -1;
+        }
+        if (entry.date < (int64_t)date)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    offset = -1;
+    if ((low < count) && logger_index_read_entry (fd, low, &entry))
+    {
+        /*
+         * if the first entry is returned and the index does not cover the
+         * whole file, older messages may exist before this one
+         */
+        if ((low > 0) || (entry.offset == 0))
+            offset = entry.offset;
+    }
+    close (fd);
+
+    return offset;
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WEECHAT_PLUGIN_LOGGER_INDEX_H
+#define WEECHAT_PLUGIN_LOGGER_INDEX_H
+
+#include <stdint.h>
+#include <time.h>
+#include <sys/types.h>
+
+#define LOGGER_INDEX_EXTENSION ".idx"
+
+struct t_logger_buffer;
+
+/* entry in index file (native byte order) */
+
+struct t_logger_index_entry
+{
+    int64_t offset;                     /* offset of message in log file    */
+    int64_t length;                     /* length of message (bytes)        */
+    int64_t date;                       /* date of message                  */
+};
+
+extern char *logger_index_get_filename (const char *log_filename);
+extern int logger_index_read_entry (int fd, int64_t index,
+                                    struct t_logger_index_entry *entry);
+extern int logger_index_open (struct t_logger_buffer *logger_buffer);
+extern void logger_index_close (struct t_logger_buffer *logger_buffer);
+extern void logger_index_add (struct t_logger_buffer *logger_buffer,
+                              off_t offset, int length, time_t date);
+extern void logger_index_flush (struct t_logger_buffer *logger_buffer);
+extern off_t logger_index_tail_offset (const char *log_filename, int messages);
+extern off_t logger_index_search_date (const char *log_filename, time_t date);
+
+#endif /* WEECHAT_PLUGIN_LOGGER_INDEX_H */
@@ -26,6 +26,7 @@
 #include "../weechat-plugin.h"
 #include "logger.h"
 #include "logger-buffer.h"
+#include "logger-search.h"
 
 
 /*
@@ -137,6 +138,70 @@ logger_info_infolist_logger_buffer_cb (const void *pointer, void *data,
     return NULL;
 }
 
+/*
+ * Returns logger infolist "logger_search".
+ */
+
+struct t_infolist *
+logger_info_infolist_logger_search_cb (const void *pointer, void *data,
+                                       const char *infolist_name,
+                                       void *obj_pointer,
+                                       const char *arguments)
+{
+    struct t_infolist *ptr_infolist;
+    struct t_infolist_item *ptr_item;
+    struct t_logger_search_query *query;
+    struct t_logger_search_result *ptr_result;
+    struct t_arraylist *results;
+    int i, size;
+
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) infolist_name;
+    (void) obj_pointer;
+
+    query = logger_search_query_parse (arguments, NULL);
+    if (!query)
+        return NULL;
+
+    results = logger_search_run (query);
+    logger_search_query_free (query);
+    if (!results)
+        return NULL;
+
+    ptr_infolist = weechat_infolist_new ();
+    if (!ptr_infolist)
+        goto error;
+
+    size = weechat_arraylist_size (results);
+    for (i = 0; i < size; i++)
+    {
+        ptr_result = (struct t_logger_search_result *)weechat_arraylist_get (
+            results, i);
+        ptr_item = weechat_infolist_new_item (ptr_infolist);
+        if (!ptr_item
+            || !weechat_infolist_new_var_string (ptr_item, "log_filename",
+                                                 ptr_result->log_filename)
+            || !weechat_infolist_new_var_time (ptr_item, "date",
+                                               ptr_result->date)
+            || !weechat_infolist_new_var_string (ptr_item, "line",
+                                                 ptr_result->line))
+        {
+            goto error;
+        }
+    }
+
+    weechat_arraylist_free (results);
+
+    return ptr_infolist;
+
+error:
+    weechat_infolist_free (ptr_infolist);
+    weechat_arraylist_free (results);
+    return NULL;
+}
+
 
 /*
  * Hooks infolist for logger plugin.
@@ -159,4 +224,10 @@ logger_info_init ()
         N_("logger pointer (optional)"),
         NULL,
         &logger_info_infolist_logger_buffer_cb, NULL, NULL);
+    weechat_hook_infolist (
+        "logger_search", N_("lines found in log files with the search index"),
+        N_("search query, same format as command /logger search (example: "
+           "\"-nick alice -limit 10 weechat\")"),
+        NULL,
+        &logger_info_infolist_logger_search_cb, NULL, NULL);
 }
@@ -0,0 +1,481 @@
+/*
+ * logger-reader.c - thread reading backlog for logger plugin
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * When a buffer is opened and it is not displayed in a window, its backlog is
+ * read by the reader thread (reading the end of a large log file can take
+ * time, and many buffers are opened on startup); the messages read are sent
+ * back to the main thread, which displays them in the buffer.
+ *
+ * While the backlog is read, the lines logged for the buffer are kept in
+ * memory (not written in the log file), so that they are not read in the
+ * backlog.
+ */
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <pthread.h>
+
+#include "../weechat-plugin.h"
+#include "logger.h"
+#include "logger-backlog.h"
+#include "logger-buffer.h"
+#include "logger-reader.h"
+#include "logger-writer.h"
+
+
+int logger_reader_thread_running = 0;  /* 1 if reader thread is running     */
+
+pthread_t logger_reader_thread;
+pthread_mutex_t logger_reader_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t logger_reader_cond_request = PTHREAD_COND_INITIALIZER;
+
+struct t_logger_reader_request *logger_reader_requests = NULL;
+struct t_logger_reader_request *last_logger_reader_request = NULL;
+struct t_logger_reader_request *logger_reader_requests_done = NULL;
+struct t_logger_reader_request *logger_reader_current_request = NULL;
+int logger_reader_quit = 0;            /* 1 if thread must exit             */
+
+int logger_reader_pipe[2] = { -1, -1 }; /* pipe to wake up main thread      */
+struct t_hook *logger_reader_hook_fd = NULL;
+
+
+/*
+ * Frees a request.
+ */
+
+void
+logger_reader_request_free (struct t_logger_reader_request *request)
+{
+    if (!request)
+        return;
+
+    free (request->filename);
+    free (request->time_format);
+    if (request->messages)
+        weechat_arraylist_free (request->messages);
+    free (request);
+}
+
+/*
+ * Reader thread: reads backlog of pending requests, then waits for new
+ * requests.
+ *
+ * Note: only the read of log file is done in this thread (see function
+ * logger_backlog_read), the display is done by the main thread.
+ */
+
+void *
+logger_reader_thread_cb (void *arg)
+{
+    struct t_logger_reader_request *ptr_request;
+    int canceled;
+    char c;
+
+    /* make C compiler happy */
+    (void) arg;
+
+    pthread_mutex_lock (&logger_reader_mutex);
+    while (1)
+    {
+        while (!logger_reader_requests && !logger_reader_quit)
+        {
+            pthread_cond_wait (&logger_reader_cond_request,
+                               &logger_reader_mutex);
+        }
+        if (logger_reader_quit)
+            break;
+
+        /* take first pending request */
+        ptr_request = logger_reader_requests;
+        logger_reader_requests = ptr_request->next_request;
+        if (!logger_reader_requests)
+            last_logger_reader_request = NULL;
+        ptr_request->next_request = NULL;
+        logger_reader_current_request = ptr_request;
+        canceled = (ptr_request->buffer == NULL);
+        pthread_mutex_unlock (&logger_reader_mutex);
+
+        if (!canceled)
+        {
+            /* lines sent to the writer thread must be in the file */
+            logger_writer_wait ();
+
+            ptr_request->messages = logger_backlog_read (
+                ptr_request->filename,
+                ptr_request->lines,
+                ptr_request->use_index,
+                ptr_request->time_format);
+        }
+
+        pthread_mutex_lock (&logger_reader_mutex);
+        logger_reader_current_request = NULL;
+        ptr_request->next_request = logger_reader_requests_done;
+        logger_reader_requests_done = ptr_request;
+
+        /* wake up main thread */
+        c = 1;
+        if (write (logger_reader_pipe[1], &c, 1) < 0)
+        {
+            /* pipe is full: main thread will read the requests anyway */
+        }
+    }
+    pthread_mutex_unlock (&logger_reader_mutex);
+
+    return NULL;
+}
+
+/*
+ * Displays backlog of requests done by the reader thread.
+ */
+
+void
+logger_reader_display_requests ()
+{
+    struct t_logger_reader_request *ptr_requests, *ptr_next_request;
+    struct t_logger_reader_request *ptr_request, *list_requests;
+    struct t_logger_buffer *ptr_logger_buffer;
+
+    pthread_mutex_lock (&logger_reader_mutex);
+    ptr_requests = logger_reader_requests_done;
+    logger_reader_requests_done = NULL;
+    pthread_mutex_unlock (&logger_reader_mutex);
+
+    /* requests done are in reverse order: reverse the list */
+    list_requests = NULL;
+    while (ptr_requests)
+    {
+        ptr_next_request = ptr_requests->next_request;
+        ptr_requests->next_request = list_requests;
+        list_requests = ptr_requests;
+        ptr_requests = ptr_next_request;
+    }
+
+    for (ptr_request = list_requests; ptr_request;
+         ptr_request = ptr_next_request)
+    {
+        ptr_next_request = ptr_request->next_request;
+        /* buffer is NULL if the request has been canceled */
+        ptr_logger_buffer = (ptr_request->buffer) ?
+            logger_buffer_search_buffer (ptr_request->buffer) : NULL;
+        if (ptr_logger_buffer)
+        {
+            ptr_logger_buffer->log_enabled = 0;
+            logger_backlog_display (ptr_request->buffer,
+                                    ptr_request->messages);
+            ptr_logger_buffer->log_enabled = 1;
+            ptr_logger_buffer->backlog_pending = 0;
+            /* write lines logged while the backlog was read */
+            if (!logger_hook_timer && ptr_logger_buffer->flush_needed)
+                logger_buffer_flush_file (ptr_logger_buffer, 1);
+        }
+        logger_reader_request_free (ptr_request);
+    }
+}
+
+/*
+ * Callback called when the reader thread has done some requests.
+ */
+
+int
+logger_reader_fd_cb (const void *pointer, void *data, int fd)
+{
+    char buffer[256];
+
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+
+    while (read (fd, buffer, sizeof (buffer)) > 0)
+    {
+    }
+
+    logger_reader_display_requests ();
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Adds a request to read the backlog of a buffer in the reader thread.
+ *
+ * Returns:
+ *   1: OK (backlog will be displayed later by the main thread)
+ *   0: error (thread not running or not enough memory)
+ */
+
+int
+logger_reader_add (struct t_gui_buffer *buffer, const char *filename,
+                   int lines, int use_index, const char *time_format)
+{
+    struct t_logger_reader_request *new_request;
+
+    if (!logger_reader_thread_running || !buffer || !filename
+        || !time_format)
+    {
+        return 0;
+    }
+
+    new_request = malloc (sizeof (*new_request));
+    if (!new_request)
+        return 0;
+
+    new_request->buffer = buffer;
+    new_request->filename = strdup (filename);
+    new_request->lines = lines;
+    new_request->use_index = use_index;
+    new_request->time_format = strdup (time_format);
+    new_request->messages = NULL;
+    new_request->next_request = NULL;
+    if (!new_request->filename || !new_request->time_format)
+    {
+        logger_reader_request_free (new_request);
+        return 0;
+    }
+
+    pthread_mutex_lock (&logger_reader_mutex);
+    if (last_logger_reader_request)
+        last_logger_reader_request->next_request = new_request;
+    else
+        logger_reader_requests = new_request;
+    last_logger_reader_request = new_request;
+    pthread_cond_signal (&logger_reader_cond_request);
+    pthread_mutex_unlock (&logger_reader_mutex);
+
+    return 1;
+}
+
+/*
+ * Reads first the backlog of a buffer (if pending), for example when the
+ * buffer is displayed in a window.
+ */
+
+void
+logger_reader_prioritize (struct t_gui_buffer *buffer)
+{
+    struct t_logger_reader_request *ptr_request, *ptr_prev_request;
+
+    if (!logger_reader_thread_running || !buffer)
+        return;
+
+    pthread_mutex_lock (&logger_reader_mutex);
+    ptr_prev_request = NULL;
+    for (ptr_request = logger_reader_requests; ptr_request;
+         ptr_request = ptr_request->next_request)
+    {
+        if (ptr_request->buffer == buffer)
+        {
+            if (ptr_prev_request)
+            {
+                ptr_prev_request->next_request = ptr_request->next_request;
+                if (last_logger_reader_request == ptr_request)
+                    last_logger_reader_request = ptr_prev_request;
+                ptr_request->next_request = logger_reader_requests;
+                logger_reader_requests = ptr_request;
+            }
+            break;
+        }
+        ptr_prev_request = ptr_request;
+    }
+    pthread_mutex_unlock (&logger_reader_mutex);
+}
+
+/*
+ * Cancels read of backlog for a buffer (called when the buffer is closed).
+ *
+ * The requests are not freed here (one of them can be in progress in the
+ * reader thread), they are ignored and freed by the main thread when they are
+ * done.
+ */
+
+void
+logger_reader_cancel (struct t_gui_buffer *buffer)
+{
+    struct t_logger_reader_request *ptr_request;
+
+    if (!logger_reader_thread_running || !buffer)
+        return;
+
+    pthread_mutex_lock (&logger_reader_mutex);
+    for (ptr_request = logger_reader_requests; ptr_request;
+         ptr_request = ptr_request->next_request)
+    {
+        if (ptr_request->buffer == buffer)
+            ptr_request->buffer = NULL;
+    }
+    if (logger_reader_current_request
+        && (logger_reader_current_request->buffer == buffer))
+    {
+        logger_reader_current_request->buffer = NULL;
+    }
+    for (ptr_request = logger_reader_requests_done; ptr_request;
+         ptr_request = ptr_request->next_request)
+    {
+        if (ptr_request->buffer == buffer)
+            ptr_request->buffer = NULL;
+    }
+    pthread_mutex_unlock (&logger_reader_mutex);
+}
+
+/*
+ * Callback for signal "buffer_switch".
+ */
+
+int
+logger_reader_buffer_switch_signal_cb (const void *pointer, void *data,
+                                       const char *signal,
+                                       const char *type_data,
+                                       void *signal_data)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) signal;
+    (void) type_data;
+
+    logger_reader_prioritize (signal_data);
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Starts the reader thread.
+ *
+ * If the thread can not be created, the backlog is read by the main thread.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (thread not created)
+ */
+
+int
+logger_reader_init ()
+{
+    sigset_t set, old_set;
+    int rc;
+
+    if (logger_reader_thread_running)
+        return 1;
+
+    if (pipe (logger_reader_pipe) < 0)
+        goto error;
+    fcntl (logger_reader_pipe[0], F_SETFL, O_NONBLOCK);
+    fcntl (logger_reader_pipe[1], F_SETFL, O_NONBLOCK);
+
+    logger_reader_hook_fd = weechat_hook_fd (logger_reader_pipe[0], 1, 0, 0,
+                                             &logger_reader_fd_cb, NULL, NULL);
+    if (!logger_reader_hook_fd)
+        goto error;
+
+    logger_reader_quit = 0;
+
+    /* signals are handled by the main thread only */
+    sigfillset (&set);
+    pthread_sigmask (SIG_SETMASK, &set, &old_set);
+    rc = pthread_create (&logger_reader_thread, NULL,
+                         &logger_reader_thread_cb, NULL);
+    pthread_sigmask (SIG_SETMASK, &old_set, NULL);
+
+    if (rc != 0)
+        goto error;
+
+    logger_reader_thread_running = 1;
+
+    return 1;
+
+error:
+    weechat_printf (NULL,
+                    _("%s%s: unable to create reader thread, backlog will be "
+                      "read by the main thread"),
+                    weechat_prefix ("error"), LOGGER_PLUGIN_NAME);
+    if (logger_reader_hook_fd)
+    {
+        weechat_unhook (logger_reader_hook_fd);
+        logger_reader_hook_fd = NULL;
+    }
+    if (logger_reader_pipe[0] >= 0)
+    {
+        close (logger_reader_pipe[0]);
+        close (logger_reader_pipe[1]);
+        logger_reader_pipe[0] = -1;
+        logger_reader_pipe[1] = -1;
+    }
+    return 0;
+}
+
+/*
+ * Stops the reader thread: the pending requests are canceled (backlog is not
+ * displayed).
+ */
+
+void
+logger_reader_end ()
+{
+    struct t_logger_reader_request *ptr_request, *ptr_next_request;
+    struct t_logger_buffer *ptr_logger_buffer;
+
+    if (!logger_reader_thread_running)
+        return;
+
+    pthread_mutex_lock (&logger_reader_mutex);
+    logger_reader_quit = 1;
+    pthread_cond_signal (&logger_reader_cond_request);
+    pthread_mutex_unlock (&logger_reader_mutex);
+
+    pthread_join (logger_reader_thread, NULL);
+
+    logger_reader_thread_running = 0;
+
+    /* free all requests (pending and done) */
+    ptr_request = logger_reader_requests;
+    while (ptr_request)
+    {
+        ptr_next_request = ptr_request->next_request;
+        logger_reader_request_free (ptr_request);
+        ptr_request = ptr_next_request;
+    }
+    logger_reader_requests = NULL;
+    last_logger_reader_request = NULL;
+    ptr_request = logger_reader_requests_done;
+    while (ptr_request)
+    {
+        ptr_next_request = ptr_request->next_request;
+        logger_reader_request_free (ptr_request);
+        ptr_request = ptr_next_request;
+    }
+    logger_reader_requests_done = NULL;
+
+    /* lines kept in memory can now be written */
+    for (ptr_logger_buffer = logger_buffers; ptr_logger_buffer;
+         ptr_logger_buffer = ptr_logger_buffer->next_buffer)
+    {
+        ptr_logger_buffer->backlog_pending = 0;
+    }
+
+    weechat_unhook (logger_reader_hook_fd);
+    logger_reader_hook_fd = NULL;
+    close (logger_reader_pipe[0]);
+    close (logger_reader_pipe[1]);
+    logger_reader_pipe[0] = -1;
+    logger_reader_pipe[1] = -1;
+}
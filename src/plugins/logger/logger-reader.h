@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WEECHAT_PLUGIN_LOGGER_READER_H
+#define WEECHAT_PLUGIN_LOGGER_READER_H
+
+struct t_arraylist;
+
+struct t_logger_reader_request
+{
+    struct t_gui_buffer *buffer;        /* buffer (NULL if canceled)        */
+    char *filename;                     /* log filename                     */
+    int lines;                          /* max number of lines to read      */
+    int use_index;                      /* 1 to use index of log file       */
+    char *time_format;                  /* time format in log file          */
+    struct t_arraylist *messages;       /* messages read (set by thread)    */
+    struct t_logger_reader_request *next_request; /* link to next request   */
+};
+
+extern int logger_reader_thread_running;
+
+extern int logger_reader_add (struct t_gui_buffer *buffer,
+                              const char *filename, int lines, int use_index,
+                              const char *time_format);
+extern void logger_reader_prioritize (struct t_gui_buffer *buffer);
+extern void logger_reader_cancel (struct t_gui_buffer *buffer);
+extern int logger_reader_buffer_switch_signal_cb (const void *pointer,
+                                                  void *data,
+                                                  const char *signal,
+                                                  const char *type_data,
+                                                  void *signal_data);
+extern int logger_reader_init ();
+extern void logger_reader_end ();
+
+#endif /* WEECHAT_PLUGIN_LOGGER_READER_H */
@@ -0,0 +1,1296 @@
+/*
+ * logger-search.c - full-text search index of log files for logger plugin
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The search index is an inverted index: for each term (word of message,
+ * "nick:xxx" and "tag:xxx" for tags of line), the list of messages (offset
+ * in log file and date) containing this term.
+ *
+ * Postings are first accumulated in memory for each logger buffer, then
+ * written in a segment file (one per day, or when there are too many postings
+ * in memory) in a directory next to the log file:
+ *
+ *   irc.libera.#weechat.weechatlog
+ *   irc.libera.#weechat.weechatlog.fts/
+ *     0.seg
+ *     123456.seg
+ *
+ * The name of segment is the offset of its first message in the log file.
+ * The terms of a segment are sorted, so a term is found with a binary search
+ * and only the postings of the terms searched are read.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "../weechat-plugin.h"
+#include "logger.h"
+#include "logger-search.h"
+#include "logger-buffer.h"
+#include "logger-config.h"
+#include "logger-writer.h"
+
+
+#define LOGGER_SEARCH_SEPARATORS " \t\r\n!\"#$%&'()*+,-./:;<=>?@[\\]^_`{|}~"
+
+struct t_logger_search_candidate
+{
+    int file_index;                     /* index of log file in context     */
+    int64_t offset;                     /* offset of message in log file    */
+    int64_t date;                       /* date of message                  */
+};
+
+struct t_logger_search_context
+{
+    struct t_logger_search_query *query; /* search query                    */
+    char **files;                       /* log files with candidates        */
+    int num_files;                      /* number of log files              */
+    struct t_logger_search_candidate *candidates; /* messages found         */
+    int num_candidates;                 /* number of messages found         */
+    int num_candidates_alloc;           /* allocated candidates             */
+};
+
+
+/*
+ * Splits a string into words for the search index: words are converted to
+ * lower case, and words too short or too long are ignored.
+ *
+ * Note: result must be freed after use with function weechat_string_free_split.
+ */
+
+char **
+logger_search_split_words (const char *string, int *num_words)
+{
+    char *string_lower, **words;
+    int i, num, count, length;
+
+    if (num_words)
+        *num_words = 0;
+
+    if (!string || !num_words)
+        return NULL;
+
+    string_lower = weechat_string_tolower (string);
+    if (!string_lower)
+        return NULL;
+
+    words = weechat_string_split (string_lower, LOGGER_SEARCH_SEPARATORS, NULL,
+                                  WEECHAT_STRING_SPLIT_STRIP_LEFT
+                                  | WEECHAT_STRING_SPLIT_STRIP_RIGHT
+                                  | WEECHAT_STRING_SPLIT_COLLAPSE_SEPS,
+                                  0, &num);
+    free (string_lower);
+    if (!words)
+        return NULL;
+
+    count = 0;
+    for (i = 0; i < num; i++)
+    {
+        length = strlen (words[i]);
+        if ((weechat_utf8_strlen (words[i]) < LOGGER_SEARCH_WORD_MIN_LENGTH)
+            || (length > LOGGER_SEARCH_WORD_MAX_LENGTH))
+        {
+            free (words[i]);
+        }
+        else
+        {
+            words[count++] = words[i];
+        }
+    }
+    words[count] = NULL;
+
+    *num_words = count;
+
+    return words;
+}
+
+/*
+ * Frees postings of a term (value in hashtable).
+ */
+
+void
+logger_search_free_postings_cb (struct t_hashtable *hashtable,
+                                const void *key, void *value)
+{
+    struct t_logger_search_postings *postings;
+
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    postings = (struct t_logger_search_postings *)value;
+    if (postings)
+    {
+        free (postings->postings);
+        free (postings);
+    }
+}
+
+/*
+ * Adds a posting for a term in memory.
+ */
+
+void
+logger_search_add_term (struct t_logger_buffer *logger_buffer,
+                        const char *term, off_t offset, time_t date)
+{
+    struct t_logger_search_postings *ptr_postings;
+    struct t_logger_search_posting *new_postings;
+    int new_count_alloc;
+
+    if (!term || !term[0] || (strlen (term) > LOGGER_SEARCH_TERM_MAX_LENGTH))
+        return;
+
+    ptr_postings = weechat_hashtable_get (logger_buffer->search_terms, term);
+    if (!ptr_postings)
+    {
+        ptr_postings = calloc (1, sizeof (*ptr_postings));
+        if (!ptr_postings)
+            return;
+        if (!weechat_hashtable_set (logger_buffer->search_terms,
+                                    term, ptr_postings))
+        {
+            free (ptr_postings);
+            return;
+        }
+    }
+
+    /* term already added for this message */
+    if ((ptr_postings->count > 0)
+        && (ptr_postings->postings[ptr_postings->count - 1].offset
+            == (int64_t)offset))
+    {
+        return;
+    }
+
+    if (ptr_postings->count >= ptr_postings->count_alloc)
+    {
+        new_count_alloc = (ptr_postings->count_alloc < 4) ?
+            4 : ptr_postings->count_alloc * 2;
+        new_postings = realloc (ptr_postings->postings,
+                                new_count_alloc * sizeof (*new_postings));
+        if (!new_postings)
+            return;
+        ptr_postings->postings = new_postings;
+        ptr_postings->count_alloc = new_count_alloc;
+    }
+
+    ptr_postings->postings[ptr_postings->count].offset = offset;
+    ptr_postings->postings[ptr_postings->count].date = date;
+    ptr_postings->count++;
+    logger_buffer->search_num_postings++;
+}
+
+/*
+ * Adds a term with a prefix ("nick:" or "tag:") in memory.
+ */
+
+void
+logger_search_add_term_prefix (struct t_logger_buffer *logger_buffer,
+                               const char *prefix, const char *value,
+                               off_t offset, time_t date)
+{
+    char term[LOGGER_SEARCH_TERM_MAX_LENGTH + 1], *value_lower;
+
+    if (!value || !value[0])
+        return;
+
+    value_lower = weechat_string_tolower (value);
+    if (!value_lower)
+        return;
+
+    if (snprintf (term, sizeof (term), "%s%s", prefix, value_lower)
+        < (int)sizeof (term))
+    {
+        logger_search_add_term (logger_buffer, term, offset, date);
+    }
+
+    free (value_lower);
+}
+
+/*
+ * Returns the day of current date, as integer (YYYYMMDD).
+ */
+
+int
+logger_search_get_current_day ()
+{
+    time_t now;
+    struct tm *local_time;
+
+    now = time (NULL);
+    local_time = localtime (&now);
+    if (!local_time)
+        return 0;
+
+    return ((local_time->tm_year + 1900) * 10000)
+        + ((local_time->tm_mon + 1) * 100)
+        + local_time->tm_mday;
+}
+
+/*
+ * Adds a line written in log file to the search index (in memory): words of
+ * message and tags of line.
+ *
+ * The terms in memory are written in a segment when the day changes or if
+ * there are too many postings in memory.
+ */
+
+void
+logger_search_add_line (struct t_logger_buffer *logger_buffer,
+                        off_t offset, time_t date,
+                        int tags_count, const char **tags,
+                        const char *message)
+{
+    char **words;
+    int i, num_words, day;
+
+    if (!logger_buffer || (offset < 0))
+        return;
+
+    day = logger_search_get_current_day ();
+
+    if ((logger_buffer->search_num_postings > 0)
+        && ((day != logger_buffer->search_day)
+            || (logger_buffer->search_num_postings >= LOGGER_SEARCH_MAX_POSTINGS)))
+    {
+        logger_search_write_segment (logger_buffer);
+    }
+
+    if (!logger_buffer->search_terms)
+    {
+        logger_buffer->search_terms = weechat_hashtable_new (
+            256,
+            WEECHAT_HASHTABLE_STRING,
+            WEECHAT_HASHTABLE_POINTER,
+            NULL, NULL);
+        if (!logger_buffer->search_terms)
+            return;
+        weechat_hashtable_set_pointer (logger_buffer->search_terms,
+                                       "callback_free_value",
+                                       &logger_search_free_postings_cb);
+    }
+
+    if (logger_buffer->search_num_postings == 0)
+    {
+        logger_buffer->search_day = day;
+        logger_buffer->search_first_offset = offset;
+    }
+
+    words = logger_search_split_words (message, &num_words);
+    if (words)
+    {
+        for (i = 0; i < num_words; i++)
+        {
+            logger_search_add_term (logger_buffer, words[i], offset, date);
+        }
+        weechat_string_free_split (words);
+    }
+
+    for (i = 0; i < tags_count; i++)
+    {
+        if (strncmp (tags[i], "nick_", 5) == 0)
+        {
+            logger_search_add_term_prefix (logger_buffer, "nick:", tags[i] + 5,
+                                           offset, date);
+        }
+        logger_search_add_term_prefix (logger_buffer, "tag:", tags[i],
+                                       offset, date);
+    }
+}
+
+/*
+ * Returns directory with segments of a log file.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+logger_search_get_directory (const char *log_filename)
+{
+    char *directory;
+
+    if (!log_filename || !log_filename[0])
+        return NULL;
+
+    if (weechat_asprintf (&directory, "%s%s",
+                          log_filename, LOGGER_SEARCH_DIR_EXTENSION) < 0)
+    {
+        return NULL;
+    }
+
+    return directory;
+}
+
+/*
+ * Writes terms in memory to a new segment file (the write is done by the
+ * writer thread), then clears terms in memory.
+ */
+
+void
+logger_search_write_segment (struct t_logger_buffer *logger_buffer)
+{
+    struct t_logger_search_header *ptr_header;
+    struct t_logger_search_term *ptr_terms;
+    struct t_logger_search_posting *ptr_postings;
+    struct t_logger_search_postings *ptr_term_postings;
+    const char *keys;
+    char **terms, *directory, filename[PATH_MAX], *data, *ptr_strings;
+    int i, num_terms, num_postings, string_offset, length, size, fd;
+    int64_t strings_size;
+
+    if (!logger_buffer || !logger_buffer->search_terms)
+        return;
+
+    if (!logger_buffer->log_filename
+        || (logger_buffer->search_num_postings == 0))
+    {
+        logger_search_free_terms (logger_buffer);
+        return;
+    }
+
+    data = NULL;
+    terms = NULL;
+    directory = NULL;
+
+    keys = weechat_hashtable_get_string (logger_buffer->search_terms,
+                                         "keys_sorted");
+    if (!keys)
+        goto end;
+    terms = weechat_string_split (keys, ",", NULL, 0, 0, &num_terms);
+    if (!terms)
+        goto end;
+
+    /* compute size of segment */
+    num_postings = 0;
+    strings_size = 0;
+    for (i = 0; i < num_terms; i++)
+    {
+        ptr_term_postings = weechat_hashtable_get (logger_buffer->search_terms,
+                                                   terms[i]);
+        if (ptr_term_postings)
+            num_postings += ptr_term_postings->count;
+        strings_size += strlen (terms[i]);
+    }
+    size = sizeof (*ptr_header)
+        + (num_terms * sizeof (*ptr_terms))
+        + (num_postings * sizeof (*ptr_postings))
+        + strings_size;
+
+    data = calloc (1, size);
+    if (!data)
+        goto end;
+
+    ptr_header = (struct t_logger_search_header *)data;
+    ptr_terms = (struct t_logger_search_term *)(data + sizeof (*ptr_header));
+    ptr_postings = (struct t_logger_search_posting *)(
+        data + sizeof (*ptr_header) + (num_terms * sizeof (*ptr_terms)));
+    ptr_strings = (char *)(ptr_postings + num_postings);
+
+    memcpy (ptr_header->magic, LOGGER_SEARCH_MAGIC, 4);
+    ptr_header->version = LOGGER_SEARCH_VERSION;
+    ptr_header->num_terms = num_terms;
+    ptr_header->num_postings = num_postings;
+    ptr_header->date_min = INT64_MAX;
+    ptr_header->date_max = 0;
+    ptr_header->strings_size = strings_size;
+
+    num_postings = 0;
+    string_offset = 0;
+    for (i = 0; i < num_terms; i++)
+    {
+        ptr_term_postings = weechat_hashtable_get (logger_buffer->search_terms,
+                                                   terms[i]);
+        length = strlen (terms[i]);
+        memcpy (ptr_strings + string_offset, terms[i], length);
+        ptr_terms[i].string_offset = string_offset;
+        ptr_terms[i].string_length = length;
+        ptr_terms[i].postings_index = num_postings;
+        ptr_terms[i].postings_count = 0;
+        string_offset += length;
+        if (ptr_term_postings && (ptr_term_postings->count > 0))
+        {
+            memcpy (ptr_postings + num_postings, ptr_term_postings->postings,
+                    ptr_term_postings->count * sizeof (*ptr_postings));
+            ptr_terms[i].postings_count = ptr_term_postings->count;
+            if (ptr_term_postings->postings[0].date < ptr_header->date_min)
+                ptr_header->date_min = ptr_term_postings->postings[0].date;
+            if (ptr_term_postings->postings[ptr_term_postings->count - 1].date
+                > ptr_header->date_max)
+            {
+                ptr_header->date_max =
+                    ptr_term_postings->postings[ptr_term_postings->count - 1].date;
+            }
+            num_postings += ptr_term_postings->count;
+        }
+    }
+    if (ptr_header->date_min > ptr_header->date_max)
+        ptr_header->date_min = ptr_header->date_max;
+
+    /* dates of messages may not be sorted: check all postings */
+    for (i = 0; i < num_postings; i++)
+    {
+        if (ptr_postings[i].date < ptr_header->date_min)
+            ptr_header->date_min = ptr_postings[i].date;
+        if (ptr_postings[i].date > ptr_header->date_max)
+            ptr_header->date_max = ptr_postings[i].date;
+    }
+
+    directory = logger_search_get_directory (logger_buffer->log_filename);
+    if (!directory || !weechat_mkdir_parents (directory, 0700))
+        goto end;
+    snprintf (filename, sizeof (filename),
+              "%s/%lld%s",
+              directory,
+              (long long)logger_buffer->search_first_offset,
+              LOGGER_SEARCH_SEGMENT_EXTENSION);
+
+    if (weechat_logger_plugin->debug)
+    {
+        weechat_log_printf ("logger: writing search segment \"%s\" "
+                            "(%d terms, %d postings)",
+                            filename, num_terms, num_postings);
+    }
+
+    fd = open (filename, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd >= 0)
+    {
+        logger_writer_add (fd, data, size,
+                           weechat_config_boolean (logger_config_file_fsync));
+        data = NULL;
+    }
+
+end:
+    free (data);
+    free (directory);
+    weechat_string_free_split (terms);
+    logger_search_free_terms (logger_buffer);
+}
+
+/*
+ * Frees terms in memory for a logger buffer.
+ */
+
+void
+logger_search_free_terms (struct t_logger_buffer *logger_buffer)
+{
+    if (!logger_buffer)
+        return;
+
+    weechat_hashtable_free (logger_buffer->search_terms);
+    logger_buffer->search_terms = NULL;
+    logger_buffer->search_num_postings = 0;
+    logger_buffer->search_day = 0;
+    logger_buffer->search_first_offset = 0;
+}
+
+/*
+ * Removes a segment file.
+ */
+
+void
+logger_search_remove_segment_cb (void *data, const char *filename)
+{
+    int length;
+
+    /* make C compiler happy */
+    (void) data;
+
+    length = strlen (filename);
+    if ((length > 4)
+        && (strcmp (filename + length - 4, LOGGER_SEARCH_SEGMENT_EXTENSION) == 0))
+    {
+        unlink (filename);
+    }
+}
+
+/*
+ * Removes all segments of a log file (for example after rotation of log file,
+ * when offsets in segments are not valid any more).
+ */
+
+void
+logger_search_remove_segments (const char *log_filename)
+{
+    char *directory;
+
+    directory = logger_search_get_directory (log_filename);
+    if (!directory)
+        return;
+
+    weechat_exec_on_files (directory, 0, 0,
+                           &logger_search_remove_segment_cb, NULL);
+    rmdir (directory);
+
+    free (directory);
+}
+
+/*
+ * Adds a term in a search query.
+ */
+
+void
+logger_search_query_add_term (struct t_logger_search_query *query,
+                              const char *prefix, const char *term)
+{
+    char **new_terms, *new_term, *term_lower;
+
+    term_lower = weechat_string_tolower (term);
+    if (!term_lower)
+        return;
+
+    if (weechat_asprintf (&new_term, "%s%s", prefix, term_lower) < 0)
+    {
+        free (term_lower);
+        return;
+    }
+    free (term_lower);
+
+    new_terms = realloc (query->terms,
+                         (query->num_terms + 2) * sizeof (*new_terms));
+    if (!new_terms)
+    {
+        free (new_term);
+        return;
+    }
+    query->terms = new_terms;
+    query->terms[query->num_terms++] = new_term;
+    query->terms[query->num_terms] = NULL;
+}
+
+/*
+ * Parses a search query, with format:
+ *
+ *   [-buffer <name>] [-nick <nick>] [-tag <tag>] [-since <date>]
+ *   [-until <date>] [-limit <count>] [<words>...]
+ *
+ * Returns pointer to query, NULL if error (error is set in *error).
+ *
+ * Note: result must be freed after use with function
+ * logger_search_query_free.
+ */
+
+struct t_logger_search_query *
+logger_search_query_parse (const char *string, const char **error)
+{
+    struct t_logger_search_query *query;
+    struct timeval tv;
+    char **argv, **words, *error_limit;
+    int i, j, argc, num_words;
+    long limit;
+
+    if (error)
+        *error = NULL;
+
+    if (!string)
+        return NULL;
+
+    query = calloc (1, sizeof (*query));
+    if (!query)
+        return NULL;
+    query->limit = LOGGER_SEARCH_DEFAULT_LIMIT;
+
+    argv = weechat_string_split (string, " ", NULL,
+                                 WEECHAT_STRING_SPLIT_STRIP_LEFT
+                                 | WEECHAT_STRING_SPLIT_STRIP_RIGHT
+                                 | WEECHAT_STRING_SPLIT_COLLAPSE_SEPS,
+                                 0, &argc);
+
+    for (i = 0; i < argc; i++)
+    {
+        if ((strcmp (argv[i], "-buffer") == 0) && (i + 1 < argc))
+        {
+            free (query->buffer_name);
+            query->buffer_name = strdup (argv[++i]);
+        }
+        else if ((strcmp (argv[i], "-nick") == 0) && (i + 1 < argc))
+        {
+            logger_search_query_add_term (query, "nick:", argv[++i]);
+        }
+        else if ((strcmp (argv[i], "-tag") == 0) && (i + 1 < argc))
+        {
+            logger_search_query_add_term (query, "tag:", argv[++i]);
+        }
+        else if (((strcmp (argv[i], "-since") == 0)
+                  || (strcmp (argv[i], "-until") == 0))
+                 && (i + 1 < argc))
+        {
+            if (!weechat_util_parse_time (argv[i + 1], &tv))
+            {
+                if (error)
+                    *error = _("invalid date");
+                goto error;
+            }
+            if (strcmp (argv[i], "-since") == 0)
+                query->date_min = tv.tv_sec;
+            else
+                query->date_max = tv.tv_sec;
+            i++;
+        }
+        else if ((strcmp (argv[i], "-limit") == 0) && (i + 1 < argc))
+        {
+            error_limit = NULL;
+            limit = strtol (argv[i + 1], &error_limit, 10);
+            if (!error_limit || error_limit[0] || (limit < 1))
+            {
+                if (error)
+                    *error = _("invalid limit");
+                goto error;
+            }
+            query->limit = (int)limit;
+            i++;
+        }
+        else
+        {
+            words = logger_search_split_words (argv[i], &num_words);
+            if (words)
+            {
+                for (j = 0; j < num_words; j++)
+                {
+                    logger_search_query_add_term (query, "", words[j]);
+                }
+                weechat_string_free_split (words);
+            }
+        }
+    }
+
+    if (query->num_terms == 0)
+    {
+        if (error)
+            *error = _("nothing to search");
+        goto error;
+    }
+
+    weechat_string_free_split (argv);
+
+    return query;
+
+error:
+    weechat_string_free_split (argv);
+    logger_search_query_free (query);
+    return NULL;
+}
+
+/*
+ * Frees a search query.
+ */
+
+void
+logger_search_query_free (struct t_logger_search_query *query)
+{
+    if (!query)
+        return;
+
+    weechat_string_free_split (query->terms);
+    free (query->buffer_name);
+    free (query);
+}
+
+/*
+ * Keeps only postings present in both lists (sorted by offset); the result
+ * is stored in the first list.
+ *
+ * Returns number of postings in the result.
+ */
+
+int
+logger_search_intersect (struct t_logger_search_posting *postings1, int count1,
+                         const struct t_logger_search_posting *postings2,
+                         int count2)
+{
+    int i, j, count;
+
+    i = 0;
+    j = 0;
+    count = 0;
+    while ((i < count1) && (j < count2))
+    {
+        if (postings1[i].offset < postings2[j].offset)
+            i++;
+        else if (postings1[i].offset > postings2[j].offset)
+            j++;
+        else
+        {
+            postings1[count++] = postings1[i];
+            i++;
+            j++;
+        }
+    }
+
+    return count;
+}
+
+/*
+ * Adds a message found in search context.
+ */
+
+void
+logger_search_add_candidate (struct t_logger_search_context *context,
+                             int file_index,
+                             const struct t_logger_search_posting *posting)
+{
+    struct t_logger_search_candidate *new_candidates;
+    int new_count_alloc;
+
+    if ((context->query->date_min > 0)
+        && (posting->date < (int64_t)context->query->date_min))
+    {
+        return;
+    }
+    if ((context->query->date_max > 0)
+        && (posting->date > (int64_t)context->query->date_max))
+    {
+        return;
+    }
+
+    if (context->num_candidates >= context->num_candidates_alloc)
+    {
+        new_count_alloc = (context->num_candidates_alloc < 64) ?
+            64 : context->num_candidates_alloc * 2;
+        new_candidates = realloc (context->candidates,
+                                  new_count_alloc * sizeof (*new_candidates));
+        if (!new_candidates)
+            return;
+        context->candidates = new_candidates;
+        context->num_candidates_alloc = new_count_alloc;
+    }
+
+    context->candidates[context->num_candidates].file_index = file_index;
+    context->candidates[context->num_candidates].offset = posting->offset;
+    context->candidates[context->num_candidates].date = posting->date;
+    context->num_candidates++;
+}
+
+/*
+ * Adds a log file in search context (if not already added as last file).
+ *
+ * Returns index of file, -1 if error.
+ */
+
+int
+logger_search_add_file (struct t_logger_search_context *context,
+                        const char *log_filename)
+{
+    char **new_files;
+
+    if ((context->num_files > 0)
+        && (strcmp (context->files[context->num_files - 1], log_filename) == 0))
+    {
+        return context->num_files - 1;
+    }
+
+    new_files = realloc (context->files,
+                         (context->num_files + 1) * sizeof (*new_files));
+    if (!new_files)
+        return -1;
+    context->files = new_files;
+    context->files[context->num_files] = strdup (log_filename);
+    if (!context->files[context->num_files])
+        return -1;
+    context->num_files++;
+
+    return context->num_files - 1;
+}
+
+/*
+ * Reads postings of a term in a segment file.
+ *
+ * Returns postings found (number is set in *count), NULL if term is not
+ * found or error.
+ *
+ * Note: result must be freed after use.
+ */
+
+struct t_logger_search_posting *
+logger_search_segment_get_postings (int fd,
+                                    struct t_logger_search_header *header,
+                                    const char *term, int *count)
+{
+    struct t_logger_search_term entry;
+    struct t_logger_search_posting *postings;
+    char string[LOGGER_SEARCH_TERM_MAX_LENGTH + 1];
+    off_t offset_terms, offset_postings, offset_strings;
+    int low, high, middle, rc;
+
+    *count = 0;
+
+    offset_terms = sizeof (*header);
+    offset_postings = offset_terms + (header->num_terms * sizeof (entry));
+    offset_strings = offset_postings
+        + (header->num_postings * sizeof (*postings));
+
+    low = 0;
+    high = header->num_terms - 1;
+    while (low <= high)
+    {
+        middle = low + ((high - low) / 2);
+        if (pread (fd, &entry, sizeof (entry),
+                   offset_terms + (middle * sizeof (entry)))
+            != (ssize_t)sizeof (entry))
+        {
+            return NULL;
+        }
+        if ((entry.string_length < 0)
+            || (entry.string_length > LOGGER_SEARCH_TERM_MAX_LENGTH)
+            || (pread (fd, string, entry.string_length,
+                       offset_strings + entry.string_offset)
+                != (ssize_t)entry.string_length))
+        {
+            return NULL;
+        }
+        string[entry.string_length] = '\0';
+        rc = strcmp (term, string);
+        if (rc == 0)
+        {
+            if ((entry.postings_count <= 0)
+                || (entry.postings_index < 0)
+                || (entry.postings_index + entry.postings_count
+                    > header->num_postings))
+            {
+                return NULL;
+            }
+            postings = malloc (entry.postings_count * sizeof (*postings));
+            if (!postings)
+                return NULL;
+            if (pread (fd, postings, entry.postings_count * sizeof (*postings),
+                       offset_postings
+                       + (entry.postings_index * sizeof (*postings)))
+                != (ssize_t)(entry.postings_count * sizeof (*postings)))
+            {
+                free (postings);
+                return NULL;
+            }
+            *count = entry.postings_count;
+            return postings;
+        }
+        if (rc < 0)
+            high = middle - 1;
+        else
+            low = middle + 1;
+    }
+
+    /* term not found */
+    return NULL;
+}
+
+/*
+ * Searches terms of query in a segment file.
+ */
+
+void
+logger_search_segment (struct t_logger_search_context *context,
+                       const char *filename, int file_index)
+{
+    struct t_logger_search_header header;
+    struct t_logger_search_posting *postings, *postings_term;
+    struct stat st;
+    int i, fd, count, count_term;
+
+    fd = open (filename, O_RDONLY);
+    if (fd < 0)
+        return;
+
+    postings = NULL;
+    count = 0;
+
+    /* check header and size of segment */
+    if ((fstat (fd, &st) != 0)
+        || (pread (fd, &header, sizeof (header), 0) != (ssize_t)sizeof (header))
+        || (memcmp (header.magic, LOGGER_SEARCH_MAGIC, 4) != 0)
+        || (header.version != LOGGER_SEARCH_VERSION)
+        || (header.num_terms < 0)
+        || (header.num_postings < 0)
+        || (header.strings_size < 0)
+        || (st.st_size != (off_t)(sizeof (header)
+                                  + (header.num_terms
+                                     * sizeof (struct t_logger_search_term))
+                                  + (header.num_postings
+                                     * sizeof (struct t_logger_search_posting))
+                                  + header.strings_size)))
+    {
+        goto end;
+    }
+
+    /* skip segment if it has no message in the range of dates */
+    if ((context->query->date_min > 0)
+        && (header.date_max < (int64_t)context->query->date_min))
+    {
+        goto end;
+    }
+    if ((context->query->date_max > 0)
+        && (header.date_min > (int64_t)context->query->date_max))
+    {
+        goto end;
+    }
+
+    for (i = 0; i < context->query->num_terms; i++)
+    {
+        postings_term = logger_search_segment_get_postings (
+            fd, &header, context->query->terms[i], &count_term);
+        if (!postings_term)
+        {
+            count = 0;
+            goto end;
+        }
+        if (i == 0)
+        {
+            postings = postings_term;
+            count = count_term;
+        }
+        else
+        {
+            count = logger_search_intersect (postings, count,
+                                             postings_term, count_term);
+            free (postings_term);
+        }
+        if (count == 0)
+            goto end;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        logger_search_add_candidate (context, file_index, &postings[i]);
+    }
+
+end:
+    free (postings);
+    close (fd);
+}
+
+/*
+ * Searches terms of query in memory (terms not yet written in a segment).
+ */
+
+void
+logger_search_memory (struct t_logger_search_context *context,
+                      struct t_logger_buffer *logger_buffer, int file_index)
+{
+    struct t_logger_search_posting *postings;
+    struct t_logger_search_postings *ptr_postings;
+    int i, count;
+
+    postings = NULL;
+    count = 0;
+
+    for (i = 0; i < context->query->num_terms; i++)
+    {
+        ptr_postings = weechat_hashtable_get (logger_buffer->search_terms,
+                                              context->query->terms[i]);
+        if (!ptr_postings || (ptr_postings->count == 0))
+        {
+            count = 0;
+            break;
+        }
+        if (i == 0)
+        {
+            postings = malloc (ptr_postings->count * sizeof (*postings));
+            if (!postings)
+                break;
+            memcpy (postings, ptr_postings->postings,
+                    ptr_postings->count * sizeof (*postings));
+            count = ptr_postings->count;
+        }
+        else
+        {
+            count = logger_search_intersect (postings, count,
+                                             ptr_postings->postings,
+                                             ptr_postings->count);
+        }
+        if (count == 0)
+            break;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        logger_search_add_candidate (context, file_index, &postings[i]);
+    }
+
+    free (postings);
+}
+
+/*
+ * Searches terms of query in a file found in logs directory (it is used only
+ * if it is a segment file).
+ */
+
+void
+logger_search_file_cb (void *data, const char *filename)
+{
+    struct t_logger_search_context *context;
+    char *log_filename;
+    const char *pos_slash;
+    int length, length_dir, file_index;
+
+    context = (struct t_logger_search_context *)data;
+
+    /* check that file is "<log_filename>.fts/<offset>.seg" */
+    length = strlen (filename);
+    if ((length <= 4)
+        || (strcmp (filename + length - 4, LOGGER_SEARCH_SEGMENT_EXTENSION) != 0))
+    {
+        return;
+    }
+    pos_slash = strrchr (filename, '/');
+    if (!pos_slash)
+        return;
+    length_dir = pos_slash - filename;
+    if ((length_dir <= 4)
+        || (strncmp (pos_slash - 4, LOGGER_SEARCH_DIR_EXTENSION, 4) != 0))
+    {
+        return;
+    }
+
+    log_filename = weechat_strndup (filename, length_dir - 4);
+    if (!log_filename)
+        return;
+    file_index = logger_search_add_file (context, log_filename);
+    free (log_filename);
+
+    if (file_index >= 0)
+        logger_search_segment (context, filename, file_index);
+}
+
+/*
+ * Compares two candidates (by date, then file and offset).
+ */
+
+int
+logger_search_candidate_cmp (const void *candidate1, const void *candidate2)
+{
+    const struct t_logger_search_candidate *ptr_candidate1, *ptr_candidate2;
+
+    ptr_candidate1 = (const struct t_logger_search_candidate *)candidate1;
+    ptr_candidate2 = (const struct t_logger_search_candidate *)candidate2;
+
+    if (ptr_candidate1->date != ptr_candidate2->date)
+        return (ptr_candidate1->date < ptr_candidate2->date) ? -1 : 1;
+    if (ptr_candidate1->file_index != ptr_candidate2->file_index)
+        return (ptr_candidate1->file_index < ptr_candidate2->file_index) ? -1 : 1;
+    if (ptr_candidate1->offset != ptr_candidate2->offset)
+        return (ptr_candidate1->offset < ptr_candidate2->offset) ? -1 : 1;
+    return 0;
+}
+
+/*
+ * Reads a line in a log file at a given offset, and converts it from terminal
+ * charset to internal charset.
+ *
+ * Returns line read, NULL if error.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+logger_search_read_line (const char *filename, int64_t offset)
+{
+    char buffer[1024], **line, *pos_eol, *line_internal;
+    ssize_t bytes_read;
+    int fd;
+
+    fd = open (filename, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    line = weechat_string_dyn_alloc (256);
+    if (!line)
+    {
+        close (fd);
+        return NULL;
+    }
+
+    while (1)
+    {
+        bytes_read = pread (fd, buffer, sizeof (buffer) - 1, (off_t)offset);
+        if (bytes_read <= 0)
+            break;
+        buffer[bytes_read] = '\0';
+        pos_eol = strchr (buffer, '\n');
+        if (pos_eol)
+        {
+            weechat_string_dyn_concat (line, buffer, pos_eol - buffer);
+            break;
+        }
+        weechat_string_dyn_concat (line, buffer, bytes_read);
+        offset += bytes_read;
+    }
+
+    close (fd);
+
+    line_internal = (logger_charset_terminal) ?
+        weechat_iconv_to_internal (logger_charset_terminal, *line) : NULL;
+    if (line_internal)
+    {
+        weechat_string_dyn_free (line, 1);
+        return line_internal;
+    }
+
+    return weechat_string_dyn_free (line, 0);
+}
+
+/*
+ * Frees a search result (in arraylist).
+ */
+
+void
+logger_search_result_free_cb (void *data, struct t_arraylist *arraylist,
+                              void *pointer)
+{
+    struct t_logger_search_result *result;
+
+    /* make C compiler happy */
+    (void) data;
+    (void) arraylist;
+
+    result = (struct t_logger_search_result *)pointer;
+    if (result)
+    {
+        free (result->log_filename);
+        free (result->line);
+        free (result);
+    }
+}
+
+/*
+ * Runs a search query on all log files (or only the log file of buffer if
+ * the query has a buffer): segment files and terms in memory.
+ *
+ * Returns arraylist with the most recent results found (struct
+ * t_logger_search_result), sorted by date, NULL if error.
+ *
+ * Note: result must be freed after use.
+ */
+
+struct t_arraylist *
+logger_search_run (struct t_logger_search_query *query)
+{
+    struct t_logger_search_context context;
+    struct t_logger_search_result *new_result;
+    struct t_logger_buffer *ptr_logger_buffer, *ptr_logger_buffer_query;
+    struct t_arraylist *results;
+    char *directory, *file_path, *line;
+    int i, file_index;
+
+    if (!query)
+        return NULL;
+
+    results = weechat_arraylist_new (query->limit, 0, 1,
+                                     NULL, NULL,
+                                     &logger_search_result_free_cb, NULL);
+    if (!results)
+        return NULL;
+
+    ptr_logger_buffer_query = NULL;
+    if (query->buffer_name)
+    {
+        ptr_logger_buffer_query = logger_buffer_search_buffer (
+            weechat_buffer_search ("==", query->buffer_name));
+        if (!ptr_logger_buffer_query || !ptr_logger_buffer_query->log_filename)
+            return results;
+    }
+
+    /* lines in memory and segments must be written to read them */
+    logger_buffer_flush ();
+    logger_writer_wait ();
+
+    memset (&context, 0, sizeof (context));
+    context.query = query;
+
+    /* search in segment files */
+    if (ptr_logger_buffer_query)
+    {
+        directory = logger_search_get_directory (
+            ptr_logger_buffer_query->log_filename);
+        if (directory)
+        {
+            weechat_exec_on_files (directory, 0, 0,
+                                   &logger_search_file_cb, &context);
+            free (directory);
+        }
+    }
+    else
+    {
+        file_path = logger_get_file_path ();
+        if (file_path)
+        {
+            weechat_exec_on_files (file_path, 1, 0,
+                                   &logger_search_file_cb, &context);
+            free (file_path);
+        }
+    }
+
+    /* search in terms in memory */
+    for (ptr_logger_buffer = logger_buffers; ptr_logger_buffer;
+         ptr_logger_buffer = ptr_logger_buffer->next_buffer)
+    {
+        if (!ptr_logger_buffer->search_terms
+            || !ptr_logger_buffer->log_filename
+            || (ptr_logger_buffer_query
+                && (ptr_logger_buffer != ptr_logger_buffer_query)))
+        {
+            continue;
+        }
+        file_index = logger_search_add_file (&context,
+                                             ptr_logger_buffer->log_filename);
+        if (file_index >= 0)
+            logger_search_memory (&context, ptr_logger_buffer, file_index);
+    }
+
+    /* keep the most recent messages */
+    if (context.num_candidates > 0)
+    {
+        qsort (context.candidates, context.num_candidates,
+               sizeof (*context.candidates), &logger_search_candidate_cmp);
+    }
+    for (i = context.num_candidates - 1;
+         (i >= 0) && (weechat_arraylist_size (results) < query->limit); i--)
+    {
+        line = logger_search_read_line (
+            context.files[context.candidates[i].file_index],
+            context.candidates[i].offset);
+        if (!line)
+            continue;
+        new_result = malloc (sizeof (*new_result));
+        if (!new_result)
+        {
+            free (line);
+            break;
+        }
+        new_result->log_filename = strdup (
+            context.files[context.candidates[i].file_index]);
+        new_result->date = (time_t)context.candidates[i].date;
+        new_result->line = line;
+        weechat_arraylist_insert (results, 0, new_result);
+    }
+
+    for (i = 0; i < context.num_files; i++)
+    {
+        free (context.files[i]);
+    }
+    free (context.files);
+    free (context.candidates);
+
+    return results;
+}
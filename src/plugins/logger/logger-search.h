@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WEECHAT_PLUGIN_LOGGER_SEARCH_H
+#define WEECHAT_PLUGIN_LOGGER_SEARCH_H
+
+#include <stdint.h>
+#include <time.h>
+#include <sys/types.h>
+
+#define LOGGER_SEARCH_DIR_EXTENSION ".fts"
+#define LOGGER_SEARCH_SEGMENT_EXTENSION ".seg"
+#define LOGGER_SEARCH_MAGIC "WLSI"
+#define LOGGER_SEARCH_VERSION 1
+
+#define LOGGER_SEARCH_WORD_MIN_LENGTH 2
+#define LOGGER_SEARCH_WORD_MAX_LENGTH 64
+#define LOGGER_SEARCH_TERM_MAX_LENGTH 128
+#define LOGGER_SEARCH_MAX_POSTINGS 100000
+#define LOGGER_SEARCH_DEFAULT_LIMIT 50
+
+struct t_logger_buffer;
+struct t_arraylist;
+
+/*
+ * Segment file (native byte order):
+ *   header | terms (sorted by string) | postings | strings of terms
+ */
+
+struct t_logger_search_header
+{
+    char magic[4];                      /* "WLSI"                           */
+    int32_t version;                    /* version of format                */
+    int32_t num_terms;                  /* number of terms                  */
+    int32_t num_postings;               /* number of postings               */
+    int64_t date_min;                   /* date of oldest message           */
+    int64_t date_max;                   /* date of newest message           */
+    int64_t strings_size;               /* size of strings of terms         */
+};
+
+struct t_logger_search_term
+{
+    int32_t string_offset;              /* offset of term in strings        */
+    int32_t string_length;              /* length of term                   */
+    int32_t postings_index;             /* index of first posting           */
+    int32_t postings_count;             /* number of postings               */
+};
+
+struct t_logger_search_posting
+{
+    int64_t offset;                     /* offset of message in log file    */
+    int64_t date;                       /* date of message                  */
+};
+
+/* postings of a term in memory (not yet written in a segment) */
+
+struct t_logger_search_postings
+{
+    struct t_logger_search_posting *postings; /* postings (sorted by offset)*/
+    int count;                          /* number of postings               */
+    int count_alloc;                    /* number of allocated postings     */
+};
+
+struct t_logger_search_query
+{
+    char **terms;                       /* terms (words, nick:xxx, tag:xxx) */
+    int num_terms;                      /* number of terms                  */
+    char *buffer_name;                  /* search only in this buffer       */
+    time_t date_min;                    /* date min (0 = no limit)          */
+    time_t date_max;                    /* date max (0 = no limit)          */
+    int limit;                          /* max number of results            */
+};
+
+struct t_logger_search_result
+{
+    char *log_filename;                 /* log file                         */
+    time_t date;                        /* date of message                  */
+    char *line;                         /* line in log file                 */
+};
+
+extern char **logger_search_split_words (const char *string, int *num_words);
+extern void logger_search_add_line (struct t_logger_buffer *logger_buffer,
+                                    off_t offset, time_t date,
+                                    int tags_count, const char **tags,
+                                    const char *message);
+extern void logger_search_write_segment (struct t_logger_buffer *logger_buffer);
+extern void logger_search_free_terms (struct t_logger_buffer *logger_buffer);
+extern void logger_search_remove_segments (const char *log_filename);
+extern struct t_logger_search_query *logger_search_query_parse (const char *string,
+                                                                const char **error);
+extern void logger_search_query_free (struct t_logger_search_query *query);
+extern struct t_arraylist *logger_search_run (struct t_logger_search_query *query);
+
+#endif /* WEECHAT_PLUGIN_LOGGER_SEARCH_H */
@@ -33,6 +33,7 @@
 #include "../weechat-plugin.h"
 #include "logger.h"
 #include "logger-tail.h"
+#include "logger-zstd.h"
 
 
 #define LOGGER_TAIL_BUFSIZE 4096
@@ -94,6 +95,9 @@ logger_tail_lines_free_cb (void *data, struct t_arraylist *arraylist,
 /*
  * Returns last lines of a file.
  *
+ * If the file is compressed with zstd (current log file compressed while it
+ * is written), the last lines are read in the last zstd frames.
+ *
  * Note: result must be freed after use.
  */
 
@@ -111,6 +115,9 @@ logger_tail_file (const char *filename, int lines)
     if (!filename || !filename[0] || (lines < 1))
         return NULL;
 
+    if (logger_zstd_is_compressed (filename))
+        return logger_zstd_tail_file (filename, lines);
+
     fd = -1;
     part_of_line = 0;
     list_lines = NULL;
@@ -238,3 +245,77 @@ error:
         close (fd);
     return NULL;
 }
+
+/*
+ * Returns lines of a file, starting at an offset (up to the end of file).
+ *
+ * Note: result must be freed after use.
+ */
+
+struct t_arraylist *
+logger_tail_file_from_offset (const char *filename, off_t offset)
+{
+    int fd;
+    off_t file_length;
+    size_t to_read;
+    ssize_t bytes_read;
+    char *buf, *ptr_buf, *pos_eol;
+    struct t_arraylist *list_lines;
+
+    if (!filename || !filename[0] || (offset < 0))
+        return NULL;
+
+    buf = NULL;
+    list_lines = NULL;
+
+    /* open file */
+    fd = open (filename, O_RDONLY);
+    if (fd == -1)
+        goto error;
+
+    file_length = lseek (fd, (off_t)0, SEEK_END);
+    if (file_length <= offset)
+        goto error;
+
+    /* read file from offset to the end of file */
+    to_read = file_length - offset;
+    buf = malloc (to_read + 1);
+    if (!buf)
+        goto error;
+    bytes_read = pread (fd, buf, to_read, offset);
+    if (bytes_read <= 0)
+        goto error;
+    buf[bytes_read] = '\0';
+
+    /* allocate arraylist */
+    list_lines = weechat_arraylist_new (32, 0, 1,
+                                        &logger_tail_lines_cmp_cb, NULL,
+                                        &logger_tail_lines_free_cb, NULL);
+    if (!list_lines)
+        goto error;
+
+    /* split lines */
+    ptr_buf = buf;
+    while (ptr_buf[0])
+    {
+        pos_eol = strpbrk (ptr_buf, "\r\n");
+        if (pos_eol)
+            pos_eol[0] = '\0';
+        weechat_arraylist_add (list_lines, strdup (ptr_buf));
+        if (!pos_eol)
+            break;
+        ptr_buf = pos_eol + 1;
+    }
+
+    free (buf);
+    close (fd);
+
+    return list_lines;
+
+error:
+    free (buf);
+    weechat_arraylist_free (list_lines);
+    if (fd >= 0)
+        close (fd);
+    return NULL;
+}
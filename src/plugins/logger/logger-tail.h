@@ -20,6 +20,21 @@
 #ifndef WEECHAT_PLUGIN_LOGGER_TAIL_H
 #define WEECHAT_PLUGIN_LOGGER_TAIL_H
 
+#include <sys/types.h>
+
+struct t_arraylist;
+
+extern const char *logger_tail_last_eol (const char *string_start,
+                                         const char *string_ptr);
+extern int logger_tail_lines_cmp_cb (void *data,
+                                     struct t_arraylist *arraylist,
+                                     void *pointer1,
+                                     void *pointer2);
+extern void logger_tail_lines_free_cb (void *data,
+                                       struct t_arraylist *arraylist,
+                                       void *pointer);
 extern struct t_arraylist *logger_tail_file (const char *filename, int lines);
+extern struct t_arraylist *logger_tail_file_from_offset (const char *filename,
+                                                         off_t offset);
 
 #endif /* WEECHAT_PLUGIN_LOGGER_TAIL_H */
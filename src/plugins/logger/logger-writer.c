@@ -0,0 +1,280 @@
+/*
+ * logger-writer.c - thread writing log files for logger plugin
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The main thread formats the lines and appends them in a buffer for each log
+ * file; on flush, the content of this buffer is sent as a batch to the writer
+ * thread, which writes it to disk (one write per file and flush), then calls
+ * fsync if needed.
+ *
+ * Each batch has its own file descriptor (duplicated from the log file), so
+ * the main thread can close or reopen the log file at any time.
+ */
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <pthread.h>
+
+#include "../weechat-plugin.h"
+#include "logger.h"
+#include "logger-writer.h"
+
+
+int logger_writer_thread_running = 0;  /* 1 if writer thread is running     */
+
+pthread_t logger_writer_thread;
+pthread_mutex_t logger_writer_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t logger_writer_cond_batch = PTHREAD_COND_INITIALIZER;
+pthread_cond_t logger_writer_cond_idle = PTHREAD_COND_INITIALIZER;
+
+struct t_logger_writer_batch *logger_writer_batches = NULL;
+struct t_logger_writer_batch *last_logger_writer_batch = NULL;
+int logger_writer_busy = 0;            /* 1 if thread is writing batches    */
+int logger_writer_quit = 0;            /* 1 if thread must exit             */
+
+
+/*
+ * Writes a batch on disk and frees it.
+ *
+ * Note: this function is called by the writer thread (or by the main thread
+ * if the writer thread is not running), so it must not call any WeeChat API
+ * function.
+ */
+
+void
+logger_writer_write_batch (struct t_logger_writer_batch *batch)
+{
+    ssize_t num_written;
+    int offset;
+
+    if (!batch)
+        return;
+
+    offset = 0;
+    while (offset < batch->size)
+    {
+        num_written = write (batch->fd, batch->data + offset,
+                             batch->size - offset);
+        if (num_written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        offset += num_written;
+    }
+
+    if (batch->fsync)
+        fsync (batch->fd);
+
+    close (batch->fd);
+    free (batch->data);
+    free (batch);
+}
+
+/*
+ * Writer thread: writes all pending batches, then waits for new batches.
+ */
+
+void *
+logger_writer_thread_cb (void *arg)
+{
+    struct t_logger_writer_batch *ptr_batches, *ptr_next_batch;
+
+    /* make C compiler happy */
+    (void) arg;
+
+    pthread_mutex_lock (&logger_writer_mutex);
+    while (1)
+    {
+        while (!logger_writer_batches && !logger_writer_quit)
+        {
+            pthread_cond_wait (&logger_writer_cond_batch, &logger_writer_mutex);
+        }
+        if (!logger_writer_batches && logger_writer_quit)
+            break;
+
+        /* take all pending batches */
+        ptr_batches = logger_writer_batches;
+        logger_writer_batches = NULL;
+        last_logger_writer_batch = NULL;
+        logger_writer_busy = 1;
+        pthread_mutex_unlock (&logger_writer_mutex);
+
+        while (ptr_batches)
+        {
+            ptr_next_batch = ptr_batches->next_batch;
+            logger_writer_write_batch (ptr_batches);
+            ptr_batches = ptr_next_batch;
+        }
+
+        pthread_mutex_lock (&logger_writer_mutex);
+        logger_writer_busy = 0;
+        if (!logger_writer_batches)
+            pthread_cond_broadcast (&logger_writer_cond_idle);
+    }
+    pthread_mutex_unlock (&logger_writer_mutex);
+
+    return NULL;
+}
+
+/*
+ * Adds a batch to write in a file.
+ *
+ * The file descriptor and data are owned by the batch: they are closed/freed
+ * after the write, even in case of error.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+logger_writer_add (int fd, char *data, int size, int fsync)
+{
+    struct t_logger_writer_batch *new_batch;
+
+    if ((fd < 0) || !data || (size < 0))
+    {
+        if (fd >= 0)
+            close (fd);
+        free (data);
+        return 0;
+    }
+
+    new_batch = malloc (sizeof (*new_batch));
+    if (!new_batch)
+    {
+        close (fd);
+        free (data);
+        return 0;
+    }
+
+    new_batch->fd = fd;
+    new_batch->data = data;
+    new_batch->size = size;
+    new_batch->fsync = fsync;
+    new_batch->next_batch = NULL;
+
+    if (!logger_writer_thread_running)
+    {
+        /* no thread: write immediately */
+        logger_writer_write_batch (new_batch);
+        return 1;
+    }
+
+    pthread_mutex_lock (&logger_writer_mutex);
+    if (last_logger_writer_batch)
+        last_logger_writer_batch->next_batch = new_batch;
+    else
+        logger_writer_batches = new_batch;
+    last_logger_writer_batch = new_batch;
+    pthread_cond_signal (&logger_writer_cond_batch);
+    pthread_mutex_unlock (&logger_writer_mutex);
+
+    return 1;
+}
+
+/*
+ * Waits until all pending batches are written on disk.
+ *
+ * This blocks the main thread and must be used only when needed (for example
+ * before the rotation of a log file).
+ */
+
+void
+logger_writer_wait ()
+{
+    if (!logger_writer_thread_running)
+        return;
+
+    pthread_mutex_lock (&logger_writer_mutex);
+    while (logger_writer_batches || logger_writer_busy)
+    {
+        pthread_cond_wait (&logger_writer_cond_idle, &logger_writer_mutex);
+    }
+    pthread_mutex_unlock (&logger_writer_mutex);
+}
+
+/*
+ * Starts the writer thread.
+ *
+ * If the thread can not be created, the batches are written by the main
+ * thread.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (thread not created)
+ */
+
+int
+logger_writer_init ()
+{
+    sigset_t set, old_set;
+    int rc;
+
+    if (logger_writer_thread_running)
+        return 1;
+
+    logger_writer_quit = 0;
+
+    /* signals are handled by the main thread only */
+    sigfillset (&set);
+    pthread_sigmask (SIG_SETMASK, &set, &old_set);
+    rc = pthread_create (&logger_writer_thread, NULL,
+                         &logger_writer_thread_cb, NULL);
+    pthread_sigmask (SIG_SETMASK, &old_set, NULL);
+
+    if (rc != 0)
+    {
+        weechat_printf (NULL,
+                        _("%s%s: unable to create writer thread, log files "
+                          "will be written by the main thread"),
+                        weechat_prefix ("error"), LOGGER_PLUGIN_NAME);
+        return 0;
+    }
+
+    logger_writer_thread_running = 1;
+
+    return 1;
+}
+
+/*
+ * Writes all pending batches and stops the writer thread.
+ */
+
+void
+logger_writer_end ()
+{
+    if (!logger_writer_thread_running)
+        return;
+
+    pthread_mutex_lock (&logger_writer_mutex);
+    logger_writer_quit = 1;
+    pthread_cond_signal (&logger_writer_cond_batch);
+    pthread_mutex_unlock (&logger_writer_mutex);
+
+    pthread_join (logger_writer_thread, NULL);
+
+    logger_writer_thread_running = 0;
+}
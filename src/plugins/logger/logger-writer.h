@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WEECHAT_PLUGIN_LOGGER_WRITER_H
+#define WEECHAT_PLUGIN_LOGGER_WRITER_H
+
+struct t_logger_writer_batch
+{
+    int fd;                             /* file descriptor (owned by batch) */
+    char *data;                         /* data to write (owned by batch)   */
+    int size;                           /* size of data                     */
+    int fsync;                          /* 1 to call fsync after write      */
+    struct t_logger_writer_batch *next_batch; /* link to next batch         */
+};
+
+extern int logger_writer_thread_running;
+
+extern void logger_writer_write_batch (struct t_logger_writer_batch *batch);
+extern int logger_writer_add (int fd, char *data, int size, int fsync);
+extern void logger_writer_wait ();
+extern int logger_writer_init ();
+extern void logger_writer_end ();
+
+#endif /* WEECHAT_PLUGIN_LOGGER_WRITER_H */
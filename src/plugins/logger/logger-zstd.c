@@ -0,0 +1,444 @@
+/*
+ * logger-zstd.c - zstd compression of current log files for logger plugin
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * A compressed log file is a sequence of independent zstd frames (one per
+ * flush of the log file), so the file can be decompressed at any time with
+ * "zstdcat", even while it is written.
+ *
+ * Each zstd frame is followed by a skippable frame (ignored by zstd tools)
+ * with the compressed and decompressed size of the frame, so the file can be
+ * read backwards, frame by frame, to get the last lines:
+ *
+ *   +-------------+----------------+-------------+----------------+-----
+ *   | zstd frame  | skippable frame| zstd frame  | skippable frame| ...
+ *   | (lines)     | (16 bytes)     | (lines)     | (16 bytes)     |
+ *   +-------------+----------------+-------------+----------------+-----
+ *
+ * Skippable frame: magic (4 bytes) + size of payload (4 bytes, always 8) +
+ * size of previous zstd frame (4 bytes) + size of its content (4 bytes),
+ * all integers are little-endian.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <string.h>
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "../weechat-plugin.h"
+#include "logger.h"
+#include "logger-tail.h"
+#include "logger-zstd.h"
+
+
+#define LOGGER_ZSTD_BUFSIZE 65536
+
+
+/*
+ * Checks if zstd compression is available.
+ *
+ * Returns:
+ *   1: zstd is available
+ *   0: zstd is not available
+ */
+
+int
+logger_zstd_available ()
+{
+#ifdef HAVE_ZSTD
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+/*
+ * Checks if a file is compressed with zstd (file starting with a zstd frame).
+ *
+ * Returns:
+ *   1: file is compressed with zstd
+ *   0: file is not compressed (or empty, or error)
+ */
+
+int
+logger_zstd_is_compressed (const char *filename)
+{
+    char magic[4];
+    int fd, rc;
+
+    if (!filename || !filename[0])
+        return 0;
+
+    fd = open (filename, O_RDONLY);
+    if (fd < 0)
+        return 0;
+
+    rc = ((read (fd, magic, sizeof (magic)) == (ssize_t)sizeof (magic))
+          && (memcmp (magic, LOGGER_ZSTD_MAGIC, sizeof (magic)) == 0));
+
+    close (fd);
+
+    return rc;
+}
+
+/*
+ * Writes an unsigned 32-bit integer (little-endian).
+ */
+
+void
+logger_zstd_write_uint32 (unsigned char *buffer, uint32_t value)
+{
+    buffer[0] = value & 0xFF;
+    buffer[1] = (value >> 8) & 0xFF;
+    buffer[2] = (value >> 16) & 0xFF;
+    buffer[3] = (value >> 24) & 0xFF;
+}
+
+/*
+ * Reads an unsigned 32-bit integer (little-endian).
+ */
+
+uint32_t
+logger_zstd_read_uint32 (const unsigned char *buffer)
+{
+    return (uint32_t)buffer[0]
+        | ((uint32_t)buffer[1] << 8)
+        | ((uint32_t)buffer[2] << 16)
+        | ((uint32_t)buffer[3] << 24);
+}
+
+/*
+ * Compresses data in a zstd frame, followed by the skippable frame with the
+ * sizes of frame.
+ *
+ * Argument "compression_level" is a percentage (1-100), converted to zstd
+ * compression level (1-19).
+ *
+ * Returns pointer to frames (size is set in *size_frame), NULL if error.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+logger_zstd_compress_frame (const char *data, int size,
+                            int compression_level, int *size_frame)
+{
+#ifdef HAVE_ZSTD
+    unsigned char *frame;
+    size_t bound, size_compressed;
+    int level;
+
+    if (size_frame)
+        *size_frame = 0;
+
+    if (!data || (size <= 0) || !size_frame)
+        return NULL;
+
+    if ((compression_level < 1) || (compression_level > 100))
+        compression_level = 20;
+    level = (((compression_level - 1) * 19) / 100) + 1;
+
+    bound = ZSTD_compressBound (size);
+    frame = malloc (bound + LOGGER_ZSTD_TRAILER_SIZE);
+    if (!frame)
+        return NULL;
+
+    size_compressed = ZSTD_compress (frame, bound, data, size, level);
+    if (ZSTD_isError (size_compressed))
+    {
+        free (frame);
+        return NULL;
+    }
+
+    memcpy (frame + size_compressed, LOGGER_ZSTD_TRAILER_MAGIC, 4);
+    logger_zstd_write_uint32 (frame + size_compressed + 4, 8);
+    logger_zstd_write_uint32 (frame + size_compressed + 8, size_compressed);
+    logger_zstd_write_uint32 (frame + size_compressed + 12, size);
+
+    *size_frame = size_compressed + LOGGER_ZSTD_TRAILER_SIZE;
+
+    return (char *)frame;
+#else
+    /* make C compiler happy */
+    (void) data;
+    (void) size;
+    (void) compression_level;
+
+    if (size_frame)
+        *size_frame = 0;
+
+    return NULL;
+#endif
+}
+
+#ifdef HAVE_ZSTD
+/*
+ * Decompresses a whole file with zstd frames (used if skippable frames are
+ * missing, for example with a file compressed by zstd tool).
+ *
+ * Returns decompressed content, NULL if error.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+logger_zstd_decompress_file (int fd)
+{
+    ZSTD_DStream *dstream;
+    ZSTD_inBuffer input;
+    ZSTD_outBuffer output;
+    char *buffer_in, *buffer_out, **content;
+    ssize_t bytes_read;
+    size_t rc;
+
+    dstream = NULL;
+    content = NULL;
+    buffer_in = malloc (LOGGER_ZSTD_BUFSIZE);
+    buffer_out = malloc (LOGGER_ZSTD_BUFSIZE);
+    if (!buffer_in || !buffer_out)
+        goto error;
+
+    content = weechat_string_dyn_alloc (LOGGER_ZSTD_BUFSIZE);
+    if (!content)
+        goto error;
+
+    dstream = ZSTD_createDStream ();
+    if (!dstream)
+        goto error;
+    ZSTD_initDStream (dstream);
+
+    lseek (fd, 0, SEEK_SET);
+    while ((bytes_read = read (fd, buffer_in, LOGGER_ZSTD_BUFSIZE)) > 0)
+    {
+        input.src = buffer_in;
+        input.size = bytes_read;
+        input.pos = 0;
+        do
+        {
+            output.dst = buffer_out;
+            output.size = LOGGER_ZSTD_BUFSIZE;
+            output.pos = 0;
+            rc = ZSTD_decompressStream (dstream, &output, &input);
+            if (ZSTD_isError (rc))
+                goto error;
+            weechat_string_dyn_concat (content, buffer_out, output.pos);
+        } while ((input.pos < input.size) || (output.pos == output.size));
+    }
+
+    ZSTD_freeDStream (dstream);
+    free (buffer_in);
+    free (buffer_out);
+
+    return weechat_string_dyn_free (content, 0);
+
+error:
+    if (dstream)
+        ZSTD_freeDStream (dstream);
+    free (buffer_in);
+    free (buffer_out);
+    weechat_string_dyn_free (content, 1);
+    return NULL;
+}
+
+/*
+ * Decompresses the last frames of a file, until at least "lines" lines are
+ * read (or beginning of file is reached).
+ *
+ * Returns decompressed content, NULL if error or if a skippable frame is
+ * missing.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+logger_zstd_decompress_last_frames (int fd, off_t file_length, int lines)
+{
+    unsigned char trailer[LOGGER_ZSTD_TRAILER_SIZE];
+    char *frame, *content, *new_content, *ptr_char;
+    uint32_t frame_size, content_size;
+    size_t rc, content_length;
+    off_t pos;
+    int count_lines;
+
+    content = NULL;
+    content_length = 0;
+    count_lines = 0;
+    pos = file_length;
+
+    while ((pos > 0) && (count_lines < lines))
+    {
+        if ((pos < LOGGER_ZSTD_TRAILER_SIZE)
+            || (pread (fd, trailer, sizeof (trailer),
+                       pos - LOGGER_ZSTD_TRAILER_SIZE)
+                != (ssize_t)sizeof (trailer))
+            || (memcmp (trailer, LOGGER_ZSTD_TRAILER_MAGIC, 4) != 0)
+            || (logger_zstd_read_uint32 (trailer + 4) != 8))
+        {
+            goto error;
+        }
+        frame_size = logger_zstd_read_uint32 (trailer + 8);
+        content_size = logger_zstd_read_uint32 (trailer + 12);
+        if ((off_t)frame_size > pos - LOGGER_ZSTD_TRAILER_SIZE)
+            goto error;
+        pos -= LOGGER_ZSTD_TRAILER_SIZE + frame_size;
+
+        /* read and decompress frame before the current content */
+        frame = malloc (frame_size);
+        if (!frame)
+            goto error;
+        new_content = malloc (content_size + content_length + 1);
+        if (!new_content)
+        {
+            free (frame);
+            goto error;
+        }
+        if (pread (fd, frame, frame_size, pos) != (ssize_t)frame_size)
+        {
+            free (frame);
+            free (new_content);
+            goto error;
+        }
+        rc = ZSTD_decompress (new_content, content_size, frame, frame_size);
+        free (frame);
+        if (ZSTD_isError (rc) || (rc != content_size))
+        {
+            free (new_content);
+            goto error;
+        }
+        if (content)
+            memcpy (new_content + content_size, content, content_length);
+        new_content[content_size + content_length] = '\0';
+        free (content);
+        content = new_content;
+        content_length += content_size;
+
+        for (ptr_char = content; ptr_char < content + content_size; ptr_char++)
+        {
+            if (ptr_char[0] == '\n')
+                count_lines++;
+        }
+    }
+
+    return content;
+
+error:
+    free (content);
+    return NULL;
+}
+#endif /* HAVE_ZSTD */
+
+/*
+ * Returns last lines of a file compressed with zstd.
+ *
+ * Note: result must be freed after use.
+ */
+
+struct t_arraylist *
+logger_zstd_tail_file (const char *filename, int lines)
+{
+#ifdef HAVE_ZSTD
+    struct t_arraylist *list_lines;
+    char *content, *pos_eol;
+    off_t file_length;
+    int fd;
+
+    if (!filename || !filename[0] || (lines < 1))
+        return NULL;
+
+    fd = open (filename, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    file_length = lseek (fd, (off_t)0, SEEK_END);
+    if (file_length <= 0)
+    {
+        close (fd);
+        return NULL;
+    }
+
+    /* read the last frames, or the whole file if skippable frames are missing */
+    content = logger_zstd_decompress_last_frames (fd, file_length, lines + 1);
+    if (!content)
+        content = logger_zstd_decompress_file (fd);
+
+    close (fd);
+
+    if (!content)
+        return NULL;
+
+    list_lines = weechat_arraylist_new (lines, 0, 1,
+                                        &logger_tail_lines_cmp_cb, NULL,
+                                        &logger_tail_lines_free_cb, NULL);
+    if (!list_lines)
+    {
+        free (content);
+        return NULL;
+    }
+
+    if (!content[0])
+    {
+        free (content);
+        return list_lines;
+    }
+
+    /* ignore last new line of the file */
+    pos_eol = content + strlen (content);
+    if ((pos_eol > content)
+        && ((pos_eol[-1] == '\n') || (pos_eol[-1] == '\r')))
+    {
+        pos_eol--;
+        pos_eol[0] = '\0';
+    }
+
+    /* add lines from the end */
+    while (lines > 0)
+    {
+        pos_eol = (char *)logger_tail_last_eol (content, pos_eol - 1);
+        if (!pos_eol)
+        {
+            weechat_arraylist_insert (list_lines, 0, strdup (content));
+            break;
+        }
+        pos_eol[0] = '\0';
+        weechat_arraylist_insert (list_lines, 0, strdup (pos_eol + 1));
+        lines--;
+    }
+
+    free (content);
+
+    return list_lines;
+#else
+    /* make C compiler happy */
+    (void) filename;
+    (void) lines;
+
+    return NULL;
+#endif
+}
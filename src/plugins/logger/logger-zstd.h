@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WEECHAT_PLUGIN_LOGGER_ZSTD_H
+#define WEECHAT_PLUGIN_LOGGER_ZSTD_H
+
+/* magic number of a zstd frame (little-endian) */
+#define LOGGER_ZSTD_MAGIC "\x28\xB5\x2F\xFD"
+
+/* skippable frame written after each zstd frame (ignored by zstd tools) */
+#define LOGGER_ZSTD_TRAILER_MAGIC "\x5E\x2A\x4D\x18"
+#define LOGGER_ZSTD_TRAILER_SIZE 16
+
+extern int logger_zstd_available ();
+extern int logger_zstd_is_compressed (const char *filename);
+extern char *logger_zstd_compress_frame (const char *data, int size,
+                                         int compression_level,
+                                         int *size_frame);
+extern struct t_arraylist *logger_zstd_tail_file (const char *filename,
+                                                  int lines);
+
+#endif /* WEECHAT_PLUGIN_LOGGER_ZSTD_H */
@@ -34,7 +34,10 @@
 #include "logger-command.h"
 #include "logger-config.h"
 #include "logger-info.h"
+#include "logger-reader.h"
+#include "logger-search.h"
 #include "logger-tail.h"
+#include "logger-writer.h"
 
 
 WEECHAT_PLUGIN_NAME(LOGGER_PLUGIN_NAME);
@@ -49,6 +52,11 @@ struct t_weechat_plugin *weechat_logger_plugin = NULL;
 struct t_hook *logger_hook_timer = NULL;    /* timer to flush log files     */
 struct t_hook *logger_hook_print = NULL;
 
+char *logger_charset_terminal = NULL;       /* charset used in log files    */
+
+time_t logger_time_cache_date = -1;         /* date of cached time string   */
+char logger_time_cache_string[256];         /* last formatted time          */
+
 
 /*
  * Checks conditions against a buffer.
@@ -677,6 +685,51 @@ logger_get_line_tag_info (int tags_count, const char **tags,
     }
 }
 
+/*
+ * Resets the cache of formatted time (called when option
+ * "logger.file.time_format" is changed).
+ */
+
+void
+logger_time_cache_reset ()
+{
+    logger_time_cache_date = -1;
+    logger_time_cache_string[0] = '\0';
+}
+
+/*
+ * Formats a date with option "logger.file.time_format".
+ *
+ * The last formatted time is cached and returned as-is for lines printed
+ * during the same second, unless the format contains microseconds.
+ *
+ * Note: the result must not be freed and is overwritten on next call.
+ */
+
+const char *
+logger_format_time (time_t date, int date_usec)
+{
+    struct timeval tv;
+    const char *ptr_format;
+
+    if ((logger_time_cache_date >= 0) && (date == logger_time_cache_date))
+        return logger_time_cache_string;
+
+    ptr_format = weechat_config_string (logger_config_file_time_format);
+
+    tv.tv_sec = date;
+    tv.tv_usec = date_usec;
+    weechat_util_strftimeval (logger_time_cache_string,
+                              sizeof (logger_time_cache_string),
+                              ptr_format, &tv);
+
+    /* the time string can be cached only if it does not contain microseconds */
+    logger_time_cache_date = (strstr (ptr_format, "%.")
+                              || strstr (ptr_format, "%f")) ? -1 : date;
+
+    return logger_time_cache_string;
+}
+
 /*
  * Callback for print hooked.
  */
@@ -689,10 +742,10 @@ logger_print_cb (const void *pointer, void *data,
                  const char *prefix, const char *message)
 {
     struct t_logger_buffer *ptr_logger_buffer;
-    struct timeval tv;
-    char buf_time[256], *prefix_ansi, *message_ansi;
+    char *prefix_ansi, *message_ansi, *message_no_color;
     const char *ptr_prefix, *ptr_message;
     int line_log_level, prefix_is_nick, color_lines;
+    off_t offset;
 
     /* make C compiler happy */
     (void) pointer;
@@ -728,23 +781,28 @@ logger_print_cb (const void *pointer, void *data,
             ptr_prefix = prefix;
             ptr_message = message;
         }
-        tv.tv_sec = date;
-        tv.tv_usec = date_usec;
-        weechat_util_strftimeval (
-            buf_time, sizeof (buf_time),
-            weechat_config_string (logger_config_file_time_format),
-            &tv);
-
-        logger_buffer_write_line (
+        offset = logger_buffer_write_line (
             ptr_logger_buffer,
+            date,
             "%s\t%s%s%s\t%s%s",
-            buf_time,
+            logger_format_time (date, date_usec),
             (ptr_prefix && prefix_is_nick) ? weechat_config_string (logger_config_file_nick_prefix) : "",
             (ptr_prefix) ? ptr_prefix : "",
             (ptr_prefix && prefix_is_nick) ? weechat_config_string (logger_config_file_nick_suffix) : "",
             (color_lines) ? "\x1B[0m" : "",
             ptr_message);
 
+        if ((offset >= 0)
+            && weechat_config_boolean (logger_config_file_search_index))
+        {
+            message_no_color = weechat_string_remove_color (message, NULL);
+            logger_search_add_line (ptr_logger_buffer, offset, date,
+                                    tags_count, tags,
+                                    (message_no_color) ?
+                                    message_no_color : message);
+            free (message_no_color);
+        }
+
         free (prefix_ansi);
         free (message_ansi);
     }
@@ -789,6 +847,11 @@ weechat_plugin_init (struct t_weechat_plugin *plugin, int argc, char *argv[])
 
     logger_command_init ();
 
+    logger_charset_terminal = weechat_info_get ("charset_terminal", "");
+
+    logger_writer_init ();
+    logger_reader_init ();
+
     logger_buffer_start_all (1);
 
     weechat_hook_signal ("buffer_opened",
@@ -797,6 +860,8 @@ weechat_plugin_init (struct t_weechat_plugin *plugin, int argc, char *argv[])
                          &logger_buffer_closing_signal_cb, NULL, NULL);
     weechat_hook_signal ("buffer_renamed",
                          &logger_buffer_renamed_signal_cb, NULL, NULL);
+    weechat_hook_signal ("buffer_switch",
+                         &logger_reader_buffer_switch_signal_cb, NULL, NULL);
     weechat_hook_signal ("logger_backlog",
                          &logger_backlog_signal_cb, NULL, NULL);
     weechat_hook_signal ("logger_start",
@@ -837,8 +902,15 @@ weechat_plugin_end (struct t_weechat_plugin *plugin)
 
     logger_config_write ();
 
+    logger_reader_end ();
+
     logger_buffer_stop_all (1);
 
+    logger_writer_end ();
+
+    free (logger_charset_terminal);
+    logger_charset_terminal = NULL;
+
     logger_config_free ();
 
     return WEECHAT_RC_OK;
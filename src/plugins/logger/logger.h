@@ -33,13 +33,17 @@ extern struct t_weechat_plugin *weechat_logger_plugin;
 
 extern struct t_hook *logger_hook_timer;
 extern struct t_hook *logger_hook_print;
+extern char *logger_charset_terminal;
 
 extern int logger_check_conditions (struct t_gui_buffer *buffer,
                                     const char *conditions);
+extern char *logger_get_file_path ();
 extern int logger_create_directory ();
 extern char *logger_build_option_name (struct t_gui_buffer *buffer);
 extern int logger_get_level_for_buffer (struct t_gui_buffer *buffer);
 extern char *logger_get_filename (struct t_gui_buffer *buffer);
+extern void logger_time_cache_reset ();
+extern const char *logger_format_time (time_t date, int date_usec);
 extern int logger_print_cb (const void *pointer, void *data,
                             struct t_gui_buffer *buffer,
                             time_t date, int date_usec,
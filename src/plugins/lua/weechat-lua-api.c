@@ -5569,6 +5569,33 @@ API_FUNC(hdata_hashtable)
     return 1;
 }
 
+API_FUNC(hdata_get_fields)
+{
+    const char *hdata, *pointer, *fields;
+    struct t_hashtable *result_hashtable;
+    int count;
+
+    API_INIT_FUNC(1, "hdata_get_fields", API_RETURN_EMPTY);
+    if (lua_gettop (L) < 4)
+        API_WRONG_ARGS(API_RETURN_EMPTY);
+
+    hdata = lua_tostring (L, -4);
+    pointer = lua_tostring (L, -3);
+    count = lua_tonumber (L, -2);
+    fields = lua_tostring (L, -1);
+
+    result_hashtable = weechat_hdata_get_fields (API_STR2PTR(hdata),
+                                                 API_STR2PTR(pointer),
+                                                 count,
+                                                 fields);
+
+    weechat_lua_pushhashtable (L, result_hashtable);
+
+    weechat_hashtable_free (result_hashtable);
+
+    return 1;
+}
+
 API_FUNC(hdata_compare)
 {
     const char *hdata, *pointer1, *pointer2, *name;
@@ -5971,6 +5998,7 @@ const struct luaL_Reg weechat_lua_api_funcs[] = {
     API_DEF_FUNC(hdata_pointer),
     API_DEF_FUNC(hdata_time),
     API_DEF_FUNC(hdata_hashtable),
+    API_DEF_FUNC(hdata_get_fields),
     API_DEF_FUNC(hdata_compare),
     API_DEF_FUNC(hdata_update),
     API_DEF_FUNC(hdata_get_string),
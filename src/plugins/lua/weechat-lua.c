@@ -28,6 +28,8 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 #include "../weechat-plugin.h"
 #include "../plugin-script.h"
@@ -49,6 +51,8 @@ struct t_plugin_script_data lua_data;
 struct t_config_file *lua_config_file = NULL;
 struct t_config_option *lua_config_look_check_license = NULL;
 struct t_config_option *lua_config_look_eval_keep_context = NULL;
+struct t_config_option *lua_config_look_autoload_deferred = NULL;
+struct t_config_option *lua_config_look_bytecode_cache = NULL;
 
 int lua_quiet = 0;
 
@@ -505,6 +509,226 @@ weechat_lua_register_lib (lua_State *L, const char *libname,
     lua_pop (L, 1);
 }
 
+/*
+ * Returns path to the bytecode cache of a script file:
+ * "${weechat_cache_dir}/lua/<sha1 of script path>.luac".
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+weechat_lua_bytecode_cache_path (const char *filename)
+{
+    char hash[256 / 8], hash_hex[((256 / 8) * 2) + 1], *cache_dir, *path;
+    int hash_size;
+
+    if (!weechat_crypto_hash (filename, strlen (filename), "sha1",
+                              hash, &hash_size))
+    {
+        return NULL;
+    }
+    if (weechat_string_base_encode ("16", hash, hash_size, hash_hex) < 0)
+        return NULL;
+
+    cache_dir = weechat_string_eval_path_home ("${weechat_cache_dir}/"
+                                               LUA_PLUGIN_NAME,
+                                               NULL, NULL, NULL);
+    if (!cache_dir)
+        return NULL;
+
+    weechat_asprintf (&path, "%s/%s.luac", cache_dir, hash_hex);
+
+    free (cache_dir);
+
+    return path;
+}
+
+/*
+ * Returns header of the bytecode cache of a script file: it contains the
+ * Lua version, the path, the modification time and the size of the script
+ * file, so that the cache is used only if it has been built by this Lua
+ * version from the current script file.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+weechat_lua_bytecode_cache_header (const char *filename,
+                                   struct stat *st_script)
+{
+    char *header;
+
+    if (weechat_asprintf (&header,
+                          "weechat-lua-bytecode\n%s\n%s\n%lld %lld\n",
+                          LUA_RELEASE,
+                          filename,
+                          (long long)st_script->st_mtime,
+                          (long long)st_script->st_size) < 0)
+    {
+        return NULL;
+    }
+
+    return header;
+}
+
+/*
+ * Loads compiled chunk of a script file from the bytecode cache (if option
+ * lua.look.bytecode_cache is enabled and if the cache is valid).
+ *
+ * Returns:
+ *   1: chunk loaded from cache (compiled function is pushed on the stack)
+ *   0: cache not used (nothing is pushed on the stack)
+ */
+
+int
+weechat_lua_bytecode_cache_load (lua_State *interpreter, const char *filename)
+{
+    struct stat st_script, st_cache;
+    char *path, *header, *data, *chunk_name;
+    size_t length_header;
+    FILE *file;
+    int rc;
+
+    if (!weechat_config_boolean (lua_config_look_bytecode_cache))
+        return 0;
+
+    if (stat (filename, &st_script) != 0)
+        return 0;
+
+    rc = 0;
+    path = NULL;
+    header = NULL;
+    data = NULL;
+    chunk_name = NULL;
+    file = NULL;
+
+    path = weechat_lua_bytecode_cache_path (filename);
+    if (!path || (stat (path, &st_cache) != 0))
+        goto end;
+    header = weechat_lua_bytecode_cache_header (filename, &st_script);
+    if (!header)
+        goto end;
+    length_header = strlen (header);
+    if ((st_cache.st_size <= (off_t)length_header)
+        || (st_cache.st_mtime < st_script.st_mtime))
+    {
+        goto end;
+    }
+
+    file = fopen (path, "rb");
+    if (!file)
+        goto end;
+    data = malloc (st_cache.st_size);
+    if (!data)
+        goto end;
+    if (fread (data, 1, st_cache.st_size, file) != (size_t)st_cache.st_size)
+        goto end;
+    if (memcmp (data, header, length_header) != 0)
+        goto end;
+
+    if (weechat_asprintf (&chunk_name, "@%s", filename) < 0)
+        goto end;
+    if (luaL_loadbuffer (interpreter,
+                         data + length_header,
+                         st_cache.st_size - length_header,
+                         chunk_name) != 0)
+    {
+        /* invalid cache: remove error from stack, source will be loaded */
+        lua_pop (interpreter, 1);
+        goto end;
+    }
+
+    rc = 1;
+
+end:
+    if (file)
+        fclose (file);
+    free (path);
+    free (header);
+    free (data);
+    free (chunk_name);
+    return rc;
+}
+
+/*
+ * Writes a part of compiled chunk in the bytecode cache.
+ *
+ * Returns 0 if OK, 1 if error.
+ */
+
+int
+weechat_lua_bytecode_cache_writer (lua_State *interpreter, const void *data,
+                                   size_t size, void *user_data)
+{
+    /* make C compiler happy */
+    (void) interpreter;
+
+    return (fwrite (data, 1, size, (FILE *)user_data) == size) ? 0 : 1;
+}
+
+/*
+ * Saves compiled chunk of a script file (function on top of stack) in the
+ * bytecode cache (if option lua.look.bytecode_cache is enabled).
+ *
+ * The cache is written in a temporary file which is then renamed, so that a
+ * partial cache is never read.
+ */
+
+void
+weechat_lua_bytecode_cache_save (lua_State *interpreter, const char *filename)
+{
+    struct stat st_script;
+    char *path, *path_tmp, *header;
+    FILE *file;
+    int rc;
+
+    if (!weechat_config_boolean (lua_config_look_bytecode_cache))
+        return;
+
+    if (stat (filename, &st_script) != 0)
+        return;
+
+    if (!weechat_mkdir_home ("${weechat_cache_dir}/" LUA_PLUGIN_NAME, 0755))
+        return;
+
+    path = weechat_lua_bytecode_cache_path (filename);
+    if (!path)
+        return;
+    header = weechat_lua_bytecode_cache_header (filename, &st_script);
+    if (!header)
+    {
+        free (path);
+        return;
+    }
+
+    if (weechat_asprintf (&path_tmp, "%s.tmp", path) >= 0)
+    {
+        file = fopen (path_tmp, "wb");
+        if (file)
+        {
+            rc = (fputs (header, file) >= 0) ? 0 : 1;
+            if (rc == 0)
+            {
+#if LUA_VERSION_NUM >= 503
+                rc = lua_dump (interpreter, &weechat_lua_bytecode_cache_writer,
+                               file, 0);
+#else
+                rc = lua_dump (interpreter, &weechat_lua_bytecode_cache_writer,
+                               file);
+#endif /* LUA_VERSION_NUM >= 503 */
+            }
+            if (fclose (file) != 0)
+                rc = 1;
+            if ((rc != 0) || (rename (path_tmp, path) != 0))
+                unlink (path_tmp);
+        }
+        free (path_tmp);
+    }
+
+    free (path);
+    free (header);
+}
+
 /*
  * Loads a lua script.
  *
@@ -624,19 +848,27 @@ weechat_lua_load (const char *filename, const char *code)
     }
     else
     {
-        /* read and execute code from file */
-        if (luaL_loadfile (lua_current_interpreter, filename) != 0)
+        /* read and execute code from bytecode cache or from file */
+        if (!weechat_lua_bytecode_cache_load (lua_current_interpreter,
+                                              filename))
         {
-            weechat_printf (NULL,
-                            weechat_gettext ("%s%s: unable to load file \"%s\""),
-                            weechat_prefix ("error"), LUA_PLUGIN_NAME, filename);
-            weechat_printf (NULL,
-                            weechat_gettext ("%s%s: error: %s"),
-                            weechat_prefix ("error"), LUA_PLUGIN_NAME,
-                            lua_tostring (lua_current_interpreter, -1));
-            lua_close (lua_current_interpreter);
-            fclose (fp);
-            return NULL;
+            if (luaL_loadfile (lua_current_interpreter, filename) != 0)
+            {
+                weechat_printf (NULL,
+                                weechat_gettext ("%s%s: unable to load file "
+                                                 "\"%s\""),
+                                weechat_prefix ("error"), LUA_PLUGIN_NAME,
+                                filename);
+                weechat_printf (NULL,
+                                weechat_gettext ("%s%s: error: %s"),
+                                weechat_prefix ("error"), LUA_PLUGIN_NAME,
+                                lua_tostring (lua_current_interpreter, -1));
+                lua_close (lua_current_interpreter);
+                fclose (fp);
+                return NULL;
+            }
+            weechat_lua_bytecode_cache_save (lua_current_interpreter,
+                                             filename);
         }
     }
 
@@ -716,13 +948,18 @@ void
 weechat_lua_load_cb (void *data, const char *filename)
 {
     const char *pos_dot;
-
-    /* make C compiler happy */
-    (void) data;
+    int old_lua_quiet;
 
     pos_dot = strrchr (filename, '.');
     if (pos_dot && (strcmp (pos_dot, ".lua") == 0))
+    {
+        /* data is an optional pointer to integer: 1 for quiet mode */
+        old_lua_quiet = lua_quiet;
+        if (data && *((int *)data))
+            lua_quiet = 1;
         weechat_lua_load (filename, NULL);
+        lua_quiet = old_lua_quiet;
+    }
 }
 
 /*
@@ -1285,6 +1522,8 @@ weechat_plugin_init (struct t_weechat_plugin *plugin, int argc, char *argv[])
     lua_data.config_file = &lua_config_file;
     lua_data.config_look_check_license = &lua_config_look_check_license;
     lua_data.config_look_eval_keep_context = &lua_config_look_eval_keep_context;
+    lua_data.config_look_autoload_deferred = &lua_config_look_autoload_deferred;
+    lua_data.config_look_bytecode_cache = &lua_config_look_bytecode_cache;
     lua_data.scripts = &lua_scripts;
     lua_data.last_script = &last_lua_script;
     lua_data.callback_command = &weechat_lua_command_cb;
@@ -5491,6 +5491,34 @@ API_FUNC(hdata_hashtable)
     API_RETURN_OBJ(result_hash);
 }
 
+API_FUNC(hdata_get_fields)
+{
+    char *hdata, *pointer, *fields;
+    struct t_hashtable *result_hashtable;
+    HV *result_hash;
+    int count;
+    dXSARGS;
+
+    API_INIT_FUNC(1, "hdata_get_fields", API_RETURN_EMPTY);
+    if (items < 4)
+        API_WRONG_ARGS(API_RETURN_EMPTY);
+
+    hdata = SvPV_nolen (ST (0));
+    pointer = SvPV_nolen (ST (1));
+    count = SvIV(ST (2));
+    fields = SvPV_nolen (ST (3));
+
+    result_hashtable = weechat_hdata_get_fields (API_STR2PTR(hdata),
+                                                 API_STR2PTR(pointer),
+                                                 count,
+                                                 fields);
+    result_hash = weechat_perl_hashtable_to_hash (result_hashtable);
+
+    weechat_hashtable_free (result_hashtable);
+
+    API_RETURN_OBJ(result_hash);
+}
+
 API_FUNC(hdata_compare)
 {
     char *hdata, *pointer1, *pointer2, *name;
@@ -5909,6 +5937,7 @@ weechat_perl_api_init (pTHX)
     API_DEF_FUNC(hdata_pointer);
     API_DEF_FUNC(hdata_time);
     API_DEF_FUNC(hdata_hashtable);
+    API_DEF_FUNC(hdata_get_fields);
     API_DEF_FUNC(hdata_compare);
     API_DEF_FUNC(hdata_update);
     API_DEF_FUNC(hdata_get_string);
@@ -47,6 +47,7 @@ struct t_plugin_script_data perl_data;
 struct t_config_file *perl_config_file = NULL;
 struct t_config_option *perl_config_look_check_license = NULL;
 struct t_config_option *perl_config_look_eval_keep_context = NULL;
+struct t_config_option *perl_config_look_autoload_deferred = NULL;
 
 int perl_quiet = 0;
 
@@ -672,13 +673,18 @@ void
 weechat_perl_load_cb (void *data, const char *filename)
 {
     const char *pos_dot;
-
-    /* make C compiler happy */
-    (void) data;
+    int old_perl_quiet;
 
     pos_dot = strrchr (filename, '.');
     if (pos_dot && (strcmp (pos_dot, ".pl") == 0))
+    {
+        /* data is an optional pointer to integer: 1 for quiet mode */
+        old_perl_quiet = perl_quiet;
+        if (data && *((int *)data))
+            perl_quiet = 1;
         weechat_perl_load (filename, NULL);
+        perl_quiet = old_perl_quiet;
+    }
 }
 
 /*
@@ -1310,6 +1316,7 @@ weechat_plugin_init (struct t_weechat_plugin *plugin, int argc, char *argv[])
     perl_data.config_file = &perl_config_file;
     perl_data.config_look_check_license = &perl_config_look_check_license;
     perl_data.config_look_eval_keep_context = &perl_config_look_eval_keep_context;
+    perl_data.config_look_autoload_deferred = &perl_config_look_autoload_deferred;
     perl_data.scripts = &perl_scripts;
     perl_data.last_script = &last_perl_script;
     perl_data.callback_command = &weechat_perl_command_cb;
@@ -5659,6 +5659,34 @@ API_FUNC(hdata_hashtable)
     weechat_php_hashtable_to_array (result, return_value);
 }
 
+API_FUNC(hdata_get_fields)
+{
+    zend_string *z_hdata, *z_pointer, *z_fields;
+    zend_long z_count;
+    struct t_hdata *hdata;
+    void *pointer;
+    int count;
+    char *fields;
+    struct t_hashtable *result;
+
+    API_INIT_FUNC(1, "hdata_get_fields", API_RETURN_EMPTY);
+    if (zend_parse_parameters (ZEND_NUM_ARGS(), "SSlS", &z_hdata, &z_pointer,
+                               &z_count, &z_fields) == FAILURE)
+        API_WRONG_ARGS(API_RETURN_EMPTY);
+
+    hdata = (struct t_hdata *)API_STR2PTR(ZSTR_VAL(z_hdata));
+    pointer = (void *)API_STR2PTR(ZSTR_VAL(z_pointer));
+    count = (int)z_count;
+    fields = ZSTR_VAL(z_fields);
+
+    result = weechat_hdata_get_fields (hdata, pointer, count,
+                                       (const char *)fields);
+
+    weechat_php_hashtable_to_array (result, return_value);
+
+    weechat_hashtable_free (result);
+}
+
 API_FUNC(hdata_compare)
 {
     zend_string *z_hdata, *z_pointer1, *z_pointer2, *z_name;
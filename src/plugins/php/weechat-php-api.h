@@ -258,6 +258,7 @@ PHP_FUNCTION(weechat_hdata_string);
 PHP_FUNCTION(weechat_hdata_pointer);
 PHP_FUNCTION(weechat_hdata_time);
 PHP_FUNCTION(weechat_hdata_hashtable);
+PHP_FUNCTION(weechat_hdata_get_fields);
 PHP_FUNCTION(weechat_hdata_compare);
 PHP_FUNCTION(weechat_hdata_update);
 PHP_FUNCTION(weechat_hdata_get_string);
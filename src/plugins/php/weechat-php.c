@@ -62,6 +62,7 @@ struct t_plugin_script_data php_data;
 struct t_config_file *php_config_file = NULL;
 struct t_config_option *php_config_look_check_license = NULL;
 struct t_config_option *php_config_look_eval_keep_context = NULL;
+struct t_config_option *php_config_look_autoload_deferred = NULL;
 
 int php_quiet = 0;
 
@@ -316,6 +317,7 @@ const zend_function_entry weechat_functions[] = {
     PHP_FE(weechat_hdata_pointer, arginfo_weechat_hdata_pointer)
     PHP_FE(weechat_hdata_time, arginfo_weechat_hdata_time)
     PHP_FE(weechat_hdata_hashtable, arginfo_weechat_hdata_hashtable)
+    PHP_FE(weechat_hdata_get_fields, arginfo_weechat_hdata_get_fields)
     PHP_FE(weechat_hdata_compare, arginfo_weechat_hdata_compare)
     PHP_FE(weechat_hdata_update, arginfo_weechat_hdata_update)
     PHP_FE(weechat_hdata_get_string, arginfo_weechat_hdata_get_string)
@@ -716,13 +718,18 @@ void
 weechat_php_load_cb (void *data, const char *filename)
 {
     const char *pos_dot;
-
-    /* make C compiler happy */
-    (void) data;
+    int old_php_quiet;
 
     pos_dot = strrchr (filename, '.');
     if (pos_dot && (strcmp (pos_dot, ".php") == 0))
+    {
+        /* data is an optional pointer to integer: 1 for quiet mode */
+        old_php_quiet = php_quiet;
+        if (data && *((int *)data))
+            php_quiet = 1;
         weechat_php_load (filename, NULL);
+        php_quiet = old_php_quiet;
+    }
 }
 
 /*
@@ -1296,6 +1303,7 @@ weechat_plugin_init (struct t_weechat_plugin *plugin, int argc, char *argv[])
     php_data.config_file = &php_config_file;
     php_data.config_look_check_license = &php_config_look_check_license;
     php_data.config_look_eval_keep_context = &php_config_look_eval_keep_context;
+    php_data.config_look_autoload_deferred = &php_config_look_autoload_deferred;
     php_data.scripts = &php_scripts;
     php_data.last_script = &last_php_script;
     php_data.callback_command = &weechat_php_command_cb;
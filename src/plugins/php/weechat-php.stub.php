@@ -224,6 +224,7 @@ function weechat_hdata_string(string $p0, string $p1, string $p2): string {}
 function weechat_hdata_pointer(string $p0, string $p1, string $p2): string {}
 function weechat_hdata_time(string $p0, string $p1, string $p2): int {}
 function weechat_hdata_hashtable(string $p0, string $p1, string $p2): void {}
+function weechat_hdata_get_fields(string $p0, string $p1, int $p2, string $p3): void {}
 function weechat_hdata_compare(string $p0, string $p1, string $p2, string $p3, int $p4): int {}
 function weechat_hdata_update(string $p0, string $p1, array $p2): int {}
 function weechat_hdata_get_string(string $p0, string $p1): string {}
@@ -632,6 +632,13 @@ ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_weechat_hdata_hashtable, 0, 3, I
 	ZEND_ARG_TYPE_INFO(0, p2, IS_STRING, 0)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_weechat_hdata_get_fields, 0, 4, IS_VOID, 0)
+	ZEND_ARG_TYPE_INFO(0, p0, IS_STRING, 0)
+	ZEND_ARG_TYPE_INFO(0, p1, IS_STRING, 0)
+	ZEND_ARG_TYPE_INFO(0, p2, IS_LONG, 0)
+	ZEND_ARG_TYPE_INFO(0, p3, IS_STRING, 0)
+ZEND_END_ARG_INFO()
+
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_weechat_hdata_compare, 0, 5, IS_LONG, 0)
 	ZEND_ARG_TYPE_INFO(0, p0, IS_STRING, 0)
 	ZEND_ARG_TYPE_INFO(0, p1, IS_STRING, 0)
@@ -463,6 +463,8 @@ ZEND_END_ARG_INFO()
 
 #define arginfo_weechat_hdata_hashtable arginfo_weechat_ngettext
 
+#define arginfo_weechat_hdata_get_fields arginfo_weechat_string_eval_expression
+
 #define arginfo_weechat_hdata_compare arginfo_weechat_print_datetime_tags
 
 #define arginfo_weechat_hdata_update arginfo_weechat_ngettext
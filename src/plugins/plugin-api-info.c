@@ -35,6 +35,7 @@
 #include "../core/core-hashtable.h"
 #include "../core/core-hook.h"
 #include "../core/core-infolist.h"
+#include "../core/core-profile.h"
 #include "../core/core-proxy.h"
 #include "../core/core-secure.h"
 #include "../core/core-string.h"
@@ -61,6 +62,15 @@
 #include "plugin.h"
 
 
+/*
+ * options changing the nick colors: the infos "nick_color*" are cached and
+ * the cache is cleared when one of these options is changed
+ */
+#define PLUGIN_API_INFO_NICK_COLOR_OPTIONS                              \
+    "weechat.look.nick_color_*;weechat.color.chat_nick_colors;"         \
+    "weechat.palette.*"
+
+
 /*
  * Returns WeeChat info "version".
  */
@@ -1929,6 +1939,38 @@ plugin_api_infolist_plugin_cb (const void *pointer, void *data,
     return NULL;
 }
 
+/*
+ * Returns WeeChat infolist "profile".
+ *
+ * Note: result must be freed after use with function weechat_infolist_free().
+ */
+
+struct t_infolist *
+plugin_api_infolist_profile_cb (const void *pointer, void *data,
+                                const char *infolist_name,
+                                void *obj_pointer, const char *arguments)
+{
+    struct t_infolist *ptr_infolist;
+
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) infolist_name;
+    (void) obj_pointer;
+    (void) arguments;
+
+    ptr_infolist = infolist_new (NULL);
+    if (!ptr_infolist)
+        return NULL;
+
+    if (!profile_add_to_infolist (ptr_infolist))
+    {
+        infolist_free (ptr_infolist);
+        return NULL;
+    }
+    return ptr_infolist;
+}
+
 /*
  * Returns WeeChat infolist "proxy".
  *
@@ -2127,6 +2169,8 @@ plugin_api_infolist_window_cb (const void *pointer, void *data,
 void
 plugin_api_info_init ()
 {
+    struct t_hook *ptr_hook;
+
     /* WeeChat core info hooks */
     hook_info (NULL, "version",
                N_("WeeChat version"),
@@ -2256,42 +2300,50 @@ plugin_api_info_init ()
                N_("RGB color converted to terminal color (0-255)"),
                N_("rgb,limit (limit is optional and is set to 256 by default)"),
                &plugin_api_info_color_rgb2term_cb, NULL, NULL);
-    hook_info (NULL, "nick_color",
-               N_("get nick color code"),
-               N_("nickname;colors (colors is an optional comma-separated "
-                  "list of colors to use; background is allowed for a color "
-                  "with format text:background; if colors is present, WeeChat "
-                  "options with nick colors and forced nick colors are "
-                  "ignored)"),
-               &plugin_api_info_nick_color_cb, NULL, NULL);
-    hook_info (NULL, "nick_color_name",
-               N_("get nick color name"),
-               N_("nickname;colors (colors is an optional comma-separated "
-                  "list of colors to use; background is allowed for a color "
-                  "with format text:background; if colors is present, WeeChat "
-                  "options with nick colors and forced nick colors are "
-                  "ignored)"),
-               &plugin_api_info_nick_color_name_cb, NULL, NULL);
-    hook_info (NULL, "nick_color_ignore_case",
-               N_("get nick color code, ignoring case"),
-               N_("nickname;range;colors (range is a number of chars (see "
-                  "function strcasecmp_range, 0 = convert to lower case without "
-                   "using a range), colors is an optional comma-separated list "
-                  "of colors to use; background is allowed for a color with "
-                  "format text:background; if colors is present, WeeChat "
-                  "options with nick colors and forced nick colors are "
-                  "ignored)"),
-               &plugin_api_info_nick_color_ignore_case_cb, NULL, NULL);
-    hook_info (NULL, "nick_color_name_ignore_case",
-               N_("get nick color name, ignoring case"),
-               N_("nickname;range;colors (range is a number of chars (see "
-                  "function strcasecmp_range, 0 = convert to lower case without "
-                   "using a range), colors is an optional comma-separated list "
-                  "of colors to use; background is allowed for a color with "
-                  "format text:background; if colors is present, WeeChat "
-                  "options with nick colors and forced nick colors are "
-                  "ignored)"),
-               &plugin_api_info_nick_color_name_ignore_case_cb, NULL, NULL);
+    ptr_hook = hook_info (
+        NULL, "nick_color",
+        N_("get nick color code"),
+        N_("nickname;colors (colors is an optional comma-separated "
+           "list of colors to use; background is allowed for a color "
+           "with format text:background; if colors is present, WeeChat "
+           "options with nick colors and forced nick colors are "
+           "ignored)"),
+        &plugin_api_info_nick_color_cb, NULL, NULL);
+    hook_set (ptr_hook, "cache_config", PLUGIN_API_INFO_NICK_COLOR_OPTIONS);
+    ptr_hook = hook_info (
+        NULL, "nick_color_name",
+        N_("get nick color name"),
+        N_("nickname;colors (colors is an optional comma-separated "
+           "list of colors to use; background is allowed for a color "
+           "with format text:background; if colors is present, WeeChat "
+           "options with nick colors and forced nick colors are "
+           "ignored)"),
+        &plugin_api_info_nick_color_name_cb, NULL, NULL);
+    hook_set (ptr_hook, "cache_config", PLUGIN_API_INFO_NICK_COLOR_OPTIONS);
+    ptr_hook = hook_info (
+        NULL, "nick_color_ignore_case",
+        N_("get nick color code, ignoring case"),
+        N_("nickname;range;colors (range is a number of chars (see "
+           "function strcasecmp_range, 0 = convert to lower case without "
+            "using a range), colors is an optional comma-separated list "
+           "of colors to use; background is allowed for a color with "
+           "format text:background; if colors is present, WeeChat "
+           "options with nick colors and forced nick colors are "
+           "ignored)"),
+        &plugin_api_info_nick_color_ignore_case_cb, NULL, NULL);
+    hook_set (ptr_hook, "cache_config", PLUGIN_API_INFO_NICK_COLOR_OPTIONS);
+    ptr_hook = hook_info (
+        NULL, "nick_color_name_ignore_case",
+        N_("get nick color name, ignoring case"),
+        N_("nickname;range;colors (range is a number of chars (see "
+           "function strcasecmp_range, 0 = convert to lower case without "
+            "using a range), colors is an optional comma-separated list "
+           "of colors to use; background is allowed for a color with "
+           "format text:background; if colors is present, WeeChat "
+           "options with nick colors and forced nick colors are "
+           "ignored)"),
+        &plugin_api_info_nick_color_name_ignore_case_cb, NULL, NULL);
+    hook_set (ptr_hook, "cache_config", PLUGIN_API_INFO_NICK_COLOR_OPTIONS);
     hook_info (NULL, "uptime",
                N_("WeeChat uptime (format: \"days:hh:mm:ss\")"),
                N_("\"days\" (number of days) or \"seconds\" (number of "
@@ -2419,6 +2471,12 @@ plugin_api_info_init ()
                    N_("plugin pointer (optional)"),
                    N_("plugin name (wildcard \"*\" is allowed) (optional)"),
                    &plugin_api_infolist_plugin_cb, NULL, NULL);
+    hook_infolist (NULL, "profile",
+                   N_("profiler stats: main loop phases, hook types, "
+                      "plugins/scripts and hooks (see /help debug)"),
+                   NULL,
+                   NULL,
+                   &plugin_api_infolist_profile_cb, NULL, NULL);
     hook_infolist (NULL, "proxy",
                    N_("list of proxies"),
                    N_("proxy pointer (optional)"),
@@ -80,6 +80,29 @@ plugin_script_config_init (struct t_weechat_plugin *weechat_plugin,
                "after each eval: this uses less memory, but is slower"),
             NULL, 0, 0, "on", NULL, 0,
             NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+        *(plugin_data->config_look_autoload_deferred) = weechat_config_new_option (
+            *(plugin_data->config_file), ptr_section,
+            "autoload_deferred", "boolean",
+            N_("load scripts of \"autoload\" directory one by one in the "
+               "main loop after startup, instead of loading all of them "
+               "before WeeChat is displayed: this reduces the startup time "
+               "when many scripts are installed, but the commands and "
+               "features of scripts are available only a few milliseconds "
+               "after startup"),
+            NULL, 0, 0, "off", NULL, 0,
+            NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+        if (plugin_data->config_look_bytecode_cache)
+        {
+            *(plugin_data->config_look_bytecode_cache) = weechat_config_new_option (
+                *(plugin_data->config_file), ptr_section,
+                "bytecode_cache", "boolean",
+                N_("save compiled scripts in cache directory and load them "
+                   "from there when the script file has not changed (same "
+                   "path, modification time, size and interpreter version): "
+                   "this reduces the time to load scripts"),
+                NULL, 0, 0, "off", NULL, 0,
+                NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+        }
     }
 
     return 1;
@@ -21,6 +21,7 @@
 
 #include <stdlib.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <unistd.h>
 #include <stdio.h>
 #include <errno.h>
@@ -214,6 +215,8 @@ plugin_script_init (struct t_weechat_plugin *weechat_plugin,
     char *action_signals[] = { "install", "remove", "autoload", NULL };
     int i, auto_load_scripts;
 
+    plugin_data->plugin = weechat_plugin;
+
     /* initialize script configuration file (file: "<language>.conf") */
     plugin_script_config_init (weechat_plugin, plugin_data);
 
@@ -334,8 +337,16 @@ plugin_script_init (struct t_weechat_plugin *weechat_plugin,
     /* autoload scripts */
     if (auto_load_scripts)
     {
-        plugin_script_auto_load (weechat_plugin,
-                                 plugin_data->callback_load_file);
+        if (weechat_config_boolean (
+                *(plugin_data->config_look_autoload_deferred)))
+        {
+            plugin_script_auto_load_deferred (weechat_plugin, plugin_data);
+        }
+        else
+        {
+            plugin_script_auto_load (weechat_plugin,
+                                     plugin_data->callback_load_file);
+        }
     }
 }
 
@@ -370,6 +381,9 @@ plugin_script_valid (struct t_plugin_script *scripts,
 /*
  * Converts a pointer to a string for usage in a script.
  *
+ * This function is called for each pointer returned to scripts, so the hex
+ * digits are written directly (without snprintf).
+ *
  * Returns string with format "0x12345678".
  */
 
@@ -378,6 +392,10 @@ plugin_script_ptr2str (void *pointer)
 {
     static char str_pointer[32][32];
     static int index_pointer = 0;
+    static const char hex_digits[] = "0123456789abcdef";
+    char digits[sizeof (uintptr_t) * 2];
+    uintptr_t value;
+    int i, num_digits;
 
     index_pointer = (index_pointer + 1) % 32;
     str_pointer[index_pointer][0] = '\0';
@@ -385,8 +403,21 @@ plugin_script_ptr2str (void *pointer)
     if (!pointer)
         return str_pointer[index_pointer];
 
-    snprintf (str_pointer[index_pointer], sizeof (str_pointer[index_pointer]),
-              "0x%lx", (unsigned long)pointer);
+    value = (uintptr_t)pointer;
+    num_digits = 0;
+    while (value)
+    {
+        digits[num_digits++] = hex_digits[value & 0xF];
+        value >>= 4;
+    }
+
+    str_pointer[index_pointer][0] = '0';
+    str_pointer[index_pointer][1] = 'x';
+    for (i = 0; i < num_digits; i++)
+    {
+        str_pointer[index_pointer][2 + i] = digits[num_digits - 1 - i];
+    }
+    str_pointer[index_pointer][2 + num_digits] = '\0';
 
     return str_pointer[index_pointer];
 }
@@ -395,6 +426,10 @@ plugin_script_ptr2str (void *pointer)
  * Converts a string to pointer for usage outside a script.
  *
  * Format of "str_pointer" is "0x12345678".
+ *
+ * This function is called for each pointer received from scripts, so the
+ * hex digits are parsed directly (without sscanf); chars after the hex
+ * digits are ignored.
  */
 
 void *
@@ -402,8 +437,9 @@ plugin_script_str2ptr (struct t_weechat_plugin *weechat_plugin,
                        const char *script_name, const char *function_name,
                        const char *str_pointer)
 {
-    void *pointer;
-    int rc;
+    uintptr_t value;
+    const char *ptr_digit;
+    int num_digits, digit;
     struct t_gui_buffer *ptr_buffer;
 
     if (!str_pointer || !str_pointer[0])
@@ -412,9 +448,30 @@ plugin_script_str2ptr (struct t_weechat_plugin *weechat_plugin,
     if ((str_pointer[0] != '0') || (str_pointer[1] != 'x'))
         goto invalid;
 
-    rc = sscanf (str_pointer, "%p", &pointer);
-    if ((rc != EOF) && (rc >= 1))
-        return pointer;
+    value = 0;
+    num_digits = 0;
+    for (ptr_digit = str_pointer + 2; ptr_digit[0]; ptr_digit++)
+    {
+        if ((ptr_digit[0] >= '0') && (ptr_digit[0] <= '9'))
+            digit = ptr_digit[0] - '0';
+        else if ((ptr_digit[0] >= 'a') && (ptr_digit[0] <= 'f'))
+            digit = ptr_digit[0] - 'a' + 10;
+        else if ((ptr_digit[0] >= 'A') && (ptr_digit[0] <= 'F'))
+            digit = ptr_digit[0] - 'A' + 10;
+        else
+            break;
+        /* skip leading zeros, then check that the value fits in a pointer */
+        if ((num_digits > 0) || (digit > 0))
+        {
+            if (num_digits >= (int)(sizeof (value) * 2))
+                goto invalid;
+            num_digits++;
+        }
+        value = (value << 4) | digit;
+    }
+
+    if (ptr_digit > str_pointer + 2)
+        return (void *)value;
 
 invalid:
     if ((weechat_plugin->debug >= 1) && script_name && function_name)
@@ -496,13 +553,84 @@ plugin_script_get_function_and_data (void *callback_data,
 }
 
 /*
- * Auto-loads all scripts in a directory.
+ * Gets object of a function in the cache of functions of a script (object
+ * stored by the scripting language, for example the callable or the
+ * name of function as an object of the language).
+ *
+ * Returns pointer to object, NULL if function is not in cache.
+ */
+
+void *
+plugin_script_function_cache_get (struct t_weechat_plugin *weechat_plugin,
+                                  struct t_plugin_script *script,
+                                  const char *function)
+{
+    if (!script || !script->functions_cache || !function)
+        return NULL;
+
+    return weechat_hashtable_get (script->functions_cache, function);
+}
+
+/*
+ * Adds object of a function in the cache of functions of a script.
+ *
+ * The callback "callback_free" is called to free the object when the cache
+ * is freed (when the script is unloaded).
  */
 
 void
-plugin_script_auto_load (struct t_weechat_plugin *weechat_plugin,
-                         void (*callback)(void *data,
-                                          const char *filename))
+plugin_script_function_cache_set (struct t_weechat_plugin *weechat_plugin,
+                                  struct t_plugin_script *script,
+                                  const char *function,
+                                  void *object,
+                                  void (*callback_free)(struct t_hashtable *hashtable,
+                                                        const void *key,
+                                                        void *value))
+{
+    if (!script || !function || !object)
+        return;
+
+    if (!script->functions_cache)
+    {
+        script->functions_cache = weechat_hashtable_new (
+            32,
+            WEECHAT_HASHTABLE_STRING,
+            WEECHAT_HASHTABLE_POINTER,
+            NULL, NULL);
+        if (!script->functions_cache)
+            return;
+        weechat_hashtable_set_pointer (script->functions_cache,
+                                       "callback_free_value",
+                                       callback_free);
+    }
+
+    weechat_hashtable_set (script->functions_cache, function, object);
+}
+
+/*
+ * Frees the cache of functions of a script.
+ */
+
+void
+plugin_script_function_cache_free (struct t_weechat_plugin *weechat_plugin,
+                                   struct t_plugin_script *script)
+{
+    if (!script || !script->functions_cache)
+        return;
+
+    weechat_hashtable_free (script->functions_cache);
+    script->functions_cache = NULL;
+}
+
+/*
+ * Returns the directory with scripts to auto-load:
+ * "${weechat_data_dir}/<language>/autoload".
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+plugin_script_auto_load_dir (struct t_weechat_plugin *weechat_plugin)
 {
     char *weechat_data_dir, *dir_name;
     int dir_length;
@@ -510,20 +638,151 @@ plugin_script_auto_load (struct t_weechat_plugin *weechat_plugin,
     /* build directory, adding WeeChat data directory */
     weechat_data_dir = weechat_info_get ("weechat_data_dir", "");
     if (!weechat_data_dir)
-        return;
+        return NULL;
     dir_length = strlen (weechat_data_dir) + strlen (weechat_plugin->name) + 16;
     dir_name = malloc (dir_length);
-    if (!dir_name)
+    if (dir_name)
     {
-        free (weechat_data_dir);
-        return;
+        snprintf (dir_name, dir_length,
+                  "%s/%s/autoload", weechat_data_dir, weechat_plugin->name);
     }
 
-    snprintf (dir_name, dir_length,
-              "%s/%s/autoload", weechat_data_dir, weechat_plugin->name);
+    free (weechat_data_dir);
+
+    return dir_name;
+}
+
+/*
+ * Auto-loads all scripts in a directory.
+ */
+
+void
+plugin_script_auto_load (struct t_weechat_plugin *weechat_plugin,
+                         void (*callback)(void *data,
+                                          const char *filename))
+{
+    char *dir_name;
+
+    dir_name = plugin_script_auto_load_dir (weechat_plugin);
+    if (!dir_name)
+        return;
+
     weechat_exec_on_files (dir_name, 0, 0, callback, NULL);
 
-    free (weechat_data_dir);
+    free (dir_name);
+}
+
+/*
+ * Adds a file in list of scripts to auto-load later (callback called for each
+ * file in "autoload" directory).
+ */
+
+void
+plugin_script_auto_load_deferred_add_cb (void *data, const char *filename)
+{
+    struct t_plugin_script_data *plugin_data;
+    struct t_weechat_plugin *weechat_plugin;
+
+    plugin_data = (struct t_plugin_script_data *)data;
+    weechat_plugin = plugin_data->plugin;
+
+    weechat_list_add (plugin_data->autoload_deferred, filename,
+                      WEECHAT_LIST_POS_END, NULL);
+}
+
+/*
+ * Callback for timer used to auto-load scripts after startup: loads one
+ * script on each call, so that WeeChat main loop is not blocked.
+ */
+
+int
+plugin_script_auto_load_deferred_timer_cb (const void *pointer, void *data,
+                                           int remaining_calls)
+{
+    struct t_plugin_script_data *plugin_data;
+    struct t_weechat_plugin *weechat_plugin;
+    struct t_weelist_item *ptr_item;
+    struct t_plugin_script *ptr_script;
+    const char *filename;
+    int quiet;
+
+    /* make C compiler happy */
+    (void) data;
+
+    plugin_data = (struct t_plugin_script_data *)pointer;
+    weechat_plugin = plugin_data->plugin;
+
+    ptr_item = weechat_list_get (plugin_data->autoload_deferred, 0);
+    if (ptr_item)
+    {
+        /* skip script if it has been loaded meanwhile (by a command) */
+        filename = weechat_list_string (ptr_item);
+        for (ptr_script = *(plugin_data->scripts); ptr_script;
+             ptr_script = ptr_script->next_script)
+        {
+            if (strcmp (ptr_script->filename, filename) == 0)
+                break;
+        }
+        if (!ptr_script)
+        {
+            quiet = 1;
+            (plugin_data->callback_load_file) (&quiet, filename);
+        }
+        weechat_list_remove (plugin_data->autoload_deferred, ptr_item);
+    }
+
+    if (remaining_calls == 0)
+    {
+        /* last call: the timer is automatically removed */
+        plugin_data->autoload_deferred_timer = NULL;
+        weechat_list_free (plugin_data->autoload_deferred);
+        plugin_data->autoload_deferred = NULL;
+        plugin_script_display_short_list (weechat_plugin,
+                                          *(plugin_data->scripts));
+    }
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Auto-loads all scripts in a directory, later: scripts are loaded one by one
+ * in the main loop (see option <language>.look.autoload_deferred).
+ */
+
+void
+plugin_script_auto_load_deferred (struct t_weechat_plugin *weechat_plugin,
+                                  struct t_plugin_script_data *plugin_data)
+{
+    char *dir_name;
+    int count;
+
+    if (plugin_data->autoload_deferred)
+        return;
+
+    dir_name = plugin_script_auto_load_dir (weechat_plugin);
+    if (!dir_name)
+        return;
+
+    plugin_data->autoload_deferred = weechat_list_new ();
+    if (plugin_data->autoload_deferred)
+    {
+        weechat_exec_on_files (dir_name, 0, 0,
+                               &plugin_script_auto_load_deferred_add_cb,
+                               plugin_data);
+        count = weechat_list_size (plugin_data->autoload_deferred);
+        if (count > 0)
+        {
+            plugin_data->autoload_deferred_timer = weechat_hook_timer (
+                1, 0, count,
+                &plugin_script_auto_load_deferred_timer_cb, plugin_data, NULL);
+        }
+        if (!plugin_data->autoload_deferred_timer)
+        {
+            weechat_list_free (plugin_data->autoload_deferred);
+            plugin_data->autoload_deferred = NULL;
+        }
+    }
+
     free (dir_name);
 }
 
@@ -775,6 +1034,7 @@ plugin_script_alloc (const char *filename, const char *name,
         strdup (shutdown_func) : NULL;
     new_script->charset = (charset) ? strdup (charset) : NULL;
     new_script->unloading = 0;
+    new_script->functions_cache = NULL;
     new_script->prev_script = NULL;
     new_script->next_script = NULL;
 
@@ -1121,6 +1381,8 @@ plugin_script_remove (struct t_weechat_plugin *weechat_plugin,
     if (*last_script == script)
         *last_script = script->prev_script;
 
+    plugin_script_function_cache_free (weechat_plugin, script);
+
     /* free data and script */
     plugin_script_free (script);
 }
@@ -1708,6 +1970,7 @@ plugin_script_hdata_script (struct t_weechat_plugin *weechat_plugin,
         WEECHAT_HDATA_VAR(struct t_plugin_script, shutdown_func, STRING, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_plugin_script, charset, STRING, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_plugin_script, unloading, INTEGER, 0, NULL, NULL);
+        WEECHAT_HDATA_VAR(struct t_plugin_script, functions_cache, HASHTABLE, 0, NULL, NULL);
         WEECHAT_HDATA_VAR(struct t_plugin_script, prev_script, POINTER, 0, NULL, hdata_name);
         WEECHAT_HDATA_VAR(struct t_plugin_script, next_script, POINTER, 0, NULL, hdata_name);
         weechat_hdata_new_list (hdata, "scripts", scripts,
@@ -1829,6 +2092,18 @@ plugin_script_end (struct t_weechat_plugin *weechat_plugin,
 {
     int scripts_loaded;
 
+    /* cancel auto-load of scripts not yet loaded */
+    if (plugin_data->autoload_deferred_timer)
+    {
+        weechat_unhook (plugin_data->autoload_deferred_timer);
+        plugin_data->autoload_deferred_timer = NULL;
+    }
+    if (plugin_data->autoload_deferred)
+    {
+        weechat_list_free (plugin_data->autoload_deferred);
+        plugin_data->autoload_deferred = NULL;
+    }
+
     /* unload all scripts */
     scripts_loaded = (*(plugin_data->scripts)) ? 1 : 0;
     (void)(plugin_data->unload_all) ();
@@ -1873,6 +2148,7 @@ plugin_script_print_log (struct t_weechat_plugin *weechat_plugin,
         weechat_log_printf ("  shutdown_func . . . : '%s'", ptr_script->shutdown_func);
         weechat_log_printf ("  charset . . . . . . : '%s'", ptr_script->charset);
         weechat_log_printf ("  unloading . . . . . : %d", ptr_script->unloading);
+        weechat_log_printf ("  functions_cache . . : %p", ptr_script->functions_cache);
         weechat_log_printf ("  prev_script . . . . : %p", ptr_script->prev_script);
         weechat_log_printf ("  next_script . . . . : %p", ptr_script->next_script);
     }
@@ -78,6 +78,8 @@ struct t_plugin_script
     char *shutdown_func;                 /* function when script is unloaded*/
     char *charset;                       /* script charset                  */
     int unloading;                       /* script is being unloaded        */
+    struct t_hashtable *functions_cache; /* objects of functions called     */
+                                         /* (name -> object of language)    */
     struct t_plugin_script *prev_script; /* link to previous script         */
     struct t_plugin_script *next_script; /* link to next script             */
 };
@@ -88,8 +90,13 @@ struct t_plugin_script_data
     struct t_config_file **config_file;
     struct t_config_option **config_look_check_license;
     struct t_config_option **config_look_eval_keep_context;
+    struct t_config_option **config_look_autoload_deferred;
+    struct t_config_option **config_look_bytecode_cache;
     struct t_plugin_script **scripts;
     struct t_plugin_script **last_script;
+    struct t_weechat_plugin *plugin;             /* set by plugin_script_init */
+    struct t_weelist *autoload_deferred;         /* scripts to auto-load    */
+    struct t_hook *autoload_deferred_timer;      /* timer to auto-load them */
 
     /* callbacks */
     int (*callback_command) (const void *pointer, void *data,
@@ -144,9 +151,23 @@ extern char *plugin_script_build_function_and_data (const char *function,
 extern void plugin_script_get_function_and_data (void *callback_data,
                                                  const char **function,
                                                  const char **data);
+extern void *plugin_script_function_cache_get (struct t_weechat_plugin *weechat_plugin,
+                                               struct t_plugin_script *script,
+                                               const char *function);
+extern void plugin_script_function_cache_set (struct t_weechat_plugin *weechat_plugin,
+                                              struct t_plugin_script *script,
+                                              const char *function,
+                                              void *object,
+                                              void (*callback_free)(struct t_hashtable *hashtable,
+                                                                    const void *key,
+                                                                    void *value));
+extern void plugin_script_function_cache_free (struct t_weechat_plugin *weechat_plugin,
+                                               struct t_plugin_script *script);
 extern void plugin_script_auto_load (struct t_weechat_plugin *weechat_plugin,
                                      void (*callback)(void *data,
                                                       const char *filename));
+extern void plugin_script_auto_load_deferred (struct t_weechat_plugin *weechat_plugin,
+                                              struct t_plugin_script_data *plugin_data);
 extern struct t_plugin_script *plugin_script_search (struct t_plugin_script *scripts,
                                                      const char *name);
 extern char *plugin_script_search_path (struct t_weechat_plugin *weechat_plugin,
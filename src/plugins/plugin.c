@@ -32,6 +32,7 @@
 #include <string.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/time.h>
 #include <dirent.h>
 #include <dlfcn.h>
 
@@ -47,7 +48,9 @@
 #include "../core/core-list.h"
 #include "../core/core-log.h"
 #include "../core/core-network.h"
+#include "../core/core-profile.h"
 #include "../core/core-string.h"
+#include "../core/core-thread.h"
 #include "../core/core-upgrade-file.h"
 #include "../core/core-utf8.h"
 #include "../core/core-util.h"
@@ -339,6 +342,7 @@ plugin_call_init (struct t_weechat_plugin *plugin, int argc, char **argv)
     int no_connect, rc, old_auto_connect, no_script, old_auto_load_scripts;
     int plugin_argc;
     char **plugin_argv;
+    struct timeval tv_start;
 
     if (plugin->initialized)
         return 1;
@@ -366,8 +370,12 @@ plugin_call_init (struct t_weechat_plugin *plugin, int argc, char **argv)
                          plugin->name,
                          plugin->priority);
     }
+    gettimeofday (&tv_start, NULL);
+    profile_startup_set_mark ();
     rc = ((t_weechat_init_func *)init_func) (plugin,
                                              plugin_argc, plugin_argv);
+    (void) profile_startup_add (PROFILE_STARTUP_PLUGIN_INIT, plugin->name,
+                                &tv_start);
     if (rc == WEECHAT_RC_OK)
     {
         plugin->initialized = 1;
@@ -407,6 +415,7 @@ plugin_load (const char *filename, int init_plugin, int argc, char **argv)
     int *priority;
     struct t_weechat_plugin *new_plugin;
     struct t_config_option *ptr_option;
+    struct timeval tv_start;
 
     if (!filename)
         return NULL;
@@ -419,6 +428,7 @@ plugin_load (const char *filename, int init_plugin, int argc, char **argv)
     if (plugin_autoload_array && !plugin_check_autoload (filename))
         return NULL;
 
+    gettimeofday (&tv_start, NULL);
     handle = dlopen (filename, RTLD_GLOBAL | RTLD_NOW);
     if (!handle)
     {
@@ -626,6 +636,9 @@ plugin_load (const char *filename, int init_plugin, int argc, char **argv)
         new_plugin->strlen_screen = &gui_chat_strlen_screen;
         new_plugin->string_match = &string_match;
         new_plugin->string_match_list = &string_match_list;
+        new_plugin->string_mask_compile = &string_mask_compile;
+        new_plugin->string_match_compiled = &string_match_compiled;
+        new_plugin->string_mask_free = &string_mask_free;
         new_plugin->string_replace = &string_replace;
         new_plugin->string_expand_home = &string_expand_home;
         new_plugin->string_eval_path_home = &string_eval_path_home;
@@ -635,6 +648,8 @@ plugin_load (const char *filename, int init_plugin, int argc, char **argv)
         new_plugin->string_mask_to_regex = &string_mask_to_regex;
         new_plugin->string_regex_flags = &string_regex_flags;
         new_plugin->string_regcomp = &string_regcomp;
+        new_plugin->string_regexec = &string_regexec;
+        new_plugin->string_regfree = &string_regfree;
         new_plugin->string_has_highlight = &string_has_highlight;
         new_plugin->string_has_highlight_regex = &string_has_highlight_regex;
         new_plugin->string_replace_regex = &string_replace_regex;
@@ -660,6 +675,8 @@ plugin_load (const char *filename, int init_plugin, int argc, char **argv)
         new_plugin->string_dyn_concat = &string_dyn_concat;
         new_plugin->string_dyn_free = &string_dyn_free;
         new_plugin->string_concat = &string_concat;
+        new_plugin->string_shared_get = &string_shared_get;
+        new_plugin->string_shared_free = &string_shared_free;
 
         new_plugin->utf8_has_8bits = &utf8_has_8bits;
         new_plugin->utf8_is_valid = &utf8_is_valid;
@@ -699,6 +716,9 @@ plugin_load (const char *filename, int init_plugin, int argc, char **argv)
         new_plugin->util_parse_time = &util_parse_time;
         new_plugin->util_version_number = &util_version_number;
 
+        new_plugin->thread_is_main = &thread_is_main;
+        new_plugin->thread_post = &thread_post;
+
         new_plugin->list_new = &weelist_new;
         new_plugin->list_add = &weelist_add;
         new_plugin->list_search = &weelist_search;
@@ -799,6 +819,8 @@ plugin_load (const char *filename, int init_plugin, int argc, char **argv)
         new_plugin->color = &plugin_api_color;
         new_plugin->printf_datetime_tags = &gui_chat_printf_datetime_tags;
         new_plugin->printf_y_datetime_tags = &gui_chat_printf_y_datetime_tags;
+        new_plugin->printf_lines_begin = &gui_chat_printf_lines_begin;
+        new_plugin->printf_lines_end = &gui_chat_printf_lines_end;
         new_plugin->log_printf = &log_printf;
 
         new_plugin->hook_command = &hook_command;
@@ -821,6 +843,7 @@ plugin_load (const char *filename, int init_plugin, int argc, char **argv)
         new_plugin->hook_completion_list_add = &gui_completion_list_add;
         new_plugin->hook_modifier = &hook_modifier;
         new_plugin->hook_modifier_exec = &hook_modifier_exec;
+        new_plugin->hook_modifier_hooked = &hook_modifier_hooked;
         new_plugin->hook_info = &hook_info;
         new_plugin->hook_info_hashtable = &hook_info_hashtable;
         new_plugin->hook_infolist = &hook_infolist;
@@ -842,6 +865,7 @@ plugin_load (const char *filename, int init_plugin, int argc, char **argv)
         new_plugin->buffer_get_string = &gui_buffer_get_string;
         new_plugin->buffer_get_pointer = &gui_buffer_get_pointer;
         new_plugin->buffer_set = &gui_buffer_set;
+        new_plugin->buffer_set_multiple = &gui_buffer_set_multiple;
         new_plugin->buffer_set_pointer = &gui_buffer_set_pointer;
         new_plugin->buffer_string_replace_local_var = &gui_buffer_string_replace_local_var;
         new_plugin->buffer_match_list = &gui_buffer_match_list;
@@ -928,6 +952,10 @@ plugin_load (const char *filename, int init_plugin, int argc, char **argv)
         new_plugin->hdata_get_var_hdata = &hdata_get_var_hdata;
         new_plugin->hdata_get_var = &hdata_get_var;
         new_plugin->hdata_get_var_at_offset = &hdata_get_var_at_offset;
+        new_plugin->hdata_path_new = &hdata_path_new;
+        new_plugin->hdata_path_get_var = &hdata_path_get_var;
+        new_plugin->hdata_path_free = &hdata_path_free;
+        new_plugin->hdata_get_fields = &hdata_get_fields;
         new_plugin->hdata_get_list = &hdata_get_list;
         new_plugin->hdata_check_pointer = &hdata_check_pointer;
         new_plugin->hdata_move = &hdata_move;
@@ -965,6 +993,9 @@ plugin_load (const char *filename, int init_plugin, int argc, char **argv)
          */
         gui_buffer_set_plugin_for_upgrade (name, new_plugin);
 
+        (void) profile_startup_add (PROFILE_STARTUP_PLUGIN_LOAD, name,
+                                    &tv_start);
+
         if (init_plugin)
         {
             if (!plugin_call_init (new_plugin, argc, argv))
@@ -1209,6 +1240,9 @@ plugin_remove (struct t_weechat_plugin *plugin)
     /* remove all configuration files */
     config_file_free_all_plugin (plugin);
 
+    /* remove all posts from threads */
+    thread_post_remove_plugin (plugin);
+
     /* remove all hooks */
     unhook_all_plugin (plugin, NULL);
 
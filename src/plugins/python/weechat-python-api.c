@@ -5438,6 +5438,32 @@ API_FUNC(hdata_hashtable)
     return result_dict;
 }
 
+API_FUNC(hdata_get_fields)
+{
+    char *hdata, *pointer, *fields;
+    struct t_hashtable *result_hashtable;
+    PyObject *result_dict;
+    int count;
+
+    API_INIT_FUNC(1, "hdata_get_fields", API_RETURN_EMPTY);
+    hdata = NULL;
+    pointer = NULL;
+    count = 0;
+    fields = NULL;
+    if (!PyArg_ParseTuple (args, "ssis", &hdata, &pointer, &count, &fields))
+        API_WRONG_ARGS(API_RETURN_EMPTY);
+
+    result_hashtable = weechat_hdata_get_fields (API_STR2PTR(hdata),
+                                                 API_STR2PTR(pointer),
+                                                 count,
+                                                 fields);
+    result_dict = weechat_python_hashtable_to_dict (result_hashtable);
+
+    weechat_hashtable_free (result_hashtable);
+
+    return result_dict;
+}
+
 API_FUNC(hdata_compare)
 {
     char *hdata, *pointer1, *pointer2, *name;
@@ -5837,6 +5863,7 @@ PyMethodDef weechat_python_funcs[] =
     API_DEF_FUNC(hdata_pointer),
     API_DEF_FUNC(hdata_time),
     API_DEF_FUNC(hdata_hashtable),
+    API_DEF_FUNC(hdata_get_fields),
     API_DEF_FUNC(hdata_compare),
     API_DEF_FUNC(hdata_update),
     API_DEF_FUNC(hdata_get_string),
@@ -49,6 +49,7 @@ struct t_plugin_script_data python_data;
 struct t_config_file *python_config_file = NULL;
 struct t_config_option *python_config_look_check_license = NULL;
 struct t_config_option *python_config_look_eval_keep_context = NULL;
+struct t_config_option *python_config_look_autoload_deferred = NULL;
 
 int python_quiet = 0;
 
@@ -386,8 +387,113 @@ weechat_python_output (PyObject *self, PyObject *args)
     return Py_None;
 }
 
+/*
+ * Frees a python object in the cache of functions of a script.
+ */
+
+void
+weechat_python_function_cache_free_cb (struct t_hashtable *hashtable,
+                                       const void *key, void *value)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    Py_XDECREF((PyObject *)value);
+}
+
+/*
+ * Checks if a string argument can be kept in the cache of strings of a
+ * script: only short strings without spaces (like pointers, signal names,
+ * tags or data of callbacks), which are often the same, are cached.
+ *
+ * Returns:
+ *   1: string can be cached
+ *   0: string must not be cached
+ */
+
+int
+weechat_python_string_is_cacheable (const char *string)
+{
+    int i;
+
+    for (i = 0; string[i]; i++)
+    {
+        if ((i >= PYTHON_STRING_CACHE_MAX_LENGTH) || (string[i] == ' '))
+            return 0;
+    }
+
+    return 1;
+}
+
+/*
+ * Converts a C string (argument of a callback) to a python object: a str if
+ * the string is valid UTF-8, otherwise bytes (None if string is NULL).
+ *
+ * Short strings are converted once to interned python strings, kept in the
+ * cache of functions of the script (a function name is a python string
+ * too, so both share the same cache).
+ *
+ * Returns a new reference.
+ */
+
+PyObject *
+weechat_python_string_to_object (struct t_plugin_script *script,
+                                 const char *string)
+{
+    PyObject *object;
+    int items_count;
+
+    if (!string)
+    {
+        Py_INCREF(Py_None);
+        return Py_None;
+    }
+
+    if (!weechat_utf8_is_valid (string, -1, NULL))
+        return PyBytes_FromString (string);
+
+    if (!weechat_python_string_is_cacheable (string))
+        return PyUnicode_FromString (string);
+
+    object = plugin_script_function_cache_get (weechat_python_plugin,
+                                               script, string);
+    if (object)
+    {
+        Py_INCREF(object);
+        return object;
+    }
+
+    object = PyUnicode_InternFromString (string);
+    if (!object)
+        return NULL;
+
+    items_count = (script->functions_cache) ?
+        weechat_hashtable_get_integer (script->functions_cache,
+                                       "items_count") : 0;
+    if (items_count < PYTHON_STRING_CACHE_MAX_ITEMS)
+    {
+        /* one reference is kept by the cache */
+        Py_INCREF(object);
+        plugin_script_function_cache_set (
+            weechat_python_plugin, script, string, object,
+            &weechat_python_function_cache_free_cb);
+    }
+
+    return object;
+}
+
 /*
  * Executes a python function.
+ *
+ * The name of function is converted once to an interned python string,
+ * kept in the cache of functions of the script, so that the function is
+ * searched in the dictionary of module "__main__" without allocating a new
+ * string (and still found if the function is defined again by the script).
+ *
+ * Arguments are converted directly to python objects (without format
+ * string) and the function is called with the vectorcall protocol (if
+ * available), so that no tuple is built for arguments.
  */
 
 void *
@@ -397,9 +503,11 @@ weechat_python_exec (struct t_plugin_script *script,
 {
     struct t_plugin_script *old_python_current_script;
     PyThreadState *old_interpreter;
-    PyObject *evMain, *evDict, *evFunc, *rc;
-    void *argv2[16], *ret_value, *ret_temp;
-    char format2[17];
+    PyObject *evMain, *evDict, *evName, *evFunc, *rc, *args[16];
+#if PY_VERSION_HEX < 0x03090000
+    PyObject *tuple;
+#endif
+    void *ret_value, *ret_temp;
     int i, argc, *ret_int;
 
     ret_value = NULL;
@@ -424,7 +532,19 @@ weechat_python_exec (struct t_plugin_script *script,
     if (!evMain)
         goto end;
     evDict = PyModule_GetDict (evMain);
-    evFunc = PyDict_GetItemString (evDict, function);
+    evName = plugin_script_function_cache_get (weechat_python_plugin,
+                                               script, function);
+    if (!evName)
+    {
+        evName = PyUnicode_InternFromString (function);
+        if (evName)
+        {
+            plugin_script_function_cache_set (
+                weechat_python_plugin, script, function, evName,
+                &weechat_python_function_cache_free_cb);
+        }
+    }
+    evFunc = (evName) ? PyDict_GetItem (evDict, evName) : NULL;
 
     if ( !(evFunc && PyCallable_Check (evFunc)) )
     {
@@ -438,56 +558,62 @@ weechat_python_exec (struct t_plugin_script *script,
     if (argv && argv[0])
     {
         argc = strlen (format);
-        for (i = 0; i < 16; i++)
+        if (argc > 16)
+            argc = 16;
+        for (i = 0; i < argc; i++)
         {
-            if (i < argc)
+            switch (format[i])
             {
-                switch (format[i])
-                {
-                    case 's': /* string or null */
-                        argv2[i] = argv[i];
-                        if (weechat_utf8_is_valid (argv2[i], -1, NULL))
-                            format2[i] = 's';  /* str */
-                        else
-                            format2[i] = 'y';  /* bytes */
-                        break;
-                    case 'i': /* integer */
-                        argv2[i] = PyLong_FromLong ((long)(*((int *)argv[i])));
-                        format2[i] = 'O';
-                        break;
-                    case 'h': /* hash */
-                        argv2[i] = weechat_python_hashtable_to_dict (
-                            (struct t_hashtable *)argv[i]);
-                        format2[i] = 'O';
-                        break;
-                    case 'O': /* object */
-                        argv2[i] = argv[i];
-                        format2[i] = 'O';
-                        break;
-                }
+                case 's': /* string or null */
+                    args[i] = weechat_python_string_to_object (
+                        script, (const char *)argv[i]);
+                    break;
+                case 'i': /* integer */
+                    args[i] = PyLong_FromLong ((long)(*((int *)argv[i])));
+                    break;
+                case 'h': /* hash */
+                    args[i] = weechat_python_hashtable_to_dict (
+                        (struct t_hashtable *)argv[i]);
+                    break;
+                case 'O': /* object */
+                    args[i] = (PyObject *)argv[i];
+                    Py_XINCREF(args[i]);
+                    break;
+                default:
+                    args[i] = NULL;
+                    break;
             }
-            else
+            if (!args[i])
             {
-                argv2[i] = NULL;
-                format2[i] = '\0';
+                Py_INCREF(Py_None);
+                args[i] = Py_None;
             }
         }
-        format2[argc] = '\0';
-
-        rc = PyObject_CallFunction (evFunc, format2,
-                                    argv2[0], argv2[1],
-                                    argv2[2], argv2[3],
-                                    argv2[4], argv2[5],
-                                    argv2[6], argv2[7],
-                                    argv2[8], argv2[9],
-                                    argv2[10], argv2[11],
-                                    argv2[12], argv2[13],
-                                    argv2[14], argv2[15]);
+
+#if PY_VERSION_HEX >= 0x03090000
+        rc = PyObject_Vectorcall (evFunc, args, argc, NULL);
+#else
+        tuple = PyTuple_New (argc);
+        if (tuple)
+        {
+            for (i = 0; i < argc; i++)
+            {
+                /* reference is stolen by the tuple */
+                Py_INCREF(args[i]);
+                PyTuple_SET_ITEM(tuple, i, args[i]);
+            }
+            rc = PyObject_CallObject (evFunc, tuple);
+            Py_DECREF(tuple);
+        }
+        else
+        {
+            rc = NULL;
+        }
+#endif /* PY_VERSION_HEX >= 0x03090000 */
 
         for (i = 0; i < argc; i++)
         {
-            if (argv2[i] && (format2[i] == 'O'))
-                Py_XDECREF((PyObject *)argv2[i]);
+            Py_DECREF(args[i]);
         }
     }
     else
@@ -892,13 +1018,18 @@ void
 weechat_python_load_cb (void *data, const char *filename)
 {
     const char *pos_dot;
-
-    /* make C compiler happy */
-    (void) data;
+    int old_python_quiet;
 
     pos_dot = strrchr (filename, '.');
     if (pos_dot && (strcmp (pos_dot, ".py") == 0))
+    {
+        /* data is an optional pointer to integer: 1 for quiet mode */
+        old_python_quiet = python_quiet;
+        if (data && *((int *)data))
+            python_quiet = 1;
         weechat_python_load (filename, NULL);
+        python_quiet = old_python_quiet;
+    }
 }
 
 /*
@@ -909,7 +1040,7 @@ void
 weechat_python_unload (struct t_plugin_script *script)
 {
     int *rc;
-    void *interpreter;
+    void *interpreter, *old_interpreter;
     char *filename;
 
     if ((weechat_python_plugin->debug >= 2) || !python_quiet)
@@ -935,6 +1066,14 @@ weechat_python_unload (struct t_plugin_script *script)
             python_current_script->prev_script : python_current_script->next_script;
     }
 
+    /* python objects in cache must be freed with the interpreter of script */
+    if (interpreter)
+    {
+        old_interpreter = PyThreadState_Swap (interpreter);
+        plugin_script_function_cache_free (weechat_python_plugin, script);
+        PyThreadState_Swap (old_interpreter);
+    }
+
     plugin_script_remove (weechat_python_plugin, &python_scripts, &last_python_script,
                           script);
 
@@ -1599,6 +1738,7 @@ weechat_plugin_init (struct t_weechat_plugin *plugin, int argc, char *argv[])
     python_data.config_file = &python_config_file;
     python_data.config_look_check_license = &python_config_look_check_license;
     python_data.config_look_eval_keep_context = &python_config_look_eval_keep_context;
+    python_data.config_look_autoload_deferred = &python_config_look_autoload_deferred;
     python_data.scripts = &python_scripts;
     python_data.last_script = &last_python_script;
     python_data.callback_command = &weechat_python_command_cb;
@@ -25,6 +25,10 @@
 #define PYTHON_PLUGIN_NAME "python"
 #define PYTHON_PLUGIN_PRIORITY 4020
 
+/* strings kept in cache of scripts (arguments of callbacks) */
+#define PYTHON_STRING_CACHE_MAX_LENGTH 128
+#define PYTHON_STRING_CACHE_MAX_ITEMS  512
+
 #define PYTHON_CURRENT_SCRIPT_NAME ((python_current_script) ? python_current_script->name : "-")
 
 #define PY_INTEGER_CHECK(x) (PyLong_Check(x))
@@ -2780,6 +2780,21 @@ def hdata_hashtable(hdata: str, pointer: str, name: str) -> Dict[str, str]:
     ...
 
 
+def hdata_get_fields(hdata: str, pointer: str, count: int, fields: str) -> Dict[str, str]:
+    """`hdata_get_fields in WeeChat plugin API reference <https://weechat.org/doc/weechat/api/#_hdata_get_fields>`_
+    ::
+
+        # example
+        hdata = weechat.hdata_get("line")
+        own_lines = weechat.hdata_pointer(weechat.hdata_get("buffer"), weechat.current_buffer(), "own_lines")
+        line = weechat.hdata_pointer(weechat.hdata_get("lines"), own_lines, "first_line")
+        fields = weechat.hdata_get_fields(hdata, line, 0, "data.prefix,data.message")
+        for i in range(int(fields["count"])):
+            weechat.prnt("", "%s: %s" % (fields["%d.data.prefix" % i], fields["%d.data.message" % i]))
+    """
+    ...
+
+
 def hdata_compare(hdata: str, pointer1: str, pointer2: str, name: str, case_sensitive: int) -> int:
     """`hdata_compare in WeeChat plugin API reference <https://weechat.org/doc/weechat/api/#_hdata_compare>`_
     ::
@@ -0,0 +1,312 @@
+/*
+ * relay-api-cbor.c - CBOR encoding of JSON messages for "api" protocol
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * CBOR (Concise Binary Object Representation) is defined in RFC 8949:
+ * https://www.rfc-editor.org/rfc/rfc8949.html
+ *
+ * The JSON objects are converted to CBOR with the same structure (same keys
+ * and values), so the schema of messages is the same with both encodings:
+ *   - object -> map (major type 5), keys are text strings
+ *   - array -> array (major type 4)
+ *   - string -> text string (major type 3)
+ *   - number -> unsigned/negative integer (major types 0/1) if the number is
+ *     an integer, otherwise double-precision float (major type 7)
+ *   - true/false/null -> simple values (major type 7)
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <cjson/cJSON.h>
+
+#include "../../weechat-plugin.h"
+#include "../relay.h"
+#include "relay-api.h"
+#include "relay-api-cbor.h"
+
+
+/*
+ * Adds bytes in a CBOR buffer.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (memory allocation)
+ */
+
+int
+relay_api_cbor_add_bytes (struct t_relay_api_cbor *cbor,
+                          const void *data, int size)
+{
+    unsigned char *new_data;
+    int new_size_alloc;
+
+    if (!cbor || !data || (size < 0))
+        return 0;
+
+    if (cbor->size + size > cbor->size_alloc)
+    {
+        new_size_alloc = (cbor->size_alloc < 64) ? 64 : cbor->size_alloc * 2;
+        if (new_size_alloc < cbor->size + size)
+            new_size_alloc = cbor->size + size;
+        new_data = realloc (cbor->data, new_size_alloc);
+        if (!new_data)
+            return 0;
+        cbor->data = new_data;
+        cbor->size_alloc = new_size_alloc;
+    }
+
+    memcpy (cbor->data + cbor->size, data, size);
+    cbor->size += size;
+
+    return 1;
+}
+
+/*
+ * Adds a CBOR head (major type and argument) in a CBOR buffer, using the
+ * shortest form for the argument.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (memory allocation)
+ */
+
+int
+relay_api_cbor_add_head (struct t_relay_api_cbor *cbor,
+                         int major_type, uint64_t argument)
+{
+    unsigned char head[9];
+    int i, size;
+
+    if (argument < 24)
+    {
+        head[0] = (major_type << 5) | (unsigned char)argument;
+        size = 1;
+    }
+    else if (argument <= 0xFF)
+    {
+        head[0] = (major_type << 5) | 24;
+        size = 2;
+    }
+    else if (argument <= 0xFFFF)
+    {
+        head[0] = (major_type << 5) | 25;
+        size = 3;
+    }
+    else if (argument <= 0xFFFFFFFF)
+    {
+        head[0] = (major_type << 5) | 26;
+        size = 5;
+    }
+    else
+    {
+        head[0] = (major_type << 5) | 27;
+        size = 9;
+    }
+
+    /* argument in network byte order (big-endian) */
+    for (i = size - 1; i > 0; i--)
+    {
+        head[i] = argument & 0xFF;
+        argument >>= 8;
+    }
+
+    return relay_api_cbor_add_bytes (cbor, head, size);
+}
+
+/*
+ * Adds a number in a CBOR buffer: integer if the number has no fractional
+ * part (and fits in a signed 64-bit integer), otherwise a double-precision
+ * float.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (memory allocation)
+ */
+
+int
+relay_api_cbor_add_number (struct t_relay_api_cbor *cbor, double number)
+{
+    unsigned char data[9];
+    uint64_t bits;
+    int i;
+
+    if ((number >= -9223372036854775808.0)
+        && (number < 9223372036854775808.0)
+        && (number == (double)((int64_t)number)))
+    {
+        if (number >= 0)
+        {
+            return relay_api_cbor_add_head (cbor, RELAY_API_CBOR_MAJOR_UINT,
+                                            (uint64_t)number);
+        }
+        return relay_api_cbor_add_head (cbor, RELAY_API_CBOR_MAJOR_NEGINT,
+                                        (uint64_t)(-1 - (int64_t)number));
+    }
+
+    /* NaN and infinity are not in JSON, but encode them anyway as float */
+    memcpy (&bits, &number, sizeof (bits));
+    data[0] = (RELAY_API_CBOR_MAJOR_SIMPLE << 5) | RELAY_API_CBOR_SIMPLE_FLOAT64;
+    for (i = 8; i > 0; i--)
+    {
+        data[i] = bits & 0xFF;
+        bits >>= 8;
+    }
+
+    return relay_api_cbor_add_bytes (cbor, data, sizeof (data));
+}
+
+/*
+ * Adds a text string in a CBOR buffer.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (memory allocation)
+ */
+
+int
+relay_api_cbor_add_string (struct t_relay_api_cbor *cbor, const char *string)
+{
+    int length;
+
+    if (!string)
+        string = "";
+
+    length = strlen (string);
+
+    if (!relay_api_cbor_add_head (cbor, RELAY_API_CBOR_MAJOR_TEXT, length))
+        return 0;
+
+    return (length > 0) ? relay_api_cbor_add_bytes (cbor, string, length) : 1;
+}
+
+/*
+ * Adds a JSON item (and its children) in a CBOR buffer.
+ *
+ * Raw JSON items (JSON written directly as string) are parsed then added.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+relay_api_cbor_add_json (struct t_relay_api_cbor *cbor, const cJSON *json)
+{
+    cJSON *json_parsed, *ptr_item;
+    unsigned char simple;
+    int rc, count;
+
+    if (!cbor)
+        return 0;
+
+    if (!json || cJSON_IsNull (json))
+    {
+        simple = (RELAY_API_CBOR_MAJOR_SIMPLE << 5) | RELAY_API_CBOR_SIMPLE_NULL;
+        return relay_api_cbor_add_bytes (cbor, &simple, 1);
+    }
+
+    if (cJSON_IsBool (json))
+    {
+        simple = (RELAY_API_CBOR_MAJOR_SIMPLE << 5)
+            | ((cJSON_IsTrue (json)) ?
+               RELAY_API_CBOR_SIMPLE_TRUE : RELAY_API_CBOR_SIMPLE_FALSE);
+        return relay_api_cbor_add_bytes (cbor, &simple, 1);
+    }
+
+    if (cJSON_IsNumber (json))
+        return relay_api_cbor_add_number (cbor, cJSON_GetNumberValue (json));
+
+    if (cJSON_IsString (json))
+        return relay_api_cbor_add_string (cbor, cJSON_GetStringValue (json));
+
+    if (cJSON_IsRaw (json))
+    {
+        json_parsed = cJSON_Parse (json->valuestring);
+        if (!json_parsed)
+            return 0;
+        rc = relay_api_cbor_add_json (cbor, json_parsed);
+        cJSON_Delete (json_parsed);
+        return rc;
+    }
+
+    if (cJSON_IsArray (json) || cJSON_IsObject (json))
+    {
+        count = cJSON_GetArraySize (json);
+        if (!relay_api_cbor_add_head (
+                cbor,
+                (cJSON_IsArray (json)) ?
+                RELAY_API_CBOR_MAJOR_ARRAY : RELAY_API_CBOR_MAJOR_MAP,
+                count))
+        {
+            return 0;
+        }
+        cJSON_ArrayForEach (ptr_item, json)
+        {
+            if (cJSON_IsObject (json)
+                && !relay_api_cbor_add_string (cbor, ptr_item->string))
+            {
+                return 0;
+            }
+            if (!relay_api_cbor_add_json (cbor, ptr_item))
+                return 0;
+        }
+        return 1;
+    }
+
+    /* unknown type: encode as null */
+    simple = (RELAY_API_CBOR_MAJOR_SIMPLE << 5) | RELAY_API_CBOR_SIMPLE_NULL;
+    return relay_api_cbor_add_bytes (cbor, &simple, 1);
+}
+
+/*
+ * Encodes a JSON object in CBOR.
+ *
+ * Returns pointer to CBOR data (size is set in *size), NULL if error.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+relay_api_cbor_encode (const cJSON *json, int *size)
+{
+    struct t_relay_api_cbor cbor;
+
+    if (!size)
+        return NULL;
+
+    *size = 0;
+
+    cbor.data = NULL;
+    cbor.size = 0;
+    cbor.size_alloc = 0;
+
+    if (!relay_api_cbor_add_json (&cbor, json))
+    {
+        free (cbor.data);
+        return NULL;
+    }
+
+    *size = cbor.size;
+
+    return (char *)cbor.data;
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WEECHAT_PLUGIN_RELAY_API_CBOR_H
+#define WEECHAT_PLUGIN_RELAY_API_CBOR_H
+
+#include <stdint.h>
+
+/* CBOR major types (RFC 8949) */
+#define RELAY_API_CBOR_MAJOR_UINT      0
+#define RELAY_API_CBOR_MAJOR_NEGINT    1
+#define RELAY_API_CBOR_MAJOR_BYTES     2
+#define RELAY_API_CBOR_MAJOR_TEXT      3
+#define RELAY_API_CBOR_MAJOR_ARRAY     4
+#define RELAY_API_CBOR_MAJOR_MAP       5
+#define RELAY_API_CBOR_MAJOR_TAG       6
+#define RELAY_API_CBOR_MAJOR_SIMPLE    7
+
+/* CBOR simple values and floats (major type 7) */
+#define RELAY_API_CBOR_SIMPLE_FALSE    20
+#define RELAY_API_CBOR_SIMPLE_TRUE     21
+#define RELAY_API_CBOR_SIMPLE_NULL     22
+#define RELAY_API_CBOR_SIMPLE_FLOAT64  27
+
+struct t_relay_api_cbor
+{
+    unsigned char *data;               /* CBOR data                         */
+    int size;                          /* size of data                      */
+    int size_alloc;                    /* allocated size for data           */
+};
+
+extern int relay_api_cbor_add_bytes (struct t_relay_api_cbor *cbor,
+                                     const void *data, int size);
+extern int relay_api_cbor_add_head (struct t_relay_api_cbor *cbor,
+                                    int major_type, uint64_t argument);
+extern int relay_api_cbor_add_number (struct t_relay_api_cbor *cbor,
+                                      double number);
+extern int relay_api_cbor_add_string (struct t_relay_api_cbor *cbor,
+                                      const char *string);
+extern int relay_api_cbor_add_json (struct t_relay_api_cbor *cbor,
+                                    const cJSON *json);
+extern char *relay_api_cbor_encode (const cJSON *json, int *size);
+
+#endif /* WEECHAT_PLUGIN_RELAY_API_CBOR_H */
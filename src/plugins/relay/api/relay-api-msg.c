@@ -35,6 +35,7 @@
 #include "../relay-http.h"
 #include "../relay-websocket.h"
 #include "relay-api.h"
+#include "relay-api-cbor.h"
 #include "relay-api-msg.h"
 #include "relay-api-protocol.h"
 
@@ -75,7 +76,7 @@
     ptr_string = weechat_hdata_string (hdata, pointer, __var_name);     \
     MSG_ADD_STR_PTR(__json_name, ptr_string);
 
-#define MSG_CONVERT_COLORS(__json_name, __string)                       \
+#define MSG_CONVERT_COLORS_ADD(__add_str, __json_name, __string)        \
     switch (colors)                                                     \
     {                                                                   \
         case RELAY_API_COLORS_ANSI:                                     \
@@ -84,25 +85,28 @@
                 (__string) ? __string : "");                            \
             if (string)                                                 \
             {                                                           \
-                MSG_ADD_STR_PTR(__json_name, string);                   \
+                __add_str(__json_name, string);                         \
                 free (string);                                          \
             }                                                           \
             break;                                                      \
         case RELAY_API_COLORS_WEECHAT:                                  \
-            MSG_ADD_STR_PTR(__json_name, __string);                     \
+            __add_str(__json_name, __string);                           \
             break;                                                      \
         case RELAY_API_COLORS_STRIP:                                    \
             string = weechat_string_remove_color (                      \
                 (__string) ? __string : "", NULL);                      \
             if (string)                                                 \
             {                                                           \
-                MSG_ADD_STR_PTR(__json_name, string);                   \
+                __add_str(__json_name, string);                         \
                 free (string);                                          \
             }                                                           \
         case RELAY_API_NUM_COLORS:                                      \
             break;                                                      \
     }
 
+#define MSG_CONVERT_COLORS(__json_name, __string)                       \
+    MSG_CONVERT_COLORS_ADD(MSG_ADD_STR_PTR, __json_name, __string);
+
 #define MSG_ADD_HDATA_STR_COLORS(__json_name, __var_name)               \
     ptr_string = weechat_hdata_string (hdata, pointer, __var_name);     \
     MSG_CONVERT_COLORS(__json_name, ptr_string);
@@ -113,10 +117,279 @@
         weechat_color (ptr_string) : NULL;                              \
     MSG_CONVERT_COLORS(__json_name, ptr_color);
 
+/*
+ * macros to write JSON directly in a dynamic string (variable "json" is a
+ * "char **"), without building cJSON objects; all keys except the first
+ * one are written with a leading comma
+ */
+
+#define MSG_WRITE_KEY(__json_name)                                      \
+    weechat_string_dyn_concat (json, ",\"" __json_name "\":", -1);
+
+#define MSG_WRITE_STR_PTR(__json_name, __string)                        \
+    MSG_WRITE_KEY(__json_name);                                         \
+    relay_api_msg_json_write_string (json, __string);
+
+#define MSG_WRITE_HDATA_NUMBER(__json_name, __var_type, __var_name)     \
+    snprintf (str_number, sizeof (str_number), "%lld",                  \
+              (long long)weechat_hdata_##__var_type (hdata, pointer,    \
+                                                     __var_name));      \
+    MSG_WRITE_KEY(__json_name);                                         \
+    weechat_string_dyn_concat (json, str_number, -1);
+
+#define MSG_WRITE_HDATA_BOOL(__json_name, __var_type, __var_name)       \
+    MSG_WRITE_KEY(__json_name);                                         \
+    weechat_string_dyn_concat (                                         \
+        json,                                                           \
+        (weechat_hdata_##__var_type (hdata, pointer, __var_name)) ?     \
+        "true" : "false",                                               \
+        -1);
+
+#define MSG_WRITE_HDATA_TIME_USEC(__json_name,                          \
+                                  __var_name, __var_name_usec)          \
+    time_value = weechat_hdata_time (hdata, pointer, __var_name);       \
+    gmtime_r (&time_value, &gm_time);                                   \
+    tv.tv_sec = mktime (&gm_time);                                      \
+    tv.tv_usec = weechat_hdata_integer (hdata, pointer,                 \
+                                        __var_name_usec);               \
+    weechat_util_strftimeval (str_time, sizeof (str_time),              \
+                              "%FT%T.%fZ", &tv);                        \
+    MSG_WRITE_STR_PTR(__json_name, str_time);
+
+#define MSG_WRITE_HDATA_STR(__json_name, __var_name)                    \
+    ptr_string = weechat_hdata_string (hdata, pointer, __var_name);     \
+    MSG_WRITE_STR_PTR(__json_name, ptr_string);
+
+#define MSG_WRITE_HDATA_STR_COLORS(__json_name, __var_name)             \
+    ptr_string = weechat_hdata_string (hdata, pointer, __var_name);     \
+    MSG_CONVERT_COLORS_ADD(MSG_WRITE_STR_PTR, __json_name, ptr_string);
+
+#define MSG_WRITE_HDATA_COLOR(__json_name, __var_name)                  \
+    ptr_string = weechat_hdata_string (hdata, pointer, __var_name);     \
+    ptr_color = (ptr_string && ptr_string[0]) ?                         \
+        weechat_color (ptr_string) : NULL;                              \
+    MSG_CONVERT_COLORS_ADD(MSG_WRITE_STR_PTR, __json_name, ptr_color);
+
+
+/*
+ * Writes a string as JSON string (with double quotes) in a dynamic string.
+ *
+ * Chars are escaped like cJSON does: double quote, backslash and control
+ * chars; other chars (including UTF-8 multi-bytes chars) are written as-is.
+ * A NULL string is written as empty string.
+ */
+
+void
+relay_api_msg_json_write_string (char **json, const char *string)
+{
+    const unsigned char *ptr_string, *ptr_start;
+    const char *ptr_escape;
+    char str_escape[16];
+
+    if (!json)
+        return;
+
+    weechat_string_dyn_concat (json, "\"", -1);
+
+    if (string)
+    {
+        ptr_start = (const unsigned char *)string;
+        for (ptr_string = ptr_start; ptr_string[0]; ptr_string++)
+        {
+            switch (ptr_string[0])
+            {
+                case '"':
+                    ptr_escape = "\\\"";
+                    break;
+                case '\\':
+                    ptr_escape = "\\\\";
+                    break;
+                case '\b':
+                    ptr_escape = "\\b";
+                    break;
+                case '\f':
+                    ptr_escape = "\\f";
+                    break;
+                case '\n':
+                    ptr_escape = "\\n";
+                    break;
+                case '\r':
+                    ptr_escape = "\\r";
+                    break;
+                case '\t':
+                    ptr_escape = "\\t";
+                    break;
+                default:
+                    if (ptr_string[0] < 32)
+                    {
+                        snprintf (str_escape, sizeof (str_escape),
+                                  "\\u%04x", ptr_string[0]);
+                        ptr_escape = str_escape;
+                    }
+                    else
+                        ptr_escape = NULL;
+                    break;
+            }
+            if (ptr_escape)
+            {
+                if (ptr_string > ptr_start)
+                {
+                    weechat_string_dyn_concat (json, (const char *)ptr_start,
+                                               ptr_string - ptr_start);
+                }
+                weechat_string_dyn_concat (json, ptr_escape, -1);
+                ptr_start = ptr_string + 1;
+            }
+        }
+        if (ptr_start[0])
+            weechat_string_dyn_concat (json, (const char *)ptr_start, -1);
+    }
+
+    weechat_string_dyn_concat (json, "\"", -1);
+}
+
+/*
+ * Creates a cJSON raw item with JSON written by a "write" function, which is
+ * printed as-is when the message is sent.
+ *
+ * Note: the dynamic string "json" is freed.
+ */
+
+cJSON *
+relay_api_msg_json_raw (char **json)
+{
+    cJSON *json_raw;
+
+    if (!json)
+        return NULL;
+
+    json_raw = cJSON_CreateRaw (*json);
+
+    weechat_string_dyn_free (json, 1);
+
+    return json_raw;
+}
+
+/*
+ * Sends HTTP response to client with a JSON body encoded in CBOR.
+ *
+ * Returns number of bytes sent to client, -1 if error.
+ */
+
+int
+relay_api_msg_send_http_cbor (struct t_relay_client *client,
+                              int return_code,
+                              const char *message,
+                              const char *headers,
+                              cJSON *json_body)
+{
+    char *cbor, *headers2;
+    int num_bytes, size;
+
+    if (!client || !message)
+        return -1;
+
+    size = 0;
+    cbor = (json_body) ? relay_api_cbor_encode (json_body, &size) : NULL;
+
+    if (weechat_asprintf (
+            &headers2,
+            "%s%s%s",
+            (headers) ? headers : "",
+            (headers && headers[0]) ? "\r\n" : "",
+            "Access-Control-Allow-Origin: *\r\n"
+            "Content-Type: " RELAY_API_CBOR_CONTENT_TYPE) < 0)
+    {
+        free (cbor);
+        return -1;
+    }
+
+    num_bytes = relay_http_send (client, return_code, message, headers2,
+                                 cbor, (cbor) ? size : 0);
+
+    free (headers2);
+    free (cbor);
+
+    return num_bytes;
+}
+
+/*
+ * Builds a JSON object with a response or an event, as sent to the client
+ * with an established websocket or in the response of a batch request.
+ *
+ * The key "body" is not added, it must be added by the caller.
+ *
+ * Note: result must be freed after use.
+ */
+
+cJSON *
+relay_api_msg_response_to_json (struct t_relay_client *client,
+                                int return_code,
+                                const char *message,
+                                const char *event_name,
+                                long long event_buffer_id,
+                                const char *body_type)
+{
+    cJSON *json;
+    char *request;
+    int length;
+
+    json = cJSON_CreateObject ();
+    if (!json)
+        return NULL;
+
+    cJSON_AddItemToObject (json, "code", cJSON_CreateNumber (return_code));
+    cJSON_AddItemToObject (json, "message", cJSON_CreateString (message));
+    if (event_name)
+    {
+        cJSON_AddItemToObject (
+            json, "event_name",
+            cJSON_CreateString ((event_name) ? event_name : ""));
+        cJSON_AddItemToObject (
+            json, "buffer_id",
+            cJSON_CreateNumber (event_buffer_id));
+    }
+    else
+    {
+        length = weechat_asprintf (
+            &request,
+            "%s%s%s",
+            (client->http_req->method) ? client->http_req->method : "",
+            (client->http_req->method) ? " " : "",
+            (client->http_req->path) ? client->http_req->path : "");
+        if (length >= 0)
+        {
+            cJSON_AddItemToObject (json, "request",
+                                   cJSON_CreateString (request));
+            cJSON_AddItemToObject (
+                json, "request_body",
+                (client->http_req->body) ?
+                cJSON_Parse (client->http_req->body) : cJSON_CreateNull ());
+            free (request);
+        }
+        cJSON_AddItemToObject (
+            json, "request_id",
+            (client->http_req->id) ?
+            cJSON_CreateString (client->http_req->id) : cJSON_CreateNull ());
+    }
+    cJSON_AddItemToObject (
+        json, "body_type",
+        (body_type) ?
+        cJSON_CreateString (body_type) : cJSON_CreateNull ());
+
+    return json;
+}
 
 /*
  * Sends JSON response to client (internal use).
  *
+ * The message is encoded in CBOR instead of JSON if the client asked for it
+ * (header "Accept: application/cbor" with HTTP, subprotocol "cbor" with
+ * websocket).
+ *
+ * During a batch request, the response is not sent but added to the
+ * responses of the batch (events are always sent immediately).
+ *
  * Returns number of bytes sent to client, -1 if error.
  */
 
@@ -131,76 +404,73 @@ relay_api_msg_send_json_internal (struct t_relay_client *client,
                                   cJSON *json_body)
 {
     cJSON *json;
-    char *string, *request;
-    int num_bytes, length;
+    char *string;
+    int num_bytes, size;
 
     if (!client || !message)
         return -1;
 
     num_bytes = -1;
 
-    if (client->websocket == RELAY_CLIENT_WEBSOCKET_READY)
+    if (!event_name && RELAY_API_DATA(client, batch_responses))
+    {
+        json = relay_api_msg_response_to_json (client, return_code, message,
+                                               NULL, -1, body_type);
+        if (json)
+        {
+            cJSON_AddItemToObject (
+                json, "body",
+                (json_body) ?
+                cJSON_Duplicate (json_body, 1) : cJSON_CreateNull ());
+            cJSON_AddItemToArray (RELAY_API_DATA(client, batch_responses),
+                                  json);
+            num_bytes = 0;
+        }
+    }
+    else if (client->websocket == RELAY_CLIENT_WEBSOCKET_READY)
     {
         /*
          * with established websocket, we return JSON string instead of
          * an HTTP response
          */
-        json = cJSON_CreateObject ();
+        json = relay_api_msg_response_to_json (client, return_code, message,
+                                               event_name, event_buffer_id,
+                                               body_type);
         if (json)
         {
-            cJSON_AddItemToObject (json, "code", cJSON_CreateNumber (return_code));
-            cJSON_AddItemToObject (json, "message", cJSON_CreateString (message));
-            if (event_name)
+            cJSON_AddItemToObject (
+                json, "body",
+                (json_body) ? json_body : cJSON_CreateNull ());
+            if (RELAY_API_DATA(client, encoding) == RELAY_API_ENCODING_CBOR)
             {
-                cJSON_AddItemToObject (
-                    json, "event_name",
-                    cJSON_CreateString ((event_name) ? event_name : ""));
-                cJSON_AddItemToObject (
-                    json, "buffer_id",
-                    cJSON_CreateNumber (event_buffer_id));
+                string = relay_api_cbor_encode (json, &size);
+                num_bytes = relay_client_send (
+                    client,
+                    RELAY_MSG_STANDARD,
+                    string,
+                    (string) ? size : 0,
+                    NULL);  /* raw_message */
             }
             else
             {
-                length = weechat_asprintf (
-                    &request,
-                    "%s%s%s",
-                    (client->http_req->method) ? client->http_req->method : "",
-                    (client->http_req->method) ? " " : "",
-                    (client->http_req->path) ? client->http_req->path : "");
-                if (length >= 0)
-                {
-                    cJSON_AddItemToObject (json, "request",
-                                           cJSON_CreateString (request));
-                    cJSON_AddItemToObject (
-                        json, "request_body",
-                        (client->http_req->body) ?
-                        cJSON_Parse (client->http_req->body) : cJSON_CreateNull ());
-                    free (request);
-                }
-                cJSON_AddItemToObject (
-                    json, "request_id",
-                    (client->http_req->id) ?
-                    cJSON_CreateString (client->http_req->id) : cJSON_CreateNull ());
+                string = cJSON_PrintUnformatted (json);
+                num_bytes = relay_client_send (
+                    client,
+                    RELAY_MSG_STANDARD,
+                    string,
+                    (string) ? strlen (string) : 0,
+                    NULL);  /* raw_message */
             }
-            cJSON_AddItemToObject (
-                json, "body_type",
-                (body_type) ?
-                cJSON_CreateString (body_type) : cJSON_CreateNull ());
-            cJSON_AddItemToObject (
-                json, "body",
-                (json_body) ? json_body : cJSON_CreateNull ());
-            string = cJSON_PrintUnformatted (json);
-            num_bytes = relay_client_send (
-                client,
-                RELAY_MSG_STANDARD,
-                string,
-                (string) ? strlen (string) : 0,
-                NULL);  /* raw_message */
             free (string);
             cJSON_DetachItemFromObject (json, "body");
             cJSON_Delete (json);
         }
     }
+    else if (relay_api_get_encoding_http (client->http_req) == RELAY_API_ENCODING_CBOR)
+    {
+        num_bytes = relay_api_msg_send_http_cbor (client, return_code, message,
+                                                  headers, json_body);
+    }
     else
     {
         string = (json_body) ? cJSON_PrintUnformatted (json_body) : NULL;
@@ -262,11 +532,12 @@ relay_api_msg_send_error_json (struct t_relay_client *client,
 
     num_bytes = -1;
 
-    if (client->websocket == RELAY_CLIENT_WEBSOCKET_READY)
+    if ((client->websocket == RELAY_CLIENT_WEBSOCKET_READY)
+        || RELAY_API_DATA(client, batch_responses))
     {
         /*
-         * with established websocket, we return JSON string instead of
-         * an HTTP response
+         * with established websocket (or during a batch request), we return
+         * JSON string instead of an HTTP response
          */
         json = cJSON_CreateObject ();
         if (json)
@@ -284,6 +555,17 @@ relay_api_msg_send_error_json (struct t_relay_client *client,
             cJSON_Delete (json);
         }
     }
+    else if (relay_api_get_encoding_http (client->http_req) == RELAY_API_ENCODING_CBOR)
+    {
+        json = cJSON_CreateObject ();
+        if (json)
+        {
+            cJSON_AddItemToObject (json, "error", cJSON_CreateString (vbuffer));
+            num_bytes = relay_api_msg_send_http_cbor (client, return_code,
+                                                      message, headers, json);
+            cJSON_Delete (json);
+        }
+    }
     else
     {
         error_msg = weechat_string_replace (vbuffer, "\"", "\\\"");
@@ -350,12 +632,18 @@ relay_api_msg_buffer_add_local_vars_cb (void *data,
 
 /*
  * Creates a JSON object with a buffer.
+ *
+ * If lines_since_id >= 0, only lines with an id greater than lines_since_id
+ * are returned; if lines_since is not NULL, only lines printed after this
+ * date are returned.
  */
 
 cJSON *
 relay_api_msg_buffer_to_json (struct t_gui_buffer *buffer,
                               long lines,
                               long lines_free,
+                              long lines_since_id,
+                              struct timeval *lines_since,
                               int nicks,
                               enum t_relay_api_colors colors)
 {
@@ -410,7 +698,9 @@ relay_api_msg_buffer_to_json (struct t_gui_buffer *buffer,
     /* lines */
     if (lines != 0)
     {
-        json_lines = relay_api_msg_lines_to_json (buffer, lines, colors);
+        json_lines = relay_api_msg_lines_to_json (buffer, lines,
+                                                  lines_since_id, lines_since,
+                                                  colors);
         if (json_lines)
             cJSON_AddItemToObject (json, "lines", json_lines);
     }
@@ -418,6 +708,9 @@ relay_api_msg_buffer_to_json (struct t_gui_buffer *buffer,
     /* nicks */
     if (nicks)
     {
+        /* ask to fill nicklist if it's filled on demand */
+        (void) weechat_hook_signal_send ("buffer_nicklist_request",
+                                         WEECHAT_HOOK_SIGNAL_POINTER, buffer);
         json_nicklist_root = relay_api_msg_nick_group_to_json (
             weechat_hdata_pointer (hdata, buffer, "nicklist_root"),
             colors);
@@ -428,6 +721,50 @@ relay_api_msg_buffer_to_json (struct t_gui_buffer *buffer,
     return json;
 }
 
+/*
+ * Creates a JSON object with memory used by a buffer (in bytes): lines,
+ * compressed lines, lines saved on disk, nicklist and local variables.
+ */
+
+cJSON *
+relay_api_msg_buffer_memory_to_json (struct t_gui_buffer *buffer)
+{
+    struct t_hdata *hdata;
+    void *pointer;
+    cJSON *json;
+
+    json = cJSON_CreateObject ();
+    if (!json)
+        return NULL;
+
+    if (!buffer)
+        return json;
+
+    hdata = relay_hdata_lines;
+    pointer = weechat_hdata_pointer (relay_hdata_buffer, buffer, "own_lines");
+    if (pointer)
+    {
+        MSG_ADD_HDATA_VAR(Number, "lines", integer, "lines_count");
+        MSG_ADD_HDATA_VAR(Number, "lines_size", longlong, "lines_size");
+        MSG_ADD_HDATA_VAR(Number, "lines_compressed", integer,
+                          "lines_compressed_count");
+        MSG_ADD_HDATA_VAR(Number, "lines_compressed_size", longlong,
+                          "lines_compressed_size");
+        MSG_ADD_HDATA_VAR(Number, "lines_on_disk", integer,
+                          "lines_segment_count");
+        MSG_ADD_HDATA_VAR(Number, "lines_on_disk_size", longlong,
+                          "segment_size");
+    }
+
+    hdata = relay_hdata_buffer;
+    pointer = buffer;
+    MSG_ADD_HDATA_VAR(Number, "nicklist_size", longlong, "nicklist_size");
+    MSG_ADD_HDATA_VAR(Number, "local_variables_size", longlong,
+                      "local_variables_size");
+
+    return json;
+}
+
 /*
  * Creates a JSON object with a buffer key.
  */
@@ -481,18 +818,18 @@ relay_api_msg_keys_to_json (struct t_gui_buffer *buffer)
 }
 
 /*
- * Creates a JSON object with a buffer line data.
+ * Writes JSON object with a buffer line data in a dynamic string.
  */
 
-cJSON *
-relay_api_msg_line_data_to_json (struct t_gui_line_data *line_data,
-                                 enum t_relay_api_colors colors)
+void
+relay_api_msg_line_data_write_json (char **json,
+                                    struct t_gui_line_data *line_data,
+                                    enum t_relay_api_colors colors)
 {
     struct t_hdata *hdata;
     struct t_gui_line_data *pointer;
-    cJSON *json, *json_tags;
     const char *ptr_string;
-    char *string, str_time[256], str_var[64];
+    char *string, str_time[256], str_var[64], str_number[64];
     int i, tags_count;
     time_t time_value;
     struct timeval tv;
@@ -501,68 +838,189 @@ relay_api_msg_line_data_to_json (struct t_gui_line_data *line_data,
     hdata = relay_hdata_line_data;
     pointer = line_data;
 
-    json = cJSON_CreateObject ();
+    if (!line_data)
+    {
+        weechat_string_dyn_concat (json, "{}", -1);
+        return;
+    }
+
+    snprintf (str_number, sizeof (str_number), "{\"id\":%d",
+              weechat_hdata_integer (hdata, pointer, "id"));
+    weechat_string_dyn_concat (json, str_number, -1);
+    MSG_WRITE_HDATA_NUMBER("y", integer, "y");
+    MSG_WRITE_HDATA_TIME_USEC("date", "date", "date_usec");
+    MSG_WRITE_HDATA_TIME_USEC("date_printed", "date_printed", "date_usec_printed");
+    MSG_WRITE_HDATA_BOOL("displayed", char, "displayed");
+    MSG_WRITE_HDATA_BOOL("highlight", char, "highlight");
+    MSG_WRITE_HDATA_NUMBER("notify_level", char, "notify_level");
+    MSG_WRITE_HDATA_STR_COLORS("prefix", "prefix");
+    MSG_WRITE_HDATA_STR_COLORS("message", "message");
+
+    /* tags */
+    MSG_WRITE_KEY("tags");
+    weechat_string_dyn_concat (json, "[", -1);
+    tags_count = weechat_hdata_integer (hdata, line_data, "tags_count");
+    for (i = 0; i < tags_count; i++)
+    {
+        if (i > 0)
+            weechat_string_dyn_concat (json, ",", -1);
+        snprintf (str_var, sizeof (str_var), "%d|tags_array", i);
+        relay_api_msg_json_write_string (
+            json, weechat_hdata_string (hdata, line_data, str_var));
+    }
+    weechat_string_dyn_concat (json, "]}", -1);
+}
+
+/*
+ * Creates a JSON object with a buffer line data.
+ */
+
+cJSON *
+relay_api_msg_line_data_to_json (struct t_gui_line_data *line_data,
+                                 enum t_relay_api_colors colors)
+{
+    char **json;
+
+    json = weechat_string_dyn_alloc (512);
     if (!json)
         return NULL;
 
-    if (!line_data)
-        return json;
+    relay_api_msg_line_data_write_json (json, line_data, colors);
 
-    MSG_ADD_HDATA_VAR(Number, "id", integer, "id");
-    MSG_ADD_HDATA_VAR(Number, "y", integer, "y");
-    MSG_ADD_HDATA_TIME_USEC("date", "date", "date_usec");
-    MSG_ADD_HDATA_TIME_USEC("date_printed", "date_printed", "date_usec_printed");
-    MSG_ADD_HDATA_VAR(Bool, "displayed", char, "displayed");
-    MSG_ADD_HDATA_VAR(Bool, "highlight", char, "highlight");
-    MSG_ADD_HDATA_VAR(Number, "notify_level", char, "notify_level");
-    MSG_ADD_HDATA_STR_COLORS("prefix", "prefix");
-    MSG_ADD_HDATA_STR_COLORS("message", "message");
+    return relay_api_msg_json_raw (json);
+}
 
-    /* tags */
-    json_tags = cJSON_CreateArray ();
-    if (json_tags)
+/*
+ * Checks if a line has been printed after a date.
+ *
+ * Returns:
+ *   1: line printed after the date
+ *   0: line printed before or at the date
+ */
+
+int
+relay_api_msg_line_printed_after (struct t_gui_line *line,
+                                  struct timeval *date)
+{
+    struct t_gui_line_data *ptr_line_data;
+    struct timeval tv_printed;
+
+    if (!line || !date)
+        return 0;
+
+    ptr_line_data = weechat_hdata_pointer (relay_hdata_line, line, "data");
+    if (!ptr_line_data)
+        return 0;
+
+    tv_printed.tv_sec = weechat_hdata_time (relay_hdata_line_data,
+                                            ptr_line_data, "date_printed");
+    tv_printed.tv_usec = weechat_hdata_integer (relay_hdata_line_data,
+                                                ptr_line_data,
+                                                "date_usec_printed");
+
+    return (weechat_util_timeval_cmp (&tv_printed, date) > 0) ? 1 : 0;
+}
+
+/*
+ * Searches the first line of buffer lines that matches the conditions
+ * "lines_since_id" and "lines_since".
+ *
+ * The lines are searched from the last line to the first one, so the cost is
+ * proportional to the number of lines returned (if lines < 0, at most -lines
+ * lines are checked).
+ *
+ * Returns pointer to first line found, NULL if no line matches.
+ */
+
+struct t_gui_line *
+relay_api_msg_lines_search_since (struct t_gui_lines *lines,
+                                  long max_lines,
+                                  long lines_since_id,
+                                  struct timeval *lines_since)
+{
+    struct t_gui_line *ptr_line, *ptr_first_line;
+    struct t_gui_line_data *ptr_line_data;
+    long count;
+
+    ptr_first_line = NULL;
+    count = 0;
+
+    ptr_line = weechat_hdata_pointer (relay_hdata_lines, lines, "last_line");
+    while (ptr_line)
     {
-        tags_count = weechat_hdata_integer (hdata, line_data, "tags_count");
-        for (i = 0; i < tags_count; i++)
+        if ((max_lines < 0) && (count >= -1 * max_lines))
+            break;
+        if (lines_since_id >= 0)
         {
-            snprintf (str_var, sizeof (str_var), "%d|tags_array", i);
-            cJSON_AddItemToArray (
-                json_tags,
-                cJSON_CreateString (weechat_hdata_string (hdata, line_data, str_var)));
+            ptr_line_data = weechat_hdata_pointer (relay_hdata_line, ptr_line,
+                                                   "data");
+            if (!ptr_line_data
+                || (weechat_hdata_integer (relay_hdata_line_data,
+                                           ptr_line_data,
+                                           "id") <= lines_since_id))
+            {
+                break;
+            }
+        }
+        if (lines_since
+            && !relay_api_msg_line_printed_after (ptr_line, lines_since))
+        {
+            break;
         }
+        ptr_first_line = ptr_line;
+        count++;
+        ptr_line = weechat_hdata_move (relay_hdata_line, ptr_line, -1);
     }
-    cJSON_AddItemToObject(json, "tags", json_tags);
 
-    return json;
+    return ptr_first_line;
 }
 
 /*
- * Creates a JSON object with an array of buffer lines.
+ * Writes JSON array with buffer lines in a dynamic string.
+ *
+ * If lines_since_id >= 0, only lines with an id greater than lines_since_id
+ * are written; if lines_since is not NULL, only lines printed after this
+ * date are written.
  */
 
-cJSON *
-relay_api_msg_lines_to_json (struct t_gui_buffer *buffer,
-                             long lines,
-                             enum t_relay_api_colors colors)
+void
+relay_api_msg_lines_write_json (char **json,
+                                struct t_gui_buffer *buffer,
+                                long lines,
+                                long lines_since_id,
+                                struct timeval *lines_since,
+                                enum t_relay_api_colors colors)
 {
-    cJSON *json;
     struct t_gui_lines *ptr_lines;
     struct t_gui_line *ptr_line;
     struct t_gui_line_data *ptr_line_data;
-    long i, count;
+    long i, count, count_written;
+    char str_count[64];
 
-    json = cJSON_CreateArray ();
-    if (!json)
-        return NULL;
+    weechat_string_dyn_concat (json, "[", -1);
 
-    if (lines == 0)
-        return json;
-
-    ptr_lines = weechat_hdata_pointer (relay_hdata_buffer, buffer, "own_lines");
+    ptr_lines = (lines != 0) ?
+        weechat_hdata_pointer (relay_hdata_buffer, buffer, "own_lines") : NULL;
     if (!ptr_lines)
-        return json;
+    {
+        weechat_string_dyn_concat (json, "]", -1);
+        return;
+    }
+
+    /*
+     * uncompress old lines of buffer if needed: the N last lines if lines < 0,
+     * otherwise all lines
+     */
+    snprintf (str_count, sizeof (str_count), "%ld", (lines < 0) ? -lines : -1);
+    weechat_buffer_set (buffer, "uncompress_lines", str_count);
 
-    if (lines < 0)
+    if ((lines_since_id >= 0) || lines_since)
+    {
+        ptr_line = relay_api_msg_lines_search_since (ptr_lines, lines,
+                                                     lines_since_id,
+                                                     lines_since);
+    }
+    else if (lines < 0)
     {
         /* search start line from the last line */
         ptr_line = weechat_hdata_pointer (relay_hdata_lines, ptr_lines, "last_line");
@@ -583,18 +1041,17 @@ relay_api_msg_lines_to_json (struct t_gui_buffer *buffer,
         ptr_line = weechat_hdata_pointer (relay_hdata_lines, ptr_lines, "first_line");
     }
 
-    if (!ptr_line)
-        return json;
-
     count = 0;
+    count_written = 0;
     while (ptr_line)
     {
         ptr_line_data = weechat_hdata_pointer (relay_hdata_line, ptr_line, "data");
         if (ptr_line_data)
         {
-            cJSON_AddItemToArray (
-                json,
-                relay_api_msg_line_data_to_json (ptr_line_data, colors));
+            if (count_written > 0)
+                weechat_string_dyn_concat (json, ",", -1);
+            relay_api_msg_line_data_write_json (json, ptr_line_data, colors);
+            count_written++;
         }
         count++;
         if ((lines > 0) && (count >= lines))
@@ -602,124 +1059,175 @@ relay_api_msg_lines_to_json (struct t_gui_buffer *buffer,
         ptr_line = weechat_hdata_move (relay_hdata_line, ptr_line, 1);
     }
 
-    return json;
+    weechat_string_dyn_concat (json, "]", -1);
 }
 
 /*
- * Creates a nick JSON object.
+ * Creates a JSON object with an array of buffer lines.
+ *
+ * If lines_since_id >= 0, only lines with an id greater than lines_since_id
+ * are returned; if lines_since is not NULL, only lines printed after this
+ * date are returned.
  */
 
 cJSON *
-relay_api_msg_nick_to_json (struct t_gui_nick *nick,
-                            enum t_relay_api_colors colors)
+relay_api_msg_lines_to_json (struct t_gui_buffer *buffer,
+                             long lines,
+                             long lines_since_id,
+                             struct timeval *lines_since,
+                             enum t_relay_api_colors colors)
+{
+    char **json;
+
+    json = weechat_string_dyn_alloc (4096);
+    if (!json)
+        return NULL;
+
+    relay_api_msg_lines_write_json (json, buffer, lines, lines_since_id,
+                                    lines_since, colors);
+
+    return relay_api_msg_json_raw (json);
+}
+
+/*
+ * Writes nick JSON object in a dynamic string.
+ */
+
+void
+relay_api_msg_nick_write_json (char **json,
+                               struct t_gui_nick *nick,
+                               enum t_relay_api_colors colors)
 {
     struct t_hdata *hdata;
     struct t_gui_nick *pointer;
     struct t_gui_nick_group *ptr_group;
-    cJSON *json;
     const char *ptr_string, *ptr_color;
-    char *string;
+    char *string, str_number[64];
 
     hdata = relay_hdata_nick;
     pointer = nick;
 
-    json = cJSON_CreateObject ();
-    if (!json)
-        return NULL;
-
     if (!nick)
-        return json;
+    {
+        weechat_string_dyn_concat (json, "{}", -1);
+        return;
+    }
 
-    MSG_ADD_HDATA_VAR(Number, "id", longlong, "id");
     ptr_group = weechat_hdata_pointer (relay_hdata_nick, nick, "group");
-    cJSON_AddItemToObject (
-        json, "parent_group_id",
-        cJSON_CreateNumber (
-            (ptr_group) ?
-            weechat_hdata_longlong (relay_hdata_nick_group, ptr_group, "id") : -1));
-    MSG_ADD_HDATA_STR("prefix", "prefix");
-    MSG_ADD_HDATA_STR("prefix_color_name", "prefix_color");
-    MSG_ADD_HDATA_COLOR("prefix_color", "prefix_color");
-    MSG_ADD_HDATA_STR("name", "name");
-    MSG_ADD_HDATA_STR("color_name", "color");
-    MSG_ADD_HDATA_COLOR("color", "color");
-    MSG_ADD_HDATA_VAR(Bool, "visible", integer, "visible");
-
-    return json;
+    snprintf (str_number, sizeof (str_number),
+              "{\"id\":%lld,\"parent_group_id\":%lld",
+              weechat_hdata_longlong (hdata, pointer, "id"),
+              (ptr_group) ?
+              weechat_hdata_longlong (relay_hdata_nick_group, ptr_group, "id") : -1);
+    weechat_string_dyn_concat (json, str_number, -1);
+    MSG_WRITE_HDATA_STR("prefix", "prefix");
+    MSG_WRITE_HDATA_STR("prefix_color_name", "prefix_color");
+    MSG_WRITE_HDATA_COLOR("prefix_color", "prefix_color");
+    MSG_WRITE_HDATA_STR("name", "name");
+    MSG_WRITE_HDATA_STR("color_name", "color");
+    MSG_WRITE_HDATA_COLOR("color", "color");
+    MSG_WRITE_HDATA_BOOL("visible", integer, "visible");
+    weechat_string_dyn_concat (json, "}", -1);
 }
 
 /*
- * Creates a nick group JSON object.
+ * Creates a nick JSON object.
  */
 
 cJSON *
-relay_api_msg_nick_group_to_json (struct t_gui_nick_group *nick_group,
-                                  enum t_relay_api_colors colors)
+relay_api_msg_nick_to_json (struct t_gui_nick *nick,
+                            enum t_relay_api_colors colors)
+{
+    char **json;
+
+    json = weechat_string_dyn_alloc (256);
+    if (!json)
+        return NULL;
+
+    relay_api_msg_nick_write_json (json, nick, colors);
+
+    return relay_api_msg_json_raw (json);
+}
+
+/*
+ * Writes nick group JSON object (with sub-groups and nicks) in a dynamic
+ * string.
+ */
+
+void
+relay_api_msg_nick_group_write_json (char **json,
+                                     struct t_gui_nick_group *nick_group,
+                                     enum t_relay_api_colors colors)
 {
     struct t_hdata *hdata;
     struct t_gui_nick_group *pointer, *ptr_group;
     struct t_gui_nick *ptr_nick;
-    cJSON *json, *json_groups, *json_nicks;
     const char *ptr_string, *ptr_color;
-    char *string;
+    char *string, str_number[64];
 
     hdata = relay_hdata_nick_group;
     pointer = nick_group;
 
-    json = cJSON_CreateObject ();
-    if (!json)
-        return NULL;
-
     if (!nick_group)
-        return json;
+    {
+        weechat_string_dyn_concat (json, "{}", -1);
+        return;
+    }
 
-    MSG_ADD_HDATA_VAR(Number, "id", longlong, "id");
     ptr_group = weechat_hdata_pointer (relay_hdata_nick_group, nick_group, "parent");
-    cJSON_AddItemToObject (
-        json, "parent_group_id",
-        cJSON_CreateNumber (
-            (ptr_group) ?
-            weechat_hdata_longlong (relay_hdata_nick_group, ptr_group, "id") : -1));
-    MSG_ADD_HDATA_STR("name", "name");
-    MSG_ADD_HDATA_STR("color_name", "color");
-    MSG_ADD_HDATA_COLOR("color", "color");
-    MSG_ADD_HDATA_VAR(Bool, "visible", integer, "visible");
-
-    json_groups = cJSON_CreateArray ();
-    if (json_groups)
+    snprintf (str_number, sizeof (str_number),
+              "{\"id\":%lld,\"parent_group_id\":%lld",
+              weechat_hdata_longlong (hdata, pointer, "id"),
+              (ptr_group) ?
+              weechat_hdata_longlong (relay_hdata_nick_group, ptr_group, "id") : -1);
+    weechat_string_dyn_concat (json, str_number, -1);
+    MSG_WRITE_HDATA_STR("name", "name");
+    MSG_WRITE_HDATA_STR("color_name", "color");
+    MSG_WRITE_HDATA_COLOR("color", "color");
+    MSG_WRITE_HDATA_BOOL("visible", integer, "visible");
+
+    MSG_WRITE_KEY("groups");
+    weechat_string_dyn_concat (json, "[", -1);
+    ptr_group = weechat_hdata_pointer (relay_hdata_nick_group, nick_group, "children");
+    while (ptr_group)
     {
-        ptr_group = weechat_hdata_pointer (relay_hdata_nick_group, nick_group, "children");
+        relay_api_msg_nick_group_write_json (json, ptr_group, colors);
+        ptr_group = weechat_hdata_move (relay_hdata_nick_group, ptr_group, 1);
         if (ptr_group)
-        {
-            while (ptr_group)
-            {
-                cJSON_AddItemToArray (
-                    json_groups,
-                    relay_api_msg_nick_group_to_json (ptr_group, colors));
-                ptr_group = weechat_hdata_move (relay_hdata_nick_group, ptr_group, 1);
-            }
-        }
-        cJSON_AddItemToObject (json, "groups", json_groups);
+            weechat_string_dyn_concat (json, ",", -1);
     }
+    weechat_string_dyn_concat (json, "]", -1);
 
-    json_nicks = cJSON_CreateArray ();
-    if (json_nicks)
+    MSG_WRITE_KEY("nicks");
+    weechat_string_dyn_concat (json, "[", -1);
+    ptr_nick = weechat_hdata_pointer (relay_hdata_nick_group, nick_group, "nicks");
+    while (ptr_nick)
     {
-        ptr_nick = weechat_hdata_pointer (relay_hdata_nick_group, nick_group, "nicks");
+        relay_api_msg_nick_write_json (json, ptr_nick, colors);
+        ptr_nick = weechat_hdata_move (relay_hdata_nick, ptr_nick, 1);
         if (ptr_nick)
-        {
-            while (ptr_nick)
-            {
-                cJSON_AddItemToArray (
-                    json_nicks,
-                    relay_api_msg_nick_to_json (ptr_nick, colors));
-                ptr_nick = weechat_hdata_move (relay_hdata_nick, ptr_nick, 1);
-            }
-        }
-        cJSON_AddItemToObject (json, "nicks", json_nicks);
+            weechat_string_dyn_concat (json, ",", -1);
     }
+    weechat_string_dyn_concat (json, "]}", -1);
+}
 
-    return json;
+/*
+ * Creates a nick group JSON object.
+ */
+
+cJSON *
+relay_api_msg_nick_group_to_json (struct t_gui_nick_group *nick_group,
+                                  enum t_relay_api_colors colors)
+{
+    char **json;
+
+    json = weechat_string_dyn_alloc (4096);
+    if (!json)
+        return NULL;
+
+    relay_api_msg_nick_group_write_json (json, nick_group, colors);
+
+    return relay_api_msg_json_raw (json);
 }
 
 /*
@@ -21,7 +21,23 @@
 #define WEECHAT_PLUGIN_RELAY_API_MSG_H
 
 enum t_relay_api_colors;
+struct t_gui_line;
+struct t_gui_lines;
+struct timeval;
 
+extern void relay_api_msg_json_write_string (char **json, const char *string);
+extern cJSON *relay_api_msg_json_raw (char **json);
+extern int relay_api_msg_send_http_cbor (struct t_relay_client *client,
+                                         int return_code,
+                                         const char *message,
+                                         const char *headers,
+                                         cJSON *json_body);
+extern cJSON *relay_api_msg_response_to_json (struct t_relay_client *client,
+                                              int return_code,
+                                              const char *message,
+                                              const char *event_name,
+                                              long long event_buffer_id,
+                                              const char *body_type);
 extern int relay_api_msg_send_json (struct t_relay_client *client,
                                     int return_code,
                                     const char *message,
@@ -41,17 +57,43 @@ extern int relay_api_msg_send_event (struct t_relay_client *client,
 extern cJSON *relay_api_msg_buffer_to_json (struct t_gui_buffer *buffer,
                                             long lines,
                                             long lines_free,
+                                            long lines_since_id,
+                                            struct timeval *lines_since,
                                             int nicks,
                                             enum t_relay_api_colors colors);
+extern cJSON *relay_api_msg_buffer_memory_to_json (struct t_gui_buffer *buffer);
 extern cJSON *relay_api_msg_key_to_json (struct t_gui_key *key);
 extern cJSON *relay_api_msg_keys_to_json (struct t_gui_buffer *buffer);
+extern void relay_api_msg_line_data_write_json (char **json,
+                                                struct t_gui_line_data *line_data,
+                                                enum t_relay_api_colors colors);
 extern cJSON *relay_api_msg_line_data_to_json (struct t_gui_line_data *line_data,
                                                enum t_relay_api_colors colors);
+extern int relay_api_msg_line_printed_after (struct t_gui_line *line,
+                                             struct timeval *date);
+extern struct t_gui_line *relay_api_msg_lines_search_since (struct t_gui_lines *lines,
+                                                            long max_lines,
+                                                            long lines_since_id,
+                                                            struct timeval *lines_since);
+extern void relay_api_msg_lines_write_json (char **json,
+                                            struct t_gui_buffer *buffer,
+                                            long lines,
+                                            long lines_since_id,
+                                            struct timeval *lines_since,
+                                            enum t_relay_api_colors colors);
 extern cJSON *relay_api_msg_lines_to_json (struct t_gui_buffer *buffer,
                                            long lines,
+                                           long lines_since_id,
+                                           struct timeval *lines_since,
+                                           enum t_relay_api_colors colors);
+extern void relay_api_msg_nick_write_json (char **json,
+                                           struct t_gui_nick *nick,
                                            enum t_relay_api_colors colors);
 extern cJSON *relay_api_msg_nick_to_json (struct t_gui_nick *nick,
                                           enum t_relay_api_colors colors);
+extern void relay_api_msg_nick_group_write_json (char **json,
+                                                 struct t_gui_nick_group *nick_group,
+                                                 enum t_relay_api_colors colors);
 extern cJSON *relay_api_msg_nick_group_to_json (struct t_gui_nick_group *nick_group,
                                                 enum t_relay_api_colors colors);
 extern cJSON *relay_api_msg_hotlist_to_json (struct t_gui_hotlist *hotlist);
@@ -33,6 +33,7 @@
 #include "../relay-client.h"
 #include "../relay-config.h"
 #include "../relay-http.h"
+#include "../relay-metrics.h"
 #include "../relay-websocket.h"
 #include "relay-api.h"
 #include "relay-api-msg.h"
@@ -56,6 +57,32 @@ relay_api_protocol_search_buffer_id_name (const char *string)
     return weechat_buffer_search ("==", string);
 }
 
+/*
+ * Sends the last lines of a buffer, which were not sent to the client
+ * because its outqueue was full (event "buffer_resync").
+ */
+
+void
+relay_api_protocol_send_buffer_resync (struct t_relay_client *client,
+                                       struct t_gui_buffer *buffer,
+                                       int num_lines)
+{
+    cJSON *json;
+
+    if (!client || !buffer || (num_lines <= 0))
+        return;
+
+    json = relay_api_msg_lines_to_json (buffer, -1 * num_lines, -1, NULL,
+                                        RELAY_API_DATA(client, sync_colors));
+    if (json)
+    {
+        relay_api_msg_send_event (client, "buffer_resync",
+                                  relay_api_get_buffer_id (buffer),
+                                  "lines", json);
+        cJSON_Delete (json);
+    }
+}
+
 /*
  * Callback for signals "buffer_*".
  */
@@ -124,10 +151,16 @@ relay_api_protocol_signal_buffer_cb (const void *pointer, void *data,
                     RELAY_API_DATA(ptr_client, buffers_closing),
                     ptr_buffer);
             }
+            weechat_hashtable_remove (
+                RELAY_API_DATA(ptr_client, nicklist_diff),
+                ptr_buffer);
             relay_api_msg_send_event (ptr_client, signal, buffer_id, NULL, NULL);
             return WEECHAT_RC_OK;
         }
 
+        /* send nicklist changes not yet sent, so that events are in order */
+        relay_api_protocol_send_nicklist_diff (ptr_client, ptr_buffer);
+
         if (strcmp (signal, "buffer_closing") == 0)
         {
             /*
@@ -156,7 +189,7 @@ relay_api_protocol_signal_buffer_cb (const void *pointer, void *data,
 
         /* build body with buffer info */
         json = relay_api_msg_buffer_to_json (
-            ptr_buffer, lines, lines_free, nicks,
+            ptr_buffer, lines, lines_free, -1, NULL, nicks,
             RELAY_API_DATA(ptr_client, sync_colors));
 
         /* send to client */
@@ -167,6 +200,28 @@ relay_api_protocol_signal_buffer_cb (const void *pointer, void *data,
             cJSON_Delete (json);
         }
     }
+    else if (strcmp (signal, "buffer_list_reordered") == 0)
+    {
+        /* all buffers may have moved: send event "buffer_moved" for each one */
+        ptr_buffer = weechat_hdata_get_list (relay_hdata_buffer, "gui_buffers");
+        while (ptr_buffer)
+        {
+            if (!relay_buffer_is_relay (ptr_buffer))
+            {
+                json = relay_api_msg_buffer_to_json (
+                    ptr_buffer, 0, 0, -1, NULL, 0,
+                    RELAY_API_DATA(ptr_client, sync_colors));
+                if (json)
+                {
+                    relay_api_msg_send_event (
+                        ptr_client, "buffer_moved",
+                        relay_api_get_buffer_id (ptr_buffer), "buffer", json);
+                    cJSON_Delete (json);
+                }
+            }
+            ptr_buffer = weechat_hdata_move (relay_hdata_buffer, ptr_buffer, 1);
+        }
+    }
     else if (strcmp (signal, "buffer_line_added") == 0)
     {
         ptr_line = (struct t_gui_line *)signal_data;
@@ -183,6 +238,10 @@ relay_api_protocol_signal_buffer_cb (const void *pointer, void *data,
         if (!ptr_buffer || relay_buffer_is_relay (ptr_buffer))
             return WEECHAT_RC_OK;
 
+        /* outqueue full: line is sent later in event "buffer_resync" */
+        if (relay_client_outqueue_drop_line (ptr_client, ptr_buffer))
+            return WEECHAT_RC_OK;
+
         json = relay_api_msg_line_data_to_json (
             ptr_line_data, RELAY_API_DATA(ptr_client, sync_colors));
         if (json)
@@ -218,6 +277,53 @@ relay_api_protocol_signal_buffer_cb (const void *pointer, void *data,
     return WEECHAT_RC_OK;
 }
 
+/*
+ * Adds a nicklist change in the nicklist diff of a buffer (sent later by
+ * the timer, in a single event "nicklist_diff").
+ *
+ * Note: json_body is freed by this function.
+ */
+
+void
+relay_api_protocol_nicklist_diff_add (struct t_relay_client *client,
+                                      struct t_gui_buffer *buffer,
+                                      const char *event_name,
+                                      const char *body_type,
+                                      cJSON *json_body)
+{
+    cJSON *json_diff, *json_item;
+
+    json_diff = weechat_hashtable_get (RELAY_API_DATA(client, nicklist_diff),
+                                       buffer);
+    if (!json_diff)
+    {
+        json_diff = cJSON_CreateArray ();
+        if (!json_diff)
+        {
+            cJSON_Delete (json_body);
+            return;
+        }
+        weechat_hashtable_set (RELAY_API_DATA(client, nicklist_diff),
+                               buffer, json_diff);
+    }
+
+    json_item = cJSON_CreateObject ();
+    if (!json_item)
+    {
+        cJSON_Delete (json_body);
+        return;
+    }
+    cJSON_AddItemToObject (json_item, "event_name",
+                           cJSON_CreateString (event_name));
+    cJSON_AddItemToObject (json_item, "body_type",
+                           cJSON_CreateString (body_type));
+    cJSON_AddItemToObject (json_item, "body", json_body);
+    cJSON_AddItemToArray (json_diff, json_item);
+
+    if (!RELAY_API_DATA(client, hook_timer_nicklist))
+        relay_api_hook_timer_nicklist (client);
+}
+
 /*
  * Callback for hsignals "nicklist_*".
  */
@@ -231,6 +337,7 @@ relay_api_protocol_hsignal_nicklist_cb (const void *pointer, void *data,
     struct t_gui_buffer *ptr_buffer;
     struct t_gui_nick_group *ptr_parent_group, *ptr_group;
     struct t_gui_nick *ptr_nick;
+    const char *body_type;
     cJSON *json;
     long long buffer_id;
 
@@ -253,40 +360,148 @@ relay_api_protocol_hsignal_nicklist_cb (const void *pointer, void *data,
     if (!ptr_buffer || relay_buffer_is_relay (ptr_buffer))
         return WEECHAT_RC_OK;
 
-    buffer_id = relay_api_get_buffer_id (ptr_buffer);
+    /*
+     * with nicklist diff, nicks of a buffer being closed (removed after
+     * the signal "buffer_closing") are not sent: the client receives
+     * the event "buffer_closed"
+     */
+    if (RELAY_API_DATA(ptr_client, sync_nicklist_diff)
+        && weechat_hashtable_has_key (RELAY_API_DATA(ptr_client, buffers_closing),
+                                      ptr_buffer))
+    {
+        return WEECHAT_RC_OK;
+    }
 
     if ((strcmp (signal, "nicklist_group_added") == 0)
         || (strcmp (signal, "nicklist_group_changed") == 0)
         || (strcmp (signal, "nicklist_group_removing") == 0))
     {
+        body_type = "nick_group";
         json = relay_api_msg_nick_group_to_json (
             ptr_group,
             RELAY_API_DATA(ptr_client, sync_colors));
-        if (json)
-        {
-            relay_api_msg_send_event (ptr_client, signal, buffer_id,
-                                      "nick_group", json);
-            cJSON_Delete (json);
-        }
     }
     else if ((strcmp (signal, "nicklist_nick_added") == 0)
         || (strcmp (signal, "nicklist_nick_changed") == 0)
         || (strcmp (signal, "nicklist_nick_removing") == 0))
     {
+        body_type = "nick";
         json = relay_api_msg_nick_to_json (
             ptr_nick,
             RELAY_API_DATA(ptr_client, sync_colors));
-        if (json)
-        {
-            relay_api_msg_send_event (ptr_client, signal, buffer_id,
-                                      "nick", json);
-            cJSON_Delete (json);
-        }
+    }
+    else
+    {
+        return WEECHAT_RC_OK;
+    }
+
+    if (!json)
+        return WEECHAT_RC_OK;
+
+    if (RELAY_API_DATA(ptr_client, sync_nicklist_diff))
+    {
+        relay_api_protocol_nicklist_diff_add (ptr_client, ptr_buffer,
+                                              signal, body_type, json);
+    }
+    else
+    {
+        buffer_id = relay_api_get_buffer_id (ptr_buffer);
+        relay_api_msg_send_event (ptr_client, signal, buffer_id,
+                                  body_type, json);
+        cJSON_Delete (json);
     }
 
     return WEECHAT_RC_OK;
 }
 
+/*
+ * Sends nicklist changes not yet sent for a buffer (event "nicklist_diff").
+ */
+
+void
+relay_api_protocol_send_nicklist_diff (struct t_relay_client *client,
+                                       struct t_gui_buffer *buffer)
+{
+    cJSON *json_diff;
+
+    if (!client || !buffer)
+        return;
+
+    json_diff = weechat_hashtable_get (RELAY_API_DATA(client, nicklist_diff),
+                                       buffer);
+    if (!json_diff)
+        return;
+
+    relay_api_msg_send_event (client, "nicklist_diff",
+                              relay_api_get_buffer_id (buffer),
+                              "nicklist_diff", json_diff);
+
+    /* this frees the JSON array */
+    weechat_hashtable_remove (RELAY_API_DATA(client, nicklist_diff), buffer);
+}
+
+/*
+ * Callback called for each buffer in hashtable "nicklist_diff".
+ */
+
+void
+relay_api_protocol_nicklist_diff_map_cb (void *data,
+                                         struct t_hashtable *hashtable,
+                                         const void *key,
+                                         const void *value)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+
+    relay_api_msg_send_event ((struct t_relay_client *)data,
+                              "nicklist_diff",
+                              relay_api_get_buffer_id ((struct t_gui_buffer *)key),
+                              "nicklist_diff",
+                              (cJSON *)value);
+}
+
+/*
+ * Sends nicklist changes not yet sent for all buffers.
+ */
+
+void
+relay_api_protocol_send_nicklist_diff_all (struct t_relay_client *client)
+{
+    if (!client)
+        return;
+
+    weechat_hashtable_map (RELAY_API_DATA(client, nicklist_diff),
+                           &relay_api_protocol_nicklist_diff_map_cb,
+                           client);
+
+    weechat_hashtable_remove_all (RELAY_API_DATA(client, nicklist_diff));
+}
+
+/*
+ * Callback for timer sending nicklist changes (event "nicklist_diff").
+ */
+
+int
+relay_api_protocol_timer_nicklist_cb (const void *pointer, void *data,
+                                      int remaining_calls)
+{
+    struct t_relay_client *ptr_client;
+
+    /* make C compiler happy */
+    (void) data;
+    (void) remaining_calls;
+
+    ptr_client = (struct t_relay_client *)pointer;
+    if (!ptr_client || !relay_client_valid (ptr_client))
+        return WEECHAT_RC_OK;
+
+    relay_api_protocol_send_nicklist_diff_all (ptr_client);
+
+    RELAY_API_DATA(ptr_client, hook_timer_nicklist) = NULL;
+
+    return WEECHAT_RC_OK;
+}
+
 /*
  * Callback for signal "input_text_changed".
  */
@@ -315,7 +530,7 @@ relay_api_protocol_signal_input_cb (const void *pointer, void *data,
         return WEECHAT_RC_OK;
 
     json = relay_api_msg_buffer_to_json (
-        ptr_buffer, 0, 0, 0,
+        ptr_buffer, 0, 0, -1, NULL, 0,
         RELAY_API_DATA(ptr_client, sync_colors));
 
     if (json)
@@ -352,6 +567,7 @@ relay_api_protocol_signal_upgrade_cb (const void *pointer, void *data,
     if ((strcmp (signal, "upgrade") == 0)
         || (strcmp (signal, "upgrade_ended") == 0))
     {
+        relay_api_protocol_send_nicklist_diff_all (ptr_client);
         relay_api_msg_send_event (ptr_client, signal, -1, NULL, NULL);
     }
 
@@ -509,6 +725,64 @@ RELAY_API_PROTOCOL_CALLBACK(version)
     return RELAY_API_PROTOCOL_RC_OK;
 }
 
+/*
+ * Gets a date in an URL parameter.
+ *
+ * If the parameter is set and valid, *date is set to tv, otherwise to NULL.
+ *
+ * Returns:
+ *   1: OK (parameter not set or valid date)
+ *   0: invalid date (an error is sent to the client)
+ */
+
+int
+relay_api_protocol_get_param_time (struct t_relay_client *client,
+                                   const char *name,
+                                   struct timeval *tv,
+                                   struct timeval **date)
+{
+    int rc;
+
+    *date = NULL;
+
+    rc = relay_http_get_param_time (client->http_req, name, tv);
+    if (rc < 0)
+    {
+        relay_api_msg_send_error_json (client, RELAY_HTTP_400_BAD_REQUEST, NULL,
+                                       "Invalid date for parameter \"%s\"",
+                                       name);
+        return 0;
+    }
+
+    if (rc > 0)
+        *date = tv;
+
+    return 1;
+}
+
+/*
+ * Checks if a buffer has lines printed after a date.
+ *
+ * Returns:
+ *   1: buffer has lines printed after the date
+ *   0: buffer has no lines printed after the date
+ */
+
+int
+relay_api_protocol_buffer_changed_since (struct t_gui_buffer *buffer,
+                                         struct timeval *date)
+{
+    struct t_gui_lines *ptr_lines;
+
+    ptr_lines = weechat_hdata_pointer (relay_hdata_buffer, buffer, "own_lines");
+    if (!ptr_lines)
+        return 0;
+
+    return relay_api_msg_line_printed_after (
+        weechat_hdata_pointer (relay_hdata_lines, ptr_lines, "last_line"),
+        date);
+}
+
 /*
  * Callback for resource "buffers".
  *
@@ -522,21 +796,40 @@ RELAY_API_PROTOCOL_CALLBACK(version)
  *   GET /api/buffers/{buffer_name}/lines
  *   GET /api/buffers/{buffer_name}/lines/{line_id}
  *   GET /api/buffers/{buffer_name}/nicks
+ *
+ * Parameters "lines_since_id" (only with a buffer) and "lines_since" return
+ * only lines that the client has not received yet (delta after reconnection),
+ * and parameter "changed_since" returns only buffers with lines printed after
+ * this date.
+ *
+ * Parameter "memory" adds memory used by each buffer.
  */
 
 RELAY_API_PROTOCOL_CALLBACK(buffers)
 {
-    cJSON *json;
+    cJSON *json, *json_buffer;
     struct t_gui_buffer *ptr_buffer;
     struct t_gui_line *ptr_line;
     struct t_gui_line_data *ptr_line_data;
-    long lines, lines_free, line_id;
-    int nicks;
+    struct timeval tv_lines_since, tv_changed_since;
+    struct timeval *ptr_lines_since, *ptr_changed_since;
+    long lines, lines_free, line_id, lines_since_id;
+    int nicks, memory;
     char *error;
     enum t_relay_api_colors colors;
 
     json = NULL;
 
+    if (!relay_api_protocol_get_param_time (client, "lines_since",
+                                            &tv_lines_since,
+                                            &ptr_lines_since)
+        || !relay_api_protocol_get_param_time (client, "changed_since",
+                                               &tv_changed_since,
+                                               &ptr_changed_since))
+    {
+        return RELAY_API_PROTOCOL_RC_OK;
+    }
+
     ptr_buffer = NULL;
     if (client->http_req->num_path_items > 2)
     {
@@ -552,8 +845,12 @@ RELAY_API_PROTOCOL_CALLBACK(buffers)
     }
 
     nicks = relay_http_get_param_boolean (client->http_req, "nicks", 0);
+    memory = relay_http_get_param_boolean (client->http_req, "memory", 0);
     colors = relay_api_search_colors (
         weechat_hashtable_get (client->http_req->params, "colors"));
+    /* line ids are specific to each buffer */
+    lines_since_id = (ptr_buffer) ?
+        relay_http_get_param_long (client->http_req, "lines_since_id", -1) : -1;
 
     if (client->http_req->num_path_items > 3)
     {
@@ -585,7 +882,10 @@ RELAY_API_PROTOCOL_CALLBACK(buffers)
             else
             {
                 lines = relay_http_get_param_long (client->http_req, "lines", LONG_MAX);
-                json = relay_api_msg_lines_to_json (ptr_buffer, lines, colors);
+                json = relay_api_msg_lines_to_json (ptr_buffer, lines,
+                                                    lines_since_id,
+                                                    ptr_lines_since,
+                                                    colors);
                 if (json)
                 {
                     relay_api_msg_send_json (client, RELAY_HTTP_200_OK, NULL,
@@ -623,9 +923,16 @@ RELAY_API_PROTOCOL_CALLBACK(buffers)
         if (ptr_buffer)
         {
             json = relay_api_msg_buffer_to_json (ptr_buffer, lines, lines_free,
+                                                 lines_since_id, ptr_lines_since,
                                                  nicks, colors);
             if (json)
             {
+                if (memory)
+                {
+                    cJSON_AddItemToObject (
+                        json, "memory",
+                        relay_api_msg_buffer_memory_to_json (ptr_buffer));
+                }
                 relay_api_msg_send_json (client, RELAY_HTTP_200_OK, NULL,
                                          "buffer", json);
             }
@@ -639,10 +946,21 @@ RELAY_API_PROTOCOL_CALLBACK(buffers)
                                                  "gui_buffers");
             while (ptr_buffer)
             {
-                cJSON_AddItemToArray (
-                    json,
-                    relay_api_msg_buffer_to_json (ptr_buffer, lines, lines_free,
-                                                  nicks, colors));
+                if (!ptr_changed_since
+                    || relay_api_protocol_buffer_changed_since (
+                        ptr_buffer, ptr_changed_since))
+                {
+                    json_buffer = relay_api_msg_buffer_to_json (
+                        ptr_buffer, lines, lines_free, -1, ptr_lines_since,
+                        nicks, colors);
+                    if (json_buffer && memory)
+                    {
+                        cJSON_AddItemToObject (
+                            json_buffer, "memory",
+                            relay_api_msg_buffer_memory_to_json (ptr_buffer));
+                    }
+                    cJSON_AddItemToArray (json, json_buffer);
+                }
                 ptr_buffer = weechat_hdata_move (relay_hdata_buffer, ptr_buffer, 1);
             }
             if (json)
@@ -691,6 +1009,46 @@ RELAY_API_PROTOCOL_CALLBACK(hotlist)
     return RELAY_API_PROTOCOL_RC_OK;
 }
 
+/*
+ * Callback for resource "metrics".
+ *
+ * The metrics are sent in Prometheus text format, or as a JSON string in
+ * body when the client is connected with a websocket or in a batch request.
+ *
+ * Routes:
+ *   GET /api/metrics
+ */
+
+RELAY_API_PROTOCOL_CALLBACK(metrics)
+{
+    cJSON *json;
+    char *metrics;
+
+    metrics = relay_metrics_get ();
+    if (!metrics)
+        return RELAY_API_PROTOCOL_RC_MEMORY;
+
+    if ((client->websocket == RELAY_CLIENT_WEBSOCKET_READY)
+        || RELAY_API_DATA(client, batch_responses))
+    {
+        json = cJSON_CreateString (metrics);
+        relay_api_msg_send_json (client, RELAY_HTTP_200_OK, NULL, "metrics",
+                                 json);
+        cJSON_Delete (json);
+    }
+    else
+    {
+        relay_http_send (client, RELAY_HTTP_200_OK,
+                         "Access-Control-Allow-Origin: *\r\n"
+                         "Content-Type: " RELAY_METRICS_CONTENT_TYPE,
+                         metrics, strlen (metrics));
+    }
+
+    free (metrics);
+
+    return RELAY_API_PROTOCOL_RC_OK;
+}
+
 /*
  * Callback for resource "input".
  *
@@ -869,7 +1227,8 @@ RELAY_API_PROTOCOL_CALLBACK(ping)
 
 RELAY_API_PROTOCOL_CALLBACK(sync)
 {
-    cJSON *json_body, *json_sync, *json_nicks, *json_input, *json_colors;
+    cJSON *json_body, *json_sync, *json_nicks, *json_nicklist_diff;
+    cJSON *json_input, *json_colors;
 
     if (client->websocket != RELAY_CLIENT_WEBSOCKET_READY)
     {
@@ -883,6 +1242,7 @@ RELAY_API_PROTOCOL_CALLBACK(sync)
 
     RELAY_API_DATA(client, sync_enabled) = 1;
     RELAY_API_DATA(client, sync_nicks) = 1;
+    RELAY_API_DATA(client, sync_nicklist_diff) = 0;
     RELAY_API_DATA(client, sync_input) = 1;
     RELAY_API_DATA(client, sync_colors) = RELAY_API_COLORS_ANSI;
 
@@ -895,6 +1255,9 @@ RELAY_API_PROTOCOL_CALLBACK(sync)
         json_nicks = cJSON_GetObjectItem (json_body, "nicks");
         if (json_nicks && cJSON_IsBool (json_nicks))
             RELAY_API_DATA(client, sync_nicks) = (cJSON_IsTrue (json_nicks)) ? 1 : 0;
+        json_nicklist_diff = cJSON_GetObjectItem (json_body, "nicklist_diff");
+        if (json_nicklist_diff && cJSON_IsBool (json_nicklist_diff))
+            RELAY_API_DATA(client, sync_nicklist_diff) = (cJSON_IsTrue (json_nicklist_diff)) ? 1 : 0;
         json_input = cJSON_GetObjectItem (json_body, "input");
         if (json_input && cJSON_IsBool (json_input))
             RELAY_API_DATA(client, sync_input) = (cJSON_IsTrue (json_input)) ? 1 : 0;
@@ -915,12 +1278,9 @@ RELAY_API_PROTOCOL_CALLBACK(sync)
 }
 
 /*
- * Reads JSON string from a client: when connected via websocket (persistent
- * connection), the client is sending JSON data as a request, which is
- * converted to HTTP request by this function, before calling the function
- * relay_api_protocol_recv_http.
+ * Converts a JSON object with a request to an HTTP request.
  *
- * Example of JSON received:
+ * Example of JSON object:
  *
  * {
  *     "request": "POST /api/input",
@@ -937,33 +1297,35 @@ RELAY_API_PROTOCOL_CALLBACK(sync)
  * Content-Type: application/json
  *
  * {"buffer": "irc.libera.#weechat","command": "hello!"}
+ *
+ * Returns:
+ *   1: OK
+ *   0: invalid request
  */
 
-void
-relay_api_protocol_recv_json (struct t_relay_client *client, const char *json)
+int
+relay_api_protocol_json_to_request (cJSON *json_obj,
+                                    struct t_relay_http_request *request)
 {
-    cJSON *json_obj, *json_request, *json_body, *json_request_id;
+    cJSON *json_request, *json_body, *json_request_id;
     const char *ptr_request_id;
     char *string_body;
     int length;
 
-    relay_http_request_reinit (client->http_req);
-
-    json_obj = cJSON_Parse (json);
-    if (!json_obj)
-        goto error;
+    if (!json_obj || !request || !cJSON_IsObject (json_obj))
+        return 0;
 
     json_request = cJSON_GetObjectItem (json_obj, "request");
     if (!json_request)
-        goto error;
+        return 0;
 
     if (!cJSON_IsString (json_request))
-        goto error;
+        return 0;
 
-    if (!relay_http_parse_method_path (client->http_req,
+    if (!relay_http_parse_method_path (request,
                                        cJSON_GetStringValue (json_request)))
     {
-        goto error;
+        return 0;
     }
 
     json_body = cJSON_GetObjectItem (json_obj, "body");
@@ -973,37 +1335,135 @@ relay_api_protocol_recv_json (struct t_relay_client *client, const char *json)
         if (string_body)
         {
             length = strlen (string_body);
-            client->http_req->body = malloc (length + 1);
-            if (client->http_req->body)
+            request->body = malloc (length + 1);
+            if (request->body)
             {
-                memcpy (client->http_req->body, string_body, length + 1);
-                client->http_req->content_length = length;
-                client->http_req->body_size = length;
+                memcpy (request->body, string_body, length + 1);
+                request->content_length = length;
+                request->body_size = length;
             }
             free (string_body);
         }
     }
 
-    free (client->http_req->id);
-    client->http_req->id = NULL;
+    free (request->id);
+    request->id = NULL;
     json_request_id = cJSON_GetObjectItem (json_obj, "request_id");
     if (json_request_id)
     {
         if (!cJSON_IsString (json_request_id) && !cJSON_IsNull (json_request_id))
-            goto error;
-        free (client->http_req->id);
+            return 0;
         ptr_request_id = cJSON_GetStringValue (json_request_id);
-        client->http_req->id = (ptr_request_id) ?
-            strdup (ptr_request_id) : NULL;
+        request->id = (ptr_request_id) ? strdup (ptr_request_id) : NULL;
     }
 
-    relay_api_protocol_recv_http (client);
-    goto end;
+    return 1;
+}
 
-error:
-    relay_api_msg_send_json (client, RELAY_HTTP_400_BAD_REQUEST, NULL, NULL, NULL);
+/*
+ * Callback for resource "batch".
+ *
+ * Routes:
+ *   POST /api/batch
+ *
+ * The body is an array of requests, with the same format as requests sent
+ * with a websocket (see function relay_api_protocol_json_to_request); they
+ * are executed in order, with the headers of the batch request (so the
+ * authentication is checked only once), and the response is an array with
+ * the response of each request.
+ */
+
+RELAY_API_PROTOCOL_CALLBACK(batch)
+{
+    cJSON *json_body, *json_responses, *json_request;
+    struct t_relay_http_request *ptr_batch_request, *sub_request;
+
+    if (RELAY_API_DATA(client, batch_responses))
+    {
+        relay_api_msg_send_error_json (client, RELAY_HTTP_400_BAD_REQUEST, NULL,
+                                       "Nested batch requests are not allowed");
+        return RELAY_API_PROTOCOL_RC_OK;
+    }
+
+    json_body = cJSON_Parse (client->http_req->body);
+    if (!json_body)
+        return RELAY_API_PROTOCOL_RC_BAD_REQUEST;
+    if (!cJSON_IsArray (json_body))
+    {
+        cJSON_Delete (json_body);
+        return RELAY_API_PROTOCOL_RC_BAD_REQUEST;
+    }
+
+    json_responses = cJSON_CreateArray ();
+    if (!json_responses)
+    {
+        cJSON_Delete (json_body);
+        return RELAY_API_PROTOCOL_RC_MEMORY;
+    }
+
+    ptr_batch_request = client->http_req;
+    RELAY_API_DATA(client, batch_responses) = json_responses;
+
+    cJSON_ArrayForEach (json_request, json_body)
+    {
+        sub_request = relay_http_request_alloc ();
+        if (!sub_request)
+            break;
+        weechat_hashtable_free (sub_request->headers);
+        sub_request->headers = weechat_hashtable_dup (
+            ptr_batch_request->headers);
+        client->http_req = sub_request;
+        if (sub_request->headers
+            && relay_api_protocol_json_to_request (json_request, sub_request))
+        {
+            relay_api_protocol_recv_http (client);
+        }
+        else
+        {
+            relay_api_msg_send_json (client, RELAY_HTTP_400_BAD_REQUEST,
+                                     NULL, NULL, NULL);
+        }
+        client->http_req = ptr_batch_request;
+        relay_http_request_free (sub_request);
+        if (RELAY_STATUS_HAS_ENDED(client->status))
+            break;
+    }
+
+    RELAY_API_DATA(client, batch_responses) = NULL;
+
+    if (!RELAY_STATUS_HAS_ENDED(client->status))
+    {
+        relay_api_msg_send_json (client, RELAY_HTTP_200_OK, NULL, "batch",
+                                 json_responses);
+    }
+
+    cJSON_Delete (json_responses);
+    cJSON_Delete (json_body);
+
+    return RELAY_API_PROTOCOL_RC_OK;
+}
+
+/*
+ * Reads JSON string from a client: when connected via websocket (persistent
+ * connection), the client is sending JSON data as a request, which is
+ * converted to HTTP request by the function
+ * relay_api_protocol_json_to_request, before calling the function
+ * relay_api_protocol_recv_http.
+ */
+
+void
+relay_api_protocol_recv_json (struct t_relay_client *client, const char *json)
+{
+    cJSON *json_obj;
+
+    relay_http_request_reinit (client->http_req);
+
+    json_obj = cJSON_Parse (json);
+    if (relay_api_protocol_json_to_request (json_obj, client->http_req))
+        relay_api_protocol_recv_http (client);
+    else
+        relay_api_msg_send_json (client, RELAY_HTTP_400_BAD_REQUEST, NULL, NULL, NULL);
 
-end:
     if (json_obj)
         cJSON_Delete (json_obj);
 }
@@ -1024,9 +1484,11 @@ relay_api_protocol_recv_http (struct t_relay_client *client)
         { "GET",     "version",   1, 0,  0, &relay_api_protocol_cb_version   },
         { "GET",     "buffers",   1, 0,  3, &relay_api_protocol_cb_buffers   },
         { "GET",     "hotlist",   1, 0,  3, &relay_api_protocol_cb_hotlist   },
+        { "GET",     "metrics",   1, 0,  0, &relay_api_protocol_cb_metrics   },
         { "POST",    "input",     1, 0,  0, &relay_api_protocol_cb_input     },
         { "POST",    "ping",      1, 0,  0, &relay_api_protocol_cb_ping      },
         { "POST",    "sync",      1, 0,  0, &relay_api_protocol_cb_sync      },
+        { "POST",    "batch",     1, 0,  0, &relay_api_protocol_cb_batch     },
         { NULL,      NULL,        0, 0,  0, NULL                             },
     };
 
@@ -45,15 +45,35 @@ struct t_relay_api_protocol_cb
     t_relay_api_cmd_func *cmd_function; /* callback                         */
 };
 
+extern void relay_api_protocol_send_buffer_resync (struct t_relay_client *client,
+                                                  struct t_gui_buffer *buffer,
+                                                  int num_lines);
+extern int relay_api_protocol_get_param_time (struct t_relay_client *client,
+                                              const char *name,
+                                              struct timeval *tv,
+                                              struct timeval **date);
+extern int relay_api_protocol_buffer_changed_since (struct t_gui_buffer *buffer,
+                                                    struct timeval *date);
 extern int relay_api_protocol_signal_buffer_cb (const void *pointer,
                                                 void *data,
                                                 const char *signal,
                                                 const char *type_data,
                                                 void *signal_data);
+extern void relay_api_protocol_nicklist_diff_add (struct t_relay_client *client,
+                                                 struct t_gui_buffer *buffer,
+                                                 const char *event_name,
+                                                 const char *body_type,
+                                                 struct cJSON *json_body);
 extern int relay_api_protocol_hsignal_nicklist_cb (const void *pointer,
                                                    void *data,
                                                    const char *signal,
                                                    struct t_hashtable *hashtable);
+extern void relay_api_protocol_send_nicklist_diff (struct t_relay_client *client,
+                                                  struct t_gui_buffer *buffer);
+extern void relay_api_protocol_send_nicklist_diff_all (struct t_relay_client *client);
+extern int relay_api_protocol_timer_nicklist_cb (const void *pointer,
+                                                 void *data,
+                                                 int remaining_calls);
 extern int relay_api_protocol_signal_input_cb (const void *pointer, void *data,
                                                const char *signal,
                                                const char *type_data,
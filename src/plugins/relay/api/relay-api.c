@@ -30,6 +30,8 @@
 #include <errno.h>
 #include <arpa/inet.h>
 
+#include <cjson/cJSON.h>
+
 #include "../../weechat-plugin.h"
 #include "../relay.h"
 #include "../relay-client.h"
@@ -41,6 +43,10 @@
 #include "relay-api-protocol.h"
 
 
+char *relay_api_encoding_string[RELAY_API_NUM_ENCODINGS] =
+{ "json", "cbor" };
+
+
 /*
  * Returns buffer id.
  */
@@ -89,6 +95,135 @@ relay_api_search_colors (const char *colors)
     return RELAY_API_COLORS_ANSI;
 }
 
+/*
+ * Checks if a comma-separated list of values (HTTP header) contains a value
+ * (parameters after ";" in items are ignored, comparison is case-insensitive).
+ *
+ * Returns:
+ *   1: list contains the value
+ *   0: list does not contain the value
+ */
+
+int
+relay_api_header_list_has_value (const char *list, const char *value)
+{
+    char **items, *item, *pos;
+    int i, num_items, found;
+
+    if (!list || !value)
+        return 0;
+
+    found = 0;
+
+    items = weechat_string_split (list, ",", " ", 0, 0, &num_items);
+    if (items)
+    {
+        for (i = 0; i < num_items; i++)
+        {
+            pos = strchr (items[i], ';');
+            if (pos)
+                pos[0] = '\0';
+            item = weechat_string_strip (items[i], 0, 1, " ");
+            if (item && (weechat_strcasecmp (item, value) == 0))
+                found = 1;
+            free (item);
+            if (found)
+                break;
+        }
+        weechat_string_free_split (items);
+    }
+
+    return found;
+}
+
+/*
+ * Returns encoding of HTTP response body, according to the header "Accept"
+ * of the request: CBOR if "application/cbor" is accepted, otherwise JSON.
+ */
+
+enum t_relay_api_encoding
+relay_api_get_encoding_http (struct t_relay_http_request *request)
+{
+    if (!request)
+        return RELAY_API_ENCODING_JSON;
+
+    return (relay_api_header_list_has_value (
+                weechat_hashtable_get (request->headers, "accept"),
+                RELAY_API_CBOR_CONTENT_TYPE)) ?
+        RELAY_API_ENCODING_CBOR : RELAY_API_ENCODING_JSON;
+}
+
+/*
+ * Returns encoding of websocket messages, according to the header
+ * "Sec-WebSocket-Protocol" of the websocket handshake: CBOR if subprotocol
+ * "cbor" is requested, otherwise JSON.
+ */
+
+enum t_relay_api_encoding
+relay_api_get_encoding_websocket (struct t_relay_http_request *request)
+{
+    if (!request)
+        return RELAY_API_ENCODING_JSON;
+
+    return (relay_api_header_list_has_value (
+                weechat_hashtable_get (request->headers,
+                                       "sec-websocket-protocol"),
+                RELAY_API_CBOR_WS_PROTOCOL)) ?
+        RELAY_API_ENCODING_CBOR : RELAY_API_ENCODING_JSON;
+}
+
+/*
+ * Sets encoding of websocket messages sent to the client, using the
+ * websocket handshake sent by the client.
+ *
+ * If CBOR is used, the subprotocol is returned in the websocket handshake
+ * sent to the client.
+ */
+
+void
+relay_api_websocket_set_encoding (struct t_relay_client *client)
+{
+    if (!client || !client->protocol_data || !client->http_req)
+        return;
+
+    RELAY_API_DATA(client, encoding) = relay_api_get_encoding_websocket (
+        client->http_req);
+
+    free (client->http_req->ws_protocol);
+    client->http_req->ws_protocol =
+        (RELAY_API_DATA(client, encoding) == RELAY_API_ENCODING_CBOR) ?
+        strdup (RELAY_API_CBOR_WS_PROTOCOL) : NULL;
+}
+
+/*
+ * Hooks timer to send nicklist changes (event "nicklist_diff").
+ */
+
+void
+relay_api_hook_timer_nicklist (struct t_relay_client *client)
+{
+    RELAY_API_DATA(client, hook_timer_nicklist) =
+        weechat_hook_timer (100, 0, 1,
+                            &relay_api_protocol_timer_nicklist_cb,
+                            client, NULL);
+}
+
+/*
+ * Unhooks timer to send nicklist changes and discards the changes not yet
+ * sent.
+ */
+
+void
+relay_api_unhook_timer_nicklist (struct t_relay_client *client)
+{
+    if (RELAY_API_DATA(client, hook_timer_nicklist))
+    {
+        weechat_unhook (RELAY_API_DATA(client, hook_timer_nicklist));
+        RELAY_API_DATA(client, hook_timer_nicklist) = NULL;
+    }
+    weechat_hashtable_remove_all (RELAY_API_DATA(client, nicklist_diff));
+}
+
 /*
  * Hooks signals for a client.
  */
@@ -120,6 +255,13 @@ relay_api_hook_signals (struct t_relay_client *client)
             weechat_unhook (RELAY_API_DATA(client, hook_hsignal_nicklist));
             RELAY_API_DATA(client, hook_hsignal_nicklist) = NULL;
         }
+        relay_api_unhook_timer_nicklist (client);
+    }
+    if (!RELAY_API_DATA(client, sync_nicklist_diff))
+    {
+        /* nicklist changes are now sent immediately: flush pending changes */
+        relay_api_protocol_send_nicklist_diff_all (client);
+        relay_api_unhook_timer_nicklist (client);
     }
     if (RELAY_API_DATA(client, sync_input))
     {
@@ -167,6 +309,7 @@ relay_api_unhook_signals (struct t_relay_client *client)
         weechat_unhook (RELAY_API_DATA(client, hook_hsignal_nicklist));
         RELAY_API_DATA(client, hook_hsignal_nicklist) = NULL;
     }
+    relay_api_unhook_timer_nicklist (client);
     if (RELAY_API_DATA(client, hook_signal_input))
     {
         weechat_unhook (RELAY_API_DATA(client, hook_signal_input));
@@ -216,6 +359,21 @@ relay_api_close_connection (struct t_relay_client *client)
     relay_api_unhook_signals (client);
 }
 
+/*
+ * Frees a value of hashtable "nicklist_diff".
+ */
+
+void
+relay_api_free_nicklist_diff (struct t_hashtable *hashtable,
+                              const void *key, void *value)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    cJSON_Delete ((cJSON *)value);
+}
+
 /*
  * Initializes relay data specific to API protocol.
  */
@@ -237,10 +395,23 @@ relay_api_alloc (struct t_relay_client *client)
         WEECHAT_HASHTABLE_STRING,
         NULL,
         NULL);
+    RELAY_API_DATA(client, nicklist_diff) = weechat_hashtable_new (
+        32,
+        WEECHAT_HASHTABLE_POINTER,
+        WEECHAT_HASHTABLE_POINTER,
+        NULL,
+        NULL);
+    weechat_hashtable_set_pointer (RELAY_API_DATA(client, nicklist_diff),
+                                   "callback_free_value",
+                                   &relay_api_free_nicklist_diff);
+    RELAY_API_DATA(client, hook_timer_nicklist) = NULL;
     RELAY_API_DATA(client, sync_enabled) = 0;
     RELAY_API_DATA(client, sync_nicks) = 0;
+    RELAY_API_DATA(client, sync_nicklist_diff) = 0;
     RELAY_API_DATA(client, sync_input) = 0;
     RELAY_API_DATA(client, sync_colors) = RELAY_API_COLORS_ANSI;
+    RELAY_API_DATA(client, encoding) = RELAY_API_ENCODING_JSON;
+    RELAY_API_DATA(client, batch_responses) = NULL;
 }
 
 /*
@@ -267,14 +438,29 @@ relay_api_alloc_with_infolist (struct t_relay_client *client,
         WEECHAT_HASHTABLE_STRING,
         NULL,
         NULL);
+    RELAY_API_DATA(client, nicklist_diff) = weechat_hashtable_new (
+        32,
+        WEECHAT_HASHTABLE_POINTER,
+        WEECHAT_HASHTABLE_POINTER,
+        NULL,
+        NULL);
+    weechat_hashtable_set_pointer (RELAY_API_DATA(client, nicklist_diff),
+                                   "callback_free_value",
+                                   &relay_api_free_nicklist_diff);
+    RELAY_API_DATA(client, hook_timer_nicklist) = NULL;
     RELAY_API_DATA(client, sync_enabled) = weechat_infolist_integer (
         infolist, "sync_enabled");
     RELAY_API_DATA(client, sync_nicks) = weechat_infolist_integer (
         infolist, "sync_nicks");
+    RELAY_API_DATA(client, sync_nicklist_diff) = weechat_infolist_integer (
+        infolist, "sync_nicklist_diff");
     RELAY_API_DATA(client, sync_input) = weechat_infolist_integer (
         infolist, "sync_input");
     RELAY_API_DATA(client, sync_colors) = weechat_infolist_integer (
         infolist, "sync_colors");
+    RELAY_API_DATA(client, encoding) = weechat_infolist_integer (
+        infolist, "encoding");
+    RELAY_API_DATA(client, batch_responses) = NULL;
 
     if (!RELAY_STATUS_HAS_ENDED(client->status)
         && RELAY_API_DATA(client, sync_enabled))
@@ -314,6 +500,8 @@ relay_api_free (struct t_relay_client *client)
         weechat_unhook (RELAY_API_DATA(client, hook_signal_input));
         weechat_unhook (RELAY_API_DATA(client, hook_signal_upgrade));
         weechat_hashtable_free (RELAY_API_DATA(client, buffers_closing));
+        weechat_hashtable_free (RELAY_API_DATA(client, nicklist_diff));
+        weechat_unhook (RELAY_API_DATA(client, hook_timer_nicklist));
 
         free (client->protocol_data);
 
@@ -352,14 +540,20 @@ relay_api_add_to_infolist (struct t_infolist_item *item,
         return 0;
     if (!weechat_infolist_new_var_pointer (item, "hook_signal_upgrade", RELAY_API_DATA(client, hook_signal_upgrade)))
         return 0;
+    if (!weechat_infolist_new_var_pointer (item, "hook_timer_nicklist", RELAY_API_DATA(client, hook_timer_nicklist)))
+        return 0;
     if (!weechat_infolist_new_var_integer (item, "sync_enabled", RELAY_API_DATA(client, sync_enabled)))
         return 0;
     if (!weechat_infolist_new_var_integer (item, "sync_nicks", RELAY_API_DATA(client, sync_nicks)))
         return 0;
+    if (!weechat_infolist_new_var_integer (item, "sync_nicklist_diff", RELAY_API_DATA(client, sync_nicklist_diff)))
+        return 0;
     if (!weechat_infolist_new_var_integer (item, "sync_input", RELAY_API_DATA(client, sync_input)))
         return 0;
     if (!weechat_infolist_new_var_integer (item, "sync_colors", RELAY_API_DATA(client, sync_colors)))
         return 0;
+    if (!weechat_infolist_new_var_integer (item, "encoding", RELAY_API_DATA(client, encoding)))
+        return 0;
 
     return 1;
 }
@@ -382,9 +576,20 @@ relay_api_print_log (struct t_relay_client *client)
                             weechat_hashtable_get_string (
                                 RELAY_API_DATA(client, buffers_closing),
                                 "keys_values"));
+        weechat_log_printf ("    nicklist_diff . . . . . : %p (hashtable: '%s')",
+                            RELAY_API_DATA(client, nicklist_diff),
+                            weechat_hashtable_get_string (
+                                RELAY_API_DATA(client, nicklist_diff),
+                                "keys_values"));
+        weechat_log_printf ("    hook_timer_nicklist . . : %p", RELAY_API_DATA(client, hook_timer_nicklist));
         weechat_log_printf ("    sync_enabled. . . . . . : %d", RELAY_API_DATA(client, sync_enabled));
         weechat_log_printf ("    sync_nicks. . . . . . . : %d", RELAY_API_DATA(client, sync_nicks));
+        weechat_log_printf ("    sync_nicklist_diff. . . : %d", RELAY_API_DATA(client, sync_nicklist_diff));
         weechat_log_printf ("    sync_input. . . . . . . : %d", RELAY_API_DATA(client, sync_input));
         weechat_log_printf ("    sync_colors . . . . . . : %d", RELAY_API_DATA(client, sync_colors));
+        weechat_log_printf ("    encoding. . . . . . . . : %d (%s)",
+                            RELAY_API_DATA(client, encoding),
+                            relay_api_encoding_string[RELAY_API_DATA(client, encoding)]);
+        weechat_log_printf ("    batch_responses . . . . : %p", RELAY_API_DATA(client, batch_responses));
     }
 }
@@ -21,6 +21,8 @@
 #define WEECHAT_PLUGIN_RELAY_API_H
 
 struct t_relay_client;
+struct t_relay_http_request;
+struct cJSON;
 enum t_relay_status;
 
 #define RELAY_API_VERSION_MAJOR 0
@@ -42,6 +44,9 @@ enum t_relay_status;
 
 #define RELAY_API_HTTP_0_EVENT 0, "Event"
 
+#define RELAY_API_CBOR_CONTENT_TYPE "application/cbor"
+#define RELAY_API_CBOR_WS_PROTOCOL "cbor"
+
 enum t_relay_api_colors
 {
     RELAY_API_COLORS_ANSI = 0,         /* convert colors to ANSI colors     */
@@ -51,6 +56,14 @@ enum t_relay_api_colors
     RELAY_API_NUM_COLORS,
 };
 
+enum t_relay_api_encoding
+{
+    RELAY_API_ENCODING_JSON = 0,       /* JSON (default)                    */
+    RELAY_API_ENCODING_CBOR,           /* CBOR (binary, RFC 8949)           */
+    /* number of encodings */
+    RELAY_API_NUM_ENCODINGS,
+};
+
 struct t_relay_api_data
 {
     struct t_hook *hook_signal_buffer;    /* hook for signals "buffer_*"    */
@@ -59,15 +72,32 @@ struct t_relay_api_data
                                           /* "input_text_changed"           */
     struct t_hook *hook_signal_upgrade;   /* hook for signals "upgrade*"    */
     struct t_hashtable *buffers_closing;  /* ptr -> "id" of buffers closing */
+    struct t_hashtable *nicklist_diff;    /* ptr -> JSON array with nicklist*/
+                                          /* changes not yet sent           */
+    struct t_hook *hook_timer_nicklist;   /* timer for sending nicklist diff*/
     int sync_enabled;                     /* 1 if sync is enabled           */
     int sync_nicks;                       /* 1 if nicks are synchronized    */
+    int sync_nicklist_diff;               /* 1 if nicklist changes are sent */
+                                          /* in event "nicklist_diff"       */
     int sync_input;                       /* 1 if input is synchronized     */
                                           /* (WeeChat -> client)            */
     enum t_relay_api_colors sync_colors;  /* colors to send with sync       */
+    enum t_relay_api_encoding encoding;   /* encoding of websocket messages */
+                                          /* sent to client                 */
+    struct cJSON *batch_responses;        /* responses of sub-requests,     */
+                                          /* during a batch request         */
 };
 
+extern char *relay_api_encoding_string[];
+
 extern long long relay_api_get_buffer_id (struct t_gui_buffer *buffer);
 extern enum t_relay_api_colors relay_api_search_colors (const char *colors);
+extern int relay_api_header_list_has_value (const char *list, const char *value);
+extern enum t_relay_api_encoding relay_api_get_encoding_http (struct t_relay_http_request *request);
+extern enum t_relay_api_encoding relay_api_get_encoding_websocket (struct t_relay_http_request *request);
+extern void relay_api_websocket_set_encoding (struct t_relay_client *client);
+extern void relay_api_hook_timer_nicklist (struct t_relay_client *client);
+extern void relay_api_unhook_timer_nicklist (struct t_relay_client *client);
 extern void relay_api_hook_signals (struct t_relay_client *client);
 extern void relay_api_unhook_signals (struct t_relay_client *client);
 extern void relay_api_recv_http (struct t_relay_client *client);
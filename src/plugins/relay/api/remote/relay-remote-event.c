@@ -304,6 +304,57 @@ relay_remote_event_search_line_by_id (struct t_gui_buffer *buffer, int id)
     return NULL;
 }
 
+/*
+ * Gets id of last line received from remote in a buffer (tag
+ * "relay_remote_line_id_123456", where 123456 is the line id).
+ *
+ * Returns id of last line, -1 if not found.
+ */
+
+int
+relay_remote_event_get_last_line_id (struct t_gui_buffer *buffer)
+{
+    struct t_gui_lines *ptr_lines;
+    struct t_gui_line *ptr_line;
+    struct t_gui_line_data *ptr_line_data;
+    const char **tags;
+    char *error;
+    long number;
+    int i;
+
+    if (!buffer)
+        return -1;
+
+    ptr_lines = weechat_hdata_pointer (relay_hdata_buffer, buffer, "own_lines");
+    if (!ptr_lines)
+        return -1;
+
+    ptr_line = weechat_hdata_pointer (relay_hdata_lines, ptr_lines, "last_line");
+    if (!ptr_line)
+        return -1;
+
+    ptr_line_data = weechat_hdata_pointer (relay_hdata_line, ptr_line, "data");
+    if (!ptr_line_data)
+        return -1;
+
+    tags = weechat_hdata_pointer (relay_hdata_line_data, ptr_line_data, "tags_array");
+    if (!tags)
+        return -1;
+
+    for (i = 0; tags[i]; i++)
+    {
+        if (strncmp (tags[i], "relay_remote_line_id_", 21) == 0)
+        {
+            error = NULL;
+            number = strtol (tags[i] + 21, &error, 10);
+            if (error && !error[0] && (number >= 0))
+                return (int)number;
+        }
+    }
+
+    return -1;
+}
+
 /*
  * Updates a line in a buffer.
  */
@@ -596,21 +647,33 @@ RELAY_REMOTE_EVENT_CALLBACK(nick)
 }
 
 /*
- * Applies properties to a buffer.
+ * Callback for a nicklist diff event (one item of the array).
  */
 
-void
-relay_remote_event_apply_props (void *data,
-                                struct t_hashtable *hashtable,
-                                const void *key,
-                                const void *value)
+RELAY_REMOTE_EVENT_CALLBACK(nicklist_diff)
 {
-    /* make C compiler happy */
-    (void) hashtable;
+    struct t_relay_remote_event event_item;
+    const char *event_name;
+    cJSON *json_obj;
+
+    if (!event->buffer || !event->json)
+        return WEECHAT_RC_OK;
+
+    JSON_GET_STR(event->json, event_name);
+    if (!event_name)
+        return WEECHAT_RC_OK;
 
-    weechat_buffer_set ((struct t_gui_buffer *)data,
-                        (const char *)key,
-                        (const char *)value);
+    event_item.remote = event->remote;
+    event_item.name = event_name;
+    event_item.buffer = event->buffer;
+    event_item.json = cJSON_GetObjectItem (event->json, "body");
+
+    if (strncmp (event_name, "nicklist_group_", 15) == 0)
+        return relay_remote_event_cb_nick_group (&event_item);
+    if (strncmp (event_name, "nicklist_nick_", 14) == 0)
+        return relay_remote_event_cb_nick (&event_item);
+
+    return WEECHAT_RC_OK;
 }
 
 /*
@@ -741,13 +804,14 @@ RELAY_REMOTE_EVENT_CALLBACK(buffer)
     struct t_hashtable *local_variables;
     cJSON *json_obj, *json_keys, *json_key, *json_key_name, *json_key_command;
     cJSON *json_vars, *json_var, *json_lines, *json_line, *json_nicklist_root;
+    cJSON *json_line_start, *json_line_id;
     void *pointers[2];
     const char *name, *short_name, *type, *title, *modes, *input_prompt, *input;
     const char *ptr_key, *ptr_command;
     char *full_name, str_number[64], str_local_var[1024], *property;
     long long id;
     int number, nicklist, nicklist_case_sensitive, nicklist_display_groups;
-    int apply_props, input_position, input_multiline;
+    int apply_props, input_position, input_multiline, last_line_id;
 
     if (!event->json)
         return WEECHAT_RC_OK;
@@ -835,8 +899,7 @@ RELAY_REMOTE_EVENT_CALLBACK(buffer)
 
     if (apply_props)
     {
-        weechat_hashtable_map (buffer_props,
-                               &relay_remote_event_apply_props, ptr_buffer);
+        weechat_buffer_set_multiple (ptr_buffer, buffer_props);
     }
 
     json_vars = cJSON_GetObjectItem (event->json, "local_variables");
@@ -910,14 +973,40 @@ RELAY_REMOTE_EVENT_CALLBACK(buffer)
     json_lines = cJSON_GetObjectItem (event->json, "lines");
     if (json_lines && cJSON_IsArray (json_lines))
     {
+        json_line_start = json_lines->child;
+        if (apply_props && (weechat_strcmp (type, "free") != 0))
+        {
+            /*
+             * buffer already exists (reconnection to remote): resume after
+             * the last line received, if this line is still on remote
+             * (lines are added only if they are not in the buffer)
+             */
+            last_line_id = relay_remote_event_get_last_line_id (ptr_buffer);
+            if (last_line_id >= 0)
+            {
+                cJSON_ArrayForEach (json_line, json_lines)
+                {
+                    json_line_id = cJSON_GetObjectItem (json_line, "id");
+                    if (json_line_id && cJSON_IsNumber (json_line_id)
+                        && ((int)cJSON_GetNumberValue (json_line_id) == last_line_id))
+                    {
+                        json_line_start = json_line->next;
+                        break;
+                    }
+                }
+            }
+        }
         event_line.name = "buffer_line_added";
         event_line.remote = event->remote;
         event_line.buffer = ptr_buffer;
-        cJSON_ArrayForEach (json_line, json_lines)
+        weechat_printf_lines_begin (ptr_buffer);
+        for (json_line = json_line_start; json_line;
+             json_line = json_line->next)
         {
             event_line.json = json_line;
             relay_remote_event_cb_line (&event_line);
         }
+        weechat_printf_lines_end (ptr_buffer);
     }
 
     /* add nicklist groups and nicks */
@@ -977,6 +1066,83 @@ RELAY_REMOTE_EVENT_CALLBACK(input)
     return WEECHAT_RC_OK;
 }
 
+/*
+ * Removes hotlist of all buffers of a remote.
+ */
+
+void
+relay_remote_event_hotlist_clear (struct t_relay_remote *remote)
+{
+    struct t_gui_buffer *ptr_buffer;
+
+    if (!remote)
+        return;
+
+    ptr_buffer = weechat_hdata_get_list (relay_hdata_buffer, "gui_buffers");
+    while (ptr_buffer)
+    {
+        if (weechat_strcmp (
+                weechat_buffer_get_string (ptr_buffer, "localvar_relay_remote"),
+                remote->name) == 0)
+        {
+            weechat_buffer_set (ptr_buffer, "hotlist", "-1");
+        }
+        ptr_buffer = weechat_hdata_move (relay_hdata_buffer, ptr_buffer, 1);
+    }
+}
+
+/*
+ * Callback for a hotlist entry (response to GET /api/hotlist): the buffer is
+ * added to local hotlist with the same number of messages for each priority.
+ */
+
+RELAY_REMOTE_EVENT_CALLBACK(hotlist)
+{
+    cJSON *json_obj, *json_count, *json_count_item;
+    struct t_gui_buffer *ptr_buffer;
+    char str_value[64];
+    long long buffer_id;
+    int priority, i, count, added;
+
+    if (!event->json)
+        return WEECHAT_RC_OK;
+
+    JSON_GET_NUM(event->json, buffer_id, -1);
+    JSON_GET_NUM(event->json, priority, -1);
+
+    ptr_buffer = relay_remote_event_search_buffer (event->remote, buffer_id);
+    if (!ptr_buffer)
+        return WEECHAT_RC_OK;
+
+    weechat_buffer_set (ptr_buffer, "hotlist", "-1");
+
+    added = 0;
+    json_count = cJSON_GetObjectItem (event->json, "count");
+    if (json_count && cJSON_IsArray (json_count))
+    {
+        i = 0;
+        cJSON_ArrayForEach (json_count_item, json_count)
+        {
+            count = (cJSON_IsNumber (json_count_item)) ?
+                cJSON_GetNumberValue (json_count_item) : 0;
+            if (count > 0)
+            {
+                snprintf (str_value, sizeof (str_value), "%d,%d", i, count);
+                weechat_buffer_set (ptr_buffer, "hotlist", str_value);
+                added = 1;
+            }
+            i++;
+        }
+    }
+    if (!added && (priority >= 0))
+    {
+        snprintf (str_value, sizeof (str_value), "%d", priority);
+        weechat_buffer_set (ptr_buffer, "hotlist", str_value);
+    }
+
+    return WEECHAT_RC_OK;
+}
+
 /*
  * Callback for response to GET /api/version.
  */
@@ -1046,10 +1212,17 @@ void
 relay_remote_event_sync_with_remote (struct t_relay_remote *remote)
 {
     cJSON *json, *json_body;
+    char request[1024];
 
     if (!remote)
         return;
 
+    /* get hotlist of remote (history lines are not added in hotlist) */
+    snprintf (request, sizeof (request),
+              "{\"request\": \"GET /api/hotlist\"}");
+    relay_remote_network_send (remote, RELAY_MSG_STANDARD,
+                               request, strlen (request));
+
     json = cJSON_CreateObject ();
     if (!json)
         goto end;
@@ -1060,6 +1233,7 @@ relay_remote_event_sync_with_remote (struct t_relay_remote *remote)
     if (!json_body)
         goto end;
 
+    cJSON_AddItemToObject (json_body, "nicklist_diff", cJSON_CreateBool (1));
     cJSON_AddItemToObject (json_body, "colors",
                            cJSON_CreateString ("weechat"));
     cJSON_AddItemToObject (json, "body", json_body);
@@ -1072,6 +1246,117 @@ end:
     cJSON_Delete (json);
 }
 
+/*
+ * Stops the creation of buffers received from remote (if in progress).
+ */
+
+void
+relay_remote_event_sync_buffers_stop (struct t_relay_remote *remote)
+{
+    if (!remote)
+        return;
+
+    if (remote->hook_timer_sync)
+    {
+        weechat_unhook (remote->hook_timer_sync);
+        remote->hook_timer_sync = NULL;
+    }
+    if (remote->sync_buffers)
+    {
+        cJSON_Delete ((cJSON *)remote->sync_buffers);
+        remote->sync_buffers = NULL;
+    }
+    remote->sync_buffers_next = NULL;
+}
+
+/*
+ * Callback for timer used to create next buffers received from remote.
+ */
+
+int
+relay_remote_event_sync_buffers_timer_cb (const void *pointer, void *data,
+                                          int remaining_calls)
+{
+    struct t_relay_remote *remote;
+
+    /* make C compiler happy */
+    (void) data;
+    (void) remaining_calls;
+
+    remote = (struct t_relay_remote *)pointer;
+    if (!relay_remote_valid (remote))
+        return WEECHAT_RC_OK;
+
+    /* the timer is called only one time */
+    remote->hook_timer_sync = NULL;
+
+    relay_remote_event_sync_buffers (remote);
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Creates (or updates) buffers received from remote in response to
+ * GET /api/buffers, during at most RELAY_REMOTE_EVENT_SYNC_MAX_TIME
+ * milliseconds: the next buffers are created later with a timer, so that
+ * WeeChat remains responsive when there are many buffers on remote.
+ *
+ * When all buffers have been created, a sync with remote is requested.
+ */
+
+void
+relay_remote_event_sync_buffers (struct t_relay_remote *remote)
+{
+    struct t_relay_remote_event event;
+    struct timeval tv_start, tv_now;
+    cJSON *json_buffer;
+
+    if (!remote || !remote->sync_buffers)
+        return;
+
+    event.remote = remote;
+    event.name = NULL;
+
+    gettimeofday (&tv_start, NULL);
+
+    /* lines received with buffers are history: hotlist is set later */
+    weechat_buffer_set (NULL, "hotlist", "-");
+
+    json_buffer = (cJSON *)remote->sync_buffers_next;
+    while (json_buffer)
+    {
+        event.buffer = NULL;
+        event.json = json_buffer;
+        (void) relay_remote_event_cb_buffer (&event);
+        json_buffer = json_buffer->next;
+        remote->sync_buffers_next = json_buffer;
+        if (!json_buffer)
+            break;
+        gettimeofday (&tv_now, NULL);
+        if (weechat_util_timeval_diff (&tv_start, &tv_now)
+            >= RELAY_REMOTE_EVENT_SYNC_MAX_TIME * 1000)
+        {
+            /* create next buffers later */
+            if (!remote->hook_timer_sync)
+            {
+                remote->hook_timer_sync = weechat_hook_timer (
+                    1, 0, 1,
+                    &relay_remote_event_sync_buffers_timer_cb,
+                    remote, NULL);
+            }
+            weechat_buffer_set (NULL, "hotlist", "+");
+            return;
+        }
+    }
+
+    weechat_buffer_set (NULL, "hotlist", "+");
+
+    relay_remote_event_sync_buffers_stop (remote);
+
+    if (!remote->synced)
+        relay_remote_event_sync_with_remote (remote);
+}
+
 /*
  * Reads an event from a remote.
  */
@@ -1092,6 +1377,7 @@ relay_remote_event_recv (struct t_relay_remote *remote, const char *data)
         { "buffer_closed", &relay_remote_event_cb_buffer_closed },
         { "buffer_*", &relay_remote_event_cb_buffer },
         { "input_*", &relay_remote_event_cb_input },
+        { "nicklist_diff", &relay_remote_event_cb_nicklist_diff },
         { "nicklist_group_*", &relay_remote_event_cb_nick_group },
         { "nicklist_nick_*", &relay_remote_event_cb_nick },
         { NULL, NULL },
@@ -1124,7 +1410,20 @@ relay_remote_event_recv (struct t_relay_remote *remote, const char *data)
     json_body = cJSON_GetObjectItem (json, "body");
 
     if (!body_type && ((code == 200) || (code == 204)))
-        return;
+        goto end;
+
+    if (!remote->synced
+        && (code == 200)
+        && (weechat_strcmp (body_type, "buffer") == 0)
+        && cJSON_IsArray (json_body))
+    {
+        /* buffers are created progressively, then sync with remote */
+        relay_remote_event_sync_buffers_stop (remote);
+        remote->sync_buffers = cJSON_DetachItemViaPointer (json, json_body);
+        remote->sync_buffers_next = (json_body) ? json_body->child : NULL;
+        relay_remote_event_sync_buffers (remote);
+        goto end;
+    }
 
     JSON_GET_STR(json, event_name);
     event.name = event_name;
@@ -1136,9 +1435,18 @@ relay_remote_event_recv (struct t_relay_remote *remote, const char *data)
     if (code == 200)
     {
         if (weechat_strcmp (body_type, "buffer") == 0)
+        {
             callback = &relay_remote_event_cb_buffer;
+        }
+        else if (weechat_strcmp (body_type, "hotlist") == 0)
+        {
+            relay_remote_event_hotlist_clear (remote);
+            callback = &relay_remote_event_cb_hotlist;
+        }
         else if (weechat_strcmp (body_type, "version") == 0)
+        {
             callback = &relay_remote_event_cb_version;
+        }
     }
     else if (event.name)
     {
@@ -1179,6 +1487,8 @@ relay_remote_event_recv (struct t_relay_remote *remote, const char *data)
         relay_remote_event_sync_with_remote (remote);
     }
 
+end:
+    cJSON_Delete (json);
     return;
 
 error_data:
@@ -1197,5 +1507,6 @@ error_cb:
         weechat_prefix ("error"),
         remote->name,
         body_type);
+    cJSON_Delete (json);
     return;
 }
@@ -20,6 +20,9 @@
 #ifndef WEECHAT_PLUGIN_RELAY_REMOTE_EVENT_H
 #define WEECHAT_PLUGIN_RELAY_REMOTE_EVENT_H
 
+/* max time (in milliseconds) to create remote buffers in one call */
+#define RELAY_REMOTE_EVENT_SYNC_MAX_TIME 50
+
 #define RELAY_REMOTE_EVENT_CALLBACK(__body_type)                        \
     int                                                                 \
     relay_remote_event_cb_##__body_type (                               \
@@ -41,6 +44,8 @@ struct t_relay_remote_event_cb
     t_relay_remote_event_func *func;    /* callback (can be NULL)           */
 };
 
+extern void relay_remote_event_sync_buffers_stop (struct t_relay_remote *remote);
+extern void relay_remote_event_sync_buffers (struct t_relay_remote *remote);
 extern void relay_remote_event_recv (struct t_relay_remote *remote,
                                      const char *data);
 
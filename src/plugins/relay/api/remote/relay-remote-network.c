@@ -105,6 +105,7 @@ relay_remote_network_close_connection (struct t_relay_remote *remote)
         remote->sock = -1;
     }
     relay_websocket_deflate_reinit (remote->ws_deflate);
+    relay_remote_event_sync_buffers_stop (remote);
     remote->version_ok = 0;
     remote->synced = 0;
     if (remote->partial_ws_frame)
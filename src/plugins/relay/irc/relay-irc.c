@@ -708,6 +708,7 @@ relay_irc_get_line_info (struct t_relay_client *client,
 {
     int i, num_tags, command, action, all_tags, length;
     char str_tag[512], *pos, *message_no_color, str_time[256];
+    const char **ptr_tags;
     const char *ptr_tag, *ptr_message, *ptr_nick, *ptr_nick1, *ptr_nick2;
     const char *ptr_host, *localvar_nick, *time_format;
     time_t msg_date;
@@ -735,10 +736,12 @@ relay_irc_get_line_info (struct t_relay_client *client,
     msg_date = weechat_hdata_time (relay_hdata_line_data, line_data, "date");
     num_tags = weechat_hdata_get_var_array_size (relay_hdata_line_data, line_data,
                                                  "tags_array");
+    ptr_tags = weechat_hdata_pointer (relay_hdata_line_data, line_data,
+                                      "tags_array");
     ptr_message = weechat_hdata_pointer (relay_hdata_line_data, line_data, "message");
 
     /* no tag found, or no message? just exit */
-    if ((num_tags <= 0) || !ptr_message)
+    if ((num_tags <= 0) || !ptr_tags || !ptr_message)
         return;
 
     command = -1;
@@ -751,8 +754,7 @@ relay_irc_get_line_info (struct t_relay_client *client,
                                           "*");
     for (i = 0; i < num_tags; i++)
     {
-        snprintf (str_tag, sizeof (str_tag), "%d|tags_array", i);
-        ptr_tag = weechat_hdata_string (relay_hdata_line_data, line_data, str_tag);
+        ptr_tag = ptr_tags[i];
         if (ptr_tag)
         {
             if (strcmp (ptr_tag, "irc_action") == 0)
@@ -806,10 +808,11 @@ relay_irc_get_line_info (struct t_relay_client *client,
         *nick2 = ptr_nick2;
     if (host)
         *host = ptr_host;
-    message_no_color = (ptr_message) ?
+    /* colors are removed only if the message is asked */
+    message_no_color = ((command == RELAY_IRC_CMD_PRIVMSG) && message) ?
         weechat_string_remove_color (ptr_message, NULL) : NULL;
 
-    if ((command == RELAY_IRC_CMD_PRIVMSG) && message && message_no_color)
+    if (message_no_color)
     {
         pos = message_no_color;
         if (action)
@@ -972,8 +975,9 @@ relay_irc_send_channel_backlog (struct t_relay_client *client,
 
     /*
      * loop on lines from line pointer until last line of buffer, and for each
-     * irc message, sends it to client
+     * irc message, sends it to client (messages are sent by batch)
      */
+    relay_client_send_batch_start (client);
     while (ptr_line)
     {
         ptr_line_data = weechat_hdata_pointer (relay_hdata_line,
@@ -1053,6 +1057,7 @@ relay_irc_send_channel_backlog (struct t_relay_client *client,
         }
         ptr_line = weechat_hdata_move (relay_hdata_line, ptr_line, 1);
     }
+    relay_client_send_batch_end (client);
 }
 
 /*
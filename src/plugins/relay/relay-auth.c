@@ -41,6 +41,12 @@
 char *relay_auth_password_hash_algo_name[RELAY_NUM_PASSWORD_HASH_ALGOS] =
 { "plain", "sha256", "sha512", "pbkdf2+sha256", "pbkdf2+sha512" };
 
+/*
+ * passwords verified recently: hash of credentials + relay password -> time
+ * of verification (see option relay.network.auth_cache_ttl)
+ */
+struct t_hashtable *relay_auth_cache = NULL;
+
 
 /*
  * Searches for a password hash algorithm.
@@ -559,3 +565,132 @@ end:
 
     return rc;
 }
+
+/*
+ * Builds the key used in the cache of passwords verified recently: SHA256 of
+ * the credentials received and the relay password (as hexadecimal), so that
+ * no password is stored as-is and a change of the relay password
+ * invalidates the cache.
+ *
+ * Returns:
+ *   1: OK (key is set in "key")
+ *   0: error
+ */
+
+int
+relay_auth_cache_build_key (const char *credentials,
+                            const char *relay_password,
+                            char *key)
+{
+    char *data, hash[256 / 8];
+    int rc, length, hash_size;
+
+    if (!credentials || !relay_password || !key)
+        return 0;
+
+    length = weechat_asprintf (&data, "%s\n%s", credentials, relay_password);
+    if (length < 0)
+        return 0;
+
+    rc = 0;
+    if (weechat_crypto_hash (data, length, "sha256", hash, &hash_size))
+    {
+        weechat_string_base_encode ("16", hash, hash_size, key);
+        rc = 1;
+    }
+
+    free (data);
+
+    return rc;
+}
+
+/*
+ * Searches if credentials have been verified recently with this relay
+ * password (less than relay.network.auth_cache_ttl seconds ago); expired
+ * entries are removed from the cache.
+ *
+ * Returns:
+ *   1: credentials verified recently
+ *   0: credentials not verified recently (they must be checked)
+ */
+
+int
+relay_auth_cache_search (const char *credentials, const char *relay_password)
+{
+    char key[((256 / 8) * 2) + 1];
+    time_t *ptr_time;
+    int ttl;
+
+    if (!relay_auth_cache)
+        return 0;
+
+    ttl = weechat_config_integer (relay_config_network_auth_cache_ttl);
+    if (ttl <= 0)
+        return 0;
+
+    if (!relay_auth_cache_build_key (credentials, relay_password, key))
+        return 0;
+
+    ptr_time = weechat_hashtable_get (relay_auth_cache, key);
+    if (!ptr_time)
+        return 0;
+
+    if (time (NULL) - *ptr_time >= ttl)
+    {
+        weechat_hashtable_remove (relay_auth_cache, key);
+        return 0;
+    }
+
+    return 1;
+}
+
+/*
+ * Adds credentials successfully verified with this relay password in the
+ * cache (only if relay.network.auth_cache_ttl is greater than 0).
+ *
+ * The cache is cleared if it is full (entries are short-lived anyway).
+ */
+
+void
+relay_auth_cache_add (const char *credentials, const char *relay_password)
+{
+    char key[((256 / 8) * 2) + 1];
+    time_t time_now;
+
+    if (weechat_config_integer (relay_config_network_auth_cache_ttl) <= 0)
+        return;
+
+    if (!relay_auth_cache)
+    {
+        relay_auth_cache = weechat_hashtable_new (
+            32,
+            WEECHAT_HASHTABLE_STRING,
+            WEECHAT_HASHTABLE_TIME,
+            NULL, NULL);
+        if (!relay_auth_cache)
+            return;
+    }
+
+    if (!relay_auth_cache_build_key (credentials, relay_password, key))
+        return;
+
+    if (weechat_hashtable_get_integer (relay_auth_cache, "items_count")
+        >= RELAY_AUTH_CACHE_MAX_SIZE)
+    {
+        weechat_hashtable_remove_all (relay_auth_cache);
+    }
+
+    time_now = time (NULL);
+    weechat_hashtable_set (relay_auth_cache, key, &time_now);
+}
+
+/*
+ * Frees the cache of passwords verified recently.
+ */
+
+void
+relay_auth_cache_free ()
+{
+    weechat_hashtable_free (relay_auth_cache);
+    relay_auth_cache = NULL;
+}
@@ -22,6 +22,9 @@
 
 struct t_relay_client;
 
+/* max number of passwords in the cache of passwords verified recently */
+#define RELAY_AUTH_CACHE_MAX_SIZE 256
+
 enum t_relay_auth_password_hash_algo
 {
     RELAY_AUTH_PASSWORD_HASH_PLAIN = 0,
@@ -34,6 +37,7 @@ enum t_relay_auth_password_hash_algo
 };
 
 extern char *relay_auth_password_hash_algo_name[];
+extern struct t_hashtable *relay_auth_cache;
 
 extern int relay_auth_password_hash_algo_search (const char *name);
 extern char *relay_auth_generate_nonce (int size);
@@ -65,5 +69,10 @@ extern int relay_auth_check_hash_pbkdf2 (const char *hash_pbkdf2_algo,
 extern int relay_auth_password_hash (struct t_relay_client *client,
                                      const char *hashed_password,
                                      const char *relay_password);
+extern int relay_auth_cache_search (const char *credentials,
+                                    const char *relay_password);
+extern void relay_auth_cache_add (const char *credentials,
+                                  const char *relay_password);
+extern void relay_auth_cache_free ();
 
 #endif /* WEECHAT_PLUGIN_RELAY_AUTH_H */
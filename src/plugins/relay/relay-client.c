@@ -28,6 +28,7 @@
 #include <errno.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <gnutls/gnutls.h>
 #include <zlib.h>
 
@@ -41,12 +42,15 @@
 #include "relay-network.h"
 #include "relay-raw.h"
 #include "relay-server.h"
+#include "relay-tls-thread.h"
 #include "relay-websocket.h"
 #ifdef HAVE_CJSON
 #include "api/relay-api.h"
+#include "api/relay-api-protocol.h"
 #endif
 #include "irc/relay-irc.h"
 #include "weechat/relay-weechat.h"
+#include "weechat/relay-weechat-protocol.h"
 
 
 char *relay_client_data_type_string[] = /* strings for data types           */
@@ -55,6 +59,7 @@ char *relay_client_data_type_string[] = /* strings for data types           */
 struct t_relay_client *relay_clients = NULL;
 struct t_relay_client *last_relay_client = NULL;
 int relay_client_count = 0;            /* number of clients                 */
+unsigned long long relay_client_outqueue_size_total = 0; /* all outqueues */
 
 
 /*
@@ -197,6 +202,33 @@ relay_client_set_desc (struct t_relay_client *client)
     client->desc = strdup (desc);
 }
 
+/*
+ * Checks if compression of messages sent to a client is allowed: it is
+ * not allowed for a client connected on a UNIX domain socket if option
+ * relay.network.compression_unix_socket is off.
+ *
+ * Note: option relay.network.compression is not checked by this function.
+ *
+ * Returns:
+ *   1: compression allowed
+ *   0: compression not allowed
+ */
+
+int
+relay_client_compression_allowed (struct t_relay_client *client)
+{
+    if (!client)
+        return 0;
+
+    if (client->unix_socket
+        && !weechat_config_boolean (relay_config_network_compression_unix_socket))
+    {
+        return 0;
+    }
+
+    return 1;
+}
+
 /*
  * Timer callback for handshake with client (for TLS connection only).
  */
@@ -221,6 +253,9 @@ relay_client_handshake_timer_cb (const void *pointer, void *data,
         weechat_unhook (client->hook_timer_handshake);
         client->hook_timer_handshake = NULL;
         client->gnutls_handshake_ok = 1;
+        /* data must be given to the thread before the first send */
+        if (weechat_config_boolean (relay_config_network_tls_thread))
+            relay_tls_thread_start (client);
         switch (client->protocol)
         {
             case RELAY_PROTOCOL_WEECHAT:
@@ -289,13 +324,15 @@ relay_client_handshake_timer_cb (const void *pointer, void *data,
 /*
  * Reads text data from a client (messages on a single line): splits data on
  * '\n' and keeps a partial message if data does not end with '\n'.
+ *
+ * Lines are parsed in place in the partial message (no copy of lines).
  */
 
 void
 relay_client_recv_text_single_line (struct t_relay_client *client)
 {
-    char *pos, *raw_msg, **lines, *tmp;
-    int i, num_lines, length;
+    char *pos, *ptr_line, *pos_end, saved_char;
+    int length;
 
     if (!client->partial_message)
         return;
@@ -305,32 +342,31 @@ relay_client_recv_text_single_line (struct t_relay_client *client)
         return;
 
     /* print message in raw buffer */
-    raw_msg = weechat_strndup (client->partial_message,
-                               pos - client->partial_message + 1);
-    if (raw_msg)
-    {
-        relay_raw_print_client (client, RELAY_MSG_STANDARD,
-                                RELAY_RAW_FLAG_RECV,
-                                raw_msg, strlen (raw_msg) + 1);
-        free (raw_msg);
-    }
+    saved_char = pos[1];
+    pos[1] = '\0';
+    relay_raw_print_client (client, RELAY_MSG_STANDARD,
+                            RELAY_RAW_FLAG_RECV,
+                            client->partial_message,
+                            pos - client->partial_message + 2);
+    pos[1] = saved_char;
 
     pos[0] = '\0';
 
-    lines = weechat_string_split (client->partial_message, "\n", NULL,
-                                  WEECHAT_STRING_SPLIT_STRIP_LEFT
-                                  | WEECHAT_STRING_SPLIT_STRIP_RIGHT
-                                  | WEECHAT_STRING_SPLIT_COLLAPSE_SEPS,
-                                  0, &num_lines);
-    if (lines)
+    ptr_line = client->partial_message;
+    while (ptr_line && (ptr_line <= pos))
     {
-        for (i = 0; i < num_lines; i++)
-        {
-            /* remove final '\r' */
-            length = strlen (lines[i]);
-            if ((length > 0) && (lines[i][length - 1] == '\r'))
-                lines[i][length - 1] = '\0';
+        pos_end = strchr (ptr_line, '\n');
+        if (pos_end)
+            pos_end[0] = '\0';
 
+        /* remove final '\r' */
+        length = strlen (ptr_line);
+        if ((length > 0) && (ptr_line[length - 1] == '\r'))
+            ptr_line[--length] = '\0';
+
+        /* skip empty lines */
+        if (length > 0)
+        {
             /*
              * interpret text from client, according to the relay
              * protocol used
@@ -338,10 +374,10 @@ relay_client_recv_text_single_line (struct t_relay_client *client)
             switch (client->protocol)
             {
                 case RELAY_PROTOCOL_WEECHAT:
-                    relay_weechat_recv (client, lines[i]);
+                    relay_weechat_recv (client, ptr_line);
                     break;
                 case RELAY_PROTOCOL_IRC:
-                    relay_irc_recv (client, lines[i]);
+                    relay_irc_recv (client, ptr_line);
                     break;
                 case RELAY_PROTOCOL_API:
                     /* api is multi-line only (JSON) */
@@ -350,13 +386,14 @@ relay_client_recv_text_single_line (struct t_relay_client *client)
                     break;
             }
         }
-        weechat_string_free_split (lines);
+
+        ptr_line = (pos_end) ? pos_end + 1 : NULL;
     }
+
     if (pos[1])
     {
-        tmp = strdup (pos + 1);
-        free (client->partial_message);
-        client->partial_message = tmp;
+        /* keep partial message (in the same allocated buffer) */
+        memmove (client->partial_message, pos + 1, strlen (pos + 1) + 1);
     }
     else
     {
@@ -415,16 +452,19 @@ void
 relay_client_recv_text (struct t_relay_client *client, const char *data)
 {
     char *new_partial;
+    int length_partial, length_data;
 
     if (client->partial_message)
     {
+        length_partial = strlen (client->partial_message);
+        length_data = strlen (data);
         new_partial = realloc (client->partial_message,
-                               strlen (client->partial_message) +
-                               strlen (data) + 1);
+                               length_partial + length_data + 1);
         if (!new_partial)
             return;
         client->partial_message = new_partial;
-        strcat (client->partial_message, data);
+        memcpy (client->partial_message + length_partial, data,
+                length_data + 1);
     }
     else
         client->partial_message = strdup (data);
@@ -711,7 +751,7 @@ int
 relay_client_recv_cb (const void *pointer, void *data, int fd)
 {
     struct t_relay_client *client;
-    static char buffer[4096];
+    static char buffer[RELAY_CLIENT_RECV_BUFFER_SIZE];
     int num_read;
 
     /* make C compiler happy */
@@ -720,6 +760,11 @@ relay_client_recv_cb (const void *pointer, void *data, int fd)
 
     client = (struct t_relay_client *)pointer;
 
+    if (client->sock < 0)
+        return WEECHAT_RC_OK;
+
+    /* socket may be ready for write: send messages in outqueue */
+    relay_client_send_outqueue (client);
     if (client->sock < 0)
         return WEECHAT_RC_OK;
 
@@ -822,6 +867,10 @@ relay_client_outqueue_free (struct t_relay_client *client,
     if (outqueue->next_outqueue)
         (outqueue->next_outqueue)->prev_outqueue = outqueue->prev_outqueue;
 
+    /* update size of outqueue */
+    client->outqueue_size -= outqueue->data_size - outqueue->data_offset;
+    relay_client_outqueue_size_total -= outqueue->data_size - outqueue->data_offset;
+
     /* free data */
     free (outqueue->data);
     free (outqueue->raw_message[0]);
@@ -869,73 +918,357 @@ relay_client_send_data (struct t_relay_client *client,
     }
 }
 
+/*
+ * Checks if outqueue of a client supports dropping lines when it is full
+ * (option relay.network.outqueue_overflow set to "drop_lines" and protocol
+ * "api" or "weechat").
+ *
+ * Returns:
+ *   1: lines can be dropped
+ *   0: lines can not be dropped (client is disconnected when outqueue is full)
+ */
+
+int
+relay_client_outqueue_can_drop_lines (struct t_relay_client *client)
+{
+    if (weechat_config_enum (relay_config_network_outqueue_overflow)
+        != RELAY_CONFIG_OUTQUEUE_OVERFLOW_DROP_LINES)
+    {
+        return 0;
+    }
+
+    return ((client->protocol == RELAY_PROTOCOL_WEECHAT)
+            || (client->protocol == RELAY_PROTOCOL_API)) ? 1 : 0;
+}
+
+/*
+ * Checks if outqueue of a client is full after adding "size" bytes, using
+ * "factor" times the max sizes defined in options.
+ *
+ * Returns:
+ *   1: outqueue is full
+ *   0: outqueue is not full
+ */
+
+int
+relay_client_outqueue_is_full (struct t_relay_client *client,
+                               unsigned long long size, int factor)
+{
+    unsigned long long max_size;
+
+    max_size = (unsigned long long)weechat_config_integer (
+        relay_config_network_outqueue_max_size) * 1024;
+    if ((max_size > 0)
+        && (client->outqueue_size + size > max_size * factor))
+    {
+        return 1;
+    }
+
+    max_size = (unsigned long long)weechat_config_integer (
+        relay_config_network_outqueue_max_size_total) * 1024;
+    if ((max_size > 0)
+        && (relay_client_outqueue_size_total + size > max_size * factor))
+    {
+        return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * Checks if a line added in a buffer must be dropped (not sent) because the
+ * outqueue of a client is full; if so, the line is counted and the buffer
+ * will be resynchronized when the outqueue is empty.
+ *
+ * Once a line is dropped in a buffer, next lines of this buffer are dropped
+ * as well until the buffer is resynchronized, so that lines are received by
+ * the client in the right order.
+ *
+ * Returns:
+ *   1: line dropped (it must not be sent)
+ *   0: line must be sent
+ */
+
+int
+relay_client_outqueue_drop_line (struct t_relay_client *client,
+                                 struct t_gui_buffer *buffer)
+{
+    const char *ptr_full_name;
+    int *ptr_count, count;
+
+    if (!client || !buffer || !client->outqueue)
+        return 0;
+
+    if (!relay_client_outqueue_can_drop_lines (client))
+        return 0;
+
+    ptr_full_name = weechat_buffer_get_string (buffer, "full_name");
+    if (!ptr_full_name)
+        return 0;
+
+    ptr_count = (client->buffers_lines_dropped) ?
+        weechat_hashtable_get (client->buffers_lines_dropped, ptr_full_name) :
+        NULL;
+    if (!ptr_count && !relay_client_outqueue_is_full (client, 0, 1))
+        return 0;
+
+    if (!client->buffers_lines_dropped)
+    {
+        client->buffers_lines_dropped = weechat_hashtable_new (
+            32,
+            WEECHAT_HASHTABLE_STRING,
+            WEECHAT_HASHTABLE_INTEGER,
+            NULL, NULL);
+        if (!client->buffers_lines_dropped)
+            return 0;
+    }
+
+    count = (ptr_count) ? *ptr_count + 1 : 1;
+    weechat_hashtable_set (client->buffers_lines_dropped,
+                           ptr_full_name, &count);
+    client->lines_dropped++;
+
+    return 1;
+}
+
+/*
+ * Sends lines dropped in a buffer to a client.
+ */
+
+void
+relay_client_send_lines_dropped_cb (void *data,
+                                    struct t_hashtable *hashtable,
+                                    const void *key, const void *value)
+{
+    struct t_relay_client *client;
+    struct t_gui_buffer *ptr_buffer;
+
+    /* make C compiler happy */
+    (void) hashtable;
+
+    client = (struct t_relay_client *)data;
+
+    if (RELAY_STATUS_HAS_ENDED(client->status))
+        return;
+
+    ptr_buffer = weechat_buffer_search ("==", (const char *)key);
+    if (!ptr_buffer)
+        return;
+
+    switch (client->protocol)
+    {
+        case RELAY_PROTOCOL_WEECHAT:
+            relay_weechat_protocol_send_buffer_resync (client, ptr_buffer,
+                                                       *((int *)value));
+            break;
+        case RELAY_PROTOCOL_API:
+#ifdef HAVE_CJSON
+            relay_api_protocol_send_buffer_resync (client, ptr_buffer,
+                                                   *((int *)value));
+#endif /* HAVE_CJSON */
+            break;
+        case RELAY_PROTOCOL_IRC:
+        case RELAY_NUM_PROTOCOLS:
+            break;
+    }
+}
+
+/*
+ * Sends lines dropped (while outqueue was full) to a client: one event is
+ * sent for each buffer, with all lines dropped in this buffer.
+ */
+
+void
+relay_client_send_lines_dropped (struct t_relay_client *client)
+{
+    struct t_hashtable *ptr_hashtable;
+
+    /*
+     * detach hashtable from client: it can be set again if lines are
+     * dropped again while lines are sent
+     */
+    ptr_hashtable = client->buffers_lines_dropped;
+    client->buffers_lines_dropped = NULL;
+
+    weechat_hashtable_map (ptr_hashtable,
+                           &relay_client_send_lines_dropped_cb, client);
+
+    weechat_hashtable_free (ptr_hashtable);
+}
+
+/*
+ * Sends a vector of data to a client (only without TLS).
+ *
+ * Returns the number of bytes sent to the client.
+ */
+
+int
+relay_client_send_data_vector (struct t_relay_client *client,
+                               const struct iovec *iov, int iovcnt)
+{
+    int i, total;
+
+    if (client->sock >= 0)
+        return writev (client->sock, iov, iovcnt);
+
+    total = 0;
+    for (i = 0; i < iovcnt; i++)
+    {
+        total += iov[i].iov_len;
+    }
+    return total;
+}
+
+/*
+ * Removes "num_sent" bytes from the beginning of outqueue: raw messages of
+ * outqueue messages (partially) sent are printed and messages completely sent
+ * are removed from outqueue.
+ */
+
+void
+relay_client_outqueue_consume (struct t_relay_client *client, int num_sent)
+{
+    struct t_relay_client_outqueue *ptr_outqueue;
+    int i, first, remaining;
+
+    first = 1;
+    while (client->outqueue && (first || (num_sent > 0)))
+    {
+        ptr_outqueue = client->outqueue;
+        for (i = 0; i < 2; i++)
+        {
+            if (ptr_outqueue->raw_message[i])
+            {
+                /*
+                 * print raw message and remove it from outqueue
+                 * (so that it is displayed only one time, even if
+                 * message is sent in many chunks)
+                 */
+                relay_raw_print_client (
+                    client,
+                    ptr_outqueue->raw_msg_type[i],
+                    ptr_outqueue->raw_flags[i],
+                    ptr_outqueue->raw_message[i],
+                    ptr_outqueue->raw_size[i]);
+                ptr_outqueue->raw_flags[i] = 0;
+                free (ptr_outqueue->raw_message[i]);
+                ptr_outqueue->raw_message[i] = NULL;
+                ptr_outqueue->raw_size[i] = 0;
+            }
+        }
+        remaining = ptr_outqueue->data_size - ptr_outqueue->data_offset;
+        if (num_sent < remaining)
+        {
+            /* some data was not sent: it will be sent later */
+            ptr_outqueue->data_offset += num_sent;
+            client->outqueue_size -= num_sent;
+            relay_client_outqueue_size_total -= num_sent;
+            break;
+        }
+        /* whole data sent, remove outqueue */
+        num_sent -= remaining;
+        relay_client_outqueue_free (client, ptr_outqueue);
+        first = 0;
+    }
+}
+
+/*
+ * Reports bytes sent by the TLS thread of a client: data sent is removed from
+ * outqueue; in case of error (gnutls error < 0), the client is disconnected.
+ */
+
+void
+relay_client_outqueue_sent (struct t_relay_client *client, int num_sent,
+                            int error)
+{
+    if (num_sent > 0)
+    {
+        client->bytes_sent += num_sent;
+        relay_buffer_refresh (NULL);
+        relay_client_outqueue_consume (client, num_sent);
+    }
+
+    if (error < 0)
+    {
+        weechat_printf_date_tags (
+            NULL, 0, "relay_client",
+            _("%s%s: sending data to client %s%s%s: error %d %s"),
+            weechat_prefix ("error"),
+            RELAY_PLUGIN_NAME,
+            RELAY_COLOR_CHAT_CLIENT,
+            client->desc,
+            RELAY_COLOR_CHAT,
+            error,
+            gnutls_strerror (error));
+        relay_client_set_status (client, RELAY_STATUS_DISCONNECTED);
+        return;
+    }
+
+    /* send lines dropped while the outqueue was full */
+    if (!client->outqueue && client->buffers_lines_dropped)
+        relay_client_send_lines_dropped (client);
+}
+
 /*
  * Sends messages in outqueue for a client.
+ *
+ * Without TLS, many messages are sent with a single call to writev.
+ * With TLS, each message is sent in a TLS record: gnutls requires the same
+ * data to be sent again after an interrupted call, so messages are not
+ * coalesced.
  */
 
 void
 relay_client_send_outqueue (struct t_relay_client *client)
 {
-    int i, num_sent;
-    char *buf;
+    struct t_relay_client_outqueue *ptr_outqueue;
+    struct iovec iov[RELAY_CLIENT_OUTQUEUE_MAX_IOV];
+    int iovcnt, num_sent, size;
+
+    /* with a TLS thread, data in outqueue is already given to the thread */
+    if (!client->outqueue || client->tls_thread)
+        return;
 
     while (client->outqueue)
     {
-        num_sent = relay_client_send_data (client,
-                                           client->outqueue->data,
-                                           client->outqueue->data_size);
-        if (num_sent >= 0)
+        if (client->tls)
         {
-            for (i = 0; i < 2; i++)
+            size = client->outqueue->data_size - client->outqueue->data_offset;
+            num_sent = relay_client_send_data (
+                client,
+                client->outqueue->data + client->outqueue->data_offset,
+                size);
+        }
+        else
+        {
+            iovcnt = 0;
+            size = 0;
+            for (ptr_outqueue = client->outqueue;
+                 ptr_outqueue && (iovcnt < RELAY_CLIENT_OUTQUEUE_MAX_IOV);
+                 ptr_outqueue = ptr_outqueue->next_outqueue)
             {
-                if (client->outqueue->raw_message[i])
-                {
-                    /*
-                     * print raw message and remove it from outqueue
-                     * (so that it is displayed only one time, even if
-                     * message is sent in many chunks)
-                     */
-                    relay_raw_print_client (
-                        client,
-                        client->outqueue->raw_msg_type[i],
-                        client->outqueue->raw_flags[i],
-                        client->outqueue->raw_message[i],
-                        client->outqueue->raw_size[i]);
-                    client->outqueue->raw_flags[i] = 0;
-                    free (client->outqueue->raw_message[i]);
-                    client->outqueue->raw_message[i] = NULL;
-                    client->outqueue->raw_size[i] = 0;
-                }
+                iov[iovcnt].iov_base = ptr_outqueue->data
+                    + ptr_outqueue->data_offset;
+                iov[iovcnt].iov_len = ptr_outqueue->data_size
+                    - ptr_outqueue->data_offset;
+                size += iov[iovcnt].iov_len;
+                iovcnt++;
             }
+            num_sent = relay_client_send_data_vector (client, iov, iovcnt);
+        }
+        if (num_sent >= 0)
+        {
             if (num_sent > 0)
             {
                 client->bytes_sent += num_sent;
                 relay_buffer_refresh (NULL);
             }
-            if (num_sent == client->outqueue->data_size)
-            {
-                /* whole data sent, remove outqueue */
-                relay_client_outqueue_free (client, client->outqueue);
-            }
-            else
+            relay_client_outqueue_consume (client, num_sent);
+            if (num_sent < size)
             {
                 /*
-                 * some data was not sent, update outqueue and stop
-                 * sending data from outqueue
+                 * some data was not sent, stop sending data from outqueue
                  */
-                if (num_sent > 0)
-                {
-                    buf = malloc (client->outqueue->data_size - num_sent);
-                    if (buf)
-                    {
-                        memcpy (buf,
-                                client->outqueue->data + num_sent,
-                                client->outqueue->data_size - num_sent);
-                        free (client->outqueue->data);
-                        client->outqueue->data = buf;
-                        client->outqueue->data_size = client->outqueue->data_size - num_sent;
-                    }
-                }
                 break;
             }
         }
@@ -967,7 +1300,8 @@ relay_client_send_outqueue (struct t_relay_client *client)
             }
             else
             {
-                if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+                if ((errno == EAGAIN) || (errno == EWOULDBLOCK)
+                    || (errno == EINTR))
                 {
                     /* we will retry later this client's queue */
                     break;
@@ -991,68 +1325,81 @@ relay_client_send_outqueue (struct t_relay_client *client)
         }
     }
 
-    if (!client->outqueue && client->hook_timer_send)
+    if (!client->outqueue)
     {
-        weechat_unhook (client->hook_timer_send);
-        client->hook_timer_send = NULL;
+        /* outqueue is empty: stop watching socket for write */
+        if (client->hook_fd)
+            weechat_hook_set (client->hook_fd, "flag_write", "0");
+        /* send lines dropped while the outqueue was full */
+        if (client->buffers_lines_dropped)
+            relay_client_send_lines_dropped (client);
     }
 }
 
 /*
- * Timer called for a client when outqueue is not empty.
+ * Adds an allocated buffer in out queue: the buffer is not copied and is
+ * freed by the outqueue (or immediately in case of error).
  *
- * This timer is automatically removed when the outqueue becomes empty
- * (done in the function relay_client_send_outqueue).
- */
-
-int
-relay_client_timer_send_cb (const void *pointer, void *data,
-                            int remaining_calls)
-{
-    struct t_relay_client *ptr_client;
-
-    /* make C compiler happy */
-    (void) data;
-    (void) remaining_calls;
-
-    ptr_client = (struct t_relay_client *)pointer;
-
-    relay_client_send_outqueue (ptr_client);
-
-    return WEECHAT_RC_OK;
-}
-
-/*
- * Adds a message in out queue.
+ * Bytes before "data_offset" in buffer are considered as already sent.
+ *
+ * If the relay raw buffer is not opened, raw messages are immediately added
+ * to the list of raw messages (instead of making a copy in the outqueue).
  */
 
 void
-relay_client_outqueue_add (struct t_relay_client *client,
-                           const char *data, int data_size,
-                           enum t_relay_msg_type raw_msg_type[2],
-                           int raw_flags[2],
-                           const char *raw_message[2],
-                           int raw_size[2])
+relay_client_outqueue_add_buffer (struct t_relay_client *client,
+                                  char *buffer, int buffer_size,
+                                  int data_offset,
+                                  enum t_relay_msg_type raw_msg_type[2],
+                                  int raw_flags[2],
+                                  const char *raw_message[2],
+                                  int raw_size[2])
 {
     struct t_relay_client_outqueue *new_outqueue;
     int i;
 
-    if (!client || !data || (data_size <= 0))
+    if (!client || !buffer || (data_offset < 0)
+        || (data_offset >= buffer_size))
+    {
+        free (buffer);
         return;
+    }
 
-    new_outqueue = malloc (sizeof (*new_outqueue));
-    if (!new_outqueue)
+    /*
+     * if the outqueue is full, disconnect the client
+     * (if lines are dropped, the max size is twice the size in options,
+     * to let other messages be sent)
+     */
+    if (relay_client_outqueue_is_full (
+            client,
+            buffer_size - data_offset,
+            (relay_client_outqueue_can_drop_lines (client)) ? 2 : 1))
+    {
+        free (buffer);
+        weechat_printf_date_tags (
+            NULL, 0, "relay_client",
+            _("%s%s: too much data waiting to be sent to client %s%s%s "
+              "(%llu bytes), disconnecting client"),
+            weechat_prefix ("error"),
+            RELAY_PLUGIN_NAME,
+            RELAY_COLOR_CHAT_CLIENT,
+            client->desc,
+            RELAY_COLOR_CHAT,
+            client->outqueue_size);
+        relay_client_set_status (client, RELAY_STATUS_DISCONNECTED);
         return;
+    }
 
-    new_outqueue->data = malloc (data_size);
-    if (!new_outqueue->data)
+    new_outqueue = malloc (sizeof (*new_outqueue));
+    if (!new_outqueue)
     {
-        free (new_outqueue);
+        free (buffer);
         return;
     }
 
-    memcpy (new_outqueue->data, data, data_size);
-    new_outqueue->data_size = data_size;
+    new_outqueue->data = buffer;
+    new_outqueue->data_size = buffer_size;
+    new_outqueue->data_offset = data_offset;
     for (i = 0; i < 2; i++)
     {
         new_outqueue->raw_msg_type[i] = RELAY_MSG_STANDARD;
@@ -1061,6 +1408,13 @@ relay_client_outqueue_add (struct t_relay_client *client,
         new_outqueue->raw_size[i] = 0;
         if (raw_message && raw_message[i] && (raw_size[i] > 0))
         {
+            if (!relay_raw_buffer)
+            {
+                relay_raw_print_client (client, raw_msg_type[i],
+                                        raw_flags[i],
+                                        raw_message[i], raw_size[i]);
+                continue;
+            }
             new_outqueue->raw_message[i] = malloc (raw_size[i]);
             if (new_outqueue->raw_message[i])
             {
@@ -1081,11 +1435,120 @@ relay_client_outqueue_add (struct t_relay_client *client,
         client->outqueue = new_outqueue;
     client->last_outqueue = new_outqueue;
 
-    if (!client->hook_timer_send)
+    client->outqueue_size += buffer_size - data_offset;
+    if (client->outqueue_size > client->outqueue_size_max)
+        client->outqueue_size_max = client->outqueue_size;
+    relay_client_outqueue_size_total += buffer_size - data_offset;
+
+    if (client->tls_thread)
+    {
+        /* the TLS thread sends data and reports bytes sent */
+        if (!relay_tls_thread_send (client, buffer + data_offset,
+                                    buffer_size - data_offset))
+        {
+            relay_client_set_status (client, RELAY_STATUS_DISCONNECTED);
+        }
+        return;
+    }
+
+    /* watch socket for write, to send outqueue as soon as possible */
+    if (!new_outqueue->prev_outqueue && client->hook_fd)
+        weechat_hook_set (client->hook_fd, "flag_write", "1");
+}
+
+/*
+ * Adds a message in out queue (data is copied).
+ */
+
+void
+relay_client_outqueue_add (struct t_relay_client *client,
+                           const char *data, int data_size,
+                           enum t_relay_msg_type raw_msg_type[2],
+                           int raw_flags[2],
+                           const char *raw_message[2],
+                           int raw_size[2])
+{
+    char *buffer;
+
+    if (!client || !data || (data_size <= 0))
+        return;
+
+    buffer = malloc (data_size);
+    if (!buffer)
+        return;
+    memcpy (buffer, data, data_size);
+
+    relay_client_outqueue_add_buffer (client, buffer, data_size, 0,
+                                      raw_msg_type, raw_flags,
+                                      raw_message, raw_size);
+}
+
+/*
+ * Adds data in out queue: if data is the websocket frame allocated by
+ * function relay_client_send, the frame is given to the outqueue (and
+ * "*websocket_frame" is set to NULL), otherwise data is copied.
+ */
+
+void
+relay_client_outqueue_add_data (struct t_relay_client *client,
+                                char **websocket_frame,
+                                const char *data, int data_size,
+                                int data_offset,
+                                enum t_relay_msg_type raw_msg_type[2],
+                                int raw_flags[2],
+                                const char *raw_message[2],
+                                int raw_size[2])
+{
+    if (*websocket_frame && (data == *websocket_frame))
     {
-        client->hook_timer_send = weechat_hook_timer (
-            1, 0, 0,
-            &relay_client_timer_send_cb, client, NULL);
+        relay_client_outqueue_add_buffer (client, *websocket_frame, data_size,
+                                          data_offset,
+                                          raw_msg_type, raw_flags,
+                                          raw_message, raw_size);
+        *websocket_frame = NULL;
+    }
+    else
+    {
+        relay_client_outqueue_add (client,
+                                   data + data_offset,
+                                   data_size - data_offset,
+                                   raw_msg_type, raw_flags,
+                                   raw_message, raw_size);
+    }
+}
+
+/*
+ * Starts a batch of messages sent to client: messages are added to the
+ * outqueue and sent with a few calls to writev (without TLS), instead of one
+ * call to send for each message.
+ *
+ * Batches can be nested: messages are sent when the last batch ends.
+ */
+
+void
+relay_client_send_batch_start (struct t_relay_client *client)
+{
+    if (!client)
+        return;
+
+    client->send_batch++;
+}
+
+/*
+ * Ends a batch of messages sent to client: messages queued are sent.
+ */
+
+void
+relay_client_send_batch_end (struct t_relay_client *client)
+{
+    if (!client || (client->send_batch <= 0))
+        return;
+
+    client->send_batch--;
+    if (client->send_batch == 0)
+    {
+        client->send_batch_count = 0;
+        relay_client_send_outqueue (client);
     }
 }
 
@@ -1203,12 +1666,27 @@ relay_client_send (struct t_relay_client *client,
 
     /*
      * if outqueue is not empty, add to outqueue
-     * (because message must be sent *after* messages already in outqueue)
+     * (because message must be sent *after* messages already in outqueue);
+     * with a TLS thread, data is always sent via the outqueue;
+     * in a batch, messages are sent when the batch ends (or when there are
+     * enough messages for a single call to writev)
      */
-    if (client->outqueue)
+    if (client->outqueue || client->tls_thread
+        || ((client->send_batch > 0) && !client->tls))
     {
-        relay_client_outqueue_add (client, ptr_data, data_size,
-                                   raw_msg_type, raw_flags, raw_msg, raw_size);
+        relay_client_outqueue_add_data (client, &websocket_frame,
+                                        ptr_data, data_size, 0,
+                                        raw_msg_type, raw_flags,
+                                        raw_msg, raw_size);
+        if ((client->send_batch > 0) && !client->tls)
+        {
+            client->send_batch_count++;
+            if (client->send_batch_count >= RELAY_CLIENT_OUTQUEUE_MAX_IOV)
+            {
+                client->send_batch_count = 0;
+                relay_client_send_outqueue (client);
+            }
+        }
     }
     else
     {
@@ -1232,10 +1710,9 @@ relay_client_send (struct t_relay_client *client,
             if (num_sent < data_size)
             {
                 /* some data was not sent, add it to outqueue */
-                relay_client_outqueue_add (client,
-                                           ptr_data + num_sent,
-                                           data_size - num_sent,
-                                           NULL, NULL, NULL, NULL);
+                relay_client_outqueue_add_data (client, &websocket_frame,
+                                                ptr_data, data_size, num_sent,
+                                                NULL, NULL, NULL, NULL);
             }
         }
         else
@@ -1246,10 +1723,10 @@ relay_client_send (struct t_relay_client *client,
                     || (num_sent == GNUTLS_E_INTERRUPTED))
                 {
                     /* add message to queue (will be sent later) */
-                    relay_client_outqueue_add (client,
-                                               ptr_data, data_size,
-                                               raw_msg_type, raw_flags,
-                                               raw_msg, raw_size);
+                    relay_client_outqueue_add_data (client, &websocket_frame,
+                                                    ptr_data, data_size, 0,
+                                                    raw_msg_type, raw_flags,
+                                                    raw_msg, raw_size);
                 }
                 else
                 {
@@ -1271,9 +1748,10 @@ relay_client_send (struct t_relay_client *client,
                 if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
                 {
                     /* add message to queue (will be sent later) */
-                    relay_client_outqueue_add (client, ptr_data, data_size,
-                                               raw_msg_type, raw_flags,
-                                               raw_msg, raw_size);
+                    relay_client_outqueue_add_data (client, &websocket_frame,
+                                                    ptr_data, data_size, 0,
+                                                    raw_msg_type, raw_flags,
+                                                    raw_msg, raw_size);
                 }
                 else
                 {
@@ -1378,10 +1856,12 @@ relay_client_new (int sock, const char *address, struct t_relay_server *server)
         new_client->sock = sock;
         new_client->server_port = server->port;
         new_client->tls = server->tls;
+        new_client->unix_socket = server->unix_socket;
         new_client->gnutls_sess = NULL;
         new_client->fake_send_func = NULL;
         new_client->hook_timer_handshake = NULL;
         new_client->gnutls_handshake_ok = 0;
+        new_client->tls_thread = NULL;
         new_client->websocket = RELAY_CLIENT_WEBSOCKET_NOT_USED;
         new_client->ws_deflate = relay_websocket_deflate_alloc ();
         new_client->http_req = relay_http_request_alloc ();
@@ -1399,11 +1879,11 @@ relay_client_new (int sock, const char *address, struct t_relay_server *server)
             (const char **)relay_config_network_password_hash_algo_list,
             1);
         new_client->password_hash_algo = (plain_text_password) ? 0 : -1;
+        new_client->http_auth = NULL;
         new_client->listen_start_time = server->start_time;
         new_client->start_time = time (NULL);
         new_client->end_time = 0;
         new_client->hook_fd = NULL;
-        new_client->hook_timer_send = NULL;
         new_client->last_activity = new_client->start_time;
         new_client->bytes_recv = 0;
         new_client->bytes_sent = 0;
@@ -1518,6 +1998,12 @@ relay_client_new (int sock, const char *address, struct t_relay_server *server)
 
         new_client->outqueue = NULL;
         new_client->last_outqueue = NULL;
+        new_client->outqueue_size = 0;
+        new_client->outqueue_size_max = 0;
+        new_client->lines_dropped = 0;
+        new_client->send_batch = 0;
+        new_client->send_batch_count = 0;
+        new_client->buffers_lines_dropped = NULL;
 
         new_client->prev_client = NULL;
         new_client->next_client = relay_clients;
@@ -1557,10 +2043,11 @@ relay_client_new (int sock, const char *address, struct t_relay_server *server)
 
         if (new_client->sock >= 0)
         {
-            new_client->hook_fd = weechat_hook_fd (new_client->sock,
-                                                   1, 0, 0,
-                                                   &relay_client_recv_cb,
-                                                   new_client, NULL);
+            new_client->hook_fd = weechat_hook_fd (
+                new_client->sock,
+                1, (new_client->outqueue) ? 1 : 0, 0,
+                &relay_client_recv_cb,
+                new_client, NULL);
         }
 
         relay_client_count++;
@@ -1582,6 +2069,115 @@ relay_client_new (int sock, const char *address, struct t_relay_server *server)
     return new_client;
 }
 
+/*
+ * Adds data not yet sent to client (outqueue) and lines dropped in an
+ * infolist item, so that they can be restored after /upgrade.
+ *
+ * Only the bytes not yet sent of each message in outqueue are saved (messages
+ * for the raw buffer are not saved).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+relay_client_outqueue_add_to_infolist (struct t_infolist_item *item,
+                                       struct t_relay_client *client)
+{
+    struct t_relay_client_outqueue *ptr_outqueue;
+    char name[64];
+    int index;
+
+    index = 0;
+    for (ptr_outqueue = client->outqueue; ptr_outqueue;
+         ptr_outqueue = ptr_outqueue->next_outqueue)
+    {
+        if (ptr_outqueue->data_offset >= ptr_outqueue->data_size)
+            continue;
+        snprintf (name, sizeof (name), "outqueue_data_%05d", index);
+        if (!weechat_infolist_new_var_buffer (
+                item, name,
+                ptr_outqueue->data + ptr_outqueue->data_offset,
+                ptr_outqueue->data_size - ptr_outqueue->data_offset))
+        {
+            return 0;
+        }
+        index++;
+    }
+
+    if (client->buffers_lines_dropped
+        && !weechat_hashtable_add_to_infolist (client->buffers_lines_dropped,
+                                               item,
+                                               "buffers_lines_dropped"))
+    {
+        return 0;
+    }
+
+    return 1;
+}
+
+/*
+ * Restores data not yet sent to client (outqueue) and lines dropped from an
+ * infolist (after /upgrade).
+ */
+
+void
+relay_client_outqueue_read_infolist (struct t_relay_client *client,
+                                     struct t_infolist *infolist)
+{
+    const char *ptr_string;
+    char name[64];
+    void *ptr_data;
+    int index, data_size, value;
+
+    ptr_string = weechat_infolist_string (infolist, "lines_dropped");
+    if (ptr_string)
+        sscanf (ptr_string, "%llu", &(client->lines_dropped));
+
+    /* "buffers_lines_dropped_*" and "outqueue_data_*" are new in 4.4.0 */
+    index = 0;
+    while (1)
+    {
+        snprintf (name, sizeof (name),
+                  "buffers_lines_dropped_name_%05d", index);
+        ptr_string = weechat_infolist_string (infolist, name);
+        if (!ptr_string)
+            break;
+        if (!client->buffers_lines_dropped)
+        {
+            client->buffers_lines_dropped = weechat_hashtable_new (
+                32,
+                WEECHAT_HASHTABLE_STRING,
+                WEECHAT_HASHTABLE_INTEGER,
+                NULL, NULL);
+            if (!client->buffers_lines_dropped)
+                break;
+        }
+        snprintf (name, sizeof (name),
+                  "buffers_lines_dropped_value_%05d", index);
+        value = weechat_infolist_integer (infolist, name);
+        weechat_hashtable_set (client->buffers_lines_dropped,
+                               ptr_string, &value);
+        index++;
+    }
+
+    if (client->sock < 0)
+        return;
+
+    index = 0;
+    while (1)
+    {
+        snprintf (name, sizeof (name), "outqueue_data_%05d", index);
+        if (!weechat_infolist_search_var (infolist, name))
+            break;
+        ptr_data = weechat_infolist_buffer (infolist, name, &data_size);
+        relay_client_outqueue_add (client, ptr_data, data_size,
+                                   NULL, NULL, NULL, NULL);
+        index++;
+    }
+}
+
 /*
  * Creates a new client using an infolist.
  *
@@ -1609,10 +2205,13 @@ relay_client_new_with_infolist (struct t_infolist *infolist)
             new_client->tls = weechat_infolist_integer (infolist, "tls");
         else
             new_client->tls = weechat_infolist_integer (infolist, "ssl");
+        new_client->unix_socket = weechat_infolist_integer (infolist,
+                                                            "unix_socket");
         new_client->gnutls_sess = NULL;
         new_client->fake_send_func = NULL;
         new_client->hook_timer_handshake = NULL;
         new_client->gnutls_handshake_ok = 0;
+        new_client->tls_thread = NULL;
         new_client->websocket = weechat_infolist_integer (infolist, "websocket");
         new_client->ws_deflate = relay_websocket_deflate_alloc ();
         new_client->ws_deflate->enabled = weechat_infolist_integer (infolist, "ws_deflate_enabled");
@@ -1677,6 +2276,7 @@ relay_client_new_with_infolist (struct t_infolist *infolist)
             new_client->password_hash_algo = weechat_infolist_integer (infolist, "password_hash_algo");
         else
             new_client->password_hash_algo = RELAY_AUTH_PASSWORD_HASH_PLAIN;
+        new_client->http_auth = NULL;
         new_client->listen_start_time = weechat_infolist_time (infolist, "listen_start_time");
         new_client->start_time = weechat_infolist_time (infolist, "start_time");
         new_client->end_time = weechat_infolist_time (infolist, "end_time");
@@ -1690,7 +2290,6 @@ relay_client_new_with_infolist (struct t_infolist *infolist)
         }
         else
             new_client->hook_fd = NULL;
-        new_client->hook_timer_send = NULL;
         new_client->last_activity = weechat_infolist_time (infolist, "last_activity");
         sscanf (weechat_infolist_string (infolist, "bytes_recv"),
                 "%llu", &(new_client->bytes_recv));
@@ -1698,6 +2297,8 @@ relay_client_new_with_infolist (struct t_infolist *infolist)
                 "%llu", &(new_client->bytes_sent));
         new_client->recv_data_type = weechat_infolist_integer (infolist, "recv_data_type");
         new_client->send_data_type = weechat_infolist_integer (infolist, "send_data_type");
+        new_client->partial_ws_frame = NULL;
+        new_client->partial_ws_frame_size = 0;
         ptr_ws_frame = weechat_infolist_buffer (infolist, "partial_ws_frame", &ws_frame_size);
         if (ptr_ws_frame && (ws_frame_size > 0))
         {
@@ -1736,6 +2337,12 @@ relay_client_new_with_infolist (struct t_infolist *infolist)
 
         new_client->outqueue = NULL;
         new_client->last_outqueue = NULL;
+        new_client->outqueue_size = 0;
+        new_client->outqueue_size_max = 0;
+        new_client->lines_dropped = 0;
+        new_client->send_batch = 0;
+        new_client->send_batch_count = 0;
+        new_client->buffers_lines_dropped = NULL;
 
         new_client->prev_client = NULL;
         new_client->next_client = relay_clients;
@@ -1746,6 +2353,9 @@ relay_client_new_with_infolist (struct t_infolist *infolist)
         relay_clients = new_client;
 
         relay_client_count++;
+
+        /* restore data not yet sent to client and lines dropped */
+        relay_client_outqueue_read_infolist (new_client, infolist);
     }
 
     return new_client;
@@ -1798,6 +2408,7 @@ relay_client_set_status (struct t_relay_client *client,
                 ptr_server->last_client_disconnect = client->end_time;
         }
 
+        relay_tls_thread_stop (client);
         relay_client_outqueue_free_all (client);
 
         if (client->hook_timer_handshake)
@@ -1811,11 +2422,6 @@ relay_client_set_status (struct t_relay_client *client,
             weechat_unhook (client->hook_fd);
             client->hook_fd = NULL;
         }
-        if (client->hook_timer_send)
-        {
-            weechat_unhook (client->hook_timer_send);
-            client->hook_timer_send = NULL;
-        }
         switch (client->protocol)
         {
             case RELAY_PROTOCOL_WEECHAT:
@@ -1876,6 +2482,25 @@ relay_client_set_status (struct t_relay_client *client,
     relay_buffer_refresh (WEECHAT_HOTLIST_MESSAGE);
 }
 
+/*
+ * Resets the credentials of last successful HTTP auth in all clients: next
+ * HTTP requests are authenticated again (called when the password or the
+ * TOTP secret is changed).
+ */
+
+void
+relay_client_reset_http_auth_all ()
+{
+    struct t_relay_client *ptr_client;
+
+    for (ptr_client = relay_clients; ptr_client;
+         ptr_client = ptr_client->next_client)
+    {
+        free (ptr_client->http_auth);
+        ptr_client->http_auth = NULL;
+    }
+}
+
 /*
  * Removes a client.
  */
@@ -1902,17 +2527,18 @@ relay_client_free (struct t_relay_client *client)
         (client->next_client)->prev_client = client->prev_client;
 
     /* free data */
+    relay_tls_thread_stop (client);
     free (client->desc);
     free (client->address);
     free (client->real_ip);
     free (client->protocol_string);
     free (client->protocol_args);
     free (client->nonce);
+    free (client->http_auth);
     weechat_unhook (client->hook_timer_handshake);
     relay_websocket_deflate_free (client->ws_deflate);
     relay_http_request_free (client->http_req);
     weechat_unhook (client->hook_fd);
-    weechat_unhook (client->hook_timer_send);
     free (client->partial_ws_frame);
     free (client->partial_message);
     if (client->protocol_data)
@@ -1935,6 +2561,7 @@ relay_client_free (struct t_relay_client *client)
         }
     }
     relay_client_outqueue_free_all (client);
+    weechat_hashtable_free (client->buffers_lines_dropped);
 
     free (client);
 
@@ -2035,8 +2662,6 @@ relay_client_add_to_infolist (struct t_infolist *infolist,
             return 0;
         if (!weechat_infolist_new_var_time (ptr_item, "end_time", time (NULL)))
             return 0;
-        if (!weechat_infolist_new_var_buffer (ptr_item, "partial_ws_frame", NULL, 0))
-            return 0;
         if (!weechat_infolist_new_var_string (ptr_item, "partial_message", NULL))
             return 0;
     }
@@ -2052,8 +2677,11 @@ relay_client_add_to_infolist (struct t_infolist *infolist,
             return 0;
         if (!weechat_infolist_new_var_time (ptr_item, "end_time", client->end_time))
             return 0;
-        if (!weechat_infolist_new_var_buffer (ptr_item, "partial_ws_frame", client->partial_ws_frame, client->partial_ws_frame_size))
+        if ((client->partial_ws_frame_size > 0)
+            && !weechat_infolist_new_var_buffer (ptr_item, "partial_ws_frame", client->partial_ws_frame, client->partial_ws_frame_size))
+        {
             return 0;
+        }
         if (!weechat_infolist_new_var_string (ptr_item, "partial_message", client->partial_message))
             return 0;
     }
@@ -2061,6 +2689,8 @@ relay_client_add_to_infolist (struct t_infolist *infolist,
         return 0;
     if (!weechat_infolist_new_var_integer (ptr_item, "tls", client->tls))
         return 0;
+    if (!weechat_infolist_new_var_integer (ptr_item, "unix_socket", client->unix_socket))
+        return 0;
     if (!weechat_infolist_new_var_pointer (ptr_item, "fake_send_func", client->fake_send_func))
         return 0;
     if (!weechat_infolist_new_var_integer (ptr_item, "websocket", client->websocket))
@@ -2134,8 +2764,6 @@ relay_client_add_to_infolist (struct t_infolist *infolist,
         return 0;
     if (!weechat_infolist_new_var_pointer (ptr_item, "hook_fd", client->hook_fd))
         return 0;
-    if (!weechat_infolist_new_var_pointer (ptr_item, "hook_timer_send", client->hook_timer_send))
-        return 0;
     if (!weechat_infolist_new_var_time (ptr_item, "last_activity", client->last_activity))
         return 0;
     snprintf (value, sizeof (value), "%llu", client->bytes_recv);
@@ -2148,6 +2776,20 @@ relay_client_add_to_infolist (struct t_infolist *infolist,
         return 0;
     if (!weechat_infolist_new_var_integer (ptr_item, "send_data_type", client->send_data_type))
         return 0;
+    snprintf (value, sizeof (value), "%llu", client->outqueue_size);
+    if (!weechat_infolist_new_var_string (ptr_item, "outqueue_size", value))
+        return 0;
+    snprintf (value, sizeof (value), "%llu", client->outqueue_size_max);
+    if (!weechat_infolist_new_var_string (ptr_item, "outqueue_size_max", value))
+        return 0;
+    snprintf (value, sizeof (value), "%llu", client->lines_dropped);
+    if (!weechat_infolist_new_var_string (ptr_item, "lines_dropped", value))
+        return 0;
+    if (relay_signal_upgrade_received
+        && !relay_client_outqueue_add_to_infolist (ptr_item, client))
+    {
+        return 0;
+    }
 
     switch (client->protocol)
     {
@@ -2191,10 +2833,12 @@ relay_client_print_log ()
         weechat_log_printf ("  sock. . . . . . . . . . . : %d", ptr_client->sock);
         weechat_log_printf ("  server_port . . . . . . . : %d", ptr_client->server_port);
         weechat_log_printf ("  tls . . . . . . . . . . . : %d", ptr_client->tls);
+        weechat_log_printf ("  unix_socket . . . . . . . : %d", ptr_client->unix_socket);
         weechat_log_printf ("  gnutls_sess . . . . . . . : %p", ptr_client->gnutls_sess);
         weechat_log_printf ("  fake_send_func. . . . . . : %p", ptr_client->fake_send_func);
         weechat_log_printf ("  hook_timer_handshake. . . : %p", ptr_client->hook_timer_handshake);
         weechat_log_printf ("  gnutls_handshake_ok . . . : %p", ptr_client->gnutls_handshake_ok);
+        weechat_log_printf ("  tls_thread. . . . . . . . : %p", ptr_client->tls_thread);
         weechat_log_printf ("  websocket . . . . . . . . ; %d", ptr_client->websocket);
         relay_websocket_deflate_print_log (ptr_client->ws_deflate, "");
         relay_http_print_log_request (ptr_client->http_req);
@@ -2213,11 +2857,12 @@ relay_client_print_log ()
                             ptr_client->password_hash_algo,
                             (ptr_client->password_hash_algo >= 0) ?
                             relay_auth_password_hash_algo_name[ptr_client->password_hash_algo] : "");
+        weechat_log_printf ("  http_auth . . . . . . . . : %s",
+                            (ptr_client->http_auth) ? "(set)" : "(null)");
         weechat_log_printf ("  listen_start_time . . . . : %lld", (long long)ptr_client->listen_start_time);
         weechat_log_printf ("  start_time. . . . . . . . : %lld", (long long)ptr_client->start_time);
         weechat_log_printf ("  end_time. . . . . . . . . : %lld", (long long)ptr_client->end_time);
         weechat_log_printf ("  hook_fd . . . . . . . . . : %p", ptr_client->hook_fd);
-        weechat_log_printf ("  hook_timer_send . . . . . : %p", ptr_client->hook_timer_send);
         weechat_log_printf ("  last_activity . . . . . . : %lld", (long long)ptr_client->last_activity);
         weechat_log_printf ("  bytes_recv. . . . . . . . : %llu", ptr_client->bytes_recv);
         weechat_log_printf ("  bytes_sent. . . . . . . . : %llu", ptr_client->bytes_sent);
@@ -2250,6 +2895,12 @@ relay_client_print_log ()
         }
         weechat_log_printf ("  outqueue. . . . . . . . . : %p", ptr_client->outqueue);
         weechat_log_printf ("  last_outqueue . . . . . . : %p", ptr_client->last_outqueue);
+        weechat_log_printf ("  outqueue_size . . . . . . : %llu", ptr_client->outqueue_size);
+        weechat_log_printf ("  outqueue_size_max . . . . : %llu", ptr_client->outqueue_size_max);
+        weechat_log_printf ("  lines_dropped . . . . . . : %llu", ptr_client->lines_dropped);
+        weechat_log_printf ("  send_batch. . . . . . . . : %d", ptr_client->send_batch);
+        weechat_log_printf ("  send_batch_count. . . . . : %d", ptr_client->send_batch_count);
+        weechat_log_printf ("  buffers_lines_dropped . . : %p", ptr_client->buffers_lines_dropped);
         weechat_log_printf ("  prev_client . . . . . . . : %p", ptr_client->prev_client);
         weechat_log_printf ("  next_client . . . . . . . : %p", ptr_client->next_client);
     }
@@ -24,8 +24,11 @@
 
 #include <gnutls/gnutls.h>
 
+struct t_gui_buffer;
+struct t_hashtable;
 struct t_relay_server;
 struct t_relay_http_request;
+struct t_relay_tls_thread;
 
 /* type of data exchanged with client */
 
@@ -55,12 +58,21 @@ enum t_relay_client_websocket_status
 typedef void (t_relay_fake_send_func)(void *client,
                                       const char *data, int data_size);
 
+/* max number of messages in outqueue sent with a single call to writev */
+
+#define RELAY_CLIENT_OUTQUEUE_MAX_IOV 64
+
+/* size of buffer used to read data from client (max size of a single read) */
+
+#define RELAY_CLIENT_RECV_BUFFER_SIZE (64 * 1024)
+
 /* output queue of messages to client */
 
 struct t_relay_client_outqueue
 {
     char *data;                         /* data to send                     */
     int data_size;                      /* number of bytes                  */
+    int data_offset;                    /* number of bytes already sent     */
     int raw_msg_type[2];                /* msgs types                       */
     int raw_flags[2];                   /* flags for raw messages           */
     char *raw_message[2];               /* msgs for raw buffer (can be NULL)*/
@@ -78,11 +90,13 @@ struct t_relay_client
     int sock;                          /* socket for connection             */
     int server_port;                   /* port used for connection          */
     int tls;                           /* 1 if TLS is enabled               */
+    int unix_socket;                   /* 1 if UNIX domain socket is used   */
     gnutls_session_t gnutls_sess;      /* gnutls session (only if TLS used) */
     t_relay_fake_send_func *fake_send_func; /* function called for fake send*/
                                        /* (used in tests only)              */
     struct t_hook *hook_timer_handshake; /* timer for doing gnutls handshake*/
     int gnutls_handshake_ok;           /* 1 if handshake was done and OK    */
+    struct t_relay_tls_thread *tls_thread; /* thread sending TLS records    */
     enum t_relay_client_websocket_status websocket; /* websocket status     */
     struct t_relay_websocket_deflate *ws_deflate; /* websocket deflate data */
     struct t_relay_http_request *http_req; /* HTTP request                  */
@@ -95,11 +109,12 @@ struct t_relay_client
                                        /* example: server for irc protocol  */
     char *nonce;                       /* nonce used in salt of hashed pwd  */
     int password_hash_algo;            /* password hash algo (negotiated)   */
+    char *http_auth;                   /* credentials of last successful    */
+                                       /* HTTP auth (keep-alive connection) */
     time_t listen_start_time;          /* when listening started            */
     time_t start_time;                 /* time of client connection         */
     time_t end_time;                   /* time of client disconnection      */
     struct t_hook *hook_fd;            /* hook for socket or child pipe     */
-    struct t_hook *hook_timer_send;    /* timer to quickly flush outqueue   */
     time_t last_activity;              /* time of last byte received/sent   */
     unsigned long long bytes_recv;     /* bytes received from client        */
     unsigned long long bytes_sent;     /* bytes sent to client              */
@@ -111,6 +126,14 @@ struct t_relay_client
     void *protocol_data;               /* data depending on protocol used   */
     struct t_relay_client_outqueue *outqueue; /* queue for outgoing msgs    */
     struct t_relay_client_outqueue *last_outqueue; /* last outgoing msg     */
+    unsigned long long outqueue_size;  /* bytes in outqueue (not yet sent)  */
+    unsigned long long outqueue_size_max; /* max bytes reached in outqueue  */
+    unsigned long long lines_dropped;  /* lines not sent (outqueue full)    */
+    int send_batch;                    /* > 0: messages are queued and sent */
+                                       /* by batch (without TLS)            */
+    int send_batch_count;              /* messages queued in current batch  */
+    struct t_hashtable *buffers_lines_dropped; /* buffer full name ->       */
+                                       /* number of lines dropped           */
     struct t_relay_client *prev_client;/* link to previous client           */
     struct t_relay_client *next_client;/* link to next client               */
 };
@@ -118,15 +141,30 @@ struct t_relay_client
 extern struct t_relay_client *relay_clients;
 extern struct t_relay_client *last_relay_client;
 extern int relay_client_count;
+extern unsigned long long relay_client_outqueue_size_total;
 
 extern int relay_client_valid (struct t_relay_client *client);
 extern struct t_relay_client *relay_client_search_by_number (int number);
 extern struct t_relay_client *relay_client_search_by_id (int id);
 extern int relay_client_count_active_by_port (int server_port);
 extern void relay_client_set_desc (struct t_relay_client *client);
+extern int relay_client_compression_allowed (struct t_relay_client *client);
 extern void relay_client_recv_buffer (struct t_relay_client *client,
                                       const char *buffer, int buffer_size);
 extern int relay_client_recv_cb (const void *pointer, void *data, int fd);
+extern void relay_client_outqueue_add (struct t_relay_client *client,
+                                       const char *data, int data_size,
+                                       enum t_relay_msg_type raw_msg_type[2],
+                                       int raw_flags[2],
+                                       const char *raw_message[2],
+                                       int raw_size[2]);
+extern void relay_client_outqueue_sent (struct t_relay_client *client,
+                                        int num_sent, int error);
+extern void relay_client_send_outqueue (struct t_relay_client *client);
+extern int relay_client_outqueue_drop_line (struct t_relay_client *client,
+                                            struct t_gui_buffer *buffer);
+extern void relay_client_send_batch_start (struct t_relay_client *client);
+extern void relay_client_send_batch_end (struct t_relay_client *client);
 extern int relay_client_send (struct t_relay_client *client,
                               enum t_relay_msg_type msg_type,
                               const char *data,
@@ -138,6 +176,7 @@ extern struct t_relay_client *relay_client_new (int sock, const char *address,
 extern struct t_relay_client *relay_client_new_with_infolist (struct t_infolist *infolist);
 extern void relay_client_set_status (struct t_relay_client *client,
                                      enum t_relay_status status);
+extern void relay_client_reset_http_auth_all ();
 extern void relay_client_free (struct t_relay_client *client);
 extern void relay_client_free_all ();
 extern void relay_client_disconnect (struct t_relay_client *client);
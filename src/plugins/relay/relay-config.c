@@ -32,6 +32,7 @@
 
 #include "../weechat-plugin.h"
 #include "relay.h"
+#include "relay-auth.h"
 #include "relay-client.h"
 #include "relay-config.h"
 #include "relay-buffer.h"
@@ -75,20 +76,26 @@ struct t_config_option *relay_config_color_text_selected = NULL;
 
 struct t_config_option *relay_config_network_allow_empty_password = NULL;
 struct t_config_option *relay_config_network_allowed_ips = NULL;
+struct t_config_option *relay_config_network_auth_cache_ttl = NULL;
 struct t_config_option *relay_config_network_auth_timeout = NULL;
 struct t_config_option *relay_config_network_bind_address = NULL;
 struct t_config_option *relay_config_network_clients_purge_delay = NULL;
 struct t_config_option *relay_config_network_commands = NULL;
 struct t_config_option *relay_config_network_compression = NULL;
+struct t_config_option *relay_config_network_compression_unix_socket = NULL;
 struct t_config_option *relay_config_network_ipv6 = NULL;
 struct t_config_option *relay_config_network_max_clients = NULL;
 struct t_config_option *relay_config_network_nonce_size = NULL;
+struct t_config_option *relay_config_network_outqueue_max_size = NULL;
+struct t_config_option *relay_config_network_outqueue_max_size_total = NULL;
+struct t_config_option *relay_config_network_outqueue_overflow = NULL;
 struct t_config_option *relay_config_network_password = NULL;
 struct t_config_option *relay_config_network_password_hash_algo = NULL;
 struct t_config_option *relay_config_network_password_hash_iterations = NULL;
 struct t_config_option *relay_config_network_time_window = NULL;
 struct t_config_option *relay_config_network_tls_cert_key = NULL;
 struct t_config_option *relay_config_network_tls_priorities = NULL;
+struct t_config_option *relay_config_network_tls_thread = NULL;
 struct t_config_option *relay_config_network_totp_secret = NULL;
 struct t_config_option *relay_config_network_totp_window = NULL;
 struct t_config_option *relay_config_network_websocket_allowed_origins = NULL;
@@ -240,7 +247,7 @@ relay_config_change_network_allowed_ips (const void *pointer, void *data,
 
     if (relay_config_regex_allowed_ips)
     {
-        regfree (relay_config_regex_allowed_ips);
+        weechat_string_regfree (relay_config_regex_allowed_ips);
         free (relay_config_regex_allowed_ips);
         relay_config_regex_allowed_ips = NULL;
     }
@@ -262,6 +269,25 @@ relay_config_change_network_allowed_ips (const void *pointer, void *data,
     }
 }
 
+/*
+ * Callback for changes on options "relay.network.auth_cache_ttl",
+ * "relay.network.password" and "relay.network.totp_secret".
+ */
+
+void
+relay_config_change_network_password_cb (const void *pointer, void *data,
+                                         struct t_config_option *option)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) option;
+
+    /* saved credentials and verified passwords are not valid any more */
+    relay_client_reset_http_auth_all ();
+    relay_auth_cache_free ();
+}
+
 /*
  * Callback for changes on option "relay.network.password_hash_algo".
  */
@@ -492,7 +518,7 @@ relay_config_change_network_websocket_allowed_origins (const void *pointer, void
 
     if (relay_config_regex_websocket_allowed_origins)
     {
-        regfree (relay_config_regex_websocket_allowed_origins);
+        weechat_string_regfree (relay_config_regex_websocket_allowed_origins);
         free (relay_config_regex_websocket_allowed_origins);
         relay_config_regex_websocket_allowed_origins = NULL;
     }
@@ -1578,6 +1604,22 @@ relay_config_init ()
             NULL, NULL, NULL,
             &relay_config_change_network_allowed_ips, NULL, NULL,
             NULL, NULL, NULL);
+        relay_config_network_auth_cache_ttl = weechat_config_new_option (
+            relay_config_file, relay_config_section_network,
+            "auth_cache_ttl", "integer",
+            N_("delay (in seconds) during which a password successfully "
+               "verified for an HTTP request (\"api\" protocol) is not "
+               "verified again for next requests with the same credentials, "
+               "including on new connections; this avoids to compute again "
+               "the password hash (which can be slow with PBKDF2); "
+               "the TOTP is always verified; "
+               "a hashed password can then be reused during this delay, "
+               "even if its timestamp is older than "
+               "relay.network.time_window (0 = always verify the password)"),
+            NULL, 0, INT_MAX, "60", NULL, 0,
+            NULL, NULL, NULL,
+            &relay_config_change_network_password_cb, NULL, NULL,
+            NULL, NULL, NULL);
         relay_config_network_auth_timeout = weechat_config_new_option (
             relay_config_file, relay_config_section_network,
             "auth_timeout", "integer",
@@ -1631,6 +1673,17 @@ relay_config_init ()
                "compromise between compression and speed"),
             NULL, 0, 100, "20", NULL, 0,
             NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+        relay_config_network_compression_unix_socket = weechat_config_new_option (
+            relay_config_file, relay_config_section_network,
+            "compression_unix_socket", "boolean",
+            N_("compress messages sent to clients connected on a UNIX domain "
+               "socket (if option relay.network.compression is not 0); it can "
+               "be disabled when all clients run on the same host as WeeChat, "
+               "so that no CPU is used to compress data that does not go "
+               "through a network, but it should be kept enabled if the "
+               "socket is forwarded to another host (for example with SSH)"),
+            NULL, 0, 0, "on", NULL, 0,
+            NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
         relay_config_network_ipv6 = weechat_config_new_option (
             relay_config_file, relay_config_section_network,
             "ipv6", "boolean",
@@ -1656,6 +1709,40 @@ relay_config_init ()
                "command of the weechat protocol"),
             NULL, 8, 128, "16", NULL, 0,
             NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+        relay_config_network_outqueue_max_size = weechat_config_new_option (
+            relay_config_file, relay_config_section_network,
+            "outqueue_max_size", "integer",
+            N_("maximum size (in kilobytes) of data waiting to be sent to a "
+               "client (when the client does not read data fast enough); "
+               "when this size is reached, the action defined in option "
+               "relay.network.outqueue_overflow is performed "
+               "(0 = no limit)"),
+            NULL, 0, INT_MAX, "65536", NULL, 0,
+            NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+        relay_config_network_outqueue_max_size_total = weechat_config_new_option (
+            relay_config_file, relay_config_section_network,
+            "outqueue_max_size_total", "integer",
+            N_("maximum size (in kilobytes) of data waiting to be sent to all "
+               "clients; when this size is reached, the action defined in "
+               "option relay.network.outqueue_overflow is performed on the "
+               "client sending data (0 = no limit)"),
+            NULL, 0, INT_MAX, "262144", NULL, 0,
+            NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+        relay_config_network_outqueue_overflow = weechat_config_new_option (
+            relay_config_file, relay_config_section_network,
+            "outqueue_overflow", "enum",
+            N_("action performed when the max size of data waiting to be sent "
+               "to a client is reached: "
+               "\"disconnect\" to disconnect the client, "
+               "\"drop_lines\" to stop sending buffer lines to the client "
+               "(\"api\" and \"weechat\" protocols only, other protocols "
+               "are disconnected): when all the data is sent, the lines "
+               "dropped are sent in a single event for each buffer "
+               "(\"buffer_resync\" with \"api\" protocol, "
+               "\"_buffer_resync\" with \"weechat\" protocol); the client "
+               "is disconnected if twice the max size is reached"),
+            "disconnect|drop_lines", 0, 0, "disconnect", NULL, 0,
+            NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
         relay_config_network_password = weechat_config_new_option (
             relay_config_file, relay_config_section_network,
             "password", "string",
@@ -1664,7 +1751,9 @@ relay_config_init ()
                "relay.network.allow_empty_password) (note: content is evaluated, "
                "see /help eval)"),
             NULL, 0, 0, "", NULL, 0,
-            NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+            NULL, NULL, NULL,
+            &relay_config_change_network_password_cb, NULL, NULL,
+            NULL, NULL, NULL);
         relay_config_network_password_hash_algo = weechat_config_new_option (
             relay_config_file, relay_config_section_network,
             "password_hash_algo", "string",
@@ -1719,6 +1808,17 @@ relay_config_init ()
             &relay_config_check_network_tls_priorities, NULL, NULL,
             &relay_config_change_network_tls_priorities, NULL, NULL,
             NULL, NULL, NULL);
+        relay_config_network_tls_thread = weechat_config_new_option (
+            relay_config_file, relay_config_section_network,
+            "tls_thread", "boolean",
+            N_("encrypt and send data to each TLS client in a separate "
+               "thread, so that the main loop does not spend time in TLS "
+               "encryption when a lot of data is sent (for example the "
+               "backlog); the thread is not used if kernel TLS (kTLS) is "
+               "enabled for the connection; changes apply to new clients "
+               "only"),
+            NULL, 0, 0, "off", NULL, 0,
+            NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
         relay_config_network_totp_secret = weechat_config_new_option (
             relay_config_file, relay_config_section_network,
             "totp_secret", "string",
@@ -1730,7 +1830,7 @@ relay_config_init ()
                "(note: content is evaluated, see /help eval)"),
             NULL, 0, 0, "", NULL, 0,
             &relay_config_check_network_totp_secret, NULL, NULL,
-            NULL, NULL, NULL,
+            &relay_config_change_network_password_cb, NULL, NULL,
             NULL, NULL, NULL);
         relay_config_network_totp_window = weechat_config_new_option (
             relay_config_file, relay_config_section_network,
@@ -1929,14 +2029,14 @@ relay_config_free ()
 
     if (relay_config_regex_allowed_ips)
     {
-        regfree (relay_config_regex_allowed_ips);
+        weechat_string_regfree (relay_config_regex_allowed_ips);
         free (relay_config_regex_allowed_ips);
         relay_config_regex_allowed_ips = NULL;
     }
 
     if (relay_config_regex_websocket_allowed_origins)
     {
-        regfree (relay_config_regex_websocket_allowed_origins);
+        weechat_string_regfree (relay_config_regex_websocket_allowed_origins);
         free (relay_config_regex_websocket_allowed_origins);
         relay_config_regex_websocket_allowed_origins = NULL;
     }
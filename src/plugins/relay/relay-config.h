@@ -28,6 +28,14 @@
 
 #define RELAY_CONFIG_VERSION 2
 
+enum t_relay_config_outqueue_overflow
+{
+    RELAY_CONFIG_OUTQUEUE_OVERFLOW_DISCONNECT = 0,
+    RELAY_CONFIG_OUTQUEUE_OVERFLOW_DROP_LINES,
+    /* number of outqueue overflow actions */
+    RELAY_CONFIG_NUM_OUTQUEUE_OVERFLOW,
+};
+
 extern struct t_config_file *relay_config_file;
 extern struct t_config_section *relay_config_section_port;
 extern struct t_config_section *relay_config_section_path;
@@ -44,20 +52,26 @@ extern struct t_config_option *relay_config_color_text_selected;
 
 extern struct t_config_option *relay_config_network_allow_empty_password;
 extern struct t_config_option *relay_config_network_allowed_ips;
+extern struct t_config_option *relay_config_network_auth_cache_ttl;
 extern struct t_config_option *relay_config_network_auth_timeout;
 extern struct t_config_option *relay_config_network_bind_address;
 extern struct t_config_option *relay_config_network_clients_purge_delay;
 extern struct t_config_option *relay_config_network_commands;
 extern struct t_config_option *relay_config_network_compression;
+extern struct t_config_option *relay_config_network_compression_unix_socket;
 extern struct t_config_option *relay_config_network_ipv6;
 extern struct t_config_option *relay_config_network_max_clients;
 extern struct t_config_option *relay_config_network_nonce_size;
+extern struct t_config_option *relay_config_network_outqueue_max_size;
+extern struct t_config_option *relay_config_network_outqueue_max_size_total;
+extern struct t_config_option *relay_config_network_outqueue_overflow;
 extern struct t_config_option *relay_config_network_password;
 extern struct t_config_option *relay_config_network_password_hash_algo;
 extern struct t_config_option *relay_config_network_password_hash_iterations;
 extern struct t_config_option *relay_config_network_time_window;
 extern struct t_config_option *relay_config_network_tls_cert_key;
 extern struct t_config_option *relay_config_network_tls_priorities;
+extern struct t_config_option *relay_config_network_tls_thread;
 extern struct t_config_option *relay_config_network_totp_secret;
 extern struct t_config_option *relay_config_network_totp_window;
 extern struct t_config_option *relay_config_network_websocket_allowed_origins;
@@ -69,6 +69,8 @@ relay_http_request_reinit (struct t_relay_http_request *request)
     weechat_hashtable_remove_all (request->accept_encoding);
     relay_websocket_deflate_free (request->ws_deflate);
     request->ws_deflate = relay_websocket_deflate_alloc ();
+    free (request->ws_protocol);
+    request->ws_protocol = NULL;
     request->content_length = 0;
     request->body_size = 0;
     free (request->body);
@@ -113,6 +115,7 @@ relay_http_request_alloc ()
         WEECHAT_HASHTABLE_STRING,
         NULL, NULL);
     new_request->ws_deflate = relay_websocket_deflate_alloc ();
+    new_request->ws_protocol = NULL;
     new_request->content_length = 0;
     new_request->body_size = 0;
     new_request->body = NULL;
@@ -209,6 +212,29 @@ relay_http_get_param_long (struct t_relay_http_request *request,
     return default_value;
 }
 
+/*
+ * Gets value of an URL parameter as date (see function weechat_util_parse_time
+ * for the allowed formats).
+ *
+ * Returns:
+ *    1: OK, date set in tv
+ *    0: parameter not set
+ *   -1: invalid date
+ */
+
+int
+relay_http_get_param_time (struct t_relay_http_request *request,
+                           const char *name, struct timeval *tv)
+{
+    const char *ptr_value;
+
+    ptr_value = weechat_hashtable_get (request->params, name);
+    if (!ptr_value)
+        return 0;
+
+    return (weechat_util_parse_time (ptr_value, tv)) ? 1 : -1;
+}
+
 /*
  * Get decoded path items from path.
  */
@@ -468,89 +494,99 @@ relay_http_parse_header (struct t_relay_http_request *request,
     return 1;
 }
 
+/*
+ * Adds data to HTTP body (at most "length" bytes, only bytes missing
+ * according to the header "Content-Length" are added), changes the status
+ * to RELAY_HTTP_END if the body is complete.
+ *
+ * Returns number of bytes added to body (the remaining bytes are the
+ * beginning of next request).
+ */
+
+int
+relay_http_add_data_to_body (struct t_relay_http_request *request,
+                             const char *data, int length)
+{
+    char *new_body;
+    int num_bytes_missing, num_bytes;
+
+    if (!request || !data || (length < 0))
+        return 0;
+
+    num_bytes_missing = request->content_length - request->body_size;
+    if (num_bytes_missing <= 0)
+    {
+        request->status = RELAY_HTTP_END;
+        return 0;
+    }
+
+    num_bytes = (num_bytes_missing >= length) ? length : num_bytes_missing;
+
+    new_body = realloc (request->body, request->body_size + num_bytes + 1);
+    if (new_body)
+    {
+        request->body = new_body;
+        memcpy (request->body + request->body_size, data, num_bytes);
+        request->body[request->body_size + num_bytes] = '\0';
+        request->body_size += num_bytes;
+        weechat_string_dyn_concat (request->raw, data, num_bytes);
+    }
+
+    if (request->body_size >= request->content_length)
+        request->status = RELAY_HTTP_END;
+
+    return num_bytes;
+}
+
 /*
  * Adds bytes to HTTP body, changes the status to RELAY_HTTP_END if the body
  * is complete.
+ *
+ * The bytes added to the body are removed from *partial_message (set to NULL
+ * if all bytes are added).
  */
 
 void
 relay_http_add_to_body (struct t_relay_http_request *request,
                         char **partial_message)
 {
-    char *new_body, *new_partial;
-    int num_bytes_missing, length_msg, length;
+    char *new_partial;
+    int length_msg, num_bytes;
 
     if (!partial_message || !*partial_message)
         return;
 
-    num_bytes_missing = request->content_length
-        - request->body_size;
-    if (num_bytes_missing <= 0)
-    {
-        request->status = RELAY_HTTP_END;
+    length_msg = strlen (*partial_message);
+    num_bytes = relay_http_add_data_to_body (request, *partial_message,
+                                             length_msg);
+    if ((num_bytes == 0) && (request->status == RELAY_HTTP_END))
         return;
-    }
 
-    length_msg = strlen (*partial_message);
-    if (num_bytes_missing >= length_msg)
+    if (num_bytes >= length_msg)
     {
-        new_body = realloc (
-            request->body,
-            request->body_size + length_msg + 1);
-        if (new_body)
-        {
-            request->body = new_body;
-            memcpy (request->body + request->body_size,
-                    *partial_message,
-                    length_msg);
-            request->body[request->body_size + length_msg] = '\0';
-            request->body_size += length_msg;
-            weechat_string_dyn_concat (request->raw, *partial_message, -1);
-        }
         free (*partial_message);
         *partial_message = NULL;
     }
-    else
+    else if (num_bytes > 0)
     {
-        new_body = realloc (
-            request->body,
-            request->body_size + num_bytes_missing + 1);
-        if (new_body)
+        new_partial = malloc (length_msg - num_bytes + 1);
+        if (new_partial)
         {
-            request->body = new_body;
-            memcpy (request->body + request->body_size,
-                    *partial_message,
-                    num_bytes_missing);
-            request->body[request->body_size + num_bytes_missing] = '\0';
-            request->body_size += num_bytes_missing;
-            weechat_string_dyn_concat (request->raw,
-                                       *partial_message, num_bytes_missing);
-            length = strlen (*partial_message + num_bytes_missing);
-            new_partial = malloc (length + 1);
-            if (new_partial)
-            {
-                memcpy (new_partial,
-                        *partial_message + num_bytes_missing,
-                        length + 1);
-                free (*partial_message);
-                *partial_message = new_partial;
-            }
+            memcpy (new_partial, *partial_message + num_bytes,
+                    length_msg - num_bytes + 1);
+            free (*partial_message);
+            *partial_message = new_partial;
         }
     }
-
-    if (request->body_size >= request->content_length)
-        request->status = RELAY_HTTP_END;
 }
 
 /*
- * Gets authentication status according to headers in the request.
+ * Checks password sent by the client in header "Authorization" (encoded in
+ * base64, without the "Basic" prefix).
  *
  * Returns:
- *    0: authentication OK (password + TOTP if enabled)
- *   -1: missing password
+ *    0: password OK
  *   -2: invalid password
- *   -3: missing TOTP
- *   -4: invalid TOTP
  *   -5: invalid hash algorithm
  *   -6: invalid timestamp (used as salt)
  *   -7: invalid number of iterations (PBKDF2)
@@ -558,54 +594,26 @@ relay_http_add_to_body (struct t_relay_http_request *request,
  */
 
 int
-relay_http_get_auth_status (struct t_relay_client *client)
+relay_http_check_password (struct t_relay_client *client,
+                           const char *user_pass_base64,
+                           const char *relay_password)
 {
-    const char *auth, *client_totp, *pos;
-    char *relay_password, *totp_secret, *info_totp_args, *info_totp;
     char *user_pass;
-    int rc, length, totp_ok;
+    int rc, length;
 
     rc = 0;
-    relay_password = NULL;
-    totp_secret = NULL;
-    user_pass = NULL;
-
-    relay_password = weechat_string_eval_expression (
-        weechat_config_string (relay_config_network_password),
-        NULL, NULL, NULL);
-    if (!relay_password)
-    {
-        rc = -8;
-        goto end;
-    }
-
-    auth = weechat_hashtable_get (client->http_req->headers, "authorization");
-    if (!auth || (weechat_strncasecmp (auth, "basic ", 6) != 0))
-    {
-        rc = -1;
-        goto end;
-    }
 
-    pos = auth + 6;
-    while (pos[0] == ' ')
-    {
-        pos++;
-    }
-
-    length = strlen (pos);
+    length = strlen (user_pass_base64);
     user_pass = malloc (length + 1);
     if (!user_pass)
-    {
-        rc = -8;
-        goto end;
-    }
-    length = weechat_string_base_decode ("64", pos, user_pass);
+        return -8;
+
+    length = weechat_string_base_decode ("64", user_pass_base64, user_pass);
     if (length < 0)
     {
         rc = -2;
-        goto end;
     }
-    if (strncmp (user_pass, "plain:", 6) == 0)
+    else if (strncmp (user_pass, "plain:", 6) == 0)
     {
         switch (relay_auth_check_password_plain (client, user_pass + 6, relay_password))
         {
@@ -613,11 +621,11 @@ relay_http_get_auth_status (struct t_relay_client *client)
                 break;
             case -1: /* "plain" is not allowed */
                 rc = -5;
-                goto end;
+                break;
             case -2: /* invalid password */
             default:
                 rc = -2;
-                goto end;
+                break;
         }
     }
     else if (strncmp (user_pass, "hash:", 5) == 0)
@@ -628,25 +636,88 @@ relay_http_get_auth_status (struct t_relay_client *client)
                 break;
             case -1: /* invalid hash algorithm */
                 rc = -5;
-                goto end;
+                break;
             case -2: /* invalid timestamp */
                 rc = -6;
-                goto end;
+                break;
             case -3: /* invalid iterations */
                 rc = -7;
-                goto end;
+                break;
             case -4: /* invalid password */
             default:
                 rc = -2;
-                goto end;
+                break;
         }
     }
     else
     {
         rc = -2;
+    }
+
+    free (user_pass);
+    return rc;
+}
+
+/*
+ * Gets authentication status according to headers in the request.
+ *
+ * The password is not verified again if the same credentials have been
+ * verified recently (see option relay.network.auth_cache_ttl), but the TOTP
+ * is always verified.
+ *
+ * Returns:
+ *    0: authentication OK (password + TOTP if enabled)
+ *   -1: missing password
+ *   -2: invalid password
+ *   -3: missing TOTP
+ *   -4: invalid TOTP
+ *   -5: invalid hash algorithm
+ *   -6: invalid timestamp (used as salt)
+ *   -7: invalid number of iterations (PBKDF2)
+ *   -8: out of memory
+ */
+
+int
+relay_http_get_auth_status (struct t_relay_client *client)
+{
+    const char *auth, *client_totp, *pos;
+    char *relay_password, *totp_secret, *info_totp_args, *info_totp;
+    int rc, length, totp_ok;
+
+    rc = 0;
+    relay_password = NULL;
+    totp_secret = NULL;
+
+    relay_password = weechat_string_eval_expression (
+        weechat_config_string (relay_config_network_password),
+        NULL, NULL, NULL);
+    if (!relay_password)
+    {
+        rc = -8;
         goto end;
     }
 
+    auth = weechat_hashtable_get (client->http_req->headers, "authorization");
+    if (!auth || (weechat_strncasecmp (auth, "basic ", 6) != 0))
+    {
+        rc = -1;
+        goto end;
+    }
+
+    pos = auth + 6;
+    while (pos[0] == ' ')
+    {
+        pos++;
+    }
+
+    if (!relay_auth_cache_search (pos, relay_password))
+    {
+        rc = relay_http_check_password (client, pos, relay_password);
+        if (rc < 0)
+            goto end;
+        relay_auth_cache_add (pos, relay_password);
+    }
+
     totp_secret = weechat_string_eval_expression (
         weechat_config_string (relay_config_network_totp_secret),
         NULL, NULL, NULL);
@@ -684,13 +755,46 @@ relay_http_get_auth_status (struct t_relay_client *client)
 end:
     free (relay_password);
     free (totp_secret);
-    free (user_pass);
     return rc;
 }
 
+/*
+ * Gets credentials sent by the client in HTTP request: headers
+ * "Authorization" and "x-weechat-totp" (can be empty).
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+relay_http_get_auth_credentials (struct t_relay_http_request *request)
+{
+    const char *ptr_auth, *ptr_totp;
+    char *credentials;
+
+    if (!request)
+        return NULL;
+
+    ptr_auth = weechat_hashtable_get (request->headers, "authorization");
+    ptr_totp = weechat_hashtable_get (request->headers, "x-weechat-totp");
+
+    if (weechat_asprintf (&credentials, "%s\n%s",
+                          (ptr_auth) ? ptr_auth : "",
+                          (ptr_totp) ? ptr_totp : "") < 0)
+    {
+        return NULL;
+    }
+
+    return credentials;
+}
+
 /*
  * Checks authentication in HTTP request.
  *
+ * When the authentication is successful, the credentials are saved in the
+ * client, so that next requests received on the same connection (HTTP
+ * keep-alive) with the same credentials are accepted without checking again
+ * the password (which can be slow with PBKDF2) and the TOTP.
+ *
  * Returns:
  *   1: authentication OK
  *   0: authentication failed
@@ -699,8 +803,20 @@ end:
 int
 relay_http_check_auth (struct t_relay_client *client)
 {
+    char *auth;
     int rc;
 
+    if (!client || !client->http_req)
+        return 0;
+
+    /* credentials already checked on this connection? */
+    auth = relay_http_get_auth_credentials (client->http_req);
+    if (auth && client->http_auth && (strcmp (auth, client->http_auth) == 0))
+    {
+        free (auth);
+        return 1;
+    }
+
     rc = relay_http_get_auth_status (client);
     switch (rc)
     {
@@ -747,6 +863,18 @@ relay_http_check_auth (struct t_relay_client *client)
                                         RELAY_HTTP_ERROR_OUT_OF_MEMORY);
             break;
     }
+
+    free (client->http_auth);
+    if (rc == 0)
+    {
+        client->http_auth = auth;
+    }
+    else
+    {
+        client->http_auth = NULL;
+        free (auth);
+    }
+
     return (rc == 0) ? 1 : 0;
 }
 
@@ -809,6 +937,9 @@ relay_http_process_websocket (struct t_relay_client *client)
             relay_client_set_status (client, RELAY_STATUS_AUTH_FAILED);
             return;
         }
+#ifdef HAVE_CJSON
+        relay_api_websocket_set_encoding (client);
+#endif /* HAVE_CJSON */
     }
 
     handshake = relay_websocket_build_handshake (client->http_req);
@@ -827,6 +958,11 @@ relay_http_process_websocket (struct t_relay_client *client)
             /* "api" protocol uses JSON in input/output (multi-line text) */
             client->recv_data_type = RELAY_CLIENT_DATA_TEXT_MULTILINE;
             client->send_data_type = RELAY_CLIENT_DATA_TEXT_MULTILINE;
+#ifdef HAVE_CJSON
+            /* messages sent in CBOR (binary) if requested by the client */
+            if (RELAY_API_DATA(client, encoding) == RELAY_API_ENCODING_CBOR)
+                client->send_data_type = RELAY_CLIENT_DATA_BINARY;
+#endif /* HAVE_CJSON */
         }
     }
 
@@ -880,12 +1016,16 @@ relay_http_process_request (struct t_relay_client *client)
 
 /*
  * Reads HTTP data from a client.
+ *
+ * Many requests can be received at once (HTTP pipelining with "api" relay):
+ * they are parsed and processed in order, and only the incomplete data at the
+ * end (beginning of next request) is kept in the partial message.
  */
 
 void
 relay_http_recv (struct t_relay_client *client, const char *data)
 {
-    char *new_partial, *pos;
+    char *new_partial, *ptr_data, *pos;
     int length, ws_deflate_allowed;
 
     if (client->partial_message)
@@ -903,52 +1043,46 @@ relay_http_recv (struct t_relay_client *client, const char *data)
         client->partial_message = strdup (data);
     }
 
-    while (client->partial_message)
+    if (!client->partial_message)
+        return;
+
+    ptr_data = client->partial_message;
+    length = strlen (ptr_data);
+
+    while (ptr_data[0])
     {
         if ((client->http_req->status == RELAY_HTTP_METHOD)
             || (client->http_req->status == RELAY_HTTP_HEADERS))
         {
-            pos = strchr (client->partial_message, '\r');
+            pos = strchr (ptr_data, '\r');
             if (!pos)
                 break;
             pos[0] = '\0';
             if (client->http_req->status == RELAY_HTTP_METHOD)
             {
-                relay_http_parse_method_path (client->http_req,
-                                              client->partial_message);
+                relay_http_parse_method_path (client->http_req, ptr_data);
             }
             else
             {
-                ws_deflate_allowed = (client->protocol == RELAY_PROTOCOL_API) ?
+                ws_deflate_allowed = ((client->protocol == RELAY_PROTOCOL_API)
+                                      && relay_client_compression_allowed (client)) ?
                     1 : 0;
-                relay_http_parse_header (client->http_req,
-                                         client->partial_message,
+                relay_http_parse_header (client->http_req, ptr_data,
                                          ws_deflate_allowed);
             }
             pos[0] = '\r';
             pos++;
             if (pos[0] == '\n')
                 pos++;
-            length = strlen (pos);
-            if (length > 0)
-            {
-                new_partial = malloc (length + 1);
-                if (new_partial)
-                {
-                    memcpy (new_partial, pos, length + 1);
-                    free (client->partial_message);
-                    client->partial_message = new_partial;
-                }
-            }
-            else
-            {
-                free (client->partial_message);
-                client->partial_message = NULL;
-            }
+            length -= pos - ptr_data;
+            ptr_data = pos;
         }
         else if (client->http_req->status == RELAY_HTTP_BODY)
         {
-            relay_http_add_to_body (client->http_req, &(client->partial_message));
+            pos = ptr_data + relay_http_add_data_to_body (client->http_req,
+                                                          ptr_data, length);
+            length -= pos - ptr_data;
+            ptr_data = pos;
         }
 
         /* process the request if it's ready to be processed (all parsed) */
@@ -968,6 +1102,18 @@ relay_http_recv (struct t_relay_client *client, const char *data)
             break;
         }
     }
+
+    /* keep only data not yet parsed (moved only once, after all requests) */
+    if (ptr_data[0])
+    {
+        if (ptr_data != client->partial_message)
+            memmove (client->partial_message, ptr_data, length + 1);
+    }
+    else
+    {
+        free (client->partial_message);
+        client->partial_message = NULL;
+    }
 }
 
 /*
@@ -1156,10 +1302,11 @@ relay_http_send (struct t_relay_client *client,
     ptr_body = body;
     ptr_body_size = &body_size;
 
-    compressed_body = relay_http_compress (client->http_req, body, body_size,
-                                           &compressed_body_size,
-                                           str_content_encoding,
-                                           sizeof (str_content_encoding));
+    compressed_body = (relay_client_compression_allowed (client)) ?
+        relay_http_compress (client->http_req, body, body_size,
+                             &compressed_body_size,
+                             str_content_encoding,
+                             sizeof (str_content_encoding)) : NULL;
     if (compressed_body)
     {
         ptr_body = compressed_body;
@@ -1322,6 +1469,7 @@ relay_http_request_free (struct t_relay_http_request *request)
     weechat_hashtable_free (request->headers);
     weechat_hashtable_free (request->accept_encoding);
     relay_websocket_deflate_free (request->ws_deflate);
+    free (request->ws_protocol);
     free (request->body);
     free (request->id);
 
@@ -1610,6 +1758,7 @@ relay_http_print_log_request (struct t_relay_http_request *request)
                         weechat_hashtable_get_string (request->accept_encoding,
                                                       "keys_values"));
     relay_websocket_deflate_print_log (request->ws_deflate, "  ");
+    weechat_log_printf ("    ws_protocol . . . . . . : '%s'", request->ws_protocol);
     weechat_log_printf ("    content_length. . . . . : %d", request->content_length);
     weechat_log_printf ("    body_size . . . . . . . : %d", request->body_size);
     weechat_log_printf ("    body. . . . . . . . . . : '%s'", request->body);
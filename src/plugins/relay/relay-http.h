@@ -21,6 +21,7 @@
 #define WEECHAT_PLUGIN_RELAY_HTTP_H
 
 struct t_relay_client;
+struct timeval;
 
 enum t_relay_client_http_status
 {
@@ -66,6 +67,8 @@ struct t_relay_http_request
                                        /* and API protocol                  */
     struct t_hashtable *accept_encoding; /* allowed encoding for response   */
     struct t_relay_websocket_deflate *ws_deflate; /* websocket deflate data */
+    char *ws_protocol;                 /* websocket subprotocol returned    */
+                                       /* in handshake (can be NULL)        */
     int content_length;                /* value of header "Content-Length"  */
     int body_size;                     /* size of HTTP body read so far     */
     char *body;                        /* HTTP body (can be NULL)           */
@@ -91,6 +94,8 @@ extern int relay_http_get_param_boolean (struct t_relay_http_request *request,
                                          const char *name, int default_value);
 extern long relay_http_get_param_long (struct t_relay_http_request *request,
                                        const char *name, long default_value);
+extern int relay_http_get_param_time (struct t_relay_http_request *request,
+                                      const char *name, struct timeval *tv);
 extern int relay_http_parse_method_path (struct t_relay_http_request *request,
                                          const char *method_path);
 extern int relay_http_check_auth (struct t_relay_client *client);
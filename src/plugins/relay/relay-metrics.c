@@ -0,0 +1,589 @@
+/*
+ * relay-metrics.c - metrics in Prometheus text format for relay plugin
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Metrics are not computed in hot paths: they are read from counters already
+ * maintained by WeeChat and plugins (IRC servers, relay clients, buffers,
+ * profiler) only when they are requested by a client.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../weechat-plugin.h"
+#include "relay.h"
+#include "relay-client.h"
+#include "relay-metrics.h"
+
+
+struct t_relay_metrics_var
+{
+    char *name;                        /* metric name                       */
+    char *type;                        /* "counter" or "gauge"              */
+    char *help;                        /* description of metric             */
+    char *var;                         /* hdata variable                    */
+    long long divisor;                 /* divisor of value (unit: seconds)  */
+};
+
+
+/*
+ * Escapes a label value: backslash, double quote and line feed are escaped.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+relay_metrics_escape_label (const char *value)
+{
+    char *result, *ptr_result;
+
+    if (!value)
+        return strdup ("");
+
+    result = malloc ((strlen (value) * 2) + 1);
+    if (!result)
+        return NULL;
+
+    ptr_result = result;
+    while (value[0])
+    {
+        switch (value[0])
+        {
+            case '\\':
+            case '"':
+                ptr_result[0] = '\\';
+                ptr_result[1] = value[0];
+                ptr_result += 2;
+                break;
+            case '\n':
+                ptr_result[0] = '\\';
+                ptr_result[1] = 'n';
+                ptr_result += 2;
+                break;
+            default:
+                ptr_result[0] = value[0];
+                ptr_result++;
+                break;
+        }
+        value++;
+    }
+    ptr_result[0] = '\0';
+
+    return result;
+}
+
+/*
+ * Adds lines "HELP" and "TYPE" of a metric.
+ */
+
+void
+relay_metrics_add_header (char **metrics, const char *name,
+                          const char *type, const char *help)
+{
+    char str_line[1024];
+
+    if (!metrics || !name || !type || !help)
+        return;
+
+    snprintf (str_line, sizeof (str_line),
+              "# HELP %s %s\n# TYPE %s %s\n",
+              name, help, name, type);
+    weechat_string_dyn_concat (metrics, str_line, -1);
+}
+
+/*
+ * Adds a sample of a metric, with optional labels (for example:
+ * 'server="libera"').
+ *
+ * If divisor is greater than 1, the value is divided and displayed with
+ * decimals (for example 1000000 to convert microseconds to seconds).
+ */
+
+void
+relay_metrics_add_value (char **metrics, const char *name,
+                         const char *labels, long long value,
+                         long long divisor)
+{
+    char str_value[512];
+
+    if (!metrics || !name)
+        return;
+
+    if (divisor > 1)
+        snprintf (str_value, sizeof (str_value), "%.6f",
+                  (double)value / divisor);
+    else
+        snprintf (str_value, sizeof (str_value), "%lld", value);
+
+    weechat_string_dyn_concat (metrics, name, -1);
+    if (labels && labels[0])
+    {
+        weechat_string_dyn_concat (metrics, "{", -1);
+        weechat_string_dyn_concat (metrics, labels, -1);
+        weechat_string_dyn_concat (metrics, "}", -1);
+    }
+    weechat_string_dyn_concat (metrics, " ", -1);
+    weechat_string_dyn_concat (metrics, str_value, -1);
+    weechat_string_dyn_concat (metrics, "\n", -1);
+}
+
+/*
+ * Adds a histogram of times (in microseconds) from the profiler: bucket N
+ * contains the number of calls with time < 2^N microseconds (the last bucket
+ * contains all other calls).
+ *
+ * Buckets are displayed in seconds and are cumulative, as expected in
+ * Prometheus format.
+ */
+
+void
+relay_metrics_add_histogram (char **metrics, const char *name,
+                             const char *labels,
+                             const long long *histogram, int histogram_size,
+                             long long count, long long time_total)
+{
+    char str_name[256], str_labels[1024];
+    long long total;
+    int i;
+
+    if (!metrics || !name || !histogram)
+        return;
+
+    snprintf (str_name, sizeof (str_name), "%s_bucket", name);
+    total = 0;
+    for (i = 0; i < histogram_size; i++)
+    {
+        total += histogram[i];
+        if (i < histogram_size - 1)
+        {
+            snprintf (str_labels, sizeof (str_labels),
+                      "%s%sle=\"%.6f\"",
+                      (labels) ? labels : "",
+                      (labels && labels[0]) ? "," : "",
+                      (double)(1LL << i) / 1000000);
+            relay_metrics_add_value (metrics, str_name, str_labels, total, 1);
+        }
+    }
+    snprintf (str_labels, sizeof (str_labels),
+              "%s%sle=\"+Inf\"",
+              (labels) ? labels : "",
+              (labels && labels[0]) ? "," : "");
+    relay_metrics_add_value (metrics, str_name, str_labels, total, 1);
+
+    snprintf (str_name, sizeof (str_name), "%s_sum", name);
+    relay_metrics_add_value (metrics, str_name, labels, time_total, 1000000);
+    snprintf (str_name, sizeof (str_name), "%s_count", name);
+    relay_metrics_add_value (metrics, str_name, labels, count, 1);
+}
+
+/*
+ * Returns value of an integer variable in hdata (type integer or long long).
+ */
+
+long long
+relay_metrics_hdata_value (struct t_hdata *hdata, void *pointer,
+                           const char *name)
+{
+    switch (weechat_hdata_get_var_type (hdata, name))
+    {
+        case WEECHAT_HDATA_INTEGER:
+            return (long long)weechat_hdata_integer (hdata, pointer, name);
+        case WEECHAT_HDATA_LONG:
+            return (long long)weechat_hdata_long (hdata, pointer, name);
+        case WEECHAT_HDATA_LONGLONG:
+            return weechat_hdata_longlong (hdata, pointer, name);
+        default:
+            break;
+    }
+    return 0;
+}
+
+/*
+ * Adds metrics of IRC servers (if irc plugin is loaded).
+ */
+
+void
+relay_metrics_add_irc (char **metrics)
+{
+    struct t_relay_metrics_var vars[] = {
+        { "weechat_irc_connected", "gauge",
+          "1 if connected to IRC server", "is_connected", 1 },
+        { "weechat_irc_messages_received_total", "counter",
+          "Messages received from IRC server", "messages_recv", 1 },
+        { "weechat_irc_messages_sent_total", "counter",
+          "Messages sent to IRC server", "outqueue_sent", 1 },
+        { "weechat_irc_outqueue_messages", "gauge",
+          "Messages waiting in out queues of IRC server",
+          "outqueue_count", 1 },
+        { "weechat_irc_outqueue_wait_seconds_total", "counter",
+          "Total time spent by messages sent in out queues of IRC server",
+          "outqueue_wait_total", 1000000 },
+        { "weechat_irc_lag_seconds", "gauge",
+          "Lag with IRC server", "lag", 1000 },
+        { "weechat_irc_reconnects_total", "counter",
+          "Reconnections to IRC server", "reconnect_count", 1 },
+        { NULL, NULL, NULL, NULL, 0 },
+    };
+    struct t_hdata *hdata;
+    void *servers, *ptr_server;
+    char *name, str_labels[1024];
+    int i;
+
+    hdata = weechat_hdata_get ("irc_server");
+    if (!hdata)
+        return;
+    servers = weechat_hdata_get_list (hdata, "irc_servers");
+
+    for (i = 0; vars[i].name; i++)
+    {
+        relay_metrics_add_header (metrics, vars[i].name, vars[i].type,
+                                  vars[i].help);
+        for (ptr_server = servers; ptr_server;
+             ptr_server = weechat_hdata_move (hdata, ptr_server, 1))
+        {
+            name = relay_metrics_escape_label (
+                weechat_hdata_string (hdata, ptr_server, "name"));
+            snprintf (str_labels, sizeof (str_labels),
+                      "server=\"%s\"", (name) ? name : "");
+            free (name);
+            relay_metrics_add_value (
+                metrics, vars[i].name, str_labels,
+                relay_metrics_hdata_value (hdata, ptr_server, vars[i].var),
+                vars[i].divisor);
+        }
+    }
+}
+
+/*
+ * Adds metrics of relay clients (only clients not disconnected).
+ */
+
+void
+relay_metrics_add_clients (char **metrics)
+{
+    char *names[] = {
+        "weechat_relay_client_bytes_received_total",
+        "weechat_relay_client_bytes_sent_total",
+        "weechat_relay_client_outqueue_bytes",
+        "weechat_relay_client_lines_dropped_total",
+        NULL,
+    };
+    char *types[] = { "counter", "counter", "gauge", "counter", NULL };
+    char *help[] = {
+        "Bytes received from relay client",
+        "Bytes sent to relay client",
+        "Bytes waiting in out queue of relay client",
+        "Lines not sent to relay client (out queue full)",
+        NULL,
+    };
+    struct t_relay_client *ptr_client;
+    char *address, str_labels[1024];
+    unsigned long long value;
+    int i, count;
+
+    count = 0;
+    for (ptr_client = relay_clients; ptr_client;
+         ptr_client = ptr_client->next_client)
+    {
+        if (!RELAY_STATUS_HAS_ENDED(ptr_client->status))
+            count++;
+    }
+    relay_metrics_add_header (metrics, "weechat_relay_clients", "gauge",
+                              "Relay clients connected");
+    relay_metrics_add_value (metrics, "weechat_relay_clients", NULL,
+                             count, 1);
+    relay_metrics_add_header (metrics, "weechat_relay_outqueue_bytes",
+                              "gauge",
+                              "Bytes waiting in out queues of all relay "
+                              "clients");
+    relay_metrics_add_value (metrics, "weechat_relay_outqueue_bytes", NULL,
+                             (long long)relay_client_outqueue_size_total, 1);
+
+    for (i = 0; names[i]; i++)
+    {
+        relay_metrics_add_header (metrics, names[i], types[i], help[i]);
+        for (ptr_client = relay_clients; ptr_client;
+             ptr_client = ptr_client->next_client)
+        {
+            if (RELAY_STATUS_HAS_ENDED(ptr_client->status))
+                continue;
+            address = relay_metrics_escape_label (
+                (ptr_client->real_ip) ?
+                ptr_client->real_ip : ptr_client->address);
+            snprintf (str_labels, sizeof (str_labels),
+                      "client=\"%d\",protocol=\"%s\",address=\"%s\"",
+                      ptr_client->id,
+                      relay_protocol_string[ptr_client->protocol],
+                      (address) ? address : "");
+            free (address);
+            switch (i)
+            {
+                case 0:
+                    value = ptr_client->bytes_recv;
+                    break;
+                case 1:
+                    value = ptr_client->bytes_sent;
+                    break;
+                case 2:
+                    value = ptr_client->outqueue_size;
+                    break;
+                default:
+                    value = ptr_client->lines_dropped;
+                    break;
+            }
+            relay_metrics_add_value (metrics, names[i], str_labels,
+                                     (long long)value, 1);
+        }
+    }
+}
+
+/*
+ * Builds labels of a buffer (full name and plugin).
+ */
+
+void
+relay_metrics_buffer_labels (struct t_gui_buffer *buffer,
+                             char *labels, int size)
+{
+    char *name, *plugin;
+
+    name = relay_metrics_escape_label (
+        weechat_buffer_get_string (buffer, "full_name"));
+    plugin = relay_metrics_escape_label (
+        weechat_buffer_get_string (buffer, "plugin"));
+    snprintf (labels, size,
+              "buffer=\"%s\",plugin=\"%s\"",
+              (name) ? name : "",
+              (plugin) ? plugin : "");
+    free (name);
+    free (plugin);
+}
+
+/*
+ * Adds metrics of buffers: lines and memory used.
+ */
+
+void
+relay_metrics_add_buffers (char **metrics)
+{
+    struct t_relay_metrics_var vars[] = {
+        { "weechat_buffer_lines", "gauge",
+          "Lines in buffer", "lines_count", 1 },
+        { "weechat_buffer_lines_compressed", "gauge",
+          "Lines of buffer compressed in memory",
+          "lines_compressed_count", 1 },
+        { "weechat_buffer_lines_on_disk", "gauge",
+          "Lines of buffer saved on disk", "lines_segment_count", 1 },
+        { "weechat_buffer_disk_bytes", "gauge",
+          "Bytes of buffer lines saved on disk", "segment_size", 1 },
+        { NULL, NULL, NULL, NULL, 0 },
+    };
+    char *memory_types[][2] = {
+        { "lines", "lines_size" },
+        { "lines_compressed", "lines_compressed_size" },
+        { "nicklist", "nicklist_size" },
+        { "local_variables", "local_variables_size" },
+        { NULL, NULL },
+    };
+    struct t_gui_buffer *buffers, *ptr_buffer;
+    void *ptr_lines;
+    char str_labels[1024], str_labels2[2048];
+    long long value;
+    int i;
+
+    buffers = weechat_hdata_get_list (relay_hdata_buffer, "gui_buffers");
+
+    for (i = 0; vars[i].name; i++)
+    {
+        relay_metrics_add_header (metrics, vars[i].name, vars[i].type,
+                                  vars[i].help);
+        for (ptr_buffer = buffers; ptr_buffer;
+             ptr_buffer = weechat_hdata_move (relay_hdata_buffer,
+                                              ptr_buffer, 1))
+        {
+            ptr_lines = weechat_hdata_pointer (relay_hdata_buffer,
+                                               ptr_buffer, "own_lines");
+            if (!ptr_lines)
+                continue;
+            relay_metrics_buffer_labels (ptr_buffer,
+                                         str_labels, sizeof (str_labels));
+            relay_metrics_add_value (
+                metrics, vars[i].name, str_labels,
+                relay_metrics_hdata_value (relay_hdata_lines, ptr_lines,
+                                           vars[i].var),
+                vars[i].divisor);
+        }
+    }
+
+    relay_metrics_add_header (metrics, "weechat_buffer_memory_bytes", "gauge",
+                              "Bytes of memory used by buffer");
+    for (ptr_buffer = buffers; ptr_buffer;
+         ptr_buffer = weechat_hdata_move (relay_hdata_buffer, ptr_buffer, 1))
+    {
+        ptr_lines = weechat_hdata_pointer (relay_hdata_buffer,
+                                           ptr_buffer, "own_lines");
+        if (!ptr_lines)
+            continue;
+        relay_metrics_buffer_labels (ptr_buffer,
+                                     str_labels, sizeof (str_labels));
+        for (i = 0; memory_types[i][0]; i++)
+        {
+            /* the first types are in lines, the other ones in buffer */
+            value = (i < 2) ?
+                relay_metrics_hdata_value (relay_hdata_lines, ptr_lines,
+                                           memory_types[i][1]) :
+                relay_metrics_hdata_value (relay_hdata_buffer, ptr_buffer,
+                                           memory_types[i][1]);
+            snprintf (str_labels2, sizeof (str_labels2),
+                      "%s,type=\"%s\"", str_labels, memory_types[i][0]);
+            relay_metrics_add_value (metrics, "weechat_buffer_memory_bytes",
+                                     str_labels2, value, 1);
+        }
+    }
+}
+
+/*
+ * Adds metrics of profiler: main loop and hook callbacks by plugin (stats
+ * are updated only when the profiler is running, see /debug profile).
+ */
+
+void
+relay_metrics_add_profile (char **metrics)
+{
+    struct t_relay_metrics_var hooks[] = {
+        { "weechat_hook_callback_seconds_total", "counter",
+          "Time spent in hook callbacks by plugin (script is empty for "
+          "the whole plugin)", "time_total", 1000000 },
+        { "weechat_hook_callback_calls_total", "counter",
+          "Calls of hook callbacks by plugin (script is empty for "
+          "the whole plugin)", "count", 1 },
+        { NULL, NULL, NULL, NULL, 0 },
+    };
+    struct t_infolist *infolist;
+    const char *type, *name, *pos;
+    char *plugin, *script, str_labels[1024];
+    long long histogram[RELAY_METRICS_HISTOGRAM_SIZE], *ptr_histogram;
+    int i, size;
+
+    infolist = weechat_infolist_get ("profile", NULL, NULL);
+    if (!infolist)
+        return;
+
+    /* iterations of main loop (histogram) */
+    relay_metrics_add_header (metrics, "weechat_main_loop_iteration_seconds",
+                              "histogram",
+                              "Time of main loop iterations");
+    while (weechat_infolist_next (infolist))
+    {
+        type = weechat_infolist_string (infolist, "type");
+        if (!type || (strcmp (type, "loop") != 0))
+            continue;
+        memset (histogram, 0, sizeof (histogram));
+        ptr_histogram = (long long *)weechat_infolist_buffer (
+            infolist, "histogram", &size);
+        if (ptr_histogram && (size == (int)sizeof (histogram)))
+            memcpy (histogram, ptr_histogram, sizeof (histogram));
+        relay_metrics_add_histogram (
+            metrics, "weechat_main_loop_iteration_seconds", NULL,
+            histogram, RELAY_METRICS_HISTOGRAM_SIZE,
+            strtoll (weechat_infolist_string (infolist, "count"), NULL, 10),
+            strtoll (weechat_infolist_string (infolist, "time_total"),
+                     NULL, 10));
+    }
+
+    /* phases of main loop */
+    relay_metrics_add_header (metrics, "weechat_main_loop_phase_seconds_total",
+                              "counter",
+                              "Time spent in phases of main loop");
+    weechat_infolist_reset_item_cursor (infolist);
+    while (weechat_infolist_next (infolist))
+    {
+        type = weechat_infolist_string (infolist, "type");
+        if (!type || (strcmp (type, "phase") != 0))
+            continue;
+        name = weechat_infolist_string (infolist, "name");
+        snprintf (str_labels, sizeof (str_labels),
+                  "phase=\"%s\"", (name) ? name : "");
+        relay_metrics_add_value (
+            metrics, "weechat_main_loop_phase_seconds_total", str_labels,
+            strtoll (weechat_infolist_string (infolist, "time_total"),
+                     NULL, 10),
+            1000000);
+    }
+
+    /* hook callbacks, by plugin and script */
+    for (i = 0; hooks[i].name; i++)
+    {
+        relay_metrics_add_header (metrics, hooks[i].name, hooks[i].type,
+                                  hooks[i].help);
+        weechat_infolist_reset_item_cursor (infolist);
+        while (weechat_infolist_next (infolist))
+        {
+            type = weechat_infolist_string (infolist, "type");
+            if (!type || (strcmp (type, "plugin") != 0))
+                continue;
+            name = weechat_infolist_string (infolist, "name");
+            if (!name)
+                continue;
+            pos = strchr (name, '/');
+            plugin = (pos) ?
+                weechat_strndup (name, pos - name) : strdup (name);
+            script = relay_metrics_escape_label ((pos) ? pos + 1 : NULL);
+            snprintf (str_labels, sizeof (str_labels),
+                      "plugin=\"%s\",script=\"%s\"",
+                      (plugin) ? plugin : "",
+                      (script) ? script : "");
+            free (plugin);
+            free (script);
+            relay_metrics_add_value (
+                metrics, hooks[i].name, str_labels,
+                strtoll (weechat_infolist_string (infolist, hooks[i].var),
+                         NULL, 10),
+                hooks[i].divisor);
+        }
+    }
+
+    weechat_infolist_free (infolist);
+}
+
+/*
+ * Returns all metrics in Prometheus text format.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+relay_metrics_get ()
+{
+    char **metrics;
+
+    metrics = weechat_string_dyn_alloc (4096);
+    if (!metrics)
+        return NULL;
+
+    relay_metrics_add_irc (metrics);
+    relay_metrics_add_clients (metrics);
+    relay_metrics_add_buffers (metrics);
+    relay_metrics_add_profile (metrics);
+
+    return weechat_string_dyn_free (metrics, 0);
+}
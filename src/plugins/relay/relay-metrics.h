@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WEECHAT_PLUGIN_RELAY_METRICS_H
+#define WEECHAT_PLUGIN_RELAY_METRICS_H
+
+/* metrics in Prometheus text format (version 0.0.4) */
+
+#define RELAY_METRICS_CONTENT_TYPE "text/plain; version=0.0.4; charset=utf-8"
+
+/* number of buckets in histograms of profiler (see core-profile.h) */
+#define RELAY_METRICS_HISTOGRAM_SIZE 32
+
+extern char *relay_metrics_escape_label (const char *value);
+extern void relay_metrics_add_header (char **metrics, const char *name,
+                                      const char *type, const char *help);
+extern void relay_metrics_add_value (char **metrics, const char *name,
+                                     const char *labels, long long value,
+                                     long long divisor);
+extern void relay_metrics_add_histogram (char **metrics, const char *name,
+                                         const char *labels,
+                                         const long long *histogram,
+                                         int histogram_size,
+                                         long long count,
+                                         long long time_total);
+extern char *relay_metrics_get ();
+
+#endif /* WEECHAT_PLUGIN_RELAY_METRICS_H */
@@ -394,6 +394,13 @@ relay_raw_print_client (struct t_relay_client *client,
     if (!relay_raw_buffer && (weechat_relay_plugin->debug >= 1))
         relay_raw_open (0);
 
+    /* message not displayed and not kept: skip conversion of message */
+    if (!relay_raw_buffer
+        && (weechat_config_integer (relay_config_look_raw_messages) == 0))
+    {
+        return;
+    }
+
     if (client)
     {
         snprintf (peer_id, sizeof (peer_id), "%s[%s%d%s] %s%s%s%s",
@@ -430,6 +437,13 @@ relay_raw_print_remote (struct t_relay_remote *remote,
     if (!relay_raw_buffer && (weechat_relay_plugin->debug >= 1))
         relay_raw_open (0);
 
+    /* message not displayed and not kept: skip conversion of message */
+    if (!relay_raw_buffer
+        && (weechat_config_integer (relay_config_look_raw_messages) == 0))
+    {
+        return;
+    }
+
     if (remote)
     {
         snprintf (peer_id, sizeof (peer_id), "%s<%sR%s> %s%s",
@@ -30,6 +30,9 @@
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <gnutls/gnutls.h>
+#ifdef HAVE_CJSON
+#include <cjson/cJSON.h>
+#endif
 
 #include "../weechat-plugin.h"
 #include "relay.h"
@@ -37,6 +40,7 @@
 #include "relay-remote.h"
 #include "relay-websocket.h"
 #ifdef HAVE_CJSON
+#include "api/remote/relay-remote-event.h"
 #include "api/remote/relay-remote-network.h"
 #endif
 
@@ -342,6 +346,9 @@ relay_remote_alloc (const char *name)
     new_remote->ws_deflate = relay_websocket_deflate_alloc ();
     new_remote->version_ok = 0;
     new_remote->synced = 0;
+    new_remote->sync_buffers = NULL;
+    new_remote->sync_buffers_next = NULL;
+    new_remote->hook_timer_sync = NULL;
     new_remote->partial_ws_frame = NULL;
     new_remote->partial_ws_frame_size = 0;
     new_remote->prev_remote = NULL;
@@ -582,6 +589,9 @@ relay_remote_new_with_infolist (struct t_infolist *infolist)
     }
     new_remote->version_ok = weechat_infolist_integer (infolist, "version_ok");
     new_remote->synced = weechat_infolist_integer (infolist, "synced");
+    new_remote->sync_buffers = NULL;
+    new_remote->sync_buffers_next = NULL;
+    new_remote->hook_timer_sync = NULL;
     ptr_ws_frame = weechat_infolist_buffer (infolist, "partial_ws_frame", &ws_frame_size);
     if (ptr_ws_frame && (ws_frame_size > 0))
     {
@@ -835,6 +845,9 @@ relay_remote_free (struct t_relay_remote *remote)
     weechat_unhook (remote->hook_url_handshake);
     weechat_unhook (remote->hook_connect);
     weechat_unhook (remote->hook_fd);
+#ifdef HAVE_CJSON
+    relay_remote_event_sync_buffers_stop (remote);
+#endif /* HAVE_CJSON */
     relay_websocket_deflate_free (remote->ws_deflate);
     free (remote->partial_ws_frame);
 
@@ -1000,6 +1013,9 @@ relay_remote_print_log ()
         relay_websocket_deflate_print_log (ptr_remote->ws_deflate, "");
         weechat_log_printf ("  version_ok. . . . . . . : %d", ptr_remote->version_ok);
         weechat_log_printf ("  synced. . . . . . . . . : %d", ptr_remote->synced);
+        weechat_log_printf ("  sync_buffers. . . . . . : %p", ptr_remote->sync_buffers);
+        weechat_log_printf ("  sync_buffers_next . . . : %p", ptr_remote->sync_buffers_next);
+        weechat_log_printf ("  hook_timer_sync . . . . : %p", ptr_remote->hook_timer_sync);
         weechat_log_printf ("  partial_ws_frame. . . . : %p (%d bytes)",
                             ptr_remote->partial_ws_frame,
                             ptr_remote->partial_ws_frame_size);
@@ -59,6 +59,10 @@ struct t_relay_remote
     struct t_relay_websocket_deflate *ws_deflate; /* websocket deflate data */
     int version_ok;                    /* remote API version is OK?         */
     int synced;                        /* 1 if synced with remote           */
+    void *sync_buffers;                /* buffers received (cJSON array),   */
+                                       /* created progressively before sync */
+    void *sync_buffers_next;           /* next buffer to create (cJSON)     */
+    struct t_hook *hook_timer_sync;    /* timer to create next buffers      */
     char *partial_ws_frame;            /* part. binary websocket frame recv */
     int partial_ws_frame_size;         /* size of partial websocket frame   */
     struct t_relay_remote *prev_remote;/* link to previous remote           */
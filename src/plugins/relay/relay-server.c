@@ -19,6 +19,8 @@
  * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include "config.h"
+
 #include <stdlib.h>
 #include <unistd.h>
 #include <stdio.h>
@@ -264,31 +266,31 @@ relay_server_close_socket (struct t_relay_server *server)
 }
 
 /*
- * Reads data from a client which is connecting on socket.
+ * Accepts one client connecting on socket.
+ *
+ * If "auth_ok" is 0 (relay password or TOTP secret not allowed), the
+ * connection is accepted then immediately closed.
+ *
+ * Returns:
+ *   1: a connection was accepted (client added or connection closed)
+ *   0: no pending connection, or error
  */
 
 int
-relay_server_sock_cb (const void *pointer, void *data, int fd)
+relay_server_accept_client (struct t_relay_server *server, int auth_ok)
 {
-    struct t_relay_server *server;
     struct sockaddr_in client_addr;
     struct sockaddr_in6 client_addr6;
     struct sockaddr_un client_addr_unix;
     socklen_t client_addr_size;
     void *ptr_addr;
-    int client_fd, flags, set, max_clients, num_clients_on_port;
+    int client_fd, set, max_clients, num_clients_on_port;
+#ifndef HAVE_ACCEPT4
+    int flags;
+#endif
     char ipv4_address[INET_ADDRSTRLEN + 1], ipv6_address[INET6_ADDRSTRLEN + 1];
     char unix_address[sizeof (client_addr_unix.sun_path)];
-    char *ptr_ip_address, *relay_password, *relay_totp_secret;
-
-    /* make C compiler happy */
-    (void) data;
-    (void) fd;
-
-    relay_password = NULL;
-    relay_totp_secret = NULL;
-
-    server = (struct t_relay_server *)pointer;
+    char *ptr_ip_address;
 
     if (server->ipv6)
     {
@@ -308,10 +310,18 @@ relay_server_sock_cb (const void *pointer, void *data, int fd)
 
     memset (ptr_addr, 0, client_addr_size);
 
+#ifdef HAVE_ACCEPT4
+    client_fd = accept4 (server->sock, (struct sockaddr *)ptr_addr,
+                         &client_addr_size, SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
     client_fd = accept (server->sock, (struct sockaddr *)ptr_addr,
                         &client_addr_size);
+#endif
     if (client_fd < 0)
     {
+        /* no more pending connection? */
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR))
+            return 0;
         if (server->unix_socket)
         {
             weechat_printf (NULL,
@@ -330,50 +340,11 @@ relay_server_sock_cb (const void *pointer, void *data, int fd)
                             server->port, server->protocol_string,
                             errno, strerror (errno));
         }
-        goto error;
+        return 0;
     }
 
-    /* check if relay password is empty and if it is not allowed */
-    relay_password = weechat_string_eval_expression (
-        weechat_config_string (relay_config_network_password),
-        NULL, NULL, NULL);
-    if (!weechat_config_boolean (relay_config_network_allow_empty_password)
-        && (!relay_password || !relay_password[0]))
-    {
-        weechat_printf (NULL,
-                        _("%s%s: cannot accept client because relay password "
-                          "is empty, and option "
-                          "relay.network.allow_empty_password is off"),
-                        weechat_prefix ("error"), RELAY_PLUGIN_NAME);
+    if (!auth_ok)
         goto error;
-    }
-
-    if (server->protocol == RELAY_PROTOCOL_WEECHAT)
-    {
-        /*
-         * TOTP can be enabled only as second factor, in addition to the
-         * password (only for weechat protocol)
-         */
-        relay_totp_secret = weechat_string_eval_expression (
-            weechat_config_string (relay_config_network_totp_secret),
-            NULL, NULL, NULL);
-        if ((!relay_password || !relay_password[0])
-            && relay_totp_secret && relay_totp_secret[0])
-        {
-            weechat_printf (NULL,
-                            _("%s%s: Time-based One-Time Password (TOTP) "
-                              "can be enabled only as second factor, if the "
-                              "password is not empty"),
-                            weechat_prefix ("error"), RELAY_PLUGIN_NAME);
-            goto error;
-        }
-        if (!relay_config_check_network_totp_secret (
-                NULL, NULL, NULL,
-                weechat_config_string (relay_config_network_totp_secret)))
-        {
-            goto error;
-        }
-    }
 
     /* check if we have reached the max number of clients on this port */
     max_clients = weechat_config_integer (relay_config_network_max_clients);
@@ -433,7 +404,8 @@ relay_server_sock_cb (const void *pointer, void *data, int fd)
 
     /* check if IP is allowed, if not, just close socket */
     if (relay_config_regex_allowed_ips
-        && (regexec (relay_config_regex_allowed_ips, ptr_ip_address, 0, NULL, 0) != 0))
+        && (weechat_string_regexec (relay_config_regex_allowed_ips,
+                                    ptr_ip_address, 0, NULL, 0) != 0))
     {
         if (weechat_relay_plugin->debug >= 1)
         {
@@ -446,11 +418,13 @@ relay_server_sock_cb (const void *pointer, void *data, int fd)
         goto error;
     }
 
+#ifndef HAVE_ACCEPT4
     /* set non-blocking mode for socket */
     flags = fcntl (client_fd, F_GETFL);
     if (flags == -1)
         flags = 0;
     fcntl (client_fd, F_SETFL, flags | O_NONBLOCK);
+#endif
 
     /* set socket option SO_REUSEADDR (only for TCP socket) */
     if (!server->unix_socket)
@@ -471,13 +445,85 @@ relay_server_sock_cb (const void *pointer, void *data, int fd)
     /* add the client */
     relay_client_new (client_fd, ptr_ip_address, server);
 
-    goto end;
+    return 1;
 
 error:
-    if (client_fd >= 0)
-        close (client_fd);
+    close (client_fd);
+    return 1;
+}
+
+/*
+ * Reads data from clients which are connecting on socket: all pending
+ * connections are accepted (up to RELAY_SERVER_ACCEPT_MAX in one call).
+ */
+
+int
+relay_server_sock_cb (const void *pointer, void *data, int fd)
+{
+    struct t_relay_server *server;
+    char *relay_password, *relay_totp_secret;
+    int auth_ok, i;
+
+    /* make C compiler happy */
+    (void) data;
+    (void) fd;
+
+    relay_password = NULL;
+    relay_totp_secret = NULL;
+
+    server = (struct t_relay_server *)pointer;
+
+    auth_ok = 1;
+
+    /* check if relay password is empty and if it is not allowed */
+    relay_password = weechat_string_eval_expression (
+        weechat_config_string (relay_config_network_password),
+        NULL, NULL, NULL);
+    if (!weechat_config_boolean (relay_config_network_allow_empty_password)
+        && (!relay_password || !relay_password[0]))
+    {
+        weechat_printf (NULL,
+                        _("%s%s: cannot accept client because relay password "
+                          "is empty, and option "
+                          "relay.network.allow_empty_password is off"),
+                        weechat_prefix ("error"), RELAY_PLUGIN_NAME);
+        auth_ok = 0;
+    }
+
+    if (auth_ok && (server->protocol == RELAY_PROTOCOL_WEECHAT))
+    {
+        /*
+         * TOTP can be enabled only as second factor, in addition to the
+         * password (only for weechat protocol)
+         */
+        relay_totp_secret = weechat_string_eval_expression (
+            weechat_config_string (relay_config_network_totp_secret),
+            NULL, NULL, NULL);
+        if ((!relay_password || !relay_password[0])
+            && relay_totp_secret && relay_totp_secret[0])
+        {
+            weechat_printf (NULL,
+                            _("%s%s: Time-based One-Time Password (TOTP) "
+                              "can be enabled only as second factor, if the "
+                              "password is not empty"),
+                            weechat_prefix ("error"), RELAY_PLUGIN_NAME);
+            auth_ok = 0;
+        }
+        else if (!relay_config_check_network_totp_secret (
+                     NULL, NULL, NULL,
+                     weechat_config_string (relay_config_network_totp_secret)))
+        {
+            auth_ok = 0;
+        }
+    }
+
+    /* accept all pending connections (the listening socket is non-blocking) */
+    for (i = 0; i < RELAY_SERVER_ACCEPT_MAX; i++)
+    {
+        if (!relay_server_accept_client (server, auth_ok))
+            break;
+    }
 
-end:
     free (relay_password);
     free (relay_totp_secret);
 
@@ -495,7 +541,7 @@ end:
 int
 relay_server_create_socket (struct t_relay_server *server)
 {
-    int domain, set, max_clients, addr_size, rc;
+    int domain, set, max_clients, addr_size, rc, flags;
     struct sockaddr_in server_addr;
     struct sockaddr_in6 server_addr6;
     struct sockaddr_un server_addr_unix;
@@ -722,6 +768,12 @@ relay_server_create_socket (struct t_relay_server *server)
         return 0;
     }
 
+    /* set non-blocking mode: pending connections are accepted in a loop */
+    flags = fcntl (server->sock, F_GETFL);
+    if (flags == -1)
+        flags = 0;
+    fcntl (server->sock, F_SETFL, flags | O_NONBLOCK);
+
     max_clients = weechat_config_integer (relay_config_network_max_clients);
     if (max_clients > 0)
     {
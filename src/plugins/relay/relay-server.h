@@ -24,6 +24,9 @@
 
 #define RELAY_SERVER_GNUTLS_DH_BITS 1024
 
+/* max number of clients accepted in one call of socket callback */
+#define RELAY_SERVER_ACCEPT_MAX 64
+
 struct t_relay_server
 {
     char *protocol_string;             /* example: "ipv6.tls.irc.libera"    */
@@ -0,0 +1,360 @@
+/*
+ * relay-tls-thread.c - thread to encrypt and send TLS records to a client
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * When the option relay.network.tls_thread is enabled, a thread is created
+ * for each TLS client after the handshake: the main thread adds plain data
+ * in the outqueue of client (as usual) and gives a copy to the thread, which
+ * encrypts and sends it with gnutls_record_send; the number of bytes sent is
+ * posted to the main thread, which then removes data from the outqueue.
+ *
+ * Records are received in the main thread: gnutls allows a session to be
+ * used by two threads, one sending and one receiving (re-handshake is never
+ * done by relay).
+ *
+ * If kernel TLS (kTLS) is enabled for sending, records are encrypted by the
+ * kernel and the thread is not used.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <signal.h>
+#include <poll.h>
+#include <pthread.h>
+#include <gnutls/gnutls.h>
+#if GNUTLS_VERSION_NUMBER >= 0x030703
+#include <gnutls/socket.h>
+#endif
+
+#include "../weechat-plugin.h"
+#include "relay.h"
+#include "relay-tls-thread.h"
+#include "relay-client.h"
+#include "relay-config.h"
+
+
+/*
+ * Callback called in main thread (posted by the TLS thread): reports the
+ * bytes sent (and error, if any) to the client.
+ */
+
+void
+relay_tls_thread_post_cb (const void *pointer, void *data)
+{
+    struct t_relay_client *ptr_client;
+    struct t_relay_tls_thread *ptr_tls_thread;
+    int num_sent, error;
+
+    /* make C compiler happy */
+    (void) data;
+
+    ptr_client = relay_client_search_by_id ((int)(intptr_t)pointer);
+    if (!ptr_client || !ptr_client->tls_thread)
+        return;
+
+    ptr_tls_thread = ptr_client->tls_thread;
+
+    /* reset flag first, so that bytes sent from now are posted again */
+    __atomic_store_n (&ptr_tls_thread->post_pending, 0, __ATOMIC_SEQ_CST);
+    num_sent = __atomic_exchange_n (&ptr_tls_thread->num_sent, 0,
+                                    __ATOMIC_SEQ_CST);
+    error = __atomic_load_n (&ptr_tls_thread->error, __ATOMIC_SEQ_CST);
+
+    relay_client_outqueue_sent (ptr_client, num_sent, error);
+}
+
+/*
+ * Reports bytes sent (and error) to the main thread.
+ *
+ * A single post is pending at any time: bytes sent are accumulated until the
+ * main thread reads them.
+ *
+ * Note: this function is called by the TLS thread.
+ */
+
+void
+relay_tls_thread_report (struct t_relay_tls_thread *tls_thread,
+                         int num_sent, int error)
+{
+    if (num_sent > 0)
+    {
+        __atomic_add_fetch (&tls_thread->num_sent, num_sent,
+                            __ATOMIC_SEQ_CST);
+    }
+    if (error < 0)
+        __atomic_store_n (&tls_thread->error, error, __ATOMIC_SEQ_CST);
+
+    if (!__atomic_exchange_n (&tls_thread->post_pending, 1, __ATOMIC_SEQ_CST))
+    {
+        if (!weechat_thread_post (&relay_tls_thread_post_cb,
+                                  (const void *)(intptr_t)tls_thread->client_id,
+                                  NULL))
+        {
+            __atomic_store_n (&tls_thread->post_pending, 0, __ATOMIC_SEQ_CST);
+        }
+    }
+}
+
+/*
+ * Sends data in a TLS record, waiting for the socket to be ready for write.
+ *
+ * Note: this function is called by the TLS thread.
+ *
+ * Returns the number of bytes sent, or a gnutls error (< 0).
+ */
+
+int
+relay_tls_thread_send_data (struct t_relay_tls_thread *tls_thread,
+                            const char *data, int data_size)
+{
+    struct pollfd poll_fd;
+    int offset, rc;
+
+    offset = 0;
+    while (offset < data_size)
+    {
+        rc = gnutls_record_send (tls_thread->gnutls_sess, data + offset,
+                                 data_size - offset);
+        if (rc >= 0)
+        {
+            offset += rc;
+            continue;
+        }
+        if ((rc != GNUTLS_E_AGAIN) && (rc != GNUTLS_E_INTERRUPTED))
+            return rc;
+        if (__atomic_load_n (&tls_thread->quit, __ATOMIC_SEQ_CST))
+            break;
+        /* wait for the socket (with timeout, to check the quit flag) */
+        poll_fd.fd = tls_thread->sock;
+        poll_fd.events = POLLOUT;
+        poll_fd.revents = 0;
+        (void) poll (&poll_fd, 1, 100);
+    }
+
+    return offset;
+}
+
+/*
+ * TLS thread: sends all pending data, then waits for new data.
+ */
+
+void *
+relay_tls_thread_cb (void *arg)
+{
+    struct t_relay_tls_thread *tls_thread;
+    struct t_relay_tls_thread_data *ptr_data, *ptr_next_data;
+    int rc;
+
+    tls_thread = (struct t_relay_tls_thread *)arg;
+
+    pthread_mutex_lock (&tls_thread->mutex);
+    while (1)
+    {
+        while (!tls_thread->data && !tls_thread->quit)
+        {
+            pthread_cond_wait (&tls_thread->cond_data, &tls_thread->mutex);
+        }
+        if (tls_thread->quit)
+            break;
+
+        /* take all pending data */
+        ptr_data = tls_thread->data;
+        tls_thread->data = NULL;
+        tls_thread->last_data = NULL;
+        pthread_mutex_unlock (&tls_thread->mutex);
+
+        rc = 0;
+        while (ptr_data)
+        {
+            ptr_next_data = ptr_data->next_data;
+            if (rc >= 0)
+            {
+                rc = relay_tls_thread_send_data (tls_thread, ptr_data->data,
+                                                 ptr_data->size);
+                relay_tls_thread_report (tls_thread, (rc > 0) ? rc : 0,
+                                         (rc < 0) ? rc : 0);
+            }
+            free (ptr_data->data);
+            free (ptr_data);
+            ptr_data = ptr_next_data;
+        }
+
+        pthread_mutex_lock (&tls_thread->mutex);
+        if (rc < 0)
+        {
+            /* error: the main thread disconnects the client */
+            break;
+        }
+    }
+    pthread_mutex_unlock (&tls_thread->mutex);
+
+    return NULL;
+}
+
+/*
+ * Starts the TLS thread of a client (handshake must be done).
+ *
+ * Returns:
+ *   1: OK
+ *   0: thread not started (data is sent by the main thread)
+ */
+
+int
+relay_tls_thread_start (struct t_relay_client *client)
+{
+    struct t_relay_tls_thread *new_tls_thread;
+    sigset_t set, old_set;
+    int rc;
+
+    if (!client || !client->tls || !client->gnutls_handshake_ok
+        || (client->sock < 0) || client->tls_thread)
+    {
+        return 0;
+    }
+
+#if GNUTLS_VERSION_NUMBER >= 0x030703
+    /* records are already encrypted by the kernel */
+    if (gnutls_transport_is_ktls_enabled (client->gnutls_sess)
+        & GNUTLS_KTLS_SEND)
+    {
+        return 0;
+    }
+#endif
+
+    new_tls_thread = calloc (1, sizeof (*new_tls_thread));
+    if (!new_tls_thread)
+        return 0;
+
+    new_tls_thread->client_id = client->id;
+    new_tls_thread->sock = client->sock;
+    new_tls_thread->gnutls_sess = client->gnutls_sess;
+    pthread_mutex_init (&new_tls_thread->mutex, NULL);
+    pthread_cond_init (&new_tls_thread->cond_data, NULL);
+
+    /* signals are handled by the main thread only */
+    sigfillset (&set);
+    pthread_sigmask (SIG_SETMASK, &set, &old_set);
+    rc = pthread_create (&new_tls_thread->thread, NULL,
+                         &relay_tls_thread_cb, new_tls_thread);
+    pthread_sigmask (SIG_SETMASK, &old_set, NULL);
+
+    if (rc != 0)
+    {
+        weechat_printf (NULL,
+                        _("%s%s: unable to create TLS thread for client "
+                          "%s%s%s, data is sent by the main thread"),
+                        weechat_prefix ("error"), RELAY_PLUGIN_NAME,
+                        RELAY_COLOR_CHAT_CLIENT,
+                        client->desc,
+                        RELAY_COLOR_CHAT);
+        pthread_cond_destroy (&new_tls_thread->cond_data);
+        pthread_mutex_destroy (&new_tls_thread->mutex);
+        free (new_tls_thread);
+        return 0;
+    }
+
+    client->tls_thread = new_tls_thread;
+
+    return 1;
+}
+
+/*
+ * Gives data to the TLS thread of a client (data is copied).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+relay_tls_thread_send (struct t_relay_client *client,
+                       const char *data, int data_size)
+{
+    struct t_relay_tls_thread_data *new_data;
+
+    if (!client || !client->tls_thread || !data || (data_size <= 0))
+        return 0;
+
+    new_data = malloc (sizeof (*new_data));
+    if (!new_data)
+        return 0;
+    new_data->data = malloc (data_size);
+    if (!new_data->data)
+    {
+        free (new_data);
+        return 0;
+    }
+    memcpy (new_data->data, data, data_size);
+    new_data->size = data_size;
+    new_data->next_data = NULL;
+
+    pthread_mutex_lock (&client->tls_thread->mutex);
+    if (client->tls_thread->last_data)
+        client->tls_thread->last_data->next_data = new_data;
+    else
+        client->tls_thread->data = new_data;
+    client->tls_thread->last_data = new_data;
+    pthread_cond_signal (&client->tls_thread->cond_data);
+    pthread_mutex_unlock (&client->tls_thread->mutex);
+
+    return 1;
+}
+
+/*
+ * Stops the TLS thread of a client: data not sent yet is discarded.
+ *
+ * This must be called before the gnutls session is closed.
+ */
+
+void
+relay_tls_thread_stop (struct t_relay_client *client)
+{
+    struct t_relay_tls_thread *ptr_tls_thread;
+    struct t_relay_tls_thread_data *ptr_data, *ptr_next_data;
+
+    if (!client || !client->tls_thread)
+        return;
+
+    ptr_tls_thread = client->tls_thread;
+
+    pthread_mutex_lock (&ptr_tls_thread->mutex);
+    __atomic_store_n (&ptr_tls_thread->quit, 1, __ATOMIC_SEQ_CST);
+    pthread_cond_signal (&ptr_tls_thread->cond_data);
+    pthread_mutex_unlock (&ptr_tls_thread->mutex);
+
+    pthread_join (ptr_tls_thread->thread, NULL);
+
+    ptr_data = ptr_tls_thread->data;
+    while (ptr_data)
+    {
+        ptr_next_data = ptr_data->next_data;
+        free (ptr_data->data);
+        free (ptr_data);
+        ptr_data = ptr_next_data;
+    }
+
+    pthread_cond_destroy (&ptr_tls_thread->cond_data);
+    pthread_mutex_destroy (&ptr_tls_thread->mutex);
+    free (ptr_tls_thread);
+
+    client->tls_thread = NULL;
+}
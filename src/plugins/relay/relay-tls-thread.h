@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WEECHAT_PLUGIN_RELAY_TLS_THREAD_H
+#define WEECHAT_PLUGIN_RELAY_TLS_THREAD_H
+
+#include <pthread.h>
+#include <gnutls/gnutls.h>
+
+struct t_relay_client;
+
+/* plain data waiting to be encrypted and sent by the thread */
+
+struct t_relay_tls_thread_data
+{
+    char *data;                        /* data to send (owned by thread)    */
+    int size;                          /* size of data                      */
+    struct t_relay_tls_thread_data *next_data; /* link to next data         */
+};
+
+/* thread sending TLS records of a client */
+
+struct t_relay_tls_thread
+{
+    int client_id;                     /* id of relay client                */
+    int sock;                          /* socket of client                  */
+    gnutls_session_t gnutls_sess;      /* gnutls session of client          */
+    pthread_t thread;                  /* thread                            */
+    pthread_mutex_t mutex;             /* mutex for data and quit           */
+    pthread_cond_t cond_data;          /* signaled when data is added       */
+    struct t_relay_tls_thread_data *data; /* data to send                   */
+    struct t_relay_tls_thread_data *last_data; /* last data to send         */
+    int quit;                          /* 1 if thread must exit             */
+    int num_sent;                      /* bytes sent, not yet reported to   */
+                                       /* main thread (atomic)              */
+    int error;                         /* gnutls error (atomic), 0 if OK    */
+    int post_pending;                  /* 1 if a post to main thread is     */
+                                       /* pending (atomic)                  */
+};
+
+extern int relay_tls_thread_start (struct t_relay_client *client);
+extern int relay_tls_thread_send (struct t_relay_client *client,
+                                  const char *data, int data_size);
+extern void relay_tls_thread_stop (struct t_relay_client *client);
+
+#endif /* WEECHAT_PLUGIN_RELAY_TLS_THREAD_H */
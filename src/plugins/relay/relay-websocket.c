@@ -23,6 +23,7 @@
 #include <unistd.h>
 #include <stdio.h>
 #include <string.h>
+#include <stdint.h>
 #include <gcrypt.h>
 #include <zlib.h>
 
@@ -281,8 +282,8 @@ relay_websocket_client_handshake_valid (struct t_relay_http_request *request)
         value = weechat_hashtable_get (request->headers, "origin");
         if (!value || !value[0])
             return -2;
-        if (regexec (relay_config_regex_websocket_allowed_origins, value, 0,
-                     NULL, 0) != 0)
+        if (weechat_string_regexec (relay_config_regex_websocket_allowed_origins,
+                                    value, 0, NULL, 0) != 0)
         {
             return -2;
         }
@@ -403,6 +404,7 @@ relay_websocket_build_handshake (struct t_relay_http_request *request)
     const char *sec_websocket_key;
     char *key, sec_websocket_accept[128], handshake[4096], hash[160 / 8];
     char **extensions, str_window_bits[128], sec_websocket_extensions[1024];
+    char sec_websocket_protocol[256];
     int length, hash_size;
 
     if (!request)
@@ -481,6 +483,17 @@ relay_websocket_build_handshake (struct t_relay_http_request *request)
         sec_websocket_extensions[0] = '\0';
     }
 
+    if (request->ws_protocol && request->ws_protocol[0])
+    {
+        snprintf (sec_websocket_protocol, sizeof (sec_websocket_protocol),
+                  "Sec-WebSocket-Protocol: %s\r\n",
+                  request->ws_protocol);
+    }
+    else
+    {
+        sec_websocket_protocol[0] = '\0';
+    }
+
     /* build the handshake (it will be sent as-is to client) */
     snprintf (handshake, sizeof (handshake),
               "HTTP/1.1 101 Switching Protocols\r\n"
@@ -488,9 +501,11 @@ relay_websocket_build_handshake (struct t_relay_http_request *request)
               "Connection: Upgrade\r\n"
               "Sec-WebSocket-Accept: %s\r\n"
               "%s"
+              "%s"
               "\r\n",
               sec_websocket_accept,
-              sec_websocket_extensions);
+              sec_websocket_extensions,
+              sec_websocket_protocol);
 
     return strdup (handshake);
 }
@@ -588,6 +603,40 @@ error:
     return NULL;
 }
 
+/*
+ * Masks or unmasks data with the 4-byte mask (XOR, see RFC 6455): "size"
+ * bytes of "src" are written in "dest" (they can be the same pointer).
+ *
+ * Data is processed 8 bytes at a time, then byte by byte for the remaining
+ * bytes.
+ */
+
+void
+relay_websocket_mask (unsigned char *dest, const unsigned char *src,
+                      unsigned long long size, const unsigned char *mask)
+{
+    unsigned char mask8[8];
+    uint64_t mask64, value;
+    unsigned long long i;
+
+    for (i = 0; i < 8; i++)
+    {
+        mask8[i] = mask[i % 4];
+    }
+    memcpy (&mask64, mask8, sizeof (mask64));
+
+    for (i = 0; i + 8 <= size; i += 8)
+    {
+        memcpy (&value, src + i, sizeof (value));
+        value ^= mask64;
+        memcpy (dest + i, &value, sizeof (value));
+    }
+    for (; i < size; i++)
+    {
+        dest[i] = src[i] ^ mask[i % 4];
+    }
+}
+
 /*
  * Decodes a websocket frame and return a list of frames in "*frames" (each
  * frame is first decompressed if "permessage-deflate" websocket extension
@@ -617,7 +666,8 @@ relay_websocket_decode_frame (const unsigned char *buffer,
     size_t size_decompressed;
     char *payload_decompressed;
     struct t_relay_websocket_frame *frames2, *ptr_frame;
-    int size, masked_frame, mask[4];
+    unsigned char mask[4];
+    int size, masked_frame;
 
     if (!buffer || !frames || !num_frames)
         return 0;
@@ -672,10 +722,7 @@ relay_websocket_decode_frame (const unsigned char *buffer,
             /* read mask (4 bytes) */
             if (index_buffer + 4 > buffer_length)
                 goto missing_data;
-            for (i = 0; i < 4; i++)
-            {
-                mask[i] = (int)((unsigned char)buffer[index_buffer + i]);
-            }
+            memcpy (mask, buffer + index_buffer, 4);
             index_buffer += 4;
         }
 
@@ -723,10 +770,8 @@ relay_websocket_decode_frame (const unsigned char *buffer,
         /* fill payload */
         if (masked_frame)
         {
-            for (i = 0; i < length_frame; i++)
-            {
-                ptr_frame->payload[i] = (int)((unsigned char)buffer[index_buffer + i]) ^ mask[i % 4];
-            }
+            relay_websocket_mask ((unsigned char *)ptr_frame->payload,
+                                  buffer + index_buffer, length_frame, mask);
         }
         else
         {
@@ -862,7 +907,7 @@ relay_websocket_encode_frame (struct t_relay_websocket_deflate *ws_deflate,
     char *payload_compressed;
     size_t size_compressed;
     unsigned char *frame, *ptr_mask;
-    unsigned long long i, index, data_size;
+    unsigned long long index, data_size;
 
     *length_frame = 0;
 
@@ -961,16 +1006,15 @@ relay_websocket_encode_frame (struct t_relay_websocket_deflate *ws_deflate,
         index += 4;
     }
 
-    /* copy buffer after data_size */
-    memcpy (frame + index, ptr_data, data_size);
-
-    /* mask frame */
+    /* copy buffer after data_size (masked if needed) */
     if (mask_frame)
     {
-        for (i = 0; i < data_size; i++)
-        {
-            frame[index + i] = frame[index + i] ^ ptr_mask[i % 4];
-        }
+        relay_websocket_mask (frame + index, (const unsigned char *)ptr_data,
+                              data_size, ptr_mask);
+    }
+    else
+    {
+        memcpy (frame + index, ptr_data, data_size);
     }
 
     *length_frame = index + data_size;
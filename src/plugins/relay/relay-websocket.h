@@ -74,6 +74,10 @@ extern void relay_websocket_parse_extensions (const char *extensions,
                                               struct t_relay_websocket_deflate *ws_deflate,
                                               int ws_deflate_allowed);
 extern char *relay_websocket_build_handshake (struct t_relay_http_request *request);
+extern void relay_websocket_mask (unsigned char *dest,
+                                  const unsigned char *src,
+                                  unsigned long long size,
+                                  const unsigned char *mask);
 extern int relay_websocket_decode_frame (const unsigned char *buffer,
                                          unsigned long long length,
                                          int expect_masked_frame,
@@ -24,6 +24,7 @@
 
 #include "../weechat-plugin.h"
 #include "relay.h"
+#include "relay-auth.h"
 #include "relay-buffer.h"
 #include "relay-client.h"
 #include "relay-command.h"
@@ -301,6 +302,8 @@ weechat_plugin_init (struct t_weechat_plugin *plugin, int argc, char *argv[])
 
     relay_hook_timer = weechat_hook_timer (1 * 1000, 0, 0,
                                            &relay_client_timer_cb, NULL, NULL);
+    /* allow a small delay to be called with other timers */
+    weechat_hook_set (relay_hook_timer, "slack", "500");
 
     return WEECHAT_RC_OK;
 }
@@ -343,6 +346,8 @@ weechat_plugin_end (struct t_weechat_plugin *plugin)
 
     relay_network_end ();
 
+    relay_auth_cache_free ();
+
     relay_config_free ();
 
     return WEECHAT_RC_OK;
@@ -54,6 +54,7 @@ struct t_relay_weechat_msg *
 relay_weechat_msg_new (const char *id)
 {
     struct t_relay_weechat_msg *new_msg;
+    int i;
 
     new_msg = malloc (sizeof (*new_msg));
     if (!new_msg)
@@ -68,6 +69,12 @@ relay_weechat_msg_new (const char *id)
     }
     new_msg->data_alloc = RELAY_WEECHAT_MSG_INITIAL_ALLOC;
     new_msg->data_size = 0;
+    for (i = 0; i < RELAY_WEECHAT_NUM_COMPRESSIONS; i++)
+    {
+        new_msg->compressed[i] = NULL;
+        new_msg->compressed_size[i] = 0;
+        new_msg->compressed_raw[i] = NULL;
+    }
 
     /* add size and compression flag (they will be set later) */
     relay_weechat_msg_add_int (new_msg, 0);
@@ -343,6 +350,53 @@ relay_weechat_msg_add_hashtable (struct t_relay_weechat_msg *msg,
                            &relay_weechat_msg_hashtable_map_cb, msg);
 }
 
+/*
+ * Adds value of a hdata variable (not an array) to a message, using pointer
+ * to content of variable.
+ */
+
+void
+relay_weechat_msg_add_hdata_value (struct t_relay_weechat_msg *msg,
+                                   int var_type, void *ptr_value)
+{
+    switch (var_type)
+    {
+        case WEECHAT_HDATA_CHAR:
+            relay_weechat_msg_add_char (
+                msg, (ptr_value) ? *((char *)ptr_value) : '\0');
+            break;
+        case WEECHAT_HDATA_INTEGER:
+            relay_weechat_msg_add_int (
+                msg, (ptr_value) ? *((int *)ptr_value) : 0);
+            break;
+        case WEECHAT_HDATA_LONG:
+            relay_weechat_msg_add_long (
+                msg, (ptr_value) ? *((long *)ptr_value) : 0);
+            break;
+        case WEECHAT_HDATA_LONGLONG:
+            relay_weechat_msg_add_longlong (
+                msg, (ptr_value) ? *((long long *)ptr_value) : 0);
+            break;
+        case WEECHAT_HDATA_STRING:
+        case WEECHAT_HDATA_SHARED_STRING:
+            relay_weechat_msg_add_string (
+                msg, (ptr_value) ? *((char **)ptr_value) : NULL);
+            break;
+        case WEECHAT_HDATA_POINTER:
+            relay_weechat_msg_add_pointer (
+                msg, (ptr_value) ? *((void **)ptr_value) : NULL);
+            break;
+        case WEECHAT_HDATA_TIME:
+            relay_weechat_msg_add_time (
+                msg, (ptr_value) ? *((time_t *)ptr_value) : 0);
+            break;
+        case WEECHAT_HDATA_HASHTABLE:
+            relay_weechat_msg_add_hashtable (
+                msg, (ptr_value) ? *((struct t_hashtable **)ptr_value) : NULL);
+            break;
+    }
+}
+
 /*
  * Adds recursively hdata for a path to a message.
  *
@@ -356,7 +410,9 @@ relay_weechat_msg_add_hdata_path (struct t_relay_weechat_msg *msg,
                                   void **path_pointers,
                                   struct t_hdata *hdata,
                                   void *pointer,
-                                  char **list_keys)
+                                  char **list_keys,
+                                  struct t_hdata_path **list_keys_paths,
+                                  int *list_keys_types)
 {
     int num_added, i, j, count, count_all, var_type, array_size, max_array_size;
     int length;
@@ -424,7 +480,9 @@ relay_weechat_msg_add_hdata_path (struct t_relay_weechat_msg *msg,
                                                                    path_pointers,
                                                                    sub_hdata,
                                                                    sub_pointer,
-                                                                   list_keys);
+                                                                   list_keys,
+                                                                   list_keys_paths,
+                                                                   list_keys_types);
                 }
             }
         }
@@ -437,6 +495,16 @@ relay_weechat_msg_add_hdata_path (struct t_relay_weechat_msg *msg,
             }
             for (i = 0; list_keys[i]; i++)
             {
+                if (list_keys_paths[i])
+                {
+                    /* variable resolved before (not an array): fast path */
+                    relay_weechat_msg_add_hdata_value (
+                        msg,
+                        list_keys_types[i],
+                        weechat_hdata_path_get_var (list_keys_paths[i],
+                                                    pointer));
+                    continue;
+                }
                 var_type = weechat_hdata_get_var_type (hdata, list_keys[i]);
                 if ((var_type >= 0) && (var_type != WEECHAT_HDATA_OTHER))
                 {
@@ -584,17 +652,21 @@ relay_weechat_msg_add_hdata (struct t_relay_weechat_msg *msg,
                              const char *path, const char *keys)
 {
     struct t_hdata *ptr_hdata_head, *ptr_hdata;
+    struct t_hdata_path **list_keys_paths;
     char *hdata_head, *pos, **list_keys, *keys_types, **list_path;
     char *path_returned;
     const char *hdata_name, *array_size;
     void *pointer, **path_pointers;
     int rc, num_keys, num_path, i, type, pos_count, count, rc_sscanf;
+    int *list_keys_types;
     uint32_t count32;
 
     rc = 0;
 
     hdata_head = NULL;
     list_keys = NULL;
+    list_keys_paths = NULL;
+    list_keys_types = NULL;
     num_keys = 0;
     keys_types = NULL;
     list_path = NULL;
@@ -694,6 +766,15 @@ relay_weechat_msg_add_hdata (struct t_relay_weechat_msg *msg,
     if (!list_keys)
         goto end;
 
+    /*
+     * resolve variables which are not arrays, so that they are read directly
+     * in each object
+     */
+    list_keys_paths = calloc (num_keys, sizeof (*list_keys_paths));
+    list_keys_types = calloc (num_keys, sizeof (*list_keys_types));
+    if (!list_keys_paths || !list_keys_types)
+        goto end;
+
     /* build string with list of keys with types: "key1:type1,key2:type2,..." */
     keys_types = malloc (strlen (keys) + (num_keys * 8) + 1);
     if (!keys_types)
@@ -702,6 +783,7 @@ relay_weechat_msg_add_hdata (struct t_relay_weechat_msg *msg,
     for (i = 0; i < num_keys; i++)
     {
         type = weechat_hdata_get_var_type (ptr_hdata, list_keys[i]);
+        list_keys_types[i] = type;
         if ((type >= 0) && (type != WEECHAT_HDATA_OTHER))
         {
             if (keys_types[0])
@@ -715,6 +797,8 @@ relay_weechat_msg_add_hdata (struct t_relay_weechat_msg *msg,
                 strcat (keys_types, RELAY_WEECHAT_MSG_OBJ_ARRAY);
             else
             {
+                list_keys_paths[i] = weechat_hdata_path_new (ptr_hdata,
+                                                             list_keys[i]);
                 switch (type)
                 {
                     case WEECHAT_HDATA_CHAR:
@@ -765,7 +849,9 @@ relay_weechat_msg_add_hdata (struct t_relay_weechat_msg *msg,
                                                   path_pointers,
                                                   ptr_hdata_head,
                                                   pointer,
-                                                  list_keys);
+                                                  list_keys,
+                                                  list_keys_paths,
+                                                  list_keys_types);
         free (path_pointers);
     }
     count32 = htonl ((uint32_t)count);
@@ -774,6 +860,15 @@ relay_weechat_msg_add_hdata (struct t_relay_weechat_msg *msg,
     rc = 1;
 
 end:
+    if (list_keys_paths)
+    {
+        for (i = 0; i < num_keys; i++)
+        {
+            weechat_hdata_path_free (list_keys_paths[i]);
+        }
+        free (list_keys_paths);
+    }
+    free (list_keys_types);
     weechat_string_free_split (list_keys);
     free (keys_types);
     weechat_string_free_split (list_path);
@@ -933,7 +1028,9 @@ relay_weechat_msg_add_nicklist_buffer (struct t_relay_weechat_msg *msg,
     }
     else
     {
-        /* send full nicklist */
+        /* send full nicklist (ask to fill it if it's filled on demand) */
+        (void) weechat_hook_signal_send ("buffer_nicklist_request",
+                                         WEECHAT_HOOK_SIGNAL_POINTER, buffer);
         ptr_group = NULL;
         ptr_nick = NULL;
         weechat_nicklist_get_next_item (buffer, &ptr_group, &ptr_nick);
@@ -1062,13 +1159,12 @@ relay_weechat_msg_add_nicklist (struct t_relay_weechat_msg *msg,
  * Compresses the message with zlib.
  *
  * Returns:
- *   1: OK, message compressed and sent
- *   0: error, no message sent
+ *   1: OK, message compressed
+ *   0: error, message not compressed
  */
 
 int
-relay_weechat_msg_compress_zlib (struct t_relay_client *client,
-                                 struct t_relay_weechat_msg *msg)
+relay_weechat_msg_compress_zlib (struct t_relay_weechat_msg *msg)
 {
     char raw_message[1024];
     uint32_t size32;
@@ -1076,15 +1172,12 @@ relay_weechat_msg_compress_zlib (struct t_relay_client *client,
     uLongf dest_size;
     struct timeval tv1, tv2;
     long long time_diff;
-    int rc, rc_compress, compression, compression_level;
-
-    rc = 0;
-    dest = NULL;
+    int rc_compress, compression, compression_level;
 
     dest_size = compressBound (msg->data_size - 5);
     dest = malloc (dest_size + 5);
     if (!dest)
-        goto error;
+        return 0;
 
     /* convert % to zlib compression level (1-9) */
     compression = weechat_config_integer (relay_config_network_compression);
@@ -1100,14 +1193,17 @@ relay_weechat_msg_compress_zlib (struct t_relay_client *client,
     gettimeofday (&tv2, NULL);
     time_diff = weechat_util_timeval_diff (&tv1, &tv2);
     if ((rc_compress != Z_OK) || ((int)dest_size + 5 >= msg->data_size))
-        goto error;
+    {
+        free (dest);
+        return 0;
+    }
 
     /* set size and compression flag */
     size32 = htonl ((uint32_t)(dest_size + 5));
     memcpy (dest, &size32, 4);
     dest[4] = RELAY_WEECHAT_COMPRESSION_ZLIB;
 
-    /* display message in raw buffer */
+    /* message for raw buffer */
     snprintf (raw_message, sizeof (raw_message),
               "obj: %d/%d bytes (zlib: %d%%, %.2fms), id: %s",
               (int)dest_size + 5,
@@ -1116,30 +1212,23 @@ relay_weechat_msg_compress_zlib (struct t_relay_client *client,
               ((float)time_diff) / 1000,
               msg->id);
 
-    /* send compressed data */
-    relay_client_send (client, RELAY_MSG_STANDARD,
-                       (const char *)dest, dest_size + 5,
-                       raw_message);
-
-    rc = 1;
+    msg->compressed[RELAY_WEECHAT_COMPRESSION_ZLIB] = (char *)dest;
+    msg->compressed_size[RELAY_WEECHAT_COMPRESSION_ZLIB] = dest_size + 5;
+    msg->compressed_raw[RELAY_WEECHAT_COMPRESSION_ZLIB] = strdup (raw_message);
 
-error:
-    free (dest);
-
-    return rc;
+    return 1;
 }
 
 /*
  * Compresses the message with zstd.
  *
  * Returns:
- *   1: OK, message compressed and sent
- *   0: error, no message sent
+ *   1: OK, message compressed
+ *   0: error, message not compressed
  */
 
 int
-relay_weechat_msg_compress_zstd (struct t_relay_client *client,
-                                 struct t_relay_weechat_msg *msg)
+relay_weechat_msg_compress_zstd (struct t_relay_weechat_msg *msg)
 {
 #ifdef HAVE_ZSTD
     char raw_message[1024];
@@ -1148,15 +1237,12 @@ relay_weechat_msg_compress_zstd (struct t_relay_client *client,
     size_t dest_size, comp_size;
     struct timeval tv1, tv2;
     long long time_diff;
-    int rc, compression, compression_level;
-
-    rc = 0;
-    dest = NULL;
+    int compression, compression_level;
 
     dest_size = ZSTD_compressBound (msg->data_size - 5);
     dest = malloc (dest_size + 5);
     if (!dest)
-        goto error;
+        return 0;
 
     /* convert % to zstd compression level (1-19) */
     compression = weechat_config_integer (relay_config_network_compression);
@@ -1172,14 +1258,17 @@ relay_weechat_msg_compress_zstd (struct t_relay_client *client,
     gettimeofday (&tv2, NULL);
     time_diff = weechat_util_timeval_diff (&tv1, &tv2);
     if ((comp_size == 0) || ((int)comp_size + 5 >= msg->data_size))
-        goto error;
+    {
+        free (dest);
+        return 0;
+    }
 
     /* set size and compression flag */
     size32 = htonl ((uint32_t)(comp_size + 5));
     memcpy (dest, &size32, 4);
     dest[4] = RELAY_WEECHAT_COMPRESSION_ZSTD;
 
-    /* display message in raw buffer */
+    /* message for raw buffer */
     snprintf (raw_message, sizeof (raw_message),
               "obj: %d/%d bytes (zstd: %d%%, %.2fms), id: %s",
               (int)comp_size + 5,
@@ -1188,28 +1277,293 @@ relay_weechat_msg_compress_zstd (struct t_relay_client *client,
               ((float)time_diff) / 1000,
               msg->id);
 
-    /* send compressed data */
-    relay_client_send (client, RELAY_MSG_STANDARD,
-                       (const char *)dest, comp_size + 5,
-                       raw_message);
+    msg->compressed[RELAY_WEECHAT_COMPRESSION_ZSTD] = (char *)dest;
+    msg->compressed_size[RELAY_WEECHAT_COMPRESSION_ZSTD] = comp_size + 5;
+    msg->compressed_raw[RELAY_WEECHAT_COMPRESSION_ZSTD] = strdup (raw_message);
 
-    rc = 1;
+    return 1;
+#else
+    /* make C compiler happy */
+    (void) msg;
 
-error:
-    free (dest);
+    return 0;
+#endif /* HAVE_ZSTD */
+}
 
-    return rc;
+/*
+ * Compresses the message with the zlib stream of client (the stream is kept
+ * between messages and flushed after each message).
+ *
+ * The compressed message is allocated, it must be freed after use.
+ *
+ * Returns:
+ *   1: OK, message compressed
+ *   0: error, message not compressed
+ */
+
+int
+relay_weechat_msg_compress_zlib_stream (struct t_relay_client *client,
+                                        struct t_relay_weechat_msg *msg,
+                                        char **compressed,
+                                        int *compressed_size,
+                                        char *raw_message,
+                                        int raw_message_size)
+{
+    z_stream *strm;
+    uint32_t size32;
+    Bytef *dest, *new_dest;
+    uLong dest_size;
+    struct timeval tv1, tv2;
+    long long time_diff;
+    int rc, compression, compression_level;
+
+    strm = RELAY_WEECHAT_DATA(client, zlib_stream);
+    if (!strm)
+    {
+        strm = calloc (1, sizeof (*strm));
+        if (!strm)
+            return 0;
+        /* convert % to zlib compression level (1-9) */
+        compression = weechat_config_integer (relay_config_network_compression);
+        compression_level = (((compression - 1) * 9) / 100) + 1;
+        if (deflateInit (strm, compression_level) != Z_OK)
+        {
+            free (strm);
+            return 0;
+        }
+        RELAY_WEECHAT_DATA(client, zlib_stream) = strm;
+    }
+
+    /* room for the sync flush marker (and zlib header on first message) */
+    dest_size = deflateBound (strm, msg->data_size - 5) + 16;
+    dest = malloc (dest_size + 5);
+    if (!dest)
+        return 0;
+
+    gettimeofday (&tv1, NULL);
+    strm->next_in = (Bytef *)(msg->data + 5);
+    strm->avail_in = msg->data_size - 5;
+    strm->next_out = dest + 5;
+    strm->avail_out = dest_size;
+    while (1)
+    {
+        rc = deflate (strm, Z_SYNC_FLUSH);
+        if ((rc != Z_OK) && (rc != Z_BUF_ERROR))
+        {
+            free (dest);
+            return 0;
+        }
+        if (strm->avail_out > 0)
+            break;
+        /* output buffer is full: grow it and continue to flush */
+        new_dest = realloc (dest, (dest_size * 2) + 5);
+        if (!new_dest)
+        {
+            free (dest);
+            return 0;
+        }
+        dest = new_dest;
+        strm->next_out = dest + 5 + dest_size;
+        strm->avail_out = dest_size;
+        dest_size *= 2;
+    }
+    gettimeofday (&tv2, NULL);
+    time_diff = weechat_util_timeval_diff (&tv1, &tv2);
+    dest_size -= strm->avail_out;
+
+    /* set size and compression flag */
+    size32 = htonl ((uint32_t)(dest_size + 5));
+    memcpy (dest, &size32, 4);
+    dest[4] = RELAY_WEECHAT_COMPRESSION_ZLIB;
+
+    /* message for raw buffer */
+    snprintf (raw_message, raw_message_size,
+              "obj: %d/%d bytes (zlib stream: %d%%, %.2fms), id: %s",
+              (int)dest_size + 5,
+              msg->data_size,
+              100 - ((((int)dest_size + 5) * 100) / msg->data_size),
+              ((float)time_diff) / 1000,
+              msg->id);
+
+    *compressed = (char *)dest;
+    *compressed_size = dest_size + 5;
+
+    return 1;
+}
+
+/*
+ * Compresses the message with the zstd context of client (the context is kept
+ * between messages and flushed after each message).
+ *
+ * The compressed message is allocated, it must be freed after use.
+ *
+ * Returns:
+ *   1: OK, message compressed
+ *   0: error, message not compressed
+ */
+
+int
+relay_weechat_msg_compress_zstd_stream (struct t_relay_client *client,
+                                        struct t_relay_weechat_msg *msg,
+                                        char **compressed,
+                                        int *compressed_size,
+                                        char *raw_message,
+                                        int raw_message_size)
+{
+#ifdef HAVE_ZSTD
+    ZSTD_CCtx *cctx;
+    ZSTD_inBuffer input;
+    ZSTD_outBuffer output;
+    uint32_t size32;
+    char *dest, *new_dest;
+    size_t dest_size, remaining;
+    struct timeval tv1, tv2;
+    long long time_diff;
+    int compression, compression_level;
+
+    cctx = RELAY_WEECHAT_DATA(client, zstd_cctx);
+    if (!cctx)
+    {
+        cctx = ZSTD_createCCtx ();
+        if (!cctx)
+            return 0;
+        /* convert % to zstd compression level (1-19) */
+        compression = weechat_config_integer (relay_config_network_compression);
+        compression_level = (((compression - 1) * 19) / 100) + 1;
+        ZSTD_CCtx_setParameter (cctx, ZSTD_c_compressionLevel,
+                                compression_level);
+        RELAY_WEECHAT_DATA(client, zstd_cctx) = cctx;
+    }
+
+    dest_size = ZSTD_compressBound (msg->data_size - 5) + 32;
+    dest = malloc (dest_size + 5);
+    if (!dest)
+        return 0;
+
+    gettimeofday (&tv1, NULL);
+    input.src = msg->data + 5;
+    input.size = msg->data_size - 5;
+    input.pos = 0;
+    output.dst = dest + 5;
+    output.size = dest_size;
+    output.pos = 0;
+    while (1)
+    {
+        remaining = ZSTD_compressStream2 (cctx, &output, &input, ZSTD_e_flush);
+        if (ZSTD_isError (remaining))
+        {
+            free (dest);
+            return 0;
+        }
+        if (remaining == 0)
+            break;
+        /* output buffer is full: grow it and continue to flush */
+        new_dest = realloc (dest, (dest_size * 2) + 5);
+        if (!new_dest)
+        {
+            free (dest);
+            return 0;
+        }
+        dest = new_dest;
+        dest_size *= 2;
+        output.dst = dest + 5;
+        output.size = dest_size;
+    }
+    gettimeofday (&tv2, NULL);
+    time_diff = weechat_util_timeval_diff (&tv1, &tv2);
+
+    /* set size and compression flag */
+    size32 = htonl ((uint32_t)(output.pos + 5));
+    memcpy (dest, &size32, 4);
+    dest[4] = RELAY_WEECHAT_COMPRESSION_ZSTD;
+
+    /* message for raw buffer */
+    snprintf (raw_message, raw_message_size,
+              "obj: %d/%d bytes (zstd stream: %d%%, %.2fms), id: %s",
+              (int)output.pos + 5,
+              msg->data_size,
+              100 - ((((int)output.pos + 5) * 100) / msg->data_size),
+              ((float)time_diff) / 1000,
+              msg->id);
+
+    *compressed = dest;
+    *compressed_size = output.pos + 5;
+
+    return 1;
 #else
     /* make C compiler happy */
     (void) client;
     (void) msg;
+    (void) compressed;
+    (void) compressed_size;
+    (void) raw_message;
+    (void) raw_message_size;
 
     return 0;
 #endif /* HAVE_ZSTD */
 }
 
+/*
+ * Compresses the message with the streaming compression of client and sends
+ * it.
+ *
+ * Once the stream has started, all messages must be compressed with it (even
+ * if compressed data is bigger than the message), so that the client can
+ * decompress them with a single context.
+ *
+ * Returns:
+ *   1: OK, message compressed and sent
+ *   0: error, message not compressed
+ */
+
+int
+relay_weechat_msg_send_stream (struct t_relay_client *client,
+                               struct t_relay_weechat_msg *msg)
+{
+    char raw_message[1024], *compressed;
+    int compressed_size, rc;
+
+    compressed = NULL;
+    compressed_size = 0;
+
+    switch (RELAY_WEECHAT_DATA(client, compression))
+    {
+        case RELAY_WEECHAT_COMPRESSION_ZLIB:
+            rc = relay_weechat_msg_compress_zlib_stream (
+                client, msg, &compressed, &compressed_size,
+                raw_message, sizeof (raw_message));
+            break;
+#ifdef HAVE_ZSTD
+        case RELAY_WEECHAT_COMPRESSION_ZSTD:
+            rc = relay_weechat_msg_compress_zstd_stream (
+                client, msg, &compressed, &compressed_size,
+                raw_message, sizeof (raw_message));
+            break;
+#endif
+        default:
+            rc = 0;
+            break;
+    }
+
+    if (!rc)
+        return 0;
+
+    relay_client_send (client, RELAY_MSG_STANDARD,
+                       compressed, compressed_size, raw_message);
+    free (compressed);
+
+    return 1;
+}
+
 /*
  * Sends a message.
+ *
+ * The message can be sent to multiple clients: the compressed data is built
+ * on first send with each compression, then reused for next clients
+ * (except with streaming compression, where each client has its own context).
+ *
+ * With streaming compression, messages are sent uncompressed until the
+ * handshake is done, so that the client can read the compression negotiated.
  */
 
 void
@@ -1218,23 +1572,52 @@ relay_weechat_msg_send (struct t_relay_client *client,
 {
     char compression, raw_message[1024];
     uint32_t size32;
+    int compressed;
+
+    compression = RELAY_WEECHAT_DATA(client, compression);
 
-    if (weechat_config_integer (relay_config_network_compression) > 0)
+    if (RELAY_WEECHAT_DATA(client, compression_stream))
+    {
+        if (RELAY_WEECHAT_DATA(client, handshake_done)
+            && (weechat_config_integer (relay_config_network_compression) > 0)
+            && (compression > RELAY_WEECHAT_COMPRESSION_OFF)
+            && (compression < RELAY_WEECHAT_NUM_COMPRESSIONS)
+            && relay_weechat_msg_send_stream (client, msg))
+        {
+            return;
+        }
+    }
+    else if ((compression > RELAY_WEECHAT_COMPRESSION_OFF)
+             && (compression < RELAY_WEECHAT_NUM_COMPRESSIONS)
+             && (weechat_config_integer (relay_config_network_compression) > 0))
     {
-        switch (RELAY_WEECHAT_DATA(client, compression))
+        if (msg->compressed_size[(int)compression] == 0)
         {
-            case RELAY_WEECHAT_COMPRESSION_ZLIB:
-                if (relay_weechat_msg_compress_zlib (client, msg))
-                    return;
-                break;
+            switch (compression)
+            {
+                case RELAY_WEECHAT_COMPRESSION_ZLIB:
+                    compressed = relay_weechat_msg_compress_zlib (msg);
+                    break;
 #ifdef HAVE_ZSTD
-            case RELAY_WEECHAT_COMPRESSION_ZSTD:
-                if (relay_weechat_msg_compress_zstd (client, msg))
-                    return;
-                break;
+                case RELAY_WEECHAT_COMPRESSION_ZSTD:
+                    compressed = relay_weechat_msg_compress_zstd (msg);
+                    break;
 #endif
-            default:
-                break;
+                default:
+                    compressed = 0;
+                    break;
+            }
+            if (!compressed)
+                msg->compressed_size[(int)compression] = -1;
+        }
+        if (msg->compressed_size[(int)compression] > 0)
+        {
+            /* send compressed data */
+            relay_client_send (client, RELAY_MSG_STANDARD,
+                               msg->compressed[(int)compression],
+                               msg->compressed_size[(int)compression],
+                               msg->compressed_raw[(int)compression]);
+            return;
         }
     }
 
@@ -1260,11 +1643,18 @@ relay_weechat_msg_send (struct t_relay_client *client,
 void
 relay_weechat_msg_free (struct t_relay_weechat_msg *msg)
 {
+    int i;
+
     if (!msg)
         return;
 
     free (msg->id);
     free (msg->data);
+    for (i = 0; i < RELAY_WEECHAT_NUM_COMPRESSIONS; i++)
+    {
+        free (msg->compressed[i]);
+        free (msg->compressed_raw[i]);
+    }
 
     free (msg);
 }
@@ -22,6 +22,8 @@
 
 #include <time.h>
 
+#include "relay-weechat.h"
+
 struct t_relay_weechat_nicklist;
 
 #define RELAY_WEECHAT_MSG_INITIAL_ALLOC 4096
@@ -46,6 +48,12 @@ struct t_relay_weechat_msg
     char *data;                        /* binary buffer                     */
     int data_alloc;                    /* currently allocated size          */
     int data_size;                     /* current size of buffer            */
+    /* data compressed (built on first send, shared by all clients) */
+    char *compressed[RELAY_WEECHAT_NUM_COMPRESSIONS]; /* compressed data    */
+    int compressed_size[RELAY_WEECHAT_NUM_COMPRESSIONS]; /* 0 = not built,  */
+                                       /* -1 = not compressed (error or     */
+                                       /* compressed data is too big)       */
+    char *compressed_raw[RELAY_WEECHAT_NUM_COMPRESSIONS]; /* for raw buffer */
 };
 
 extern struct t_relay_weechat_msg *relay_weechat_msg_new (const char *id);
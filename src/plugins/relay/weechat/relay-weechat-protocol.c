@@ -36,6 +36,10 @@
 #include "../relay-raw.h"
 
 
+struct t_relay_weechat_protocol_signal_msg relay_weechat_protocol_signal_msg =
+{ NULL, NULL, NULL, 0, 0, 0, NULL, NULL };
+
+
 /*
  * Gets buffer pointer with argument from a command.
  *
@@ -144,6 +148,102 @@ relay_weechat_protocol_is_sync (struct t_relay_client *ptr_client,
     return 0;
 }
 
+/*
+ * Builds the list of fields of lines sent to a client, with the fields
+ * requested by the client in handshake (separated by colons).
+ *
+ * Fields are kept in the default order, unknown fields are ignored and the
+ * field "buffer" is always sent (the client needs it to find the buffer of
+ * the line).
+ *
+ * Returns the fields separated by commas (to use as hdata keys), NULL if all
+ * fields are requested (then the default list is used).
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+relay_weechat_protocol_line_fields_build (const char *fields)
+{
+    char **requested, **default_fields, **result;
+    int i, num_requested, num_default, count;
+
+    if (!fields || !fields[0])
+        return NULL;
+
+    requested = weechat_string_split (
+        fields,
+        ":",
+        NULL,
+        WEECHAT_STRING_SPLIT_STRIP_LEFT
+        | WEECHAT_STRING_SPLIT_STRIP_RIGHT
+        | WEECHAT_STRING_SPLIT_COLLAPSE_SEPS,
+        0,
+        &num_requested);
+    if (!requested)
+        return NULL;
+
+    default_fields = weechat_string_split (
+        RELAY_WEECHAT_PROTOCOL_LINE_FIELDS,
+        ",",
+        NULL,
+        0,
+        0,
+        &num_default);
+    if (!default_fields)
+    {
+        weechat_string_free_split (requested);
+        return NULL;
+    }
+
+    result = weechat_string_dyn_alloc (128);
+    if (!result)
+    {
+        weechat_string_free_split (requested);
+        weechat_string_free_split (default_fields);
+        return NULL;
+    }
+
+    count = 0;
+    for (i = 0; i < num_default; i++)
+    {
+        if ((strcmp (default_fields[i], "buffer") == 0)
+            || weechat_string_match_list (default_fields[i],
+                                          (const char **)requested, 1))
+        {
+            if (count > 0)
+                weechat_string_dyn_concat (result, ",", -1);
+            weechat_string_dyn_concat (result, default_fields[i], -1);
+            count++;
+        }
+    }
+
+    weechat_string_free_split (requested);
+    weechat_string_free_split (default_fields);
+
+    /* all fields requested: use the default list */
+    if (count == num_default)
+    {
+        weechat_string_dyn_free (result, 1);
+        return NULL;
+    }
+
+    return weechat_string_dyn_free (result, 0);
+}
+
+/*
+ * Returns the fields of lines sent to a client (separated by commas).
+ */
+
+const char *
+relay_weechat_protocol_line_fields (struct t_relay_client *client)
+{
+    return (client && client->protocol_data
+            && RELAY_WEECHAT_DATA(client, line_fields)) ?
+        RELAY_WEECHAT_DATA(client, line_fields) :
+        RELAY_WEECHAT_PROTOCOL_LINE_FIELDS;
+}
+
 /*
  * Replies to a client handshake command.
  */
@@ -154,7 +254,7 @@ relay_weechat_protocol_handshake_reply (struct t_relay_client *client,
 {
     struct t_relay_weechat_msg *msg;
     struct t_hashtable *hashtable;
-    char *totp_secret, string[64];
+    char *totp_secret, *line_fields, string[64];
 
     totp_secret = weechat_string_eval_expression (
         weechat_config_string (relay_config_network_totp_secret),
@@ -189,11 +289,17 @@ relay_weechat_protocol_handshake_reply (struct t_relay_client *client,
         weechat_hashtable_set (
             hashtable,
             "compression",
+            (RELAY_WEECHAT_DATA(client, compression_stream)) ?
+            relay_weechat_compression_stream_string[RELAY_WEECHAT_DATA(client, compression)] :
             relay_weechat_compression_string[RELAY_WEECHAT_DATA(client, compression)]);
         weechat_hashtable_set (
             hashtable,
             "escape_commands",
             RELAY_WEECHAT_DATA(client, escape_commands) ? "on" : "off");
+        line_fields = weechat_string_replace (
+            relay_weechat_protocol_line_fields (client), ",", ":");
+        weechat_hashtable_set (hashtable, "line_fields", line_fields);
+        free (line_fields);
 
         msg = relay_weechat_msg_new (id);
         if (msg)
@@ -280,7 +386,8 @@ RELAY_WEECHAT_PROTOCOL_CALLBACK(handshake)
                         weechat_string_free_split (auths);
                     }
                 }
-                else if (strcmp (options[i], "compression") == 0)
+                else if ((strcmp (options[i], "compression") == 0)
+                         && relay_client_compression_allowed (client))
                 {
                     compressions = weechat_string_split (
                         pos,
@@ -301,6 +408,13 @@ RELAY_WEECHAT_PROTOCOL_CALLBACK(handshake)
                                 RELAY_WEECHAT_DATA(client, compression) = compression;
                                 break;
                             }
+                            compression = relay_weechat_compression_stream_search (compressions[j]);
+                            if (compression >= 0)
+                            {
+                                RELAY_WEECHAT_DATA(client, compression) = compression;
+                                RELAY_WEECHAT_DATA(client, compression_stream) = 1;
+                                break;
+                            }
                         }
                         weechat_string_free_split (compressions);
                     }
@@ -311,6 +425,12 @@ RELAY_WEECHAT_PROTOCOL_CALLBACK(handshake)
                         (weechat_strcmp (pos, "on") == 0) ?
                         1 : 0;
                 }
+                else if (strcmp (options[i], "line_fields") == 0)
+                {
+                    free (RELAY_WEECHAT_DATA(client, line_fields));
+                    RELAY_WEECHAT_DATA(client, line_fields) =
+                        relay_weechat_protocol_line_fields_build (pos);
+                }
             }
         }
         weechat_string_free_split_command (options);
@@ -829,6 +949,186 @@ error:
     return WEECHAT_RC_OK;
 }
 
+/*
+ * Resets message shared by clients for a signal.
+ */
+
+void
+relay_weechat_protocol_signal_msg_reset ()
+{
+    free (relay_weechat_protocol_signal_msg.signal);
+    relay_weechat_protocol_signal_msg.signal = NULL;
+    relay_weechat_protocol_signal_msg.signal_data = NULL;
+    relay_weechat_protocol_signal_msg.num_clients = 0;
+    relay_weechat_protocol_signal_msg.generation++;
+    if (relay_weechat_protocol_signal_msg.msg)
+    {
+        relay_weechat_msg_free (relay_weechat_protocol_signal_msg.msg);
+        relay_weechat_protocol_signal_msg.msg = NULL;
+    }
+    free (relay_weechat_protocol_signal_msg.keys);
+    relay_weechat_protocol_signal_msg.keys = NULL;
+}
+
+/*
+ * Frees message shared by clients for a signal.
+ */
+
+void
+relay_weechat_protocol_signal_msg_free ()
+{
+    relay_weechat_protocol_signal_msg_reset ();
+    free (relay_weechat_protocol_signal_msg.clients);
+    relay_weechat_protocol_signal_msg.clients = NULL;
+    relay_weechat_protocol_signal_msg.size_clients = 0;
+}
+
+/*
+ * Starts handling of a signal for a client: if the signal is not the one
+ * already handled for other clients, or if this client was already called
+ * for this signal (so this is a new signal with same data), the shared
+ * message is reset.
+ */
+
+void
+relay_weechat_protocol_signal_msg_start (struct t_relay_client *client,
+                                         const char *signal,
+                                         void *signal_data)
+{
+    int i, new_size, *new_clients;
+
+    if (!relay_weechat_protocol_signal_msg.signal
+        || (strcmp (relay_weechat_protocol_signal_msg.signal, signal) != 0)
+        || (relay_weechat_protocol_signal_msg.signal_data != signal_data))
+    {
+        relay_weechat_protocol_signal_msg_reset ();
+        relay_weechat_protocol_signal_msg.signal = strdup (signal);
+        relay_weechat_protocol_signal_msg.signal_data = signal_data;
+    }
+    else
+    {
+        for (i = 0; i < relay_weechat_protocol_signal_msg.num_clients; i++)
+        {
+            if (relay_weechat_protocol_signal_msg.clients[i] == client->id)
+            {
+                relay_weechat_protocol_signal_msg_reset ();
+                relay_weechat_protocol_signal_msg.signal = strdup (signal);
+                relay_weechat_protocol_signal_msg.signal_data = signal_data;
+                break;
+            }
+        }
+    }
+
+    if (relay_weechat_protocol_signal_msg.num_clients
+        >= relay_weechat_protocol_signal_msg.size_clients)
+    {
+        new_size = (relay_weechat_protocol_signal_msg.size_clients > 0) ?
+            relay_weechat_protocol_signal_msg.size_clients * 2 : 8;
+        new_clients = realloc (relay_weechat_protocol_signal_msg.clients,
+                               new_size * sizeof (new_clients[0]));
+        if (!new_clients)
+        {
+            /* not enough memory: the message will not be shared */
+            relay_weechat_protocol_signal_msg_reset ();
+            return;
+        }
+        relay_weechat_protocol_signal_msg.clients = new_clients;
+        relay_weechat_protocol_signal_msg.size_clients = new_size;
+    }
+    relay_weechat_protocol_signal_msg.clients[
+        relay_weechat_protocol_signal_msg.num_clients++] = client->id;
+}
+
+/*
+ * Sends a hdata message for a signal to a client.
+ *
+ * The message is built only once for all clients receiving the signal
+ * (see function relay_weechat_protocol_signal_msg_start).
+ */
+
+void
+relay_weechat_protocol_signal_send_hdata (struct t_relay_client *client,
+                                          const char *id,
+                                          const char *path,
+                                          const char *keys)
+{
+    struct t_relay_weechat_msg *msg;
+    int generation;
+
+    /*
+     * take the message while it is sent: it can be reset by a signal sent
+     * during the send (for example if client is disconnected)
+     */
+    msg = NULL;
+    if (relay_weechat_protocol_signal_msg.msg
+        && (weechat_strcmp (relay_weechat_protocol_signal_msg.keys, keys) == 0))
+    {
+        msg = relay_weechat_protocol_signal_msg.msg;
+        relay_weechat_protocol_signal_msg.msg = NULL;
+    }
+    if (!msg)
+    {
+        msg = relay_weechat_msg_new (id);
+        if (!msg)
+            return;
+        relay_weechat_msg_add_hdata (msg, path, keys);
+    }
+
+    generation = relay_weechat_protocol_signal_msg.generation;
+
+    relay_weechat_msg_send (client, msg);
+
+    /*
+     * keep message for next clients, if still handling the same signal
+     * (if the message built for other keys is still kept, the new one is
+     * not kept: clients with same keys as the first one reuse its message)
+     */
+    if (relay_weechat_protocol_signal_msg.signal
+        && (relay_weechat_protocol_signal_msg.generation == generation)
+        && !relay_weechat_protocol_signal_msg.msg)
+    {
+        relay_weechat_protocol_signal_msg.msg = msg;
+        if (weechat_strcmp (relay_weechat_protocol_signal_msg.keys, keys) != 0)
+        {
+            free (relay_weechat_protocol_signal_msg.keys);
+            relay_weechat_protocol_signal_msg.keys = (keys) ? strdup (keys) : NULL;
+        }
+    }
+    else
+    {
+        relay_weechat_msg_free (msg);
+    }
+}
+
+/*
+ * Sends the last lines of a buffer, which were not sent to the client
+ * because its outqueue was full (message "_buffer_resync").
+ */
+
+void
+relay_weechat_protocol_send_buffer_resync (struct t_relay_client *client,
+                                           struct t_gui_buffer *buffer,
+                                           int num_lines)
+{
+    struct t_relay_weechat_msg *msg;
+    char cmd_hdata[128];
+
+    if (!client || !buffer || (num_lines <= 0))
+        return;
+
+    msg = relay_weechat_msg_new ("_buffer_resync");
+    if (!msg)
+        return;
+
+    snprintf (cmd_hdata, sizeof (cmd_hdata),
+              "buffer:0x%lx/own_lines/last_line(-%d)/data",
+              (unsigned long)buffer, num_lines);
+    relay_weechat_msg_add_hdata (
+        msg, cmd_hdata, relay_weechat_protocol_line_fields (client));
+    relay_weechat_msg_send (client, msg);
+    relay_weechat_msg_free (msg);
+}
+
 /*
  * Callback for signals "buffer_*".
  */
@@ -843,7 +1143,6 @@ relay_weechat_protocol_signal_buffer_cb (const void *pointer, void *data,
     struct t_gui_line *ptr_line;
     struct t_gui_line_data *ptr_line_data;
     struct t_gui_buffer *ptr_buffer;
-    struct t_relay_weechat_msg *msg;
     char cmd_hdata[64], str_signal[128];
     const char *ptr_old_full_name;
     int *ptr_old_flags, flags;
@@ -858,6 +1157,8 @@ relay_weechat_protocol_signal_buffer_cb (const void *pointer, void *data,
 
     snprintf (str_signal, sizeof (str_signal), "_%s", signal);
 
+    relay_weechat_protocol_signal_msg_start (ptr_client, signal, signal_data);
+
     if (strcmp (signal, "buffer_opened") == 0)
     {
         ptr_buffer = (struct t_gui_buffer *)signal_data;
@@ -869,18 +1170,13 @@ relay_weechat_protocol_signal_buffer_cb (const void *pointer, void *data,
                                             RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
                                             RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
         {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "buffer:0x%lx", (unsigned long)ptr_buffer);
-                relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "id,number,full_name,short_name,"
-                                             "nicklist,title,local_variables,"
-                                             "prev_buffer,next_buffer");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
+            snprintf (cmd_hdata, sizeof (cmd_hdata),
+                      "buffer:0x%lx", (unsigned long)ptr_buffer);
+            relay_weechat_protocol_signal_send_hdata (
+                ptr_client, str_signal, cmd_hdata,
+                "id,number,full_name,short_name,"
+                "nicklist,title,local_variables,"
+                "prev_buffer,next_buffer");
         }
     }
     else if (strcmp (signal, "buffer_type_changed") == 0)
@@ -894,16 +1190,11 @@ relay_weechat_protocol_signal_buffer_cb (const void *pointer, void *data,
                                             RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
                                             RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
         {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "buffer:0x%lx", (unsigned long)ptr_buffer);
-                relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "id,number,full_name,type");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
+            snprintf (cmd_hdata, sizeof (cmd_hdata),
+                      "buffer:0x%lx", (unsigned long)ptr_buffer);
+            relay_weechat_protocol_signal_send_hdata (
+                ptr_client, str_signal, cmd_hdata,
+                "id,number,full_name,type");
         }
     }
     else if (strcmp (signal, "buffer_moved") == 0)
@@ -917,17 +1208,27 @@ relay_weechat_protocol_signal_buffer_cb (const void *pointer, void *data,
                                             RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
                                             RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
         {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "buffer:0x%lx", (unsigned long)ptr_buffer);
-                relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "id,number,full_name,"
-                                             "prev_buffer,next_buffer");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
+            snprintf (cmd_hdata, sizeof (cmd_hdata),
+                      "buffer:0x%lx", (unsigned long)ptr_buffer);
+            relay_weechat_protocol_signal_send_hdata (
+                ptr_client, str_signal, cmd_hdata,
+                "id,number,full_name,"
+                "prev_buffer,next_buffer");
+        }
+    }
+    else if (strcmp (signal, "buffer_list_reordered") == 0)
+    {
+        /*
+         * all buffers may have moved: send a single message "_buffer_moved"
+         * with all buffers (instead of one message per buffer)
+         */
+        if (relay_weechat_protocol_is_sync (ptr_client, NULL,
+                                            RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS))
+        {
+            relay_weechat_protocol_signal_send_hdata (
+                ptr_client, "_buffer_moved", "buffer:gui_buffers(*)",
+                "id,number,full_name,"
+                "prev_buffer,next_buffer");
         }
     }
     else if ((strcmp (signal, "buffer_merged") == 0)
@@ -942,17 +1243,12 @@ relay_weechat_protocol_signal_buffer_cb (const void *pointer, void *data,
                                             RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
                                             RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
         {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "buffer:0x%lx", (unsigned long)ptr_buffer);
-                relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "id,number,full_name,"
-                                             "prev_buffer,next_buffer");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
+            snprintf (cmd_hdata, sizeof (cmd_hdata),
+                      "buffer:0x%lx", (unsigned long)ptr_buffer);
+            relay_weechat_protocol_signal_send_hdata (
+                ptr_client, str_signal, cmd_hdata,
+                "id,number,full_name,"
+                "prev_buffer,next_buffer");
         }
     }
     else if ((strcmp (signal, "buffer_hidden") == 0)
@@ -967,17 +1263,12 @@ relay_weechat_protocol_signal_buffer_cb (const void *pointer, void *data,
                                             RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
                                             RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
         {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "buffer:0x%lx", (unsigned long)ptr_buffer);
-                relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "id,number,full_name,"
-                                             "prev_buffer,next_buffer");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
+            snprintf (cmd_hdata, sizeof (cmd_hdata),
+                      "buffer:0x%lx", (unsigned long)ptr_buffer);
+            relay_weechat_protocol_signal_send_hdata (
+                ptr_client, str_signal, cmd_hdata,
+                "id,number,full_name,"
+                "prev_buffer,next_buffer");
         }
     }
     else if (strcmp (signal, "buffer_renamed") == 0)
@@ -1012,17 +1303,12 @@ relay_weechat_protocol_signal_buffer_cb (const void *pointer, void *data,
                                             RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
                                             RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
         {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "buffer:0x%lx", (unsigned long)ptr_buffer);
-                relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "id,number,full_name,short_name,"
-                                             "local_variables");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
+            snprintf (cmd_hdata, sizeof (cmd_hdata),
+                      "buffer:0x%lx", (unsigned long)ptr_buffer);
+            relay_weechat_protocol_signal_send_hdata (
+                ptr_client, str_signal, cmd_hdata,
+                "id,number,full_name,short_name,"
+                "local_variables");
         }
     }
     else if (strcmp (signal, "buffer_title_changed") == 0)
@@ -1036,16 +1322,11 @@ relay_weechat_protocol_signal_buffer_cb (const void *pointer, void *data,
                                             RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
                                             RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
         {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "buffer:0x%lx", (unsigned long)ptr_buffer);
-                relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "id,number,full_name,title");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
+            snprintf (cmd_hdata, sizeof (cmd_hdata),
+                      "buffer:0x%lx", (unsigned long)ptr_buffer);
+            relay_weechat_protocol_signal_send_hdata (
+                ptr_client, str_signal, cmd_hdata,
+                "id,number,full_name,title");
         }
     }
     else if (strncmp (signal, "buffer_localvar_", 16) == 0)
@@ -1059,16 +1340,11 @@ relay_weechat_protocol_signal_buffer_cb (const void *pointer, void *data,
                                             RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
                                             RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
         {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "buffer:0x%lx", (unsigned long)ptr_buffer);
-                relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "id,number,full_name,local_variables");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
+            snprintf (cmd_hdata, sizeof (cmd_hdata),
+                      "buffer:0x%lx", (unsigned long)ptr_buffer);
+            relay_weechat_protocol_signal_send_hdata (
+                ptr_client, str_signal, cmd_hdata,
+                "id,number,full_name,local_variables");
         }
     }
     else if (strcmp (signal, "buffer_cleared") == 0)
@@ -1081,16 +1357,11 @@ relay_weechat_protocol_signal_buffer_cb (const void *pointer, void *data,
         if (relay_weechat_protocol_is_sync (ptr_client, ptr_buffer,
                                             RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
         {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "buffer:0x%lx", (unsigned long)ptr_buffer);
-                relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "id,number,full_name");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
+            snprintf (cmd_hdata, sizeof (cmd_hdata),
+                      "buffer:0x%lx", (unsigned long)ptr_buffer);
+            relay_weechat_protocol_signal_send_hdata (
+                ptr_client, str_signal, cmd_hdata,
+                "id,number,full_name");
         }
     }
     else if (strcmp (signal, "buffer_line_added") == 0)
@@ -1112,20 +1383,15 @@ relay_weechat_protocol_signal_buffer_cb (const void *pointer, void *data,
         if (relay_weechat_protocol_is_sync (ptr_client, ptr_buffer,
                                             RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
         {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "line_data:0x%lx",
-                          (unsigned long)ptr_line_data);
-                relay_weechat_msg_add_hdata (
-                    msg, cmd_hdata,
-                    "buffer,id,date,date_usec,date_printed,date_usec_printed,"
-                    "displayed,notify_level,highlight,tags_array,"
-                    "prefix,message");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
+            /* outqueue full: line is sent later in message "_buffer_resync" */
+            if (relay_client_outqueue_drop_line (ptr_client, ptr_buffer))
+                return WEECHAT_RC_OK;
+            snprintf (cmd_hdata, sizeof (cmd_hdata),
+                      "line_data:0x%lx",
+                      (unsigned long)ptr_line_data);
+            relay_weechat_protocol_signal_send_hdata (
+                ptr_client, str_signal, cmd_hdata,
+                relay_weechat_protocol_line_fields (ptr_client));
         }
     }
     else if (strcmp (signal, "buffer_line_data_changed") == 0)
@@ -1143,20 +1409,12 @@ relay_weechat_protocol_signal_buffer_cb (const void *pointer, void *data,
         if (relay_weechat_protocol_is_sync (ptr_client, ptr_buffer,
                                             RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
         {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "line_data:0x%lx",
-                          (unsigned long)ptr_line_data);
-                relay_weechat_msg_add_hdata (
-                    msg, cmd_hdata,
-                    "buffer,id,date,date_usec,date_printed,date_usec_printed,"
-                    "displayed,notify_level,highlight,tags_array,"
-                    "prefix,message");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
+            snprintf (cmd_hdata, sizeof (cmd_hdata),
+                      "line_data:0x%lx",
+                      (unsigned long)ptr_line_data);
+            relay_weechat_protocol_signal_send_hdata (
+                ptr_client, str_signal, cmd_hdata,
+                relay_weechat_protocol_line_fields (ptr_client));
         }
     }
     else if (strcmp (signal, "buffer_closing") == 0)
@@ -1170,16 +1428,11 @@ relay_weechat_protocol_signal_buffer_cb (const void *pointer, void *data,
                                             RELAY_WEECHAT_PROTOCOL_SYNC_BUFFERS |
                                             RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER))
         {
-            msg = relay_weechat_msg_new (str_signal);
-            if (msg)
-            {
-                snprintf (cmd_hdata, sizeof (cmd_hdata),
-                          "buffer:0x%lx", (unsigned long)ptr_buffer);
-                relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "id,number,full_name");
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
-            }
+            snprintf (cmd_hdata, sizeof (cmd_hdata),
+                      "buffer:0x%lx", (unsigned long)ptr_buffer);
+            relay_weechat_protocol_signal_send_hdata (
+                ptr_client, str_signal, cmd_hdata,
+                "id,number,full_name");
         }
 
         /* remove buffer from hashtables */
@@ -35,6 +35,11 @@
     (RELAY_WEECHAT_PROTOCOL_SYNC_BUFFER |       \
      RELAY_WEECHAT_PROTOCOL_SYNC_NICKLIST)
 
+/* fields of lines sent to clients (all fields by default) */
+#define RELAY_WEECHAT_PROTOCOL_LINE_FIELDS                              \
+    "buffer,id,date,date_usec,date_printed,date_usec_printed,"          \
+    "displayed,notify_level,highlight,tags_array,prefix,message"
+
 #define RELAY_WEECHAT_PROTOCOL_CALLBACK(__command)                      \
     int                                                                 \
     relay_weechat_protocol_cb_##__command (                             \
@@ -81,6 +86,40 @@ struct t_relay_weechat_protocol_cb
     t_relay_weechat_cmd_func *cmd_function; /* callback                     */
 };
 
+/*
+ * message built for a signal "buffer_*": the message is the same for all
+ * clients, so it is built by the first client and then sent as-is to other
+ * clients receiving the same signal
+ */
+
+struct t_relay_weechat_protocol_signal_msg
+{
+    char *signal;                      /* signal name                       */
+    void *signal_data;                 /* signal data                       */
+    int *clients;                      /* ids of clients called for signal  */
+    int num_clients;                   /* number of clients called          */
+    int size_clients;                  /* allocated size for "clients"      */
+    int generation;                    /* incremented on each reset         */
+    struct t_relay_weechat_msg *msg;   /* message built (NULL if none)      */
+    char *keys;                        /* keys of hdata in message built    */
+};
+
+extern struct t_relay_weechat_protocol_signal_msg relay_weechat_protocol_signal_msg;
+
+extern char *relay_weechat_protocol_line_fields_build (const char *fields);
+extern const char *relay_weechat_protocol_line_fields (struct t_relay_client *client);
+extern void relay_weechat_protocol_signal_msg_reset ();
+extern void relay_weechat_protocol_signal_msg_free ();
+extern void relay_weechat_protocol_signal_msg_start (struct t_relay_client *client,
+                                                     const char *signal,
+                                                     void *signal_data);
+extern void relay_weechat_protocol_signal_send_hdata (struct t_relay_client *client,
+                                                      const char *id,
+                                                      const char *path,
+                                                      const char *keys);
+extern void relay_weechat_protocol_send_buffer_resync (struct t_relay_client *client,
+                                                      struct t_gui_buffer *buffer,
+                                                      int num_lines);
 extern int relay_weechat_protocol_signal_buffer_cb (const void *pointer,
                                                     void *data,
                                                     const char *signal,
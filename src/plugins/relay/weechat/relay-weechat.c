@@ -29,6 +29,10 @@
 #include <sys/time.h>
 #include <errno.h>
 #include <arpa/inet.h>
+#include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
 
 #include "../../weechat-plugin.h"
 #include "../relay.h"
@@ -49,6 +53,15 @@ char *relay_weechat_compression_string[RELAY_WEECHAT_NUM_COMPRESSIONS] = {
 #endif
 };
 
+/* strings for compression with a context kept between messages */
+char *relay_weechat_compression_stream_string[RELAY_WEECHAT_NUM_COMPRESSIONS] = {
+    NULL,
+    "zlib_stream",
+#ifdef HAVE_ZSTD
+    "zstd_stream",
+#endif
+};
+
 
 /*
  * Searches for a compression.
@@ -75,6 +88,35 @@ relay_weechat_compression_search (const char *compression)
     return -1;
 }
 
+/*
+ * Searches for a streaming compression (context kept between messages).
+ *
+ * Returns index of compression in enum t_relay_weechat_compression, -1 if
+ * compression is not found.
+ */
+
+int
+relay_weechat_compression_stream_search (const char *compression)
+{
+    int i;
+
+    if (!compression)
+        return -1;
+
+    for (i = 0; i < RELAY_WEECHAT_NUM_COMPRESSIONS; i++)
+    {
+        if (relay_weechat_compression_stream_string[i]
+            && (strcmp (relay_weechat_compression_stream_string[i],
+                        compression) == 0))
+        {
+            return i;
+        }
+    }
+
+    /* compression not found */
+    return -1;
+}
+
 /*
  * Hooks signals for a client.
  */
@@ -123,6 +165,9 @@ relay_weechat_unhook_signals (struct t_relay_client *client)
         weechat_unhook (RELAY_WEECHAT_DATA(client, hook_timer_nicklist));
         RELAY_WEECHAT_DATA(client, hook_timer_nicklist) = NULL;
     }
+
+    /* message shared with other clients may have been built by this client */
+    relay_weechat_protocol_signal_msg_free ();
 }
 
 /*
@@ -195,7 +240,9 @@ relay_weechat_alloc (struct t_relay_client *client)
     RELAY_WEECHAT_DATA(client, password_ok) = 0;
     RELAY_WEECHAT_DATA(client, totp_ok) = 0;
     RELAY_WEECHAT_DATA(client, compression) = RELAY_WEECHAT_COMPRESSION_OFF;
+    RELAY_WEECHAT_DATA(client, compression_stream) = 0;
     RELAY_WEECHAT_DATA(client, escape_commands) = 0;
+    RELAY_WEECHAT_DATA(client, line_fields) = NULL;
     RELAY_WEECHAT_DATA(client, buffers_sync) =
         weechat_hashtable_new (32,
                                WEECHAT_HASHTABLE_STRING,
@@ -213,6 +260,8 @@ relay_weechat_alloc (struct t_relay_client *client)
                                    "callback_free_value",
                                    &relay_weechat_free_buffers_nicklist);
     RELAY_WEECHAT_DATA(client, hook_timer_nicklist) = NULL;
+    RELAY_WEECHAT_DATA(client, zlib_stream) = NULL;
+    RELAY_WEECHAT_DATA(client, zstd_cctx) = NULL;
 
     relay_weechat_hook_signals (client);
 }
@@ -250,8 +299,23 @@ relay_weechat_alloc_with_infolist (struct t_relay_client *client,
         RELAY_WEECHAT_DATA(client, totp_ok) = 1;
     RELAY_WEECHAT_DATA(client, compression) = weechat_infolist_integer (
         infolist, "compression");
+    /*
+     * "compression_stream" is new in WeeChat 4.4.0; the compression context
+     * can not be restored after upgrade, so the messages are not compressed
+     * any more (the client can always decode uncompressed messages)
+     */
+    RELAY_WEECHAT_DATA(client, compression_stream) = 0;
+    if (weechat_infolist_search_var (infolist, "compression_stream")
+        && weechat_infolist_integer (infolist, "compression_stream"))
+    {
+        RELAY_WEECHAT_DATA(client, compression) = RELAY_WEECHAT_COMPRESSION_OFF;
+    }
     RELAY_WEECHAT_DATA(client, escape_commands) = weechat_infolist_integer (
         infolist, "escape_commands");
+    /* "line_fields" is new in WeeChat 4.4.0 */
+    key = weechat_infolist_string (infolist, "line_fields");
+    RELAY_WEECHAT_DATA(client, line_fields) = (key && key[0]) ?
+        strdup (key) : NULL;
 
     /* sync of buffers */
     RELAY_WEECHAT_DATA(client, buffers_sync) = weechat_hashtable_new (
@@ -285,6 +349,8 @@ relay_weechat_alloc_with_infolist (struct t_relay_client *client,
                                    "callback_free_value",
                                    &relay_weechat_free_buffers_nicklist);
     RELAY_WEECHAT_DATA(client, hook_timer_nicklist) = NULL;
+    RELAY_WEECHAT_DATA(client, zlib_stream) = NULL;
+    RELAY_WEECHAT_DATA(client, zstd_cctx) = NULL;
 
     if (!RELAY_STATUS_HAS_ENDED(client->status))
         relay_weechat_hook_signals (client);
@@ -317,12 +383,21 @@ relay_weechat_free (struct t_relay_client *client)
 
     if (client->protocol_data)
     {
+        free (RELAY_WEECHAT_DATA(client, line_fields));
         weechat_hashtable_free (RELAY_WEECHAT_DATA(client, buffers_sync));
         weechat_unhook (RELAY_WEECHAT_DATA(client, hook_signal_buffer));
         weechat_unhook (RELAY_WEECHAT_DATA(client, hook_hsignal_nicklist));
         weechat_unhook (RELAY_WEECHAT_DATA(client, hook_signal_upgrade));
         weechat_hashtable_free (RELAY_WEECHAT_DATA(client, buffers_nicklist));
         weechat_unhook (RELAY_WEECHAT_DATA(client, hook_timer_nicklist));
+        if (RELAY_WEECHAT_DATA(client, zlib_stream))
+        {
+            deflateEnd (RELAY_WEECHAT_DATA(client, zlib_stream));
+            free (RELAY_WEECHAT_DATA(client, zlib_stream));
+        }
+#ifdef HAVE_ZSTD
+        ZSTD_freeCCtx (RELAY_WEECHAT_DATA(client, zstd_cctx));
+#endif
 
         free (client->protocol_data);
 
@@ -361,8 +436,12 @@ relay_weechat_add_to_infolist (struct t_infolist_item *item,
         return 0;
     if (!weechat_infolist_new_var_integer (item, "compression", RELAY_WEECHAT_DATA(client, compression)))
         return 0;
+    if (!weechat_infolist_new_var_integer (item, "compression_stream", RELAY_WEECHAT_DATA(client, compression_stream)))
+        return 0;
     if (!weechat_infolist_new_var_integer (item, "escape_commands", RELAY_WEECHAT_DATA(client, escape_commands)))
         return 0;
+    if (!weechat_infolist_new_var_string (item, "line_fields", RELAY_WEECHAT_DATA(client, line_fields)))
+        return 0;
     if (!weechat_hashtable_add_to_infolist (RELAY_WEECHAT_DATA(client, buffers_sync), item, "buffers_sync"))
         return 0;
 
@@ -382,7 +461,9 @@ relay_weechat_print_log (struct t_relay_client *client)
         weechat_log_printf ("    password_ok . . . . . . : %d", RELAY_WEECHAT_DATA(client, password_ok));
         weechat_log_printf ("    totp_ok . . . . . . . . : %d", RELAY_WEECHAT_DATA(client, totp_ok));
         weechat_log_printf ("    compression . . . . . . : %d", RELAY_WEECHAT_DATA(client, compression));
+        weechat_log_printf ("    compression_stream. . . : %d", RELAY_WEECHAT_DATA(client, compression_stream));
         weechat_log_printf ("    escape_commands . . . . : %d", RELAY_WEECHAT_DATA(client, escape_commands));
+        weechat_log_printf ("    line_fields . . . . . . : '%s'", RELAY_WEECHAT_DATA(client, line_fields));
         weechat_log_printf ("    buffers_sync. . . . . . : %p (hashtable: '%s')",
                             RELAY_WEECHAT_DATA(client, buffers_sync),
                             weechat_hashtable_get_string (RELAY_WEECHAT_DATA(client, buffers_sync),
@@ -395,5 +476,7 @@ relay_weechat_print_log (struct t_relay_client *client)
                             weechat_hashtable_get_string (RELAY_WEECHAT_DATA(client, buffers_nicklist),
                                                           "keys_values"));
         weechat_log_printf ("    hook_timer_nicklist . . : %p", RELAY_WEECHAT_DATA(client, hook_timer_nicklist));
+        weechat_log_printf ("    zlib_stream . . . . . . : %p", RELAY_WEECHAT_DATA(client, zlib_stream));
+        weechat_log_printf ("    zstd_cctx . . . . . . . : %p", RELAY_WEECHAT_DATA(client, zstd_cctx));
     }
 }
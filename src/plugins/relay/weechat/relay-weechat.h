@@ -41,6 +41,9 @@ enum t_relay_weechat_compression
     RELAY_WEECHAT_NUM_COMPRESSIONS,
 };
 
+struct z_stream_s;
+struct ZSTD_CCtx_s;
+
 struct t_relay_weechat_data
 {
     /* handshake status */
@@ -48,8 +51,12 @@ struct t_relay_weechat_data
 
     /* handshake options */
     enum t_relay_weechat_compression compression; /* compression type       */
+    int compression_stream;            /* 1 if compression context is kept  */
+                                       /* between messages (streaming)      */
     int escape_commands;               /* 1 if backslashes are interpreted  */
                                        /* in commands sent by client        */
+    char *line_fields;                 /* fields of lines sent to client    */
+                                       /* (NULL = all fields)               */
 
     /* authentication status (init command) */
     int password_ok;                   /* password received and OK?         */
@@ -63,11 +70,17 @@ struct t_relay_weechat_data
     struct t_hook *hook_signal_upgrade;   /* hook for signals "upgrade*"    */
     struct t_hashtable *buffers_nicklist; /* send nicklist for these buffers*/
     struct t_hook *hook_timer_nicklist;   /* timer for sending nicklist     */
+
+    /* streaming compression (contexts created on first compressed message) */
+    struct z_stream_s *zlib_stream;    /* zlib stream (deflate)             */
+    struct ZSTD_CCtx_s *zstd_cctx;     /* zstd compression context          */
 };
 
 extern char *relay_weechat_compression_string[];
+extern char *relay_weechat_compression_stream_string[];
 
 extern int relay_weechat_compression_search (const char *compression);
+extern int relay_weechat_compression_stream_search (const char *compression);
 extern void relay_weechat_hook_signals (struct t_relay_client *client);
 extern void relay_weechat_unhook_signals (struct t_relay_client *client);
 extern void relay_weechat_hook_timer_nicklist (struct t_relay_client *client);
@@ -6723,6 +6723,40 @@ weechat_ruby_api_hdata_hashtable (VALUE class, VALUE hdata, VALUE pointer,
     return result_hash;
 }
 
+static VALUE
+weechat_ruby_api_hdata_get_fields (VALUE class, VALUE hdata, VALUE pointer,
+                                   VALUE count, VALUE fields)
+{
+    char *c_hdata, *c_pointer, *c_fields;
+    struct t_hashtable *result_hashtable;
+    int c_count;
+    VALUE result_hash;
+
+    API_INIT_FUNC(1, "hdata_get_fields", API_RETURN_EMPTY);
+    if (NIL_P (hdata) || NIL_P (pointer) || NIL_P (count) || NIL_P (fields))
+        API_WRONG_ARGS(API_RETURN_EMPTY);
+
+    Check_Type (hdata, T_STRING);
+    Check_Type (pointer, T_STRING);
+    CHECK_INTEGER(count);
+    Check_Type (fields, T_STRING);
+
+    c_hdata = StringValuePtr (hdata);
+    c_pointer = StringValuePtr (pointer);
+    c_count = NUM2INT (count);
+    c_fields = StringValuePtr (fields);
+
+    result_hashtable = weechat_hdata_get_fields (API_STR2PTR(c_hdata),
+                                                 API_STR2PTR(c_pointer),
+                                                 c_count,
+                                                 c_fields);
+    result_hash = weechat_ruby_hashtable_to_hash (result_hashtable);
+
+    weechat_hashtable_free (result_hashtable);
+
+    return result_hash;
+}
+
 static VALUE
 weechat_ruby_api_hdata_compare (VALUE class, VALUE hdata,
                                 VALUE pointer1, VALUE pointer2, VALUE name,
@@ -7179,6 +7213,7 @@ weechat_ruby_api_init (VALUE ruby_mWeechat)
     API_DEF_FUNC(hdata_pointer, 3);
     API_DEF_FUNC(hdata_time, 3);
     API_DEF_FUNC(hdata_hashtable, 3);
+    API_DEF_FUNC(hdata_get_fields, 4);
     API_DEF_FUNC(hdata_compare, 5);
     API_DEF_FUNC(hdata_update, 3);
     API_DEF_FUNC(hdata_get_string, 2);
@@ -71,6 +71,7 @@ struct t_plugin_script_data ruby_data;
 struct t_config_file *ruby_config_file = NULL;
 struct t_config_option *ruby_config_look_check_license = NULL;
 struct t_config_option *ruby_config_look_eval_keep_context = NULL;
+struct t_config_option *ruby_config_look_autoload_deferred = NULL;
 
 int ruby_quiet = 0;
 
@@ -728,13 +729,18 @@ void
 weechat_ruby_load_cb (void *data, const char *filename)
 {
     const char *pos_dot;
-
-    /* make C compiler happy */
-    (void) data;
+    int old_ruby_quiet;
 
     pos_dot = strrchr (filename, '.');
     if (pos_dot && (strcmp (pos_dot, ".rb") == 0))
+    {
+        /* data is an optional pointer to integer: 1 for quiet mode */
+        old_ruby_quiet = ruby_quiet;
+        if (data && *((int *)data))
+            ruby_quiet = 1;
         weechat_ruby_load (filename, NULL);
+        ruby_quiet = old_ruby_quiet;
+    }
 }
 
 /*
@@ -1401,6 +1407,7 @@ weechat_plugin_init (struct t_weechat_plugin *plugin, int argc, char *argv[])
     ruby_data.config_file = &ruby_config_file;
     ruby_data.config_look_check_license = &ruby_config_look_check_license;
     ruby_data.config_look_eval_keep_context = &ruby_config_look_eval_keep_context;
+    ruby_data.config_look_autoload_deferred = &ruby_config_look_autoload_deferred;
     ruby_data.scripts = &ruby_scripts;
     ruby_data.last_script = &last_ruby_script;
     ruby_data.callback_command = &weechat_ruby_command_cb;
@@ -51,6 +51,8 @@ int script_repo_count = 0;
 int script_repo_count_displayed = 0;
 struct t_hashtable *script_repo_max_length_field = NULL;
 char *script_repo_filter = NULL;
+struct t_hashtable *script_repo_sha512sum_cache = NULL; /* filename ->      */
+                                       /* "mtime:size:inode:sha512sum"      */
 
 
 /*
@@ -521,6 +523,13 @@ script_repo_find_pos (struct t_script_repo *script)
 {
     struct t_script_repo *ptr_script;
 
+    /* fast path: the script is after the last one (list already sorted) */
+    if (last_script_repo
+        && (script_repo_compare_scripts (last_script_repo, script) <= 0))
+    {
+        return NULL;
+    }
+
     for (ptr_script = scripts_repo; ptr_script;
          ptr_script = ptr_script->next_script)
     {
@@ -754,6 +763,63 @@ script_repo_sha512sum_file (const char *filename)
     return weechat_string_tolower (hash_hexa);
 }
 
+/*
+ * Computes SHA-512 checksum for the content of a file, using a cache of
+ * checksums: the checksum is computed again only if the modification time,
+ * the size or the inode of file has changed.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+script_repo_sha512sum_file_cached (const char *filename, struct stat *st)
+{
+    char str_key[128], *sha512sum, *value;
+    const char *ptr_value;
+    int length;
+
+    if (!filename || !st)
+        return NULL;
+
+    if (!script_repo_sha512sum_cache)
+    {
+        script_repo_sha512sum_cache = weechat_hashtable_new (
+            32,
+            WEECHAT_HASHTABLE_STRING,
+            WEECHAT_HASHTABLE_STRING,
+            NULL, NULL);
+        if (!script_repo_sha512sum_cache)
+            return script_repo_sha512sum_file (filename);
+    }
+
+    snprintf (str_key, sizeof (str_key), "%lld:%lld:%llu:",
+              (long long)st->st_mtime,
+              (long long)st->st_size,
+              (unsigned long long)st->st_ino);
+    length = strlen (str_key);
+
+    ptr_value = weechat_hashtable_get (script_repo_sha512sum_cache, filename);
+    if (ptr_value && (strncmp (ptr_value, str_key, length) == 0))
+        return strdup (ptr_value + length);
+
+    sha512sum = script_repo_sha512sum_file (filename);
+    if (sha512sum)
+    {
+        if (weechat_asprintf (&value, "%s%s", str_key, sha512sum) >= 0)
+        {
+            weechat_hashtable_set (script_repo_sha512sum_cache,
+                                   filename, value);
+            free (value);
+        }
+    }
+    else
+    {
+        weechat_hashtable_remove (script_repo_sha512sum_cache, filename);
+    }
+
+    return sha512sum;
+}
+
 /*
  * Updates following status of a script:
  *   - script installed?
@@ -767,11 +833,13 @@ script_repo_update_status (struct t_script_repo *script)
     const char *version;
     char *weechat_data_dir, *filename, *sha512sum;
     struct stat st;
-    int length;
+    int length, old_length_version_loaded;
     struct t_script_repo *ptr_script;
 
     script->status = 0;
     sha512sum = NULL;
+    old_length_version_loaded = (script->version_loaded) ?
+        weechat_utf8_strlen_screen (script->version_loaded) : -1;
 
     /* check if script is installed (file found on disk) */
     weechat_data_dir = weechat_info_get ("weechat_data_dir", NULL);
@@ -787,7 +855,7 @@ script_repo_update_status (struct t_script_repo *script)
         {
             script->status |= SCRIPT_STATUS_INSTALLED;
             script->status |= SCRIPT_STATUS_AUTOLOADED;
-            sha512sum = script_repo_sha512sum_file (filename);
+            sha512sum = script_repo_sha512sum_file_cached (filename, &st);
         }
         else
         {
@@ -798,7 +866,7 @@ script_repo_update_status (struct t_script_repo *script)
             if (stat (filename, &st) == 0)
             {
                 script->status |= SCRIPT_STATUS_INSTALLED;
-                sha512sum = script_repo_sha512sum_file (filename);
+                sha512sum = script_repo_sha512sum_file_cached (filename, &st);
             }
         }
         free (filename);
@@ -834,8 +902,20 @@ script_repo_update_status (struct t_script_repo *script)
         script->status |= SCRIPT_STATUS_NEW_VERSION;
     }
 
-    /* recompute max length for version loaded (for display) */
-    if (script_repo_max_length_field)
+    /*
+     * recompute max length for version loaded (for display); all scripts are
+     * checked only if the version loaded of this script was displayed before
+     * (the max length can be smaller)
+     */
+    if (script_repo_max_length_field && (old_length_version_loaded < 0))
+    {
+        if (script->version_loaded)
+        {
+            script_repo_set_max_length_field (
+                "V", weechat_utf8_strlen_screen (script->version_loaded));
+        }
+    }
+    else if (script_repo_max_length_field)
     {
         length = 0;
         weechat_hashtable_set (script_repo_max_length_field, "V", &length);
@@ -1275,9 +1355,19 @@ script_repo_file_read (int quiet)
                         {
                             name = weechat_strndup (pos + 1, pos2 - pos - 1);
                             value1 = weechat_strndup (pos2 + 1, pos3 - pos2 - 1);
-                            value2 = weechat_string_replace (value1, "&amp;", "&");
-                            value3 = weechat_string_replace (value2, "&gt;", ">");
-                            value = weechat_string_replace (value3, "&lt;", "<");
+                            if (value1 && strchr (value1, '&'))
+                            {
+                                value2 = weechat_string_replace (value1, "&amp;", "&");
+                                value3 = weechat_string_replace (value2, "&gt;", ">");
+                                value = weechat_string_replace (value3, "&lt;", "<");
+                            }
+                            else
+                            {
+                                value2 = NULL;
+                                value3 = NULL;
+                                value = value1;
+                                value1 = NULL;
+                            }
                             if (name && value)
                             {
                                 if (strcmp (name, "name") == 0)
@@ -61,6 +61,7 @@ extern struct t_script_repo *last_script_repo;
 extern int script_repo_count, script_repo_count_displayed;
 extern struct t_hashtable *script_repo_max_length_field;
 extern char *script_repo_filter;
+extern struct t_hashtable *script_repo_sha512sum_cache;
 
 extern int script_repo_script_valid (struct t_script_repo *script);
 extern struct t_script_repo *script_repo_search_displayed_by_number (int number);
@@ -413,6 +413,9 @@ weechat_plugin_end (struct t_weechat_plugin *plugin)
 
     script_repo_remove_all ();
 
+    weechat_hashtable_free (script_repo_sha512sum_cache);
+    script_repo_sha512sum_cache = NULL;
+
     if (script_repo_filter)
     {
         free (script_repo_filter);
@@ -319,6 +319,8 @@ spell_command_add_word (struct t_gui_buffer *buffer, const char *dict,
         goto error;
 #endif /* USE_ENCHANT */
 
+    spell_speller_buffer_clear_cache ();
+
     goto end;
 
 error:
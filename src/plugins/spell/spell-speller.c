@@ -386,6 +386,11 @@ spell_speller_buffer_new (struct t_gui_buffer *buffer)
     new_speller_buffer->modifier_string = NULL;
     new_speller_buffer->input_pos = -1;
     new_speller_buffer->modifier_result = NULL;
+    new_speller_buffer->words_checked = weechat_hashtable_new (
+        256,
+        WEECHAT_HASHTABLE_STRING,
+        WEECHAT_HASHTABLE_INTEGER,
+        NULL, NULL);
 
     buffer_dicts = spell_get_dict (buffer);
     if (buffer_dicts && (strcmp (buffer_dicts, "-") != 0))
@@ -448,10 +453,50 @@ spell_speller_buffer_free_value_cb (struct t_hashtable *hashtable,
     free (ptr_speller_buffer->spellers);
     free (ptr_speller_buffer->modifier_string);
     free (ptr_speller_buffer->modifier_result);
+    weechat_hashtable_free (ptr_speller_buffer->words_checked);
 
     free (ptr_speller_buffer);
 }
 
+/*
+ * Clears cache of words checked and last modifier result in a buffer speller
+ * info.
+ */
+
+void
+spell_speller_buffer_clear_cache_cb (void *data,
+                                     struct t_hashtable *hashtable,
+                                     const void *key, const void *value)
+{
+    struct t_spell_speller_buffer *ptr_speller_buffer;
+
+    /* make C compiler happy */
+    (void) data;
+    (void) hashtable;
+    (void) key;
+
+    ptr_speller_buffer = (struct t_spell_speller_buffer *)value;
+
+    if (ptr_speller_buffer->words_checked)
+        weechat_hashtable_remove_all (ptr_speller_buffer->words_checked);
+    free (ptr_speller_buffer->modifier_string);
+    ptr_speller_buffer->modifier_string = NULL;
+    free (ptr_speller_buffer->modifier_result);
+    ptr_speller_buffer->modifier_result = NULL;
+}
+
+/*
+ * Clears cache of words checked in all buffers (called when a word is added
+ * in a personal dictionary).
+ */
+
+void
+spell_speller_buffer_clear_cache ()
+{
+    weechat_hashtable_map (spell_speller_buffer,
+                           &spell_speller_buffer_clear_cache_cb, NULL);
+}
+
 /*
  * Initializes spellers (creates hashtables).
  *
@@ -21,6 +21,9 @@
 #ifndef WEECHAT_PLUGIN_SPELL_SPELLER_H
 #define WEECHAT_PLUGIN_SPELL_SPELLER_H
 
+/* max words in cache of words checked (cache is cleared when full) */
+#define SPELL_SPELLER_CACHE_MAX_WORDS 4096
+
 struct t_spell_speller_buffer
 {
 #ifdef USE_ENCHANT
@@ -31,6 +34,7 @@ struct t_spell_speller_buffer
     char *modifier_string;                 /* last modifier string          */
     int input_pos;                         /* position of cursor in input   */
     char *modifier_result;                 /* last modifier result          */
+    struct t_hashtable *words_checked;     /* cache: word -> 1 if OK, else 0*/
 };
 
 extern struct t_hashtable *spell_spellers;
@@ -45,6 +49,7 @@ extern AspellSpeller *spell_speller_new (const char *lang);
 #endif /* USE_ENCHANT */
 extern void spell_speller_remove_unused ();
 extern struct t_spell_speller_buffer *spell_speller_buffer_new (struct t_gui_buffer *buffer);
+extern void spell_speller_buffer_clear_cache ();
 extern int spell_speller_init ();
 extern void spell_speller_end ();
 
@@ -494,6 +494,9 @@ spell_string_is_simili_number (const char *word)
 /*
  * Spell checks a word.
  *
+ * Result of spellers is kept in a cache of the buffer speller info, so
+ * words of input that did not change are not checked again on each key.
+ *
  * Returns:
  *   1: word is OK
  *   0: word is misspelled
@@ -503,7 +506,7 @@ int
 spell_check_word (struct t_spell_speller_buffer *speller_buffer,
                   const char *word)
 {
-    int i;
+    int i, rc, *ptr_rc;
 
     /* word too small? then do not check word */
     if ((weechat_config_integer (spell_config_check_word_min_length) > 0)
@@ -514,7 +517,16 @@ spell_check_word (struct t_spell_speller_buffer *speller_buffer,
     if (spell_string_is_simili_number (word))
         return 1;
 
+    /* word already checked? */
+    if (speller_buffer->words_checked)
+    {
+        ptr_rc = weechat_hashtable_get (speller_buffer->words_checked, word);
+        if (ptr_rc)
+            return *ptr_rc;
+    }
+
     /* check word with all spellers (order is important) */
+    rc = 0;
     if (speller_buffer->spellers)
     {
         for (i = 0; speller_buffer->spellers[i]; i++)
@@ -524,12 +536,25 @@ spell_check_word (struct t_spell_speller_buffer *speller_buffer,
 #else
             if (aspell_speller_check (speller_buffer->spellers[i], word, -1) == 1)
 #endif /* USE_ENCHANT */
-                return 1;
+            {
+                rc = 1;
+                break;
+            }
         }
     }
 
-    /* misspelled word! */
-    return 0;
+    /* save result in cache (cleared when it is full) */
+    if (speller_buffer->words_checked)
+    {
+        if (weechat_hashtable_get_integer (speller_buffer->words_checked,
+                                           "items_count") >= SPELL_SPELLER_CACHE_MAX_WORDS)
+        {
+            weechat_hashtable_remove_all (speller_buffer->words_checked);
+        }
+        weechat_hashtable_set (speller_buffer->words_checked, word, &rc);
+    }
+
+    return rc;
 }
 
 /*
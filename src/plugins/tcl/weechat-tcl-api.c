@@ -5477,6 +5477,35 @@ API_FUNC(hdata_hashtable)
     API_RETURN_OBJ(result_dict);
 }
 
+API_FUNC(hdata_get_fields)
+{
+    Tcl_Obj *result_dict;
+    char *hdata, *pointer, *fields;
+    struct t_hashtable *result_hashtable;
+    int count;
+
+    API_INIT_FUNC(1, "hdata_get_fields", API_RETURN_EMPTY);
+    if (objc < 5)
+        API_WRONG_ARGS(API_RETURN_EMPTY);
+
+    hdata = Tcl_GetString (objv[1]);
+    pointer = Tcl_GetString (objv[2]);
+    fields = Tcl_GetString (objv[4]);
+
+    if (Tcl_GetIntFromObj (interp, objv[3], &count) != TCL_OK)
+        API_WRONG_ARGS(API_RETURN_EMPTY);
+
+    result_hashtable = weechat_hdata_get_fields (API_STR2PTR(hdata),
+                                                 API_STR2PTR(pointer),
+                                                 count,
+                                                 fields);
+    result_dict = weechat_tcl_hashtable_to_dict (interp, result_hashtable);
+
+    weechat_hashtable_free (result_hashtable);
+
+    API_RETURN_OBJ(result_dict);
+}
+
 API_FUNC(hdata_compare)
 {
     char *hdata, *pointer1, *pointer2, *name;
@@ -5914,6 +5943,7 @@ void weechat_tcl_api_init (Tcl_Interp *interp)
     API_DEF_FUNC(hdata_pointer);
     API_DEF_FUNC(hdata_time);
     API_DEF_FUNC(hdata_hashtable);
+    API_DEF_FUNC(hdata_get_fields);
     API_DEF_FUNC(hdata_compare);
     API_DEF_FUNC(hdata_update);
     API_DEF_FUNC(hdata_get_string);
@@ -49,6 +49,7 @@ struct t_plugin_script_data tcl_data;
 struct t_config_file *tcl_config_file = NULL;
 struct t_config_option *tcl_config_look_check_license = NULL;
 struct t_config_option *tcl_config_look_eval_keep_context = NULL;
+struct t_config_option *tcl_config_look_autoload_deferred = NULL;
 
 int tcl_quiet = 0;
 
@@ -188,8 +189,28 @@ weechat_tcl_dict_to_hashtable (Tcl_Interp *interp, Tcl_Obj *dict,
     return hashtable;
 }
 
+/*
+ * Frees a tcl object in the cache of functions of a script.
+ */
+
+void
+weechat_tcl_function_cache_free_cb (struct t_hashtable *hashtable,
+                                    const void *key, void *value)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    Tcl_DecrRefCount ((Tcl_Obj *)value);
+}
+
 /*
  * Executes a tcl function.
+ *
+ * The name of function is kept as a tcl object in the cache of functions of
+ * the script: tcl keeps in this object the command found, so that the
+ * command is not searched again by name on next calls (tcl checks itself if
+ * the command has been defined again).
  */
 
 void *
@@ -201,7 +222,7 @@ weechat_tcl_exec (struct t_plugin_script *script,
     int *ret_i;
     char *ret_cv;
     void *ret_val;
-    Tcl_Obj *cmdlist;
+    Tcl_Obj *cmdlist, *cmdname;
     Tcl_Interp *interp;
     struct t_plugin_script *old_tcl_script;
 
@@ -211,9 +232,19 @@ weechat_tcl_exec (struct t_plugin_script *script,
 
     if (function && function[0])
     {
+        cmdname = plugin_script_function_cache_get (weechat_tcl_plugin,
+                                                    script, function);
+        if (!cmdname)
+        {
+            cmdname = Tcl_NewStringObj (function, -1);
+            Tcl_IncrRefCount (cmdname); /* +1, released when cache is freed */
+            plugin_script_function_cache_set (
+                weechat_tcl_plugin, script, function, cmdname,
+                &weechat_tcl_function_cache_free_cb);
+        }
         cmdlist = Tcl_NewListObj (0, NULL);
         Tcl_IncrRefCount (cmdlist); /* +1 */
-        Tcl_ListObjAppendElement (interp, cmdlist, Tcl_NewStringObj (function,-1));
+        Tcl_ListObjAppendElement (interp, cmdlist, cmdname);
     }
     else
     {
@@ -415,13 +446,18 @@ void
 weechat_tcl_load_cb (void *data, const char *filename)
 {
     const char *pos_dot;
-
-    /* make C compiler happy */
-    (void) data;
+    int old_tcl_quiet;
 
     pos_dot = strrchr (filename, '.');
     if (pos_dot && (strcmp (pos_dot, ".tcl") == 0))
+    {
+        /* data is an optional pointer to integer: 1 for quiet mode */
+        old_tcl_quiet = tcl_quiet;
+        if (data && *((int *)data))
+            tcl_quiet = 1;
         weechat_tcl_load (filename, NULL);
+        tcl_quiet = old_tcl_quiet;
+    }
 }
 
 /*
@@ -938,6 +974,7 @@ weechat_plugin_init (struct t_weechat_plugin *plugin, int argc, char *argv[])
     tcl_data.config_file = &tcl_config_file;
     tcl_data.config_look_check_license = &tcl_config_look_check_license;
     tcl_data.config_look_eval_keep_context = &tcl_config_look_eval_keep_context;
+    tcl_data.config_look_autoload_deferred = &tcl_config_look_autoload_deferred;
     tcl_data.scripts = &tcl_scripts;
     tcl_data.last_script = &last_tcl_script;
     tcl_data.callback_command = &weechat_tcl_command_cb;
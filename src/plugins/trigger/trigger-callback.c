@@ -21,6 +21,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdarg.h>
 #include <string.h>
 #include <limits.h>
 #include <time.h>
@@ -42,6 +43,105 @@ unsigned long trigger_context_id = 0;
 /* hashtable used to evaluate "conditions" */
 struct t_hashtable *trigger_callback_hashtable_options_conditions = NULL;
 
+/* contexts reused by callbacks (to not allocate hashtables on each call) */
+struct t_trigger_context_pool trigger_callback_pool[TRIGGER_CALLBACK_POOL_SIZE];
+
+
+/*
+ * Gets a context from the pool (hashtables are created on first use).
+ *
+ * Returns pointer to pool entry, NULL if all entries are used (many nested
+ * callbacks) or if error: in this case the callback allocates its own
+ * hashtables.
+ */
+
+struct t_trigger_context_pool *
+trigger_callback_pool_get ()
+{
+    struct t_trigger_context_pool *ptr_pool;
+    int i;
+
+    for (i = 0; i < TRIGGER_CALLBACK_POOL_SIZE; i++)
+    {
+        ptr_pool = &trigger_callback_pool[i];
+        if (ptr_pool->used)
+            continue;
+        if (!ptr_pool->pointers)
+        {
+            ptr_pool->pointers = weechat_hashtable_new (
+                32,
+                WEECHAT_HASHTABLE_STRING,
+                WEECHAT_HASHTABLE_POINTER,
+                NULL, NULL);
+            if (!ptr_pool->pointers)
+                return NULL;
+        }
+        if (!ptr_pool->extra_vars)
+        {
+            ptr_pool->extra_vars = weechat_hashtable_new (
+                32,
+                WEECHAT_HASHTABLE_STRING,
+                WEECHAT_HASHTABLE_STRING,
+                NULL, NULL);
+            if (!ptr_pool->extra_vars)
+                return NULL;
+        }
+        if (!ptr_pool->vars_updated)
+        {
+            ptr_pool->vars_updated = weechat_list_new ();
+            if (!ptr_pool->vars_updated)
+                return NULL;
+        }
+        ptr_pool->used = 1;
+        return ptr_pool;
+    }
+
+    return NULL;
+}
+
+/*
+ * Frees data in a trigger context: hashtables/list from the pool are emptied
+ * (and the pool entry is released), the others are freed.
+ */
+
+void
+trigger_callback_context_free (struct t_trigger_context *context)
+{
+    struct t_trigger_context_pool *ptr_pool;
+
+    ptr_pool = context->pool;
+
+    if (context->pointers)
+    {
+        if (ptr_pool && (context->pointers == ptr_pool->pointers))
+            weechat_hashtable_remove_all (context->pointers);
+        else
+            weechat_hashtable_free (context->pointers);
+        context->pointers = NULL;
+    }
+    if (context->extra_vars)
+    {
+        if (ptr_pool && (context->extra_vars == ptr_pool->extra_vars))
+            weechat_hashtable_remove_all (context->extra_vars);
+        else
+            weechat_hashtable_free (context->extra_vars);
+        context->extra_vars = NULL;
+    }
+    if (context->vars_updated)
+    {
+        if (ptr_pool && (context->vars_updated == ptr_pool->vars_updated))
+            weechat_list_remove_all (context->vars_updated);
+        else
+            weechat_list_free (context->vars_updated);
+        context->vars_updated = NULL;
+    }
+
+    if (ptr_pool)
+    {
+        ptr_pool->used = 0;
+        context->pool = NULL;
+    }
+}
 
 /*
  * Parses an IRC message.
@@ -244,6 +344,63 @@ trigger_callback_set_tags (struct t_gui_buffer *buffer,
     return 1;
 }
 
+/*
+ * Checks literals required by conditions of a trigger, before the hashtables
+ * used to evaluate conditions are built: this is a fast rejection of the
+ * triggers which can not match.
+ *
+ * Arguments after trigger are couples of variable name/value, ending with
+ * NULL, for example:
+ *   trigger_callback_check_literals (trigger,
+ *                                    "tg_message", message,
+ *                                    NULL);
+ *
+ * The literals on variables not given are ignored (they are checked by the
+ * evaluation of conditions).
+ *
+ * Returns:
+ *   1: all literals found (conditions must be evaluated)
+ *   0: at least one literal not found (conditions are false)
+ */
+
+int
+trigger_callback_check_literals (struct t_trigger *trigger, ...)
+{
+    va_list args;
+    const char *ptr_variable, *ptr_value;
+    int i, found;
+
+    /* no fast rejection if monitor buffer is open (all calls are displayed) */
+    if (!trigger->literals || trigger_buffer)
+        return 1;
+
+    for (i = 0; i < trigger->literals_count; i++)
+    {
+        found = 1;
+        va_start (args, trigger);
+        while ((ptr_variable = va_arg (args, const char *)))
+        {
+            ptr_value = va_arg (args, const char *);
+            if (strcmp (ptr_variable, trigger->literals[i].variable) == 0)
+            {
+                if (ptr_value)
+                {
+                    found = (trigger->literals[i].case_sensitive) ?
+                        (strstr (ptr_value, trigger->literals[i].value) != NULL) :
+                        (weechat_strcasestr (ptr_value,
+                                             trigger->literals[i].value) != NULL);
+                }
+                break;
+            }
+        }
+        va_end (args);
+        if (!found)
+            return 0;
+    }
+
+    return 1;
+}
+
 /*
  * Checks conditions for a trigger.
  *
@@ -653,6 +810,18 @@ trigger_callback_signal_cb (const void *pointer, void *data,
 
     TRIGGER_CALLBACK_CB_INIT(WEECHAT_RC_OK);
 
+    if (!trigger_callback_check_literals (
+            trigger,
+            "tg_signal", signal,
+            "tg_signal_data",
+            (strcmp (type_data, WEECHAT_HOOK_SIGNAL_STRING) == 0) ?
+            (const char *)signal_data : NULL,
+            NULL))
+    {
+        trigger_rc = WEECHAT_RC_OK;
+        goto end;
+    }
+
     TRIGGER_CALLBACK_CB_NEW_POINTERS;
 
     /* split IRC message (if signal_data is an IRC message) */
@@ -820,7 +989,18 @@ trigger_callback_modifier_cb (const void *pointer, void *data,
     ctx.buffer = NULL;
     tags = NULL;
     num_tags = 0;
-    string_no_color = NULL;
+
+    string_no_color = weechat_string_remove_color (string, NULL);
+
+    if (!trigger_callback_check_literals (trigger,
+                                          "tg_modifier", modifier,
+                                          "tg_modifier_data", modifier_data,
+                                          "tg_string", string,
+                                          "tg_string_nocolor", string_no_color,
+                                          NULL))
+    {
+        goto end;
+    }
 
     TRIGGER_CALLBACK_CB_NEW_POINTERS;
 
@@ -855,7 +1035,6 @@ trigger_callback_modifier_cb (const void *pointer, void *data,
     weechat_hashtable_set (ctx.extra_vars, "tg_modifier", modifier);
     weechat_hashtable_set (ctx.extra_vars, "tg_modifier_data", modifier_data);
     weechat_hashtable_set (ctx.extra_vars, "tg_string", string);
-    string_no_color = weechat_string_remove_color (string, NULL);
     if (string_no_color)
     {
         weechat_hashtable_set (ctx.extra_vars,
@@ -1139,19 +1318,36 @@ trigger_callback_print_cb  (const void *pointer, void *data,
                             int displayed, int highlight, const char *prefix,
                             const char *message)
 {
-    char *str_tags, *str_tags2, str_temp[128], *str_no_color;
+    char *str_tags, *str_tags2, str_temp[128];
+    char *prefix_no_color, *message_no_color;
     int length;
     struct timeval tv;
 
     TRIGGER_CALLBACK_CB_INIT(WEECHAT_RC_OK);
 
     ctx.buffer = buffer;
+    prefix_no_color = NULL;
+    message_no_color = NULL;
 
     /* do nothing if the buffer does not match buffers defined in the trigger */
     if (trigger->hook_print_buffers
         && !weechat_buffer_match_list (buffer, trigger->hook_print_buffers))
         goto end;
 
+    prefix_no_color = weechat_string_remove_color (prefix, NULL);
+    message_no_color = weechat_string_remove_color (message, NULL);
+
+    if (!trigger_callback_check_literals (trigger,
+                                          "tg_prefix", prefix,
+                                          "tg_prefix_nocolor", prefix_no_color,
+                                          "tg_message", message,
+                                          "tg_message_nocolor", message_no_color,
+                                          NULL))
+    {
+        trigger_rc = WEECHAT_RC_OK;
+        goto end;
+    }
+
     TRIGGER_CALLBACK_CB_NEW_POINTERS;
     TRIGGER_CALLBACK_CB_NEW_EXTRA_VARS;
 
@@ -1167,18 +1363,16 @@ trigger_callback_print_cb  (const void *pointer, void *data,
     snprintf (str_temp, sizeof (str_temp), "%d", highlight);
     weechat_hashtable_set (ctx.extra_vars, "tg_highlight", str_temp);
     weechat_hashtable_set (ctx.extra_vars, "tg_prefix", prefix);
-    str_no_color = weechat_string_remove_color (prefix, NULL);
-    if (str_no_color)
+    if (prefix_no_color)
     {
-        weechat_hashtable_set (ctx.extra_vars, "tg_prefix_nocolor", str_no_color);
-        free (str_no_color);
+        weechat_hashtable_set (ctx.extra_vars, "tg_prefix_nocolor",
+                               prefix_no_color);
     }
     weechat_hashtable_set (ctx.extra_vars, "tg_message", message);
-    str_no_color = weechat_string_remove_color (message, NULL);
-    if (str_no_color)
+    if (message_no_color)
     {
-        weechat_hashtable_set (ctx.extra_vars, "tg_message_nocolor", str_no_color);
-        free (str_no_color);
+        weechat_hashtable_set (ctx.extra_vars, "tg_message_nocolor",
+                               message_no_color);
     }
 
     str_tags = weechat_string_rebuild_split_string (tags, ",", 0, -1);
@@ -1203,6 +1397,9 @@ trigger_callback_print_cb  (const void *pointer, void *data,
         trigger_rc = WEECHAT_RC_OK;
 
 end:
+    free (prefix_no_color);
+    free (message_no_color);
+
     TRIGGER_CALLBACK_CB_END(trigger_rc);
 }
 
@@ -1273,6 +1470,14 @@ trigger_callback_command_run_cb  (const void *pointer, void *data,
 {
     TRIGGER_CALLBACK_CB_INIT(WEECHAT_RC_OK);
 
+    if (!trigger_callback_check_literals (trigger,
+                                          "tg_command", command,
+                                          NULL))
+    {
+        trigger_rc = WEECHAT_RC_OK;
+        goto end;
+    }
+
     TRIGGER_CALLBACK_CB_NEW_POINTERS;
     TRIGGER_CALLBACK_CB_NEW_EXTRA_VARS;
 
@@ -1495,6 +1700,8 @@ end:
 void
 trigger_callback_init ()
 {
+    memset (trigger_callback_pool, 0, sizeof (trigger_callback_pool));
+
     trigger_callback_hashtable_options_conditions = weechat_hashtable_new (
         32,
         WEECHAT_HASHTABLE_STRING,
@@ -1514,9 +1721,22 @@ trigger_callback_init ()
 void
 trigger_callback_end ()
 {
+    int i;
+
     if (trigger_callback_hashtable_options_conditions)
     {
         weechat_hashtable_free (trigger_callback_hashtable_options_conditions);
         trigger_callback_hashtable_options_conditions = NULL;
     }
+
+    for (i = 0; i < TRIGGER_CALLBACK_POOL_SIZE; i++)
+    {
+        if (trigger_callback_pool[i].pointers)
+            weechat_hashtable_free (trigger_callback_pool[i].pointers);
+        if (trigger_callback_pool[i].extra_vars)
+            weechat_hashtable_free (trigger_callback_pool[i].extra_vars);
+        if (trigger_callback_pool[i].vars_updated)
+            weechat_list_free (trigger_callback_pool[i].vars_updated);
+    }
+    memset (trigger_callback_pool, 0, sizeof (trigger_callback_pool));
 }
@@ -23,9 +23,21 @@
 #include <time.h>
 #include <sys/time.h>
 
+/* max number of contexts kept for reuse (callbacks can be nested) */
+#define TRIGGER_CALLBACK_POOL_SIZE 16
+
+struct t_trigger_context_pool
+{
+    struct t_hashtable *pointers;      /* pointers (emptied after use)      */
+    struct t_hashtable *extra_vars;    /* extra vars (emptied after use)    */
+    struct t_weelist *vars_updated;    /* vars updated (emptied after use)  */
+    int used;                          /* 1 if used by a running callback   */
+};
+
 struct t_trigger_context
 {
     unsigned long id;
+    struct t_trigger_context_pool *pool;
     struct t_gui_buffer *buffer;
     struct t_hashtable *pointers;
     struct t_hashtable *extra_vars;
@@ -58,35 +70,41 @@ struct t_trigger_context
             trigger->options[TRIGGER_OPTION_RETURN_CODE])];
 
 #define TRIGGER_CALLBACK_CB_NEW_POINTERS                        \
-    ctx.pointers = weechat_hashtable_new (                      \
-        32,                                                     \
-        WEECHAT_HASHTABLE_STRING,                               \
-        WEECHAT_HASHTABLE_POINTER,                              \
-        NULL, NULL);                                            \
+    if (!ctx.pool)                                              \
+        ctx.pool = trigger_callback_pool_get ();                \
+    ctx.pointers = (ctx.pool) ?                                 \
+        ctx.pool->pointers :                                    \
+        weechat_hashtable_new (                                 \
+            32,                                                 \
+            WEECHAT_HASHTABLE_STRING,                           \
+            WEECHAT_HASHTABLE_POINTER,                          \
+            NULL, NULL);                                        \
     if (!ctx.pointers)                                          \
         goto end;
 
 #define TRIGGER_CALLBACK_CB_NEW_EXTRA_VARS                      \
-    ctx.extra_vars = weechat_hashtable_new (                    \
-        32,                                                     \
-        WEECHAT_HASHTABLE_STRING,                               \
-        WEECHAT_HASHTABLE_STRING,                               \
-        NULL, NULL);                                            \
+    if (!ctx.pool)                                              \
+        ctx.pool = trigger_callback_pool_get ();                \
+    ctx.extra_vars = (ctx.pool) ?                               \
+        ctx.pool->extra_vars :                                  \
+        weechat_hashtable_new (                                 \
+            32,                                                 \
+            WEECHAT_HASHTABLE_STRING,                           \
+            WEECHAT_HASHTABLE_STRING,                           \
+            NULL, NULL);                                        \
     if (!ctx.extra_vars)                                        \
         goto end;
 
 #define TRIGGER_CALLBACK_CB_NEW_VARS_UPDATED                    \
-    ctx.vars_updated = weechat_list_new ();                     \
+    if (!ctx.pool)                                              \
+        ctx.pool = trigger_callback_pool_get ();                \
+    ctx.vars_updated = (ctx.pool) ?                             \
+        ctx.pool->vars_updated : weechat_list_new ();           \
     if (!ctx.vars_updated)                                      \
         goto end;
 
 #define TRIGGER_CALLBACK_CB_END(__rc)                           \
-    if (ctx.pointers)                                           \
-        weechat_hashtable_free (ctx.pointers);                  \
-    if (ctx.extra_vars)                                         \
-        weechat_hashtable_free (ctx.extra_vars);                \
-    if (ctx.vars_updated)                                       \
-        weechat_list_free (ctx.vars_updated);                   \
+    trigger_callback_context_free (&ctx);                       \
     trigger->hook_running = 0;                                  \
     switch (weechat_config_enum (                               \
                 trigger->options[TRIGGER_OPTION_POST_ACTION]))  \
@@ -106,6 +124,12 @@ struct t_trigger_context
     return __rc;
 
 extern unsigned long trigger_context_id;
+extern struct t_trigger_context_pool trigger_callback_pool[];
+
+extern struct t_trigger_context_pool *trigger_callback_pool_get ();
+extern void trigger_callback_context_free (struct t_trigger_context *context);
+
+extern int trigger_callback_check_literals (struct t_trigger *trigger, ...);
 
 extern int trigger_callback_signal_cb (const void *pointer, void *data,
                                        const char *signal,
@@ -265,6 +265,29 @@ trigger_config_change_trigger_arguments (const void *pointer, void *data,
         trigger_hook (ptr_trigger);
 }
 
+/*
+ * Callback for changes on option "trigger.trigger.xxx.conditions".
+ */
+
+void
+trigger_config_change_trigger_conditions (const void *pointer, void *data,
+                                          struct t_config_option *option)
+{
+    struct t_trigger *ptr_trigger;
+
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+
+    ptr_trigger = trigger_search_with_option (option);
+    if (!ptr_trigger)
+        return;
+
+    trigger_split_conditions (weechat_config_string (option),
+                              &ptr_trigger->literals_count,
+                              &ptr_trigger->literals);
+}
+
 /*
  * Callback for changes on option "trigger.trigger.xxx.regex".
  */
@@ -402,7 +425,9 @@ trigger_config_create_trigger_option (const char *trigger_name, int index_option
                    "hook callback) (note: content is evaluated when trigger is "
                    "run, see /help eval)"),
                 NULL, 0, 0, value, NULL, 0,
-                NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+                NULL, NULL, NULL,
+                &trigger_config_change_trigger_conditions, NULL, NULL,
+                NULL, NULL, NULL);
             break;
         case TRIGGER_OPTION_REGEX:
             ptr_option = weechat_config_new_option (
@@ -622,7 +622,7 @@ trigger_regex_free (int *regex_count, struct t_trigger_regex **regex)
             free ((*regex)[i].str_regex);
             if ((*regex)[i].regex)
             {
-                regfree ((*regex)[i].regex);
+                weechat_string_regfree ((*regex)[i].regex);
                 free ((*regex)[i].regex);
             }
             free ((*regex)[i].replace);
@@ -865,6 +865,302 @@ trigger_split_command (const char *command,
     }
 }
 
+/*
+ * Frees literals extracted from conditions.
+ */
+
+void
+trigger_literals_free (int *literals_count,
+                       struct t_trigger_literal **literals)
+{
+    int i;
+
+    if (!literals_count || !literals)
+        return;
+
+    if (*literals)
+    {
+        for (i = 0; i < *literals_count; i++)
+        {
+            free ((*literals)[i].variable);
+            free ((*literals)[i].value);
+        }
+        free (*literals);
+        *literals = NULL;
+    }
+    *literals_count = 0;
+}
+
+/*
+ * Searches a string in conditions at same level, skipping sub-expressions
+ * "${...}" and "(...)" (same as the evaluation of conditions by WeeChat).
+ *
+ * Returns pointer to string found, or NULL if not found.
+ */
+
+const char *
+trigger_conditions_strstr_level (const char *string, const char *search)
+{
+    int level, length_search;
+
+    length_search = strlen (search);
+
+    level = 0;
+    while (string[0])
+    {
+        if (strncmp (string, "${", 2) == 0)
+        {
+            level++;
+            string += 2;
+        }
+        else if (string[0] == '(')
+        {
+            level++;
+            string++;
+        }
+        else if ((string[0] == '}') || (string[0] == ')'))
+        {
+            if (level > 0)
+                level--;
+            string++;
+        }
+        else if ((level == 0)
+                 && (strncmp (string, search, length_search) == 0))
+        {
+            return string;
+        }
+        else
+        {
+            string++;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Adds a literal required by conditions.
+ */
+
+void
+trigger_conditions_add_literal (const char *variable, int length_variable,
+                                const char *value, int length_value,
+                                int case_sensitive,
+                                int *literals_count,
+                                struct t_trigger_literal **literals)
+{
+    struct t_trigger_literal *new_literals;
+
+    if (length_value <= 0)
+        return;
+
+    new_literals = realloc (*literals,
+                            (*literals_count + 1) * sizeof (**literals));
+    if (!new_literals)
+        return;
+    *literals = new_literals;
+
+    new_literals[*literals_count].variable = weechat_strndup (variable,
+                                                            length_variable);
+    new_literals[*literals_count].value = weechat_strndup (value,
+                                                         length_value);
+    new_literals[*literals_count].case_sensitive = case_sensitive;
+    if (!new_literals[*literals_count].variable
+        || !new_literals[*literals_count].value)
+    {
+        free (new_literals[*literals_count].variable);
+        free (new_literals[*literals_count].value);
+        return;
+    }
+    (*literals_count)++;
+}
+
+/*
+ * Extracts literals required by conditions (expression is modified).
+ *
+ * Only comparisons "${var} =- text", "${var} ==- text" (include) and
+ * "${var} =* mask", "${var} ==* mask" (match) which must all be true
+ * (joined by "&&") are used: the text (or each word of the mask) must be in
+ * the variable, otherwise the conditions are false.
+ */
+
+void
+trigger_conditions_parse (char *expr, int *literals_count,
+                          struct t_trigger_literal **literals)
+{
+    /* comparisons, in the same order as the evaluation by WeeChat */
+    static char *comparisons[] = {
+        "=~", "!~", "==*", "!!*", "=*", "!*", "==-", "!!-", "=-", "!-",
+        "==", "!=", "<=", "<", ">=", ">", NULL,
+    };
+    char *pos, *pos_end, *left, *right, *ptr_word;
+    int i, length, level, case_sensitive, mask;
+
+    while (expr[0] == ' ')
+    {
+        expr++;
+    }
+    pos_end = expr + strlen (expr);
+    while ((pos_end > expr) && (pos_end[-1] == ' '))
+    {
+        pos_end--;
+    }
+    pos_end[0] = '\0';
+    if (!expr[0])
+        return;
+
+    /* with "||", nothing is required */
+    pos = (char *)trigger_conditions_strstr_level (expr, "||");
+    if (pos && (pos > expr))
+        return;
+
+    /* "&&": both sub-expressions are required */
+    pos = (char *)trigger_conditions_strstr_level (expr, "&&");
+    if (pos && (pos > expr))
+    {
+        pos[0] = '\0';
+        trigger_conditions_parse (expr, literals_count, literals);
+        trigger_conditions_parse (pos + 2, literals_count, literals);
+        return;
+    }
+
+    for (i = 0; comparisons[i]; i++)
+    {
+        pos = (char *)trigger_conditions_strstr_level (expr, comparisons[i]);
+        if (pos)
+            break;
+    }
+    if (pos)
+    {
+        if (strcmp (comparisons[i], "==-") == 0)
+        {
+            case_sensitive = 1;
+            mask = 0;
+        }
+        else if (strcmp (comparisons[i], "=-") == 0)
+        {
+            case_sensitive = 0;
+            mask = 0;
+        }
+        else if (strcmp (comparisons[i], "==*") == 0)
+        {
+            case_sensitive = 1;
+            mask = 1;
+        }
+        else if (strcmp (comparisons[i], "=*") == 0)
+        {
+            case_sensitive = 0;
+            mask = 1;
+        }
+        else
+            return;
+
+        /* left: must be exactly one variable: "${name}" */
+        left = expr;
+        length = pos - expr;
+        while ((length > 0) && (left[length - 1] == ' '))
+        {
+            length--;
+        }
+        if ((length < 4) || (strncmp (left, "${", 2) != 0)
+            || (left[length - 1] != '}'))
+        {
+            return;
+        }
+        for (ptr_word = left + 2; ptr_word < left + length - 1; ptr_word++)
+        {
+            if (!isalnum ((unsigned char)ptr_word[0]) && (ptr_word[0] != '_'))
+                return;
+        }
+
+        /* right: must be a constant text */
+        right = pos + strlen (comparisons[i]);
+        while (right[0] == ' ')
+        {
+            right++;
+        }
+        if (strpbrk (right, "$()=!<>\\"))
+            return;
+
+        if (!mask)
+        {
+            trigger_conditions_add_literal (left + 2, length - 3,
+                                            right, strlen (right),
+                                            case_sensitive,
+                                            literals_count, literals);
+            return;
+        }
+
+        /* mask: each word between wildcards is required */
+        while (right[0])
+        {
+            pos_end = strchr (right, '*');
+            if (!pos_end)
+                pos_end = right + strlen (right);
+            trigger_conditions_add_literal (left + 2, length - 3,
+                                            right, pos_end - right,
+                                            case_sensitive,
+                                            literals_count, literals);
+            right = (pos_end[0]) ? pos_end + 1 : pos_end;
+        }
+        return;
+    }
+
+    /* sub-expression between parentheses */
+    if (expr[0] == '(')
+    {
+        level = 0;
+        pos = expr + 1;
+        while (pos[0])
+        {
+            if (pos[0] == '(')
+                level++;
+            else if (pos[0] == ')')
+            {
+                if (level == 0)
+                    break;
+                level--;
+            }
+            pos++;
+        }
+        if ((pos[0] == ')') && !pos[1])
+        {
+            pos[0] = '\0';
+            trigger_conditions_parse (expr + 1, literals_count, literals);
+        }
+    }
+}
+
+/*
+ * Extracts the literals required by conditions of a trigger: they are checked
+ * in hook callbacks before the conditions are evaluated, to skip quickly the
+ * triggers which can not match.
+ */
+
+void
+trigger_split_conditions (const char *conditions,
+                          int *literals_count,
+                          struct t_trigger_literal **literals)
+{
+    char *expr;
+
+    if (!literals_count || !literals)
+        return;
+
+    trigger_literals_free (literals_count, literals);
+
+    if (!conditions || !conditions[0])
+        return;
+
+    expr = strdup (conditions);
+    if (!expr)
+        return;
+
+    trigger_conditions_parse (expr, literals_count, literals);
+
+    free (expr);
+}
+
 /*
  * Checks if a trigger name is valid:
  *   - it must not start with "-"
@@ -926,6 +1222,8 @@ trigger_alloc (const char *name)
     new_trigger->hook_count_cmd = 0;
     new_trigger->hook_running = 0;
     new_trigger->hook_print_buffers = NULL;
+    new_trigger->literals_count = 0;
+    new_trigger->literals = NULL;
     new_trigger->regex_count = 0;
     new_trigger->regex = NULL;
     new_trigger->commands_count = 0;
@@ -1030,6 +1328,10 @@ trigger_new_with_options (const char *name, struct t_config_option **options)
                            &new_trigger->commands_count,
                            &new_trigger->commands);
 
+    trigger_split_conditions (weechat_config_string (new_trigger->options[TRIGGER_OPTION_CONDITIONS]),
+                              &new_trigger->literals_count,
+                              &new_trigger->literals);
+
     trigger_hook (new_trigger);
 
     return new_trigger;
@@ -1226,6 +1528,7 @@ trigger_free (struct t_trigger *trigger)
 
     /* free data */
     trigger_unhook (trigger);
+    trigger_literals_free (&trigger->literals_count, &trigger->literals);
     trigger_regex_free (&trigger->regex_count, &trigger->regex);
     free (trigger->name);
     for (i = 0; i < TRIGGER_NUM_OPTIONS; i++)
@@ -1298,6 +1601,17 @@ trigger_print_log ()
         weechat_log_printf ("  hook_count_cmd. . . . . : %llu", ptr_trigger->hook_count_cmd);
         weechat_log_printf ("  hook_running. . . . . . : %d", ptr_trigger->hook_running);
         weechat_log_printf ("  hook_print_buffers. . . : '%s'", ptr_trigger->hook_print_buffers);
+        weechat_log_printf ("  literals_count. . . . . : %d", ptr_trigger->literals_count);
+        weechat_log_printf ("  literals. . . . . . . . : %p", ptr_trigger->literals);
+        for (i = 0; i < ptr_trigger->literals_count; i++)
+        {
+            weechat_log_printf ("    literals[%03d].variable. . . : '%s'",
+                                i, ptr_trigger->literals[i].variable);
+            weechat_log_printf ("    literals[%03d].value . . . . : '%s'",
+                                i, ptr_trigger->literals[i].value);
+            weechat_log_printf ("    literals[%03d].case_sensitive: %d",
+                                i, ptr_trigger->literals[i].case_sensitive);
+        }
         weechat_log_printf ("  regex_count . . . . . . : %d", ptr_trigger->regex_count);
         weechat_log_printf ("  regex . . . . . . . . . : %p", ptr_trigger->regex);
         for (i = 0; i < ptr_trigger->regex_count; i++)
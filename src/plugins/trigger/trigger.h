@@ -98,6 +98,13 @@ struct t_trigger_regex
     char *replace_escaped;             /* repl. text (with chars escaped)   */
 };
 
+struct t_trigger_literal
+{
+    char *variable;                    /* variable (eg: "tg_message")       */
+    char *value;                       /* text that must be in variable     */
+    int case_sensitive;                /* 1 if search is case sensitive     */
+};
+
 struct t_trigger
 {
     /* user choices */
@@ -114,6 +121,10 @@ struct t_trigger
     int hook_running;                  /* 1 if one hook callback is running */
     char *hook_print_buffers;          /* buffers (for hook_print only)     */
 
+    /* literals required by conditions (checked before conditions) */
+    int literals_count;                /* number of literals                */
+    struct t_trigger_literal *literals; /* array of literals                */
+
     /* regular expressions */
     int regex_count;                   /* number of regex                   */
     struct t_trigger_regex *regex;     /* array of regex                    */
@@ -160,6 +171,11 @@ extern int trigger_regex_split (const char *str_regex,
                                 struct t_trigger_regex **regex);
 extern void trigger_split_command (const char *command,
                                    int *commands_count, char ***commands);
+extern void trigger_literals_free (int *literals_count,
+                                   struct t_trigger_literal **literals);
+extern void trigger_split_conditions (const char *conditions,
+                                      int *literals_count,
+                                      struct t_trigger_literal **literals);
 extern void trigger_unhook (struct t_trigger *trigger);
 extern void trigger_hook (struct t_trigger *trigger);
 extern int trigger_name_valid (const char *name);
@@ -22,6 +22,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/time.h>
 
 #include "../weechat-plugin.h"
 #include "typing.h"
@@ -30,6 +31,10 @@
 #include "typing-status.h"
 
 
+struct t_hook *typing_bar_item_timer_update = NULL;
+struct timeval typing_bar_item_last_update = { 0, 0 };
+
+
 /*
  * Callback used to build a string with the list of nicks typing on the buffer.
  */
@@ -119,6 +124,73 @@ typing_bar_item_typing (const void *pointer, void *data,
     return str_typing_cut;
 }
 
+/*
+ * Updates bar item "typing" now, and saves the time of update.
+ */
+
+void
+typing_bar_item_update_now ()
+{
+    gettimeofday (&typing_bar_item_last_update, NULL);
+    weechat_bar_item_update (TYPING_BAR_ITEM_NAME);
+}
+
+/*
+ * Timer callback for a delayed update of bar item "typing".
+ */
+
+int
+typing_bar_item_update_timer_cb (const void *pointer, void *data,
+                                 int remaining_calls)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) remaining_calls;
+
+    typing_bar_item_timer_update = NULL;
+    typing_bar_item_update_now ();
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Updates bar item "typing", at most once per delay defined in option
+ * "typing.look.delay_item_update": if the item was updated recently,
+ * the update is delayed (all changes received meanwhile are displayed
+ * by a single update).
+ */
+
+void
+typing_bar_item_update ()
+{
+    struct timeval tv_now;
+    long long delay, elapsed;
+
+    /* update already scheduled? */
+    if (typing_bar_item_timer_update)
+        return;
+
+    delay = (long long)weechat_config_integer (
+        typing_config_look_delay_item_update) * 1000;
+    if (delay > 0)
+    {
+        gettimeofday (&tv_now, NULL);
+        elapsed = weechat_util_timeval_diff (&typing_bar_item_last_update,
+                                             &tv_now);
+        if ((elapsed >= 0) && (elapsed < delay))
+        {
+            typing_bar_item_timer_update = weechat_hook_timer (
+                ((delay - elapsed) / 1000) + 1, 0, 1,
+                &typing_bar_item_update_timer_cb, NULL, NULL);
+            if (typing_bar_item_timer_update)
+                return;
+        }
+    }
+
+    typing_bar_item_update_now ();
+}
+
 /*
  * Initializes typing bar items.
  */
@@ -22,6 +22,9 @@
 
 #define TYPING_BAR_ITEM_NAME "typing"
 
+extern struct t_hook *typing_bar_item_timer_update;
+
+extern void typing_bar_item_update ();
 extern void typing_bar_item_init ();
 
 #endif /* WEECHAT_PLUGIN_TYPING_BAR_ITEM_H */
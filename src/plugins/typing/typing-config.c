@@ -38,6 +38,7 @@ struct t_config_section *typing_config_section_look = NULL;
 
 /* typing config, look section */
 
+struct t_config_option *typing_config_look_delay_item_update = NULL;
 struct t_config_option *typing_config_look_delay_purge_paused = NULL;
 struct t_config_option *typing_config_look_delay_purge_typing = NULL;
 struct t_config_option *typing_config_look_delay_set_paused = NULL;
@@ -85,6 +86,23 @@ typing_config_change_enabled (const void *pointer, void *data,
     weechat_bar_item_update (TYPING_BAR_ITEM_NAME);
 }
 
+/*
+ * Callback for changes on options "typing.look.delay_purge_*".
+ */
+
+void
+typing_config_change_delay_purge (const void *pointer, void *data,
+                                  struct t_config_option *option)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) option;
+
+    /* check all nicks on next timer call (delays may be shorter) */
+    typing_nicks_next_purge = 1;
+}
+
 /*
  * Callback for changes on options "typing.look.item_max_length".
  */
@@ -129,20 +147,32 @@ typing_config_init ()
         NULL, NULL, NULL);
     if (typing_config_section_look)
     {
+        typing_config_look_delay_item_update = weechat_config_new_option (
+            typing_config_file, typing_config_section_look,
+            "delay_item_update", "integer",
+            N_("min delay between two updates of bar item \"typing\" (in "
+               "milliseconds): changes of nicks typing status received during "
+               "this delay are displayed at once (0 = update immediately)"),
+            NULL, 0, 60000, "500", NULL, 0,
+            NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
         typing_config_look_delay_purge_paused = weechat_config_new_option (
             typing_config_file, typing_config_section_look,
             "delay_purge_paused", "integer",
             N_("number of seconds after paused status has been set: if reached, "
                "the typing status is removed"),
             NULL, 1, INT_MAX, "30", NULL, 0,
-            NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+            NULL, NULL, NULL,
+            &typing_config_change_delay_purge, NULL, NULL,
+            NULL, NULL, NULL);
         typing_config_look_delay_purge_typing = weechat_config_new_option (
             typing_config_file, typing_config_section_look,
             "delay_purge_typing", "integer",
             N_("number of seconds after typing status has been set: if reached, "
                "the typing status is removed"),
             NULL, 1, INT_MAX, "6", NULL, 0,
-            NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+            NULL, NULL, NULL,
+            &typing_config_change_delay_purge, NULL, NULL,
+            NULL, NULL, NULL);
         typing_config_look_delay_set_paused = weechat_config_new_option (
             typing_config_file, typing_config_section_look,
             "delay_set_paused", "integer",
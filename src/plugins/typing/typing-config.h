@@ -23,6 +23,7 @@
 #define TYPING_CONFIG_NAME "typing"
 #define TYPING_CONFIG_PRIO_NAME (TO_STR(TYPING_PLUGIN_PRIORITY) "|" TYPING_CONFIG_NAME)
 
+extern struct t_config_option *typing_config_look_delay_item_update;
 extern struct t_config_option *typing_config_look_delay_purge_paused;
 extern struct t_config_option *typing_config_look_delay_purge_typing;
 extern struct t_config_option *typing_config_look_delay_set_paused;
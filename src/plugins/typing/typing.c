@@ -48,6 +48,7 @@ struct t_hook *typing_signal_typing_set_nick = NULL;
 struct t_hook *typing_signal_typing_reset_buffer = NULL;
 
 int typing_update_item = 0;
+time_t typing_nicks_next_purge = 0;    /* 0 = no nicks to purge         */
 
 
 /*
@@ -277,6 +278,26 @@ typing_status_self_status_map_cb (void *data,
     }
 }
 
+/*
+ * Updates the time of next purge of nicks with the expiration of a nick
+ * typing status: the nicks are checked only when the first typing status
+ * expires, instead of every second.
+ */
+
+void
+typing_nicks_set_next_purge (struct t_typing_status *typing_status)
+{
+    time_t expiration;
+
+    expiration = typing_status->last_typed + 1 + weechat_config_integer (
+        (typing_status->state == TYPING_STATUS_STATE_PAUSED) ?
+        typing_config_look_delay_purge_paused :
+        typing_config_look_delay_purge_typing);
+
+    if ((typing_nicks_next_purge == 0) || (expiration < typing_nicks_next_purge))
+        typing_nicks_next_purge = expiration;
+}
+
 /*
  * Callback called periodically (via a timer) for each entry in hashtable
  * "typing_status_nicks".
@@ -313,6 +334,10 @@ typing_status_nicks_status_map_cb (void *data,
         weechat_hashtable_remove (hashtable, key);
         typing_update_item = 1;
     }
+    else
+    {
+        typing_nicks_set_next_purge (ptr_typing_status);
+    }
 }
 
 /*
@@ -360,11 +385,18 @@ typing_timer_cb (const void *pointer, void *data, int remaining_calls)
 
     weechat_hashtable_map (typing_status_self,
                            &typing_status_self_status_map_cb, &current_time);
-    weechat_hashtable_map (typing_status_nicks,
-                           &typing_status_nicks_hash_map_cb, &current_time);
+
+    /* check nicks only if a typing status has expired */
+    if ((typing_nicks_next_purge > 0)
+        && (current_time >= typing_nicks_next_purge))
+    {
+        typing_nicks_next_purge = 0;
+        weechat_hashtable_map (typing_status_nicks,
+                               &typing_status_nicks_hash_map_cb, &current_time);
+    }
 
     if (typing_update_item)
-        weechat_bar_item_update (TYPING_BAR_ITEM_NAME);
+        typing_bar_item_update ();
 
     return WEECHAT_RC_OK;
 }
@@ -421,9 +453,12 @@ typing_typing_set_nick_signal_cb (const void *pointer, void *data,
         }
         else
         {
-            typing_status_nick_add (ptr_buffer, items[2], state, time (NULL));
+            ptr_typing_status = typing_status_nick_add (ptr_buffer, items[2],
+                                                        state, time (NULL));
             updated = 1;
         }
+        if (ptr_typing_status)
+            typing_nicks_set_next_purge (ptr_typing_status);
     }
     else
     {
@@ -433,7 +468,7 @@ typing_typing_set_nick_signal_cb (const void *pointer, void *data,
     }
 
     if (updated)
-        weechat_bar_item_update (TYPING_BAR_ITEM_NAME);
+        typing_bar_item_update ();
 
 end:
     weechat_string_free_split (items);
@@ -468,7 +503,7 @@ typing_typing_reset_buffer_signal_cb (const void *pointer, void *data,
                                                  "items_count");
     weechat_hashtable_remove (typing_status_nicks, ptr_buffer);
     if (items_count > 0)
-        weechat_bar_item_update (TYPING_BAR_ITEM_NAME);
+        typing_bar_item_update ();
 
     return WEECHAT_RC_OK;
 }
@@ -569,9 +604,13 @@ typing_setup_hooks ()
                 weechat_hashtable_free (typing_status_nicks);
                 typing_status_nicks = NULL;
             }
+            typing_nicks_next_purge = 0;
+        }
+        if (!typing_signal_buffer_closing && typing_timer)
+        {
+            weechat_unhook (typing_timer);
+            typing_timer = NULL;
         }
-        weechat_unhook (typing_timer);
-        typing_timer = NULL;
     }
 }
 
@@ -612,6 +651,11 @@ typing_remove_hooks ()
         weechat_unhook (typing_signal_typing_reset_buffer);
         typing_signal_typing_reset_buffer = NULL;
     }
+    if (typing_bar_item_timer_update)
+    {
+        weechat_unhook (typing_bar_item_timer_update);
+        typing_bar_item_timer_update = NULL;
+    }
 }
 
 /*
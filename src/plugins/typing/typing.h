@@ -20,6 +20,8 @@
 #ifndef WEECHAT_PLUGIN_TYPING_H
 #define WEECHAT_PLUGIN_TYPING_H
 
+#include <time.h>
+
 #define weechat_plugin weechat_typing_plugin
 #define TYPING_PLUGIN_NAME "typing"
 #define TYPING_PLUGIN_PRIORITY 8000
@@ -40,6 +42,8 @@ extern struct t_typing *typing_list;
 
 extern struct t_weechat_plugin *weechat_typing_plugin;
 
+extern time_t typing_nicks_next_purge;
+
 extern void typing_setup_hooks ();
 
 #endif /* WEECHAT_PLUGIN_TYPING_H */
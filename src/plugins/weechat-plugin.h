@@ -58,8 +58,10 @@ struct t_gui_nick_group;
 struct t_gui_window;
 struct t_hashtable;
 struct t_hdata;
+struct t_hdata_path;
 struct t_infolist;
 struct t_infolist_item;
+struct t_string_mask;
 struct t_upgrade_file;
 struct t_weelist;
 struct t_weelist_item;
@@ -74,7 +76,7 @@ struct t_weelist_item;
  * please change the date with current one; for a second change at same
  * date, increment the 01, otherwise please keep 01.
  */
-#define WEECHAT_PLUGIN_API_VERSION "20240627-01"
+#define WEECHAT_PLUGIN_API_VERSION "20261014-09"
 
 /* macros for defining plugin infos */
 #define WEECHAT_PLUGIN_NAME(__name)                                     \
@@ -342,6 +344,11 @@ struct t_weechat_plugin
                          int case_sensitive);
     int (*string_match_list) (const char *string, const char **masks,
                               int case_sensitive);
+    struct t_string_mask *(*string_mask_compile) (const char *mask,
+                                                  int case_sensitive);
+    int (*string_match_compiled) (const char *string,
+                                  struct t_string_mask *mask);
+    void (*string_mask_free) (struct t_string_mask *mask);
     char *(*string_replace) (const char *string, const char *search,
                              const char *replace);
     char *(*string_expand_home) (const char *path);
@@ -357,6 +364,9 @@ struct t_weechat_plugin
     const char *(*string_regex_flags) (const char *regex, int default_flags,
                                        int *flags);
     int (*string_regcomp) (void *preg, const char *regex, int default_flags);
+    int (*string_regexec) (void *preg, const char *string, size_t nmatch,
+                           void *pmatch, int eflags);
+    void (*string_regfree) (void *preg);
     int (*string_has_highlight) (const char *string,
                                  const char *highlight_words);
     int (*string_has_highlight_regex) (const char *string, const char *regex);
@@ -399,6 +409,8 @@ struct t_weechat_plugin
     int (*string_dyn_concat) (char **string, const char *add, int bytes);
     char *(*string_dyn_free) (char **string, int free_string);
     const char *(*string_concat) (const char *separator, ...);
+    const char *(*string_shared_get) (const char *string);
+    void (*string_shared_free) (const char *string);
 
     /* UTF-8 strings */
     int (*utf8_has_8bits) (const char *string);
@@ -456,6 +468,13 @@ struct t_weechat_plugin
     int (*util_parse_time) (const char *datetime, struct timeval *tv);
     int (*util_version_number) (const char *version);
 
+    /* threads */
+    int (*thread_is_main) ();
+    int (*thread_post) (struct t_weechat_plugin *plugin,
+                        void (*callback)(const void *pointer, void *data),
+                        const void *callback_pointer,
+                        void *callback_data);
+
     /* sorted lists */
     struct t_weelist *(*list_new) ();
     struct t_weelist_item *(*list_add) (struct t_weelist *weelist,
@@ -724,6 +743,8 @@ struct t_weechat_plugin
                                     time_t date, int date_usec,
                                     const char *tags,
                                     const char *message, ...);
+    void (*printf_lines_begin) (struct t_gui_buffer *buffer);
+    void (*printf_lines_end) (struct t_gui_buffer *buffer);
     void (*log_printf) (const char *message, ...);
 
     /* hooks */
@@ -905,6 +926,7 @@ struct t_weechat_plugin
                                  const char *modifier,
                                  const char *modifier_data,
                                  const char *string);
+    int (*hook_modifier_hooked) (const char *modifier);
     struct t_hook *(*hook_info) (struct t_weechat_plugin *plugin,
                                  const char *info_name,
                                  const char *description,
@@ -1002,6 +1024,8 @@ struct t_weechat_plugin
                                  const char *property);
     void (*buffer_set) (struct t_gui_buffer *buffer, const char *property,
                         const char *value);
+    void (*buffer_set_multiple) (struct t_gui_buffer *buffer,
+                                 struct t_hashtable *properties);
     void (*buffer_set_pointer) (struct t_gui_buffer *buffer,
                                 const char *property, void *pointer);
     char *(*buffer_string_replace_local_var) (struct t_gui_buffer *buffer,
@@ -1212,6 +1236,13 @@ struct t_weechat_plugin
                             const char *name);
     void *(*hdata_get_var_at_offset) (struct t_hdata *hdata, void *pointer,
                                       int offset);
+    struct t_hdata_path *(*hdata_path_new) (struct t_hdata *hdata,
+                                            const char *path);
+    void *(*hdata_path_get_var) (struct t_hdata_path *path, void *pointer);
+    void (*hdata_path_free) (struct t_hdata_path *path);
+    struct t_hashtable *(*hdata_get_fields) (struct t_hdata *hdata,
+                                             void *pointer, int count,
+                                             const char *fields);
     void *(*hdata_get_list) (struct t_hdata *hdata, const char *name);
     int (*hdata_check_pointer) (struct t_hdata *hdata, void *list,
                                 void *pointer);
@@ -1339,6 +1370,12 @@ extern int weechat_plugin_end (struct t_weechat_plugin *plugin);
 #define weechat_string_match_list(__string, __masks, __case_sensitive)  \
     (weechat_plugin->string_match_list)(__string, __masks,              \
                                         __case_sensitive)
+#define weechat_string_mask_compile(__mask, __case_sensitive)           \
+    (weechat_plugin->string_mask_compile)(__mask, __case_sensitive)
+#define weechat_string_match_compiled(__string, __mask)                 \
+    (weechat_plugin->string_match_compiled)(__string, __mask)
+#define weechat_string_mask_free(__mask)                                \
+    (weechat_plugin->string_mask_free)(__mask)
 #define weechat_string_replace(__string, __search, __replace)           \
     (weechat_plugin->string_replace)(__string, __search, __replace)
 #define weechat_string_expand_home(__path)                              \
@@ -1360,6 +1397,12 @@ extern int weechat_plugin_end (struct t_weechat_plugin *plugin);
                                          __flags)
 #define weechat_string_regcomp(__preg, __regex, __default_flags)        \
     (weechat_plugin->string_regcomp)(__preg, __regex, __default_flags)
+#define weechat_string_regexec(__preg, __string, __nmatch, __pmatch,  \
+                               __eflags)                                \
+    (weechat_plugin->string_regexec)(__preg, __string, __nmatch,        \
+                                     __pmatch, __eflags)
+#define weechat_string_regfree(__preg)                                  \
+    (weechat_plugin->string_regfree)(__preg)
 #define weechat_string_has_highlight(__string, __highlight_words)       \
     (weechat_plugin->string_has_highlight)(__string, __highlight_words)
 #define weechat_string_has_highlight_regex(__string, __regex)           \
@@ -1432,6 +1475,10 @@ extern int weechat_plugin_end (struct t_weechat_plugin *plugin);
     (weechat_plugin->string_dyn_free)(__string, __free_string)
 #define weechat_string_concat(__separator, __argz...)                   \
     (weechat_plugin->string_concat)(__separator, ##__argz)
+#define weechat_string_shared_get(__string)                             \
+    (weechat_plugin->string_shared_get)(__string)
+#define weechat_string_shared_free(__string)                            \
+    (weechat_plugin->string_shared_free)(__string)
 
 /* UTF-8 strings */
 #define weechat_utf8_has_8bits(__string)                                \
@@ -1531,6 +1578,14 @@ extern int weechat_plugin_end (struct t_weechat_plugin *plugin);
 #define weechat_util_version_number(__version)                          \
     (weechat_plugin->util_version_number)(__version)
 
+/* threads */
+#define weechat_thread_is_main()                                        \
+    (weechat_plugin->thread_is_main)()
+#define weechat_thread_post(__callback, __callback_pointer,             \
+                            __callback_data)                            \
+    (weechat_plugin->thread_post)(weechat_plugin, __callback,           \
+                                  __callback_pointer, __callback_data)
+
 /* sorted list */
 #define weechat_list_new()                                              \
     (weechat_plugin->list_new)()
@@ -1862,6 +1917,10 @@ extern int weechat_plugin_end (struct t_weechat_plugin *plugin);
     (weechat_plugin->printf_y_datetime_tags)(__buffer, __y, __date,     \
                                              __date_usec, __tags,       \
                                              __message, ##__argz)
+#define weechat_printf_lines_begin(__buffer)                            \
+    (weechat_plugin->printf_lines_begin)(__buffer)
+#define weechat_printf_lines_end(__buffer)                              \
+    (weechat_plugin->printf_lines_end)(__buffer)
 #define weechat_log_printf(__message, __argz...)                        \
     (weechat_plugin->log_printf)(__message, ##__argz)
 
@@ -1964,6 +2023,8 @@ extern int weechat_plugin_end (struct t_weechat_plugin *plugin);
                                    __string)                            \
     (weechat_plugin->hook_modifier_exec)(weechat_plugin, __modifier,    \
                                          __modifier_data, __string)
+#define weechat_hook_modifier_hooked(__modifier)                        \
+    (weechat_plugin->hook_modifier_hooked)(__modifier)
 #define weechat_hook_info(__info_name, __description,                   \
                           __args_description, __callback, __pointer,    \
                           __data)                                       \
@@ -2061,6 +2122,8 @@ extern int weechat_plugin_end (struct t_weechat_plugin *plugin);
     (weechat_plugin->buffer_get_pointer)(__buffer, __property)
 #define weechat_buffer_set(__buffer, __property, __value)               \
     (weechat_plugin->buffer_set)(__buffer, __property, __value)
+#define weechat_buffer_set_multiple(__buffer, __properties)             \
+    (weechat_plugin->buffer_set_multiple)(__buffer, __properties)
 #define weechat_buffer_set_pointer(__buffer, __property, __pointer)     \
     (weechat_plugin->buffer_set_pointer)(__buffer, __property,          \
                                          __pointer)
@@ -2318,6 +2381,15 @@ extern int weechat_plugin_end (struct t_weechat_plugin *plugin);
 #define weechat_hdata_get_var_at_offset(__hdata, __pointer, __offset)   \
     (weechat_plugin->hdata_get_var_at_offset)(__hdata, __pointer,       \
                                               __offset)
+#define weechat_hdata_path_new(__hdata, __path)                         \
+    (weechat_plugin->hdata_path_new)(__hdata, __path)
+#define weechat_hdata_path_get_var(__path, __pointer)                   \
+    (weechat_plugin->hdata_path_get_var)(__path, __pointer)
+#define weechat_hdata_path_free(__path)                                 \
+    (weechat_plugin->hdata_path_free)(__path)
+#define weechat_hdata_get_fields(__hdata, __pointer, __count, __fields) \
+    (weechat_plugin->hdata_get_fields)(__hdata, __pointer, __count,     \
+                                       __fields)
 #define weechat_hdata_get_list(__hdata, __name)                         \
     (weechat_plugin->hdata_get_list)(__hdata, __name)
 #define weechat_hdata_check_pointer(__hdata, __list, __pointer)         \
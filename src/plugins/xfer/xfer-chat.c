@@ -335,24 +335,6 @@ xfer_chat_buffer_close_cb (const void *pointer, void *data,
     return WEECHAT_RC_OK;
 }
 
-/*
- * Applies properties to a buffer.
- */
-
-void
-xfer_chat_apply_props (void *data,
-                       struct t_hashtable *hashtable,
-                       const void *key,
-                       const void *value)
-{
-    /* make C compiler happy */
-    (void) hashtable;
-
-    weechat_buffer_set ((struct t_gui_buffer *)data,
-                        (const char *)key,
-                        (const char *)value);
-}
-
 /*
  * Creates buffer for DCC chat.
  */
@@ -394,7 +376,7 @@ xfer_chat_open_buffer (struct t_xfer *xfer)
     {
         weechat_hashtable_remove (buffer_props, "short_name");
         weechat_hashtable_remove (buffer_props, "highlight_words_add");
-        weechat_hashtable_map (buffer_props, &xfer_chat_apply_props, xfer->buffer);
+        weechat_buffer_set_multiple (xfer->buffer, buffer_props);
     }
     else
     {
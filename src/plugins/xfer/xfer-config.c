@@ -59,6 +59,7 @@ struct t_config_option *xfer_config_network_fast_send = NULL;
 struct t_config_option *xfer_config_network_own_ip = NULL;
 struct t_config_option *xfer_config_network_port_range = NULL;
 struct t_config_option *xfer_config_network_send_ack = NULL;
+struct t_config_option *xfer_config_network_send_buffer_size = NULL;
 struct t_config_option *xfer_config_network_speed_limit_recv = NULL;
 struct t_config_option *xfer_config_network_speed_limit_send = NULL;
 struct t_config_option *xfer_config_network_timeout = NULL;
@@ -295,6 +296,14 @@ xfer_config_init ()
                "a freeze if the acks are not sent immediately to the sender"),
             NULL, 0, 0, "on", NULL, 0,
             NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+        xfer_config_network_send_buffer_size = weechat_config_new_option (
+            xfer_config_file, xfer_config_section_network,
+            "send_buffer_size", "integer",
+            N_("size of the socket send buffer when sending files, in "
+               "kilobytes (0 = system default); a large buffer improves "
+               "speed on fast networks"),
+            NULL, 0, 256 * 1024, "0", NULL, 0,
+            NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
         xfer_config_network_speed_limit_recv = weechat_config_new_option (
             xfer_config_file, xfer_config_section_network,
             "speed_limit_recv", "integer",
@@ -41,6 +41,7 @@ extern struct t_config_option *xfer_config_network_fast_send;
 extern struct t_config_option *xfer_config_network_own_ip;
 extern struct t_config_option *xfer_config_network_port_range;
 extern struct t_config_option *xfer_config_network_send_ack;
+extern struct t_config_option *xfer_config_network_send_buffer_size;
 extern struct t_config_option *xfer_config_network_speed_limit_recv;
 extern struct t_config_option *xfer_config_network_speed_limit_send;
 extern struct t_config_option *xfer_config_network_timeout;
@@ -19,6 +19,8 @@
  * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include "config.h"
+
 #include <stdlib.h>
 #include <unistd.h>
 #include <stdio.h>
@@ -31,29 +33,43 @@
 #include <netinet/tcp.h>
 #include <fcntl.h>
 #include <time.h>
+#include <signal.h>
 #include <netdb.h>
 #include <errno.h>
 #include <gcrypt.h>
+#include <pthread.h>
+#ifdef HAVE_SENDFILE
+#include <sys/sendfile.h>
+#endif
 
 #include "../weechat-plugin.h"
 #include "xfer.h"
 #include "xfer-config.h"
+#include "xfer-dcc.h"
 #include "xfer-file.h"
 #include "xfer-network.h"
 
 
 /*
- * Child process for sending file with DCC protocol.
+ * Thread for sending file with DCC protocol.
+ *
+ * If available, sendfile() is used to send the file without copying data
+ * in a buffer (with fallback to read/send if the file can not be sent with
+ * sendfile()).
  */
 
 void
 xfer_dcc_send_file_child (struct t_xfer *xfer)
 {
-    int num_read, num_sent;
-    static char buffer[XFER_BLOCKSIZE_MAX];
+    int num_read, num_sent, send_buffer_size;
+    char buffer[XFER_BLOCKSIZE_MAX];
     uint32_t ack;
     time_t last_sent, new_time, last_second, sent_ok;
     unsigned long long blocksize, speed_limit, sent_last_second;
+#ifdef HAVE_SENDFILE
+    off_t offset;
+    int use_sendfile;
+#endif
 
     /* empty file? just return immediately */
     if (xfer->pos >= xfer->size)
@@ -70,12 +86,27 @@ xfer_dcc_send_file_child (struct t_xfer *xfer)
     if ((speed_limit > 0) && (blocksize > speed_limit * 1024))
         blocksize = speed_limit * 1024;
 
+    send_buffer_size = weechat_config_integer (
+        xfer_config_network_send_buffer_size) * 1024;
+    if (send_buffer_size > 0)
+    {
+        setsockopt (xfer->sock, SOL_SOCKET, SO_SNDBUF,
+                    (void *)&send_buffer_size, sizeof (send_buffer_size));
+    }
+
+#ifdef HAVE_SENDFILE
+    use_sendfile = 1;
+#endif
+
     last_sent = time (NULL);
     last_second = last_sent;
     sent_ok = 0;
     sent_last_second = 0;
     while (1)
     {
+        /* exit if the thread is cancelled (transfer stopped) */
+        pthread_testcancel ();
+
         /* read DCC ACK (sent by receiver) */
         if (xfer->pos > xfer->ack)
         {
@@ -120,15 +151,39 @@ xfer_dcc_send_file_child (struct t_xfer *xfer)
             }
             else
             {
-                lseek (xfer->file, xfer->pos, SEEK_SET);
-                num_read = read (xfer->file, buffer, blocksize);
-                if (num_read < 1)
+#ifdef HAVE_SENDFILE
+                if (use_sendfile)
                 {
-                    xfer_network_write_pipe (xfer, XFER_STATUS_FAILED,
-                                             XFER_ERROR_READ_LOCAL);
-                    return;
+                    offset = (off_t)xfer->pos;
+                    num_sent = sendfile (xfer->sock, xfer->file, &offset,
+                                         (size_t)blocksize);
+                    if ((num_sent < 0)
+                        && ((errno == EINVAL) || (errno == ENOSYS)))
+                    {
+                        /* sendfile not supported for this file: use read/send */
+                        use_sendfile = 0;
+                        continue;
+                    }
+                    if (num_sent == 0)
+                    {
+                        xfer_network_write_pipe (xfer, XFER_STATUS_FAILED,
+                                                 XFER_ERROR_READ_LOCAL);
+                        return;
+                    }
+                }
+                else
+#endif /* HAVE_SENDFILE */
+                {
+                    lseek (xfer->file, xfer->pos, SEEK_SET);
+                    num_read = read (xfer->file, buffer, blocksize);
+                    if (num_read < 1)
+                    {
+                        xfer_network_write_pipe (xfer, XFER_STATUS_FAILED,
+                                                 XFER_ERROR_READ_LOCAL);
+                        return;
+                    }
+                    num_sent = send (xfer->sock, buffer, num_read, 0);
                 }
-                num_sent = send (xfer->sock, buffer, num_read, 0);
                 if (num_sent < 0)
                 {
                     /*
@@ -229,92 +284,248 @@ xfer_dcc_recv_file_send_ack (struct t_xfer *xfer)
 }
 
 /*
- * Reads a resumed xfer from disk for hashing.
+ * Checks if hashing of chunks must be stopped.
  *
  * Returns:
- *   1: OK
- *   0: error
+ *   1: hashing must be stopped
+ *   0: hashing can continue
  */
 
 int
-xfer_dcc_resume_hash (struct t_xfer *xfer)
+xfer_dcc_hash_quit (struct t_xfer_dcc_hash *hash)
 {
+    int quit;
+
+    pthread_mutex_lock (&hash->mutex);
+    quit = hash->quit;
+    pthread_mutex_unlock (&hash->mutex);
+
+    return quit;
+}
+
+/*
+ * Computes CRC32 of a chunk of file.
+ *
+ * Chunk fields "crc32" and "rc" are set (rc is 1 if OK, 0 if error).
+ */
+
+void
+xfer_dcc_hash_chunk (struct t_xfer_dcc_hash_chunk *chunk)
+{
+    gcry_md_hd_t hd;
     char *buf;
-    unsigned long long total_read;
+    unsigned char *bin_hash;
+    unsigned long long pos, end;
     ssize_t length_buf, to_read, num_read;
-    int ret, fd;
+    int fd, hd_open;
 
-    total_read = 0;
-    ret = 1;
-    fd = 0;
+    chunk->rc = 0;
+    chunk->crc32 = 0;
+
+    buf = NULL;
+    hd_open = 0;
+
+    fd = open (chunk->filename, O_RDONLY);
+    if (fd < 0)
+        return;
+
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise (fd, (off_t)chunk->start, (off_t)chunk->size,
+                   POSIX_FADV_SEQUENTIAL);
+#endif
 
     length_buf = 1024 * 1024;
     buf = malloc (length_buf);
     if (!buf)
-        return 0;
+        goto end;
+
+    if (gcry_md_open (&hd, GCRY_MD_CRC32, 0) != 0)
+        goto end;
+    hd_open = 1;
 
-    while (fd <= 0)
+    pos = chunk->start;
+    end = chunk->start + chunk->size;
+    while (pos < end)
     {
-        fd = open (xfer->temp_local_filename, O_RDONLY);
-        if (fd < 0)
+        if (xfer_dcc_hash_quit (chunk->hash))
+            goto end;
+        to_read = (end - pos > (unsigned long long)length_buf) ?
+            length_buf : (ssize_t)(end - pos);
+        num_read = pread (fd, buf, to_read, (off_t)pos);
+        if (num_read > 0)
         {
-            if (errno == EINTR)
-                continue;
-            fd = 0;
-            ret = 0;
-            break;
+            gcry_md_write (hd, buf, num_read);
+            pos += num_read;
+        }
+        else if ((num_read < 0) && (errno == EINTR))
+        {
+            continue;
         }
+        else
+        {
+            /* read error or file is too short */
+            goto end;
+        }
+    }
+
+    gcry_md_final (hd);
+    bin_hash = gcry_md_read (hd, 0);
+    if (bin_hash)
+    {
+        chunk->crc32 = ((uint32_t)bin_hash[0] << 24)
+            | ((uint32_t)bin_hash[1] << 16)
+            | ((uint32_t)bin_hash[2] << 8)
+            | (uint32_t)bin_hash[3];
+        chunk->rc = 1;
+    }
+
+end:
+    if (hd_open)
+        gcry_md_close (hd);
+    free (buf);
+    close (fd);
+}
+
+/*
+ * Thread computing CRC32 of a chunk of file.
+ *
+ * The thread can not be cancelled: it stops when the "quit" flag is set.
+ */
+
+void *
+xfer_dcc_hash_chunk_thread_cb (void *arg)
+{
+    pthread_setcancelstate (PTHREAD_CANCEL_DISABLE, NULL);
+
+    xfer_dcc_hash_chunk ((struct t_xfer_dcc_hash_chunk *)arg);
+
+    return NULL;
+}
+
+/*
+ * Stops threads hashing chunks of file (called if thread receiving file is
+ * cancelled while the hashing is running).
+ */
+
+void
+xfer_dcc_hash_stop_threads (void *arg)
+{
+    struct t_xfer_dcc_hash *hash;
+    int i;
+
+    hash = (struct t_xfer_dcc_hash *)arg;
+
+    pthread_mutex_lock (&hash->mutex);
+    hash->quit = 1;
+    pthread_mutex_unlock (&hash->mutex);
+
+    for (i = 0; i < hash->num_threads; i++)
+    {
+        pthread_join (hash->threads[i], NULL);
     }
+    hash->num_threads = 0;
+}
+
+/*
+ * Computes CRC32 of the part of a resumed file already on disk.
+ *
+ * The file is split in chunks hashed in parallel by threads, and the CRC32
+ * of chunks are combined.
+ *
+ * Returns:
+ *   1: OK (CRC32 is set in "crc32")
+ *   0: error
+ */
 
-    if (fd)
+int
+xfer_dcc_resume_hash (struct t_xfer *xfer, uint32_t *crc32)
+{
+    struct t_xfer_dcc_hash hash;
+    unsigned long long chunk_size;
+    sigset_t set, old_set;
+    int i, num_chunks, rc;
+
+    memset (&hash, 0, sizeof (hash));
+    pthread_mutex_init (&hash.mutex, NULL);
+
+    num_chunks = (int)(xfer->start_resume / XFER_DCC_HASH_CHUNK_MIN_SIZE);
+    if (num_chunks < 1)
+        num_chunks = 1;
+    else if (num_chunks > XFER_DCC_HASH_MAX_THREADS)
+        num_chunks = XFER_DCC_HASH_MAX_THREADS;
+    chunk_size = xfer->start_resume / num_chunks;
+
+    for (i = 0; i < num_chunks; i++)
     {
-        while (total_read < xfer->start_resume)
+        hash.chunks[i].hash = &hash;
+        hash.chunks[i].filename = xfer->temp_local_filename;
+        hash.chunks[i].start = i * chunk_size;
+        hash.chunks[i].size = (i == num_chunks - 1) ?
+            xfer->start_resume - hash.chunks[i].start : chunk_size;
+    }
+
+    pthread_cleanup_push (&xfer_dcc_hash_stop_threads, &hash);
+
+    /* signals are handled by the main thread only */
+    sigfillset (&set);
+    pthread_sigmask (SIG_SETMASK, &set, &old_set);
+    for (i = 0; i < num_chunks; i++)
+    {
+        if (pthread_create (&hash.threads[i], NULL,
+                            &xfer_dcc_hash_chunk_thread_cb,
+                            &hash.chunks[i]) != 0)
         {
-            to_read = xfer->start_resume - total_read;
-            if (to_read > length_buf)
-                num_read = read (fd, buf, length_buf);
-            else
-                num_read = read (fd, buf, to_read);
-            if (num_read > 0)
-            {
-                gcry_md_write (*xfer->hash_handle, buf, num_read);
-                total_read += num_read;
-            }
-            else if (num_read < 0)
-            {
-                if (errno == EINTR)
-                    continue;
-                ret = 0;
-                break;
-            }
+            break;
         }
+        hash.num_threads++;
+    }
+    pthread_sigmask (SIG_SETMASK, &old_set, NULL);
 
-        while (close (fd) < 0)
+    /* wait for end of threads (chunks without thread have rc = 0) */
+    for (i = 0; i < hash.num_threads; i++)
+    {
+        pthread_join (hash.threads[i], NULL);
+    }
+    hash.num_threads = 0;
+
+    pthread_cleanup_pop (0);
+
+    pthread_mutex_destroy (&hash.mutex);
+
+    rc = 1;
+    *crc32 = hash.chunks[0].crc32;
+    for (i = 0; i < num_chunks; i++)
+    {
+        if (!hash.chunks[i].rc)
         {
-            if (errno != EINTR)
-                break;
+            rc = 0;
+            break;
+        }
+        if (i > 0)
+        {
+            *crc32 = xfer_file_crc32_combine (*crc32, hash.chunks[i].crc32,
+                                              hash.chunks[i].size);
         }
     }
 
-    free (buf);
-
-    return ret;
+    return rc;
 }
 
 /*
- * Child process for receiving file with DCC protocol.
+ * Thread for receiving file with DCC protocol.
  */
 
 void
 xfer_dcc_recv_file_child (struct t_xfer *xfer)
 {
     int flags, num_read, ready;
-    static char buffer[XFER_BLOCKSIZE_MAX];
+    char buffer[XFER_BLOCKSIZE_MAX];
     time_t last_sent, last_second, new_time;
     unsigned long long blocksize, pos_last_ack, speed_limit, recv_last_second;
     struct pollfd poll_fd;
     ssize_t written, total_written;
     unsigned char *bin_hash;
+    uint32_t crc32, crc32_resume;
     char hash[9];
 
     speed_limit = (unsigned long long)weechat_config_integer (
@@ -324,15 +535,18 @@ xfer_dcc_recv_file_child (struct t_xfer *xfer)
     if ((speed_limit > 0) && (blocksize > speed_limit * 1024))
         blocksize = speed_limit * 1024;
 
-    /* if resuming, hash the portion of the file we have */
+    /*
+     * if resuming, hash the portion of the file we have (data received
+     * is hashed separately and both CRC32 are combined at the end)
+     */
+    crc32_resume = 0;
     if ((xfer->start_resume > 0) && xfer->hash_handle)
     {
         xfer_network_write_pipe (xfer, XFER_STATUS_HASHING,
                                  XFER_NO_ERROR);
-        if (!xfer_dcc_resume_hash (xfer))
+        if (!xfer_dcc_resume_hash (xfer, &crc32_resume))
         {
-            gcry_md_close (*xfer->hash_handle);
-            free (xfer->hash_handle);
+            /* handle is shared with main thread, which closes it */
             xfer->hash_handle = NULL;
             xfer_network_write_pipe (xfer, XFER_STATUS_HASHING,
                                      XFER_ERROR_HASH_RESUME_ERROR);
@@ -470,9 +684,18 @@ xfer_dcc_recv_file_child (struct t_xfer *xfer)
                             bin_hash = gcry_md_read (*xfer->hash_handle, 0);
                             if (bin_hash)
                             {
-                                snprintf (hash, sizeof (hash), "%.2X%.2X%.2X%.2X",
-                                          bin_hash[0], bin_hash[1], bin_hash[2],
-                                          bin_hash[3]);
+                                crc32 = ((uint32_t)bin_hash[0] << 24)
+                                    | ((uint32_t)bin_hash[1] << 16)
+                                    | ((uint32_t)bin_hash[2] << 8)
+                                    | (uint32_t)bin_hash[3];
+                                if (xfer->start_resume > 0)
+                                {
+                                    crc32 = xfer_file_crc32_combine (
+                                        crc32_resume, crc32,
+                                        xfer->size - xfer->start_resume);
+                                }
+                                snprintf (hash, sizeof (hash), "%08X",
+                                          (unsigned int)crc32);
                                 if (weechat_strcasecmp (hash,
                                                         xfer->hash_target) == 0)
                                 {
@@ -20,6 +20,36 @@
 #ifndef WEECHAT_PLUGIN_XFER_DCC_H
 #define WEECHAT_PLUGIN_XFER_DCC_H
 
+#include <stdint.h>
+#include <pthread.h>
+
+/* hash of resumed file: min size of a chunk, max number of threads */
+#define XFER_DCC_HASH_CHUNK_MIN_SIZE (64ULL * 1024 * 1024)
+#define XFER_DCC_HASH_MAX_THREADS    4
+
+struct t_xfer_dcc_hash;
+
+struct t_xfer_dcc_hash_chunk
+{
+    struct t_xfer_dcc_hash *hash;      /* hash of file (for "quit" flag)    */
+    const char *filename;              /* file to read                      */
+    unsigned long long start;          /* start of chunk in file            */
+    unsigned long long size;           /* size of chunk                     */
+    uint32_t crc32;                    /* CRC32 of chunk                    */
+    int rc;                            /* 1 if chunk was hashed, 0 if error */
+};
+
+struct t_xfer_dcc_hash
+{
+    pthread_mutex_t mutex;             /* mutex for "quit" flag             */
+    int quit;                          /* 1 if threads must stop            */
+    int num_threads;                   /* number of threads created         */
+    pthread_t threads[XFER_DCC_HASH_MAX_THREADS]; /* threads hashing chunks */
+    struct t_xfer_dcc_hash_chunk chunks[XFER_DCC_HASH_MAX_THREADS];
+};
+
+extern void xfer_dcc_hash_chunk (struct t_xfer_dcc_hash_chunk *chunk);
+extern int xfer_dcc_resume_hash (struct t_xfer *xfer, uint32_t *crc32);
 extern void xfer_dcc_send_file_child (struct t_xfer *xfer);
 extern void xfer_dcc_recv_file_child (struct t_xfer *xfer);
 
@@ -22,6 +22,7 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <stdio.h>
+#include <stdint.h>
 #include <string.h>
 #include <time.h>
 #include <sys/types.h>
@@ -89,6 +90,93 @@ xfer_file_search_crc32 (const char *filename)
     return ptr_crc32;
 }
 
+/*
+ * Multiplies a vector by a 32x32 matrix over GF(2) (used to combine CRC32).
+ */
+
+uint32_t
+xfer_file_crc32_matrix_times (const uint32_t *matrix, uint32_t vector)
+{
+    uint32_t sum;
+
+    sum = 0;
+    while (vector)
+    {
+        if (vector & 1)
+            sum ^= *matrix;
+        vector >>= 1;
+        matrix++;
+    }
+
+    return sum;
+}
+
+/*
+ * Squares a 32x32 matrix over GF(2) (used to combine CRC32).
+ */
+
+void
+xfer_file_crc32_matrix_square (uint32_t *square, const uint32_t *matrix)
+{
+    int i;
+
+    for (i = 0; i < 32; i++)
+    {
+        square[i] = xfer_file_crc32_matrix_times (matrix, matrix[i]);
+    }
+}
+
+/*
+ * Combines two CRC32: "crc1" is the CRC32 of a first block of data and "crc2"
+ * is the CRC32 of a second block of "length2" bytes.
+ *
+ * Returns the CRC32 of the two blocks concatenated (without reading data
+ * again), so that blocks of a file can be hashed separately.
+ */
+
+uint32_t
+xfer_file_crc32_combine (uint32_t crc1, uint32_t crc2,
+                         unsigned long long length2)
+{
+    uint32_t even[32], odd[32], row;
+    int i;
+
+    if (length2 == 0)
+        return crc1;
+
+    /* operator for one zero bit (CRC32 polynomial, reversed) */
+    odd[0] = 0xEDB88320;
+    row = 1;
+    for (i = 1; i < 32; i++)
+    {
+        odd[i] = row;
+        row <<= 1;
+    }
+
+    /* operators for two and four zero bits */
+    xfer_file_crc32_matrix_square (even, odd);
+    xfer_file_crc32_matrix_square (odd, even);
+
+    /* apply "length2" zero bytes to "crc1" */
+    while (1)
+    {
+        xfer_file_crc32_matrix_square (even, odd);
+        if (length2 & 1)
+            crc1 = xfer_file_crc32_matrix_times (even, crc1);
+        length2 >>= 1;
+        if (length2 == 0)
+            break;
+        xfer_file_crc32_matrix_square (odd, even);
+        if (length2 & 1)
+            crc1 = xfer_file_crc32_matrix_times (odd, crc1);
+        length2 >>= 1;
+        if (length2 == 0)
+            break;
+    }
+
+    return crc1 ^ crc2;
+}
+
 /*
  * Resumes a download.
  *
@@ -20,7 +20,11 @@
 #ifndef WEECHAT_PLUGIN_XFER_FILE_H
 #define WEECHAT_PLUGIN_XFER_FILE_H
 
+#include <stdint.h>
+
 extern const char *xfer_file_search_crc32 (const char *filename);
+extern uint32_t xfer_file_crc32_combine (uint32_t crc1, uint32_t crc2,
+                                         unsigned long long length2);
 extern void xfer_file_find_filename (struct t_xfer *xfer);
 extern void xfer_file_calculate_speed (struct t_xfer *xfer, int ended);
 
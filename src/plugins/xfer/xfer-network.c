@@ -27,7 +27,6 @@
 #include <string.h>
 #include <fcntl.h>
 #include <sys/types.h>
-#include <sys/wait.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/nameser.h>
@@ -35,6 +34,7 @@
 #include <resolv.h>
 #include <signal.h>
 #include <time.h>
+#include <pthread.h>
 
 #include "../weechat-plugin.h"
 #include "xfer.h"
@@ -151,7 +151,7 @@ xfer_network_resolve_addr (const char *str_address, const char *str_port,
 }
 
 /*
- * Creates pipe for communication with child process.
+ * Creates pipe for communication with thread sending/receiving file.
  *
  * Returns:
  *   1: OK
@@ -197,7 +197,7 @@ xfer_network_write_pipe (struct t_xfer *xfer, int status, int error)
 }
 
 /*
- * Reads data from child via pipe.
+ * Reads data from thread sending/receiving file via pipe.
  */
 
 int
@@ -318,15 +318,97 @@ xfer_network_child_read_cb (const void *pointer, void *data, int fd)
 }
 
 /*
- * Forks process for sending file.
+ * Thread sending or receiving a file.
+ *
+ * The thread works on its own copy of the xfer (like a child process would
+ * do) and reports status and position to the main thread via the pipe.
  */
 
-void
-xfer_network_send_file_fork (struct t_xfer *xfer)
+void *
+xfer_network_child_thread_cb (void *arg)
+{
+    struct t_xfer *xfer;
+
+    xfer = (struct t_xfer *)arg;
+
+    switch (xfer->protocol)
+    {
+        case XFER_NO_PROTOCOL:
+            break;
+        case XFER_PROTOCOL_DCC:
+            if (XFER_IS_RECV(xfer->type))
+                xfer_dcc_recv_file_child (xfer);
+            else
+                xfer_dcc_send_file_child (xfer);
+            break;
+        case XFER_NUM_PROTOCOLS:
+            break;
+    }
+
+    return NULL;
+}
+
+/*
+ * Starts thread for sending or receiving file.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (thread not created)
+ */
+
+int
+xfer_network_child_start (struct t_xfer *xfer)
 {
-    pid_t pid;
+    struct t_xfer *child_xfer;
+    sigset_t set, old_set;
     int rc;
 
+    child_xfer = malloc (sizeof (*child_xfer));
+    if (!child_xfer)
+    {
+        rc = ENOMEM;
+    }
+    else
+    {
+        memcpy (child_xfer, xfer, sizeof (*child_xfer));
+
+        /* signals are handled by the main thread only */
+        sigfillset (&set);
+        pthread_sigmask (SIG_SETMASK, &set, &old_set);
+        rc = pthread_create (&xfer->child_thread, NULL,
+                             &xfer_network_child_thread_cb, child_xfer);
+        pthread_sigmask (SIG_SETMASK, &old_set, NULL);
+    }
+
+    if (rc != 0)
+    {
+        weechat_printf (NULL,
+                        _("%s%s: unable to create thread (%s)"),
+                        weechat_prefix ("error"),
+                        XFER_PLUGIN_NAME,
+                        strerror (rc));
+        free (child_xfer);
+        xfer_close (xfer, XFER_STATUS_FAILED);
+        xfer_buffer_refresh (WEECHAT_HOTLIST_MESSAGE);
+        return 0;
+    }
+
+    xfer->child_xfer = child_xfer;
+    xfer->hook_fd = weechat_hook_fd (xfer->child_read,
+                                     1, 0, 0,
+                                     &xfer_network_child_read_cb,
+                                     xfer, NULL);
+
+    return 1;
+}
+
+/*
+ * Starts thread for sending file.
+ */
+
+void
+xfer_network_send_file_start (struct t_xfer *xfer)
+{
     if (!xfer_network_create_pipe (xfer))
         return;
 
@@ -342,36 +424,11 @@ xfer_network_send_file_fork (struct t_xfer *xfer)
                         strerror (errno));
         xfer_close (xfer, XFER_STATUS_FAILED);
         xfer_buffer_refresh (WEECHAT_HOTLIST_MESSAGE);
+        return;
     }
 
-    switch (pid = fork ())
-    {
-        case -1:  /* fork failed */
-            weechat_printf (NULL,
-                            _("%s%s: unable to fork (%s)"),
-                            weechat_prefix ("error"),
-                            XFER_PLUGIN_NAME,
-                            strerror (errno));
-            xfer_close (xfer, XFER_STATUS_FAILED);
-            xfer_buffer_refresh (WEECHAT_HOTLIST_MESSAGE);
-            return;
-        case 0:  /* child process */
-            rc = setuid (getuid ());
-            (void) rc;
-            close (xfer->child_read);
-            switch (xfer->protocol)
-            {
-                case XFER_NO_PROTOCOL:
-                    _exit (EXIT_SUCCESS);
-                    break;
-                case XFER_PROTOCOL_DCC:
-                    xfer_dcc_send_file_child (xfer);
-                    break;
-                case XFER_NUM_PROTOCOLS:
-                    break;
-            }
-            _exit (EXIT_SUCCESS);
-    }
+    if (!xfer_network_child_start (xfer))
+        return;
 
     weechat_printf (NULL,
                     _("%s: sending file to %s (%s, %s.%s), "
@@ -385,27 +442,15 @@ xfer_network_send_file_fork (struct t_xfer *xfer)
                     xfer->local_filename,
                     xfer->size,
                     xfer_protocol_string[xfer->protocol]);
-
-    /* parent process */
-    xfer->child_pid = pid;
-    close (xfer->child_write);
-    xfer->child_write = -1;
-    xfer->hook_fd = weechat_hook_fd (xfer->child_read,
-                                     1, 0, 0,
-                                     &xfer_network_child_read_cb,
-                                     xfer, NULL);
 }
 
 /*
- * Forks process for receiving file.
+ * Starts thread for receiving file.
  */
 
 void
-xfer_network_recv_file_fork (struct t_xfer *xfer)
+xfer_network_recv_file_start (struct t_xfer *xfer)
 {
-    pid_t pid;
-    int rc;
-
     if (!xfer_network_create_pipe (xfer))
         return;
 
@@ -434,59 +479,29 @@ xfer_network_recv_file_fork (struct t_xfer *xfer)
         return;
     }
 
-    switch (pid = fork ())
-    {
-        case -1:  /* fork failed */
-            weechat_printf (NULL,
-                            _("%s%s: unable to fork (%s)"),
-                            weechat_prefix ("error"),
-                            XFER_PLUGIN_NAME,
-                            strerror (errno));
-            xfer_close (xfer, XFER_STATUS_FAILED);
-            xfer_buffer_refresh (WEECHAT_HOTLIST_MESSAGE);
-            return;
-        case 0:  /* child process */
-            rc = setuid (getuid ());
-            (void) rc;
-            close (xfer->child_read);
-            switch (xfer->protocol)
-            {
-                case XFER_NO_PROTOCOL:
-                    _exit (EXIT_SUCCESS);
-                    break;
-                case XFER_PROTOCOL_DCC:
-                    xfer_dcc_recv_file_child (xfer);
-                    break;
-                case XFER_NUM_PROTOCOLS:
-                    break;
-            }
-            _exit (EXIT_SUCCESS);
-    }
-
-    /* parent process */
-    xfer->child_pid = pid;
-    close (xfer->child_write);
-    xfer->child_write = -1;
-    xfer->hook_fd = weechat_hook_fd (xfer->child_read,
-                                     1, 0, 0,
-                                     &xfer_network_child_read_cb,
-                                     xfer, NULL);
+    xfer_network_child_start (xfer);
 }
 
 /*
- * Kills child process and closes pipe.
+ * Stops thread sending/receiving file and closes pipe.
  */
 
 void
 xfer_network_child_kill (struct t_xfer *xfer)
 {
-    /* kill process */
-    if (xfer->child_pid > 0)
+    /* stop thread */
+    if (xfer->child_xfer)
     {
-        kill (xfer->child_pid, SIGKILL);
-        weechat_command (weechat_buffer_search_main (),
-                         "/mute /wait 100ms /sys waitpid 10");
-        xfer->child_pid = 0;
+        pthread_cancel (xfer->child_thread);
+        pthread_join (xfer->child_thread, NULL);
+        /* close socket connected by thread (active receive) */
+        if ((xfer->child_xfer->sock >= 0)
+            && (xfer->child_xfer->sock != xfer->sock))
+        {
+            close (xfer->child_xfer->sock);
+        }
+        free (xfer->child_xfer);
+        xfer->child_xfer = NULL;
     }
 
     /* close pipe used with child */
@@ -576,10 +591,10 @@ xfer_network_fd_cb (const void *pointer, void *data, int fd)
             switch (xfer->type)
             {
                 case XFER_TYPE_FILE_SEND_PASSIVE:
-                    xfer_network_send_file_fork (xfer);
+                    xfer_network_send_file_start (xfer);
                     break;
                 case XFER_TYPE_FILE_RECV_PASSIVE:
-                    xfer_network_recv_file_fork (xfer);
+                    xfer_network_recv_file_start (xfer);
                     break;
                 default:
                     weechat_printf (NULL,
@@ -881,7 +896,7 @@ xfer_network_connect (struct t_xfer *xfer)
                                                    xfer, NULL);
     }
 
-    /* for file receiving, connection is made in child process (blocking) */
+    /* for file receiving, connection is made in thread (blocking) */
 
     return 1;
 }
@@ -900,9 +915,9 @@ xfer_network_connect_init (struct t_xfer *xfer)
     else
     {
         xfer->status = XFER_STATUS_CONNECTING;
-        /* for a file: launch child process */
+        /* for a file: start thread receiving file */
         if (XFER_IS_FILE(xfer->type) && XFER_IS_ACTIVE(xfer->type))
-            xfer_network_recv_file_fork (xfer);
+            xfer_network_recv_file_start (xfer);
     }
     xfer_buffer_refresh (WEECHAT_HOTLIST_MESSAGE);
 }
@@ -534,7 +534,7 @@ xfer_alloc ()
     new_xfer->start_time = time_now;
     new_xfer->start_transfer = time_now;
     new_xfer->sock = -1;
-    new_xfer->child_pid = 0;
+    new_xfer->child_xfer = NULL;
     new_xfer->child_read = -1;
     new_xfer->child_write = -1;
     new_xfer->hook_fd = NULL;
@@ -912,6 +912,9 @@ xfer_free (struct t_xfer *xfer)
     if (!xfer)
         return;
 
+    /* stop thread sending/receiving file (if still running) */
+    xfer_network_child_kill (xfer);
+
     /* remove xfer from list */
     if (last_xfer == xfer)
         last_xfer = xfer->prev_xfer;
@@ -1636,7 +1639,7 @@ xfer_add_to_infolist (struct t_infolist *infolist, struct t_xfer *xfer)
         return 0;
     if (!weechat_infolist_new_var_integer (ptr_item, "sock", xfer->sock))
         return 0;
-    if (!weechat_infolist_new_var_integer (ptr_item, "child_pid", xfer->child_pid))
+    if (!weechat_infolist_new_var_pointer (ptr_item, "child_xfer", xfer->child_xfer))
         return 0;
     if (!weechat_infolist_new_var_integer (ptr_item, "child_read", xfer->child_read))
         return 0;
@@ -1736,7 +1739,7 @@ xfer_print_log ()
         weechat_log_printf ("  start_time. . . . . . . : %lld", (long long)ptr_xfer->start_time);
         weechat_log_printf ("  start_transfer. . . . . : %lld", (long long)ptr_xfer->start_transfer);
         weechat_log_printf ("  sock. . . . . . . . . . : %d", ptr_xfer->sock);
-        weechat_log_printf ("  child_pid . . . . . . . : %d", ptr_xfer->child_pid);
+        weechat_log_printf ("  child_xfer. . . . . . . : %p", ptr_xfer->child_xfer);
         weechat_log_printf ("  child_read. . . . . . . : %d", ptr_xfer->child_read);
         weechat_log_printf ("  child_write . . . . . . : %d", ptr_xfer->child_write);
         weechat_log_printf ("  hook_fd . . . . . . . . : %p", ptr_xfer->hook_fd);
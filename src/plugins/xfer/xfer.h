@@ -22,6 +22,7 @@
 
 #include <unistd.h>
 #include <time.h>
+#include <pthread.h>
 #include <gcrypt.h>
 #include <sys/socket.h>
 
@@ -173,7 +174,9 @@ struct t_xfer
     time_t start_time;                 /* time when xfer started            */
     time_t start_transfer;             /* time when xfer transfer started   */
     int sock;                          /* socket for connection             */
-    pid_t child_pid;                   /* pid of child process (send/recv)  */
+    pthread_t child_thread;            /* thread sending/receiving file     */
+    struct t_xfer *child_xfer;         /* copy of xfer used by thread       */
+                                       /* (NULL if no thread is running)    */
     int child_read;                    /* to read into child pipe           */
     int child_write;                   /* to write into child pipe          */
     struct t_hook *hook_fd;            /* hook for socket or child pipe     */
@@ -0,0 +1,393 @@
+/*
+ * benchmarks.cpp - run micro-benchmarks in WeeChat environment
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <dlfcn.h>
+#include <string.h>
+#include <time.h>
+#include <locale.h>
+
+#include "benchmarks.h"
+
+extern "C"
+{
+#ifndef HAVE_CONFIG_H
+#define HAVE_CONFIG_H
+#endif
+#include "src/core/weechat.h"
+#include "src/core/core-dir.h"
+#include "src/core/core-string.h"
+#include "src/core/core-version.h"
+#include "src/plugins/plugin.h"
+#include "src/gui/gui-main.h"
+
+    extern void gui_main_init ();
+}
+
+#define LOCALE_BENCHMARKS "en_US.UTF-8"
+
+#define WEECHAT_BENCHMARKS_HOME "./tmp_weechat_benchmarks"
+
+#define BENCHMARKS_MAX 256             /* max number of benchmarks          */
+#define BENCHMARKS_MAX_ITERATIONS 1000000000LL
+
+/* registered benchmarks (static storage: zero before any registration) */
+struct t_benchmark benchmarks[BENCHMARKS_MAX];
+int benchmarks_count;
+
+
+/*
+ * Registers a benchmark (called by static objects created with macro
+ * BENCHMARK, in this binary and in the library with benchmarks on plugins).
+ */
+
+BenchmarkRegister::BenchmarkRegister (const char *group, const char *name,
+                                      const char *args,
+                                      void (*function) (struct t_benchmark *benchmark))
+{
+    if (benchmarks_count >= BENCHMARKS_MAX)
+    {
+        fprintf (stderr, "ERROR: too many benchmarks (max: %d)\n",
+                 BENCHMARKS_MAX);
+        return;
+    }
+    benchmarks[benchmarks_count].group = group;
+    benchmarks[benchmarks_count].name = name;
+    benchmarks[benchmarks_count].args = (args && args[0]) ? args : "0";
+    benchmarks[benchmarks_count].function = function;
+    benchmarks_count++;
+}
+
+/*
+ * Returns current time in nanoseconds (monotonic clock).
+ */
+
+long long
+benchmark_get_time ()
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ((long long)ts.tv_sec * 1000000000LL) + ts.tv_nsec;
+}
+
+/*
+ * Starts the timed loop of a benchmark.
+ *
+ * Returns 0 (first iteration).
+ */
+
+long long
+benchmark_loop_start (struct t_benchmark *benchmark)
+{
+    benchmark->time_loop = 0;
+    benchmark->time_start = benchmark_get_time ();
+    return 0;
+}
+
+/*
+ * Ends the timed loop of a benchmark.
+ *
+ * Returns 0 (end of loop).
+ */
+
+int
+benchmark_loop_end (struct t_benchmark *benchmark)
+{
+    benchmark->time_loop = benchmark_get_time () - benchmark->time_start;
+    return 0;
+}
+
+/*
+ * Runs a benchmark with an argument: the number of iterations is increased
+ * until the loop runs at least "min_time" nanoseconds.
+ *
+ * Returns the best time per iteration (in nanoseconds) among "runs" runs.
+ */
+
+double
+benchmark_run (struct t_benchmark *benchmark, long long arg,
+               long long min_time, int runs, long long *iterations)
+{
+    double best, time_op;
+    long long factor;
+    int i;
+
+    benchmark->arg = arg;
+
+    /* find number of iterations */
+    benchmark->iterations = 1;
+    while (1)
+    {
+        benchmark->time_loop = 0;
+        (benchmark->function) (benchmark);
+        if ((benchmark->time_loop >= min_time)
+            || (benchmark->iterations >= BENCHMARKS_MAX_ITERATIONS))
+        {
+            break;
+        }
+        factor = (benchmark->time_loop > 0) ?
+            ((min_time * 12) / (benchmark->time_loop * 10)) + 1 : 100;
+        if (factor < 2)
+            factor = 2;
+        if (factor > 100)
+            factor = 100;
+        benchmark->iterations *= factor;
+        if (benchmark->iterations > BENCHMARKS_MAX_ITERATIONS)
+            benchmark->iterations = BENCHMARKS_MAX_ITERATIONS;
+    }
+
+    /* keep best time of all runs */
+    best = (double)benchmark->time_loop / benchmark->iterations;
+    for (i = 1; i < runs; i++)
+    {
+        (benchmark->function) (benchmark);
+        time_op = (double)benchmark->time_loop / benchmark->iterations;
+        if (time_op < best)
+            best = time_op;
+    }
+
+    *iterations = benchmark->iterations;
+
+    return best;
+}
+
+/*
+ * Displays help.
+ */
+
+void
+benchmarks_help (const char *name)
+{
+    printf ("Usage: %s [option...]\n"
+            "\n"
+            "  -f, --filter <string>  run only benchmarks with this string "
+            "in name\n"
+            "  -h, --help             display this help\n"
+            "  -l, --list             list benchmarks and exit\n"
+            "  -o, --output <file>    write results in this file "
+            "(JSON format)\n"
+            "  -r, --runs <num>       number of runs of each benchmark "
+            "(default: 3)\n"
+            "  -t, --time <ms>        minimum time of a run in milliseconds "
+            "(default: 200)\n"
+            "\n"
+            "Environment variables:\n"
+            "  WEECHAT_EXTRA_LIBDIR              directory with plugins "
+            "to load\n"
+            "  WEECHAT_BENCHMARKS_PLUGINS_LIB    library with benchmarks "
+            "on plugins\n",
+            name);
+}
+
+/*
+ * Runs benchmarks in WeeChat environment.
+ */
+
+int
+main (int argc, char *argv[])
+{
+    const char *ptr_filter, *ptr_output, *ptr_lib;
+    char *args, **weechat_argv, **list_args, name[256];
+    int i, j, weechat_argc, num_args, runs, list, first;
+    long long min_time, arg, iterations;
+    double time_op;
+    void *handle;
+    FILE *file;
+
+    ptr_filter = NULL;
+    ptr_output = NULL;
+    runs = 3;
+    min_time = 200;
+    list = 0;
+
+    for (i = 1; i < argc; i++)
+    {
+        if ((strcmp (argv[i], "-h") == 0)
+            || (strcmp (argv[i], "--help") == 0))
+        {
+            benchmarks_help (argv[0]);
+            return 0;
+        }
+        else if ((strcmp (argv[i], "-l") == 0)
+                 || (strcmp (argv[i], "--list") == 0))
+        {
+            list = 1;
+        }
+        else if (i + 1 < argc)
+        {
+            if ((strcmp (argv[i], "-f") == 0)
+                || (strcmp (argv[i], "--filter") == 0))
+                ptr_filter = argv[++i];
+            else if ((strcmp (argv[i], "-o") == 0)
+                     || (strcmp (argv[i], "--output") == 0))
+                ptr_output = argv[++i];
+            else if ((strcmp (argv[i], "-r") == 0)
+                     || (strcmp (argv[i], "--runs") == 0))
+                runs = atoi (argv[++i]);
+            else if ((strcmp (argv[i], "-t") == 0)
+                     || (strcmp (argv[i], "--time") == 0))
+                min_time = atoll (argv[++i]);
+            else
+            {
+                benchmarks_help (argv[0]);
+                return 1;
+            }
+        }
+        else
+        {
+            benchmarks_help (argv[0]);
+            return 1;
+        }
+    }
+    if (runs < 1)
+        runs = 1;
+    if (min_time < 1)
+        min_time = 1;
+    min_time *= 1000000LL;
+
+    /* setup environment: English language, no specific timezone */
+    setenv ("LC_ALL", LOCALE_BENCHMARKS, 1);
+    setenv ("TZ", "", 1);
+    if (!setlocale (LC_ALL, ""))
+    {
+        fprintf (stderr,
+                 "ERROR: the locale %s must be installed to run WeeChat "
+                 "benchmarks.\n",
+                 LOCALE_BENCHMARKS);
+        return 1;
+    }
+
+    /* init WeeChat (plugins are loaded below) */
+    (void) dir_rmtree (WEECHAT_BENCHMARKS_HOME);
+    if (string_asprintf (&args, "%s --dir %s -p",
+                         argv[0], WEECHAT_BENCHMARKS_HOME) < 0)
+    {
+        fprintf (stderr, "Memory error\n");
+        return 1;
+    }
+    weechat_argv = string_split_shell (args, &weechat_argc);
+    weechat_init_gettext ();
+    weechat_init (weechat_argc, weechat_argv, &gui_main_init);
+    if (weechat_argv)
+        string_free_split (weechat_argv);
+    free (args);
+    plugin_auto_load (NULL, 0, 1, 0, 0, NULL);
+
+    /* load benchmarks on plugins (optional) */
+    handle = NULL;
+    ptr_lib = getenv ("WEECHAT_BENCHMARKS_PLUGINS_LIB");
+    if (ptr_lib && ptr_lib[0])
+    {
+        handle = dlopen (ptr_lib, RTLD_GLOBAL | RTLD_NOW);
+        if (!handle)
+        {
+            fprintf (stderr,
+                     "ERROR: unable to load benchmarks on plugins: %s\n",
+                     dlerror ());
+            return 1;
+        }
+    }
+
+    file = NULL;
+    if (ptr_output && !list)
+    {
+        file = fopen (ptr_output, "w");
+        if (!file)
+        {
+            fprintf (stderr, "ERROR: unable to write file \"%s\"\n",
+                     ptr_output);
+            return 1;
+        }
+        fprintf (file,
+                 "{\n"
+                 "  \"weechat_version\": \"%s\",\n"
+                 "  \"min_time_ms\": %lld,\n"
+                 "  \"runs\": %d,\n"
+                 "  \"benchmarks\": [",
+                 version_get_version (),
+                 min_time / 1000000LL,
+                 runs);
+    }
+
+    first = 1;
+    for (i = 0; i < benchmarks_count; i++)
+    {
+        list_args = string_split (benchmarks[i].args, ",", NULL, 0, 0,
+                                  &num_args);
+        for (j = 0; list_args && (j < num_args); j++)
+        {
+            arg = atoll (list_args[j]);
+            snprintf (name, sizeof (name), "%s.%s/%lld",
+                      benchmarks[i].group, benchmarks[i].name, arg);
+            if (ptr_filter && !strstr (name, ptr_filter))
+                continue;
+            if (list)
+            {
+                printf ("%s\n", name);
+                continue;
+            }
+            time_op = benchmark_run (&benchmarks[i], arg, min_time, runs,
+                                     &iterations);
+            printf ("%-48s %12lld iterations %14.2f ns/op\n",
+                    name, iterations, time_op);
+            fflush (stdout);
+            if (file)
+            {
+                fprintf (file,
+                         "%s\n"
+                         "    {\n"
+                         "      \"name\": \"%s\",\n"
+                         "      \"group\": \"%s\",\n"
+                         "      \"benchmark\": \"%s\",\n"
+                         "      \"arg\": %lld,\n"
+                         "      \"iterations\": %lld,\n"
+                         "      \"ns_per_op\": %.3f\n"
+                         "    }",
+                         (first) ? "" : ",",
+                         name,
+                         benchmarks[i].group,
+                         benchmarks[i].name,
+                         arg,
+                         iterations,
+                         time_op);
+            }
+            first = 0;
+        }
+        string_free_split (list_args);
+    }
+
+    if (file)
+    {
+        fprintf (file, "\n  ]\n}\n");
+        fclose (file);
+    }
+
+    /* end WeeChat */
+    weechat_end (&gui_main_end);
+
+    if (handle)
+        dlclose (handle);
+
+    return 0;
+}
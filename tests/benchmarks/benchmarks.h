@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WEECHAT_BENCHMARKS_H
+#define WEECHAT_BENCHMARKS_H
+
+/*
+ * A benchmark is a function with an optional setup, a timed loop
+ * (BENCHMARK_LOOP) and an optional cleanup; only the loop is timed.
+ *
+ * The function is called many times by the runner, with a growing number of
+ * iterations, until the loop runs during the minimum time; the result is the
+ * time per iteration (the best one among all runs).
+ *
+ * Example:
+ *
+ *   BENCHMARK(CoreString, Match, "0")
+ *   {
+ *       long long i;
+ *
+ *       BENCHMARK_LOOP(i)
+ *       {
+ *           (void) string_match ("test", "t*t", 0);
+ *       }
+ *   }
+ *
+ * The last argument of BENCHMARK is a list of values separated by commas,
+ * the benchmark is run once for each value (available in "benchmark->arg").
+ */
+
+struct t_benchmark
+{
+    const char *group;                 /* group (like "CoreHashtable")      */
+    const char *name;                  /* name (like "Get")                 */
+    const char *args;                  /* list of args (like "1,10,100")    */
+    void (*function) (struct t_benchmark *benchmark);
+    long long arg;                     /* current arg                       */
+    long long iterations;              /* number of iterations to run       */
+    long long time_start;              /* start of loop (nanoseconds)       */
+    long long time_loop;               /* duration of loop (nanoseconds)    */
+};
+
+class BenchmarkRegister
+{
+public:
+    BenchmarkRegister (const char *group, const char *name, const char *args,
+                       void (*function) (struct t_benchmark *benchmark));
+};
+
+#define BENCHMARK(__group, __name, __args)                              \
+    static void benchmark_##__group##_##__name (                        \
+        struct t_benchmark *benchmark);                                 \
+    static BenchmarkRegister benchmark_register_##__group##_##__name (  \
+        #__group, #__name, __args, &benchmark_##__group##_##__name);    \
+    static void benchmark_##__group##_##__name (                        \
+        struct t_benchmark *benchmark)
+
+#define BENCHMARK_LOOP(__i)                                             \
+    for (__i = benchmark_loop_start (benchmark);                        \
+         (__i < benchmark->iterations) || benchmark_loop_end (benchmark); \
+         __i++)
+
+extern long long benchmark_loop_start (struct t_benchmark *benchmark);
+extern int benchmark_loop_end (struct t_benchmark *benchmark);
+
+#endif /* WEECHAT_BENCHMARKS_H */
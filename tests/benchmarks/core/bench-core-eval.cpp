@@ -0,0 +1,75 @@
+/*
+ * bench-core-eval.cpp - benchmark evaluation functions
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "tests/benchmarks/benchmarks.h"
+
+extern "C"
+{
+#include <stdlib.h>
+#include "src/core/core-eval.h"
+#include "src/core/core-hashtable.h"
+#include "src/plugins/weechat-plugin.h"
+}
+
+/*
+ * Benchmarks functions:
+ *   eval_expression (string)
+ */
+
+BENCHMARK(CoreEval, Expression, "0")
+{
+    char *value;
+    long long i;
+
+    BENCHMARK_LOOP(i)
+    {
+        value = eval_expression ("${info:version} ${color:green}${buffer.number}",
+                                 NULL, NULL, NULL);
+        free (value);
+    }
+}
+
+/*
+ * Benchmarks functions:
+ *   eval_expression (condition)
+ */
+
+BENCHMARK(CoreEval, Condition, "0")
+{
+    struct t_hashtable *options;
+    char *value;
+    long long i;
+
+    options = hashtable_new (32,
+                             WEECHAT_HASHTABLE_STRING,
+                             WEECHAT_HASHTABLE_STRING,
+                             NULL, NULL);
+    hashtable_set (options, "type", "condition");
+
+    BENCHMARK_LOOP(i)
+    {
+        value = eval_expression ("${buffer.number} == 1 && abc =~ ^a",
+                                 NULL, NULL, options);
+        free (value);
+    }
+
+    hashtable_free (options);
+}
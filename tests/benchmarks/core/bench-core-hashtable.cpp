@@ -0,0 +1,96 @@
+/*
+ * bench-core-hashtable.cpp - benchmark hashtable functions
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "tests/benchmarks/benchmarks.h"
+
+extern "C"
+{
+#include <stdio.h>
+#include "src/core/core-hashtable.h"
+#include "src/plugins/weechat-plugin.h"
+}
+
+/*
+ * Creates a hashtable with "count" items (keys: "key0", "key1", ...).
+ */
+
+struct t_hashtable *
+bench_core_hashtable_create (long long count)
+{
+    struct t_hashtable *hashtable;
+    char key[64];
+    long long i;
+
+    hashtable = hashtable_new (32,
+                               WEECHAT_HASHTABLE_STRING,
+                               WEECHAT_HASHTABLE_STRING,
+                               NULL, NULL);
+    for (i = 0; i < count; i++)
+    {
+        snprintf (key, sizeof (key), "key%lld", i);
+        hashtable_set (hashtable, key, "value");
+    }
+    return hashtable;
+}
+
+/*
+ * Benchmarks functions:
+ *   hashtable_set
+ */
+
+BENCHMARK(CoreHashtable, Set, "10,1000,100000")
+{
+    struct t_hashtable *hashtable;
+    char key[64];
+    long long i;
+
+    hashtable = bench_core_hashtable_create (benchmark->arg);
+
+    BENCHMARK_LOOP(i)
+    {
+        snprintf (key, sizeof (key), "key%lld", i % (benchmark->arg + 1));
+        hashtable_set (hashtable, key, "value2");
+    }
+
+    hashtable_free (hashtable);
+}
+
+/*
+ * Benchmarks functions:
+ *   hashtable_get
+ */
+
+BENCHMARK(CoreHashtable, Get, "10,1000,100000")
+{
+    struct t_hashtable *hashtable;
+    char key[64];
+    long long i;
+
+    hashtable = bench_core_hashtable_create (benchmark->arg);
+
+    BENCHMARK_LOOP(i)
+    {
+        snprintf (key, sizeof (key), "key%lld", i % benchmark->arg);
+        (void) hashtable_get (hashtable, key);
+    }
+
+    hashtable_free (hashtable);
+}
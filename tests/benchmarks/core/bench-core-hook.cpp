@@ -0,0 +1,90 @@
+/*
+ * bench-core-hook.cpp - benchmark hook functions
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "tests/benchmarks/benchmarks.h"
+
+extern "C"
+{
+#include <stdlib.h>
+#include <stdio.h>
+#include "src/core/weechat.h"
+#include "src/core/core-hook.h"
+#include "src/plugins/weechat-plugin.h"
+}
+
+/*
+ * Callback for signal hooks.
+ */
+
+int
+bench_core_hook_signal_cb (const void *pointer, void *data,
+                           const char *signal, const char *type_data,
+                           void *signal_data)
+{
+    /* make C++ compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) signal;
+    (void) type_data;
+    (void) signal_data;
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Benchmarks functions:
+ *   hook_signal_send
+ *
+ * The argument is the number of hooks on the signal sent; there are always
+ * 100 other hooks on other signals.
+ */
+
+BENCHMARK(CoreHook, SignalSend, "0,10,100")
+{
+    struct t_hook **hooks;
+    char signal[64];
+    long long i;
+    int j, num_hooks;
+
+    num_hooks = benchmark->arg + 100;
+    hooks = (struct t_hook **)calloc (num_hooks, sizeof (*hooks));
+    for (j = 0; j < num_hooks; j++)
+    {
+        if (j < benchmark->arg)
+            snprintf (signal, sizeof (signal), "bench_signal");
+        else
+            snprintf (signal, sizeof (signal), "bench_other_%d", j);
+        hooks[j] = hook_signal (NULL, signal,
+                                &bench_core_hook_signal_cb, NULL, NULL);
+    }
+
+    BENCHMARK_LOOP(i)
+    {
+        (void) hook_signal_send ("bench_signal",
+                                 WEECHAT_HOOK_SIGNAL_STRING, (void *)"test");
+    }
+
+    for (j = 0; j < num_hooks; j++)
+    {
+        unhook (hooks[j]);
+    }
+    free (hooks);
+}
@@ -0,0 +1,91 @@
+/*
+ * bench-core-secure.cpp - benchmark secured data functions
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "tests/benchmarks/benchmarks.h"
+
+extern "C"
+{
+#include <stdlib.h>
+#include <string.h>
+#include <gcrypt.h>
+#include "src/core/core-secure.h"
+}
+
+#define BENCH_SECURE_PASSPHRASE "this is the passphrase"
+#define BENCH_SECURE_DATA "my_secret_password"
+
+/*
+ * Benchmarks functions:
+ *   secure_encrypt_data
+ */
+
+BENCHMARK(CoreSecure, EncryptData, "0")
+{
+    char *encrypted;
+    int length_encrypted;
+    long long i;
+
+    BENCHMARK_LOOP(i)
+    {
+        encrypted = NULL;
+        (void) secure_encrypt_data (BENCH_SECURE_DATA,
+                                    strlen (BENCH_SECURE_DATA) + 1,
+                                    GCRY_MD_SHA256, GCRY_CIPHER_AES256,
+                                    BENCH_SECURE_PASSPHRASE,
+                                    &encrypted, &length_encrypted);
+        free (encrypted);
+    }
+}
+
+/*
+ * Benchmarks functions:
+ *   secure_decrypt_data
+ */
+
+BENCHMARK(CoreSecure, DecryptData, "0")
+{
+    char *encrypted, *decrypted;
+    int length_encrypted, length_decrypted;
+    long long i;
+
+    encrypted = NULL;
+    length_encrypted = 0;
+    if (secure_encrypt_data (BENCH_SECURE_DATA,
+                             strlen (BENCH_SECURE_DATA) + 1,
+                             GCRY_MD_SHA256, GCRY_CIPHER_AES256,
+                             BENCH_SECURE_PASSPHRASE,
+                             &encrypted, &length_encrypted) != 0)
+    {
+        return;
+    }
+
+    BENCHMARK_LOOP(i)
+    {
+        decrypted = NULL;
+        (void) secure_decrypt_data (encrypted, length_encrypted,
+                                    GCRY_MD_SHA256, GCRY_CIPHER_AES256,
+                                    BENCH_SECURE_PASSPHRASE,
+                                    &decrypted, &length_decrypted);
+        free (decrypted);
+    }
+
+    free (encrypted);
+}
@@ -0,0 +1,75 @@
+/*
+ * bench-core-string.cpp - benchmark string functions
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "tests/benchmarks/benchmarks.h"
+
+extern "C"
+{
+#include "src/core/core-string.h"
+#include "src/plugins/weechat-plugin.h"
+}
+
+/*
+ * Benchmarks functions:
+ *   string_match
+ */
+
+BENCHMARK(CoreString, Match, "0")
+{
+    long long i;
+
+    BENCHMARK_LOOP(i)
+    {
+        (void) string_match ("irc.libera.#weechat", "irc.*.#wee*", 0);
+        (void) string_match ("irc.libera.#weechat", "*.oftc.*", 1);
+    }
+}
+
+/*
+ * Benchmarks functions:
+ *   string_split
+ */
+
+BENCHMARK(CoreString, Split, "2,20,200")
+{
+    char **string, **argv;
+    long long i;
+    int j, argc;
+
+    string = string_dyn_alloc (256);
+    for (j = 0; j < benchmark->arg; j++)
+    {
+        string_dyn_concat (string, (j > 0) ? " " : "", -1);
+        string_dyn_concat (string, "word", -1);
+    }
+
+    BENCHMARK_LOOP(i)
+    {
+        argv = string_split (*string, " ", NULL,
+                             WEECHAT_STRING_SPLIT_STRIP_LEFT
+                             | WEECHAT_STRING_SPLIT_STRIP_RIGHT
+                             | WEECHAT_STRING_SPLIT_COLLAPSE_SEPS,
+                             0, &argc);
+        string_free_split (argv);
+    }
+
+    string_dyn_free (string, 1);
+}
@@ -0,0 +1,73 @@
+/*
+ * bench-gui-color.cpp - benchmark color functions
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "tests/benchmarks/benchmarks.h"
+
+extern "C"
+{
+#include <stdlib.h>
+#include "src/core/core-string.h"
+#include "src/gui/gui-color.h"
+}
+
+/*
+ * Builds a message with "count" colored words.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+bench_gui_color_build_message (long long count)
+{
+    char **string;
+    long long i;
+
+    string = string_dyn_alloc (256);
+    for (i = 0; i < count; i++)
+    {
+        string_dyn_concat (string, gui_color_get_custom ("lightred"), -1);
+        string_dyn_concat (string, "word ", -1);
+        string_dyn_concat (string, gui_color_get_custom ("reset"), -1);
+    }
+    string_dyn_concat (string, "end of message", -1);
+    return string_dyn_free (string, 0);
+}
+
+/*
+ * Benchmarks functions:
+ *   gui_color_decode
+ */
+
+BENCHMARK(GuiColor, Decode, "0,10")
+{
+    char *message, *decoded;
+    long long i;
+
+    message = bench_gui_color_build_message (benchmark->arg);
+
+    BENCHMARK_LOOP(i)
+    {
+        decoded = gui_color_decode (message, NULL);
+        free (decoded);
+    }
+
+    free (message);
+}
@@ -0,0 +1,113 @@
+/*
+ * bench-gui-line.cpp - benchmark line functions
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "tests/benchmarks/benchmarks.h"
+
+extern "C"
+{
+#include <stdlib.h>
+#include <stdio.h>
+#include "src/core/weechat.h"
+#include "src/core/core-hook.h"
+#include "src/gui/gui-buffer.h"
+#include "src/gui/gui-chat.h"
+#include "src/gui/gui-filter.h"
+#include "src/plugins/weechat-plugin.h"
+}
+
+#define BENCH_GUI_LINE_BUFFER_NAME "bench"
+
+/*
+ * Callback for print hooks.
+ */
+
+int
+bench_gui_line_print_cb (const void *pointer, void *data,
+                         struct t_gui_buffer *buffer,
+                         time_t date, int date_usec,
+                         int tags_count, const char **tags,
+                         int displayed, int highlight,
+                         const char *prefix, const char *message)
+{
+    /* make C++ compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) buffer;
+    (void) date;
+    (void) date_usec;
+    (void) tags_count;
+    (void) tags;
+    (void) displayed;
+    (void) highlight;
+    (void) prefix;
+    (void) message;
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Benchmarks functions:
+ *   gui_line_add (via gui_chat_printf_date_tags)
+ *
+ * The argument is both the number of print hooks and the number of
+ * enabled filters (none of them matches the lines added).
+ */
+
+BENCHMARK(GuiLine, Add, "0,10,50")
+{
+    struct t_gui_buffer *buffer;
+    struct t_hook **hooks;
+    char name[64], tags[64];
+    long long i;
+    int j;
+
+    buffer = gui_buffer_new (NULL, BENCH_GUI_LINE_BUFFER_NAME,
+                             NULL, NULL, NULL,
+                             NULL, NULL, NULL);
+    if (!buffer)
+        return;
+
+    hooks = (struct t_hook **)calloc (benchmark->arg + 1, sizeof (*hooks));
+    for (j = 0; j < benchmark->arg; j++)
+    {
+        hooks[j] = hook_print (NULL, buffer, NULL, NULL, 1,
+                               &bench_gui_line_print_cb, NULL, NULL);
+        snprintf (name, sizeof (name), "bench%d", j);
+        snprintf (tags, sizeof (tags), "bench_tag_%d", j);
+        (void) gui_filter_new (1, name, "core." BENCH_GUI_LINE_BUFFER_NAME,
+                               tags, "*");
+    }
+
+    BENCHMARK_LOOP(i)
+    {
+        gui_chat_printf_date_tags (buffer, 0, "irc_privmsg,nick_alice,log1",
+                                   "alice\tthis is a test message %lld", i);
+    }
+
+    for (j = 0; j < benchmark->arg; j++)
+    {
+        unhook (hooks[j]);
+        snprintf (name, sizeof (name), "bench%d", j);
+        gui_filter_free (gui_filter_search_by_name (name));
+    }
+    free (hooks);
+    gui_buffer_close (buffer);
+}
@@ -0,0 +1,102 @@
+/*
+ * bench-irc-message.cpp - benchmark IRC message functions
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "tests/benchmarks/benchmarks.h"
+
+extern "C"
+{
+#include <stdlib.h>
+#include "src/core/core-string.h"
+#include "src/plugins/irc/irc-message.h"
+}
+
+/*
+ * Messages parsed: 0 = short PRIVMSG, 1 = PRIVMSG with tags, 2 = numeric with
+ * many parameters (the benchmark argument is the index in this array).
+ */
+
+const char *bench_irc_message_messages[3] = {
+    ":alice!user@host PRIVMSG #weechat :hello world",
+    "@time=2024-01-01T00:00:00.000Z;account=alice;msgid=abc123 "
+    ":alice!user@host PRIVMSG #weechat :hello world with tags",
+    ":server 005 alice CHANTYPES=# EXCEPTS INVEX CHANMODES=eIbq,k,flj,"
+    "CFLMPQScgimnprstuz CHANLIMIT=#:250 PREFIX=(ov)@+ MAXLIST=bqeI:100 "
+    "MODES=4 NETWORK=libera STATUSMSG=@+ CALLERID=g CASEMAPPING=rfc1459 "
+    ":are supported by this server",
+};
+
+#define BENCH_IRC_MESSAGE(__arg)                                        \
+    bench_irc_message_messages[((__arg) >= 0 && (__arg) <= 2) ? (__arg) : 0]
+
+/*
+ * Benchmarks functions:
+ *   irc_message_parse
+ */
+
+BENCHMARK(IrcMessage, Parse, "0,1,2")
+{
+    const char *message;
+    char *tags, *message_without_tags, *nick, *user, *host, *command;
+    char *channel, *arguments, *text, **params;
+    int num_params, pos_command, pos_arguments, pos_channel, pos_text;
+    long long i;
+
+    message = BENCH_IRC_MESSAGE(benchmark->arg);
+
+    BENCHMARK_LOOP(i)
+    {
+        irc_message_parse (NULL, message,
+                           &tags, &message_without_tags,
+                           &nick, &user, &host, &command, &channel,
+                           &arguments, &text, &params, &num_params,
+                           &pos_command, &pos_arguments, &pos_channel,
+                           &pos_text);
+        free (tags);
+        free (message_without_tags);
+        free (nick);
+        free (user);
+        free (host);
+        free (command);
+        free (channel);
+        free (arguments);
+        free (text);
+        string_free_split (params);
+    }
+}
+
+/*
+ * Benchmarks functions:
+ *   irc_message_parse_spans
+ */
+
+BENCHMARK(IrcMessage, ParseSpans, "0,1,2")
+{
+    struct t_irc_message_spans spans;
+    const char *message;
+    long long i;
+
+    message = BENCH_IRC_MESSAGE(benchmark->arg);
+
+    BENCHMARK_LOOP(i)
+    {
+        irc_message_parse_spans (NULL, message, &spans);
+    }
+}
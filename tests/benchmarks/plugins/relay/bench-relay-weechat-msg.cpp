@@ -0,0 +1,74 @@
+/*
+ * bench-relay-weechat-msg.cpp - benchmark relay weechat message functions
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "tests/benchmarks/benchmarks.h"
+
+extern "C"
+{
+#include <stdlib.h>
+#include <stdio.h>
+#include "src/gui/gui-buffer.h"
+#include "src/plugins/relay/relay.h"
+#include "src/plugins/relay/weechat/relay-weechat-msg.h"
+}
+
+/*
+ * Benchmarks functions:
+ *   relay_weechat_msg_add_hdata
+ *
+ * The argument is the number of buffers created (in addition to the core
+ * buffer).
+ */
+
+BENCHMARK(RelayWeechatMsg, AddHdata, "0,10,100")
+{
+    struct t_gui_buffer **buffers;
+    struct t_relay_weechat_msg *msg;
+    char name[64];
+    long long i;
+    int j;
+
+    buffers = (struct t_gui_buffer **)calloc (benchmark->arg + 1,
+                                              sizeof (*buffers));
+    for (j = 0; j < benchmark->arg; j++)
+    {
+        snprintf (name, sizeof (name), "bench%d", j);
+        buffers[j] = gui_buffer_new (NULL, name,
+                                     NULL, NULL, NULL,
+                                     NULL, NULL, NULL);
+    }
+
+    BENCHMARK_LOOP(i)
+    {
+        msg = relay_weechat_msg_new ("_buffer_list");
+        (void) relay_weechat_msg_add_hdata (
+            msg,
+            "buffer:gui_buffers(*)",
+            "number,full_name,short_name,type,nicklist,title,local_variables");
+        relay_weechat_msg_free (msg);
+    }
+
+    for (j = 0; j < benchmark->arg; j++)
+    {
+        gui_buffer_close (buffers[j]);
+    }
+    free (buffers);
+}
@@ -833,6 +833,20 @@ def test_hdata():
     local_vars = weechat.hdata_hashtable(hdata_buffer, buffer2, 'local_variables')
     value = local_vars['name']
     check(value == 'test')
+    # hdata_get_fields
+    fields = weechat.hdata_get_fields(hdata_line, line1, 0, 'data.date,data.prefix,data.message')
+    check(fields['count'] == '3')
+    check(fields['next'] == '')
+    check(fields['0.pointer'] == line1)
+    check(fields['0.data.date'] == '2146383600')
+    check(fields['0.data.prefix'] == 'prefix1')
+    check(fields['0.data.message'] == '## msg1')
+    check(fields['2.pointer'] == line3)
+    check(fields['2.data.message'] == '## msg3')
+    fields = weechat.hdata_get_fields(hdata_line, line3, -2, 'data.message')
+    check(fields['count'] == '2')
+    check(fields['next'] == line1)
+    check(fields['1.data.message'] == '## msg2')
     # hdata_compare
     check(weechat.hdata_compare(hdata_buffer, buffer, buffer2, 'name', 0) > 0)
     check(weechat.hdata_compare(hdata_buffer, buffer2, buffer, 'name', 0) < 0)
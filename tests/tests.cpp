@@ -70,14 +70,20 @@ IMPORT_TEST_GROUP(CoreHdata);
 IMPORT_TEST_GROUP(CoreHook);
 IMPORT_TEST_GROUP(CoreInfolist);
 IMPORT_TEST_GROUP(CoreList);
+IMPORT_TEST_GROUP(CoreLog);
 IMPORT_TEST_GROUP(CoreNetwork);
+IMPORT_TEST_GROUP(CoreParallel);
+IMPORT_TEST_GROUP(CoreProfile);
 IMPORT_TEST_GROUP(CoreSecure);
 IMPORT_TEST_GROUP(CoreSignal);
+IMPORT_TEST_GROUP(CoreSlab);
 IMPORT_TEST_GROUP(CoreString);
+IMPORT_TEST_GROUP(CoreUpgradeFile);
 IMPORT_TEST_GROUP(CoreUrl);
 IMPORT_TEST_GROUP(CoreUtf8);
 IMPORT_TEST_GROUP(CoreUtil);
 IMPORT_TEST_GROUP(CoreSys);
+IMPORT_TEST_GROUP(CoreThread);
 /* core/hook */
 IMPORT_TEST_GROUP(HookCommand);
 IMPORT_TEST_GROUP(HookCommandRun);
@@ -107,13 +113,18 @@ IMPORT_TEST_GROUP(GuiBuffer);
 IMPORT_TEST_GROUP(GuiChat);
 IMPORT_TEST_GROUP(GuiColor);
 IMPORT_TEST_GROUP(GuiFilter);
+IMPORT_TEST_GROUP(GuiHistory);
 IMPORT_TEST_GROUP(GuiHotlist);
 IMPORT_TEST_GROUP(GuiInput);
 IMPORT_TEST_GROUP(GuiKey);
 IMPORT_TEST_GROUP(GuiLine);
+IMPORT_TEST_GROUP(GuiLineCompress);
+IMPORT_TEST_GROUP(GuiLineSegment);
 IMPORT_TEST_GROUP(GuiNick);
 IMPORT_TEST_GROUP(GuiNicklist);
 /* GUI - Curses */
+IMPORT_TEST_GROUP(GuiCursesKey);
+IMPORT_TEST_GROUP(GuiCursesMain);
 IMPORT_TEST_GROUP(GuiCursesMouse);
 /* scripts */
 IMPORT_TEST_GROUP(Scripts);
@@ -29,14 +29,38 @@ extern "C"
 #define HAVE_CONFIG_H
 #endif
 #include "src/core/weechat.h"
+#include "src/core/core-config.h"
+#include "src/core/core-config-file.h"
+#include "src/core/core-hook.h"
 #include "src/core/hook/hook-command.h"
+#include "src/gui/gui-buffer.h"
 #include "src/plugins/plugin.h"
 
+extern struct t_hook *hook_command_search (struct t_weechat_plugin *plugin,
+                                           const char *command);
 extern char *hook_command_remove_raw_markers (const char *string);
 }
 
+int hook_command_test_calls = 0;
+
 TEST_GROUP(HookCommand)
 {
+    static int command_cb (const void *pointer, void *data,
+                           struct t_gui_buffer *buffer,
+                           int argc, char **argv, char **argv_eol)
+    {
+        /* make C compiler happy */
+        (void) pointer;
+        (void) data;
+        (void) buffer;
+        (void) argc;
+        (void) argv;
+        (void) argv_eol;
+
+        hook_command_test_calls++;
+
+        return WEECHAT_RC_OK;
+    }
 };
 
 /*
@@ -56,7 +80,20 @@ TEST(HookCommand, GetDescription)
 
 TEST(HookCommand, Search)
 {
-    /* TODO: write tests */
+    struct t_hook *hook;
+
+    POINTERS_EQUAL(NULL, hook_command_search (NULL, NULL));
+    POINTERS_EQUAL(NULL, hook_command_search (NULL, "testcmdsearch"));
+
+    hook = hook_command (NULL, "testcmdsearch", "", "", "", "",
+                         &command_cb, NULL, NULL);
+    CHECK(hook);
+    POINTERS_EQUAL(hook, hook_command_search (NULL, "testcmdsearch"));
+    POINTERS_EQUAL(NULL, hook_command_search (NULL, "testcmdsearc"));
+    POINTERS_EQUAL(NULL, hook_command_search (NULL, "TESTCMDSEARCH"));
+
+    unhook (hook);
+    POINTERS_EQUAL(NULL, hook_command_search (NULL, "testcmdsearch"));
 }
 
 /*
@@ -156,7 +193,38 @@ TEST(HookCommand, Command)
 
 TEST(HookCommand, CommandExec)
 {
-    /* TODO: write tests */
+    struct t_hook *hook1, *hook2;
+
+    hook1 = hook_command (NULL, "testcmdexec1", "", "", "", "",
+                          &command_cb, NULL, NULL);
+    hook2 = hook_command (NULL, "testcmdexec2", "", "", "", "",
+                          &command_cb, NULL, NULL);
+
+    hook_command_test_calls = 0;
+    LONGS_EQUAL(HOOK_COMMAND_EXEC_OK,
+                hook_command_exec (gui_buffers, 1, NULL, "/testcmdexec1"));
+    LONGS_EQUAL(1, hook_command_test_calls);
+    LONGS_EQUAL(HOOK_COMMAND_EXEC_OK,
+                hook_command_exec (gui_buffers, 1, NULL,
+                                   "/testcmdexec2 arg"));
+    LONGS_EQUAL(2, hook_command_test_calls);
+    LONGS_EQUAL(HOOK_COMMAND_EXEC_NOT_FOUND,
+                hook_command_exec (gui_buffers, 1, NULL, "/testcmdexec"));
+
+    /* incomplete commands */
+    config_file_option_set (config_look_command_incomplete, "on", 1);
+    LONGS_EQUAL(HOOK_COMMAND_EXEC_AMBIGUOUS_INCOMPLETE,
+                hook_command_exec (gui_buffers, 1, NULL, "/testcmdexec"));
+    unhook (hook2);
+    LONGS_EQUAL(HOOK_COMMAND_EXEC_OK,
+                hook_command_exec (gui_buffers, 1, NULL, "/testcmdexec"));
+    LONGS_EQUAL(3, hook_command_test_calls);
+    config_file_option_reset (config_look_command_incomplete, 1);
+
+    unhook (hook1);
+    LONGS_EQUAL(HOOK_COMMAND_EXEC_NOT_FOUND,
+                hook_command_exec (gui_buffers, 1, NULL, "/testcmdexec1"));
+    LONGS_EQUAL(3, hook_command_test_calls);
 }
 
 /*
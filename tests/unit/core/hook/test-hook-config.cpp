@@ -25,11 +25,43 @@
 
 extern "C"
 {
+#include <stdio.h>
+#include <string.h>
 #include "src/core/weechat.h"
+#include "src/core/core-config.h"
+#include "src/core/core-config-file.h"
+#include "src/core/core-hook.h"
+#include "src/plugins/weechat-plugin.h"
 }
 
+int test_hook_config_count = 0;
+char test_hook_config_option[256];
+char test_hook_config_value[256];
+
 TEST_GROUP(HookConfig)
 {
+    static int test_config_cb (const void *pointer, void *data,
+                               const char *option, const char *value)
+    {
+        /* make C++ compiler happy */
+        (void) pointer;
+        (void) data;
+
+        test_hook_config_count++;
+        snprintf (test_hook_config_option, sizeof (test_hook_config_option),
+                  "%s", option);
+        snprintf (test_hook_config_value, sizeof (test_hook_config_value),
+                  "%s", (value) ? value : "(null)");
+
+        return WEECHAT_RC_OK;
+    }
+
+    void setup ()
+    {
+        test_hook_config_count = 0;
+        test_hook_config_option[0] = '\0';
+        test_hook_config_value[0] = '\0';
+    }
 };
 
 /*
@@ -59,7 +91,83 @@ TEST(HookConfig, Config)
 
 TEST(HookConfig, Exec)
 {
-    /* TODO: write tests */
+    struct t_hook *hook;
+    const char *masks_match[] = {
+        "weechat.look.test_option", "WEECHAT.LOOK.TEST_OPTION",
+        "weechat.look.*", "weechat.*.test_option", "*.test_option", "*",
+        "w*", NULL,
+    };
+    const char *masks_no_match[] = {
+        "", "weechat.look.test", "weechat.look.test_option2", "irc.*",
+        "weechat.color.*", "*.test", "x*", NULL,
+    };
+    int i;
+
+    for (i = 0; masks_match[i]; i++)
+    {
+        hook = hook_config (NULL, masks_match[i], &test_config_cb, NULL, NULL);
+        CHECK(hook);
+        test_hook_config_count = 0;
+        hook_config_exec ("weechat.look.test_option", "value");
+        LONGS_EQUAL(1, test_hook_config_count);
+        STRCMP_EQUAL("weechat.look.test_option", test_hook_config_option);
+        STRCMP_EQUAL("value", test_hook_config_value);
+        unhook (hook);
+    }
+
+    for (i = 0; masks_no_match[i]; i++)
+    {
+        hook = hook_config (NULL, masks_no_match[i], &test_config_cb,
+                            NULL, NULL);
+        CHECK(hook);
+        test_hook_config_count = 0;
+        hook_config_exec ("weechat.look.test_option", "value");
+        LONGS_EQUAL(0, test_hook_config_count);
+        unhook (hook);
+    }
+}
+
+/*
+ * Tests functions:
+ *   config_file_begin_batch
+ *   config_file_end_batch
+ */
+
+TEST(HookConfig, Batch)
+{
+    struct t_hook *hook;
+
+    hook = hook_config (NULL, "weechat.look.day_change", &test_config_cb,
+                        NULL, NULL);
+    CHECK(hook);
+
+    /* without batch: one call per change */
+    config_file_option_set (config_look_day_change, "off", 1);
+    config_file_option_set (config_look_day_change, "on", 1);
+    LONGS_EQUAL(2, test_hook_config_count);
+    STRCMP_EQUAL("on", test_hook_config_value);
+
+    /* with batch (nested): one call at the end of outer batch */
+    test_hook_config_count = 0;
+    config_file_begin_batch ();
+    config_file_begin_batch ();
+    config_file_option_set (config_look_day_change, "off", 1);
+    config_file_option_set (config_look_day_change, "on", 1);
+    config_file_option_set (config_look_day_change, "off", 1);
+    config_file_end_batch ();
+    LONGS_EQUAL(0, test_hook_config_count);
+    config_file_end_batch ();
+    LONGS_EQUAL(1, test_hook_config_count);
+    STRCMP_EQUAL("weechat.look.day_change", test_hook_config_option);
+    STRCMP_EQUAL("off", test_hook_config_value);
+
+    /* end of batch without batch in progress does nothing */
+    config_file_end_batch ();
+    LONGS_EQUAL(0, config_file_batch);
+
+    config_file_option_reset (config_look_day_change, 1);
+
+    unhook (hook);
 }
 
 /*
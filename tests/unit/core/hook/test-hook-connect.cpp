@@ -25,13 +25,71 @@
 
 extern "C"
 {
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
 #include "src/core/weechat.h"
+#include "src/core/core-hook.h"
+#include "src/core/core-util.h"
+#include "src/plugins/plugin.h"
 }
 
+int test_hook_connect_calls = 0;
+int test_hook_connect_status = -1;
+int test_hook_connect_sock = -1;
+char *test_hook_connect_ip_address = NULL;
+
 TEST_GROUP(HookConnect)
 {
 };
 
+/*
+ * Callback of connect hook used in tests.
+ */
+
+int
+test_hook_connect_cb (const void *pointer, void *data,
+                      int status, int gnutls_rc, int sock,
+                      const char *error, const char *ip_address)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) gnutls_rc;
+    (void) error;
+
+    test_hook_connect_calls++;
+    test_hook_connect_status = status;
+    test_hook_connect_sock = sock;
+    free (test_hook_connect_ip_address);
+    test_hook_connect_ip_address = (ip_address) ? strdup (ip_address) : NULL;
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Runs fd hooks until the connect callback is called (max 10 seconds).
+ */
+
+void
+test_hook_connect_wait ()
+{
+    struct timeval tv_start, tv_now;
+
+    gettimeofday (&tv_start, NULL);
+    while (test_hook_connect_calls == 0)
+    {
+        hook_fd_exec ();
+        gettimeofday (&tv_now, NULL);
+        if (util_timeval_diff (&tv_start, &tv_now) > 10 * 1000000LL)
+            break;
+    }
+}
+
 /*
  * Tests functions:
  *   hook_connect_get_description
@@ -49,7 +107,85 @@ TEST(HookConnect, GetDescription)
 
 TEST(HookConnect, Connect)
 {
-    /* TODO: write tests */
+    struct t_hook *hook;
+    struct sockaddr_in addr;
+    socklen_t length;
+    int sock_listen, port;
+
+    POINTERS_EQUAL(NULL, hook_connect (NULL, NULL, NULL, 1234, 0, 0,
+                                       NULL, NULL, 0, NULL, NULL,
+                                       &test_hook_connect_cb, NULL, NULL));
+    POINTERS_EQUAL(NULL, hook_connect (NULL, NULL, "127.0.0.1", 0, 0, 0,
+                                       NULL, NULL, 0, NULL, NULL,
+                                       &test_hook_connect_cb, NULL, NULL));
+    POINTERS_EQUAL(NULL, hook_connect (NULL, NULL, "127.0.0.1", 1234, 0, 0,
+                                       NULL, NULL, 0, NULL, NULL,
+                                       NULL, NULL, NULL));
+
+    /* listen on a free port of localhost */
+    sock_listen = socket (AF_INET, SOCK_STREAM, 0);
+    CHECK(sock_listen >= 0);
+    memset (&addr, 0, sizeof (addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    LONGS_EQUAL(0, bind (sock_listen, (struct sockaddr *)&addr, sizeof (addr)));
+    LONGS_EQUAL(0, listen (sock_listen, 1));
+    length = sizeof (addr);
+    LONGS_EQUAL(0, getsockname (sock_listen, (struct sockaddr *)&addr, &length));
+    port = ntohs (addr.sin_port);
+
+    /* connection OK (without proxy: no fork) */
+    test_hook_connect_calls = 0;
+    hook = hook_connect (NULL, NULL, "127.0.0.1", port, 0, 0,
+                         NULL, NULL, 0, NULL, NULL,
+                         &test_hook_connect_cb, NULL, NULL);
+    CHECK(hook);
+    LONGS_EQUAL(0, HOOK_CONNECT(hook, child_pid));
+    CHECK(HOOK_CONNECT(hook, resolve));
+    test_hook_connect_wait ();
+    LONGS_EQUAL(1, test_hook_connect_calls);
+    LONGS_EQUAL(WEECHAT_HOOK_CONNECT_OK, test_hook_connect_status);
+    CHECK(test_hook_connect_sock >= 0);
+    STRCMP_EQUAL("127.0.0.1", test_hook_connect_ip_address);
+    close (test_hook_connect_sock);
+
+    /* connection refused */
+    close (sock_listen);
+    test_hook_connect_calls = 0;
+    hook = hook_connect (NULL, NULL, "127.0.0.1", port, 0, 0,
+                         NULL, NULL, 0, NULL, NULL,
+                         &test_hook_connect_cb, NULL, NULL);
+    CHECK(hook);
+    test_hook_connect_wait ();
+    LONGS_EQUAL(1, test_hook_connect_calls);
+    LONGS_EQUAL(WEECHAT_HOOK_CONNECT_CONNECTION_REFUSED,
+                test_hook_connect_status);
+    LONGS_EQUAL(-1, test_hook_connect_sock);
+    POINTERS_EQUAL(NULL, test_hook_connect_ip_address);
+
+    /* address not found */
+    test_hook_connect_calls = 0;
+    hook = hook_connect (NULL, NULL, "invalid..address", port, 0, 0,
+                         NULL, NULL, 0, NULL, NULL,
+                         &test_hook_connect_cb, NULL, NULL);
+    CHECK(hook);
+    test_hook_connect_wait ();
+    LONGS_EQUAL(1, test_hook_connect_calls);
+    LONGS_EQUAL(WEECHAT_HOOK_CONNECT_ADDRESS_NOT_FOUND,
+                test_hook_connect_status);
+
+    /* unhook while name resolution is in progress */
+    test_hook_connect_calls = 0;
+    hook = hook_connect (NULL, NULL, "127.0.0.1", port, 0, 0,
+                         NULL, NULL, 0, NULL, NULL,
+                         &test_hook_connect_cb, NULL, NULL);
+    CHECK(hook);
+    unhook (hook);
+    LONGS_EQUAL(0, test_hook_connect_calls);
+
+    free (test_hook_connect_ip_address);
+    test_hook_connect_ip_address = NULL;
 }
 
 /*
@@ -25,13 +25,38 @@
 
 extern "C"
 {
+#include <unistd.h>
 #include "src/core/weechat.h"
+#include "src/core/core-hook.h"
+#include "src/plugins/plugin.h"
 }
 
+int test_hook_fd_calls = 0;
+
 TEST_GROUP(HookFd)
 {
 };
 
+/*
+ * Callback for fd hook (used in tests).
+ */
+
+int
+test_hook_fd_cb (const void *pointer, void *data, int fd)
+{
+    char buf[16];
+
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+
+    test_hook_fd_calls++;
+
+    (void) read (fd, buf, sizeof (buf));
+
+    return WEECHAT_RC_OK;
+}
+
 /*
  * Tests functions:
  *   hook_fd_get_description
@@ -62,6 +87,40 @@ TEST(HookFd, ReallocPollfd)
     /* TODO: write tests */
 }
 
+/*
+ * Tests functions:
+ *   hook_fd_event_realloc
+ */
+
+TEST(HookFd, EventRealloc)
+{
+    /* TODO: write tests */
+}
+
+/*
+ * Tests functions:
+ *   hook_fd_event_register
+ *   hook_fd_event_unregister
+ */
+
+TEST(HookFd, EventRegister)
+{
+    /* TODO: write tests */
+}
+
+/*
+ * Tests functions:
+ *   hook_fd_event_end
+ *   hook_fd_event_add
+ *   hook_fd_event_remove
+ *   hook_fd_event_rebuild_interest_set
+ */
+
+TEST(HookFd, EventAddRemove)
+{
+    /* TODO: write tests */
+}
+
 /*
  * Tests functions:
  *   hook_fd_add_cb
@@ -94,12 +153,108 @@ TEST(HookFd, Fd)
 
 /*
  * Tests functions:
+ *   hook_fd_set
+ */
+
+TEST(HookFd, Set)
+{
+    struct t_hook *hook;
+    int fd[2], old_process_pending;
+
+    LONGS_EQUAL(0, pipe (fd));
+
+    /* force timeout of 0 ms in hook_fd_exec */
+    old_process_pending = hook_process_pending;
+    hook_process_pending = 1;
+
+    /* write end of pipe watched for read: callback never called */
+    hook = hook_fd (NULL, fd[1], 1, 0, 0, &test_hook_fd_cb, NULL, NULL);
+    CHECK(hook);
+    LONGS_EQUAL(HOOK_FD_FLAG_READ, HOOK_FD(hook, flags));
+    test_hook_fd_calls = 0;
+    hook_fd_exec ();
+    LONGS_EQUAL(0, test_hook_fd_calls);
+
+    /* invalid arguments */
+    hook_fd_set (NULL, "flag_write", "1");
+    hook_fd_set (hook, NULL, "1");
+    hook_fd_set (hook, "flag_write", NULL);
+    hook_fd_set (hook, "zzz", "1");
+    hook_fd_set (hook, "flag_write", "abc");
+    LONGS_EQUAL(HOOK_FD_FLAG_READ, HOOK_FD(hook, flags));
+
+    /* watch for write: callback called (pipe is writable) */
+    hook_set (hook, "flag_write", "1");
+    LONGS_EQUAL(HOOK_FD_FLAG_READ | HOOK_FD_FLAG_WRITE, HOOK_FD(hook, flags));
+    hook_fd_exec ();
+    LONGS_EQUAL(1, test_hook_fd_calls);
+    hook_fd_exec ();
+    LONGS_EQUAL(2, test_hook_fd_calls);
+
+    /* stop watching for write: callback not called */
+    hook_set (hook, "flag_write", "0");
+    LONGS_EQUAL(HOOK_FD_FLAG_READ, HOOK_FD(hook, flags));
+    hook_fd_exec ();
+    LONGS_EQUAL(2, test_hook_fd_calls);
+
+    hook_set (hook, "flag_exception", "1");
+    LONGS_EQUAL(HOOK_FD_FLAG_READ | HOOK_FD_FLAG_EXCEPTION,
+                HOOK_FD(hook, flags));
+    hook_set (hook, "flag_read", "0");
+    LONGS_EQUAL(HOOK_FD_FLAG_EXCEPTION, HOOK_FD(hook, flags));
+
+    unhook (hook);
+
+    hook_process_pending = old_process_pending;
+
+    close (fd[0]);
+    close (fd[1]);
+}
+
+/*
+ * Tests functions:
+ *   hook_fd_exec_event
  *   hook_fd_exec
  */
 
 TEST(HookFd, Exec)
 {
-    /* TODO: write tests */
+    struct t_hook *hook;
+    int fd[2], old_process_pending;
+
+    LONGS_EQUAL(0, pipe (fd));
+
+    /* force timeout of 0 ms in hook_fd_exec */
+    old_process_pending = hook_process_pending;
+    hook_process_pending = 1;
+
+    hook = hook_fd (NULL, fd[0], 1, 0, 0, &test_hook_fd_cb, NULL, NULL);
+    CHECK(hook);
+
+    /* nothing to read: callback not called */
+    test_hook_fd_calls = 0;
+    hook_fd_exec ();
+    LONGS_EQUAL(0, test_hook_fd_calls);
+
+    /* data to read: callback called once */
+    LONGS_EQUAL(1, write (fd[1], "a", 1));
+    hook_fd_exec ();
+    LONGS_EQUAL(1, test_hook_fd_calls);
+
+    /* data read by callback: callback not called */
+    hook_fd_exec ();
+    LONGS_EQUAL(1, test_hook_fd_calls);
+
+    /* fd unhooked: callback not called */
+    unhook (hook);
+    LONGS_EQUAL(1, write (fd[1], "a", 1));
+    hook_fd_exec ();
+    LONGS_EQUAL(1, test_hook_fd_calls);
+
+    hook_process_pending = old_process_pending;
+
+    close (fd[0]);
+    close (fd[1]);
 }
 
 /*
@@ -25,13 +25,38 @@
 
 extern "C"
 {
+#include <string.h>
 #include "src/core/weechat.h"
+#include "src/core/core-hook.h"
+#include "src/plugins/plugin.h"
 }
 
+char test_hook_hsignal_calls[64];
+
 TEST_GROUP(HookHsignal)
 {
 };
 
+/*
+ * Callback for hsignal hook (used in tests): appends the pointer (a string)
+ * to the list of calls.
+ */
+
+int
+test_hook_hsignal_cb (const void *pointer, void *data, const char *signal,
+                      struct t_hashtable *hashtable)
+{
+    /* make C compiler happy */
+    (void) data;
+    (void) signal;
+    (void) hashtable;
+
+    strcat (test_hook_hsignal_calls, (const char *)pointer);
+
+    return (strcmp ((const char *)pointer, "E") == 0) ?
+        WEECHAT_RC_OK_EAT : WEECHAT_RC_OK;
+}
+
 /*
  * Tests functions:
  *   hook_hsignal_get_description
@@ -62,6 +87,52 @@ TEST(HookHsignal, Match)
     /* TODO: write tests */
 }
 
+/*
+ * Tests functions:
+ *   hook_hsignal_index_cmp_cb
+ *   hook_hsignal_index_free_value_cb
+ *   hook_hsignal_index_new_list
+ *   hook_hsignal_index_add
+ *   hook_hsignal_index_remove_from_list
+ *   hook_hsignal_index_remove
+ *   hook_hsignal_index_next_wildcard
+ */
+
+TEST(HookHsignal, Index)
+{
+    /* TODO: write tests */
+}
+
+/*
+ * Tests functions:
+ *   hook_hsignal_has_hooks
+ */
+
+TEST(HookHsignal, HasHooks)
+{
+    struct t_hook *hook1, *hook2;
+
+    LONGS_EQUAL(0, hook_hsignal_has_hooks (NULL));
+    LONGS_EQUAL(0, hook_hsignal_has_hooks ("test_hsignal_a"));
+
+    hook1 = hook_hsignal (NULL, "test_hsignal_a", &test_hook_hsignal_cb,
+                          "1", NULL);
+    LONGS_EQUAL(1, hook_hsignal_has_hooks ("test_hsignal_a"));
+    LONGS_EQUAL(1, hook_hsignal_has_hooks ("TEST_HSIGNAL_A"));
+    LONGS_EQUAL(0, hook_hsignal_has_hooks ("test_hsignal_b"));
+
+    hook2 = hook_hsignal (NULL, "test_hsignal_b*", &test_hook_hsignal_cb,
+                          "2", NULL);
+    LONGS_EQUAL(1, hook_hsignal_has_hooks ("test_hsignal_b"));
+    LONGS_EQUAL(1, hook_hsignal_has_hooks ("test_hsignal_bcd"));
+    LONGS_EQUAL(0, hook_hsignal_has_hooks ("test_hsignal_c"));
+
+    unhook (hook1);
+    LONGS_EQUAL(0, hook_hsignal_has_hooks ("test_hsignal_a"));
+    unhook (hook2);
+    LONGS_EQUAL(0, hook_hsignal_has_hooks ("test_hsignal_b"));
+}
+
 /*
  * Tests functions:
  *   hook_hsignal_send
@@ -69,7 +140,55 @@ TEST(HookHsignal, Match)
 
 TEST(HookHsignal, Send)
 {
-    /* TODO: write tests */
+    struct t_hook *hook1, *hook2, *hook3, *hook4, *hook5;
+
+    hook1 = hook_hsignal (NULL, "test_hsignal_a", &test_hook_hsignal_cb,
+                          "1", NULL);
+    hook2 = hook_hsignal (NULL, "2000|test_hsignal_*", &test_hook_hsignal_cb,
+                          "2", NULL);
+    hook3 = hook_hsignal (NULL, "TEST_HSIGNAL_A;test_hsignal_*",
+                          &test_hook_hsignal_cb, "3", NULL);
+    hook4 = hook_hsignal (NULL, "test_hsignal_b", &test_hook_hsignal_cb,
+                          "4", NULL);
+    hook5 = hook_hsignal (NULL, "500|test_hsignal_a;test_hsignal_b",
+                          &test_hook_hsignal_cb, "E", NULL);
+
+    /* hsignal not hooked */
+    test_hook_hsignal_calls[0] = '\0';
+    LONGS_EQUAL(WEECHAT_RC_OK, hook_hsignal_send ("test_xxx", NULL));
+    STRCMP_EQUAL("", test_hook_hsignal_calls);
+
+    /* exact name (case insensitive) and wildcards, sorted by priority */
+    test_hook_hsignal_calls[0] = '\0';
+    LONGS_EQUAL(WEECHAT_RC_OK_EAT,
+                hook_hsignal_send ("Test_Hsignal_A", NULL));
+    STRCMP_EQUAL("213E", test_hook_hsignal_calls);
+
+    /* hook 5 eats the hsignal */
+    test_hook_hsignal_calls[0] = '\0';
+    LONGS_EQUAL(WEECHAT_RC_OK_EAT,
+                hook_hsignal_send ("test_hsignal_b", NULL));
+    STRCMP_EQUAL("234E", test_hook_hsignal_calls);
+
+    /* wildcard only */
+    test_hook_hsignal_calls[0] = '\0';
+    LONGS_EQUAL(WEECHAT_RC_OK, hook_hsignal_send ("test_hsignal_c", NULL));
+    STRCMP_EQUAL("23", test_hook_hsignal_calls);
+
+    unhook (hook5);
+    unhook (hook2);
+
+    test_hook_hsignal_calls[0] = '\0';
+    LONGS_EQUAL(WEECHAT_RC_OK, hook_hsignal_send ("test_hsignal_a", NULL));
+    STRCMP_EQUAL("13", test_hook_hsignal_calls);
+
+    unhook (hook1);
+    unhook (hook3);
+    unhook (hook4);
+
+    test_hook_hsignal_calls[0] = '\0';
+    LONGS_EQUAL(WEECHAT_RC_OK, hook_hsignal_send ("test_hsignal_a", NULL));
+    STRCMP_EQUAL("", test_hook_hsignal_calls);
 }
 
 /*
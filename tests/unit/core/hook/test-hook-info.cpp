@@ -25,11 +25,34 @@
 
 extern "C"
 {
+#include <stdlib.h>
+#include <string.h>
 #include "src/core/weechat.h"
+#include "src/core/core-arraylist.h"
+#include "src/core/core-config.h"
+#include "src/core/core-config-file.h"
+#include "src/core/core-hashtable.h"
+#include "src/core/core-hook.h"
+#include "src/core/core-string.h"
+#include "src/plugins/plugin.h"
 }
 
+int hook_info_cb_calls = 0;
+
 TEST_GROUP(HookInfo)
 {
+    static char *info_cb (const void *pointer, void *data,
+                          const char *info_name, const char *arguments)
+    {
+        /* make C compiler happy */
+        (void) data;
+        (void) info_name;
+        (void) arguments;
+
+        hook_info_cb_calls++;
+
+        return strdup ((const char *)pointer);
+    }
 };
 
 /*
@@ -59,7 +82,118 @@ TEST(HookInfo, Info)
 
 TEST(HookInfo, Get)
 {
-    /* TODO: write tests */
+    struct t_hook *hook1, *hook2, *hook3;
+    char *str;
+
+    POINTERS_EQUAL(NULL, hook_info_get (NULL, NULL, NULL));
+    POINTERS_EQUAL(NULL, hook_info_get (NULL, "", NULL));
+    POINTERS_EQUAL(NULL, hook_info_get (NULL, "test_info", NULL));
+
+    hook1 = hook_info (NULL, "test_info", "", "", &info_cb, "value1", NULL);
+    hook2 = hook_info (NULL, "2000|test_info", "", "", &info_cb, "value2",
+                       NULL);
+    hook3 = hook_info (NULL, "test_info", "", "", &info_cb, "value3", NULL);
+    LONGS_EQUAL(3, arraylist_size (hook_index_name_get (HOOK_TYPE_INFO,
+                                                        "test_info")));
+
+    /* higher priority first, then order of creation */
+    WEE_TEST_STR("value2", hook_info_get (NULL, "test_info", NULL));
+    unhook (hook2);
+    WEE_TEST_STR("value1", hook_info_get (NULL, "test_info", NULL));
+    unhook (hook1);
+    WEE_TEST_STR("value3", hook_info_get (NULL, "test_info", NULL));
+    unhook (hook3);
+    POINTERS_EQUAL(NULL, hook_info_get (NULL, "test_info", NULL));
+    POINTERS_EQUAL(NULL, hook_index_name_get (HOOK_TYPE_INFO, "test_info"));
+
+    /* info from core */
+    str = hook_info_get (NULL, "version", NULL);
+    CHECK(str);
+    free (str);
+}
+
+/*
+ * Tests functions:
+ *   hook_info_set
+ *   hook_info_get (with cache)
+ */
+
+TEST(HookInfo, Cache)
+{
+    struct t_hook *hook;
+    char *str, *color1, *color2;
+
+    hook = hook_info (NULL, "test_info", "", "", &info_cb, "value", NULL);
+    POINTERS_EQUAL(NULL, HOOK_INFO(hook, cache));
+
+    /* no cache: callback is called each time */
+    hook_info_cb_calls = 0;
+    WEE_TEST_STR("value", hook_info_get (NULL, "test_info", "abc"));
+    WEE_TEST_STR("value", hook_info_get (NULL, "test_info", "abc"));
+    LONGS_EQUAL(2, hook_info_cb_calls);
+
+    /* invalid values */
+    hook_set (hook, "cache_signal", "");
+    hook_set (hook, "cache_config", "");
+    POINTERS_EQUAL(NULL, HOOK_INFO(hook, cache));
+
+    /* enable cache, cleared by signals and an option */
+    hook_set (hook, "cache_signal", "test_info_clear1;test_info_clear2");
+    hook_set (hook, "cache_config", "weechat.look.nick_color_stop_chars");
+    CHECK(HOOK_INFO(hook, cache));
+    LONGS_EQUAL(2, HOOK_INFO(hook, num_hooks_cache));
+
+    hook_info_cb_calls = 0;
+    WEE_TEST_STR("value", hook_info_get (NULL, "test_info", "abc"));
+    WEE_TEST_STR("value", hook_info_get (NULL, "test_info", "abc"));
+    WEE_TEST_STR("value", hook_info_get (NULL, "test_info", NULL));
+    WEE_TEST_STR("value", hook_info_get (NULL, "test_info", ""));
+    LONGS_EQUAL(2, hook_info_cb_calls);
+    LONGS_EQUAL(2, HOOK_INFO(hook, cache)->items_count);
+
+    /* clear cache with a signal */
+    hook_signal_send ("test_info_clear2", WEECHAT_HOOK_SIGNAL_STRING, NULL);
+    LONGS_EQUAL(0, HOOK_INFO(hook, cache)->items_count);
+    WEE_TEST_STR("value", hook_info_get (NULL, "test_info", "abc"));
+    LONGS_EQUAL(3, hook_info_cb_calls);
+
+    /* clear cache with an option */
+    config_file_option_set (config_look_nick_color_stop_chars, "_", 1);
+    LONGS_EQUAL(0, HOOK_INFO(hook, cache)->items_count);
+    config_file_option_reset (config_look_nick_color_stop_chars, 1);
+    WEE_TEST_STR("value", hook_info_get (NULL, "test_info", "abc"));
+    LONGS_EQUAL(4, hook_info_cb_calls);
+
+    /* clear cache with property "cache_clear" */
+    hook_set (hook, "cache_clear", "");
+    LONGS_EQUAL(0, HOOK_INFO(hook, cache)->items_count);
+
+    /* disable cache */
+    hook_set (hook, "cache", "0");
+    POINTERS_EQUAL(NULL, HOOK_INFO(hook, cache));
+    POINTERS_EQUAL(NULL, HOOK_INFO(hook, hooks_cache));
+    LONGS_EQUAL(0, HOOK_INFO(hook, num_hooks_cache));
+    hook_info_cb_calls = 0;
+    WEE_TEST_STR("value", hook_info_get (NULL, "test_info", "abc"));
+    WEE_TEST_STR("value", hook_info_get (NULL, "test_info", "abc"));
+    LONGS_EQUAL(2, hook_info_cb_calls);
+
+    /* unhook with cache enabled */
+    hook_set (hook, "cache_signal", "test_info_clear1");
+    WEE_TEST_STR("value", hook_info_get (NULL, "test_info", "abc"));
+    unhook (hook);
+    POINTERS_EQUAL(NULL, hook_info_get (NULL, "test_info", "abc"));
+
+    /* nick colors from core are cached, cache cleared by options */
+    color1 = hook_info_get (NULL, "nick_color_name", "abc");
+    CHECK(color1);
+    config_file_option_set (config_color_chat_nick_colors, "red", 1);
+    WEE_TEST_STR("red", hook_info_get (NULL, "nick_color_name", "abc"));
+    config_file_option_reset (config_color_chat_nick_colors, 1);
+    color2 = hook_info_get (NULL, "nick_color_name", "abc");
+    STRCMP_EQUAL(color1, color2);
+    free (color1);
+    free (color2);
 }
 
 /*
@@ -253,6 +253,68 @@ TEST(HookModifier, Modifier)
     gui_buffer_close (test_buffer);
 }
 
+/*
+ * Callback for modifier hook (used in tests): appends the pointer (a string)
+ * to the string, returns NULL (string unchanged) if pointer is "N" or an
+ * empty string (string dropped) if pointer is "D".
+ */
+
+char *
+test_modifier_append_cb (const void *pointer, void *data,
+                         const char *modifier, const char *modifier_data,
+                         const char *string)
+{
+    char *new_string;
+
+    /* make C++ compiler happy */
+    (void) data;
+    (void) modifier;
+    (void) modifier_data;
+
+    if (strcmp ((const char *)pointer, "N") == 0)
+        return NULL;
+
+    if (strcmp ((const char *)pointer, "D") == 0)
+        return strdup ("");
+
+    if (string_asprintf (&new_string, "%s%s",
+                         string, (const char *)pointer) < 0)
+    {
+        return NULL;
+    }
+
+    return new_string;
+}
+
+/*
+ * Tests functions:
+ *   hook_modifier_hooked
+ */
+
+TEST(HookModifier, Hooked)
+{
+    struct t_hook *hook1, *hook2;
+
+    LONGS_EQUAL(0, hook_modifier_hooked (NULL));
+    LONGS_EQUAL(0, hook_modifier_hooked (""));
+    LONGS_EQUAL(0, hook_modifier_hooked ("test_modifier"));
+
+    hook1 = hook_modifier (NULL, "test_modifier",
+                           &test_modifier_append_cb, "A", NULL);
+    hook2 = hook_modifier (NULL, "test_modifier",
+                           &test_modifier_append_cb, "B", NULL);
+
+    LONGS_EQUAL(1, hook_modifier_hooked ("test_modifier"));
+    LONGS_EQUAL(1, hook_modifier_hooked ("TEST_MODIFIER"));
+    LONGS_EQUAL(0, hook_modifier_hooked ("test_modifier2"));
+
+    unhook (hook1);
+    LONGS_EQUAL(1, hook_modifier_hooked ("test_modifier"));
+
+    unhook (hook2);
+    LONGS_EQUAL(0, hook_modifier_hooked ("test_modifier"));
+}
+
 /*
  * Tests functions:
  *   hook_modifier_exec
@@ -260,7 +322,49 @@ TEST(HookModifier, Modifier)
 
 TEST(HookModifier, Exec)
 {
-    /* TODO: write tests */
+    struct t_hook *hook1, *hook2, *hook3, *hook4, *hook5;
+    char *str;
+
+    POINTERS_EQUAL(NULL, hook_modifier_exec (NULL, NULL, NULL, NULL));
+    POINTERS_EQUAL(NULL, hook_modifier_exec (NULL, "", NULL, "test"));
+    POINTERS_EQUAL(NULL, hook_modifier_exec (NULL, "test_modifier", NULL,
+                                             NULL));
+
+    /* no hooks: string unchanged */
+    WEE_TEST_STR("test",
+                 hook_modifier_exec (NULL, "test_modifier", NULL, "test"));
+
+    /* hooks are called by priority, then order of creation */
+    hook1 = hook_modifier (NULL, "test_modifier",
+                           &test_modifier_append_cb, "A", NULL);
+    hook2 = hook_modifier (NULL, "2000|test_modifier",
+                           &test_modifier_append_cb, "B", NULL);
+    hook3 = hook_modifier (NULL, "test_modifier",
+                           &test_modifier_append_cb, "N", NULL);
+    hook4 = hook_modifier (NULL, "TEST_MODIFIER",
+                           &test_modifier_append_cb, "C", NULL);
+    hook5 = hook_modifier (NULL, "test_modifier2",
+                           &test_modifier_append_cb, "X", NULL);
+    WEE_TEST_STR("testBAC",
+                 hook_modifier_exec (NULL, "test_modifier", NULL, "test"));
+    WEE_TEST_STR("testX",
+                 hook_modifier_exec (NULL, "test_modifier2", NULL, "test"));
+
+    /* string dropped by a hook: next hooks are not called */
+    unhook (hook3);
+    hook3 = hook_modifier (NULL, "1500|test_modifier",
+                           &test_modifier_append_cb, "D", NULL);
+    WEE_TEST_STR("",
+                 hook_modifier_exec (NULL, "test_modifier", NULL, "test"));
+
+    unhook (hook1);
+    unhook (hook2);
+    unhook (hook3);
+    unhook (hook4);
+    unhook (hook5);
+
+    WEE_TEST_STR("test",
+                 hook_modifier_exec (NULL, "test_modifier", NULL, "test"));
 }
 
 /*
@@ -25,13 +25,52 @@
 
 extern "C"
 {
+#include <string.h>
 #include "src/core/weechat.h"
+#include "src/core/core-hook.h"
+#include "src/gui/gui-chat.h"
+#include "src/gui/gui-color.h"
+#include "src/plugins/plugin.h"
 }
 
+int test_hook_print_calls = 0;
+char test_hook_print_message[256];
+
 TEST_GROUP(HookPrint)
 {
 };
 
+/*
+ * Callback for print hook (used in tests).
+ */
+
+int
+test_hook_print_cb (const void *pointer, void *data,
+                    struct t_gui_buffer *buffer,
+                    time_t date, int date_usec,
+                    int tags_count, const char **tags,
+                    int displayed, int highlight,
+                    const char *prefix, const char *message)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) buffer;
+    (void) date;
+    (void) date_usec;
+    (void) tags_count;
+    (void) tags;
+    (void) displayed;
+    (void) highlight;
+    (void) prefix;
+
+    test_hook_print_calls++;
+    snprintf (test_hook_print_message, sizeof (test_hook_print_message),
+              "%s", message);
+
+    return WEECHAT_RC_OK;
+}
+
 /*
  * Tests functions:
  *   hook_print_get_description
@@ -52,6 +91,16 @@ TEST(HookPrint, Print)
     /* TODO: write tests */
 }
 
+/*
+ * Tests functions:
+ *   hook_print_decode_colors
+ */
+
+TEST(HookPrint, DecodeColors)
+{
+    /* TODO: write tests */
+}
+
 /*
  * Tests functions:
  *   hook_print_exec
@@ -59,7 +108,37 @@ TEST(HookPrint, Print)
 
 TEST(HookPrint, Exec)
 {
-    /* TODO: write tests */
+    struct t_hook *hook1, *hook2;
+
+    hook1 = hook_print (NULL, NULL, "test_tag", "hello", 1,
+                        &test_hook_print_cb, NULL, NULL);
+    hook2 = hook_print (NULL, NULL, "test_tag2", NULL, 0,
+                        &test_hook_print_cb, NULL, NULL);
+
+    /* tag not matching */
+    test_hook_print_calls = 0;
+    gui_chat_printf_date_tags (NULL, 0, "other_tag", "hello world");
+    LONGS_EQUAL(0, test_hook_print_calls);
+
+    /* tag matching, message not matching */
+    gui_chat_printf_date_tags (NULL, 0, "test_tag", "bye");
+    LONGS_EQUAL(0, test_hook_print_calls);
+
+    /* tag and message matching (message with colors stripped) */
+    gui_chat_printf_date_tags (NULL, 0, "test_tag", "%shel%slo world",
+                               GUI_COLOR(GUI_COLOR_CHAT_HOST),
+                               GUI_COLOR(GUI_COLOR_CHAT));
+    LONGS_EQUAL(1, test_hook_print_calls);
+    STRCMP_EQUAL("hello world", test_hook_print_message);
+
+    /* tag matching, no message, colors kept */
+    gui_chat_printf_date_tags (NULL, 0, "test_tag2", "%stest",
+                               GUI_COLOR(GUI_COLOR_CHAT_HOST));
+    LONGS_EQUAL(2, test_hook_print_calls);
+    CHECK(strcmp (test_hook_print_message, "test") != 0);
+
+    unhook (hook1);
+    unhook (hook2);
 }
 
 /*
@@ -26,12 +26,34 @@
 extern "C"
 {
 #include "src/core/weechat.h"
+#include "src/core/core-config.h"
+#include "src/core/core-config-file.h"
+#include "src/core/core-hashtable.h"
+#include "src/core/core-hook.h"
+#include "src/core/core-input.h"
+#include "src/gui/gui-buffer.h"
+#include "src/plugins/plugin.h"
 }
 
 TEST_GROUP(HookProcess)
 {
 };
 
+int
+test_hook_process_cb (const void *pointer, void *data, const char *command,
+                      int return_code, const char *out, const char *err)
+{
+    /* make C++ compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) command;
+    (void) return_code;
+    (void) out;
+    (void) err;
+
+    return WEECHAT_RC_OK;
+}
+
 /*
  * Tests functions:
  *   hook_process_get_description
@@ -49,7 +71,73 @@ TEST(HookProcess, GetDescription)
 
 TEST(HookProcess, Hashtable)
 {
-    /* TODO: write tests */
+    struct t_hashtable *options;
+    struct t_hook *hook;
+
+    POINTERS_EQUAL(NULL,
+                   hook_process_hashtable (NULL, NULL, NULL, 0,
+                                           &test_hook_process_cb, NULL, NULL));
+    POINTERS_EQUAL(NULL,
+                   hook_process_hashtable (NULL, "func:test", NULL, 0,
+                                           NULL, NULL, NULL));
+
+    /* default options ("func:" is not executed immediately) */
+    hook = hook_process_hashtable (NULL, "func:test", NULL, 0,
+                                   &test_hook_process_cb, NULL, NULL);
+    CHECK(hook);
+    LONGS_EQUAL(HOOK_PROCESS_BUFFER_SIZE, HOOK_PROCESS(hook, buffer_max));
+    LONGS_EQUAL(HOOK_PROCESS_BUFFER_SIZE, HOOK_PROCESS(hook, buffer_flush));
+    LONGS_EQUAL(0, HOOK_PROCESS(hook, line_mode));
+    LONGS_EQUAL(0, HOOK_PROCESS(hook, output_max));
+    LONGS_EQUAL(0, HOOK_PROCESS(hook, child_pid));
+    LONGS_EQUAL(-1, HOOK_PROCESS(hook, child_pidfd));
+    unhook (hook);
+
+    options = hashtable_new (32,
+                             WEECHAT_HASHTABLE_STRING,
+                             WEECHAT_HASHTABLE_STRING,
+                             NULL, NULL);
+    CHECK(options);
+
+    /* invalid values are ignored */
+    hashtable_set (options, "buffer_size", "10");
+    hashtable_set (options, "buffer_flush", "0");
+    hashtable_set (options, "output_max", "-1");
+    hook = hook_process_hashtable (NULL, "func:test", options, 0,
+                                   &test_hook_process_cb, NULL, NULL);
+    CHECK(hook);
+    LONGS_EQUAL(HOOK_PROCESS_BUFFER_SIZE, HOOK_PROCESS(hook, buffer_max));
+    LONGS_EQUAL(HOOK_PROCESS_BUFFER_SIZE, HOOK_PROCESS(hook, buffer_flush));
+    LONGS_EQUAL(0, HOOK_PROCESS(hook, output_max));
+    unhook (hook);
+
+    /* buffer_flush can not be greater than buffer_size */
+    hashtable_set (options, "buffer_size", "4096");
+    hashtable_set (options, "buffer_flush", "8192");
+    hook = hook_process_hashtable (NULL, "func:test", options, 0,
+                                   &test_hook_process_cb, NULL, NULL);
+    CHECK(hook);
+    LONGS_EQUAL(4096, HOOK_PROCESS(hook, buffer_max));
+    LONGS_EQUAL(4096, HOOK_PROCESS(hook, buffer_flush));
+    unhook (hook);
+
+    /* valid values */
+    hashtable_set (options, "buffer_size", "1048576");
+    hashtable_set (options, "buffer_flush", "1");
+    hashtable_set (options, "line_mode", "");
+    hashtable_set (options, "output_max", "10000000000");
+    hook = hook_process_hashtable (NULL, "func:test", options, 0,
+                                   &test_hook_process_cb, NULL, NULL);
+    CHECK(hook);
+    LONGS_EQUAL(1048576, HOOK_PROCESS(hook, buffer_max));
+    LONGS_EQUAL(1, HOOK_PROCESS(hook, buffer_flush));
+    LONGS_EQUAL(1, HOOK_PROCESS(hook, line_mode));
+    CHECK(HOOK_PROCESS(hook, output_max) == 10000000000LL);
+    unhook (hook);
+
+    hashtable_free (options);
+
+    hook_process_pending = 0;
 }
 
 /*
@@ -72,6 +160,24 @@ TEST(HookProcess, Child)
     /* TODO: write tests */
 }
 
+/*
+ * Tests functions disabled in a child process (hook_process_in_child == 1):
+ *   input_data
+ *   config_file_write
+ */
+
+TEST(HookProcess, InChild)
+{
+    hook_process_in_child = 1;
+
+    LONGS_EQUAL(WEECHAT_RC_ERROR,
+                input_data (gui_buffers, "/print test", NULL, 0, 0));
+    LONGS_EQUAL(WEECHAT_CONFIG_WRITE_ERROR,
+                config_file_write (weechat_config_file));
+
+    hook_process_in_child = 0;
+}
+
 /*
  * Tests functions:
  *   hook_process_send_buffers
@@ -84,12 +190,27 @@ TEST(HookProcess, SendBuffers)
 
 /*
  * Tests functions:
- *   hook_process_add_to_buffer
+ *   hook_process_complete_lines_size
  */
 
-TEST(HookProcess, AddToBuffer)
+TEST(HookProcess, CompleteLinesSize)
 {
-    /* TODO: write tests */
+    LONGS_EQUAL(0, hook_process_complete_lines_size (NULL, 0));
+    LONGS_EQUAL(0, hook_process_complete_lines_size (NULL, 10));
+    LONGS_EQUAL(0, hook_process_complete_lines_size ("", 0));
+    LONGS_EQUAL(0, hook_process_complete_lines_size ("abc", 3));
+    LONGS_EQUAL(1, hook_process_complete_lines_size ("\n", 1));
+    LONGS_EQUAL(4, hook_process_complete_lines_size ("abc\n", 4));
+    LONGS_EQUAL(4, hook_process_complete_lines_size ("abc\ndef", 7));
+    LONGS_EQUAL(8, hook_process_complete_lines_size ("abc\ndef\n", 8));
+    LONGS_EQUAL(8, hook_process_complete_lines_size ("abc\ndef\ngh", 10));
+
+    /* size is used (not the final '\0') */
+    LONGS_EQUAL(0, hook_process_complete_lines_size ("abc\ndef\n", 3));
+    LONGS_EQUAL(4, hook_process_complete_lines_size ("abc\ndef\n", 7));
+
+    /* null bytes in data */
+    LONGS_EQUAL(5, hook_process_complete_lines_size ("a\0bc\nd\0e", 9));
 }
 
 /*
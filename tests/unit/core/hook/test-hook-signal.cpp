@@ -25,13 +25,39 @@
 
 extern "C"
 {
+#include <string.h>
 #include "src/core/weechat.h"
+#include "src/core/core-hook.h"
+#include "src/plugins/plugin.h"
 }
 
+char test_hook_signal_calls[64];
+
 TEST_GROUP(HookSignal)
 {
 };
 
+/*
+ * Callback for signal hook (used in tests): appends the pointer (a string)
+ * to the list of calls.
+ */
+
+int
+test_hook_signal_cb (const void *pointer, void *data, const char *signal,
+                     const char *type_data, void *signal_data)
+{
+    /* make C compiler happy */
+    (void) data;
+    (void) signal;
+    (void) type_data;
+    (void) signal_data;
+
+    strcat (test_hook_signal_calls, (const char *)pointer);
+
+    return (strcmp ((const char *)pointer, "E") == 0) ?
+        WEECHAT_RC_OK_EAT : WEECHAT_RC_OK;
+}
+
 /*
  * Tests functions:
  *   hook_signal_get_description
@@ -62,6 +88,24 @@ TEST(HookSignal, Match)
     /* TODO: write tests */
 }
 
+/*
+ * Tests functions:
+ *   hook_signal_hash_key_cb
+ *   hook_signal_keycmp_cb
+ *   hook_signal_index_cmp_cb
+ *   hook_signal_index_free_value_cb
+ *   hook_signal_index_new_list
+ *   hook_signal_index_add
+ *   hook_signal_index_remove_from_list
+ *   hook_signal_index_remove
+ *   hook_signal_index_next_wildcard
+ */
+
+TEST(HookSignal, Index)
+{
+    /* TODO: write tests */
+}
+
 /*
  * Tests functions:
  *   hook_signal_send
@@ -69,7 +113,65 @@ TEST(HookSignal, Match)
 
 TEST(HookSignal, Send)
 {
-    /* TODO: write tests */
+    struct t_hook *hook1, *hook2, *hook3, *hook4, *hook5;
+
+    hook1 = hook_signal (NULL, "test_signal_a", &test_hook_signal_cb,
+                         "1", NULL);
+    hook2 = hook_signal (NULL, "2000|test_signal_*", &test_hook_signal_cb,
+                         "2", NULL);
+    hook3 = hook_signal (NULL, "TEST_SIGNAL_A;test_signal_*",
+                         &test_hook_signal_cb, "3", NULL);
+    hook4 = hook_signal (NULL, "test_signal_b", &test_hook_signal_cb,
+                         "4", NULL);
+    hook5 = hook_signal (NULL, "500|test_signal_a;test_signal_b",
+                         &test_hook_signal_cb, "E", NULL);
+
+    /* signal not hooked */
+    test_hook_signal_calls[0] = '\0';
+    LONGS_EQUAL(WEECHAT_RC_OK,
+                hook_signal_send ("test_xxx", WEECHAT_HOOK_SIGNAL_STRING,
+                                  NULL));
+    STRCMP_EQUAL("", test_hook_signal_calls);
+
+    /* exact name (case insensitive) and wildcards, sorted by priority */
+    test_hook_signal_calls[0] = '\0';
+    LONGS_EQUAL(WEECHAT_RC_OK_EAT,
+                hook_signal_send ("Test_Signal_A", WEECHAT_HOOK_SIGNAL_STRING,
+                                  NULL));
+    STRCMP_EQUAL("213E", test_hook_signal_calls);
+
+    /* hook 5 eats the signal */
+    test_hook_signal_calls[0] = '\0';
+    LONGS_EQUAL(WEECHAT_RC_OK_EAT,
+                hook_signal_send ("test_signal_b", WEECHAT_HOOK_SIGNAL_STRING,
+                                  NULL));
+    STRCMP_EQUAL("234E", test_hook_signal_calls);
+
+    /* wildcard only */
+    test_hook_signal_calls[0] = '\0';
+    LONGS_EQUAL(WEECHAT_RC_OK,
+                hook_signal_send ("test_signal_c", WEECHAT_HOOK_SIGNAL_STRING,
+                                  NULL));
+    STRCMP_EQUAL("23", test_hook_signal_calls);
+
+    unhook (hook5);
+    unhook (hook2);
+
+    test_hook_signal_calls[0] = '\0';
+    LONGS_EQUAL(WEECHAT_RC_OK,
+                hook_signal_send ("test_signal_a", WEECHAT_HOOK_SIGNAL_STRING,
+                                  NULL));
+    STRCMP_EQUAL("13", test_hook_signal_calls);
+
+    unhook (hook1);
+    unhook (hook3);
+    unhook (hook4);
+
+    test_hook_signal_calls[0] = '\0';
+    LONGS_EQUAL(WEECHAT_RC_OK,
+                hook_signal_send ("test_signal_a", WEECHAT_HOOK_SIGNAL_STRING,
+                                  NULL));
+    STRCMP_EQUAL("", test_hook_signal_calls);
 }
 
 /*
@@ -26,12 +26,50 @@
 extern "C"
 {
 #include "src/core/weechat.h"
+#include "src/core/core-hook.h"
+#include "src/core/core-util.h"
+#include "src/plugins/plugin.h"
 }
 
 TEST_GROUP(HookTimer)
 {
+    /*
+     * Checks that each timer in heap runs after its parent and that its
+     * index is correct.
+     */
+
+    void check_heap ()
+    {
+        int i;
+
+        for (i = 0; i < hook_timer_heap_count; i++)
+        {
+            LONGS_EQUAL(i, HOOK_TIMER(hook_timer_heap[i], heap_index));
+            if (i > 0)
+            {
+                CHECK(util_timeval_cmp (
+                          &HOOK_TIMER(hook_timer_heap[(i - 1) / 2], next_exec),
+                          &HOOK_TIMER(hook_timer_heap[i], next_exec)) <= 0);
+            }
+        }
+    }
 };
 
+/*
+ * Callback for timer hook (used in tests).
+ */
+
+int
+test_hook_timer_cb (const void *pointer, void *data, int remaining_calls)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) remaining_calls;
+
+    return WEECHAT_RC_OK;
+}
+
 /*
  * Tests functions:
  *   hook_timer_get_description
@@ -42,6 +80,59 @@ TEST(HookTimer, GetDescription)
     /* TODO: write tests */
 }
 
+/*
+ * Tests functions:
+ *   hook_timer_heap_cmp
+ *   hook_timer_heap_set
+ *   hook_timer_heap_sift_up
+ *   hook_timer_heap_sift_down
+ *   hook_timer_heap_add
+ *   hook_timer_heap_remove
+ *   hook_timer_heap_rebuild
+ */
+
+TEST(HookTimer, Heap)
+{
+    struct t_hook *hooks[8];
+    long intervals[8] = { 50000, 1000, 70000, 2000, 10, 30000, 10, 600000 };
+    int i, count;
+
+    count = hook_timer_heap_count;
+
+    for (i = 0; i < 8; i++)
+    {
+        hooks[i] = hook_timer (NULL, intervals[i], 0, 0,
+                               &test_hook_timer_cb, NULL, NULL);
+        CHECK(hooks[i]);
+        CHECK(HOOK_TIMER(hooks[i], heap_index) >= 0);
+        check_heap ();
+    }
+    LONGS_EQUAL(count + 8, hook_timer_heap_count);
+
+    /* timer already in heap: not added again */
+    LONGS_EQUAL(1, hook_timer_heap_add (hooks[0]));
+    LONGS_EQUAL(count + 8, hook_timer_heap_count);
+
+    /* remove timers from heap */
+    hook_timer_heap_remove (hooks[4]);
+    LONGS_EQUAL(-1, HOOK_TIMER(hooks[4], heap_index));
+    LONGS_EQUAL(count + 7, hook_timer_heap_count);
+    check_heap ();
+    hook_timer_heap_remove (hooks[4]);
+    LONGS_EQUAL(count + 7, hook_timer_heap_count);
+    LONGS_EQUAL(1, hook_timer_heap_add (hooks[4]));
+    LONGS_EQUAL(count + 8, hook_timer_heap_count);
+    check_heap ();
+
+    /* unhook timers: they are removed from heap */
+    for (i = 0; i < 8; i++)
+    {
+        unhook (hooks[i]);
+        check_heap ();
+    }
+    LONGS_EQUAL(count, hook_timer_heap_count);
+}
+
 /*
  * Tests functions:
  *   hook_timer_init
@@ -52,6 +143,17 @@ TEST(HookTimer, Init)
     /* TODO: write tests */
 }
 
+/*
+ * Tests functions:
+ *   hook_timer_add_cb
+ *   hook_timer_remove_cb
+ */
+
+TEST(HookTimer, AddRemoveCb)
+{
+    /* TODO: write tests */
+}
+
 /*
  * Tests functions:
  *   hook_timer
@@ -62,6 +164,36 @@ TEST(HookTimer, Timer)
     /* TODO: write tests */
 }
 
+/*
+ * Tests functions:
+ *   hook_timer_set
+ */
+
+TEST(HookTimer, Set)
+{
+    struct t_hook *hook;
+
+    hook = hook_timer (NULL, 1000, 0, 0, &test_hook_timer_cb, NULL, NULL);
+    CHECK(hook);
+    LONGS_EQUAL(0, HOOK_TIMER(hook, slack));
+
+    hook_set (hook, "slack", "500");
+    LONGS_EQUAL(500, HOOK_TIMER(hook, slack));
+
+    /* invalid values */
+    hook_set (hook, "slack", "abc");
+    LONGS_EQUAL(500, HOOK_TIMER(hook, slack));
+    hook_set (hook, "slack", "-1");
+    LONGS_EQUAL(500, HOOK_TIMER(hook, slack));
+    hook_timer_set (hook, "slack", NULL);
+    LONGS_EQUAL(500, HOOK_TIMER(hook, slack));
+
+    hook_set (hook, "slack", "0");
+    LONGS_EQUAL(0, HOOK_TIMER(hook, slack));
+
+    unhook (hook);
+}
+
 /*
  * Tests functions:
  *   hook_timer_check_system_clock
@@ -69,7 +201,80 @@ TEST(HookTimer, Timer)
 
 TEST(HookTimer, CheckSystemClock)
 {
-    /* TODO: write tests */
+    struct t_hook *hook;
+    struct timeval tv_now;
+
+    hook = hook_timer (NULL, 1000, 0, 0, &test_hook_timer_cb, NULL, NULL);
+    CHECK(hook);
+    HOOK_TIMER(hook, next_exec).tv_sec += 3600;
+
+    /* same time elapsed on system and monotonic clocks: no change */
+    hook_timer_check_system_clock ();
+    gettimeofday (&tv_now, NULL);
+    CHECK(HOOK_TIMER(hook, next_exec).tv_sec > tv_now.tv_sec + 3000);
+
+    /* system clock changed: timers are reinitialized */
+    hook_last_system_time -= 3600;
+    hook_timer_check_system_clock ();
+    gettimeofday (&tv_now, NULL);
+    CHECK(HOOK_TIMER(hook, next_exec).tv_sec <= tv_now.tv_sec + 1);
+    LONGS_EQUAL(time (NULL), hook_last_system_time);
+    LONGS_EQUAL(hook_timer_get_monotonic_time (), hook_last_monotonic_time);
+    check_heap ();
+
+    unhook (hook);
+}
+
+/*
+ * Tests functions:
+ *   hook_timer_get_wakeup_heap
+ *   hook_timer_get_wakeup
+ */
+
+TEST(HookTimer, GetWakeup)
+{
+    struct t_hook *hooks[4];
+    struct timeval tv_wakeup, tv_expected, tv_deadline;
+    long intervals[4] = { 3000, 1000, 2000, 1500 };
+    int i;
+
+    LONGS_EQUAL(0, hook_timer_get_wakeup (NULL));
+
+    for (i = 0; i < 4; i++)
+    {
+        hooks[i] = hook_timer (NULL, intervals[i], 0, 0,
+                               &test_hook_timer_cb, NULL, NULL);
+        CHECK(hooks[i]);
+    }
+
+    /* timer of 1 second can be delayed to run with the one of 1.5 seconds */
+    hook_set (hooks[1], "slack", "700");
+    hook_set (hooks[3], "slack", "100");
+
+    LONGS_EQUAL(1, hook_timer_get_wakeup (&tv_wakeup));
+
+    /* wakeup date is the lowest deadline of all timers */
+    tv_expected.tv_sec = 0;
+    tv_expected.tv_usec = 0;
+    for (i = 0; i < hook_timer_heap_count; i++)
+    {
+        tv_deadline.tv_sec = HOOK_TIMER(hook_timer_heap[i], next_exec).tv_sec;
+        tv_deadline.tv_usec = HOOK_TIMER(hook_timer_heap[i], next_exec).tv_usec;
+        util_timeval_add (
+            &tv_deadline,
+            ((long long)HOOK_TIMER(hook_timer_heap[i], slack)) * 1000);
+        if ((i == 0) || (util_timeval_cmp (&tv_deadline, &tv_expected) < 0))
+        {
+            tv_expected.tv_sec = tv_deadline.tv_sec;
+            tv_expected.tv_usec = tv_deadline.tv_usec;
+        }
+    }
+    LONGS_EQUAL(0, util_timeval_cmp (&tv_expected, &tv_wakeup));
+
+    for (i = 0; i < 4; i++)
+    {
+        unhook (hooks[i]);
+    }
 }
 
 /*
@@ -79,7 +284,23 @@ TEST(HookTimer, CheckSystemClock)
 
 TEST(HookTimer, GetTimeToNext)
 {
-    /* TODO: write tests */
+    struct t_hook *hook;
+    int timeout;
+
+    hook = hook_timer (NULL, 24 * 3600 * 1000, 0, 0,
+                       &test_hook_timer_cb, NULL, NULL);
+    CHECK(hook);
+
+    timeout = hook_timer_get_time_to_next ();
+    CHECK((timeout >= 1) && (timeout <= HOOK_TIMER_MAX_TIMEOUT));
+
+    /* timer in the past */
+    HOOK_TIMER(hook, next_exec).tv_sec -= 48 * 3600;
+    hook_timer_heap_remove (hook);
+    hook_timer_heap_add (hook);
+    LONGS_EQUAL(1, hook_timer_get_time_to_next ());
+
+    unhook (hook);
 }
 
 /*
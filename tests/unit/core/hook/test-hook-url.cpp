@@ -62,6 +62,16 @@ TEST(HookUrl, RunCallback)
     /* TODO: write tests */
 }
 
+/*
+ * Tests functions:
+ *   hook_url_end_transfer
+ */
+
+TEST(HookUrl, EndTransfer)
+{
+    /* TODO: write tests */
+}
+
 /*
  * Tests functions:
  *   hook_url_thread_cleanup
@@ -92,6 +102,50 @@ TEST(HookUrl, TimerCb)
     /* TODO: write tests */
 }
 
+/*
+ * Tests functions:
+ *   hook_url_multi_check_done
+ */
+
+TEST(HookUrl, MultiCheckDone)
+{
+    /* TODO: write tests */
+}
+
+/*
+ * Tests functions:
+ *   hook_url_multi_fd_cb
+ *   hook_url_multi_timer_cb
+ *   hook_url_multi_socket_function
+ *   hook_url_multi_timer_function
+ */
+
+TEST(HookUrl, MultiCallbacks)
+{
+    /* TODO: write tests */
+}
+
+/*
+ * Tests functions:
+ *   hook_url_multi_init
+ *   hook_url_end
+ */
+
+TEST(HookUrl, MultiInit)
+{
+    /* TODO: write tests */
+}
+
+/*
+ * Tests functions:
+ *   hook_url_transfer_multi
+ */
+
+TEST(HookUrl, TransferMulti)
+{
+    /* TODO: write tests */
+}
+
 /*
  * Tests functions:
  *   hook_url_transfer
@@ -34,6 +34,7 @@ extern "C"
 #include "src/core/core-input.h"
 #include "src/core/core-string.h"
 #include "src/gui/gui-buffer.h"
+#include "src/gui/gui-chat.h"
 }
 
 #define WEE_CMD_BUFFER(__buffer_name, __command)                        \
@@ -414,6 +415,60 @@ TEST(CoreCommand, Save)
     /* TODO: write tests */
 }
 
+/*
+ * Tests functions:
+ *   command_search
+ */
+
+TEST(CoreCommand, Search)
+{
+    struct t_gui_buffer *buffer;
+
+    buffer = gui_buffer_new_user ("test_search", GUI_BUFFER_TYPE_FORMATTED);
+    CHECK(buffer);
+    gui_chat_printf (buffer, "alice\tFirst line");
+    gui_chat_printf (buffer, "bob\tsecond LINE");
+    gui_chat_printf (buffer, "carol\tthird message");
+
+    WEE_CMD_CORE("/search");
+    WEE_CHECK_MSG_CORE("=!=", "Too few arguments for command \"/search\" "
+                       "(help on command: /help search)");
+
+    WEE_CMD_CORE("/search -max");
+    WEE_CHECK_MSG_CORE("=!=", "Error with command \"/search -max\" "
+                       "(help on command: /help search)");
+
+    WEE_CMD_CORE("/search -max abc test");
+    WEE_CHECK_MSG_CORE("=!=", "Invalid number: \"abc\"");
+
+    WEE_CMD_CORE("/search -regex (");
+    WEE_CHECK_MSG_CORE("=!=", "Invalid regular expression: \"(\"");
+
+    WEE_CMD_CORE("/search -buffer core.test_search xyz");
+    WEE_CHECK_MSG_CORE("", "No line found with \"xyz\"");
+
+    WEE_CMD_CORE("/search -buffer core.test_search line");
+    WEE_CHECK_MSG_CORE("", "2 lines found with \"line\":");
+
+    WEE_CMD_CORE("/search -buffer core.test_search -exact line");
+    WEE_CHECK_MSG_CORE("", "1 line found with \"line\":");
+
+    WEE_CMD_CORE("/search -buffer core.test_search -prefix bob");
+    WEE_CHECK_MSG_CORE("", "1 line found with \"bob\":");
+
+    WEE_CMD_CORE("/search -buffer core.test_search bob");
+    WEE_CHECK_MSG_CORE("", "No line found with \"bob\"");
+
+    WEE_CMD_CORE("/search -buffer core.test_search -regex ^(first|third)");
+    WEE_CHECK_MSG_CORE("", "2 lines found with \"^(first|third)\":");
+
+    WEE_CMD_CORE("/search -buffer core.test_search -max 1 -regex i");
+    WEE_CHECK_MSG_CORE("", "3 lines found with \"i\":");
+    WEE_CHECK_MSG_CORE("", "  (2 more lines)");
+
+    gui_buffer_close (buffer);
+}
+
 /*
  * Tests functions:
  *   command_secure
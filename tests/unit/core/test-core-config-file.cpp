@@ -29,7 +29,9 @@ extern "C"
 #include "src/core/core-arraylist.h"
 #include "src/core/core-config-file.h"
 #include "src/core/core-config.h"
+#include "src/core/core-hashtable.h"
 #include "src/core/core-secure-config.h"
+#include "src/core/core-string.h"
 #include "src/gui/gui-color.h"
 #include "src/plugins/plugin.h"
 #include "src/plugins/plugin-config.h"
@@ -38,6 +40,7 @@ extern struct t_config_file *config_file_find_pos (const char *name);
 extern char *config_file_option_full_name (struct t_config_option *option);
 extern int config_file_string_boolean_is_valid (const char *text);
 extern const char *config_file_option_escape (const char *name);
+extern void config_file_section_sort_options (struct t_config_section *section);
 }
 
 struct t_config_option *ptr_option_bool = NULL;
@@ -375,11 +378,67 @@ TEST(CoreConfigFile, OptionFindPos)
 /*
  * Tests functions:
  *   config_file_option_insert_in_section
+ *   config_file_section_sort_options
  */
 
 TEST(CoreConfigFile, OptionInsertInSection)
 {
-    /* TODO: write tests */
+    struct t_config_file *ptr_config;
+    struct t_config_section *ptr_section;
+    const char *names[] = { "test_c", "test_a", "test_b", NULL };
+    int i;
+
+    ptr_config = config_file_new (NULL, "test_insert", NULL, NULL, NULL);
+    CHECK(ptr_config);
+    ptr_section = config_file_new_section (ptr_config, "section",
+                                           0, 0,
+                                           NULL, NULL, NULL,
+                                           NULL, NULL, NULL,
+                                           NULL, NULL, NULL,
+                                           NULL, NULL, NULL,
+                                           NULL, NULL, NULL);
+    CHECK(ptr_section);
+
+    /* options are sorted on insert */
+    for (i = 0; names[i]; i++)
+    {
+        CHECK(config_file_new_option (
+                  ptr_config, ptr_section,
+                  names[i], "integer", "", NULL, 0, 100, "50", NULL, 0,
+                  NULL, NULL, NULL,
+                  NULL, NULL, NULL,
+                  NULL, NULL, NULL));
+    }
+    STRCMP_EQUAL("test_a", ptr_section->options->name);
+    STRCMP_EQUAL("test_b", ptr_section->options->next_option->name);
+    STRCMP_EQUAL("test_c", ptr_section->last_option->name);
+    config_file_section_free_options (ptr_section);
+
+    /* options are appended during bulk load, then sorted once */
+    config_file_bulk_load = ptr_config;
+    for (i = 0; names[i]; i++)
+    {
+        CHECK(config_file_new_option (
+                  ptr_config, ptr_section,
+                  names[i], "integer", "", NULL, 0, 100, "50", NULL, 0,
+                  NULL, NULL, NULL,
+                  NULL, NULL, NULL,
+                  NULL, NULL, NULL));
+    }
+    config_file_bulk_load = NULL;
+    STRCMP_EQUAL("test_c", ptr_section->options->name);
+    STRCMP_EQUAL("test_a", ptr_section->options->next_option->name);
+    STRCMP_EQUAL("test_b", ptr_section->last_option->name);
+    config_file_section_sort_options (ptr_section);
+    STRCMP_EQUAL("test_a", ptr_section->options->name);
+    POINTERS_EQUAL(NULL, ptr_section->options->prev_option);
+    STRCMP_EQUAL("test_b", ptr_section->options->next_option->name);
+    STRCMP_EQUAL("test_c", ptr_section->last_option->name);
+    POINTERS_EQUAL(NULL, ptr_section->last_option->next_option);
+    POINTERS_EQUAL(ptr_section->options->next_option,
+                   ptr_section->last_option->prev_option);
+
+    config_file_free (ptr_config);
 }
 
 /*
@@ -580,6 +639,78 @@ TEST(CoreConfigFile, SearchWithString)
     POINTERS_EQUAL(weechat_config_section_color, ptr_section);
     POINTERS_EQUAL(config_color_chat_channel, ptr_option);
     STRCMP_EQUAL("chat_channel", pos_option_name);
+
+    ptr_config = (struct t_config_file *)0x1;
+    ptr_section = (struct t_config_section *)0x1;
+    ptr_option = (struct t_config_option *)0x1;
+    pos_option_name = (char *)0x1;
+    config_file_search_with_string ("weechat.color.zzz",
+                                    &ptr_config, &ptr_section,
+                                    &ptr_option, &pos_option_name);
+    POINTERS_EQUAL(weechat_config_file, ptr_config);
+    POINTERS_EQUAL(weechat_config_section_color, ptr_section);
+    POINTERS_EQUAL(NULL, ptr_option);
+    STRCMP_EQUAL("zzz", pos_option_name);
+
+    ptr_config = (struct t_config_file *)0x1;
+    ptr_section = (struct t_config_section *)0x1;
+    ptr_option = (struct t_config_option *)0x1;
+    pos_option_name = (char *)0x1;
+    config_file_search_with_string ("weechat.zzz.chat_channel",
+                                    &ptr_config, &ptr_section,
+                                    &ptr_option, &pos_option_name);
+    POINTERS_EQUAL(weechat_config_file, ptr_config);
+    POINTERS_EQUAL(NULL, ptr_section);
+    POINTERS_EQUAL(NULL, ptr_option);
+    STRCMP_EQUAL("chat_channel", pos_option_name);
+}
+
+/*
+ * Tests functions:
+ *   config_file_get_options_sorted
+ */
+
+TEST(CoreConfigFile, GetOptionsSorted)
+{
+    struct t_config_option *ptr_option;
+    const char **options_sorted;
+    int i, count, found;
+
+    count = -1;
+    options_sorted = config_file_get_options_sorted (&count);
+    CHECK(options_sorted);
+    CHECK(count > 0);
+    LONGS_EQUAL(config_file_options_index->items_count, count);
+    for (i = 1; i < count; i++)
+    {
+        CHECK(string_strcasecmp (options_sorted[i - 1],
+                                 options_sorted[i]) <= 0);
+    }
+
+    /* new option: array is built again */
+    ptr_option = config_file_new_option (
+        weechat_config_file, weechat_config_section_color,
+        "aaa_test", "integer", "", NULL, 0, 100, "1", NULL, 0,
+        NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+    CHECK(ptr_option);
+    options_sorted = config_file_get_options_sorted (&i);
+    LONGS_EQUAL(count + 1, i);
+    found = 0;
+    for (i = 0; i < count + 1; i++)
+    {
+        if (strcmp (options_sorted[i], "weechat.color.aaa_test") == 0)
+            found++;
+        if (i > 0)
+        {
+            CHECK(string_strcasecmp (options_sorted[i - 1],
+                                     options_sorted[i]) <= 0);
+        }
+    }
+    LONGS_EQUAL(1, found);
+
+    config_file_option_free (ptr_option, 0);
+    options_sorted = config_file_get_options_sorted (&i);
+    LONGS_EQUAL(count, i);
 }
 
 /*
@@ -1100,7 +1231,52 @@ TEST(CoreConfigFile, OptionUnset)
 
 TEST(CoreConfigFile, OptionRename)
 {
-    /* TODO: write tests */
+    struct t_config_option *ptr_option, *ptr_option_found;
+
+    ptr_option = config_file_new_option (
+        weechat_config_file, weechat_config_section_look,
+        "test_rename", "integer", "", NULL, 0, 100, "50", NULL, 0,
+        NULL, NULL, NULL,
+        NULL, NULL, NULL,
+        NULL, NULL, NULL);
+    CHECK(ptr_option);
+    POINTERS_EQUAL(ptr_option,
+                   hashtable_get (weechat_config_section_look->options_hash,
+                                  "test_rename"));
+    POINTERS_EQUAL(ptr_option,
+                   hashtable_get (config_file_options_index,
+                                  "weechat.look.test_rename"));
+
+    /* rename to an existing option: not allowed */
+    config_file_option_rename (ptr_option, "day_change");
+    STRCMP_EQUAL("test_rename", ptr_option->name);
+
+    config_file_option_rename (ptr_option, "test_rename2");
+    STRCMP_EQUAL("test_rename2", ptr_option->name);
+    POINTERS_EQUAL(NULL,
+                   hashtable_get (weechat_config_section_look->options_hash,
+                                  "test_rename"));
+    POINTERS_EQUAL(NULL,
+                   hashtable_get (config_file_options_index,
+                                  "weechat.look.test_rename"));
+    POINTERS_EQUAL(ptr_option,
+                   config_file_search_option (weechat_config_file,
+                                              weechat_config_section_look,
+                                              "test_rename2"));
+    config_file_search_with_string ("weechat.look.test_rename", NULL, NULL,
+                                    &ptr_option_found, NULL);
+    POINTERS_EQUAL(NULL, ptr_option_found);
+    config_file_search_with_string ("weechat.look.test_rename2", NULL, NULL,
+                                    &ptr_option_found, NULL);
+    POINTERS_EQUAL(ptr_option, ptr_option_found);
+
+    config_file_option_free (ptr_option, 0);
+    POINTERS_EQUAL(NULL,
+                   hashtable_get (weechat_config_section_look->options_hash,
+                                  "test_rename2"));
+    POINTERS_EQUAL(NULL,
+                   hashtable_get (config_file_options_index,
+                                  "weechat.look.test_rename2"));
 }
 
 /*
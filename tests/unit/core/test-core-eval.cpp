@@ -31,6 +31,8 @@ extern "C"
 #include "src/core/core-config.h"
 #include "src/core/core-config-file.h"
 #include "src/core/core-hashtable.h"
+#include "src/core/core-hdata.h"
+#include "src/core/core-hook.h"
 #include "src/core/core-secure.h"
 #include "src/core/core-string.h"
 #include "src/core/core-version.h"
@@ -445,6 +447,229 @@ TEST(CoreEval, EvalCondition)
     hashtable_free (options);
 }
 
+/*
+ * Tests functions:
+ *   eval_compiled_get
+ *   eval_compile_condition
+ *   eval_node_evaluate
+ *   eval_end
+ */
+
+TEST(CoreEval, EvalConditionCompiled)
+{
+    struct t_hashtable *extra_vars, *options;
+    struct t_eval_compiled *ptr_compiled, *ptr_compiled2;
+    char *value, str_expr[64];
+    int i, count;
+
+    extra_vars = hashtable_new (32,
+                                WEECHAT_HASHTABLE_STRING,
+                                WEECHAT_HASHTABLE_STRING,
+                                NULL, NULL);
+    CHECK(extra_vars);
+
+    options = hashtable_new (32,
+                             WEECHAT_HASHTABLE_STRING,
+                             WEECHAT_HASHTABLE_STRING,
+                             NULL, NULL);
+    CHECK(options);
+    hashtable_set (options, "type", "condition");
+
+    eval_end ();
+    LONGS_EQUAL(0, eval_compiled_count);
+    POINTERS_EQUAL(NULL, eval_compiled_list);
+    POINTERS_EQUAL(NULL, last_eval_compiled);
+
+    /* same expression evaluated with different variables */
+    hashtable_set (extra_vars, "nick", "alice");
+    value = eval_expression ("${nick} =~ ^ali && (${nick} != bob)",
+                             NULL, extra_vars, options);
+    STRCMP_EQUAL("1", value);
+    free (value);
+    LONGS_EQUAL(1, eval_compiled_count);
+    ptr_compiled = eval_compiled_list;
+    CHECK(ptr_compiled);
+    STRCMP_EQUAL("${nick} =~ ^ali && (${nick} != bob)", ptr_compiled->expr);
+    LONGS_EQUAL(EVAL_NODE_LOGICAL_OP, ptr_compiled->node->type);
+    LONGS_EQUAL(EVAL_LOGICAL_OP_AND, ptr_compiled->node->op);
+    LONGS_EQUAL(EVAL_NODE_COMPARISON, ptr_compiled->node->left->type);
+    CHECK(ptr_compiled->node->left->regex);
+    LONGS_EQUAL(EVAL_NODE_PARENTHESES, ptr_compiled->node->right->type);
+    LONGS_EQUAL(0, ptr_compiled->used);
+    hashtable_set (extra_vars, "nick", "bob");
+    value = eval_expression ("${nick} =~ ^ali && (${nick} != bob)",
+                             NULL, extra_vars, options);
+    STRCMP_EQUAL("0", value);
+    free (value);
+    hashtable_set (extra_vars, "nick", "alicia");
+    value = eval_expression ("${nick} =~ ^ali && (${nick} != bob)",
+                             NULL, extra_vars, options);
+    STRCMP_EQUAL("1", value);
+    free (value);
+    LONGS_EQUAL(1, eval_compiled_count);
+    POINTERS_EQUAL(ptr_compiled, eval_compiled_list);
+
+    /* expression with a value after parentheses: not compiled */
+    value = eval_expression ("(1) == 1", NULL, extra_vars, options);
+    STRCMP_EQUAL("1", value);
+    free (value);
+    value = eval_expression ("(1) 2", NULL, extra_vars, options);
+    STRCMP_EQUAL("1", value);
+    free (value);
+    ptr_compiled2 = (struct t_eval_compiled *)hashtable_get (eval_compiled,
+                                                             "(1) 2");
+    CHECK(ptr_compiled2);
+    LONGS_EQUAL(EVAL_NODE_EXPRESSION, ptr_compiled2->node->type);
+
+    /* expression used again is moved at the beginning of list */
+    value = eval_expression ("${nick} =~ ^ali && (${nick} != bob)",
+                             NULL, extra_vars, options);
+    free (value);
+    POINTERS_EQUAL(ptr_compiled, eval_compiled_list);
+
+    /* conditions with debug are not compiled */
+    count = eval_compiled_count;
+    hashtable_set (options, "debug", "1");
+    value = eval_expression ("abc < def", NULL, extra_vars, options);
+    STRCMP_EQUAL("1", value);
+    free (value);
+    hashtable_remove (options, "debug");
+    hashtable_remove (options, "debug_output");
+    LONGS_EQUAL(count, eval_compiled_count);
+
+    /* cache is limited to EVAL_COMPILED_MAX expressions */
+    for (i = 0; i < EVAL_COMPILED_MAX + 10; i++)
+    {
+        snprintf (str_expr, sizeof (str_expr), "%d == %d", i, i);
+        value = eval_expression (str_expr, NULL, extra_vars, options);
+        STRCMP_EQUAL("1", value);
+        free (value);
+    }
+    LONGS_EQUAL(EVAL_COMPILED_MAX, eval_compiled_count);
+    STRCMP_EQUAL("521 == 521", eval_compiled_list->expr);
+    STRCMP_EQUAL("10 == 10", last_eval_compiled->expr);
+
+    eval_end ();
+    LONGS_EQUAL(0, eval_compiled_count);
+    POINTERS_EQUAL(NULL, eval_compiled_list);
+    POINTERS_EQUAL(NULL, last_eval_compiled);
+
+    hashtable_free (extra_vars);
+    hashtable_free (options);
+}
+
+/*
+ * Tests functions:
+ *   eval_cond_init_fast
+ *   eval_cond_new
+ *   eval_cond_fast
+ *   eval_cond_is_true
+ *   eval_cond_free
+ */
+
+TEST(CoreEval, EvalCond)
+{
+    struct t_hashtable *options;
+    struct t_hdata *hdata;
+    struct t_eval_cond *cond;
+
+    hdata = hook_hdata_get (NULL, "buffer");
+    CHECK(hdata);
+
+    POINTERS_EQUAL(NULL, eval_cond_new (NULL, NULL, NULL, NULL, NULL));
+
+    /* condition without hdata */
+    cond = eval_cond_new ("1 == 1", NULL, NULL, NULL, NULL);
+    CHECK(cond);
+    CHECK(cond->compiled);
+    POINTERS_EQUAL(NULL, cond->fast_name);
+    LONGS_EQUAL(1, eval_cond_is_true (cond, NULL));
+    eval_cond_free (cond);
+
+    /* fast path with a string comparison */
+    cond = eval_cond_new ("${buffer.full_name} == core.weechat",
+                          NULL, NULL, NULL, hdata);
+    CHECK(cond);
+    STRCMP_EQUAL("buffer.full_name", cond->fast_name);
+    LONGS_EQUAL(1, cond->fast_strcmp);
+    LONGS_EQUAL(1, eval_cond_is_true (cond, gui_buffers));
+    eval_cond_free (cond);
+    cond = eval_cond_new ("${buffer.full_name} != core.weechat",
+                          NULL, NULL, NULL, hdata);
+    CHECK(cond);
+    STRCMP_EQUAL("buffer.full_name", cond->fast_name);
+    LONGS_EQUAL(0, eval_cond_is_true (cond, gui_buffers));
+    eval_cond_free (cond);
+    cond = eval_cond_new ("${buffer.full_name} =~ ^core\\.",
+                          NULL, NULL, NULL, hdata);
+    CHECK(cond);
+    STRCMP_EQUAL("buffer.full_name", cond->fast_name);
+    LONGS_EQUAL(0, cond->fast_strcmp);
+    LONGS_EQUAL(1, eval_cond_is_true (cond, gui_buffers));
+    eval_cond_free (cond);
+
+    /* local variable with the same name: no fast path */
+    gui_buffer_local_var_add (gui_buffers, "buffer.full_name", "test");
+    cond = eval_cond_new ("${buffer.full_name} == core.weechat",
+                          NULL, NULL, NULL, hdata);
+    CHECK(cond);
+    LONGS_EQUAL(0, eval_cond_is_true (cond, gui_buffers));
+    eval_cond_free (cond);
+    gui_buffer_local_var_remove (gui_buffers, "buffer.full_name");
+
+    /* fast path with a number */
+    cond = eval_cond_new ("${buffer.number} >= 1", NULL, NULL, NULL, hdata);
+    CHECK(cond);
+    STRCMP_EQUAL("buffer.number", cond->fast_name);
+    LONGS_EQUAL(0, cond->fast_strcmp);
+    LONGS_EQUAL(1, eval_cond_is_true (cond, gui_buffers));
+    eval_cond_free (cond);
+    cond = eval_cond_new ("${buffer.number} == 01", NULL, NULL, NULL, hdata);
+    CHECK(cond);
+    LONGS_EQUAL(0, cond->fast_strcmp);
+    LONGS_EQUAL(1, eval_cond_is_true (cond, gui_buffers));
+    eval_cond_free (cond);
+
+    /* no fast path */
+    cond = eval_cond_new ("${buffer.full_name} == core.weechat && 1",
+                          NULL, NULL, NULL, hdata);
+    CHECK(cond);
+    CHECK(cond->compiled);
+    POINTERS_EQUAL(NULL, cond->fast_name);
+    LONGS_EQUAL(1, eval_cond_is_true (cond, gui_buffers));
+    eval_cond_free (cond);
+    cond = eval_cond_new ("${buffer.local_variables.name} == weechat",
+                          NULL, NULL, NULL, hdata);
+    CHECK(cond);
+    POINTERS_EQUAL(NULL, cond->fast_name);
+    LONGS_EQUAL(1, eval_cond_is_true (cond, gui_buffers));
+    eval_cond_free (cond);
+
+    /* user variables are reset before each evaluation */
+    cond = eval_cond_new ("${define:x,${buffer.number}}${x} == 1",
+                          NULL, NULL, NULL, hdata);
+    CHECK(cond);
+    LONGS_EQUAL(1, eval_cond_is_true (cond, gui_buffers));
+    LONGS_EQUAL(1, eval_cond_is_true (cond, gui_buffers));
+    eval_cond_free (cond);
+
+    /* debug: evaluated with eval_expression each time */
+    options = hashtable_new (32,
+                             WEECHAT_HASHTABLE_STRING,
+                             WEECHAT_HASHTABLE_STRING,
+                             NULL, NULL);
+    CHECK(options);
+    hashtable_set (options, "debug", "1");
+    cond = eval_cond_new ("${buffer.full_name} == core.weechat",
+                          NULL, NULL, options, hdata);
+    CHECK(cond);
+    POINTERS_EQUAL(NULL, cond->compiled);
+    POINTERS_EQUAL(NULL, cond->fast_name);
+    LONGS_EQUAL(1, eval_cond_is_true (cond, gui_buffers));
+    eval_cond_free (cond);
+    hashtable_free (options);
+}
+
 /*
  * Tests functions:
  *   eval_expression (expression)
@@ -557,6 +557,117 @@ TEST(CoreHashtable, SetGetRemove)
     hashtable_free (hashtable);
 }
 
+/*
+ * Tests functions:
+ *   hashtable_get_list
+ *   hashtable_list_insert
+ *   hashtable_rehash
+ *   hashtable_resize
+ */
+
+TEST(CoreHashtable, Resize)
+{
+    struct t_hashtable *hashtable;
+    struct t_hashtable_item *ptr_item;
+    char str_key[64], str_value[64];
+    int i, count;
+
+    hashtable = hashtable_new (4,
+                               WEECHAT_HASHTABLE_STRING,
+                               WEECHAT_HASHTABLE_STRING,
+                               NULL,
+                               NULL);
+    CHECK(hashtable);
+    LONGS_EQUAL(1, hashtable->auto_resize);
+    LONGS_EQUAL(4, hashtable->size);
+    POINTERS_EQUAL(NULL, hashtable->htable_old);
+
+    /* no resize up to 8 items (size * HASHTABLE_RESIZE_LOAD) */
+    for (i = 0; i < 8; i++)
+    {
+        snprintf (str_key, sizeof (str_key), "key%d", i);
+        snprintf (str_value, sizeof (str_value), "value%d", i);
+        hashtable_set (hashtable, str_key, str_value);
+    }
+    LONGS_EQUAL(4, hashtable->size);
+    POINTERS_EQUAL(NULL, hashtable->htable_old);
+
+    /* resize starts with the 9th item */
+    hashtable_set (hashtable, "key8", "value8");
+    LONGS_EQUAL(8, hashtable->size);
+    CHECK(hashtable->htable_old);
+    LONGS_EQUAL(4, hashtable->size_old);
+    LONGS_EQUAL(0, hashtable->rehash_index);
+    STRCMP_EQUAL("value0", (const char *)hashtable_get (hashtable, "key0"));
+    STRCMP_EQUAL("value8", (const char *)hashtable_get (hashtable, "key8"));
+
+    /* two lists moved on each change */
+    hashtable_remove (hashtable, "key8");
+    LONGS_EQUAL(2, hashtable->rehash_index);
+    hashtable_set (hashtable, "key8", "value8");
+    POINTERS_EQUAL(NULL, hashtable->htable_old);
+    LONGS_EQUAL(0, hashtable->size_old);
+    LONGS_EQUAL(0, hashtable->rehash_index);
+
+    /* add many items, check they are all found, in order of creation */
+    for (i = 9; i < 10000; i++)
+    {
+        snprintf (str_key, sizeof (str_key), "key%d", i);
+        snprintf (str_value, sizeof (str_value), "value%d", i);
+        hashtable_set (hashtable, str_key, str_value);
+    }
+    LONGS_EQUAL(10000, hashtable->items_count);
+    CHECK(hashtable->size >= 10000 / HASHTABLE_RESIZE_LOAD);
+    for (i = 0; i < 10000; i++)
+    {
+        snprintf (str_key, sizeof (str_key), "key%d", i);
+        snprintf (str_value, sizeof (str_value), "value%d", i);
+        STRCMP_EQUAL(str_value, (const char *)hashtable_get (hashtable, str_key));
+    }
+    count = 0;
+    for (ptr_item = hashtable->oldest_item; ptr_item;
+         ptr_item = ptr_item->next_created_item)
+    {
+        snprintf (str_key, sizeof (str_key), "key%d", count);
+        STRCMP_EQUAL(str_key, (const char *)ptr_item->key);
+        count++;
+    }
+    LONGS_EQUAL(10000, count);
+
+    /* remove items */
+    for (i = 0; i < 10000; i += 2)
+    {
+        snprintf (str_key, sizeof (str_key), "key%d", i);
+        hashtable_remove (hashtable, str_key);
+    }
+    LONGS_EQUAL(5000, hashtable->items_count);
+    POINTERS_EQUAL(NULL, hashtable_get (hashtable, "key0"));
+    STRCMP_EQUAL("value1", (const char *)hashtable_get (hashtable, "key1"));
+
+    hashtable_remove_all (hashtable);
+    LONGS_EQUAL(0, hashtable->items_count);
+    POINTERS_EQUAL(NULL, hashtable->htable_old);
+
+    hashtable_free (hashtable);
+
+    /* hashtable without auto resize */
+    hashtable = hashtable_new (4,
+                               WEECHAT_HASHTABLE_STRING,
+                               WEECHAT_HASHTABLE_STRING,
+                               NULL,
+                               NULL);
+    CHECK(hashtable);
+    hashtable->auto_resize = 0;
+    for (i = 0; i < 100; i++)
+    {
+        snprintf (str_key, sizeof (str_key), "key%d", i);
+        hashtable_set (hashtable, str_key, NULL);
+    }
+    LONGS_EQUAL(4, hashtable->size);
+    POINTERS_EQUAL(NULL, hashtable->htable_old);
+    hashtable_free (hashtable);
+}
+
 void
 test_hashtable_map_string_cb (void *data,
                               struct t_hashtable *hashtable,
@@ -264,6 +264,7 @@ TEST(CoreHdata, NewVar)
 
 /*
  * Tests functions:
+ *   hdata_new_list_pointers
  *   hdata_new_list
  */
 
@@ -290,6 +291,7 @@ TEST(CoreHdata, NewList)
     CHECK(list);
     POINTERS_EQUAL(0x123, list->pointer);
     LONGS_EQUAL(0, list->flags);
+    POINTERS_EQUAL(NULL, list->pointers);
 
     hdata_new_list (hdata, "list2", (void *)0x456,
                     WEECHAT_HDATA_LIST_CHECK_POINTERS);
@@ -298,6 +300,17 @@ TEST(CoreHdata, NewList)
     CHECK(list);
     POINTERS_EQUAL(0x456, list->pointer);
     LONGS_EQUAL(WEECHAT_HDATA_LIST_CHECK_POINTERS, list->flags);
+    POINTERS_EQUAL(NULL, list->pointers);
+
+    hdata_new_list_pointers (hdata, "list3", (void *)0x789,
+                             WEECHAT_HDATA_LIST_CHECK_POINTERS,
+                             (struct t_hashtable **)0xabc);
+    LONGS_EQUAL(3, hdata->hash_list->items_count);
+    list = (struct t_hdata_list *)hashtable_get (hdata->hash_list, "list3");
+    CHECK(list);
+    POINTERS_EQUAL(0x789, list->pointer);
+    LONGS_EQUAL(WEECHAT_HDATA_LIST_CHECK_POINTERS, list->flags);
+    POINTERS_EQUAL(0xabc, list->pointers);
 
     hashtable_remove (weechat_hdata, "test_hdata");
 }
@@ -1302,6 +1315,188 @@ TEST(CoreHdataWithList, GetVarAtOffset)
                        offsetof (struct t_test_item, test_string)));
 }
 
+/*
+ * Tests functions:
+ *   hdata_path_new
+ *   hdata_path_get_var
+ *   hdata_path_free
+ */
+
+TEST(CoreHdataWithList, Path)
+{
+    struct t_hdata_path *path;
+
+    POINTERS_EQUAL(NULL, hdata_path_new (NULL, NULL));
+    POINTERS_EQUAL(NULL, hdata_path_new (ptr_hdata, NULL));
+    POINTERS_EQUAL(NULL, hdata_path_new (NULL, "test_char"));
+    POINTERS_EQUAL(NULL, hdata_path_new (ptr_hdata, ""));
+    POINTERS_EQUAL(NULL, hdata_path_new (ptr_hdata, "zzz"));
+    POINTERS_EQUAL(NULL, hdata_path_new (ptr_hdata, "next_item.zzz"));
+    POINTERS_EQUAL(NULL, hdata_path_new (ptr_hdata, "test_int.test_char"));
+    POINTERS_EQUAL(NULL, hdata_path_new (ptr_hdata, "test_pointer.test_char"));
+
+    POINTERS_EQUAL(NULL, hdata_path_get_var (NULL, NULL));
+    POINTERS_EQUAL(NULL, hdata_path_get_var (NULL, ptr_item1));
+    hdata_path_free (NULL);
+
+    /* variable in object */
+    path = hdata_path_new (ptr_hdata, "test_int");
+    CHECK(path);
+    POINTERS_EQUAL(ptr_hdata, path->hdata);
+    LONGS_EQUAL(1, path->num_steps);
+    POINTERS_EQUAL(NULL, hdata_path_get_var (path, NULL));
+    POINTERS_EQUAL(&(ptr_item1->test_int),
+                   hdata_path_get_var (path, ptr_item1));
+    POINTERS_EQUAL(&(ptr_item2->test_int),
+                   hdata_path_get_var (path, ptr_item2));
+    hdata_path_free (path);
+
+    /* variable in next object */
+    path = hdata_path_new (ptr_hdata, "next_item.test_string");
+    CHECK(path);
+    LONGS_EQUAL(2, path->num_steps);
+    POINTERS_EQUAL(&(ptr_item2->test_string),
+                   hdata_path_get_var (path, ptr_item1));
+    POINTERS_EQUAL(NULL, hdata_path_get_var (path, ptr_item2));
+    hdata_path_free (path);
+
+    path = hdata_path_new (ptr_hdata, "next_item.prev_item.test_int");
+    CHECK(path);
+    LONGS_EQUAL(3, path->num_steps);
+    POINTERS_EQUAL(&(ptr_item1->test_int),
+                   hdata_path_get_var (path, ptr_item1));
+    hdata_path_free (path);
+
+    /* index in arrays */
+    path = hdata_path_new (ptr_hdata, "1|test_array_2_int_fixed_size");
+    CHECK(path);
+    POINTERS_EQUAL(&(ptr_item1->test_array_2_int_fixed_size[1]),
+                   hdata_path_get_var (path, ptr_item1));
+    hdata_path_free (path);
+
+    path = hdata_path_new (ptr_hdata, "2|test_ptr_3_int");
+    CHECK(path);
+    POINTERS_EQUAL(&(ptr_item1->test_ptr_3_int[2]),
+                   hdata_path_get_var (path, ptr_item1));
+    hdata_path_free (path);
+
+    path = hdata_path_new (ptr_hdata, "next_item.1|test_ptr_words_dyn");
+    CHECK(path);
+    POINTERS_EQUAL(&(ptr_item2->test_ptr_words_dyn[1]),
+                   hdata_path_get_var (path, ptr_item1));
+    hdata_path_free (path);
+
+    /* we can not index a static array of strings */
+    path = hdata_path_new (ptr_hdata, "1|test_array_2_words_fixed_size");
+    CHECK(path);
+    POINTERS_EQUAL(NULL, hdata_path_get_var (path, ptr_item1));
+    hdata_path_free (path);
+}
+
+/*
+ * Tests functions:
+ *   hdata_var_content_to_string
+ *   hdata_get_fields
+ */
+
+TEST(CoreHdataWithList, GetFields)
+{
+    struct t_hashtable *hashtable;
+    char str_pointer[64];
+
+    POINTERS_EQUAL(NULL, hdata_get_fields (NULL, NULL, 0, NULL));
+    POINTERS_EQUAL(NULL, hdata_get_fields (ptr_hdata, ptr_item1, 0, NULL));
+    POINTERS_EQUAL(NULL, hdata_get_fields (ptr_hdata, ptr_item1, 0, ""));
+    POINTERS_EQUAL(NULL, hdata_get_fields (ptr_hdata, ptr_item1, 0, "zzz"));
+    POINTERS_EQUAL(NULL,
+                   hdata_get_fields (ptr_hdata, ptr_item1, 0,
+                                     "test_int,zzz"));
+
+    /* no object */
+    hashtable = hdata_get_fields (ptr_hdata, NULL, 0, "test_int");
+    CHECK(hashtable);
+    LONGS_EQUAL(2, hashtable->items_count);
+    STRCMP_EQUAL("0", (const char *)hashtable_get (hashtable, "count"));
+    STRCMP_EQUAL("", (const char *)hashtable_get (hashtable, "next"));
+    hashtable_free (hashtable);
+
+    /* all objects until the end of list */
+    hashtable = hdata_get_fields (
+        ptr_hdata, ptr_item1, 0,
+        "test_char,test_int,test_long,test_longlong,test_string,"
+        "test_string_null,test_shared_string,test_pointer,test_time,"
+        "next_item.test_string,1|test_ptr_3_int");
+    CHECK(hashtable);
+    LONGS_EQUAL(2 + (2 * 12), hashtable->items_count);
+    STRCMP_EQUAL("2", (const char *)hashtable_get (hashtable, "count"));
+    STRCMP_EQUAL("", (const char *)hashtable_get (hashtable, "next"));
+    snprintf (str_pointer, sizeof (str_pointer),
+              "0x%lx", (unsigned long)ptr_item1);
+    STRCMP_EQUAL(str_pointer,
+                 (const char *)hashtable_get (hashtable, "0.pointer"));
+    STRCMP_EQUAL("A", (const char *)hashtable_get (hashtable, "0.test_char"));
+    STRCMP_EQUAL("123", (const char *)hashtable_get (hashtable, "0.test_int"));
+    STRCMP_EQUAL("123456789",
+                 (const char *)hashtable_get (hashtable, "0.test_long"));
+    STRCMP_EQUAL("123456789123456",
+                 (const char *)hashtable_get (hashtable, "0.test_longlong"));
+    STRCMP_EQUAL("item1",
+                 (const char *)hashtable_get (hashtable, "0.test_string"));
+    STRCMP_EQUAL("",
+                 (const char *)hashtable_get (hashtable,
+                                              "0.test_string_null"));
+    STRCMP_EQUAL("item1_shared",
+                 (const char *)hashtable_get (hashtable,
+                                              "0.test_shared_string"));
+    STRCMP_EQUAL("0x123",
+                 (const char *)hashtable_get (hashtable, "0.test_pointer"));
+    STRCMP_EQUAL("123456",
+                 (const char *)hashtable_get (hashtable, "0.test_time"));
+    STRCMP_EQUAL("item2",
+                 (const char *)hashtable_get (hashtable,
+                                              "0.next_item.test_string"));
+    STRCMP_EQUAL("2",
+                 (const char *)hashtable_get (hashtable, "0.1|test_ptr_3_int"));
+    snprintf (str_pointer, sizeof (str_pointer),
+              "0x%lx", (unsigned long)ptr_item2);
+    STRCMP_EQUAL(str_pointer,
+                 (const char *)hashtable_get (hashtable, "1.pointer"));
+    STRCMP_EQUAL("456", (const char *)hashtable_get (hashtable, "1.test_int"));
+    STRCMP_EQUAL("item2",
+                 (const char *)hashtable_get (hashtable, "1.test_string"));
+    STRCMP_EQUAL("",
+                 (const char *)hashtable_get (hashtable,
+                                              "1.next_item.test_string"));
+    STRCMP_EQUAL("5",
+                 (const char *)hashtable_get (hashtable, "1.1|test_ptr_3_int"));
+    hashtable_free (hashtable);
+
+    /* one object, then move to next one */
+    hashtable = hdata_get_fields (ptr_hdata, ptr_item1, 1,
+                                  ",test_int,,test_string,");
+    CHECK(hashtable);
+    LONGS_EQUAL(5, hashtable->items_count);
+    STRCMP_EQUAL("1", (const char *)hashtable_get (hashtable, "count"));
+    snprintf (str_pointer, sizeof (str_pointer),
+              "0x%lx", (unsigned long)ptr_item2);
+    STRCMP_EQUAL(str_pointer,
+                 (const char *)hashtable_get (hashtable, "next"));
+    STRCMP_EQUAL("123", (const char *)hashtable_get (hashtable, "0.test_int"));
+    STRCMP_EQUAL("item1",
+                 (const char *)hashtable_get (hashtable, "0.test_string"));
+    hashtable_free (hashtable);
+
+    /* move to previous objects */
+    hashtable = hdata_get_fields (ptr_hdata, ptr_item2, -5, "test_int");
+    CHECK(hashtable);
+    LONGS_EQUAL(6, hashtable->items_count);
+    STRCMP_EQUAL("2", (const char *)hashtable_get (hashtable, "count"));
+    STRCMP_EQUAL("", (const char *)hashtable_get (hashtable, "next"));
+    STRCMP_EQUAL("456", (const char *)hashtable_get (hashtable, "0.test_int"));
+    STRCMP_EQUAL("123", (const char *)hashtable_get (hashtable, "1.test_int"));
+    hashtable_free (hashtable);
+}
+
 /*
  * Tests functions:
  *   hdata_get_list
@@ -1340,6 +1535,49 @@ TEST(CoreHdataWithList, Check)
     LONGS_EQUAL(1, hdata_check_pointer (ptr_hdata, items, ptr_item2));
 }
 
+/*
+ * Tests functions:
+ *   hdata_check_pointer (list with a hashtable of pointers)
+ */
+
+TEST(CoreHdataWithList, CheckWithHashtable)
+{
+    struct t_hdata_list *ptr_list;
+    struct t_hashtable *pointers;
+
+    ptr_list = (struct t_hdata_list *)hashtable_get (ptr_hdata->hash_list,
+                                                     "items");
+    CHECK(ptr_list);
+
+    pointers = NULL;
+    ptr_list->pointers = &pointers;
+
+    /* no hashtable: the list is walked */
+    LONGS_EQUAL(1, hdata_check_pointer (ptr_hdata, NULL, ptr_item1));
+    LONGS_EQUAL(1, hdata_check_pointer (ptr_hdata, NULL, ptr_item2));
+    LONGS_EQUAL(1, hdata_check_pointer (ptr_hdata, items, ptr_item2));
+    LONGS_EQUAL(0, hdata_check_pointer (ptr_hdata, NULL, (void *)0x1));
+
+    /* hashtable with only first item: the list is not walked */
+    pointers = hashtable_new (32,
+                              WEECHAT_HASHTABLE_POINTER,
+                              WEECHAT_HASHTABLE_POINTER,
+                              NULL, NULL);
+    CHECK(pointers);
+    hashtable_set (pointers, ptr_item1, NULL);
+    LONGS_EQUAL(1, hdata_check_pointer (ptr_hdata, NULL, ptr_item1));
+    LONGS_EQUAL(0, hdata_check_pointer (ptr_hdata, NULL, ptr_item2));
+    LONGS_EQUAL(1, hdata_check_pointer (ptr_hdata, items, ptr_item1));
+    LONGS_EQUAL(0, hdata_check_pointer (ptr_hdata, items, ptr_item2));
+    LONGS_EQUAL(0, hdata_check_pointer (ptr_hdata, NULL, (void *)0x1));
+
+    /* list without hashtable: walked */
+    LONGS_EQUAL(1, hdata_check_pointer (ptr_hdata, last_item, ptr_item2));
+
+    hashtable_free (pointers);
+    ptr_list->pointers = NULL;
+}
+
 /*
  * Tests functions:
  *   hdata_move
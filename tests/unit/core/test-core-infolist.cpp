@@ -24,6 +24,7 @@
 
 extern "C"
 {
+#include "src/core/core-hashtable.h"
 #include "src/core/core-hook.h"
 #include "src/core/core-infolist.h"
 }
@@ -129,6 +130,7 @@ TEST(CoreInfolist, New)
     POINTERS_EQUAL(NULL, infolist->items);
     POINTERS_EQUAL(NULL, infolist->last_item);
     POINTERS_EQUAL(NULL, infolist->ptr_item);
+    POINTERS_EQUAL(NULL, infolist->names);
 
     /* check that the infolist is the last one in list */
     POINTERS_EQUAL(last_weechat_infolist, infolist);
@@ -138,8 +140,10 @@ TEST(CoreInfolist, New)
     CHECK(item);
 
     /* check initial item values */
+    POINTERS_EQUAL(infolist, item->infolist);
     POINTERS_EQUAL(NULL, item->vars);
     POINTERS_EQUAL(NULL, item->last_var);
+    POINTERS_EQUAL(NULL, item->hint_var);
     POINTERS_EQUAL(NULL, item->fields);
     POINTERS_EQUAL(NULL, item->prev_item);
     POINTERS_EQUAL(NULL, item->next_item);
@@ -156,6 +160,7 @@ TEST(CoreInfolist, New)
     STRCMP_EQUAL("test_integer", var_int->name);
     LONGS_EQUAL(INFOLIST_INTEGER, var_int->type);
     LONGS_EQUAL(123456, *((int *)var_int->value));
+    POINTERS_EQUAL(&(var_int->scalar.integer), var_int->value);
     LONGS_EQUAL(0, var_int->size);
     POINTERS_EQUAL(NULL, var_int->prev_var);
     POINTERS_EQUAL(NULL, var_int->next_var);
@@ -223,6 +228,7 @@ TEST(CoreInfolist, New)
     STRCMP_EQUAL("test_time", var_time->name);
     LONGS_EQUAL(INFOLIST_TIME, var_time->type);
     LONGS_EQUAL(1234567890, *((time_t *)var_time->value));
+    POINTERS_EQUAL(&(var_time->scalar.time), var_time->value);
     LONGS_EQUAL(0, var_time->size);
     POINTERS_EQUAL(var_buf, var_time->prev_var);
     POINTERS_EQUAL(NULL, var_time->next_var);
@@ -302,6 +308,72 @@ TEST(CoreInfolist, Search)
     infolist_free (infolist);
 }
 
+/*
+ * Tests functions:
+ *   infolist_get_shared_name
+ *   infolist_var_new
+ */
+
+TEST(CoreInfolist, SharedNames)
+{
+    struct t_infolist *infolist;
+    struct t_infolist_item *item1, *item2, *item3;
+    struct t_infolist_var *var1_a, *var1_b, *var2_a, *var2_b, *var3_c, *var3_a;
+    char name[32];
+
+    infolist = infolist_new (NULL);
+    CHECK(infolist);
+
+    POINTERS_EQUAL(NULL, infolist_get_shared_name (infolist, "a", 0));
+    POINTERS_EQUAL(NULL, infolist->names);
+
+    item1 = infolist_new_item (infolist);
+    var1_a = infolist_new_var_integer (item1, "a", 1);
+    var1_b = infolist_new_var_string (item1, "b", "value_b");
+    CHECK(infolist->names);
+    LONGS_EQUAL(2, infolist->names->items_count);
+    POINTERS_EQUAL(var1_a->name, infolist_get_shared_name (infolist, "a", 0));
+    POINTERS_EQUAL(var1_b->name, infolist_get_shared_name (infolist, "b", 0));
+    POINTERS_EQUAL(NULL, infolist_get_shared_name (infolist, "c", 0));
+
+    /* same variables in same order: names are shared */
+    item2 = infolist_new_item (infolist);
+    POINTERS_EQUAL(var1_a, item2->hint_var);
+    snprintf (name, sizeof (name), "%s", "a");
+    var2_a = infolist_new_var_integer (item2, name, 2);
+    POINTERS_EQUAL(var1_b, item2->hint_var);
+    snprintf (name, sizeof (name), "%s", "b");
+    var2_b = infolist_new_var_string (item2, name, "value_b2");
+    POINTERS_EQUAL(NULL, item2->hint_var);
+    POINTERS_EQUAL(var1_a->name, var2_a->name);
+    POINTERS_EQUAL(var1_b->name, var2_b->name);
+    LONGS_EQUAL(2, infolist->names->items_count);
+
+    /* other order and new variable: names are still shared */
+    item3 = infolist_new_item (infolist);
+    var3_c = infolist_new_var_time (item3, "c", 3);
+    var3_a = infolist_new_var_integer (item3, "a", 3);
+    STRCMP_EQUAL("c", var3_c->name);
+    POINTERS_EQUAL(var1_a->name, var3_a->name);
+    LONGS_EQUAL(3, infolist->names->items_count);
+
+    /* search variables in items */
+    infolist_next (infolist);
+    LONGS_EQUAL(1, infolist_integer (infolist, "a"));
+    STRCMP_EQUAL("value_b", infolist_string (infolist, "b"));
+    POINTERS_EQUAL(NULL, infolist_search_var (infolist, "c"));
+    infolist_next (infolist);
+    LONGS_EQUAL(2, infolist_integer (infolist, "a"));
+    STRCMP_EQUAL("value_b2", infolist_string (infolist, "b"));
+    infolist_next (infolist);
+    LONGS_EQUAL(3, infolist_integer (infolist, "a"));
+    POINTERS_EQUAL(NULL, infolist_search_var (infolist, "b"));
+    LONGS_EQUAL(3, infolist_time (infolist, "c"));
+    STRCMP_EQUAL("t:c,i:a", infolist_fields (infolist));
+
+    infolist_free (infolist);
+}
+
 /*
  * Tests functions:
  *   infolist_next
@@ -0,0 +1,101 @@
+/*
+ * test-core-log.cpp - test log functions
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "src/core/core-log.h"
+
+extern int log_flush_pending;
+extern const char *log_date_prefix_get ();
+}
+
+TEST_GROUP(CoreLog)
+{
+    /*
+     * Returns the size of log file on disk.
+     */
+
+    static long get_log_size ()
+    {
+        struct stat st;
+
+        if (!weechat_log_filename || (stat (weechat_log_filename, &st) != 0))
+            return -1;
+        return (long)st.st_size;
+    }
+};
+
+/*
+ * Tests functions:
+ *   log_date_prefix_get
+ */
+
+TEST(CoreLog, DatePrefixGet)
+{
+    const char *prefix;
+
+    prefix = log_date_prefix_get ();
+    LONGS_EQUAL(22, strlen (prefix));
+    LONGS_EQUAL('[', prefix[0]);
+    STRCMP_EQUAL("] ", prefix + 20);
+}
+
+/*
+ * Tests functions:
+ *   log_printf
+ *   log_flush
+ *   log_set_flush_delayed
+ */
+
+TEST(CoreLog, Flush)
+{
+    long size;
+
+    if (!weechat_log_file || !weechat_log_filename)
+        return;
+
+    /* immediate flush */
+    log_printf ("test log: immediate flush");
+    LONGS_EQUAL(0, log_flush_pending);
+
+    /* delayed flush */
+    log_set_flush_delayed (1);
+    size = get_log_size ();
+    log_printf ("test log: delayed flush");
+    LONGS_EQUAL(1, log_flush_pending);
+    LONGS_EQUAL(size, get_log_size ());
+    log_flush ();
+    LONGS_EQUAL(0, log_flush_pending);
+    CHECK(get_log_size () > size);
+
+    /* disable delayed flush: pending messages are flushed */
+    size = get_log_size ();
+    log_printf ("test log: delayed flush (2)");
+    LONGS_EQUAL(size, get_log_size ());
+    log_set_flush_delayed (0);
+    LONGS_EQUAL(0, log_flush_pending);
+    CHECK(get_log_size () > size);
+}
@@ -23,6 +23,11 @@
 
 extern "C"
 {
+#include <stdlib.h>
+#include <string.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/socket.h>
 #include "src/core/core-network.h"
 
 extern int network_is_ip_address (const char *address);
@@ -280,3 +285,100 @@ TEST(CoreNetwork, ConnectWithFork)
 {
     /* TODO: write tests */
 }
+
+/*
+ * Tests functions:
+ *   network_connect_reorder_addresses
+ */
+
+TEST(CoreNetwork, ConnectReorderAddresses)
+{
+    struct addrinfo res[4], **res_reorder;
+    int i;
+
+    memset (res, 0, sizeof (res));
+    res[0].ai_family = AF_INET6;
+    res[0].ai_next = &res[1];
+    res[1].ai_family = AF_INET6;
+    res[1].ai_next = &res[2];
+    res[2].ai_family = AF_INET;
+    res[2].ai_next = &res[3];
+    res[3].ai_family = AF_INET;
+
+    LONGS_EQUAL(-1, network_connect_reorder_addresses (res, 0, NULL));
+
+    res_reorder = (struct addrinfo **)0x1;
+    LONGS_EQUAL(0, network_connect_reorder_addresses (NULL, 0, &res_reorder));
+    POINTERS_EQUAL(NULL, res_reorder);
+
+    /* first try: IPv6 group first */
+    LONGS_EQUAL(4, network_connect_reorder_addresses (res, 0, &res_reorder));
+    CHECK(res_reorder);
+    LONGS_EQUAL(AF_INET6, res_reorder[0]->ai_family);
+    LONGS_EQUAL(AF_INET6, res_reorder[1]->ai_family);
+    LONGS_EQUAL(AF_INET, res_reorder[2]->ai_family);
+    LONGS_EQUAL(AF_INET, res_reorder[3]->ai_family);
+    free (res_reorder);
+
+    /* retry: IPv4 group first, all addresses are kept */
+    LONGS_EQUAL(4, network_connect_reorder_addresses (res, 3, &res_reorder));
+    CHECK(res_reorder);
+    LONGS_EQUAL(AF_INET, res_reorder[0]->ai_family);
+    LONGS_EQUAL(AF_INET, res_reorder[1]->ai_family);
+    LONGS_EQUAL(AF_INET6, res_reorder[2]->ai_family);
+    LONGS_EQUAL(AF_INET6, res_reorder[3]->ai_family);
+    CHECK(res_reorder[0] != res_reorder[1]);
+    CHECK(res_reorder[2] != res_reorder[3]);
+    for (i = 0; i < 4; i++)
+    {
+        CHECK((res_reorder[i] >= &res[0]) && (res_reorder[i] <= &res[3]));
+    }
+    free (res_reorder);
+}
+
+/*
+ * Tests functions:
+ *   network_resolve_new
+ *   network_resolve_start
+ *   network_resolve_thread
+ *   network_resolve_unref
+ */
+
+TEST(CoreNetwork, ResolveThread)
+{
+    struct t_network_resolve *resolve;
+    struct pollfd poll_fd;
+    int done;
+
+    POINTERS_EQUAL(NULL, network_resolve_new (NULL, 6667, AF_INET, NULL));
+    POINTERS_EQUAL(NULL, network_resolve_new ("", 6667, AF_INET, NULL));
+    LONGS_EQUAL(0, network_resolve_start (NULL));
+    network_resolve_unref (NULL);
+
+    resolve = network_resolve_new ("127.0.0.1", 6667, AF_INET, "");
+    CHECK(resolve);
+    LONGS_EQUAL(1, resolve->refcount);
+    LONGS_EQUAL(0, resolve->done);
+    STRCMP_EQUAL("127.0.0.1", resolve->address);
+    STRCMP_EQUAL("6667", resolve->port);
+    POINTERS_EQUAL(NULL, resolve->local_hostname);
+
+    LONGS_EQUAL(1, network_resolve_start (resolve));
+
+    /* wait for end of thread (notified in the pipe) */
+    poll_fd.fd = resolve->pipe_read;
+    poll_fd.events = POLLIN;
+    poll_fd.revents = 0;
+    LONGS_EQUAL(1, poll (&poll_fd, 1, 10000));
+
+    pthread_mutex_lock (&resolve->mutex);
+    done = resolve->done;
+    pthread_mutex_unlock (&resolve->mutex);
+    LONGS_EQUAL(1, done);
+    LONGS_EQUAL(0, resolve->rc_remote);
+    CHECK(resolve->res_remote);
+    LONGS_EQUAL(AF_INET, resolve->res_remote->ai_family);
+    POINTERS_EQUAL(NULL, resolve->res_local);
+
+    network_resolve_unref (resolve);
+}
@@ -0,0 +1,126 @@
+/*
+ * test-core-parallel.cpp - test parallel functions
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include <string.h>
+#include "src/core/core-parallel.h"
+}
+
+struct t_test_parallel
+{
+    int values[10000];
+    int ranges[PARALLEL_MAX_THREADS][2];
+};
+
+TEST_GROUP(CoreParallel)
+{
+    /*
+     * Callback used in tests: sets value of items and stores the range
+     * processed by each thread.
+     */
+
+    static void
+    test_parallel_cb (void *data, int thread_index, int start, int end)
+    {
+        struct t_test_parallel *test;
+        int i;
+
+        test = (struct t_test_parallel *)data;
+
+        test->ranges[thread_index][0] = start;
+        test->ranges[thread_index][1] = end;
+        for (i = start; i < end; i++)
+        {
+            test->values[i] += i + 1;
+        }
+    }
+};
+
+/*
+ * Tests functions:
+ *   parallel_run
+ */
+
+TEST(CoreParallel, Run)
+{
+    static struct t_test_parallel test;
+    int i;
+
+    /* invalid arguments */
+    LONGS_EQUAL(0, parallel_run (4, 10, 1, NULL, NULL));
+    LONGS_EQUAL(0, parallel_run (4, -1, 1, &test_parallel_cb, &test));
+
+    /* no items */
+    memset (&test, 0, sizeof (test));
+    LONGS_EQUAL(1, parallel_run (4, 0, 100, &test_parallel_cb, &test));
+    LONGS_EQUAL(0, test.ranges[0][0]);
+    LONGS_EQUAL(0, test.ranges[0][1]);
+
+    /* not enough items for 2 threads */
+    memset (&test, 0, sizeof (test));
+    LONGS_EQUAL(1, parallel_run (4, 199, 100, &test_parallel_cb, &test));
+    LONGS_EQUAL(0, test.ranges[0][0]);
+    LONGS_EQUAL(199, test.ranges[0][1]);
+
+    /* only one thread allowed */
+    memset (&test, 0, sizeof (test));
+    LONGS_EQUAL(1, parallel_run (1, 10000, 100, &test_parallel_cb, &test));
+    LONGS_EQUAL(10000, test.ranges[0][1]);
+    for (i = 0; i < 10000; i++)
+    {
+        LONGS_EQUAL(i + 1, test.values[i]);
+    }
+
+    /* 3 threads (not enough items for 4) */
+    memset (&test, 0, sizeof (test));
+    LONGS_EQUAL(3, parallel_run (4, 350, 100, &test_parallel_cb, &test));
+    LONGS_EQUAL(0, test.ranges[0][0]);
+    LONGS_EQUAL(116, test.ranges[0][1]);
+    LONGS_EQUAL(116, test.ranges[1][0]);
+    LONGS_EQUAL(233, test.ranges[1][1]);
+    LONGS_EQUAL(233, test.ranges[2][0]);
+    LONGS_EQUAL(350, test.ranges[2][1]);
+    for (i = 0; i < 350; i++)
+    {
+        LONGS_EQUAL(i + 1, test.values[i]);
+    }
+
+    /* 8 threads, each item is processed exactly once */
+    memset (&test, 0, sizeof (test));
+    LONGS_EQUAL(8, parallel_run (8, 10000, 1, &test_parallel_cb, &test));
+    for (i = 0; i < 10000; i++)
+    {
+        LONGS_EQUAL(i + 1, test.values[i]);
+    }
+
+    /* max threads is limited to PARALLEL_MAX_THREADS */
+    memset (&test, 0, sizeof (test));
+    LONGS_EQUAL(PARALLEL_MAX_THREADS,
+                parallel_run (1000, 10000, 1, &test_parallel_cb, &test));
+    LONGS_EQUAL(10000, test.ranges[PARALLEL_MAX_THREADS - 1][1]);
+    for (i = 0; i < 10000; i++)
+    {
+        LONGS_EQUAL(i + 1, test.values[i]);
+    }
+}
@@ -0,0 +1,427 @@
+/*
+ * test-core-profile.cpp - test profiler functions
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include "src/core/weechat.h"
+#include "src/core/core-hashtable.h"
+#include "src/core/core-hook.h"
+#include "src/core/core-infolist.h"
+#include "src/core/core-profile.h"
+#include "src/core/core-util.h"
+#include "src/plugins/plugin.h"
+}
+
+TEST_GROUP(CoreProfile)
+{
+};
+
+/*
+ * Callback of signal hook used in tests.
+ */
+
+int
+test_profile_signal_cb (const void *pointer, void *data,
+                        const char *signal, const char *type_data,
+                        void *signal_data)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) signal;
+    (void) type_data;
+    (void) signal_data;
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Tests functions:
+ *   profile_stats_add
+ *   profile_stats_percentile
+ */
+
+TEST(CoreProfile, Stats)
+{
+    struct t_profile_stats stats;
+    int i;
+
+    memset (&stats, 0, sizeof (stats));
+
+    profile_stats_add (NULL, 10);
+    LONGS_EQUAL(0, profile_stats_percentile (NULL, 99));
+    LONGS_EQUAL(0, profile_stats_percentile (&stats, 99));
+
+    profile_stats_add (&stats, 0);
+    profile_stats_add (&stats, -5);
+    LONGS_EQUAL(2, stats.count);
+    LONGS_EQUAL(0, stats.time_total);
+    LONGS_EQUAL(0, stats.time_max);
+    LONGS_EQUAL(2, stats.histogram[0]);
+    LONGS_EQUAL(0, profile_stats_percentile (&stats, 99));
+
+    /* 98 calls of 10 microseconds and 2 slow calls */
+    memset (&stats, 0, sizeof (stats));
+    for (i = 0; i < 98; i++)
+    {
+        profile_stats_add (&stats, 10);
+    }
+    profile_stats_add (&stats, 3000);
+    profile_stats_add (&stats, 5000);
+    LONGS_EQUAL(100, stats.count);
+    LONGS_EQUAL(98 * 10 + 3000 + 5000, stats.time_total);
+    LONGS_EQUAL(5000, stats.time_max);
+    LONGS_EQUAL(98, stats.histogram[4]);
+    LONGS_EQUAL(1, stats.histogram[12]);
+    LONGS_EQUAL(1, stats.histogram[13]);
+
+    LONGS_EQUAL(15, profile_stats_percentile (&stats, 0));
+    LONGS_EQUAL(15, profile_stats_percentile (&stats, 50));
+    LONGS_EQUAL(15, profile_stats_percentile (&stats, 98));
+    LONGS_EQUAL(4095, profile_stats_percentile (&stats, 99));
+    LONGS_EQUAL(5000, profile_stats_percentile (&stats, 100));
+    LONGS_EQUAL(5000, profile_stats_percentile (&stats, 200));
+
+    /* very long call: last bucket */
+    profile_stats_add (&stats, 1LL << 40);
+    LONGS_EQUAL(1, stats.histogram[PROFILE_HISTOGRAM_SIZE - 1]);
+}
+
+/*
+ * Tests functions:
+ *   profile_start
+ *   profile_stop
+ *   profile_reset
+ *   profile_hook_add
+ *   profile_hook_free
+ *   profile_add_to_infolist
+ */
+
+TEST(CoreProfile, Hooks)
+{
+    struct t_hook *hook;
+    struct t_profile_stats *ptr_stats;
+    struct t_infolist *infolist;
+    long long *ptr_histogram;
+    int found_loop, found_phase, found_hook_type, found_plugin, found_hook;
+    int size;
+
+    profile_start ();
+    LONGS_EQUAL(1, profile_enabled);
+
+    hook = hook_signal (NULL, "test_profile", &test_profile_signal_cb,
+                        NULL, NULL);
+    CHECK(hook);
+    POINTERS_EQUAL(NULL, hook->profile);
+    hook_set (hook, "subplugin", "script");
+
+    (void) hook_signal_send ("test_profile", WEECHAT_HOOK_SIGNAL_STRING, NULL);
+    (void) hook_signal_send ("test_profile", WEECHAT_HOOK_SIGNAL_STRING, NULL);
+    CHECK(hook->profile);
+    LONGS_EQUAL(2, hook->profile->stats.count);
+    CHECK(profile_hook_types[HOOK_TYPE_SIGNAL].count >= 2);
+    ptr_stats = (struct t_profile_stats *)hashtable_get (profile_plugins,
+                                                         "core");
+    CHECK(ptr_stats);
+    POINTERS_EQUAL(ptr_stats, hook->profile->plugin_stats);
+    ptr_stats = (struct t_profile_stats *)hashtable_get (profile_plugins,
+                                                         "core/script");
+    CHECK(ptr_stats);
+    POINTERS_EQUAL(ptr_stats, hook->profile->subplugin_stats);
+    LONGS_EQUAL(2, ptr_stats->count);
+
+    /* check infolist */
+    infolist = infolist_new (NULL);
+    CHECK(infolist);
+    LONGS_EQUAL(1, profile_add_to_infolist (infolist));
+    found_loop = 0;
+    found_phase = 0;
+    found_hook_type = 0;
+    found_plugin = 0;
+    found_hook = 0;
+    while (infolist_next (infolist))
+    {
+        if ((strcmp (infolist_string (infolist, "type"), "loop") == 0)
+            && (strcmp (infolist_string (infolist, "name"), "iteration") == 0))
+        {
+            found_loop = 1;
+        }
+        else if ((strcmp (infolist_string (infolist, "type"), "phase") == 0)
+                 && (strcmp (infolist_string (infolist, "name"), "timers") == 0))
+        {
+            found_phase = 1;
+        }
+        else if ((strcmp (infolist_string (infolist, "type"), "hook_type") == 0)
+                 && (strcmp (infolist_string (infolist, "name"), "signal") == 0))
+        {
+            found_hook_type = 1;
+        }
+        else if ((strcmp (infolist_string (infolist, "type"), "plugin") == 0)
+                 && (strcmp (infolist_string (infolist, "name"), "core/script") == 0))
+        {
+            found_plugin = 1;
+            STRCMP_EQUAL("2", infolist_string (infolist, "count"));
+        }
+        else if ((strcmp (infolist_string (infolist, "type"), "hook") == 0)
+                 && (infolist_pointer (infolist, "hook") == hook))
+        {
+            found_hook = 1;
+            STRCMP_EQUAL("core/script", infolist_string (infolist, "name"));
+            STRCMP_EQUAL("2", infolist_string (infolist, "count"));
+            CHECK(infolist_string (infolist, "time_total"));
+            CHECK(infolist_string (infolist, "time_avg"));
+            CHECK(infolist_string (infolist, "time_max"));
+            CHECK(infolist_string (infolist, "time_p99"));
+            ptr_histogram = (long long *)infolist_buffer (infolist,
+                                                          "histogram",
+                                                          &size);
+            CHECK(ptr_histogram);
+            LONGS_EQUAL(PROFILE_HISTOGRAM_SIZE * sizeof (long long), size);
+        }
+    }
+    infolist_free (infolist);
+    LONGS_EQUAL(1, found_loop);
+    LONGS_EQUAL(1, found_phase);
+    LONGS_EQUAL(1, found_hook_type);
+    LONGS_EQUAL(1, found_plugin);
+    LONGS_EQUAL(1, found_hook);
+
+    /* stats are kept when profiler is stopped */
+    profile_stop ();
+    LONGS_EQUAL(0, profile_enabled);
+    (void) hook_signal_send ("test_profile", WEECHAT_HOOK_SIGNAL_STRING, NULL);
+    LONGS_EQUAL(2, hook->profile->stats.count);
+
+    /* reset stats */
+    profile_reset ();
+    POINTERS_EQUAL(NULL, hook->profile);
+    LONGS_EQUAL(0, profile_hook_types[HOOK_TYPE_SIGNAL].count);
+    LONGS_EQUAL(0, profile_plugins->items_count);
+
+    /* profile of hook is freed by unhook */
+    profile_start ();
+    (void) hook_signal_send ("test_profile", WEECHAT_HOOK_SIGNAL_STRING, NULL);
+    CHECK(hook->profile);
+    profile_hook_free (hook);
+    POINTERS_EQUAL(NULL, hook->profile);
+    profile_hook_free (NULL);
+    (void) hook_signal_send ("test_profile", WEECHAT_HOOK_SIGNAL_STRING, NULL);
+    CHECK(hook->profile);
+    unhook (hook);
+    profile_stop ();
+    profile_reset ();
+}
+
+/*
+ * Tests functions:
+ *   profile_phase_start
+ *   profile_phase_end
+ */
+
+TEST(CoreProfile, Phases)
+{
+    struct timeval start;
+
+    profile_reset ();
+
+    /* profiler disabled */
+    profile_phase_start (&start);
+    LONGS_EQUAL(0, start.tv_sec);
+    profile_phase_end (PROFILE_PHASE_TIMERS, &start);
+    LONGS_EQUAL(0, start.tv_sec);
+    LONGS_EQUAL(0, profile_phases[PROFILE_PHASE_TIMERS].count);
+
+    /* profiler enabled after start of phase: start time is set */
+    profile_enabled = 1;
+    profile_phase_end (PROFILE_PHASE_TIMERS, &start);
+    CHECK(start.tv_sec > 0);
+    LONGS_EQUAL(0, profile_phases[PROFILE_PHASE_TIMERS].count);
+
+    /* phases measured */
+    profile_phase_end (PROFILE_PHASE_TIMERS, &start);
+    profile_phase_end (PROFILE_PHASE_FD, &start);
+    profile_phase_end (PROFILE_PHASE_FD, &start);
+    LONGS_EQUAL(1, profile_phases[PROFILE_PHASE_TIMERS].count);
+    LONGS_EQUAL(2, profile_phases[PROFILE_PHASE_FD].count);
+    LONGS_EQUAL(0, profile_phases[PROFILE_PHASE_PROCESS].count);
+
+    /* iterations of main loop: the first one is partial and not measured */
+    LONGS_EQUAL(0, profile_loop.count);
+    profile_phase_end (PROFILE_PHASE_SIGNALS, &start);
+    LONGS_EQUAL(0, profile_loop.count);
+    profile_phase_end (PROFILE_PHASE_TIMERS, &start);
+    profile_phase_end (PROFILE_PHASE_SIGNALS, &start);
+    LONGS_EQUAL(1, profile_loop.count);
+
+    profile_stop ();
+    profile_phase_end (PROFILE_PHASE_FD, &start);
+    LONGS_EQUAL(0, start.tv_sec);
+    LONGS_EQUAL(2, profile_phases[PROFILE_PHASE_FD].count);
+
+    profile_reset ();
+    LONGS_EQUAL(0, profile_phases[PROFILE_PHASE_FD].count);
+    LONGS_EQUAL(0, profile_loop.count);
+}
+
+/*
+ * Tests functions:
+ *   profile_display
+ *   profile_export
+ *   profile_export_set
+ */
+
+TEST(CoreProfile, Export)
+{
+    char filename[1024], line[4096];
+    FILE *file;
+    int found;
+
+    snprintf (filename, sizeof (filename),
+              "%s/test_profile_%d.txt", weechat_data_dir, getpid ());
+
+    LONGS_EQUAL(0, profile_export (NULL));
+    LONGS_EQUAL(0, profile_export (""));
+    LONGS_EQUAL(0, profile_export ("/nonexistent_dir/profile.txt"));
+
+    profile_start ();
+    LONGS_EQUAL(1, profile_export (filename));
+    file = fopen (filename, "r");
+    CHECK(file);
+    found = 0;
+    while (fgets (line, sizeof (line), file))
+    {
+        if (strncmp (line, "Profile (running, duration: ", 28) == 0)
+            found |= 1;
+        else if (strcmp (line, "  main loop:\n") == 0)
+            found |= 2;
+        else if (strncmp (line, "    timers: calls: 0, ", 22) == 0)
+            found |= 4;
+        else if (strcmp (line, "  hooks (top 0 of 0):\n") == 0)
+            found |= 8;
+    }
+    fclose (file);
+    unlink (filename);
+    LONGS_EQUAL(15, found);
+
+    /* periodic export */
+    LONGS_EQUAL(1, profile_export_set (filename, 60 * 1000000LL));
+    STRCMP_EQUAL(filename, profile_export_filename);
+    LONGS_EQUAL(60 * 1000000LL, profile_export_interval);
+    LONGS_EQUAL(1, profile_export_set (NULL, 0));
+    POINTERS_EQUAL(NULL, profile_export_filename);
+    LONGS_EQUAL(0, profile_export_interval);
+
+    /* periodic export is stopped with profiler */
+    LONGS_EQUAL(1, profile_export_set (filename, 1000000LL));
+    profile_stop ();
+    POINTERS_EQUAL(NULL, profile_export_filename);
+
+    profile_reset ();
+}
+
+/*
+ * Tests functions:
+ *   profile_startup_init
+ *   profile_startup_add
+ *   profile_startup_phase
+ *   profile_startup_set_mark
+ *   profile_startup_end
+ *   profile_startup_display
+ *   profile_startup_free_all
+ */
+
+TEST(CoreProfile, Startup)
+{
+    struct t_profile_startup_step *step;
+    struct timeval tv_start, tv_phase;
+
+    /* startup profile has been recorded on startup */
+    LONGS_EQUAL(0, profile_startup_running);
+    CHECK(profile_startup_steps);
+    CHECK(profile_startup_time > 0);
+
+    gettimeofday (&tv_start, NULL);
+
+    /* startup is over: no step is added */
+    POINTERS_EQUAL(NULL,
+                   profile_startup_add (PROFILE_STARTUP_PHASE, "test",
+                                        &tv_start));
+
+    profile_startup_init ();
+    LONGS_EQUAL(1, profile_startup_running);
+    POINTERS_EQUAL(NULL, profile_startup_steps);
+    POINTERS_EQUAL(NULL, last_profile_startup_step);
+
+    POINTERS_EQUAL(NULL,
+                   profile_startup_add (PROFILE_STARTUP_PHASE, "test", NULL));
+    POINTERS_EQUAL(NULL,
+                   profile_startup_add (PROFILE_STARTUP_NUM_TYPES, "test",
+                                        &tv_start));
+
+    step = profile_startup_add (PROFILE_STARTUP_CONFIG, "test.conf",
+                                &tv_start);
+    CHECK(step);
+    POINTERS_EQUAL(step, profile_startup_steps);
+    POINTERS_EQUAL(step, last_profile_startup_step);
+    LONGS_EQUAL(PROFILE_STARTUP_CONFIG, step->type);
+    STRCMP_EQUAL("test.conf", step->name);
+    CHECK(step->start > 0);
+    CHECK(step->time >= 0);
+
+    tv_phase = tv_start;
+    profile_startup_phase ("phase1", &tv_phase);
+    CHECK(util_timeval_cmp (&tv_phase, &tv_start) >= 0);
+    step = last_profile_startup_step;
+    CHECK(step);
+    POINTERS_EQUAL(profile_startup_steps, step->prev_step);
+    LONGS_EQUAL(PROFILE_STARTUP_PHASE, step->type);
+    STRCMP_EQUAL("phase1", step->name);
+
+    /* script loaded */
+    profile_startup_set_mark ();
+    hook_signal_send ("test_script_loaded",
+                      WEECHAT_HOOK_SIGNAL_STRING, (void *)"/path/test.py");
+    step = last_profile_startup_step;
+    CHECK(step);
+    LONGS_EQUAL(PROFILE_STARTUP_SCRIPT, step->type);
+    STRCMP_EQUAL("/path/test.py", step->name);
+
+    profile_startup_display (NULL);
+
+    profile_startup_end ();
+    LONGS_EQUAL(0, profile_startup_running);
+    CHECK(profile_startup_time > 0);
+
+    /* startup is over: signal is not caught any more */
+    hook_signal_send ("test_script_loaded",
+                      WEECHAT_HOOK_SIGNAL_STRING, (void *)"/path/test2.py");
+    POINTERS_EQUAL(step, last_profile_startup_step);
+
+    profile_startup_free_all ();
+    POINTERS_EQUAL(NULL, profile_startup_steps);
+    POINTERS_EQUAL(NULL, last_profile_startup_step);
+}
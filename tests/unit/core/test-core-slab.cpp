@@ -0,0 +1,162 @@
+/*
+ * test-core-slab.cpp - test slab functions
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include <string.h>
+#include "src/core/core-slab.h"
+}
+
+TEST_GROUP(CoreSlab)
+{
+};
+
+/*
+ * Tests functions:
+ *   slab_new
+ *   slab_free
+ */
+
+TEST(CoreSlab, New)
+{
+    struct t_slab *slab;
+
+    POINTERS_EQUAL(NULL, slab_new (0, 16));
+    POINTERS_EQUAL(NULL, slab_new (-1, 16));
+    POINTERS_EQUAL(NULL, slab_new (16, 0));
+
+    slab = slab_new (2, 16);
+    CHECK(slab);
+    LONGS_EQUAL(sizeof (void *), slab->item_size);
+    CHECK(slab->slot_size >= (int)(2 * sizeof (void *)));
+    LONGS_EQUAL(16, slab->chunk_max_items);
+    LONGS_EQUAL(0, slab->chunks_count);
+    LONGS_EQUAL(0, slab->items_count);
+    LONGS_EQUAL(0, slab->free_pending);
+    POINTERS_EQUAL(NULL, slab->chunks);
+    POINTERS_EQUAL(NULL, slab->last_chunk);
+    slab_free (slab);
+
+    slab_free (NULL);
+}
+
+/*
+ * Tests functions:
+ *   slab_alloc
+ *   slab_free_item
+ */
+
+TEST(CoreSlab, AllocFree)
+{
+    struct t_slab *slab;
+    char *items[100];
+    int i, j;
+
+    POINTERS_EQUAL(NULL, slab_alloc (NULL));
+    slab_free_item (NULL);
+
+    slab = slab_new (10, 32);
+    CHECK(slab);
+
+    /* allocate items: chunks have 8, 8, 16, 32, 32... items */
+    for (i = 0; i < 100; i++)
+    {
+        items[i] = (char *)slab_alloc (slab);
+        CHECK(items[i]);
+        LONGS_EQUAL(0, ((unsigned long)items[i]) % sizeof (void *));
+        snprintf (items[i], 10, "item%d", i);
+    }
+    LONGS_EQUAL(100, slab->items_count);
+    LONGS_EQUAL(6, slab->chunks_count);
+    for (i = 0; i < 100; i++)
+    {
+        for (j = i + 1; j < 100; j++)
+        {
+            CHECK(items[i] != items[j]);
+        }
+    }
+    for (i = 0; i < 100; i++)
+    {
+        char str_item[16];
+        snprintf (str_item, sizeof (str_item), "item%d", i);
+        STRCMP_EQUAL(str_item, items[i]);
+    }
+
+    /* free first chunks: memory of chunks is released */
+    for (i = 0; i < 16; i++)
+    {
+        slab_free_item (items[i]);
+    }
+    LONGS_EQUAL(84, slab->items_count);
+    LONGS_EQUAL(4, slab->chunks_count);
+
+    /* free one item in a full chunk: it is reused by next allocation */
+    slab_free_item (items[50]);
+    LONGS_EQUAL(83, slab->items_count);
+    LONGS_EQUAL(slab->chunks->size - 1, slab->chunks->items_used);
+    POINTERS_EQUAL(items[50], slab_alloc (slab));
+    LONGS_EQUAL(84, slab->items_count);
+    LONGS_EQUAL(4, slab->chunks_count);
+
+    /* free all items */
+    for (i = 16; i < 100; i++)
+    {
+        slab_free_item (items[i]);
+    }
+    LONGS_EQUAL(0, slab->items_count);
+    LONGS_EQUAL(0, slab->chunks_count);
+    POINTERS_EQUAL(NULL, slab->chunks);
+    POINTERS_EQUAL(NULL, slab->last_chunk);
+
+    slab_free (slab);
+}
+
+/*
+ * Tests functions:
+ *   slab_free (with items still used)
+ */
+
+TEST(CoreSlab, FreePending)
+{
+    struct t_slab *slab;
+    void *item1, *item2;
+
+    slab = slab_new (32, 8);
+    CHECK(slab);
+
+    item1 = slab_alloc (slab);
+    CHECK(item1);
+    item2 = slab_alloc (slab);
+    CHECK(item2);
+
+    /* slab is not freed while items are used */
+    slab_free (slab);
+    LONGS_EQUAL(1, slab->free_pending);
+    LONGS_EQUAL(2, slab->items_count);
+
+    slab_free_item (item1);
+    LONGS_EQUAL(1, slab->items_count);
+
+    /* slab is freed with the last item */
+    slab_free_item (item2);
+}
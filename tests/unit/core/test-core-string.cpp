@@ -52,6 +52,14 @@ extern "C"
 #define WEE_HAS_HL_STR(__result, __str, __words)                        \
     LONGS_EQUAL(__result, string_has_highlight (__str, __words));
 
+#define WEE_MATCH_COMPILED(__result, __str, __mask, __case_sensitive) \
+    LONGS_EQUAL(__result,                                               \
+                string_match (__str, __mask, __case_sensitive));        \
+    mask = string_mask_compile (__mask, __case_sensitive);              \
+    CHECK(mask);                                                        \
+    LONGS_EQUAL(__result, string_match_compiled (__str, mask));         \
+    string_mask_free (mask);
+
 #define WEE_HAS_HL_REGEX(__result_regex, __result_hl, __str, __regex)   \
     LONGS_EQUAL(__result_hl,                                            \
                 string_has_highlight_regex (__str, __regex));           \
@@ -61,7 +69,7 @@ extern "C"
                 string_has_highlight_regex_compiled (__str,             \
                                                      &regex));          \
     if (__result_regex == 0)                                            \
-        regfree(&regex);
+        string_regfree (&regex);
 
 #define WEE_REPLACE_REGEX(__result_regex, __result_replace, __str,      \
                           __regex, __replace, __ref_char, __callback)   \
@@ -80,7 +88,7 @@ extern "C"
         free (result);                                                  \
     }                                                                   \
     if (__result_regex == 0)                                            \
-        regfree(&regex);
+        string_regfree (&regex);
 
 #define WEE_REPLACE_CB(__result_replace, __result_errors,               \
                        __str, __prefix, __suffix, __allow_escape,       \
@@ -958,6 +966,211 @@ TEST(CoreString, MatchList)
     LONGS_EQUAL(1, string_match_list ("def", masks_negative_star, 0));
 }
 
+/*
+ * Tests functions:
+ *   string_mask_compile
+ *   string_mask_free
+ */
+
+TEST(CoreString, MaskCompile)
+{
+    struct t_string_mask *mask;
+
+    POINTERS_EQUAL(NULL, string_mask_compile (NULL, 0));
+
+    mask = string_mask_compile ("", 0);
+    CHECK(mask);
+    STRCMP_EQUAL("", mask->mask);
+    LONGS_EQUAL(0, mask->wildcard_start);
+    LONGS_EQUAL(0, mask->wildcard_end);
+    LONGS_EQUAL(0, mask->words_count);
+    POINTERS_EQUAL(NULL, mask->words);
+    string_mask_free (mask);
+
+    mask = string_mask_compile ("**", 1);
+    CHECK(mask);
+    STRCMP_EQUAL("**", mask->mask);
+    LONGS_EQUAL(1, mask->case_sensitive);
+    LONGS_EQUAL(0, mask->negated);
+    LONGS_EQUAL(1, mask->wildcard_start);
+    LONGS_EQUAL(1, mask->wildcard_end);
+    LONGS_EQUAL(0, mask->words_count);
+    POINTERS_EQUAL(NULL, mask->words);
+    string_mask_free (mask);
+
+    mask = string_mask_compile ("!irc.*", 1);
+    CHECK(mask);
+    STRCMP_EQUAL("!irc.*", mask->mask);
+    LONGS_EQUAL(0, mask->negated);
+    LONGS_EQUAL(0, mask->wildcard_start);
+    LONGS_EQUAL(1, mask->wildcard_end);
+    LONGS_EQUAL(1, mask->words_count);
+    STRCMP_EQUAL("!irc.", mask->words[0].word);
+    LONGS_EQUAL(5, mask->words[0].size);
+    LONGS_EQUAL(5, mask->words[0].length);
+    POINTERS_EQUAL(NULL, mask->words[0].chars);
+    string_mask_free (mask);
+
+    mask = string_mask_compile ("Déf*AB**c", 0);
+    CHECK(mask);
+    LONGS_EQUAL(0, mask->case_sensitive);
+    LONGS_EQUAL(0, mask->wildcard_start);
+    LONGS_EQUAL(0, mask->wildcard_end);
+    LONGS_EQUAL(3, mask->words_count);
+    STRCMP_EQUAL("Déf", mask->words[0].word);
+    LONGS_EQUAL(4, mask->words[0].size);
+    LONGS_EQUAL(3, mask->words[0].length);
+    LONGS_EQUAL('d', mask->words[0].chars[0]);
+    LONGS_EQUAL(0xE9, mask->words[0].chars[1]);
+    LONGS_EQUAL('f', mask->words[0].chars[2]);
+    STRCMP_EQUAL("AB", mask->words[1].word);
+    LONGS_EQUAL('a', mask->words[1].chars[0]);
+    LONGS_EQUAL('b', mask->words[1].chars[1]);
+    STRCMP_EQUAL("c", mask->words[2].word);
+    LONGS_EQUAL('c', mask->words[2].chars[0]);
+    string_mask_free (mask);
+
+    /* test free of NULL mask */
+    string_mask_free (NULL);
+}
+
+/*
+ * Tests functions:
+ *   string_match_compiled
+ */
+
+TEST(CoreString, MatchCompiled)
+{
+    struct t_string_mask *mask;
+
+    LONGS_EQUAL(0, string_match_compiled (NULL, NULL));
+    LONGS_EQUAL(0, string_match_compiled ("test", NULL));
+    mask = string_mask_compile ("test", 0);
+    LONGS_EQUAL(0, string_match_compiled (NULL, mask));
+    string_mask_free (mask);
+
+    WEE_MATCH_COMPILED(0, "", "", 0);
+    WEE_MATCH_COMPILED(0, "", "test", 0);
+    WEE_MATCH_COMPILED(0, "test", "", 0);
+    WEE_MATCH_COMPILED(1, "", "*", 0);
+    WEE_MATCH_COMPILED(1, "", "**", 1);
+    WEE_MATCH_COMPILED(0, "", "*a", 0);
+    WEE_MATCH_COMPILED(0, "", "a*", 0);
+    WEE_MATCH_COMPILED(1, "test", "*", 0);
+    WEE_MATCH_COMPILED(1, "test", "test", 0);
+    WEE_MATCH_COMPILED(1, "test", "TEST", 0);
+    WEE_MATCH_COMPILED(0, "test", "TEST", 1);
+    WEE_MATCH_COMPILED(0, "test", "tes", 0);
+    WEE_MATCH_COMPILED(0, "tes", "test", 0);
+    WEE_MATCH_COMPILED(0, "test", "def*", 0);
+    WEE_MATCH_COMPILED(0, "test", "*def", 1);
+    WEE_MATCH_COMPILED(0, "test", "*def*", 0);
+    WEE_MATCH_COMPILED(0, "test", "es*", 0);
+    WEE_MATCH_COMPILED(0, "test", "*es", 1);
+    WEE_MATCH_COMPILED(1, "test", "*es*", 0);
+    WEE_MATCH_COMPILED(1, "test", "**es**", 0);
+    WEE_MATCH_COMPILED(1, "test", "*ES*", 0);
+    WEE_MATCH_COMPILED(0, "test", "*ES*", 1);
+    WEE_MATCH_COMPILED(1, "TEST", "*es*", 0);
+    WEE_MATCH_COMPILED(0, "TEST", "*es*", 1);
+    WEE_MATCH_COMPILED(1, "test", "t*t", 1);
+    WEE_MATCH_COMPILED(1, "tt", "t*t", 1);
+    WEE_MATCH_COMPILED(0, "t", "t*t", 1);
+    WEE_MATCH_COMPILED(0, "aba", "ab*ba", 0);
+    WEE_MATCH_COMPILED(1, "abba", "ab*ba", 0);
+    WEE_MATCH_COMPILED(0, "aaba", "*aa", 0);
+    WEE_MATCH_COMPILED(1, "abaa", "*aa", 1);
+    WEE_MATCH_COMPILED(1, "aabaabaabaa", "*aa", 0);
+    WEE_MATCH_COMPILED(0, "abaa", "aa*", 0);
+    WEE_MATCH_COMPILED(1, "aaba", "aa*", 1);
+    WEE_MATCH_COMPILED(1, "script.color.description", "*script.color*", 0);
+    WEE_MATCH_COMPILED(1, "script.color.description", "*script.COLOR*", 0);
+    WEE_MATCH_COMPILED(0, "script.color.description", "*script.COLOR*", 1);
+    WEE_MATCH_COMPILED(1, "script.color.description", "*script*color*", 1);
+    WEE_MATCH_COMPILED(1, "script.color.description", "script*desc*ion", 1);
+    WEE_MATCH_COMPILED(0, "script.color.description", "script*desc*color", 1);
+    WEE_MATCH_COMPILED(1, "script.script.script", "scr*scr*scr*", 0);
+    WEE_MATCH_COMPILED(1, "script.script.script", "SCR*SCR*SCR*", 0);
+    WEE_MATCH_COMPILED(0, "script.script.script", "SCR*SCR*SCR*", 1);
+    WEE_MATCH_COMPILED(0, "script.script.script", "scr*scr*scr*scr*", 0);
+    WEE_MATCH_COMPILED(1, "irc.libera.#weechat", "irc.*.#weechat", 1);
+    WEE_MATCH_COMPILED(0, "irc.libera.#weechat", "irc.*.#test", 1);
+    WEE_MATCH_COMPILED(1, "DÉFINITION", "déf*tion", 0);
+    WEE_MATCH_COMPILED(1, "définition", "*FINI*", 0);
+    WEE_MATCH_COMPILED(1, "définition", "*É*", 0);
+    WEE_MATCH_COMPILED(0, "définition", "*É*", 1);
+    WEE_MATCH_COMPILED(1, "café", "*É", 0);
+    WEE_MATCH_COMPILED(0, "café", "*É", 1);
+    WEE_MATCH_COMPILED(1, "!test", "!test", 0);
+    WEE_MATCH_COMPILED(0, "test", "!test", 0);
+}
+
+/*
+ * Tests functions:
+ *   string_mask_compile_list
+ *   string_match_list_compiled
+ *   string_mask_free_list
+ */
+
+TEST(CoreString, MatchListCompiled)
+{
+    const char *masks_none[1] = { NULL };
+    const char *masks_two[3] = { "toto", "abc", NULL };
+    const char *masks_negative[3] = { "*", "!abc", NULL };
+    const char *masks_negative_star[3] = { "*", "!abc*", NULL };
+    struct t_string_mask **masks;
+
+    POINTERS_EQUAL(NULL, string_mask_compile_list (NULL, 0));
+    LONGS_EQUAL(0, string_match_list_compiled (NULL, NULL));
+    LONGS_EQUAL(0, string_match_list_compiled ("test", NULL));
+
+    masks = string_mask_compile_list (masks_none, 0);
+    CHECK(masks);
+    POINTERS_EQUAL(NULL, masks[0]);
+    LONGS_EQUAL(0, string_match_list_compiled (NULL, masks));
+    LONGS_EQUAL(0, string_match_list_compiled ("", masks));
+    LONGS_EQUAL(0, string_match_list_compiled ("toto", masks));
+    string_mask_free_list (masks);
+
+    masks = string_mask_compile_list (masks_two, 0);
+    CHECK(masks);
+    LONGS_EQUAL(0, masks[0]->negated);
+    LONGS_EQUAL(0, masks[1]->negated);
+    POINTERS_EQUAL(NULL, masks[2]);
+    LONGS_EQUAL(1, string_match_list_compiled ("toto", masks));
+    LONGS_EQUAL(1, string_match_list_compiled ("ABC", masks));
+    LONGS_EQUAL(0, string_match_list_compiled ("def", masks));
+    string_mask_free_list (masks);
+
+    masks = string_mask_compile_list (masks_negative, 0);
+    CHECK(masks);
+    LONGS_EQUAL(0, masks[0]->negated);
+    LONGS_EQUAL(1, masks[1]->negated);
+    STRCMP_EQUAL("abc", masks[1]->mask);
+    LONGS_EQUAL(1, string_match_list_compiled ("test", masks));
+    LONGS_EQUAL(0, string_match_list_compiled ("abc", masks));
+    LONGS_EQUAL(0, string_match_list_compiled ("ABC", masks));
+    LONGS_EQUAL(1, string_match_list_compiled ("abcdef", masks));
+    string_mask_free_list (masks);
+
+    masks = string_mask_compile_list (masks_negative, 1);
+    CHECK(masks);
+    LONGS_EQUAL(0, string_match_list_compiled ("abc", masks));
+    LONGS_EQUAL(1, string_match_list_compiled ("ABC", masks));
+    string_mask_free_list (masks);
+
+    masks = string_mask_compile_list (masks_negative_star, 0);
+    CHECK(masks);
+    LONGS_EQUAL(1, string_match_list_compiled ("test", masks));
+    LONGS_EQUAL(0, string_match_list_compiled ("abc", masks));
+    LONGS_EQUAL(0, string_match_list_compiled ("ABCDEF", masks));
+    LONGS_EQUAL(1, string_match_list_compiled ("def", masks));
+    string_mask_free_list (masks);
+
+    /* test free of NULL list */
+    string_mask_free_list (NULL);
+}
+
 /*
  * Tests functions:
  *   string_expand_home
@@ -1284,6 +1497,7 @@ TEST(CoreString, MaskToRegex)
  * Tests functions:
  *   string_regex_flags
  *   string_regcomp
+ *   string_regfree
  */
 
 TEST(CoreString, Regex)
@@ -1328,16 +1542,98 @@ TEST(CoreString, Regex)
     LONGS_EQUAL(REG_ICASE | REG_NEWLINE | REG_NOSUB, flags);
     STRCMP_EQUAL("test6", ptr);
 
+    ptr = string_regex_flags ("(?ij)test7", REG_EXTENDED, &flags);
+    LONGS_EQUAL(REG_EXTENDED | REG_ICASE | STRING_REGEX_JIT, flags);
+    STRCMP_EQUAL("test7", ptr);
+
     /* compile regular expression */
     LONGS_EQUAL(-1, string_regcomp (&regex, NULL, 0));
     LONGS_EQUAL(0, string_regcomp (&regex, "", 0));
-    regfree (&regex);
+    string_regfree (&regex);
     LONGS_EQUAL(0, string_regcomp (&regex, "test", 0));
-    regfree (&regex);
+    string_regfree (&regex);
     LONGS_EQUAL(0, string_regcomp (&regex, "test", REG_EXTENDED));
-    regfree (&regex);
+    string_regfree (&regex);
     LONGS_EQUAL(0, string_regcomp (&regex, "(?ins)test", REG_EXTENDED));
-    regfree (&regex);
+    string_regfree (&regex);
+    LONGS_EQUAL(0, string_regcomp (&regex, "(?j)test", REG_EXTENDED));
+#ifdef HAVE_PCRE2
+    CHECK(hashtable_has_key (string_hashtable_regex_jit, &regex));
+#endif
+    string_regfree (&regex);
+#ifdef HAVE_PCRE2
+    CHECK(!hashtable_has_key (string_hashtable_regex_jit, &regex));
+#endif
+    LONGS_EQUAL(0, string_regcomp (&regex, "(?j)test", 0));
+#ifdef HAVE_PCRE2
+    CHECK(!hashtable_has_key (string_hashtable_regex_jit, &regex));
+#endif
+    string_regfree (&regex);
+    CHECK(string_regcomp (&regex, "(?j)test(", REG_EXTENDED) != 0);
+
+    string_regfree (NULL);
+}
+
+/*
+ * Tests functions:
+ *   string_regexec
+ */
+
+TEST(CoreString, Regexec)
+{
+    const char *regex_flags[] = { "", "(?j)", NULL };
+    char str_regex[128];
+    regex_t regex;
+    regmatch_t regex_match[4];
+    int i;
+
+    for (i = 0; regex_flags[i]; i++)
+    {
+        snprintf (str_regex, sizeof (str_regex),
+                  "%s^([a-z]+) +([0-9]+)( x)?", regex_flags[i]);
+        LONGS_EQUAL(0, string_regcomp (&regex, str_regex,
+                                       REG_EXTENDED | REG_ICASE));
+        LONGS_EQUAL(REG_NOMATCH,
+                    string_regexec (&regex, "", 0, NULL, 0));
+        LONGS_EQUAL(REG_NOMATCH,
+                    string_regexec (&regex, "123 abc", 0, NULL, 0));
+        LONGS_EQUAL(0, string_regexec (&regex, "ABC 123", 0, NULL, 0));
+        LONGS_EQUAL(REG_NOMATCH,
+                    string_regexec (&regex, "abc 123", 0, NULL, REG_NOTBOL));
+        LONGS_EQUAL(0, string_regexec (&regex, "Abc  42 y", 4, regex_match, 0));
+        LONGS_EQUAL(0, regex_match[0].rm_so);
+        LONGS_EQUAL(7, regex_match[0].rm_eo);
+        LONGS_EQUAL(0, regex_match[1].rm_so);
+        LONGS_EQUAL(3, regex_match[1].rm_eo);
+        LONGS_EQUAL(5, regex_match[2].rm_so);
+        LONGS_EQUAL(7, regex_match[2].rm_eo);
+        LONGS_EQUAL(-1, regex_match[3].rm_so);
+        LONGS_EQUAL(-1, regex_match[3].rm_eo);
+        LONGS_EQUAL(0, string_regexec (&regex, "x 1", 1, regex_match, 0));
+        LONGS_EQUAL(0, regex_match[0].rm_so);
+        LONGS_EQUAL(3, regex_match[0].rm_eo);
+        string_regfree (&regex);
+
+        /* flag "n": "." does not match a newline */
+        snprintf (str_regex, sizeof (str_regex), "%s(?n)a.b", regex_flags[i]);
+        LONGS_EQUAL(0, string_regcomp (&regex, str_regex, REG_EXTENDED));
+        LONGS_EQUAL(0, string_regexec (&regex, "axb", 0, NULL, 0));
+        LONGS_EQUAL(REG_NOMATCH, string_regexec (&regex, "a\nb", 0, NULL, 0));
+        string_regfree (&regex);
+        snprintf (str_regex, sizeof (str_regex), "%sa.b", regex_flags[i]);
+        LONGS_EQUAL(0, string_regcomp (&regex, str_regex, REG_EXTENDED));
+        LONGS_EQUAL(0, string_regexec (&regex, "a\nb", 0, NULL, 0));
+        string_regfree (&regex);
+    }
+
+    /* basic regex (not supported by PCRE2, POSIX regex is used) */
+    LONGS_EQUAL(0, string_regcomp (&regex, "(?j)a\\(b\\)", 0));
+    LONGS_EQUAL(0, string_regexec (&regex, "xab", 2, regex_match, 0));
+    LONGS_EQUAL(1, regex_match[0].rm_so);
+    LONGS_EQUAL(3, regex_match[0].rm_eo);
+    LONGS_EQUAL(2, regex_match[1].rm_so);
+    LONGS_EQUAL(3, regex_match[1].rm_eo);
+    string_regfree (&regex);
 }
 
 /*
@@ -1369,6 +1665,26 @@ TEST(CoreString, Highlight)
     WEE_HAS_HL_STR(1, "test\u00A0:here", "test");  /* unbreakable space */
     WEE_HAS_HL_STR(1, "this is a test here", "test");
     WEE_HAS_HL_STR(1, "this is a test here", "abc,test");
+    WEE_HAS_HL_STR(1, "this is a TEST here", "abc,test");
+    WEE_HAS_HL_STR(0, "this is a TEST here", "abc,(?-i)test");
+    WEE_HAS_HL_STR(1, "this is a test here", "abc,(?-i)test");
+    WEE_HAS_HL_STR(1, "this is a TEST here", "(?-i)abc,test");
+    WEE_HAS_HL_STR(0, "testing", "test");
+    WEE_HAS_HL_STR(1, "testing", "test*");
+    WEE_HAS_HL_STR(0, "testing", "*test");
+    WEE_HAS_HL_STR(1, "retest", "*test");
+    WEE_HAS_HL_STR(0, "retest", "test*");
+    WEE_HAS_HL_STR(1, "retesting", "*test*");
+    WEE_HAS_HL_STR(0, "abc", "*");
+    WEE_HAS_HL_STR(0, "abc", "**");
+    WEE_HAS_HL_STR(1, "ushers", "he,she,*hers");
+    WEE_HAS_HL_STR(1, "his hers", "he,she,his*,hers");
+    WEE_HAS_HL_STR(1, "a she b", "he,she,hers");
+    WEE_HAS_HL_STR(0, "ushers", "he,she,hers");
+    WEE_HAS_HL_STR(1, "xa:a:a b", "a:a");
+    WEE_HAS_HL_STR(1, "l'ÉTÉ est là", "été");
+    WEE_HAS_HL_STR(0, "l'ÉTÉ est là", "(?-i)été");
+    WEE_HAS_HL_STR(1, "il fait chaud en été", "ÉTÉ");
 
     /*
      * check highlight with a regex, each call of macro
@@ -1387,6 +1703,61 @@ TEST(CoreString, Highlight)
     WEE_HAS_HL_REGEX(0, 1, "tested here", "test.*");
     WEE_HAS_HL_REGEX(0, 0, "this is a test", "teste.*");
     WEE_HAS_HL_REGEX(0, 0, "test here", "teste.*");
+    WEE_HAS_HL_REGEX(0, 1, "this is a TEST", "(?ej)test");
+    WEE_HAS_HL_REGEX(0, 1, "abc tested here", "(?ej)test.*");
+    WEE_HAS_HL_REGEX(0, 0, "abc tested here", "(?ej)test");
+    WEE_HAS_HL_REGEX(0, 1, "été test", "(?ej)(été|test)");
+}
+
+/*
+ * Tests functions:
+ *   string_highlight_compile
+ *   string_highlight_match
+ *   string_highlight_free
+ */
+
+TEST(CoreString, HighlightCompile)
+{
+    struct t_string_highlight *highlight;
+
+    POINTERS_EQUAL(NULL, string_highlight_compile (NULL));
+    LONGS_EQUAL(0, string_highlight_match (NULL, "test"));
+    string_highlight_free (NULL);
+
+    highlight = string_highlight_compile ("");
+    CHECK(highlight);
+    STRCMP_EQUAL("", highlight->highlight_words);
+    LONGS_EQUAL(0, highlight->words_count);
+    LONGS_EQUAL(0, string_highlight_match (highlight, "test"));
+    string_highlight_free (highlight);
+
+    highlight = string_highlight_compile ("test,*abc,(?-i)DEF*,,*");
+    CHECK(highlight);
+    STRCMP_EQUAL("test,*abc,(?-i)DEF*,,*", highlight->highlight_words);
+    LONGS_EQUAL(3, highlight->words_count);
+    LONGS_EQUAL(4, highlight->words[0].length);
+    LONGS_EQUAL(0, highlight->words[0].wildcard_start);
+    LONGS_EQUAL(0, highlight->words[0].wildcard_end);
+    LONGS_EQUAL(3, highlight->words[1].length);
+    LONGS_EQUAL(1, highlight->words[1].wildcard_start);
+    LONGS_EQUAL(0, highlight->words[1].wildcard_end);
+    LONGS_EQUAL(3, highlight->words[2].length);
+    LONGS_EQUAL(0, highlight->words[2].wildcard_start);
+    LONGS_EQUAL(1, highlight->words[2].wildcard_end);
+    /* root + "test" + "abc" (case insensitive) */
+    LONGS_EQUAL(8, highlight->automaton[0].states_count);
+    /* root + "DEF" (case sensitive) */
+    LONGS_EQUAL(4, highlight->automaton[1].states_count);
+    LONGS_EQUAL(0, string_highlight_match (highlight, NULL));
+    LONGS_EQUAL(0, string_highlight_match (highlight, ""));
+    LONGS_EQUAL(0, string_highlight_match (highlight, "tests"));
+    LONGS_EQUAL(1, string_highlight_match (highlight, "a TEST!"));
+    LONGS_EQUAL(1, string_highlight_match (highlight, "xyzABC"));
+    LONGS_EQUAL(0, string_highlight_match (highlight, "xyzABCd"));
+    LONGS_EQUAL(1, string_highlight_match (highlight, "DEFINE"));
+    LONGS_EQUAL(0, string_highlight_match (highlight, "define"));
+    LONGS_EQUAL(0, string_highlight_match (highlight, "UNDEFINED"));
+    string_highlight_free (highlight);
 }
 
 /*
@@ -1462,6 +1833,14 @@ TEST(CoreString, ReplaceRegex)
                       "^(test +)(.*)", "$1/ $.*2", '$', NULL);
     WEE_REPLACE_REGEX(0, "%%%", "test foo",
                       "^(test +)(.*)", "$.%+", '$', NULL);
+
+    /* PCRE2 regex (if available) */
+    WEE_REPLACE_REGEX(0, "test xxx def xxx", "test abc def ABC",
+                      "(?j)abc", "xxx", '$', NULL);
+    WEE_REPLACE_REGEX(0, "foo", "test foo",
+                      "(?j)^(test +)(.*)", "$2", '$', NULL);
+    WEE_REPLACE_REGEX(0, "test / ***", "test foo",
+                      "(?j)^(test +)(.*)", "$1/ $.*2", '$', NULL);
 }
 
 /*
@@ -1900,6 +2279,76 @@ TEST(CoreString, SplitShared)
     string_free_split_shared (NULL);
 }
 
+/*
+ * Tests functions:
+ *   string_split_cursor_init
+ *   string_split_cursor_next
+ *   string_split_count
+ */
+
+TEST(CoreString, SplitCursor)
+{
+    struct t_string_split_cursor cursor;
+    const char *strings[] = {
+        "", ",", ",,,", "abc", "abc,de,fghi", ",abc", ",abc,de",
+        "abc,,,de,,fghi", ",,abc ,, de , fghi,,", "abc,", "a, b ;c;;",
+        NULL,
+    };
+    const char *item;
+    char **items;
+    int i, flags, max_items, num_items, length, count;
+
+    /* invalid arguments */
+    string_split_cursor_init (NULL, "abc", ",", 0, 0);
+    LONGS_EQUAL(0, string_split_cursor_next (NULL, &item, &length));
+    string_split_cursor_init (&cursor, NULL, ",", 0, 0);
+    LONGS_EQUAL(0, string_split_cursor_next (&cursor, &item, &length));
+    string_split_cursor_init (&cursor, "abc", NULL, 0, 0);
+    LONGS_EQUAL(0, string_split_cursor_next (&cursor, &item, &length));
+    string_split_cursor_init (&cursor, "abc", "", 0, 0);
+    LONGS_EQUAL(0, string_split_cursor_next (&cursor, &item, &length));
+    LONGS_EQUAL(0, string_split_count (NULL, ",", 0, 0));
+
+    /* simple split */
+    string_split_cursor_init (&cursor, "abc,de", ",", 0, 0);
+    LONGS_EQUAL(1, string_split_cursor_next (&cursor, &item, &length));
+    LONGS_EQUAL(3, length);
+    CHECK(strncmp (item, "abc", 3) == 0);
+    LONGS_EQUAL(1, string_split_cursor_next (&cursor, &item, &length));
+    LONGS_EQUAL(2, length);
+    CHECK(strncmp (item, "de", 2) == 0);
+    LONGS_EQUAL(0, string_split_cursor_next (&cursor, &item, &length));
+    LONGS_EQUAL(0, string_split_cursor_next (&cursor, &item, &length));
+
+    /* items must be the same as the ones returned by string_split */
+    for (i = 0; strings[i]; i++)
+    {
+        for (flags = 0; flags < 16; flags++)
+        {
+            for (max_items = 0; max_items < 4; max_items++)
+            {
+                items = string_split (strings[i], ",;", NULL, flags,
+                                      max_items, &num_items);
+                string_split_cursor_init (&cursor, strings[i], ",;", flags,
+                                          max_items);
+                count = 0;
+                while (string_split_cursor_next (&cursor, &item, &length))
+                {
+                    CHECK(count < num_items);
+                    LONGS_EQUAL(strlen (items[count]), length);
+                    CHECK(strncmp (item, items[count], length) == 0);
+                    count++;
+                }
+                LONGS_EQUAL(num_items, count);
+                LONGS_EQUAL(num_items,
+                            string_split_count (strings[i], ",;", flags,
+                                                max_items));
+                string_free_split (items);
+            }
+        }
+    }
+}
+
 /*
  * Tests functions:
  *   string_split_shell
@@ -0,0 +1,272 @@
+/*
+ * test-core-thread.cpp - test thread functions
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include <string.h>
+#include <pthread.h>
+#include "src/core/core-hashtable.h"
+#include "src/core/core-string.h"
+#include "src/core/core-thread.h"
+
+extern struct t_hashtable *string_hashtable_shared;
+}
+
+#define TEST_THREAD_NUM 4
+#define TEST_THREAD_POSTS 1000
+
+struct t_test_thread
+{
+    int index;                         /* index of thread                   */
+    int is_main;                       /* result of thread_is_main()        */
+    int posts_ok;                      /* number of posts OK                */
+    const char *concat;                /* result of string_concat()         */
+};
+
+int test_thread_count = 0;
+int test_thread_last[TEST_THREAD_NUM];
+int test_thread_errors = 0;
+
+TEST_GROUP(CoreThread)
+{
+    /*
+     * Callback used in tests: checks that posts of a thread are received in
+     * order.
+     */
+
+    static void
+    test_thread_post_cb (const void *pointer, void *data)
+    {
+        long thread_index, value;
+
+        thread_index = (long)pointer;
+        value = (long)data;
+
+        if (value != test_thread_last[thread_index] + 1)
+            test_thread_errors++;
+        test_thread_last[thread_index] = value;
+        test_thread_count++;
+    }
+
+    /*
+     * Thread used in tests: posts callbacks to main thread.
+     */
+
+    static void *
+    test_thread_post_run (void *arg)
+    {
+        struct t_test_thread *test;
+        long i;
+
+        test = (struct t_test_thread *)arg;
+
+        test->is_main = thread_is_main ();
+        for (i = 1; i <= TEST_THREAD_POSTS; i++)
+        {
+            if (thread_post (NULL, &test_thread_post_cb,
+                             (const void *)(long)test->index, (void *)i))
+            {
+                test->posts_ok++;
+            }
+        }
+
+        return NULL;
+    }
+
+    /*
+     * Thread used in tests: gets and frees shared strings, concatenates
+     * strings.
+     */
+
+    static void *
+    test_thread_string_run (void *arg)
+    {
+        struct t_test_thread *test;
+        const char *str1, *str2;
+        int i;
+
+        test = (struct t_test_thread *)arg;
+
+        for (i = 0; i < TEST_THREAD_POSTS; i++)
+        {
+            str1 = string_shared_get ("thread_shared");
+            str2 = string_shared_get ((i % 2) ? "thread_odd" : "thread_even");
+            string_shared_free (str1);
+            string_shared_free (str2);
+        }
+        test->concat = string_concat ("-", "thread", "concat", NULL);
+        test->posts_ok = (strcmp (test->concat, "thread-concat") == 0);
+
+        return NULL;
+    }
+
+    void setup ()
+    {
+        test_thread_count = 0;
+        memset (test_thread_last, 0, sizeof (test_thread_last));
+        test_thread_errors = 0;
+    }
+};
+
+/*
+ * Tests functions:
+ *   thread_is_main
+ */
+
+TEST(CoreThread, IsMain)
+{
+    pthread_t thread;
+    struct t_test_thread test;
+
+    LONGS_EQUAL(1, thread_is_main ());
+
+    memset (&test, 0, sizeof (test));
+    test.is_main = -1;
+    LONGS_EQUAL(0, pthread_create (&thread, NULL, &test_thread_post_run, &test));
+    pthread_join (thread, NULL);
+    LONGS_EQUAL(0, test.is_main);
+    LONGS_EQUAL(TEST_THREAD_POSTS, thread_post_run ());
+    LONGS_EQUAL(0, test_thread_errors);
+}
+
+/*
+ * Tests functions:
+ *   thread_post
+ *   thread_post_run
+ */
+
+TEST(CoreThread, Post)
+{
+    pthread_t threads[TEST_THREAD_NUM];
+    struct t_test_thread tests[TEST_THREAD_NUM];
+    long i;
+
+    /* invalid callback */
+    LONGS_EQUAL(0, thread_post (NULL, NULL, NULL, NULL));
+
+    /* nothing posted */
+    LONGS_EQUAL(0, thread_post_run ());
+
+    /* posts from main thread */
+    for (i = 1; i <= 3; i++)
+    {
+        LONGS_EQUAL(1, thread_post (NULL, &test_thread_post_cb, NULL,
+                                    (void *)i));
+    }
+    LONGS_EQUAL(0, test_thread_count);
+    LONGS_EQUAL(3, thread_post_run ());
+    LONGS_EQUAL(3, test_thread_count);
+    LONGS_EQUAL(3, test_thread_last[0]);
+    LONGS_EQUAL(0, test_thread_errors);
+    LONGS_EQUAL(0, thread_post_run ());
+
+    /* posts from multiple threads */
+    setup ();
+    memset (tests, 0, sizeof (tests));
+    for (i = 0; i < TEST_THREAD_NUM; i++)
+    {
+        tests[i].index = i;
+        LONGS_EQUAL(0, pthread_create (&threads[i], NULL,
+                                       &test_thread_post_run, &tests[i]));
+    }
+    for (i = 0; i < TEST_THREAD_NUM; i++)
+    {
+        pthread_join (threads[i], NULL);
+        LONGS_EQUAL(TEST_THREAD_POSTS, tests[i].posts_ok);
+    }
+    LONGS_EQUAL(TEST_THREAD_NUM * TEST_THREAD_POSTS, thread_post_run ());
+    LONGS_EQUAL(TEST_THREAD_NUM * TEST_THREAD_POSTS, test_thread_count);
+    for (i = 0; i < TEST_THREAD_NUM; i++)
+    {
+        LONGS_EQUAL(TEST_THREAD_POSTS, test_thread_last[i]);
+    }
+    LONGS_EQUAL(0, test_thread_errors);
+}
+
+/*
+ * Tests functions:
+ *   thread_post_remove_plugin
+ */
+
+TEST(CoreThread, PostRemovePlugin)
+{
+    struct t_weechat_plugin *plugin;
+
+    plugin = (struct t_weechat_plugin *)0x1;
+
+    LONGS_EQUAL(1, thread_post (plugin, &test_thread_post_cb, NULL,
+                                (void *)100));
+    LONGS_EQUAL(1, thread_post (NULL, &test_thread_post_cb, NULL,
+                                (void *)1));
+    LONGS_EQUAL(1, thread_post (plugin, &test_thread_post_cb, NULL,
+                                (void *)101));
+    LONGS_EQUAL(1, thread_post (NULL, &test_thread_post_cb, NULL,
+                                (void *)2));
+
+    thread_post_remove_plugin (NULL);
+    thread_post_remove_plugin (plugin);
+
+    /* a post after removal is run after the pending posts */
+    LONGS_EQUAL(1, thread_post (NULL, &test_thread_post_cb, NULL,
+                                (void *)3));
+
+    LONGS_EQUAL(3, thread_post_run ());
+    LONGS_EQUAL(3, test_thread_last[0]);
+    LONGS_EQUAL(0, test_thread_errors);
+}
+
+/*
+ * Tests functions (called from multiple threads):
+ *   string_shared_get
+ *   string_shared_free
+ *   string_concat
+ */
+
+TEST(CoreThread, StringFunctions)
+{
+    pthread_t threads[TEST_THREAD_NUM];
+    struct t_test_thread tests[TEST_THREAD_NUM];
+    const char *str_main;
+    int i, count;
+
+    count = (string_hashtable_shared) ? string_hashtable_shared->items_count : 0;
+
+    str_main = string_concat ("-", "main", "concat", NULL);
+
+    memset (tests, 0, sizeof (tests));
+    for (i = 0; i < TEST_THREAD_NUM; i++)
+    {
+        LONGS_EQUAL(0, pthread_create (&threads[i], NULL,
+                                       &test_thread_string_run, &tests[i]));
+    }
+    for (i = 0; i < TEST_THREAD_NUM; i++)
+    {
+        pthread_join (threads[i], NULL);
+        LONGS_EQUAL(1, tests[i].posts_ok);
+    }
+
+    /* buffer of main thread has not been changed by other threads */
+    STRCMP_EQUAL("main-concat", str_main);
+
+    LONGS_EQUAL(count, string_hashtable_shared->items_count);
+}
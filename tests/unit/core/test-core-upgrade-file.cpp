@@ -0,0 +1,251 @@
+/*
+ * test-core-upgrade-file.cpp - test upgrade file functions
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#ifndef HAVE_CONFIG_H
+#define HAVE_CONFIG_H
+#endif
+#include <string.h>
+#include <unistd.h>
+#include "src/core/weechat.h"
+#include "src/core/core-infolist.h"
+#include "src/core/core-upgrade-file.h"
+#include "src/plugins/weechat-plugin.h"
+}
+
+#define TEST_UPGRADE_FILENAME "test_upgrade_file"
+
+int test_upgrade_object_id = -1;
+char *test_upgrade_block = NULL;
+int test_upgrade_block_size = 0;
+char *test_upgrade_string = NULL;
+
+TEST_GROUP(CoreUpgradeFile)
+{
+};
+
+/*
+ * Tests functions:
+ *   upgrade_file_block_new
+ *   upgrade_file_block_add
+ *   upgrade_file_block_add_integer
+ *   upgrade_file_block_add_time
+ *   upgrade_file_block_add_string
+ *   upgrade_file_block_get
+ *   upgrade_file_block_get_integer
+ *   upgrade_file_block_get_time
+ *   upgrade_file_block_get_string
+ *   upgrade_file_block_free
+ */
+
+TEST(CoreUpgradeFile, Block)
+{
+    struct t_upgrade_block *block;
+    int value;
+    time_t date;
+    char data[4];
+
+    block = upgrade_file_block_new ();
+    CHECK(block);
+    POINTERS_EQUAL(NULL, block->data);
+    LONGS_EQUAL(0, block->size);
+    LONGS_EQUAL(0, block->size_alloc);
+    LONGS_EQUAL(0, block->read_pos);
+
+    LONGS_EQUAL(0, upgrade_file_block_add (NULL, "abc", 3));
+    LONGS_EQUAL(0, upgrade_file_block_add (block, NULL, 3));
+    LONGS_EQUAL(0, upgrade_file_block_add (block, "abc", -1));
+    LONGS_EQUAL(1, upgrade_file_block_add (block, "abc", 0));
+    LONGS_EQUAL(0, block->size);
+
+    LONGS_EQUAL(1, upgrade_file_block_add (block, "abc", 3));
+    LONGS_EQUAL(1, upgrade_file_block_add_integer (block, 123456));
+    LONGS_EQUAL(1, upgrade_file_block_add_time (block, 1700000000));
+    LONGS_EQUAL(1, upgrade_file_block_add_string (block, NULL));
+    LONGS_EQUAL(1, upgrade_file_block_add_string (block, ""));
+    LONGS_EQUAL(1, upgrade_file_block_add_string (block, "test"));
+    LONGS_EQUAL(3 + sizeof (int) + sizeof (time_t) + (3 * sizeof (int))
+                + 1 + 5,
+                block->size);
+
+    memset (data, 0, sizeof (data));
+    LONGS_EQUAL(1, upgrade_file_block_get (block, data, 3));
+    STRCMP_EQUAL("abc", data);
+    LONGS_EQUAL(1, upgrade_file_block_get_integer (block, &value));
+    LONGS_EQUAL(123456, value);
+    LONGS_EQUAL(1, upgrade_file_block_get_time (block, &date));
+    LONGS_EQUAL(1700000000, date);
+    POINTERS_EQUAL(NULL, upgrade_file_block_get_string (block));
+    STRCMP_EQUAL("", upgrade_file_block_get_string (block));
+    STRCMP_EQUAL("test", upgrade_file_block_get_string (block));
+    LONGS_EQUAL(block->size, block->read_pos);
+
+    /* no more data in block */
+    LONGS_EQUAL(0, upgrade_file_block_get_integer (block, &value));
+    POINTERS_EQUAL(NULL, upgrade_file_block_get_string (block));
+
+    upgrade_file_block_free (block);
+    upgrade_file_block_free (NULL);
+}
+
+/*
+ * Callback for reading upgrade file.
+ */
+
+int
+test_upgrade_file_read_cb (const void *pointer, void *data,
+                           struct t_upgrade_file *upgrade_file,
+                           int object_id,
+                           struct t_infolist *infolist)
+{
+    void *ptr_block;
+    const char *ptr_string;
+
+    /* make C++ compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) upgrade_file;
+
+    test_upgrade_object_id = object_id;
+
+    infolist_reset_item_cursor (infolist);
+    if (!infolist_next (infolist))
+        return WEECHAT_RC_ERROR;
+
+    ptr_string = infolist_string (infolist, "text");
+    if (ptr_string)
+    {
+        free (test_upgrade_string);
+        test_upgrade_string = strdup (ptr_string);
+    }
+
+    ptr_block = infolist_pointer (infolist, "block");
+    if (ptr_block)
+    {
+        test_upgrade_block_size = infolist_integer (infolist, "block_size");
+        free (test_upgrade_block);
+        test_upgrade_block = (char *)malloc (test_upgrade_block_size);
+        memcpy (test_upgrade_block, ptr_block, test_upgrade_block_size);
+    }
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Tests functions:
+ *   upgrade_file_new
+ *   upgrade_file_write_object
+ *   upgrade_file_write_block
+ *   upgrade_file_read
+ *   upgrade_file_read_block
+ *   upgrade_file_close
+ *   upgrade_file_wait_writers
+ *   upgrade_file_prefetch
+ *   upgrade_file_prefetch_free
+ */
+
+TEST(CoreUpgradeFile, WriteRead)
+{
+    struct t_upgrade_file *upgrade_file;
+    struct t_upgrade_block *block;
+    struct t_infolist *infolist;
+    struct t_infolist_item *item;
+    char *filename;
+    int i;
+
+    /* write file */
+    upgrade_file = upgrade_file_new (TEST_UPGRADE_FILENAME, NULL, NULL, NULL);
+    CHECK(upgrade_file);
+    filename = strdup (upgrade_file->filename);
+
+    infolist = infolist_new (NULL);
+    item = infolist_new_item (infolist);
+    infolist_new_var_string (item, "text", "some text");
+    LONGS_EQUAL(1, upgrade_file_write_object (upgrade_file, 1, infolist));
+    infolist_free (infolist);
+
+    block = upgrade_file_block_new ();
+    for (i = 0; i < 1000; i++)
+    {
+        upgrade_file_block_add_integer (block, i);
+        upgrade_file_block_add_string (block, "repeated string");
+    }
+    LONGS_EQUAL(1, upgrade_file_write_block (upgrade_file, 2, block));
+
+    upgrade_file_close (upgrade_file);
+
+    /* file is written on disk by a thread */
+    LONGS_EQUAL(1, upgrade_file_wait_writers ());
+    LONGS_EQUAL(0, access (filename, R_OK));
+
+    /* read file (mapped in memory when opened) */
+    upgrade_file = upgrade_file_new (TEST_UPGRADE_FILENAME,
+                                     &test_upgrade_file_read_cb, NULL, NULL);
+    CHECK(upgrade_file);
+#ifdef HAVE_FMEMOPEN
+    LONGS_EQUAL(1, upgrade_file->memory_mapped);
+#endif
+    LONGS_EQUAL(1, upgrade_file_read (upgrade_file));
+    upgrade_file_close (upgrade_file);
+
+    LONGS_EQUAL(2, test_upgrade_object_id);
+    STRCMP_EQUAL("some text", test_upgrade_string);
+    LONGS_EQUAL(block->size, test_upgrade_block_size);
+    MEMCMP_EQUAL(block->data, test_upgrade_block, block->size);
+
+    free (test_upgrade_string);
+    test_upgrade_string = NULL;
+    free (test_upgrade_block);
+    test_upgrade_block = NULL;
+    test_upgrade_block_size = 0;
+    test_upgrade_object_id = -1;
+
+    /* read file (mapped in memory before it is opened) */
+    upgrade_file_prefetch (weechat_data_dir);
+    upgrade_file = upgrade_file_new (TEST_UPGRADE_FILENAME,
+                                     &test_upgrade_file_read_cb, NULL, NULL);
+    CHECK(upgrade_file);
+#ifdef HAVE_FMEMOPEN
+    LONGS_EQUAL(1, upgrade_file->memory_mapped);
+    CHECK(upgrade_file->memory_data);
+#endif
+    LONGS_EQUAL(1, upgrade_file_read (upgrade_file));
+    upgrade_file_close (upgrade_file);
+    upgrade_file_prefetch_free ();
+
+    LONGS_EQUAL(2, test_upgrade_object_id);
+    STRCMP_EQUAL("some text", test_upgrade_string);
+    LONGS_EQUAL(block->size, test_upgrade_block_size);
+    MEMCMP_EQUAL(block->data, test_upgrade_block, block->size);
+
+    upgrade_file_block_free (block);
+    free (test_upgrade_string);
+    test_upgrade_string = NULL;
+    free (test_upgrade_block);
+    test_upgrade_block = NULL;
+    test_upgrade_block_size = 0;
+
+    unlink (filename);
+    free (filename);
+}
@@ -23,7 +23,13 @@
 
 extern "C"
 {
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "src/core/weechat.h"
+#include "src/core/core-hashtable.h"
 #include "src/core/core-url.h"
+#include "src/plugins/plugin.h"
 
 extern struct t_url_constant url_proxy_types[];
 extern struct t_url_constant url_protocols[];
@@ -139,6 +145,69 @@ TEST(CoreUrl, SetProxy)
     /* TODO: write tests */
 }
 
+/*
+ * Tests functions:
+ *   weeurl_transfer_new
+ *   weeurl_transfer_done
+ *   weeurl_transfer_free
+ */
+
+TEST(CoreUrl, Transfer)
+{
+    struct t_url_transfer *transfer;
+    struct t_hashtable *options, *output;
+
+    options = hashtable_new (32,
+                             WEECHAT_HASHTABLE_STRING,
+                             WEECHAT_HASHTABLE_STRING,
+                             NULL, NULL);
+    output = hashtable_new (32,
+                            WEECHAT_HASHTABLE_STRING,
+                            WEECHAT_HASHTABLE_STRING,
+                            NULL, NULL);
+
+    weeurl_transfer_free (NULL);
+    LONGS_EQUAL(3, weeurl_transfer_done (NULL, 0));
+
+    /* invalid URL */
+    transfer = weeurl_transfer_new (NULL, NULL, output);
+    CHECK(transfer);
+    POINTERS_EQUAL(NULL, transfer->curl);
+    LONGS_EQUAL(1, transfer->rc);
+    LONGS_EQUAL(1, weeurl_transfer_done (transfer, 0));
+    STRCMP_EQUAL("invalid URL", (const char *)hashtable_get (output, "error"));
+    weeurl_transfer_free (transfer);
+    hashtable_remove_all (output);
+
+    /* input file not found */
+    hashtable_set (options, "file_in", "/path/to/file/not/found");
+    transfer = weeurl_transfer_new ("file:///dev/null", options, output);
+    CHECK(transfer);
+    CHECK(transfer->curl);
+    LONGS_EQUAL(4, transfer->rc);
+    LONGS_EQUAL(4, weeurl_transfer_done (transfer, 0));
+    STRCMP_EQUAL("file \"/path/to/file/not/found\" not found",
+                 (const char *)hashtable_get (output, "error"));
+    weeurl_transfer_free (transfer);
+    hashtable_remove_all (options);
+    hashtable_remove_all (output);
+
+    /* transfer not performed (simulated curl error) */
+    transfer = weeurl_transfer_new ("file:///dev/null", NULL, output);
+    CHECK(transfer);
+    CHECK(transfer->curl);
+    LONGS_EQUAL(0, transfer->rc);
+    LONGS_EQUAL(2, weeurl_transfer_done (transfer, 7));
+    STRCMP_EQUAL("transfer error",
+                 (const char *)hashtable_get (output, "error"));
+    STRCMP_EQUAL("7", (const char *)hashtable_get (output, "error_code_curl"));
+    STRCMP_EQUAL("", (const char *)hashtable_get (output, "output"));
+    weeurl_transfer_free (transfer);
+
+    hashtable_free (options);
+    hashtable_free (output);
+}
+
 /*
  * Tests functions:
  *   weeurl_download
@@ -146,7 +215,63 @@ TEST(CoreUrl, SetProxy)
 
 TEST(CoreUrl, Download)
 {
-    /* TODO: write tests */
+    struct t_hashtable *options, *output;
+    char path[1024], path_out[1024], url[2048];
+    FILE *file;
+
+    snprintf (path, sizeof (path), "/tmp/weechat_test_url_%d",
+              (int)getpid ());
+    snprintf (path_out, sizeof (path_out), "/tmp/weechat_test_url_out_%d",
+              (int)getpid ());
+    snprintf (url, sizeof (url), "file://%s", path);
+    file = fopen (path, "w");
+    CHECK(file);
+    fputs ("test URL\n", file);
+    fclose (file);
+
+    options = hashtable_new (32,
+                             WEECHAT_HASHTABLE_STRING,
+                             WEECHAT_HASHTABLE_STRING,
+                             NULL, NULL);
+    output = hashtable_new (32,
+                            WEECHAT_HASHTABLE_STRING,
+                            WEECHAT_HASHTABLE_STRING,
+                            NULL, NULL);
+
+    LONGS_EQUAL(1, weeurl_download (NULL, NULL, NULL));
+    LONGS_EQUAL(1, weeurl_download ("", NULL, output));
+    STRCMP_EQUAL("invalid URL", (const char *)hashtable_get (output, "error"));
+    hashtable_remove_all (output);
+
+    /* output in hashtable */
+    LONGS_EQUAL(0, weeurl_download (url, NULL, output));
+    STRCMP_EQUAL("test URL\n", (const char *)hashtable_get (output, "output"));
+    STRCMP_EQUAL("0", (const char *)hashtable_get (output, "response_code"));
+    POINTERS_EQUAL(NULL, hashtable_get (output, "error"));
+    hashtable_remove_all (output);
+
+    /* output in a file */
+    hashtable_set (options, "file_out", path_out);
+    LONGS_EQUAL(0, weeurl_download (url, options, output));
+    POINTERS_EQUAL(NULL, hashtable_get (output, "output"));
+    file = fopen (path_out, "r");
+    CHECK(file);
+    CHECK(fgets (url, sizeof (url), file));
+    STRCMP_EQUAL("test URL\n", url);
+    fclose (file);
+    hashtable_remove_all (output);
+
+    unlink (path);
+    unlink (path_out);
+
+    /* file not found */
+    snprintf (url, sizeof (url), "file://%s", path);
+    LONGS_EQUAL(2, weeurl_download (url, NULL, output));
+    CHECK(hashtable_get (output, "error"));
+    CHECK(hashtable_get (output, "error_code_curl"));
+
+    hashtable_free (options);
+    hashtable_free (output);
 }
 
 /*
@@ -603,6 +603,7 @@ TEST(CoreUtf8, Size)
     LONGS_EQUAL(4, utf8_strlen_screen ("a" "\x01" UNICODE_ZERO_WIDTH_SPACE "\x02" "b"));
     LONGS_EQUAL(2, utf8_strlen_screen (UNICODE_SNOWMAN));
     LONGS_EQUAL(6, utf8_strlen_screen ("a" "\x01" UNICODE_SNOWMAN "\x02" "b"));
+    LONGS_EQUAL(15, utf8_strlen_screen ("abc " UNICODE_SNOWMAN " def~ ghi"));
     LONGS_EQUAL(2, utf8_strlen_screen (UNICODE_CJK_YELLOW));
     LONGS_EQUAL(6, utf8_strlen_screen ("a" "\x01" UNICODE_CJK_YELLOW "\x02" "b"));
     LONGS_EQUAL(2, utf8_strlen_screen (UNICODE_HAN_CHAR));
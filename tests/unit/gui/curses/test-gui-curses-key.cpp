@@ -0,0 +1,98 @@
+/*
+ * test-gui-curses-key.cpp - test key functions (Curses interface)
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include <string.h>
+#include "src/core/weechat.h"
+#include "src/core/core-hook.h"
+#include "src/gui/gui-buffer.h"
+#include "src/gui/gui-input.h"
+#include "src/gui/gui-key.h"
+#include "src/gui/gui-window.h"
+#include "src/plugins/plugin.h"
+
+extern void gui_key_flush (int paste);
+}
+
+int test_gui_curses_key_count_changed = 0;
+
+int
+test_gui_curses_key_input_text_changed_cb (const void *pointer, void *data,
+                                           const char *signal,
+                                           const char *type_data,
+                                           void *signal_data)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) signal;
+    (void) type_data;
+    (void) signal_data;
+
+    test_gui_curses_key_count_changed++;
+
+    return WEECHAT_RC_OK;
+}
+
+TEST_GROUP(GuiCursesKey)
+{
+};
+
+/*
+ * Tests functions:
+ *   gui_key_flush
+ */
+
+TEST(GuiCursesKey, Flush)
+{
+    struct t_hook *hook;
+    const char *text = "paste \xc3\xa9t\xc3\xa9\rline 2";
+    int i;
+
+    gui_input_delete_line (gui_current_window->buffer);
+    hook = hook_signal (NULL, "input_text_changed",
+                        &test_gui_curses_key_input_text_changed_cb,
+                        NULL, NULL);
+
+    /* paste: text is inserted at once, with a single signal */
+    test_gui_curses_key_count_changed = 0;
+    gui_key_buffer_reset ();
+    for (i = 0; text[i]; i++)
+    {
+        gui_key_buffer_add ((unsigned char)text[i]);
+    }
+    gui_key_flush (1);
+    STRCMP_EQUAL("paste \xc3\xa9t\xc3\xa9\nline 2",
+                 gui_current_window->buffer->input_buffer);
+    LONGS_EQUAL(16, gui_current_window->buffer->input_buffer_pos);
+    LONGS_EQUAL(1, test_gui_curses_key_count_changed);
+    LONGS_EQUAL(0, gui_key_buffer_size);
+
+    /* undo restores the input before paste */
+    gui_input_undo (gui_current_window->buffer);
+    STRCMP_EQUAL("", gui_current_window->buffer->input_buffer);
+
+    unhook (hook);
+    gui_input_delete_line (gui_current_window->buffer);
+}
@@ -0,0 +1,94 @@
+/*
+ * test-gui-curses-main.cpp - test main functions (Curses interface)
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include <string.h>
+#include <sys/time.h>
+#include "src/core/core-config.h"
+#include "src/core/core-config-file.h"
+#include "src/core/core-hook.h"
+#include "src/gui/gui-window.h"
+#include "src/gui/curses/gui-curses-main.h"
+
+extern struct timeval gui_main_refresh_last;
+extern struct t_hook *gui_main_refresh_timer;
+extern int gui_main_refresh_pending ();
+extern int gui_main_refresh_allowed ();
+}
+
+TEST_GROUP(GuiCursesMain)
+{
+};
+
+/*
+ * Tests functions:
+ *   gui_main_refresh_pending
+ */
+
+TEST(GuiCursesMain, RefreshPending)
+{
+    int old_refresh_needed;
+
+    old_refresh_needed = gui_window_refresh_needed;
+
+    gui_window_refresh_needed = 1;
+    LONGS_EQUAL(1, gui_main_refresh_pending ());
+
+    gui_window_refresh_needed = old_refresh_needed;
+}
+
+/*
+ * Tests functions:
+ *   gui_main_refresh_allowed
+ */
+
+TEST(GuiCursesMain, RefreshAllowed)
+{
+    /* no limit */
+    config_file_option_set (config_look_max_fps, "0", 1);
+    gettimeofday (&gui_main_refresh_last, NULL);
+    LONGS_EQUAL(1, gui_main_refresh_allowed ());
+    POINTERS_EQUAL(NULL, gui_main_refresh_timer);
+
+    /* refresh just done: next refresh is delayed, with a timer */
+    config_file_option_set (config_look_max_fps, "10", 1);
+    gettimeofday (&gui_main_refresh_last, NULL);
+    LONGS_EQUAL(0, gui_main_refresh_allowed ());
+    CHECK(gui_main_refresh_timer);
+    LONGS_EQUAL(0, gui_main_refresh_allowed ());
+
+    /* key pressed: immediate refresh */
+    gui_main_refresh_immediate = 1;
+    LONGS_EQUAL(1, gui_main_refresh_allowed ());
+    gui_main_refresh_immediate = 0;
+
+    /* last refresh is old enough */
+    gui_main_refresh_last.tv_sec -= 1;
+    LONGS_EQUAL(1, gui_main_refresh_allowed ());
+
+    unhook (gui_main_refresh_timer);
+    gui_main_refresh_timer = NULL;
+
+    config_file_option_reset (config_look_max_fps, 1);
+}
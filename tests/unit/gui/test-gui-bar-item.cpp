@@ -24,16 +24,30 @@
 extern "C"
 {
 #include <string.h>
+#include "src/core/core-hashtable.h"
+#include "src/core/core-hook.h"
 #include "src/gui/gui-bar.h"
 #include "src/gui/gui-bar-item.h"
+#include "src/gui/gui-buffer.h"
+#include "src/gui/gui-nicklist.h"
+#include "src/plugins/weechat-plugin.h"
+
+extern struct t_hook *gui_bar_item_updates_timer;
 
 extern char *gui_bar_item_buffer_name_cb (const void *pointer, void *data,
                                           struct t_gui_bar_item *item,
                                           struct t_gui_window *window,
                                           struct t_gui_buffer *buffer,
                                           struct t_hashtable *extra_info);
+extern char *gui_bar_item_buffer_nicklist_cb (const void *pointer, void *data,
+                                              struct t_gui_bar_item *item,
+                                              struct t_gui_window *window,
+                                              struct t_gui_buffer *buffer,
+                                              struct t_hashtable *extra_info);
 }
 
+#define TEST_BUFFER_NAME "test"
+
 TEST_GROUP(GuiBarItem)
 {
 };
@@ -161,6 +175,63 @@ TEST(GuiBarItem, CountLines)
     /* TODO: write tests */
 }
 
+/*
+ * Tests functions:
+ *   gui_bar_item_get_lines_displayed
+ *   gui_bar_item_set_lines_returned
+ */
+
+TEST(GuiBarItem, LinesDisplayed)
+{
+    struct t_hashtable *extra_info;
+    int lines_start, lines_count;
+
+    extra_info = hashtable_new (32,
+                                WEECHAT_HASHTABLE_STRING,
+                                WEECHAT_HASHTABLE_STRING,
+                                NULL, NULL);
+    CHECK(extra_info);
+
+    LONGS_EQUAL(0, gui_bar_item_get_lines_displayed (NULL,
+                                                     &lines_start,
+                                                     &lines_count));
+    LONGS_EQUAL(0, lines_start);
+    LONGS_EQUAL(-1, lines_count);
+    LONGS_EQUAL(0, gui_bar_item_get_lines_displayed (extra_info,
+                                                     &lines_start,
+                                                     &lines_count));
+
+    hashtable_set (extra_info, "_lines_start", "10");
+    LONGS_EQUAL(0, gui_bar_item_get_lines_displayed (extra_info,
+                                                     &lines_start,
+                                                     &lines_count));
+    hashtable_set (extra_info, "_lines_count", "abc");
+    LONGS_EQUAL(0, gui_bar_item_get_lines_displayed (extra_info,
+                                                     &lines_start,
+                                                     &lines_count));
+    hashtable_set (extra_info, "_lines_count", "0");
+    LONGS_EQUAL(0, gui_bar_item_get_lines_displayed (extra_info,
+                                                     &lines_start,
+                                                     &lines_count));
+    hashtable_set (extra_info, "_lines_count", "25");
+    LONGS_EQUAL(1, gui_bar_item_get_lines_displayed (extra_info,
+                                                     &lines_start,
+                                                     &lines_count));
+    LONGS_EQUAL(10, lines_start);
+    LONGS_EQUAL(25, lines_count);
+
+    gui_bar_item_set_lines_returned (NULL, 1, 2, 3);
+    gui_bar_item_set_lines_returned (extra_info, 30000, 8, 16);
+    STRCMP_EQUAL("30000", (const char *)hashtable_get (extra_info,
+                                                       "_lines_total"));
+    STRCMP_EQUAL("8", (const char *)hashtable_get (extra_info,
+                                                   "_lines_start"));
+    STRCMP_EQUAL("16", (const char *)hashtable_get (extra_info,
+                                                    "_lines_max_length"));
+
+    hashtable_free (extra_info);
+}
+
 /*
  * Tests functions:
  *   gui_bar_item_new
@@ -171,14 +242,64 @@ TEST(GuiBarItem, New)
     /* TODO: write tests */
 }
 
+/*
+ * Tests functions:
+ *   gui_bar_item_update_now
+ */
+
+TEST(GuiBarItem, UpdateNow)
+{
+    /* TODO: write tests */
+}
+
 /*
  * Tests functions:
  *   gui_bar_item_update
+ *   gui_bar_item_update_flush
  */
 
 TEST(GuiBarItem, Update)
 {
-    /* TODO: write tests */
+    struct t_gui_bar_item *ptr_item;
+
+    gui_bar_item_update_flush ();
+    CHECK(gui_bar_item_updates);
+    LONGS_EQUAL(0, gui_bar_item_updates->items_count);
+
+    gui_bar_item_update (NULL);
+    LONGS_EQUAL(0, gui_bar_item_updates->items_count);
+
+    /* updates of same item are done once */
+    gui_bar_item_update ("time");
+    gui_bar_item_update ("test_item");
+    gui_bar_item_update ("time");
+    gui_bar_item_update ("time");
+    LONGS_EQUAL(2, gui_bar_item_updates->items_count);
+    CHECK(hashtable_has_key (gui_bar_item_updates, "time"));
+    CHECK(hashtable_has_key (gui_bar_item_updates, "test_item"));
+    gui_bar_item_update_flush ();
+    LONGS_EQUAL(0, gui_bar_item_updates->items_count);
+
+    /* minimum interval between two updates */
+    ptr_item = gui_bar_item_search ("time");
+    CHECK(ptr_item);
+    ptr_item->update_min_interval = 60000;
+    ptr_item->update_last_time.tv_sec = 0;
+    ptr_item->update_last_time.tv_usec = 0;
+    gui_bar_item_update ("time");
+    gui_bar_item_update_flush ();
+    LONGS_EQUAL(0, gui_bar_item_updates->items_count);
+    CHECK(ptr_item->update_last_time.tv_sec > 0);
+    POINTERS_EQUAL(NULL, gui_bar_item_updates_timer);
+    gui_bar_item_update ("time");
+    gui_bar_item_update_flush ();
+    LONGS_EQUAL(1, gui_bar_item_updates->items_count);
+    CHECK(gui_bar_item_updates_timer);
+    ptr_item->update_min_interval = 0;
+    gui_bar_item_update_flush ();
+    LONGS_EQUAL(0, gui_bar_item_updates->items_count);
+    unhook (gui_bar_item_updates_timer);
+    gui_bar_item_updates_timer = NULL;
 }
 
 /*
@@ -429,7 +550,69 @@ TEST(GuiBarItem, BufferTitleCb)
 
 TEST(GuiBarItem, BufferNicklistCb)
 {
-    /* TODO: write tests */
+    struct t_gui_buffer *buffer;
+    struct t_hashtable *extra_info;
+    char *str, name[32];
+    int i;
+
+    buffer = gui_buffer_new (NULL, TEST_BUFFER_NAME,
+                             NULL, NULL, NULL,
+                             NULL, NULL, NULL);
+    CHECK(buffer);
+    gui_buffer_set (buffer, "nicklist_display_groups", "0");
+    for (i = 0; i < 100; i++)
+    {
+        snprintf (name, sizeof (name), "nick%03d", i);
+        CHECK(gui_nicklist_add_nick (buffer, NULL, name, NULL,
+                                     (i < 10) ? "@" : " ", NULL, 1));
+    }
+
+    extra_info = hashtable_new (32,
+                                WEECHAT_HASHTABLE_STRING,
+                                WEECHAT_HASHTABLE_STRING,
+                                NULL, NULL);
+    CHECK(extra_info);
+
+    POINTERS_EQUAL(NULL,
+                   gui_bar_item_buffer_nicklist_cb (NULL, NULL, NULL, NULL,
+                                                    NULL, NULL));
+
+    /* all lines */
+    str = gui_bar_item_buffer_nicklist_cb (NULL, NULL, NULL, NULL,
+                                           buffer, NULL);
+    CHECK(str);
+    LONGS_EQUAL(100, gui_bar_item_count_lines (str));
+    CHECK(strncmp (str, "@nick000\n@nick001\n", 18) == 0);
+    free (str);
+
+    /* only lines displayed */
+    hashtable_set (extra_info, "_lines_start", "9");
+    hashtable_set (extra_info, "_lines_count", "3");
+    str = gui_bar_item_buffer_nicklist_cb (NULL, NULL, NULL, NULL,
+                                           buffer, extra_info);
+    STRCMP_EQUAL("@nick009\n nick010\n nick011", str);
+    free (str);
+    STRCMP_EQUAL("100", (const char *)hashtable_get (extra_info,
+                                                     "_lines_total"));
+    STRCMP_EQUAL("9", (const char *)hashtable_get (extra_info,
+                                                   "_lines_start"));
+    STRCMP_EQUAL("8", (const char *)hashtable_get (extra_info,
+                                                   "_lines_max_length"));
+
+    /* lines after the end of nicklist */
+    hashtable_remove_all (extra_info);
+    hashtable_set (extra_info, "_lines_start", "1000");
+    hashtable_set (extra_info, "_lines_count", "3");
+    str = gui_bar_item_buffer_nicklist_cb (NULL, NULL, NULL, NULL,
+                                           buffer, extra_info);
+    STRCMP_EQUAL("", str);
+    free (str);
+    STRCMP_EQUAL("100", (const char *)hashtable_get (extra_info,
+                                                     "_lines_total"));
+
+    hashtable_free (extra_info);
+
+    gui_buffer_close (buffer);
 }
 
 /*
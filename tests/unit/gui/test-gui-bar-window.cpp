@@ -24,6 +24,8 @@
 extern "C"
 {
 #include <string.h>
+#include "src/core/core-config-file.h"
+#include "src/gui/gui-bar.h"
 #include "src/gui/gui-bar-window.h"
 #include "src/gui/gui-color.h"
 #include "src/gui/gui-window.h"
@@ -150,6 +152,77 @@ TEST(GuiBarWindow, ContentGet)
     /* TODO: write tests */
 }
 
+/*
+ * Tests functions:
+ *   gui_bar_window_can_limit_lines
+ */
+
+TEST(GuiBarWindow, CanLimitLines)
+{
+    struct t_gui_bar *bar;
+    struct t_gui_bar_window *bar_window;
+
+    LONGS_EQUAL(0, gui_bar_window_can_limit_lines (NULL));
+
+    bar = gui_bar_search ("title");
+    CHECK(bar);
+    bar_window = gui_bar_window_search_bar (gui_windows, bar);
+    CHECK(bar_window);
+    LONGS_EQUAL(0, gui_bar_window_can_limit_lines (bar_window));
+
+    bar = gui_bar_search ("status");
+    CHECK(bar);
+    bar_window = gui_bar_window_search_bar (gui_windows, bar);
+    CHECK(bar_window);
+    LONGS_EQUAL(0, gui_bar_window_can_limit_lines (bar_window));
+
+    bar = gui_bar_new ("test", "off", "0", "root", "", "right",
+                       "horizontal", "vertical", "0", "0",
+                       "default", "default", "default", "default",
+                       "off", "buffer_nicklist");
+    CHECK(bar);
+    CHECK(bar->bar_window);
+    LONGS_EQUAL(0, gui_bar_window_can_limit_lines (bar->bar_window));
+    /* no screen in tests: the bar window has a null size */
+    bar->bar_window->height = 10;
+    LONGS_EQUAL(1, gui_bar_window_can_limit_lines (bar->bar_window));
+    config_file_option_set (bar->options[GUI_BAR_OPTION_FILLING_LEFT_RIGHT],
+                            "columns_vertical", 1);
+    LONGS_EQUAL(0, gui_bar_window_can_limit_lines (bar->bar_window));
+    config_file_option_set (bar->options[GUI_BAR_OPTION_FILLING_LEFT_RIGHT],
+                            "vertical", 1);
+    config_file_option_set (bar->options[GUI_BAR_OPTION_ITEMS],
+                            "[buffer_nicklist]", 1);
+    LONGS_EQUAL(0, gui_bar_window_can_limit_lines (bar->bar_window));
+    config_file_option_set (bar->options[GUI_BAR_OPTION_ITEMS],
+                            "buffer_nicklist,time", 1);
+    LONGS_EQUAL(0, gui_bar_window_can_limit_lines (bar->bar_window));
+    config_file_option_set (bar->options[GUI_BAR_OPTION_ITEMS],
+                            "buffer_nicklist", 1);
+    config_file_option_set (bar->options[GUI_BAR_OPTION_POSITION],
+                            "top", 1);
+    config_file_option_set (bar->options[GUI_BAR_OPTION_FILLING_TOP_BOTTOM],
+                            "vertical", 1);
+    LONGS_EQUAL(0, gui_bar_window_can_limit_lines (bar->bar_window));
+    config_file_option_set (bar->options[GUI_BAR_OPTION_SIZE], "1", 1);
+    bar->bar_window->height = 1;
+    LONGS_EQUAL(1, gui_bar_window_can_limit_lines (bar->bar_window));
+    gui_bar_free (bar);
+}
+
+/*
+ * Tests functions:
+ *   gui_bar_window_search_window
+ */
+
+TEST(GuiBarWindow, SearchWindow)
+{
+    POINTERS_EQUAL(NULL, gui_bar_window_search_window (NULL));
+
+    POINTERS_EQUAL(gui_windows,
+                   gui_bar_window_search_window (gui_windows->bar_windows));
+}
+
 /*
  * Tests functions:
  *   gui_bar_window_item_is_spacer
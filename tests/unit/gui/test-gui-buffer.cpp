@@ -21,8 +21,11 @@
 
 #include "CppUTest/TestHarness.h"
 
+#include "tests/tests.h"
+
 extern "C"
 {
+#include <stdio.h>
 #include <string.h>
 #include "src/core/core-config.h"
 #include "src/core/core-hashtable.h"
@@ -30,6 +33,8 @@ extern "C"
 #include "src/core/core-input.h"
 #include "src/core/core-list.h"
 #include "src/gui/gui-buffer.h"
+#include "src/gui/gui-chat.h"
+#include "src/gui/gui-hotlist.h"
 #include "src/gui/gui-key.h"
 #include "src/gui/gui-line.h"
 #include "src/gui/gui-nicklist.h"
@@ -46,6 +51,7 @@ extern void gui_buffer_set_short_name (struct t_gui_buffer *buffer,
                                        const char *short_name);
 extern void gui_buffer_set_highlight_words_list (struct t_gui_buffer *buffer,
                                                  struct t_weelist *list);
+extern int gui_buffer_signals_delayed_count;
 
 }
 
@@ -53,9 +59,32 @@ extern void gui_buffer_set_highlight_words_list (struct t_gui_buffer *buffer,
 
 char signal_buffer_user_input[256];
 int signal_buffer_user_closing = 0;
+int signal_buffer_localvar_added = 0;
+int signal_buffer_title_changed = 0;
+int signal_buffer_properties_changed = 0;
 
 TEST_GROUP(GuiBuffer)
 {
+    static int signal_buffer_count_cb (const void *pointer, void *data,
+                                       const char *signal,
+                                       const char *type_data,
+                                       void *signal_data)
+    {
+        /* make C++ compiler happy */
+        (void) pointer;
+        (void) data;
+        (void) type_data;
+        (void) signal_data;
+
+        if (strcmp (signal, "buffer_localvar_added") == 0)
+            signal_buffer_localvar_added++;
+        else if (strcmp (signal, "buffer_title_changed") == 0)
+            signal_buffer_title_changed++;
+        else if (strcmp (signal, "buffer_properties_changed") == 0)
+            signal_buffer_properties_changed++;
+        return WEECHAT_RC_OK;
+    }
+
     static int signal_buffer_user_input_cb (const void *pointer, void *data,
                                             const char *signal,
                                             const char *type_data,
@@ -229,6 +258,7 @@ TEST(GuiBuffer, BuildFullName)
 
 /*
  * Tests functions:
+ *   gui_buffer_local_var_get_size
  *   gui_buffer_local_var_add
  *   gui_buffer_local_var_remove
  *   gui_buffer_local_var_remove_all
@@ -237,6 +267,7 @@ TEST(GuiBuffer, BuildFullName)
 TEST(GuiBuffer, LocalVarAddRemove)
 {
     struct t_gui_buffer *buffer;
+    int size;
 
     buffer = gui_buffer_new (NULL, TEST_BUFFER_NAME,
                              NULL, NULL, NULL,
@@ -247,6 +278,9 @@ TEST(GuiBuffer, LocalVarAddRemove)
 
     STRCMP_EQUAL("plugin:core,name:" TEST_BUFFER_NAME,
                  hashtable_get_string (buffer->local_variables, "keys_values"));
+    size = gui_buffer_local_var_get_size ("plugin", "core")
+        + gui_buffer_local_var_get_size ("name", TEST_BUFFER_NAME);
+    LONGS_EQUAL(size, buffer->local_variables_size);
 
     gui_buffer_local_var_add (buffer, NULL, NULL);
     STRCMP_EQUAL("plugin:core,name:" TEST_BUFFER_NAME,
@@ -259,6 +293,13 @@ TEST(GuiBuffer, LocalVarAddRemove)
     gui_buffer_local_var_add (buffer, "test_var", "value");
     STRCMP_EQUAL("plugin:core,name:" TEST_BUFFER_NAME ",test_var:value",
                  hashtable_get_string (buffer->local_variables, "keys_values"));
+    LONGS_EQUAL(size + gui_buffer_local_var_get_size ("test_var", "value"),
+                buffer->local_variables_size);
+
+    gui_buffer_local_var_add (buffer, "test_var", "value2");
+    LONGS_EQUAL(size + gui_buffer_local_var_get_size ("test_var", "value2"),
+                buffer->local_variables_size);
+    gui_buffer_local_var_add (buffer, "test_var", "value");
 
     gui_buffer_local_var_remove (buffer, "no_such_var");
     STRCMP_EQUAL("plugin:core,name:" TEST_BUFFER_NAME ",test_var:value",
@@ -267,12 +308,42 @@ TEST(GuiBuffer, LocalVarAddRemove)
     gui_buffer_local_var_remove (buffer, "test_var");
     STRCMP_EQUAL("plugin:core,name:" TEST_BUFFER_NAME,
                  hashtable_get_string (buffer->local_variables, "keys_values"));
+    LONGS_EQUAL(size, buffer->local_variables_size);
 
     gui_buffer_local_var_remove_all (NULL);
 
     gui_buffer_local_var_remove_all (buffer);
     POINTERS_EQUAL(NULL,
                    hashtable_get_string (buffer->local_variables, "keys_values"));
+    LONGS_EQUAL(0, buffer->local_variables_size);
+
+    gui_buffer_close (buffer);
+}
+
+/*
+ * Tests functions:
+ *   gui_buffer_get_memory_size
+ */
+
+TEST(GuiBuffer, GetMemorySize)
+{
+    struct t_gui_buffer *buffer;
+
+    LONGS_EQUAL(0, gui_buffer_get_memory_size (NULL));
+
+    buffer = gui_buffer_new (NULL, TEST_BUFFER_NAME,
+                             NULL, NULL, NULL,
+                             NULL, NULL, NULL);
+    CHECK(buffer);
+
+    LONGS_EQUAL(buffer->nicklist_size + buffer->local_variables_size,
+                gui_buffer_get_memory_size (buffer));
+
+    gui_chat_printf (buffer, "test");
+    CHECK(buffer->own_lines->lines_size > 0);
+    LONGS_EQUAL(buffer->own_lines->lines_size + buffer->nicklist_size
+                + buffer->local_variables_size,
+                gui_buffer_get_memory_size (buffer));
 
     gui_buffer_close (buffer);
 }
@@ -801,12 +872,79 @@ TEST(GuiBuffer, Valid)
 
 /*
  * Tests functions:
+ *   gui_buffer_string_replace_local_var_cached
  *   gui_buffer_string_replace_local_var
  */
 
 TEST(GuiBuffer, StringReplaceLocalVar)
 {
-    /* TODO: write tests */
+    struct t_gui_buffer *buffer;
+    const char *ptr_str;
+    char *str, string[64];
+    int i;
+
+    buffer = gui_buffer_new (NULL, TEST_BUFFER_NAME,
+                             NULL, NULL, NULL,
+                             NULL, NULL, NULL);
+    CHECK(buffer);
+
+    POINTERS_EQUAL(NULL, gui_buffer_string_replace_local_var (NULL, NULL));
+    POINTERS_EQUAL(NULL, gui_buffer_string_replace_local_var (buffer, NULL));
+    POINTERS_EQUAL(NULL, gui_buffer_string_replace_local_var (NULL, "test"));
+    POINTERS_EQUAL(NULL,
+                   gui_buffer_string_replace_local_var_cached (NULL, "test"));
+
+    WEE_TEST_STR("", gui_buffer_string_replace_local_var (buffer, ""));
+    WEE_TEST_STR("test", gui_buffer_string_replace_local_var (buffer, "test"));
+    WEE_TEST_STR("test " TEST_BUFFER_NAME " core",
+                 gui_buffer_string_replace_local_var (buffer,
+                                                      "test $name $plugin"));
+    WEE_TEST_STR("$xxx", gui_buffer_string_replace_local_var (buffer, "$xxx"));
+
+    /* string without "$": the string itself is returned */
+    ptr_str = "test";
+    POINTERS_EQUAL(ptr_str,
+                   gui_buffer_string_replace_local_var_cached (buffer, ptr_str));
+    POINTERS_EQUAL(NULL, hashtable_get (buffer->local_var_cache, "test"));
+
+    /* result is saved in cache */
+    ptr_str = gui_buffer_string_replace_local_var_cached (buffer, "$name");
+    STRCMP_EQUAL(TEST_BUFFER_NAME, ptr_str);
+    POINTERS_EQUAL(ptr_str, hashtable_get (buffer->local_var_cache, "$name"));
+    POINTERS_EQUAL(ptr_str,
+                   gui_buffer_string_replace_local_var_cached (buffer, "$name"));
+
+    /* cache is cleared when local variables are changed */
+    gui_buffer_local_var_add (buffer, "testvar", "value");
+    POINTERS_EQUAL(NULL, hashtable_get (buffer->local_var_cache, "$name"));
+    STRCMP_EQUAL("value",
+                 gui_buffer_string_replace_local_var_cached (buffer,
+                                                             "$testvar"));
+    gui_buffer_local_var_add (buffer, "testvar", "value2");
+    STRCMP_EQUAL("value2",
+                 gui_buffer_string_replace_local_var_cached (buffer,
+                                                             "$testvar"));
+    gui_buffer_local_var_remove (buffer, "testvar");
+    STRCMP_EQUAL("$testvar",
+                 gui_buffer_string_replace_local_var_cached (buffer,
+                                                             "$testvar"));
+
+    /* cache has a max size */
+    for (i = 0; i < GUI_BUFFER_LOCAL_VAR_CACHE_MAX * 2; i++)
+    {
+        snprintf (string, sizeof (string), "$name/%d", i);
+        CHECK(gui_buffer_string_replace_local_var_cached (buffer, string));
+        CHECK(buffer->local_var_cache->items_count
+              <= GUI_BUFFER_LOCAL_VAR_CACHE_MAX);
+    }
+
+    gui_buffer_local_var_remove_all (buffer);
+    LONGS_EQUAL(0, buffer->local_var_cache->items_count);
+    str = gui_buffer_string_replace_local_var (buffer, "$name");
+    STRCMP_EQUAL("$name", str);
+    free (str);
+
+    gui_buffer_close (buffer);
 }
 
 /*
@@ -959,12 +1097,51 @@ TEST(GuiBuffer, GetPointer)
 
 /*
  * Tests functions:
+ *   gui_buffer_ask_chat_refresh_lines_added
  *   gui_buffer_ask_chat_refresh
  */
 
 TEST(GuiBuffer, AskChatRefresh)
 {
-    /* TODO: write tests */
+    struct t_gui_buffer *buffer;
+
+    gui_buffer_ask_chat_refresh_lines_added (NULL);
+    gui_buffer_ask_chat_refresh (NULL, 1);
+
+    buffer = gui_buffer_new_user (TEST_BUFFER_NAME, GUI_BUFFER_TYPE_FORMATTED);
+    CHECK(buffer);
+
+    buffer->chat_refresh_needed = 0;
+    buffer->chat_refresh_lines_added = 0;
+
+    /* only lines added */
+    gui_buffer_ask_chat_refresh_lines_added (buffer);
+    LONGS_EQUAL(1, buffer->chat_refresh_needed);
+    LONGS_EQUAL(1, buffer->chat_refresh_lines_added);
+    gui_buffer_ask_chat_refresh_lines_added (buffer);
+    LONGS_EQUAL(1, buffer->chat_refresh_needed);
+    LONGS_EQUAL(1, buffer->chat_refresh_lines_added);
+
+    /* refresh of chat asked: all lines must be displayed */
+    gui_buffer_ask_chat_refresh (buffer, 1);
+    LONGS_EQUAL(1, buffer->chat_refresh_needed);
+    LONGS_EQUAL(0, buffer->chat_refresh_lines_added);
+    gui_buffer_ask_chat_refresh_lines_added (buffer);
+    LONGS_EQUAL(1, buffer->chat_refresh_needed);
+    LONGS_EQUAL(0, buffer->chat_refresh_lines_added);
+    gui_buffer_ask_chat_refresh (buffer, 2);
+    LONGS_EQUAL(2, buffer->chat_refresh_needed);
+    LONGS_EQUAL(0, buffer->chat_refresh_lines_added);
+    gui_buffer_ask_chat_refresh (buffer, 1);
+    LONGS_EQUAL(2, buffer->chat_refresh_needed);
+
+    /* new line printed */
+    buffer->chat_refresh_needed = 0;
+    gui_chat_printf_date_tags (buffer, 0, NULL, "test");
+    LONGS_EQUAL(1, buffer->chat_refresh_needed);
+    LONGS_EQUAL(1, buffer->chat_refresh_lines_added);
+
+    gui_buffer_close (buffer);
 }
 
 /*
@@ -1306,7 +1483,45 @@ TEST(GuiBuffer, SetUnread)
 
 TEST(GuiBuffer, Set)
 {
-    /* TODO: write tests */
+    struct t_gui_buffer *buffer;
+
+    buffer = gui_buffer_new_user (TEST_BUFFER_NAME, GUI_BUFFER_TYPE_FORMATTED);
+    CHECK(buffer);
+
+    /* hotlist */
+    gui_buffer_set (buffer, "hotlist", "1");
+    CHECK(buffer->hotlist);
+    LONGS_EQUAL(GUI_HOTLIST_MESSAGE, buffer->hotlist->priority);
+    LONGS_EQUAL(1, buffer->hotlist->count[GUI_HOTLIST_MESSAGE]);
+    gui_buffer_set (buffer, "hotlist", "1,5");
+    LONGS_EQUAL(6, buffer->hotlist->count[GUI_HOTLIST_MESSAGE]);
+    gui_buffer_set (buffer, "hotlist", "0,3");
+    LONGS_EQUAL(GUI_HOTLIST_MESSAGE, buffer->hotlist->priority);
+    LONGS_EQUAL(3, buffer->hotlist->count[GUI_HOTLIST_LOW]);
+    gui_buffer_set (buffer, "hotlist", "2,2");
+    LONGS_EQUAL(GUI_HOTLIST_PRIVATE, buffer->hotlist->priority);
+    LONGS_EQUAL(3, buffer->hotlist->count[GUI_HOTLIST_LOW]);
+    LONGS_EQUAL(6, buffer->hotlist->count[GUI_HOTLIST_MESSAGE]);
+    LONGS_EQUAL(2, buffer->hotlist->count[GUI_HOTLIST_PRIVATE]);
+    LONGS_EQUAL(0, buffer->hotlist->count[GUI_HOTLIST_HIGHLIGHT]);
+    gui_buffer_set (buffer, "hotlist", "2,0");
+    gui_buffer_set (buffer, "hotlist", "2,-1");
+    gui_buffer_set (buffer, "hotlist", "2,");
+    gui_buffer_set (buffer, "hotlist", ",2");
+    gui_buffer_set (buffer, "hotlist", "2,2x");
+    LONGS_EQUAL(2, buffer->hotlist->count[GUI_HOTLIST_PRIVATE]);
+    gui_buffer_set (buffer, "hotlist", "-1");
+    POINTERS_EQUAL(NULL, buffer->hotlist);
+    gui_buffer_set (buffer, "hotlist", "-");
+    gui_buffer_set (buffer, "hotlist", "1,5");
+    POINTERS_EQUAL(NULL, buffer->hotlist);
+    gui_buffer_set (buffer, "hotlist", "+");
+    gui_buffer_set (buffer, "hotlist", "3,4");
+    CHECK(buffer->hotlist);
+    LONGS_EQUAL(GUI_HOTLIST_HIGHLIGHT, buffer->hotlist->priority);
+    LONGS_EQUAL(4, buffer->hotlist->count[GUI_HOTLIST_HIGHLIGHT]);
+
+    gui_buffer_close (buffer);
 }
 
 /*
@@ -1319,6 +1534,66 @@ TEST(GuiBuffer, SetPointer)
     /* TODO: write tests */
 }
 
+/*
+ * Tests functions:
+ *   gui_buffer_signal_delay
+ *   gui_buffer_set_multiple
+ */
+
+TEST(GuiBuffer, SetMultiple)
+{
+    struct t_gui_buffer *buffer;
+    struct t_hashtable *properties;
+    struct t_hook *hook;
+
+    buffer = gui_buffer_new_user (TEST_BUFFER_NAME, GUI_BUFFER_TYPE_DEFAULT);
+    CHECK(buffer);
+
+    properties = hashtable_new (32,
+                                WEECHAT_HASHTABLE_STRING,
+                                WEECHAT_HASHTABLE_STRING,
+                                NULL, NULL);
+    CHECK(properties);
+
+    hook = hook_signal (NULL, "buffer_*", &signal_buffer_count_cb, NULL, NULL);
+
+    signal_buffer_localvar_added = 0;
+    signal_buffer_title_changed = 0;
+    signal_buffer_properties_changed = 0;
+
+    /* no properties: nothing changed */
+    gui_buffer_set_multiple (buffer, NULL);
+    gui_buffer_set_multiple (buffer, properties);
+    LONGS_EQUAL(0, signal_buffer_properties_changed);
+
+    hashtable_set (properties, "title", "test title");
+    hashtable_set (properties, "localvar_set_var1", "value1");
+    hashtable_set (properties, "localvar_set_var2", "value2");
+    hashtable_set (properties, "localvar_set_var3", "value3");
+    gui_buffer_set_multiple (buffer, properties);
+    STRCMP_EQUAL("test title", buffer->title);
+    STRCMP_EQUAL("value1",
+                 (const char *)hashtable_get (buffer->local_variables, "var1"));
+    STRCMP_EQUAL("value3",
+                 (const char *)hashtable_get (buffer->local_variables, "var3"));
+
+    /* each signal is sent only once */
+    LONGS_EQUAL(1, signal_buffer_localvar_added);
+    LONGS_EQUAL(1, signal_buffer_title_changed);
+    LONGS_EQUAL(1, signal_buffer_properties_changed);
+    LONGS_EQUAL(0, gui_buffer_signals_delayed_count);
+
+    /* signals are sent immediately with gui_buffer_set */
+    gui_buffer_set (buffer, "localvar_set_var4", "value4");
+    gui_buffer_set (buffer, "localvar_set_var5", "value5");
+    LONGS_EQUAL(3, signal_buffer_localvar_added);
+    LONGS_EQUAL(1, signal_buffer_properties_changed);
+
+    unhook (hook);
+    hashtable_free (properties);
+    gui_buffer_close (buffer);
+}
+
 /*
  * Tests functions:
  *   gui_buffer_compute_num_displayed
@@ -1413,6 +1688,8 @@ TEST(GuiBuffer, SearchById)
 
 /*
  * Tests functions:
+ *   gui_buffer_full_name_index_add
+ *   gui_buffer_full_name_index_remove
  *   gui_buffer_search_by_full_name
  */
 
@@ -1439,11 +1716,22 @@ TEST(GuiBuffer, SearchByFullName)
     POINTERS_EQUAL(NULL, gui_buffer_search_by_full_name ("CORE." TEST_BUFFER_NAME));
     POINTERS_EQUAL(buffer, gui_buffer_search_by_full_name ("(?i)CORE." TEST_BUFFER_NAME));
 
+    /* rename buffer */
+    gui_buffer_set (buffer, "name", TEST_BUFFER_NAME "2");
+    POINTERS_EQUAL(NULL, gui_buffer_search_by_full_name ("core." TEST_BUFFER_NAME));
+    POINTERS_EQUAL(NULL, gui_buffer_search_by_full_name ("(?i)CORE." TEST_BUFFER_NAME));
+    POINTERS_EQUAL(buffer, gui_buffer_search_by_full_name ("core." TEST_BUFFER_NAME "2"));
+    POINTERS_EQUAL(buffer, gui_buffer_search_by_full_name ("(?i)CORE." TEST_BUFFER_NAME "2"));
+
     gui_buffer_close (buffer);
+    POINTERS_EQUAL(NULL, gui_buffer_search_by_full_name ("core." TEST_BUFFER_NAME "2"));
+    POINTERS_EQUAL(NULL, gui_buffer_search_by_full_name ("(?i)CORE." TEST_BUFFER_NAME "2"));
+    POINTERS_EQUAL(gui_buffers, gui_buffer_search_by_full_name ("core.weechat"));
 }
 
 /*
  * Tests functions:
+ *   gui_buffer_match_plugin_name
  *   gui_buffer_search
  */
 
@@ -1542,7 +1830,7 @@ TEST(GuiBuffer, SearchByPartialName)
 
 TEST(GuiBuffer, SearchByNumber)
 {
-    struct t_gui_buffer *buffer;
+    struct t_gui_buffer *buffer, *buffer2;
 
     buffer = gui_buffer_new (NULL, TEST_BUFFER_NAME,
                              NULL, NULL, NULL,
@@ -1556,6 +1844,29 @@ TEST(GuiBuffer, SearchByNumber)
     POINTERS_EQUAL(gui_buffers, gui_buffer_search_by_number (1));
     POINTERS_EQUAL(buffer, gui_buffer_search_by_number (2));
 
+    buffer2 = gui_buffer_new (NULL, TEST_BUFFER_NAME "2",
+                              NULL, NULL, NULL,
+                              NULL, NULL, NULL);
+    CHECK(buffer2);
+    POINTERS_EQUAL(buffer2, gui_buffer_search_by_number (3));
+
+    /* search after a move */
+    gui_buffer_move_to_number (buffer2, 1);
+    POINTERS_EQUAL(buffer2, gui_buffer_search_by_number (1));
+    POINTERS_EQUAL(buffer, gui_buffer_search_by_number (3));
+
+    /* search with a gap in numbers */
+    config_file_option_set (config_look_buffer_auto_renumber, "off", 1);
+    gui_buffer_move_to_number (buffer2, 10);
+    LONGS_EQUAL(10, buffer2->number);
+    POINTERS_EQUAL(NULL, gui_buffer_search_by_number (1));
+    POINTERS_EQUAL(buffer, gui_buffer_search_by_number (3));
+    POINTERS_EQUAL(NULL, gui_buffer_search_by_number (9));
+    POINTERS_EQUAL(buffer2, gui_buffer_search_by_number (10));
+    POINTERS_EQUAL(NULL, gui_buffer_search_by_number (11));
+    config_file_option_reset (config_look_buffer_auto_renumber, 1);
+
+    gui_buffer_close (buffer2);
     gui_buffer_close (buffer);
 }
 
@@ -1835,6 +2146,102 @@ TEST(GuiBuffer, Swap)
     /* TODO: write tests */
 }
 
+/*
+ * Tests functions:
+ *   gui_buffer_reorder
+ */
+
+TEST(GuiBuffer, Reorder)
+{
+    struct t_gui_buffer *buffer1, *buffer2, *buffer3, *buffers[4];
+
+    LONGS_EQUAL(0, gui_buffer_reorder (NULL, 0));
+    LONGS_EQUAL(0, gui_buffer_reorder (buffers, -1));
+
+    buffer1 = gui_buffer_new (NULL, TEST_BUFFER_NAME "1",
+                              NULL, NULL, NULL,
+                              NULL, NULL, NULL);
+    CHECK(buffer1);
+    buffer2 = gui_buffer_new (NULL, TEST_BUFFER_NAME "2",
+                              NULL, NULL, NULL,
+                              NULL, NULL, NULL);
+    CHECK(buffer2);
+    buffer3 = gui_buffer_new (NULL, TEST_BUFFER_NAME "3",
+                              NULL, NULL, NULL,
+                              NULL, NULL, NULL);
+    CHECK(buffer3);
+
+    /* same order: nothing changed */
+    buffers[0] = gui_buffers;
+    buffers[1] = buffer1;
+    LONGS_EQUAL(1, gui_buffer_reorder (buffers, 2));
+    POINTERS_EQUAL(buffer1, gui_buffers->next_buffer);
+    POINTERS_EQUAL(buffer3, last_gui_buffer);
+
+    /* buffer3, then buffer1, then other buffers */
+    buffers[0] = buffer3;
+    buffers[1] = NULL;
+    buffers[2] = buffer1;
+    buffers[3] = buffer3;
+    LONGS_EQUAL(1, gui_buffer_reorder (buffers, 4));
+    POINTERS_EQUAL(buffer3, gui_buffers);
+    POINTERS_EQUAL(NULL, buffer3->prev_buffer);
+    POINTERS_EQUAL(buffer1, buffer3->next_buffer);
+    POINTERS_EQUAL(buffer3, buffer1->prev_buffer);
+    STRCMP_EQUAL(GUI_BUFFER_MAIN, buffer1->next_buffer->name);
+    POINTERS_EQUAL(buffer2, buffer1->next_buffer->next_buffer);
+    POINTERS_EQUAL(buffer2, last_gui_buffer);
+    POINTERS_EQUAL(NULL, buffer2->next_buffer);
+    LONGS_EQUAL(1, buffer3->number);
+    LONGS_EQUAL(2, buffer1->number);
+    LONGS_EQUAL(3, buffer1->next_buffer->number);
+    LONGS_EQUAL(4, buffer2->number);
+    POINTERS_EQUAL(buffer3, gui_buffer_search_by_number (1));
+    POINTERS_EQUAL(buffer2, gui_buffer_search_by_number (4));
+
+    /* numbers are kept (gaps remain at same place) */
+    config_file_option_set (config_look_buffer_auto_renumber, "off", 1);
+    gui_buffer_move_to_number (buffer2, 10);
+    buffers[0] = buffer2;
+    LONGS_EQUAL(1, gui_buffer_reorder (buffers, 1));
+    POINTERS_EQUAL(buffer2, gui_buffers);
+    LONGS_EQUAL(1, buffer2->number);
+    LONGS_EQUAL(2, buffer3->number);
+    LONGS_EQUAL(3, buffer1->number);
+    STRCMP_EQUAL(GUI_BUFFER_MAIN, last_gui_buffer->name);
+    LONGS_EQUAL(10, last_gui_buffer->number);
+    POINTERS_EQUAL(buffer1, gui_buffer_search_by_number (3));
+    POINTERS_EQUAL(NULL, gui_buffer_search_by_number (4));
+    POINTERS_EQUAL(NULL, gui_buffer_search_by_number (9));
+    POINTERS_EQUAL(last_gui_buffer, gui_buffer_search_by_number (10));
+    config_file_option_reset (config_look_buffer_auto_renumber, 1);
+    LONGS_EQUAL(4, last_gui_buffer->number);
+
+    /* merged buffers are moved together */
+    gui_buffer_merge (buffer3, buffer1);
+    LONGS_EQUAL(2, buffer3->number);
+    LONGS_EQUAL(2, gui_buffer_count_merged_buffers (2));
+    buffers[0] = buffer3;
+    LONGS_EQUAL(1, gui_buffer_reorder (buffers, 1));
+    LONGS_EQUAL(1, buffer1->number);
+    LONGS_EQUAL(1, buffer3->number);
+    LONGS_EQUAL(2, buffer2->number);
+    LONGS_EQUAL(3, last_gui_buffer->number);
+    LONGS_EQUAL(2, gui_buffer_count_merged_buffers (1));
+    POINTERS_EQUAL(NULL, gui_buffers->prev_buffer);
+    POINTERS_EQUAL(buffer2, gui_buffers->next_buffer->next_buffer);
+    POINTERS_EQUAL(buffer2, last_gui_buffer->prev_buffer);
+    POINTERS_EQUAL(buffer2, gui_buffer_search_by_number (2));
+
+    gui_buffer_close (buffer1);
+    gui_buffer_close (buffer2);
+    gui_buffer_close (buffer3);
+
+    /* restore main buffer as first buffer */
+    STRCMP_EQUAL(GUI_BUFFER_MAIN, gui_buffers->name);
+    LONGS_EQUAL(1, gui_buffers->number);
+}
+
 /*
  * Tests functions:
  *   gui_buffer_merge
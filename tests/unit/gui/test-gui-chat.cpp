@@ -27,8 +27,22 @@ extern "C"
 #include "src/gui/gui-buffer.h"
 #include "src/gui/gui-chat.h"
 #include "src/gui/gui-color.h"
+#include "src/gui/gui-hotlist.h"
 #include "src/gui/gui-line.h"
 #include "src/gui/gui-window.h"
+#include "src/core/core-hashtable.h"
+#include "src/core/core-hook.h"
+#include "src/plugins/weechat-plugin.h"
+#include "src/gui/curses/gui-curses.h"
+#include "src/gui/curses/gui-curses-chat.h"
+#include "src/gui/curses/gui-curses-window.h"
+
+extern int gui_chat_display_line (struct t_gui_window *window,
+                                  struct t_gui_line *line,
+                                  int count, int simulate);
+extern char *gui_chat_format_buffer;
+extern int gui_chat_format_buffer_size;
+extern int gui_chat_format_buffer_used;
 }
 
 #define WEE_GET_WORD_INFO(__result_word_start_offset,                   \
@@ -50,6 +64,21 @@ extern "C"
 
 TEST_GROUP(GuiChat)
 {
+    /*
+     * Formats a message with gui_chat_vformat (used in tests).
+     */
+
+    static char *format (const char *fmt, ...)
+    {
+        va_list args;
+        char *result;
+
+        va_start (args, fmt);
+        result = gui_chat_vformat (fmt, args);
+        va_end (args);
+
+        return result;
+    }
 };
 
 /*
@@ -142,6 +171,12 @@ TEST(GuiChat, StrlenScreen)
     snprintf (string, sizeof (string),
               "a" "\u00ad" "%s" "\u200b" "b", gui_color_get_custom ("red"));
     LONGS_EQUAL(2, gui_chat_strlen_screen (string));
+
+    /* ASCII + color + digits + "é" + color + ASCII */
+    snprintf (string, sizeof (string),
+              "abc%s12" "\u00e9" "%sde", gui_color_get_custom ("214"),
+              gui_color_get_custom ("reset"));
+    LONGS_EQUAL(8, gui_chat_strlen_screen (string));
 }
 
 /*
@@ -426,6 +461,53 @@ TEST(GuiChat, PrintLinesWaitingBuffer)
     /* TODO: write tests */
 }
 
+/*
+ * Tests functions:
+ *   gui_chat_vformat
+ *   gui_chat_format_release
+ */
+
+TEST(GuiChat, Vformat)
+{
+    char *msg1, *msg2, *msg3, long_msg[2048];
+
+    memset (long_msg, 'a', sizeof (long_msg) - 1);
+    long_msg[sizeof (long_msg) - 1] = '\0';
+
+    /* format in the reused buffer */
+    msg1 = format ("test %d %s", 123, "abc");
+    STRCMP_EQUAL("test 123 abc", msg1);
+    POINTERS_EQUAL(gui_chat_format_buffer, msg1);
+    LONGS_EQUAL(1, gui_chat_format_buffer_used);
+
+    /* nested call: allocated buffer */
+    msg2 = format ("nested %s", "call");
+    STRCMP_EQUAL("nested call", msg2);
+    CHECK(msg2 != gui_chat_format_buffer);
+    gui_chat_format_release (msg2);
+    LONGS_EQUAL(1, gui_chat_format_buffer_used);
+    STRCMP_EQUAL("test 123 abc", msg1);
+
+    gui_chat_format_release (msg1);
+    LONGS_EQUAL(0, gui_chat_format_buffer_used);
+
+    /* buffer is reused */
+    msg1 = format ("%s", "again");
+    POINTERS_EQUAL(gui_chat_format_buffer, msg1);
+    STRCMP_EQUAL("again", msg1);
+    gui_chat_format_release (msg1);
+
+    /* long message: the reused buffer grows */
+    msg3 = format ("%s", long_msg);
+    STRCMP_EQUAL(long_msg, msg3);
+    POINTERS_EQUAL(gui_chat_format_buffer, msg3);
+    CHECK(gui_chat_format_buffer_size >= (int)sizeof (long_msg));
+    gui_chat_format_release (msg3);
+    LONGS_EQUAL(0, gui_chat_format_buffer_used);
+
+    gui_chat_format_release (NULL);
+}
+
 /*
  * Tests functions:
  *   gui_chat_printf_datetime_tags_internal
@@ -660,6 +742,108 @@ TEST(GuiChat, PrintDatetimeTags)
     STRCMP_EQUAL("this is a test", ptr_data->message);
 }
 
+/*
+ * Callback of signal "buffer_line_added" (used in tests).
+ */
+
+int
+test_gui_chat_line_added_cb (const void *pointer, void *data,
+                             const char *signal, const char *type_data,
+                             void *signal_data)
+{
+    struct t_gui_line *line;
+
+    /* make C compiler happy */
+    (void) data;
+    (void) signal;
+    (void) type_data;
+
+    line = (struct t_gui_line *)signal_data;
+    if (strcmp (line->data->message, "first") == 0)
+        (*((int *)pointer)) = 0;
+    (*((int *)pointer))++;
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Tests functions:
+ *   gui_chat_printf_lines_begin
+ *   gui_chat_line_in_batch
+ *   gui_chat_printf_lines_end
+ */
+
+TEST(GuiChat, PrintfLines)
+{
+    struct t_gui_buffer *buffer;
+    struct t_hook *hook;
+    int lines_added;
+
+    buffer = gui_buffer_new (NULL, "test", NULL, NULL, NULL, NULL, NULL, NULL);
+    CHECK(buffer);
+
+    lines_added = 0;
+    hook = hook_signal (NULL, "buffer_line_added",
+                        &test_gui_chat_line_added_cb, &lines_added, NULL);
+
+    /* end without begin */
+    gui_chat_printf_lines_end (buffer);
+    LONGS_EQUAL(0, buffer->lines_batch);
+
+    /* lines added without batch */
+    gui_chat_printf_datetime_tags (buffer, 0, 0, "notify_message", "first");
+    gui_chat_printf_datetime_tags (buffer, 0, 0, "notify_message", "second");
+    LONGS_EQUAL(2, lines_added);
+    CHECK(buffer->hotlist);
+    LONGS_EQUAL(2, buffer->hotlist->count[GUI_HOTLIST_MESSAGE]);
+    gui_hotlist_remove_buffer (buffer, 1);
+    POINTERS_EQUAL(NULL, buffer->hotlist);
+
+    /* nested batches */
+    lines_added = -1;
+    gui_chat_printf_lines_begin (buffer);
+    gui_chat_printf_lines_begin (buffer);
+    LONGS_EQUAL(2, buffer->lines_batch);
+    gui_chat_printf_datetime_tags (buffer, 0, 0, "notify_message", "first");
+    gui_chat_printf_datetime_tags (buffer, 0, 0, "notify_highlight", "2");
+    gui_chat_printf_datetime_tags (buffer, 0, 0, "notify_message", "3");
+    gui_chat_printf_datetime_tags (buffer, 0, 0, "notify_none", "4");
+    LONGS_EQUAL(-1, lines_added);
+    LONGS_EQUAL(4, buffer->lines_batch_count);
+    LONGS_EQUAL(2, buffer->lines_batch_hotlist[GUI_HOTLIST_MESSAGE]);
+    LONGS_EQUAL(1, buffer->lines_batch_hotlist[GUI_HOTLIST_HIGHLIGHT]);
+    CHECK(gui_chat_line_in_batch (buffer->own_lines->last_line));
+    CHECK(!gui_chat_line_in_batch (buffer->own_lines->first_line));
+    POINTERS_EQUAL(NULL, buffer->hotlist);
+    gui_chat_printf_lines_end (buffer);
+    LONGS_EQUAL(1, buffer->lines_batch);
+    LONGS_EQUAL(-1, lines_added);
+    POINTERS_EQUAL(NULL, buffer->hotlist);
+    gui_chat_printf_lines_end (buffer);
+    LONGS_EQUAL(0, buffer->lines_batch);
+    LONGS_EQUAL(4, lines_added);
+    LONGS_EQUAL(0, buffer->lines_batch_count);
+    CHECK(buffer->hotlist);
+    LONGS_EQUAL(GUI_HOTLIST_HIGHLIGHT, buffer->hotlist->priority);
+    LONGS_EQUAL(2, buffer->hotlist->count[GUI_HOTLIST_MESSAGE]);
+    LONGS_EQUAL(1, buffer->hotlist->count[GUI_HOTLIST_HIGHLIGHT]);
+    gui_hotlist_remove_buffer (buffer, 1);
+
+    /* lines of batch removed from buffer: signal for remaining lines */
+    lines_added = -1;
+    gui_chat_printf_lines_begin (buffer);
+    gui_chat_printf_datetime_tags (buffer, 0, 0, NULL, "first");
+    gui_chat_printf_datetime_tags (buffer, 0, 0, NULL, "2");
+    gui_chat_printf_datetime_tags (buffer, 0, 0, NULL, "3");
+    gui_line_free (buffer, buffer->own_lines->last_line->prev_line->prev_line);
+    gui_chat_printf_lines_end (buffer);
+    /* line "first" removed: the counter is not reset */
+    LONGS_EQUAL(1, lines_added);
+
+    unhook (hook);
+    gui_buffer_close (buffer);
+}
+
 /*
  * Tests functions:
  *   gui_chat_printf_y_datetime_tags
@@ -854,6 +1038,89 @@ TEST(GuiChat, HsignalQuoteLineCb)
     /* TODO: write tests */
 }
 
+/*
+ * Tests functions:
+ *   gui_chat_get_line_rows
+ *   gui_chat_layout_remove_line
+ *   gui_chat_layout_clear
+ */
+
+TEST(GuiChat, LineRows)
+{
+    struct t_gui_buffer *buffer, *old_buffer;
+    struct t_gui_line *ptr_line;
+    struct t_hashtable *ptr_cache;
+    char message[1024];
+    int i, rows, old_width, old_height;
+
+    old_buffer = gui_windows->buffer;
+    buffer = gui_buffer_new_user ("test", GUI_BUFFER_TYPE_FORMATTED);
+    CHECK(buffer);
+    gui_window_switch_to_buffer (gui_windows, buffer, 0);
+    old_width = gui_windows->win_chat_width;
+    old_height = gui_windows->win_chat_height;
+    gui_windows->win_chat_width = 80;
+    gui_windows->win_chat_height = 25;
+
+    message[0] = '\0';
+    for (i = 0; i < 100; i++)
+    {
+        strcat (message, "word ");
+    }
+    gui_chat_printf_date_tags (buffer, 0, NULL, "first line");
+    gui_chat_printf_date_tags (buffer, 0, NULL, "%s", message);
+    gui_chat_printf_date_tags (buffer, 0, NULL, "middle line");
+    gui_chat_printf_date_tags (buffer, 0, NULL, "last line");
+
+    ptr_cache = GUI_WINDOW_OBJECTS(gui_windows)->chat_layout;
+    CHECK(ptr_cache);
+    gui_chat_layout_clear (gui_windows);
+    LONGS_EQUAL(0, ptr_cache->items_count);
+
+    LONGS_EQUAL(0, gui_chat_get_line_rows (gui_windows, NULL));
+
+    /* first and last lines are not cached */
+    ptr_line = buffer->own_lines->first_line;
+    LONGS_EQUAL(1, gui_chat_get_line_rows (gui_windows, ptr_line));
+    LONGS_EQUAL(1, gui_chat_get_line_rows (gui_windows,
+                                           buffer->own_lines->last_line));
+    LONGS_EQUAL(0, ptr_cache->items_count);
+
+    /* long line: rows are cached */
+    ptr_line = ptr_line->next_line;
+    rows = gui_chat_display_line (gui_windows, ptr_line, 0, 1);
+    CHECK(rows > 1);
+    LONGS_EQUAL(rows, gui_chat_get_line_rows (gui_windows, ptr_line));
+    LONGS_EQUAL(1, ptr_cache->items_count);
+    LONGS_EQUAL(rows, gui_chat_get_line_rows (gui_windows, ptr_line));
+    LONGS_EQUAL(1, ptr_cache->items_count);
+
+    LONGS_EQUAL(1, gui_chat_get_line_rows (gui_windows,
+                                           ptr_line->next_line));
+    LONGS_EQUAL(2, ptr_cache->items_count);
+
+    /* remove a line from cache */
+    gui_chat_layout_remove_line (gui_windows, ptr_line);
+    LONGS_EQUAL(1, ptr_cache->items_count);
+    gui_chat_layout_remove_line (NULL, ptr_line);
+
+    /* clear cache */
+    gui_chat_layout_clear (gui_windows);
+    LONGS_EQUAL(0, ptr_cache->items_count);
+    gui_chat_layout_clear (NULL);
+
+    /* freed lines are removed from cache */
+    LONGS_EQUAL(rows, gui_chat_get_line_rows (gui_windows, ptr_line));
+    LONGS_EQUAL(1, ptr_cache->items_count);
+    gui_buffer_clear (buffer);
+    LONGS_EQUAL(0, ptr_cache->items_count);
+
+    gui_windows->win_chat_width = old_width;
+    gui_windows->win_chat_height = old_height;
+    gui_window_switch_to_buffer (gui_windows, old_buffer, 0);
+    gui_buffer_close (buffer);
+}
+
 /*
  * Tests functions:
  *   gui_chat_end
@@ -559,6 +559,59 @@ TEST(GuiColor, Decode)
     WEE_CHECK_DECODE("test_[color]option_weechat.color.chat_host", string, "[color]");
 }
 
+/*
+ * Tests functions:
+ *   gui_color_decode_dyn
+ *   gui_color_decode_buffer
+ */
+
+TEST(GuiColor, DecodeBuffer)
+{
+    char string[256], **buffer, **output;
+    const char *ptr_decoded;
+
+    buffer = NULL;
+
+    POINTERS_EQUAL(NULL, gui_color_decode_buffer (NULL, NULL));
+    POINTERS_EQUAL(NULL, gui_color_decode_buffer (NULL, &buffer));
+    POINTERS_EQUAL(NULL, gui_color_decode_buffer ("test", NULL));
+
+    /* no color codes: the string itself is returned, buffer not allocated */
+    snprintf (string, sizeof (string), "test string");
+    POINTERS_EQUAL(string, gui_color_decode_buffer (string, &buffer));
+    POINTERS_EQUAL(NULL, buffer);
+    POINTERS_EQUAL(string + 11, gui_color_decode_buffer (string + 11, &buffer));
+    POINTERS_EQUAL(NULL, buffer);
+
+    /* color codes: buffer is allocated */
+    snprintf (string, sizeof (string),
+              "%s" "test_" "%s" "yellow" "%s",
+              GUI_COLOR(GUI_COLOR_CHAT_HOST),
+              gui_color_get_custom ("yellow,blue"),
+              gui_color_get_custom ("reset"));
+    ptr_decoded = gui_color_decode_buffer (string, &buffer);
+    CHECK(buffer);
+    POINTERS_EQUAL(*buffer, ptr_decoded);
+    STRCMP_EQUAL("test_yellow", ptr_decoded);
+
+    /* buffer is reused */
+    snprintf (string, sizeof (string),
+              "ab" "%s" "c",
+              gui_color_get_custom ("bold"));
+    ptr_decoded = gui_color_decode_buffer (string, &buffer);
+    POINTERS_EQUAL(*buffer, ptr_decoded);
+    STRCMP_EQUAL("abc", ptr_decoded);
+
+    string_dyn_free (buffer, 1);
+
+    /* decode in an existing dynamic string */
+    output = string_dyn_alloc (64);
+    string_dyn_copy (output, "before|");
+    gui_color_decode_dyn (output, string, "[color]");
+    STRCMP_EQUAL("before|ab[color]c", *output);
+    string_dyn_free (output, 1);
+}
+
 /*
  * Tests functions:
  *   gui_color_decode_ansi
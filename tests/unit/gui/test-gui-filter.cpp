@@ -24,12 +24,17 @@
 extern "C"
 {
 #include <string.h>
+#include "src/core/core-config.h"
+#include "src/core/core-config-file.h"
+#include "src/core/core-string.h"
 #include "src/gui/gui-buffer.h"
 #include "src/gui/gui-chat.h"
 #include "src/gui/gui-filter.h"
 #include "src/gui/gui-line.h"
 
 extern struct t_gui_filter *gui_filter_find_pos (struct t_gui_filter *filter);
+extern struct t_gui_line_data *gui_filter_scan_lines[];
+extern char gui_filter_scan_displayed[];
 
 }
 
@@ -79,6 +84,102 @@ TEST(GuiFilter, CheckLine)
     gui_filter_free (filter1);
 }
 
+/*
+ * Tests functions:
+ *   gui_filter_match_buffer
+ */
+
+TEST(GuiFilter, MatchBuffer)
+{
+    struct t_gui_filter *filter;
+
+    filter = gui_filter_new (1, "test", "core.*,!*.test", "*", "test");
+    CHECK(filter);
+    CHECK(filter->buffers_masks);
+    LONGS_EQUAL(1, gui_filter_match_buffer (filter, gui_buffers));
+
+    /* fallback on buffer names if masks are not compiled */
+    string_mask_free_list (filter->buffers_masks);
+    filter->buffers_masks = NULL;
+    LONGS_EQUAL(1, gui_filter_match_buffer (filter, gui_buffers));
+
+    gui_filter_free (filter);
+
+    filter = gui_filter_new (1, "test", "CORE.WEECHAT", "*", "test");
+    CHECK(filter);
+    LONGS_EQUAL(1, gui_filter_match_buffer (filter, gui_buffers));
+    gui_filter_free (filter);
+
+    filter = gui_filter_new (1, "test", "*,!core.weechat", "*", "test");
+    CHECK(filter);
+    LONGS_EQUAL(0, gui_filter_match_buffer (filter, gui_buffers));
+    gui_filter_free (filter);
+}
+
+/*
+ * Tests functions:
+ *   gui_filter_buffer_cache_reset
+ *   gui_filter_buffer_cache_build
+ *   gui_filter_match_line
+ */
+
+TEST(GuiFilter, BufferCache)
+{
+    struct t_gui_buffer *buffer;
+    struct t_gui_filter *filter1, *filter2, *filter3;
+    struct t_gui_line_data *line_data;
+    int generation;
+
+    buffer = gui_buffer_new_user ("test", GUI_BUFFER_TYPE_FORMATTED);
+    CHECK(buffer);
+    LONGS_EQUAL(-1, buffer->filters_cache_generation);
+
+    gui_chat_printf_date_tags (buffer, 0, "tag1,tag2", "this is a test");
+    line_data = buffer->own_lines->last_line->data;
+    LONGS_EQUAL(gui_filters_generation, buffer->filters_cache_generation);
+    LONGS_EQUAL(0, buffer->filters_cache_count);
+    POINTERS_EQUAL(NULL, buffer->filters_cache);
+
+    generation = gui_filters_generation;
+    filter1 = gui_filter_new (1, "test1", "irc.*", "*", "this");
+    filter2 = gui_filter_new (0, "test2", "core.test", "tag2", "test");
+    filter3 = gui_filter_new (1, "test3", "*,!core.test", "*", "test");
+    CHECK(gui_filters_generation > generation);
+    CHECK(buffer->filters_cache_generation != gui_filters_generation);
+
+    /* filter2 is disabled */
+    LONGS_EQUAL(1, gui_filter_check_line (line_data));
+    LONGS_EQUAL(gui_filters_generation, buffer->filters_cache_generation);
+    LONGS_EQUAL(1, buffer->filters_cache_count);
+    POINTERS_EQUAL(filter2, buffer->filters_cache[0]);
+    LONGS_EQUAL(1, gui_filter_match_line (filter2, line_data));
+    LONGS_EQUAL(1, gui_filter_match_line (filter3, line_data));
+
+    /* enable filter2: cache is still valid */
+    filter2->enabled = 1;
+    generation = gui_filters_generation;
+    LONGS_EQUAL(0, gui_filter_check_line (line_data));
+    LONGS_EQUAL(generation, buffer->filters_cache_generation);
+
+    /* rename buffer: cache must be built again */
+    gui_buffer_set (buffer, "name", "test_renamed");
+    LONGS_EQUAL(-1, buffer->filters_cache_generation);
+    LONGS_EQUAL(0, gui_filter_check_line (line_data));
+    LONGS_EQUAL(1, buffer->filters_cache_count);
+    POINTERS_EQUAL(filter3, buffer->filters_cache[0]);
+
+    /* remove filter3: cache is built again */
+    gui_filter_free (filter3);
+    LONGS_EQUAL(1, gui_filter_check_line (line_data));
+    LONGS_EQUAL(gui_filters_generation, buffer->filters_cache_generation);
+    LONGS_EQUAL(0, buffer->filters_cache_count);
+
+    gui_filter_free (filter1);
+    gui_filter_free (filter2);
+
+    gui_buffer_close (buffer);
+}
+
 /*
  * Tests functions:
  *   gui_filter_buffer
@@ -89,6 +190,53 @@ TEST(GuiFilter, Buffer)
     /* TODO: write tests */
 }
 
+/*
+ * Tests functions:
+ *   gui_filter_scan
+ *   gui_filter_scan_apply
+ */
+
+TEST(GuiFilter, Scan)
+{
+    struct t_gui_buffer *buffer;
+    struct t_gui_filter *filter;
+    struct t_gui_line *ptr_line;
+    int count, lines_hidden;
+
+    buffer = gui_buffer_new_user ("test", GUI_BUFFER_TYPE_FORMATTED);
+    CHECK(buffer);
+    gui_chat_printf_date_tags (buffer, 0, "tag_test", "line 1");
+    gui_chat_printf_date_tags (buffer, 0, "tag_other", "line 2");
+    gui_chat_printf_date_tags (buffer, 0, "tag_test", "line 3");
+
+    filter = gui_filter_new (0, "test", "core.test", "tag_test", "*");
+    CHECK(filter);
+    filter->enabled = 1;
+
+    count = 0;
+    for (ptr_line = buffer->own_lines->first_line; ptr_line;
+         ptr_line = ptr_line->next_line)
+    {
+        gui_filter_scan_lines[count++] = ptr_line->data;
+    }
+    gui_filter_scan (count);
+    LONGS_EQUAL(0, gui_filter_scan_displayed[0]);
+    LONGS_EQUAL(1, gui_filter_scan_displayed[1]);
+    LONGS_EQUAL(0, gui_filter_scan_displayed[2]);
+
+    /* lines are not changed until the result is applied */
+    LONGS_EQUAL(1, buffer->own_lines->first_line->data->displayed);
+    lines_hidden = 0;
+    LONGS_EQUAL(1, gui_filter_scan_apply (count, &lines_hidden));
+    LONGS_EQUAL(2, lines_hidden);
+    LONGS_EQUAL(0, buffer->own_lines->first_line->data->displayed);
+    LONGS_EQUAL(0, gui_filter_scan_apply (count, &lines_hidden));
+    LONGS_EQUAL(2, lines_hidden);
+
+    gui_filter_free (filter);
+    gui_buffer_close (buffer);
+}
+
 /*
  * Tests functions:
  *   gui_filter_all_buffers
@@ -96,7 +244,155 @@ TEST(GuiFilter, Buffer)
 
 TEST(GuiFilter, AllBuffers)
 {
-    /* TODO: write tests */
+    struct t_gui_buffer *buffers[10];
+    struct t_gui_filter *filter;
+    char name[32];
+    int i, j, threads;
+
+    /* 10 buffers with 2000 lines: lines are checked by 2 scans */
+    for (i = 0; i < 10; i++)
+    {
+        snprintf (name, sizeof (name), "test%d", i);
+        buffers[i] = gui_buffer_new_user (name, GUI_BUFFER_TYPE_FORMATTED);
+        CHECK(buffers[i]);
+        for (j = 0; j < 2000; j++)
+        {
+            gui_chat_printf_date_tags (buffers[i], 0,
+                                       (j % 4 == 0) ? "tag_test" : "tag_other",
+                                       "line %d", j);
+        }
+    }
+
+    filter = gui_filter_new (0, "test", "core.test*", "tag_test", "*");
+    CHECK(filter);
+
+    /* same result with lines scanned in threads or in main thread */
+    for (threads = 1; threads <= 4; threads += 3)
+    {
+        snprintf (name, sizeof (name), "%d", threads);
+        config_file_option_set (config_look_scan_threads, name, 1);
+
+        filter->enabled = 1;
+        gui_filter_all_buffers (filter);
+        for (i = 0; i < 10; i++)
+        {
+            LONGS_EQUAL(500, buffers[i]->own_lines->lines_hidden);
+            LONGS_EQUAL(0, buffers[i]->own_lines->first_line->data->displayed);
+            LONGS_EQUAL(1, buffers[i]->own_lines->last_line->data->displayed);
+        }
+
+        filter->enabled = 0;
+        gui_filter_all_buffers (filter);
+        for (i = 0; i < 10; i++)
+        {
+            LONGS_EQUAL(0, buffers[i]->own_lines->lines_hidden);
+            LONGS_EQUAL(1, buffers[i]->own_lines->first_line->data->displayed);
+        }
+    }
+
+    gui_filter_free (filter);
+    for (i = 0; i < 10; i++)
+    {
+        gui_buffer_close (buffers[i]);
+    }
+
+    config_file_option_reset (config_look_scan_threads, 1);
+}
+
+/*
+ * Tests functions:
+ *   gui_filter_job_step
+ *   gui_filter_jobs_step
+ *   gui_filter_buffer_job_start
+ *   gui_filter_jobs_finish
+ */
+
+TEST(GuiFilter, Jobs)
+{
+    struct t_gui_buffer *buffer;
+    struct t_gui_filter *filter;
+    struct t_gui_line *ptr_line;
+    int i;
+
+    config_file_option_set (config_look_filter_chunk_size, "10", 1);
+
+    buffer = gui_buffer_new_user ("test", GUI_BUFFER_TYPE_FORMATTED);
+    CHECK(buffer);
+    for (i = 0; i < 35; i++)
+    {
+        gui_chat_printf_date_tags (buffer, 0, "tag_test", "line %d", i);
+    }
+    LONGS_EQUAL(35, buffer->own_lines->lines_count);
+    LONGS_EQUAL(0, buffer->own_lines->lines_hidden);
+
+    /* disable the filter on buffer: lines added are not filtered */
+    gui_buffer_set (buffer, "filter", "0");
+    filter = gui_filter_new (1, "test", "core.test", "tag_test", "*");
+    CHECK(filter);
+    gui_chat_printf_date_tags (buffer, 0, "tag_test", "line 35");
+    gui_buffer_set (buffer, "filter", "1");
+    LONGS_EQUAL(36, buffer->own_lines->lines_hidden);
+    POINTERS_EQUAL(NULL, buffer->own_lines->filter_job_line);
+
+    /* disable filters and filter lines by chunks of 10 lines */
+    filter->enabled = 0;
+    gui_filter_all_buffers (filter);
+    LONGS_EQUAL(26, buffer->own_lines->lines_hidden);
+    LONGS_EQUAL(10, buffer->own_lines->filter_job_lines_done);
+    CHECK(gui_filter_jobs_timer);
+    ptr_line = buffer->own_lines->last_line;
+    for (i = 0; i < 10; i++)
+    {
+        LONGS_EQUAL(1, ptr_line->data->displayed);
+        ptr_line = ptr_line->prev_line;
+    }
+    POINTERS_EQUAL(ptr_line, buffer->own_lines->filter_job_line);
+    LONGS_EQUAL(0, ptr_line->data->displayed);
+
+    /* removing the line where the job is: job continues on previous line */
+    gui_line_free (buffer, ptr_line->prev_line);
+    LONGS_EQUAL(25, buffer->own_lines->lines_hidden);
+    ptr_line = buffer->own_lines->filter_job_line;
+    gui_line_free (buffer, ptr_line);
+    LONGS_EQUAL(24, buffer->own_lines->lines_hidden);
+    CHECK(buffer->own_lines->filter_job_line);
+    CHECK(buffer->own_lines->filter_job_line != ptr_line);
+
+    LONGS_EQUAL(0, gui_filter_jobs_step (10));
+    LONGS_EQUAL(14, buffer->own_lines->lines_hidden);
+    LONGS_EQUAL(0, gui_filter_jobs_step (10));
+    LONGS_EQUAL(4, buffer->own_lines->lines_hidden);
+    LONGS_EQUAL(1, gui_filter_jobs_step (10));
+    LONGS_EQUAL(0, buffer->own_lines->lines_hidden);
+    POINTERS_EQUAL(NULL, buffer->own_lines->filter_job_line);
+    LONGS_EQUAL(34, buffer->own_lines->filter_job_lines_done);
+    for (ptr_line = buffer->own_lines->first_line; ptr_line;
+         ptr_line = ptr_line->next_line)
+    {
+        LONGS_EQUAL(1, ptr_line->data->displayed);
+    }
+
+    /* enable filter and finish the job immediately */
+    filter->enabled = 1;
+    gui_filter_all_buffers (filter);
+    LONGS_EQUAL(10, buffer->own_lines->lines_hidden);
+    CHECK(buffer->own_lines->filter_job_line);
+    gui_filter_jobs_finish ();
+    LONGS_EQUAL(34, buffer->own_lines->lines_hidden);
+    POINTERS_EQUAL(NULL, buffer->own_lines->filter_job_line);
+    POINTERS_EQUAL(NULL, gui_filter_jobs_timer);
+
+    /* with chunk size 0, all lines are filtered at once */
+    config_file_option_set (config_look_filter_chunk_size, "0", 1);
+    filter->enabled = 0;
+    gui_filter_all_buffers (filter);
+    LONGS_EQUAL(0, buffer->own_lines->lines_hidden);
+    POINTERS_EQUAL(NULL, buffer->own_lines->filter_job_line);
+
+    gui_filter_free (filter);
+    gui_buffer_close (buffer);
+
+    config_file_option_reset (config_look_filter_chunk_size, 1);
 }
 
 /*
@@ -0,0 +1,191 @@
+/*
+ * test-gui-history.cpp - test history functions
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+#include "tests/tests.h"
+
+extern "C"
+{
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "src/core/core-config.h"
+#include "src/core/core-config-file.h"
+#include "src/core/core-dir.h"
+#include "src/core/core-hashtable.h"
+#include "src/core/core-string.h"
+#include "src/gui/gui-buffer.h"
+#include "src/gui/gui-history.h"
+
+extern char *gui_history_file_escape (const char *string);
+extern char *gui_history_file_get_path ();
+}
+
+TEST_GROUP(GuiHistory)
+{
+};
+
+/*
+ * Tests functions:
+ *   gui_history_buffer_add
+ *   gui_history_buffer_remove
+ *   gui_history_buffer_free
+ */
+
+TEST(GuiHistory, BufferAdd)
+{
+    struct t_gui_buffer *buffer;
+
+    buffer = gui_buffer_new (NULL, "test_history", NULL, NULL, NULL, NULL, NULL, NULL);
+    CHECK(buffer);
+
+    gui_history_buffer_add (buffer, NULL);
+    POINTERS_EQUAL(NULL, buffer->history);
+    LONGS_EQUAL(0, buffer->num_history);
+
+    gui_history_buffer_add (buffer, "cmd1");
+    gui_history_buffer_add (buffer, "cmd2");
+    gui_history_buffer_add (buffer, "cmd2");
+    gui_history_buffer_add (buffer, "cmd3");
+    LONGS_EQUAL(3, buffer->num_history);
+    STRCMP_EQUAL("cmd3", buffer->history->text);
+    STRCMP_EQUAL("cmd2", buffer->history->next_history->text);
+    STRCMP_EQUAL("cmd1", buffer->last_history->text);
+    gui_history_buffer_add (buffer, "cmd1");
+    LONGS_EQUAL(4, buffer->num_history);
+    POINTERS_EQUAL(NULL, buffer->history_index);
+
+    /* remove duplicates: the old entry is removed */
+    config_file_option_set (config_history_remove_duplicates, "on", 1);
+    gui_history_buffer_add (buffer, "cmd2");
+    LONGS_EQUAL(4, buffer->num_history);
+    CHECK(buffer->history_index);
+    STRCMP_EQUAL("cmd2", buffer->history->text);
+    STRCMP_EQUAL("cmd1", buffer->history->next_history->text);
+    STRCMP_EQUAL("cmd3", buffer->history->next_history->next_history->text);
+    STRCMP_EQUAL("cmd1", buffer->last_history->text);
+    POINTERS_EQUAL(NULL, buffer->last_history->next_history);
+    gui_history_buffer_add (buffer, "cmd3");
+    LONGS_EQUAL(4, buffer->num_history);
+    STRCMP_EQUAL("cmd3", buffer->history->text);
+    STRCMP_EQUAL("cmd2", buffer->history->next_history->text);
+    POINTERS_EQUAL(buffer->history,
+                   hashtable_get (buffer->history_index, "cmd3"));
+    POINTERS_EQUAL(buffer->history->next_history->next_history,
+                   hashtable_get (buffer->history_index, "cmd1"));
+
+    /* max commands */
+    config_file_option_set (config_history_max_commands, "4", 1);
+    gui_history_buffer_add (buffer, "cmd4");
+    LONGS_EQUAL(4, buffer->num_history);
+    STRCMP_EQUAL("cmd4", buffer->history->text);
+    STRCMP_EQUAL("cmd1", buffer->last_history->text);
+    POINTERS_EQUAL(buffer->last_history,
+                   hashtable_get (buffer->history_index, "cmd1"));
+    gui_history_buffer_add (buffer, "cmd5");
+    LONGS_EQUAL(4, buffer->num_history);
+    STRCMP_EQUAL("cmd2", buffer->last_history->text);
+    POINTERS_EQUAL(NULL, hashtable_get (buffer->history_index, "cmd1"));
+    config_file_option_reset (config_history_max_commands, 1);
+    config_file_option_reset (config_history_remove_duplicates, 1);
+
+    gui_history_buffer_free (buffer);
+    POINTERS_EQUAL(NULL, buffer->history);
+    POINTERS_EQUAL(NULL, buffer->last_history);
+    POINTERS_EQUAL(NULL, buffer->history_index);
+    LONGS_EQUAL(0, buffer->num_history);
+
+    gui_buffer_close (buffer);
+}
+
+/*
+ * Tests functions:
+ *   gui_history_file_escape
+ */
+
+TEST(GuiHistory, FileEscape)
+{
+    char *str;
+
+    WEE_TEST_STR("", gui_history_file_escape (""));
+    WEE_TEST_STR("/print test", gui_history_file_escape ("/print test"));
+    WEE_TEST_STR("line1\\nline2\\r\\\\n",
+                 gui_history_file_escape ("line1\nline2\r\\n"));
+}
+
+/*
+ * Tests functions:
+ *   gui_history_file_get_path
+ *   gui_history_file_add
+ *   gui_history_file_flush
+ *   gui_history_file_read
+ */
+
+TEST(GuiHistory, File)
+{
+    char path[1024], *content, *str;
+
+    POINTERS_EQUAL(NULL, gui_history_file_get_path ());
+
+    snprintf (path, sizeof (path), "/tmp/weechat_test_history_%d",
+              (int)getpid ());
+    config_file_option_set (config_history_file, path, 1);
+    WEE_TEST_STR(path, gui_history_file_get_path ());
+
+    gui_history_add (gui_buffers, "/print test history 1");
+    gui_history_add (gui_buffers, "/print test history 1");
+    gui_history_add (gui_buffers, "/print test\nhistory 2");
+    gui_history_file_flush ();
+
+    content = dir_file_get_content (path);
+    STRCMP_EQUAL("/print test history 1\n"
+                 "/print test\\nhistory 2\n",
+                 content);
+    free (content);
+
+    /* read file: entries are added in global history */
+    gui_history_global_free ();
+    gui_history_file_read ();
+    STRCMP_EQUAL("/print test\nhistory 2", gui_history->text);
+    STRCMP_EQUAL("/print test history 1", gui_history->next_history->text);
+    POINTERS_EQUAL(gui_history->next_history, last_gui_history);
+
+    /* file is compacted when it has too many entries */
+    gui_history_add (gui_buffers, "/print test history 3");
+    gui_history_file_flush ();
+    config_file_option_set (config_history_max_commands, "1", 1);
+    gui_history_global_free ();
+    gui_history_file_read ();
+    config_file_option_reset (config_history_max_commands, 1);
+    STRCMP_EQUAL("/print test history 3", gui_history->text);
+    POINTERS_EQUAL(gui_history, last_gui_history);
+
+    content = dir_file_get_content (path);
+    STRCMP_EQUAL("/print test history 3\n", content);
+    free (content);
+
+    unlink (path);
+    config_file_option_reset (config_history_file, 1);
+    gui_history_global_free ();
+    gui_history_buffer_free (gui_buffers);
+}
@@ -36,6 +36,11 @@ extern struct t_gui_hotlist *gui_hotlist_dup (struct t_gui_hotlist *hotlist);
 extern int gui_hotlist_compare_hotlists (struct t_hdata *hdata_hotlist,
                                          struct t_gui_hotlist *hotlist1,
                                          struct t_gui_hotlist *hotlist2);
+extern struct t_gui_hotlist *gui_hotlist_find_pos (struct t_gui_hotlist *last_hotlist,
+                                                   struct t_gui_hotlist *new_hotlist);
+extern void gui_hotlist_add_hotlist (struct t_gui_hotlist **hotlist,
+                                     struct t_gui_hotlist **last_hotlist,
+                                     struct t_gui_hotlist *new_hotlist);
 extern void gui_hotlist_free_all (struct t_gui_hotlist **hotlist,
                                   struct t_gui_hotlist **last_hotlist);
 }
@@ -233,6 +238,38 @@ TEST(GuiHotlist, CompareHotlists)
     LONGS_EQUAL(-1, gui_hotlist_compare_hotlists (hdata_hotlist, gui_hotlist, NULL));
     LONGS_EQUAL(1, gui_hotlist_compare_hotlists (hdata_hotlist, NULL, gui_hotlist));
 
+    /* field compared with hdata */
+    config_file_option_set (config_look_hotlist_sort, "count", 1);
+    LONGS_EQUAL(0, gui_hotlist_compare_hotlists (NULL, gui_hotlist, gui_hotlist));
+
+    /* fields compared directly */
+    config_file_option_set (config_look_hotlist_sort, "buffer.number", 1);
+    LONGS_EQUAL(-1, gui_hotlist_compare_hotlists (NULL,
+                                                  buffer_test[0]->hotlist,
+                                                  buffer_test[1]->hotlist));
+    LONGS_EQUAL(1, gui_hotlist_compare_hotlists (NULL,
+                                                 buffer_test[1]->hotlist,
+                                                 buffer_test[0]->hotlist));
+    LONGS_EQUAL(0, gui_hotlist_compare_hotlists (NULL,
+                                                 buffer_test[0]->hotlist,
+                                                 buffer_test[0]->hotlist));
+    config_file_option_set (config_look_hotlist_sort, "buffer.name", 1);
+    LONGS_EQUAL(1, gui_hotlist_compare_hotlists (NULL,
+                                                 buffer_test[0]->hotlist,
+                                                 buffer_test[2]->hotlist));
+    config_file_option_set (config_look_hotlist_sort, "~buffer.name", 1);
+    LONGS_EQUAL(-1, gui_hotlist_compare_hotlists (NULL,
+                                                  buffer_test[0]->hotlist,
+                                                  buffer_test[2]->hotlist));
+    config_file_option_set (config_look_hotlist_sort, "-buffer.name", 1);
+    LONGS_EQUAL(-1, gui_hotlist_compare_hotlists (NULL,
+                                                  buffer_test[0]->hotlist,
+                                                  buffer_test[2]->hotlist));
+    config_file_option_set (config_look_hotlist_sort, "-priority", 1);
+    LONGS_EQUAL(1, gui_hotlist_compare_hotlists (NULL,
+                                                 buffer_test[0]->hotlist,
+                                                 buffer_test[1]->hotlist));
+
     config_file_option_reset (config_look_hotlist_sort, 1);
 }
 
@@ -243,7 +280,32 @@ TEST(GuiHotlist, CompareHotlists)
 
 TEST(GuiHotlist, FindPos)
 {
-    /* TODO: write tests */
+    struct t_gui_hotlist *new_hotlist;
+
+    config_file_option_set (config_look_hotlist_sort, "buffer.number", 1);
+
+    /* [test1, test2, Test3] */
+    new_hotlist = gui_hotlist_dup (gui_hotlist);
+    CHECK(new_hotlist);
+
+    POINTERS_EQUAL(NULL, gui_hotlist_find_pos (NULL, new_hotlist));
+
+    /* same buffer as the first one: inserted after it */
+    POINTERS_EQUAL(gui_hotlist->next_hotlist,
+                   gui_hotlist_find_pos (last_gui_hotlist, new_hotlist));
+
+    /* same buffer as the last one: added at the end */
+    new_hotlist->buffer = last_gui_hotlist->buffer;
+    POINTERS_EQUAL(NULL, gui_hotlist_find_pos (last_gui_hotlist, new_hotlist));
+
+    /* no buffer: inserted before the first one */
+    new_hotlist->buffer = NULL;
+    POINTERS_EQUAL(gui_hotlist,
+                   gui_hotlist_find_pos (last_gui_hotlist, new_hotlist));
+
+    free (new_hotlist);
+
+    config_file_option_reset (config_look_hotlist_sort, 1);
 }
 
 /*
@@ -253,7 +315,48 @@ TEST(GuiHotlist, FindPos)
 
 TEST(GuiHotlist, AddHotlist)
 {
-    /* TODO: write tests */
+    struct t_gui_hotlist *hotlist, *last_hotlist, *new_hotlist[3];
+    int i;
+
+    config_file_option_set (config_look_hotlist_sort, "-buffer.number", 1);
+
+    hotlist = NULL;
+    last_hotlist = NULL;
+
+    for (i = 0; i < 3; i++)
+    {
+        new_hotlist[i] = gui_hotlist_dup (gui_hotlist);
+        CHECK(new_hotlist[i]);
+        new_hotlist[i]->buffer = buffer_test[i];
+    }
+
+    gui_hotlist_add_hotlist (&hotlist, &last_hotlist, new_hotlist[1]);
+    POINTERS_EQUAL(new_hotlist[1], hotlist);
+    POINTERS_EQUAL(new_hotlist[1], last_hotlist);
+    POINTERS_EQUAL(NULL, hotlist->prev_hotlist);
+    POINTERS_EQUAL(NULL, hotlist->next_hotlist);
+
+    gui_hotlist_add_hotlist (&hotlist, &last_hotlist, new_hotlist[0]);
+    POINTERS_EQUAL(new_hotlist[1], hotlist);
+    POINTERS_EQUAL(new_hotlist[0], last_hotlist);
+    POINTERS_EQUAL(new_hotlist[0], hotlist->next_hotlist);
+    POINTERS_EQUAL(new_hotlist[1], last_hotlist->prev_hotlist);
+
+    gui_hotlist_add_hotlist (&hotlist, &last_hotlist, new_hotlist[2]);
+    POINTERS_EQUAL(new_hotlist[2], hotlist);
+    POINTERS_EQUAL(new_hotlist[0], last_hotlist);
+    POINTERS_EQUAL(NULL, hotlist->prev_hotlist);
+    POINTERS_EQUAL(new_hotlist[1], hotlist->next_hotlist);
+    POINTERS_EQUAL(new_hotlist[2], hotlist->next_hotlist->prev_hotlist);
+    POINTERS_EQUAL(new_hotlist[0], hotlist->next_hotlist->next_hotlist);
+    POINTERS_EQUAL(NULL, last_hotlist->next_hotlist);
+
+    for (i = 0; i < 3; i++)
+    {
+        free (new_hotlist[i]);
+    }
+
+    config_file_option_reset (config_look_hotlist_sort, 1);
 }
 
 /*
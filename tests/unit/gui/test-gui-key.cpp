@@ -26,9 +26,14 @@
 extern "C"
 {
 #include "src/core/core-config.h"
+#include "src/core/core-config-file.h"
+#include "src/core/core-hashtable.h"
 #include "src/core/core-input.h"
 #include "src/core/core-string.h"
+#include "src/gui/gui-bar.h"
+#include "src/gui/gui-bar-window.h"
 #include "src/gui/gui-buffer.h"
+#include "src/gui/gui-focus.h"
 #include "src/gui/gui-key.h"
 
 extern int gui_key_get_current_context ();
@@ -45,6 +50,17 @@ extern struct t_gui_key *gui_key_search_part (struct t_gui_buffer *buffer, int c
                                               const char **chunks1, int chunks1_count,
                                               const char **chunks2, int chunks2_count,
                                               int *exact_match);
+extern int gui_key_focus_matching (struct t_gui_key *key,
+                                   struct t_gui_focus_info **focus_info);
+extern int gui_key_focus_build_hashtables (const char *key,
+                                           struct t_gui_focus_info **focus_info,
+                                           struct t_hashtable **hashtable_focus);
+extern struct t_hashtable *gui_key_index_exact[];
+extern struct t_hashtable *gui_key_index_partial[];
+extern int gui_key_index_build (int context);
+extern struct t_gui_key *gui_key_index_search (int context, const char **chunks,
+                                               int chunks_count,
+                                               int *exact_match);
 }
 
 #define WEE_CHECK_EXP_KEY(__rc, __key_name, __key_name_alias, __key)    \
@@ -1311,6 +1327,102 @@ TEST(GuiKey, CompareChunks)
                     (const char **)ptr_key2->chunks, ptr_key2->chunks_count));
 }
 
+/*
+ * Tests functions:
+ *   gui_key_index_free
+ *   gui_key_index_invalidate
+ *   gui_key_index_build
+ *   gui_key_index_search
+ */
+
+TEST(GuiKey, Index)
+{
+    struct t_gui_key *new_key, *ptr_key;
+    char **chunks;
+    int chunks_count, exact_match;
+
+    gui_key_index_free (GUI_KEY_CONTEXT_DEFAULT);
+    POINTERS_EQUAL(NULL, gui_key_index_exact[GUI_KEY_CONTEXT_DEFAULT]);
+    POINTERS_EQUAL(NULL, gui_key_index_partial[GUI_KEY_CONTEXT_DEFAULT]);
+
+    LONGS_EQUAL(1, gui_key_index_build (GUI_KEY_CONTEXT_DEFAULT));
+    CHECK(gui_key_index_exact[GUI_KEY_CONTEXT_DEFAULT]);
+    CHECK(gui_key_index_partial[GUI_KEY_CONTEXT_DEFAULT]);
+    POINTERS_EQUAL(gui_key_search (gui_keys[GUI_KEY_CONTEXT_DEFAULT], "meta-a"),
+                   hashtable_get (gui_key_index_exact[GUI_KEY_CONTEXT_DEFAULT],
+                                  "meta-a"));
+    POINTERS_EQUAL(gui_key_search (gui_keys[GUI_KEY_CONTEXT_DEFAULT],
+                                   "meta-w,meta-b"),
+                   hashtable_get (gui_key_index_partial[GUI_KEY_CONTEXT_DEFAULT],
+                                  "meta-w"));
+    POINTERS_EQUAL(NULL,
+                   hashtable_get (gui_key_index_exact[GUI_KEY_CONTEXT_DEFAULT],
+                                  "meta-w"));
+
+    exact_match = -1;
+    POINTERS_EQUAL(NULL, gui_key_index_search (GUI_KEY_CONTEXT_DEFAULT,
+                                               NULL, 0, &exact_match));
+    LONGS_EQUAL(0, exact_match);
+
+    chunks = string_split ("meta-w", ",", NULL, 0, 0, &chunks_count);
+    exact_match = -1;
+    ptr_key = gui_key_index_search (GUI_KEY_CONTEXT_DEFAULT,
+                                    (const char **)chunks, chunks_count,
+                                    &exact_match);
+    CHECK(ptr_key);
+    STRCMP_EQUAL("meta-w,meta-b", ptr_key->key);
+    LONGS_EQUAL(0, exact_match);
+
+    /* new key: index is freed */
+    new_key = gui_key_new (NULL, GUI_KEY_CONTEXT_DEFAULT,
+                           "meta-w", "/print meta-w", 1);
+    POINTERS_EQUAL(NULL, gui_key_index_exact[GUI_KEY_CONTEXT_DEFAULT]);
+    POINTERS_EQUAL(NULL, gui_key_index_partial[GUI_KEY_CONTEXT_DEFAULT]);
+
+    /* key with no command is ignored */
+    config_file_option_set (
+        config_file_search_option (weechat_config_file,
+                                   weechat_config_section_key[GUI_KEY_CONTEXT_DEFAULT],
+                                   "meta-w"),
+        "", 1);
+    STRCMP_EQUAL("", new_key->command);
+    LONGS_EQUAL(1, gui_key_index_build (GUI_KEY_CONTEXT_DEFAULT));
+    exact_match = -1;
+    ptr_key = gui_key_index_search (GUI_KEY_CONTEXT_DEFAULT,
+                                    (const char **)chunks, chunks_count,
+                                    &exact_match);
+    CHECK(ptr_key);
+    STRCMP_EQUAL("meta-w,meta-b", ptr_key->key);
+    LONGS_EQUAL(0, exact_match);
+
+    /* change of command: index is freed */
+    config_file_option_set (
+        config_file_search_option (weechat_config_file,
+                                   weechat_config_section_key[GUI_KEY_CONTEXT_DEFAULT],
+                                   "meta-w"),
+        "/print meta-w", 1);
+    POINTERS_EQUAL(NULL, gui_key_index_exact[GUI_KEY_CONTEXT_DEFAULT]);
+    LONGS_EQUAL(1, gui_key_index_build (GUI_KEY_CONTEXT_DEFAULT));
+    exact_match = -1;
+    POINTERS_EQUAL(new_key,
+                   gui_key_index_search (GUI_KEY_CONTEXT_DEFAULT,
+                                         (const char **)chunks, chunks_count,
+                                         &exact_match));
+    LONGS_EQUAL(1, exact_match);
+
+    /* key removed: index is freed */
+    gui_key_free (GUI_KEY_CONTEXT_DEFAULT,
+                  &gui_keys[GUI_KEY_CONTEXT_DEFAULT],
+                  &last_gui_key[GUI_KEY_CONTEXT_DEFAULT],
+                  &gui_keys_count[GUI_KEY_CONTEXT_DEFAULT],
+                  new_key,
+                  1);
+    POINTERS_EQUAL(NULL, gui_key_index_exact[GUI_KEY_CONTEXT_DEFAULT]);
+    POINTERS_EQUAL(NULL, gui_key_index_partial[GUI_KEY_CONTEXT_DEFAULT]);
+
+    string_free_split (chunks);
+}
+
 /*
  * Tests functions:
  *   gui_key_search_part
@@ -1523,7 +1635,88 @@ TEST(GuiKey, UnbindPlugin)
 
 TEST(GuiKey, FocusMatching)
 {
-    /* TODO: write tests */
+    struct t_gui_key key;
+    struct t_gui_focus_info focus1, focus2, *focus_info[2];
+    struct t_gui_bar_window bar_window;
+    char area_chat[] = "core.weechat", area_bar[] = "status";
+    char area_item[] = "buffer_*", item[] = "buffer_name";
+
+    memset (&key, 0, sizeof (key));
+    memset (&focus1, 0, sizeof (focus1));
+    memset (&focus2, 0, sizeof (focus2));
+    memset (&bar_window, 0, sizeof (bar_window));
+    bar_window.bar = gui_bar_search ("status");
+    CHECK(bar_window.bar);
+    focus_info[0] = &focus1;
+    focus_info[1] = NULL;
+
+    /* any area */
+    key.area_type[0] = GUI_KEY_FOCUS_ANY;
+    key.area_type[1] = GUI_KEY_FOCUS_ANY;
+    LONGS_EQUAL(1, gui_key_focus_matching (&key, focus_info));
+
+    /* chat area */
+    key.area_type[0] = GUI_KEY_FOCUS_CHAT;
+    key.area_name[0] = area_chat;
+    focus1.buffer = gui_buffers;
+    LONGS_EQUAL(0, gui_key_focus_matching (&key, focus_info));
+    focus1.chat = 1;
+    LONGS_EQUAL(1, gui_key_focus_matching (&key, focus_info));
+    key.area_type[1] = GUI_KEY_FOCUS_CHAT;
+    key.area_name[1] = area_chat;
+    LONGS_EQUAL(0, gui_key_focus_matching (&key, focus_info));
+    focus_info[1] = &focus2;
+    LONGS_EQUAL(0, gui_key_focus_matching (&key, focus_info));
+    focus2.chat = 1;
+    focus2.buffer = gui_buffers;
+    LONGS_EQUAL(1, gui_key_focus_matching (&key, focus_info));
+
+    /* bar area */
+    key.area_type[1] = GUI_KEY_FOCUS_BAR;
+    key.area_name[1] = area_bar;
+    LONGS_EQUAL(0, gui_key_focus_matching (&key, focus_info));
+    focus2.bar_window = &bar_window;
+    LONGS_EQUAL(1, gui_key_focus_matching (&key, focus_info));
+
+    /* bar item area */
+    key.area_type[1] = GUI_KEY_FOCUS_ITEM;
+    key.area_name[1] = area_item;
+    LONGS_EQUAL(0, gui_key_focus_matching (&key, focus_info));
+    focus2.bar_item = item;
+    LONGS_EQUAL(1, gui_key_focus_matching (&key, focus_info));
+}
+
+/*
+ * Tests functions:
+ *   gui_key_focus_build_hashtables
+ */
+
+TEST(GuiKey, FocusBuildHashtables)
+{
+    struct t_gui_focus_info *focus_info[2];
+    struct t_hashtable *hashtable_focus[2], *ptr_hashtable;
+
+    focus_info[0] = gui_focus_get_info (0, 0);
+    CHECK(focus_info[0]);
+    focus_info[1] = NULL;
+    hashtable_focus[0] = NULL;
+    hashtable_focus[1] = NULL;
+
+    LONGS_EQUAL(1, gui_key_focus_build_hashtables ("button1", focus_info,
+                                                   hashtable_focus));
+    CHECK(hashtable_focus[0]);
+    POINTERS_EQUAL(NULL, hashtable_focus[1]);
+    STRCMP_EQUAL("button1", (const char *)hashtable_get (hashtable_focus[0],
+                                                         "_key"));
+
+    /* hashtable already built: not built again */
+    ptr_hashtable = hashtable_focus[0];
+    LONGS_EQUAL(1, gui_key_focus_build_hashtables ("button1", focus_info,
+                                                   hashtable_focus));
+    POINTERS_EQUAL(ptr_hashtable, hashtable_focus[0]);
+
+    hashtable_free (hashtable_focus[0]);
+    gui_focus_free_info (focus_info[0]);
 }
 
 /*
@@ -0,0 +1,275 @@
+/*
+ * test-gui-line-compress.cpp - test compression of lines
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+#include "tests/tests.h"
+
+extern "C"
+{
+#include <string.h>
+#include "src/core/core-config.h"
+#include "src/core/core-config-file.h"
+#include "src/gui/gui-buffer.h"
+#include "src/gui/gui-chat.h"
+#include "src/gui/gui-line.h"
+#include "src/gui/gui-line-compress.h"
+}
+
+TEST_GROUP(GuiLineCompress)
+{
+    /*
+     * Prints "count" lines in a buffer, with the line number in prefix and
+     * message (starting at "start").
+     */
+
+    void
+    test_gui_line_compress_print (struct t_gui_buffer *buffer,
+                                  int start, int count)
+    {
+        int i;
+
+        for (i = start; i < start + count; i++)
+        {
+            gui_chat_printf_date_tags (buffer, 1000 + i,
+                                       (i % 2 == 0) ? "tag1,tag2" : NULL,
+                                       "nick%d\tmessage %d", i, i);
+        }
+    }
+};
+
+/*
+ * Tests functions:
+ *   gui_line_compress_enabled
+ */
+
+TEST(GuiLineCompress, Enabled)
+{
+    struct t_gui_buffer *buffer;
+
+    LONGS_EQUAL(0, gui_line_compress_enabled (NULL));
+
+    buffer = gui_buffer_new_user ("test", GUI_BUFFER_TYPE_FORMATTED);
+    CHECK(buffer);
+
+    LONGS_EQUAL(0, gui_line_compress_enabled (buffer));
+
+    config_file_option_set (config_history_max_buffer_lines_uncompressed,
+                            "10", 1);
+#ifdef HAVE_ZSTD
+    LONGS_EQUAL(1, gui_line_compress_enabled (buffer));
+#else
+    LONGS_EQUAL(0, gui_line_compress_enabled (buffer));
+#endif
+
+    gui_buffer_set (buffer, "type", "free");
+    LONGS_EQUAL(0, gui_line_compress_enabled (buffer));
+
+    config_file_option_reset (config_history_max_buffer_lines_uncompressed, 1);
+
+    gui_buffer_close (buffer);
+}
+
+/*
+ * Tests functions:
+ *   gui_line_compress_buffer
+ *   gui_line_uncompress_block
+ *   gui_line_uncompress_lines
+ *   gui_line_uncompress_get_prev_line
+ *   gui_line_uncompress_get_prev_displayed
+ */
+
+TEST(GuiLineCompress, CompressUncompress)
+{
+#ifdef HAVE_ZSTD
+    struct t_gui_buffer *buffer;
+    struct t_gui_lines *lines;
+    struct t_gui_line *ptr_line;
+
+    config_file_option_set (config_history_max_buffer_lines_uncompressed,
+                            "10", 1);
+
+    buffer = gui_buffer_new_user ("test", GUI_BUFFER_TYPE_FORMATTED);
+    CHECK(buffer);
+    lines = buffer->own_lines;
+
+    /* not enough lines to compress a block */
+    test_gui_line_compress_print (buffer, 0, 10 + GUI_LINE_COMPRESS_BLOCK_LINES - 1);
+    POINTERS_EQUAL(NULL, lines->compressed_blocks);
+    LONGS_EQUAL(10 + GUI_LINE_COMPRESS_BLOCK_LINES - 1, lines->lines_count);
+
+    /* read marker in the block to compress */
+    lines->last_read_line = gui_line_search_by_id (buffer, 50);
+    CHECK(lines->last_read_line);
+
+    /* one more line: oldest lines are compressed */
+    test_gui_line_compress_print (buffer, 10 + GUI_LINE_COMPRESS_BLOCK_LINES - 1, 6);
+    CHECK(lines->compressed_blocks);
+    POINTERS_EQUAL(lines->compressed_blocks, lines->last_compressed_block);
+    LONGS_EQUAL(GUI_LINE_COMPRESS_BLOCK_LINES,
+                lines->compressed_blocks->lines_count);
+    LONGS_EQUAL(50, lines->compressed_blocks->read_marker);
+    CHECK(lines->compressed_blocks->size
+          < lines->compressed_blocks->size_uncompressed);
+    LONGS_EQUAL(GUI_LINE_COMPRESS_BLOCK_LINES, lines->lines_compressed_count);
+    LONGS_EQUAL(15, lines->lines_count);
+    LONGS_EQUAL(GUI_LINE_COMPRESS_BLOCK_LINES, lines->first_line->data->id);
+    POINTERS_EQUAL(NULL, lines->last_read_line);
+    LONGS_EQUAL(1, lines->first_line_not_read);
+    POINTERS_EQUAL(NULL, gui_line_search_by_id (buffer, 50));
+    LONGS_EQUAL(15, lines->id_index_count);
+
+    /* a search in buffer prevents compression */
+    buffer->text_search = GUI_BUFFER_SEARCH_LINES;
+    test_gui_line_compress_print (buffer, 10 + GUI_LINE_COMPRESS_BLOCK_LINES + 5,
+                                  GUI_LINE_COMPRESS_BLOCK_LINES);
+    POINTERS_EQUAL(lines->compressed_blocks, lines->last_compressed_block);
+    LONGS_EQUAL(GUI_LINE_COMPRESS_BLOCK_LINES + 15, lines->lines_count);
+    buffer->text_search = GUI_BUFFER_SEARCH_DISABLED;
+
+    /* previous line of first line: the last block is uncompressed */
+    ptr_line = gui_line_uncompress_get_prev_line (lines->first_line);
+    CHECK(ptr_line);
+    POINTERS_EQUAL(NULL, lines->compressed_blocks);
+    POINTERS_EQUAL(NULL, lines->last_compressed_block);
+    LONGS_EQUAL(0, lines->lines_compressed_count);
+    LONGS_EQUAL((2 * GUI_LINE_COMPRESS_BLOCK_LINES) + 15, lines->lines_count);
+    LONGS_EQUAL((2 * GUI_LINE_COMPRESS_BLOCK_LINES) + 15, lines->id_index_count);
+    LONGS_EQUAL(GUI_LINE_COMPRESS_BLOCK_LINES - 1, ptr_line->data->id);
+    POINTERS_EQUAL(ptr_line->next_line->prev_line, ptr_line);
+
+    /* check first line restored */
+    ptr_line = lines->first_line;
+    POINTERS_EQUAL(NULL, ptr_line->prev_line);
+    LONGS_EQUAL(0, ptr_line->data->id);
+    LONGS_EQUAL(1000, ptr_line->data->date);
+    STRCMP_EQUAL("nick0", ptr_line->data->prefix);
+    STRCMP_EQUAL("message 0", ptr_line->data->message);
+    LONGS_EQUAL(2, ptr_line->data->tags_count);
+    STRCMP_EQUAL("tag1", ptr_line->data->tags_array[0]);
+    STRCMP_EQUAL("tag2", ptr_line->data->tags_array[1]);
+    LONGS_EQUAL(1, ptr_line->data->displayed);
+    CHECK(ptr_line->data->str_time);
+    ptr_line = ptr_line->next_line;
+    LONGS_EQUAL(1, ptr_line->data->id);
+    LONGS_EQUAL(0, ptr_line->data->tags_count);
+    POINTERS_EQUAL(NULL, ptr_line->data->tags_array);
+
+    /* read marker restored */
+    POINTERS_EQUAL(gui_line_search_by_id (buffer, 50), lines->last_read_line);
+    LONGS_EQUAL(0, lines->first_line_not_read);
+
+    /* nothing to uncompress */
+    POINTERS_EQUAL(NULL, gui_line_uncompress_get_prev_line (lines->first_line));
+    POINTERS_EQUAL(NULL,
+                   gui_line_uncompress_get_prev_displayed (lines->first_line));
+    LONGS_EQUAL(-1, gui_line_uncompress_block (buffer));
+    LONGS_EQUAL(0, gui_line_uncompress_lines (buffer, -1));
+
+    /* compress all lines again (more blocks) */
+    LONGS_EQUAL(2, gui_line_compress_buffer (buffer));
+    LONGS_EQUAL(2 * GUI_LINE_COMPRESS_BLOCK_LINES, lines->lines_compressed_count);
+    CHECK(lines->compressed_blocks->next_block);
+    POINTERS_EQUAL(lines->compressed_blocks,
+                   lines->last_compressed_block->prev_block);
+
+    /* at least 15 lines in memory: nothing to do */
+    LONGS_EQUAL(0, gui_line_uncompress_lines (buffer, 15));
+
+    /* uncompress with buffer property */
+    gui_buffer_set (buffer, "uncompress_lines", "100");
+    LONGS_EQUAL(GUI_LINE_COMPRESS_BLOCK_LINES, lines->lines_compressed_count);
+    LONGS_EQUAL(GUI_LINE_COMPRESS_BLOCK_LINES + 15, lines->lines_count);
+    gui_buffer_set (buffer, "uncompress_lines", "-1");
+    LONGS_EQUAL(0, lines->lines_compressed_count);
+    LONGS_EQUAL((2 * GUI_LINE_COMPRESS_BLOCK_LINES) + 15, lines->lines_count);
+
+    /* clear buffer frees compressed lines */
+    LONGS_EQUAL(2, gui_line_compress_buffer (buffer));
+    gui_buffer_clear (buffer);
+    POINTERS_EQUAL(NULL, lines->compressed_blocks);
+    LONGS_EQUAL(0, lines->lines_compressed_count);
+    LONGS_EQUAL(0, lines->lines_count);
+
+    gui_buffer_close (buffer);
+
+    config_file_option_reset (config_history_max_buffer_lines_uncompressed, 1);
+#endif /* HAVE_ZSTD */
+}
+
+/*
+ * Tests functions:
+ *   gui_line_compress_remove_old
+ *   gui_line_compress_free_all
+ */
+
+TEST(GuiLineCompress, RemoveOld)
+{
+#ifdef HAVE_ZSTD
+    struct t_gui_buffer *buffer;
+    struct t_gui_lines *lines;
+
+    config_file_option_set (config_history_max_buffer_lines_uncompressed,
+                            "10", 1);
+    config_file_option_set (config_history_max_buffer_lines_number,
+                            "2000", 1);
+
+    buffer = gui_buffer_new_user ("test", GUI_BUFFER_TYPE_FORMATTED);
+    CHECK(buffer);
+    lines = buffer->own_lines;
+
+    /* lines over the limit are kept while a whole block can not be removed */
+    test_gui_line_compress_print (buffer, 0, 2500);
+    LONGS_EQUAL(2 * GUI_LINE_COMPRESS_BLOCK_LINES, lines->lines_compressed_count);
+    LONGS_EQUAL(2500 - (2 * GUI_LINE_COMPRESS_BLOCK_LINES), lines->lines_count);
+
+    /* the oldest block is removed */
+    test_gui_line_compress_print (buffer, 2500, 600);
+    LONGS_EQUAL(2 * GUI_LINE_COMPRESS_BLOCK_LINES, lines->lines_compressed_count);
+    LONGS_EQUAL(3100 - (3 * GUI_LINE_COMPRESS_BLOCK_LINES), lines->lines_count);
+    LONGS_EQUAL(3 * GUI_LINE_COMPRESS_BLOCK_LINES, lines->first_line->data->id);
+
+    /* remove blocks with lines printed more than 1 minute ago */
+    config_file_option_set (config_history_max_buffer_lines_minutes, "1", 1);
+    LONGS_EQUAL(0,
+                gui_line_compress_remove_old (
+                    buffer, lines->compressed_blocks->last_date_printed));
+    LONGS_EQUAL(2 * GUI_LINE_COMPRESS_BLOCK_LINES,
+                gui_line_compress_remove_old (
+                    buffer, lines->last_compressed_block->last_date_printed + 61));
+    POINTERS_EQUAL(NULL, lines->compressed_blocks);
+    LONGS_EQUAL(0, lines->lines_compressed_count);
+    config_file_option_reset (config_history_max_buffer_lines_minutes, 1);
+
+    /* free all blocks */
+    test_gui_line_compress_print (buffer, 3100, 2100);
+    CHECK(lines->compressed_blocks);
+    gui_line_compress_free_all (lines);
+    POINTERS_EQUAL(NULL, lines->compressed_blocks);
+    POINTERS_EQUAL(NULL, lines->last_compressed_block);
+    LONGS_EQUAL(0, lines->lines_compressed_count);
+
+    gui_buffer_close (buffer);
+
+    config_file_option_reset (config_history_max_buffer_lines_number, 1);
+    config_file_option_reset (config_history_max_buffer_lines_uncompressed, 1);
+#endif /* HAVE_ZSTD */
+}
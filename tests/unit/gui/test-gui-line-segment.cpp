@@ -0,0 +1,270 @@
+/*
+ * test-gui-line-segment.cpp - test segment files with lines on disk
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+#include "tests/tests.h"
+
+extern "C"
+{
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "src/core/weechat.h"
+#include "src/core/core-config.h"
+#include "src/core/core-config-file.h"
+#include "src/gui/gui-buffer.h"
+#include "src/gui/gui-chat.h"
+#include "src/gui/gui-line.h"
+#include "src/gui/gui-line-compress.h"
+#include "src/gui/gui-line-segment.h"
+}
+
+TEST_GROUP(GuiLineSegment)
+{
+    /*
+     * Prints "count" lines in a buffer, with the line number in prefix and
+     * message (starting at "start").
+     */
+
+    void
+    test_gui_line_segment_print (struct t_gui_buffer *buffer,
+                                 int start, int count)
+    {
+        int i;
+
+        for (i = start; i < start + count; i++)
+        {
+            gui_chat_printf_date_tags (buffer, 1000 + i, NULL,
+                                       "nick%d\tmessage %d", i, i);
+        }
+    }
+
+    /*
+     * Returns size of segment file of a buffer (-1 if file does not exist).
+     */
+
+    long long
+    test_gui_line_segment_file_size (struct t_gui_buffer *buffer)
+    {
+        struct stat st;
+        char *path;
+        int rc;
+
+        path = gui_line_segment_get_path (buffer);
+        if (!path)
+            return -1;
+        rc = stat (path, &st);
+        free (path);
+
+        return (rc == 0) ? (long long)st.st_size : -1;
+    }
+};
+
+/*
+ * Tests functions:
+ *   gui_line_segment_enabled
+ *   gui_line_segment_get_path
+ */
+
+TEST(GuiLineSegment, EnabledGetPath)
+{
+    struct t_gui_buffer *buffer;
+    char *path, str_end[128];
+
+    LONGS_EQUAL(0, gui_line_segment_enabled (NULL));
+    POINTERS_EQUAL(NULL, gui_line_segment_get_path (NULL));
+
+    buffer = gui_buffer_new_user ("test", GUI_BUFFER_TYPE_FORMATTED);
+    CHECK(buffer);
+
+    LONGS_EQUAL(0, gui_line_segment_enabled (buffer));
+    config_file_option_set (config_history_buffer_lines_on_disk, "on", 1);
+    LONGS_EQUAL(0, gui_line_segment_enabled (buffer));
+    config_file_option_set (config_history_max_buffer_lines_uncompressed,
+                            "10", 1);
+#ifdef HAVE_ZSTD
+    LONGS_EQUAL(1, gui_line_segment_enabled (buffer));
+#else
+    LONGS_EQUAL(0, gui_line_segment_enabled (buffer));
+#endif
+    config_file_option_reset (config_history_max_buffer_lines_uncompressed, 1);
+    config_file_option_reset (config_history_buffer_lines_on_disk, 1);
+
+    path = gui_line_segment_get_path (buffer);
+    CHECK(path);
+    CHECK(strncmp (path, weechat_cache_dir, strlen (weechat_cache_dir)) == 0);
+    snprintf (str_end, sizeof (str_end), "/lines/%lld.lines", buffer->id);
+    STRCMP_EQUAL(str_end, path + strlen (path) - strlen (str_end));
+    free (path);
+
+    gui_buffer_close (buffer);
+}
+
+/*
+ * Tests functions:
+ *   gui_line_segment_write_block
+ *   gui_line_segment_read_block
+ *   gui_line_segment_remove_file
+ */
+
+TEST(GuiLineSegment, WriteReadBlock)
+{
+#ifdef HAVE_ZSTD
+    struct t_gui_buffer *buffer;
+    struct t_gui_lines *lines;
+    struct t_gui_line *ptr_line;
+    int i;
+
+    config_file_option_set (config_history_buffer_lines_on_disk, "on", 1);
+    config_file_option_set (config_history_max_buffer_lines_uncompressed,
+                            "10", 1);
+    config_file_option_set (config_history_max_buffer_lines_number,
+                            "2000", 1);
+
+    buffer = gui_buffer_new_user ("test", GUI_BUFFER_TYPE_FORMATTED);
+    CHECK(buffer);
+    lines = buffer->own_lines;
+
+    test_gui_line_segment_print (buffer, 0, 500);
+    lines->last_read_line = gui_line_search_by_id (buffer, 50);
+    CHECK(lines->last_read_line);
+
+    /* blocks are kept in memory while the limit is not reached */
+    test_gui_line_segment_print (buffer, 500, 2000);
+    LONGS_EQUAL(2 * GUI_LINE_COMPRESS_BLOCK_LINES, lines->lines_compressed_count);
+    POINTERS_EQUAL(NULL, lines->segment_blocks);
+    LONGS_EQUAL(-1, test_gui_line_segment_file_size (buffer));
+
+    /* the oldest block is saved on disk */
+    test_gui_line_segment_print (buffer, 2500, 600);
+    LONGS_EQUAL(2 * GUI_LINE_COMPRESS_BLOCK_LINES, lines->lines_compressed_count);
+    LONGS_EQUAL(3100 - (3 * GUI_LINE_COMPRESS_BLOCK_LINES), lines->lines_count);
+    CHECK(lines->segment_blocks);
+    POINTERS_EQUAL(lines->segment_blocks, lines->last_segment_block);
+    POINTERS_EQUAL(NULL, lines->segment_blocks->data);
+    LONGS_EQUAL(0, lines->segment_blocks->offset);
+    LONGS_EQUAL(50, lines->segment_blocks->read_marker);
+    LONGS_EQUAL(GUI_LINE_COMPRESS_BLOCK_LINES, lines->lines_segment_count);
+    LONGS_EQUAL(lines->segment_blocks->size, lines->segment_size);
+    LONGS_EQUAL(lines->segment_size, test_gui_line_segment_file_size (buffer));
+
+    /* all lines are uncompressed, including lines on disk */
+    LONGS_EQUAL(3 * GUI_LINE_COMPRESS_BLOCK_LINES,
+                gui_line_uncompress_lines (buffer, -1));
+    POINTERS_EQUAL(NULL, lines->compressed_blocks);
+    POINTERS_EQUAL(NULL, lines->segment_blocks);
+    POINTERS_EQUAL(NULL, lines->last_segment_block);
+    LONGS_EQUAL(0, lines->lines_segment_count);
+    LONGS_EQUAL(0, lines->segment_size);
+    LONGS_EQUAL(3100, lines->lines_count);
+    LONGS_EQUAL(-1, test_gui_line_segment_file_size (buffer));
+    for (i = 0, ptr_line = lines->first_line; ptr_line;
+         i++, ptr_line = ptr_line->next_line)
+    {
+        LONGS_EQUAL(i, ptr_line->data->id);
+    }
+    LONGS_EQUAL(3100, i);
+    STRCMP_EQUAL("message 0", lines->first_line->data->message);
+    POINTERS_EQUAL(gui_line_search_by_id (buffer, 50), lines->last_read_line);
+
+    /* save all blocks on disk, then read the most recent block */
+    LONGS_EQUAL(3, gui_line_compress_buffer (buffer));
+    config_file_option_set (config_history_max_buffer_lines_minutes, "1", 1);
+    LONGS_EQUAL(3 * GUI_LINE_COMPRESS_BLOCK_LINES,
+                gui_line_compress_remove_old (
+                    buffer, lines->last_compressed_block->last_date_printed + 61));
+    config_file_option_reset (config_history_max_buffer_lines_minutes, 1);
+    POINTERS_EQUAL(NULL, lines->compressed_blocks);
+    LONGS_EQUAL(3 * GUI_LINE_COMPRESS_BLOCK_LINES, lines->lines_segment_count);
+    LONGS_EQUAL(lines->segment_blocks->size,
+                lines->segment_blocks->next_block->offset);
+    LONGS_EQUAL(lines->segment_size, test_gui_line_segment_file_size (buffer));
+    ptr_line = gui_line_uncompress_get_prev_line (lines->first_line);
+    CHECK(ptr_line);
+    LONGS_EQUAL((3 * GUI_LINE_COMPRESS_BLOCK_LINES) - 1, ptr_line->data->id);
+    LONGS_EQUAL(2 * GUI_LINE_COMPRESS_BLOCK_LINES, lines->lines_segment_count);
+    LONGS_EQUAL(lines->segment_size, test_gui_line_segment_file_size (buffer));
+
+    /* clear buffer removes the segment file */
+    gui_buffer_clear (buffer);
+    POINTERS_EQUAL(NULL, lines->segment_blocks);
+    LONGS_EQUAL(0, lines->lines_segment_count);
+    LONGS_EQUAL(-1, test_gui_line_segment_file_size (buffer));
+
+    gui_buffer_close (buffer);
+
+    config_file_option_reset (config_history_max_buffer_lines_number, 1);
+    config_file_option_reset (config_history_max_buffer_lines_uncompressed, 1);
+    config_file_option_reset (config_history_buffer_lines_on_disk, 1);
+#endif /* HAVE_ZSTD */
+}
+
+/*
+ * Tests functions:
+ *   gui_line_segment_add_block
+ *   gui_line_segment_free_all
+ */
+
+TEST(GuiLineSegment, AddBlockFreeAll)
+{
+    struct t_gui_buffer *buffer;
+    struct t_gui_lines *lines;
+    struct t_gui_line_block *block1, *block2;
+
+    buffer = gui_buffer_new_user ("test", GUI_BUFFER_TYPE_FORMATTED);
+    CHECK(buffer);
+    lines = buffer->own_lines;
+
+    POINTERS_EQUAL(NULL, gui_line_segment_add_block (NULL, 10, 20, 1, -1, 0));
+    POINTERS_EQUAL(NULL, gui_line_segment_add_block (buffer, 0, 20, 1, -1, 0));
+    POINTERS_EQUAL(NULL, gui_line_segment_add_block (buffer, 10, 0, 1, -1, 0));
+    POINTERS_EQUAL(NULL, gui_line_segment_add_block (buffer, 10, 20, 0, -1, 0));
+
+    block1 = gui_line_segment_add_block (buffer, 10, 20, 2, -1, 1000);
+    CHECK(block1);
+    block2 = gui_line_segment_add_block (buffer, 30, 40, 3, 1, 2000);
+    CHECK(block2);
+    POINTERS_EQUAL(block1, lines->segment_blocks);
+    POINTERS_EQUAL(block2, lines->last_segment_block);
+    POINTERS_EQUAL(block2, block1->next_block);
+    LONGS_EQUAL(0, block1->offset);
+    LONGS_EQUAL(10, block2->offset);
+    LONGS_EQUAL(1, block2->read_marker);
+    LONGS_EQUAL(2000, block2->last_date_printed);
+    LONGS_EQUAL(5, lines->lines_segment_count);
+    LONGS_EQUAL(40, lines->segment_size);
+
+    /* segment file does not exist: the block is lost */
+    POINTERS_EQUAL(NULL, gui_line_segment_read_block (buffer));
+    POINTERS_EQUAL(block1, lines->last_segment_block);
+    LONGS_EQUAL(2, lines->lines_segment_count);
+    LONGS_EQUAL(10, lines->segment_size);
+
+    gui_line_segment_free_all (lines);
+    POINTERS_EQUAL(NULL, lines->segment_blocks);
+    POINTERS_EQUAL(NULL, lines->last_segment_block);
+    LONGS_EQUAL(0, lines->lines_segment_count);
+    LONGS_EQUAL(0, lines->segment_size);
+
+    gui_buffer_close (buffer);
+}
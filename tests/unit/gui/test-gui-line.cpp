@@ -29,6 +29,9 @@ extern "C"
 #include <time.h>
 #include <sys/time.h>
 #include "src/core/core-config.h"
+#include "src/core/core-hashtable.h"
+#include "src/core/core-hdata.h"
+#include "src/core/core-hook.h"
 #include "src/core/core-string.h"
 #include "src/gui/gui-buffer.h"
 #include "src/gui/gui-chat.h"
@@ -36,6 +39,7 @@ extern "C"
 #include "src/gui/gui-filter.h"
 #include "src/gui/gui-hotlist.h"
 #include "src/gui/gui-line.h"
+#include "src/plugins/plugin.h"
 }
 
 #define WEE_BUILD_STR_PREFIX_MSG(__result, __prefix, __message)         \
@@ -45,8 +49,7 @@ extern "C"
                                                 line->data->message);   \
     STRCMP_EQUAL(__result, str);                                        \
     free (str);                                                         \
-    gui_line_free_data (line);                                          \
-    free (line);
+    gui_line_free_new (line);
 
 #define WEE_BUILD_STR_MSG_TAGS(__tags, __message, __colors)             \
     line = gui_line_new (gui_buffers, -1, 0, 0, 0, 0, __tags,           \
@@ -57,8 +60,7 @@ extern "C"
                                               __colors);                \
     STRCMP_EQUAL(str_result, str);                                      \
     free (str);                                                         \
-    gui_line_free_data (line);                                          \
-    free (line);
+    gui_line_free_new (line);
 
 #define WEE_LINE_MATCH_TAGS(__result, __line_tags, __tags)              \
     gui_line_tags_alloc (&line_data, __line_tags);                      \
@@ -70,6 +72,43 @@ extern "C"
 
 TEST_GROUP(GuiLine)
 {
+    /*
+     * Callback used to scan lines in tests.
+     */
+
+    static int
+    test_gui_line_scan_cb (void *data, struct t_gui_line_data *line_data)
+    {
+        return gui_line_match_text (line_data, GUI_BUFFER_SEARCH_IN_MESSAGE,
+                                    (const char *)data, 1, 0, NULL);
+    }
+
+    /*
+     * Returns messages of lines, separated by spaces (must be freed after
+     * use).
+     */
+
+    static char *
+    test_gui_line_messages (struct t_gui_lines *lines)
+    {
+        struct t_gui_line *ptr_line;
+        char **result;
+
+        result = string_dyn_alloc (64);
+        for (ptr_line = lines->first_line; ptr_line;
+             ptr_line = ptr_line->next_line)
+        {
+            if (ptr_line != lines->first_line)
+                string_dyn_concat (result, " ", -1);
+            string_dyn_concat (result, ptr_line->data->message, -1);
+            /* check links in both directions */
+            if (ptr_line->next_line)
+                POINTERS_EQUAL(ptr_line, ptr_line->next_line->prev_line);
+            else
+                POINTERS_EQUAL(ptr_line, lines->last_line);
+        }
+        return string_dyn_free (result, 0);
+    }
 };
 
 /*
@@ -94,6 +133,8 @@ TEST(GuiLine, LinesAlloc)
     LONGS_EQUAL(0, lines->buffer_max_length_refresh);
     LONGS_EQUAL(0, lines->prefix_max_length);
     LONGS_EQUAL(0, lines->prefix_max_length_refresh);
+    POINTERS_EQUAL(NULL, lines->prefix_length_count);
+    LONGS_EQUAL(0, lines->prefix_length_count_size);
 
     gui_line_lines_free (lines);
 
@@ -159,6 +200,72 @@ TEST(GuiLine, TagsAlloc)
     gui_line_tags_free (NULL);
 }
 
+/*
+ * Tests functions:
+ *   gui_line_data_get_size
+ *   gui_line_size_add
+ *   gui_line_size_remove
+ *   gui_line_size_update
+ */
+
+TEST(GuiLine, Size)
+{
+    struct t_gui_buffer *buffer;
+    struct t_gui_line *ptr_line;
+    struct t_hashtable *hashtable;
+    int size;
+
+    LONGS_EQUAL(0, gui_line_data_get_size (NULL));
+    gui_line_size_add (NULL);
+    gui_line_size_remove (NULL);
+    gui_line_size_update (NULL);
+
+    buffer = gui_buffer_new_user ("test", GUI_BUFFER_TYPE_FORMATTED);
+    CHECK(buffer);
+    LONGS_EQUAL(0, buffer->own_lines->lines_size);
+
+    gui_chat_printf_date_tags (buffer, 0, "tag1,tag2", "prefix\tmessage");
+    ptr_line = buffer->own_lines->last_line;
+    CHECK(ptr_line);
+    size = sizeof (struct t_gui_line) + sizeof (struct t_gui_line_data)
+        + strlen (ptr_line->data->str_time) + 1
+        + (3 * sizeof (char *))
+        + strlen ("message") + 1;
+    LONGS_EQUAL(size, gui_line_data_get_size (ptr_line->data));
+    LONGS_EQUAL(size, ptr_line->data->size);
+    LONGS_EQUAL(size, buffer->own_lines->lines_size);
+
+    gui_chat_printf (buffer, "second message");
+    LONGS_EQUAL(size + buffer->own_lines->last_line->data->size,
+                buffer->own_lines->lines_size);
+
+    /* update of message with hdata */
+    hashtable = hashtable_new (32,
+                               WEECHAT_HASHTABLE_STRING,
+                               WEECHAT_HASHTABLE_STRING,
+                               NULL, NULL);
+    CHECK(hashtable);
+    hashtable_set (hashtable, "message", "a longer message");
+    hdata_update (hook_hdata_get (NULL, "line_data"), ptr_line->data,
+                  hashtable);
+    hashtable_free (hashtable);
+    LONGS_EQUAL(size + strlen ("a longer message") - strlen ("message"),
+                ptr_line->data->size);
+    LONGS_EQUAL(ptr_line->data->size
+                + buffer->own_lines->last_line->data->size,
+                buffer->own_lines->lines_size);
+
+    /* remove the first line */
+    gui_line_free (buffer, ptr_line);
+    LONGS_EQUAL(buffer->own_lines->last_line->data->size,
+                buffer->own_lines->lines_size);
+
+    gui_buffer_clear (buffer);
+    LONGS_EQUAL(0, buffer->own_lines->lines_size);
+
+    gui_buffer_close (buffer);
+}
+
 /*
  * Tests functions:
  *   gui_line_prefix_is_same_nick
@@ -256,8 +363,7 @@ TEST(GuiLine, BuildStringMessageTags)
                                                        1,
                                                        NULL,
                                                        1));
-    gui_line_free_data (line);
-    free (line);
+    gui_line_free_new (line);
 
     snprintf (str_result, sizeof (str_result),
               "message%s [%s%s]",
@@ -389,6 +495,10 @@ TEST(GuiLine, GetNextDisplayed)
 
 TEST(GuiLine, SearchById)
 {
+    struct t_gui_buffer *buffer;
+    struct t_gui_line *ptr_line, *ptr_line2;
+    int i;
+
     POINTERS_EQUAL(NULL, gui_line_search_by_id (NULL, -1));
     POINTERS_EQUAL(NULL, gui_line_search_by_id (gui_buffers, -1));
 
@@ -396,6 +506,88 @@ TEST(GuiLine, SearchById)
         gui_buffers->own_lines->last_line,
         gui_line_search_by_id (gui_buffers,
                                gui_buffers->own_lines->last_line->data->id));
+
+    buffer = gui_buffer_new_user ("test", GUI_BUFFER_TYPE_FORMATTED);
+    CHECK(buffer);
+
+    POINTERS_EQUAL(NULL, gui_line_search_by_id (buffer, 0));
+
+    for (i = 0; i < 200; i++)
+    {
+        gui_chat_printf (buffer, "line %d", i);
+    }
+    LONGS_EQUAL(200, buffer->own_lines->id_index_count);
+    i = 0;
+    for (ptr_line = buffer->own_lines->first_line; ptr_line;
+         ptr_line = ptr_line->next_line)
+    {
+        LONGS_EQUAL(i, ptr_line->data->id);
+        POINTERS_EQUAL(ptr_line, gui_line_search_by_id (buffer, i));
+        i++;
+    }
+    POINTERS_EQUAL(NULL, gui_line_search_by_id (buffer, -1));
+    POINTERS_EQUAL(NULL, gui_line_search_by_id (buffer, 200));
+
+    /* remove first lines and a line in the middle */
+    for (i = 0; i < 10; i++)
+    {
+        gui_line_free (buffer, buffer->own_lines->first_line);
+    }
+    ptr_line = gui_line_search_by_id (buffer, 100);
+    CHECK(ptr_line);
+    gui_line_free (buffer, ptr_line);
+    LONGS_EQUAL(189, buffer->own_lines->id_index_count);
+    for (i = 0; i < 200; i++)
+    {
+        ptr_line = gui_line_search_by_id (buffer, i);
+        if ((i < 10) || (i == 100))
+        {
+            POINTERS_EQUAL(NULL, ptr_line);
+        }
+        else
+        {
+            CHECK(ptr_line);
+            LONGS_EQUAL(i, ptr_line->data->id);
+        }
+    }
+
+    /* simulate next_line_id reaching INT_MAX */
+    buffer->next_line_id = INT_MAX - 1;
+    gui_chat_printf (buffer, "line INT_MAX-1");
+    gui_chat_printf (buffer, "line INT_MAX");
+    gui_chat_printf (buffer, "line 0");
+    LONGS_EQUAL(0, buffer->own_lines->id_index_disabled);
+    POINTERS_EQUAL(buffer->own_lines->last_line->prev_line->prev_line,
+                   gui_line_search_by_id (buffer, INT_MAX - 1));
+    POINTERS_EQUAL(buffer->own_lines->last_line->prev_line,
+                   gui_line_search_by_id (buffer, INT_MAX));
+    POINTERS_EQUAL(buffer->own_lines->last_line,
+                   gui_line_search_by_id (buffer, 0));
+    ptr_line = gui_line_search_by_id (buffer, 50);
+    CHECK(ptr_line);
+    STRCMP_EQUAL("line 50", ptr_line->data->message);
+
+    /* duplicate id: the index is disabled, search is sequential */
+    buffer->next_line_id = 50;
+    gui_chat_printf (buffer, "line 50 (duplicate)");
+    LONGS_EQUAL(1, buffer->own_lines->id_index_disabled);
+    POINTERS_EQUAL(NULL, buffer->own_lines->id_index);
+    ptr_line2 = gui_line_search_by_id (buffer, 50);
+    POINTERS_EQUAL(buffer->own_lines->last_line, ptr_line2);
+    gui_line_free (buffer, ptr_line2);
+    POINTERS_EQUAL(ptr_line, gui_line_search_by_id (buffer, 50));
+    POINTERS_EQUAL(buffer->own_lines->last_line,
+                   gui_line_search_by_id (buffer, 0));
+
+    /* index is enabled again when the buffer is cleared */
+    gui_buffer_clear (buffer);
+    gui_chat_printf (buffer, "new line");
+    LONGS_EQUAL(0, buffer->own_lines->id_index_disabled);
+    LONGS_EQUAL(1, buffer->own_lines->id_index_count);
+    POINTERS_EQUAL(buffer->own_lines->last_line,
+                   gui_line_search_by_id (buffer, 51));
+
+    gui_buffer_close (buffer);
 }
 
 /*
@@ -408,6 +600,118 @@ TEST(GuiLine, SearchText)
     /* TODO: write tests */
 }
 
+/*
+ * Tests functions:
+ *   gui_line_match_text
+ */
+
+TEST(GuiLine, MatchText)
+{
+    struct t_gui_line_data line_data;
+    regex_t regex;
+    char prefix[32], message[64];
+
+    memset (&line_data, 0, sizeof (line_data));
+
+    LONGS_EQUAL(0, gui_line_match_text (NULL, GUI_BUFFER_SEARCH_IN_MESSAGE,
+                                        "test", 0, 0, NULL));
+    LONGS_EQUAL(0, gui_line_match_text (&line_data,
+                                        GUI_BUFFER_SEARCH_IN_MESSAGE,
+                                        "test", 0, 0, NULL));
+
+    snprintf (prefix, sizeof (prefix), "%salice", gui_color_get_custom ("red"));
+    snprintf (message, sizeof (message), "this is a %sTest",
+              gui_color_get_custom ("blue"));
+    line_data.prefix = prefix;
+    line_data.message = message;
+
+    LONGS_EQUAL(0, gui_line_match_text (&line_data,
+                                        GUI_BUFFER_SEARCH_IN_MESSAGE,
+                                        NULL, 0, 0, NULL));
+    LONGS_EQUAL(0, gui_line_match_text (&line_data,
+                                        GUI_BUFFER_SEARCH_IN_MESSAGE,
+                                        "", 0, 0, NULL));
+
+    /* text */
+    LONGS_EQUAL(1, gui_line_match_text (&line_data,
+                                        GUI_BUFFER_SEARCH_IN_MESSAGE,
+                                        "a test", 0, 0, NULL));
+    LONGS_EQUAL(0, gui_line_match_text (&line_data,
+                                        GUI_BUFFER_SEARCH_IN_MESSAGE,
+                                        "a test", 1, 0, NULL));
+    LONGS_EQUAL(1, gui_line_match_text (&line_data,
+                                        GUI_BUFFER_SEARCH_IN_MESSAGE,
+                                        "a Test", 1, 0, NULL));
+    LONGS_EQUAL(0, gui_line_match_text (&line_data,
+                                        GUI_BUFFER_SEARCH_IN_MESSAGE,
+                                        "alice", 0, 0, NULL));
+    LONGS_EQUAL(1, gui_line_match_text (&line_data,
+                                        GUI_BUFFER_SEARCH_IN_PREFIX,
+                                        "alice", 0, 0, NULL));
+    LONGS_EQUAL(1, gui_line_match_text (&line_data,
+                                        GUI_BUFFER_SEARCH_IN_PREFIX
+                                        | GUI_BUFFER_SEARCH_IN_MESSAGE,
+                                        "test", 0, 0, NULL));
+
+    /* regex */
+    LONGS_EQUAL(0, gui_line_match_text (&line_data,
+                                        GUI_BUFFER_SEARCH_IN_MESSAGE,
+                                        "a test", 0, 1, NULL));
+    LONGS_EQUAL(0, string_regcomp (&regex, "is a t.st$",
+                                   REG_EXTENDED | REG_NOSUB | REG_ICASE));
+    LONGS_EQUAL(1, gui_line_match_text (&line_data,
+                                        GUI_BUFFER_SEARCH_IN_MESSAGE,
+                                        "is a t.st$", 0, 1, &regex));
+    LONGS_EQUAL(0, gui_line_match_text (&line_data,
+                                        GUI_BUFFER_SEARCH_IN_PREFIX,
+                                        "is a t.st$", 0, 1, &regex));
+    regfree (&regex);
+}
+
+/*
+ * Tests functions:
+ *   gui_line_scan
+ */
+
+TEST(GuiLine, Scan)
+{
+    static struct t_gui_line_data *lines[10000], lines_data[10000];
+    static char messages[10000][32], results[10000];
+    char color[16];
+    int i, threads;
+
+    /* messages with colors use the buffer to remove colors (per thread) */
+    snprintf (color, sizeof (color), "%s", gui_color_get_custom ("red"));
+    memset (lines_data, 0, sizeof (lines_data));
+    for (i = 0; i < 10000; i++)
+    {
+        snprintf (messages[i], sizeof (messages[i]), "%sline %d",
+                  (i % 2 == 0) ? color : "", i);
+        lines_data[i].message = messages[i];
+        lines[i] = &lines_data[i];
+    }
+
+    /* invalid arguments */
+    gui_line_scan (NULL, 10, 1, &test_gui_line_scan_cb, NULL, results);
+    gui_line_scan (lines, 0, 1, &test_gui_line_scan_cb, NULL, results);
+    gui_line_scan (lines, 10, 1, NULL, NULL, results);
+    gui_line_scan (lines, 10, 1, &test_gui_line_scan_cb, NULL, NULL);
+
+    /* same result with lines scanned in threads or in main thread */
+    for (threads = 1; threads <= 4; threads++)
+    {
+        memset (results, 2, sizeof (results));
+        gui_line_scan (lines, 10000, threads,
+                       &test_gui_line_scan_cb, (void *)"9", results);
+        for (i = 0; i < 10000; i++)
+        {
+            LONGS_EQUAL((strchr (messages[i] + ((i % 2 == 0) ? strlen (color) : 0),
+                                 '9')) ? 1 : 0,
+                        results[i]);
+        }
+    }
+}
+
 /*
  * Tests functions:
  *   gui_line_match_regex
@@ -484,6 +788,19 @@ TEST(GuiLine, MatchTags)
     WEE_LINE_MATCH_TAGS(1, "irc_join,nick_test", "nick_test,irc_quit");
     WEE_LINE_MATCH_TAGS(1, "irc_join,nick_test", "!irc_quit,!irc_302,!irc_notice");
     WEE_LINE_MATCH_TAGS(1, "irc_join,nick_test", "!irc_quit+!irc_302+!irc_notice");
+
+    /* tags are case-insensitive */
+    WEE_LINE_MATCH_TAGS(1, "irc_join,nick_test", "IRC_JOIN");
+    WEE_LINE_MATCH_TAGS(1, "irc_join,nick_test", "irc_join+Nick_Test");
+    WEE_LINE_MATCH_TAGS(0, "irc_join,nick_test", "!IRC_JOIN");
+    WEE_LINE_MATCH_TAGS(0, "irc_join,nick_test", "irc_join_");
+
+    /* tags with wildcard */
+    WEE_LINE_MATCH_TAGS(1, "irc_join,nick_test", "nick_*");
+    WEE_LINE_MATCH_TAGS(1, "irc_join,nick_test", "NICK_T*");
+    WEE_LINE_MATCH_TAGS(1, "irc_join,nick_test", "irc_*+*_test");
+    WEE_LINE_MATCH_TAGS(0, "irc_join,nick_test", "nick_x*");
+    WEE_LINE_MATCH_TAGS(0, "irc_join,nick_test", "!irc_*");
 }
 
 /*
@@ -548,6 +865,41 @@ TEST(GuiLine, GetNickTag)
     free (line.data);
 }
 
+/*
+ * Tests functions:
+ *   gui_line_has_highlight_words
+ */
+
+TEST(GuiLine, HasHighlightWords)
+{
+    struct t_string_highlight *highlight, *ptr_highlight;
+
+    highlight = NULL;
+
+    LONGS_EQUAL(0, gui_line_has_highlight_words (&highlight, "test", NULL));
+    LONGS_EQUAL(0, gui_line_has_highlight_words (&highlight, "test", ""));
+    POINTERS_EQUAL(NULL, highlight);
+
+    LONGS_EQUAL(1, gui_line_has_highlight_words (&highlight, "a test",
+                                                 "abc,test"));
+    CHECK(highlight);
+    STRCMP_EQUAL("abc,test", highlight->highlight_words);
+    ptr_highlight = highlight;
+
+    /* same words: compiled highlight is reused */
+    LONGS_EQUAL(0, gui_line_has_highlight_words (&highlight, "a tester",
+                                                 "abc,test"));
+    POINTERS_EQUAL(ptr_highlight, highlight);
+
+    /* words changed: compiled again */
+    LONGS_EQUAL(1, gui_line_has_highlight_words (&highlight, "a tester",
+                                                 "abc,test*"));
+    CHECK(highlight);
+    STRCMP_EQUAL("abc,test*", highlight->highlight_words);
+
+    string_highlight_free (highlight);
+}
+
 /*
  * Tests functions:
  *   gui_line_has_highlight
@@ -590,12 +942,68 @@ TEST(GuiLine, ComputeBufferMaxLength)
 
 /*
  * Tests functions:
+ *   gui_line_prefix_align_length
+ *   gui_line_prefix_length_reset
+ *   gui_line_prefix_length_add
+ *   gui_line_prefix_length_remove
+ *   gui_line_prefix_length_update
+ *   gui_line_set_displayed
  *   gui_line_compute_prefix_max_length
  */
 
 TEST(GuiLine, ComputePrefixMaxLength)
 {
-    /* TODO: write tests */
+    struct t_gui_buffer *buffer;
+    struct t_gui_lines *lines;
+
+    buffer = gui_buffer_new_user ("test", GUI_BUFFER_TYPE_FORMATTED);
+    CHECK(buffer);
+    lines = buffer->own_lines;
+    LONGS_EQUAL(0, lines->prefix_max_length);
+
+    gui_chat_printf_date_tags (buffer, 0, NULL, "abc\tmessage 1");
+    gui_chat_printf_date_tags (buffer, 0, NULL, "abcdef\tmessage 2");
+    gui_chat_printf_date_tags (buffer, 0, NULL, "abcdef\tmessage 3");
+    LONGS_EQUAL(3, gui_line_prefix_align_length (lines->first_line->data));
+    LONGS_EQUAL(6, lines->prefix_max_length);
+    CHECK(lines->prefix_length_count_size > 6);
+    LONGS_EQUAL(1, lines->prefix_length_count[3]);
+    LONGS_EQUAL(2, lines->prefix_length_count[6]);
+
+    /* remove lines with max length */
+    gui_line_free (buffer, lines->last_line);
+    LONGS_EQUAL(6, lines->prefix_max_length);
+    gui_line_free (buffer, lines->last_line);
+    LONGS_EQUAL(3, lines->prefix_max_length);
+    LONGS_EQUAL(0, lines->prefix_length_count[6]);
+
+    /* hide and display line */
+    gui_line_set_displayed (lines->first_line->data, 0);
+    LONGS_EQUAL(0, lines->prefix_max_length);
+    LONGS_EQUAL(0, lines->prefix_length_count[3]);
+    gui_line_set_displayed (lines->first_line->data, 1);
+    LONGS_EQUAL(3, lines->prefix_max_length);
+    LONGS_EQUAL(1, lines->prefix_length_count[3]);
+
+    /* count is not changed by a line not displayed */
+    gui_line_prefix_length_remove (lines, 10);
+    gui_line_prefix_length_remove (lines, -1);
+    LONGS_EQUAL(3, lines->prefix_max_length);
+
+    /* full computation */
+    gui_chat_printf_date_tags (buffer, 0, NULL, "abcde\tmessage 4");
+    LONGS_EQUAL(5, lines->prefix_max_length);
+    gui_line_compute_prefix_max_length (lines);
+    LONGS_EQUAL(5, lines->prefix_max_length);
+    LONGS_EQUAL(1, lines->prefix_length_count[3]);
+    LONGS_EQUAL(1, lines->prefix_length_count[5]);
+    LONGS_EQUAL(0, lines->prefix_max_length_refresh);
+
+    gui_line_prefix_length_reset (lines);
+    LONGS_EQUAL(0, lines->prefix_max_length);
+    LONGS_EQUAL(0, lines->prefix_length_count[5]);
+
+    gui_buffer_close (buffer);
 }
 
 /*
@@ -611,6 +1019,7 @@ TEST(GuiLine, AddToList)
 /*
  * Tests functions:
  *   gui_line_free_data
+ *   gui_line_free_new
  */
 
 TEST(GuiLine, FreeData)
@@ -645,7 +1054,7 @@ TEST(GuiLine, MixedAdd)
 
 TEST(GuiLine, MixedFreeBuffer)
 {
-    /* TODO: write tests */
+    /* tested in test MixBuffers */
 }
 
 /*
@@ -655,7 +1064,7 @@ TEST(GuiLine, MixedFreeBuffer)
 
 TEST(GuiLine, MixedFreeAll)
 {
-    /* TODO: write tests */
+    /* tested in test MixBuffers */
 }
 
 /*
@@ -675,7 +1084,54 @@ TEST(GuiLine, Free)
 
 TEST(GuiLine, FreeAll)
 {
-    /* TODO: write tests */
+    struct t_gui_buffer *buffer1, *buffer2;
+    struct t_gui_lines *mixed_lines;
+    char *str;
+
+    buffer1 = gui_buffer_new_user ("test1", GUI_BUFFER_TYPE_FORMATTED);
+    CHECK(buffer1);
+    buffer2 = gui_buffer_new_user ("test2", GUI_BUFFER_TYPE_FORMATTED);
+    CHECK(buffer2);
+
+    gui_line_free_all (buffer1);
+    POINTERS_EQUAL(NULL, buffer1->own_lines->first_line);
+
+    gui_chat_printf_date_tags (buffer1, 100, NULL, "1a");
+    gui_chat_printf_date_tags (buffer1, 300, NULL, "1b");
+    gui_chat_printf_date_tags (buffer2, 200, NULL, "2a");
+    gui_chat_printf_date_tags (buffer2, 400, NULL, "2b");
+    buffer1->own_lines->last_read_line = buffer1->own_lines->last_line;
+    buffer1->own_lines->first_line_not_read = 0;
+    CHECK(buffer1->own_lines->lines_size > 0);
+
+    gui_buffer_merge (buffer2, buffer1);
+    mixed_lines = buffer1->mixed_lines;
+    CHECK(mixed_lines);
+    LONGS_EQUAL(4, mixed_lines->lines_count);
+
+    /* free lines of buffer1: they are removed from mixed lines too */
+    gui_line_free_all (buffer1);
+    POINTERS_EQUAL(NULL, buffer1->own_lines->first_line);
+    POINTERS_EQUAL(NULL, buffer1->own_lines->last_line);
+    LONGS_EQUAL(0, buffer1->own_lines->lines_count);
+    LONGS_EQUAL(0, buffer1->own_lines->lines_size);
+    POINTERS_EQUAL(NULL, buffer1->own_lines->last_read_line);
+    LONGS_EQUAL(1, buffer1->own_lines->first_line_not_read);
+    LONGS_EQUAL(2, mixed_lines->lines_count);
+    str = test_gui_line_messages (mixed_lines);
+    STRCMP_EQUAL("2a 2b", str);
+    free (str);
+    LONGS_EQUAL(2, buffer2->own_lines->lines_count);
+
+    /* lines can be added again */
+    gui_chat_printf_date_tags (buffer1, 500, NULL, "1c");
+    LONGS_EQUAL(1, buffer1->own_lines->lines_count);
+    str = test_gui_line_messages (mixed_lines);
+    STRCMP_EQUAL("2a 2b 1c", str);
+    free (str);
+
+    gui_buffer_close (buffer2);
+    gui_buffer_close (buffer1);
 }
 
 /*
@@ -1121,7 +1577,90 @@ TEST(GuiLine, Clear)
 
 TEST(GuiLine, MixBuffers)
 {
-    /* TODO: write tests */
+    struct t_gui_buffer *buffer1, *buffer2, *buffer3;
+    struct t_gui_lines *mixed_lines;
+    struct t_gui_line *ptr_line;
+    char *str;
+
+    buffer1 = gui_buffer_new_user ("test1", GUI_BUFFER_TYPE_FORMATTED);
+    CHECK(buffer1);
+    buffer2 = gui_buffer_new_user ("test2", GUI_BUFFER_TYPE_FORMATTED);
+    CHECK(buffer2);
+    buffer3 = gui_buffer_new_user ("test3", GUI_BUFFER_TYPE_FORMATTED);
+    CHECK(buffer3);
+
+    gui_chat_printf_date_tags (buffer1, 100, NULL, "1a");
+    gui_chat_printf_date_tags (buffer1, 300, NULL, "1b");
+    gui_chat_printf_date_tags (buffer1, 500, NULL, "1c");
+    gui_chat_printf_date_tags (buffer2, 200, NULL, "2a");
+    gui_chat_printf_date_tags (buffer2, 300, NULL, "2b");
+    gui_chat_printf_date_tags (buffer2, 600, NULL, "2c");
+    gui_chat_printf_date_tags (buffer3, 50, NULL, "3a");
+    gui_chat_printf_date_tags (buffer3, 400, NULL, "3b");
+
+    /* merge buffer2 into buffer1: mixed lines are created */
+    gui_buffer_merge (buffer2, buffer1);
+    mixed_lines = buffer1->mixed_lines;
+    CHECK(mixed_lines);
+    POINTERS_EQUAL(mixed_lines, buffer1->lines);
+    POINTERS_EQUAL(mixed_lines, buffer2->mixed_lines);
+    POINTERS_EQUAL(mixed_lines, buffer2->lines);
+    LONGS_EQUAL(6, mixed_lines->lines_count);
+    LONGS_EQUAL(1, mixed_lines->prefix_max_length_refresh);
+    LONGS_EQUAL(1, mixed_lines->buffer_max_length_refresh);
+    str = test_gui_line_messages (mixed_lines);
+    STRCMP_EQUAL("1a 2a 1b 2b 1c 2c", str);
+    free (str);
+
+    /* merge buffer3: lines are inserted in same mixed lines */
+    ptr_line = mixed_lines->first_line;
+    gui_buffer_merge (buffer3, buffer1);
+    POINTERS_EQUAL(mixed_lines, buffer1->mixed_lines);
+    POINTERS_EQUAL(mixed_lines, buffer3->mixed_lines);
+    POINTERS_EQUAL(ptr_line, mixed_lines->first_line->next_line);
+    LONGS_EQUAL(8, mixed_lines->lines_count);
+    str = test_gui_line_messages (mixed_lines);
+    STRCMP_EQUAL("3a 1a 2a 1b 2b 3b 1c 2c", str);
+    free (str);
+
+    /* unmerge buffer2: its lines are removed from mixed lines */
+    gui_buffer_unmerge (buffer2, -1);
+    POINTERS_EQUAL(NULL, buffer2->mixed_lines);
+    POINTERS_EQUAL(buffer2->own_lines, buffer2->lines);
+    POINTERS_EQUAL(mixed_lines, buffer1->mixed_lines);
+    LONGS_EQUAL(5, mixed_lines->lines_count);
+    str = test_gui_line_messages (mixed_lines);
+    STRCMP_EQUAL("3a 1a 1b 3b 1c", str);
+    free (str);
+    str = test_gui_line_messages (buffer2->own_lines);
+    STRCMP_EQUAL("2a 2b 2c", str);
+    free (str);
+
+    /* unmerge buffer3: all mixed lines are freed */
+    gui_buffer_unmerge (buffer3, -1);
+    POINTERS_EQUAL(NULL, buffer1->mixed_lines);
+    POINTERS_EQUAL(NULL, buffer3->mixed_lines);
+    POINTERS_EQUAL(buffer1->own_lines, buffer1->lines);
+
+    /* merge a group of merged buffers into a buffer (lines are moved) */
+    gui_buffer_merge (buffer3, buffer2);
+    mixed_lines = buffer2->mixed_lines;
+    CHECK(mixed_lines);
+    str = test_gui_line_messages (mixed_lines);
+    STRCMP_EQUAL("3a 2a 2b 3b 2c", str);
+    free (str);
+    gui_buffer_merge (buffer2, buffer1);
+    CHECK(buffer1->mixed_lines);
+    POINTERS_EQUAL(buffer1->mixed_lines, buffer2->mixed_lines);
+    POINTERS_EQUAL(buffer1->mixed_lines, buffer3->mixed_lines);
+    LONGS_EQUAL(8, buffer1->mixed_lines->lines_count);
+    str = test_gui_line_messages (buffer1->mixed_lines);
+    STRCMP_EQUAL("3a 1a 2a 1b 2b 3b 1c 2c", str);
+    free (str);
+
+    gui_buffer_close (buffer3);
+    gui_buffer_close (buffer2);
+    gui_buffer_close (buffer1);
 }
 
 /*
@@ -24,6 +24,7 @@
 extern "C"
 {
 #include "src/core/core-config.h"
+#include "src/core/core-hashtable.h"
 #include "src/core/core-string.h"
 #include "src/gui/gui-color.h"
 #include "src/gui/gui-nick.h"
@@ -401,3 +402,67 @@ TEST(GuiNick, FindColor)
     WEE_FIND_COLOR("magenta", "ABCDEF]^", 29, "red,blue,214,magenta,yellow");
     WEE_FIND_COLOR("yellow", "ABCDEF]^", 26, "red,blue,214,magenta,yellow");
 }
+
+/*
+ * Tests functions:
+ *   gui_nick_color_cache_clear
+ *   gui_nick_find_color_name (with cache)
+ */
+
+TEST(GuiNick, ColorCache)
+{
+    const char *result_color;
+    char *color, nick[512];
+
+    gui_nick_color_cache_clear ();
+    if (gui_nick_color_cache)
+        LONGS_EQUAL(0, gui_nick_color_cache->items_count);
+
+    /* colors are cached by nick and case range */
+    WEE_FIND_COLOR("212", "abcdef", -1, NULL);
+    WEE_FIND_COLOR("212", "abcdef", -1, NULL);
+    WEE_FIND_COLOR("186", "ABCDEF]^", 0, NULL);
+    CHECK(gui_nick_color_cache);
+    LONGS_EQUAL(2, gui_nick_color_cache->items_count);
+    STRCMP_EQUAL("212", (const char *)hashtable_get (gui_nick_color_cache,
+                                                     "-1:abcdef"));
+    STRCMP_EQUAL("186", (const char *)hashtable_get (gui_nick_color_cache,
+                                                     "0:ABCDEF]^"));
+
+    /* custom colors are not cached */
+    WEE_FIND_COLOR("214", "abcdef", -1, "red,blue,214,magenta");
+    LONGS_EQUAL(2, gui_nick_color_cache->items_count);
+
+    /* very long nick is not cached */
+    memset (nick, 'a', sizeof (nick) - 1);
+    nick[sizeof (nick) - 1] = '\0';
+    color = gui_nick_find_color_name (nick, -1, NULL);
+    CHECK(color);
+    free (color);
+    LONGS_EQUAL(2, gui_nick_color_cache->items_count);
+
+    /* cache is cleared when an option is changed */
+    config_file_option_set (config_look_nick_color_hash_salt, "abc", 1);
+    LONGS_EQUAL(0, gui_nick_color_cache->items_count);
+    WEE_FIND_COLOR("167", "abcdef", -1, NULL);
+    config_file_option_reset (config_look_nick_color_hash_salt, 1);
+    LONGS_EQUAL(0, gui_nick_color_cache->items_count);
+    WEE_FIND_COLOR("212", "abcdef", -1, NULL);
+
+    config_file_option_set (config_look_nick_color_force, "abcdef:green", 1);
+    LONGS_EQUAL(0, gui_nick_color_cache->items_count);
+    WEE_FIND_COLOR("green", "abcdef", -1, NULL);
+    config_file_option_reset (config_look_nick_color_force, 1);
+    WEE_FIND_COLOR("212", "abcdef", -1, NULL);
+
+    config_file_option_set (config_look_nick_color_stop_chars, "", 1);
+    LONGS_EQUAL(0, gui_nick_color_cache->items_count);
+    config_file_option_reset (config_look_nick_color_stop_chars, 1);
+    config_file_option_set (config_look_nick_color_hash, "sum", 1);
+    LONGS_EQUAL(0, gui_nick_color_cache->items_count);
+    config_file_option_reset (config_look_nick_color_hash, 1);
+
+    WEE_FIND_COLOR("212", "abcdef", -1, NULL);
+    gui_nick_color_cache_clear ();
+    LONGS_EQUAL(0, gui_nick_color_cache->items_count);
+}
@@ -21,11 +21,24 @@
 
 #include "CppUTest/TestHarness.h"
 
+#include "tests/tests.h"
+
 extern "C"
 {
 #include <string.h>
+#include "src/core/core-arraylist.h"
+#include "src/core/core-hashtable.h"
+#include "src/core/core-string.h"
 #include "src/gui/gui-buffer.h"
 #include "src/gui/gui-nicklist.h"
+
+extern int gui_nicklist_group_is_in_group (struct t_gui_nick_group *group,
+                                           struct t_gui_nick_group *from_group);
+extern struct t_gui_nick *gui_nicklist_find_pos_nick (struct t_gui_nick_group *group,
+                                                      struct t_gui_nick *nick);
+extern int gui_nicklist_nick_sorted_index (struct t_gui_nick_group *group,
+                                           const char *name, int after_equal);
+extern char *gui_nicklist_nick_name_key (const char *name);
 }
 
 #define TEST_BUFFER_NAME "test"
@@ -294,10 +307,15 @@ TEST(GuiNicklist, AddNick)
                                                 "nick_root", "green",
                                                 "@", "lightgreen", 1));
 
+    /* only root group */
+    LONGS_EQUAL(sizeof (struct t_gui_nick_group), buffer->nicklist_size);
+
     nick_root = gui_nicklist_add_nick (buffer, NULL,
                                        "nick_root", "green",
                                        "@", "lightgreen", 1);
     CHECK(nick_root);
+    LONGS_EQUAL(sizeof (struct t_gui_nick_group) + sizeof (struct t_gui_nick),
+                buffer->nicklist_size);
     CHECK(nick_root->id > 0);
     POINTERS_EQUAL(buffer->nicklist_root, nick_root->group);
     STRCMP_EQUAL("nick_root", nick_root->name);
@@ -403,12 +421,20 @@ TEST(GuiNicklist, AddNick)
     gui_nicklist_remove_nick (buffer, NULL);
     gui_nicklist_remove_nick (NULL, nick_root);
 
+    LONGS_EQUAL((3 * sizeof (struct t_gui_nick_group))
+                + (4 * sizeof (struct t_gui_nick)),
+                buffer->nicklist_size);
+
     gui_nicklist_remove_nick (buffer, nick_root);
     POINTERS_EQUAL(NULL, gui_nicklist_search_nick (buffer, NULL, "nick_root"));
     POINTERS_EQUAL(NULL, buffer->nicklist_root->nicks);
     POINTERS_EQUAL(NULL, buffer->nicklist_root->last_nick);
+    LONGS_EQUAL((3 * sizeof (struct t_gui_nick_group))
+                + (3 * sizeof (struct t_gui_nick)),
+                buffer->nicklist_size);
 
     gui_nicklist_remove_all (buffer);
+    LONGS_EQUAL(sizeof (struct t_gui_nick_group), buffer->nicklist_size);
     POINTERS_EQUAL(NULL, gui_nicklist_search_nick (buffer, NULL, "nick1"));
     POINTERS_EQUAL(NULL, gui_nicklist_search_nick (buffer, NULL, "nick2"));
     POINTERS_EQUAL(NULL, gui_nicklist_search_nick (buffer, NULL, "nick3"));
@@ -418,6 +444,185 @@ TEST(GuiNicklist, AddNick)
     gui_buffer_close (buffer);
 }
 
+/*
+ * Tests functions:
+ *   gui_nicklist_nick_sorted_index
+ *   gui_nicklist_find_pos_nick
+ *   gui_nicklist_insert_nick_sorted
+ *   gui_nicklist_remove_nick_sorted
+ */
+
+TEST(GuiNicklist, NickSorted)
+{
+    struct t_gui_buffer *buffer;
+    struct t_gui_nick_group *root;
+    struct t_gui_nick *ptr_nick, *nick_b;
+    char name[32];
+    int i, count;
+
+    buffer = gui_buffer_new (NULL, TEST_BUFFER_NAME,
+                             NULL, NULL, NULL,
+                             NULL, NULL, NULL);
+    CHECK(buffer);
+    root = buffer->nicklist_root;
+
+    POINTERS_EQUAL(NULL, root->nicks_sorted);
+    LONGS_EQUAL(0, gui_nicklist_nick_sorted_index (root, "nick", 0));
+
+    /* add nicks in a non-sorted order */
+    for (i = 0; i < 100; i++)
+    {
+        snprintf (name, sizeof (name), "nick%02d", (i * 37) % 100);
+        CHECK(gui_nicklist_add_nick (buffer, NULL, name, NULL, NULL, NULL, 1));
+    }
+    nick_b = gui_nicklist_add_nick (buffer, NULL, "B", NULL, NULL, NULL, 1);
+    CHECK(nick_b);
+    CHECK(gui_nicklist_add_nick (buffer, NULL, "a", NULL, NULL, NULL, 1));
+    LONGS_EQUAL(102, arraylist_size (root->nicks_sorted));
+
+    LONGS_EQUAL(0, gui_nicklist_nick_sorted_index (root, "a", 0));
+    LONGS_EQUAL(1, gui_nicklist_nick_sorted_index (root, "a", 1));
+    LONGS_EQUAL(1, gui_nicklist_nick_sorted_index (root, "b", 0));
+    LONGS_EQUAL(2, gui_nicklist_nick_sorted_index (root, "b", 1));
+    LONGS_EQUAL(102, gui_nicklist_nick_sorted_index (root, "zzz", 0));
+    POINTERS_EQUAL(nick_b, gui_nicklist_find_pos_nick (root, root->nicks));
+
+    /* linked list and sorted array are in the same order */
+    count = 0;
+    for (ptr_nick = root->nicks; ptr_nick; ptr_nick = ptr_nick->next_nick)
+    {
+        POINTERS_EQUAL(ptr_nick, arraylist_get (root->nicks_sorted, count));
+        if (ptr_nick->next_nick)
+        {
+            CHECK(string_strcasecmp (ptr_nick->name,
+                                     ptr_nick->next_nick->name) < 0);
+        }
+        count++;
+    }
+    LONGS_EQUAL(102, count);
+    STRCMP_EQUAL("a", root->nicks->name);
+    STRCMP_EQUAL("nick99", root->last_nick->name);
+
+    /* remove nicks */
+    gui_nicklist_remove_nick (buffer, nick_b);
+    gui_nicklist_remove_nick (buffer, root->last_nick);
+    LONGS_EQUAL(100, arraylist_size (root->nicks_sorted));
+    STRCMP_EQUAL("nick98", root->last_nick->name);
+    POINTERS_EQUAL(root->last_nick, arraylist_get (root->nicks_sorted, 99));
+    STRCMP_EQUAL("nick00",
+                 ((struct t_gui_nick *)arraylist_get (root->nicks_sorted,
+                                                      1))->name);
+
+    gui_nicklist_remove_all (buffer);
+    LONGS_EQUAL(0, arraylist_size (root->nicks_sorted));
+
+    gui_buffer_close (buffer);
+}
+
+/*
+ * Tests functions:
+ *   gui_nicklist_group_is_in_group
+ *   gui_nicklist_group_index_add
+ *   gui_nicklist_group_index_remove
+ *   gui_nicklist_nick_name_key
+ *   gui_nicklist_nick_index_add
+ *   gui_nicklist_nick_index_remove
+ */
+
+TEST(GuiNicklist, Index)
+{
+    struct t_gui_buffer *buffer;
+    struct t_gui_nick_group *group1, *group2, *subgroup1, *subgroup2;
+    struct t_gui_nick *nick1, *nick2, *nick3;
+    char *str, str_search_id[128];
+
+    WEE_TEST_STR(NULL, gui_nicklist_nick_name_key (NULL));
+    WEE_TEST_STR("", gui_nicklist_nick_name_key (""));
+    WEE_TEST_STR("nick", gui_nicklist_nick_name_key ("NiCk"));
+    WEE_TEST_STR("nick{|}~_", gui_nicklist_nick_name_key ("NICK[\\]^_"));
+
+    buffer = gui_buffer_new (NULL, TEST_BUFFER_NAME,
+                             NULL, NULL, NULL,
+                             NULL, NULL, NULL);
+    CHECK(buffer);
+
+    group1 = gui_nicklist_add_group (buffer, NULL, "01|group", "blue", 1);
+    CHECK(group1);
+    group2 = gui_nicklist_add_group (buffer, NULL, "02|other", "blue", 1);
+    CHECK(group2);
+    subgroup1 = gui_nicklist_add_group (buffer, group1, "04|group", "red", 1);
+    CHECK(subgroup1);
+    subgroup2 = gui_nicklist_add_group (buffer, group2, "03|group", "red", 1);
+    CHECK(subgroup2);
+
+    LONGS_EQUAL(1, gui_nicklist_group_is_in_group (group1, NULL));
+    LONGS_EQUAL(1, gui_nicklist_group_is_in_group (group1, group1));
+    LONGS_EQUAL(1, gui_nicklist_group_is_in_group (subgroup1, group1));
+    LONGS_EQUAL(1, gui_nicklist_group_is_in_group (subgroup1,
+                                                   buffer->nicklist_root));
+    LONGS_EQUAL(0, gui_nicklist_group_is_in_group (subgroup2, group1));
+    LONGS_EQUAL(0, gui_nicklist_group_is_in_group (group1, subgroup1));
+
+    /* groups with same key ("group") */
+    LONGS_EQUAL(5, buffer->nicklist_groups_by_id->items_count);
+    LONGS_EQUAL(3, buffer->nicklist_groups_by_name->items_count);
+    POINTERS_EQUAL(group1, gui_nicklist_search_group (buffer, NULL, "group"));
+    POINTERS_EQUAL(group1, gui_nicklist_search_group (buffer, NULL, "01|group"));
+    POINTERS_EQUAL(subgroup2, gui_nicklist_search_group (buffer, NULL, "03|group"));
+    POINTERS_EQUAL(subgroup1, gui_nicklist_search_group (buffer, subgroup1, "group"));
+    POINTERS_EQUAL(subgroup2, gui_nicklist_search_group (buffer, group2, "group"));
+    POINTERS_EQUAL(NULL, gui_nicklist_search_group (buffer, group2, "01|group"));
+
+    /* groups without buffer (no index) */
+    POINTERS_EQUAL(subgroup2, gui_nicklist_search_group (NULL, group2, "group"));
+    snprintf (str_search_id, sizeof (str_search_id), "==id:%lld", subgroup2->id);
+    POINTERS_EQUAL(subgroup2, gui_nicklist_search_group (NULL, group2, str_search_id));
+    POINTERS_EQUAL(NULL, gui_nicklist_search_group (NULL, group1, str_search_id));
+
+    /* remove the first group of the chain */
+    gui_nicklist_remove_group (buffer, group1);
+    LONGS_EQUAL(3, buffer->nicklist_groups_by_id->items_count);
+    LONGS_EQUAL(3, buffer->nicklist_groups_by_name->items_count);
+    POINTERS_EQUAL(subgroup2, gui_nicklist_search_group (buffer, NULL, "group"));
+    POINTERS_EQUAL(NULL, gui_nicklist_search_group (buffer, NULL, "01|group"));
+
+    /* nicks with same key ("nick[]" and "NICK{}") */
+    nick1 = gui_nicklist_add_nick (buffer, NULL, "nick[]", NULL, NULL, NULL, 1);
+    CHECK(nick1);
+    nick2 = gui_nicklist_add_nick (buffer, group2, "NICK{}", NULL, NULL, NULL, 1);
+    CHECK(nick2);
+    nick3 = gui_nicklist_add_nick (buffer, subgroup2, "nick3", NULL, NULL, NULL, 1);
+    CHECK(nick3);
+    LONGS_EQUAL(3, buffer->nicklist_nicks_by_id->items_count);
+    LONGS_EQUAL(2, buffer->nicklist_nicks_by_name->items_count);
+    POINTERS_EQUAL(nick1, gui_nicklist_search_nick (buffer, NULL, "nick[]"));
+    POINTERS_EQUAL(nick2, gui_nicklist_search_nick (buffer, NULL, "NICK{}"));
+    POINTERS_EQUAL(NULL, gui_nicklist_search_nick (buffer, NULL, "nick{}"));
+    POINTERS_EQUAL(NULL, gui_nicklist_search_nick (buffer, group2, "nick[]"));
+    POINTERS_EQUAL(nick3, gui_nicklist_search_nick (buffer, group2, "nick3"));
+
+    /* change of nick id */
+    snprintf (str_search_id, sizeof (str_search_id), "==id:%lld", nick3->id);
+    gui_nicklist_nick_set (buffer, nick3, "id", "123");
+    POINTERS_EQUAL(NULL, gui_nicklist_search_nick (buffer, NULL, str_search_id));
+    POINTERS_EQUAL(nick3, gui_nicklist_search_nick (buffer, NULL, "==id:123"));
+
+    /* remove the first nick of the chain */
+    gui_nicklist_remove_nick (buffer, nick1);
+    LONGS_EQUAL(2, buffer->nicklist_nicks_by_id->items_count);
+    LONGS_EQUAL(2, buffer->nicklist_nicks_by_name->items_count);
+    POINTERS_EQUAL(NULL, gui_nicklist_search_nick (buffer, NULL, "nick[]"));
+    POINTERS_EQUAL(nick2, gui_nicklist_search_nick (buffer, NULL, "NICK{}"));
+
+    gui_nicklist_remove_all (buffer);
+    LONGS_EQUAL(1, buffer->nicklist_groups_by_id->items_count);
+    LONGS_EQUAL(1, buffer->nicklist_groups_by_name->items_count);
+    LONGS_EQUAL(0, buffer->nicklist_nicks_by_id->items_count);
+    LONGS_EQUAL(0, buffer->nicklist_nicks_by_name->items_count);
+
+    gui_buffer_close (buffer);
+}
+
 /*
  * Tests functions:
  *   gui_nicklist_get_next_item
@@ -0,0 +1,76 @@
+/*
+ * test-fset-option.cpp - test fset option functions
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+#include "tests/tests.h"
+
+extern "C"
+{
+#include "src/plugins/fset/fset-option.h"
+}
+
+TEST_GROUP(FsetOption)
+{
+};
+
+/*
+ * Tests functions:
+ *   fset_option_filter_is_narrower
+ */
+
+TEST(FsetOption, FilterIsNarrower)
+{
+    LONGS_EQUAL(0, fset_option_filter_is_narrower (NULL, NULL));
+    LONGS_EQUAL(0, fset_option_filter_is_narrower ("irc", NULL));
+
+    /* no filter before: all options are in list */
+    LONGS_EQUAL(1, fset_option_filter_is_narrower (NULL, "irc"));
+    LONGS_EQUAL(1, fset_option_filter_is_narrower (NULL, "c:${type} == color"));
+
+    /* filter by name */
+    LONGS_EQUAL(1, fset_option_filter_is_narrower ("irc", "irc"));
+    LONGS_EQUAL(1, fset_option_filter_is_narrower ("irc", "irc.look"));
+    LONGS_EQUAL(0, fset_option_filter_is_narrower ("irc.look", "irc"));
+    LONGS_EQUAL(0, fset_option_filter_is_narrower ("irc", "xirc"));
+    LONGS_EQUAL(0, fset_option_filter_is_narrower ("irc", "irc.*"));
+    LONGS_EQUAL(0, fset_option_filter_is_narrower ("irc*", "irc*look"));
+
+    /* filter by value / help / changed options */
+    LONGS_EQUAL(1, fset_option_filter_is_narrower ("=", "=red"));
+    LONGS_EQUAL(1, fset_option_filter_is_narrower ("=re", "=red"));
+    LONGS_EQUAL(1, fset_option_filter_is_narrower ("d:irc", "d:irc.look"));
+    LONGS_EQUAL(1, fset_option_filter_is_narrower ("d=o", "d=on"));
+    LONGS_EQUAL(1, fset_option_filter_is_narrower ("h=co", "h=color"));
+    LONGS_EQUAL(1, fset_option_filter_is_narrower ("he=co", "he=color"));
+
+    /* different kinds of filter */
+    LONGS_EQUAL(0, fset_option_filter_is_narrower ("=", "==red"));
+    LONGS_EQUAL(0, fset_option_filter_is_narrower ("h", "h=color"));
+    LONGS_EQUAL(0, fset_option_filter_is_narrower ("d", "d:irc"));
+    LONGS_EQUAL(0, fset_option_filter_is_narrower ("d=", "d==on"));
+
+    /* filters not matching a substring */
+    LONGS_EQUAL(0, fset_option_filter_is_narrower ("f:irc", "f:irc"));
+    LONGS_EQUAL(0, fset_option_filter_is_narrower ("t:int", "t:integer"));
+    LONGS_EQUAL(0, fset_option_filter_is_narrower ("==on", "==on"));
+    LONGS_EQUAL(0, fset_option_filter_is_narrower ("c:1", "c:1 && 1"));
+}
@@ -190,12 +190,34 @@ TEST(IrcBatch, AddMessage)
                                    NULL);
     CHECK(batch);
 
-    irc_batch_add_message (server, "ref", ":alice PRIVMSG #test: test1");
+    LONGS_EQUAL(0, irc_batch_add_message (NULL, "ref", "test", NULL, NULL));
+    LONGS_EQUAL(0, irc_batch_add_message (server, NULL, "test", NULL, NULL));
+    LONGS_EQUAL(0, irc_batch_add_message (server, "ref", NULL, NULL, NULL));
+    LONGS_EQUAL(0, irc_batch_add_message (server, "unknown", "test",
+                                          NULL, NULL));
+    POINTERS_EQUAL(NULL, batch->messages);
+    LONGS_EQUAL(0, batch->num_msgs);
+
+    LONGS_EQUAL(1, irc_batch_add_message (server, "ref",
+                                          ":alice PRIVMSG #test: test1",
+                                          "PRIVMSG", "#test"));
     STRCMP_EQUAL(*batch->messages, ":alice PRIVMSG #test: test1");
-    irc_batch_add_message (server, "ref", ":alice PRIVMSG #test: test2");
+    LONGS_EQUAL(1, irc_batch_add_message (server, "ref",
+                                          ":bob PRIVMSG #test: test2",
+                                          NULL, NULL));
     STRCMP_EQUAL(*batch->messages,
                  ":alice PRIVMSG #test: test1\n"
-                 ":alice PRIVMSG #test: test2");
+                 ":bob PRIVMSG #test: test2");
+    LONGS_EQUAL(2, batch->num_msgs);
+    CHECK(batch->size_msgs >= 2);
+    LONGS_EQUAL(0, batch->msgs[0].offset);
+    LONGS_EQUAL(27, batch->msgs[0].length);
+    STRCMP_EQUAL("PRIVMSG", batch->msgs[0].command);
+    STRCMP_EQUAL("#test", batch->msgs[0].channel);
+    LONGS_EQUAL(28, batch->msgs[1].offset);
+    LONGS_EQUAL(25, batch->msgs[1].length);
+    POINTERS_EQUAL(NULL, batch->msgs[1].command);
+    POINTERS_EQUAL(NULL, batch->msgs[1].channel);
 
     irc_batch_free (server, batch);
 
@@ -21,10 +21,21 @@
 
 #include "CppUTest/TestHarness.h"
 
+#include "tests/tests.h"
+
 extern "C"
 {
 #include <string.h>
+#include "src/core/core-config-file.h"
+#include "src/core/core-hashtable.h"
+#include "src/core/core-hook.h"
+#include "src/gui/gui-buffer.h"
+#include "src/gui/gui-nicklist.h"
+#include "src/gui/gui-window.h"
+#include "src/plugins/plugin.h"
 #include "src/plugins/irc/irc-channel.h"
+#include "src/plugins/irc/irc-config.h"
+#include "src/plugins/irc/irc-nick.h"
 #include "src/plugins/irc/irc-server.h"
 }
 
@@ -93,3 +104,176 @@ TEST(IrcChannel, IsChannel)
 
     irc_server_free (server);
 }
+
+/*
+ * Tests functions:
+ *   irc_channel_nicklist_check_lazy
+ *   irc_channel_nicklist_fill
+ *   irc_channel_nicklist_fill_all
+ *   irc_channel_nicklist_signal_cb
+ */
+
+TEST(IrcChannel, NicklistLazy)
+{
+    struct t_irc_server *server;
+    struct t_irc_channel *channel;
+    struct t_gui_buffer *old_buffer;
+
+    run_cmd_quiet ("/mute /server add local fake:127.0.0.1");
+    run_cmd_quiet ("/connect local");
+
+    server = irc_server_search ("local");
+    CHECK(server);
+
+    channel = irc_channel_new (server, IRC_CHANNEL_TYPE_CHANNEL, "#test", 0, 0);
+    CHECK(channel);
+    CHECK(channel->buffer);
+    POINTERS_EQUAL(NULL, gui_window_search_with_buffer (channel->buffer));
+
+    irc_channel_nicklist_check_lazy (NULL, NULL);
+    irc_channel_nicklist_fill (NULL, NULL);
+
+    /* option disabled: nicks are always added in nicklist */
+    irc_nick_new (server, channel, "alice", NULL, NULL, 0, NULL, NULL);
+    irc_nick_new (server, channel, "bob", NULL, NULL, 0, NULL, NULL);
+    irc_nick_new (server, channel, "carol", NULL, NULL, 0, NULL, NULL);
+    LONGS_EQUAL(0, channel->nicklist_lazy);
+    LONGS_EQUAL(3, channel->buffer->nicklist_nicks_count);
+
+    /* channel with 4 nicks (or more) and not displayed: nicklist is empty */
+    config_file_option_set (irc_config_look_nicklist_lazy_min_nicks, "4", 1);
+    irc_nick_new (server, channel, "dave", NULL, NULL, 0, NULL, NULL);
+    LONGS_EQUAL(1, channel->nicklist_lazy);
+    LONGS_EQUAL(0, channel->buffer->nicklist_nicks_count);
+    irc_nick_new (server, channel, "eve", NULL, "@", 0, NULL, NULL);
+    irc_nick_change (server, channel, irc_nick_search (server, channel, "bob"),
+                     "bob2");
+    irc_nick_free (server, channel, irc_nick_search (server, channel, "carol"));
+    LONGS_EQUAL(4, channel->nicks_count);
+    LONGS_EQUAL(0, channel->buffer->nicklist_nicks_count);
+
+    /* nicklist requested (for example by relay) */
+    (void) hook_signal_send ("buffer_nicklist_request",
+                             WEECHAT_HOOK_SIGNAL_POINTER, channel->buffer);
+    LONGS_EQUAL(0, channel->nicklist_lazy);
+    LONGS_EQUAL(4, channel->buffer->nicklist_nicks_count);
+    CHECK(gui_nicklist_search_nick (channel->buffer, NULL, "bob2"));
+    CHECK(gui_nicklist_search_nick (channel->buffer, NULL, "eve"));
+    POINTERS_EQUAL(NULL, gui_nicklist_search_nick (channel->buffer, NULL,
+                                                   "carol"));
+
+    /* channel joined (end of names received): nicklist is kept */
+    hashtable_set (channel->join_msg_received, "366", "1");
+    irc_nick_new (server, channel, "frank", NULL, NULL, 0, NULL, NULL);
+    LONGS_EQUAL(0, channel->nicklist_lazy);
+    LONGS_EQUAL(5, channel->buffer->nicklist_nicks_count);
+    hashtable_remove (channel->join_msg_received, "366");
+
+    /* buffer displayed in a window */
+    irc_channel_nicklist_check_lazy (server, channel);
+    LONGS_EQUAL(1, channel->nicklist_lazy);
+    old_buffer = gui_current_window->buffer;
+    gui_window_switch_to_buffer (gui_current_window, channel->buffer, 0);
+    LONGS_EQUAL(0, channel->nicklist_lazy);
+    LONGS_EQUAL(5, channel->buffer->nicklist_nicks_count);
+    irc_channel_nicklist_check_lazy (server, channel);
+    LONGS_EQUAL(0, channel->nicklist_lazy);
+    gui_window_switch_to_buffer (gui_current_window, old_buffer, 0);
+
+    /* option changed: nicklist is filled */
+    irc_channel_nicklist_check_lazy (server, channel);
+    LONGS_EQUAL(1, channel->nicklist_lazy);
+    config_file_option_reset (irc_config_look_nicklist_lazy_min_nicks, 1);
+    LONGS_EQUAL(0, channel->nicklist_lazy);
+    LONGS_EQUAL(5, channel->buffer->nicklist_nicks_count);
+
+    irc_nick_free_all (server, channel);
+
+    if (channel->buffer)
+        gui_buffer_close (channel->buffer);
+
+    run_cmd_quiet ("/mute /disconnect local");
+    run_cmd_quiet ("/mute /server del local");
+}
+
+/*
+ * Tests functions:
+ *   irc_channel_nicklist_names_start
+ *   irc_channel_nicklist_names_end
+ *   irc_channel_nicklist_fill_cmp_cb
+ */
+
+TEST(IrcChannel, NicklistNames)
+{
+    struct t_irc_server *server;
+    struct t_irc_channel *channel;
+    struct t_gui_nick *ptr_nick;
+
+    run_cmd_quiet ("/mute /server add local fake:127.0.0.1");
+    run_cmd_quiet ("/connect local");
+
+    server = irc_server_search ("local");
+    CHECK(server);
+
+    channel = irc_channel_new (server, IRC_CHANNEL_TYPE_CHANNEL, "#test", 0, 0);
+    CHECK(channel);
+
+    irc_channel_nicklist_names_start (NULL, NULL);
+    irc_channel_nicklist_names_end (NULL, NULL);
+
+    /* self nick added on join */
+    irc_nick_new (server, channel, "alice", NULL, NULL, 0, NULL, NULL);
+    LONGS_EQUAL(1, channel->buffer->nicklist_nicks_count);
+
+    /* names received: nicks are not yet in nicklist */
+    irc_channel_nicklist_names_start (server, channel);
+    LONGS_EQUAL(1, channel->nicklist_lazy);
+    LONGS_EQUAL(1, channel->nicklist_names);
+    LONGS_EQUAL(0, channel->buffer->nicklist_nicks_count);
+    irc_nick_new (server, channel, "dave", NULL, NULL, 0, NULL, NULL);
+    irc_nick_new (server, channel, "alice", NULL, "@", 0, NULL, NULL);
+    irc_nick_new (server, channel, "Carol", NULL, NULL, 0, NULL, NULL);
+    irc_nick_new (server, channel, "bob", NULL, NULL, 0, NULL, NULL);
+    LONGS_EQUAL(4, channel->nicks_count);
+    LONGS_EQUAL(0, channel->buffer->nicklist_nicks_count);
+
+    /* end of names: all nicks are added in nicklist */
+    irc_channel_nicklist_names_end (server, channel);
+    LONGS_EQUAL(0, channel->nicklist_lazy);
+    LONGS_EQUAL(0, channel->nicklist_names);
+    LONGS_EQUAL(4, channel->buffer->nicklist_nicks_count);
+    ptr_nick = gui_nicklist_search_nick (channel->buffer, NULL, "alice");
+    CHECK(ptr_nick);
+    STRCMP_EQUAL("@", ptr_nick->prefix);
+    ptr_nick = gui_nicklist_search_nick (channel->buffer, NULL, "bob");
+    CHECK(ptr_nick);
+    STRCMP_EQUAL("Carol", ptr_nick->next_nick->name);
+    STRCMP_EQUAL("dave", ptr_nick->next_nick->next_nick->name);
+
+    /* channel joined (end of names received): no more names mode */
+    hashtable_set (channel->join_msg_received, "366", "1");
+    irc_channel_nicklist_names_start (server, channel);
+    LONGS_EQUAL(0, channel->nicklist_lazy);
+    LONGS_EQUAL(0, channel->nicklist_names);
+    hashtable_remove (channel->join_msg_received, "366");
+
+    /* large channel not displayed: nicklist remains lazy after names */
+    config_file_option_set (irc_config_look_nicklist_lazy_min_nicks, "4", 1);
+    irc_channel_nicklist_names_start (server, channel);
+    irc_nick_new (server, channel, "eve", NULL, NULL, 0, NULL, NULL);
+    irc_channel_nicklist_names_end (server, channel);
+    LONGS_EQUAL(1, channel->nicklist_lazy);
+    LONGS_EQUAL(0, channel->nicklist_names);
+    LONGS_EQUAL(0, channel->buffer->nicklist_nicks_count);
+    config_file_option_reset (irc_config_look_nicklist_lazy_min_nicks, 1);
+    LONGS_EQUAL(0, channel->nicklist_lazy);
+    LONGS_EQUAL(5, channel->buffer->nicklist_nicks_count);
+
+    irc_nick_free_all (server, channel);
+
+    if (channel->buffer)
+        gui_buffer_close (channel->buffer);
+
+    run_cmd_quiet ("/mute /disconnect local");
+    run_cmd_quiet ("/mute /server del local");
+}
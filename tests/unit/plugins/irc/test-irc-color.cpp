@@ -223,6 +223,12 @@ TEST(IrcColor, Decode)
     /* no color codes */
     WEE_CHECK_DECODE("test string", "test string", 0);
     WEE_CHECK_DECODE("test string", "test string", 1);
+    WEE_CHECK_DECODE("noël €", "noël €", 0);
+    WEE_CHECK_DECODE("noël €", "noël €", 1);
+
+    /* codes at start/end of string, UTF-8 chars between codes */
+    WEE_CHECK_DECODE("noël", "\x02noël\x02", 0);
+    WEE_CHECK_DECODE("a€b", "\x02\x1F" "a\x0F€\x16" "b\x1D", 0);
 
     /* bold */
     WEE_CHECK_DECODE("test_bold_end", STRING_IRC_BOLD, 0);
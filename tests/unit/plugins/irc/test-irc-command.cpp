@@ -28,6 +28,14 @@ extern "C"
 #include "src/plugins/irc/irc-command.h"
 
 extern char **irc_command_mode_masks_convert_ranges (char **argv, int arg_start);
+extern struct t_string_mask **irc_command_masks_compile (const char *str_masks,
+                                                        int case_sensitive,
+                                                        int *num_masks);
+extern int irc_command_masks_match (const char *string,
+                                    struct t_string_mask **masks,
+                                    int num_masks);
+extern void irc_command_masks_free (struct t_string_mask **masks,
+                                    int num_masks);
 }
 
 TEST_GROUP(IrcCommand)
@@ -155,6 +163,50 @@ TEST(IrcCommand, Admin)
     /* TODO: write tests */
 }
 
+/*
+ * Tests functions:
+ *   irc_command_masks_compile
+ *   irc_command_masks_match
+ *   irc_command_masks_free
+ */
+
+TEST(IrcCommand, Masks)
+{
+    struct t_string_mask **masks;
+    int num_masks;
+
+    num_masks = -1;
+    POINTERS_EQUAL(NULL, irc_command_masks_compile (NULL, 0, &num_masks));
+    LONGS_EQUAL(0, num_masks);
+    num_masks = -1;
+    POINTERS_EQUAL(NULL, irc_command_masks_compile ("", 0, &num_masks));
+    LONGS_EQUAL(0, num_masks);
+    LONGS_EQUAL(0, irc_command_masks_match ("#test", NULL, 0));
+    irc_command_masks_free (NULL, 0);
+
+    /* case insensitive */
+    masks = irc_command_masks_compile ("#weechat,#test*,,*dev", 0,
+                                       &num_masks);
+    CHECK(masks);
+    LONGS_EQUAL(3, num_masks);
+    LONGS_EQUAL(1, irc_command_masks_match ("#weechat", masks, num_masks));
+    LONGS_EQUAL(1, irc_command_masks_match ("#WeeChat", masks, num_masks));
+    LONGS_EQUAL(1, irc_command_masks_match ("#test", masks, num_masks));
+    LONGS_EQUAL(1, irc_command_masks_match ("#TEST2", masks, num_masks));
+    LONGS_EQUAL(1, irc_command_masks_match ("#weechat-dev", masks, num_masks));
+    LONGS_EQUAL(0, irc_command_masks_match ("#weechat2", masks, num_masks));
+    LONGS_EQUAL(0, irc_command_masks_match ("#other", masks, num_masks));
+    irc_command_masks_free (masks, num_masks);
+
+    /* case sensitive */
+    masks = irc_command_masks_compile ("libera", 1, &num_masks);
+    CHECK(masks);
+    LONGS_EQUAL(1, num_masks);
+    LONGS_EQUAL(1, irc_command_masks_match ("libera", masks, num_masks));
+    LONGS_EQUAL(0, irc_command_masks_match ("Libera", masks, num_masks));
+    irc_command_masks_free (masks, num_masks);
+}
+
 /*
  * Tests functions:
  *   irc_command_exec_buffers
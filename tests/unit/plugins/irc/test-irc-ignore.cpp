@@ -21,8 +21,11 @@
 
 #include "CppUTest/TestHarness.h"
 
+#include "tests/tests.h"
+
 extern "C"
 {
+#include "src/core/core-hashtable.h"
 #include "src/plugins/irc/irc-ignore.h"
 #include "src/plugins/irc/irc-server.h"
 }
@@ -49,6 +52,12 @@ TEST(IrcIgnore, New)
     CHECK(ignore->regex_mask);
     STRCMP_EQUAL("*", ignore->server);
     STRCMP_EQUAL("*", ignore->channel);
+    POINTERS_EQUAL(NULL, ignore->nick);
+    irc_ignore_free (ignore);
+
+    ignore = irc_ignore_new ("^Nick$", NULL, NULL);
+    CHECK(ignore);
+    STRCMP_EQUAL("Nick", ignore->nick);
     irc_ignore_free (ignore);
 
     ignore = irc_ignore_new ("^user@host$", "libera", "#weechat");
@@ -61,6 +70,29 @@ TEST(IrcIgnore, New)
     irc_ignore_free (ignore);
 }
 
+/*
+ * Tests functions:
+ *   irc_ignore_get_nick
+ */
+
+TEST(IrcIgnore, GetNick)
+{
+    char *str;
+
+    POINTERS_EQUAL(NULL, irc_ignore_get_nick (NULL));
+    POINTERS_EQUAL(NULL, irc_ignore_get_nick (""));
+    POINTERS_EQUAL(NULL, irc_ignore_get_nick ("^$"));
+    POINTERS_EQUAL(NULL, irc_ignore_get_nick ("nick"));
+    POINTERS_EQUAL(NULL, irc_ignore_get_nick ("^nick"));
+    POINTERS_EQUAL(NULL, irc_ignore_get_nick ("nick$"));
+    POINTERS_EQUAL(NULL, irc_ignore_get_nick ("^ni.k$"));
+    POINTERS_EQUAL(NULL, irc_ignore_get_nick ("^nick|other$"));
+    POINTERS_EQUAL(NULL, irc_ignore_get_nick ("^user@host$"));
+
+    WEE_TEST_STR("n", irc_ignore_get_nick ("^n$"));
+    WEE_TEST_STR("Nick_2-x", irc_ignore_get_nick ("^Nick_2-x$"));
+}
+
 /*
  * Tests functions:
  *   irc_ignore_free
@@ -210,7 +242,70 @@ TEST(IrcIgnore, CheckHost)
     LONGS_EQUAL(1, irc_ignore_check_host (ignore1, "nick1", "nick1!user1@host"));
     LONGS_EQUAL(0, irc_ignore_check_host (ignore2, "nick1", "nick1!aaa@bbb"));
     LONGS_EQUAL(1, irc_ignore_check_host (ignore2, "nick2", "nick2!aaa@bbb"));
+    LONGS_EQUAL(1, irc_ignore_check_host (ignore2, "NICK2", "NICK2!aaa@bbb"));
+    LONGS_EQUAL(0, irc_ignore_check_host (ignore2, NULL, "nick22!aaa@bbb"));
+    LONGS_EQUAL(1, irc_ignore_check_host (ignore2, NULL, "nick2"));
+    LONGS_EQUAL(1, irc_ignore_check_host (ignore2, NULL, "aaa!nick2"));
+
+    irc_ignore_free_all ();
+    irc_server_free (server);
+}
+
+/*
+ * Tests functions:
+ *   irc_ignore_check
+ */
+
+TEST(IrcIgnore, Check)
+{
+    struct t_irc_server *server;
+    struct t_irc_ignore *ignore1, *ignore2;
+
+    server = irc_server_alloc ("test_ignore");
+    CHECK(server);
+
+    irc_ignore_free_all ();
+
+    LONGS_EQUAL(0, irc_ignore_check (NULL, NULL, NULL, NULL));
+    LONGS_EQUAL(0, irc_ignore_check (server, "#weechat", "nick1",
+                                     "nick1!user1@host"));
+    POINTERS_EQUAL(NULL, irc_ignore_cache);
+
+    ignore1 = irc_ignore_new ("^user1@host$", "test_ignore", "#weechat");
+    CHECK(ignore1);
+
+    LONGS_EQUAL(1, irc_ignore_check (server, "#weechat", "nick1",
+                                     "nick1!user1@host"));
+    LONGS_EQUAL(0, irc_ignore_check (server, "#test", "nick1",
+                                     "nick1!user1@host"));
+    LONGS_EQUAL(0, irc_ignore_check (server, "#weechat", "nick2",
+                                     "nick2!user2@host"));
+    CHECK(irc_ignore_cache);
+    LONGS_EQUAL(3, irc_ignore_cache->items_count);
+
+    /* decisions are taken from cache */
+    LONGS_EQUAL(1, irc_ignore_check (server, "#weechat", "nick1",
+                                     "nick1!user1@host"));
+    LONGS_EQUAL(0, irc_ignore_check (server, "#weechat", "nick2",
+                                     "nick2!user2@host"));
+    LONGS_EQUAL(3, irc_ignore_cache->items_count);
+
+    /* cache is cleared when an ignore is added */
+    ignore2 = irc_ignore_new ("^nick2$", NULL, NULL);
+    CHECK(ignore2);
+    LONGS_EQUAL(0, irc_ignore_cache->items_count);
+    LONGS_EQUAL(1, irc_ignore_check (server, "#weechat", "nick2",
+                                     "nick2!user2@host"));
+    LONGS_EQUAL(1, irc_ignore_check (server, "nick2", "nick2",
+                                     "nick2!user2@host"));
+
+    /* cache is cleared when an ignore is removed */
+    irc_ignore_free (ignore2);
+    LONGS_EQUAL(0, irc_ignore_cache->items_count);
+    LONGS_EQUAL(0, irc_ignore_check (server, "#weechat", "nick2",
+                                     "nick2!user2@host"));
 
     irc_ignore_free_all ();
+    POINTERS_EQUAL(NULL, irc_ignore_cache);
     irc_server_free (server);
 }
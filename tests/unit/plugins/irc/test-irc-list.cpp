@@ -25,9 +25,32 @@
 
 extern "C"
 {
+#include <string.h>
+#include "src/core/core-arraylist.h"
+#include "src/core/core-hdata.h"
+#include "src/core/hook/hook-hdata.h"
 #include "src/plugins/irc/irc-list.h"
+#include "src/plugins/irc/irc-server.h"
+
+extern struct t_hdata *irc_list_hdata_list_channel;
+
+extern void irc_list_set_filter (struct t_irc_server *server,
+                                 const char *filter);
+extern void irc_list_set_sort (struct t_irc_server *server, const char *sort);
+extern int irc_list_filter_is_narrower (const char *old_filter,
+                                        const char *new_filter);
+extern void irc_list_sort_channels (struct t_irc_server *server);
+extern void irc_list_filter_channels (struct t_irc_server *server);
+extern int irc_list_parse_messages (struct t_irc_server *server,
+                                    const char *output);
 }
 
+#define TEST_LIST_CHANNEL(__index, __name)                              \
+    STRCMP_EQUAL(                                                       \
+        __name,                                                         \
+        ((struct t_irc_list_channel *)arraylist_get (                   \
+            server->list->filter_channels, __index))->name);
+
 TEST_GROUP(IrcList)
 {
 };
@@ -114,12 +137,158 @@ TEST(IrcList, ChannelMatchFilter)
 
 /*
  * Tests functions:
+ *   irc_list_filter_is_narrower
+ */
+
+TEST(IrcList, FilterIsNarrower)
+{
+    LONGS_EQUAL(0, irc_list_filter_is_narrower (NULL, NULL));
+    LONGS_EQUAL(0, irc_list_filter_is_narrower (NULL, "abc"));
+    LONGS_EQUAL(0, irc_list_filter_is_narrower ("abc", NULL));
+
+    /* filters on name and topic */
+    LONGS_EQUAL(1, irc_list_filter_is_narrower ("abc", "abc"));
+    LONGS_EQUAL(1, irc_list_filter_is_narrower ("ab", "abc"));
+    LONGS_EQUAL(1, irc_list_filter_is_narrower ("ab", "xABx"));
+    LONGS_EQUAL(0, irc_list_filter_is_narrower ("abc", "ab"));
+    LONGS_EQUAL(0, irc_list_filter_is_narrower ("ab", "a*bc"));
+    LONGS_EQUAL(0, irc_list_filter_is_narrower ("a*", "abc"));
+
+    /* filters on name or topic */
+    LONGS_EQUAL(1, irc_list_filter_is_narrower ("n:ab", "n:abc"));
+    LONGS_EQUAL(1, irc_list_filter_is_narrower ("t:ab", "t:abc"));
+    LONGS_EQUAL(0, irc_list_filter_is_narrower ("n:", "n:abc"));
+    LONGS_EQUAL(0, irc_list_filter_is_narrower ("n:ab", "t:abc"));
+    LONGS_EQUAL(0, irc_list_filter_is_narrower ("n:ab", "abc"));
+    LONGS_EQUAL(0, irc_list_filter_is_narrower ("ab", "n:abc"));
+
+    /* filters on users or evaluated condition */
+    LONGS_EQUAL(0, irc_list_filter_is_narrower ("u:10", "u:100"));
+    LONGS_EQUAL(0, irc_list_filter_is_narrower ("c:1", "c:1"));
+    LONGS_EQUAL(0, irc_list_filter_is_narrower ("ab", "c:abc"));
+}
+
+/*
+ * Tests functions:
+ *   irc_list_merge_sort
+ *   irc_list_sort_channels
  *   irc_list_filter_channels
  */
 
 TEST(IrcList, FilterChannels)
 {
-    /* TODO: write tests */
+    struct t_irc_server *server;
+    struct t_arraylist *ptr_sort_channels;
+
+    server = irc_server_alloc ("test_list");
+    CHECK(server);
+    CHECK(server->list);
+
+    irc_list_hdata_list_channel = hook_hdata_get (NULL, "irc_list_channel");
+    CHECK(irc_list_hdata_list_channel);
+
+    irc_list_set_sort (server, "name");
+    LONGS_EQUAL(
+        1,
+        irc_list_parse_messages (
+            server,
+            ":server 322 alice #def 3 :second topic\n"
+            ":server 322 alice #abd 25 :other topic\n"
+            ":server 322 alice #xyz 8 :about abc\n"
+            ":server 322 alice #abc 10 :first topic\n"));
+    LONGS_EQUAL(4, arraylist_size (server->list->channels));
+
+    /* channels are sorted */
+    LONGS_EQUAL(4, arraylist_size (server->list->sort_channels));
+    LONGS_EQUAL(4, arraylist_size (server->list->filter_channels));
+    TEST_LIST_CHANNEL(0, "#abc");
+    TEST_LIST_CHANNEL(1, "#abd");
+    TEST_LIST_CHANNEL(2, "#def");
+    TEST_LIST_CHANNEL(3, "#xyz");
+    POINTERS_EQUAL(NULL, server->list->filter_applied);
+
+    /* filter on name and topic */
+    irc_list_set_filter (server, "ab");
+    irc_list_filter_channels (server);
+    STRCMP_EQUAL("ab", server->list->filter_applied);
+    LONGS_EQUAL(3, arraylist_size (server->list->filter_channels));
+    TEST_LIST_CHANNEL(0, "#abc");
+    TEST_LIST_CHANNEL(1, "#abd");
+    TEST_LIST_CHANNEL(2, "#xyz");
+
+    /* narrower filter (applied on previous filtered channels) */
+    ptr_sort_channels = server->list->sort_channels;
+    irc_list_set_filter (server, "abc");
+    irc_list_filter_channels (server);
+    POINTERS_EQUAL(ptr_sort_channels, server->list->sort_channels);
+    STRCMP_EQUAL("abc", server->list->filter_applied);
+    LONGS_EQUAL(2, arraylist_size (server->list->filter_channels));
+    TEST_LIST_CHANNEL(0, "#abc");
+    TEST_LIST_CHANNEL(1, "#xyz");
+
+    /* wider filter (applied on all channels) */
+    irc_list_set_filter (server, "n:#d");
+    irc_list_filter_channels (server);
+    LONGS_EQUAL(1, arraylist_size (server->list->filter_channels));
+    TEST_LIST_CHANNEL(0, "#def");
+    POINTERS_EQUAL(NULL, server->list->filter_mask);
+
+    /* filter on name with a wildcard (mask is compiled) */
+    irc_list_set_filter (server, "n:#AB*");
+    CHECK(server->list->filter_mask);
+    irc_list_filter_channels (server);
+    LONGS_EQUAL(2, arraylist_size (server->list->filter_channels));
+    TEST_LIST_CHANNEL(0, "#abc");
+    TEST_LIST_CHANNEL(1, "#abd");
+
+    /* filter on users */
+    irc_list_set_filter (server, "u:>5");
+    POINTERS_EQUAL(NULL, server->list->filter_mask);
+    irc_list_filter_channels (server);
+    LONGS_EQUAL(3, arraylist_size (server->list->filter_channels));
+    TEST_LIST_CHANNEL(0, "#abc");
+    TEST_LIST_CHANNEL(1, "#abd");
+    TEST_LIST_CHANNEL(2, "#xyz");
+
+    /* new sort: channels are sorted again */
+    irc_list_set_sort (server, "-users");
+    POINTERS_EQUAL(NULL, server->list->sort_channels);
+    irc_list_filter_channels (server);
+    LONGS_EQUAL(4, arraylist_size (server->list->sort_channels));
+    LONGS_EQUAL(3, arraylist_size (server->list->filter_channels));
+    TEST_LIST_CHANNEL(0, "#abd");
+    TEST_LIST_CHANNEL(1, "#abc");
+    TEST_LIST_CHANNEL(2, "#xyz");
+
+    /* no filter */
+    irc_list_set_filter (server, NULL);
+    irc_list_filter_channels (server);
+    POINTERS_EQUAL(NULL, server->list->filter_applied);
+    LONGS_EQUAL(4, arraylist_size (server->list->filter_channels));
+    TEST_LIST_CHANNEL(0, "#abd");
+    TEST_LIST_CHANNEL(1, "#abc");
+    TEST_LIST_CHANNEL(2, "#xyz");
+    TEST_LIST_CHANNEL(3, "#def");
+
+    /* sort is stable: channels with same number of users keep their order */
+    irc_list_set_sort (server, "~topic");
+    irc_list_parse_messages (
+        server,
+        ":server 322 alice #c 1 :same\n"
+        ":server 322 alice #a 1 :same\n"
+        ":server 322 alice #b 1 :SAME\n"
+        ":server 322 alice #d 1 :other\n");
+    TEST_LIST_CHANNEL(0, "#d");
+    TEST_LIST_CHANNEL(1, "#c");
+    TEST_LIST_CHANNEL(2, "#a");
+    TEST_LIST_CHANNEL(3, "#b");
+
+    irc_list_reset (server);
+    LONGS_EQUAL(0, arraylist_size (server->list->channels));
+    LONGS_EQUAL(0, arraylist_size (server->list->sort_channels));
+    LONGS_EQUAL(0, arraylist_size (server->list->filter_channels));
+
+    irc_server_free (server);
 }
 
 /*
@@ -285,9 +454,11 @@ TEST(IrcList, Alloc)
     CHECK(list);
     POINTERS_EQUAL(NULL, list->buffer);
     POINTERS_EQUAL(NULL, list->channels);
+    POINTERS_EQUAL(NULL, list->sort_channels);
     POINTERS_EQUAL(NULL, list->filter_channels);
     LONGS_EQUAL(0, list->name_max_length);
     POINTERS_EQUAL(NULL, list->filter);
+    POINTERS_EQUAL(NULL, list->filter_applied);
     POINTERS_EQUAL(NULL, list->sort);
     POINTERS_EQUAL(NULL, list->sort_fields);
     LONGS_EQUAL(0, list->sort_fields_count);
@@ -306,6 +306,39 @@ TEST_GROUP(IrcMessage)
 {
 };
 
+/*
+ * Tests functions:
+ *   irc_message_parse_params_next
+ */
+
+TEST(IrcMessage, ParseParamsNext)
+{
+    const char *ptr_params, *param;
+    int length;
+
+    ptr_params = NULL;
+    LONGS_EQUAL(0, irc_message_parse_params_next (&ptr_params, &param,
+                                                  &length));
+
+    ptr_params = "#channel  nick :trailing  params ";
+    LONGS_EQUAL(1, irc_message_parse_params_next (&ptr_params, &param,
+                                                  &length));
+    LONGS_EQUAL(8, length);
+    CHECK(strncmp (param, "#channel", 8) == 0);
+    STRCMP_EQUAL("nick :trailing  params ", ptr_params);
+    LONGS_EQUAL(1, irc_message_parse_params_next (&ptr_params, &param,
+                                                  &length));
+    LONGS_EQUAL(4, length);
+    CHECK(strncmp (param, "nick", 4) == 0);
+    LONGS_EQUAL(1, irc_message_parse_params_next (&ptr_params, &param,
+                                                  &length));
+    LONGS_EQUAL(17, length);
+    STRCMP_EQUAL("trailing  params ", param);
+    POINTERS_EQUAL(NULL, ptr_params);
+    LONGS_EQUAL(0, irc_message_parse_params_next (&ptr_params, &param,
+                                                  &length));
+}
+
 /*
  * Tests functions:
  *   irc_message_parse_params
@@ -760,6 +793,69 @@ TEST(IrcMessage, Parse)
                     ":irc.example.com 404 nick #channel :Cannot send to channel");
 }
 
+/*
+ * Tests functions:
+ *   irc_message_parse_spans
+ *   irc_message_span_strdup
+ */
+
+TEST(IrcMessage, ParseSpans)
+{
+    struct t_irc_message_spans spans;
+    const char *msg;
+    char *str;
+
+    irc_message_parse_spans (NULL, NULL, &spans);
+    LONGS_EQUAL(-1, spans.tags.pos);
+    LONGS_EQUAL(-1, spans.nick.pos);
+    LONGS_EQUAL(-1, spans.command.pos);
+    LONGS_EQUAL(-1, spans.arguments.pos);
+    POINTERS_EQUAL(NULL, irc_message_span_strdup ("test", &spans.nick));
+    POINTERS_EQUAL(NULL, irc_message_span_strdup (NULL, &spans.nick));
+
+    msg = "@time=2023-08-09T07:43:01.830Z :nick!user@host "
+        "PRIVMSG #channel :the message";
+    irc_message_parse_spans (NULL, msg, &spans);
+    LONGS_EQUAL(1, spans.tags.pos);
+    LONGS_EQUAL(29, spans.tags.length);
+    LONGS_EQUAL(31, spans.message_without_tags.pos);
+    LONGS_EQUAL(32, spans.nick.pos);
+    LONGS_EQUAL(4, spans.nick.length);
+    LONGS_EQUAL(37, spans.user.pos);
+    LONGS_EQUAL(4, spans.user.length);
+    LONGS_EQUAL(32, spans.host.pos);
+    LONGS_EQUAL(14, spans.host.length);
+    LONGS_EQUAL(47, spans.command.pos);
+    LONGS_EQUAL(7, spans.command.length);
+    LONGS_EQUAL(55, spans.channel.pos);
+    LONGS_EQUAL(8, spans.channel.length);
+    LONGS_EQUAL(55, spans.arguments.pos);
+    LONGS_EQUAL(65, spans.text.pos);
+    LONGS_EQUAL(11, spans.text.length);
+
+    str = irc_message_span_strdup (msg, &spans.tags);
+    STRCMP_EQUAL("time=2023-08-09T07:43:01.830Z", str);
+    free (str);
+    str = irc_message_span_strdup (msg, &spans.nick);
+    STRCMP_EQUAL("nick", str);
+    free (str);
+    str = irc_message_span_strdup (msg, &spans.host);
+    STRCMP_EQUAL("nick!user@host", str);
+    free (str);
+    str = irc_message_span_strdup (msg, &spans.command);
+    STRCMP_EQUAL("PRIVMSG", str);
+    free (str);
+    str = irc_message_span_strdup (msg, &spans.channel);
+    STRCMP_EQUAL("#channel", str);
+    free (str);
+    str = irc_message_span_strdup (msg, &spans.arguments);
+    STRCMP_EQUAL("#channel :the message", str);
+    free (str);
+    str = irc_message_span_strdup (msg, &spans.text);
+    STRCMP_EQUAL("the message", str);
+    free (str);
+}
+
 /*
  * Tests functions:
  *   irc_message_parse_to_hashtable
@@ -1121,6 +1217,76 @@ TEST(IrcMessage, ReplaceVars)
     irc_server_free (server);
 }
 
+/*
+ * Tests functions:
+ *   irc_message_count_targets
+ */
+
+TEST(IrcMessage, CountTargets)
+{
+    LONGS_EQUAL(0, irc_message_count_targets (NULL));
+    LONGS_EQUAL(0, irc_message_count_targets (""));
+    LONGS_EQUAL(0, irc_message_count_targets (" #channel"));
+    LONGS_EQUAL(1, irc_message_count_targets ("#channel"));
+    LONGS_EQUAL(1, irc_message_count_targets ("#channel,"));
+    LONGS_EQUAL(1, irc_message_count_targets ("#channel key1,key2"));
+    LONGS_EQUAL(2, irc_message_count_targets ("#channel1,,#channel2"));
+    LONGS_EQUAL(3, irc_message_count_targets ("#channel1,#channel2,#channel3"));
+    LONGS_EQUAL(3, irc_message_count_targets ("#channel1,#channel2,#channel3 "
+                                              "key1,key2"));
+}
+
+/*
+ * Tests functions:
+ *   irc_message_split_plan_get
+ */
+
+TEST(IrcMessage, SplitPlanGet)
+{
+    struct t_irc_message_split_plan *plan, *plan2;
+
+    POINTERS_EQUAL(NULL, irc_message_split_plan_get (NULL, ' ', 10));
+    POINTERS_EQUAL(NULL, irc_message_split_plan_get ("abc", ' ', 0));
+
+    plan = irc_message_split_plan_get ("", ' ', 10);
+    CHECK(plan);
+    LONGS_EQUAL(0, plan->num_chunks);
+
+    /* split on delimiter */
+    plan = irc_message_split_plan_get ("abc def ghi jkl", ' ', 8);
+    CHECK(plan);
+    STRCMP_EQUAL("abc def ghi jkl", plan->arguments);
+    LONGS_EQUAL(8, plan->max_length);
+    LONGS_EQUAL(2, plan->num_chunks);
+    LONGS_EQUAL(0, plan->chunks[0]);
+    LONGS_EQUAL(7, plan->chunks[1]);
+    LONGS_EQUAL(8, plan->chunks[2]);
+    LONGS_EQUAL(7, plan->chunks[3]);
+
+    /* same plan is returned without computing it again */
+    plan2 = irc_message_split_plan_get ("abc def ghi jkl", ' ', 8);
+    POINTERS_EQUAL(plan, plan2);
+    LONGS_EQUAL(2, plan2->num_chunks);
+
+    /* no delimiter: split at max length, without splitting UTF-8 chars */
+    plan = irc_message_split_plan_get ("abcdé" "fgh", ' ', 5);
+    CHECK(plan);
+    LONGS_EQUAL(2, plan->num_chunks);
+    LONGS_EQUAL(0, plan->chunks[0]);
+    LONGS_EQUAL(4, plan->chunks[1]);
+    LONGS_EQUAL(4, plan->chunks[2]);
+    LONGS_EQUAL(5, plan->chunks[3]);
+
+    /* other delimiter */
+    plan = irc_message_split_plan_get ("ab,cd,ef", ',', 5);
+    CHECK(plan);
+    LONGS_EQUAL(2, plan->num_chunks);
+    LONGS_EQUAL(0, plan->chunks[0]);
+    LONGS_EQUAL(5, plan->chunks[1]);
+    LONGS_EQUAL(6, plan->chunks[2]);
+    LONGS_EQUAL(2, plan->chunks[3]);
+}
+
 /*
  * Tests functions:
  *   irc_message_split_add
@@ -1451,6 +1617,31 @@ TEST(IrcMessage, Split)
                  (const char *)hashtable_get (hashtable, "args2"));
     hashtable_free (hashtable);
 
+    /* JOIN with max 2 channels (TARGMAX): 1 split */
+    server->isupport = strdup ("TARGMAX=NAMES:1,JOIN:2,PRIVMSG:4");
+    hashtable = irc_message_split (server, "JOIN #channel1,#channel2 key1");
+    CHECK(hashtable);
+    LONGS_EQUAL(3, hashtable->items_count);
+    STRCMP_EQUAL("JOIN #channel1,#channel2 key1",
+                 (const char *)hashtable_get (hashtable, "msg1"));
+    hashtable_free (hashtable);
+    hashtable = irc_message_split (server,
+                                   "JOIN #channel1,#channel2,#channel3,"
+                                   "#channel4,#channel5 key1,key2,key3");
+    CHECK(hashtable);
+    LONGS_EQUAL(7, hashtable->items_count);
+    STRCMP_EQUAL("3",
+                 (const char *)hashtable_get (hashtable, "count"));
+    STRCMP_EQUAL("JOIN #channel1,#channel2 key1,key2",
+                 (const char *)hashtable_get (hashtable, "msg1"));
+    STRCMP_EQUAL("JOIN #channel3,#channel4 key3",
+                 (const char *)hashtable_get (hashtable, "msg2"));
+    STRCMP_EQUAL("JOIN #channel5",
+                 (const char *)hashtable_get (hashtable, "msg3"));
+    hashtable_free (hashtable);
+    free (server->isupport);
+    server->isupport = NULL;
+
     /* MONITOR with small content: no split */
     hashtable = irc_message_split (server, "MONITOR + nick1,nick2");
     CHECK(hashtable);
@@ -0,0 +1,152 @@
+/*
+ * test-irc-modelist.cpp - test IRC channel mode list functions
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+#include "tests/tests.h"
+
+extern "C"
+{
+#include <string.h>
+#include "src/core/core-arraylist.h"
+#include "src/core/core-hashtable.h"
+#include "src/plugins/irc/irc-channel.h"
+#include "src/plugins/irc/irc-modelist.h"
+
+extern char *irc_modelist_item_get_host (const char *mask);
+}
+
+TEST_GROUP(IrcModelist)
+{
+};
+
+/*
+ * Tests functions:
+ *   irc_modelist_item_get_host
+ */
+
+TEST(IrcModelist, ItemGetHost)
+{
+    char *str;
+
+    POINTERS_EQUAL(NULL, irc_modelist_item_get_host (NULL));
+    POINTERS_EQUAL(NULL, irc_modelist_item_get_host (""));
+    POINTERS_EQUAL(NULL, irc_modelist_item_get_host ("nick"));
+    POINTERS_EQUAL(NULL, irc_modelist_item_get_host ("nick!user@"));
+    POINTERS_EQUAL(NULL, irc_modelist_item_get_host ("*!*@*.example.com"));
+    POINTERS_EQUAL(NULL, irc_modelist_item_get_host ("$a:account"));
+
+    WEE_TEST_STR("example.com", irc_modelist_item_get_host ("*!*@Example.COM"));
+    WEE_TEST_STR("host", irc_modelist_item_get_host ("n*!*@x@host"));
+}
+
+/*
+ * Tests functions:
+ *   irc_modelist_new
+ *   irc_modelist_item_new
+ *   irc_modelist_item_search_mask
+ *   irc_modelist_item_search_match
+ *   irc_modelist_item_free
+ *   irc_modelist_free
+ */
+
+TEST(IrcModelist, ItemSearch)
+{
+    struct t_irc_channel channel;
+    struct t_irc_modelist *modelist;
+    struct t_irc_modelist_item *item1, *item2, *item3, *item4;
+
+    memset (&channel, 0, sizeof (channel));
+
+    modelist = irc_modelist_new (&channel, 'b');
+    CHECK(modelist);
+    CHECK(modelist->items_mask);
+    CHECK(modelist->items_host);
+    CHECK(modelist->items_wildcard);
+
+    POINTERS_EQUAL(NULL, irc_modelist_item_search_mask (NULL, NULL));
+    POINTERS_EQUAL(NULL, irc_modelist_item_search_mask (modelist, NULL));
+    POINTERS_EQUAL(NULL, irc_modelist_item_search_mask (modelist, "*!*@host"));
+    POINTERS_EQUAL(NULL, irc_modelist_item_search_match (NULL, NULL));
+    POINTERS_EQUAL(NULL, irc_modelist_item_search_match (modelist, NULL));
+    POINTERS_EQUAL(NULL,
+                   irc_modelist_item_search_match (modelist, "nick!user@host"));
+
+    item1 = irc_modelist_item_new (modelist, "*!*@Host.com", NULL, 0);
+    item2 = irc_modelist_item_new (modelist, "*!*@*.example.com", NULL, 0);
+    item3 = irc_modelist_item_new (modelist, "$a:account", NULL, 0);
+    item4 = irc_modelist_item_new (modelist, "*!*@Host.com", NULL, 0);
+    CHECK(item1);
+    CHECK(item2);
+    CHECK(item3);
+    CHECK(item4);
+
+    LONGS_EQUAL(3, modelist->items_mask->items_count);
+    LONGS_EQUAL(1, modelist->items_mask_dup);
+    LONGS_EQUAL(1, modelist->items_host->items_count);
+    LONGS_EQUAL(2, arraylist_size (modelist->items_wildcard));
+
+    /* search by mask */
+    POINTERS_EQUAL(NULL, irc_modelist_item_search_mask (modelist, "*!*@host.com"));
+    POINTERS_EQUAL(item1, irc_modelist_item_search_mask (modelist, "*!*@Host.com"));
+    POINTERS_EQUAL(item2,
+                   irc_modelist_item_search_mask (modelist, "*!*@*.example.com"));
+    POINTERS_EQUAL(item3, irc_modelist_item_search_mask (modelist, "$a:account"));
+
+    /* search matching hostmask */
+    POINTERS_EQUAL(NULL,
+                   irc_modelist_item_search_match (modelist, "nick!user@host"));
+    POINTERS_EQUAL(NULL,
+                   irc_modelist_item_search_match (modelist, "nick!user@example.com"));
+    CHECK(irc_modelist_item_search_match (modelist, "nick!user@host.com"));
+    CHECK(irc_modelist_item_search_match (modelist, "nick!user@HOST.COM"));
+    POINTERS_EQUAL(item2,
+                   irc_modelist_item_search_match (modelist,
+                                                   "nick!user@irc.example.com"));
+    POINTERS_EQUAL(item3,
+                   irc_modelist_item_search_match (modelist, "$a:account"));
+
+    /* remove first item with duplicate mask: second one is used */
+    irc_modelist_item_free (modelist, item1);
+    LONGS_EQUAL(0, modelist->items_mask_dup);
+    POINTERS_EQUAL(item4, irc_modelist_item_search_mask (modelist, "*!*@Host.com"));
+    POINTERS_EQUAL(item4,
+                   irc_modelist_item_search_match (modelist, "nick!user@host.com"));
+
+    irc_modelist_item_free (modelist, item4);
+    POINTERS_EQUAL(NULL, irc_modelist_item_search_mask (modelist, "*!*@Host.com"));
+    POINTERS_EQUAL(NULL,
+                   irc_modelist_item_search_match (modelist, "nick!user@host.com"));
+    LONGS_EQUAL(0, modelist->items_host->items_count);
+
+    irc_modelist_item_free (modelist, item2);
+    LONGS_EQUAL(1, arraylist_size (modelist->items_wildcard));
+    POINTERS_EQUAL(NULL,
+                   irc_modelist_item_search_match (modelist,
+                                                   "nick!user@irc.example.com"));
+
+    irc_modelist_item_free_all (modelist);
+    LONGS_EQUAL(0, modelist->items_mask->items_count);
+    LONGS_EQUAL(0, arraylist_size (modelist->items_wildcard));
+
+    irc_modelist_free (&channel, modelist);
+    POINTERS_EQUAL(NULL, channel.modelists);
+}
@@ -26,7 +26,11 @@
 extern "C"
 {
 #include <string.h>
+#include "src/core/core-arraylist.h"
+#include "src/core/core-hashtable.h"
+#include "src/gui/gui-buffer.h"
 #include "src/gui/gui-color.h"
+#include "src/plugins/irc/irc-channel.h"
 #include "src/plugins/irc/irc-nick.h"
 #include "src/plugins/irc/irc-server.h"
 }
@@ -220,11 +224,93 @@ TEST(IrcNick, SetPrefixes)
 /*
  * Tests functions:
  *   irc_nick_set_host
+ *   irc_nick_set_account
+ *   irc_nick_set_realname
  */
 
 TEST(IrcNick, SetHost)
 {
-    /* TODO: write tests */
+    struct t_irc_server *server;
+    struct t_irc_channel *channel1, *channel2;
+    struct t_irc_nick *nick1, *nick2;
+
+    run_cmd_quiet ("/mute /server add local fake:127.0.0.1");
+    run_cmd_quiet ("/connect local");
+
+    server = irc_server_search ("local");
+    CHECK(server);
+
+    channel1 = irc_channel_new (server, IRC_CHANNEL_TYPE_CHANNEL, "#test1",
+                                0, 0);
+    CHECK(channel1);
+    channel2 = irc_channel_new (server, IRC_CHANNEL_TYPE_CHANNEL, "#test2",
+                                0, 0);
+    CHECK(channel2);
+
+    nick1 = irc_nick_new (server, channel1, "alice", "user@host", NULL, 0,
+                          "alice_account", "Alice");
+    CHECK(nick1);
+    nick2 = irc_nick_new (server, channel2, "alice", "user@host", NULL, 0,
+                          "alice_account", "Alice");
+    CHECK(nick2);
+
+    /* strings are shared between nicks of the same user */
+    STRCMP_EQUAL("user@host", nick1->host);
+    POINTERS_EQUAL(nick1->name, nick2->name);
+    POINTERS_EQUAL(nick1->host, nick2->host);
+    POINTERS_EQUAL(nick1->account, nick2->account);
+    POINTERS_EQUAL(nick1->realname, nick2->realname);
+
+    irc_nick_set_host (NULL, NULL);
+    irc_nick_set_account (NULL, NULL);
+    irc_nick_set_realname (NULL, NULL);
+
+    /* host */
+    irc_nick_set_host (nick1, "user@host");
+    POINTERS_EQUAL(nick2->host, nick1->host);
+    irc_nick_set_host (nick1, "user@other_host");
+    STRCMP_EQUAL("user@other_host", nick1->host);
+    STRCMP_EQUAL("user@host", nick2->host);
+    irc_nick_set_host (nick2, "user@other_host");
+    POINTERS_EQUAL(nick1->host, nick2->host);
+    irc_nick_set_host (nick1, NULL);
+    POINTERS_EQUAL(NULL, nick1->host);
+    STRCMP_EQUAL("user@other_host", nick2->host);
+
+    /* account */
+    irc_nick_set_account (nick1, "other_account");
+    STRCMP_EQUAL("other_account", nick1->account);
+    STRCMP_EQUAL("alice_account", nick2->account);
+    irc_nick_set_account (nick2, NULL);
+    POINTERS_EQUAL(NULL, nick2->account);
+
+    /* realname */
+    irc_nick_set_realname (nick1, "Alice Liddell");
+    STRCMP_EQUAL("Alice Liddell", nick1->realname);
+    STRCMP_EQUAL("Alice", nick2->realname);
+    irc_nick_set_realname (nick2, "Alice Liddell");
+    POINTERS_EQUAL(nick1->realname, nick2->realname);
+
+    /* nick changed */
+    irc_nick_change (server, channel1, nick1, "alice2");
+    STRCMP_EQUAL("alice2", nick1->name);
+    STRCMP_EQUAL("alice", nick2->name);
+    irc_nick_change (server, channel2, nick2, "alice2");
+    POINTERS_EQUAL(nick1->name, nick2->name);
+
+    irc_nick_free_all (server, channel1);
+    STRCMP_EQUAL("alice2", nick2->name);
+    STRCMP_EQUAL("user@other_host", nick2->host);
+    STRCMP_EQUAL("Alice Liddell", nick2->realname);
+    irc_nick_free_all (server, channel2);
+
+    if (channel1->buffer)
+        gui_buffer_close (channel1->buffer);
+    if (channel2->buffer)
+        gui_buffer_close (channel2->buffer);
+
+    run_cmd_quiet ("/mute /disconnect local");
+    run_cmd_quiet ("/mute /server del local");
 }
 
 /*
@@ -389,12 +475,188 @@ TEST(IrcNick, FreeAll)
 
 /*
  * Tests functions:
+ *   irc_nick_hash_add
+ *   irc_nick_hash_remove
+ *   irc_nick_hash_rebuild
  *   irc_nick_search
  */
 
 TEST(IrcNick, Search)
 {
-    /* TODO: write tests */
+    struct t_irc_server *server;
+    struct t_irc_channel *channel;
+    struct t_irc_nick *nick_alice, *nick_bob;
+
+    run_cmd_quiet ("/mute /server add local fake:127.0.0.1");
+    run_cmd_quiet ("/connect local");
+
+    server = irc_server_search ("local");
+    CHECK(server);
+
+    channel = irc_channel_new (server, IRC_CHANNEL_TYPE_CHANNEL, "#test", 0, 0);
+    CHECK(channel);
+
+    POINTERS_EQUAL(NULL, irc_nick_search (NULL, NULL, NULL));
+    POINTERS_EQUAL(NULL, irc_nick_search (server, NULL, "alice"));
+    POINTERS_EQUAL(NULL, irc_nick_search (server, channel, NULL));
+    POINTERS_EQUAL(NULL, irc_nick_search (server, channel, "alice"));
+
+    nick_alice = irc_nick_new (server, channel, "Alice", "user@host", "@", 0,
+                               NULL, NULL);
+    CHECK(nick_alice);
+    nick_bob = irc_nick_new (server, channel, "bob[]", "user@host", NULL, 0,
+                             NULL, NULL);
+    CHECK(nick_bob);
+
+    /* casemapping "rfc1459" (default) */
+    server->casemapping = IRC_SERVER_CASEMAPPING_RFC1459;
+    irc_nick_hash_rebuild (server);
+    POINTERS_EQUAL(nick_alice, irc_nick_search (server, channel, "Alice"));
+    POINTERS_EQUAL(nick_alice, irc_nick_search (server, channel, "alice"));
+    POINTERS_EQUAL(nick_alice, irc_nick_search (server, channel, "ALICE"));
+    POINTERS_EQUAL(NULL, irc_nick_search (server, channel, "alic"));
+    POINTERS_EQUAL(nick_bob, irc_nick_search (server, channel, "bob[]"));
+    POINTERS_EQUAL(nick_bob, irc_nick_search (server, channel, "BOB{}"));
+    POINTERS_EQUAL(nick_bob, irc_nick_search (server, channel, "bob{]"));
+
+    /* casemapping "ascii" */
+    server->casemapping = IRC_SERVER_CASEMAPPING_ASCII;
+    irc_nick_hash_rebuild (server);
+    POINTERS_EQUAL(nick_alice, irc_nick_search (server, channel, "ALICE"));
+    POINTERS_EQUAL(nick_bob, irc_nick_search (server, channel, "BOB[]"));
+    POINTERS_EQUAL(NULL, irc_nick_search (server, channel, "bob{}"));
+    POINTERS_EQUAL(NULL, irc_nick_search (server, channel, "bob{]"));
+
+    /* nick changed */
+    irc_nick_change (server, channel, nick_alice, "Alice_");
+    POINTERS_EQUAL(NULL, irc_nick_search (server, channel, "alice"));
+    POINTERS_EQUAL(nick_alice, irc_nick_search (server, channel, "alice_"));
+
+    /* nick removed */
+    irc_nick_free (server, channel, nick_bob);
+    POINTERS_EQUAL(NULL, irc_nick_search (server, channel, "bob[]"));
+    POINTERS_EQUAL(nick_alice, irc_nick_search (server, channel, "ALICE_"));
+
+    irc_nick_free_all (server, channel);
+    POINTERS_EQUAL(NULL, irc_nick_search (server, channel, "alice_"));
+
+    if (channel->buffer)
+        gui_buffer_close (channel->buffer);
+
+    run_cmd_quiet ("/mute /disconnect local");
+    run_cmd_quiet ("/mute /server del local");
+}
+
+/*
+ * Tests functions:
+ *   irc_nick_search_channels
+ */
+
+TEST(IrcNick, SearchChannels)
+{
+    struct t_irc_server *server;
+    struct t_irc_channel *channel1, *channel2, *channel_pv;
+    struct t_irc_nick *nick_alice1, *nick_alice2, *nick_bob;
+    struct t_arraylist *channels;
+
+    run_cmd_quiet ("/mute /server add local fake:127.0.0.1");
+    run_cmd_quiet ("/connect local");
+
+    server = irc_server_search ("local");
+    CHECK(server);
+
+    channel1 = irc_channel_new (server, IRC_CHANNEL_TYPE_CHANNEL, "#test1",
+                                0, 0);
+    CHECK(channel1);
+    channel2 = irc_channel_new (server, IRC_CHANNEL_TYPE_CHANNEL, "#test2",
+                                0, 0);
+    CHECK(channel2);
+    channel_pv = irc_channel_new (server, IRC_CHANNEL_TYPE_PRIVATE, "alice",
+                                  0, 0);
+    CHECK(channel_pv);
+
+    POINTERS_EQUAL(NULL, irc_nick_search_channels (NULL, NULL, 0));
+    POINTERS_EQUAL(NULL, irc_nick_search_channels (server, NULL, 0));
+
+    channels = irc_nick_search_channels (server, "alice", 0);
+    CHECK(channels);
+    LONGS_EQUAL(0, arraylist_size (channels));
+    arraylist_free (channels);
+
+    nick_alice1 = irc_nick_new (server, channel1, "Alice", "user@host", NULL,
+                                0, NULL, NULL);
+    CHECK(nick_alice1);
+    nick_alice2 = irc_nick_new (server, channel2, "Alice", "user@host", NULL,
+                                0, NULL, NULL);
+    CHECK(nick_alice2);
+    nick_bob = irc_nick_new (server, channel2, "bob[]", "user@host", NULL,
+                             0, NULL, NULL);
+    CHECK(nick_bob);
+
+    channels = irc_nick_search_channels (server, "ALICE", 0);
+    LONGS_EQUAL(2, arraylist_size (channels));
+    POINTERS_EQUAL(channel1, arraylist_get (channels, 0));
+    POINTERS_EQUAL(channel2, arraylist_get (channels, 1));
+    arraylist_free (channels);
+
+    channels = irc_nick_search_channels (server, "alice", 1);
+    LONGS_EQUAL(3, arraylist_size (channels));
+    POINTERS_EQUAL(channel1, arraylist_get (channels, 0));
+    POINTERS_EQUAL(channel2, arraylist_get (channels, 1));
+    POINTERS_EQUAL(channel_pv, arraylist_get (channels, 2));
+    arraylist_free (channels);
+
+    channels = irc_nick_search_channels (server, "bob{}", 1);
+    LONGS_EQUAL(1, arraylist_size (channels));
+    POINTERS_EQUAL(channel2, arraylist_get (channels, 0));
+    arraylist_free (channels);
+
+    /* casemapping "ascii" */
+    server->casemapping = IRC_SERVER_CASEMAPPING_ASCII;
+    irc_nick_hash_rebuild (server);
+    channels = irc_nick_search_channels (server, "bob{}", 0);
+    LONGS_EQUAL(0, arraylist_size (channels));
+    arraylist_free (channels);
+    channels = irc_nick_search_channels (server, "BOB[]", 0);
+    LONGS_EQUAL(1, arraylist_size (channels));
+    arraylist_free (channels);
+    server->casemapping = IRC_SERVER_CASEMAPPING_RFC1459;
+    irc_nick_hash_rebuild (server);
+
+    /* nick changed in one channel */
+    irc_nick_change (server, channel1, nick_alice1, "alice_");
+    channels = irc_nick_search_channels (server, "alice", 0);
+    LONGS_EQUAL(1, arraylist_size (channels));
+    POINTERS_EQUAL(channel2, arraylist_get (channels, 0));
+    arraylist_free (channels);
+    channels = irc_nick_search_channels (server, "alice_", 0);
+    LONGS_EQUAL(1, arraylist_size (channels));
+    POINTERS_EQUAL(channel1, arraylist_get (channels, 0));
+    arraylist_free (channels);
+
+    /* nick removed */
+    irc_nick_free (server, channel2, nick_alice2);
+    channels = irc_nick_search_channels (server, "alice", 0);
+    LONGS_EQUAL(0, arraylist_size (channels));
+    arraylist_free (channels);
+    POINTERS_EQUAL(NULL,
+                   hashtable_get (server->nicks_channels, "alice"));
+
+    /* all nicks removed */
+    irc_nick_free_all (server, channel1);
+    irc_nick_free_all (server, channel2);
+    LONGS_EQUAL(0, hashtable_get_integer (server->nicks_channels,
+                                                  "items_count"));
+
+    if (channel1->buffer)
+        gui_buffer_close (channel1->buffer);
+    if (channel2->buffer)
+        gui_buffer_close (channel2->buffer);
+    if (channel_pv->buffer)
+        gui_buffer_close (channel_pv->buffer);
+
+    run_cmd_quiet ("/mute /disconnect local");
+    run_cmd_quiet ("/mute /server del local");
 }
 
 /*
@@ -0,0 +1,88 @@
+/*
+ * test-irc-notify.cpp - test IRC notify functions
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include "src/plugins/irc/irc-notify.h"
+#include "src/plugins/irc/irc-server.h"
+}
+
+TEST_GROUP(IrcNotify)
+{
+};
+
+/*
+ * Tests functions:
+ *   irc_notify_new
+ *   irc_notify_whois_schedule
+ *   irc_notify_set_is_on_server
+ */
+
+TEST(IrcNotify, WhoisSchedule)
+{
+    struct t_irc_server *server;
+    struct t_irc_notify *notify;
+    int i;
+
+    server = irc_server_alloc ("test_notify");
+    CHECK(server);
+
+    notify = irc_notify_new (server, "alice", 1);
+    CHECK(notify);
+    LONGS_EQUAL(1, notify->whois_interval);
+    LONGS_EQUAL(1, notify->whois_countdown);
+
+    irc_notify_whois_schedule (NULL, 0);
+
+    /* away status unchanged: interval is doubled, up to the max */
+    irc_notify_whois_schedule (notify, 0);
+    LONGS_EQUAL(2, notify->whois_interval);
+    LONGS_EQUAL(2, notify->whois_countdown);
+    irc_notify_whois_schedule (notify, 0);
+    LONGS_EQUAL(4, notify->whois_interval);
+    CHECK((notify->whois_countdown >= 3) && (notify->whois_countdown <= 4));
+    for (i = 0; i < 10; i++)
+    {
+        irc_notify_whois_schedule (notify, 0);
+        LONGS_EQUAL(IRC_NOTIFY_WHOIS_MAX_INTERVAL, notify->whois_interval);
+        CHECK(notify->whois_countdown >= IRC_NOTIFY_WHOIS_MAX_INTERVAL
+              - (IRC_NOTIFY_WHOIS_MAX_INTERVAL / 4));
+        CHECK(notify->whois_countdown <= IRC_NOTIFY_WHOIS_MAX_INTERVAL);
+    }
+
+    /* away status changed: check on next call of timer */
+    irc_notify_whois_schedule (notify, 1);
+    LONGS_EQUAL(1, notify->whois_interval);
+    LONGS_EQUAL(1, notify->whois_countdown);
+
+    /* nick joins: check on next call of timer */
+    irc_notify_whois_schedule (notify, 0);
+    irc_notify_whois_schedule (notify, 0);
+    CHECK(notify->whois_countdown > 1);
+    irc_notify_set_is_on_server (notify, NULL, 1);
+    LONGS_EQUAL(1, notify->is_on_server);
+    LONGS_EQUAL(1, notify->whois_interval);
+    LONGS_EQUAL(1, notify->whois_countdown);
+
+    irc_server_free (server);
+}
@@ -40,6 +40,7 @@ extern "C"
 #include "src/gui/gui-color.h"
 #include "src/plugins/plugin.h"
 #include "src/plugins/irc/irc-batch.h"
+#include "src/plugins/irc/irc-chathistory.h"
 #include "src/plugins/irc/irc-ctcp.h"
 #include "src/plugins/irc/irc-protocol.h"
 #include "src/plugins/irc/irc-channel.h"
@@ -72,9 +73,9 @@ extern char *irc_protocol_cap_to_enable (const char *capabilities,
     "CHANTYPES=# CHANMODES=eIbq,k,flj,CFLMPQScgimnprstuz "              \
     "MONITOR=100 UTF8MAPPING=rfc8265 UTF8ONLY"
 #define IRC_ALL_CAPS "account-notify,account-tag,away-notify,batch,"    \
-    "cap-notify,chghost,draft/multiline,echo-message,extended-join,"    \
-    "invite-notify,message-tags,multi-prefix,server-time,setname,"      \
-    "userhost-in-names"
+    "cap-notify,chghost,draft/chathistory,draft/multiline,"             \
+    "echo-message,extended-join,invite-notify,message-tags,"            \
+    "multi-prefix,server-time,setname,userhost-in-names"
 
 #define WEE_CHECK_PROTOCOL_TAGS(__result, __server, __command, __tags,  \
                                 __extra_tags)                           \
@@ -491,6 +492,57 @@ TEST(IrcProtocol, IsNumericCommand)
     LONGS_EQUAL(1, irc_protocol_is_numeric_command ("123"));
 }
 
+/*
+ * Tests functions:
+ *   irc_protocol_search_message
+ */
+
+TEST(IrcProtocol, SearchMessage)
+{
+    struct t_irc_protocol_msg *ptr_msg;
+
+    POINTERS_EQUAL(NULL, irc_protocol_search_message (NULL));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message (""));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message ("xyz"));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message ("privms"));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message ("privmsgx"));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message ("#privmsg"));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message ("000"));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message ("01"));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message ("0001"));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message ("1a1"));
+    POINTERS_EQUAL(NULL, irc_protocol_search_message ("999"));
+
+    ptr_msg = irc_protocol_search_message ("privmsg");
+    CHECK(ptr_msg);
+    STRCMP_EQUAL("privmsg", ptr_msg->name);
+    LONGS_EQUAL(1, ptr_msg->decode_color);
+    LONGS_EQUAL(1, ptr_msg->keep_trailing_spaces);
+    POINTERS_EQUAL(ptr_msg, irc_protocol_search_message ("PRIVMSG"));
+    POINTERS_EQUAL(ptr_msg, irc_protocol_search_message ("PrivMsg"));
+
+    ptr_msg = irc_protocol_search_message ("account");
+    CHECK(ptr_msg);
+    STRCMP_EQUAL("account", ptr_msg->name);
+    ptr_msg = irc_protocol_search_message ("warn");
+    CHECK(ptr_msg);
+    STRCMP_EQUAL("warn", ptr_msg->name);
+    ptr_msg = irc_protocol_search_message ("TOPIC");
+    CHECK(ptr_msg);
+    STRCMP_EQUAL("topic", ptr_msg->name);
+    LONGS_EQUAL(0, ptr_msg->decode_color);
+
+    ptr_msg = irc_protocol_search_message ("001");
+    CHECK(ptr_msg);
+    STRCMP_EQUAL("001", ptr_msg->name);
+    ptr_msg = irc_protocol_search_message ("353");
+    CHECK(ptr_msg);
+    STRCMP_EQUAL("353", ptr_msg->name);
+    ptr_msg = irc_protocol_search_message ("975");
+    CHECK(ptr_msg);
+    STRCMP_EQUAL("975", ptr_msg->name);
+}
+
 /*
  * Tests functions:
  *   irc_protocol_log_level_for_command
@@ -1882,6 +1934,79 @@ TEST(IrcProtocolWithServer, cap)
     CHECK_SRV("=!=", "irc: client capability, refused: sasl", "irc_cap,log3");
 }
 
+/*
+ * Tests functions:
+ *   irc_chathistory_channel_joined
+ *   irc_chathistory_send_requests
+ *   irc_chathistory_end
+ *   irc_chathistory_reset
+ */
+
+TEST(IrcProtocolWithServer, chathistory)
+{
+    struct t_irc_channel *ptr_channel, *ptr_channel2;
+
+    /* capability not enabled: no history asked */
+    SRV_INIT_JOIN;
+    RECV(":server 366 alice #test :End of /NAMES list");
+    ptr_channel = ptr_server->channels;
+    CHECK(ptr_channel);
+    LONGS_EQUAL(IRC_CHATHISTORY_STATE_NONE, ptr_channel->chathistory_state);
+    LONGS_EQUAL(0, ptr_server->chathistory_requests);
+
+    /* assume "batch" and "draft/chathistory" capabilities are enabled */
+    hashtable_set (ptr_server->cap_list, "batch", NULL);
+    hashtable_set (ptr_server->cap_list, "draft/chathistory", NULL);
+
+    RECV(":server 366 alice #test :End of /NAMES list");
+    CHECK_SENT("CHATHISTORY LATEST #test * 100");
+    LONGS_EQUAL(IRC_CHATHISTORY_STATE_REQUESTED,
+                ptr_channel->chathistory_state);
+    LONGS_EQUAL(1, ptr_server->chathistory_requests);
+
+    /* history received */
+    RECV(":server BATCH +ref chathistory #test");
+    RECV("@batch=ref :bob!user_b@host_b PRIVMSG #test :old message");
+    CHECK_NO_MSG;
+    RECV(":server BATCH -ref");
+    CHECK_CHAN("bob", "old message",
+               "irc_privmsg,irc_tag_batch=ref,irc_batch_type_chathistory,"
+               "notify_message,prefix_nick_248,nick_bob,host_user_b@host_b,"
+               "log1");
+    LONGS_EQUAL(IRC_CHATHISTORY_STATE_DONE, ptr_channel->chathistory_state);
+    LONGS_EQUAL(0, ptr_server->chathistory_requests);
+
+    /* history is asked only once */
+    RECV(":server 366 alice #test :End of /NAMES list");
+    CHECK_SENT(NULL);
+    LONGS_EQUAL(0, ptr_server->chathistory_requests);
+
+    /* limit of messages sent by server */
+    RECV(":server 005 alice CHATHISTORY=50 :are supported");
+    RECV(":alice!user_a@host_a JOIN #test2");
+    RECV(":server 366 alice #test2 :End of /NAMES list");
+    CHECK_SENT("CHATHISTORY LATEST #test2 * 50");
+    ptr_channel2 = irc_channel_search (ptr_server, "#test2");
+    CHECK(ptr_channel2);
+    LONGS_EQUAL(IRC_CHATHISTORY_STATE_REQUESTED,
+                ptr_channel2->chathistory_state);
+    LONGS_EQUAL(1, ptr_server->chathistory_requests);
+
+    /* error from server */
+    RECV(":server FAIL CHATHISTORY INVALID_TARGET LATEST #test2 "
+         ":Messages could not be retrieved");
+    LONGS_EQUAL(IRC_CHATHISTORY_STATE_DONE, ptr_channel2->chathistory_state);
+    LONGS_EQUAL(0, ptr_server->chathistory_requests);
+
+    /* reset */
+    ptr_channel2->chathistory_state = IRC_CHATHISTORY_STATE_REQUESTED;
+    ptr_server->chathistory_requests = 1;
+    irc_chathistory_reset (ptr_server);
+    LONGS_EQUAL(IRC_CHATHISTORY_STATE_DONE, ptr_channel->chathistory_state);
+    LONGS_EQUAL(IRC_CHATHISTORY_STATE_NONE, ptr_channel2->chathistory_state);
+    LONGS_EQUAL(0, ptr_server->chathistory_requests);
+}
+
 /*
  * Tests functions:
  *   irc_protocol_cb_chghost
@@ -0,0 +1,109 @@
+/*
+ * test-irc-raw.cpp - test IRC raw functions
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+#include "tests/tests.h"
+
+extern "C"
+{
+#include <string.h>
+#include "src/core/core-config-file.h"
+#include "src/plugins/irc/irc-config.h"
+#include "src/plugins/irc/irc-raw.h"
+
+extern void irc_raw_message_free_all ();
+}
+
+TEST_GROUP(IrcRaw)
+{
+};
+
+/*
+ * Tests functions:
+ *   irc_raw_message_add_to_list
+ *   irc_raw_message_remove_old
+ *   irc_raw_message_free_all
+ */
+
+TEST(IrcRaw, MessageAddToList)
+{
+    struct t_irc_raw_message *msg1, *msg2, *msg3, *msg4, *msg5;
+
+    irc_raw_message_free_all ();
+    config_file_option_set (irc_config_look_raw_messages, "3", 1);
+
+    POINTERS_EQUAL(NULL, irc_raw_message_add_to_list (0, 0, NULL, 0, NULL));
+
+    msg1 = irc_raw_message_add_to_list (1, 0, NULL, IRC_RAW_FLAG_RECV,
+                                        "message 1, long");
+    CHECK(msg1);
+    msg2 = irc_raw_message_add_to_list (2, 0, NULL, IRC_RAW_FLAG_RECV,
+                                        "message 2");
+    CHECK(msg2);
+    msg3 = irc_raw_message_add_to_list (3, 0, NULL, IRC_RAW_FLAG_SEND,
+                                        "message 3");
+    CHECK(msg3);
+    LONGS_EQUAL(3, irc_raw_messages_count);
+    POINTERS_EQUAL(msg1, irc_raw_messages);
+    POINTERS_EQUAL(msg3, last_irc_raw_message);
+    STRCMP_EQUAL("message 1, long", msg1->message);
+
+    /* list is full: oldest message is recycled (same size or shorter) */
+    msg4 = irc_raw_message_add_to_list (4, 0, NULL, IRC_RAW_FLAG_SEND,
+                                        "message 4");
+    POINTERS_EQUAL(msg1, msg4);
+    LONGS_EQUAL(3, irc_raw_messages_count);
+    POINTERS_EQUAL(msg2, irc_raw_messages);
+    POINTERS_EQUAL(NULL, msg2->prev_message);
+    POINTERS_EQUAL(msg4, last_irc_raw_message);
+    POINTERS_EQUAL(msg3, msg4->prev_message);
+    POINTERS_EQUAL(NULL, msg4->next_message);
+    LONGS_EQUAL(4, msg4->date);
+    LONGS_EQUAL(IRC_RAW_FLAG_SEND, msg4->flags);
+    STRCMP_EQUAL("message 4", msg4->message);
+
+    /* list is full, message longer than oldest one */
+    msg5 = irc_raw_message_add_to_list (5, 0, NULL, IRC_RAW_FLAG_RECV,
+                                        "message 5, longer than message 2");
+    CHECK(msg5);
+    LONGS_EQUAL(3, irc_raw_messages_count);
+    POINTERS_EQUAL(msg3, irc_raw_messages);
+    POINTERS_EQUAL(msg5, last_irc_raw_message);
+    STRCMP_EQUAL("message 5, longer than message 2", msg5->message);
+
+    /* limit reduced: old messages are removed */
+    config_file_option_set (irc_config_look_raw_messages, "1", 1);
+    msg1 = irc_raw_message_add_to_list (6, 0, NULL, IRC_RAW_FLAG_RECV,
+                                        "message 6");
+    CHECK(msg1);
+    LONGS_EQUAL(1, irc_raw_messages_count);
+    POINTERS_EQUAL(msg1, irc_raw_messages);
+    POINTERS_EQUAL(msg1, last_irc_raw_message);
+    STRCMP_EQUAL("message 6", msg1->message);
+
+    irc_raw_message_free_all ();
+    LONGS_EQUAL(0, irc_raw_messages_count);
+    POINTERS_EQUAL(NULL, irc_raw_messages);
+    POINTERS_EQUAL(NULL, last_irc_raw_message);
+
+    config_file_option_reset (irc_config_look_raw_messages, 1);
+}
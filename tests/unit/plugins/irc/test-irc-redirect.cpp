@@ -0,0 +1,186 @@
+/*
+ * test-irc-redirect.cpp - test IRC redirect functions
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+#include "tests/tests.h"
+
+extern "C"
+{
+#include <string.h>
+#include "src/core/core-hashtable.h"
+#include "src/core/core-hook.h"
+#include "src/plugins/weechat-plugin.h"
+#include "src/plugins/irc/irc-redirect.h"
+#include "src/plugins/irc/irc-server.h"
+
+extern void irc_redirect_message_add (struct t_irc_redirect *redirect,
+                                      const char *message,
+                                      const char *command);
+extern int irc_redirect_message_is_wanted (struct t_irc_server *server,
+                                           const char *command);
+}
+
+char *test_irc_redirect_output = NULL;
+
+TEST_GROUP(IrcRedirect)
+{
+    /*
+     * Callback for hsignal sent at the end of redirection (used in tests):
+     * saves the output.
+     */
+
+    static int hsignal_cb (const void *pointer, void *data,
+                           const char *signal, struct t_hashtable *hashtable)
+    {
+        /* make C compiler happy */
+        (void) pointer;
+        (void) data;
+        (void) signal;
+
+        free (test_irc_redirect_output);
+        test_irc_redirect_output = strdup (
+            (const char *)hashtable_get (hashtable, "output"));
+
+        return WEECHAT_RC_OK;
+    }
+};
+
+/*
+ * Tests functions:
+ *   irc_redirect_message_add
+ */
+
+TEST(IrcRedirect, MessageAdd)
+{
+    struct t_irc_redirect redirect;
+    char message[1024];
+    int i;
+
+    memset (&redirect, 0, sizeof (redirect));
+
+    irc_redirect_message_add (&redirect, "msg1", "352");
+    STRCMP_EQUAL("msg1", redirect.output);
+    LONGS_EQUAL(5, redirect.output_size);
+    CHECK(redirect.output_alloc >= redirect.output_size);
+
+    irc_redirect_message_add (&redirect, "", "352");
+    STRCMP_EQUAL("msg1\n", redirect.output);
+    LONGS_EQUAL(6, redirect.output_size);
+
+    irc_redirect_message_add (&redirect, "msg3", "315");
+    STRCMP_EQUAL("msg1\n\nmsg3", redirect.output);
+    LONGS_EQUAL(11, redirect.output_size);
+
+    /* add many long messages: buffer grows */
+    memset (message, 'a', sizeof (message) - 1);
+    message[sizeof (message) - 1] = '\0';
+    for (i = 0; i < 100; i++)
+    {
+        irc_redirect_message_add (&redirect, message, "352");
+    }
+    LONGS_EQUAL(11 + (100 * 1024), redirect.output_size);
+    LONGS_EQUAL(redirect.output_size - 1, strlen (redirect.output));
+    CHECK(redirect.output_alloc >= redirect.output_size);
+    CHECK(strncmp (redirect.output, "msg1\n\nmsg3\naaa", 14) == 0);
+    free (redirect.output);
+
+    /* message filtered */
+    memset (&redirect, 0, sizeof (redirect));
+    redirect.cmd_filter = hashtable_new (32,
+                                         WEECHAT_HASHTABLE_STRING,
+                                         WEECHAT_HASHTABLE_STRING,
+                                         NULL, NULL);
+    hashtable_set (redirect.cmd_filter, "352", NULL);
+    irc_redirect_message_add (&redirect, "msg1", "315");
+    POINTERS_EQUAL(NULL, redirect.output);
+    irc_redirect_message_add (&redirect, "msg2", "352");
+    STRCMP_EQUAL("msg2", redirect.output);
+    hashtable_free (redirect.cmd_filter);
+    free (redirect.output);
+}
+
+/*
+ * Tests functions:
+ *   irc_redirect_message_is_wanted
+ *   irc_redirect_message
+ */
+
+TEST(IrcRedirect, Message)
+{
+    struct t_irc_server *server;
+    struct t_irc_redirect *redirect;
+    struct t_hook *hook;
+
+    server = irc_server_alloc ("server");
+    CHECK(server);
+    server->is_connected = 1;
+
+    hook = hook_hsignal (NULL, "irc_redirection_test_who", &hsignal_cb,
+                         NULL, NULL);
+
+    LONGS_EQUAL(0, irc_redirect_message_is_wanted (server, "352"));
+    LONGS_EQUAL(0, irc_redirect_message (server, ":server 352 alice",
+                                         "352", "alice"));
+
+    redirect = irc_redirect_new (server, "who", "test", 1, "#test", 0, NULL);
+    CHECK(redirect);
+
+    /* redirect not yet started (command not sent) */
+    LONGS_EQUAL(0, irc_redirect_message_is_wanted (server, "352"));
+
+    irc_redirect_init_command (redirect, "WHO #test");
+    LONGS_EQUAL(1, irc_redirect_message_is_wanted (server, "352"));
+    LONGS_EQUAL(1, irc_redirect_message_is_wanted (server, "315"));
+    LONGS_EQUAL(0, irc_redirect_message_is_wanted (server, "PRIVMSG"));
+    LONGS_EQUAL(0, irc_redirect_message (server, ":bob!u@h PRIVMSG #test :hi",
+                                         "PRIVMSG", "#test :hi"));
+
+    /* start of redirection: all messages are wanted */
+    LONGS_EQUAL(1, irc_redirect_message (server,
+                                         ":server 352 alice #test u h s a H "
+                                         ":0 Alice",
+                                         "352",
+                                         "alice #test u h s a H :0 Alice"));
+    LONGS_EQUAL(1, irc_redirect_message_is_wanted (server, "PRIVMSG"));
+    LONGS_EQUAL(1, irc_redirect_message (server,
+                                         ":server 352 alice #test u h s b H "
+                                         ":0 Bob",
+                                         "352",
+                                         "alice #test u h s b H :0 Bob"));
+
+    /* end of redirection */
+    LONGS_EQUAL(1, irc_redirect_message (server,
+                                         ":server 315 alice #test :End",
+                                         "315", "alice #test :End"));
+    POINTERS_EQUAL(NULL, server->redirects);
+    STRCMP_EQUAL(":server 352 alice #test u h s a H :0 Alice\n"
+                 ":server 352 alice #test u h s b H :0 Bob\n"
+                 ":server 315 alice #test :End",
+                 test_irc_redirect_output);
+    LONGS_EQUAL(0, irc_redirect_message_is_wanted (server, "352"));
+
+    free (test_irc_redirect_output);
+    test_irc_redirect_output = NULL;
+    unhook (hook);
+    server->is_connected = 0;
+    irc_server_free (server);
+}
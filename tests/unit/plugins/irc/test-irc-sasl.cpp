@@ -23,7 +23,10 @@
 
 extern "C"
 {
+#include <stdio.h>
 #include <string.h>
+#include <unistd.h>
+#include "src/core/core-hashtable.h"
 #include "src/core/core-string.h"
 #include "src/plugins/plugin.h"
 #include "src/plugins/irc/irc-sasl.h"
@@ -68,7 +71,8 @@ TEST(IrcSasl, MechanismPlain)
 TEST(IrcSasl, MechanismScram)
 {
     struct t_irc_server *server;
-    char *str, str_decoded[1024], *error;
+    char *str, *str2, str_decoded[1024], *error;
+    char str_server[1024], str_server_base64[2048];
 
     POINTERS_EQUAL(NULL, irc_sasl_mechanism_scram (NULL, NULL, NULL, NULL,
                                                    NULL, NULL));
@@ -84,6 +88,38 @@ TEST(IrcSasl, MechanismScram)
     CHECK(strncmp (str_decoded, "n,,n=user1,r=", 13) == 0);
     free (str);
 
+    /* server first message: salted password is computed only once */
+    hashtable_remove_all (irc_sasl_scram_cache);
+    snprintf (str_server, sizeof (str_server),
+              "r=%s%s,s=c2FsdA==,i=4096",
+              str_decoded + 13, "3rfcNHYJY1ZVvWVs7j");
+    CHECK(string_base64_encode (0, str_server, strlen (str_server),
+                                str_server_base64) > 0);
+    error = NULL;
+    str = irc_sasl_mechanism_scram (server, "sha256", str_server_base64,
+                                    "user1", "secret", &error);
+    POINTERS_EQUAL(NULL, error);
+    CHECK(str);
+    LONGS_EQUAL(1, hashtable_get_integer (irc_sasl_scram_cache,
+                                          "items_count"));
+    str2 = irc_sasl_mechanism_scram (server, "sha256", str_server_base64,
+                                     "user1", "secret", &error);
+    POINTERS_EQUAL(NULL, error);
+    STRCMP_EQUAL(str, str2);
+    LONGS_EQUAL(1, hashtable_get_integer (irc_sasl_scram_cache,
+                                          "items_count"));
+    free (str);
+    free (str2);
+
+    /* other password: new salted password */
+    str = irc_sasl_mechanism_scram (server, "sha256", str_server_base64,
+                                    "user1", "secret2", &error);
+    POINTERS_EQUAL(NULL, error);
+    CHECK(str);
+    LONGS_EQUAL(2, hashtable_get_integer (irc_sasl_scram_cache,
+                                          "items_count"));
+    free (str);
+
     /* TODO: complete tests */
 
     irc_server_free (server);
@@ -96,7 +132,48 @@ TEST(IrcSasl, MechanismScram)
 
 TEST(IrcSasl, GetKeyContent)
 {
-    /* TODO: write tests */
+    char *filename, *str, *error;
+    FILE *file;
+
+    POINTERS_EQUAL(NULL, irc_sasl_get_key_content (NULL, NULL));
+
+    filename = string_eval_path_home ("${weechat_config_dir}/test_sasl.pem",
+                                      NULL, NULL, NULL);
+    CHECK(filename);
+    unlink (filename);
+
+    /* file not found */
+    error = NULL;
+    POINTERS_EQUAL(NULL, irc_sasl_get_key_content (filename, &error));
+    CHECK(error);
+    free (error);
+
+    file = fopen (filename, "w");
+    fputs ("key 1", file);
+    fclose (file);
+    str = irc_sasl_get_key_content (filename, NULL);
+    STRCMP_EQUAL("key 1", str);
+    free (str);
+    CHECK(hashtable_get (irc_sasl_key_cache, filename));
+
+    /* same file: content is read from cache */
+    str = irc_sasl_get_key_content (filename, NULL);
+    STRCMP_EQUAL("key 1", str);
+    free (str);
+
+    /* file changed: content is read again */
+    file = fopen (filename, "w");
+    fputs ("key 2 (new)", file);
+    fclose (file);
+    str = irc_sasl_get_key_content (filename, NULL);
+    STRCMP_EQUAL("key 2 (new)", str);
+    free (str);
+
+    /* file removed */
+    unlink (filename);
+    POINTERS_EQUAL(NULL, irc_sasl_get_key_content (filename, NULL));
+
+    free (filename);
 }
 
 /*
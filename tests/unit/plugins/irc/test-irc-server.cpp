@@ -28,13 +28,20 @@ extern "C"
 #include <stdio.h>
 #include <string.h>
 #include "src/core/core-config-file.h"
+#include "src/gui/gui-buffer.h"
+#include "src/gui/gui-window.h"
 #include "src/plugins/plugin.h"
 #include "src/plugins/irc/irc-channel.h"
+#include "src/plugins/irc/irc-config.h"
 #include "src/plugins/irc/irc-server.h"
+#include "src/plugins/irc/irc-typing.h"
 
 extern int irc_server_fingerprint_search_algo_with_size (int size);
 extern char *irc_server_eval_fingerprint (struct t_irc_server *server);
 extern char *irc_server_build_autojoin (struct t_irc_server *server);
+extern void irc_server_outqueue_send (struct t_irc_server *server);
+extern void irc_server_join_burst_start (struct t_irc_server *server,
+                                         const char *arguments);
 }
 
 #define IRC_FAKE_SERVER "fake"
@@ -609,6 +616,44 @@ TEST(IrcServer, GetIsupportValue)
     irc_server_free (server);
 }
 
+/*
+ * Tests functions:
+ *   irc_server_get_max_targets
+ */
+
+TEST(IrcServer, GetMaxTargets)
+{
+    struct t_irc_server *server;
+
+    server = irc_server_alloc ("test_max_targets");
+    CHECK(server);
+
+    LONGS_EQUAL(0, irc_server_get_max_targets (NULL, "JOIN"));
+    LONGS_EQUAL(0, irc_server_get_max_targets (server, "JOIN"));
+
+    server->isupport = strdup ("CHANLIMIT=#:10 "
+                               "TARGMAX=NAMES:1,JOIN:,PRIVMSG:4,WHOIS:x,"
+                               "KICK:1,NOTICE:4 WHOX");
+
+    LONGS_EQUAL(0, irc_server_get_max_targets (server, NULL));
+    LONGS_EQUAL(0, irc_server_get_max_targets (server, ""));
+    LONGS_EQUAL(0, irc_server_get_max_targets (server, "JOIN"));
+    LONGS_EQUAL(0, irc_server_get_max_targets (server, "WHOIS"));
+    LONGS_EQUAL(0, irc_server_get_max_targets (server, "MONITOR"));
+    LONGS_EQUAL(0, irc_server_get_max_targets (server, "KIC"));
+    LONGS_EQUAL(1, irc_server_get_max_targets (server, "NAMES"));
+    LONGS_EQUAL(4, irc_server_get_max_targets (server, "PRIVMSG"));
+    LONGS_EQUAL(4, irc_server_get_max_targets (server, "privmsg"));
+    LONGS_EQUAL(1, irc_server_get_max_targets (server, "KICK"));
+    LONGS_EQUAL(4, irc_server_get_max_targets (server, "NOTICE"));
+
+    free (server->isupport);
+    server->isupport = strdup ("TARGMAX=JOIN:10");
+    LONGS_EQUAL(10, irc_server_get_max_targets (server, "JOIN"));
+
+    irc_server_free (server);
+}
+
 /*
  * Tests functions:
  *   irc_server_set_prefix_modes_chars
@@ -1028,6 +1073,39 @@ TEST(IrcServer, FreeData)
     /* TODO: write tests */
 }
 
+/*
+ * Tests functions:
+ *   irc_server_tls_session_free
+ */
+
+TEST(IrcServer, TlsSessionFree)
+{
+    struct t_irc_server *server;
+
+    irc_server_tls_session_free (NULL);
+
+    server = irc_server_alloc ("server1");
+    CHECK(server);
+    POINTERS_EQUAL(NULL, server->tls_session_data.data);
+    LONGS_EQUAL(0, server->tls_session_data.size);
+    POINTERS_EQUAL(NULL, server->tls_session_address);
+
+    server->tls_session_data.data = (unsigned char *)gnutls_malloc (16);
+    server->tls_session_data.size = 16;
+    server->tls_session_address = strdup ("irc.example.com/6697");
+
+    irc_server_tls_session_free (server);
+    POINTERS_EQUAL(NULL, server->tls_session_data.data);
+    LONGS_EQUAL(0, server->tls_session_data.size);
+    POINTERS_EQUAL(NULL, server->tls_session_address);
+
+    /* data is freed with the server */
+    server->tls_session_data.data = (unsigned char *)gnutls_malloc (16);
+    server->tls_session_data.size = 16;
+    server->tls_session_address = strdup ("irc.example.com/6697");
+    irc_server_free (server);
+}
+
 /*
  * Tests functions:
  *   irc_server_free
@@ -1098,6 +1176,57 @@ TEST(IrcServer, Send)
     /* TODO: write tests */
 }
 
+/*
+ * Tests functions:
+ *   irc_server_send_buffer_flush
+ *   irc_server_send_buffer_add
+ */
+
+TEST(IrcServer, SendBuffer)
+{
+    struct t_irc_server *server;
+    char *big_data;
+
+    server = irc_server_alloc ("server1");
+    CHECK(server);
+    server->fake_server = 1;
+
+    LONGS_EQUAL(-1, irc_server_send_buffer_flush (NULL));
+    LONGS_EQUAL(0, irc_server_send_buffer_flush (server));
+
+    LONGS_EQUAL(0, irc_server_send_buffer_add (NULL, "test", 4));
+    LONGS_EQUAL(0, irc_server_send_buffer_add (server, NULL, 4));
+    LONGS_EQUAL(0, irc_server_send_buffer_add (server, "test", 0));
+    POINTERS_EQUAL(NULL, server->send_buffer);
+
+    LONGS_EQUAL(1, irc_server_send_buffer_add (server, "JOIN #a\r\n", 9));
+    CHECK(server->send_buffer);
+    LONGS_EQUAL(9, server->send_buffer_length);
+    LONGS_EQUAL(1, irc_server_send_buffer_add (server, "JOIN #b\r\n", 9));
+    LONGS_EQUAL(18, server->send_buffer_length);
+    MEMCMP_EQUAL("JOIN #a\r\nJOIN #b\r\n", server->send_buffer, 18);
+
+    LONGS_EQUAL(18, irc_server_send_buffer_flush (server));
+    LONGS_EQUAL(0, server->send_buffer_length);
+
+    /* buffer is sent when it is full */
+    big_data = (char *)malloc (IRC_SERVER_SEND_BUFFER_SIZE + 1);
+    memset (big_data, 'a', IRC_SERVER_SEND_BUFFER_SIZE + 1);
+    LONGS_EQUAL(1, irc_server_send_buffer_add (server, big_data,
+                                               IRC_SERVER_SEND_BUFFER_SIZE - 4));
+    LONGS_EQUAL(IRC_SERVER_SEND_BUFFER_SIZE - 4, server->send_buffer_length);
+    LONGS_EQUAL(1, irc_server_send_buffer_add (server, "JOIN #c\r\n", 9));
+    LONGS_EQUAL(9, server->send_buffer_length);
+
+    /* data bigger than buffer is sent immediately */
+    LONGS_EQUAL(1, irc_server_send_buffer_add (server, big_data,
+                                               IRC_SERVER_SEND_BUFFER_SIZE + 1));
+    LONGS_EQUAL(0, server->send_buffer_length);
+    free (big_data);
+
+    irc_server_free (server);
+}
+
 /*
  * Tests functions:
  *   irc_server_set_send_default_tags
@@ -1128,6 +1257,59 @@ TEST(IrcServer, OutqueueAllEmpty)
     /* TODO: write tests */
 }
 
+/*
+ * Tests functions:
+ *   irc_server_anti_flood_cost
+ *   irc_server_anti_flood_wait
+ *   irc_server_anti_flood_add
+ */
+
+TEST(IrcServer, AntiFlood)
+{
+    struct t_irc_server *server;
+    long long wait;
+
+    LONGS_EQUAL(0, irc_server_anti_flood_cost (NULL, "test"));
+    LONGS_EQUAL(0, irc_server_anti_flood_wait (NULL, 1000));
+    irc_server_anti_flood_add (NULL, 1000);
+
+    server = irc_server_alloc ("server1");
+    CHECK(server);
+
+    config_file_option_set (server->options[IRC_SERVER_OPTION_ANTI_FLOOD],
+                            "1000", 1);
+    config_file_option_set (server->options[IRC_SERVER_OPTION_ANTI_FLOOD_BURST],
+                            "3", 1);
+
+    /* cost of messages */
+    LONGS_EQUAL(1000000, irc_server_anti_flood_cost (server, NULL));
+    LONGS_EQUAL(1000000, irc_server_anti_flood_cost (server, "PRIVMSG #test :hello"));
+    config_file_option_set (server->options[IRC_SERVER_OPTION_ANTI_FLOOD_BYTES],
+                            "10", 1);
+    LONGS_EQUAL(1000000, irc_server_anti_flood_cost (server, "PING :abc"));
+    LONGS_EQUAL(3000000, irc_server_anti_flood_cost (server, "PRIVMSG #test :hello"));
+    config_file_option_set (server->options[IRC_SERVER_OPTION_ANTI_FLOOD_BYTES],
+                            "0", 1);
+
+    /* empty bucket: 3 messages can be sent now */
+    LONGS_EQUAL(0, irc_server_anti_flood_wait (server, 1000000));
+    irc_server_anti_flood_add (server, 1000000);
+    LONGS_EQUAL(0, irc_server_anti_flood_wait (server, 1000000));
+    irc_server_anti_flood_add (server, 1000000);
+    LONGS_EQUAL(0, irc_server_anti_flood_wait (server, 1000000));
+    irc_server_anti_flood_add (server, 1000000);
+
+    /* bucket is full: wait about one second */
+    wait = irc_server_anti_flood_wait (server, 1000000);
+    CHECK((wait > 900000) && (wait <= 1000000));
+
+    /* message bigger than the bucket: wait until bucket is empty */
+    wait = irc_server_anti_flood_wait (server, 10000000);
+    CHECK((wait > 2900000) && (wait <= 3000000));
+
+    irc_server_free (server);
+}
+
 /*
  * Tests functions:
  *   irc_server_outqueue_timer_cb
@@ -1200,40 +1382,100 @@ TEST(IrcServer, Sendf)
 
 /*
  * Tests functions:
- *   irc_server_msgq_add_msg
+ *   irc_server_recv_buffer_grow
  */
 
-TEST(IrcServer, MsgqAddMsg)
+TEST(IrcServer, RecvBufferGrow)
 {
-    /* TODO: write tests */
-}
+    struct t_irc_server *server;
+    char *ptr_buffer, *old_buffer;
 
-/*
- * Tests functions:
- *   irc_server_msgq_add_unterminated
- */
+    POINTERS_EQUAL(NULL, irc_server_recv_buffer_grow (NULL, 10));
 
-TEST(IrcServer, MsgqAddUnterminated)
-{
-    /* TODO: write tests */
+    server = irc_server_alloc ("server1");
+    CHECK(server);
+    POINTERS_EQUAL(NULL, server->recv_buffer);
+
+    POINTERS_EQUAL(NULL, irc_server_recv_buffer_grow (server, -1));
+
+    ptr_buffer = irc_server_recv_buffer_grow (server, 10);
+    CHECK(ptr_buffer);
+    POINTERS_EQUAL(server->recv_buffer, ptr_buffer);
+    LONGS_EQUAL(4096, server->recv_buffer_size);
+    LONGS_EQUAL(0, server->recv_buffer_length);
+
+    /* enough space: buffer is not reallocated */
+    server->recv_buffer_length = 100;
+    ptr_buffer = irc_server_recv_buffer_grow (server, 3995);
+    POINTERS_EQUAL(server->recv_buffer + 100, ptr_buffer);
+    LONGS_EQUAL(4096, server->recv_buffer_size);
+
+    /* not enough space for final '\0': size is doubled */
+    ptr_buffer = irc_server_recv_buffer_grow (server, 3996);
+    CHECK(ptr_buffer);
+    POINTERS_EQUAL(server->recv_buffer + 100, ptr_buffer);
+    LONGS_EQUAL(8192, server->recv_buffer_size);
+    ptr_buffer = irc_server_recv_buffer_grow (server, 65536);
+    CHECK(ptr_buffer);
+    LONGS_EQUAL(131072, server->recv_buffer_size);
+
+    /* buffer is kept during processing of messages */
+    server->recv_buffer_processing = 1;
+    old_buffer = server->recv_buffer;
+    ptr_buffer = irc_server_recv_buffer_grow (server, 131072);
+    CHECK(ptr_buffer);
+    POINTERS_EQUAL(old_buffer, server->recv_buffer_old);
+    CHECK(server->recv_buffer != old_buffer);
+    LONGS_EQUAL(262144, server->recv_buffer_size);
+    server->recv_buffer_processing = 0;
+
+    irc_server_free (server);
 }
 
 /*
  * Tests functions:
- *   irc_server_msgq_add_buffer
+ *   irc_server_recv_buffer_add
+ *   irc_server_recv_buffer_reset
  */
 
-TEST(IrcServer, MsgqAddBuffer)
+TEST(IrcServer, RecvBufferAdd)
 {
-    /* TODO: write tests */
+    struct t_irc_server *server;
+
+    server = irc_server_alloc ("server1");
+    CHECK(server);
+
+    LONGS_EQUAL(0, irc_server_recv_buffer_add (NULL, "test", 4));
+    LONGS_EQUAL(0, irc_server_recv_buffer_add (server, NULL, 4));
+    LONGS_EQUAL(0, irc_server_recv_buffer_add (server, "test", -1));
+
+    LONGS_EQUAL(1, irc_server_recv_buffer_add (server, "", 0));
+    LONGS_EQUAL(0, server->recv_buffer_length);
+    STRCMP_EQUAL("", server->recv_buffer);
+
+    LONGS_EQUAL(1, irc_server_recv_buffer_add (server, "PING :abc", 4));
+    LONGS_EQUAL(4, server->recv_buffer_length);
+    STRCMP_EQUAL("PING", server->recv_buffer);
+    LONGS_EQUAL(1, irc_server_recv_buffer_add (server, " :abc\r\n", 7));
+    LONGS_EQUAL(11, server->recv_buffer_length);
+    STRCMP_EQUAL("PING :abc\r\n", server->recv_buffer);
+
+    irc_server_recv_buffer_reset (NULL);
+    irc_server_recv_buffer_reset (server);
+    POINTERS_EQUAL(NULL, server->recv_buffer);
+    LONGS_EQUAL(0, server->recv_buffer_size);
+    LONGS_EQUAL(0, server->recv_buffer_length);
+    LONGS_EQUAL(0, server->recv_buffer_pos);
+
+    irc_server_free (server);
 }
 
 /*
  * Tests functions:
- *   irc_server_msgq_flush
+ *   irc_server_msg_process
  */
 
-TEST(IrcServer, MsgqFlush)
+TEST(IrcServer, MsgProcess)
 {
     /* TODO: write tests */
 }
@@ -1655,6 +1897,146 @@ TEST_GROUP(IrcServerConnected)
     }
 };
 
+/*
+ * Tests functions:
+ *   irc_server_recv_buffer_process
+ */
+
+TEST(IrcServerConnected, RecvBufferProcess)
+{
+    const char *data;
+    long long messages_recv;
+
+    irc_server_recv_buffer_process (NULL);
+
+    messages_recv = ptr_server->messages_recv;
+
+    data = ":server 001 alice\r\n:alice!user@host JOIN #test1\r\n"
+        ":alice!user@host JO";
+    LONGS_EQUAL(1, irc_server_recv_buffer_add (ptr_server, data,
+                                               strlen (data)));
+    irc_server_recv_buffer_process (ptr_server);
+    LONGS_EQUAL(1, ptr_server->is_connected);
+    CHECK(irc_channel_search (ptr_server, "#test1"));
+    POINTERS_EQUAL(NULL, irc_channel_search (ptr_server, "#test2"));
+    LONGS_EQUAL(messages_recv + 2, ptr_server->messages_recv);
+
+    /* unterminated message is kept at beginning of buffer */
+    STRCMP_EQUAL(":alice!user@host JO", ptr_server->recv_buffer);
+    LONGS_EQUAL(19, ptr_server->recv_buffer_length);
+    LONGS_EQUAL(0, ptr_server->recv_buffer_pos);
+    LONGS_EQUAL(0, ptr_server->recv_buffer_processing);
+
+    /* end of message, with a '\r' inside and an empty line */
+    data = "IN #te\rst2\r\n\r\n:alice!user@host JOIN #test3\n";
+    LONGS_EQUAL(1, irc_server_recv_buffer_add (ptr_server, data,
+                                               strlen (data)));
+    irc_server_recv_buffer_process (ptr_server);
+    CHECK(irc_channel_search (ptr_server, "#test2"));
+    CHECK(irc_channel_search (ptr_server, "#test3"));
+    LONGS_EQUAL(messages_recv + 4, ptr_server->messages_recv);
+    STRCMP_EQUAL("", ptr_server->recv_buffer);
+    LONGS_EQUAL(0, ptr_server->recv_buffer_length);
+    POINTERS_EQUAL(NULL, ptr_server->recv_buffer_old);
+}
+
+/*
+ * Tests functions:
+ *   irc_server_recv_buffer_process (with max time)
+ *   irc_server_timer_recv_process_cb
+ */
+
+TEST(IrcServerConnected, RecvBufferProcessMaxTime)
+{
+    char str_msg[128];
+    int i, count;
+
+    server_recv (":server 001 alice");
+
+    config_file_option_set (irc_config_network_max_process_time, "1", 1);
+
+    for (i = 0; i < 20000; i++)
+    {
+        snprintf (str_msg, sizeof (str_msg),
+                  ":server 372 alice :line %d\r\n", i);
+        irc_server_recv_buffer_add (ptr_server, str_msg, strlen (str_msg));
+    }
+    snprintf (str_msg, sizeof (str_msg),
+              ":alice!user@host JOIN #test1\r\n");
+    irc_server_recv_buffer_add (ptr_server, str_msg, strlen (str_msg));
+
+    /* only first messages are processed */
+    irc_server_recv_buffer_process (ptr_server);
+    CHECK(ptr_server->hook_timer_recv_process);
+    CHECK(ptr_server->recv_buffer_length > 0);
+    POINTERS_EQUAL(NULL, irc_channel_search (ptr_server, "#test1"));
+
+    /* other messages are processed later (timer is removed and added) */
+    count = 0;
+    while (ptr_server->hook_timer_recv_process && (count < 100000))
+    {
+        irc_server_recv_buffer_process (ptr_server);
+        count++;
+    }
+    POINTERS_EQUAL(NULL, ptr_server->hook_timer_recv_process);
+    LONGS_EQUAL(0, ptr_server->recv_buffer_length);
+    CHECK(irc_channel_search (ptr_server, "#test1"));
+
+    LONGS_EQUAL(WEECHAT_RC_ERROR,
+                irc_server_timer_recv_process_cb (NULL, NULL, 0));
+    LONGS_EQUAL(WEECHAT_RC_OK,
+                irc_server_timer_recv_process_cb (ptr_server, NULL, 0));
+
+    config_file_option_reset (irc_config_network_max_process_time, 1);
+}
+
+/*
+ * Tests functions:
+ *   irc_server_outqueue_send
+ *   irc_server_outqueue_timer_add
+ */
+
+TEST(IrcServerConnected, OutqueueSend)
+{
+    int i;
+
+    server_recv (":server 001 alice");
+
+    config_file_option_set (ptr_server->options[IRC_SERVER_OPTION_ANTI_FLOOD],
+                            "2000", 1);
+    config_file_option_set (ptr_server->options[IRC_SERVER_OPTION_ANTI_FLOOD_BURST],
+                            "2", 1);
+    ptr_server->anti_flood_time.tv_sec = 0;
+    ptr_server->anti_flood_time.tv_usec = 0;
+    ptr_server->outqueue_sent = 0;
+
+    /* only 2 messages sent, the other are sent later by the timer */
+    for (i = 0; i < 5; i++)
+    {
+        irc_server_sendf (ptr_server, IRC_SERVER_SEND_OUTQ_PRIO_HIGH, NULL,
+                          "PRIVMSG #test :message %d", i);
+    }
+    LONGS_EQUAL(2, ptr_server->outqueue_sent);
+    LONGS_EQUAL(3, ptr_server->outqueue_count);
+    CHECK(ptr_server->hook_timer_anti_flood);
+
+    /* messages with immediate priority are always sent */
+    irc_server_sendf (ptr_server, IRC_SERVER_SEND_OUTQ_PRIO_IMMEDIATE, NULL,
+                      "PONG :test");
+    LONGS_EQUAL(3, ptr_server->outqueue_sent);
+    LONGS_EQUAL(3, ptr_server->outqueue_count);
+
+    /* no anti-flood: all messages are sent */
+    config_file_option_set (ptr_server->options[IRC_SERVER_OPTION_ANTI_FLOOD],
+                            "0", 1);
+    irc_server_outqueue_send (ptr_server);
+    LONGS_EQUAL(6, ptr_server->outqueue_sent);
+    LONGS_EQUAL(0, ptr_server->outqueue_count);
+    POINTERS_EQUAL(NULL, ptr_server->hook_timer_anti_flood);
+    CHECK(ptr_server->outqueue_wait_total >= 0);
+    CHECK(ptr_server->outqueue_wait_max >= 0);
+}
+
 /*
  * Tests functions:
  *   irc_server_build_autojoin
@@ -1728,4 +2110,118 @@ TEST(IrcServerConnected, BuildAutojoin)
     server_recv (":alice!user@host MODE #test3 -k");
     WEE_TEST_STR("#test1,#test2,#test3",
                  irc_server_build_autojoin (ptr_server));
+
+    /* channel displayed in a window is first */
+    gui_window_switch_to_buffer (gui_current_window,
+                                 ptr_server->last_channel->buffer, 0);
+    WEE_TEST_STR("#test3,#test1,#test2",
+                 irc_server_build_autojoin (ptr_server));
+    gui_window_switch_to_buffer (gui_current_window, gui_buffers, 0);
+}
+
+/*
+ * Tests functions:
+ *   irc_server_join_burst_start
+ *   irc_server_join_burst_defer_check
+ *   irc_server_join_burst_end
+ */
+
+TEST(IrcServerConnected, JoinBurst)
+{
+    struct t_irc_channel *ptr_channel1, *ptr_channel2;
+    long long sent;
+
+    server_recv (":server 001 alice");
+
+    config_file_option_set (ptr_server->options[IRC_SERVER_OPTION_ANTI_FLOOD],
+                            "0", 1);
+
+    LONGS_EQUAL(0, ptr_server->join_burst);
+    LONGS_EQUAL(0, irc_server_join_burst_defer_check (NULL, NULL));
+
+    irc_server_join_burst_start (ptr_server, NULL);
+    irc_server_join_burst_start (ptr_server, "");
+    LONGS_EQUAL(0, ptr_server->join_burst);
+
+    irc_server_join_burst_start (ptr_server, "#test1,#test2 key1");
+    LONGS_EQUAL(2, ptr_server->join_burst);
+    CHECK(ptr_server->join_burst_time > 0);
+
+    /* first channel joined: MODE is delayed */
+    sent = ptr_server->outqueue_sent;
+    server_recv (":alice!user@host JOIN #test1");
+    server_recv (":server 353 alice = #test1 :alice");
+    server_recv (":server 366 alice #test1 :End of /NAMES list");
+    ptr_channel1 = irc_channel_search (ptr_server, "#test1");
+    CHECK(ptr_channel1);
+    LONGS_EQUAL(1, ptr_channel1->join_check_pending);
+    LONGS_EQUAL(1, ptr_server->join_burst);
+    LONGS_EQUAL(sent, ptr_server->outqueue_sent);
+
+    /* second channel joined: end of burst, MODE sent for both channels */
+    server_recv (":alice!user@host JOIN #test2");
+    server_recv (":server 353 alice = #test2 :alice");
+    server_recv (":server 366 alice #test2 :End of /NAMES list");
+    ptr_channel2 = irc_channel_search (ptr_server, "#test2");
+    CHECK(ptr_channel2);
+    LONGS_EQUAL(0, ptr_channel1->join_check_pending);
+    LONGS_EQUAL(0, ptr_channel2->join_check_pending);
+    LONGS_EQUAL(0, ptr_server->join_burst);
+    LONGS_EQUAL(0, ptr_server->join_burst_time);
+    LONGS_EQUAL(sent + 2, ptr_server->outqueue_sent);
+
+    /* no burst: MODE sent immediately */
+    server_recv (":alice!user@host JOIN #test3");
+    server_recv (":server 366 alice #test3 :End of /NAMES list");
+    LONGS_EQUAL(sent + 3, ptr_server->outqueue_sent);
+
+    /* burst not drained (channel not joined): end of burst forced */
+    irc_server_join_burst_start (ptr_server, "#test4,#test5");
+    server_recv (":alice!user@host JOIN #test4");
+    server_recv (":server 366 alice #test4 :End of /NAMES list");
+    LONGS_EQUAL(1, ptr_server->join_burst);
+    LONGS_EQUAL(sent + 3, ptr_server->outqueue_sent);
+    irc_server_join_burst_end (ptr_server);
+    LONGS_EQUAL(0, ptr_server->join_burst);
+    LONGS_EQUAL(sent + 4, ptr_server->outqueue_sent);
+}
+
+/*
+ * Tests functions:
+ *   irc_typing_send_to_targets
+ */
+
+TEST(IrcServerConnected, TypingSendToTargets)
+{
+    struct t_irc_channel *ptr_channel;
+
+    server_recv (":server 001 alice");
+    server_recv (":alice!user@host JOIN #test");
+    ptr_channel = irc_channel_search (ptr_server, "#test");
+    CHECK(ptr_channel);
+    LONGS_EQUAL(0, ptr_server->typing_pending);
+
+    config_file_option_set (irc_config_look_typing_status_self, "on", 1);
+
+    /* nothing pending: channels are not checked */
+    ptr_channel->typing_state = IRC_CHANNEL_TYPING_STATE_ACTIVE;
+    ptr_channel->typing_status_sent = 0;
+    irc_typing_send_to_targets (ptr_server);
+    LONGS_EQUAL(0, ptr_channel->typing_status_sent);
+
+    /* typing active: status sent, still pending */
+    ptr_server->typing_pending = 1;
+    irc_typing_send_to_targets (ptr_server);
+    CHECK(ptr_channel->typing_status_sent > 0);
+    LONGS_EQUAL(IRC_CHANNEL_TYPING_STATE_ACTIVE, ptr_channel->typing_state);
+    LONGS_EQUAL(1, ptr_server->typing_pending);
+
+    /* typing done: status sent, nothing pending any more */
+    ptr_channel->typing_state = IRC_CHANNEL_TYPING_STATE_DONE;
+    ptr_channel->typing_status_sent = 0;
+    irc_typing_send_to_targets (ptr_server);
+    LONGS_EQUAL(IRC_CHANNEL_TYPING_STATE_OFF, ptr_channel->typing_state);
+    LONGS_EQUAL(0, ptr_server->typing_pending);
+
+    config_file_option_reset (irc_config_look_typing_status_self, 1);
 }
@@ -27,16 +27,19 @@ extern "C"
 {
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
 #include "src/core/core-arraylist.h"
 #include "src/core/core-config.h"
 #include "src/gui/gui-buffer.h"
 #include "src/gui/gui-color.h"
 #include "src/gui/gui-line.h"
+#include "src/plugins/logger/logger-backlog.h"
 #include "src/plugins/logger/logger-config.h"
 
 extern void logger_backlog_display_line (struct t_gui_buffer *buffer,
                                          const char *line);
-extern struct t_arraylist *logger_backlog_group_messages (struct t_arraylist *lines);
+extern struct t_arraylist *logger_backlog_group_messages (struct t_arraylist *lines,
+                                                          const char *time_format);
 }
 
 TEST_GROUP(LoggerBacklog)
@@ -208,7 +211,7 @@ TEST(LoggerBacklog, GroupMessages)
     };
     int i;
 
-    POINTERS_EQUAL(NULL, logger_backlog_group_messages (NULL));
+    POINTERS_EQUAL(NULL, logger_backlog_group_messages (NULL, NULL));
 
     lines = arraylist_new (32, 0, 1,
                            &test_logger_backlog_msg_cmp_cb, NULL,
@@ -219,7 +222,7 @@ TEST(LoggerBacklog, GroupMessages)
         arraylist_add (lines, strdup (test_lines_1[i]));
     }
 
-    messages = logger_backlog_group_messages (lines);
+    messages = logger_backlog_group_messages (lines, NULL);
     CHECK(messages);
     LONGS_EQUAL(2, arraylist_size (messages));
     STRCMP_EQUAL("2023-06-04 21:15:34\t\tMessage 1",
@@ -235,7 +238,7 @@ TEST(LoggerBacklog, GroupMessages)
         arraylist_add (lines, strdup (test_lines_2[i]));
     }
 
-    messages = logger_backlog_group_messages (lines);
+    messages = logger_backlog_group_messages (lines, NULL);
     CHECK(messages);
     LONGS_EQUAL(4, arraylist_size (messages));
     STRCMP_EQUAL("end of line",
@@ -255,6 +258,59 @@ TEST(LoggerBacklog, GroupMessages)
     arraylist_free (lines);
 }
 
+/*
+ * Tests functions:
+ *   logger_backlog_read
+ */
+
+TEST(LoggerBacklog, Read)
+{
+    const char *filename = "/tmp/test-logger-backlog.log";
+    struct t_arraylist *messages;
+    FILE *file;
+
+    POINTERS_EQUAL(NULL, logger_backlog_read (NULL, 10, 0, "%Y"));
+    POINTERS_EQUAL(NULL, logger_backlog_read ("/tmp/does/not/exist.log",
+                                              10, 0, "%Y"));
+
+    file = fopen (filename, "w");
+    CHECK(file);
+    fputs ("2023-06-04 21:15:34\t\tMessage 1\n"
+           "2023-06-04 21:15:37\t\tMessage 2\n"
+           "second line\n"
+           "2023-06-04 21:15:40\t\tMessage 3\n",
+           file);
+    fclose (file);
+
+    messages = logger_backlog_read (filename, 3, 0, "%Y-%m-%d %H:%M:%S");
+    CHECK(messages);
+    LONGS_EQUAL(2, arraylist_size (messages));
+    STRCMP_EQUAL("2023-06-04 21:15:37\t\tMessage 2\nsecond line",
+                 (const char *)arraylist_get (messages, 0));
+    STRCMP_EQUAL("2023-06-04 21:15:40\t\tMessage 3",
+                 (const char *)arraylist_get (messages, 1));
+    arraylist_free (messages);
+
+    /* no index: the end of file is read */
+    messages = logger_backlog_read (filename, 10, 1, "%Y-%m-%d %H:%M:%S");
+    CHECK(messages);
+    LONGS_EQUAL(3, arraylist_size (messages));
+    arraylist_free (messages);
+
+    unlink (filename);
+}
+
+/*
+ * Tests functions:
+ *   logger_backlog_display
+ */
+
+TEST(LoggerBacklog, Display)
+{
+    logger_backlog_display (NULL, NULL);
+    logger_backlog_display (gui_buffers, NULL);
+}
+
 /*
  * Tests functions:
  *   logger_backlog_file
@@ -0,0 +1,235 @@
+/*
+ * test-logger-index.cpp - test logger index functions
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+#include "tests/tests.h"
+
+extern "C"
+{
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include "src/core/core-string.h"
+#include "src/plugins/logger/logger-buffer.h"
+#include "src/plugins/logger/logger-index.h"
+#include "src/plugins/logger/logger-writer.h"
+}
+
+#define WEE_TEST_LOG_CONTENT "msg 1\nmsg 2\nmsg 3\n"
+
+TEST_GROUP(LoggerIndex)
+{
+    char *log_filename;
+    char *index_filename;
+
+    void setup ()
+    {
+        FILE *file;
+
+        log_filename = string_eval_path_home (
+            "${weechat_data_dir}/test_index.weechatlog", NULL, NULL, NULL);
+        index_filename = logger_index_get_filename (log_filename);
+
+        /* write a small log file */
+        file = fopen (log_filename, "w");
+        fwrite (WEE_TEST_LOG_CONTENT, 1, strlen (WEE_TEST_LOG_CONTENT), file);
+        fclose (file);
+        unlink (index_filename);
+    }
+
+    void teardown ()
+    {
+        unlink (log_filename);
+        unlink (index_filename);
+        free (log_filename);
+        free (index_filename);
+    }
+
+    /*
+     * Writes an index file with 3 entries (one per message of the log
+     * file), the first one starting at offset "first_offset".
+     */
+
+    void write_index (int64_t first_offset)
+    {
+        struct t_logger_index_entry entries[3];
+        FILE *file;
+
+        entries[0].offset = first_offset;
+        entries[0].length = 6;
+        entries[0].date = 1000;
+        entries[1].offset = 6;
+        entries[1].length = 6;
+        entries[1].date = 2000;
+        entries[2].offset = 12;
+        entries[2].length = 6;
+        entries[2].date = 3000;
+        file = fopen (index_filename, "w");
+        fwrite (entries, 1, sizeof (entries), file);
+        fclose (file);
+    }
+};
+
+/*
+ * Tests functions:
+ *   logger_index_get_filename
+ */
+
+TEST(LoggerIndex, GetFilename)
+{
+    char *str;
+
+    POINTERS_EQUAL(NULL, logger_index_get_filename (NULL));
+    POINTERS_EQUAL(NULL, logger_index_get_filename (""));
+
+    WEE_TEST_STR("/tmp/test.weechatlog.idx",
+                 logger_index_get_filename ("/tmp/test.weechatlog"));
+}
+
+/*
+ * Tests functions:
+ *   logger_index_read_entry
+ *   logger_index_open_read
+ *   logger_index_tail_offset
+ */
+
+TEST(LoggerIndex, TailOffset)
+{
+    /* no index */
+    LONGS_EQUAL(-1, logger_index_tail_offset (log_filename, 1));
+
+    write_index (0);
+
+    LONGS_EQUAL(-1, logger_index_tail_offset (log_filename, 0));
+    LONGS_EQUAL(12, logger_index_tail_offset (log_filename, 1));
+    LONGS_EQUAL(6, logger_index_tail_offset (log_filename, 2));
+    LONGS_EQUAL(0, logger_index_tail_offset (log_filename, 3));
+    LONGS_EQUAL(0, logger_index_tail_offset (log_filename, 10));
+
+    /* index covering only the end of log file */
+    write_index (2);
+    LONGS_EQUAL(2, logger_index_tail_offset (log_filename, 3));
+    LONGS_EQUAL(-1, logger_index_tail_offset (log_filename, 10));
+
+    /* invalid index */
+    truncate (index_filename, 10);
+    LONGS_EQUAL(-1, logger_index_tail_offset (log_filename, 1));
+}
+
+/*
+ * Tests functions:
+ *   logger_index_search_date
+ */
+
+TEST(LoggerIndex, SearchDate)
+{
+    /* no index */
+    LONGS_EQUAL(-1, logger_index_search_date (log_filename, 0));
+
+    write_index (0);
+
+    LONGS_EQUAL(0, logger_index_search_date (log_filename, 0));
+    LONGS_EQUAL(0, logger_index_search_date (log_filename, 1000));
+    LONGS_EQUAL(6, logger_index_search_date (log_filename, 1001));
+    LONGS_EQUAL(6, logger_index_search_date (log_filename, 2000));
+    LONGS_EQUAL(12, logger_index_search_date (log_filename, 2500));
+    LONGS_EQUAL(-1, logger_index_search_date (log_filename, 3001));
+
+    /* index covering only the end of log file */
+    write_index (2);
+    LONGS_EQUAL(-1, logger_index_search_date (log_filename, 0));
+    LONGS_EQUAL(6, logger_index_search_date (log_filename, 1500));
+}
+
+/*
+ * Tests functions:
+ *   logger_index_open
+ *   logger_index_add
+ *   logger_index_flush
+ *   logger_index_close
+ */
+
+TEST(LoggerIndex, OpenAddFlush)
+{
+    struct t_logger_buffer logger_buffer;
+    struct t_logger_index_entry entry;
+    struct stat st;
+    int fd;
+
+    memset (&logger_buffer, 0, sizeof (logger_buffer));
+    logger_buffer.log_filename = log_filename;
+    logger_buffer.log_file = fopen (log_filename, "a");
+    CHECK(logger_buffer.log_file);
+    logger_buffer.log_file_size = strlen (WEE_TEST_LOG_CONTENT);
+    logger_buffer.log_data = string_dyn_alloc (64);
+    logger_buffer.index_fd = -1;
+
+    LONGS_EQUAL(0, logger_index_open (NULL));
+
+    /* valid index: kept */
+    write_index (0);
+    LONGS_EQUAL(1, logger_index_open (&logger_buffer));
+    CHECK(logger_buffer.index_fd >= 0);
+    LONGS_EQUAL(1, logger_index_open (&logger_buffer));
+    logger_index_add (&logger_buffer, 18, 6, 4000);
+    logger_index_add (&logger_buffer, 24, 6, 5000);
+    LONGS_EQUAL(2, logger_buffer.index_count);
+    logger_index_flush (&logger_buffer);
+    LONGS_EQUAL(0, logger_buffer.index_count);
+    POINTERS_EQUAL(NULL, logger_buffer.index_entries);
+    logger_writer_wait ();
+    logger_index_close (&logger_buffer);
+    LONGS_EQUAL(-1, logger_buffer.index_fd);
+    LONGS_EQUAL(0, stat (index_filename, &st));
+    LONGS_EQUAL(5 * sizeof (entry), st.st_size);
+    fd = open (index_filename, O_RDONLY);
+    LONGS_EQUAL(1, logger_index_read_entry (fd, 4, &entry));
+    LONGS_EQUAL(24, entry.offset);
+    LONGS_EQUAL(6, entry.length);
+    LONGS_EQUAL(5000, entry.date);
+    LONGS_EQUAL(0, logger_index_read_entry (fd, 5, &entry));
+    close (fd);
+
+    /* index does not match log file (2 messages not in log file): truncated */
+    LONGS_EQUAL(1, logger_index_open (&logger_buffer));
+    LONGS_EQUAL(0, stat (index_filename, &st));
+    LONGS_EQUAL(0, st.st_size);
+    logger_index_close (&logger_buffer);
+
+    /* entries not flushed are lost on close */
+    LONGS_EQUAL(1, logger_index_open (&logger_buffer));
+    logger_index_add (&logger_buffer, 18, 6, 4000);
+    logger_index_close (&logger_buffer);
+    LONGS_EQUAL(0, logger_buffer.index_count);
+    LONGS_EQUAL(0, stat (index_filename, &st));
+    LONGS_EQUAL(0, st.st_size);
+
+    /* index not opened: entry is ignored */
+    logger_index_add (&logger_buffer, 18, 6, 4000);
+    LONGS_EQUAL(0, logger_buffer.index_count);
+
+    fclose (logger_buffer.log_file);
+    string_dyn_free (logger_buffer.log_data, 1);
+}
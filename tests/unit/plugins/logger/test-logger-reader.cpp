@@ -0,0 +1,68 @@
+/*
+ * test-logger-reader.cpp - test logger reader functions
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+#include "tests/tests.h"
+
+extern "C"
+{
+#include "src/gui/gui-buffer.h"
+#include "src/plugins/logger/logger-reader.h"
+}
+
+TEST_GROUP(LoggerReader)
+{
+};
+
+/*
+ * Tests functions:
+ *   logger_reader_add
+ *   logger_reader_cancel
+ */
+
+TEST(LoggerReader, AddCancel)
+{
+    LONGS_EQUAL(0, logger_reader_add (NULL, "/tmp/test.log", 10, 0, "%Y"));
+    LONGS_EQUAL(0, logger_reader_add (gui_buffers, NULL, 10, 0, "%Y"));
+    LONGS_EQUAL(0, logger_reader_add (gui_buffers, "/tmp/test.log", 10, 0,
+                                      NULL));
+
+    /* request canceled immediately: backlog is never displayed */
+    LONGS_EQUAL(logger_reader_thread_running,
+                logger_reader_add (gui_buffers,
+                                   "/tmp/test-logger-reader.log", 10, 0,
+                                   "%Y-%m-%d %H:%M:%S"));
+    logger_reader_cancel (gui_buffers);
+
+    logger_reader_cancel (NULL);
+}
+
+/*
+ * Tests functions:
+ *   logger_reader_prioritize
+ */
+
+TEST(LoggerReader, Prioritize)
+{
+    logger_reader_prioritize (NULL);
+    logger_reader_prioritize (gui_buffers);
+}
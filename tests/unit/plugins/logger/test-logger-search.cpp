@@ -0,0 +1,261 @@
+/*
+ * test-logger-search.cpp - test logger search index functions
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+#include "tests/tests.h"
+
+extern "C"
+{
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "src/core/core-arraylist.h"
+#include "src/core/core-dir.h"
+#include "src/core/core-string.h"
+#include "src/plugins/logger/logger-buffer.h"
+#include "src/plugins/logger/logger-search.h"
+#include "src/plugins/logger/logger-writer.h"
+}
+
+#define WEE_TEST_LOG_LINE1 "t1\talice\thello world"
+#define WEE_TEST_LOG_LINE2 "t2\tbob\thello weechat"
+#define WEE_TEST_LOG_LINE3 "t3\talice\tweechat release"
+
+TEST_GROUP(LoggerSearch)
+{
+};
+
+/*
+ * Tests functions:
+ *   logger_search_split_words
+ */
+
+TEST(LoggerSearch, SplitWords)
+{
+    char **words;
+    int num_words;
+
+    POINTERS_EQUAL(NULL, logger_search_split_words (NULL, &num_words));
+    LONGS_EQUAL(0, num_words);
+    POINTERS_EQUAL(NULL, logger_search_split_words ("test", NULL));
+
+    words = logger_search_split_words ("", &num_words);
+    LONGS_EQUAL(0, num_words);
+    string_free_split (words);
+
+    words = logger_search_split_words ("Hello, World! a WeeChat-4.4 "
+                                       "http://weechat.org/", &num_words);
+    CHECK(words);
+    LONGS_EQUAL(6, num_words);
+    STRCMP_EQUAL("hello", words[0]);
+    STRCMP_EQUAL("world", words[1]);
+    STRCMP_EQUAL("weechat", words[2]);
+    STRCMP_EQUAL("http", words[3]);
+    STRCMP_EQUAL("weechat", words[4]);
+    STRCMP_EQUAL("org", words[5]);
+    POINTERS_EQUAL(NULL, words[6]);
+    string_free_split (words);
+}
+
+/*
+ * Tests functions:
+ *   logger_search_query_parse
+ *   logger_search_query_free
+ */
+
+TEST(LoggerSearch, QueryParse)
+{
+    struct t_logger_search_query *query;
+    const char *error;
+
+    POINTERS_EQUAL(NULL, logger_search_query_parse (NULL, &error));
+
+    POINTERS_EQUAL(NULL, logger_search_query_parse ("", &error));
+    STRCMP_EQUAL("nothing to search", error);
+    POINTERS_EQUAL(NULL, logger_search_query_parse ("-limit 10 a", &error));
+    STRCMP_EQUAL("nothing to search", error);
+    POINTERS_EQUAL(NULL, logger_search_query_parse ("-since abc test", &error));
+    STRCMP_EQUAL("invalid date", error);
+    POINTERS_EQUAL(NULL, logger_search_query_parse ("-limit 0 test", &error));
+    STRCMP_EQUAL("invalid limit", error);
+    POINTERS_EQUAL(NULL, logger_search_query_parse ("-limit x test", NULL));
+
+    query = logger_search_query_parse ("Hello", &error);
+    CHECK(query);
+    POINTERS_EQUAL(NULL, error);
+    LONGS_EQUAL(1, query->num_terms);
+    STRCMP_EQUAL("hello", query->terms[0]);
+    POINTERS_EQUAL(NULL, query->terms[1]);
+    POINTERS_EQUAL(NULL, query->buffer_name);
+    LONGS_EQUAL(0, query->date_min);
+    LONGS_EQUAL(0, query->date_max);
+    LONGS_EQUAL(LOGGER_SEARCH_DEFAULT_LIMIT, query->limit);
+    logger_search_query_free (query);
+
+    query = logger_search_query_parse (
+        "-buffer irc.libera.#weechat -nick Alice -tag irc_privmsg "
+        "-since 1000 -until 2000 -limit 5 weechat release",
+        &error);
+    CHECK(query);
+    LONGS_EQUAL(4, query->num_terms);
+    STRCMP_EQUAL("nick:alice", query->terms[0]);
+    STRCMP_EQUAL("tag:irc_privmsg", query->terms[1]);
+    STRCMP_EQUAL("weechat", query->terms[2]);
+    STRCMP_EQUAL("release", query->terms[3]);
+    STRCMP_EQUAL("irc.libera.#weechat", query->buffer_name);
+    LONGS_EQUAL(1000, query->date_min);
+    LONGS_EQUAL(2000, query->date_max);
+    LONGS_EQUAL(5, query->limit);
+    logger_search_query_free (query);
+
+    logger_search_query_free (NULL);
+}
+
+/*
+ * Tests functions:
+ *   logger_search_add_line
+ *   logger_search_write_segment
+ *   logger_search_free_terms
+ *   logger_search_run
+ *   logger_search_remove_segments
+ */
+
+TEST(LoggerSearch, Run)
+{
+    struct t_logger_buffer logger_buffer;
+    struct t_logger_search_query *query;
+    struct t_logger_search_result *ptr_result;
+    struct t_arraylist *results;
+    const char *tags_alice[] = { "irc_privmsg", "nick_alice", NULL };
+    const char *tags_bob[] = { "irc_privmsg", "nick_bob", NULL };
+    char *log_path, *log_filename, *directory, segment[1024];
+    struct stat st;
+    FILE *file;
+
+    log_path = string_eval_path_home ("${weechat_data_dir}/logs",
+                                      NULL, NULL, NULL);
+    dir_mkdir_parents (log_path, 0700);
+    log_filename = string_eval_path_home (
+        "${weechat_data_dir}/logs/test_search.weechatlog", NULL, NULL, NULL);
+    directory = string_eval_path_home (
+        "${weechat_data_dir}/logs/test_search.weechatlog.fts",
+        NULL, NULL, NULL);
+    snprintf (segment, sizeof (segment), "%s/0.seg", directory);
+
+    file = fopen (log_filename, "w");
+    fputs (WEE_TEST_LOG_LINE1 "\n", file);
+    fputs (WEE_TEST_LOG_LINE2 "\n", file);
+    fputs (WEE_TEST_LOG_LINE3 "\n", file);
+    fclose (file);
+
+    memset (&logger_buffer, 0, sizeof (logger_buffer));
+    logger_buffer.log_filename = log_filename;
+
+    logger_search_add_line (NULL, 0, 1000, 2, tags_alice, "hello world");
+    logger_search_add_line (&logger_buffer, -1, 1000, 2, tags_alice,
+                            "hello world");
+    POINTERS_EQUAL(NULL, logger_buffer.search_terms);
+
+    logger_search_add_line (&logger_buffer, 0, 1000, 2, tags_alice,
+                            "hello world");
+    logger_search_add_line (&logger_buffer, 21, 2000, 2, tags_bob,
+                            "hello weechat");
+    logger_search_add_line (&logger_buffer, 42, 3000, 2, tags_alice,
+                            "weechat release");
+    CHECK(logger_buffer.search_terms);
+    /* for each line: 2 words, 1 nick and 2 tags */
+    LONGS_EQUAL(15, logger_buffer.search_num_postings);
+    LONGS_EQUAL(0, logger_buffer.search_first_offset);
+
+    logger_search_write_segment (&logger_buffer);
+    POINTERS_EQUAL(NULL, logger_buffer.search_terms);
+    LONGS_EQUAL(0, logger_buffer.search_num_postings);
+    logger_writer_wait ();
+    LONGS_EQUAL(0, stat (segment, &st));
+
+    /* one word */
+    query = logger_search_query_parse ("weechat", NULL);
+    results = logger_search_run (query);
+    CHECK(results);
+    LONGS_EQUAL(2, arraylist_size (results));
+    ptr_result = (struct t_logger_search_result *)arraylist_get (results, 0);
+    STRCMP_EQUAL(log_filename, ptr_result->log_filename);
+    LONGS_EQUAL(2000, ptr_result->date);
+    STRCMP_EQUAL(WEE_TEST_LOG_LINE2, ptr_result->line);
+    ptr_result = (struct t_logger_search_result *)arraylist_get (results, 1);
+    LONGS_EQUAL(3000, ptr_result->date);
+    STRCMP_EQUAL(WEE_TEST_LOG_LINE3, ptr_result->line);
+    arraylist_free (results);
+    logger_search_query_free (query);
+
+    /* limit: most recent lines are returned */
+    query = logger_search_query_parse ("-limit 1 weechat", NULL);
+    results = logger_search_run (query);
+    LONGS_EQUAL(1, arraylist_size (results));
+    ptr_result = (struct t_logger_search_result *)arraylist_get (results, 0);
+    STRCMP_EQUAL(WEE_TEST_LOG_LINE3, ptr_result->line);
+    arraylist_free (results);
+    logger_search_query_free (query);
+
+    /* nick and word */
+    query = logger_search_query_parse ("-nick alice hello", NULL);
+    results = logger_search_run (query);
+    LONGS_EQUAL(1, arraylist_size (results));
+    ptr_result = (struct t_logger_search_result *)arraylist_get (results, 0);
+    STRCMP_EQUAL(WEE_TEST_LOG_LINE1, ptr_result->line);
+    arraylist_free (results);
+    logger_search_query_free (query);
+
+    /* tag and dates */
+    query = logger_search_query_parse (
+        "-tag irc_privmsg -since 1500 -until 2500", NULL);
+    results = logger_search_run (query);
+    LONGS_EQUAL(1, arraylist_size (results));
+    ptr_result = (struct t_logger_search_result *)arraylist_get (results, 0);
+    STRCMP_EQUAL(WEE_TEST_LOG_LINE2, ptr_result->line);
+    arraylist_free (results);
+    logger_search_query_free (query);
+
+    /* no line found */
+    query = logger_search_query_parse ("-nick bob release", NULL);
+    results = logger_search_run (query);
+    LONGS_EQUAL(0, arraylist_size (results));
+    arraylist_free (results);
+    logger_search_query_free (query);
+    query = logger_search_query_parse ("unknown", NULL);
+    results = logger_search_run (query);
+    LONGS_EQUAL(0, arraylist_size (results));
+    arraylist_free (results);
+    logger_search_query_free (query);
+
+    /* remove segments */
+    logger_search_remove_segments (log_filename);
+    LONGS_EQUAL(-1, stat (segment, &st));
+    LONGS_EQUAL(-1, stat (directory, &st));
+
+    unlink (log_filename);
+    free (log_path);
+    free (log_filename);
+    free (directory);
+}
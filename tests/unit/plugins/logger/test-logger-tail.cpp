@@ -346,3 +346,58 @@ TEST(LoggerTail, File)
     unlink (filename);
     free (filename);
 }
+
+/*
+ * Tests functions:
+ *   logger_tail_file_from_offset
+ */
+
+TEST(LoggerTail, FileFromOffset)
+{
+    const char *content = "line 1\nline 2\n\nline 3\n";
+    char *filename;
+    struct t_arraylist *lines;
+    FILE *file;
+
+    POINTERS_EQUAL(NULL, logger_tail_file_from_offset (NULL, 0));
+    POINTERS_EQUAL(NULL, logger_tail_file_from_offset ("", 0));
+
+    /* write a small test file */
+    filename = string_eval_path_home ("${weechat_data_dir}/test_file.txt",
+                                      NULL, NULL, NULL);
+    file = fopen (filename, "w");
+    fwrite (content, 1, strlen (content), file);
+    fflush (file);
+    fclose (file);
+
+    POINTERS_EQUAL(NULL, logger_tail_file_from_offset (filename, -1));
+    POINTERS_EQUAL(NULL, logger_tail_file_from_offset (filename, 22));
+    POINTERS_EQUAL(NULL, logger_tail_file_from_offset (filename, 100));
+
+    lines = logger_tail_file_from_offset (filename, 0);
+    CHECK(lines);
+    LONGS_EQUAL(4, arraylist_size (lines));
+    STRCMP_EQUAL("line 1", (const char *)arraylist_get (lines, 0));
+    STRCMP_EQUAL("line 2", (const char *)arraylist_get (lines, 1));
+    STRCMP_EQUAL("", (const char *)arraylist_get (lines, 2));
+    STRCMP_EQUAL("line 3", (const char *)arraylist_get (lines, 3));
+    arraylist_free (lines);
+
+    lines = logger_tail_file_from_offset (filename, 7);
+    CHECK(lines);
+    LONGS_EQUAL(3, arraylist_size (lines));
+    STRCMP_EQUAL("line 2", (const char *)arraylist_get (lines, 0));
+    STRCMP_EQUAL("", (const char *)arraylist_get (lines, 1));
+    STRCMP_EQUAL("line 3", (const char *)arraylist_get (lines, 2));
+    arraylist_free (lines);
+
+    /* offset in the middle of a line */
+    lines = logger_tail_file_from_offset (filename, 18);
+    CHECK(lines);
+    LONGS_EQUAL(1, arraylist_size (lines));
+    STRCMP_EQUAL("e 3", (const char *)arraylist_get (lines, 0));
+    arraylist_free (lines);
+
+    unlink (filename);
+    free (filename);
+}
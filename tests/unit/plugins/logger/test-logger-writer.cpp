@@ -0,0 +1,122 @@
+/*
+ * test-logger-writer.cpp - test logger writer functions
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+#include "tests/tests.h"
+
+extern "C"
+{
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "src/plugins/logger/logger-writer.h"
+}
+
+#define WEE_TEST_FILENAME "/tmp/test-logger-writer.log"
+
+TEST_GROUP(LoggerWriter)
+{
+    /*
+     * Reads content of test file (up to size - 1 bytes).
+     */
+
+    void read_test_file (char *buffer, int size)
+    {
+        FILE *file;
+        size_t num_read;
+
+        buffer[0] = '\0';
+        file = fopen (WEE_TEST_FILENAME, "r");
+        if (!file)
+            return;
+        num_read = fread (buffer, 1, size - 1, file);
+        buffer[num_read] = '\0';
+        fclose (file);
+    }
+};
+
+/*
+ * Tests functions:
+ *   logger_writer_write_batch
+ */
+
+TEST(LoggerWriter, WriteBatch)
+{
+    struct t_logger_writer_batch *batch;
+    char content[256];
+
+    unlink (WEE_TEST_FILENAME);
+
+    logger_writer_write_batch (NULL);
+
+    batch = (struct t_logger_writer_batch *)malloc (sizeof (*batch));
+    CHECK(batch);
+    batch->fd = open (WEE_TEST_FILENAME, O_WRONLY | O_CREAT | O_APPEND, 0600);
+    CHECK(batch->fd >= 0);
+    batch->data = strdup ("line 1\nline 2\n");
+    batch->size = strlen (batch->data);
+    batch->fsync = 1;
+    batch->next_batch = NULL;
+
+    /* batch is freed and file descriptor is closed */
+    logger_writer_write_batch (batch);
+
+    read_test_file (content, sizeof (content));
+    STRCMP_EQUAL("line 1\nline 2\n", content);
+
+    unlink (WEE_TEST_FILENAME);
+}
+
+/*
+ * Tests functions:
+ *   logger_writer_add
+ *   logger_writer_wait
+ */
+
+TEST(LoggerWriter, Add)
+{
+    char content[256];
+    int fd;
+
+    unlink (WEE_TEST_FILENAME);
+
+    LONGS_EQUAL(0, logger_writer_add (-1, NULL, 0, 0));
+    LONGS_EQUAL(0, logger_writer_add (-1, strdup ("test"), 4, 0));
+
+    fd = open (WEE_TEST_FILENAME, O_WRONLY | O_CREAT | O_APPEND, 0600);
+    CHECK(fd >= 0);
+    LONGS_EQUAL(0, logger_writer_add (dup (fd), NULL, 0, 0));
+    LONGS_EQUAL(1, logger_writer_add (dup (fd), strdup ("line 1\n"), 7, 0));
+    LONGS_EQUAL(1, logger_writer_add (dup (fd), strdup ("line 2\n"), 7, 1));
+    LONGS_EQUAL(1, logger_writer_add (dup (fd), strdup (""), 0, 0));
+    close (fd);
+
+    /* the file descriptor is still valid in batches after close */
+    logger_writer_wait ();
+
+    read_test_file (content, sizeof (content));
+    STRCMP_EQUAL("line 1\nline 2\n", content);
+
+    unlink (WEE_TEST_FILENAME);
+}
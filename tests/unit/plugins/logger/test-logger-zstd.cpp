@@ -0,0 +1,184 @@
+/*
+ * test-logger-zstd.cpp - test logger zstd functions
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "src/core/core-arraylist.h"
+#include "src/core/core-string.h"
+#include "src/plugins/logger/logger-tail.h"
+#include "src/plugins/logger/logger-zstd.h"
+}
+
+TEST_GROUP(LoggerZstd)
+{
+    char *filename;
+
+    void setup ()
+    {
+        filename = string_eval_path_home (
+            "${weechat_data_dir}/test_zstd.weechatlog", NULL, NULL, NULL);
+        unlink (filename);
+    }
+
+    void teardown ()
+    {
+        unlink (filename);
+        free (filename);
+    }
+
+    /*
+     * Appends data compressed in a zstd frame to the file, with or without
+     * the skippable frame.
+     */
+
+    void append_frame (const char *data, int with_trailer)
+    {
+        char *frame;
+        int size;
+        FILE *file;
+
+        frame = logger_zstd_compress_frame (data, strlen (data), 20, &size);
+        CHECK(frame);
+        file = fopen (filename, "a");
+        fwrite (frame, 1,
+                (with_trailer) ? size : size - LOGGER_ZSTD_TRAILER_SIZE,
+                file);
+        fclose (file);
+        free (frame);
+    }
+};
+
+/*
+ * Tests functions:
+ *   logger_zstd_is_compressed
+ */
+
+TEST(LoggerZstd, IsCompressed)
+{
+    FILE *file;
+
+    LONGS_EQUAL(0, logger_zstd_is_compressed (NULL));
+    LONGS_EQUAL(0, logger_zstd_is_compressed (""));
+    LONGS_EQUAL(0, logger_zstd_is_compressed (filename));
+
+    file = fopen (filename, "w");
+    fputs ("line 1\n", file);
+    fclose (file);
+    LONGS_EQUAL(0, logger_zstd_is_compressed (filename));
+
+#ifdef HAVE_ZSTD
+    unlink (filename);
+    append_frame ("line 1\n", 1);
+    LONGS_EQUAL(1, logger_zstd_is_compressed (filename));
+#endif /* HAVE_ZSTD */
+}
+
+#ifdef HAVE_ZSTD
+
+/*
+ * Tests functions:
+ *   logger_zstd_compress_frame
+ */
+
+TEST(LoggerZstd, CompressFrame)
+{
+    char *frame;
+    int size;
+
+    POINTERS_EQUAL(NULL, logger_zstd_compress_frame (NULL, 1, 20, &size));
+    LONGS_EQUAL(0, size);
+    POINTERS_EQUAL(NULL, logger_zstd_compress_frame ("test", 0, 20, &size));
+    POINTERS_EQUAL(NULL, logger_zstd_compress_frame ("test", 4, 20, NULL));
+
+    frame = logger_zstd_compress_frame ("test\n", 5, 20, &size);
+    CHECK(frame);
+    CHECK(size > LOGGER_ZSTD_TRAILER_SIZE);
+    MEMCMP_EQUAL(LOGGER_ZSTD_MAGIC, frame, 4);
+    MEMCMP_EQUAL(LOGGER_ZSTD_TRAILER_MAGIC,
+                 frame + size - LOGGER_ZSTD_TRAILER_SIZE, 4);
+    /* size of payload, size of frame, size of content */
+    MEMCMP_EQUAL("\x08\x00\x00\x00",
+                 frame + size - LOGGER_ZSTD_TRAILER_SIZE + 4, 4);
+    LONGS_EQUAL(size - LOGGER_ZSTD_TRAILER_SIZE,
+                (unsigned char)frame[size - LOGGER_ZSTD_TRAILER_SIZE + 8]);
+    MEMCMP_EQUAL("\x05\x00\x00\x00",
+                 frame + size - LOGGER_ZSTD_TRAILER_SIZE + 12, 4);
+    free (frame);
+}
+
+/*
+ * Tests functions:
+ *   logger_zstd_decompress_last_frames
+ *   logger_zstd_decompress_file
+ *   logger_zstd_tail_file
+ */
+
+TEST(LoggerZstd, TailFile)
+{
+    struct t_arraylist *lines;
+
+    POINTERS_EQUAL(NULL, logger_zstd_tail_file (NULL, 1));
+    POINTERS_EQUAL(NULL, logger_zstd_tail_file (filename, 1));
+    POINTERS_EQUAL(NULL, logger_zstd_tail_file (filename, 0));
+
+    append_frame ("line 1\nline 2\n", 1);
+    append_frame ("line 3\n", 1);
+    append_frame ("line 4\nline 5\n", 1);
+
+    lines = logger_zstd_tail_file (filename, 1);
+    CHECK(lines);
+    LONGS_EQUAL(1, arraylist_size (lines));
+    STRCMP_EQUAL("line 5", (const char *)arraylist_get (lines, 0));
+    arraylist_free (lines);
+
+    lines = logger_zstd_tail_file (filename, 3);
+    CHECK(lines);
+    LONGS_EQUAL(3, arraylist_size (lines));
+    STRCMP_EQUAL("line 3", (const char *)arraylist_get (lines, 0));
+    STRCMP_EQUAL("line 4", (const char *)arraylist_get (lines, 1));
+    STRCMP_EQUAL("line 5", (const char *)arraylist_get (lines, 2));
+    arraylist_free (lines);
+
+    /* logger_tail_file reads compressed files too */
+    lines = logger_tail_file (filename, 10);
+    CHECK(lines);
+    LONGS_EQUAL(5, arraylist_size (lines));
+    STRCMP_EQUAL("line 1", (const char *)arraylist_get (lines, 0));
+    STRCMP_EQUAL("line 5", (const char *)arraylist_get (lines, 4));
+    arraylist_free (lines);
+
+    /* frame without skippable frame: the whole file is decompressed */
+    append_frame ("line 6\n", 0);
+    lines = logger_zstd_tail_file (filename, 2);
+    CHECK(lines);
+    LONGS_EQUAL(2, arraylist_size (lines));
+    STRCMP_EQUAL("line 5", (const char *)arraylist_get (lines, 0));
+    STRCMP_EQUAL("line 6", (const char *)arraylist_get (lines, 1));
+    arraylist_free (lines);
+}
+
+#endif /* HAVE_ZSTD */
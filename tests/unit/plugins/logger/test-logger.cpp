@@ -25,8 +25,12 @@
 
 extern "C"
 {
+#include <string.h>
+#include "src/core/core-config-file.h"
 #include "src/gui/gui-buffer.h"
 #include "src/plugins/logger/logger.h"
+#include "src/plugins/logger/logger-buffer.h"
+#include "src/plugins/logger/logger-config.h"
 }
 
 TEST_GROUP(Logger)
@@ -193,6 +197,57 @@ TEST(Logger, GetLineTagInfo)
     /* TODO: write tests */
 }
 
+/*
+ * Tests functions:
+ *   logger_time_cache_reset
+ *   logger_format_time
+ */
+
+TEST(Logger, FormatTime)
+{
+    const char *ptr_time;
+    time_t date;
+
+    /* 2024-01-04 21:01:02 UTC */
+    date = 1704402062;
+
+    config_file_option_set_with_string ("logger.file.time_format", "%!");
+    STRCMP_EQUAL("1704402062", logger_format_time (date, 0));
+
+    /* same second: cached string is returned */
+    ptr_time = logger_format_time (date, 500000);
+    STRCMP_EQUAL("1704402062", ptr_time);
+    POINTERS_EQUAL(ptr_time, logger_format_time (date, 999999));
+
+    STRCMP_EQUAL("1704402063", logger_format_time (date + 1, 0));
+
+    /* format changed: cache is reset */
+    config_file_option_set_with_string ("logger.file.time_format", "%!.%.3");
+    STRCMP_EQUAL("1704402062.123", logger_format_time (date, 123456));
+
+    /* format with microseconds: never cached */
+    STRCMP_EQUAL("1704402062.654", logger_format_time (date, 654321));
+
+    config_file_option_reset (logger_config_file_time_format, 1);
+}
+
+/*
+ * Tests functions:
+ *   logger_buffer_search_buffer
+ */
+
+TEST(Logger, BufferSearchBuffer)
+{
+    struct t_logger_buffer *ptr_logger_buffer;
+
+    POINTERS_EQUAL(NULL, logger_buffer_search_buffer (NULL));
+
+    /* core buffer is logged by default */
+    ptr_logger_buffer = logger_buffer_search_buffer (gui_buffers);
+    CHECK(ptr_logger_buffer);
+    POINTERS_EQUAL(gui_buffers, ptr_logger_buffer->buffer);
+}
+
 /*
  * Tests functions:
  *   logger_print_cb
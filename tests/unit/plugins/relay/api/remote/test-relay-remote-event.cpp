@@ -85,6 +85,16 @@ TEST(RelayRemoteEvent, SearchLineById)
     /* TODO: write tests */
 }
 
+/*
+ * Tests functions:
+ *   relay_remote_event_get_last_line_id
+ */
+
+TEST(RelayRemoteEvent, GetLastLineId)
+{
+    /* TODO: write tests */
+}
+
 /*
  * Tests functions:
  *   relay_remote_event_line_update
@@ -147,10 +157,10 @@ TEST(RelayRemoteEvent, CbNick)
 
 /*
  * Tests functions:
- *   relay_remote_event_apply_props
+ *   relay_remote_event_cb_nicklist_diff
  */
 
-TEST(RelayRemoteEvent, ApplyProps)
+TEST(RelayRemoteEvent, CbNicklistDiff)
 {
     /* TODO: write tests */
 }
@@ -225,6 +235,26 @@ TEST(RelayRemoteEvent, CbInput)
     /* TODO: write tests */
 }
 
+/*
+ * Tests functions:
+ *   relay_remote_event_hotlist_clear
+ */
+
+TEST(RelayRemoteEvent, HotlistClear)
+{
+    /* TODO: write tests */
+}
+
+/*
+ * Tests functions:
+ *   relay_remote_event_cb_hotlist
+ */
+
+TEST(RelayRemoteEvent, CbHotlist)
+{
+    /* TODO: write tests */
+}
+
 /*
  * Tests functions:
  *   relay_remote_event_cb_version
@@ -245,6 +275,36 @@ TEST(RelayRemoteEvent, SyncWithRemote)
     /* TODO: write tests */
 }
 
+/*
+ * Tests functions:
+ *   relay_remote_event_sync_buffers_stop
+ */
+
+TEST(RelayRemoteEvent, SyncBuffersStop)
+{
+    /* TODO: write tests */
+}
+
+/*
+ * Tests functions:
+ *   relay_remote_event_sync_buffers_timer_cb
+ */
+
+TEST(RelayRemoteEvent, SyncBuffersTimerCb)
+{
+    /* TODO: write tests */
+}
+
+/*
+ * Tests functions:
+ *   relay_remote_event_sync_buffers
+ */
+
+TEST(RelayRemoteEvent, SyncBuffers)
+{
+    /* TODO: write tests */
+}
+
 /*
  * Tests functions:
  *   relay_remote_event_recv
@@ -0,0 +1,176 @@
+/*
+ * test-relay-api-cbor.cpp - test relay API protocol (CBOR encoding)
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include <stdlib.h>
+#include <string.h>
+#include <cjson/cJSON.h>
+#include "src/plugins/relay/api/relay-api-cbor.h"
+}
+
+/* check CBOR encoding of a JSON string (examples from RFC 8949, appendix A) */
+#define WEE_CHECK_CBOR(__expected, __json_string)                       \
+    json = cJSON_Parse (__json_string);                                 \
+    CHECK(json);                                                        \
+    cbor = relay_api_cbor_encode (json, &size);                         \
+    CHECK(cbor);                                                        \
+    LONGS_EQUAL(sizeof (__expected) - 1, size);                         \
+    MEMCMP_EQUAL(__expected, cbor, size);                               \
+    free (cbor);                                                        \
+    cJSON_Delete (json);
+
+TEST_GROUP(RelayApiCbor)
+{
+};
+
+/*
+ * Tests functions:
+ *   relay_api_cbor_add_bytes
+ *   relay_api_cbor_add_head
+ */
+
+TEST(RelayApiCbor, AddHead)
+{
+    struct t_relay_api_cbor cbor;
+
+    cbor.data = NULL;
+    cbor.size = 0;
+    cbor.size_alloc = 0;
+
+    LONGS_EQUAL(0, relay_api_cbor_add_bytes (NULL, "a", 1));
+    LONGS_EQUAL(0, relay_api_cbor_add_bytes (&cbor, NULL, 1));
+    LONGS_EQUAL(0, relay_api_cbor_add_bytes (&cbor, "a", -1));
+    LONGS_EQUAL(1, relay_api_cbor_add_bytes (&cbor, "a", 0));
+    LONGS_EQUAL(0, cbor.size);
+
+    LONGS_EQUAL(1, relay_api_cbor_add_head (&cbor, RELAY_API_CBOR_MAJOR_UINT, 23));
+    LONGS_EQUAL(1, cbor.size);
+    MEMCMP_EQUAL("\x17", cbor.data, 1);
+
+    cbor.size = 0;
+    LONGS_EQUAL(1, relay_api_cbor_add_head (&cbor, RELAY_API_CBOR_MAJOR_UINT, 24));
+    LONGS_EQUAL(2, cbor.size);
+    MEMCMP_EQUAL("\x18\x18", cbor.data, 2);
+
+    cbor.size = 0;
+    LONGS_EQUAL(1, relay_api_cbor_add_head (&cbor, RELAY_API_CBOR_MAJOR_TEXT, 256));
+    LONGS_EQUAL(3, cbor.size);
+    MEMCMP_EQUAL("\x79\x01\x00", cbor.data, 3);
+
+    cbor.size = 0;
+    LONGS_EQUAL(1, relay_api_cbor_add_head (&cbor, RELAY_API_CBOR_MAJOR_ARRAY, 65536));
+    LONGS_EQUAL(5, cbor.size);
+    MEMCMP_EQUAL("\x9a\x00\x01\x00\x00", cbor.data, 5);
+
+    cbor.size = 0;
+    LONGS_EQUAL(1, relay_api_cbor_add_head (&cbor, RELAY_API_CBOR_MAJOR_UINT,
+                                            4294967296ULL));
+    LONGS_EQUAL(9, cbor.size);
+    MEMCMP_EQUAL("\x1b\x00\x00\x00\x01\x00\x00\x00\x00", cbor.data, 9);
+
+    free (cbor.data);
+}
+
+/*
+ * Tests functions:
+ *   relay_api_cbor_add_number
+ *   relay_api_cbor_add_string
+ *   relay_api_cbor_add_json
+ *   relay_api_cbor_encode
+ */
+
+TEST(RelayApiCbor, Encode)
+{
+    cJSON *json;
+    char *cbor;
+    int size;
+
+    POINTERS_EQUAL(NULL, relay_api_cbor_encode (NULL, NULL));
+
+    /* NULL JSON is encoded as null */
+    cbor = relay_api_cbor_encode (NULL, &size);
+    CHECK(cbor);
+    LONGS_EQUAL(1, size);
+    MEMCMP_EQUAL("\xf6", cbor, 1);
+    free (cbor);
+
+    /* integers */
+    WEE_CHECK_CBOR("\x00", "0");
+    WEE_CHECK_CBOR("\x01", "1");
+    WEE_CHECK_CBOR("\x0a", "10");
+    WEE_CHECK_CBOR("\x17", "23");
+    WEE_CHECK_CBOR("\x18\x18", "24");
+    WEE_CHECK_CBOR("\x18\x64", "100");
+    WEE_CHECK_CBOR("\x19\x03\xe8", "1000");
+    WEE_CHECK_CBOR("\x1a\x00\x0f\x42\x40", "1000000");
+    WEE_CHECK_CBOR("\x1b\x00\x00\x00\xe8\xd4\xa5\x10\x00", "1000000000000");
+    WEE_CHECK_CBOR("\x20", "-1");
+    WEE_CHECK_CBOR("\x29", "-10");
+    WEE_CHECK_CBOR("\x38\x63", "-100");
+    WEE_CHECK_CBOR("\x39\x03\xe7", "-1000");
+
+    /* floats */
+    WEE_CHECK_CBOR("\xfb\x3f\xf1\x99\x99\x99\x99\x99\x9a", "1.1");
+    WEE_CHECK_CBOR("\xfb\xc0\x10\x66\x66\x66\x66\x66\x66", "-4.1");
+
+    /* simple values */
+    WEE_CHECK_CBOR("\xf4", "false");
+    WEE_CHECK_CBOR("\xf5", "true");
+    WEE_CHECK_CBOR("\xf6", "null");
+
+    /* strings */
+    WEE_CHECK_CBOR("\x60", "\"\"");
+    WEE_CHECK_CBOR("\x61\x61", "\"a\"");
+    WEE_CHECK_CBOR("\x64\x49\x45\x54\x46", "\"IETF\"");
+    WEE_CHECK_CBOR("\x62\x22\x5c", "\"\\\"\\\\\"");
+    WEE_CHECK_CBOR("\x62\xc3\xbc", "\"\\u00fc\"");
+
+    /* arrays */
+    WEE_CHECK_CBOR("\x80", "[]");
+    WEE_CHECK_CBOR("\x83\x01\x02\x03", "[1,2,3]");
+    WEE_CHECK_CBOR("\x83\x01\x82\x02\x03\x82\x04\x05", "[1,[2,3],[4,5]]");
+
+    /* objects */
+    WEE_CHECK_CBOR("\xa0", "{}");
+    WEE_CHECK_CBOR("\xa2\x61\x61\x01\x61\x62\x82\x02\x03", "{\"a\":1,\"b\":[2,3]}");
+    WEE_CHECK_CBOR("\x82\x61\x61\xa1\x61\x62\x61\x63", "[\"a\",{\"b\":\"c\"}]");
+
+    /* raw JSON item */
+    json = cJSON_CreateObject ();
+    CHECK(json);
+    cJSON_AddItemToObject (json, "lines", cJSON_CreateRaw ("[{\"id\":1}]"));
+    cbor = relay_api_cbor_encode (json, &size);
+    CHECK(cbor);
+    LONGS_EQUAL(13, size);
+    MEMCMP_EQUAL("\xa1\x65lines\x81\xa1\x62id\x01", cbor, size);
+    free (cbor);
+    cJSON_Delete (json);
+
+    /* invalid raw JSON item */
+    json = cJSON_CreateRaw ("{invalid");
+    CHECK(json);
+    POINTERS_EQUAL(NULL, relay_api_cbor_encode (json, &size));
+    LONGS_EQUAL(0, size);
+    cJSON_Delete (json);
+}
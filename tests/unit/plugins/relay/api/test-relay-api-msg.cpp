@@ -23,10 +23,12 @@
 
 extern "C"
 {
+#include <limits.h>
 #include <time.h>
 #include <sys/time.h>
 #include <cjson/cJSON.h>
 #include "src/core/core-hdata.h"
+#include "src/core/core-string.h"
 #include "src/core/core-util.h"
 #include "src/gui/gui-buffer.h"
 #include "src/gui/gui-chat.h"
@@ -69,6 +71,78 @@ TEST_GROUP(RelayApiMsg)
 {
 };
 
+/*
+ * Prints a JSON object and parses it again, so that raw items (JSON written
+ * directly as string) become standard JSON objects.
+ *
+ * Note: input JSON object is freed.
+ */
+
+cJSON *
+test_relay_api_msg_reparse (cJSON *json)
+{
+    cJSON *json_parsed;
+    char *string;
+
+    if (!json)
+        return NULL;
+
+    string = cJSON_PrintUnformatted (json);
+    cJSON_Delete (json);
+    if (!string)
+        return NULL;
+
+    json_parsed = cJSON_Parse (string);
+    free (string);
+
+    return json_parsed;
+}
+
+/*
+ * Tests functions:
+ *   relay_api_msg_json_write_string
+ *   relay_api_msg_json_raw
+ */
+
+TEST(RelayApiMsg, JsonWriteString)
+{
+    char **json;
+    cJSON *json_raw;
+
+    json = string_dyn_alloc (64);
+    CHECK(json);
+
+    relay_api_msg_json_write_string (NULL, "test");
+
+    relay_api_msg_json_write_string (json, NULL);
+    STRCMP_EQUAL("\"\"", *json);
+
+    string_dyn_copy (json, NULL);
+    relay_api_msg_json_write_string (json, "");
+    STRCMP_EQUAL("\"\"", *json);
+
+    string_dyn_copy (json, NULL);
+    relay_api_msg_json_write_string (json, "test");
+    STRCMP_EQUAL("\"test\"", *json);
+
+    string_dyn_copy (json, NULL);
+    relay_api_msg_json_write_string (json, "a \"quote\" and \\ é");
+    STRCMP_EQUAL("\"a \\\"quote\\\" and \\\\ é\"", *json);
+
+    string_dyn_copy (json, NULL);
+    relay_api_msg_json_write_string (json, "\b\f\n\r\t\x01\x19_end");
+    STRCMP_EQUAL("\"\\b\\f\\n\\r\\t\\u0001\\u0019_end\"", *json);
+
+    POINTERS_EQUAL(NULL, relay_api_msg_json_raw (NULL));
+
+    string_dyn_copy (json, "[1,2]");
+    json_raw = relay_api_msg_json_raw (json);
+    CHECK(json_raw);
+    CHECK(cJSON_IsRaw (json_raw));
+    STRCMP_EQUAL("[1,2]", json_raw->valuestring);
+    cJSON_Delete (json_raw);
+}
+
 /*
  * Tests functions:
  *   relay_api_msg_send_json_internal
@@ -113,7 +187,9 @@ TEST(RelayApiMsg, SendEvent)
  * Tests functions:
  *   relay_api_msg_buffer_add_local_vars_cb
  *   relay_api_msg_buffer_to_json
+ *   relay_api_msg_nick_write_json
  *   relay_api_msg_nick_to_json
+ *   relay_api_msg_nick_group_write_json
  *   relay_api_msg_nick_group_to_json
  */
 
@@ -128,7 +204,8 @@ TEST(RelayApiMsg, BufferToJson)
     long long group_id;
     char *color;
 
-    json = relay_api_msg_buffer_to_json (NULL, 0L, 0L, 0, RELAY_API_COLORS_ANSI);
+    json = test_relay_api_msg_reparse (
+        relay_api_msg_buffer_to_json (NULL, 0L, 0L, -1, NULL, 0, RELAY_API_COLORS_ANSI));
     CHECK(json);
     CHECK(cJSON_IsObject (json));
     POINTERS_EQUAL(NULL, cJSON_GetObjectItem (json, "name"));
@@ -138,7 +215,8 @@ TEST(RelayApiMsg, BufferToJson)
     gui_buffer_set (gui_buffers, "key_bind_meta-y,2", "/test2 arg");
 
     /* buffer without lines and nicks */
-    json = relay_api_msg_buffer_to_json (gui_buffers, 0L, 0L, 0, RELAY_API_COLORS_ANSI);
+    json = test_relay_api_msg_reparse (
+        relay_api_msg_buffer_to_json (gui_buffers, 0L, 0L, -1, NULL, 0, RELAY_API_COLORS_ANSI));
     CHECK(json);
     CHECK(cJSON_IsObject (json));
     WEE_CHECK_OBJ_NUM(gui_buffers->id, json, "id");
@@ -171,7 +249,8 @@ TEST(RelayApiMsg, BufferToJson)
     cJSON_Delete (json);
 
     /* buffer with 2 lines, without nicks */
-    json = relay_api_msg_buffer_to_json (gui_buffers, 2L, 0L, 0, RELAY_API_COLORS_ANSI);
+    json = test_relay_api_msg_reparse (
+        relay_api_msg_buffer_to_json (gui_buffers, 2L, 0L, -1, NULL, 0, RELAY_API_COLORS_ANSI));
     CHECK(json);
     CHECK(cJSON_IsObject (json));
     json_lines = cJSON_GetObjectItem (json, "lines");
@@ -194,7 +273,8 @@ TEST(RelayApiMsg, BufferToJson)
     CHECK(gui_nicklist_add_nick (buffer, NULL, "root_nick_hidden", "cyan", "+", "yellow", 0));
 
     /* buffer with no lines and 1 group / 4 nicks */
-    json = relay_api_msg_buffer_to_json (buffer, 1L, 0L, 1, RELAY_API_COLORS_ANSI);
+    json = test_relay_api_msg_reparse (
+        relay_api_msg_buffer_to_json (buffer, 1L, 0L, -1, NULL, 1, RELAY_API_COLORS_ANSI));
     CHECK(json);
     CHECK(cJSON_IsObject (json));
     WEE_CHECK_OBJ_BOOL(1, json, "nicklist");
@@ -326,7 +406,8 @@ TEST(RelayApiMsg, BufferToJson)
     gui_chat_printf_y (buffer, 3, "test line 4");
     gui_chat_printf_y (buffer, 4, "test line 5");
 
-    json = relay_api_msg_buffer_to_json (buffer, 1L, 2L, 0, RELAY_API_COLORS_ANSI);
+    json = test_relay_api_msg_reparse (
+        relay_api_msg_buffer_to_json (buffer, 1L, 2L, -1, NULL, 0, RELAY_API_COLORS_ANSI));
     CHECK(json);
     CHECK(cJSON_IsObject (json));
     json_lines = cJSON_GetObjectItem (json, "lines");
@@ -341,7 +422,8 @@ TEST(RelayApiMsg, BufferToJson)
     WEE_CHECK_OBJ_STR("test line 2", json_line, "message");
     cJSON_Delete (json);
 
-    json = relay_api_msg_buffer_to_json (buffer, 1L, -2L, 0, RELAY_API_COLORS_ANSI);
+    json = test_relay_api_msg_reparse (
+        relay_api_msg_buffer_to_json (buffer, 1L, -2L, -1, NULL, 0, RELAY_API_COLORS_ANSI));
     CHECK(json);
     CHECK(cJSON_IsObject (json));
     json_lines = cJSON_GetObjectItem (json, "lines");
@@ -361,7 +443,47 @@ TEST(RelayApiMsg, BufferToJson)
 
 /*
  * Tests functions:
+ *   relay_api_msg_buffer_memory_to_json
+ */
+
+TEST(RelayApiMsg, BufferMemoryToJson)
+{
+    cJSON *json;
+    struct t_gui_buffer *buffer;
+
+    json = test_relay_api_msg_reparse (relay_api_msg_buffer_memory_to_json (NULL));
+    CHECK(json);
+    CHECK(cJSON_IsObject (json));
+    POINTERS_EQUAL(NULL, cJSON_GetObjectItem (json, "lines"));
+    cJSON_Delete (json);
+
+    buffer = gui_buffer_new_user ("test", GUI_BUFFER_TYPE_FORMATTED);
+    CHECK(buffer);
+    gui_chat_printf (buffer, "test line 1");
+    gui_chat_printf (buffer, "test line 2");
+    gui_nicklist_add_nick (buffer, NULL, "nick1", NULL, NULL, NULL, 1);
+
+    json = test_relay_api_msg_reparse (relay_api_msg_buffer_memory_to_json (buffer));
+    CHECK(json);
+    CHECK(cJSON_IsObject (json));
+    WEE_CHECK_OBJ_NUM(2, json, "lines");
+    WEE_CHECK_OBJ_NUM(buffer->own_lines->lines_size, json, "lines_size");
+    WEE_CHECK_OBJ_NUM(0, json, "lines_compressed");
+    WEE_CHECK_OBJ_NUM(0, json, "lines_compressed_size");
+    WEE_CHECK_OBJ_NUM(0, json, "lines_on_disk");
+    WEE_CHECK_OBJ_NUM(0, json, "lines_on_disk_size");
+    WEE_CHECK_OBJ_NUM(buffer->nicklist_size, json, "nicklist_size");
+    WEE_CHECK_OBJ_NUM(buffer->local_variables_size, json, "local_variables_size");
+    cJSON_Delete (json);
+
+    gui_buffer_close (buffer);
+}
+
+/*
+ * Tests functions:
+ *   relay_api_msg_line_data_write_json
  *   relay_api_msg_line_data_to_json
+ *   relay_api_msg_lines_write_json
  *   relay_api_msg_lines_to_json
  */
 
@@ -382,7 +504,8 @@ TEST(RelayApiMsg, LinesToJson)
     gui_chat_printf (NULL, "%s", str_msg2);
 
     /* two lines with ANSI colors */
-    json = relay_api_msg_lines_to_json (gui_buffers, -2, RELAY_API_COLORS_ANSI);
+    json = test_relay_api_msg_reparse (
+        relay_api_msg_lines_to_json (gui_buffers, -2, -1, NULL, RELAY_API_COLORS_ANSI));
     CHECK(json);
     CHECK(cJSON_IsArray (json));
     LONGS_EQUAL(2, cJSON_GetArraySize (json));
@@ -452,7 +575,8 @@ TEST(RelayApiMsg, LinesToJson)
     cJSON_Delete (json);
 
     /* with ANSI colors */
-    json = relay_api_msg_lines_to_json (gui_buffers, -1, RELAY_API_COLORS_ANSI);
+    json = test_relay_api_msg_reparse (
+        relay_api_msg_lines_to_json (gui_buffers, -1, -1, NULL, RELAY_API_COLORS_ANSI));
     CHECK(json);
     CHECK(cJSON_IsArray (json));
     LONGS_EQUAL(1, cJSON_GetArraySize (json));
@@ -468,7 +592,8 @@ TEST(RelayApiMsg, LinesToJson)
     cJSON_Delete (json);
 
     /* one line with WeeChat colors */
-    json = relay_api_msg_lines_to_json (gui_buffers, -1, RELAY_API_COLORS_WEECHAT);
+    json = test_relay_api_msg_reparse (
+        relay_api_msg_lines_to_json (gui_buffers, -1, -1, NULL, RELAY_API_COLORS_WEECHAT));
     CHECK(json);
     CHECK(cJSON_IsArray (json));
     LONGS_EQUAL(1, cJSON_GetArraySize (json));
@@ -481,7 +606,8 @@ TEST(RelayApiMsg, LinesToJson)
     cJSON_Delete (json);
 
     /* one line without colors */
-    json = relay_api_msg_lines_to_json (gui_buffers, -1, RELAY_API_COLORS_STRIP);
+    json = test_relay_api_msg_reparse (
+        relay_api_msg_lines_to_json (gui_buffers, -1, -1, NULL, RELAY_API_COLORS_STRIP));
     CHECK(json);
     CHECK(cJSON_IsArray (json));
     LONGS_EQUAL(1, cJSON_GetArraySize (json));
@@ -492,6 +618,65 @@ TEST(RelayApiMsg, LinesToJson)
                       json_line, "id");
     WEE_CHECK_OBJ_STR("this is the second line with green", json_line, "message");
     cJSON_Delete (json);
+
+    /* lines after a line id */
+    json = test_relay_api_msg_reparse (
+        relay_api_msg_lines_to_json (
+            gui_buffers, LONG_MAX,
+            gui_buffers->own_lines->last_line->prev_line->data->id, NULL,
+            RELAY_API_COLORS_STRIP));
+    CHECK(json);
+    CHECK(cJSON_IsArray (json));
+    LONGS_EQUAL(1, cJSON_GetArraySize (json));
+    json_line = cJSON_GetArrayItem (json, 0);
+    WEE_CHECK_OBJ_NUM(gui_buffers->own_lines->last_line->data->id,
+                      json_line, "id");
+    cJSON_Delete (json);
+
+    /* lines after a line id, limited to the first line */
+    json = test_relay_api_msg_reparse (
+        relay_api_msg_lines_to_json (
+            gui_buffers, 1,
+            gui_buffers->own_lines->last_line->prev_line->prev_line->data->id, NULL,
+            RELAY_API_COLORS_STRIP));
+    CHECK(json);
+    LONGS_EQUAL(1, cJSON_GetArraySize (json));
+    json_line = cJSON_GetArrayItem (json, 0);
+    WEE_CHECK_OBJ_NUM(gui_buffers->own_lines->last_line->prev_line->data->id,
+                      json_line, "id");
+    cJSON_Delete (json);
+
+    /* lines printed after a date */
+    tv.tv_sec = gui_buffers->own_lines->last_line->prev_line->data->date_printed;
+    tv.tv_usec = gui_buffers->own_lines->last_line->prev_line->data->date_usec_printed;
+    LONGS_EQUAL(0, relay_api_msg_line_printed_after (
+                    gui_buffers->own_lines->last_line->prev_line, &tv));
+    LONGS_EQUAL(0, relay_api_msg_line_printed_after (NULL, &tv));
+    tv.tv_sec--;
+    LONGS_EQUAL(1, relay_api_msg_line_printed_after (
+                    gui_buffers->own_lines->last_line->prev_line, &tv));
+    json = test_relay_api_msg_reparse (
+        relay_api_msg_lines_to_json (gui_buffers, -1, -1, &tv,
+                                     RELAY_API_COLORS_STRIP));
+    CHECK(json);
+    LONGS_EQUAL(1, cJSON_GetArraySize (json));
+    cJSON_Delete (json);
+    tv.tv_sec = gui_buffers->own_lines->last_line->data->date_printed;
+    tv.tv_usec = gui_buffers->own_lines->last_line->data->date_usec_printed;
+    json = test_relay_api_msg_reparse (
+        relay_api_msg_lines_to_json (gui_buffers, -10, -1, &tv,
+                                     RELAY_API_COLORS_STRIP));
+    CHECK(json);
+    LONGS_EQUAL(0, cJSON_GetArraySize (json));
+    cJSON_Delete (json);
+
+    /* lines are written directly as JSON (raw item) */
+    json = relay_api_msg_lines_to_json (gui_buffers, -1, -1, NULL,
+                                        RELAY_API_COLORS_WEECHAT);
+    CHECK(json);
+    CHECK(cJSON_IsRaw (json));
+    STRNCMP_EQUAL("[{\"id\":", json->valuestring, 7);
+    cJSON_Delete (json);
 }
 
 /*
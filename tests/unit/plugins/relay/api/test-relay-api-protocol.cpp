@@ -29,6 +29,8 @@ extern "C"
 #include <string.h>
 #include <cjson/cJSON.h>
 #include "src/core/core-config-file.h"
+#include "src/core/core-hashtable.h"
+#include "src/core/core-hook.h"
 #include "src/core/core-string.h"
 #include "src/core/core-util.h"
 #include "src/core/core-version.h"
@@ -36,10 +38,12 @@ extern "C"
 #include "src/gui/gui-chat.h"
 #include "src/gui/gui-hotlist.h"
 #include "src/gui/gui-line.h"
+#include "src/gui/gui-nicklist.h"
 #include "src/plugins/weechat-plugin.h"
 #include "src/plugins/relay/relay.h"
 #include "src/plugins/relay/relay-client.h"
 #include "src/plugins/relay/relay-config.h"
+#include "src/plugins/relay/relay-http.h"
 #include "src/plugins/relay/relay-server.h"
 #include "src/plugins/relay/api/relay-api.h"
 #include "src/plugins/relay/api/relay-api-protocol.h"
@@ -529,6 +533,75 @@ TEST(RelayApiProtocolWithClient, CbBuffers)
     WEE_CHECK_OBJ_STR("", json, "prefix");
     WEE_CHECK_OBJ_STR("test line 2", json, "message");
 
+    /* get lines after a line id */
+    snprintf (str_http, sizeof (str_http),
+              "GET /api/buffers/core.weechat/lines?lines_since_id=%d",
+              gui_buffers->own_lines->last_line->prev_line->data->id);
+    test_client_recv_http (str_http, NULL, NULL);
+    WEE_CHECK_HTTP_CODE(200, "OK");
+    CHECK(json_body_sent);
+    CHECK(cJSON_IsArray (json_body_sent));
+    LONGS_EQUAL(1, cJSON_GetArraySize (json_body_sent));
+    json = cJSON_GetArrayItem (json_body_sent, 0);
+    WEE_CHECK_OBJ_NUM(gui_buffers->own_lines->last_line->data->id, json, "id");
+    WEE_CHECK_OBJ_STR("test line 2", json, "message");
+
+    /* get lines after the last line id: no lines */
+    snprintf (str_http, sizeof (str_http),
+              "GET /api/buffers/core.weechat/lines?lines_since_id=%d",
+              gui_buffers->own_lines->last_line->data->id);
+    test_client_recv_http (str_http, NULL, NULL);
+    WEE_CHECK_HTTP_CODE(200, "OK");
+    CHECK(json_body_sent);
+    CHECK(cJSON_IsArray (json_body_sent));
+    LONGS_EQUAL(0, cJSON_GetArraySize (json_body_sent));
+
+    /* get lines printed after a date */
+    test_client_recv_http ("GET /api/buffers/core.weechat/lines"
+                           "?lines=-2&lines_since=2000-01-01T00:00:00Z",
+                           NULL, NULL);
+    WEE_CHECK_HTTP_CODE(200, "OK");
+    CHECK(json_body_sent);
+    CHECK(cJSON_IsArray (json_body_sent));
+    LONGS_EQUAL(2, cJSON_GetArraySize (json_body_sent));
+    json = cJSON_GetArrayItem (json_body_sent, 1);
+    WEE_CHECK_OBJ_STR("test line 2", json, "message");
+    snprintf (str_http, sizeof (str_http),
+              "GET /api/buffers/core.weechat/lines?lines_since=%lld.%06d",
+              (long long)gui_buffers->own_lines->last_line->data->date_printed,
+              gui_buffers->own_lines->last_line->data->date_usec_printed);
+    test_client_recv_http (str_http, NULL, NULL);
+    WEE_CHECK_HTTP_CODE(200, "OK");
+    CHECK(json_body_sent);
+    CHECK(cJSON_IsArray (json_body_sent));
+    LONGS_EQUAL(0, cJSON_GetArraySize (json_body_sent));
+
+    /* error: invalid date */
+    test_client_recv_http ("GET /api/buffers/core.weechat/lines?lines_since=abc",
+                           NULL, NULL);
+    STRCMP_EQUAL("HTTP/1.1 400 Bad Request\r\n"
+                 "Access-Control-Allow-Origin: *\r\n"
+                 "Content-Type: application/json; charset=utf-8\r\n"
+                 "Content-Length: 55\r\n"
+                 "\r\n"
+                 "{\"error\": \"Invalid date for parameter \\\"lines_since\\\"\"}",
+                 data_sent);
+
+    /* get buffers changed since a date */
+    test_client_recv_http ("GET /api/buffers?changed_since=2000-01-01T00:00:00Z",
+                           NULL, NULL);
+    WEE_CHECK_HTTP_CODE(200, "OK");
+    CHECK(json_body_sent);
+    CHECK(cJSON_IsArray (json_body_sent));
+    json = cJSON_GetArrayItem (json_body_sent, 0);
+    WEE_CHECK_OBJ_STR("core.weechat", json, "name");
+    test_client_recv_http ("GET /api/buffers?changed_since=2100-01-01T00:00:00Z",
+                           NULL, NULL);
+    WEE_CHECK_HTTP_CODE(200, "OK");
+    CHECK(json_body_sent);
+    CHECK(cJSON_IsArray (json_body_sent));
+    LONGS_EQUAL(0, cJSON_GetArraySize (json_body_sent));
+
     /* get nicks */
     test_client_recv_http ("GET /api/buffers/core.weechat/nicks", NULL, NULL);
     WEE_CHECK_HTTP_CODE(200, "OK");
@@ -605,6 +678,29 @@ TEST(RelayApiProtocolWithClient, CbHotlist)
     gui_hotlist_remove_buffer (gui_buffers, 1);
 }
 
+/*
+ * Tests functions:
+ *   relay_api_protocol_cb_metrics
+ */
+
+TEST(RelayApiProtocolWithClient, CbMetrics)
+{
+    /* get metrics (text format) */
+    test_client_recv_http ("GET /api/metrics", NULL, NULL);
+    WEE_CHECK_HTTP_CODE(200, "OK");
+    CHECK(strstr (data_sent,
+                  "\r\nContent-Type: text/plain; version=0.0.4; "
+                  "charset=utf-8\r\n"));
+    CHECK(strstr (data_sent, "\r\n\r\n# HELP "));
+    CHECK(strstr (data_sent, "# TYPE weechat_relay_clients gauge\n"
+                  "weechat_relay_clients 1\n"));
+    POINTERS_EQUAL(NULL, json_body_sent);
+
+    /* too many arguments */
+    test_client_recv_http ("GET /api/metrics/irc", NULL, NULL);
+    WEE_CHECK_HTTP_CODE(404, "Not Found");
+}
+
 /*
  * Tests functions:
  *   relay_api_protocol_cb_input
@@ -783,6 +879,207 @@ TEST(RelayApiProtocolWithClient, CbSyncWebsocket)
     LONGS_EQUAL(RELAY_API_COLORS_STRIP, RELAY_API_DATA(ptr_relay_client, sync_colors));
 }
 
+/*
+ * Tests functions:
+ *   relay_api_protocol_hsignal_nicklist_cb (websocket)
+ *   relay_api_protocol_nicklist_diff_add
+ *   relay_api_protocol_send_nicklist_diff
+ *   relay_api_protocol_send_nicklist_diff_all
+ *   relay_api_protocol_timer_nicklist_cb
+ */
+
+TEST(RelayApiProtocolWithClient, NicklistDiff)
+{
+    struct t_gui_buffer *buffer;
+    struct t_gui_nick_group *group;
+    struct t_hook *ptr_hook;
+    cJSON *json, *json_obj, *json_body, *json_item, *json_nick;
+
+    test_client_recv_http_raw (
+        "GET /api HTTP/1.1\r\n"
+        "Authorization: Basic cGxhaW46c2VjcmV0\r\n"
+        "Sec-WebSocket-Version: 13\r\n"
+        "Sec-WebSocket-Key: dbKbsCX3CxFBmQo09ah1OQ==\r\n"
+        "Connection: Upgrade\r\n"
+        "Upgrade: websocket\r\n"
+        "Host: 127.0.0.1:9000\r\n"
+        "\r\n");
+
+    test_client_recv_text ("{\"request\": \"POST /api/sync\", "
+                           "\"body\": {\"nicklist_diff\": true}}");
+    WEE_CHECK_TEXT(204, "No Content", "POST /api/sync", "{\"nicklist_diff\":true}");
+    LONGS_EQUAL(1, RELAY_API_DATA(ptr_relay_client, sync_nicklist_diff));
+
+    buffer = gui_buffer_new_user ("test_nicklist_diff", GUI_BUFFER_TYPE_FORMATTED);
+    CHECK(buffer);
+    POINTERS_EQUAL(NULL, RELAY_API_DATA(ptr_relay_client, hook_timer_nicklist));
+
+    /* nicklist changes are not sent immediately */
+    free_data_sent ();
+    group = gui_nicklist_add_group (buffer, NULL, "group1", "magenta", 1);
+    CHECK(group);
+    CHECK(gui_nicklist_add_nick (buffer, group, "nick1", "blue", "@", "lightred", 1));
+    CHECK(gui_nicklist_add_nick (buffer, group, "nick2", "green", NULL, NULL, 1));
+    POINTERS_EQUAL(NULL, data_sent);
+    LONGS_EQUAL(1, hashtable_get_integer (RELAY_API_DATA(ptr_relay_client, nicklist_diff),
+                                          "items_count"));
+    ptr_hook = RELAY_API_DATA(ptr_relay_client, hook_timer_nicklist);
+    CHECK(ptr_hook);
+
+    /* all changes are sent by the timer in a single event */
+    relay_api_protocol_timer_nicklist_cb (ptr_relay_client, NULL, 0);
+    unhook (ptr_hook);
+    POINTERS_EQUAL(NULL, RELAY_API_DATA(ptr_relay_client, hook_timer_nicklist));
+    LONGS_EQUAL(0, hashtable_get_integer (RELAY_API_DATA(ptr_relay_client, nicklist_diff),
+                                          "items_count"));
+    CHECK(data_sent);
+    json = cJSON_Parse (data_sent);
+    CHECK(json);
+    WEE_CHECK_OBJ_STR("nicklist_diff", json, "event_name");
+    WEE_CHECK_OBJ_NUM(buffer->id, json, "buffer_id");
+    WEE_CHECK_OBJ_STR("nicklist_diff", json, "body_type");
+    json_body = cJSON_GetObjectItem (json, "body");
+    CHECK(cJSON_IsArray (json_body));
+    LONGS_EQUAL(3, cJSON_GetArraySize (json_body));
+    json_item = cJSON_GetArrayItem (json_body, 0);
+    WEE_CHECK_OBJ_STR("nicklist_group_added", json_item, "event_name");
+    WEE_CHECK_OBJ_STR("nick_group", json_item, "body_type");
+    json_nick = cJSON_GetObjectItem (json_item, "body");
+    WEE_CHECK_OBJ_STR("group1", json_nick, "name");
+    json_item = cJSON_GetArrayItem (json_body, 1);
+    WEE_CHECK_OBJ_STR("nicklist_nick_added", json_item, "event_name");
+    WEE_CHECK_OBJ_STR("nick", json_item, "body_type");
+    json_nick = cJSON_GetObjectItem (json_item, "body");
+    WEE_CHECK_OBJ_STR("nick1", json_nick, "name");
+    json_item = cJSON_GetArrayItem (json_body, 2);
+    WEE_CHECK_OBJ_STR("nicklist_nick_added", json_item, "event_name");
+    json_nick = cJSON_GetObjectItem (json_item, "body");
+    WEE_CHECK_OBJ_STR("nick2", json_nick, "name");
+    cJSON_Delete (json);
+
+    /* changes are sent before any other event on the buffer */
+    free_data_sent ();
+    gui_nicklist_remove_all (buffer);
+    POINTERS_EQUAL(NULL, data_sent);
+    LONGS_EQUAL(1, hashtable_get_integer (RELAY_API_DATA(ptr_relay_client, nicklist_diff),
+                                          "items_count"));
+    gui_buffer_set (buffer, "title", "new title");
+    LONGS_EQUAL(0, hashtable_get_integer (RELAY_API_DATA(ptr_relay_client, nicklist_diff),
+                                          "items_count"));
+    CHECK(data_sent);
+    json = cJSON_Parse (data_sent);
+    CHECK(json);
+    WEE_CHECK_OBJ_STR("buffer_title_changed", json, "event_name");
+    cJSON_Delete (json);
+
+    /* pending changes are sent immediately when the diff is disabled */
+    CHECK(gui_nicklist_add_nick (buffer, NULL, "nick3", NULL, NULL, NULL, 1));
+    LONGS_EQUAL(1, hashtable_get_integer (RELAY_API_DATA(ptr_relay_client, nicklist_diff),
+                                          "items_count"));
+    test_client_recv_text ("{\"request\": \"POST /api/sync\"}");
+    LONGS_EQUAL(0, RELAY_API_DATA(ptr_relay_client, sync_nicklist_diff));
+    LONGS_EQUAL(0, hashtable_get_integer (RELAY_API_DATA(ptr_relay_client, nicklist_diff),
+                                          "items_count"));
+    POINTERS_EQUAL(NULL, RELAY_API_DATA(ptr_relay_client, hook_timer_nicklist));
+
+    /* without diff, each change is sent in its own event */
+    free_data_sent ();
+    CHECK(gui_nicklist_add_nick (buffer, NULL, "nick4", NULL, NULL, NULL, 1));
+    CHECK(data_sent);
+    json = cJSON_Parse (data_sent);
+    CHECK(json);
+    WEE_CHECK_OBJ_STR("nicklist_nick_added", json, "event_name");
+    WEE_CHECK_OBJ_STR("nick", json, "body_type");
+    json_nick = cJSON_GetObjectItem (json, "body");
+    WEE_CHECK_OBJ_STR("nick4", json_nick, "name");
+    cJSON_Delete (json);
+    POINTERS_EQUAL(NULL, RELAY_API_DATA(ptr_relay_client, hook_timer_nicklist));
+
+    /* pending changes are sent when the buffer is closing */
+    test_client_recv_text ("{\"request\": \"POST /api/sync\", "
+                           "\"body\": {\"nicklist_diff\": true}}");
+    CHECK(gui_nicklist_add_nick (buffer, NULL, "nick5", NULL, NULL, NULL, 1));
+    LONGS_EQUAL(1, hashtable_get_integer (RELAY_API_DATA(ptr_relay_client, nicklist_diff),
+                                          "items_count"));
+    gui_buffer_close (buffer);
+    LONGS_EQUAL(0, hashtable_get_integer (RELAY_API_DATA(ptr_relay_client, nicklist_diff),
+                                          "items_count"));
+    CHECK(data_sent);
+    json = cJSON_Parse (data_sent);
+    CHECK(json);
+    WEE_CHECK_OBJ_STR("buffer_closed", json, "event_name");
+    cJSON_Delete (json);
+}
+
+/*
+ * Tests functions:
+ *   relay_api_protocol_json_to_request
+ *   relay_api_protocol_cb_batch
+ */
+
+TEST(RelayApiProtocolWithClient, CbBatch)
+{
+    cJSON *json, *json_obj;
+
+    /* error: missing body */
+    test_client_recv_http ("POST /api/batch", NULL, NULL);
+    WEE_CHECK_HTTP_CODE(400, "Bad Request");
+
+    /* error: body is not an array */
+    test_client_recv_http ("POST /api/batch", NULL, "{\"request\": \"GET /api/version\"}");
+    WEE_CHECK_HTTP_CODE(400, "Bad Request");
+
+    /* empty batch */
+    test_client_recv_http ("POST /api/batch", NULL, "[]");
+    WEE_CHECK_HTTP_CODE(200, "OK");
+    CHECK(json_body_sent);
+    CHECK(cJSON_IsArray (json_body_sent));
+    LONGS_EQUAL(0, cJSON_GetArraySize (json_body_sent));
+
+    /* batch with 4 requests: 2 valid, 1 invalid, 1 nested batch */
+    test_client_recv_http (
+        "POST /api/batch", NULL,
+        "["
+        "{\"request\": \"GET /api/version\", \"request_id\": \"v\"},"
+        "{\"request\": \"POST /api/ping\", \"body\": {\"data\": \"abc\"}},"
+        "{\"request\": 123},"
+        "{\"request\": \"POST /api/batch\", \"body\": []}"
+        "]");
+    WEE_CHECK_HTTP_CODE(200, "OK");
+    CHECK(json_body_sent);
+    CHECK(cJSON_IsArray (json_body_sent));
+    LONGS_EQUAL(4, cJSON_GetArraySize (json_body_sent));
+
+    json = cJSON_GetArrayItem (json_body_sent, 0);
+    WEE_CHECK_OBJ_NUM(200, json, "code");
+    WEE_CHECK_OBJ_STR("OK", json, "message");
+    WEE_CHECK_OBJ_STR("GET /api/version", json, "request");
+    WEE_CHECK_OBJ_STR("v", json, "request_id");
+    json_obj = cJSON_GetObjectItem (json, "body");
+    CHECK(json_obj);
+    WEE_CHECK_OBJ_STR(version_get_version (), json_obj, "weechat_version");
+
+    json = cJSON_GetArrayItem (json_body_sent, 1);
+    WEE_CHECK_OBJ_NUM(200, json, "code");
+    WEE_CHECK_OBJ_STR("POST /api/ping", json, "request");
+    WEE_CHECK_OBJ_STR("ping", json, "body_type");
+    json_obj = cJSON_GetObjectItem (json, "body");
+    CHECK(json_obj);
+    WEE_CHECK_OBJ_STR("abc", json_obj, "data");
+
+    json = cJSON_GetArrayItem (json_body_sent, 2);
+    WEE_CHECK_OBJ_NUM(400, json, "code");
+    WEE_CHECK_OBJ_STR("Bad Request", json, "message");
+
+    json = cJSON_GetArrayItem (json_body_sent, 3);
+    WEE_CHECK_OBJ_NUM(400, json, "code");
+    json_obj = cJSON_GetObjectItem (json, "body");
+    CHECK(json_obj);
+    WEE_CHECK_OBJ_STR("Nested batch requests are not allowed", json_obj, "error");
+
+    POINTERS_EQUAL(NULL, RELAY_API_DATA(ptr_relay_client, batch_responses));
+}
+
 /*
  * Tests functions:
  *   relay_api_protocol_recv_json
@@ -888,6 +1185,47 @@ TEST(RelayApiProtocolWithClient, RecvHttp404)
                  data_sent);
 }
 
+/*
+ * Tests functions:
+ *   relay_api_protocol_recv_http (pipelining)
+ */
+
+TEST(RelayApiProtocolWithClient, RecvHttpPipelining)
+{
+    cJSON *json, *json_obj;
+
+    /* two requests received at once, the second one is incomplete */
+    test_client_recv_http_raw (
+        "GET /api/version HTTP/1.1\r\n"
+        "Authorization: Basic cGxhaW46c2VjcmV0\r\n"
+        "\r\n"
+        "POST /api/ping HTTP/1.1\r\n"
+        "Authorization: Basic cGxhaW46c2VjcmV0\r\n"
+        "Content-Length: 15\r\n"
+        "\r\n"
+        "{\"data\": ");
+    WEE_CHECK_HTTP_CODE(200, "OK");
+    json = json_body_sent;
+    WEE_CHECK_OBJ_STR(version_get_version (), json, "weechat_version");
+    STRCMP_EQUAL("{\"data\": ", ptr_relay_client->http_req->body);
+
+    /* credentials of the successful auth are saved in the client */
+    STRCMP_EQUAL("Basic cGxhaW46c2VjcmV0\n", ptr_relay_client->http_auth);
+
+    /* end of second request */
+    test_client_recv_http_raw ("\"abc\"}");
+    WEE_CHECK_HTTP_CODE(200, "OK");
+    json = json_body_sent;
+    WEE_CHECK_OBJ_STR("abc", json, "data");
+    POINTERS_EQUAL(NULL, ptr_relay_client->partial_message);
+
+    /* credentials are checked again if the password is changed */
+    config_file_option_set (relay_config_network_password, "secret2", 1);
+    POINTERS_EQUAL(NULL, ptr_relay_client->http_auth);
+    test_client_recv_http ("GET /api/version", NULL, NULL);
+    WEE_CHECK_HTTP_CODE(401, "Unauthorized");
+}
+
 /*
  * Tests functions:
  *   relay_api_protocol_recv_http (missing password)
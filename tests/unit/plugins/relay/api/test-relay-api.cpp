@@ -23,8 +23,10 @@
 
 extern "C"
 {
+#include "src/core/core-hashtable.h"
 #include "src/plugins/relay/relay.h"
 #include "src/plugins/relay/relay-client.h"
+#include "src/plugins/relay/relay-http.h"
 #include "src/plugins/relay/api/relay-api.h"
 }
 
@@ -49,6 +51,83 @@ TEST(RelayApi, SearchColors)
     LONGS_EQUAL(RELAY_API_COLORS_STRIP, relay_api_search_colors ("strip"));
 }
 
+/*
+ * Tests functions:
+ *   relay_api_header_list_has_value
+ */
+
+TEST(RelayApi, HeaderListHasValue)
+{
+    LONGS_EQUAL(0, relay_api_header_list_has_value (NULL, NULL));
+    LONGS_EQUAL(0, relay_api_header_list_has_value (NULL, "cbor"));
+    LONGS_EQUAL(0, relay_api_header_list_has_value ("cbor", NULL));
+    LONGS_EQUAL(0, relay_api_header_list_has_value ("", "cbor"));
+    LONGS_EQUAL(0, relay_api_header_list_has_value ("json", "cbor"));
+    LONGS_EQUAL(0, relay_api_header_list_has_value ("cbor2", "cbor"));
+
+    LONGS_EQUAL(1, relay_api_header_list_has_value ("cbor", "cbor"));
+    LONGS_EQUAL(1, relay_api_header_list_has_value ("CBOR", "cbor"));
+    LONGS_EQUAL(1, relay_api_header_list_has_value ("json, cbor", "cbor"));
+    LONGS_EQUAL(1, relay_api_header_list_has_value ("json,cbor ", "cbor"));
+    LONGS_EQUAL(
+        1,
+        relay_api_header_list_has_value (
+            "application/json;q=0.5, application/cbor;q=1",
+            "application/cbor"));
+}
+
+/*
+ * Tests functions:
+ *   relay_api_get_encoding_http
+ *   relay_api_get_encoding_websocket
+ */
+
+TEST(RelayApi, GetEncoding)
+{
+    struct t_relay_http_request *request;
+
+    LONGS_EQUAL(RELAY_API_ENCODING_JSON, relay_api_get_encoding_http (NULL));
+    LONGS_EQUAL(RELAY_API_ENCODING_JSON, relay_api_get_encoding_websocket (NULL));
+
+    request = relay_http_request_alloc ();
+    CHECK(request);
+
+    LONGS_EQUAL(RELAY_API_ENCODING_JSON, relay_api_get_encoding_http (request));
+    LONGS_EQUAL(RELAY_API_ENCODING_JSON, relay_api_get_encoding_websocket (request));
+
+    hashtable_set (request->headers, "accept", "application/json");
+    hashtable_set (request->headers, "sec-websocket-protocol", "json");
+    LONGS_EQUAL(RELAY_API_ENCODING_JSON, relay_api_get_encoding_http (request));
+    LONGS_EQUAL(RELAY_API_ENCODING_JSON, relay_api_get_encoding_websocket (request));
+
+    hashtable_set (request->headers, "accept", "application/cbor, */*");
+    hashtable_set (request->headers, "sec-websocket-protocol", "cbor");
+    LONGS_EQUAL(RELAY_API_ENCODING_CBOR, relay_api_get_encoding_http (request));
+    LONGS_EQUAL(RELAY_API_ENCODING_CBOR, relay_api_get_encoding_websocket (request));
+
+    relay_http_request_free (request);
+}
+
+/*
+ * Tests functions:
+ *   relay_api_hook_timer_nicklist
+ */
+
+TEST(RelayApi, HookTimerNicklist)
+{
+    /* TODO: write tests */
+}
+
+/*
+ * Tests functions:
+ *   relay_api_unhook_timer_nicklist
+ */
+
+TEST(RelayApi, UnhookTimerNicklist)
+{
+    /* TODO: write tests */
+}
+
 /*
  * Tests functions:
  *   relay_api_hook_signals
@@ -28,11 +28,15 @@ extern "C"
 #include <ctype.h>
 #include <time.h>
 #include "src/core/core-config-file.h"
+#include "src/core/core-hashtable.h"
 #include "src/plugins/relay/relay.h"
 #include "src/plugins/relay/relay-auth.h"
 #include "src/plugins/relay/relay-client.h"
 #include "src/plugins/relay/relay-config.h"
 
+extern int relay_auth_cache_build_key (const char *credentials,
+                                       const char *relay_password,
+                                       char *key);
 extern int relay_auth_check_salt (struct t_relay_client *client,
                                   const char *salt_hexa,
                                   const char *salt, int salt_size);
@@ -484,3 +488,70 @@ TEST(RelayAuth, PasswordHash)
 {
     /* TODO: write tests */
 }
+
+/*
+ * Tests functions:
+ *   relay_auth_cache_build_key
+ *   relay_auth_cache_search
+ *   relay_auth_cache_add
+ *   relay_auth_cache_free
+ */
+
+TEST(RelayAuth, Cache)
+{
+    char key[128], key2[128], credentials[64];
+    time_t *ptr_time;
+    int i;
+
+    relay_auth_cache_free ();
+
+    LONGS_EQUAL(0, relay_auth_cache_build_key (NULL, "secret", key));
+    LONGS_EQUAL(0, relay_auth_cache_build_key ("cGxhaW46c2VjcmV0", NULL, key));
+    LONGS_EQUAL(0, relay_auth_cache_build_key ("cGxhaW46c2VjcmV0", "secret", NULL));
+    LONGS_EQUAL(1, relay_auth_cache_build_key ("cGxhaW46c2VjcmV0", "secret", key));
+    LONGS_EQUAL(64, strlen (key));
+    LONGS_EQUAL(1, relay_auth_cache_build_key ("cGxhaW46c2VjcmV0", "secret2", key2));
+    CHECK(strcmp (key, key2) != 0);
+
+    /* empty cache */
+    LONGS_EQUAL(0, relay_auth_cache_search (NULL, NULL));
+    LONGS_EQUAL(0, relay_auth_cache_search ("cGxhaW46c2VjcmV0", "secret"));
+
+    /* add credentials in cache */
+    relay_auth_cache_add ("cGxhaW46c2VjcmV0", "secret");
+    CHECK(relay_auth_cache);
+    LONGS_EQUAL(1, relay_auth_cache->items_count);
+    LONGS_EQUAL(1, relay_auth_cache_search ("cGxhaW46c2VjcmV0", "secret"));
+    LONGS_EQUAL(0, relay_auth_cache_search ("cGxhaW46c2VjcmV0", "secret2"));
+    LONGS_EQUAL(0, relay_auth_cache_search ("cGxhaW46dGVzdA==", "secret"));
+
+    /* cache disabled */
+    config_file_option_set (relay_config_network_auth_cache_ttl, "0", 1);
+    POINTERS_EQUAL(NULL, relay_auth_cache);
+    relay_auth_cache_add ("cGxhaW46c2VjcmV0", "secret");
+    POINTERS_EQUAL(NULL, relay_auth_cache);
+    LONGS_EQUAL(0, relay_auth_cache_search ("cGxhaW46c2VjcmV0", "secret"));
+    config_file_option_reset (relay_config_network_auth_cache_ttl, 1);
+
+    /* expired entry */
+    relay_auth_cache_add ("cGxhaW46c2VjcmV0", "secret");
+    ptr_time = (time_t *)hashtable_get (relay_auth_cache, key);
+    CHECK(ptr_time);
+    *ptr_time -= 3600;
+    LONGS_EQUAL(0, relay_auth_cache_search ("cGxhaW46c2VjcmV0", "secret"));
+    LONGS_EQUAL(0, relay_auth_cache->items_count);
+
+    /* cache is cleared when full */
+    for (i = 0; i < RELAY_AUTH_CACHE_MAX_SIZE; i++)
+    {
+        snprintf (credentials, sizeof (credentials), "test%d", i);
+        relay_auth_cache_add (credentials, "secret");
+    }
+    LONGS_EQUAL(RELAY_AUTH_CACHE_MAX_SIZE, relay_auth_cache->items_count);
+    relay_auth_cache_add ("cGxhaW46c2VjcmV0", "secret");
+    LONGS_EQUAL(1, relay_auth_cache->items_count);
+    LONGS_EQUAL(1, relay_auth_cache_search ("cGxhaW46c2VjcmV0", "secret"));
+
+    relay_auth_cache_free ();
+    POINTERS_EQUAL(NULL, relay_auth_cache);
+}
@@ -0,0 +1,532 @@
+/*
+ * test-relay-client.cpp - test client functions
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include "src/core/core-config-file.h"
+#include "src/core/core-hashtable.h"
+#include "src/core/core-hook.h"
+#include "src/core/core-infolist.h"
+#include "src/gui/gui-buffer.h"
+#include "src/plugins/weechat-plugin.h"
+#include "src/plugins/relay/relay.h"
+#include "src/plugins/relay/relay-client.h"
+#include "src/plugins/relay/relay-config.h"
+#include "src/plugins/relay/relay-server.h"
+
+extern void relay_client_recv_text (struct t_relay_client *client,
+                                    const char *data);
+extern void relay_client_outqueue_consume (struct t_relay_client *client,
+                                           int num_sent);
+}
+
+#define TEST_BIG_MESSAGE_SIZE (1024 * 1024)
+
+TEST_GROUP(RelayClientWithSocket)
+{
+    struct t_relay_server *ptr_server;
+    struct t_relay_client *ptr_client;
+    int sock[2];
+
+    void setup ()
+    {
+        /* disable auto-open of relay buffer */
+        config_file_option_set (relay_config_look_auto_open_buffer, "off", 1);
+
+        ptr_server = relay_server_new (
+            "weechat",
+            RELAY_PROTOCOL_WEECHAT,
+            "test",
+            9000,
+            NULL,  /* path */
+            1,  /* ipv4 */
+            0,  /* ipv6 */
+            0,  /* tls */
+            0);  /* unix_socket */
+
+        sock[0] = -1;
+        sock[1] = -1;
+        LONGS_EQUAL(0, socketpair (AF_UNIX, SOCK_STREAM, 0, sock));
+        fcntl (sock[0], F_SETFL, fcntl (sock[0], F_GETFL) | O_NONBLOCK);
+        fcntl (sock[1], F_SETFL, fcntl (sock[1], F_GETFL) | O_NONBLOCK);
+
+        ptr_client = relay_client_new (sock[0], "test", ptr_server);
+    }
+
+    void teardown ()
+    {
+        /* socket is closed by relay if the client has been disconnected */
+        if (ptr_client->sock < 0)
+            sock[0] = -1;
+        relay_client_free (ptr_client);
+        ptr_client = NULL;
+        relay_server_free (ptr_server);
+        ptr_server = NULL;
+        if (sock[0] >= 0)
+            close (sock[0]);
+        close (sock[1]);
+
+        /* restore options */
+        config_file_option_reset (relay_config_look_auto_open_buffer, 1);
+        config_file_option_reset (relay_config_network_outqueue_max_size, 1);
+        config_file_option_reset (relay_config_network_outqueue_overflow, 1);
+    }
+
+    /*
+     * Reads all data available on the peer socket (up to size bytes),
+     * returns number of bytes read.
+     */
+
+    int read_peer (char *buffer, int size)
+    {
+        int total, num_read;
+
+        total = 0;
+        while (total < size)
+        {
+            num_read = read (sock[1], buffer + total, size - total);
+            if (num_read <= 0)
+                break;
+            total += num_read;
+        }
+        return total;
+    }
+};
+
+/*
+ * Tests functions:
+ *   relay_client_compression_allowed
+ */
+
+TEST(RelayClientWithSocket, CompressionAllowed)
+{
+    LONGS_EQUAL(0, relay_client_compression_allowed (NULL));
+
+    LONGS_EQUAL(0, ptr_client->unix_socket);
+    LONGS_EQUAL(1, relay_client_compression_allowed (ptr_client));
+
+    ptr_client->unix_socket = 1;
+    LONGS_EQUAL(1, relay_client_compression_allowed (ptr_client));
+
+    config_file_option_set (relay_config_network_compression_unix_socket,
+                            "off", 1);
+    LONGS_EQUAL(0, relay_client_compression_allowed (ptr_client));
+    ptr_client->unix_socket = 0;
+    LONGS_EQUAL(1, relay_client_compression_allowed (ptr_client));
+
+    config_file_option_reset (relay_config_network_compression_unix_socket, 1);
+}
+
+/*
+ * Tests functions:
+ *   relay_client_outqueue_add
+ *   relay_client_outqueue_add_buffer
+ *   relay_client_outqueue_consume
+ *   relay_client_send_outqueue
+ *   relay_client_send_data_vector
+ */
+
+TEST(RelayClientWithSocket, SendOutqueue)
+{
+    char buffer[64];
+
+    relay_client_outqueue_add (NULL, "abc", 3, NULL, NULL, NULL, NULL);
+    relay_client_outqueue_add (ptr_client, NULL, 3, NULL, NULL, NULL, NULL);
+    relay_client_outqueue_add (ptr_client, "abc", 0, NULL, NULL, NULL, NULL);
+    POINTERS_EQUAL(NULL, ptr_client->outqueue);
+
+    relay_client_outqueue_add (ptr_client, "abc", 3, NULL, NULL, NULL, NULL);
+    relay_client_outqueue_add (ptr_client, "defg", 4, NULL, NULL, NULL, NULL);
+    relay_client_outqueue_add (ptr_client, "hi", 2, NULL, NULL, NULL, NULL);
+    CHECK(ptr_client->outqueue);
+    CHECK(ptr_client->outqueue->next_outqueue);
+    POINTERS_EQUAL(ptr_client->last_outqueue,
+                   ptr_client->outqueue->next_outqueue->next_outqueue);
+    LONGS_EQUAL(0, ptr_client->outqueue->data_offset);
+    LONGS_EQUAL(9, ptr_client->outqueue_size);
+    LONGS_EQUAL(9, ptr_client->outqueue_size_max);
+    LONGS_EQUAL(9, relay_client_outqueue_size_total);
+    LONGS_EQUAL(HOOK_FD_FLAG_READ | HOOK_FD_FLAG_WRITE,
+                HOOK_FD(ptr_client->hook_fd, flags));
+
+    /* all messages sent at once */
+    relay_client_send_outqueue (ptr_client);
+    POINTERS_EQUAL(NULL, ptr_client->outqueue);
+    POINTERS_EQUAL(NULL, ptr_client->last_outqueue);
+    LONGS_EQUAL(HOOK_FD_FLAG_READ, HOOK_FD(ptr_client->hook_fd, flags));
+    LONGS_EQUAL(0, ptr_client->outqueue_size);
+    LONGS_EQUAL(9, ptr_client->outqueue_size_max);
+    LONGS_EQUAL(0, relay_client_outqueue_size_total);
+    LONGS_EQUAL(9, ptr_client->bytes_sent);
+    LONGS_EQUAL(9, read_peer (buffer, sizeof (buffer)));
+    MEMCMP_EQUAL("abcdefghi", buffer, 9);
+}
+
+/*
+ * Tests functions:
+ *   relay_client_send_batch_start
+ *   relay_client_send_batch_end
+ */
+
+TEST(RelayClientWithSocket, SendBatch)
+{
+    char buffer[1024];
+    int i;
+
+    relay_client_send_batch_start (NULL);
+    relay_client_send_batch_end (NULL);
+
+    /* end without start: ignored */
+    relay_client_send_batch_end (ptr_client);
+    LONGS_EQUAL(0, ptr_client->send_batch);
+
+    /* messages are queued until the end of the last batch */
+    relay_client_send_batch_start (ptr_client);
+    relay_client_send_batch_start (ptr_client);
+    LONGS_EQUAL(2, ptr_client->send_batch);
+    (void) relay_client_send (ptr_client, RELAY_MSG_STANDARD, "abc", 3, NULL);
+    (void) relay_client_send (ptr_client, RELAY_MSG_STANDARD, "defg", 4, NULL);
+    CHECK(ptr_client->outqueue);
+    LONGS_EQUAL(7, ptr_client->outqueue_size);
+    LONGS_EQUAL(2, ptr_client->send_batch_count);
+    LONGS_EQUAL(0, read_peer (buffer, sizeof (buffer)));
+    relay_client_send_batch_end (ptr_client);
+    CHECK(ptr_client->outqueue);
+    LONGS_EQUAL(0, read_peer (buffer, sizeof (buffer)));
+    relay_client_send_batch_end (ptr_client);
+    LONGS_EQUAL(0, ptr_client->send_batch);
+    LONGS_EQUAL(0, ptr_client->send_batch_count);
+    POINTERS_EQUAL(NULL, ptr_client->outqueue);
+    LONGS_EQUAL(HOOK_FD_FLAG_READ, HOOK_FD(ptr_client->hook_fd, flags));
+    LONGS_EQUAL(7, ptr_client->bytes_sent);
+    LONGS_EQUAL(7, read_peer (buffer, sizeof (buffer)));
+    MEMCMP_EQUAL("abcdefg", buffer, 7);
+
+    /* messages are sent when there are enough messages for writev */
+    relay_client_send_batch_start (ptr_client);
+    for (i = 0; i < RELAY_CLIENT_OUTQUEUE_MAX_IOV; i++)
+    {
+        (void) relay_client_send (ptr_client, RELAY_MSG_STANDARD, "x", 1, NULL);
+    }
+    POINTERS_EQUAL(NULL, ptr_client->outqueue);
+    LONGS_EQUAL(0, ptr_client->send_batch_count);
+    (void) relay_client_send (ptr_client, RELAY_MSG_STANDARD, "y", 1, NULL);
+    CHECK(ptr_client->outqueue);
+    relay_client_send_batch_end (ptr_client);
+    POINTERS_EQUAL(NULL, ptr_client->outqueue);
+    LONGS_EQUAL(RELAY_CLIENT_OUTQUEUE_MAX_IOV + 1,
+                read_peer (buffer, sizeof (buffer)));
+    LONGS_EQUAL('y', buffer[RELAY_CLIENT_OUTQUEUE_MAX_IOV]);
+}
+
+/*
+ * Tests functions:
+ *   relay_client_outqueue_sent
+ */
+
+TEST(RelayClientWithSocket, OutqueueSent)
+{
+    relay_client_outqueue_add (ptr_client, "abc", 3, NULL, NULL, NULL, NULL);
+    relay_client_outqueue_add (ptr_client, "defg", 4, NULL, NULL, NULL, NULL);
+    LONGS_EQUAL(7, ptr_client->outqueue_size);
+
+    /* nothing sent */
+    relay_client_outqueue_sent (ptr_client, 0, 0);
+    LONGS_EQUAL(7, ptr_client->outqueue_size);
+    LONGS_EQUAL(0, ptr_client->bytes_sent);
+
+    /* first message and part of second message sent */
+    relay_client_outqueue_sent (ptr_client, 4, 0);
+    LONGS_EQUAL(3, ptr_client->outqueue_size);
+    LONGS_EQUAL(3, relay_client_outqueue_size_total);
+    LONGS_EQUAL(4, ptr_client->bytes_sent);
+    CHECK(ptr_client->outqueue);
+    POINTERS_EQUAL(NULL, ptr_client->outqueue->next_outqueue);
+    LONGS_EQUAL(1, ptr_client->outqueue->data_offset);
+
+    /* end of second message sent */
+    relay_client_outqueue_sent (ptr_client, 3, 0);
+    POINTERS_EQUAL(NULL, ptr_client->outqueue);
+    LONGS_EQUAL(0, ptr_client->outqueue_size);
+    LONGS_EQUAL(7, ptr_client->bytes_sent);
+    CHECK(ptr_client->status != RELAY_STATUS_DISCONNECTED);
+
+    /* error: client is disconnected */
+    relay_client_outqueue_add (ptr_client, "hi", 2, NULL, NULL, NULL, NULL);
+    relay_client_outqueue_sent (ptr_client, 0, GNUTLS_E_PUSH_ERROR);
+    LONGS_EQUAL(RELAY_STATUS_DISCONNECTED, ptr_client->status);
+    POINTERS_EQUAL(NULL, ptr_client->outqueue);
+    LONGS_EQUAL(0, relay_client_outqueue_size_total);
+}
+
+/*
+ * Tests functions:
+ *   relay_client_send
+ *   relay_client_outqueue_add_data
+ *   relay_client_outqueue_consume
+ *   relay_client_send_outqueue
+ *   relay_client_recv_cb
+ */
+
+TEST(RelayClientWithSocket, SendPartial)
+{
+    char *message, *received;
+    int i, total, num_read, num_messages;
+    struct t_relay_client_outqueue *ptr_outqueue;
+
+    message = (char *)malloc (TEST_BIG_MESSAGE_SIZE);
+    received = (char *)malloc (TEST_BIG_MESSAGE_SIZE * 3);
+    for (i = 0; i < TEST_BIG_MESSAGE_SIZE; i++)
+    {
+        message[i] = 'a' + (i % 26);
+    }
+
+    /* socket buffer is full: remaining data is queued */
+    LONGS_EQUAL(1, relay_client_send (ptr_client, RELAY_MSG_STANDARD,
+                                      message, TEST_BIG_MESSAGE_SIZE,
+                                      "big message 1") > 0);
+    CHECK(ptr_client->outqueue);
+    (void) relay_client_send (ptr_client, RELAY_MSG_STANDARD,
+                              message, TEST_BIG_MESSAGE_SIZE,
+                              "big message 2");
+    (void) relay_client_send (ptr_client, RELAY_MSG_STANDARD,
+                              "xyz", 3, "small message");
+    num_messages = 0;
+    for (ptr_outqueue = ptr_client->outqueue; ptr_outqueue;
+         ptr_outqueue = ptr_outqueue->next_outqueue)
+    {
+        num_messages++;
+    }
+    LONGS_EQUAL(3, num_messages);
+
+    /* read data on peer socket and flush outqueue until it's empty */
+    total = 0;
+    for (i = 0; (i < 10000) && (total < (TEST_BIG_MESSAGE_SIZE * 2) + 3); i++)
+    {
+        num_read = read_peer (received + total,
+                              (TEST_BIG_MESSAGE_SIZE * 3) - total);
+        total += num_read;
+        relay_client_recv_cb (ptr_client, NULL, sock[0]);
+    }
+    POINTERS_EQUAL(NULL, ptr_client->outqueue);
+    LONGS_EQUAL(HOOK_FD_FLAG_READ, HOOK_FD(ptr_client->hook_fd, flags));
+    LONGS_EQUAL((TEST_BIG_MESSAGE_SIZE * 2) + 3, total);
+    LONGS_EQUAL((TEST_BIG_MESSAGE_SIZE * 2) + 3, ptr_client->bytes_sent);
+    MEMCMP_EQUAL(message, received, TEST_BIG_MESSAGE_SIZE);
+    MEMCMP_EQUAL(message, received + TEST_BIG_MESSAGE_SIZE,
+                 TEST_BIG_MESSAGE_SIZE);
+    MEMCMP_EQUAL("xyz", received + (TEST_BIG_MESSAGE_SIZE * 2), 3);
+
+    free (message);
+    free (received);
+}
+
+/*
+ * Tests functions:
+ *   relay_client_outqueue_is_full
+ *   relay_client_outqueue_add_buffer
+ */
+
+TEST(RelayClientWithSocket, OutqueueOverflowDisconnect)
+{
+    char data[1500];
+
+    memset (data, 'a', sizeof (data));
+
+    config_file_option_set (relay_config_network_outqueue_max_size, "2", 1);
+
+    /* first message is queued, second one exceeds the max size */
+    relay_client_outqueue_add (ptr_client, data, sizeof (data),
+                               NULL, NULL, NULL, NULL);
+    LONGS_EQUAL(RELAY_STATUS_AUTHENTICATING, ptr_client->status);
+    LONGS_EQUAL(1500, ptr_client->outqueue_size);
+    LONGS_EQUAL(0, relay_client_outqueue_drop_line (ptr_client, gui_buffers));
+    relay_client_outqueue_add (ptr_client, data, sizeof (data),
+                               NULL, NULL, NULL, NULL);
+    LONGS_EQUAL(RELAY_STATUS_DISCONNECTED, ptr_client->status);
+    POINTERS_EQUAL(NULL, ptr_client->outqueue);
+    LONGS_EQUAL(0, ptr_client->outqueue_size);
+    LONGS_EQUAL(1500, ptr_client->outqueue_size_max);
+    LONGS_EQUAL(0, relay_client_outqueue_size_total);
+}
+
+/*
+ * Tests functions:
+ *   relay_client_outqueue_can_drop_lines
+ *   relay_client_outqueue_drop_line
+ *   relay_client_send_lines_dropped
+ *   relay_weechat_protocol_send_buffer_resync
+ */
+
+TEST(RelayClientWithSocket, OutqueueOverflowDropLines)
+{
+    char data[1500], received[16384];
+    int *ptr_count, i, total, num_read;
+
+    memset (data, 'a', sizeof (data));
+
+    config_file_option_set (relay_config_network_outqueue_max_size, "1", 1);
+    config_file_option_set (relay_config_network_outqueue_overflow,
+                            "drop_lines", 1);
+
+    LONGS_EQUAL(0, relay_client_outqueue_drop_line (NULL, gui_buffers));
+    LONGS_EQUAL(0, relay_client_outqueue_drop_line (ptr_client, NULL));
+
+    /* outqueue empty: line is not dropped */
+    LONGS_EQUAL(0, relay_client_outqueue_drop_line (ptr_client, gui_buffers));
+
+    /* outqueue full: lines are dropped */
+    relay_client_outqueue_add (ptr_client, data, sizeof (data),
+                               NULL, NULL, NULL, NULL);
+    LONGS_EQUAL(1, relay_client_outqueue_drop_line (ptr_client, gui_buffers));
+    LONGS_EQUAL(1, relay_client_outqueue_drop_line (ptr_client, gui_buffers));
+    LONGS_EQUAL(2, ptr_client->lines_dropped);
+    CHECK(ptr_client->buffers_lines_dropped);
+    ptr_count = (int *)hashtable_get (ptr_client->buffers_lines_dropped,
+                                      "core.weechat");
+    CHECK(ptr_count);
+    LONGS_EQUAL(2, *ptr_count);
+
+    /* max size * 2 not reached: client is not disconnected */
+    relay_client_outqueue_add (ptr_client, data, 500, NULL, NULL, NULL, NULL);
+    LONGS_EQUAL(RELAY_STATUS_AUTHENTICATING, ptr_client->status);
+
+    /* outqueue flushed: lines are sent in message "_buffer_resync" */
+    relay_client_send_outqueue (ptr_client);
+    POINTERS_EQUAL(NULL, ptr_client->outqueue);
+    POINTERS_EQUAL(NULL, ptr_client->buffers_lines_dropped);
+    total = 0;
+    for (i = 0; (i < 100) && (total < (int)sizeof (received)); i++)
+    {
+        num_read = read_peer (received + total, sizeof (received) - total);
+        if (num_read <= 0)
+            break;
+        total += num_read;
+    }
+    CHECK(total > 2000);
+    CHECK(memmem (received + 2000, total - 2000, "_buffer_resync", 14));
+
+    /* max size * 2 reached: client is disconnected */
+    relay_client_outqueue_add (ptr_client, data, sizeof (data),
+                               NULL, NULL, NULL, NULL);
+    relay_client_outqueue_add (ptr_client, data, sizeof (data),
+                               NULL, NULL, NULL, NULL);
+    LONGS_EQUAL(RELAY_STATUS_DISCONNECTED, ptr_client->status);
+}
+
+/*
+ * Tests functions:
+ *   relay_client_outqueue_add_to_infolist
+ *   relay_client_outqueue_read_infolist
+ */
+
+TEST(RelayClientWithSocket, OutqueueUpgrade)
+{
+    struct t_infolist *infolist;
+    struct t_relay_client *new_client;
+    char buffer[64];
+    int *ptr_count, count;
+
+    relay_client_outqueue_add (ptr_client, "abc", 3, NULL, NULL, NULL, NULL);
+    relay_client_outqueue_add (ptr_client, "defg", 4, NULL, NULL, NULL, NULL);
+    relay_client_outqueue_consume (ptr_client, 1);
+    ptr_client->lines_dropped = 3;
+    ptr_client->buffers_lines_dropped = hashtable_new (
+        32, WEECHAT_HASHTABLE_STRING, WEECHAT_HASHTABLE_INTEGER, NULL, NULL);
+    count = 3;
+    hashtable_set (ptr_client->buffers_lines_dropped, "core.weechat", &count);
+
+    /* outqueue is not saved if no upgrade is in progress */
+    infolist = infolist_new (NULL);
+    CHECK(infolist);
+    LONGS_EQUAL(1, relay_client_add_to_infolist (infolist, ptr_client, 0));
+    CHECK(infolist_next (infolist));
+    POINTERS_EQUAL(NULL, infolist_search_var (infolist, "outqueue_data_00000"));
+    infolist_free (infolist);
+
+    /* outqueue and lines dropped are saved and restored on upgrade */
+    relay_signal_upgrade_received = 1;
+    infolist = infolist_new (NULL);
+    CHECK(infolist);
+    LONGS_EQUAL(1, relay_client_add_to_infolist (infolist, ptr_client, 0));
+    relay_signal_upgrade_received = 0;
+    CHECK(infolist_next (infolist));
+    new_client = relay_client_new_with_infolist (infolist);
+    infolist_free (infolist);
+    CHECK(new_client);
+    CHECK(new_client->outqueue);
+    CHECK(new_client->outqueue->next_outqueue);
+    POINTERS_EQUAL(NULL, new_client->outqueue->next_outqueue->next_outqueue);
+    LONGS_EQUAL(6, new_client->outqueue_size);
+    LONGS_EQUAL(3, new_client->lines_dropped);
+    CHECK(new_client->buffers_lines_dropped);
+    ptr_count = (int *)hashtable_get (new_client->buffers_lines_dropped,
+                                      "core.weechat");
+    CHECK(ptr_count);
+    LONGS_EQUAL(3, *ptr_count);
+
+    /* pending data are sent by the new client */
+    hashtable_free (new_client->buffers_lines_dropped);
+    new_client->buffers_lines_dropped = NULL;
+    relay_client_send_outqueue (new_client);
+    POINTERS_EQUAL(NULL, new_client->outqueue);
+    LONGS_EQUAL(6, read_peer (buffer, sizeof (buffer)));
+    MEMCMP_EQUAL("bcdefg", buffer, 6);
+
+    relay_client_free (new_client);
+}
+
+/*
+ * Tests functions:
+ *   relay_client_recv_text
+ *   relay_client_recv_text_single_line
+ */
+
+TEST(RelayClientWithSocket, RecvTextSingleLine)
+{
+    POINTERS_EQUAL(NULL, ptr_client->partial_message);
+
+    /* no complete line: data is kept */
+    relay_client_recv_text (ptr_client, "test");
+    STRCMP_EQUAL("test", ptr_client->partial_message);
+    relay_client_recv_text (ptr_client, "_abc");
+    STRCMP_EQUAL("test_abc", ptr_client->partial_message);
+
+    /* complete lines (with empty lines and "\r"): nothing is kept */
+    relay_client_recv_text (ptr_client, "\r\n\n\r\n");
+    POINTERS_EQUAL(NULL, ptr_client->partial_message);
+
+    /* complete lines, then a partial line */
+    relay_client_recv_text (ptr_client, "line1\nline2\r\n");
+    POINTERS_EQUAL(NULL, ptr_client->partial_message);
+    relay_client_recv_text (ptr_client, "line3");
+    relay_client_recv_text (ptr_client, "\nline4\nline5");
+    STRCMP_EQUAL("line5", ptr_client->partial_message);
+    relay_client_recv_text (ptr_client, "\n");
+    POINTERS_EQUAL(NULL, ptr_client->partial_message);
+}
@@ -36,6 +36,7 @@ extern "C"
 #include "src/core/core-hook.h"
 #include "src/core/core-string.h"
 #include "src/plugins/relay/relay.h"
+#include "src/plugins/relay/relay-auth.h"
 #include "src/plugins/relay/relay-client.h"
 #include "src/plugins/relay/relay-config.h"
 #include "src/plugins/relay/relay-http.h"
@@ -49,9 +50,12 @@ extern void relay_http_parse_path (const char *url,
 extern int relay_http_parse_header (struct t_relay_http_request *request,
                                     const char *header,
                                     int ws_deflate_allowed);
+extern int relay_http_add_data_to_body (struct t_relay_http_request *request,
+                                        const char *data, int length);
 extern void relay_http_add_to_body (struct t_relay_http_request *request,
                                     char **partial_message);
 extern int relay_http_get_auth_status (struct t_relay_client *client);
+extern char *relay_http_get_auth_credentials (struct t_relay_http_request *request);
 extern char *relay_http_compress (struct t_relay_http_request *request,
                                   const char *data, int data_size,
                                   int *compressed_size,
@@ -225,6 +229,35 @@ TEST(RelayHttp, GetParamLong)
     relay_http_request_free (request);
 }
 
+/*
+ * Tests functions:
+ *   relay_http_get_param_time
+ */
+
+TEST(RelayHttp, GetParamTime)
+{
+    struct t_relay_http_request *request;
+    struct timeval tv;
+
+    request = relay_http_request_alloc ();
+    CHECK(request);
+    relay_http_parse_method_path (
+        request,
+        "GET /api/test?key1=2024-01-04T21:01:02.123456Z&key2=1704402062.5"
+        "&key3=abc");
+    tv.tv_sec = 0;
+    tv.tv_usec = 0;
+    LONGS_EQUAL(1, relay_http_get_param_time (request, "key1", &tv));
+    LONGS_EQUAL(1704402062, tv.tv_sec);
+    LONGS_EQUAL(123456, tv.tv_usec);
+    LONGS_EQUAL(1, relay_http_get_param_time (request, "key2", &tv));
+    LONGS_EQUAL(1704402062, tv.tv_sec);
+    LONGS_EQUAL(500000, tv.tv_usec);
+    LONGS_EQUAL(-1, relay_http_get_param_time (request, "key3", &tv));
+    LONGS_EQUAL(0, relay_http_get_param_time (request, "xxx", &tv));
+    relay_http_request_free (request);
+}
+
 /*
  * Tests functions:
  *   relay_http_parse_path
@@ -575,6 +608,50 @@ TEST(RelayHttp, ParseHeader)
     relay_http_request_free (request);
 }
 
+/*
+ * Tests functions:
+ *   relay_http_add_data_to_body
+ */
+
+TEST(RelayHttp, AddDataToBody)
+{
+    struct t_relay_http_request *request;
+    const char *data = "abcdefghij";
+
+    LONGS_EQUAL(0, relay_http_add_data_to_body (NULL, data, 3));
+
+    request = relay_http_request_alloc ();
+    CHECK(request);
+    relay_http_parse_method_path (request, "POST /api/input");
+    relay_http_parse_header (request, "Content-Length: 5", 1);
+    relay_http_parse_header (request, "", 1);
+    LONGS_EQUAL(RELAY_HTTP_BODY, request->status);
+
+    LONGS_EQUAL(0, relay_http_add_data_to_body (request, NULL, 3));
+    LONGS_EQUAL(0, relay_http_add_data_to_body (request, data, -1));
+    LONGS_EQUAL(0, relay_http_add_data_to_body (request, data, 0));
+    LONGS_EQUAL(RELAY_HTTP_BODY, request->status);
+    LONGS_EQUAL(0, request->body_size);
+
+    LONGS_EQUAL(3, relay_http_add_data_to_body (request, data, 3));
+    LONGS_EQUAL(RELAY_HTTP_BODY, request->status);
+    LONGS_EQUAL(3, request->body_size);
+    STRCMP_EQUAL("abc", request->body);
+
+    /* only 2 bytes are missing, remaining data is the next request */
+    LONGS_EQUAL(2, relay_http_add_data_to_body (request, data + 3, 7));
+    LONGS_EQUAL(RELAY_HTTP_END, request->status);
+    LONGS_EQUAL(5, request->body_size);
+    STRCMP_EQUAL("abcde", request->body);
+
+    /* body already complete */
+    LONGS_EQUAL(0, relay_http_add_data_to_body (request, data + 5, 5));
+    LONGS_EQUAL(RELAY_HTTP_END, request->status);
+    LONGS_EQUAL(5, request->body_size);
+
+    relay_http_request_free (request);
+}
+
 /*
  * Tests functions:
  *   relay_http_add_to_body
@@ -850,6 +927,32 @@ TEST(RelayHttp, GetAuthStatus)
     hashtable_set (client->http_req->headers, "authorization", auth_header);
     LONGS_EQUAL(0, relay_http_get_auth_status (client));
 
+    /* test password verified recently, with a too old time (salt) */
+    time_now = time (NULL) - 10;
+    snprintf (salt_pass, sizeof (salt_pass),
+              "%ld%s", time_now, good_pwd);
+    LONGS_EQUAL(1, weecrypto_hash (salt_pass, strlen (salt_pass),
+                                   GCRY_MD_SHA256, hash, &hash_size));
+    LONGS_EQUAL(64, string_base_encode ("16", hash, hash_size, hash_hexa));
+    snprintf (auth, sizeof (auth),
+              "hash:sha256:%ld:%s",
+              time_now,
+              hash_hexa);
+    string_base_encode ("64", auth, strlen (auth), auth_base64);
+    snprintf (auth_header, sizeof (auth_header), "Basic %s", auth_base64);
+    hashtable_set (client->http_req->headers, "authorization", auth_header);
+    config_file_option_set (relay_config_network_time_window, "60", 1);
+    LONGS_EQUAL(0, relay_http_get_auth_status (client));
+    LONGS_EQUAL(1, relay_auth_cache_search (auth_base64, good_pwd));
+    config_file_option_reset (relay_config_network_time_window, 1);
+    LONGS_EQUAL(0, relay_http_get_auth_status (client));
+    config_file_option_set (relay_config_network_auth_cache_ttl, "0", 1);
+    LONGS_EQUAL(-6, relay_http_get_auth_status (client));
+    config_file_option_reset (relay_config_network_auth_cache_ttl, 1);
+    hashtable_set (client->http_req->headers,
+                   "authorization",
+                   "Basic cGxhaW46c2VjcmV0X3Bhc3N3b3Jk");
+
     /* test missing/invalid TOTP */
     config_file_option_set (relay_config_network_totp_secret, "secretbase32", 1);
     config_file_option_set (relay_config_network_totp_window, "1", 1);
@@ -880,7 +983,51 @@ TEST(RelayHttp, GetAuthStatus)
 
 TEST(RelayHttp, CheckAuth)
 {
-    /* TODO: write tests */
+    struct t_relay_client *client;
+    char *credentials;
+
+    POINTERS_EQUAL(NULL, relay_http_get_auth_credentials (NULL));
+    LONGS_EQUAL(0, relay_http_check_auth (NULL));
+
+    config_file_option_set (relay_config_network_password, "secret_password", 1);
+
+    client = (struct t_relay_client *)calloc (1, sizeof (*client));
+    CHECK(client);
+
+    client->protocol = RELAY_PROTOCOL_API;
+
+    client->http_req = relay_http_request_alloc ();
+
+    credentials = relay_http_get_auth_credentials (client->http_req);
+    STRCMP_EQUAL("\n", credentials);
+    free (credentials);
+
+    /* valid plain-text password ("secret_password") */
+    hashtable_set (client->http_req->headers,
+                   "authorization",
+                   "Basic cGxhaW46c2VjcmV0X3Bhc3N3b3Jk");
+    hashtable_set (client->http_req->headers, "x-weechat-totp", "123456");
+    credentials = relay_http_get_auth_credentials (client->http_req);
+    STRCMP_EQUAL("Basic cGxhaW46c2VjcmV0X3Bhc3N3b3Jk\n123456", credentials);
+    free (credentials);
+    hashtable_remove (client->http_req->headers, "x-weechat-totp");
+    POINTERS_EQUAL(NULL, client->http_auth);
+    LONGS_EQUAL(1, relay_http_check_auth (client));
+    STRCMP_EQUAL("Basic cGxhaW46c2VjcmV0X3Bhc3N3b3Jk\n", client->http_auth);
+
+    /* same credentials on same connection: password is not checked again */
+    config_file_option_set (relay_config_network_password, "other_password", 1);
+    LONGS_EQUAL(-2, relay_http_get_auth_status (client));
+    LONGS_EQUAL(1, relay_http_check_auth (client));
+    STRCMP_EQUAL("Basic cGxhaW46c2VjcmV0X3Bhc3N3b3Jk\n", client->http_auth);
+
+    free (client->http_auth);
+    client->http_auth = NULL;
+
+    config_file_option_reset (relay_config_network_password, 1);
+
+    relay_http_request_free (client->http_req);
+    free (client);
 }
 
 /*
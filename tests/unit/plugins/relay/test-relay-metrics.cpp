@@ -0,0 +1,159 @@
+/*
+ * test-relay-metrics.cpp - test metrics functions
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+#include "tests/tests.h"
+
+extern "C"
+{
+#include <string.h>
+#include "src/core/core-string.h"
+#include "src/plugins/relay/relay.h"
+#include "src/plugins/relay/relay-metrics.h"
+}
+
+#define WEE_CHECK_ESCAPE_LABEL(__result, __value)                       \
+    str = relay_metrics_escape_label (__value);                         \
+    STRCMP_EQUAL(__result, str);                                        \
+    free (str);
+
+TEST_GROUP(RelayMetrics)
+{
+};
+
+/*
+ * Tests functions:
+ *   relay_metrics_escape_label
+ */
+
+TEST(RelayMetrics, EscapeLabel)
+{
+    char *str;
+
+    WEE_CHECK_ESCAPE_LABEL("", NULL);
+    WEE_CHECK_ESCAPE_LABEL("", "");
+    WEE_CHECK_ESCAPE_LABEL("irc.libera.#weechat", "irc.libera.#weechat");
+    WEE_CHECK_ESCAPE_LABEL("a\\\\b\\\"c\\\"\\nd", "a\\b\"c\"\nd");
+}
+
+/*
+ * Tests functions:
+ *   relay_metrics_add_header
+ *   relay_metrics_add_value
+ */
+
+TEST(RelayMetrics, AddHeaderValue)
+{
+    char **metrics;
+
+    metrics = string_dyn_alloc (64);
+    CHECK(metrics);
+
+    relay_metrics_add_header (NULL, "test", "gauge", "Test");
+    relay_metrics_add_header (metrics, NULL, "gauge", "Test");
+    relay_metrics_add_value (NULL, "test", NULL, 1, 1);
+    relay_metrics_add_value (metrics, NULL, NULL, 1, 1);
+    STRCMP_EQUAL("", *metrics);
+
+    relay_metrics_add_header (metrics, "test", "gauge", "Test metric");
+    relay_metrics_add_value (metrics, "test", NULL, 42, 1);
+    relay_metrics_add_value (metrics, "test", "", -1, 0);
+    relay_metrics_add_value (metrics, "test", "server=\"libera\"", 1500, 1000);
+    STRCMP_EQUAL("# HELP test Test metric\n"
+                 "# TYPE test gauge\n"
+                 "test 42\n"
+                 "test -1\n"
+                 "test{server=\"libera\"} 1.500000\n",
+                 *metrics);
+
+    string_dyn_free (metrics, 1);
+}
+
+/*
+ * Tests functions:
+ *   relay_metrics_add_histogram
+ */
+
+TEST(RelayMetrics, AddHistogram)
+{
+    char **metrics;
+    long long histogram[4] = { 1, 0, 2, 3 };
+
+    metrics = string_dyn_alloc (64);
+    CHECK(metrics);
+
+    relay_metrics_add_histogram (metrics, "test", NULL, NULL, 4, 6, 100);
+    STRCMP_EQUAL("", *metrics);
+
+    relay_metrics_add_histogram (metrics, "test", NULL, histogram, 4,
+                                 6, 2500000);
+    STRCMP_EQUAL("test_bucket{le=\"0.000001\"} 1\n"
+                 "test_bucket{le=\"0.000002\"} 1\n"
+                 "test_bucket{le=\"0.000004\"} 3\n"
+                 "test_bucket{le=\"+Inf\"} 6\n"
+                 "test_sum 2.500000\n"
+                 "test_count 6\n",
+                 *metrics);
+
+    string_dyn_copy (metrics, NULL);
+    relay_metrics_add_histogram (metrics, "test", "phase=\"fd\"",
+                                 histogram, 2, 1, 3);
+    STRCMP_EQUAL("test_bucket{phase=\"fd\",le=\"0.000001\"} 1\n"
+                 "test_bucket{phase=\"fd\",le=\"+Inf\"} 1\n"
+                 "test_sum{phase=\"fd\"} 0.000003\n"
+                 "test_count{phase=\"fd\"} 1\n",
+                 *metrics);
+
+    string_dyn_free (metrics, 1);
+}
+
+/*
+ * Tests functions:
+ *   relay_metrics_get
+ */
+
+TEST(RelayMetrics, Get)
+{
+    char *metrics;
+
+    metrics = relay_metrics_get ();
+    CHECK(metrics);
+
+    CHECK(strstr (metrics, "# TYPE weechat_irc_messages_received_total "
+                  "counter\n"));
+    CHECK(strstr (metrics, "# TYPE weechat_relay_clients gauge\n"));
+    CHECK(strstr (metrics, "# TYPE weechat_relay_outqueue_bytes gauge\n"));
+    CHECK(strstr (metrics, "weechat_buffer_lines{buffer=\"core.weechat\","
+                  "plugin=\"core\"} "));
+    CHECK(strstr (metrics, "weechat_buffer_memory_bytes{"
+                  "buffer=\"core.weechat\",plugin=\"core\",type=\"lines\"} "));
+    CHECK(strstr (metrics, "# TYPE weechat_main_loop_iteration_seconds "
+                  "histogram\n"));
+    CHECK(strstr (metrics, "weechat_main_loop_iteration_seconds_bucket"
+                  "{le=\"+Inf\"} "));
+    CHECK(strstr (metrics, "weechat_main_loop_phase_seconds_total"
+                  "{phase=\"timers\"} "));
+    CHECK(strstr (metrics, "# TYPE weechat_hook_callback_calls_total "
+                  "counter\n"));
+
+    free (metrics);
+}
@@ -0,0 +1,168 @@
+/*
+ * test-relay-server.cpp - test server functions
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include <unistd.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "src/core/core-config-file.h"
+#include "src/plugins/weechat-plugin.h"
+#include "src/plugins/relay/relay.h"
+#include "src/plugins/relay/relay-client.h"
+#include "src/plugins/relay/relay-config.h"
+#include "src/plugins/relay/relay-server.h"
+
+extern int relay_server_sock_cb (const void *pointer, void *data, int fd);
+}
+
+#define TEST_RELAY_SERVER_PORT 9000
+#define TEST_RELAY_SERVER_NUM_CLIENTS 3
+
+TEST_GROUP(RelayServer)
+{
+    struct t_relay_server *ptr_server;
+    int sock[TEST_RELAY_SERVER_NUM_CLIENTS];
+
+    void setup ()
+    {
+        int i;
+
+        /* disable auto-open of relay buffer */
+        config_file_option_set (relay_config_look_auto_open_buffer, "off", 1);
+
+        ptr_server = relay_server_new (
+            "weechat",
+            RELAY_PROTOCOL_WEECHAT,
+            "test",
+            TEST_RELAY_SERVER_PORT,
+            NULL,  /* path */
+            1,  /* ipv4 */
+            0,  /* ipv6 */
+            0,  /* tls */
+            0);  /* unix_socket */
+
+        for (i = 0; i < TEST_RELAY_SERVER_NUM_CLIENTS; i++)
+        {
+            sock[i] = -1;
+        }
+    }
+
+    void teardown ()
+    {
+        int i;
+
+        for (i = 0; i < TEST_RELAY_SERVER_NUM_CLIENTS; i++)
+        {
+            if (sock[i] >= 0)
+                close (sock[i]);
+        }
+        relay_server_free (ptr_server);
+        ptr_server = NULL;
+
+        /* restore options */
+        config_file_option_reset (relay_config_look_auto_open_buffer, 1);
+        config_file_option_reset (relay_config_network_password, 1);
+    }
+
+    /*
+     * Connects all test sockets to the relay server.
+     */
+
+    void connect_clients ()
+    {
+        struct sockaddr_in addr;
+        int i;
+
+        memset (&addr, 0, sizeof (addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons (TEST_RELAY_SERVER_PORT);
+        addr.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+
+        for (i = 0; i < TEST_RELAY_SERVER_NUM_CLIENTS; i++)
+        {
+            sock[i] = socket (AF_INET, SOCK_STREAM, 0);
+            CHECK(sock[i] >= 0);
+            LONGS_EQUAL(0, connect (sock[i], (struct sockaddr *)&addr,
+                                    sizeof (addr)));
+        }
+    }
+};
+
+/*
+ * Tests functions:
+ *   relay_server_accept_client
+ *   relay_server_sock_cb
+ */
+
+TEST(RelayServer, SockCb)
+{
+    int i, count;
+
+    CHECK(ptr_server);
+    CHECK(ptr_server->sock >= 0);
+
+    config_file_option_set (relay_config_network_password, "test", 1);
+
+    /* no pending connection */
+    count = relay_client_count;
+    LONGS_EQUAL(WEECHAT_RC_OK,
+                relay_server_sock_cb (ptr_server, NULL, ptr_server->sock));
+    LONGS_EQUAL(count, relay_client_count);
+
+    /* all pending connections are accepted in one call */
+    connect_clients ();
+    LONGS_EQUAL(WEECHAT_RC_OK,
+                relay_server_sock_cb (ptr_server, NULL, ptr_server->sock));
+    LONGS_EQUAL(count + TEST_RELAY_SERVER_NUM_CLIENTS, relay_client_count);
+    for (i = 0; i < TEST_RELAY_SERVER_NUM_CLIENTS; i++)
+    {
+        CHECK(last_relay_client);
+        LONGS_EQUAL(TEST_RELAY_SERVER_PORT, last_relay_client->server_port);
+        relay_client_free (last_relay_client);
+    }
+    LONGS_EQUAL(count, relay_client_count);
+}
+
+/*
+ * Tests functions:
+ *   relay_server_accept_client
+ *   relay_server_sock_cb
+ */
+
+TEST(RelayServer, SockCbEmptyPassword)
+{
+    int count;
+
+    CHECK(ptr_server);
+
+    /* empty password not allowed: connections are closed */
+    config_file_option_set (relay_config_network_password, "", 1);
+    count = relay_client_count;
+    connect_clients ();
+    LONGS_EQUAL(WEECHAT_RC_OK,
+                relay_server_sock_cb (ptr_server, NULL, ptr_server->sock));
+    LONGS_EQUAL(count, relay_client_count);
+}
@@ -248,6 +248,18 @@ TEST(RelayWebsocket, ClientHandshakeValid)
         "\r\n",
         relay_websocket_build_handshake (request));
 
+    /* subprotocol */
+    relay_websocket_deflate_reinit (request->ws_deflate);
+    request->ws_protocol = strdup ("cbor");
+    WEE_TEST_STR(
+        "HTTP/1.1 101 Switching Protocols\r\n"
+        "Upgrade: websocket\r\n"
+        "Connection: Upgrade\r\n"
+        "Sec-WebSocket-Accept: fhLJYtv//ugX2vQXpifQgByRZ5Y=\r\n"
+        "Sec-WebSocket-Protocol: cbor\r\n"
+        "\r\n",
+        relay_websocket_build_handshake (request));
+
     relay_http_request_free (request);
 }
 
@@ -455,22 +467,112 @@ TEST(RelayWebsocket, Inflate)
 
 /*
  * Tests functions:
- *   relay_websocket_decode_frame
+ *   relay_websocket_mask
  */
 
-TEST(RelayWebsocket, DecodeFrame)
+TEST(RelayWebsocket, Mask)
 {
-    /* TODO: write tests */
+    const unsigned char mask[4] = { 0x12, 0x34, 0x56, 0x78 };
+    unsigned char data[64], masked[64], expected[64];
+    int i, size;
+
+    for (i = 0; i < (int)sizeof (data); i++)
+    {
+        data[i] = (unsigned char)(i * 7);
+    }
+
+    /* all sizes (with and without remaining bytes after 8-byte blocks) */
+    for (size = 0; size <= (int)sizeof (data); size++)
+    {
+        for (i = 0; i < size; i++)
+        {
+            expected[i] = data[i] ^ mask[i % 4];
+        }
+        memset (masked, 0, sizeof (masked));
+        relay_websocket_mask (masked, data, size, mask);
+        MEMCMP_EQUAL(expected, masked, size);
+    }
+
+    /* mask in place, then unmask */
+    memcpy (masked, data, sizeof (data));
+    relay_websocket_mask (masked, masked, 61, mask);
+    MEMCMP_EQUAL(expected, masked, 61);
+    relay_websocket_mask (masked, masked, 61, mask);
+    MEMCMP_EQUAL(data, masked, 61);
 }
 
 /*
  * Tests functions:
+ *   relay_websocket_decode_frame
  *   relay_websocket_encode_frame
  */
 
-TEST(RelayWebsocket, EncodeFrame)
+TEST(RelayWebsocket, EncodeDecodeFrame)
 {
-    /* TODO: write tests */
+    struct t_relay_websocket_frame *frames;
+    char payload[300], *frame, *partial_frame;
+    unsigned long long length_frame;
+    int i, num_frames, partial_frame_size;
+
+    for (i = 0; i < (int)sizeof (payload); i++)
+    {
+        payload[i] = 'a' + (i % 26);
+    }
+
+    frames = NULL;
+    num_frames = 0;
+    partial_frame = NULL;
+    partial_frame_size = 0;
+
+    /* not masked frame */
+    frame = relay_websocket_encode_frame (NULL, 1, 0, "test", 4,
+                                          &length_frame);
+    CHECK(frame);
+    LONGS_EQUAL(6, length_frame);
+    MEMCMP_EQUAL("\x81\x04test", frame, 6);
+    LONGS_EQUAL(0, relay_websocket_decode_frame (
+                    (const unsigned char *)frame, length_frame, 1, NULL,
+                    &frames, &num_frames,
+                    &partial_frame, &partial_frame_size));
+    LONGS_EQUAL(1, relay_websocket_decode_frame (
+                    (const unsigned char *)frame, length_frame, 0, NULL,
+                    &frames, &num_frames,
+                    &partial_frame, &partial_frame_size));
+    LONGS_EQUAL(1, num_frames);
+    LONGS_EQUAL(RELAY_MSG_STANDARD, frames[0].opcode);
+    LONGS_EQUAL(4, frames[0].payload_size);
+    STRCMP_EQUAL("test", frames[0].payload);
+    free (frames[0].payload);
+    free (frames);
+    free (frame);
+
+    /* masked frame (length on 2 bytes) */
+    frame = relay_websocket_encode_frame (NULL, 1, 1, payload,
+                                          sizeof (payload), &length_frame);
+    CHECK(frame);
+    LONGS_EQUAL(2 + 2 + 4 + sizeof (payload), length_frame);
+    LONGS_EQUAL(0xFE, (unsigned char)frame[1]);
+    LONGS_EQUAL(1, relay_websocket_decode_frame (
+                    (const unsigned char *)frame, length_frame, 1, NULL,
+                    &frames, &num_frames,
+                    &partial_frame, &partial_frame_size));
+    LONGS_EQUAL(1, num_frames);
+    LONGS_EQUAL(sizeof (payload), frames[0].payload_size);
+    MEMCMP_EQUAL(payload, frames[0].payload, sizeof (payload));
+    free (frames[0].payload);
+    free (frames);
+
+    /* partial masked frame */
+    LONGS_EQUAL(1, relay_websocket_decode_frame (
+                    (const unsigned char *)frame, length_frame - 10, 1, NULL,
+                    &frames, &num_frames,
+                    &partial_frame, &partial_frame_size));
+    LONGS_EQUAL(0, num_frames);
+    LONGS_EQUAL(length_frame - 10, partial_frame_size);
+    MEMCMP_EQUAL(frame, partial_frame, partial_frame_size);
+    free (frames);
+    free (partial_frame);
+    free (frame);
 }
 
 /*
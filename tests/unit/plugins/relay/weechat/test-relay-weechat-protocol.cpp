@@ -0,0 +1,457 @@
+/*
+ * test-relay-weechat-protocol.cpp - test WeeChat protocol for relay to client
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include <string.h>
+#include <arpa/inet.h>
+#include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+#include "src/core/core-config-file.h"
+#include "src/core/core-hashtable.h"
+#include "src/gui/gui-buffer.h"
+#include "src/gui/gui-chat.h"
+#include "src/plugins/weechat-plugin.h"
+#include "src/plugins/relay/relay.h"
+#include "src/plugins/relay/relay-client.h"
+#include "src/plugins/relay/relay-config.h"
+#include "src/plugins/relay/relay-server.h"
+#include "src/plugins/relay/weechat/relay-weechat.h"
+#include "src/plugins/relay/weechat/relay-weechat-msg.h"
+#include "src/plugins/relay/weechat/relay-weechat-protocol.h"
+}
+
+#define TEST_NUM_CLIENTS 2
+
+struct t_relay_server *ptr_relay_weechat_server = NULL;
+struct t_relay_client *ptr_relay_weechat_clients[TEST_NUM_CLIENTS];
+char *relay_weechat_data_sent[TEST_NUM_CLIENTS];
+int relay_weechat_data_sent_size[TEST_NUM_CLIENTS];
+int relay_weechat_num_sent[TEST_NUM_CLIENTS];
+
+TEST_GROUP(RelayWeechatProtocolWithClient)
+{
+    static void fake_send_func (void *client, const char *data, int data_size)
+    {
+        int i;
+
+        for (i = 0; i < TEST_NUM_CLIENTS; i++)
+        {
+            if (client == ptr_relay_weechat_clients[i])
+            {
+                free (relay_weechat_data_sent[i]);
+                relay_weechat_data_sent[i] = (char *)malloc (data_size);
+                memcpy (relay_weechat_data_sent[i], data, data_size);
+                relay_weechat_data_sent_size[i] = data_size;
+                relay_weechat_num_sent[i]++;
+            }
+        }
+    }
+
+    void setup ()
+    {
+        int i, flags;
+
+        /* disable auto-open of relay buffer */
+        config_file_option_set (relay_config_look_auto_open_buffer, "off", 1);
+
+        /* create a relay server */
+        ptr_relay_weechat_server = relay_server_new (
+            "weechat",
+            RELAY_PROTOCOL_WEECHAT,
+            "test",
+            9000,
+            NULL,  /* path */
+            1,  /* ipv4 */
+            0,  /* ipv6 */
+            0,  /* tls */
+            0);  /* unix_socket */
+
+        /* create relay clients, synchronized with all buffers */
+        flags = RELAY_WEECHAT_PROTOCOL_SYNC_ALL;
+        for (i = 0; i < TEST_NUM_CLIENTS; i++)
+        {
+            ptr_relay_weechat_clients[i] = relay_client_new (
+                -1, "test", ptr_relay_weechat_server);
+            ptr_relay_weechat_clients[i]->fake_send_func = &fake_send_func;
+            hashtable_set (
+                RELAY_WEECHAT_DATA(ptr_relay_weechat_clients[i], buffers_sync),
+                "*", &flags);
+            relay_weechat_data_sent[i] = NULL;
+        }
+
+        /* ignore messages sent during creation of clients */
+        for (i = 0; i < TEST_NUM_CLIENTS; i++)
+        {
+            free (relay_weechat_data_sent[i]);
+            relay_weechat_data_sent[i] = NULL;
+            relay_weechat_data_sent_size[i] = 0;
+            relay_weechat_num_sent[i] = 0;
+        }
+    }
+
+    void teardown ()
+    {
+        int i;
+
+        for (i = 0; i < TEST_NUM_CLIENTS; i++)
+        {
+            relay_client_free (ptr_relay_weechat_clients[i]);
+            ptr_relay_weechat_clients[i] = NULL;
+            free (relay_weechat_data_sent[i]);
+            relay_weechat_data_sent[i] = NULL;
+        }
+
+        relay_server_free (ptr_relay_weechat_server);
+        ptr_relay_weechat_server = NULL;
+
+        /* restore auto-open of relay buffer */
+        config_file_option_reset (relay_config_look_auto_open_buffer, 1);
+    }
+};
+
+/*
+ * Tests functions:
+ *   relay_weechat_protocol_signal_msg_start
+ *   relay_weechat_protocol_signal_msg_reset
+ *   relay_weechat_protocol_signal_send_hdata
+ *   relay_weechat_protocol_signal_buffer_cb
+ */
+
+TEST(RelayWeechatProtocolWithClient, SignalBufferSharedMsg)
+{
+    struct t_relay_weechat_msg *ptr_msg;
+    char *old_title;
+
+    /* message built once and sent to all clients */
+    gui_chat_printf (NULL, "test relay shared message");
+    LONGS_EQUAL(1, relay_weechat_num_sent[0]);
+    LONGS_EQUAL(1, relay_weechat_num_sent[1]);
+    LONGS_EQUAL(relay_weechat_data_sent_size[0],
+                relay_weechat_data_sent_size[1]);
+    MEMCMP_EQUAL(relay_weechat_data_sent[0], relay_weechat_data_sent[1],
+                 relay_weechat_data_sent_size[0]);
+    STRCMP_EQUAL("buffer_line_added", relay_weechat_protocol_signal_msg.signal);
+    LONGS_EQUAL(TEST_NUM_CLIENTS, relay_weechat_protocol_signal_msg.num_clients);
+    ptr_msg = relay_weechat_protocol_signal_msg.msg;
+    CHECK(ptr_msg);
+    STRCMP_EQUAL("_buffer_line_added", ptr_msg->id);
+
+    /* new signal: new message */
+    gui_chat_printf (NULL, "test relay shared message 2");
+    LONGS_EQUAL(2, relay_weechat_num_sent[0]);
+    LONGS_EQUAL(2, relay_weechat_num_sent[1]);
+    MEMCMP_EQUAL(relay_weechat_data_sent[0], relay_weechat_data_sent[1],
+                 relay_weechat_data_sent_size[0]);
+    LONGS_EQUAL(TEST_NUM_CLIENTS, relay_weechat_protocol_signal_msg.num_clients);
+
+    /* same signal with same data sent again: message is built again */
+    old_title = (gui_buffers->title) ? strdup (gui_buffers->title) : NULL;
+    gui_buffer_set_title (gui_buffers, "title 1");
+    ptr_msg = relay_weechat_protocol_signal_msg.msg;
+    CHECK(ptr_msg);
+    gui_buffer_set_title (gui_buffers, "title 2");
+    LONGS_EQUAL(4, relay_weechat_num_sent[0]);
+    LONGS_EQUAL(4, relay_weechat_num_sent[1]);
+    CHECK(relay_weechat_protocol_signal_msg.msg);
+    CHECK(memmem (relay_weechat_data_sent[0], relay_weechat_data_sent_size[0],
+                  "title 2", 7));
+    CHECK(memmem (relay_weechat_data_sent[1], relay_weechat_data_sent_size[1],
+                  "title 2", 7));
+    gui_buffer_set_title (gui_buffers, old_title);
+    free (old_title);
+
+    /* reset of shared message */
+    relay_weechat_protocol_signal_msg_reset ();
+    POINTERS_EQUAL(NULL, relay_weechat_protocol_signal_msg.signal);
+    POINTERS_EQUAL(NULL, relay_weechat_protocol_signal_msg.msg);
+    LONGS_EQUAL(0, relay_weechat_protocol_signal_msg.num_clients);
+}
+
+/*
+ * Tests functions:
+ *   relay_weechat_protocol_line_fields_build
+ *   relay_weechat_protocol_line_fields
+ *   relay_weechat_protocol_signal_send_hdata
+ */
+
+TEST(RelayWeechatProtocolWithClient, SignalBufferLineFields)
+{
+    char *str;
+
+    POINTERS_EQUAL(NULL, relay_weechat_protocol_line_fields_build (NULL));
+    POINTERS_EQUAL(NULL, relay_weechat_protocol_line_fields_build (""));
+    POINTERS_EQUAL(
+        NULL,
+        relay_weechat_protocol_line_fields_build (
+            "buffer:id:date:date_usec:date_printed:date_usec_printed:"
+            "displayed:notify_level:highlight:tags_array:prefix:message"));
+    str = relay_weechat_protocol_line_fields_build ("unknown");
+    STRCMP_EQUAL("buffer", str);
+    free (str);
+    str = relay_weechat_protocol_line_fields_build ("message:date:xxx");
+    STRCMP_EQUAL("buffer,date,message", str);
+    free (str);
+
+    STRCMP_EQUAL(RELAY_WEECHAT_PROTOCOL_LINE_FIELDS,
+                 relay_weechat_protocol_line_fields (NULL));
+    STRCMP_EQUAL(RELAY_WEECHAT_PROTOCOL_LINE_FIELDS,
+                 relay_weechat_protocol_line_fields (
+                     ptr_relay_weechat_clients[0]));
+
+    /* first client receives only some fields, the second one all fields */
+    RELAY_WEECHAT_DATA(ptr_relay_weechat_clients[0], line_fields) =
+        relay_weechat_protocol_line_fields_build ("date:message");
+    STRCMP_EQUAL("buffer,date,message",
+                 relay_weechat_protocol_line_fields (
+                     ptr_relay_weechat_clients[0]));
+
+    gui_chat_printf (NULL, "test relay line fields");
+    LONGS_EQUAL(1, relay_weechat_num_sent[0]);
+    LONGS_EQUAL(1, relay_weechat_num_sent[1]);
+    CHECK(relay_weechat_data_sent_size[0] < relay_weechat_data_sent_size[1]);
+    CHECK(memmem (relay_weechat_data_sent[0], relay_weechat_data_sent_size[0],
+                  "test relay line fields", 22));
+    POINTERS_EQUAL(NULL,
+                   memmem (relay_weechat_data_sent[0],
+                           relay_weechat_data_sent_size[0],
+                           "tags_array", 10));
+    CHECK(memmem (relay_weechat_data_sent[1], relay_weechat_data_sent_size[1],
+                  "tags_array", 10));
+
+    relay_weechat_protocol_signal_msg_reset ();
+}
+
+/*
+ * Tests functions:
+ *   relay_weechat_msg_compress_zlib
+ *   relay_weechat_msg_send
+ */
+
+TEST(RelayWeechatProtocolWithClient, SendCompressedOnce)
+{
+    struct t_relay_weechat_msg *msg;
+    int i;
+
+    for (i = 0; i < TEST_NUM_CLIENTS; i++)
+    {
+        RELAY_WEECHAT_DATA(ptr_relay_weechat_clients[i], compression) =
+            RELAY_WEECHAT_COMPRESSION_ZLIB;
+    }
+
+    msg = relay_weechat_msg_new ("test");
+    CHECK(msg);
+    for (i = 0; i < 100; i++)
+    {
+        relay_weechat_msg_add_string (msg, "this is a test, this is a test");
+    }
+    LONGS_EQUAL(0, msg->compressed_size[RELAY_WEECHAT_COMPRESSION_ZLIB]);
+
+    relay_weechat_msg_send (ptr_relay_weechat_clients[0], msg);
+    CHECK(msg->compressed[RELAY_WEECHAT_COMPRESSION_ZLIB]);
+    CHECK(msg->compressed_size[RELAY_WEECHAT_COMPRESSION_ZLIB] > 0);
+    CHECK(msg->compressed_size[RELAY_WEECHAT_COMPRESSION_ZLIB] < msg->data_size);
+    CHECK(msg->compressed_raw[RELAY_WEECHAT_COMPRESSION_ZLIB]);
+    LONGS_EQUAL(msg->compressed_size[RELAY_WEECHAT_COMPRESSION_ZLIB],
+                relay_weechat_data_sent_size[0]);
+    LONGS_EQUAL(RELAY_WEECHAT_COMPRESSION_ZLIB, relay_weechat_data_sent[0][4]);
+
+    relay_weechat_msg_send (ptr_relay_weechat_clients[1], msg);
+    POINTERS_EQUAL(NULL, msg->compressed[RELAY_WEECHAT_COMPRESSION_OFF]);
+    LONGS_EQUAL(relay_weechat_data_sent_size[0],
+                relay_weechat_data_sent_size[1]);
+    MEMCMP_EQUAL(relay_weechat_data_sent[0], relay_weechat_data_sent[1],
+                 relay_weechat_data_sent_size[0]);
+
+    relay_weechat_msg_free (msg);
+
+    /* message too small to be compressed: sent uncompressed */
+    msg = relay_weechat_msg_new ("test");
+    CHECK(msg);
+    relay_weechat_msg_send (ptr_relay_weechat_clients[0], msg);
+    LONGS_EQUAL(-1, msg->compressed_size[RELAY_WEECHAT_COMPRESSION_ZLIB]);
+    POINTERS_EQUAL(NULL, msg->compressed[RELAY_WEECHAT_COMPRESSION_ZLIB]);
+    LONGS_EQUAL(msg->data_size, relay_weechat_data_sent_size[0]);
+    LONGS_EQUAL(RELAY_WEECHAT_COMPRESSION_OFF, relay_weechat_data_sent[0][4]);
+    relay_weechat_msg_free (msg);
+}
+
+/*
+ * Tests functions:
+ *   relay_weechat_protocol_cb_handshake (compression on UNIX domain socket)
+ */
+
+TEST(RelayWeechatProtocolWithClient, HandshakeCompressionUnixSocket)
+{
+    ptr_relay_weechat_clients[0]->unix_socket = 1;
+    ptr_relay_weechat_clients[1]->unix_socket = 1;
+
+    /* compression allowed on UNIX domain socket (default) */
+    relay_weechat_protocol_recv (ptr_relay_weechat_clients[0],
+                                 "(handshake) handshake compression=zlib");
+    LONGS_EQUAL(RELAY_WEECHAT_COMPRESSION_ZLIB,
+                RELAY_WEECHAT_DATA(ptr_relay_weechat_clients[0], compression));
+
+    /* compression not allowed on UNIX domain socket */
+    config_file_option_set (relay_config_network_compression_unix_socket,
+                            "off", 1);
+    relay_weechat_protocol_recv (ptr_relay_weechat_clients[1],
+                                 "(handshake) handshake compression=zlib");
+    LONGS_EQUAL(RELAY_WEECHAT_COMPRESSION_OFF,
+                RELAY_WEECHAT_DATA(ptr_relay_weechat_clients[1], compression));
+    LONGS_EQUAL(0,
+                RELAY_WEECHAT_DATA(ptr_relay_weechat_clients[1], compression_stream));
+    LONGS_EQUAL(1,
+                RELAY_WEECHAT_DATA(ptr_relay_weechat_clients[1], handshake_done));
+
+    config_file_option_reset (relay_config_network_compression_unix_socket, 1);
+}
+
+/*
+ * Tests functions:
+ *   relay_weechat_msg_compress_zlib_stream
+ *   relay_weechat_msg_send_stream
+ */
+
+TEST(RelayWeechatProtocolWithClient, SendZlibStream)
+{
+    struct t_relay_weechat_msg *msg;
+    z_stream strm;
+    char output[4096];
+    uint32_t size32;
+    int i, size_first;
+
+    RELAY_WEECHAT_DATA(ptr_relay_weechat_clients[0], compression) =
+        RELAY_WEECHAT_COMPRESSION_ZLIB;
+    RELAY_WEECHAT_DATA(ptr_relay_weechat_clients[0], compression_stream) = 1;
+
+    memset (&strm, 0, sizeof (strm));
+    LONGS_EQUAL(Z_OK, inflateInit (&strm));
+
+    /* handshake not done: message not compressed */
+    msg = relay_weechat_msg_new ("test");
+    relay_weechat_msg_add_string (msg, "this is a test, this is a test");
+    relay_weechat_msg_send (ptr_relay_weechat_clients[0], msg);
+    LONGS_EQUAL(RELAY_WEECHAT_COMPRESSION_OFF, relay_weechat_data_sent[0][4]);
+    POINTERS_EQUAL(NULL,
+                   RELAY_WEECHAT_DATA(ptr_relay_weechat_clients[0], zlib_stream));
+    relay_weechat_msg_free (msg);
+
+    RELAY_WEECHAT_DATA(ptr_relay_weechat_clients[0], handshake_done) = 1;
+
+    size_first = 0;
+    for (i = 0; i < 2; i++)
+    {
+        msg = relay_weechat_msg_new ("test");
+        relay_weechat_msg_add_string (msg, "this is a test, this is a test");
+        relay_weechat_msg_send (ptr_relay_weechat_clients[0], msg);
+        CHECK(RELAY_WEECHAT_DATA(ptr_relay_weechat_clients[0], zlib_stream));
+        LONGS_EQUAL(RELAY_WEECHAT_COMPRESSION_ZLIB,
+                    relay_weechat_data_sent[0][4]);
+        memcpy (&size32, relay_weechat_data_sent[0], 4);
+        LONGS_EQUAL(relay_weechat_data_sent_size[0], ntohl (size32));
+
+        /* decompress with the same context for all messages */
+        strm.next_in = (Bytef *)relay_weechat_data_sent[0] + 5;
+        strm.avail_in = relay_weechat_data_sent_size[0] - 5;
+        strm.next_out = (Bytef *)output;
+        strm.avail_out = sizeof (output);
+        LONGS_EQUAL(Z_OK, inflate (&strm, Z_SYNC_FLUSH));
+        LONGS_EQUAL(0, strm.avail_in);
+        LONGS_EQUAL(msg->data_size - 5, sizeof (output) - strm.avail_out);
+        MEMCMP_EQUAL(msg->data + 5, output, msg->data_size - 5);
+
+        if (i == 0)
+            size_first = relay_weechat_data_sent_size[0];
+        else
+            CHECK(relay_weechat_data_sent_size[0] < size_first);
+
+        relay_weechat_msg_free (msg);
+    }
+
+    inflateEnd (&strm);
+
+    /* other client is not affected */
+    POINTERS_EQUAL(NULL,
+                   RELAY_WEECHAT_DATA(ptr_relay_weechat_clients[1], zlib_stream));
+}
+
+/*
+ * Tests functions:
+ *   relay_weechat_msg_compress_zstd_stream
+ *   relay_weechat_msg_send_stream
+ */
+
+TEST(RelayWeechatProtocolWithClient, SendZstdStream)
+{
+#ifdef HAVE_ZSTD
+    struct t_relay_weechat_msg *msg;
+    ZSTD_DCtx *dctx;
+    ZSTD_inBuffer input;
+    ZSTD_outBuffer output;
+    char data[4096];
+    int i, size_first;
+
+    RELAY_WEECHAT_DATA(ptr_relay_weechat_clients[0], compression) =
+        RELAY_WEECHAT_COMPRESSION_ZSTD;
+    RELAY_WEECHAT_DATA(ptr_relay_weechat_clients[0], compression_stream) = 1;
+    RELAY_WEECHAT_DATA(ptr_relay_weechat_clients[0], handshake_done) = 1;
+
+    dctx = ZSTD_createDCtx ();
+    CHECK(dctx);
+
+    size_first = 0;
+    for (i = 0; i < 2; i++)
+    {
+        msg = relay_weechat_msg_new ("test");
+        relay_weechat_msg_add_string (msg, "this is a test, this is a test");
+        relay_weechat_msg_send (ptr_relay_weechat_clients[0], msg);
+        CHECK(RELAY_WEECHAT_DATA(ptr_relay_weechat_clients[0], zstd_cctx));
+        LONGS_EQUAL(RELAY_WEECHAT_COMPRESSION_ZSTD,
+                    relay_weechat_data_sent[0][4]);
+
+        /* decompress with the same context for all messages */
+        input.src = relay_weechat_data_sent[0] + 5;
+        input.size = relay_weechat_data_sent_size[0] - 5;
+        input.pos = 0;
+        output.dst = data;
+        output.size = sizeof (data);
+        output.pos = 0;
+        CHECK(!ZSTD_isError (ZSTD_decompressStream (dctx, &output, &input)));
+        LONGS_EQUAL(input.size, input.pos);
+        LONGS_EQUAL(msg->data_size - 5, output.pos);
+        MEMCMP_EQUAL(msg->data + 5, data, msg->data_size - 5);
+
+        if (i == 0)
+            size_first = relay_weechat_data_sent_size[0];
+        else
+            CHECK(relay_weechat_data_sent_size[0] < size_first);
+
+        relay_weechat_msg_free (msg);
+    }
+
+    ZSTD_freeDCtx (dctx);
+#endif /* HAVE_ZSTD */
+}
@@ -1229,6 +1229,29 @@ TEST(PluginApiInfo, InfolistPluginCb)
     free (name);
 }
 
+/*
+ * Tests functions:
+ *   plugin_api_infolist_profile_cb
+ */
+
+TEST(PluginApiInfo, InfolistProfileCb)
+{
+    struct t_infolist *infolist;
+
+    infolist = hook_infolist_get (NULL, "profile", NULL, NULL);
+    CHECK(infolist);
+    CHECK(infolist_next (infolist));
+    STRCMP_EQUAL("phase", infolist_string (infolist, "type"));
+    STRCMP_EQUAL("timers", infolist_string (infolist, "name"));
+    POINTERS_EQUAL(NULL, infolist_pointer (infolist, "hook"));
+    STRCMP_EQUAL("0", infolist_string (infolist, "count"));
+    STRCMP_EQUAL("0", infolist_string (infolist, "time_total"));
+    STRCMP_EQUAL("0", infolist_string (infolist, "time_avg"));
+    STRCMP_EQUAL("0", infolist_string (infolist, "time_max"));
+    STRCMP_EQUAL("0", infolist_string (infolist, "time_p99"));
+    infolist_free (infolist);
+}
+
 /*
  * Tests functions:
  *   plugin_api_infolist_proxy_cb
@@ -0,0 +1,150 @@
+/*
+ * test-trigger-callback.cpp - test trigger callback functions
+ *
+ * Copyright (C) 2021-2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+#include "tests/tests.h"
+
+extern "C"
+{
+#include <string.h>
+#include "src/core/core-config-file.h"
+#include "src/core/core-hashtable.h"
+#include "src/core/core-list.h"
+#include "src/plugins/plugin.h"
+#include "src/plugins/trigger/trigger.h"
+#include "src/plugins/trigger/trigger-buffer.h"
+#include "src/plugins/trigger/trigger-callback.h"
+}
+
+TEST_GROUP(TriggerCallback)
+{
+};
+
+/*
+ * Tests functions:
+ *   trigger_callback_check_literals
+ */
+
+TEST(TriggerCallback, CheckLiterals)
+{
+    struct t_trigger *trigger;
+
+    trigger = trigger_new ("test", "on", "print", "", "", "", "", "", "");
+    CHECK(trigger);
+
+    /* no literals */
+    LONGS_EQUAL(1, trigger_callback_check_literals (trigger,
+                                                    "tg_message", "test",
+                                                    NULL));
+
+    config_file_option_set (trigger->options[TRIGGER_OPTION_CONDITIONS],
+                            "${tg_message} =- abc && ${tg_prefix} ==- Nick",
+                            1);
+    LONGS_EQUAL(2, trigger->literals_count);
+
+    if (!trigger_buffer)
+    {
+        LONGS_EQUAL(1, trigger_callback_check_literals (trigger, NULL));
+        LONGS_EQUAL(1, trigger_callback_check_literals (trigger,
+                                                        "tg_message", "xABCx",
+                                                        "tg_prefix", "Nick",
+                                                        NULL));
+        LONGS_EQUAL(0, trigger_callback_check_literals (trigger,
+                                                        "tg_message", "xyz",
+                                                        "tg_prefix", "Nick",
+                                                        NULL));
+        LONGS_EQUAL(0, trigger_callback_check_literals (trigger,
+                                                        "tg_message", "abc",
+                                                        "tg_prefix", "nick",
+                                                        NULL));
+        /* unknown value: not checked */
+        LONGS_EQUAL(1, trigger_callback_check_literals (trigger,
+                                                        "tg_message", NULL,
+                                                        "tg_prefix", "Nick",
+                                                        NULL));
+    }
+
+    trigger_free (trigger);
+}
+
+/*
+ * Tests functions:
+ *   trigger_callback_pool_get
+ *   trigger_callback_context_free
+ */
+
+TEST(TriggerCallback, Pool)
+{
+    struct t_trigger_context ctx[TRIGGER_CALLBACK_POOL_SIZE];
+    int i;
+
+    memset (ctx, 0, sizeof (ctx));
+
+    for (i = 0; i < TRIGGER_CALLBACK_POOL_SIZE; i++)
+    {
+        ctx[i].pool = trigger_callback_pool_get ();
+        CHECK(ctx[i].pool);
+        CHECK(ctx[i].pool->pointers);
+        CHECK(ctx[i].pool->extra_vars);
+        CHECK(ctx[i].pool->vars_updated);
+        LONGS_EQUAL(1, ctx[i].pool->used);
+        if (i > 0)
+            CHECK(ctx[i].pool != ctx[i - 1].pool);
+    }
+
+    /* all entries are used */
+    POINTERS_EQUAL(NULL, trigger_callback_pool_get ());
+
+    /* hashtables from the pool are emptied, not freed */
+    ctx[0].pointers = ctx[0].pool->pointers;
+    ctx[0].extra_vars = ctx[0].pool->extra_vars;
+    ctx[0].vars_updated = ctx[0].pool->vars_updated;
+    hashtable_set (ctx[0].extra_vars, "tg_test", "value");
+    weelist_add (ctx[0].vars_updated, "tg_test", WEECHAT_LIST_POS_END, NULL);
+    trigger_callback_context_free (&ctx[0]);
+    POINTERS_EQUAL(NULL, ctx[0].pool);
+    POINTERS_EQUAL(NULL, ctx[0].extra_vars);
+    LONGS_EQUAL(0, trigger_callback_pool[0].used);
+    LONGS_EQUAL(0, trigger_callback_pool[0].extra_vars->items_count);
+    LONGS_EQUAL(0, weelist_size (trigger_callback_pool[0].vars_updated));
+
+    /* hashtable not from the pool is freed */
+    ctx[1].extra_vars = hashtable_new (32,
+                                       WEECHAT_HASHTABLE_STRING,
+                                       WEECHAT_HASHTABLE_STRING,
+                                       NULL, NULL);
+    trigger_callback_context_free (&ctx[1]);
+    POINTERS_EQUAL(NULL, ctx[1].extra_vars);
+
+    /* the entry released is reused */
+    POINTERS_EQUAL(&trigger_callback_pool[0], trigger_callback_pool_get ());
+    trigger_callback_pool[0].used = 0;
+
+    for (i = 2; i < TRIGGER_CALLBACK_POOL_SIZE; i++)
+    {
+        trigger_callback_context_free (&ctx[i]);
+    }
+    for (i = 0; i < TRIGGER_CALLBACK_POOL_SIZE; i++)
+    {
+        LONGS_EQUAL(0, trigger_callback_pool[i].used);
+    }
+}
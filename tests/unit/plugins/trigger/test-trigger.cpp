@@ -441,6 +441,105 @@ TEST(Trigger, SplitCommand)
     STRCMP_EQUAL("/test2", commands[1]);
 }
 
+/*
+ * Tests functions:
+ *   trigger_literals_free
+ *   trigger_split_conditions
+ */
+
+TEST(Trigger, SplitConditions)
+{
+    int literals_count;
+    struct t_trigger_literal *literals;
+
+    literals_count = 0;
+    literals = NULL;
+
+    /* no literals_count / literals */
+    trigger_split_conditions (NULL, NULL, NULL);
+    trigger_split_conditions ("${tg_message} =- test", &literals_count, NULL);
+    trigger_split_conditions ("${tg_message} =- test", NULL, &literals);
+    LONGS_EQUAL(0, literals_count);
+    POINTERS_EQUAL(NULL, literals);
+    trigger_literals_free (NULL, NULL);
+
+    /* NULL/empty conditions */
+    trigger_split_conditions (NULL, &literals_count, &literals);
+    LONGS_EQUAL(0, literals_count);
+    POINTERS_EQUAL(NULL, literals);
+    trigger_split_conditions ("", &literals_count, &literals);
+    LONGS_EQUAL(0, literals_count);
+    POINTERS_EQUAL(NULL, literals);
+
+    /* conditions without any literal */
+    trigger_split_conditions ("${tg_displayed}", &literals_count, &literals);
+    LONGS_EQUAL(0, literals_count);
+    trigger_split_conditions ("${tg_message} !- test",
+                              &literals_count, &literals);
+    LONGS_EQUAL(0, literals_count);
+    trigger_split_conditions ("${tg_message} =~ test",
+                              &literals_count, &literals);
+    LONGS_EQUAL(0, literals_count);
+    trigger_split_conditions ("${tg_message} == test",
+                              &literals_count, &literals);
+    LONGS_EQUAL(0, literals_count);
+    trigger_split_conditions ("${tg_message} =- test || ${tg_highlight}",
+                              &literals_count, &literals);
+    LONGS_EQUAL(0, literals_count);
+    trigger_split_conditions ("${tg_message} =- ${nick}",
+                              &literals_count, &literals);
+    LONGS_EQUAL(0, literals_count);
+    trigger_split_conditions ("${tg_message} =- a == b",
+                              &literals_count, &literals);
+    LONGS_EQUAL(0, literals_count);
+    trigger_split_conditions ("${info:test} =- test",
+                              &literals_count, &literals);
+    LONGS_EQUAL(0, literals_count);
+    trigger_split_conditions ("${tg_message} =- ",
+                              &literals_count, &literals);
+    LONGS_EQUAL(0, literals_count);
+    trigger_split_conditions ("(${tg_message} =- test) || ${tg_highlight}",
+                              &literals_count, &literals);
+    LONGS_EQUAL(0, literals_count);
+
+    /* include (case insensitive) */
+    trigger_split_conditions ("  ${tg_message} =- Test  ",
+                              &literals_count, &literals);
+    LONGS_EQUAL(1, literals_count);
+    CHECK(literals);
+    STRCMP_EQUAL("tg_message", literals[0].variable);
+    STRCMP_EQUAL("Test", literals[0].value);
+    LONGS_EQUAL(0, literals[0].case_sensitive);
+
+    /* include (case sensitive), with other conditions */
+    trigger_split_conditions ("${tg_displayed} && ${tg_string} ==- Test "
+                              "&& (${tg_highlight} || ${tg_msg_pv})",
+                              &literals_count, &literals);
+    LONGS_EQUAL(1, literals_count);
+    STRCMP_EQUAL("tg_string", literals[0].variable);
+    STRCMP_EQUAL("Test", literals[0].value);
+    LONGS_EQUAL(1, literals[0].case_sensitive);
+
+    /* masks and parentheses */
+    trigger_split_conditions ("(${tg_command} =* /test*) "
+                              "&& ((${tg_message_nocolor} ==* *abc*def))",
+                              &literals_count, &literals);
+    LONGS_EQUAL(3, literals_count);
+    STRCMP_EQUAL("tg_command", literals[0].variable);
+    STRCMP_EQUAL("/test", literals[0].value);
+    LONGS_EQUAL(0, literals[0].case_sensitive);
+    STRCMP_EQUAL("tg_message_nocolor", literals[1].variable);
+    STRCMP_EQUAL("abc", literals[1].value);
+    LONGS_EQUAL(1, literals[1].case_sensitive);
+    STRCMP_EQUAL("tg_message_nocolor", literals[2].variable);
+    STRCMP_EQUAL("def", literals[2].value);
+    LONGS_EQUAL(1, literals[2].case_sensitive);
+
+    trigger_literals_free (&literals_count, &literals);
+    LONGS_EQUAL(0, literals_count);
+    POINTERS_EQUAL(NULL, literals);
+}
+
 /*
  * Tests functions:
  *   trigger_name_valid
@@ -26,6 +26,9 @@
 extern "C"
 {
 #include "src/plugins/typing/typing.h"
+#include "src/plugins/typing/typing-status.h"
+
+extern void typing_nicks_set_next_purge (struct t_typing_status *typing_status);
 }
 
 TEST_GROUP(Typing)
@@ -82,6 +85,38 @@ TEST(Typing, StatusSelfStatusMapCb)
     /* TODO: write tests */
 }
 
+/*
+ * Tests functions:
+ *   typing_nicks_set_next_purge
+ */
+
+TEST(Typing, NicksSetNextPurge)
+{
+    struct t_typing_status typing_status;
+
+    typing_nicks_next_purge = 0;
+
+    /* typing: default delay_purge_typing is 6 seconds */
+    typing_status.state = TYPING_STATUS_STATE_TYPING;
+    typing_status.last_typed = 1000;
+    typing_nicks_set_next_purge (&typing_status);
+    LONGS_EQUAL(1007, typing_nicks_next_purge);
+
+    /* paused: default delay_purge_paused is 30 seconds (later: ignored) */
+    typing_status.state = TYPING_STATUS_STATE_PAUSED;
+    typing_status.last_typed = 1000;
+    typing_nicks_set_next_purge (&typing_status);
+    LONGS_EQUAL(1007, typing_nicks_next_purge);
+
+    /* earlier expiration */
+    typing_status.state = TYPING_STATUS_STATE_TYPING;
+    typing_status.last_typed = 990;
+    typing_nicks_set_next_purge (&typing_status);
+    LONGS_EQUAL(997, typing_nicks_next_purge);
+
+    typing_nicks_next_purge = 0;
+}
+
 /*
  * Tests functions:
  *   typing_status_nicks_status_map_cb
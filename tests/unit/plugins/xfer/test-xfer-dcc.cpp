@@ -0,0 +1,154 @@
+/*
+ * test-xfer-dcc.cpp - test xfer DCC functions
+ *
+ * Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+#include "tests/tests.h"
+
+extern "C"
+{
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "src/plugins/xfer/xfer.h"
+#include "src/plugins/xfer/xfer-dcc.h"
+}
+
+#define TEST_XFER_DCC_FILE "/tmp/test-xfer-dcc.txt"
+
+TEST_GROUP(XferDcc)
+{
+    void write_test_file ()
+    {
+        FILE *file;
+        int i;
+
+        file = fopen (TEST_XFER_DCC_FILE, "w");
+        CHECK(file);
+        for (i = 0; i < 1000; i++)
+        {
+            fputc ('a', file);
+        }
+        for (i = 0; i < 3000; i++)
+        {
+            fputc ('b', file);
+        }
+        fclose (file);
+    }
+};
+
+/*
+ * Tests functions:
+ *   xfer_dcc_hash_chunk
+ */
+
+TEST(XferDcc, HashChunk)
+{
+    struct t_xfer_dcc_hash hash;
+    struct t_xfer_dcc_hash_chunk chunk;
+
+    write_test_file ();
+
+    memset (&hash, 0, sizeof (hash));
+    pthread_mutex_init (&hash.mutex, NULL);
+
+    memset (&chunk, 0, sizeof (chunk));
+    chunk.hash = &hash;
+
+    /* file not found */
+    chunk.filename = "/tmp/test-xfer-dcc-not-found.txt";
+    chunk.start = 0;
+    chunk.size = 10;
+    xfer_dcc_hash_chunk (&chunk);
+    LONGS_EQUAL(0, chunk.rc);
+
+    chunk.filename = TEST_XFER_DCC_FILE;
+
+    /* whole file */
+    chunk.start = 0;
+    chunk.size = 4000;
+    xfer_dcc_hash_chunk (&chunk);
+    LONGS_EQUAL(1, chunk.rc);
+    LONGS_EQUAL(0x6155FC42, chunk.crc32);
+
+    /* first chunk */
+    chunk.start = 0;
+    chunk.size = 1000;
+    xfer_dcc_hash_chunk (&chunk);
+    LONGS_EQUAL(1, chunk.rc);
+    LONGS_EQUAL(0x9A38DA03, chunk.crc32);
+
+    /* second chunk */
+    chunk.start = 1000;
+    chunk.size = 3000;
+    xfer_dcc_hash_chunk (&chunk);
+    LONGS_EQUAL(1, chunk.rc);
+    LONGS_EQUAL(0x470C7E61, chunk.crc32);
+
+    /* chunk beyond end of file */
+    chunk.start = 1000;
+    chunk.size = 4000;
+    xfer_dcc_hash_chunk (&chunk);
+    LONGS_EQUAL(0, chunk.rc);
+
+    /* hashing stopped */
+    hash.quit = 1;
+    chunk.start = 0;
+    chunk.size = 4000;
+    xfer_dcc_hash_chunk (&chunk);
+    LONGS_EQUAL(0, chunk.rc);
+
+    pthread_mutex_destroy (&hash.mutex);
+
+    unlink (TEST_XFER_DCC_FILE);
+}
+
+/*
+ * Tests functions:
+ *   xfer_dcc_resume_hash
+ */
+
+TEST(XferDcc, ResumeHash)
+{
+    struct t_xfer xfer;
+    uint32_t crc32;
+
+    write_test_file ();
+
+    memset (&xfer, 0, sizeof (xfer));
+    xfer.temp_local_filename = (char *)TEST_XFER_DCC_FILE;
+
+    crc32 = 0;
+    xfer.start_resume = 4000;
+    LONGS_EQUAL(1, xfer_dcc_resume_hash (&xfer, &crc32));
+    LONGS_EQUAL(0x6155FC42, crc32);
+
+    crc32 = 0;
+    xfer.start_resume = 1000;
+    LONGS_EQUAL(1, xfer_dcc_resume_hash (&xfer, &crc32));
+    LONGS_EQUAL(0x9A38DA03, crc32);
+
+    /* file too short */
+    xfer.start_resume = 5000;
+    LONGS_EQUAL(0, xfer_dcc_resume_hash (&xfer, &crc32));
+
+    unlink (TEST_XFER_DCC_FILE);
+}
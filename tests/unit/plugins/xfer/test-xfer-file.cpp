@@ -52,6 +52,27 @@ TEST(XferFile, SearchCrc32)
     STRCMP_EQUAL("12345678", xfer_file_search_crc32 ("1234abcd_12345678"));
 }
 
+/*
+ * Tests functions:
+ *   xfer_file_crc32_combine
+ */
+
+TEST(XferFile, Crc32Combine)
+{
+    /* second block empty */
+    LONGS_EQUAL(0xED81F9F6, xfer_file_crc32_combine (0xED81F9F6, 0, 0));
+
+    /* first block empty */
+    LONGS_EQUAL(0x3A771143, xfer_file_crc32_combine (0, 0x3A771143, 5));
+
+    /* "hello " + "world" */
+    LONGS_EQUAL(0x0D4A1185, xfer_file_crc32_combine (0xED81F9F6, 0x3A771143, 5));
+
+    /* 1000 x "a" + 3000 x "b" */
+    LONGS_EQUAL(0x6155FC42,
+                xfer_file_crc32_combine (0x9A38DA03, 0x470C7E61, 3000));
+}
+
 /*
  * Tests functions:
  *   xfer_file_resume
@@ -0,0 +1,123 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#
+
+"""
+Compare two results of WeeChat micro-benchmarks (JSON files written by
+"weechat-benchmarks -o file.json" or "make benchmark") and report the
+benchmarks slower than a threshold (in percent, default is 10).
+
+Usage example:
+
+```
+./compare_benchmarks.py baseline.json benchmarks.json
+./compare_benchmarks.py --threshold 5 baseline.json benchmarks.json
+```
+
+The exit code is 1 if at least one benchmark is slower than the threshold
+(regression), 0 otherwise.
+
+This script requires Python 3.7+.
+"""
+
+from typing import Dict
+
+import argparse
+import json
+import sys
+
+
+def read_results(filename: str) -> Dict[str, float]:
+    """
+    Read results of benchmarks.
+
+    :param filename: JSON file with results
+    :return: dict with benchmark name as key and time per op (ns) as value
+    """
+    with open(filename, encoding="utf-8") as json_file:
+        data = json.load(json_file)
+    return {
+        bench["name"]: float(bench["ns_per_op"])
+        for bench in data.get("benchmarks", [])
+    }
+
+
+def compare_results(
+    baseline: Dict[str, float],
+    current: Dict[str, float],
+    threshold: float,
+) -> int:
+    """
+    Compare results and display a line for each benchmark.
+
+    :param baseline: results of baseline
+    :param current: results to compare with baseline
+    :param threshold: max allowed slowdown, in percent
+    :return: number of regressions
+    """
+    regressions = 0
+    for name, time_current in current.items():
+        time_baseline = baseline.get(name)
+        if time_baseline is None:
+            print(f"{name:<48} {'':>14} {time_current:>14.2f}  (new)")
+            continue
+        diff = (
+            ((time_current - time_baseline) * 100) / time_baseline
+            if time_baseline > 0
+            else 0
+        )
+        status = ""
+        if diff > threshold:
+            status = "  REGRESSION"
+            regressions += 1
+        print(
+            f"{name:<48} {time_baseline:>14.2f} {time_current:>14.2f} "
+            f"{diff:>+8.1f}%{status}"
+        )
+    for name in baseline:
+        if name not in current:
+            print(f"{name:<48} {baseline[name]:>14.2f} {'':>14}  (removed)")
+    return regressions
+
+
+def main() -> int:
+    """Compare benchmarks and return 1 if there is at least a regression."""
+    parser = argparse.ArgumentParser(
+        description="Compare results of WeeChat micro-benchmarks."
+    )
+    parser.add_argument(
+        "-t",
+        "--threshold",
+        type=float,
+        default=10.0,
+        help="max allowed slowdown in percent (default: 10)",
+    )
+    parser.add_argument("baseline", help="JSON file with baseline results")
+    parser.add_argument("current", help="JSON file with new results")
+    args = parser.parse_args()
+    regressions = compare_results(
+        read_results(args.baseline),
+        read_results(args.current),
+        args.threshold,
+    )
+    dict_reg = {0: "no regression", 1: "1 regression"}
+    print("Benchmarks:", dict_reg.get(regressions, f"{regressions} regressions"))
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
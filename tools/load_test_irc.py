@@ -0,0 +1,535 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2024 Sébastien Helleu <flashcode@flashtux.org>
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#
+
+"""
+Load test of WeeChat with synthetic or recorded IRC traffic.
+
+This script runs a local IRC server sending traffic to a headless WeeChat
+(binary "weechat-headless") connected to it, with relay clients ("weechat"
+protocol) attached and synchronized during the whole run.
+
+Scenarios (run in this order, each one can be selected with --scenario):
+
+- names: join of a channel with many users (353/366 replies)
+- privmsg: messages on the channel at a given rate
+- joinpart: storm of JOIN/PART/QUIT
+- netsplit: netsplit (QUIT of half of users) followed by netjoin
+- list: reply to /list with many channels (321/322/323)
+- replay: raw IRC messages read from a file (option --replay)
+
+For each scenario, the script reports:
+
+- throughput: messages per second, until WeeChat answered a PING sent after
+  the last message
+- IRC latency: round-trip of PING messages sent with the traffic
+  (percentiles)
+- relay latency: round-trip of "ping" commands sent by relay clients, which
+  measures the latency of the WeeChat main loop (percentiles)
+- RSS of the WeeChat process over time (Linux only).
+
+Usage example, from the build directory:
+
+```
+WEECHAT_EXTRA_LIBDIR=src ../tools/load_test_irc.py \\
+    --weechat src/gui/curses/headless/weechat-headless \\
+    --users 20000 --rate 1000 --output load.json
+```
+
+This script requires Python 3.7+.
+"""
+
+from pathlib import Path
+from typing import Dict, List, Optional
+
+import argparse
+import asyncio
+import json
+import socket
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+
+SCENARIOS = ["names", "privmsg", "joinpart", "netsplit", "list", "replay"]
+
+IRC_NICK = "alice"
+IRC_CHANNEL = "#load"
+RELAY_PASSWORD = "loadtest"
+
+LATENCY_INTERVAL = 0.1
+RSS_INTERVAL = 0.5
+
+
+def percentiles(values: List[float]) -> Dict[str, float]:
+    """
+    Return percentiles 50/90/99 and max of values (in milliseconds).
+
+    :param values: list of values in seconds
+    :return: dict with percentiles
+    """
+    if not values:
+        return {}
+    values = sorted(values)
+    result = {}
+    for pct in (50, 90, 99):
+        index = min(len(values) - 1, (len(values) * pct) // 100)
+        result[f"p{pct}"] = round(values[index] * 1000, 3)
+    result["max"] = round(values[-1] * 1000, 3)
+    return result
+
+
+def get_free_port() -> int:
+    """Return a free TCP port on localhost."""
+    with socket.socket(socket.AF_INET, socket.SOCK_STREAM) as sock:
+        sock.bind(("127.0.0.1", 0))
+        return sock.getsockname()[1]
+
+
+def get_rss(pid: int) -> int:
+    """
+    Return resident set size of a process (in KB), 0 if unknown.
+
+    :param pid: process id
+    :return: RSS in KB
+    """
+    try:
+        with open(f"/proc/{pid}/status", encoding="utf-8") as status:
+            for line in status:
+                if line.startswith("VmRSS:"):
+                    return int(line.split()[1])
+    except (OSError, ValueError, IndexError):
+        pass
+    return 0
+
+
+class IrcServer:
+    """Fake IRC server, sending traffic to one client (WeeChat)."""
+
+    def __init__(self, users: int):
+        self.users = [f"user{i}" for i in range(users)]
+        self.reader: Optional[asyncio.StreamReader] = None
+        self.writer: Optional[asyncio.StreamWriter] = None
+        self.connected = asyncio.Event()
+        self.joined = asyncio.Event()
+        self.pending_pings: Dict[str, float] = {}
+        self.pong_events: Dict[str, asyncio.Event] = {}
+        self.latencies: List[float] = []
+        self.ping_count = 0
+
+    async def handle_client(
+        self, reader: asyncio.StreamReader, writer: asyncio.StreamWriter
+    ) -> None:
+        """Handle connection of WeeChat."""
+        self.reader, self.writer = reader, writer
+        self.connected.set()
+        while True:
+            line = await reader.readline()
+            if not line:
+                break
+            self.handle_message(line.decode("utf-8", errors="replace").strip())
+
+    def send(self, message: str) -> None:
+        """Send a message to WeeChat."""
+        if self.writer:
+            self.writer.write(f"{message}\r\n".encode("utf-8"))
+
+    def handle_message(self, message: str) -> None:
+        """Handle a message received from WeeChat."""
+        items = message.split(" ")
+        command = items[0].upper()
+        if command == "CAP" and len(items) > 1 and items[1].upper() == "LS":
+            self.send(":server CAP * LS :")
+        elif command == "USER":
+            self.send(f":server 001 {IRC_NICK} :Welcome {IRC_NICK}")
+            self.send(
+                f":server 005 {IRC_NICK} CHANTYPES=# PREFIX=(ov)@+ "
+                "NETWORK=load :are supported by this server"
+            )
+            self.send(f":server 376 {IRC_NICK} :End of MOTD")
+        elif command == "PING":
+            self.send(f":server PONG server {' '.join(items[1:])}")
+        elif command == "PONG":
+            token = items[-1].lstrip(":")
+            start = self.pending_pings.pop(token, None)
+            if start is not None:
+                self.latencies.append(time.monotonic() - start)
+            event = self.pong_events.pop(token, None)
+            if event:
+                event.set()
+        elif command == "JOIN" and IRC_CHANNEL in message:
+            self.joined.set()
+
+    def send_ping(self, wait: bool = False) -> asyncio.Event:
+        """Send a PING, WeeChat answers after processing previous data."""
+        self.ping_count += 1
+        token = f"load{self.ping_count}"
+        event = asyncio.Event()
+        self.pending_pings[token] = time.monotonic()
+        if wait:
+            self.pong_events[token] = event
+        self.send(f"PING :{token}")
+        return event
+
+    async def drain(self) -> None:
+        """Wait until data is sent to the socket."""
+        if self.writer:
+            await self.writer.drain()
+
+
+class RelayClient:
+    """Relay client ("weechat" protocol), synchronized with all buffers."""
+
+    def __init__(self, port: int):
+        self.port = port
+        self.reader: Optional[asyncio.StreamReader] = None
+        self.writer: Optional[asyncio.StreamWriter] = None
+        self.pending_pings: Dict[str, float] = {}
+        self.latencies: List[float] = []
+        self.ping_count = 0
+        self.bytes_received = 0
+
+    async def connect(self, timeout: float = 30) -> None:
+        """Connect to relay, retrying until it is ready."""
+        deadline = time.monotonic() + timeout
+        while True:
+            try:
+                self.reader, self.writer = await asyncio.open_connection(
+                    "127.0.0.1", self.port
+                )
+                break
+            except OSError:
+                if time.monotonic() > deadline:
+                    raise
+                await asyncio.sleep(0.1)
+        self.send(f"init password={RELAY_PASSWORD},compression=off")
+        self.send("sync")
+
+    def send(self, command: str) -> None:
+        """Send a command to relay."""
+        if self.writer:
+            self.writer.write(f"{command}\n".encode("utf-8"))
+
+    def send_ping(self) -> None:
+        """Send a "ping" command."""
+        self.ping_count += 1
+        token = f"{self.ping_count}"
+        self.pending_pings[token] = time.monotonic()
+        self.send(f"ping {token}")
+
+    async def read(self) -> None:
+        """Read messages received from relay."""
+        assert self.reader
+        while True:
+            try:
+                header = await self.reader.readexactly(5)
+                length = struct.unpack(">i", header[:4])[0]
+                data = await self.reader.readexactly(length - 5)
+            except (asyncio.IncompleteReadError, ConnectionError):
+                break
+            self.bytes_received += length
+            self.handle_message(data)
+
+    def handle_message(self, data: bytes) -> None:
+        """Handle a message, only "_pong" is used."""
+        length_id = struct.unpack(">i", data[:4])[0]
+        if length_id <= 0 or data[4:4 + length_id] != b"_pong":
+            return
+        pos = 4 + length_id + 3  # skip id and type "str"
+        length_str = struct.unpack(">i", data[pos:pos + 4])[0]
+        token = data[pos + 4:pos + 4 + max(0, length_str)].decode()
+        start = self.pending_pings.pop(token, None)
+        if start is not None:
+            self.latencies.append(time.monotonic() - start)
+
+
+class LoadTest:
+    """Load test: WeeChat process, IRC server, relay clients, scenarios."""
+
+    def __init__(self, args: argparse.Namespace):
+        self.args = args
+        self.server = IrcServer(args.users)
+        self.relays: List[RelayClient] = []
+        self.process: Optional[subprocess.Popen] = None
+        self.rss: List[List[float]] = []
+        self.time_start = 0.0
+        self.results: Dict[str, Dict] = {}
+
+    def start_weechat(self, irc_port: int, relay_port: int, home: str):
+        """Start headless WeeChat, connected to the IRC server."""
+        commands = ";".join(
+            [
+                f"/set relay.network.password {RELAY_PASSWORD}",
+                "/set relay.network.max_clients 0",
+                f"/relay add weechat {relay_port}",
+                f"/server add load 127.0.0.1/{irc_port} -notls "
+                f"-nicks={IRC_NICK} -autojoin={IRC_CHANNEL}",
+                "/set irc.server.load.capabilities \"\"",
+                "/connect load",
+            ]
+        )
+        cmd = [self.args.weechat, "--dir", home, "-r", commands]
+        if self.args.plugins:
+            cmd[1:1] = ["-P", self.args.plugins]
+        self.process = subprocess.Popen(  # pylint: disable=consider-using-with
+            cmd,
+            stdin=subprocess.DEVNULL,
+            stdout=subprocess.DEVNULL,
+            stderr=subprocess.DEVNULL,
+        )
+
+    async def sample_rss(self) -> None:
+        """Sample RSS of WeeChat process."""
+        while self.process and self.process.poll() is None:
+            self.rss.append(
+                [
+                    round(time.monotonic() - self.time_start, 3),
+                    get_rss(self.process.pid),
+                ]
+            )
+            await asyncio.sleep(RSS_INTERVAL)
+
+    async def measure_latency(self) -> None:
+        """Send PING to WeeChat (IRC and relay) at regular interval."""
+        while True:
+            self.server.send_ping()
+            for relay in self.relays:
+                relay.send_ping()
+            await asyncio.sleep(LATENCY_INTERVAL)
+
+    async def send_lines(self, lines) -> int:
+        """
+        Send messages to WeeChat, at the rate given in arguments.
+
+        :param lines: iterable with IRC messages
+        :return: number of messages sent
+        """
+        rate = self.args.rate
+        count = 0
+        start = time.monotonic()
+        for line in lines:
+            self.server.send(line)
+            count += 1
+            if rate > 0:
+                delay = start + (count / rate) - time.monotonic()
+                if delay > 0:
+                    await self.server.drain()
+                    await asyncio.sleep(delay)
+            elif count % 1000 == 0:
+                await self.server.drain()
+        await self.server.drain()
+        return count
+
+    def scenario_lines(self, name: str):
+        """Return generator with messages of a scenario."""
+        users = self.server.users
+        if name == "names":
+            yield f":{IRC_NICK}!user@host JOIN {IRC_CHANNEL}"
+            for i in range(0, len(users), 40):
+                nicks = " ".join(users[i:i + 40])
+                yield f":server 353 {IRC_NICK} = {IRC_CHANNEL} :{nicks}"
+            yield f":server 366 {IRC_NICK} {IRC_CHANNEL} :End of /NAMES list."
+        elif name == "privmsg":
+            for i in range(self.args.messages):
+                nick = users[i % len(users)] if users else "bob"
+                yield (
+                    f":{nick}!user@host PRIVMSG {IRC_CHANNEL} "
+                    f":this is the message number {i} in the load test"
+                )
+        elif name == "joinpart":
+            for i in range(self.args.messages):
+                nick = f"storm{i % 1000}"
+                if i % 3 == 0:
+                    yield f":{nick}!user@host JOIN {IRC_CHANNEL}"
+                elif i % 3 == 1:
+                    yield f":{nick}!user@host PART {IRC_CHANNEL} :bye"
+                else:
+                    yield f":{nick}!user@host JOIN {IRC_CHANNEL}"
+                    yield f":{nick}!user@host QUIT :Quit: bye"
+        elif name == "netsplit":
+            split = users[::2]
+            for nick in split:
+                yield f":{nick}!user@host QUIT :irc.a.net irc.b.net"
+            for nick in split:
+                yield f":{nick}!user@host JOIN {IRC_CHANNEL}"
+        elif name == "list":
+            yield f":server 321 {IRC_NICK} Channel :Users Name"
+            for i in range(self.args.list):
+                yield (
+                    f":server 322 {IRC_NICK} #channel{i} {i % 500} "
+                    f":topic of channel {i}"
+                )
+            yield f":server 323 {IRC_NICK} :End of /LIST"
+        elif name == "replay" and self.args.replay:
+            with open(self.args.replay, encoding="utf-8") as replay:
+                for line in replay:
+                    line = line.rstrip("\r\n")
+                    if line:
+                        yield line
+
+    async def run_scenario(self, name: str) -> None:
+        """Run a scenario and store its results."""
+        if name == "replay" and not self.args.replay:
+            return
+        latency_irc = len(self.server.latencies)
+        latency_relay = [len(relay.latencies) for relay in self.relays]
+        start = time.monotonic()
+        count = await self.send_lines(self.scenario_lines(name))
+        await self.server.send_ping(wait=True).wait()
+        duration = time.monotonic() - start
+        relay_latencies = []
+        for relay, index in zip(self.relays, latency_relay):
+            relay_latencies.extend(relay.latencies[index:])
+        self.results[name] = {
+            "messages": count,
+            "duration_s": round(duration, 3),
+            "throughput_msg_s": round(count / duration, 1) if duration else 0,
+            "irc_latency_ms": percentiles(
+                self.server.latencies[latency_irc:]
+            ),
+            "relay_latency_ms": percentiles(relay_latencies),
+            "rss_kb": get_rss(self.process.pid) if self.process else 0,
+        }
+        print(
+            f"{name:<10} {count:>9} msgs {duration:>9.3f} s "
+            f"{self.results[name]['throughput_msg_s']:>11.1f} msg/s  "
+            f"irc: {self.results[name]['irc_latency_ms']}  "
+            f"relay: {self.results[name]['relay_latency_ms']}",
+            flush=True,
+        )
+
+    async def run(self) -> Dict:
+        """Run load test and return results."""
+        irc_server = await asyncio.start_server(
+            self.server.handle_client, "127.0.0.1", 0
+        )
+        irc_port = irc_server.sockets[0].getsockname()[1]
+        relay_port = get_free_port()
+        with tempfile.TemporaryDirectory(prefix="weechat_load_") as home:
+            self.time_start = time.monotonic()
+            self.start_weechat(irc_port, relay_port, home)
+            tasks = [asyncio.ensure_future(self.sample_rss())]
+            try:
+                await asyncio.wait_for(self.server.connected.wait(), 30)
+                await asyncio.wait_for(self.server.joined.wait(), 30)
+                for _ in range(self.args.relay_clients):
+                    relay = RelayClient(relay_port)
+                    await relay.connect()
+                    self.relays.append(relay)
+                    tasks.append(asyncio.ensure_future(relay.read()))
+                tasks.append(asyncio.ensure_future(self.measure_latency()))
+                for name in SCENARIOS:
+                    if name in self.args.scenario:
+                        await self.run_scenario(name)
+            finally:
+                if self.relays:
+                    self.relays[0].send("input core.weechat /quit")
+                try:
+                    if self.process:
+                        self.process.wait(timeout=10)
+                except subprocess.TimeoutExpired:
+                    self.process.kill()
+                for task in tasks:
+                    task.cancel()
+                irc_server.close()
+        return {
+            "users": self.args.users,
+            "rate": self.args.rate,
+            "relay_clients": self.args.relay_clients,
+            "scenarios": self.results,
+            "rss_kb": self.rss,
+        }
+
+
+def main() -> int:
+    """Run load test."""
+    parser = argparse.ArgumentParser(
+        description="Load test of WeeChat with IRC traffic."
+    )
+    parser.add_argument(
+        "-w",
+        "--weechat",
+        default="weechat-headless",
+        help="path to weechat-headless binary",
+    )
+    parser.add_argument(
+        "-P", "--plugins", help="plugins to load (option -P of WeeChat)"
+    )
+    parser.add_argument(
+        "-s",
+        "--scenario",
+        action="append",
+        choices=SCENARIOS,
+        help="scenario to run (can be given multiple times, default: all)",
+    )
+    parser.add_argument(
+        "-u",
+        "--users",
+        type=int,
+        default=20000,
+        help="number of users in channel (default: 20000)",
+    )
+    parser.add_argument(
+        "-m",
+        "--messages",
+        type=int,
+        default=10000,
+        help="messages sent in privmsg and joinpart (default: 10000)",
+    )
+    parser.add_argument(
+        "-l",
+        "--list",
+        type=int,
+        default=100000,
+        help="number of channels in reply to /list (default: 100000)",
+    )
+    parser.add_argument(
+        "-r",
+        "--rate",
+        type=float,
+        default=1000,
+        help="messages per second, 0 = unlimited (default: 1000)",
+    )
+    parser.add_argument(
+        "-c",
+        "--relay-clients",
+        type=int,
+        default=2,
+        help="number of relay clients attached (default: 2)",
+    )
+    parser.add_argument("--replay", help="file with raw IRC messages to send")
+    parser.add_argument("-o", "--output", help="write results in JSON file")
+    args = parser.parse_args()
+    if not args.scenario:
+        args.scenario = SCENARIOS
+    if "names" not in args.scenario:
+        args.scenario.insert(0, "names")
+    results = asyncio.get_event_loop().run_until_complete(
+        LoadTest(args).run()
+    )
+    if args.output:
+        Path(args.output).write_text(
+            json.dumps(results, indent=2) + "\n", encoding="utf-8"
+        )
+    max_rss = max((rss for _, rss in results["rss_kb"]), default=0)
+    print(f"Max RSS: {max_rss} KB")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())